@@ -0,0 +1,386 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file BuildPipeline_benchmark.cpp
+* @brief Times tag matching and the tgcreator build pipeline over models
+* of 10 to 10000 elements
+* $Id$
+*/
+
+// This application
+#include "yamlbuilder/TensegrityModel.h"
+#include "core/tgBasicActuator.h"
+#include "core/tgModel.h"
+#include "core/tgRod.h"
+#include "core/tgTags.h"
+#include "core/tgWorld.h"
+#include "tgcreator/tgBasicActuatorInfo.h"
+#include "tgcreator/tgBuildSpec.h"
+#include "tgcreator/tgNodes.h"
+#include "tgcreator/tgPairs.h"
+#include "tgcreator/tgRigidAutoCompound.h"
+#include "tgcreator/tgRodInfo.h"
+#include "tgcreator/tgStructure.h"
+#include "tgcreator/tgStructureInfo.h"
+// The Bullet Physics library
+#include "LinearMath/btQuickprof.h"
+// The C++ Standard Library
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+	/** Keeps the compiler from dropping the work being timed */
+	volatile std::size_t sink = 0;
+
+	const double rodRadius = 0.1;
+	const double rodDensity = 1.0;
+
+	/**
+	 * A ladder of size rungs, each a rod between a "left" and a "right"
+	 * node. The left nodes are joined by strings and every other pair of
+	 * rungs by a rod between their right nodes, so the rods form
+	 * compounds of three.
+	 */
+	void buildLadder(tgStructure& ladder, int size)
+	{
+		for (int i = 0; i < size; i++)
+		{
+			ladder.addNode(0, 0, i, "left");
+			ladder.addNode(1, 0, i, "right");
+			ladder.addPair(2 * i, 2 * i + 1, "rod");
+			if (i > 0)
+			{
+				ladder.addPair(2 * i - 2, 2 * i, "string");
+			}
+			if (i % 2 == 1)
+			{
+				ladder.addPair(2 * i - 1, 2 * i + 1, "rod");
+			}
+		}
+	}
+
+	void addBuilders(tgBuildSpec& spec)
+	{
+		const tgRod::Config rodConfig(rodRadius, rodDensity);
+		const tgBasicActuator::Config stringConfig(1000.0, 10.0, 100.0);
+		spec.addBuilder("rod", new tgRodInfo(rodConfig));
+		spec.addBuilder("string", new tgBasicActuatorInfo(stringConfig));
+	}
+
+	/** The ladder of buildLadder as a TensegrityModel structure file */
+	void writeLadder(const std::string& path, int size)
+	{
+		std::ofstream out(path.c_str());
+		out << "nodes:\n";
+		for (int i = 0; i < size; i++)
+		{
+			out << "  left" << i << ": [0, 0, " << i << "]\n"
+				<< "  right" << i << ": [1, 0, " << i << "]\n";
+		}
+		out << "\npair_groups:\n  rod:\n";
+		for (int i = 0; i < size; i++)
+		{
+			out << "    - [left" << i << ", right" << i << "]\n";
+			if (i % 2 == 1)
+			{
+				out << "    - [right" << i - 1 << ", right" << i << "]\n";
+			}
+		}
+		if (size > 1)
+		{
+			out << "  string:\n";
+			for (int i = 1; i < size; i++)
+			{
+				out << "    - [left" << i - 1 << ", left" << i << "]\n";
+			}
+		}
+		out << "\nbuilders:\n"
+			<< "  rod:\n    class: tgRodInfo\n    parameters:\n"
+			<< "      density: " << rodDensity << "\n"
+			<< "      radius: " << rodRadius << "\n";
+		if (size > 1)
+		{
+			out << "  string:\n    class: tgBasicActuatorInfo\n    parameters:\n"
+				<< "      stiffness: 1000\n      damping: 10\n      pretension: 100\n";
+		}
+	}
+
+	double elapsed(btClock& clock)
+	{
+		return clock.getTimeMicroseconds() * 1.0e-6;
+	}
+
+	// Each benchmark runs its operation calls times and returns the
+	// seconds spent in the operation alone
+
+	double tagsContains(int size, int calls)
+	{
+		std::ostringstream all;
+		for (int i = 0; i < size; i++)
+		{
+			all << "tag" << i << " ";
+		}
+		const tgTags tags(all.str());
+		std::ostringstream query;
+		query << "tag" << size - 1 << " tag0";
+		const std::string search = query.str();
+
+		btClock clock;
+		for (int i = 0; i < calls; i++)
+		{
+			sink += tags.contains(search);
+		}
+		return elapsed(clock);
+	}
+
+	double tagsSplit(int size, int calls)
+	{
+		std::ostringstream all;
+		for (int i = 0; i < size; i++)
+		{
+			all << "tag" << i << " ";
+		}
+		const std::string s = all.str();
+
+		btClock clock;
+		for (int i = 0; i < calls; i++)
+		{
+			sink += tgTags::splitTags(s).size();
+		}
+		return elapsed(clock);
+	}
+
+	double taggablesFind(int size, int calls)
+	{
+		tgStructure ladder;
+		buildLadder(ladder, size);
+		tgNodes nodes(ladder.getNodes());
+
+		btClock clock;
+		for (int i = 0; i < calls; i++)
+		{
+			sink += nodes.find("left").size();
+		}
+		return elapsed(clock);
+	}
+
+	double autoCompound(int size, int calls)
+	{
+		tgStructure ladder;
+		buildLadder(ladder, size);
+		const tgPairs& pairs = ladder.getPairs();
+		const tgRod::Config rodConfig(rodRadius, rodDensity);
+
+		double seconds = 0.0;
+		for (int i = 0; i < calls; i++)
+		{
+			std::vector<tgRigidInfo*> rigids;
+			for (int j = 0; j < pairs.size(); j++)
+			{
+				if (pairs[j].hasTag("rod"))
+				{
+					rigids.push_back(new tgRodInfo(rodConfig, pairs[j]));
+				}
+			}
+
+			btClock clock;
+			tgRigidAutoCompound compound(rigids);
+			const std::vector<tgRigidInfo*> compounded = compound.execute();
+			seconds += elapsed(clock);
+			sink += compounded.size();
+
+			// As ~tgStructureInfo does
+			for (std::size_t j = 0; j < compounded.size(); j++)
+			{
+				if (compounded[j]->getRigidInfoGroup() != compounded[j])
+				{
+					delete compounded[j];
+				}
+			}
+			for (std::size_t j = 0; j < rigids.size(); j++)
+			{
+				delete rigids[j];
+			}
+		}
+		return seconds;
+	}
+
+	double buildInto(int size, int calls)
+	{
+		tgStructure ladder;
+		buildLadder(ladder, size);
+
+		double seconds = 0.0;
+		for (int i = 0; i < calls; i++)
+		{
+			tgWorld world;
+			tgModel model;
+			tgBuildSpec spec;
+			addBuilders(spec);
+
+			btClock clock;
+			tgStructureInfo structureInfo(ladder, spec);
+			structureInfo.buildInto(model, world);
+			seconds += elapsed(clock);
+			sink += model.getDescendants().size();
+
+			model.teardown();
+		}
+		return seconds;
+	}
+
+	double yamlSetup(int size, int calls)
+	{
+		const char* const tmp = std::getenv("TMPDIR");
+		std::ostringstream path;
+		path << ((tmp != NULL) ? tmp : "/tmp") << "/BuildPipeline_" << size << ".yaml";
+		writeLadder(path.str(), size);
+
+		double seconds = 0.0;
+		for (int i = 0; i < calls; i++)
+		{
+			tgWorld world;
+			TensegrityModel model(path.str());
+
+			// Reading the file is part of the first setup
+			btClock clock;
+			model.setup(world);
+			seconds += elapsed(clock);
+			sink += model.getDescendants().size();
+
+			model.teardown();
+		}
+		std::remove(path.str().c_str());
+		return seconds;
+	}
+
+	struct Benchmark
+	{
+		const char* name;
+		double (*measure)(int size, int calls);
+	};
+
+	const Benchmark benchmarks[] = {
+		{ "tgTags::contains", tagsContains },
+		{ "tgTags::splitTags", tagsSplit },
+		{ "tgTaggables::find", taggablesFind },
+		{ "tgRigidAutoCompound::execute", autoCompound },
+		{ "tgStructureInfo::buildInto", buildInto },
+		{ "TensegrityModel::setup", yamlSetup }
+	};
+	const std::size_t nBenchmarks = sizeof(benchmarks) / sizeof(benchmarks[0]);
+
+	/** Long enough for the microsecond clock to resolve a call */
+	const double minSeconds = 0.2;
+
+	/**
+	 * Time one benchmark at one size, doubling the calls until they take
+	 * minSeconds, and report it as a JSON object.
+	 */
+	std::string run(const Benchmark& benchmark, int size)
+	{
+		int calls = 1;
+		double seconds = benchmark.measure(size, calls);
+		while (seconds < minSeconds && calls < (1 << 24))
+		{
+			calls *= 2;
+			seconds = benchmark.measure(size, calls);
+		}
+		const double perCall = seconds / calls;
+
+		std::ostringstream os;
+		os << std::setprecision(6)
+		   << "{\"benchmark\": \"" << benchmark.name << "\""
+		   << ", \"size\": " << size
+		   << ", \"calls\": " << calls
+		   << ", \"us_per_call\": " << 1.0e6 * perCall
+		   << ", \"ns_per_element\": " << 1.0e9 * perCall / size << "}";
+		return os.str();
+	}
+}
+
+/**
+ * Runs the benchmarks at sizes of 10, 100, 1000 and 10000 elements, one
+ * line each. An element is a tag for the tag benchmarks and a rung of a
+ * ladder, two nodes and a rod, otherwise.
+ * @param[in] argc the number of command-line arguments
+ * @param[in] argv argv[1], if supplied, is the name of the one benchmark
+ * to run, or "all"; argv[2] is the largest size, 10000 by default;
+ * argv[3] is a file the results are appended to, as one JSON object a
+ * line.
+ * @return 0, or 1 if the arguments are wrong
+ */
+int main(int argc, char** argv)
+{
+	const std::string which = (argc > 1) ? argv[1] : "all";
+	const int maxSize = (argc > 2) ? std::atoi(argv[2]) : 10000;
+	if (maxSize < 10)
+	{
+		std::cerr << "The largest size is less than 10" << std::endl;
+		return 1;
+	}
+
+	std::ofstream output;
+	if (argc > 3)
+	{
+		output.open(argv[3], std::ios::app);
+		if (!output)
+		{
+			std::cerr << "Can't open " << argv[3] << std::endl;
+			return 1;
+		}
+	}
+
+	bool found = false;
+	for (std::size_t i = 0; i < nBenchmarks; i++)
+	{
+		if (which != "all" && which != benchmarks[i].name)
+		{
+			continue;
+		}
+		found = true;
+		for (int size = 10; size <= maxSize; size *= 10)
+		{
+			const std::string result = run(benchmarks[i], size);
+			std::cout << result << std::endl;
+			if (output.is_open())
+			{
+				output << result << std::endl;
+			}
+		}
+	}
+	if (!found)
+	{
+		std::cerr << "No benchmark named " << which << "; the benchmarks are:";
+		for (std::size_t i = 0; i < nBenchmarks; i++)
+		{
+			std::cerr << " " << benchmarks[i].name;
+		}
+		std::cerr << std::endl;
+		return 1;
+	}
+	return 0;
+}
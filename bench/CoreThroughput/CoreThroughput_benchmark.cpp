@@ -0,0 +1,264 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file CoreThroughput_benchmark.cpp
+* @brief Runs fixed reference workloads and reports their build time,
+* stepping throughput and peak memory, to compare across commits
+* $Id$
+*/
+
+// The workloads
+#include "examples/3_prism/PrismModel.h"
+#include "examples/SUPERball/T6Model.h"
+#include "examples/contactCables/TetraSpineCollisions.h"
+#include "yamlbuilder/TensegrityModel.h"
+// This library
+#include "core/terrain/tgBoxGround.h"
+#include "core/terrain/tgHillyGround.h"
+#include "core/tgCast.h"
+#include "core/tgModel.h"
+#include "core/tgPerfCounters.h"
+#include "core/tgSimView.h"
+#include "core/tgSimulation.h"
+#include "core/tgSpringCableActuator.h"
+#include "core/tgWorld.h"
+// The Bullet Physics library
+#include "LinearMath/btQuickprof.h"
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+// POSIX
+#include <sys/resource.h>
+
+namespace {
+
+	/** How to set up one workload */
+	struct Workload
+	{
+		const char* name;
+		/** Gravity, in the length units of the model */
+		double gravity;
+		tgModel* (*createModel)();
+		tgGround* (*createGround)();
+	};
+
+	tgModel* createPrism() { return new PrismModel(); }
+
+	tgModel* createSUPERball() { return new T6Model(); }
+
+	tgModel* createBigPuppy()
+	{
+		return new TensegrityModel(RESOURCE_PATH "/YamlStructures/BigPuppy.yaml");
+	}
+
+	tgModel* createContactSpine() { return new TetraSpineCollisions(12, 50.0); }
+
+	tgGround* createFlat() { return new tgBoxGround(); }
+
+	// The hills of AppTetraSpineCol
+	tgGround* createHills()
+	{
+		const tgHillyGround::Config config(btVector3(M_PI / 4.0, 0.0, 0.0),
+										   0.5, 0.1,
+										   btVector3(500.0, 1.5, 500.0),
+										   btVector3(0.0, 0.0, 0.0),
+										   100, 100, 1.0, 15.0, 5.0, 0.0);
+		return new tgHillyGround(config);
+	}
+
+	const Workload workloads[] = {
+		{ "3_prism", 981.0, createPrism, createFlat },
+		{ "SUPERball", 98.1, createSUPERball, createFlat },
+		{ "BigPuppy_yaml", 98.1, createBigPuppy, createFlat },
+		{ "contact_spine", 981.0, createContactSpine, createFlat },
+		{ "SUPERball_hills", 98.1, createSUPERball, createHills }
+	};
+	const std::size_t nWorkloads = sizeof(workloads) / sizeof(workloads[0]);
+
+	/** The peak resident set of the process so far, in megabytes */
+	double peakRSS()
+	{
+		struct rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+		return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+		return usage.ru_maxrss / 1024.0;
+#endif
+	}
+
+	/**
+	 * Write the hardware counters of each scope as a JSON object: instructions
+	 * per cycle, and cycles and misses per item handled (cable or body)
+	 */
+	void writeCounters(std::ostream& os,
+					   const std::map<std::string, tgPerfCounters::Totals>& counters)
+	{
+		os << "{";
+		for (std::map<std::string, tgPerfCounters::Totals>::const_iterator it =
+				 counters.begin(); it != counters.end(); ++it)
+		{
+			const tgPerfCounters::Totals& totals = it->second;
+			os << (it == counters.begin() ? "" : ", ")
+			   << "\"" << it->first << "\": {\"calls\": " << totals.calls
+			   << ", \"items\": " << totals.items
+			   << ", \"ipc\": " << totals.ipc();
+			for (int c = 0; c < tgPerfCounters::eNumCounters; c++)
+			{
+				const tgPerfCounters::Counter counter =
+					static_cast<tgPerfCounters::Counter>(c);
+				if (counter != tgPerfCounters::eInstructions && totals.counted[c])
+				{
+					os << ", \"" << tgPerfCounters::getName(counter)
+					   << "_per_item\": " << totals.perItem(counter);
+				}
+			}
+			os << "}";
+		}
+		os << "}";
+	}
+
+	/** Build and run one workload, and report it as a JSON object */
+	std::string run(const Workload& workload, int steps)
+	{
+		const double stepSize = 1.0 / 1000.0;
+		btClock clock;
+
+		const tgWorld::Config config(workload.gravity);
+		tgWorld world(config, workload.createGround());
+		tgSimView view(world, stepSize, stepSize * steps);
+		tgSimulation simulation(view);
+		tgModel* const pModel = workload.createModel();
+		// The model is set up when added
+		simulation.addModel(pModel);
+		const double buildTime = clock.getTimeMicroseconds() * 1.0e-6;
+
+		const std::size_t cables =
+			tgCast::filter<tgModel, tgSpringCableActuator>(pModel->getDescendants()).size();
+
+		// Count the steps only
+		tgPerfCounters::take();
+		clock.reset();
+		simulation.run(steps);
+		const double runTime = clock.getTimeMicroseconds() * 1.0e-6;
+		const std::map<std::string, tgPerfCounters::Totals> counters =
+			tgPerfCounters::take();
+
+		const double stepsPerSecond = steps / runTime;
+		const double nsPerCableStep =
+			(cables > 0) ? 1.0e9 * runTime / (steps * static_cast<double>(cables)) : 0.0;
+
+		std::ostringstream os;
+		os << std::setprecision(6)
+		   << "{\"workload\": \"" << workload.name << "\""
+		   << ", \"steps\": " << steps
+		   << ", \"cables\": " << cables
+		   << ", \"build_s\": " << buildTime
+		   << ", \"run_s\": " << runTime
+		   << ", \"steps_per_s\": " << stepsPerSecond
+		   << ", \"ns_per_cable_step\": " << nsPerCableStep
+		   << ", \"peak_rss_mb\": " << peakRSS();
+		if (tgPerfCounters::isEnabled())
+		{
+			os << ", \"counters_available\": "
+			   << (tgPerfCounters::isAvailable() ? "true" : "false")
+			   << ", \"counters\": ";
+			writeCounters(os, counters);
+		}
+		os << "}";
+		return os.str();
+	}
+}
+
+/**
+ * Runs the workloads, one line each.
+ * @param[in] argc the number of command-line arguments
+ * @param[in] argv argv[1], if supplied, is the name of the one workload
+ * to run, or "all"; argv[2] is the number of steps, 10000 by default;
+ * argv[3] is a file the results are appended to, as one JSON object a
+ * line, or "-" for none; argv[4], if "counters", adds the hardware
+ * counters of the profiled scopes to each result. Peak RSS is that of
+ * the process, so run workloads one at a time to compare their memory.
+ * @return 0, or 1 if the arguments are wrong
+ */
+int main(int argc, char** argv)
+{
+	const std::string which = (argc > 1) ? argv[1] : "all";
+	const int steps = (argc > 2) ? std::atoi(argv[2]) : 10000;
+	if (steps <= 0)
+	{
+		std::cerr << "The number of steps is not positive" << std::endl;
+		return 1;
+	}
+
+	std::ofstream output;
+	if (argc > 3 && std::strcmp(argv[3], "-") != 0)
+	{
+		output.open(argv[3], std::ios::app);
+		if (!output)
+		{
+			std::cerr << "Can't open " << argv[3] << std::endl;
+			return 1;
+		}
+	}
+
+	if (argc > 4)
+	{
+		if (std::strcmp(argv[4], "counters") != 0)
+		{
+			std::cerr << "Unknown option " << argv[4] << std::endl;
+			return 1;
+		}
+		tgPerfCounters::setEnabled(true);
+	}
+
+	bool found = false;
+	for (std::size_t i = 0; i < nWorkloads; i++)
+	{
+		if (which == "all" || which == workloads[i].name)
+		{
+			found = true;
+			const std::string result = run(workloads[i], steps);
+			std::cout << result << std::endl;
+			if (output.is_open())
+			{
+				output << result << std::endl;
+			}
+		}
+	}
+	if (!found)
+	{
+		std::cerr << "No workload named " << which << "; the workloads are:";
+		for (std::size_t i = 0; i < nWorkloads; i++)
+		{
+			std::cerr << " " << workloads[i].name;
+		}
+		std::cerr << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -55,7 +55,7 @@ popd > /dev/null
 
 function usage
 {
-    echo "usage: $0 [-h] [-c] [-w] [-t/r/i/g] [build_path]"
+    echo "usage: $0 [-h] [-c] [-w] [-t/r/i/g/b] [build_path]"
     echo ""
     echo "positional arguments:"
     echo "  build_path            Path to build (relative to src, e.g. 'BasicApp' or"
@@ -69,6 +69,7 @@ function usage
     echo "  -r       Build test/ rather than src/ *and* run all tests after compilation."
     echo "  -i       Build test_integration/ rather than src/" 
     echo "  -g       Build test_integration/ rather than src/ *and* run all tests after compilation."
+    echo "  -b       Build bench/ rather than src/"
 }
 
 function cmake_cross_platform()
@@ -97,7 +98,7 @@ CMAKE_COMPILER_WARNINGS_FLAG=false
 RUN_ALL_TESTS=false
 RUN_INTEGRATION_TESTS=false
 
-while getopts ":hcwtrig" opt; do
+while getopts ":hcwtrigb" opt; do
     case $opt in
         h)
             usage;
@@ -127,6 +128,10 @@ while getopts ":hcwtrig" opt; do
             build_src=$INTEGRATION_TEST_DIR
             RUN_INTEGRATION_TESTS=true
             ;;
+        b)
+            build_target=$BUILD_BENCH_DIR
+            build_src=$BENCH_DIR
+            ;;
         \?)
             echo "Invalid option: -$OPTARG" >&2
             exit 1
@@ -0,0 +1,112 @@
+# Copyright (c) 2012, United States Government, as represented by the
+# Administrator of the National Aeronautics and Space Administration.
+# All rights reserved.
+#
+# The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+# under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# http://www.apache.org/licenses/LICENSE-2.0.
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+# either express or implied. See the License for the specific language
+# governing permissions and limitations under the License.
+
+import struct
+import sys
+
+class BinaryLogReader:
+    """
+    Reads the files written by tgBinaryDataLogger.
+
+    The file starts with a text header (magic line, description, byte
+    order, column count, then one column name per line), followed by
+    fixed-width records of 64-bit doubles.
+    """
+
+    MAGIC = "NTRT_BINARY_LOG 1"
+
+    def __init__(self, filePath):
+        """
+        Opens a log and parses its header.
+
+        Parameters
+
+        filePath: The path to a .bin file written by tgBinaryDataLogger.
+        """
+        self.filePath = filePath
+        self._file = open(filePath, 'rb')
+
+        magic = self._readLine()
+        if magic != self.MAGIC:
+            raise ValueError("%s is not an NTRT binary log" % filePath)
+        self.description = self._readLine()
+        byteOrder = self._readLine()
+        if byteOrder not in ("little", "big"):
+            raise ValueError("Unknown byte order '%s' in %s" % (byteOrder, filePath))
+        numColumns = int(self._readLine())
+        self.columns = [self._readLine() for i in range(numColumns)]
+
+        prefix = "<" if byteOrder == "little" else ">"
+        self._record = struct.Struct(prefix + "d" * numColumns)
+        self._dataStart = self._file.tell()
+
+    def _readLine(self):
+        return self._file.readline().decode('utf-8').rstrip('\n')
+
+    def records(self):
+        """
+        Yields each record as a tuple of floats, in column order. A record
+        cut short (e.g. by a crash while logging) is ignored.
+        """
+        self._file.seek(self._dataStart)
+        size = self._record.size
+        while True:
+            chunk = self._file.read(size)
+            if len(chunk) < size:
+                return
+            yield self._record.unpack(chunk)
+
+    def read(self):
+        """
+        Returns every record, as a list of tuples.
+        """
+        return list(self.records())
+
+    def column(self, name):
+        """
+        Returns every value of one column, as a list.
+
+        Parameters
+
+        name: A column name, e.g. "time" or "0_rod(t4 t5).X".
+        """
+        index = self.columns.index(name)
+        return [record[index] for record in self.records()]
+
+    def toCsv(self, out):
+        """
+        Writes the log in the same layout as tgDataLogger2, so that existing
+        post-processing can read it.
+
+        Parameters
+
+        out: A writable text file.
+        """
+        out.write(self.description + "\n")
+        out.write("".join(column + "," for column in self.columns) + "\n")
+        for record in self.records():
+            out.write("".join(repr(value) + "," for value in record) + "\n")
+
+    def close(self):
+        self._file.close()
+
+if __name__ == "__main__":
+    if len(sys.argv) != 2:
+        sys.stderr.write("Usage: %s log.bin > log.txt\n" % sys.argv[0])
+        sys.exit(1)
+    reader = BinaryLogReader(sys.argv[1])
+    reader.toCsv(sys.stdout)
+    reader.close()
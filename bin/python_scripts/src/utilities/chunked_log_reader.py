@@ -0,0 +1,85 @@
+# Copyright (c) 2012, United States Government, as represented by the
+# Administrator of the National Aeronautics and Space Administration.
+# All rights reserved.
+#
+# The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+# under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# http://www.apache.org/licenses/LICENSE-2.0.
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+# either express or implied. See the License for the specific language
+# governing permissions and limitations under the License.
+
+import math
+import sys
+import zlib
+
+class ChunkedLogReader:
+    """
+    Reads the compressed logs written by tgBufferedFileWriter with
+    compression on, using the chunk index next to them.
+
+    The log is a sequence of independent gzip members, one per chunk. The
+    index, the log's name plus ".idx", has a magic line and then one line
+    per chunk: byte offset, compressed size, first time, last time.
+    """
+
+    MAGIC = "NTRT_CHUNK_INDEX 1"
+
+    def __init__(self, filePath):
+        """
+        Opens a log and reads its index.
+
+        Parameters
+
+        filePath: The path to a compressed log, e.g. a .txt.gz file.
+        """
+        self.filePath = filePath
+        self.chunks = []
+        with open(filePath + ".idx", 'r') as index:
+            if index.readline().rstrip('\n') != self.MAGIC:
+                raise ValueError("%s.idx is not an NTRT chunk index" % filePath)
+            for line in index:
+                offset, size, first, last = line.split()
+                self.chunks.append((int(offset), int(size),
+                                    float(first), float(last)))
+        self._file = open(filePath, 'rb')
+
+    def chunk(self, i):
+        """
+        Returns the uncompressed bytes of chunk i.
+        """
+        offset, size, first, last = self.chunks[i]
+        self._file.seek(offset)
+        return zlib.decompress(self._file.read(size), 16 + zlib.MAX_WBITS)
+
+    def window(self, start, end):
+        """
+        Returns the uncompressed bytes of every chunk that holds data
+        between times start and end. Only those chunks are inflated; the
+        first and last may hold data outside the window. Chunks without
+        times (e.g. only a header) are skipped.
+        """
+        data = []
+        for i, (offset, size, first, last) in enumerate(self.chunks):
+            if math.isnan(first) or last < start or first > end:
+                continue
+            data.append(self.chunk(i))
+        return b"".join(data)
+
+    def close(self):
+        self._file.close()
+
+if __name__ == "__main__":
+    if len(sys.argv) != 4:
+        sys.stderr.write("Usage: %s log.txt.gz start end > window.txt\n"
+                         % sys.argv[0])
+        sys.exit(1)
+    reader = ChunkedLogReader(sys.argv[1])
+    out = getattr(sys.stdout, 'buffer', sys.stdout)
+    out.write(reader.window(float(sys.argv[2]), float(sys.argv[3])))
+    reader.close()
@@ -0,0 +1,92 @@
+# Copyright (c) 2012, United States Government, as represented by the
+# Administrator of the National Aeronautics and Space Administration.
+# All rights reserved.
+#
+# The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+# under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# http://www.apache.org/licenses/LICENSE-2.0.
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+# either express or implied. See the License for the specific language
+# governing permissions and limitations under the License.
+
+import mmap
+import os
+import struct
+import sys
+import time
+
+class TelemetryReader:
+    """
+    Reads the live frames published by tgSharedMemoryDataManager.
+
+    The segment starts with a 40-byte header (magic, column count, size of
+    the column names, sequence number), then the frame of doubles, then
+    the column names. The sequence number is odd while the simulation is
+    writing a frame.
+    """
+
+    MAGIC = b"NTRT_TELEMETRY1"
+    HEADER = struct.Struct("=16sQQQ")
+
+    def __init__(self, name):
+        """
+        Maps a segment.
+
+        Parameters
+
+        name: The name passed to tgSharedMemoryDataManager.
+        """
+        fd = os.open(os.path.join("/dev/shm", name), os.O_RDONLY)
+        try:
+            self._map = mmap.mmap(fd, 0, access=mmap.ACCESS_READ)
+        finally:
+            os.close(fd)
+        magic, numColumns, namesSize, sequence = self.HEADER.unpack_from(self._map, 0)
+        if magic.rstrip(b"\0") != self.MAGIC:
+            raise ValueError("%s is not an NTRT telemetry segment" % name)
+        self._frame = struct.Struct("=" + "d" * numColumns)
+        namesStart = self.HEADER.size + self._frame.size
+        names = self._map[namesStart:namesStart + namesSize].decode('utf-8')
+        self.columns = names.split("\n")[:-1]
+
+    def _sequence(self):
+        return struct.unpack_from("=Q", self._map, 32)[0]
+
+    def read(self, maxTries=100):
+        """
+        Returns (sequence, frame) for the newest frame, where frame is a
+        tuple of floats in column order, or None if no frame has been
+        published yet or every try collided with a write.
+        """
+        for i in range(maxTries):
+            before = self._sequence()
+            if before == 0:
+                return None
+            if before % 2:
+                continue
+            frame = self._frame.unpack_from(self._map, self.HEADER.size)
+            if self._sequence() == before:
+                return before, frame
+        return None
+
+    def close(self):
+        self._map.close()
+
+if __name__ == "__main__":
+    if len(sys.argv) != 2:
+        sys.stderr.write("Usage: %s segmentName\n" % sys.argv[0])
+        sys.exit(1)
+    reader = TelemetryReader(sys.argv[1])
+    print(",".join(reader.columns))
+    lastSequence = None
+    while True:
+        latest = reader.read()
+        if latest is not None and latest[0] != lastSequence:
+            lastSequence = latest[0]
+            print(",".join(repr(value) for value in latest[1]))
+        time.sleep(0.1)
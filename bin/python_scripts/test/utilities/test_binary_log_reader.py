@@ -0,0 +1,52 @@
+# Copyright (c) 2012, United States Government, as represented by the
+# Administrator of the National Aeronautics and Space Administration.
+# All rights reserved.
+#
+# The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+# under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# http://www.apache.org/licenses/LICENSE-2.0.
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+# either express or implied. See the License for the specific language
+# governing permissions and limitations under the License.
+
+import os
+import struct
+import tempfile
+import unittest
+from src.utilities.binary_log_reader import *
+
+class TestBinaryLogReader(unittest.TestCase):
+
+    COLUMNS = ["time", "0_rod(t0).X", "0_rod(t0).Y"]
+
+    RECORDS = [(0.001, 1.0, 2.0), (0.002, 1.5, 2.5)]
+
+    def setUp(self):
+        handle, self.path = tempfile.mkstemp(suffix=".bin")
+        header = "\n".join([BinaryLogReader.MAGIC, "test log", "little", str(len(self.COLUMNS))] + self.COLUMNS) + "\n"
+        with os.fdopen(handle, 'wb') as f:
+            f.write(header.encode('utf-8'))
+            for record in self.RECORDS:
+                f.write(struct.pack("<ddd", *record))
+            # A truncated trailing record must be ignored
+            f.write(struct.pack("<d", 9.0))
+        self.reader = BinaryLogReader(self.path)
+
+    def tearDown(self):
+        self.reader.close()
+        os.remove(self.path)
+
+    def testHeader(self):
+        self.assertEqual(self.reader.description, "test log")
+        self.assertEqual(self.reader.columns, self.COLUMNS)
+
+    def testRecords(self):
+        self.assertEqual(self.reader.read(), self.RECORDS)
+
+    def testColumn(self):
+        self.assertEqual(self.reader.column("0_rod(t0).Y"), [2.0, 2.5])
@@ -25,9 +25,11 @@ ENV_DIR="${BASE_DIR}/env"
 SRC_DIR="${BASE_DIR}/src"
 TEST_DIR="${BASE_DIR}/test"
 INTEGRATION_TEST_DIR="${BASE_DIR}/test_integration"
+BENCH_DIR="${BASE_DIR}/bench"
 BUILD_DIR="${BASE_DIR}/build"
 BUILD_TEST_DIR="${BASE_DIR}/build_test"
 BUILD_INTEGRATION_TEST_DIR="${BASE_DIR}/build_test_integration"
+BUILD_BENCH_DIR="${BASE_DIR}/build_bench"
 
 SETUP_DIR="${BIN_DIR}/setup"
 SHELL_UTILITIES_DIR="${BIN_DIR}/utilities"
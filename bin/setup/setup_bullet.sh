@@ -156,6 +156,12 @@ function build_bullet()
     echo "- Building Bullet Physics under $BULLET_BUILD_DIR"
     pushd "$BULLET_BUILD_DIR" > /dev/null
 
+    # Multithreaded solving requires the profiler to be compiled out
+    bullet_cxx_flags="-fPIC"
+    if [ "$BULLET_NO_PROFILE" == "true" ]; then
+        bullet_cxx_flags="$bullet_cxx_flags -DBT_NO_PROFILE"
+    fi
+
     # Perform the build
     # If you turn double precision on, turn it on in inc.CMakeBullet.txt as well for the NTRT build
     "$ENV_DIR/bin/cmake" . -G "Unix Makefiles" \
@@ -163,7 +169,7 @@ function build_bullet()
         -DBUILD_EXTRAS=ON \
         -DCMAKE_INSTALL_PREFIX="$BULLET_INSTALL_PREFIX" \
         -DCMAKE_C_FLAGS="-fPIC" \
-        -DCMAKE_CXX_FLAGS="-fPIC" \
+        -DCMAKE_CXX_FLAGS="$bullet_cxx_flags" \
         -DCMAKE_C_COMPILER="gcc" \
         -DCMAKE_CXX_COMPILER="g++" \
         -DCMAKE_EXE_LINKER_FLAGS="-fPIC" \
@@ -1,14 +1,8 @@
 import logging
-import time
-import psutil
 import os
 
 class ConcurrentScheduler:
 
-    # Number of seconds to wait after spawning processes before
-    # querying PID list.
-    __CHECK_DELAY = 0.1
-
     def __init__(self, toProcess, numProcesses):
         self.numProcesses = numProcesses
         self.jobsUnprocessed = toProcess
@@ -34,22 +28,21 @@ class ConcurrentScheduler:
                 self.jobsProcessing.append(toRun)
                 toRun.startJob()
 
-            time.sleep(self.__CHECK_DELAY)
-
-            self.__checkProcesses()
+            self.__waitForProcess()
 
-    def __checkProcesses(self):
-        completed = []
+    def __waitForProcess(self):
+        """
+        Block until any child exits, so the next job starts as soon as a
+        process slot frees up rather than at the next poll.
+        """
+        childPid, status = os.waitpid(-1, 0)
 
         for activeProc in self.jobsProcessing:
-            proc = psutil.Process(activeProc.pid)
-            if proc.status() == psutil.STATUS_ZOMBIE:
-                logging.info("Process with ID %d is now a zombie process. Mark it as complete." % activeProc.pid)
-                completed.append(activeProc)
-                # Releasing the processID from each zombie process
-                childPid, status = os.waitpid(activeProc.pid, 0)
-                logging.info("Zombie process ID %d, with exit status %d, has been removed from the process table and can be reused." % (childPid, status))
-
-        for completeProc in completed:
-            self.jobsProcessing.remove(completeProc)
-            self.jobsComplete.append(completeProc)
+            if activeProc.pid == childPid:
+                logging.info("Process ID %d, with exit status %d, has been removed from the process table. Mark it as complete." % (childPid, status))
+                self.jobsProcessing.remove(activeProc)
+                self.jobsComplete.append(activeProc)
+                return
+
+        # Some other child of this script, nothing to do
+        logging.info("Reaped unrelated process ID %d." % childPid)
@@ -1,2 +1,3 @@
 from evolution_job_master import EvolutionJobMaster
 from evolution_job import EvolutionJob
+from fitness_cache import FitnessCache
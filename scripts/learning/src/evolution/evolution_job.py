@@ -5,7 +5,23 @@ import json
 import logging
 from interfaces import NTRTMasterError, NTRTJob
 
-
+def budgetOptions(budget):
+    """
+    The app options of a trial budget, a dict of the optional keys
+    'wallClock' (seconds per run), 'settleSpeed' (m/s) and 'settleTime'
+    (seconds below that speed), so a run ends inside the simulator
+    rather than by being killed. See tgSimulation::run(int).
+    """
+    if not budget:
+        return []
+    options = []
+    if 'wallClock' in budget:
+        options += ["-T", str(float(budget['wallClock']))]
+    if 'settleSpeed' in budget:
+        options += ["--settle_speed", str(float(budget['settleSpeed']))]
+    if 'settleTime' in budget:
+        options += ["--settle_time", str(float(budget['settleTime']))]
+    return options
 
 class EvolutionJob(NTRTJob):
 
@@ -50,16 +66,58 @@ class EvolutionJob(NTRTJob):
             if len(terrainMatrix[0]) < 4: 
                 raise NTRTMasterError("Not enough terrain args!")
             
+            if self.args.get('sweep', False):
+                # One process builds the model once and resets it to each terrain
+                requests = "\n".join(self.workerRequests()) + "\nquit\n"
+                options = budgetOptions(self.args.get('budget'))
+                proc = subprocess.Popen([self.args['executable'], "--worker"] + options, stdin=subprocess.PIPE, stdout=logFile)
+                proc.communicate(requests.encode("utf-8"))
+                if proc.returncode != 0:
+                    raise subprocess.CalledProcessError(proc.returncode, self.args['executable'])
+                sys.exit()
+
             # Run through a set of binary job options. Currently handles terrain switches
+            options = budgetOptions(self.args.get('budget'))
             for run in terrainMatrix:
-                if (len(run)) >= 5:
-                    trialLength = run[4]
-                else:
-                    trialLength = self.args['length']
+                trialLength = self.trialLength(run)
                 #TODO improve error handling here
-                subprocess.check_call([self.args['executable'], "-l", self.args['filename'], "-P", self.args['path'], "-s", str(trialLength), "-b", str(run[0]), "-H", str(run[1]), "-a", str(run[2]), "-B", str(run[3])], stdout=logFile)
+                subprocess.check_call([self.args['executable'], "-l", self.args['filename'], "-P", self.args['path'], "-s", str(trialLength), "-b", str(run[0]), "-H", str(run[1]), "-a", str(run[2]), "-B", str(run[3])] + options, stdout=logFile)
             sys.exit()
 
+    def trialLength(self, run):
+        """
+        The number of steps for one terrain run. A run may override the
+        configured length, and successive halving runs a fraction of it.
+        """
+        if (len(run)) >= 5:
+            trialLength = run[4]
+        else:
+            trialLength = self.args['length']
+        return max(1, int(trialLength * self.args.get('lengthFraction', 1.0)))
+
+    def workerRequests(self):
+        """
+        The same trials as startJob, as 'run' lines for a persistent worker,
+        or as one 'sweep' line if the job sweeps its terrains in one model.
+        See src/helpers/WorkerProtocol.h
+        """
+        terrainMatrix = self.args['terrain']
+        if len(terrainMatrix[0]) < 4:
+            raise NTRTMasterError("Not enough terrain args!")
+
+        for name in (self.args['filename'], self.args['path']):
+            if len(name) == 0 or len(name.split()) != 1:
+                raise NTRTMasterError("Worker file names can't be empty or contain spaces: '%s'" % name)
+
+        terrains = []
+        for run in terrainMatrix:
+            trialLength = self.trialLength(run)
+            terrains.append("%d %d %d %r %r" % (int(trialLength), int(run[0]), int(run[1]), float(run[2]), float(run[3])))
+
+        if self.args.get('sweep', False):
+            return ["sweep %s %s %s" % (self.args['filename'], self.args['path'], " ".join(terrains))]
+        return ["run %s %s %s" % (self.args['filename'], self.args['path'], terrain) for terrain in terrains]
+
     def processJobOutput(self):
         scoresPath = self.args['resourcePrefix'] + self.args['path'] + self.args['filename']
 
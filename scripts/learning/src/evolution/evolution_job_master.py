@@ -1,12 +1,17 @@
 import os
 import json
+import logging
+import math
 import random
 import collections
-from interfaces import NTRTJobMaster, NTRTMasterError
+from interfaces import NTRTJobMaster, NTRTMasterError, WorkerScheduler
 from concurrent_scheduler import ConcurrentScheduler
+from fitness_cache import FitnessCache
+from population_store import PopulationStore, ScoreCheckpoints
+from nnw_format import writeNNW
 import collections
 #TODO: This is hackety, fix it.
-from evolution_job import EvolutionJob
+from evolution_job import EvolutionJob, budgetOptions
 
 class LastUpdatedOrderedDict(collections.OrderedDict):
     'Store items in the order the keys were last added'
@@ -50,19 +55,13 @@ class EvolutionJobMaster(NTRTJobMaster):
         # Consider seeding random, using default (system time) now
         #random.seed(5)
 
-    def __writeToNNW(self, neuralParams, fileName):
+    def __writeToNNW(self, neuralParams, fileName, shape=(0, 0, 0)):
         """
         Take the params (neuralParams) and write them to a .nnw file for reading by
-        the neuralNetwork code (Third party library)
+        the neuralNetwork code (Third party library), or with "binaryWeights" in
+        the binary format that NeuralNetBatch maps, which neuralNetwork can't read
         """
-        fout = open(fileName, 'w')
-        first = True
-        for x in neuralParams:
-            if (first):
-                fout.write(str(x))
-                first = False
-            else:
-                fout.write("," + str(x))
+        writeNNW(neuralParams, fileName, self.jConf.get('binaryWeights', False), shape)
 
 
     def __getNewParams(self, paramName):
@@ -109,7 +108,8 @@ class EvolutionJobMaster(NTRTJobMaster):
 
             newParams['neuralParams'] = neuralParams
 
-            self.__writeToNNW(neuralParams, self.path + newParams['neuralFilename'])
+            self.__writeToNNW(neuralParams, self.path + newParams['neuralFilename'],
+                              (numStates, numHidden, numOutputs))
 
         newController['params'] = newParams
         newController['scores'] = []
@@ -239,6 +239,35 @@ class EvolutionJobMaster(NTRTJobMaster):
 
         return x['maxScore']
 
+    def __setProbabilities(self, sortedGeneration, scoreKey):
+        """
+        Give each controller of a ranked generation the cumulative
+        'probability' __getControllerFromProbability draws from: the sum
+        of the shares of the scores above the worst, down to its own
+        """
+        for controller in sortedGeneration.itervalues():
+            pass
+
+        floor = controller[scoreKey]
+
+        totalScore = 0
+        for controller in sortedGeneration.itervalues():
+            totalScore += controller[scoreKey] - floor
+
+        # All scores are the same for some reason, don't divide by zero
+        if totalScore == 0.0:
+            totalScore = 1
+
+        first = True
+        c1 = {}
+        for c in sortedGeneration.itervalues():
+            if first:
+                c['probability'] = (c[scoreKey] - floor) / totalScore
+                first = False
+            else:
+                c['probability'] = (c[scoreKey] - floor) / totalScore + c1['probability']
+            c1 = c
+
     def generationGenerator(self, currentGeneration, paramName):
         """
         Master function that takes an existing set of paramters, sorts them by score
@@ -251,7 +280,7 @@ class EvolutionJobMaster(NTRTJobMaster):
 
         useAvg = params['useAverage']
 
-        nextGeneration = LastUpdatedOrderedDict()
+        nextGeneration = PopulationStore()
 
         # Are we doing monteCarlo or starting a new trial?
         if (len(currentGeneration) == 0 or params['monteCarlo']):
@@ -298,13 +327,7 @@ class EvolutionJobMaster(NTRTJobMaster):
 
             popSize = len(currentGeneration)
 
-            # order the prior population
-
-            for k, controller in currentGeneration.iteritems() :
-                scores = controller['scores']
-                controller['maxScore'] = max(scores)
-                controller['avgScore'] = sum(scores) / float(len(scores))
-
+            # order the prior population, whose score summaries the store kept current
 
             if (useAvg):
                 key = lambda x: x[1]['avgScore']
@@ -312,61 +335,10 @@ class EvolutionJobMaster(NTRTJobMaster):
                 key = lambda x: x[1]['maxScore']
             sortedGeneration = collections.OrderedDict(sorted(currentGeneration.items(), None, key, True))
 
-            scoreDump = open('scoreDump.txt', 'a')
-            scoreDump.write(json.dumps(sortedGeneration))
-            scoreDump.write('\n')
-            scoreDump.close()
-
-            totalScore = 0
+            self.__dumpScores(sortedGeneration)
 
             # Get probabilities for children (for mating)
-
-            if (useAvg):
-
-                for controller in sortedGeneration.itervalues():
-                    pass
-
-                floor = controller['avgScore']
-
-                for controller in sortedGeneration.itervalues():
-                    totalScore += controller['avgScore'] - floor
-
-                first = True
-                c1 = {}
-
-                # All scores are the same for some reason, don't divide by zero
-                if totalScore == 0.0:
-                    totalScore = 1
-
-                for c in sortedGeneration.itervalues():
-                    if first:
-                        c['probability'] = (c['avgScore'] - floor) / totalScore
-                        first = False
-                    else:
-                        c['probability'] = (c['avgScore'] - floor) / totalScore + c1['probability']
-                    c1 = c
-
-            else:
-                for controller in sortedGeneration.itervalues():
-                    pass
-
-                floor = controller['maxScore']
-
-                for controller in sortedGeneration.itervalues():
-                    totalScore += controller['maxScore'] - floor
-
-                first = True
-                c1 = {}
-                # All scores are the same for some reason, don't divide by zero
-                if totalScore == 0.0:
-                    totalScore = 1
-                for c in sortedGeneration.itervalues():
-                    if first:
-                        c['probability'] = (c['maxScore'] - floor) / totalScore
-                        first = False
-                    else:
-                        c['probability'] = (c['maxScore'] - floor) / totalScore + c1['probability']
-                    c1 = c
+            self.__setProbabilities(sortedGeneration, 'avgScore' if useAvg else 'maxScore')
 
             # How many of the best controllers are we keeping?
             numElites = popSize - (params['numberToMutate'] + params['numberOfChildren'])
@@ -439,7 +411,8 @@ class EvolutionJobMaster(NTRTJobMaster):
             if (params['numberOfStates'] > 0):
                 for c in nextGeneration.itervalues():
                     c['params']['neuralFilename'] = "logs/bestParameters-test_fb-"+ c['paramID'] +".nnw"
-                    self.__writeToNNW(c['params']['neuralParams'], self.path + c['params']['neuralFilename'])
+                    self.__writeToNNW(c['params']['neuralParams'], self.path + c['params']['neuralFilename'],
+                                      (params['numberOfStates'], params['numberHidden'], params['numberOfOutputs']))
 
         return nextGeneration
 
@@ -448,7 +421,7 @@ class EvolutionJobMaster(NTRTJobMaster):
         Get the controller's key based on the job number
         """
         try:
-            return list(gen)[jobNum]
+            return gen.keyAt(jobNum)
         except IndexError:
             print 'Not enough keys'
 
@@ -457,6 +430,7 @@ class EvolutionJobMaster(NTRTJobMaster):
         Handle the generation of a new JSON file with new parameters. Will vary based on the
         learning method used and the config file
         Edit this based on your parameter set
+        The file is only written by writeFile, once a job is to read it
         """
 
         obj = {}
@@ -472,13 +446,37 @@ class EvolutionJobMaster(NTRTJobMaster):
 
 	obj["metrics"] = [] # Added to store tension and COM data. 
         
-	outFile = self.path + self.jConf['filePrefix'] + "_" + str(jobNum) + self.jConf['fileSuffix']
+        fileName = self.jConf['filePrefix'] + "_" + str(jobNum) + self.jConf['fileSuffix']
 
-        fout = open(outFile, 'w')
+        # Until a job needs it. The fitness cache keys the file by its parameters
+        self.unwrittenFiles[fileName] = obj
+        self.lastFileObject = obj
 
-        json.dump(obj, fout, indent=4)
+        return fileName
 
-        return self.jConf['filePrefix'] + "_" + str(jobNum) + self.jConf['fileSuffix']
+    def writeFile(self, fileName):
+        """
+        Write the file getNewFile made, compactly since only the controller reads it
+        """
+        obj = self.unwrittenFiles.pop(fileName, None)
+        if obj is None:
+            return
+        fout = open(self.path + fileName, 'w')
+        json.dump(obj, fout, separators=(',', ':'))
+        fout.close()
+
+    def __dumpScores(self, sortedGeneration):
+        """
+        Record the ranked generation; as binary checkpoints unless the
+        config sets "scoreDump" : "json" for the JSON lines of scoreDump.txt
+        """
+        if self.scoreCheckpoints is not None:
+            self.scoreCheckpoints.append(sortedGeneration)
+        else:
+            scoreDump = open('scoreDump.txt', 'a')
+            scoreDump.write(json.dumps(sortedGeneration))
+            scoreDump.write('\n')
+            scoreDump.close()
     
     def getJobNum(self, paramNum, paramName):
 
@@ -488,6 +486,269 @@ class EvolutionJobMaster(NTRTJobMaster):
 
         return i
     
+    def __jobArgs(self, fileName, terrain):
+        # All args to be passed to subprocess must be strings
+        return {'filename' : fileName,
+                'resourcePrefix' : self.jConf['resourcePath'],
+                'path'     : self.jConf['lowerPath'],
+                'executable' : self.jConf['executable'],
+                'length'   : self.jConf['learningParams']['trialLength'],
+                'sweep'    : self.jConf.get('terrainSweep', False),
+                'budget'   : self.jConf.get('trialBudget'),
+                'terrain'  : terrain}
+
+    def __runJobs(self, jobList, workers):
+        if workers is not None:
+            return workers.processJobs(jobList)
+        conSched = ConcurrentScheduler(jobList, self.numProcesses)
+        return conSched.processJobs()
+
+    def __scoresPath(self, job):
+        return job.args['resourcePrefix'] + job.args['path'] + job.args['filename']
+
+    def __meanDistance(self, fileName):
+        try:
+            fin = open(fileName, 'r')
+            scores = json.load(fin)['scores']
+            fin.close()
+        except (IOError, KeyError, ValueError):
+            return -1.0
+        if len(scores) == 0:
+            return -1.0
+        return sum(i['distance'] for i in scores) / float(len(scores))
+
+    def __clearScores(self, fileName):
+        # The controllers append to 'scores', keep only the next rung's
+        try:
+            fin = open(fileName, 'r')
+            obj = json.load(fin)
+            fin.close()
+        except (IOError, ValueError):
+            return
+        obj['scores'] = []
+        fout = open(fileName, 'w')
+        json.dump(obj, fout, indent=4)
+        fout.close()
+
+    def __cacheParams(self, jobVals):
+        params = []
+        for p in sorted(self.prefixes):
+            FitnessCache.flatten(jobVals[p + 'Vals']['params'], params)
+        return params
+
+    def successiveHalving(self, jobList, workers):
+        """
+        Run the generation's jobs at 1/eta**(rungs-1) of their trial length,
+        rerun the best 1/eta of the controllers at eta times that length, and
+        so on until the survivors run the full length. Candidates are the
+        controller files, so every terrain job of a file is promoted or
+        dropped together. A dropped file keeps the scores of its last,
+        shorter rung, which rank below full length scores in most runs;
+        only the ranking matters to generationGenerator. Configured by
+        learningParams['successiveHalving'] = {"eta" : 3, "rungs" : 3}.
+        """
+        shConf = self.jConf['learningParams']['successiveHalving']
+        eta = shConf.get('eta', 3)
+        rungs = shConf.get('rungs', 3)
+
+        candidates = list(jobList)
+        del jobList[:]
+        finalJobs = []
+
+        for rung in range(rungs):
+            fraction = 1.0 / (eta ** (rungs - 1 - rung))
+            files = []
+            for job in candidates:
+                job.args['lengthFraction'] = fraction
+                fileName = self.__scoresPath(job)
+                if fileName not in files:
+                    files.append(fileName)
+            for fileName in files:
+                self.__clearScores(fileName)
+
+            completed = self.__runJobs(list(candidates), workers)
+
+            if rung == rungs - 1:
+                finalJobs += completed
+                break
+
+            files.sort(key=self.__meanDistance, reverse=True)
+            keep = set(files[:max(1, int(math.ceil(len(files) / float(eta))))])
+            candidates = []
+            for job in completed:
+                if self.__scoresPath(job) in keep:
+                    candidates.append(job)
+                else:
+                    finalJobs.append(job)
+
+            logging.info("Successive halving rung %d: promoting %d of %d controllers." % (rung, len(keep), len(files)))
+
+        return finalJobs
+
+    def __score(self, controller, scoreKey):
+        return controller.get(scoreKey, float('-inf'))
+
+    def __breedController(self, population, paramName):
+        """
+        One new controller bred from the population as it stands, for
+        steadyState: a child of two controllers drawn by their scores, as
+        generationGenerator makes numberOfChildren of, or a mutation of
+        one drawn the same way, in proportion to numberToMutate
+        """
+        params = self.jConf["learningParams"][paramName]
+        scoreKey = 'avgScore' if params['useAverage'] else 'maxScore'
+        key = lambda x: self.__score(x[1], scoreKey)
+        sortedGeneration = collections.OrderedDict(sorted(population.items(), None, key, True))
+        self.__setProbabilities(sortedGeneration, scoreKey)
+
+        numBred = params['numberToMutate'] + params['numberOfChildren']
+        c1 = self.__getControllerFromProbability(sortedGeneration, random.random())
+        cNew = {}
+        if len(sortedGeneration) > 1 and random.random() * numBred < params['numberOfChildren']:
+            c2 = self.__getControllerFromProbability(sortedGeneration, random.random())
+            if c2 is c1:
+                c2 = random.choice([c for c in sortedGeneration.itervalues() if c is not c1])
+            cNew['params'] = self.__getChildController(c1['params'], c2['params'], params)
+
+            if (random.random() >= params['childMutationChance']):
+                cNew['params'] = self.__mutateParams(cNew['params'], paramName)
+        else:
+            cNew['params'] = self.__mutateParams(c1['params'], paramName)
+
+        cNew['paramID'] = str(self.paramID)
+        cNew['scores'] = []
+        self.paramID += 1
+
+        if (params['numberOfStates'] > 0):
+            cNew['params']['neuralFilename'] = "logs/bestParameters-test_fb-"+ cNew['paramID'] +".nnw"
+            self.__writeToNNW(cNew['params']['neuralParams'], self.path + cNew['params']['neuralFilename'],
+                              (params['numberOfStates'], params['numberHidden'], params['numberOfOutputs']))
+
+        return cNew
+
+    def __insertController(self, population, controller, paramName):
+        """
+        Put a scored controller in the place of the worst of the population
+        if it scores better. Returns whether it did.
+        """
+        if len(controller['scores']) == 0:
+            return False
+        params = self.jConf["learningParams"][paramName]
+        scoreKey = 'avgScore' if params['useAverage'] else 'maxScore'
+        controller['maxScore'] = max(controller['scores'])
+        controller['avgScore'] = sum(controller['scores']) / float(len(controller['scores']))
+
+        worst = min(population, key=lambda k: self.__score(population[k], scoreKey))
+        if self.__score(controller, scoreKey) <= self.__score(population[worst], scoreKey):
+            return False
+        del population[worst]
+        population[controller['paramID']] = controller
+        return True
+
+    def __nextSteadyJob(self):
+        """
+        The next job for processStream, breeding a controller file whenever
+        the jobs of the last one are handed out
+        """
+        if len(self.steadyJobs) == 0:
+            if self.steadyBred == self.steadyTotal:
+                return None
+            self.steadyBred += 1
+
+            lParams = self.jConf['learningParams']
+            obj = {}
+            for p in self.prefixes:
+                population = self.currentGeneration[p]
+                if lParams[p + 'Vals']['learning']:
+                    obj[p + 'Vals'] = self.__breedController(population, p + 'Vals')
+                else:
+                    obj[p + 'Vals'] = population[population.keyAt(random.randint(0, len(population) - 1))]
+            obj["metrics"] = []
+
+            # A file per controller in flight, reused once it is scored
+            if len(self.steadyNames) > 0:
+                fileName = self.steadyNames.pop()
+            else:
+                fileName = self.jConf['filePrefix'] + "_steady" + str(len(self.steadyFiles)) + self.jConf['fileSuffix']
+            self.unwrittenFiles[fileName] = obj
+            self.writeFile(fileName)
+
+            self.steadyFiles[fileName] = {'obj' : obj, 'jobs' : len(self.jConf['terrain']), 'dropped' : False}
+            for j in self.jConf['terrain']:
+                self.steadyJobs.append(EvolutionJob(self.__jobArgs(fileName, j)))
+
+        return self.steadyJobs.pop(0)
+
+    def __steadyJobDone(self, job, finished):
+        """
+        Score a controller file once all its jobs are done, unless one was
+        dropped, and log every numTrials files as a generation
+        """
+        lParams = self.jConf['learningParams']
+        fileName = job.args['filename']
+        entry = self.steadyFiles[fileName]
+        entry['jobs'] -= 1
+        if not finished:
+            entry['dropped'] = True
+        if entry['jobs'] > 0:
+            return
+        self.steadyNames.append(fileName)
+        del self.steadyFiles[fileName]
+        if entry['dropped']:
+            logging.warning("Dropped %s, a job ran over trialTimeLimit." % fileName)
+            return
+
+        # Every job of the file appended its scores to it
+        job.processJobOutput()
+        distances = [i['distance'] for i in job.obj.get('scores', [])]
+        for p in self.prefixes:
+            if lParams[p + 'Vals']['learning']:
+                controller = entry['obj'][p + 'Vals']
+                controller['scores'] = list(distances)
+                self.__insertController(self.currentGeneration[p], controller, p + 'Vals')
+
+        for score in distances:
+            self.steadyLog['total'] += score
+            self.steadyLog['count'] += 1
+            if score > self.steadyLog['max']:
+                self.steadyLog['max'] = score
+
+        self.steadyLog['files'] += 1
+        if self.steadyLog['files'] % lParams['numTrials'] == 0 and self.steadyLog['count'] > 0:
+            self.steadyLog['generation'] += 1
+            for p in self.prefixes:
+                if lParams[p + 'Vals']['learning']:
+                    scoreKey = 'avgScore' if lParams[p + 'Vals']['useAverage'] else 'maxScore'
+                    key = lambda x: self.__score(x[1], scoreKey)
+                    self.__dumpScores(collections.OrderedDict(sorted(self.currentGeneration[p].items(), None, key, True)))
+            logFile = open('evoLog.txt', 'a')
+            logFile.write(str(self.steadyLog['generation'] * lParams['numTrials']) + ',' + str(self.steadyLog['max']) + ',' +
+                          str(self.steadyLog['total'] / self.steadyLog['count']) + '\n')
+            logFile.close()
+            self.steadyLog.update({'total' : 0.0, 'count' : 0, 'max' : -1000})
+
+    def steadyState(self, workers, numControllers):
+        """
+        Breed and run controllers one at a time, as workers free up, rather
+        than a generation at a time, so no worker waits on the slowest
+        trial of a generation. Each new controller is bred from the
+        populations as they stand and takes the place of the worst
+        controller if it scores better. Set learningParams['steadyState']
+        to true, with persistent workers; the first generation still runs
+        as a whole. Every numTrials controllers count as a generation in
+        evoLog.txt and the score dump. With "trialTimeLimit" (seconds) a
+        controller whose jobs run longer is dropped, not retried. The
+        fitness cache and successive halving are generational only.
+        """
+        self.steadyTotal = numControllers
+        self.steadyBred = 0
+        self.steadyJobs = []
+        self.steadyFiles = {}
+        self.steadyNames = []
+        self.steadyLog = {'generation' : 1, 'files' : 0, 'total' : 0.0, 'count' : 0, 'max' : -1000}
+        workers.processStream(self.__nextSteadyJob, self.__steadyJobDone,
+                              self.jConf.get('trialTimeLimit'))
+
     def beginTrial(self):
         """
         Override this. It should just contain a loop where you keep constructing NTRTJobs, then calling
@@ -516,14 +777,46 @@ class EvolutionJobMaster(NTRTJobMaster):
         
         self.currentGeneration = {}
         for p in self.prefixes:
-            self.currentGeneration[p] = {}
+            self.currentGeneration[p] = PopulationStore()
+
+        # Files of skipped jobs, written when the run ends
+        self.unwrittenFiles = {}
 
         logFile = open('evoLog.txt', 'w') #Clear logfile
         logFile.close()
 
-        scoreDump = open('scoreDump.txt', 'w')
-        scoreDump.close()
-        for n in range(numGenerations):
+        if self.jConf.get('scoreDump', 'binary') == 'json':
+            self.scoreCheckpoints = None
+            scoreDump = open('scoreDump.txt', 'w')
+            scoreDump.close()
+        else:
+            self.scoreCheckpoints = ScoreCheckpoints('scoreDump.pkl')
+
+        # Optionally keep one simulator process per core for the whole run,
+        # on this machine or on the nodes listed in workerHosts
+        workers = None
+        if self.jConf.get('persistentWorkers', False) or 'workerHosts' in self.jConf:
+            workers = WorkerScheduler(self.jConf['executable'], self.numProcesses,
+                                      hosts=self.jConf.get('workerHosts'),
+                                      trialTimeout=self.jConf.get('trialTimeout'),
+                                      maxRetries=self.jConf.get('maxRetries', 2),
+                                      options=budgetOptions(self.jConf.get('trialBudget')))
+
+        # Optionally skip controllers that were already simulated
+        cache = None
+        if 'fitnessCache' in lParams:
+            cConf = lParams['fitnessCache']
+            cache = FitnessCache(resolution=cConf.get('resolution', 1e-6),
+                                 capacity=cConf.get('capacity', 10000),
+                                 neighbors=cConf.get('neighbors', 0),
+                                 quantile=cConf.get('quantile', 0.25))
+
+        # After the first generation, optionally go on without generations
+        steady = lParams.get('steadyState', False)
+        if steady and workers is None:
+            raise NTRTMasterError("steadyState needs persistentWorkers")
+
+        for n in range(1 if steady else numGenerations):
             # Create the generation'
             for p in self.prefixes:
                 self.currentGeneration[p] = self.generationGenerator(self.currentGeneration[p], p + 'Vals')
@@ -534,55 +827,99 @@ class EvolutionJobMaster(NTRTJobMaster):
             else:
                 startTrial = 0
 
+            # (file contents, distances) of the files the cache answered, and
+            # (file contents, file) of those repeating a file simulated now
+            cachedFiles = []
+            twinFiles = []
+            simulatedKeys = {}
+
             # We want to write all of the trials for post processing
             for i in range(0, numTrials) :
 
                 # MonteCarlo solution. This function could be overridden with something that
                 # provides a filename for a pre-existing file
                 fileName = self.getNewFile(i)
+
+                if cache is not None and (n == 0 or i >= startTrial):
+                    params = self.__cacheParams(self.lastFileObject)
+                    screened = cache.screen(params)
+                    if screened is not None:
+                        if len(screened) == 1:
+                            # A prediction stands for every terrain's score
+                            screened = screened * len(self.jConf['terrain'])
+                        cachedFiles.append((self.lastFileObject, screened))
+                        continue
+                    key = cache.key(params)
+                    if key in simulatedKeys:
+                        twinFiles.append((self.lastFileObject, simulatedKeys[key]))
+                        continue
+                    simulatedKeys[key] = fileName
                 
                 for j in self.jConf['terrain']:
-                    # All args to be passed to subprocess must be strings
-                                  
-                    args = {'filename' : fileName,
-                            'resourcePrefix' : self.jConf['resourcePath'],
-                            'path'     : self.jConf['lowerPath'],
-                            'executable' : self.jConf['executable'],
-                            'length'   : self.jConf['learningParams']['trialLength'],
-                            'terrain'  : j}
                     if (n == 0 or i >= startTrial):
-                        jobList.append(EvolutionJob(args))
+                        self.writeFile(fileName)
+                        jobList.append(EvolutionJob(self.__jobArgs(fileName, j)))
 
             # Run the jobs
-            conSched = ConcurrentScheduler(jobList, self.numProcesses)
-            completedJobs = conSched.processJobs()
+            if 'successiveHalving' in lParams:
+                completedJobs = self.successiveHalving(jobList, workers)
+            else:
+                completedJobs = self.__runJobs(jobList, workers)
 
-            # Read scores from files, write to logs
-            totalScore = 0
-            maxScore = -1000
+            # Read scores from files, as (file contents, distances)
+            results = []
+            fileDistances = {}
+            fullLength = set()
             for job in completedJobs:
                 job.processJobOutput()
-                jobVals = job.obj
-
-                scores = jobVals['scores']
-                
-                             
+                distances = [i['distance'] for i in job.obj['scores']]
+                results.append((job.obj, distances))
+                fileDistances[job.args['filename']] = (job.obj, distances)
+                # Rungs of successive halving shorter than the trial aren't cached
+                if job.args.get('lengthFraction', 1.0) == 1.0:
+                    fullLength.add(job.args['filename'])
+
+            if cache is not None:
+                for fileName in fullLength:
+                    jobVals, distances = fileDistances[fileName]
+                    cache.insert(self.__cacheParams(jobVals), distances)
+                for jobVals, fileName in twinFiles:
+                    if fileName in fileDistances:
+                        cachedFiles.append((jobVals, fileDistances[fileName][1]))
+                # As each of the file's terrain jobs would have read them
+                for jobVals, distances in cachedFiles:
+                    for j in self.jConf['terrain']:
+                        results.append((jobVals, distances))
+                logging.info("Fitness cache: %d files simulated, %d skipped." % (len(fileDistances), len(cachedFiles)))
+
+            # Write to logs
+            totalScore = 0
+            maxScore = -1000
+            for jobVals, distances in results:
 
                 # Iterate through all of the new scores for this file
-                for i in scores:
-                    score = i['distance']
+                for score in distances:
                     
                     for p in self.prefixes:
                         if (lParams[p + 'Vals']['learning']):
                             key = jobVals [p + 'Vals']['paramID']
-                            self.currentGeneration[p][key]['scores'].append(score)
+                            self.currentGeneration[p].addScore(key, score)
 
                     totalScore += score
                     if score > maxScore:
                         maxScore = score
 
-            avgScore = totalScore / float(len(completedJobs) * len(self.jConf['terrain']) )
+            avgScore = totalScore / float(len(results) * len(self.jConf['terrain']) )
             logFile = open('evoLog.txt', 'a')
             logFile.write(str((n+1) * numTrials) + ',' + str(maxScore) + ',' + str(avgScore) +'\n')
             logFile.close()
 
+        if steady:
+            self.steadyState(workers, (numGenerations - 1) * numTrials)
+
+        if workers is not None:
+            workers.close()
+
+        # Leave every controller file of the last generation, as if all had run
+        for fileName in self.unwrittenFiles.keys():
+            self.writeFile(fileName)
@@ -0,0 +1,110 @@
+import collections
+import math
+
+class FitnessCache:
+    """
+    The scores of the controllers a learning run has already simulated, so
+    the master can skip files it would only repeat: elites carried into the
+    next generation, children of identical parents, or mutations too small
+    to matter. Parameter vectors are quantized to multiples of resolution;
+    repeated simulations of one vector are averaged per score.
+
+    With neighbors > 0, screen() also predicts the mean score of a new
+    vector from its nearest cached vectors (inverse distance weighted), and
+    returns the prediction instead of None when it falls below the given
+    quantile of the cached means, so clearly poor candidates are not
+    simulated. Only meaningful for deterministic trials. Configured by
+    learningParams['fitnessCache'] = {"resolution" : 1e-6, "capacity" : 10000,
+    "neighbors" : 0, "quantile" : 0.25}. The C++ class is util/FitnessCache.
+    """
+
+    def __init__(self, resolution=1e-6, capacity=10000, neighbors=0, quantile=0.25):
+        if resolution <= 0 or capacity <= 0:
+            raise ValueError("Resolution and capacity must be positive")
+        self.resolution = resolution
+        self.capacity = capacity
+        self.neighbors = neighbors
+        self.quantile = quantile
+        # key -> [params, scores, count], oldest first
+        self.entries = collections.OrderedDict()
+
+    @staticmethod
+    def flatten(value, out=None):
+        """
+        The numbers of a controller's parameters in a fixed order: dicts by
+        sorted key, lists in order. Strings such as file names are skipped.
+        """
+        if out is None:
+            out = []
+        if isinstance(value, (int, float)):
+            out.append(float(value))
+        elif isinstance(value, dict):
+            for k in sorted(value):
+                FitnessCache.flatten(value[k], out)
+        elif isinstance(value, (list, tuple)):
+            for v in value:
+                FitnessCache.flatten(v, out)
+        return out
+
+    def key(self, params):
+        return tuple(int(math.floor(p / self.resolution + 0.5)) for p in params)
+
+    def find(self, params):
+        entry = self.entries.get(self.key(params))
+        if entry is None:
+            return None
+        return list(entry[1])
+
+    def insert(self, params, scores):
+        """ Record the scores of one simulation of params """
+        k = self.key(params)
+        entry = self.entries.get(k)
+        if entry is not None:
+            entry[2] += 1
+            n = min(len(entry[1]), len(scores))
+            entry[1] = [entry[1][i] + (scores[i] - entry[1][i]) / entry[2] for i in range(n)]
+            return
+        if len(self.entries) >= self.capacity:
+            self.entries.popitem(last=False)
+        self.entries[k] = [list(params), [float(s) for s in scores], 1]
+
+    def predict(self, params):
+        """ The predicted mean score of params, or None with too few neighbours """
+        k = self.neighbors
+        candidates = [e for e in self.entries.values() if e[1] and len(e[0]) == len(params)]
+        if k <= 0 or len(candidates) < k:
+            return None
+        distances = []
+        for e in candidates:
+            d = math.sqrt(sum((a - b) ** 2 for a, b in zip(e[0], params)))
+            distances.append((d, sum(e[1]) / len(e[1])))
+        distances.sort(key=lambda x: x[0])
+        weights = 0.0
+        total = 0.0
+        for d, score in distances[:k]:
+            if d < self.resolution:
+                return score
+            weights += 1.0 / d
+            total += score / d
+        return total / weights
+
+    def cutoff(self):
+        means = sorted(sum(e[1]) / len(e[1]) for e in self.entries.values() if e[1])
+        if not means:
+            return None
+        q = max(0.0, min(1.0, self.quantile))
+        return means[int(q * (len(means) - 1))]
+
+    def screen(self, params):
+        """
+        Return the cached scores of params, a one element list holding the
+        predicted score of a likely poor candidate, or None if params has to
+        be simulated.
+        """
+        scores = self.find(params)
+        if scores is not None:
+            return scores
+        predicted = self.predict(params)
+        if predicted is not None and predicted < self.cutoff():
+            return [predicted]
+        return None
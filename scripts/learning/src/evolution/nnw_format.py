@@ -0,0 +1,54 @@
+import struct
+import sys
+from array import array
+
+MAGIC = b'NTRTNNW\0'
+VERSION = 1
+# version, inputs, hidden, outputs, count, in native byte order
+HEADER = struct.Struct('=IiiiQ')
+
+def writeNNW(values, fileName, binary=False, shape=(0, 0, 0)):
+    """
+    Write weights or parameters as the comma separated text neuralNetwork
+    reads, or if binary in the format NeuralNetWeights maps, with shape
+    the input, hidden and output layer sizes of a network
+    """
+    fout = open(fileName, 'wb' if binary else 'w')
+    if binary:
+        fout.write(MAGIC)
+        fout.write(HEADER.pack(VERSION, shape[0], shape[1], shape[2], len(values)))
+        array('d', values).tofile(fout)
+    else:
+        fout.write(",".join(repr(float(x)) for x in values))
+    fout.close()
+
+def readNNW(fileName):
+    """ Return (values, shape) of a file of either format """
+    fin = open(fileName, 'rb')
+    contents = fin.read()
+    fin.close()
+    if not contents.startswith(MAGIC):
+        values = [float(x) for x in contents.replace(b'\n', b',').split(b',') if x.strip()]
+        return values, (0, 0, 0)
+
+    start = len(MAGIC) + HEADER.size
+    version, inputs, hidden, outputs, count = HEADER.unpack(contents[len(MAGIC):start])
+    if version != VERSION:
+        raise ValueError("Unsupported version or byte order of " + fileName)
+    values = array('d')
+    values.fromstring(contents[start:])
+    if len(values) != count:
+        raise ValueError("Wrong length of " + fileName)
+    return list(values), (inputs, hidden, outputs)
+
+if __name__ == "__main__":
+    # Convert to the other format, e.g.
+    #     python nnw_format.py bestParameters-1_fb-3.nnw weights.nnb
+    if len(sys.argv) != 3:
+        print("Usage: python nnw_format.py <input .nnw> <output .nnw>")
+        sys.exit(1)
+    fin = open(sys.argv[1], 'rb')
+    binary = not fin.read(len(MAGIC)) == MAGIC
+    fin.close()
+    values, shape = readNNW(sys.argv[1])
+    writeNNW(values, sys.argv[2], binary, shape)
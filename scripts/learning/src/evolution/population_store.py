@@ -0,0 +1,101 @@
+import collections
+import json
+import sys
+try:
+    import cPickle as pickle
+except ImportError:
+    import pickle
+
+class PopulationStore(collections.OrderedDict):
+    """
+    One generation of controllers of one parameter prefix, keyed by paramID
+    in the order they were last added. addScore() keeps each controller's
+    'maxScore' and 'avgScore' current as the scores come in, so ranking a
+    generation needs no pass over the score lists, and keyAt() finds the
+    n'th key without copying all of them for every job.
+    """
+
+    def __init__(self, *args, **kwds):
+        self.__keys = None
+        self.__sums = {}
+        collections.OrderedDict.__init__(self, *args, **kwds)
+
+    def __setitem__(self, key, value):
+        if key in self:
+            del self[key]
+        collections.OrderedDict.__setitem__(self, key, value)
+        self.__keys = None
+
+        # Elites bring the scores of earlier generations along
+        scores = value.get('scores', [])
+        self.__sums[key] = sum(scores)
+        if len(scores) > 0:
+            value['maxScore'] = max(scores)
+            value['avgScore'] = self.__sums[key] / float(len(scores))
+
+    def __delitem__(self, key):
+        collections.OrderedDict.__delitem__(self, key)
+        self.__keys = None
+        del self.__sums[key]
+
+    def addScore(self, key, score):
+        """ Append a score of the controller and update its summary """
+        controller = self[key]
+        scores = controller['scores']
+        scores.append(score)
+        self.__sums[key] += score
+        if len(scores) == 1 or score > controller['maxScore']:
+            controller['maxScore'] = score
+        controller['avgScore'] = self.__sums[key] / float(len(scores))
+
+    def keyAt(self, index):
+        if self.__keys is None:
+            self.__keys = list(self)
+        return self.__keys[index]
+
+class ScoreCheckpoints:
+    """
+    The ranked generations of a learning run, appended to one file as a
+    binary pickle each, which costs far less than a JSON dump of every
+    controller. export() writes them in the JSON lines format of the old
+    scoreDump.txt when that is wanted, e.g.
+
+        python population_store.py scoreDump.pkl scoreDump.txt
+    """
+
+    def __init__(self, path):
+        self.path = path
+        open(self.path, 'wb').close()
+
+    def append(self, sortedGeneration):
+        fout = open(self.path, 'ab')
+        pickle.dump(sortedGeneration.items(), fout, pickle.HIGHEST_PROTOCOL)
+        fout.close()
+
+    @staticmethod
+    def read(path):
+        """ Yield each checkpointed generation as an OrderedDict """
+        fin = open(path, 'rb')
+        try:
+            while True:
+                try:
+                    items = pickle.load(fin)
+                except EOFError:
+                    break
+                yield collections.OrderedDict(items)
+        finally:
+            fin.close()
+
+    @staticmethod
+    def export(path, jsonPath):
+        fout = open(jsonPath, 'w')
+        for generation in ScoreCheckpoints.read(path):
+            fout.write(json.dumps(generation))
+            fout.write('\n')
+        fout.close()
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        print("Usage: python population_store.py <checkpoints> <json lines output>")
+        sys.exit(1)
+    ScoreCheckpoints.export(sys.argv[1], sys.argv[2])
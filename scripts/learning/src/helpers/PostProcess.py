@@ -23,13 +23,8 @@
 # Date:    March 2015
 
 import sys
-import os
-import subprocess
-import json
-import random
 import logging
-import collections
-import operator
+import leaderboard
 
 
 if __name__ == "__main__":
@@ -44,72 +39,25 @@ if __name__ == "__main__":
     else:
         numScore = 1
 
-    scoreSum = 0
-    fileSum = 0
-    maxScore = -1000
-    topScore = []
-    topParam = []
-
-    paramList = []
-
-    paramVals = paramType + 'Vals'
-
-    for i in range(0, numFiles):
-        scoresPath = configFile + str(i) +'.json'
-        fin = open(scoresPath, 'r')
-        obj = json.load(fin)
-        fin.close()
-        try:
-            paramID = obj[paramVals]['paramID']  
-
-            if (paramList.count(paramID) == 0):
-                # Use this for processing monteCarlo
-                 
-                thisScore = 0
-                for k in range(0, 4):
-                    try:
-                        thisScore += float(obj['scores'][k]['distance'])
-                    except IndexError:
-                        thisScore += 0
-                """
-                
-                thisScore = float(obj[paramVals]['avgScore'])
-                """
-                fileSum += 1
-                paramList.append(paramID)
-            """
-            else:
-                print(str(i) + " " +str(paramID) + " " + str(paramList.count(paramID)))
-                thisScore = 0
-            """
-        except KeyError:
-            print(str(i) + " " + str(KeyError))
-            thisScore =  0
-
-        if(thisScore > maxScore):
-            j = min([numScore, len(topScore)])
-            # Sort into position
-            while j > 0:
-                if thisScore > topScore[j - 1]:
-                    j -= 1
-                else:
-                    break
-
-            topScore.insert(j, thisScore)
-            topParam.insert(j, i)
-
-            if (len(topScore) > numScore):
-                maxScore = topScore[numScore - 1]
-                topScore.pop(numScore)
-                topParam.pop(numScore)
-            topObj = obj
-
-        scoreSum += thisScore
+    # Each paramID once, scored by the sum of its first four distances, as for monteCarlo.
+    # The files are parsed in parallel, see leaderboard.py
+    table = leaderboard.scanFiles(configFile, numFiles, paramType, 4)
+    if len(table) == 0:
+        print("No readable files")
+        sys.exit(1)
+    scores = table['score']
+    order = leaderboard.top(scores, numScore)
+
+    topScore = list(scores[order])
+    topParam = list(table['index'][order])
+    if len(scores) > numScore:
+        maxScore = topScore[numScore - 1]
+    else:
+        maxScore = -1000
 
     print(maxScore)
-    print(scoreSum / fileSum)
+    print(scores.mean())
     print(topScore)
     print(topParam)
 
     # Now average the scores of the top object
-
@@ -0,0 +1,92 @@
+#!/usr/bin/python
+
+# Copyright (c) 2012, United States Government, as represented by the
+# Administrator of the National Aeronautics and Space Administration.
+# All rights reserved.
+#
+# The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+# under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# http://www.apache.org/licenses/LICENSE-2.0.
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+# either express or implied. See the License for the specific language
+# governing permissions and limitations under the License.
+
+""" Converts a controller's JSON file to the binary ParameterBlob format """
+
+# Purpose: Let controllers load their parameters without parsing JSON
+# Date:    October 2026
+# Notes:   Every numeric array in the JSON file (a list of numbers, or a
+# list of equal length lists of numbers) becomes one section named by its
+# path, such as nodeVals/params. Everything else, including scores, is
+# dropped. See src/helpers/ParameterBlob.h for the layout. Inputs are
+# (1) The name of the JSON file
+# (2) The name of the binary output file
+
+import sys
+import json
+import struct
+
+MAGIC = b'NTRTPB1\0'
+
+def isNumber(value):
+    return isinstance(value, (int, float)) and not isinstance(value, bool)
+
+def asArray(value):
+    """ Return the rows of a numeric array, or None """
+    if not isinstance(value, list) or len(value) == 0:
+        return None
+    if all(isNumber(v) for v in value):
+        return [value]
+    if not all(isinstance(row, list) for row in value):
+        return None
+    cols = len(value[0])
+    for row in value:
+        if len(row) != cols or not all(isNumber(v) for v in row):
+            return None
+    return value
+
+def collectSections(node, path, sections):
+    if isinstance(node, dict):
+        for key in sorted(node.keys()):
+            if path == '' and key == 'scores':
+                continue
+            collectSections(node[key], path + key + '/', sections)
+    else:
+        rows = asArray(node)
+        if rows is not None:
+            sections.append((path[:-1], rows))
+
+def writeBlob(sections, outFile):
+    header = MAGIC + struct.pack('<I', len(sections))
+    data = b''
+    for name, rows in sections:
+        encoded = name.encode('utf-8')
+        header += struct.pack('<I', len(encoded)) + encoded
+        header += struct.pack('<II', len(rows), len(rows[0]))
+        for row in rows:
+            data += struct.pack('<%dd' % len(row), *row)
+    # The doubles start on an 8 byte boundary
+    header += b'\0' * (-len(header) % 8)
+    fout = open(outFile, 'wb')
+    fout.write(header + data)
+    fout.close()
+
+if __name__=="__main__":
+    inFile = sys.argv[1]
+    outFile = sys.argv[2]
+
+    fin = open(inFile, 'r')
+    root = json.load(fin)
+    fin.close()
+
+    sections = []
+    collectSections(root, '', sections)
+    writeBlob(sections, outFile)
+
+    for name, rows in sections:
+        print(name + ': ' + str(len(rows)) + ' x ' + str(len(rows[0])))
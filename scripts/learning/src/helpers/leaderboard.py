@@ -0,0 +1,223 @@
+#!/usr/bin/python
+
+# Copyright (c) 2012, United States Government, as represented by the
+# Administrator of the National Aeronautics and Space Administration.
+# All rights reserved.
+#
+# The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+# under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# http://www.apache.org/licenses/LICENSE-2.0.
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+# either express or implied. See the License for the specific language
+# governing permissions and limitations under the License.
+
+""" Ranks the trials of a learning run without loading them all at once """
+
+# Purpose: Leaderboards over the outputs of long learning runs
+# Date:    October 2026
+# Notes:   Scores are streamed into numpy columns, a chunk at a time, from
+# one of
+#     checkpoints <scoreDump.pkl>   the ranked generations the evolution
+#                                   master writes, see population_store.py
+#     files <prefix> <numFiles> <paramType>
+#                                   the controller files <prefix><i>.json,
+#                                   parsed by a pool of processes
+#     csv <scores.csv>              the scores files of the NeuroEvolution
+#                                   library, score in the first column
+# and the best -n are printed, highest first. The top k are found with a
+# partial sort, so a million trials take about as long as reading them.
+
+import argparse
+import json
+import logging
+import multiprocessing
+import sys
+try:
+    import cPickle as pickle
+except ImportError:
+    import pickle
+
+import numpy as np
+
+class Columns:
+    """
+    Named numpy columns of equal length, grown by doubling as rows are
+    appended, so a scan never holds its rows as Python objects.
+    """
+
+    def __init__(self, dtypes, capacity=1024):
+        self.names = [name for name, dtype in dtypes]
+        self.data = dict((name, np.empty(capacity, dtype)) for name, dtype in dtypes)
+        self.size = 0
+
+    def append(self, rows):
+        """ Append a list of tuples with one value per column """
+        self.appendColumns(list(zip(*rows)))
+
+    def appendColumns(self, columns):
+        """ Append one sequence or array per column, all of one length """
+        n = len(columns[0])
+        if self.size + n > len(self.data[self.names[0]]):
+            capacity = max(2 * len(self.data[self.names[0]]), self.size + n)
+            for name in self.names:
+                grown = np.empty(capacity, self.data[name].dtype)
+                grown[:self.size] = self.data[name][:self.size]
+                self.data[name] = grown
+        for name, column in zip(self.names, columns):
+            self.data[name][self.size:self.size + n] = column
+        self.size += n
+
+    def __getitem__(self, name):
+        return self.data[name][:self.size]
+
+    def __len__(self):
+        return self.size
+
+def top(scores, k):
+    """ The indices of the k highest scores, highest first """
+    k = min(k, len(scores))
+    if k == 0:
+        return np.empty(0, np.int64)
+    best = np.argpartition(-scores, k - 1)[:k]
+    return best[np.argsort(-scores[best], kind='mergesort')]
+
+def latest(ids):
+    """ The index of the last row of each id, since elites recur in later generations """
+    ids = np.asarray(ids)
+    unique, last = np.unique(ids[::-1], return_index=True)
+    return np.sort(len(ids) - 1 - last)
+
+def scanCheckpoints(path, useMax=False, chunk=4096):
+    """
+    Stream every controller of every checkpointed generation into columns
+    generation, paramID, score (the average, or the maximum if useMax) and
+    count, the number of scores behind it. Use latest() to count each
+    controller once.
+    """
+    table = Columns([('generation', np.int32), ('paramID', np.int64),
+                     ('score', np.float64), ('count', np.int32)])
+    summary = 'maxScore' if useMax else 'avgScore'
+    rows = []
+    fin = open(path, 'rb')
+    try:
+        generation = 0
+        while True:
+            try:
+                items = pickle.load(fin)
+            except EOFError:
+                break
+            for key, controller in items:
+                if len(controller['scores']) == 0:
+                    continue
+                rows.append((generation, int(key), controller[summary], len(controller['scores'])))
+            if len(rows) >= chunk:
+                table.append(rows)
+                rows = []
+            generation += 1
+    finally:
+        fin.close()
+    if len(rows) > 0:
+        table.append(rows)
+    return table
+
+def readControllerFile(job):
+    """
+    (index, paramID, score, found) of one controller file, for a pool.
+    The score sums the first numScores distances, as PostProcess.py does;
+    found is False if the file or its parameters are missing.
+    """
+    index, path, paramVals, numScores = job
+    try:
+        fin = open(path, 'r')
+        obj = json.load(fin)
+        fin.close()
+        paramID = int(obj[paramVals]['paramID'])
+        distances = [float(s['distance']) for s in obj['scores'][0:numScores]]
+    except (IOError, ValueError, KeyError, TypeError):
+        return (index, -1, 0.0, False)
+    return (index, paramID, sum(distances), True)
+
+def scanFiles(prefix, numFiles, paramType, numScores=4, processes=None, chunk=256):
+    """
+    Stream the controller files <prefix><i>.json, i < numFiles, into
+    columns index, paramID and score, parsing them in parallel. Files
+    repeating an earlier file's paramID and unreadable files are skipped.
+    """
+    table = Columns([('index', np.int64), ('paramID', np.int64), ('score', np.float64)])
+    jobs = ((i, prefix + str(i) + '.json', paramType + 'Vals', numScores) for i in range(numFiles))
+    pool = multiprocessing.Pool(processes)
+    seen = set()
+    rows = []
+    try:
+        # imap keeps the file order, so duplicates drop as in a serial scan
+        for index, paramID, score, found in pool.imap(readControllerFile, jobs, chunk):
+            if not found:
+                logging.warning("Skipped unreadable file %d" % index)
+                continue
+            if paramID in seen:
+                continue
+            seen.add(paramID)
+            rows.append((index, paramID, score))
+            if len(rows) >= chunk:
+                table.append(rows)
+                rows = []
+    finally:
+        pool.close()
+        pool.join()
+    if len(rows) > 0:
+        table.append(rows)
+    return table
+
+def scanCsv(path):
+    """ The columns of a scores file; score is the first, the second is kept as other """
+    data = np.loadtxt(path, delimiter=',', usecols=(0, 1), ndmin=2)
+    table = Columns([('line', np.int64), ('score', np.float64), ('other', np.float64)], max(1, len(data)))
+    table.appendColumns([np.arange(len(data)), data[:, 0], data[:, 1]])
+    return table
+
+def printTable(table, order, names):
+    print(" ".join(names))
+    for i in order:
+        print(" ".join(str(table[name][i]) for name in names))
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Print the best trials of a learning run")
+    parser.add_argument('-n', type=int, default=10, help="how many to print")
+    sources = parser.add_subparsers(dest='source')
+    checkpoints = sources.add_parser('checkpoints')
+    checkpoints.add_argument('path')
+    checkpoints.add_argument('--max', action='store_true', help="rank by the best score instead of the average")
+    files = sources.add_parser('files')
+    files.add_argument('prefix')
+    files.add_argument('numFiles', type=int)
+    files.add_argument('paramType')
+    files.add_argument('--scores', type=int, default=4, help="distances summed per file")
+    files.add_argument('-j', type=int, default=None, help="processes, one per core by default")
+    scoresCsv = sources.add_parser('csv')
+    scoresCsv.add_argument('path')
+    args = parser.parse_args()
+
+    if args.source == 'checkpoints':
+        table = scanCheckpoints(args.path, args.max)
+        names = ['generation', 'paramID', 'score', 'count']
+    elif args.source == 'files':
+        table = scanFiles(args.prefix, args.numFiles, args.paramType, args.scores, args.j)
+        names = ['index', 'paramID', 'score']
+    else:
+        table = scanCsv(args.path)
+        names = ['line', 'score', 'other']
+
+    if len(table) == 0:
+        print("No scores found")
+        sys.exit(1)
+    rows = np.arange(len(table))
+    if args.source == 'checkpoints':
+        rows = latest(table['paramID'])
+    scores = table['score'][rows]
+    print("%d trials, mean %.6g, max %.6g" % (len(rows), np.mean(scores), np.max(scores)))
+    printTable(table, rows[top(scores, args.n)], names)
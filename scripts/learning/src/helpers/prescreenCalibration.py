@@ -0,0 +1,133 @@
+#!/usr/bin/python
+
+# Copyright (c) 2012, United States Government, as represented by the
+# Administrator of the National Aeronautics and Space Administration.
+# All rights reserved.
+#
+# The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+# under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# http://www.apache.org/licenses/LICENSE-2.0.
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+# either express or implied. See the License for the specific language
+# governing permissions and limitations under the License.
+
+
+""" Measures how well prescreen scores rank trials compared with full ones """
+
+# Purpose: Calibration of NeuroEvolution's prescreening (prescreenQuantile)
+# Date:    October 2026
+# Notes:   Reads the logs/prescreen<suffix>.csv files NeuroEvolution
+# writes, whose columns are generation, trial, fidelity, prescreen score
+# and full score. Trials with both scores, the survivors and the audited
+# ones (prescreenAudit), are compared: the Spearman and Kendall rank
+# correlations, and how many of the best -k by full score the prescreen
+# also ranks in its best k. Audited trials matter most, since survivors
+# alone only show the ranking above the threshold.
+
+import argparse
+import sys
+
+import numpy as np
+
+def readLog(path):
+    """ (generation, prescreen, full) columns of the rows with both scores, and the row count """
+    generations = []
+    cheap = []
+    full = []
+    rows = 0
+    fin = open(path, 'r')
+    try:
+        for line in fin:
+            fields = line.strip().split(',')
+            if len(fields) != 5:
+                continue
+            rows += 1
+            if fields[3] == '' or fields[4] == '':
+                continue
+            generations.append(int(fields[0]))
+            cheap.append(float(fields[3]))
+            full.append(float(fields[4]))
+    finally:
+        fin.close()
+    return np.array(generations, np.int64), np.array(cheap), np.array(full), rows
+
+def ranks(values):
+    """ Ranks from 0, ties taking the mean of their ranks """
+    order = np.argsort(values, kind='mergesort')
+    result = np.empty(len(values))
+    sortedValues = values[order]
+    start = 0
+    while start < len(values):
+        end = start
+        while end + 1 < len(values) and sortedValues[end + 1] == sortedValues[start]:
+            end += 1
+        result[order[start:end + 1]] = 0.5 * (start + end)
+        start = end + 1
+    return result
+
+def spearman(a, b):
+    ra = ranks(a) - (len(a) - 1) / 2.0
+    rb = ranks(b) - (len(b) - 1) / 2.0
+    denominator = np.sqrt(np.sum(ra * ra) * np.sum(rb * rb))
+    return np.sum(ra * rb) / denominator if denominator > 0 else float('nan')
+
+def kendall(a, b):
+    """ Kendall's tau-b, in O(n^2), which suits the trials of a run """
+    da = np.sign(a[:, None] - a[None, :])
+    db = np.sign(b[:, None] - b[None, :])
+    concordance = np.sum(np.triu(da * db, 1))
+    pairsA = np.sum(np.triu(da != 0, 1))
+    pairsB = np.sum(np.triu(db != 0, 1))
+    denominator = np.sqrt(float(pairsA) * pairsB)
+    return concordance / denominator if denominator > 0 else float('nan')
+
+def topOverlap(cheap, full, k):
+    """ The fraction of the k best by full score also in the k best by prescreen score """
+    k = min(k, len(full))
+    if k == 0:
+        return float('nan')
+    bestFull = set(np.argsort(-full, kind='mergesort')[:k])
+    bestCheap = set(np.argsort(-cheap, kind='mergesort')[:k])
+    return len(bestFull & bestCheap) / float(k)
+
+def report(name, cheap, full, k):
+    print("%s: %d trials, spearman %.3f, kendall %.3f, top %d overlap %.3f" %
+          (name, len(full), spearman(cheap, full), kendall(cheap, full),
+           min(k, len(full)), topOverlap(cheap, full, k)))
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Compare prescreen and full scores of a learning run")
+    parser.add_argument('logs', nargs='+', help="prescreen logs")
+    parser.add_argument('-k', type=int, default=10, help="how many best trials to compare")
+    parser.add_argument('--generations', action='store_true', help="also report each generation")
+    args = parser.parse_args()
+
+    generations = []
+    cheap = []
+    full = []
+    rows = 0
+    for path in args.logs:
+        g, c, f, n = readLog(path)
+        generations.append(g)
+        cheap.append(c)
+        full.append(f)
+        rows += n
+    generations = np.concatenate(generations)
+    cheap = np.concatenate(cheap)
+    full = np.concatenate(full)
+    if len(full) < 2:
+        print("Fewer than two trials have both scores")
+        sys.exit(1)
+
+    print("%d of %d prescreened trials were also simulated in full" % (len(full), rows))
+    if args.generations:
+        for generation in np.unique(generations):
+            selected = generations == generation
+            if np.sum(selected) >= 2:
+                report("generation %d" % generation, cheap[selected], full[selected], args.k)
+    report("all", cheap, full, args.k)
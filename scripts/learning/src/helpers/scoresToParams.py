@@ -51,7 +51,10 @@ def sortFile(inFile, outFile):
 
         f.close()
 
-    sortedDistances = sorted(unsorted, key=lambda elem: elem[0], reverse=True)
+    # A stable sort on the scores alone, highest first like sorted(reverse=True)
+    scores = np.array([row[0] for row in unsorted])
+    order = np.argsort(-scores, kind='mergesort')
+    sortedDistances = [unsorted[i] for i in order]
 
     try:
         f = open(outFile, 'w')
@@ -27,20 +27,13 @@
 #     splitInfile.py for preliminary work that may need to be done
 
 import sys
-import csv
 import numpy as np
 
 def statScores(inFile):
-    scores1 = []
-    scores2 = []
-    try:
-        f = open(inFile, 'r')
-        reader = csv.reader(f, delimiter=',')
-        for row in reader:
-            scores1.append(float(row[0]))
-            scores2.append(float(row[1]))
-    finally:
-        f.close()
+    # Both columns at once, without a Python loop over the rows
+    scores = np.loadtxt(inFile, delimiter=',', usecols=(0, 1), ndmin=2)
+    scores1 = scores[:, 0]
+    scores2 = scores[:, 1]
 
     mean1 = np.mean(scores1)
     std1 = np.std(scores1)
@@ -1,3 +1,4 @@
 from ntrt_job_master import NTRTJobMaster
 from ntrt_job import NTRTJob
 from ntrt_master_error import NTRTMasterError
+from worker_scheduler import WorkerScheduler
@@ -0,0 +1,292 @@
+import logging
+import os
+import select
+import subprocess
+import time
+
+from ntrt_master_error import NTRTMasterError
+
+class NTRTWorker:
+    """
+    One persistent NTRT process, started with --worker. It reads 'run' lines
+    on its stdin and answers each with a prefixed line on its stdout. The
+    protocol is described in src/helpers/WorkerProtocol.h.
+
+    With a host the process is started over ssh in the current directory,
+    so the host must see the same resources and build directories (a shared
+    file system), since the controllers still read and write their files.
+    """
+
+    __REPLY_PREFIX = "NTRTWORKER "
+
+    def __init__(self, executable, host=None, options=None):
+        self.executable = executable
+        self.host = host
+        self.options = options or []
+        self.job = None
+        self.pending = []
+        self.buffer = b""
+        self.started = None
+        # Consecutive jobs lost by this slot, reset by any reply
+        self.failures = 0
+        self.__spawn()
+
+    def __spawn(self):
+        if self.host is None:
+            command = [self.executable, "--worker"] + self.options
+        else:
+            # ServerAliveInterval makes ssh exit if the node stops answering
+            command = ["ssh", "-o", "BatchMode=yes", "-o", "ServerAliveInterval=15", self.host,
+                       "cd '%s' && exec '%s' --worker%s" % (os.getcwd(), self.executable,
+                                                            "".join(" '%s'" % o for o in self.options))]
+        self.proc = subprocess.Popen(command, stdin=subprocess.PIPE, stdout=subprocess.PIPE)
+        self.pid = self.proc.pid
+        self.buffer = b""
+        logging.info("Started worker process with ID %d on %s." % (self.pid, self.host or "localhost"))
+
+    def fileno(self):
+        return self.proc.stdout.fileno()
+
+    def startJob(self, job):
+        """
+        Send every outstanding request of the job at once, the worker runs
+        them in order.
+        """
+        self.job = job
+        self.pending = list(job.remainingRequests)
+        self.started = time.time()
+        try:
+            for request in self.pending:
+                self.proc.stdin.write((request + "\n").encode("utf-8"))
+            self.proc.stdin.flush()
+        except (IOError, OSError):
+            # The process is gone, readReplies will see the end of its output
+            pass
+
+    def readReplies(self):
+        """
+        Read whatever the worker has written. Returns True once every request
+        of the current job is answered.
+        """
+        data = os.read(self.fileno(), 65536)
+        if not data:
+            raise NTRTMasterError("Worker process %d exited during a job" % self.pid)
+
+        lines = (self.buffer + data).split(b"\n")
+        self.buffer = lines.pop()
+        for line in lines:
+            line = line.decode("utf-8", "replace")
+            if not line.startswith(self.__REPLY_PREFIX):
+                logging.debug("Worker %d: %s" % (self.pid, line))
+                continue
+            words = line[len(self.__REPLY_PREFIX):].split(" ", 2)
+            if words[0] == "fail":
+                logging.warning("Worker %d failed trial %s: %s" % (self.pid, words[1], words[2] if len(words) > 2 else ""))
+            # Replies come in request order
+            self.pending.pop(0)
+            self.job.remainingRequests = list(self.pending)
+            self.started = time.time()
+            self.failures = 0
+
+        return len(self.pending) == 0
+
+    def stop(self):
+        """
+        Kill the process. The caller requeues the job, whose answered
+        requests are not sent again.
+        """
+        try:
+            self.proc.kill()
+        except OSError:
+            pass
+        self.proc.wait()
+        self.job = None
+        self.pending = []
+        self.failures += 1
+
+    def restart(self):
+        self.stop()
+        self.__spawn()
+
+    def close(self):
+        try:
+            self.proc.stdin.write(b"quit\n")
+            self.proc.stdin.close()
+        except (IOError, OSError):
+            pass
+        status = self.proc.wait()
+        logging.info("Worker process ID %d exited with status %d." % (self.pid, status))
+
+
+class WorkerScheduler:
+    """
+    A drop in replacement for ConcurrentScheduler that keeps NTRT processes
+    alive for the whole learning run, instead of forking one per job.
+    Jobs must provide workerRequests() alongside processJobOutput(). Call
+    close() once the run is over.
+
+    hosts spreads the workers over several machines, each entry being
+    {"host" : name, "processes" : count}. Idle workers take the next job
+    from one queue, so fast nodes take more of the work. A worker that
+    exits, loses its ssh connection or stays silent for more than
+    trialTimeout seconds on one trial is restarted and its unanswered
+    trials are queued again, at most maxRetries times per job. options are
+    passed to every worker process, such as the trial budget of
+    evolution_job.budgetOptions().
+    """
+
+    def __init__(self, executable, numProcesses, hosts=None, trialTimeout=None, maxRetries=2, options=None):
+        self.executable = executable
+        self.options = options
+        self.slots = []
+        if hosts:
+            for entry in hosts:
+                self.slots += [entry['host']] * int(entry['processes'])
+        else:
+            self.slots = [None] * numProcesses
+        self.trialTimeout = trialTimeout
+        self.maxRetries = maxRetries
+        self.workers = []
+        logging.info("Worker Scheduler instantiated. Executable: %s. Number of workers: %d." % (executable, len(self.slots)))
+
+    def processJobs(self, toProcess):
+        """
+        Run the jobs, emptying toProcess like ConcurrentScheduler does, and
+        return them once complete.
+        """
+        if len(self.workers) == 0:
+            self.workers = [NTRTWorker(self.executable, host, self.options) for host in self.slots]
+
+        for job in toProcess:
+            job.remainingRequests = job.workerRequests()
+            job.retries = 0
+
+        jobsComplete = []
+        idle = list(self.workers)
+        busy = []
+
+        while len(toProcess) > 0 or len(busy) > 0:
+
+            while len(idle) > 0 and len(toProcess) > 0:
+                worker = idle.pop()
+                worker.startJob(toProcess.pop())
+                busy.append(worker)
+
+            # Block until some worker writes, no polling delay
+            ready, _, _ = select.select(busy, [], [], self.trialTimeout)
+            for worker in ready:
+                try:
+                    if worker.readReplies():
+                        busy.remove(worker)
+                        idle.append(worker)
+                        jobsComplete.append(worker.job)
+                        worker.job = None
+                except NTRTMasterError as e:
+                    logging.warning(str(e))
+                    self.__recover(worker, busy, idle, toProcess)
+
+            if self.trialTimeout is not None:
+                now = time.time()
+                for worker in list(busy):
+                    if now - worker.started > self.trialTimeout:
+                        logging.warning("Worker %d on %s timed out." % (worker.pid, worker.host or "localhost"))
+                        self.__recover(worker, busy, idle, toProcess)
+
+        return jobsComplete
+
+    def processStream(self, nextJob, jobDone, trialTimeLimit=None):
+        """
+        Keep every worker busy with the jobs nextJob() returns, until it
+        returns None, and call jobDone(job, True) as each job completes,
+        without waiting for the others. A job still running trialTimeLimit
+        seconds after it started is dropped: its worker is restarted and
+        jobDone(job, False) called. Lost workers are handled as in
+        processJobs().
+        """
+        if len(self.workers) == 0:
+            self.workers = [NTRTWorker(self.executable, host, self.options) for host in self.slots]
+
+        idle = list(self.workers)
+        busy = []
+        requeued = []
+        exhausted = False
+
+        while True:
+
+            while len(idle) > 0 and (len(requeued) > 0 or not exhausted):
+                if len(requeued) > 0:
+                    job = requeued.pop()
+                else:
+                    job = nextJob()
+                    if job is None:
+                        exhausted = True
+                        break
+                    job.remainingRequests = job.workerRequests()
+                    job.retries = 0
+                    job.begun = time.time()
+                worker = idle.pop()
+                worker.startJob(job)
+                busy.append(worker)
+
+            if len(busy) == 0:
+                return
+
+            # Wake up in time for the next job to reach its limit
+            timeout = self.trialTimeout
+            if trialTimeLimit is not None:
+                first = min(worker.job.begun for worker in busy)
+                remaining = max(0.0, first + trialTimeLimit - time.time())
+                if timeout is None or remaining < timeout:
+                    timeout = remaining
+
+            ready, _, _ = select.select(busy, [], [], timeout)
+            for worker in ready:
+                try:
+                    if worker.readReplies():
+                        job = worker.job
+                        busy.remove(worker)
+                        idle.append(worker)
+                        worker.job = None
+                        jobDone(job, True)
+                except NTRTMasterError as e:
+                    logging.warning(str(e))
+                    self.__recover(worker, busy, idle, requeued)
+
+            now = time.time()
+            for worker in list(busy):
+                if trialTimeLimit is not None and now - worker.job.begun > trialTimeLimit:
+                    # Not the slot's fault, so not one of its failures
+                    job = worker.job
+                    failures = worker.failures
+                    busy.remove(worker)
+                    worker.restart()
+                    worker.failures = failures
+                    idle.append(worker)
+                    jobDone(job, False)
+                elif self.trialTimeout is not None and now - worker.started > self.trialTimeout:
+                    logging.warning("Worker %d on %s timed out." % (worker.pid, worker.host or "localhost"))
+                    self.__recover(worker, busy, idle, requeued)
+
+    def __recover(self, worker, busy, idle, toProcess):
+        job = worker.job
+        job.retries += 1
+        if job.retries > self.maxRetries:
+            raise NTRTMasterError("Job %s was lost %d times" % (job.remainingRequests[0], job.retries))
+        toProcess.append(job)
+
+        busy.remove(worker)
+        if worker.failures >= self.maxRetries:
+            # Stop using a slot that keeps losing jobs, such as a dead node
+            logging.warning("Retiring worker slot on %s." % (worker.host or "localhost"))
+            worker.stop()
+            self.workers.remove(worker)
+            if len(self.workers) == 0:
+                raise NTRTMasterError("No workers left")
+        else:
+            worker.restart()
+            idle.append(worker)
+
+    def close(self):
+        for worker in self.workers:
+            worker.close()
+        self.workers = []
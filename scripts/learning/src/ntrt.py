@@ -0,0 +1,151 @@
+#!/usr/bin/python
+
+# Copyright (c) 2012, United States Government, as represented by the
+# Administrator of the National Aeronautics and Space Administration.
+# All rights reserved.
+#
+# The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+# under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# http://www.apache.org/licenses/LICENSE-2.0.
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+# either express or implied. See the License for the specific language
+# governing permissions and limitations under the License.
+
+""" Runs trials of a YAML model in this process, without executables or files """
+
+# Purpose: Let the evolution and SPSA scripts evaluate trials in process
+# Date:    October 2026
+# Notes:   A wrapper of src/bindings/ntrt.h. ctypes releases the GIL for
+# the whole of each call, so threads of the learning scripts keep running
+# while the worlds step. The library is found at $NTRT_LIB, or else in the
+# build directory of the repository, e.g.
+#
+#     trials = Trials('resources/src/structure.yaml', worlds=8)
+#     scores = trials.evaluate(population, steps=60000)
+
+import ctypes
+import os
+from array import array
+
+_libPath = os.environ.get('NTRT_LIB', os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                                   '..', '..', '..', 'build', 'bindings', 'libntrt.so'))
+_lib = None
+
+def _load():
+    global _lib
+    if _lib is not None:
+        return _lib
+    lib = ctypes.CDLL(_libPath)
+    handle = ctypes.c_void_p
+    doubles = ctypes.POINTER(ctypes.c_double)
+    lib.ntrt_create.restype = handle
+    lib.ntrt_create.argtypes = [ctypes.c_char_p, ctypes.c_size_t, ctypes.c_double, ctypes.c_size_t,
+                                ctypes.c_double, ctypes.c_double, doubles,
+                                ctypes.POINTER(ctypes.c_char_p)]
+    lib.ntrt_destroy.argtypes = [handle]
+    lib.ntrt_last_error.restype = ctypes.c_char_p
+    lib.ntrt_last_error.argtypes = [handle]
+    lib.ntrt_worlds.restype = ctypes.c_size_t
+    lib.ntrt_worlds.argtypes = [handle]
+    lib.ntrt_parameter_count.restype = ctypes.c_size_t
+    lib.ntrt_parameter_count.argtypes = [handle]
+    lib.ntrt_set_parameters.argtypes = [handle, ctypes.c_size_t, doubles, ctypes.c_size_t]
+    lib.ntrt_set_overrides.argtypes = [handle, ctypes.c_size_t, ctypes.POINTER(ctypes.c_char_p),
+                                       doubles, ctypes.c_size_t]
+    lib.ntrt_reset.argtypes = [handle]
+    lib.ntrt_run.argtypes = [handle, ctypes.c_int]
+    lib.ntrt_scores.argtypes = [handle, doubles]
+    lib.ntrt_evaluate.argtypes = [handle, doubles, ctypes.c_int, doubles]
+    _lib = lib
+    return lib
+
+def _doubles(values):
+    """ A C array of the values, and the array that keeps it alive """
+    buf = array('d', values)
+    address, length = buf.buffer_info()
+    return ctypes.cast(address, ctypes.POINTER(ctypes.c_double)), buf
+
+class NTRTError(Exception):
+    pass
+
+class Trials:
+    """
+    One model per world, each with the sine wave controller of
+    src/bindings/TrialController.h: amplitude, frequency, phase and offset
+    per actuator. The score of a trial is the distance its center of mass
+    moved over the ground. The default gains are those of the inner
+    strings of LearningSpineSine.
+    """
+
+    def __init__(self, model, worlds=1, stepSize=0.001, threads=0, gravity=98.1,
+                 controlStep=0.0, gains=(1500.0, 100.0, 100.0)):
+        self.__lib = _load()
+        gainsPtr, gainsBuf = _doubles(gains)
+        error = ctypes.c_char_p()
+        self.__handle = self.__lib.ntrt_create(model.encode('utf-8'), worlds, stepSize, threads,
+                                               gravity, controlStep, gainsPtr, ctypes.byref(error))
+        if not self.__handle:
+            raise NTRTError(error.value)
+        self.worlds = self.__lib.ntrt_worlds(self.__handle)
+        self.parameterCount = self.__lib.ntrt_parameter_count(self.__handle)
+
+    def close(self):
+        if self.__handle:
+            self.__lib.ntrt_destroy(self.__handle)
+            self.__handle = None
+
+    def __del__(self):
+        self.close()
+
+    def __check(self, result):
+        if result != 0:
+            raise NTRTError(self.__lib.ntrt_last_error(self.__handle))
+
+    def setParameters(self, world, parameters):
+        """ The controller parameters of a world, for its next reset """
+        ptr, buf = _doubles(parameters)
+        self.__check(self.__lib.ntrt_set_parameters(self.__handle, world, ptr, len(buf)))
+
+    def setOverrides(self, world, overrides):
+        """ Builder parameters of a world's model, e.g. {'string.stiffness': 500} """
+        names = (ctypes.c_char_p * len(overrides))(*[k.encode('utf-8') for k in overrides])
+        ptr, buf = _doubles(overrides.values())
+        self.__check(self.__lib.ntrt_set_overrides(self.__handle, world, names, ptr, len(buf)))
+
+    def reset(self):
+        self.__check(self.__lib.ntrt_reset(self.__handle))
+
+    def run(self, steps):
+        self.__check(self.__lib.ntrt_run(self.__handle, steps))
+
+    def scores(self):
+        ptr, buf = _doubles([0.0] * self.worlds)
+        self.__check(self.__lib.ntrt_scores(self.__handle, ptr))
+        return list(buf)
+
+    def evaluate(self, population, steps):
+        """
+        Score each parameter list of the population, worlds at a time,
+        each call stepping every world at once
+        """
+        scores = []
+        for first in range(0, len(population), self.worlds):
+            batch = list(population[first:first + self.worlds])
+            # Spare worlds repeat the first trial of the batch
+            while len(batch) < self.worlds:
+                batch.append(batch[0])
+            flat = []
+            for parameters in batch:
+                if len(parameters) != self.parameterCount:
+                    raise NTRTError("Expected %d parameters" % self.parameterCount)
+                flat.extend(parameters)
+            ptr, buf = _doubles(flat)
+            out, outBuf = _doubles([0.0] * self.worlds)
+            self.__check(self.__lib.ntrt_evaluate(self.__handle, ptr, steps, out))
+            scores.extend(list(outBuf)[:len(population) - first])
+        return scores
@@ -0,0 +1,133 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+
+/**
+ * @file TrialController.cpp
+ * @brief Implementation of TrialController.
+ * $Id$
+ */
+
+// This module
+#include "TrialController.h"
+// This application
+#include "yamlbuilder/TensegrityModel.h"
+// This library
+#include "controllers/tgSineWaveBank.h"
+#include "core/tgBaseRigid.h"
+#include "core/tgBasicActuator.h"
+#include "core/tgCast.h"
+// The C++ Standard Library
+#include <cmath>
+#include <stdexcept>
+
+TrialController::TrialController(double controlStep,
+                                 const tgImpedanceController& gains) :
+    m_controlStep(controlStep),
+    m_gains(gains),
+    m_pBank(NULL),
+    m_actuators(0),
+    m_start(0.0, 0.0, 0.0)
+{
+    if (controlStep < 0.0)
+    {
+        throw std::invalid_argument("Negative control step");
+    }
+}
+
+TrialController::~TrialController()
+{
+    delete m_pBank;
+}
+
+void TrialController::onSetup(TensegrityModel& subject)
+{
+    delete m_pBank;
+    m_pBank = new tgSineWaveBank(m_controlStep);
+
+    // Contact cables and other spring cables have no impedance control
+    const std::vector<tgSpringCableActuator*>& actuators = subject.getAllActuators();
+    m_actuators = actuators.size();
+    for (std::size_t i = 0; i < actuators.size(); ++i)
+    {
+        tgBasicActuator* const pActuator = dynamic_cast<tgBasicActuator*>(actuators[i]);
+        if (pActuator == NULL)
+        {
+            continue;
+        }
+        const std::size_t first = i * parametersPerActuator;
+        double wave[parametersPerActuator] = { 0.0, 0.0, 0.0, 0.0 };
+        for (std::size_t j = 0; j < parametersPerActuator; ++j)
+        {
+            if (first + j < m_parameters.size())
+            {
+                wave[j] = m_parameters[first + j];
+            }
+        }
+        m_pBank->add(pActuator, m_gains, wave[0], wave[1], wave[2], wave[3],
+                     pActuator->getStartLength());
+    }
+
+    m_rigids = tgCast::filter<tgModel, tgBaseRigid>(subject.getDescendants());
+    m_start = centerOfMass();
+}
+
+void TrialController::onStep(TensegrityModel& subject, double dt)
+{
+    if (m_pBank != NULL && dt > 0.0)
+    {
+        m_pBank->step(dt);
+    }
+}
+
+void TrialController::onTeardown(TensegrityModel& subject)
+{
+    delete m_pBank;
+    m_pBank = NULL;
+    m_rigids.clear();
+}
+
+void TrialController::setParameters(const double* parameters, std::size_t count)
+{
+    if (m_actuators > 0 && count > m_actuators * parametersPerActuator)
+    {
+        throw std::invalid_argument("More parameters than actuators take");
+    }
+    m_parameters.assign(parameters, parameters + count);
+}
+
+double TrialController::score() const
+{
+    if (m_rigids.empty())
+    {
+        return 0.0;
+    }
+    const btVector3 moved = centerOfMass() - m_start;
+    return std::sqrt(moved.x() * moved.x() + moved.z() * moved.z());
+}
+
+btVector3 TrialController::centerOfMass() const
+{
+    btVector3 sum(0.0, 0.0, 0.0);
+    double mass = 0.0;
+    for (std::size_t i = 0; i < m_rigids.size(); ++i)
+    {
+        sum += m_rigids[i]->centerOfMass() * m_rigids[i]->mass();
+        mass += m_rigids[i]->mass();
+    }
+    return mass > 0.0 ? sum / mass : sum;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+
+#ifndef TRIAL_CONTROLLER_H
+#define TRIAL_CONTROLLER_H
+
+/**
+ * @file TrialController.h
+ * @brief Contains the definition of class TrialController.
+ * $Id$
+ */
+
+// This library
+#include "controllers/tgImpedanceController.h"
+#include "core/tgObserver.h"
+// Bullet Physics
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class TensegrityModel;
+class tgBaseRigid;
+class tgSineWaveBank;
+
+/**
+ * The controller of the in-process trials of ntrt.h: a sine wave on the
+ * velocity of every basic actuator of a TensegrityModel, driven by one
+ * tgSineWaveBank, and the distance the model's center of mass moves over
+ * the ground as the score.
+ *
+ * Each actuator takes parametersPerActuator parameters, in the order of
+ * TensegrityModel::getAllActuators(): amplitude, frequency in Hz, phase
+ * in radians and offset. New parameters take effect at the next setup,
+ * which every reset makes.
+ */
+class TrialController : public tgObserver<TensegrityModel>
+{
+public:
+
+    static const std::size_t parametersPerActuator = 4;
+
+    /**
+     * @param[in] controlStep how often the tensions are set, in seconds;
+     * zero sets them every step
+     * @param[in] gains the impedance gains of every actuator
+     * @throw std::invalid_argument if controlStep is negative
+     */
+    TrialController(double controlStep, const tgImpedanceController& gains);
+
+    virtual ~TrialController();
+
+    /** Build the sine waves from the parameters and note the start. */
+    virtual void onSetup(TensegrityModel& subject);
+
+    virtual void onStep(TensegrityModel& subject, double dt);
+
+    virtual void onTeardown(TensegrityModel& subject);
+
+    /** Only the subject's actuators are touched. */
+    virtual bool isParallelSafe() const { return true; }
+
+    /**
+     * Set the parameters of the next setup; missing ones are zero.
+     * @throw std::invalid_argument if there are more than
+     * parametersPerActuator for each actuator of the last setup
+     */
+    void setParameters(const double* parameters, std::size_t count);
+
+    /** @return the number of actuators of the last setup */
+    std::size_t actuatorCount() const { return m_actuators; }
+
+    /**
+     * @return the distance in the x-z plane from the center of mass at
+     * setup to the current one, 0 before setup
+     */
+    double score() const;
+
+private:
+
+    /** The mass weighted center of m_rigids */
+    btVector3 centerOfMass() const;
+
+    const double m_controlStep;
+
+    const tgImpedanceController m_gains;
+
+    std::vector<double> m_parameters;
+
+    /** The waves of the current setup; owned, NULL outside of setup */
+    tgSineWaveBank* m_pBank;
+
+    /** The bodies of the current setup */
+    std::vector<tgBaseRigid*> m_rigids;
+
+    std::size_t m_actuators;
+
+    btVector3 m_start;
+};
+
+#endif // TRIAL_CONTROLLER_H
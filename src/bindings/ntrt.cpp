@@ -0,0 +1,246 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+
+/**
+ * @file ntrt.cpp
+ * @brief Implementation of the C interface of ntrt.h
+ * $Id$
+ */
+
+// This module
+#include "ntrt.h"
+// This application
+#include "TrialController.h"
+#include "yamlbuilder/TensegrityModel.h"
+// This library
+#include "core/tgBatchSimulation.h"
+#include "core/tgWorld.h"
+// The C++ Standard Library
+#include <exception>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct ntrt_trials
+{
+    ntrt_trials() : pBatch(NULL) { }
+
+    ~ntrt_trials()
+    {
+        // The simulations tear the models down, which notifies the controllers
+        delete pBatch;
+        for (std::size_t i = 0; i < controllers.size(); ++i)
+        {
+            delete controllers[i];
+        }
+    }
+
+    tgBatchSimulation* pBatch;
+
+    /** One per world, observing that world's model; owned */
+    std::vector<TrialController*> controllers;
+
+    std::vector<TensegrityModel*> models;
+
+    std::string error;
+};
+
+namespace
+{
+    TrialController& controller(const ntrt_trials* trials, size_t world)
+    {
+        if (world >= trials->controllers.size())
+        {
+            throw std::out_of_range("World index out of range");
+        }
+        return *trials->controllers[world];
+    }
+
+    /** Record the message of the exception being handled */
+    int fail(const ntrt_trials* trials)
+    {
+        std::string& error = const_cast<ntrt_trials*>(trials)->error;
+        try
+        {
+            throw;
+        }
+        catch (const std::exception& e)
+        {
+            error = e.what();
+        }
+        catch (...)
+        {
+            error = "Unknown exception";
+        }
+        return -1;
+    }
+}
+
+ntrt_trials* ntrt_create(const char* model, size_t worlds, double step_size,
+                         size_t threads, double gravity, double control_step,
+                         const double gains[3], const char** error)
+{
+    // Set when NULL is returned, so it must outlive the call
+    static std::string message;
+    ntrt_trials* const trials = new ntrt_trials();
+    try
+    {
+        trials->pBatch = new tgBatchSimulation(worlds, tgWorld::Config(gravity),
+                                               step_size, threads);
+        const tgImpedanceController impedance(gains[0], gains[1], gains[2]);
+        for (std::size_t i = 0; i < worlds; ++i)
+        {
+            TrialController* const pController =
+                new TrialController(control_step, impedance);
+            trials->controllers.push_back(pController);
+            TensegrityModel* const pModel = new TensegrityModel(model);
+            pModel->attach(pController);
+            trials->pBatch->addModel(i, pModel);
+            trials->models.push_back(pModel);
+        }
+        return trials;
+    }
+    catch (...)
+    {
+        fail(trials);
+        message = trials->error;
+        if (error != NULL)
+        {
+            *error = message.c_str();
+        }
+        delete trials;
+        return NULL;
+    }
+}
+
+void ntrt_destroy(ntrt_trials* trials)
+{
+    delete trials;
+}
+
+const char* ntrt_last_error(const ntrt_trials* trials)
+{
+    return trials->error.c_str();
+}
+
+size_t ntrt_worlds(const ntrt_trials* trials)
+{
+    return trials->controllers.size();
+}
+
+size_t ntrt_parameter_count(const ntrt_trials* trials)
+{
+    return trials->controllers[0]->actuatorCount() *
+        TrialController::parametersPerActuator;
+}
+
+int ntrt_set_parameters(ntrt_trials* trials, size_t world,
+                        const double* parameters, size_t count)
+{
+    try
+    {
+        controller(trials, world).setParameters(parameters, count);
+        return 0;
+    }
+    catch (...)
+    {
+        return fail(trials);
+    }
+}
+
+int ntrt_set_overrides(ntrt_trials* trials, size_t world,
+                       const char* const* names, const double* values,
+                       size_t count)
+{
+    try
+    {
+        controller(trials, world);
+        std::map<std::string, double> overrides;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            overrides[names[i]] = values[i];
+        }
+        trials->models[world]->setParameterOverrides(overrides);
+        return 0;
+    }
+    catch (...)
+    {
+        return fail(trials);
+    }
+}
+
+int ntrt_reset(ntrt_trials* trials)
+{
+    try
+    {
+        trials->pBatch->reset();
+        return 0;
+    }
+    catch (...)
+    {
+        return fail(trials);
+    }
+}
+
+int ntrt_run(ntrt_trials* trials, int steps)
+{
+    try
+    {
+        trials->pBatch->run(steps);
+        return 0;
+    }
+    catch (...)
+    {
+        return fail(trials);
+    }
+}
+
+int ntrt_scores(const ntrt_trials* trials, double* scores)
+{
+    try
+    {
+        for (std::size_t i = 0; i < trials->controllers.size(); ++i)
+        {
+            scores[i] = trials->controllers[i]->score();
+        }
+        return 0;
+    }
+    catch (...)
+    {
+        return fail(trials);
+    }
+}
+
+int ntrt_evaluate(ntrt_trials* trials, const double* parameters, int steps,
+                  double* scores)
+{
+    const std::size_t count = ntrt_parameter_count(trials);
+    for (std::size_t i = 0; i < trials->controllers.size(); ++i)
+    {
+        if (ntrt_set_parameters(trials, i, parameters + i * count, count) != 0)
+        {
+            return -1;
+        }
+    }
+    if (ntrt_reset(trials) != 0 || ntrt_run(trials, steps) != 0)
+    {
+        return -1;
+    }
+    return ntrt_scores(trials, scores);
+}
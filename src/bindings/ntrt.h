@@ -0,0 +1,114 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+
+#ifndef NTRT_H
+#define NTRT_H
+
+/**
+ * @file ntrt.h
+ * @brief A C interface for running trials of YAML models in process
+ * $Id$
+ *
+ * The learning scripts load libntrt with Python's ctypes, which releases
+ * the GIL for as long as each call runs, so other Python threads keep
+ * going while the worlds step; see scripts/learning/src/ntrt.py. Plain C
+ * keeps the interface free of any Python or Boost.Python build
+ * dependency.
+ *
+ * A handle owns a tgBatchSimulation of one TensegrityModel per world,
+ * each with a TrialController. Calls return 0 on success and -1 on
+ * failure, leaving a message for ntrt_last_error(); no exception crosses
+ * the interface. A handle must not be used by two threads at once.
+ */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ntrt_trials ntrt_trials;
+
+/**
+ * Build the worlds and their models.
+ * @param[in] model the path of a YAML structure or of a compiled model
+ * @param[in] worlds the number of worlds, trials run at once
+ * @param[in] step_size the physics timestep, in seconds
+ * @param[in] threads the worker threads, 0 for one per core
+ * @param[in] gravity the gravity of every world
+ * @param[in] control_step how often the controllers set the tensions
+ * @param[in] gains the offset tension, length and velocity stiffness of
+ * the impedance control of every actuator
+ * @param[out] error the message if NULL is returned; may be NULL
+ * @return the handle, or NULL
+ */
+ntrt_trials* ntrt_create(const char* model, size_t worlds, double step_size,
+                         size_t threads, double gravity, double control_step,
+                         const double gains[3], const char** error);
+
+void ntrt_destroy(ntrt_trials* trials);
+
+/** @return the message of the last failed call of the handle */
+const char* ntrt_last_error(const ntrt_trials* trials);
+
+size_t ntrt_worlds(const ntrt_trials* trials);
+
+/** @return the parameters each world's controller takes */
+size_t ntrt_parameter_count(const ntrt_trials* trials);
+
+/**
+ * Set the controller parameters of one world, for its next reset.
+ * @see TrialController
+ */
+int ntrt_set_parameters(ntrt_trials* trials, size_t world,
+                        const double* parameters, size_t count);
+
+/**
+ * Override builder parameters of one world's model, such as
+ * "string.stiffness"; see TensegrityModel::setParameterOverrides.
+ */
+int ntrt_set_overrides(ntrt_trials* trials, size_t world,
+                       const char* const* names, const double* values,
+                       size_t count);
+
+/** Reset every world, applying the parameters and overrides set. */
+int ntrt_reset(ntrt_trials* trials);
+
+/** Advance every world by steps timesteps. */
+int ntrt_run(ntrt_trials* trials, int steps);
+
+/**
+ * @param[out] scores the score of each world, ntrt_worlds() of them
+ * @see TrialController::score
+ */
+int ntrt_scores(const ntrt_trials* trials, double* scores);
+
+/**
+ * One trial per world in a single call: set each world's parameters,
+ * reset, run and read the scores.
+ * @param[in] parameters ntrt_worlds() rows of ntrt_parameter_count()
+ * @param[out] scores ntrt_worlds() scores
+ */
+int ntrt_evaluate(ntrt_trials* trials, const double* parameters, int steps,
+                  double* scores);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NTRT_H
@@ -0,0 +1,195 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+/**
+ * @file tgCommandMailbox.cpp
+ * @brief Implementation of the tgCommandMailbox class
+ * $Id$
+ */
+
+#include "tgCommandMailbox.h"
+
+#include "core/tgCast.h"
+#include "core/tgModel.h"
+#include "core/tgSpringCableActuator.h"
+
+// The C++ Standard Library
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+	boost::uint64_t toBits(double value)
+	{
+		boost::uint64_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	double fromBits(boost::uint64_t bits)
+	{
+		double value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+}
+
+const boost::uint64_t tgCommandMailbox::noCommand = ~boost::uint64_t(0);
+
+tgCommandMailbox::Slot::Slot() :
+command(noCommand),
+sequence(0)
+{
+	for (std::size_t i = 0; i < 5; i++)
+	{
+		state[i].store(0, boost::memory_order_relaxed);
+	}
+}
+
+tgCommandMailbox::tgCommandMailbox() :
+m_actuators(0)
+{
+}
+
+tgCommandMailbox::~tgCommandMailbox()
+{
+}
+
+void tgCommandMailbox::attach(tgModel& model)
+{
+	const std::vector<tgSpringCableActuator*> actuators =
+		tgCast::filter<tgModel, tgSpringCableActuator>(model.getDescendants());
+	if (!m_slots)
+	{
+		m_slots.reset(new Slot[actuators.size()]);
+		m_actuators = actuators.size();
+		if (m_actuators > 0 && !m_slots[0].command.is_lock_free())
+		{
+			m_slots.reset();
+			m_actuators = 0;
+			throw std::runtime_error("tgCommandMailbox needs lock-free 64-bit atomics.");
+		}
+	}
+	else if (actuators.size() != m_actuators)
+	{
+		throw std::invalid_argument("Model does not have the attached number of actuators.");
+	}
+	m_index.clear();
+	for (std::size_t i = 0; i < actuators.size(); i++)
+	{
+		m_index[actuators[i]] = i;
+		// The new actuator has not stepped yet
+		m_slots[i].sequence.store(0, boost::memory_order_release);
+		actuators[i]->attach(this);
+	}
+}
+
+tgCommandMailbox::Slot& tgCommandMailbox::slotOf(std::size_t actuator) const
+{
+	if (actuator >= m_actuators)
+	{
+		throw std::out_of_range("No such actuator in the mailbox.");
+	}
+	return m_slots[actuator];
+}
+
+void tgCommandMailbox::post(std::size_t actuator, double restLength)
+{
+	// Also rejects NaN, so that noCommand is never posted
+	if (!(restLength >= 0.0))
+	{
+		throw std::invalid_argument("Rest length is negative.");
+	}
+	slotOf(actuator).command.store(toBits(restLength),
+	                               boost::memory_order_relaxed);
+}
+
+void tgCommandMailbox::clear(std::size_t actuator)
+{
+	slotOf(actuator).command.store(noCommand, boost::memory_order_relaxed);
+}
+
+bool tgCommandMailbox::readState(std::size_t actuator, State& state,
+                                 std::size_t maxTries) const
+{
+	const Slot& slot = slotOf(actuator);
+	for (std::size_t i = 0; i < maxTries; i++)
+	{
+		const boost::uint64_t before =
+			slot.sequence.load(boost::memory_order_acquire);
+		if (before == 0)
+		{
+			return false;
+		}
+		if (before % 2 != 0)
+		{
+			continue;
+		}
+		boost::uint64_t bits[5];
+		for (std::size_t j = 0; j < 5; j++)
+		{
+			bits[j] = slot.state[j].load(boost::memory_order_relaxed);
+		}
+		boost::atomic_thread_fence(boost::memory_order_acquire);
+		if (slot.sequence.load(boost::memory_order_relaxed) == before)
+		{
+			state.step = static_cast<std::size_t>(bits[0]);
+			state.restLength = fromBits(bits[1]);
+			state.currentLength = fromBits(bits[2]);
+			state.velocity = fromBits(bits[3]);
+			state.tension = fromBits(bits[4]);
+			return true;
+		}
+	}
+	return false;
+}
+
+void tgCommandMailbox::onStep(tgSpringCableActuator& subject, double dt)
+{
+	const std::map<const tgSpringCableActuator*, std::size_t>::const_iterator
+		it = m_index.find(&subject);
+	if (it == m_index.end())
+	{
+		return;
+	}
+	Slot& slot = m_slots[it->second];
+
+	// Only this thread writes the state, so the sequence is read relaxed
+	const boost::uint64_t sequence =
+		slot.sequence.load(boost::memory_order_relaxed);
+	slot.sequence.store(sequence + 1, boost::memory_order_relaxed);
+	boost::atomic_thread_fence(boost::memory_order_release);
+	slot.state[0].store(subject.getStepCount(), boost::memory_order_relaxed);
+	slot.state[1].store(toBits(subject.getRestLength()),
+	                    boost::memory_order_relaxed);
+	slot.state[2].store(toBits(subject.getCurrentLength()),
+	                    boost::memory_order_relaxed);
+	slot.state[3].store(toBits(subject.getVelocity()),
+	                    boost::memory_order_relaxed);
+	slot.state[4].store(toBits(subject.getTension()),
+	                    boost::memory_order_relaxed);
+	slot.sequence.store(sequence + 2, boost::memory_order_release);
+
+	const boost::uint64_t command =
+		slot.command.load(boost::memory_order_relaxed);
+	if (command != noCommand)
+	{
+		subject.setControlInput(fromBits(command), dt);
+	}
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_COMMAND_MAILBOX_H
+#define TG_COMMAND_MAILBOX_H
+
+/**
+ * @file tgCommandMailbox.h
+ * @brief Definition of the tgCommandMailbox class
+ * $Id$
+ */
+
+// This application
+#include "core/tgObserver.h"
+// Boost
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/scoped_array.hpp>
+// The C++ Standard Library
+#include <cstddef>
+#include <map>
+
+// Forward declarations
+class tgModel;
+class tgSpringCableActuator;
+
+/**
+ * Lets threads other than the simulation's, such as a ROS node, command
+ * a model's spring cable actuators and read them back without locks.
+ * Calling tgControllable::setControlInput() from another thread races
+ * with the actuator's step; here post() only stores the rest length in
+ * the actuator's slot, and the simulation thread applies it, with the
+ * step's dt, when the actuator is next stepped. A command holds until it
+ * is replaced or cleared, as a position command does, and the latest one
+ * wins if several threads post to the same actuator.
+ *
+ * At the same point the actuator's state after the previous step is
+ * published, and readState() returns a consistent copy of it from any
+ * thread. Neither side blocks the other: the simulation never waits
+ * and a reader only retries while one actuator's state is being written.
+ *
+ * Actuators are numbered in the order of tgModel::getDescendants(), as
+ * in tgControlInputRecord.
+ */
+class tgCommandMailbox : public tgObserver<tgSpringCableActuator>
+{
+public:
+
+    /** An actuator as it was after a step. */
+    struct State
+    {
+        /** The number of steps the actuator had completed. */
+        std::size_t step;
+
+        double restLength;
+
+        double currentLength;
+
+        double velocity;
+
+        double tension;
+    };
+
+    tgCommandMailbox();
+
+    virtual ~tgCommandMailbox();
+
+    /**
+     * Attach to every spring cable actuator below a model. The actuators
+     * are recreated by a reset, so call this again after each one, from
+     * the simulation thread; the commands posted so far are kept.
+     * @param[in,out] model a model that has been set up
+     * @throw std::invalid_argument if the model does not have as many
+     * actuators as when first attached
+     * @throw std::runtime_error if 64-bit atomics are not lock-free here
+     */
+    void attach(tgModel& model);
+
+    /**
+     * Command an actuator from any thread. Call attach() before posting.
+     * @param[in] actuator the index of the actuator
+     * @param[in] restLength the rest length to move towards
+     * @throw std::out_of_range if there is no such actuator
+     * @throw std::invalid_argument if restLength is negative or not a
+     * number
+     */
+    void post(std::size_t actuator, double restLength);
+
+    /**
+     * Stop commanding an actuator from any thread. It keeps the rest
+     * length it has.
+     * @param[in] actuator the index of the actuator
+     * @throw std::out_of_range if there is no such actuator
+     */
+    void clear(std::size_t actuator);
+
+    /**
+     * Read an actuator's latest state from any thread.
+     * @param[in] actuator the index of the actuator
+     * @param[out] state the state, if one has been published
+     * @param[in] maxTries the number of times to retry while the state
+     * is being written
+     * @return false if no state has been published or every try found
+     * it being written
+     * @throw std::out_of_range if there is no such actuator
+     */
+    bool readState(std::size_t actuator, State& state,
+                   std::size_t maxTries = 100) const;
+
+    /**
+     * Publish the actuator's state, then apply its command, if any.
+     * Called by the simulation thread.
+     * @param[in,out] subject an actuator passed to attach()
+     * @param[in] dt the step size
+     */
+    virtual void onStep(tgSpringCableActuator& subject, double dt);
+
+    /** @return the number of actuators, zero until attach() */
+    std::size_t getActuators() const { return m_actuators; }
+
+private:
+
+    /**
+     * The command and state of one actuator, padded to a cache line so
+     * that threads working on neighbouring actuators don't share one.
+     * Every field is atomic, doubles being kept as their bits, so that
+     * nothing is read while it is written.
+     */
+    struct Slot
+    {
+        Slot();
+
+        /** The rest length, or noCommand */
+        boost::atomic<boost::uint64_t> command;
+
+        /** Zero until published, odd while the state is being written */
+        boost::atomic<boost::uint64_t> sequence;
+
+        /** The step count, then the doubles of State in order */
+        boost::atomic<boost::uint64_t> state[5];
+
+        char padding[64 - 7 * sizeof(boost::uint64_t) % 64];
+    };
+
+    /** Not copyable: the actuators point to this mailbox. */
+    tgCommandMailbox(const tgCommandMailbox&);
+    tgCommandMailbox& operator=(const tgCommandMailbox&);
+
+    /** @throw std::out_of_range if there is no such actuator */
+    Slot& slotOf(std::size_t actuator) const;
+
+    /** The bits of a NaN that post() never stores */
+    static const boost::uint64_t noCommand;
+
+    /** One per actuator; allocated by the first attach() */
+    boost::scoped_array<Slot> m_slots;
+
+    std::size_t m_actuators;
+
+    /** The index of each attached actuator. */
+    std::map<const tgSpringCableActuator*, std::size_t> m_index;
+};
+
+#endif  // TG_COMMAND_MAILBOX_H
@@ -0,0 +1,105 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+/**
+ * @file tgControlInputReplay.cpp
+ * @brief Implementation of the tgControlInputReplay class
+ * $Id$
+ */
+
+#include "tgControlInputReplay.h"
+
+#include "core/tgCast.h"
+#include "core/tgModel.h"
+#include "core/tgSpringCableActuator.h"
+
+// The C++ Standard Library
+#include <cassert>
+#include <stdexcept>
+
+tgControlInputReplay::tgControlInputReplay(const tgControlInputRecord& record) :
+m_inputs(record.getActuators()),
+m_next(record.getActuators(), 0)
+{
+	const std::vector<tgControlInputRecord::Input>& inputs = record.getInputs();
+	for (std::size_t i = 0; i < inputs.size(); i++)
+	{
+		assert(inputs[i].actuator < m_inputs.size());
+		m_inputs[inputs[i].actuator].push_back(inputs[i]);
+	}
+}
+
+tgControlInputReplay::~tgControlInputReplay()
+{
+}
+
+void tgControlInputReplay::attach(tgModel& model)
+{
+	const std::vector<tgSpringCableActuator*> actuators =
+		tgCast::filter<tgModel, tgSpringCableActuator>(model.getDescendants());
+	if (actuators.size() != m_inputs.size())
+	{
+		throw std::invalid_argument("Model does not have the recorded number of actuators.");
+	}
+	m_index.clear();
+	for (std::size_t i = 0; i < actuators.size(); i++)
+	{
+		m_index[actuators[i]] = i;
+		m_next[i] = 0;
+		actuators[i]->attach(this);
+	}
+}
+
+void tgControlInputReplay::onStep(tgSpringCableActuator& subject, double dt)
+{
+	const std::map<const tgSpringCableActuator*, std::size_t>::const_iterator
+		it = m_index.find(&subject);
+	if (it == m_index.end())
+	{
+		return;
+	}
+	const std::vector<tgControlInputRecord::Input>& inputs = m_inputs[it->second];
+	std::size_t& next = m_next[it->second];
+	const std::size_t step = subject.getStepCount();
+	// Inputs before this step were applied in their own steps, unless
+	// the replay was attached late
+	while (next < inputs.size() && inputs[next].step <= step)
+	{
+		const tgControlInputRecord::Input& input = inputs[next];
+		if (input.dt > 0.0)
+		{
+			subject.setControlInput(input.value, input.dt);
+		}
+		else
+		{
+			subject.setControlInput(input.value);
+		}
+		++next;
+	}
+}
+
+bool tgControlInputReplay::finished() const
+{
+	for (std::size_t i = 0; i < m_inputs.size(); i++)
+	{
+		if (m_next[i] < m_inputs[i].size())
+		{
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+#ifndef TG_CONTROL_INPUT_REPLAY_H
+#define TG_CONTROL_INPUT_REPLAY_H
+
+/**
+ * @file tgControlInputReplay.h
+ * @brief Definition of the tgControlInputReplay class
+ * $Id$
+ */
+
+// This application
+#include "core/tgControlInputRecord.h"
+#include "core/tgObserver.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <map>
+#include <vector>
+
+// Forward declarations
+class tgModel;
+class tgSpringCableActuator;
+
+/**
+ * Feeds a tgControlInputRecord back into a model in place of its
+ * controller. Each actuator gets the inputs recorded for it before the
+ * same step, in the same order, so nothing is computed but the physics.
+ * The actuators are observed directly, so it does not matter which
+ * model the original controller was attached to.
+ */
+class tgControlInputReplay : public tgObserver<tgSpringCableActuator>
+{
+public:
+
+    /**
+     * @param[in] record the inputs to replay, which are copied
+     */
+    tgControlInputReplay(const tgControlInputRecord& record);
+
+    virtual ~tgControlInputReplay();
+
+    /**
+     * Attach to every spring cable actuator below a model and start from
+     * the first input. The actuators are recreated by a reset, so call
+     * this again after each one.
+     * @param[in,out] model a model that has been set up
+     * @throw std::invalid_argument if the model does not have as many
+     * actuators as the record
+     */
+    void attach(tgModel& model);
+
+    /**
+     * Apply the inputs recorded for this actuator before its current
+     * step.
+     * @param[in,out] subject an actuator passed to attach()
+     * @param[in] dt the step size
+     */
+    virtual void onStep(tgSpringCableActuator& subject, double dt);
+
+    /** @return true if every input has been applied */
+    bool finished() const;
+
+private:
+
+    /** The inputs of each actuator, in the order they arrived. */
+    std::vector<std::vector<tgControlInputRecord::Input> > m_inputs;
+
+    /** The next input of each actuator. */
+    std::vector<std::size_t> m_next;
+
+    /** The index of each attached actuator. */
+    std::map<const tgSpringCableActuator*, std::size_t> m_index;
+};
+
+#endif  // TG_CONTROL_INPUT_REPLAY_H
@@ -0,0 +1,405 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgHardwareBridge.cpp
+ * @brief Implementation of the tgHardwareBridge class
+ * $Id$
+ */
+
+// This module
+#include "tgHardwareBridge.h"
+// This library
+#include "tgCommandMailbox.h"
+// Boost
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+// The C++ Standard Library
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+// POSIX
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace
+{
+	const unsigned char magic[4] = { 'N', 'T', 'H', 'B' };
+
+	/** The weight of each new round trip in the smoothed one */
+	const double smoothing = 0.1;
+
+	/** The largest datagram received */
+	const std::size_t maxFrame = 65536;
+
+	void put(std::vector<unsigned char>& buffer, boost::uint64_t value,
+	         std::size_t bytes)
+	{
+		for (std::size_t i = 0; i < bytes; i++)
+		{
+			buffer.push_back(static_cast<unsigned char>(value >> (8 * i)));
+		}
+	}
+
+	boost::uint64_t get(const unsigned char* data, std::size_t bytes)
+	{
+		boost::uint64_t value = 0;
+		for (std::size_t i = 0; i < bytes; i++)
+		{
+			value |= static_cast<boost::uint64_t>(data[i]) << (8 * i);
+		}
+		return value;
+	}
+
+	boost::uint64_t toBits(double value)
+	{
+		boost::uint64_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	double fromBits(boost::uint64_t bits)
+	{
+		double value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	/** A NaN is the only value not equal to itself */
+	bool isNaN(float value)
+	{
+		return value != value;
+	}
+
+	/** True if sequence a comes after b, allowing for wrap around */
+	bool isNewer(boost::uint32_t a, boost::uint32_t b)
+	{
+		return a != b && static_cast<boost::uint32_t>(a - b) < 0x80000000u;
+	}
+}
+
+const std::size_t tgHardwareBridge::headerSize;
+const boost::uint16_t tgHardwareBridge::version;
+
+tgHardwareBridge::Config::Config(const std::string& remoteHost,
+                                 unsigned short remotePort,
+                                 unsigned short localPort,
+                                 double period,
+                                 bool compensate) :
+remoteHost(remoteHost),
+remotePort(remotePort),
+localPort(localPort),
+period(period),
+compensate(compensate)
+{
+}
+
+tgHardwareBridge::Frame::Frame() :
+type(eState),
+sequence(0),
+sendTime(0),
+echoTime(0),
+echoDelay(0)
+{
+}
+
+void tgHardwareBridge::encode(const Frame& frame,
+                              std::vector<unsigned char>& buffer)
+{
+	buffer.clear();
+	buffer.reserve(headerSize + 4 * frame.values.size());
+	buffer.insert(buffer.end(), magic, magic + 4);
+	put(buffer, version, 2);
+	put(buffer, frame.type, 2);
+	put(buffer, frame.sequence, 4);
+	put(buffer, frame.values.size(), 4);
+	put(buffer, frame.sendTime, 8);
+	put(buffer, frame.echoTime, 8);
+	put(buffer, frame.echoDelay, 8);
+	for (std::size_t i = 0; i < frame.values.size(); i++)
+	{
+		boost::uint32_t bits;
+		std::memcpy(&bits, &frame.values[i], sizeof(bits));
+		put(buffer, bits, 4);
+	}
+}
+
+bool tgHardwareBridge::decode(const unsigned char* data, std::size_t size,
+                              Frame& frame)
+{
+	if (size < headerSize || std::memcmp(data, magic, 4) != 0 ||
+		get(data + 4, 2) != version)
+	{
+		return false;
+	}
+	const boost::uint64_t type = get(data + 6, 2);
+	if (type != Frame::eState && type != Frame::eCommand)
+	{
+		return false;
+	}
+	const std::size_t count = static_cast<std::size_t>(get(data + 12, 4));
+	if (size != headerSize + 4 * count)
+	{
+		return false;
+	}
+	frame.type = static_cast<Frame::Type>(type);
+	frame.sequence = static_cast<boost::uint32_t>(get(data + 8, 4));
+	frame.sendTime = get(data + 16, 8);
+	frame.echoTime = get(data + 24, 8);
+	frame.echoDelay = get(data + 32, 8);
+	frame.values.resize(count);
+	for (std::size_t i = 0; i < count; i++)
+	{
+		const boost::uint32_t bits = static_cast<boost::uint32_t>(
+			get(data + headerSize + 4 * i, 4));
+		std::memcpy(&frame.values[i], &bits, sizeof(bits));
+	}
+	return true;
+}
+
+tgHardwareBridge::tgHardwareBridge(tgCommandMailbox& mailbox,
+                                   const Config& config) :
+m_mailbox(mailbox),
+m_config(config),
+m_socket(-1),
+m_running(false),
+m_sequence(0),
+m_haveCommand(false),
+m_lastCommand(0),
+m_echoTime(0),
+m_echoReceived(0),
+m_roundTrip(toBits(0.0)),
+m_sent(0),
+m_received(0),
+m_dropped(0)
+{
+	if (!(config.period > 0.0))
+	{
+		throw std::invalid_argument("Bridge period is not positive.");
+	}
+
+	sockaddr_in remote;
+	std::memset(&remote, 0, sizeof(remote));
+	remote.sin_family = AF_INET;
+	remote.sin_port = htons(config.remotePort);
+	if (inet_pton(AF_INET, config.remoteHost.c_str(), &remote.sin_addr) != 1)
+	{
+		throw std::invalid_argument("Not an IPv4 address: " + config.remoteHost);
+	}
+	const unsigned char* const pRemote =
+		reinterpret_cast<const unsigned char*>(&remote);
+	m_remote.assign(pRemote, pRemote + sizeof(remote));
+
+	m_socket = socket(AF_INET, SOCK_DGRAM, 0);
+	if (m_socket < 0)
+	{
+		throw std::runtime_error("Can't open the bridge's socket: " +
+		                         std::string(std::strerror(errno)));
+	}
+	sockaddr_in local;
+	std::memset(&local, 0, sizeof(local));
+	local.sin_family = AF_INET;
+	local.sin_port = htons(config.localPort);
+	local.sin_addr.s_addr = htonl(INADDR_ANY);
+	if (bind(m_socket, reinterpret_cast<const sockaddr*>(&local),
+	         sizeof(local)) != 0)
+	{
+		const std::string error(std::strerror(errno));
+		close(m_socket);
+		throw std::runtime_error("Can't bind the bridge's port: " + error);
+	}
+}
+
+tgHardwareBridge::~tgHardwareBridge()
+{
+	stop();
+	close(m_socket);
+}
+
+void tgHardwareBridge::start()
+{
+	if (!m_pThread)
+	{
+		m_running.store(true);
+		m_pThread.reset(new boost::thread(boost::bind(&tgHardwareBridge::run,
+		                                              this)));
+	}
+}
+
+void tgHardwareBridge::stop()
+{
+	if (m_pThread)
+	{
+		m_running.store(false);
+		m_pThread->join();
+		m_pThread.reset();
+	}
+}
+
+void tgHardwareBridge::run()
+{
+	const boost::uint64_t period =
+		static_cast<boost::uint64_t>(m_config.period * 1.0e6 + 0.5);
+	boost::uint64_t next = now();
+	while (m_running.load())
+	{
+		// Apply commands as they come, not only at the tick
+		const boost::uint64_t t = now();
+		if (t < next)
+		{
+			pollfd pending;
+			pending.fd = m_socket;
+			pending.events = POLLIN;
+			const int milliseconds =
+				static_cast<int>((next - t + 999) / 1000);
+			if (poll(&pending, 1, milliseconds) > 0)
+			{
+				receive(now());
+			}
+			continue;
+		}
+		tick();
+		next += period;
+		if (next < now())
+		{
+			// Fell behind; skip the missed ticks rather than burst
+			next = now() + period;
+		}
+	}
+}
+
+void tgHardwareBridge::tick()
+{
+	const boost::uint64_t t = now();
+	receive(t);
+	send(t);
+}
+
+void tgHardwareBridge::receive(boost::uint64_t t)
+{
+	m_buffer.resize(maxFrame);
+	Frame frame;
+	for (;;)
+	{
+		const ssize_t size = recv(m_socket, &m_buffer[0], m_buffer.size(),
+		                          MSG_DONTWAIT);
+		if (size < 0)
+		{
+			return;
+		}
+		m_received.fetch_add(1);
+
+		const std::size_t actuators = m_mailbox.getActuators();
+		bool valid = decode(&m_buffer[0], size, frame) &&
+			frame.type == Frame::eCommand &&
+			frame.values.size() == actuators &&
+			(!m_haveCommand || isNewer(frame.sequence, m_lastCommand));
+		for (std::size_t i = 0; valid && i < actuators; i++)
+		{
+			valid = isNaN(frame.values[i]) || frame.values[i] >= 0.0f;
+		}
+		if (!valid)
+		{
+			m_dropped.fetch_add(1);
+			continue;
+		}
+
+		for (std::size_t i = 0; i < actuators; i++)
+		{
+			if (isNaN(frame.values[i]))
+			{
+				m_mailbox.clear(i);
+			}
+			else
+			{
+				m_mailbox.post(i, frame.values[i]);
+			}
+		}
+		m_haveCommand = true;
+		m_lastCommand = frame.sequence;
+		m_echoTime = frame.sendTime;
+		m_echoReceived = t;
+
+		// The peer held our frame for echoDelay of the round trip
+		if (frame.echoTime != 0 && t > frame.echoTime + frame.echoDelay)
+		{
+			const double sample = (t - frame.echoTime - frame.echoDelay) * 1.0e-6;
+			const double previous = getRoundTrip();
+			const double smoothed = previous == 0.0 ? sample :
+				previous + smoothing * (sample - previous);
+			m_roundTrip.store(toBits(smoothed));
+		}
+	}
+}
+
+void tgHardwareBridge::send(boost::uint64_t t)
+{
+	const std::size_t actuators = m_mailbox.getActuators();
+	const double ahead = m_config.compensate ? 0.5 * getRoundTrip() : 0.0;
+	const float unknown = std::numeric_limits<float>::quiet_NaN();
+
+	Frame frame;
+	frame.type = Frame::eState;
+	frame.sequence = ++m_sequence;
+	frame.sendTime = t;
+	frame.echoTime = m_echoTime;
+	frame.echoDelay = m_echoTime != 0 ? t - m_echoReceived : 0;
+	frame.values.reserve(4 * actuators);
+	for (std::size_t i = 0; i < actuators; i++)
+	{
+		tgCommandMailbox::State state;
+		if (m_mailbox.readState(i, state))
+		{
+			frame.values.push_back(state.restLength);
+			frame.values.push_back(state.currentLength + state.velocity * ahead);
+			frame.values.push_back(state.velocity);
+			frame.values.push_back(state.tension);
+		}
+		else
+		{
+			frame.values.insert(frame.values.end(), 4, unknown);
+		}
+	}
+
+	encode(frame, m_buffer);
+	// A lost or refused datagram is only a missed tick
+	if (sendto(m_socket, &m_buffer[0], m_buffer.size(), 0,
+	           reinterpret_cast<const sockaddr*>(&m_remote[0]),
+	           m_remote.size()) >= 0)
+	{
+		m_sent.fetch_add(1);
+	}
+}
+
+double tgHardwareBridge::getRoundTrip() const
+{
+	return fromBits(m_roundTrip.load());
+}
+
+boost::uint64_t tgHardwareBridge::now()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<boost::uint64_t>(ts.tv_sec) * 1000000u +
+		ts.tv_nsec / 1000;
+}
@@ -0,0 +1,223 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_HARDWARE_BRIDGE_H
+#define TG_HARDWARE_BRIDGE_H
+
+/**
+ * @file tgHardwareBridge.h
+ * @brief Definition of the tgHardwareBridge class
+ * $Id$
+ */
+
+// Boost
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/scoped_ptr.hpp>
+// The C++ Standard Library
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class tgCommandMailbox;
+namespace boost { class thread; }
+
+/**
+ * Connects the actuators of a tgCommandMailbox to hardware, or to a
+ * controller running on it, over UDP: once per control tick the bridge
+ * sends the state of every actuator as one frame, and every command
+ * frame it receives sets the rest length of every actuator at once, so
+ * a whole robot's I/O costs one packet each way per tick. The bridge
+ * runs on a thread of its own and only touches the mailbox, so the
+ * simulation thread never waits on the network.
+ *
+ * Frames are timestamped with the sender's monotonic clock and echo the
+ * timestamp of the last frame received, with how long it was held, so
+ * the bridge measures the round trip without synchronized clocks. With
+ * Config::compensate, the lengths it sends are extrapolated by their
+ * velocity over half the round trip, to where they will be when the
+ * frame arrives; that assumes the simulation runs in real time, see
+ * tgRealTimePacing. Frames older than the newest one received are
+ * dropped.
+ *
+ * A frame is little endian: a 40 byte header of the magic "NTHB", the
+ * version and type as 16 bit integers, the sequence number and number of
+ * values as 32 bit integers, then the send time, the echoed time and the
+ * echo delay in microseconds as 64 bit integers, followed by the values
+ * as 32 bit floats. A state frame holds four values per actuator: rest
+ * length, current length, velocity and tension. A command frame holds
+ * one rest length per actuator, NaN to stop commanding it.
+ */
+class tgHardwareBridge
+{
+public:
+
+    struct Config
+    {
+        Config(const std::string& remoteHost = "127.0.0.1",
+               unsigned short remotePort = 9870,
+               unsigned short localPort = 9871,
+               double period = 0.01,
+               bool compensate = true);
+
+        /** The IPv4 address of the hardware, in dotted form */
+        std::string remoteHost;
+
+        unsigned short remotePort;
+
+        /** The port command frames are received on */
+        unsigned short localPort;
+
+        /** The control tick in seconds of wall clock time, positive */
+        double period;
+
+        /** Extrapolate the lengths sent over half the round trip */
+        bool compensate;
+    };
+
+    /** The contents of one frame */
+    struct Frame
+    {
+        enum Type
+        {
+            eState = 1,
+            eCommand = 2
+        };
+
+        Frame();
+
+        Type type;
+
+        boost::uint32_t sequence;
+
+        /** Microseconds of the sender's monotonic clock */
+        boost::uint64_t sendTime;
+
+        /** The sendTime of the last frame the sender received, or 0 */
+        boost::uint64_t echoTime;
+
+        /** Microseconds between receiving that frame and sending this */
+        boost::uint64_t echoDelay;
+
+        std::vector<float> values;
+    };
+
+    /** The number of bytes before a frame's values */
+    static const std::size_t headerSize = 40;
+
+    static const boost::uint16_t version = 1;
+
+    /** Replace the contents of a buffer with a frame. */
+    static void encode(const Frame& frame, std::vector<unsigned char>& buffer);
+
+    /**
+     * @return false, leaving the frame unspecified, if the bytes are not
+     * a frame of this version
+     */
+    static bool decode(const unsigned char* data, std::size_t size,
+                       Frame& frame);
+
+    /**
+     * Open the socket; start() starts the ticks.
+     * @param[in] mailbox attached to the model's actuators before
+     * start(); not owned, it must outlive the bridge
+     * @throw std::invalid_argument if the period is not positive or the
+     * host is not an IPv4 address
+     * @throw std::runtime_error if the socket can't be opened or bound
+     */
+    tgHardwareBridge(tgCommandMailbox& mailbox, const Config& config = Config());
+
+    /** Stops the thread and closes the socket. */
+    ~tgHardwareBridge();
+
+    /** Start ticking on the bridge's thread, if it isn't already. */
+    void start();
+
+    /** Stop ticking, waiting for the current tick to end. */
+    void stop();
+
+    /**
+     * Receive every pending command frame, then send one state frame.
+     * The bridge's thread calls this each period; an application
+     * ticking on its own thread may call it instead of start().
+     */
+    void tick();
+
+    /** @return the smoothed round trip in seconds, 0 until measured */
+    double getRoundTrip() const;
+
+    std::size_t getFramesSent() const { return m_sent.load(); }
+
+    std::size_t getFramesReceived() const { return m_received.load(); }
+
+    /** @return the frames dropped as malformed, mismatched or stale */
+    std::size_t getFramesDropped() const { return m_dropped.load(); }
+
+    const Config& getConfig() const { return m_config; }
+
+private:
+
+    /** Not copyable, the thread points to the bridge */
+    tgHardwareBridge(const tgHardwareBridge&);
+    tgHardwareBridge& operator=(const tgHardwareBridge&);
+
+    /** The thread's loop */
+    void run();
+
+    void receive(boost::uint64_t now);
+
+    void send(boost::uint64_t now);
+
+    /** Microseconds of the monotonic clock */
+    static boost::uint64_t now();
+
+    tgCommandMailbox& m_mailbox;
+
+    const Config m_config;
+
+    int m_socket;
+
+    /** The remote address, a sockaddr_in */
+    std::vector<unsigned char> m_remote;
+
+    boost::scoped_ptr<boost::thread> m_pThread;
+
+    boost::atomic<bool> m_running;
+
+    // Only touched by the ticking thread
+
+    boost::uint32_t m_sequence;
+
+    /** The last command frame accepted; its sequence orders the next */
+    bool m_haveCommand;
+    boost::uint32_t m_lastCommand;
+    boost::uint64_t m_echoTime;
+    boost::uint64_t m_echoReceived;
+
+    std::vector<unsigned char> m_buffer;
+
+    /** The round trip in seconds, as the bits of a double */
+    boost::atomic<boost::uint64_t> m_roundTrip;
+
+    boost::atomic<std::size_t> m_sent;
+    boost::atomic<std::size_t> m_received;
+    boost::atomic<std::size_t> m_dropped;
+};
+
+#endif  // TG_HARDWARE_BRIDGE_H
@@ -0,0 +1,217 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgImpedanceControllerBank.cpp
+ * @brief Implementation of the tgImpedanceControllerBank class
+ * $Id$
+ */
+
+// This module
+#include "tgImpedanceControllerBank.h"
+// This library
+#include "tgImpedanceController.h"
+#include "tgPIDControllerBank.h"
+#include "tgTensionController.h"
+#include "core/tgBasicActuator.h"
+// The C++ Standard Library
+#include <stdexcept>
+
+namespace
+{
+    /** @return the set tensions as doubles, without a copy if they are */
+    const double* asDoubles(const std::vector<double>& values,
+                            std::vector<double>& scratch)
+    {
+        (void)scratch;
+        return &values[0];
+    }
+
+    const double* asDoubles(const std::vector<float>& values,
+                            std::vector<double>& scratch)
+    {
+        scratch.assign(values.begin(), values.end());
+        return &scratch[0];
+    }
+}
+
+template <typename Scalar>
+tgImpedanceControllerBankT<Scalar>::tgImpedanceControllerBankT()
+{
+}
+
+template <typename Scalar>
+tgImpedanceControllerBankT<Scalar>::~tgImpedanceControllerBankT()
+{
+}
+
+template <typename Scalar>
+std::size_t tgImpedanceControllerBankT<Scalar>::add(tgBasicActuator* actuator,
+                                           double offsetTension,
+                                           double lengthStiffness,
+                                           double velStiffness)
+{
+    if (actuator == NULL)
+    {
+        throw std::invalid_argument("Actuator is NULL.");
+    }
+    else if (offsetTension < 0.0)
+    {
+        throw std::invalid_argument("Offset tension is negative.");
+    }
+    else if (lengthStiffness < 0.0)
+    {
+        throw std::invalid_argument("Length stiffness is negative.");
+    }
+    else if (velStiffness < 0.0)
+    {
+        throw std::invalid_argument("Velocity stiffness is negative.");
+    }
+    m_actuators.push_back(actuator);
+    m_offsetTension.push_back(static_cast<Scalar>(offsetTension));
+    m_lengthStiffness.push_back(static_cast<Scalar>(lengthStiffness));
+    m_velStiffness.push_back(static_cast<Scalar>(velStiffness));
+    m_position.push_back(Scalar(0));
+    m_offsetVel.push_back(Scalar(0));
+    m_length.push_back(Scalar(0));
+    m_velocity.push_back(Scalar(0));
+    m_tension.push_back(Scalar(0));
+    m_setTension.push_back(Scalar(0));
+    return m_actuators.size() - 1;
+}
+
+template <typename Scalar>
+std::size_t tgImpedanceControllerBankT<Scalar>::add(tgBasicActuator* actuator,
+                                           const tgImpedanceController& gains)
+{
+    return add(actuator,
+               gains.getOffsetTension(),
+               gains.getLengthStiffness(),
+               gains.getVelStiffness());
+}
+
+template <typename Scalar>
+void tgImpedanceControllerBankT<Scalar>::setTarget(std::size_t i,
+                                          double position,
+                                          double offsetVel)
+{
+    check(i);
+    m_position[i] = static_cast<Scalar>(position);
+    m_offsetVel[i] = static_cast<Scalar>(offsetVel);
+}
+
+template <typename Scalar>
+void tgImpedanceControllerBankT<Scalar>::setOffsetTension(std::size_t i,
+                                                 double offsetTension)
+{
+    check(i);
+    if (offsetTension < 0.0)
+    {
+        throw std::invalid_argument("Offset tension is negative.");
+    }
+    m_offsetTension[i] = static_cast<Scalar>(offsetTension);
+}
+
+template <typename Scalar>
+double tgImpedanceControllerBankT<Scalar>::getSetTension(std::size_t i) const
+{
+    check(i);
+    return m_setTension[i];
+}
+
+template <typename Scalar>
+void tgImpedanceControllerBankT<Scalar>::findSetTensions()
+{
+    const std::size_t n = m_actuators.size();
+    if (n == 0)
+    {
+        return;
+    }
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const tgBasicActuator& actuator = *m_actuators[i];
+        m_length[i] = static_cast<Scalar>(actuator.getCurrentLength());
+        m_velocity[i] = static_cast<Scalar>(actuator.getVelocity());
+        m_tension[i] = static_cast<Scalar>(actuator.getTension());
+    }
+
+    // Only arithmetic on the arrays here, so the loop vectorizes
+    const Scalar* const offset = &m_offsetTension[0];
+    const Scalar* const kLength = &m_lengthStiffness[0];
+    const Scalar* const kVel = &m_velStiffness[0];
+    const Scalar* const position = &m_position[0];
+    const Scalar* const offsetVel = &m_offsetVel[0];
+    const Scalar* const length = &m_length[0];
+    const Scalar* const velocity = &m_velocity[0];
+    Scalar* const setTension = &m_setTension[0];
+    for (std::size_t i = 0; i < n; i++)
+    {
+        // As determineSetTension in tgImpedanceController.cpp
+        const Scalar tension = offset[i] +
+            kLength[i] * (length[i] - position[i]) +
+            kVel[i] * (velocity[i] - offsetVel[i]);
+        setTension[i] = tension > 0 ? tension : Scalar(0);
+    }
+}
+
+template <typename Scalar>
+void tgImpedanceControllerBankT<Scalar>::control(double dt)
+{
+    if (dt <= 0.0)
+    {
+        throw std::runtime_error ("Timestep must be positive.");
+    }
+    findSetTensions();
+    if (!m_actuators.empty())
+    {
+        tgTensionController::control(&m_actuators[0], m_actuators.size(), dt,
+                                     asDoubles(m_setTension, m_setTensionInput));
+    }
+}
+
+template <typename Scalar>
+void tgImpedanceControllerBankT<Scalar>::control(double dt, tgPIDControllerBankT<Scalar>& pids)
+{
+    if (dt <= 0.0)
+    {
+        throw std::runtime_error ("Timestep must be positive.");
+    }
+    else if (pids.size() != m_actuators.size())
+    {
+        throw std::invalid_argument("The PID bank is not the same size.");
+    }
+    findSetTensions();
+    for (std::size_t i = 0; i < m_actuators.size(); i++)
+    {
+        pids.setSetPoint(i, m_setTension[i]);
+        pids.setSensorData(i, m_tension[i]);
+    }
+    pids.control(dt);
+}
+
+template <typename Scalar>
+void tgImpedanceControllerBankT<Scalar>::check(std::size_t i) const
+{
+    if (i >= m_actuators.size())
+    {
+        throw std::out_of_range("No such actuator in the bank.");
+    }
+}
+
+template class tgImpedanceControllerBankT<double>;
+template class tgImpedanceControllerBankT<float>;
@@ -0,0 +1,160 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_IMPEDANCE_CONTROLLER_BANK_H
+#define TG_IMPEDANCE_CONTROLLER_BANK_H
+
+/**
+ * @file tgImpedanceControllerBank.h
+ * @brief Definition of the tgImpedanceControllerBank class
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class tgBasicActuator;
+class tgImpedanceController;
+template <typename Scalar> class tgPIDControllerBankT;
+
+/**
+ * The impedance control of many tgBasicActuators, run together. The
+ * gains and targets are kept in arrays: control() reads the length,
+ * velocity and tension of every actuator, finds every set tension in one
+ * pass of arithmetic that the compiler can vectorize, and then applies
+ * them, as tgImpedanceController does for one actuator.
+ *
+ * The set tensions are found in Scalar: tgImpedanceControllerBank is
+ * double and tgImpedanceControllerBankF is float, which pairs with
+ * tgPIDControllerBankF. Only float and double are instantiated.
+ */
+template <typename Scalar>
+class tgImpedanceControllerBankT
+{
+public:
+
+    tgImpedanceControllerBankT();
+
+    /** The actuators are not owned, so there is nothing to delete */
+    ~tgImpedanceControllerBankT();
+
+    /**
+     * Add an actuator.
+     * @param[in] actuator the actuator to control; must not be NULL
+     * @param[in] offsetTension the offset tension; must be non-negative
+     * @param[in] lengthStiffness the length stiffness; must be
+     * non-negative
+     * @param[in] velStiffness the velocity stiffness; must be
+     * non-negative
+     * @return the slot of the actuator
+     * @throw std::invalid_argument if actuator is NULL or a gain is
+     * negative
+     */
+    std::size_t add(tgBasicActuator* actuator,
+                    double offsetTension,
+                    double lengthStiffness,
+                    double velStiffness);
+
+    /**
+     * Add an actuator with the gains of a tgImpedanceController.
+     * @throw std::invalid_argument if actuator is NULL
+     */
+    std::size_t add(tgBasicActuator* actuator,
+                    const tgImpedanceController& gains);
+
+    /** @return the number of actuators */
+    std::size_t size() const { return m_actuators.size(); }
+
+    /**
+     * @param[in] i a slot returned by add()
+     * @param[in] position the length the actuator is pulled towards
+     * @param[in] offsetVel the velocity the actuator is pulled towards
+     * @throw std::out_of_range if there is no slot i
+     */
+    void setTarget(std::size_t i, double position, double offsetVel = 0.0);
+
+    /**
+     * @param[in] i a slot returned by add()
+     * @param[in] offsetTension the new offset tension; must be
+     * non-negative
+     * @throw std::out_of_range if there is no slot i
+     * @throw std::invalid_argument if offsetTension is negative
+     */
+    void setOffsetTension(std::size_t i, double offsetTension);
+
+    /**
+     * @param[in] i a slot returned by add()
+     * @return the tension set by the last control()
+     * @throw std::out_of_range if there is no slot i
+     */
+    double getSetTension(std::size_t i) const;
+
+    /**
+     * Set the tension of every actuator with tgTensionController.
+     * @param[in] dt the timestep; must be positive
+     * @throw std::runtime_error if dt is not positive
+     */
+    void control(double dt);
+
+    /**
+     * Reach the set tensions through PID loops, as
+     * tgImpedanceController::controlTension does with a tgPIDController.
+     * @param[in] dt the timestep; must be positive
+     * @param[in,out] pids controls actuator i in its slot i
+     * @throw std::runtime_error if dt is not positive
+     * @throw std::invalid_argument if pids is not the same size
+     */
+    void control(double dt, tgPIDControllerBankT<Scalar>& pids);
+
+private:
+
+    /** Read the actuators and fill m_setTension */
+    void findSetTensions();
+
+    /** @throw std::out_of_range if there is no slot i */
+    void check(std::size_t i) const;
+
+    /** The actuators; not owned */
+    std::vector<tgBasicActuator*> m_actuators;
+
+    std::vector<Scalar> m_offsetTension;
+    std::vector<Scalar> m_lengthStiffness;
+    std::vector<Scalar> m_velStiffness;
+
+    std::vector<Scalar> m_position;
+    std::vector<Scalar> m_offsetVel;
+
+    /** Read from the actuators by each control() */
+    std::vector<Scalar> m_length;
+    std::vector<Scalar> m_velocity;
+    std::vector<Scalar> m_tension;
+
+    /** The result of the last control() */
+    std::vector<Scalar> m_setTension;
+
+    /** m_setTension as doubles, for the float version's control(dt) */
+    std::vector<double> m_setTensionInput;
+};
+
+typedef tgImpedanceControllerBankT<double> tgImpedanceControllerBank;
+
+typedef tgImpedanceControllerBankT<float> tgImpedanceControllerBankF;
+
+#endif  // TG_IMPEDANCE_CONTROLLER_BANK_H
@@ -26,6 +26,7 @@
 
 
 #include "tgPIDController.h"
+#include "tgPIDControllerBank.h"
 
 #include "core/tgControllable.h"
 
@@ -63,11 +64,21 @@ startingSetPoint(setPoint)
 	
 
 tgPIDController::tgPIDController(tgControllable* controllable, tgPIDController::Config config) :
-m_sensorData(0.0),
-m_prevError(0.0),
-m_intError(0.0),
-m_config(config),
-tgBasicController(controllable, config.startingSetPoint)
+tgBasicController(controllable, config.startingSetPoint),
+m_pBank(new tgPIDControllerBank()),
+m_ownsBank(true),
+m_index(m_pBank->add(controllable, config))
+{
+	assert(controllable != NULL);
+}
+
+tgPIDController::tgPIDController(tgPIDControllerBank& bank,
+                                 tgControllable* controllable,
+                                 tgPIDController::Config config) :
+tgBasicController(controllable, config.startingSetPoint),
+m_pBank(&bank),
+m_ownsBank(false),
+m_index(bank.add(controllable, config))
 {
 	assert(controllable != NULL);
 }
@@ -75,6 +86,10 @@ tgBasicController(controllable, config.startingSetPoint)
 tgPIDController::~tgPIDController()
 {
 	// tgBasicController owns m_controllable
+	if (m_ownsBank)
+	{
+		delete m_pBank;
+	}
 }
 	
 void tgPIDController::control(double dt)
@@ -84,17 +99,7 @@ void tgPIDController::control(double dt)
 		throw std::runtime_error ("Timestep must be positive.");
 	}
 	
-	double error = m_setPoint - m_sensorData;
-	
-	/// Integrate using trapezoid rule to reduce error in integration over rectangle
-	m_intError += (error + m_prevError) / 2.0 * dt;
-	double dError = (error - m_prevError) / dt;
-	double result = m_config.kP * error + m_config.kI * m_intError +
-					m_config.kD * dError;
-	
-	m_controllable->setControlInput(result);
-	
-	m_prevError = error;
+	m_pBank->control(m_index, dt);
 }
 	
 void tgPIDController::control(double dt, double setPoint, double sensorData)
@@ -109,8 +114,14 @@ void tgPIDController::control(double dt, double setPoint, double sensorData)
 	control(dt);
 }
 
+void tgPIDController::setNewSetPoint(double newSetPoint)
+{
+	tgBasicController::setNewSetPoint(newSetPoint);
+	m_pBank->setSetPoint(m_index, newSetPoint);
+}
+
 void tgPIDController::setSensorData(double sensorData)
 {
 	/// @todo - are there any sanity checks we can enforce here?
-	m_sensorData = sensorData;
+	m_pBank->setSensorData(m_index, sensorData);
 }
@@ -29,14 +29,23 @@
 
 #include "tgBasicController.h"
 
+// The C++ Standard Library
+#include <cstddef>
+
 // Forward declarations
 class tgControllable;
+template <typename Scalar> class tgPIDControllerBankT;
+typedef tgPIDControllerBankT<double> tgPIDControllerBank;
 
 /**
  * Applies PID control to its tgControllable. Will work for any controllable
  * for which we can get an approprate sensor input. Depending on the system
  * it may be necessary to invert the output, this is done within the 
  * config file upon construction.
+ *
+ * The state of the loop is kept in a slot of a tgPIDControllerBank: a
+ * bank of its own, or a shared one whose control(dt) runs all of its
+ * loops in one pass.
  */
 class tgPIDController : public tgBasicController
 {
@@ -99,10 +108,22 @@ public:
      * a starting setpoint
      */
     tgPIDController(tgControllable* controllable, tgPIDController::Config config);
+
+    /**
+     * Keep the loop in a shared bank. Either call control() on this
+     * controller or the bank's control(dt), not both, in a step.
+     * @param[in,out] bank the bank, which must outlive the controller
+     * @param[in] controllable. The system to be controlled.
+     * @param[in] config. Contains the gains for the PID control and 
+     * a starting setpoint
+     */
+    tgPIDController(tgPIDControllerBank& bank,
+                    tgControllable* controllable,
+                    tgPIDController::Config config);
     
 	/**
-	 * This destructor has nothing to do. The parent class will set
-	 * the pointer for m_controllable to NULL
+	 * Deletes the bank if it is the controller's own. The parent class
+	 * will set the pointer for m_controllable to NULL
 	 */
     virtual ~tgPIDController();
 	
@@ -131,30 +152,31 @@ public:
 	 * @todo upgrade once the messaging protocol is in place
 	 */
 	virtual void setSensorData(double sensorData);
-	
-	/// @todo should we have a getSensorData function? Might make code changes simpler later
-	
-private:
-	/**
-	 * Member variable for sensor data. Units are application dependant.
-	 */
-	double m_sensorData;
-	
+
 	/**
-	 * The previous error between the setpoint and the sensor value.
-	 * Used in computing the integral and derivative terms
+	 * Updates m_setPoint and the setpoint of the loop in the bank
+	 * @param[in] newSetPoint, the next desired setpoint for the controllable
 	 */
-	double m_prevError;
+	virtual void setNewSetPoint(double newSetPoint);
 	
-	/**
-	 * The integral of the error
-	 */
-	double m_intError;
+	/// @todo should we have a getSensorData function? Might make code changes simpler later
 	
+private:
+
+	/** Not copyable, since the bank may be owned */
+	tgPIDController(const tgPIDController&);
+	tgPIDController& operator=(const tgPIDController&);
+
 	/**
-	 * A locally stored config, contains the gains
+	 * Holds the gains, sensor data, previous error and integral of the
+	 * error; owned if m_ownsBank
 	 */
-	const tgPIDController::Config m_config;
+	tgPIDControllerBank* const m_pBank;
+
+	const bool m_ownsBank;
+
+	/** This controller's slot in m_pBank */
+	const std::size_t m_index;
 };
 
 #endif  // TG_PID_CONTROLLER_H
@@ -0,0 +1,154 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgPIDControllerBank.cpp
+ * @brief Implementation of the tgPIDControllerBank class
+ * $Id$
+ */
+
+#include "tgPIDControllerBank.h"
+
+#include "core/tgControllable.h"
+
+// The C++ Standard Library
+#include <stdexcept>
+#include <cassert>
+
+template <typename Scalar>
+tgPIDControllerBankT<Scalar>::tgPIDControllerBankT()
+{
+}
+
+template <typename Scalar>
+tgPIDControllerBankT<Scalar>::~tgPIDControllerBankT()
+{
+}
+
+template <typename Scalar>
+std::size_t tgPIDControllerBankT<Scalar>::add(tgControllable* controllable,
+                                     const tgPIDController::Config& config)
+{
+	if (controllable == NULL)
+	{
+		throw std::invalid_argument("Controllable is NULL.");
+	}
+	m_controllables.push_back(controllable);
+	m_kP.push_back(static_cast<Scalar>(config.kP));
+	m_kI.push_back(static_cast<Scalar>(config.kI));
+	m_kD.push_back(static_cast<Scalar>(config.kD));
+	m_setPoint.push_back(static_cast<Scalar>(config.startingSetPoint));
+	m_sensorData.push_back(Scalar(0));
+	m_prevError.push_back(Scalar(0));
+	m_intError.push_back(Scalar(0));
+	m_output.push_back(Scalar(0));
+	return m_controllables.size() - 1;
+}
+
+template <typename Scalar>
+void tgPIDControllerBankT<Scalar>::setSetPoint(std::size_t i, double setPoint)
+{
+	check(i);
+	m_setPoint[i] = static_cast<Scalar>(setPoint);
+}
+
+template <typename Scalar>
+void tgPIDControllerBankT<Scalar>::setSensorData(std::size_t i, double sensorData)
+{
+	check(i);
+	m_sensorData[i] = static_cast<Scalar>(sensorData);
+}
+
+template <typename Scalar>
+double tgPIDControllerBankT<Scalar>::getOutput(std::size_t i) const
+{
+	check(i);
+	return m_output[i];
+}
+
+template <typename Scalar>
+void tgPIDControllerBankT<Scalar>::control(double dt)
+{
+	if (dt <= 0.0)
+	{
+		throw std::runtime_error ("Timestep must be positive.");
+	}
+	const std::size_t n = m_controllables.size();
+	if (n == 0)
+	{
+		return;
+	}
+
+	// Only arithmetic on the arrays here, so the loop vectorizes
+	const Scalar* const kP = &m_kP[0];
+	const Scalar* const kI = &m_kI[0];
+	const Scalar* const kD = &m_kD[0];
+	const Scalar* const setPoint = &m_setPoint[0];
+	const Scalar* const sensorData = &m_sensorData[0];
+	Scalar* const prevError = &m_prevError[0];
+	Scalar* const intError = &m_intError[0];
+	Scalar* const output = &m_output[0];
+	const Scalar h = static_cast<Scalar>(dt);
+	for (std::size_t i = 0; i < n; i++)
+	{
+		const Scalar error = setPoint[i] - sensorData[i];
+		/// Integrate using trapezoid rule, as control(i, dt) does
+		intError[i] += (error + prevError[i]) / 2 * h;
+		const Scalar dError = (error - prevError[i]) / h;
+		output[i] = kP[i] * error + kI[i] * intError[i] + kD[i] * dError;
+		prevError[i] = error;
+	}
+
+	for (std::size_t i = 0; i < n; i++)
+	{
+		m_controllables[i]->setControlInput(output[i]);
+	}
+}
+
+template <typename Scalar>
+void tgPIDControllerBankT<Scalar>::control(std::size_t i, double dt)
+{
+	if (dt <= 0.0)
+	{
+		throw std::runtime_error ("Timestep must be positive.");
+	}
+	check(i);
+
+	const Scalar h = static_cast<Scalar>(dt);
+	const Scalar error = m_setPoint[i] - m_sensorData[i];
+	/// Integrate using trapezoid rule to reduce error in integration over rectangle
+	m_intError[i] += (error + m_prevError[i]) / 2 * h;
+	const Scalar dError = (error - m_prevError[i]) / h;
+	m_output[i] = m_kP[i] * error + m_kI[i] * m_intError[i] +
+					m_kD[i] * dError;
+	m_prevError[i] = error;
+
+	m_controllables[i]->setControlInput(m_output[i]);
+}
+
+template <typename Scalar>
+void tgPIDControllerBankT<Scalar>::check(std::size_t i) const
+{
+	if (i >= m_controllables.size())
+	{
+		throw std::out_of_range("No such PID controller in the bank.");
+	}
+}
+
+template class tgPIDControllerBankT<double>;
+template class tgPIDControllerBankT<float>;
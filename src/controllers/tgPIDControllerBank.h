@@ -0,0 +1,142 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_PID_CONTROLLER_BANK_H
+#define TG_PID_CONTROLLER_BANK_H
+
+/**
+ * @file tgPIDControllerBank.h
+ * @brief Definition of the tgPIDControllerBank class
+ * $Id$
+ */
+
+#include "tgPIDController.h"
+
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class tgControllable;
+
+/**
+ * The PID loops of many controllables, run together. The gains, set
+ * points, sensor data, previous errors and integrals of all the loops are
+ * kept in arrays, so control(dt) is one pass of arithmetic over them that
+ * the compiler can vectorize, followed by one setControlInput call per
+ * controllable. A tgPIDController made with a bank is a view of one of
+ * its slots.
+ *
+ * The loops run in Scalar: tgPIDControllerBank is double, as
+ * tgPIDController is, and tgPIDControllerBankF is float, which fits twice
+ * as many loops in a vector and rounds as float32 embedded controllers
+ * do. Only float and double are instantiated.
+ */
+template <typename Scalar>
+class tgPIDControllerBankT
+{
+public:
+
+    tgPIDControllerBankT();
+
+    /** The controllables are not owned, so there is nothing to delete */
+    ~tgPIDControllerBankT();
+
+    /**
+     * Add a loop.
+     * @param[in] controllable the system to be controlled; must not be
+     * NULL
+     * @param[in] config the gains and the starting setpoint
+     * @return the slot of the loop
+     * @throw std::invalid_argument if controllable is NULL
+     */
+    std::size_t add(tgControllable* controllable,
+                    const tgPIDController::Config& config);
+
+    /** @return the number of loops */
+    std::size_t size() const { return m_controllables.size(); }
+
+    /**
+     * @param[in] i a slot returned by add()
+     * @param[in] setPoint the setpoint of the next steps
+     * @throw std::out_of_range if there is no slot i
+     */
+    void setSetPoint(std::size_t i, double setPoint);
+
+    /**
+     * @param[in] i a slot returned by add()
+     * @param[in] sensorData the value compared with the setpoint
+     * @throw std::out_of_range if there is no slot i
+     */
+    void setSensorData(std::size_t i, double sensorData);
+
+    /**
+     * @param[in] i a slot returned by add()
+     * @return the control input set by the last step of the loop
+     * @throw std::out_of_range if there is no slot i
+     */
+    double getOutput(std::size_t i) const;
+
+    /**
+     * Run every loop and set the control input of every controllable.
+     * @param[in] dt the timestep; must be positive
+     * @throw std::runtime_error if dt is not positive
+     */
+    void control(double dt);
+
+    /**
+     * Run one loop and set the control input of its controllable.
+     * @param[in] i a slot returned by add()
+     * @param[in] dt the timestep; must be positive
+     * @throw std::runtime_error if dt is not positive
+     * @throw std::out_of_range if there is no slot i
+     */
+    void control(std::size_t i, double dt);
+
+private:
+
+    /** @throw std::out_of_range if there is no slot i */
+    void check(std::size_t i) const;
+
+    /** The systems being controlled; not owned */
+    std::vector<tgControllable*> m_controllables;
+
+    /** The gains, already negated for tension control */
+    std::vector<Scalar> m_kP;
+    std::vector<Scalar> m_kI;
+    std::vector<Scalar> m_kD;
+
+    std::vector<Scalar> m_setPoint;
+
+    std::vector<Scalar> m_sensorData;
+
+    /** The error of the last step */
+    std::vector<Scalar> m_prevError;
+
+    /** The integral of the error */
+    std::vector<Scalar> m_intError;
+
+    /** The control inputs of the last step */
+    std::vector<Scalar> m_output;
+};
+
+typedef tgPIDControllerBankT<double> tgPIDControllerBank;
+
+typedef tgPIDControllerBankT<float> tgPIDControllerBankF;
+
+#endif  // TG_PID_CONTROLLER_BANK_H
@@ -0,0 +1,137 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgSineWaveBank.cpp
+ * @brief Implementation of the tgSineWaveBank class
+ * $Id$
+ */
+
+// This module
+#include "tgSineWaveBank.h"
+// The C++ Standard Library
+#include <cmath>
+#include <stdexcept>
+
+tgSineWaveBank::tgSineWaveBank(double controlStep, std::size_t tableSize) :
+m_controlStep(controlStep),
+m_controlTime(0.0),
+m_totalTime(0.0)
+{
+    if (m_controlStep < 0.0)
+    {
+        throw std::invalid_argument("Negative control step");
+    }
+    if (tableSize > 0)
+    {
+        m_table.resize(tableSize + 1);
+        for (std::size_t k = 0; k < tableSize; k++)
+        {
+            m_table[k] = std::cos(2.0 * M_PI * k / tableSize);
+        }
+        m_table[tableSize] = m_table[0];
+    }
+}
+
+tgSineWaveBank::~tgSineWaveBank()
+{
+}
+
+std::size_t tgSineWaveBank::add(tgBasicActuator* actuator,
+                                const tgImpedanceController& gains,
+                                double amplitude,
+                                double frequency,
+                                double phase,
+                                double offset,
+                                double length)
+{
+    const std::size_t i = m_impedance.add(actuator, gains);
+    m_amplitude.push_back(amplitude);
+    m_frequency.push_back(frequency);
+    m_phase.push_back(phase);
+    m_offset.push_back(offset);
+    m_length.push_back(length);
+    m_target.push_back(0.0);
+    return i;
+}
+
+void tgSineWaveBank::step(double dt)
+{
+    if (dt <= 0.0)
+    {
+        throw std::invalid_argument("dt is not positive");
+    }
+    m_controlTime += dt;
+    m_totalTime += dt;
+
+    if (m_controlTime >= m_controlStep && !m_target.empty())
+    {
+        findTargets();
+        for (std::size_t i = 0; i < m_target.size(); i++)
+        {
+            m_impedance.setTarget(i, m_length[i], m_target[i]);
+        }
+        // As tgSineStringControl, the motors move by the time since the
+        // last control step
+        m_impedance.control(m_controlTime);
+        m_controlTime = 0.0;
+    }
+}
+
+void tgSineWaveBank::reset()
+{
+    m_controlTime = 0.0;
+    m_totalTime = 0.0;
+}
+
+void tgSineWaveBank::findTargets()
+{
+    const std::size_t n = m_target.size();
+    const double t = m_totalTime;
+    const double* const amplitude = &m_amplitude[0];
+    const double* const frequency = &m_frequency[0];
+    const double* const phase = &m_phase[0];
+    const double* const offset = &m_offset[0];
+    double* const target = &m_target[0];
+
+    if (m_table.empty())
+    {
+        for (std::size_t i = 0; i < n; i++)
+        {
+            const double cycle = std::cos(t * 2.0 * M_PI * frequency[i] + phase[i]);
+            target[i] = cycle * amplitude[i] + offset[i];
+        }
+    }
+    else
+    {
+        const double* const table = &m_table[0];
+        const double entries = static_cast<double>(m_table.size() - 1);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            // The wave's position in its period, from 0 to 1
+            double turns = t * frequency[i] + phase[i] / (2.0 * M_PI);
+            turns -= std::floor(turns);
+            const double x = turns * entries;
+            std::size_t k = static_cast<std::size_t>(x);
+            // turns can round up to 1
+            k = k < m_table.size() - 1 ? k : m_table.size() - 2;
+            const double cycle = table[k] + (x - k) * (table[k + 1] - table[k]);
+            target[i] = cycle * amplitude[i] + offset[i];
+        }
+    }
+}
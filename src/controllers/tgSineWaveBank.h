@@ -0,0 +1,141 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_SINE_WAVE_BANK_H
+#define TG_SINE_WAVE_BANK_H
+
+/**
+ * @file tgSineWaveBank.h
+ * @brief Definition of the tgSineWaveBank class
+ * $Id$
+ */
+
+// This library
+#include "tgImpedanceControllerBank.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class tgBasicActuator;
+class tgImpedanceController;
+
+/**
+ * The sine wave controllers of many actuators with one clock, as in
+ * tgSineStringControl: every control step each actuator is pulled
+ * towards its control length and towards the velocity
+ * offset + amplitude * cos(2 pi frequency t + phase). Instead of one
+ * observer per actuator keeping its own time, the bank finds every
+ * wave in one loop and sets the tensions with a
+ * tgImpedanceControllerBank, which applies them in one batch.
+ *
+ * With a table size, the waves are looked up in a table of one period
+ * with linear interpolation rather than computed; a table of n entries
+ * is within about 5 / n^2 of the cosine.
+ */
+class tgSineWaveBank
+{
+public:
+
+    /**
+     * @param[in] controlStep how often the tensions are set, in seconds;
+     * zero sets them every step
+     * @param[in] tableSize the entries of the wave table, or zero to
+     * compute every wave with std::cos
+     * @throw std::invalid_argument if controlStep is negative
+     */
+    tgSineWaveBank(double controlStep, std::size_t tableSize = 0);
+
+    ~tgSineWaveBank();
+
+    /**
+     * Add an actuator.
+     * @param[in] actuator the actuator; not owned
+     * @param[in] gains the impedance gains, which are copied
+     * @param[in] amplitude the amplitude of the velocity wave
+     * @param[in] frequency the frequency of the wave, in Hz
+     * @param[in] phase the phase of the wave, in radians
+     * @param[in] offset the velocity the wave oscillates about
+     * @param[in] length the length the actuator is pulled towards
+     * @return the index of the actuator
+     * @throw std::invalid_argument if actuator is NULL
+     */
+    std::size_t add(tgBasicActuator* actuator,
+                    const tgImpedanceController& gains,
+                    double amplitude,
+                    double frequency,
+                    double phase,
+                    double offset,
+                    double length);
+
+    /** @return the number of actuators */
+    std::size_t size() const { return m_amplitude.size(); }
+
+    /**
+     * Advance the clock, and set every actuator's tension if a control
+     * step has passed.
+     * @param[in] dt the timestep; must be positive
+     * @throw std::invalid_argument if dt is not positive
+     */
+    void step(double dt);
+
+    /** Start the clock from zero again. */
+    void reset();
+
+    /**
+     * @param[in] i an index returned by add()
+     * @return the velocity target of the last control step
+     */
+    double getTarget(std::size_t i) const { return m_target[i]; }
+
+    /**
+     * @param[in] i an index returned by add()
+     * @return the tension set by the last control step
+     */
+    double getCommandedTension(std::size_t i) const
+    {
+        return m_impedance.getSetTension(i);
+    }
+
+private:
+
+    /** Fill m_target for time m_totalTime */
+    void findTargets();
+
+    const double m_controlStep;
+
+    double m_controlTime;
+
+    double m_totalTime;
+
+    /** One period of cos, plus the first entry again; empty for std::cos */
+    std::vector<double> m_table;
+
+    std::vector<double> m_amplitude;
+    std::vector<double> m_frequency;
+    std::vector<double> m_phase;
+    std::vector<double> m_offset;
+    std::vector<double> m_length;
+
+    /** The velocity targets of the last control step */
+    std::vector<double> m_target;
+
+    tgImpedanceControllerBank m_impedance;
+};
+
+#endif  // TG_SINE_WAVE_BANK_H
@@ -35,6 +35,12 @@
 #include <stdexcept>
 #include <cstddef> // NULL keyword
 
+namespace
+{
+    /** The actuators gathered at a time by the batch version */
+    const std::size_t blockSize = 64;
+}
+
 tgTensionController::tgTensionController(tgBasicActuator* controllable, double setPoint) :
 m_sca(controllable),
 tgBasicController(controllable, setPoint)
@@ -112,3 +118,62 @@ void tgTensionController::control(tgBasicActuator& sca, double dt, double setPoi
     
 	sca.setControlInput(newLength, dt);
 }
+
+void tgTensionController::control(tgBasicActuator* const* actuators,
+                                  std::size_t n, double dt,
+                                  const double* setPoints)
+{
+    if (dt <= 0.0)
+	{
+		throw std::runtime_error ("Timestep must be positive.");
+	}
+
+    double tension[blockSize];
+    double stiffness[blockSize];
+    double restLength[blockSize];
+    double newLength[blockSize];
+
+    for (std::size_t begin = 0; begin < n; begin += blockSize)
+    {
+        const std::size_t m = (n - begin < blockSize) ? n - begin : blockSize;
+        tgBasicActuator* const* const block = actuators + begin;
+
+        for (std::size_t i = 0; i < m; i++)
+        {
+            assert(block[i] != NULL);
+            const tgSpringCable* const springCable = block[i]->getSpringCable();
+            tension[i] = springCable->getTension();
+            stiffness[i] = springCable->getCoefK();
+            // @todo: write invariant that checks this;
+            assert(stiffness[i] > 0.0);
+            restLength[i] = block[i]->getRestLength();
+        }
+
+        const double* const setPoint = setPoints + begin;
+        for (std::size_t i = 0; i < m; i++)
+        {
+            const double length =
+                restLength[i] - (setPoint[i] - tension[i]) / stiffness[i];
+            // Safety check
+            newLength[i] = length < 0.1 ? 0.1 : length;
+        }
+
+        for (std::size_t i = 0; i < m; i++)
+        {
+            block[i]->setControlInput(newLength[i], dt);
+        }
+    }
+}
+
+void tgTensionController::control(const std::vector<tgBasicActuator*>& actuators,
+                                  double dt, const std::vector<double>& setPoints)
+{
+    if (actuators.size() != setPoints.size())
+    {
+        throw std::invalid_argument("Need one set point per actuator.");
+    }
+    if (!actuators.empty())
+    {
+        control(&actuators[0], actuators.size(), dt, &setPoints[0]);
+    }
+}
@@ -29,6 +29,10 @@
 
 #include "tgBasicController.h"
 
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
 // Forward declarations
 class tgControllable;
 class tgBasicActuator;
@@ -81,6 +85,27 @@ public:
      * @param[in] setPoint, the desired tension.
      */
     static void control(tgBasicActuator& sca, double dt, double setPoint);
+
+    /**
+     * The static version for many actuators at once. The tensions, rest
+     * lengths and stiffnesses are gathered a block at a time into arrays
+     * on the stack, the new rest lengths computed in one loop, and then
+     * passed to setControlInput(input, dt), with the same results as
+     * calling control(sca, dt, setPoint) on each in turn.
+     * @param[in] actuators the actuators to be controlled; none NULL
+     * @param[in] n the number of actuators and set points
+     * @param[in] dt, the time elapsed since the last call
+     * @param[in] setPoints the desired tension of each actuator
+     */
+    static void control(tgBasicActuator* const* actuators, std::size_t n,
+                        double dt, const double* setPoints);
+
+    /**
+     * As above, for vectors of the same size.
+     * @throw std::invalid_argument if the sizes differ
+     */
+    static void control(const std::vector<tgBasicActuator*>& actuators,
+                        double dt, const std::vector<double>& setPoints);
 private:
     /**
      * The tgBasicActuator this class controls. We do not own this
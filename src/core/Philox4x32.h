@@ -0,0 +1,208 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef SRC_CORE_PHILOX4X32
+#define SRC_CORE_PHILOX4X32
+
+/**
+ * @file Philox4x32.h
+ * @brief Definition and implementation of class Philox4x32
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+// Boost
+#include <boost/cstdint.hpp>
+
+/**
+ * The Philox4x32-10 counter based generator of Salmon et al., "Parallel
+ * random numbers: as easy as 1, 2, 3" (SC 2011). Each block of four 32
+ * bit outputs is a keyed hash of a 128 bit counter, so a generator is
+ * two words of state besides the counter, any (key, stream) pair gives
+ * an independent sequence and skipping ahead is free. Ten rounds of two
+ * multiplies each replace the carry chains of ranlux.
+ */
+class Philox4x32
+{
+public:
+
+	/**
+	 * @param[in] key the seed shared by all streams
+	 * @param[in] stream selects one of 2^64 independent sequences, such
+	 * as one per thread or per population member
+	 */
+	Philox4x32(boost::uint64_t key = 0, boost::uint64_t stream = 0)
+	{
+		seed(key, stream);
+	}
+
+	/** Restart at the beginning of a stream */
+	void seed(boost::uint64_t key, boost::uint64_t stream)
+	{
+		m_key[0] = static_cast<boost::uint32_t>(key);
+		m_key[1] = static_cast<boost::uint32_t>(key >> 32);
+		m_counter[0] = 0;
+		m_counter[1] = 0;
+		m_counter[2] = static_cast<boost::uint32_t>(stream);
+		m_counter[3] = static_cast<boost::uint32_t>(stream >> 32);
+	}
+
+	/** Copy the key and counter out, e.g. for a checkpoint */
+	void getState(boost::uint32_t key[2], boost::uint32_t counter[4]) const
+	{
+		key[0] = m_key[0];
+		key[1] = m_key[1];
+		for (int i = 0; i < 4; i++)
+		{
+			counter[i] = m_counter[i];
+		}
+	}
+
+	/** Continue from a key and counter getState() copied */
+	void setState(const boost::uint32_t key[2],
+				  const boost::uint32_t counter[4])
+	{
+		m_key[0] = key[0];
+		m_key[1] = key[1];
+		for (int i = 0; i < 4; i++)
+		{
+			m_counter[i] = counter[i];
+		}
+	}
+
+	/** Write the next four outputs and advance the counter */
+	void next(boost::uint32_t out[4])
+	{
+		block(m_counter, m_key, out);
+		if (++m_counter[0] == 0)
+		{
+			++m_counter[1];
+		}
+	}
+
+	/**
+	 * Write the next blocks, four outputs each, and advance the counter.
+	 * Four blocks are hashed side by side, since the rounds of one block
+	 * are a chain of dependent multiplies.
+	 * @param[out] out 4 * blocks words
+	 */
+	void next(boost::uint32_t* out, std::size_t blocks)
+	{
+		while (blocks >= 4)
+		{
+			boost::uint32_t c0[4], c1[4], c2[4], c3[4];
+			for (int lane = 0; lane < 4; lane++)
+			{
+				c0[lane] = m_counter[0] + lane;
+				// Carry into the second word if the first wraps
+				c1[lane] = m_counter[1] + (c0[lane] < m_counter[0] ? 1 : 0);
+				c2[lane] = m_counter[2];
+				c3[lane] = m_counter[3];
+			}
+			boost::uint32_t k0 = m_key[0];
+			boost::uint32_t k1 = m_key[1];
+			for (int round = 0; round < 10; round++)
+			{
+				for (int lane = 0; lane < 4; lane++)
+				{
+					const boost::uint64_t p0 =
+						static_cast<boost::uint64_t>(0xD2511F53u) * c0[lane];
+					const boost::uint64_t p1 =
+						static_cast<boost::uint64_t>(0xCD9E8D57u) * c2[lane];
+					const boost::uint32_t hi0 =
+						static_cast<boost::uint32_t>(p0 >> 32);
+					const boost::uint32_t hi1 =
+						static_cast<boost::uint32_t>(p1 >> 32);
+					c0[lane] = hi1 ^ c1[lane] ^ k0;
+					c1[lane] = static_cast<boost::uint32_t>(p1);
+					c2[lane] = hi0 ^ c3[lane] ^ k1;
+					c3[lane] = static_cast<boost::uint32_t>(p0);
+				}
+				k0 += 0x9E3779B9u;
+				k1 += 0xBB67AE85u;
+			}
+			for (int lane = 0; lane < 4; lane++)
+			{
+				out[4 * lane] = c0[lane];
+				out[4 * lane + 1] = c1[lane];
+				out[4 * lane + 2] = c2[lane];
+				out[4 * lane + 3] = c3[lane];
+			}
+			const boost::uint32_t before = m_counter[0];
+			m_counter[0] += 4;
+			if (m_counter[0] < before)
+			{
+				++m_counter[1];
+			}
+			out += 16;
+			blocks -= 4;
+		}
+		for (; blocks > 0; blocks--)
+		{
+			next(out);
+			out += 4;
+		}
+	}
+
+	/**
+	 * The hash itself: ten rounds on a counter under a key.
+	 * @param[in] counter four words
+	 * @param[in] key two words
+	 * @param[out] out four words
+	 */
+	static void block(const boost::uint32_t counter[4],
+					  const boost::uint32_t key[2],
+					  boost::uint32_t out[4])
+	{
+		boost::uint32_t c0 = counter[0];
+		boost::uint32_t c1 = counter[1];
+		boost::uint32_t c2 = counter[2];
+		boost::uint32_t c3 = counter[3];
+		boost::uint32_t k0 = key[0];
+		boost::uint32_t k1 = key[1];
+		for (int round = 0; round < 10; round++)
+		{
+			const boost::uint64_t p0 =
+				static_cast<boost::uint64_t>(0xD2511F53u) * c0;
+			const boost::uint64_t p1 =
+				static_cast<boost::uint64_t>(0xCD9E8D57u) * c2;
+			const boost::uint32_t hi0 = static_cast<boost::uint32_t>(p0 >> 32);
+			const boost::uint32_t hi1 = static_cast<boost::uint32_t>(p1 >> 32);
+			c0 = hi1 ^ c1 ^ k0;
+			c1 = static_cast<boost::uint32_t>(p1);
+			c2 = hi0 ^ c3 ^ k1;
+			c3 = static_cast<boost::uint32_t>(p0);
+			// The Weyl sequence of the key schedule
+			k0 += 0x9E3779B9u;
+			k1 += 0xBB67AE85u;
+		}
+		out[0] = c0;
+		out[1] = c1;
+		out[2] = c2;
+		out[3] = c3;
+	}
+
+private:
+
+	boost::uint32_t m_counter[4];
+	boost::uint32_t m_key[2];
+};
+
+#endif // SRC_CORE_PHILOX4X32
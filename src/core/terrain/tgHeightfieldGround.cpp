@@ -0,0 +1,150 @@
+/**
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+
+/**
+ * @file tgHeightfieldGround.cpp
+ * @brief Contains the implementation of class tgHeightfieldGround
+ * $Id$
+ */
+
+//This Module
+#include "tgHeightfieldGround.h"
+
+//Bullet Physics
+#include "BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btDefaultMotionState.h"
+#include "LinearMath/btTransform.h"
+
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+tgHeightfieldGround::tgHeightfieldGround() :
+    m_config(Config())
+{
+    setHeights();
+    createShape();
+}
+
+tgHeightfieldGround::tgHeightfieldGround(const Config& config) :
+    m_config(config)
+{
+    setHeights();
+    createShape();
+}
+
+tgHeightfieldGround::tgHeightfieldGround(const Config& config,
+        const boost::shared_ptr<const std::vector<float> >& heights) :
+    m_config(config),
+    m_heights(heights)
+{
+    if (!m_heights || m_heights->size() != m_config.m_nx * m_config.m_ny)
+    {
+        throw std::invalid_argument("Heightfield needs one height per grid node");
+    }
+    createShape();
+}
+
+tgHeightfieldGround::~tgHeightfieldGround()
+{
+}
+
+btRigidBody* tgHeightfieldGround::getGroundRigidBody() const
+{
+    const btScalar mass = 0.0;
+
+    btTransform groundTransform;
+    groundTransform.setIdentity();
+    groundTransform.setOrigin(m_config.m_origin);
+
+    btQuaternion orientation;
+    orientation.setEuler(m_config.m_eulerAngles[0], // Yaw
+                         m_config.m_eulerAngles[1], // Pitch
+                         m_config.m_eulerAngles[2]); // Roll
+    groundTransform.setRotation(orientation);
+
+    // Move the shape's center to where the grid puts it
+    const btTransform centered =
+        groundTransform * btTransform(btMatrix3x3::getIdentity(), m_center);
+
+    // Using motionstate is recommended
+    // It provides interpolation capabilities, and only synchronizes 'active' objects
+    btDefaultMotionState* const pMotionState =
+        new btDefaultMotionState(centered);
+
+    const btVector3 localInertia(0, 0, 0);
+
+    btRigidBody::btRigidBodyConstructionInfo const rbInfo(mass, pMotionState, pGroundShape, localInertia);
+
+    btRigidBody* const pGroundBody = new btRigidBody(rbInfo);
+
+    assert(pGroundBody);
+    return pGroundBody;
+}
+
+void tgHeightfieldGround::setHeights()
+{
+    // The same hills as tgHillyGround::setVertices
+    std::vector<float>* const heights =
+        new std::vector<float>(m_config.m_nx * m_config.m_ny);
+    for (std::size_t i = 0; i < m_config.m_nx; i++)
+    {
+        for (std::size_t j = 0; j < m_config.m_ny; j++)
+        {
+            (*heights)[i + (j * m_config.m_nx)] =
+                m_config.m_waveHeight * sin((double)i) * cos((double)j) +
+                m_config.m_offset;
+        }
+    }
+    m_heights.reset(heights);
+}
+
+void tgHeightfieldGround::createShape()
+{
+    // Bullet needs at least one cell
+    if (m_config.m_nx < 2 || m_config.m_ny < 2)
+    {
+        throw std::invalid_argument("Heightfield needs at least 2 x 2 nodes");
+    }
+
+    const std::vector<float>& heights = *m_heights;
+    const float minHeight = *std::min_element(heights.begin(), heights.end());
+    const float maxHeight = *std::max_element(heights.begin(), heights.end());
+
+    const btScalar heightScale = 1.0;
+    const int upAxis = 1;
+    // Split each cell from (i, j) to (i + 1, j + 1), as tgHillyGround::setIndices does
+    const bool flipQuadEdges = true;
+    btHeightfieldTerrainShape* const pShape =
+        new btHeightfieldTerrainShape(m_config.m_nx, m_config.m_ny, &heights[0],
+                                      heightScale, minHeight, maxHeight,
+                                      upAxis, PHY_FLOAT, flipQuadEdges);
+    pShape->setLocalScaling(btVector3(m_config.m_triangleSize, 1.0,
+                                      m_config.m_triangleSize));
+    pShape->setMargin(m_config.m_margin);
+    pGroundShape = pShape;
+
+    // Grid node i is at x = (i - nx / 2) * triangleSize, Bullet centers
+    // the nodes, so its x = (i - (nx - 1) / 2) * triangleSize; z likewise
+    m_center = btVector3(-0.5 * m_config.m_triangleSize,
+                         0.5 * (minHeight + maxHeight),
+                         -0.5 * m_config.m_triangleSize);
+}
@@ -0,0 +1,112 @@
+/**
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+
+#ifndef CORE_TERRAIN_TG_HEIGHTFIELD_GROUND_H
+#define CORE_TERRAIN_TG_HEIGHTFIELD_GROUND_H
+
+/**
+ * @file tgHeightfieldGround.h
+ * @brief Contains the definition of class tgHeightfieldGround.
+ * $Id$
+ */
+
+#include "tgBulletGround.h"
+#include "tgHillyGround.h"
+
+#include "LinearMath/btVector3.h"
+
+#include <boost/shared_ptr.hpp>
+
+// The C++ Standard Library
+#include <vector>
+
+// Forward declarations
+class btRigidBody;
+
+/**
+ * The hilly ground of tgHillyGround as a btHeightfieldTerrainShape.
+ * Only one float per grid node is stored and no BVH is built, so large
+ * grids take a fraction of the memory and set up time of the triangle
+ * mesh, and contact queries only visit the cells under an object. The
+ * surface is the same: each cell is split along the same diagonal.
+ */
+class tgHeightfieldGround : public tgBulletGround
+{
+    public:
+
+        /** The configuration is that of tgHillyGround */
+        typedef tgHillyGround::Config Config;
+
+        /**
+         * Default construction that uses the default values of config
+         */
+        tgHeightfieldGround();
+
+        /**
+         * Allows a user to specify their own config. The heights are the
+         * hills of tgHillyGround.
+         */
+        tgHeightfieldGround(const Config& config);
+
+        /**
+         * Use heights from elsewhere, such as from a terrain survey,
+         * which any number of grounds may share. The wave height and
+         * offset of config are unused.
+         * @param[in] config the grid size and spacing, and the body
+         * @param[in] heights m_nx * m_ny heights, x varying fastest; must
+         * not change while any ground uses it
+         */
+        tgHeightfieldGround(const Config& config,
+                            const boost::shared_ptr<const std::vector<float> >& heights);
+
+        /** The shape is deleted by tgBulletGround */
+        virtual ~tgHeightfieldGround();
+
+        /**
+         * Setup and return a return a rigid body based on the collision
+         * object
+         */
+        virtual btRigidBody* getGroundRigidBody() const;
+
+        /** The heights, one per grid node, x varying fastest */
+        const std::vector<float>& getHeights() const
+        {
+            return *m_heights;
+        }
+
+    private:
+        /** Fill m_heights with the hills of tgHillyGround */
+        void setHeights();
+
+        /** Create pGroundShape over m_heights, and m_center */
+        void createShape();
+
+        /** Store the configuration data for use later */
+        Config m_config;
+
+        /** The shape reads these in place, so they must outlive it */
+        boost::shared_ptr<const std::vector<float> > m_heights;
+
+        /**
+         * Bullet centers a heightfield on its bounding box; this is where
+         * that center is in the ground's frame
+         */
+        btVector3 m_center;
+};
+
+#endif  // CORE_TERRAIN_TG_HEIGHTFIELD_GROUND_H
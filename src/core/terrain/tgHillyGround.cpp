@@ -34,9 +34,81 @@
 #include "LinearMath/btDefaultMotionState.h"
 #include "LinearMath/btTransform.h"
 
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/weak_ptr.hpp>
+
 // The C++ Standard Library
 #include <cassert>
 #include <iostream>
+#include <map>
+
+struct tgHillyGround::Terrain
+{
+    Terrain() : pMesh(NULL), vertices(NULL), pIndices(NULL), pShape(NULL) {}
+
+    ~Terrain()
+    {
+        delete pShape;
+        delete pMesh;
+        delete[] pIndices;
+        delete[] vertices;
+    }
+
+    btTriangleIndexVertexArray* pMesh;
+    btVector3* vertices;
+    int* pIndices;
+    btCollisionShape* pShape;
+};
+
+namespace
+{
+    /** The part of a config that the mesh depends on */
+    struct TerrainKey
+    {
+        TerrainKey(const tgHillyGround::Config& config) :
+            nx(config.m_nx), ny(config.m_ny), margin(config.m_margin),
+            triangleSize(config.m_triangleSize), waveHeight(config.m_waveHeight),
+            offset(config.m_offset)
+        {
+        }
+
+        bool operator<(const TerrainKey& other) const
+        {
+            if (nx != other.nx) return nx < other.nx;
+            if (ny != other.ny) return ny < other.ny;
+            if (margin != other.margin) return margin < other.margin;
+            if (triangleSize != other.triangleSize) return triangleSize < other.triangleSize;
+            if (waveHeight != other.waveHeight) return waveHeight < other.waveHeight;
+            return offset < other.offset;
+        }
+
+        std::size_t nx;
+        std::size_t ny;
+        double margin;
+        double triangleSize;
+        double waveHeight;
+        double offset;
+    };
+
+    /**
+     * The meshes of the grounds alive, built at most once each. Worlds of
+     * a batch may be set up from several threads.
+     */
+    template <class Terrain>
+    struct TerrainCache
+    {
+        boost::mutex mutex;
+        std::map<TerrainKey, boost::weak_ptr<Terrain> > terrains;
+    };
+
+    template <class Terrain>
+    TerrainCache<Terrain>& terrainCache()
+    {
+        static TerrainCache<Terrain> cache;
+        return cache;
+    }
+}
 
 tgHillyGround::Config::Config(btVector3 eulerAngles,
         double friction,
@@ -87,9 +159,8 @@ tgHillyGround::tgHillyGround(const tgHillyGround::Config& config) :
 
 tgHillyGround::~tgHillyGround()
 {
-    delete m_pMesh;
-    delete[] m_pIndices;
-    delete[] m_vertices;
+    // The terrain deletes the shape once no ground uses it
+    pGroundShape = NULL;
 }
 
 btRigidBody* tgHillyGround::getGroundRigidBody() const
@@ -123,7 +194,20 @@ btRigidBody* tgHillyGround::getGroundRigidBody() const
 }  
 
 btCollisionShape* tgHillyGround::hillyCollisionShape() {
-    btCollisionShape * pShape = 0;
+    if (m_pTerrain) {
+        return m_pTerrain->pShape;
+    }
+
+    TerrainCache<Terrain>& cache = terrainCache<Terrain>();
+    const TerrainKey key(m_config);
+    boost::lock_guard<boost::mutex> lock(cache.mutex);
+    boost::shared_ptr<Terrain> pTerrain = cache.terrains[key].lock();
+    if (pTerrain) {
+        m_pTerrain = pTerrain;
+        return pTerrain->pShape;
+    }
+    pTerrain.reset(new Terrain());
+
     // The number of vertices in the mesh
     // Hill Paramenters: Subject to Change
     const std::size_t vertexCount = m_config.m_nx * m_config.m_ny;
@@ -133,30 +217,43 @@ btCollisionShape* tgHillyGround::hillyCollisionShape() {
         const std::size_t triangleCount = 2 * (m_config.m_nx - 1) * (m_config.m_ny - 1);
 
         // A flattened array of all vertices in the mesh
-        m_vertices = new btVector3[vertexCount];
+        pTerrain->vertices = new btVector3[vertexCount];
 
         // Supplied by the derived class
-        setVertices(m_vertices);
+        setVertices(pTerrain->vertices);
         // A flattened array of indices for each corner of each triangle
-        m_pIndices = new int[triangleCount * 3];
+        pTerrain->pIndices = new int[triangleCount * 3];
 
         // Supplied by the derived class
-        setIndices(m_pIndices);
+        setIndices(pTerrain->pIndices);
 
         // Create the mesh object
-        m_pMesh = createMesh(triangleCount, m_pIndices, vertexCount, m_vertices);
+        pTerrain->pMesh = createMesh(triangleCount, pTerrain->pIndices, vertexCount, pTerrain->vertices);
 
         // Create the shape object
-        pShape = createShape(m_pMesh);
+        pTerrain->pShape = createShape(pTerrain->pMesh);
 
         // Set the margin
-        pShape->setMargin(m_config.m_margin);
+        pTerrain->pShape->setMargin(m_config.m_margin);
         // DO NOT deallocate vertices, indices or pMesh until simulation is over!
-        // The shape owns them, but will not delete them
+        // The shape owns them, but will not delete them; the terrain does
     }
 
-    assert(pShape);
-    return pShape; 
+    assert(pTerrain->pShape);
+
+    // Forget the grids no ground uses anymore
+    typedef std::map<TerrainKey, boost::weak_ptr<Terrain> >::iterator Iterator;
+    for (Iterator it = cache.terrains.begin(); it != cache.terrains.end(); ) {
+        if (it->second.expired()) {
+            cache.terrains.erase(it++);
+        }
+        else {
+            ++it;
+        }
+    }
+    cache.terrains[key] = pTerrain;
+    m_pTerrain = pTerrain;
+    return pTerrain->pShape; 
 }
 
 btTriangleIndexVertexArray *tgHillyGround::createMesh(std::size_t triangleCount, int indices[], std::size_t vertexCount, btVector3 vertices[]) {
@@ -31,6 +31,8 @@
 #include "LinearMath/btScalar.h"
 #include "LinearMath/btVector3.h"
 
+#include <boost/shared_ptr.hpp>
+
 // std::size_t
 #include <cstddef>
 
@@ -39,7 +41,11 @@ class btRigidBody;
 class btTriangleIndexVertexArray;
 
 /**
- * A "hilly" ground, with randomized hills and valleys
+ * A "hilly" ground, with randomized hills and valleys.
+ * The mesh and its BVH only depend on the grid part of the config, and
+ * never change once built, so every tgHillyGround alive with the same grid
+ * shares one. Replacing a ground with an identical one between episodes,
+ * or giving one to each of a batch of worlds, builds the mesh only once.
  */
 class tgHillyGround : public tgBulletGround
 {
@@ -106,7 +112,7 @@ class tgHillyGround : public tgBulletGround
          */
         tgHillyGround(const tgHillyGround::Config& config);
 
-        /** Clean up the implementation. Deletes m_pMesh */
+        /** Release the shared mesh, deleted with the last ground using it */
         virtual ~tgHillyGround();
 
         /**
@@ -121,9 +127,15 @@ class tgHillyGround : public tgBulletGround
         btCollisionShape* hillyCollisionShape();
 
     private:  
+        /** A mesh, its shape and the arrays they read */
+        struct Terrain;
+
         /** Store the configuration data for use later */
         Config m_config;
 
+        /** Shared with every other ground built from the same grid */
+        boost::shared_ptr<Terrain> m_pTerrain;
+
         /** Pre-condition: Quantity of triangles and vertices must each be greater than zero 
          *  Post-condition: Returns a mesh, as configured by the input parameters, 
          *                  to be used as a template for a btBvhTriangleMeshShape
@@ -144,11 +156,6 @@ class tgHillyGround : public tgBulletGround
          * @param[out] A flattened array of indices in the mesh
          */
         void setIndices(int indices[]);
-        
-        // Store this so we can delete it later
-        btTriangleIndexVertexArray* m_pMesh;
-        btVector3 * m_vertices;
-        int * m_pIndices;
 
 };
 
@@ -0,0 +1,527 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgAggregateBroadphase.cpp
+ * @brief Contains the definitions of members of class tgAggregateBroadphase
+ * $Id$
+ */
+
+// This module
+#include "tgAggregateBroadphase.h"
+// The Bullet Physics library
+#include "LinearMath/btAabbUtil2.h"
+// Boost
+#include <boost/thread/tss.hpp>
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+
+struct tgAggregateBroadphase::Proxy : public btBroadphaseProxy
+{
+    Proxy(const btVector3& aabbMin, const btVector3& aabbMax, void* userPtr,
+          short int collisionFilterGroup, short int collisionFilterMask) :
+        btBroadphaseProxy(aabbMin, aabbMax, userPtr,
+                          collisionFilterGroup, collisionFilterMask),
+        aggregate(0),
+        member(0)
+    {
+    }
+
+    /** The index of its aggregate in m_aggregates */
+    std::size_t aggregate;
+
+    /** Its index in the aggregate's members */
+    std::size_t member;
+};
+
+struct tgAggregateBroadphase::Aggregate
+{
+    explicit Aggregate(const void* k) :
+        key(k)
+    {
+    }
+
+    /** NULL for an aggregate of one */
+    const void* key;
+
+    /** The box around the members, refit on every step */
+    btVector3 aabbMin;
+    btVector3 aabbMax;
+
+    /** Not owned by the aggregate. By lower x as of the last step. */
+    std::vector<Proxy*> members;
+};
+
+namespace
+{
+    // The cleanup of thread_specific_ptr, for pointers it does not own
+    void keep(tgAggregateBroadphase::Scope*) { }
+
+    /** The open Scope of each thread */
+    boost::thread_specific_ptr<tgAggregateBroadphase::Scope>
+        current(keep);
+
+    /** @return true if the boxes overlap */
+    bool overlaps(const btBroadphaseProxy& a, const btBroadphaseProxy& b)
+    {
+        return TestAabbAgainstAabb2(a.m_aabbMin, a.m_aabbMax,
+                                    b.m_aabbMin, b.m_aabbMax);
+    }
+
+    /**
+     * Sort by lower x. An insertion sort, since the order of the last
+     * step is nearly right.
+     */
+    template <typename T, typename Lower>
+    void sortByLowerX(std::vector<T>& items, Lower lower)
+    {
+        for (std::size_t i = 1; i < items.size(); ++i)
+        {
+            const T item = items[i];
+            const btScalar x = lower(item);
+            std::size_t j = i;
+            for (; j > 0 && lower(items[j - 1]) > x; --j)
+            {
+                items[j] = items[j - 1];
+            }
+            items[j] = item;
+        }
+    }
+
+    btScalar proxyLowerX(const btBroadphaseProxy* proxy)
+    {
+        return proxy->m_aabbMin.x();
+    }
+
+    /** Drops the cached pairs whose boxes no longer overlap */
+    class PartedPairs : public btOverlapCallback
+    {
+    public:
+        virtual bool processOverlap(btBroadphasePair& pair)
+        {
+            return !overlaps(*pair.m_pProxy0, *pair.m_pProxy1);
+        }
+    };
+}
+
+tgAggregateBroadphase::Scope::Scope(const void* key) :
+    m_key(key),
+    m_pPrevious(current.get())
+{
+    current.reset(this);
+}
+
+tgAggregateBroadphase::Scope::~Scope()
+{
+    current.reset(m_pPrevious);
+}
+
+tgAggregateBroadphase::tgAggregateBroadphase() :
+    m_nextId(2),
+    m_tests(0)
+{
+    assert(invariant());
+}
+
+tgAggregateBroadphase::~tgAggregateBroadphase()
+{
+    for (std::size_t i = 0; i < m_aggregates.size(); ++i)
+    {
+        const std::vector<Proxy*>& members = m_aggregates[i]->members;
+        for (std::size_t j = 0; j < members.size(); ++j)
+        {
+            delete members[j];
+        }
+        delete m_aggregates[i];
+    }
+}
+
+btBroadphaseProxy* tgAggregateBroadphase::createProxy(const btVector3& aabbMin,
+                                                      const btVector3& aabbMax,
+                                                      int shapeType,
+                                                      void* userPtr,
+                                                      short int collisionFilterGroup,
+                                                      short int collisionFilterMask,
+                                                      btDispatcher* dispatcher,
+                                                      void* multiSapProxy)
+{
+    const Scope* const pScope = current.get();
+    const void* const key = pScope != NULL ? pScope->m_key : NULL;
+
+    Proxy* const proxy = new Proxy(aabbMin, aabbMax, userPtr,
+                                   collisionFilterGroup, collisionFilterMask);
+    proxy->m_uniqueId = m_nextId++;
+
+    std::size_t index = m_aggregates.size();
+    if (key != NULL)
+    {
+        const std::map<const void*, std::size_t>::const_iterator it =
+            m_keys.find(key);
+        if (it != m_keys.end())
+        {
+            index = it->second;
+        }
+    }
+    if (index == m_aggregates.size())
+    {
+        Aggregate* const pAggregate = new Aggregate(key);
+        pAggregate->aabbMin = aabbMin;
+        pAggregate->aabbMax = aabbMax;
+        m_aggregates.push_back(pAggregate);
+        m_order.push_back(index);
+        if (key != NULL)
+        {
+            m_keys[key] = index;
+        }
+    }
+    Aggregate& aggregate = *m_aggregates[index];
+    aggregate.aabbMin.setMin(aabbMin);
+    aggregate.aabbMax.setMax(aabbMax);
+    proxy->aggregate = index;
+    proxy->member = aggregate.members.size();
+    aggregate.members.push_back(proxy);
+
+    assert(invariant());
+    return proxy;
+}
+
+void tgAggregateBroadphase::destroyProxy(btBroadphaseProxy* proxy,
+                                         btDispatcher* dispatcher)
+{
+    Proxy* const pProxy = static_cast<Proxy*>(proxy);
+    m_pairCache.removeOverlappingPairsContainingProxy(pProxy, dispatcher);
+
+    Aggregate& aggregate = *m_aggregates[pProxy->aggregate];
+    std::vector<Proxy*>& members = aggregate.members;
+    assert(members[pProxy->member] == pProxy);
+    // Erased rather than swapped, to keep the order by x
+    members.erase(members.begin() + pProxy->member);
+    for (std::size_t i = pProxy->member; i < members.size(); ++i)
+    {
+        members[i]->member = i;
+    }
+    if (members.empty())
+    {
+        removeAggregate(pProxy->aggregate);
+    }
+    delete pProxy;
+
+    assert(invariant());
+}
+
+void tgAggregateBroadphase::removeAggregate(std::size_t index)
+{
+    Aggregate* const pGone = m_aggregates[index];
+    if (pGone->key != NULL)
+    {
+        m_keys.erase(pGone->key);
+    }
+    const std::size_t last = m_aggregates.size() - 1;
+    m_order.erase(std::find(m_order.begin(), m_order.end(), index));
+    if (index != last)
+    {
+        Aggregate* const pMoved = m_aggregates[last];
+        m_aggregates[index] = pMoved;
+        for (std::size_t i = 0; i < pMoved->members.size(); ++i)
+        {
+            pMoved->members[i]->aggregate = index;
+        }
+        if (pMoved->key != NULL)
+        {
+            m_keys[pMoved->key] = index;
+        }
+        *std::find(m_order.begin(), m_order.end(), last) = index;
+    }
+    m_aggregates.pop_back();
+    delete pGone;
+}
+
+void tgAggregateBroadphase::setAabb(btBroadphaseProxy* proxy,
+                                    const btVector3& aabbMin,
+                                    const btVector3& aabbMax,
+                                    btDispatcher* dispatcher)
+{
+    Proxy* const pProxy = static_cast<Proxy*>(proxy);
+    pProxy->m_aabbMin = aabbMin;
+    pProxy->m_aabbMax = aabbMax;
+    // Grown at once for the queries, shrunk on the next step
+    Aggregate& aggregate = *m_aggregates[pProxy->aggregate];
+    aggregate.aabbMin.setMin(aabbMin);
+    aggregate.aabbMax.setMax(aabbMax);
+}
+
+void tgAggregateBroadphase::getAabb(btBroadphaseProxy* proxy,
+                                    btVector3& aabbMin,
+                                    btVector3& aabbMax) const
+{
+    aabbMin = proxy->m_aabbMin;
+    aabbMax = proxy->m_aabbMax;
+}
+
+void tgAggregateBroadphase::rayTest(const btVector3& rayFrom,
+                                    const btVector3& rayTo,
+                                    btBroadphaseRayCallback& rayCallback,
+                                    const btVector3& aabbMin,
+                                    const btVector3& aabbMax)
+{
+    // A cast shape's box sweeps with the ray, so the boxes it can hit
+    // grow by it, as in btDbvt::rayTestInternal()
+    for (std::size_t i = 0; i < m_aggregates.size(); ++i)
+    {
+        const Aggregate& aggregate = *m_aggregates[i];
+        btScalar param = 1.0;
+        btVector3 normal;
+        if (!btRayAabb(rayFrom, rayTo, aggregate.aabbMin - aabbMax,
+                       aggregate.aabbMax - aabbMin, param, normal))
+        {
+            continue;
+        }
+        for (std::size_t j = 0; j < aggregate.members.size(); ++j)
+        {
+            const Proxy* const pProxy = aggregate.members[j];
+            param = 1.0;
+            if (btRayAabb(rayFrom, rayTo, pProxy->m_aabbMin - aabbMax,
+                          pProxy->m_aabbMax - aabbMin, param, normal))
+            {
+                rayCallback.process(pProxy);
+            }
+        }
+    }
+}
+
+void tgAggregateBroadphase::aabbTest(const btVector3& aabbMin,
+                                     const btVector3& aabbMax,
+                                     btBroadphaseAabbCallback& callback)
+{
+    for (std::size_t i = 0; i < m_aggregates.size(); ++i)
+    {
+        const Aggregate& aggregate = *m_aggregates[i];
+        if (!TestAabbAgainstAabb2(aabbMin, aabbMax,
+                                  aggregate.aabbMin, aggregate.aabbMax))
+        {
+            continue;
+        }
+        for (std::size_t j = 0; j < aggregate.members.size(); ++j)
+        {
+            const Proxy* const pProxy = aggregate.members[j];
+            if (TestAabbAgainstAabb2(aabbMin, aabbMax,
+                                     pProxy->m_aabbMin, pProxy->m_aabbMax))
+            {
+                callback.process(pProxy);
+            }
+        }
+    }
+}
+
+namespace
+{
+    /** The lower x of an aggregate, by its index */
+    template <typename Aggregates>
+    class AggregateLowerX
+    {
+    public:
+        explicit AggregateLowerX(const Aggregates& aggregates) :
+            m_aggregates(aggregates)
+        {
+        }
+
+        btScalar operator()(std::size_t index) const
+        {
+            return m_aggregates[index]->aabbMin.x();
+        }
+
+    private:
+        const Aggregates& m_aggregates;
+    };
+}
+
+void tgAggregateBroadphase::calculateOverlappingPairs(btDispatcher* dispatcher)
+{
+    m_tests = 0;
+
+    PartedPairs parted;
+    m_pairCache.processAllOverlappingPairs(&parted, dispatcher);
+
+    // Refit the aggregates to their members as they are now
+    for (std::size_t i = 0; i < m_aggregates.size(); ++i)
+    {
+        Aggregate& aggregate = *m_aggregates[i];
+        std::vector<Proxy*>& members = aggregate.members;
+        sortByLowerX(members, proxyLowerX);
+        aggregate.aabbMin = members[0]->m_aabbMin;
+        aggregate.aabbMax = members[0]->m_aabbMax;
+        for (std::size_t j = 0; j < members.size(); ++j)
+        {
+            members[j]->member = j;
+            aggregate.aabbMin.setMin(members[j]->m_aabbMin);
+            aggregate.aabbMax.setMax(members[j]->m_aabbMax);
+        }
+    }
+    sortByLowerX(m_order, AggregateLowerX<std::vector<Aggregate*> >(m_aggregates));
+
+    // The top level sweep
+    const std::size_t n = m_order.size();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        Aggregate& a = *m_aggregates[m_order[i]];
+        collide(a, dispatcher);
+        for (std::size_t j = i + 1; j < n; ++j)
+        {
+            const Aggregate& b = *m_aggregates[m_order[j]];
+            if (b.aabbMin.x() > a.aabbMax.x())
+            {
+                break;
+            }
+            if (TestAabbAgainstAabb2(a.aabbMin, a.aabbMax,
+                                     b.aabbMin, b.aabbMax))
+            {
+                collide(a, b, dispatcher);
+            }
+        }
+    }
+}
+
+void tgAggregateBroadphase::collide(Aggregate& aggregate,
+                                    btDispatcher* dispatcher)
+{
+    const std::vector<Proxy*>& members = aggregate.members;
+    const std::size_t n = members.size();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        Proxy* const p = members[i];
+        for (std::size_t j = i + 1; j < n; ++j)
+        {
+            Proxy* const q = members[j];
+            if (q->m_aabbMin.x() > p->m_aabbMax.x())
+            {
+                break;
+            }
+            ++m_tests;
+            if (overlaps(*p, *q))
+            {
+                m_pairCache.addOverlappingPair(p, q);
+            }
+        }
+    }
+}
+
+void tgAggregateBroadphase::collide(const Aggregate& a, const Aggregate& b,
+                                    btDispatcher* dispatcher)
+{
+    btVector3 lower = a.aabbMin;
+    lower.setMax(b.aabbMin);
+    btVector3 upper = a.aabbMax;
+    upper.setMin(b.aabbMax);
+
+    // Only the members in the overlap can pair, in the order by x
+    m_inA.clear();
+    for (std::size_t i = 0; i < a.members.size(); ++i)
+    {
+        Proxy* const p = a.members[i];
+        if (TestAabbAgainstAabb2(lower, upper, p->m_aabbMin, p->m_aabbMax))
+        {
+            m_inA.push_back(p);
+        }
+    }
+    if (m_inA.empty())
+    {
+        return;
+    }
+    m_inB.clear();
+    for (std::size_t i = 0; i < b.members.size(); ++i)
+    {
+        Proxy* const q = b.members[i];
+        if (TestAabbAgainstAabb2(lower, upper, q->m_aabbMin, q->m_aabbMax))
+        {
+            m_inB.push_back(q);
+        }
+    }
+
+    // Sweep the two lists together: whichever starts lower is tested
+    // against the other list's members that start before it ends
+    const std::size_t nA = m_inA.size();
+    const std::size_t nB = m_inB.size();
+    std::size_t i = 0;
+    std::size_t j = 0;
+    while (i < nA && j < nB)
+    {
+        if (m_inA[i]->m_aabbMin.x() < m_inB[j]->m_aabbMin.x())
+        {
+            Proxy* const p = m_inA[i];
+            for (std::size_t k = j;
+                 k < nB && m_inB[k]->m_aabbMin.x() <= p->m_aabbMax.x(); ++k)
+            {
+                ++m_tests;
+                if (overlaps(*p, *m_inB[k]))
+                {
+                    m_pairCache.addOverlappingPair(p, m_inB[k]);
+                }
+            }
+            ++i;
+        }
+        else
+        {
+            Proxy* const q = m_inB[j];
+            for (std::size_t k = i;
+                 k < nA && m_inA[k]->m_aabbMin.x() <= q->m_aabbMax.x(); ++k)
+            {
+                ++m_tests;
+                if (overlaps(*m_inA[k], *q))
+                {
+                    m_pairCache.addOverlappingPair(m_inA[k], q);
+                }
+            }
+            ++j;
+        }
+    }
+}
+
+void tgAggregateBroadphase::getBroadphaseAabb(btVector3& aabbMin,
+                                              btVector3& aabbMax) const
+{
+    if (m_aggregates.empty())
+    {
+        aabbMin.setValue(0, 0, 0);
+        aabbMax.setValue(0, 0, 0);
+        return;
+    }
+    aabbMin = m_aggregates[0]->aabbMin;
+    aabbMax = m_aggregates[0]->aabbMax;
+    for (std::size_t i = 1; i < m_aggregates.size(); ++i)
+    {
+        aabbMin.setMin(m_aggregates[i]->aabbMin);
+        aabbMax.setMax(m_aggregates[i]->aabbMax);
+    }
+}
+
+void tgAggregateBroadphase::printStats()
+{
+    std::cout << "tgAggregateBroadphase: " << m_aggregates.size()
+              << " aggregates, " << m_keys.size() << " named, "
+              << m_tests << " tests, "
+              << m_pairCache.getNumOverlappingPairs() << " pairs"
+              << std::endl;
+}
+
+bool tgAggregateBroadphase::invariant() const
+{
+    return m_order.size() == m_aggregates.size() &&
+        m_keys.size() <= m_aggregates.size();
+}
@@ -0,0 +1,192 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_AGGREGATE_BROADPHASE_H
+#define TG_AGGREGATE_BROADPHASE_H
+
+/**
+ * @file tgAggregateBroadphase.h
+ * @brief Contains the definition of class tgAggregateBroadphase
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "BulletCollision/BroadphaseCollision/btBroadphaseInterface.h"
+#include "BulletCollision/BroadphaseCollision/btOverlappingPairCache.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <map>
+#include <vector>
+
+/**
+ * A two level broadphase, tgWorld::Config::AGGREGATE. The proxies made
+ * while a Scope is open form one aggregate, tgSimulation opens one
+ * around the setup of each model and obstacle, and the top level only
+ * sees the box around each aggregate. The proxies of two aggregates are
+ * tested against each other only where those boxes overlap, so robots
+ * far apart cost a box test per pair of robots, however many rods,
+ * boxes and ghosts they have. Proxies made outside a Scope, such as the
+ * ground and the bodies of persistent obstacles, are aggregates of one.
+ *
+ * Both levels are swept along x in an order kept from the last step,
+ * which is nearly sorted already. Every overlapping pair is offered to
+ * the pair cache on every call, and cached pairs whose boxes no longer
+ * overlap are dropped, so a pair the filter turned down earlier comes
+ * back on the next step once it is allowed.
+ */
+class tgAggregateBroadphase : public btBroadphaseInterface
+{
+public:
+
+    /**
+     * Puts the proxies this thread makes into one aggregate until
+     * destroyed, as the proxies of the open Scope before it were.
+     */
+    class Scope
+    {
+    public:
+        /**
+         * @param[in] key names the aggregate, the same for the same
+         * model, or NULL for aggregates of one
+         */
+        explicit Scope(const void* key);
+
+        ~Scope();
+
+    private:
+        // Not copyable
+        Scope(const Scope&);
+        Scope& operator=(const Scope&);
+
+        const void* const m_key;
+        Scope* const m_pPrevious;
+
+        friend class tgAggregateBroadphase;
+    };
+
+    tgAggregateBroadphase();
+
+    /** The proxies must have been destroyed. */
+    virtual ~tgAggregateBroadphase();
+
+    virtual btBroadphaseProxy* createProxy(const btVector3& aabbMin,
+                                           const btVector3& aabbMax,
+                                           int shapeType,
+                                           void* userPtr,
+                                           short int collisionFilterGroup,
+                                           short int collisionFilterMask,
+                                           btDispatcher* dispatcher,
+                                           void* multiSapProxy);
+
+    virtual void destroyProxy(btBroadphaseProxy* proxy,
+                              btDispatcher* dispatcher);
+
+    virtual void setAabb(btBroadphaseProxy* proxy,
+                         const btVector3& aabbMin,
+                         const btVector3& aabbMax,
+                         btDispatcher* dispatcher);
+
+    virtual void getAabb(btBroadphaseProxy* proxy,
+                         btVector3& aabbMin,
+                         btVector3& aabbMax) const;
+
+    /** Offer the callback the proxies whose boxes the ray hits. */
+    virtual void rayTest(const btVector3& rayFrom,
+                         const btVector3& rayTo,
+                         btBroadphaseRayCallback& rayCallback,
+                         const btVector3& aabbMin = btVector3(0, 0, 0),
+                         const btVector3& aabbMax = btVector3(0, 0, 0));
+
+    virtual void aabbTest(const btVector3& aabbMin,
+                          const btVector3& aabbMax,
+                          btBroadphaseAabbCallback& callback);
+
+    /** Find the pairs of this step, and drop the ones gone since. */
+    virtual void calculateOverlappingPairs(btDispatcher* dispatcher);
+
+    virtual btOverlappingPairCache* getOverlappingPairCache()
+    {
+        return &m_pairCache;
+    }
+
+    virtual const btOverlappingPairCache* getOverlappingPairCache() const
+    {
+        return &m_pairCache;
+    }
+
+    /** @return the box around every proxy, zero if there are none */
+    virtual void getBroadphaseAabb(btVector3& aabbMin,
+                                   btVector3& aabbMax) const;
+
+    virtual void printStats();
+
+    /** @return the number of aggregates, those of one included */
+    std::size_t getNumAggregates() const { return m_aggregates.size(); }
+
+    /**
+     * @return the number of proxy pairs tested by the last
+     * calculateOverlappingPairs()
+     */
+    std::size_t getNumTests() const { return m_tests; }
+
+private:
+
+    struct Proxy;
+    struct Aggregate;
+
+    /** Add the pairs of the members of an aggregate. */
+    void collide(Aggregate& aggregate, btDispatcher* dispatcher);
+
+    /**
+     * Add the pairs between the members of two aggregates that are in
+     * the overlap of their boxes.
+     */
+    void collide(const Aggregate& a, const Aggregate& b,
+                 btDispatcher* dispatcher);
+
+    /** Remove an aggregate, moving the last one into its place. */
+    void removeAggregate(std::size_t index);
+
+    /** Integrity predicate. */
+    bool invariant() const;
+
+private:
+
+    btHashedOverlappingPairCache m_pairCache;
+
+    /** Owned. All pointers are non-NULL, none is empty. */
+    std::vector<Aggregate*> m_aggregates;
+
+    /** The index in m_aggregates of each named aggregate */
+    std::map<const void*, std::size_t> m_keys;
+
+    /** Indices into m_aggregates by lower x, from the last step */
+    std::vector<std::size_t> m_order;
+
+    /** The unique ID of the next proxy */
+    int m_nextId;
+
+    /** See getNumTests() */
+    std::size_t m_tests;
+
+    /** Scratch for collide(a, b) */
+    std::vector<Proxy*> m_inA;
+    std::vector<Proxy*> m_inB;
+};
+
+#endif  // TG_AGGREGATE_BROADPHASE_H
@@ -0,0 +1,174 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgAssetCache.cpp
+ * @brief Contains the definition of members of class tgAssetCache
+ * $Id$
+ */
+
+// This module
+#include "tgAssetCache.h"
+// Boost
+#include <boost/thread/mutex.hpp>
+// The C++ Standard Library
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+// POSIX
+#include <sys/stat.h>
+
+namespace
+{
+    /** What identifies the contents of a file */
+    struct Stamp
+    {
+        dev_t device;
+        ino_t inode;
+        off_t size;
+        time_t seconds;
+        long nanoseconds;
+
+        bool operator==(const Stamp& other) const
+        {
+            return device == other.device && inode == other.inode &&
+                size == other.size && seconds == other.seconds &&
+                nanoseconds == other.nanoseconds;
+        }
+    };
+
+    struct Entry
+    {
+        Stamp stamp;
+        tgAssetCache::Handle asset;
+    };
+
+    /** Read and mapped assets are kept apart, keyed by path */
+    typedef std::map<std::pair<std::string, bool>, Entry> Assets;
+
+    boost::mutex& cacheMutex()
+    {
+        static boost::mutex mutex;
+        return mutex;
+    }
+
+    Assets& assets()
+    {
+        static Assets assets;
+        return assets;
+    }
+
+    Stamp stampOf(const std::string& path)
+    {
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0)
+        {
+            throw std::runtime_error("Can't open " + path + ": " +
+                                     std::strerror(errno));
+        }
+        Stamp stamp;
+        stamp.device = info.st_dev;
+        stamp.inode = info.st_ino;
+        stamp.size = info.st_size;
+        stamp.seconds = info.st_mtim.tv_sec;
+        stamp.nanoseconds = info.st_mtim.tv_nsec;
+        return stamp;
+    }
+} // namespace
+
+tgAssetCache::Handle tgAssetCache::read(const std::string& path)
+{
+    return load(path, false);
+}
+
+tgAssetCache::Handle tgAssetCache::map(const std::string& path)
+{
+    return load(path, true);
+}
+
+tgAssetCache::Handle tgAssetCache::load(const std::string& path, bool mapped)
+{
+    const Stamp stamp = stampOf(path);
+    const Assets::key_type key(path, mapped);
+    {
+        boost::mutex::scoped_lock lock(cacheMutex());
+        const Assets::const_iterator it = assets().find(key);
+        if (it != assets().end() && it->second.stamp == stamp)
+        {
+            return it->second.asset;
+        }
+    }
+
+    // Load outside the lock, so one large file doesn't hold up the others.
+    // Should two threads load the same file, the last one's copy is kept.
+    boost::shared_ptr<Asset> asset(new Asset());
+    if (mapped && stamp.size > 0)
+    {
+        try
+        {
+            namespace bip = boost::interprocess;
+            bip::file_mapping file(path.c_str(), bip::read_only);
+            bip::mapped_region region(file, bip::read_only);
+            asset->m_file.swap(file);
+            asset->m_region.swap(region);
+        }
+        catch (const boost::interprocess::interprocess_exception& e)
+        {
+            throw std::runtime_error("Can't map " + path + ": " + e.what());
+        }
+        asset->m_data = static_cast<const char*>(asset->m_region.get_address());
+        asset->m_size = asset->m_region.get_size();
+    }
+    else
+    {
+        std::ifstream input(path.c_str(), std::ios::in | std::ios::binary);
+        if (!input)
+        {
+            throw std::runtime_error("Can't open " + path);
+        }
+        std::ostringstream contents;
+        contents << input.rdbuf();
+        asset->m_buffer = contents.str();
+        asset->m_data = asset->m_buffer.data();
+        asset->m_size = asset->m_buffer.size();
+    }
+
+    // The stamp taken before loading, so a change made meanwhile is seen
+    // at the next lookup
+    Entry entry;
+    entry.stamp = stamp;
+    entry.asset = asset;
+    boost::mutex::scoped_lock lock(cacheMutex());
+    assets()[key] = entry;
+    return entry.asset;
+}
+
+void tgAssetCache::clear()
+{
+    boost::mutex::scoped_lock lock(cacheMutex());
+    assets().clear();
+}
+
+std::size_t tgAssetCache::size()
+{
+    boost::mutex::scoped_lock lock(cacheMutex());
+    return assets().size();
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_ASSET_CACHE_H
+#define TG_ASSET_CACHE_H
+
+/**
+ * @file tgAssetCache.h
+ * @brief Contains the definition of class tgAssetCache
+ * $Id$
+ */
+
+// Boost
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/shared_ptr.hpp>
+// The C++ Standard Library
+#include <cstddef>
+#include <string>
+
+/**
+ * The contents of the files a process reads, loaded once however many
+ * simulations ask for them: the YAML structures and compiled models of
+ * TensegrityModel, the JSON of FileHelpers::getFileString() and the
+ * weights of NeuralNetWeights. Assets are immutable and shared through
+ * reference counted handles, so every worker of a tgBatchSimulation
+ * reads the same copy, from any thread.
+ *
+ * The cache keeps each asset until clear(). A lookup checks the file's
+ * size, modification time and inode, so a file the learning scripts
+ * rewrite between trials is loaded again, while handles to the old
+ * contents stay valid.
+ *
+ * read() copies a file into memory, which suits files rewritten in place.
+ * map() maps it read only; the operating system then shares the pages
+ * with other processes too, but a file must be replaced by renaming a new
+ * one over it, never truncated, while it is mapped.
+ */
+class tgAssetCache
+{
+public:
+
+    /** The contents of one file */
+    class Asset
+    {
+    public:
+
+        const char* data() const { return m_data; }
+
+        std::size_t size() const { return m_size; }
+
+        /** @return a copy of the contents */
+        std::string str() const { return std::string(m_data, m_size); }
+
+        /** @return true if the contents are mapped rather than copied */
+        bool isMapped() const { return m_region.get_address() != NULL; }
+
+    private:
+
+        friend class tgAssetCache;
+
+        Asset() : m_data(NULL), m_size(0) { }
+
+        Asset(const Asset&);
+        Asset& operator=(const Asset&);
+
+        boost::interprocess::file_mapping m_file;
+        boost::interprocess::mapped_region m_region;
+
+        /** The contents of a file that is read, or is empty */
+        std::string m_buffer;
+
+        const char* m_data;
+        std::size_t m_size;
+    };
+
+    typedef boost::shared_ptr<const Asset> Handle;
+
+    /**
+     * The contents of a file, copied into memory.
+     * @param[in] path the file, cached under exactly this path
+     * @throw std::runtime_error if the file can't be read
+     */
+    static Handle read(const std::string& path);
+
+    /**
+     * The contents of a file, mapped read only. Empty files are read.
+     * @param[in] path the file, cached under exactly this path
+     * @throw std::runtime_error if the file can't be mapped
+     */
+    static Handle map(const std::string& path);
+
+    /** Forget every asset; handles still held stay valid. */
+    static void clear();
+
+    /** @return the number of assets cached */
+    static std::size_t size();
+
+private:
+
+    static Handle load(const std::string& path, bool mapped);
+};
+
+#endif  // TG_ASSET_CACHE_H
@@ -56,7 +56,7 @@ tgBaseRigid::tgBaseRigid(btRigidBody* pRigidBody,
 
 tgBaseRigid::~tgBaseRigid() { }
 
-void tgBaseRigid::onVisit(const tgModelVisitor& v) const
+void tgBaseRigid::accept(const tgModelVisitor& v) const
 {
     v.render(*this);
     
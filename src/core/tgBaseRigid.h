@@ -53,10 +53,10 @@ public:
     virtual void teardown();
     
     /**
-     * Double dispatch funciton. Will pass itself and any children
-     * back to the tgModelVisitor
+     * Double dispatch funciton. Will pass itself back to the
+     * tgModelVisitor; tgModel::onVisit() passes any children.
      */
-    virtual void onVisit(const tgModelVisitor& v) const;
+    virtual void accept(const tgModelVisitor& v) const;
     
     /**
      * Return the rod's mass in application-dependent units.
@@ -27,6 +27,8 @@
 #include "tgBulletSpringCable.h"
 #include "tgBasicActuator.h"
 #include "tgModelVisitor.h"
+#include "tgPerfCounters.h"
+#include "tgSnapshot.h"
 #include "tgWorld.h"
 // The Bullet Physics Library
 #include "LinearMath/btQuickprof.h"
@@ -46,7 +48,7 @@ void tgBasicActuator::constructorAux()
     prevVel = 0.0;
     if (m_springCable == NULL)
     {
-        throw std::invalid_argument("Pointer to tgBulletSpringCable is NULL.");
+        throw std::invalid_argument("Pointer to tgSpringCable is NULL.");
     }
     else if (m_config.targetVelocity < 0.0)
     {
@@ -58,10 +60,11 @@ void tgBasicActuator::constructorAux()
     }
     else
     {
-        logHistory();
+        // Seed the history with the values at construction
+        logHistory(0.0);
     }
 }
-tgBasicActuator::tgBasicActuator(tgBulletSpringCable* muscle,
+tgBasicActuator::tgBasicActuator(tgSpringCable* muscle,
                    const tgTags& tags,
                    tgSpringCableActuator::Config& config) :
     tgSpringCableActuator(muscle, tags, config),
@@ -98,6 +101,7 @@ void tgBasicActuator::step(double dt)
 #ifndef BT_NO_PROFILE 
     BT_PROFILE("tgBasicActuator::step");
 #endif //BT_NO_PROFILE   	
+    const tgPerfCounters::Scope counters("tgBasicActuator::step");
     if (dt <= 0.0)
     {
         throw std::invalid_argument("dt is not positive.");
@@ -106,32 +110,58 @@ void tgBasicActuator::step(double dt)
     {   
         // Want to update any controls before applying forces
         notifyStep(dt); 
-        m_springCable->step(dt);
-        logHistory();  
+        if (!m_deferCableForces)
+        {
+            m_springCable->step(dt);
+            logHistory(dt);
+        }
         tgModel::step(dt);
+        ++m_stepCount;
     }
 }
 
-void tgBasicActuator::onVisit(const tgModelVisitor& r) const
+void tgBasicActuator::accept(const tgModelVisitor& r) const
 {
 #ifndef BT_NO_PROFILE 
-    BT_PROFILE("tgBasicActuator::onVisit");
+    BT_PROFILE("tgBasicActuator::accept");
 #endif //BT_NO_PROFILE	
     r.render(*this);
 }
     
-void tgBasicActuator::logHistory()
+void tgBasicActuator::storeState(tgSnapshot& snapshot)
+{
+    tgSpringCableActuator::storeState(snapshot);
+    snapshot.write(m_preferredLength);
+    snapshot.write(prevVel);
+}
+
+void tgBasicActuator::restoreState(const tgSnapshot& snapshot)
+{
+    tgSpringCableActuator::restoreState(snapshot);
+    m_preferredLength = snapshot.read();
+    prevVel = snapshot.read();
+}
+    
+bool tgBasicActuator::deferCableForces(bool defer)
+{
+    return setCableForcesDeferred(defer);
+}
+
+void tgBasicActuator::finishDeferredStep(double dt)
+{
+    logHistory(dt);
+}
+    
+void tgBasicActuator::logHistory(double dt)
 {
     m_prevVelocity = m_springCable->getVelocity();
 
-    if (m_config.hist)
-    {
-        m_pHistory->lastLengths.push_back(m_springCable->getActualLength());
-        m_pHistory->lastVelocities.push_back(m_springCable->getVelocity());
-        m_pHistory->dampingHistory.push_back(m_springCable->getDamping());
-        m_pHistory->restLengths.push_back(m_springCable->getRestLength());
-        m_pHistory->tensionHistory.push_back(m_springCable->getTension());
-    }
+    recordHistory(m_springCable->getActualLength(),
+                  m_springCable->getVelocity(),
+                  m_springCable->getDamping(),
+                  m_springCable->getRestLength(),
+                  m_springCable->getTension(),
+                  dt);
 }
 
 void tgBasicActuator::setControlInput(double input)
@@ -142,6 +172,7 @@ void tgBasicActuator::setControlInput(double input)
     }
     else
     {
+        recordControlInput(input, 0.0);
         m_preferredLength = input;
     }
 }    
@@ -154,6 +185,7 @@ void tgBasicActuator::setControlInput(double input, double dt)
     }
     else
     {
+        recordControlInput(input, dt);
         m_preferredLength = input;
         
         // moveMotors can change m_preferred length, so this goes here for now
@@ -43,13 +43,13 @@ public:
 
     /**
      * Constructor using tags. Typically called in tgBasicActuatorInfo.cpp 
-     * @param[in] muscle The muscle2P object that this controls and logs.
-     * Set up in tgBasicActuatorInfo.cpp
+     * @param[in] muscle The spring cable that this controls and logs,
+     * such as a tgBulletSpringCable set up in tgBasicActuatorInfo.cpp
      * @param[in] tags as passed through tgStructure and tgStructureInfo
      * @param[in] config Holds member variables like elasticity, damping
      * and motor parameters. See tgSpringCableActuator
      */    
-    tgBasicActuator(tgBulletSpringCable* muscle,
+    tgBasicActuator(tgSpringCable* muscle,
            const tgTags& tags,
            tgSpringCableActuator::Config& config);
     
@@ -83,7 +83,32 @@ public:
      * data logging as of May 2014.
      * @param[in] r, the visiting tgModelVisitor
      */
-    virtual void onVisit(const tgModelVisitor& r) const;
+    virtual void accept(const tgModelVisitor& r) const;
+
+    /**
+     * Stores the tgSpringCableActuator state, then the preferred length and previous velocity.
+     * @param[in,out] snapshot the snapshot to append to
+     */
+    virtual void storeState(tgSnapshot& snapshot);
+
+    /**
+     * Reads back what storeState() wrote, in the same order.
+     * @param[in] snapshot the snapshot to read from
+     */
+    virtual void restoreState(const tgSnapshot& snapshot);
+
+    /**
+     * Supported when the spring cable is a plain tgBulletSpringCable.
+     * While deferred, step() still notifies controllers and moves the
+     * motor, but the cable force and history wait for the
+     * tgCableForcePass.
+     * @param[in] defer true to defer
+     * @return true if the request was honored
+     */
+    virtual bool deferCableForces(bool defer);
+    
+    /** Logs the history that step() skipped while deferred. */
+    virtual void finishDeferredStep(double dt);
     
     
     /** Functions for interfacing with higher level controllers */
@@ -118,9 +143,10 @@ private:
 
     /**
      * Append damping, rest length and tension values to the history member
-     * variables.
+     * variables, and update the running aggregates.
+     * @param[in] dt the step just taken, or zero at construction
      */
-    void logHistory();
+    void logHistory(double dt);
 
     /** Integrity predicate. */
     bool invariant() const;
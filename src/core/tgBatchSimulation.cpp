@@ -0,0 +1,435 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgBatchSimulation.cpp
+ * @brief Contains the definitions of members of class tgBatchSimulation
+ * $Id$
+ */
+
+// This module
+#include "tgBatchSimulation.h"
+// This application
+#include "tgModel.h"
+#include "tgSimView.h"
+#include "tgSimulation.h"
+#include "tgSnapshot.h"
+#include "tgStepTimes.h"
+// The C++ Standard Library
+#include <cassert>
+#include <stdexcept>
+
+namespace
+{
+    /** Build one world, with its view and simulation. */
+    class BuildTask : public tgThreadPool::Task
+    {
+    public:
+        BuildTask(std::vector<tgWorld*>& worlds,
+                  std::vector<tgSimView*>& views,
+                  std::vector<tgSimulation*>& simulations,
+                  const tgWorld::Config& config, double stepSize) :
+            m_worlds(worlds),
+            m_views(views),
+            m_simulations(simulations),
+            m_config(config),
+            m_stepSize(stepSize)
+        {
+        }
+
+        virtual void operator()(std::size_t item)
+        {
+            tgWorld* const pWorld = new tgWorld(m_config);
+            m_worlds[item] = pWorld;
+            // Each world draws its own random streams, see tgRandom
+            pWorld->setStream(item);
+            // The render rate is irrelevant for a headless view, so make
+            // it the step size
+            m_views[item] = new tgSimView(*pWorld, m_stepSize, m_stepSize);
+            m_simulations[item] = new tgSimulation(*m_views[item]);
+        }
+
+    private:
+        std::vector<tgWorld*>& m_worlds;
+        std::vector<tgSimView*>& m_views;
+        std::vector<tgSimulation*>& m_simulations;
+        const tgWorld::Config& m_config;
+        const double m_stepSize;
+    };
+
+    /** Add a model to one simulation, on the worker of its world. */
+    class SetupTask : public tgThreadPool::Task
+    {
+    public:
+        SetupTask(tgSimulation& simulation, std::size_t world,
+                  tgModel* pModel) :
+            m_simulation(simulation),
+            m_world(world),
+            m_pModel(pModel)
+        {
+        }
+
+        virtual void operator()(std::size_t item)
+        {
+            if (item == m_world)
+            {
+                m_simulation.addModel(m_pModel);
+            }
+        }
+
+    private:
+        tgSimulation& m_simulation;
+        const std::size_t m_world;
+        tgModel* const m_pModel;
+    };
+
+    /** Advance one simulation by a fixed number of steps. */
+    class RunTask : public tgThreadPool::Task
+    {
+    public:
+        RunTask(const std::vector<tgSimulation*>& simulations,
+                double stepSize, int steps,
+                std::vector<std::size_t>& counts,
+                std::vector<double>& seconds) :
+            m_simulations(simulations),
+            m_stepSize(stepSize),
+            m_steps(steps),
+            m_counts(counts),
+            m_seconds(seconds)
+        {
+        }
+
+        virtual void operator()(std::size_t item)
+        {
+            const tgSimulation& simulation = *m_simulations[item];
+            const long long start = tgStepTimes::now();
+            for (int i = 0; i < m_steps; ++i)
+            {
+                simulation.step(m_stepSize);
+            }
+            // Only this item's worker writes its entries
+            m_counts[item] += m_steps;
+            m_seconds[item] += (tgStepTimes::now() - start) * 1.0e-9;
+        }
+
+    private:
+        const std::vector<tgSimulation*>& m_simulations;
+        const double m_stepSize;
+        const int m_steps;
+        std::vector<std::size_t>& m_counts;
+        std::vector<double>& m_seconds;
+    };
+
+    /** Reset one simulation. */
+    class ResetTask : public tgThreadPool::Task
+    {
+    public:
+        ResetTask(const std::vector<tgSimulation*>& simulations) :
+            m_simulations(simulations)
+        {
+        }
+
+        virtual void operator()(std::size_t item)
+        {
+            m_simulations[item]->reset();
+        }
+
+    private:
+        const std::vector<tgSimulation*>& m_simulations;
+    };
+
+    /** Restore one simulation from its own copy of a state. */
+    class RestoreTask : public tgThreadPool::Task
+    {
+    public:
+        RestoreTask(const std::vector<tgSimulation*>& simulations,
+                    const tgSnapshot& state) :
+            m_simulations(simulations),
+            // A snapshot's read position is not shared between threads
+            m_states(simulations.size(), state)
+        {
+        }
+
+        virtual void operator()(std::size_t item)
+        {
+            m_simulations[item]->restore(m_states[item]);
+        }
+
+    private:
+        const std::vector<tgSimulation*>& m_simulations;
+        const std::vector<tgSnapshot> m_states;
+    };
+
+    /** Restore each simulation from a state of its own. */
+    class RestoreEachTask : public tgThreadPool::Task
+    {
+    public:
+        RestoreEachTask(const std::vector<tgSimulation*>& simulations,
+                        const std::vector<tgSnapshot>& states) :
+            m_simulations(simulations),
+            m_states(states)
+        {
+        }
+
+        virtual void operator()(std::size_t item)
+        {
+            m_simulations[item]->restore(m_states[item]);
+        }
+
+    private:
+        const std::vector<tgSimulation*>& m_simulations;
+        const std::vector<tgSnapshot>& m_states;
+    };
+}
+
+tgBatchSimulation::Throughput::Throughput() :
+    node(0),
+    workers(0),
+    worlds(0),
+    steps(0),
+    seconds(0.0)
+{
+}
+
+tgBatchSimulation::tgBatchSimulation(std::size_t nWorlds,
+                                     const tgWorld::Config& config,
+                                     double stepSize,
+                                     std::size_t nThreads,
+                                     bool pinned) :
+    m_stepSize(stepSize),
+    m_worlds(nWorlds, NULL),
+    m_views(nWorlds, NULL),
+    m_simulations(nWorlds, NULL),
+    m_steps(nWorlds, 0),
+    m_seconds(nWorlds, 0.0),
+    m_pool(nThreads, pinned),
+    m_pController(NULL)
+{
+    if (nWorlds == 0)
+    {
+        throw std::invalid_argument("nWorlds is not positive");
+    }
+    else if (stepSize <= 0.0)
+    {
+        throw std::invalid_argument("stepSize is not positive");
+    }
+    
+    BuildTask task(m_worlds, m_views, m_simulations, config, stepSize);
+    try
+    {
+        if (m_pool.isPinned())
+        {
+            // First touch each world on the node that steps it
+            m_pool.run(task, nWorlds);
+        }
+        else
+        {
+            for (std::size_t i = 0; i < nWorlds; ++i)
+            {
+                task(i);
+            }
+        }
+    }
+    catch (...)
+    {
+        destroy();
+        throw;
+    }
+
+    // Postcondition
+    assert(invariant());
+    assert(size() == nWorlds);
+}
+
+tgBatchSimulation::~tgBatchSimulation()
+{
+    destroy();
+}
+
+void tgBatchSimulation::destroy()
+{
+    // The simulations reference the views, which reference the worlds.
+    // Deleting NULL does nothing, for a constructor that failed.
+    for (std::size_t i = 0; i < m_simulations.size(); ++i)
+    {
+        delete m_simulations[i];
+        m_simulations[i] = NULL;
+    }
+    for (std::size_t i = 0; i < m_views.size(); ++i)
+    {
+        delete m_views[i];
+        m_views[i] = NULL;
+    }
+    for (std::size_t i = 0; i < m_worlds.size(); ++i)
+    {
+        delete m_worlds[i];
+        m_worlds[i] = NULL;
+    }
+}
+
+void tgBatchSimulation::addModel(std::size_t world, tgModel* pModel)
+{
+    tgSimulation& simulation = getSimulation(world);
+    if (m_pool.isPinned())
+    {
+        if (pModel == NULL)
+        {
+            throw std::invalid_argument("NULL pointer to tgModel");
+        }
+        // The items before world go to other workers, which skip them
+        SetupTask task(simulation, world, pModel);
+        m_pool.run(task, world + 1);
+    }
+    else
+    {
+        simulation.addModel(pModel);
+    }
+
+    // Postcondition
+    assert(invariant());
+}
+
+void tgBatchSimulation::run(int steps)
+{
+    if (m_pController)
+    {
+        // Lockstep, so the controller sees every world at the same time
+        RunTask task(m_simulations, m_stepSize, 1, m_steps, m_seconds);
+        for (int i = 0; i < steps; ++i)
+        {
+            m_pController->onStep(*this, m_stepSize);
+            m_pool.run(task, m_simulations.size());
+        }
+    }
+    else if (steps > 0)
+    {
+        RunTask task(m_simulations, m_stepSize, steps, m_steps, m_seconds);
+        m_pool.run(task, m_simulations.size());
+    }
+
+    // Postcondition
+    assert(invariant());
+}
+
+void tgBatchSimulation::step()
+{
+    run(1);
+}
+
+void tgBatchSimulation::reset()
+{
+    ResetTask task(m_simulations);
+    m_pool.run(task, m_simulations.size());
+
+    // Postcondition
+    assert(invariant());
+}
+
+void tgBatchSimulation::restore(const tgSnapshot& state)
+{
+    RestoreTask task(m_simulations, state);
+    m_pool.run(task, m_simulations.size());
+
+    // Postcondition
+    assert(invariant());
+}
+
+void tgBatchSimulation::restore(const std::vector<tgSnapshot>& states)
+{
+    if (states.size() != m_simulations.size())
+    {
+        throw std::invalid_argument("Not one state per world");
+    }
+    RestoreEachTask task(m_simulations, states);
+    m_pool.run(task, m_simulations.size());
+
+    // Postcondition
+    assert(invariant());
+}
+
+tgMemoryReport tgBatchSimulation::getMemoryReport() const
+{
+    tgMemoryReport report;
+    for (std::size_t i = 0; i < m_simulations.size(); i++)
+    {
+        report += m_simulations[i]->getMemoryReport();
+    }
+    return report;
+}
+
+std::vector<tgBatchSimulation::Throughput>
+tgBatchSimulation::getThroughput() const
+{
+    std::vector<Throughput> nodes;
+    for (std::size_t w = 0; w < m_pool.size(); ++w)
+    {
+        const std::size_t node = m_pool.getNode(w);
+        if (node >= nodes.size())
+        {
+            nodes.resize(node + 1);
+        }
+        nodes[node].workers++;
+    }
+    for (std::size_t i = 0; i < m_simulations.size(); ++i)
+    {
+        Throughput& t = nodes[m_pool.getNode(m_pool.getWorker(i))];
+        t.worlds++;
+        t.steps += m_steps[i];
+        t.seconds += m_seconds[i];
+    }
+
+    // Drop the nodes no worker landed on
+    std::vector<Throughput> result;
+    for (std::size_t node = 0; node < nodes.size(); ++node)
+    {
+        if (nodes[node].workers > 0)
+        {
+            nodes[node].node = node;
+            result.push_back(nodes[node]);
+        }
+    }
+    return result;
+}
+
+tgSimulation& tgBatchSimulation::getSimulation(std::size_t world) const
+{
+    if (world >= m_simulations.size())
+    {
+        throw std::out_of_range("world index is out of range");
+    }
+    return *m_simulations[world];
+}
+
+tgWorld& tgBatchSimulation::getWorld(std::size_t world) const
+{
+    if (world >= m_worlds.size())
+    {
+        throw std::out_of_range("world index is out of range");
+    }
+    return *m_worlds[world];
+}
+
+bool tgBatchSimulation::invariant() const
+{
+    return
+        (m_stepSize > 0.0) &&
+        (m_worlds.size() == m_views.size()) &&
+        (m_views.size() == m_simulations.size()) &&
+        (m_steps.size() == m_simulations.size()) &&
+        (m_seconds.size() == m_simulations.size());
+}
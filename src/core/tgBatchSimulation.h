@@ -0,0 +1,260 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_BATCH_SIMULATION_H
+#define TG_BATCH_SIMULATION_H
+
+/**
+ * @file tgBatchSimulation.h
+ * @brief Contains the definition of class tgBatchSimulation
+ * $Id$
+ */
+
+// This application
+#include "tgMemoryReport.h"
+#include "tgWorld.h"
+#include "tgThreadPool.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class tgModel;
+class tgSimView;
+class tgSimulation;
+class tgSnapshot;
+
+/**
+ * Owns a number of independent, headless simulations (each with its own
+ * tgWorld, tgSimView and tgSimulation) and advances them concurrently on
+ * a tgThreadPool, one world per worker at a time. This lets a learning
+ * run evaluate many short trials in one process instead of paying process
+ * startup, Bullet initialization and model parsing for each of them.
+ *
+ * A Controller set with setController() can drive every world from one
+ * place, so the controllers of identical models run as one batch.
+ *
+ * A pinned batch keeps each worker on one CPU, spread over the NUMA
+ * nodes of the machine (see tgCpuTopology), and builds every world, and
+ * sets up its models, on the worker that steps it. The arena, cable bank
+ * and Bullet objects of a world are then first touched, and so placed,
+ * on that worker's node, rather than all on the node of the thread that
+ * made the batch. getThroughput() reports the steps of each node.
+ *
+ * Each world must get its own model instances; models are never shared
+ * between worlds. Bullet's built-in profiler (BT_PROFILE) keeps global
+ * state, so builds that step more than one world at a time should define
+ * BT_NO_PROFILE.
+ */
+class tgBatchSimulation
+{
+public:
+
+    /**
+     * Controls every world of a batch at once, such as a network per
+     * world evaluated in one NeuralNetBatch pass instead of one
+     * controller per model. While one is set, run() steps the worlds in
+     * lockstep and calls onStep() between the steps, on the calling
+     * thread, with no world being stepped.
+     */
+    class Controller
+    {
+    public:
+        virtual ~Controller() { }
+
+        /**
+         * Read the worlds' sensors and set their actuators for the step
+         * about to be taken.
+         * @param[in,out] batch the batch stepped
+         * @param[in] dt the step size
+         */
+        virtual void onStep(tgBatchSimulation& batch, double dt) = 0;
+    };
+
+    /** The steps taken by the workers of one NUMA node */
+    struct Throughput
+    {
+        Throughput();
+
+        /** The node */
+        std::size_t node;
+
+        /** The workers on the node */
+        std::size_t workers;
+
+        /** The worlds those workers step */
+        std::size_t worlds;
+
+        /** The world steps they took */
+        std::size_t steps;
+
+        /**
+         * The seconds they spent taking them, summed over the worlds;
+         * steps / seconds is the rate of one of the node's cores
+         */
+        double seconds;
+    };
+
+    /**
+     * Create nWorlds empty worlds with the same configuration.
+     * @param[in] nWorlds the number of independent worlds; must be positive
+     * @param[in] config the configuration of every world
+     * @param[in] stepSize the time interval for advancing each world;
+     * must be positive
+     * @param[in] nThreads the number of worker threads; 0 selects the
+     * number of hardware threads
+     * @param[in] pinned true to pin the workers and build each world on
+     * its own, see the class comment
+     * @throw std::invalid_argument if nWorlds or stepSize is not positive
+     */
+    tgBatchSimulation(std::size_t nWorlds,
+                      const tgWorld::Config& config = tgWorld::Config(),
+                      double stepSize = 1.0/1000.0,
+                      std::size_t nThreads = 0,
+                      bool pinned = false);
+
+    /** Delete the simulations, views and worlds, in that order. */
+    ~tgBatchSimulation();
+
+    /**
+     * Add a model to one of the worlds. Ownership passes to that
+     * world's tgSimulation. A pinned batch sets the model up on the
+     * world's worker, and rethrows what setup throws as a
+     * std::runtime_error.
+     * @param[in] world the index of the world
+     * @param[in] pModel the model; must not be NULL
+     * @throw std::out_of_range if world is not less than size()
+     * @throw std::invalid_argument if pModel is NULL
+     */
+    void addModel(std::size_t world, tgModel* pModel);
+
+    /**
+     * Advance every world by steps * getStepSize() seconds. Returns when
+     * all of the worlds are done.
+     * @param[in] steps the number of steps
+     */
+    void run(int steps);
+
+    /** Advance every world by one step. */
+    void step();
+
+    /**
+     * Control the worlds with a batched controller, see Controller.
+     * Without one, run() lets each worker step its world through all the
+     * steps at once.
+     * @param[in] pController not owned, or NULL to stop
+     */
+    void setController(Controller* pController) { m_pController = pController; }
+
+    /**
+     * Call tgSimulation::reset() on every world, concurrently.
+     */
+    void reset();
+
+    /**
+     * Call tgSimulation::restore() on every world with the same state,
+     * concurrently. The state may come from any simulation whose world
+     * and models were built like these, so K candidate actions can be
+     * rolled out at once from the state of a main simulation; see
+     * tgSimulationFork.
+     * @param[in] state a snapshot of a simulation built like every world
+     * @throw std::runtime_error if the state does not match a world
+     */
+    void restore(const tgSnapshot& state);
+
+    /**
+     * Call tgSimulation::restore() on every world with a state of its
+     * own, concurrently, such as the starts of perturbed worlds.
+     * @param[in] states one snapshot per world, in world order
+     * @throw std::invalid_argument if there is not one state per world
+     * @throw std::runtime_error if a state does not match its world
+     */
+    void restore(const std::vector<tgSnapshot>& states);
+
+    /**
+     * Return the simulation of one world, e.g. to attach data managers
+     * or obstacles, or to read results after run().
+     * @param[in] world the index of the world
+     * @throw std::out_of_range if world is not less than size()
+     */
+    tgSimulation& getSimulation(std::size_t world) const;
+
+    /**
+     * Return one of the worlds.
+     * @param[in] world the index of the world
+     * @throw std::out_of_range if world is not less than size()
+     */
+    tgWorld& getWorld(std::size_t world) const;
+
+    /**
+     * Return the memory of every world, summed; divide by size() for the
+     * cost of one world. See tgSimulation::getMemoryReport().
+     */
+    tgMemoryReport getMemoryReport() const;
+
+    /**
+     * Return the steps run() has taken, per NUMA node of the workers, in
+     * node order. An unpinned batch reports all of them as node 0.
+     */
+    std::vector<Throughput> getThroughput() const;
+
+    /** Return the number of worlds. */
+    std::size_t size() const { return m_simulations.size(); }
+
+    /** Return the time interval for advancing each world. */
+    double getStepSize() const { return m_stepSize; }
+
+    /** Return the number of worker threads. */
+    std::size_t getNumThreads() const { return m_pool.size(); }
+
+private:
+
+    /** Delete the simulations, views and worlds, in that order. */
+    void destroy();
+
+    /** Integrity predicate. */
+    bool invariant() const;
+
+private:
+
+    /** The time interval for advancing each world. Positive. */
+    const double m_stepSize;
+
+    /** The worlds. Owned. All pointers are non-NULL. */
+    std::vector<tgWorld*> m_worlds;
+
+    /** One headless view per world. Owned. All pointers are non-NULL. */
+    std::vector<tgSimView*> m_views;
+
+    /** One simulation per world. Owned. All pointers are non-NULL. */
+    std::vector<tgSimulation*> m_simulations;
+
+    /** The steps run() has taken of each world. */
+    std::vector<std::size_t> m_steps;
+
+    /** The seconds those steps took. */
+    std::vector<double> m_seconds;
+
+    /** The workers that step the worlds. */
+    tgThreadPool m_pool;
+
+    /** Not owned, may be NULL */
+    Controller* m_pController;
+};
+
+#endif  // TG_BATCH_SIMULATION_H
@@ -0,0 +1,496 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgBatchedRenderer.cpp
+ * @brief Contains the definitions of members of class tgBatchedRenderer
+ * $Id$
+ */
+
+// This module
+#include "tgBatchedRenderer.h"
+// This application
+#include "abstractMarker.h"
+#include "tgBaseRigid.h"
+#include "tgBulletCompressionSpring.h"
+#include "tgCast.h"
+#include "tgCompressionSpringActuator.h"
+#include "tgCordeCable.h"
+#include "tgModel.h"
+#include "tgRod.h"
+#include "tgSpringCable.h"
+#include "tgSpringCableActuator.h"
+#include "tgSpringCableAnchor.h"
+// Bullet OpenGL_FreeGlut (patched files)
+#include "tgGlutStuff.h"
+// The Bullet Physics library
+#include "BulletCollision/CollisionShapes/btCapsuleShape.h"
+#include "BulletCollision/CollisionShapes/btCompoundShape.h"
+#include "BulletCollision/CollisionShapes/btCylinderShape.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btQuickprof.h"
+// The C++ Standard Library
+#include <cmath>
+
+namespace
+{
+  /** Sides of the cylinders */
+  const int sides = 12;
+
+  void addLine(tgBatchedRenderer::Batch& batch, const btVector3& from,
+               const btVector3& to, const btVector3& color)
+  {
+    const float vertices[6] = {
+      (float)from.x(), (float)from.y(), (float)from.z(),
+      (float)to.x(), (float)to.y(), (float)to.z()
+    };
+    const float colors[6] = {
+      (float)color.x(), (float)color.y(), (float)color.z(),
+      (float)color.x(), (float)color.y(), (float)color.z()
+    };
+    batch.lineVertices.insert(batch.lineVertices.end(), vertices, vertices + 6);
+    batch.lineColors.insert(batch.lineColors.end(), colors, colors + 6);
+  }
+
+  void addVertex(std::vector<float>& vertices, std::vector<float>& normals,
+                 const btTransform& transform, const btVector3& local,
+                 const btVector3& normal)
+  {
+    const btVector3 v = transform * local;
+    const btVector3 n = transform.getBasis() * normal;
+    vertices.push_back(v.x());
+    vertices.push_back(v.y());
+    vertices.push_back(v.z());
+    normals.push_back(n.x());
+    normals.push_back(n.y());
+    normals.push_back(n.z());
+  }
+
+  /** A point of the cylinder's side, with the up axis as given */
+  btVector3 sidePoint(int upAxis, double radius, double height, int side)
+  {
+    const double angle = 2.0 * M_PI * side / sides;
+    const double a = radius * cos(angle);
+    const double b = radius * sin(angle);
+    switch (upAxis)
+    {
+    // Cyclic, so that the side faces outwards
+    case 0:
+      return btVector3(height, b, a);
+    case 2:
+      return btVector3(b, a, height);
+    default:
+      return btVector3(a, height, b);
+    }
+  }
+
+  void grow(btVector3& min, btVector3& max, bool& empty, const btVector3& p)
+  {
+    if (empty)
+    {
+      min = p;
+      max = p;
+      empty = false;
+    }
+    else
+    {
+      min.setMin(p);
+      max.setMax(p);
+    }
+  }
+
+  /** Row i of a column major 4 by 4 matrix */
+  btVector4 row(const double m[16], int i)
+  {
+    return btVector4(m[i], m[4 + i], m[8 + i], m[12 + i]);
+  }
+}
+
+void tgBatchedRenderer::Batch::clear()
+{
+  lineVertices.clear();
+  lineColors.clear();
+  cylinders.clear();
+}
+
+void tgBatchedRenderer::Batch::draw(bool drawCylinders) const
+{
+#ifndef BT_NO_PROFILE
+  BT_PROFILE("tgBatchedRenderer::draw");
+#endif //BT_NO_PROFILE
+  glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT);
+  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+  glEnableClientState(GL_VERTEX_ARRAY);
+
+  if (!lineVertices.empty())
+  {
+    glDisable(GL_LIGHTING);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, &lineVertices[0]);
+    glColorPointer(3, GL_FLOAT, 0, &lineColors[0]);
+    glDrawArrays(GL_LINES, 0, lineVertices.size() / 3);
+    glDisableClientState(GL_COLOR_ARRAY);
+  }
+
+  if (drawCylinders && !cylinders.empty())
+  {
+    triangleVertices.clear();
+    triangleNormals.clear();
+    for (std::size_t i = 0; i < cylinders.size(); i++)
+    {
+      const Cylinder& c = cylinders[i];
+      btVector3 up(0.0, 0.0, 0.0);
+      up[c.upAxis] = 1.0;
+      for (int s = 0; s < sides; s++)
+      {
+        const btVector3 b0 = sidePoint(c.upAxis, c.radius, -c.halfHeight, s);
+        const btVector3 b1 = sidePoint(c.upAxis, c.radius, -c.halfHeight, s + 1);
+        const btVector3 t0 = sidePoint(c.upAxis, c.radius, c.halfHeight, s);
+        const btVector3 t1 = sidePoint(c.upAxis, c.radius, c.halfHeight, s + 1);
+        const btVector3 n0 = (b0 - up * b0.dot(up)).normalized();
+        const btVector3 n1 = (b1 - up * b1.dot(up)).normalized();
+        const btVector3 bottom = -up * c.halfHeight;
+        const btVector3 top = up * c.halfHeight;
+
+        // The side
+        addVertex(triangleVertices, triangleNormals, c.transform, b0, n0);
+        addVertex(triangleVertices, triangleNormals, c.transform, t0, n0);
+        addVertex(triangleVertices, triangleNormals, c.transform, b1, n1);
+        addVertex(triangleVertices, triangleNormals, c.transform, b1, n1);
+        addVertex(triangleVertices, triangleNormals, c.transform, t0, n0);
+        addVertex(triangleVertices, triangleNormals, c.transform, t1, n1);
+        // The caps
+        addVertex(triangleVertices, triangleNormals, c.transform, top, up);
+        addVertex(triangleVertices, triangleNormals, c.transform, t1, up);
+        addVertex(triangleVertices, triangleNormals, c.transform, t0, up);
+        addVertex(triangleVertices, triangleNormals, c.transform, bottom, -up);
+        addVertex(triangleVertices, triangleNormals, c.transform, b0, -up);
+        addVertex(triangleVertices, triangleNormals, c.transform, b1, -up);
+      }
+    }
+
+    glEnable(GL_LIGHTING);
+    glEnable(GL_COLOR_MATERIAL);
+    glColor3f(0.8f, 0.8f, 0.8f);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, &triangleVertices[0]);
+    glNormalPointer(GL_FLOAT, 0, &triangleNormals[0]);
+    glDrawArrays(GL_TRIANGLES, 0, triangleVertices.size() / 3);
+  }
+
+  glPopClientAttrib();
+  glPopAttrib();
+}
+
+tgBatchedRenderer::tgBatchedRenderer(const tgWorld& world) :
+  tgBulletRenderer(world),
+  m_hasView(false)
+{
+}
+
+void tgBatchedRenderer::render(const tgSpringCableActuator& mSCA) const
+{
+  const tgSpringCable* const pSpringCable = mSCA.getSpringCable();
+  if (pSpringCable == NULL)
+  {
+    return;
+  }
+
+  // The same colors as tgBulletRenderer
+  const double stretch = mSCA.getCurrentLength() - mSCA.getRestLength();
+  const btVector3 color =
+    (stretch < 0.0) ?
+    btVector3(0.0, 0.0, 1.0) :
+    btVector3(0.5 + stretch / 3.0,
+              0.5 - stretch / 2.0,
+              0.0);
+
+  // Along the chain of point masses of a Corde cable
+  const tgCordeCable* const pCorde =
+    tgCast::cast<tgSpringCable, tgCordeCable>(pSpringCable);
+  if (pCorde != NULL)
+  {
+    for (std::size_t i = 0; i + 1 < pCorde->getResolution(); i++)
+    {
+      addLine(m_batch, pCorde->getPoint(i), pCorde->getPoint(i + 1), color);
+    }
+    return;
+  }
+
+  const std::vector<const tgSpringCableAnchor*>& anchors =
+    pSpringCable->getAnchors();
+  for (std::size_t i = 0; i + 1 < anchors.size(); i++)
+  {
+    addLine(m_batch, anchors[i]->getWorldPosition(),
+            anchors[i + 1]->getWorldPosition(), color);
+  }
+}
+
+void tgBatchedRenderer::render(const tgCompressionSpringActuator& mCSA) const
+{
+  const tgBulletCompressionSpring* const pCompressionSpring =
+    mCSA.getCompressionSpring();
+  if (pCompressionSpring == NULL)
+  {
+    return;
+  }
+
+  // The same colors as tgBulletRenderer
+  const double force = pCompressionSpring->getSpringForce();
+  const btVector3 color =
+    pCompressionSpring->isFreeEndAttached() ?
+    ((force < 0.0) ? btVector3(1.0, 0.0, 0.0) : btVector3(0.0, 1.0, 0.0)) :
+    ((force <= 0.0) ? btVector3(0.0, 0.0, 1.0) : btVector3(0.0, 1.0, 0.0));
+
+  const std::vector<const tgSpringCableAnchor*>& anchors =
+    pCompressionSpring->getAnchors();
+  for (std::size_t i = 0; i + 1 < anchors.size(); i++)
+  {
+    addLine(m_batch, anchors[i]->getWorldPosition(),
+            pCompressionSpring->getSpringEndpoint(), color);
+  }
+}
+
+void tgBatchedRenderer::render(const tgRod& rod) const
+{
+  // The rigids of a compound share a body, whose shape has them all
+  const btRigidBody* const pBody =
+    const_cast<tgRod&>(rod).getPRigidBody();
+  if (pBody != NULL && m_bodies.insert(pBody).second)
+  {
+    addCylinders(pBody->getCollisionShape(), pBody->getWorldTransform(),
+                 m_batch);
+  }
+}
+
+bool tgBatchedRenderer::culls(const tgModel& model) const
+{
+  Bounds bounds;
+  const std::map<const tgModel*, Bounds>::const_iterator it =
+    m_fixedBounds.find(&model);
+  if (it != m_fixedBounds.end())
+  {
+    bounds = it->second;
+  }
+  else
+  {
+    bounds = findBounds(model);
+    if (bounds.fixed)
+    {
+      m_fixedBounds[&model] = bounds;
+    }
+  }
+
+  if (bounds.blank)
+  {
+    return true;
+  }
+  if (!m_hasView || bounds.empty)
+  {
+    return false;
+  }
+  // Outside if the corner furthest along the normal is behind any plane
+  for (int i = 0; i < 6; i++)
+  {
+    const btVector4& p = m_planes[i];
+    const btVector3 corner(p.x() > 0.0 ? bounds.max.x() : bounds.min.x(),
+                           p.y() > 0.0 ? bounds.max.y() : bounds.min.y(),
+                           p.z() > 0.0 ? bounds.max.z() : bounds.min.z());
+    if (p.x() * corner.x() + p.y() * corner.y() + p.z() * corner.z() + p.w()
+        < 0.0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+void tgBatchedRenderer::setView(const double modelview[16],
+                                const double projection[16])
+{
+  double clip[16];
+  for (int column = 0; column < 4; column++)
+  {
+    for (int r = 0; r < 4; r++)
+    {
+      double sum = 0.0;
+      for (int k = 0; k < 4; k++)
+      {
+        sum += projection[4 * k + r] * modelview[4 * column + k];
+      }
+      clip[4 * column + r] = sum;
+    }
+  }
+  const btVector4 w = row(clip, 3);
+  for (int i = 0; i < 3; i++)
+  {
+    const btVector4 v = row(clip, i);
+    m_planes[2 * i] = btVector4(w.x() + v.x(), w.y() + v.y(),
+                                w.z() + v.z(), w.w() + v.w());
+    m_planes[2 * i + 1] = btVector4(w.x() - v.x(), w.y() - v.y(),
+                                    w.z() - v.z(), w.w() - v.w());
+  }
+  m_hasView = true;
+}
+
+tgBatchedRenderer::Bounds tgBatchedRenderer::findBounds(const tgModel& model)
+{
+  Bounds bounds;
+  bounds.empty = true;
+  bounds.fixed = true;
+  bool drawn = false;
+
+  std::vector<const tgModel*> models(1, &model);
+  models.insert(models.end(), model.getDescendants().begin(),
+                model.getDescendants().end());
+  for (std::size_t i = 0; i < models.size(); i++)
+  {
+    const tgModel* const pModel = models[i];
+
+    const std::vector<abstractMarker>& markers = pModel->getMarkers();
+    for (std::size_t j = 0; j < markers.size(); j++)
+    {
+      grow(bounds.min, bounds.max, bounds.empty,
+           markers[j].getWorldPosition());
+      bounds.fixed = false;
+      drawn = true;
+    }
+
+    const tgBaseRigid* const pRigid =
+      tgCast::cast<tgModel, tgBaseRigid>(pModel);
+    if (pRigid != NULL)
+    {
+      const btRigidBody* const pBody =
+        const_cast<tgBaseRigid*>(pRigid)->getPRigidBody();
+      if (pBody != NULL)
+      {
+        btVector3 min;
+        btVector3 max;
+        pBody->getAabb(min, max);
+        grow(bounds.min, bounds.max, bounds.empty, min);
+        grow(bounds.min, bounds.max, bounds.empty, max);
+        if (!pBody->isStaticOrKinematicObject())
+        {
+          bounds.fixed = false;
+        }
+      }
+      if (tgCast::cast<tgModel, tgRod>(pModel) != NULL)
+      {
+        drawn = true;
+      }
+    }
+
+    const tgSpringCableActuator* const pActuator =
+      tgCast::cast<tgModel, tgSpringCableActuator>(pModel);
+    if (pActuator != NULL && pActuator->getSpringCable() != NULL)
+    {
+      const std::vector<const tgSpringCableAnchor*> anchors =
+        pActuator->getSpringCable()->getAnchors();
+      for (std::size_t j = 0; j < anchors.size(); j++)
+      {
+        grow(bounds.min, bounds.max, bounds.empty,
+             anchors[j]->getWorldPosition());
+      }
+      bounds.fixed = false;
+      drawn = true;
+    }
+
+    const tgCompressionSpringActuator* const pSpring =
+      tgCast::cast<tgModel, tgCompressionSpringActuator>(pModel);
+    if (pSpring != NULL && pSpring->getCompressionSpring() != NULL)
+    {
+      const tgBulletCompressionSpring* const pCompressionSpring =
+        pSpring->getCompressionSpring();
+      const std::vector<const tgSpringCableAnchor*> anchors =
+        pCompressionSpring->getAnchors();
+      for (std::size_t j = 0; j < anchors.size(); j++)
+      {
+        grow(bounds.min, bounds.max, bounds.empty,
+             anchors[j]->getWorldPosition());
+      }
+      grow(bounds.min, bounds.max, bounds.empty,
+           pCompressionSpring->getSpringEndpoint());
+      bounds.fixed = false;
+      drawn = true;
+    }
+  }
+
+  // Nothing will ever be drawn for a static model without these
+  bounds.blank = bounds.fixed && !drawn;
+  return bounds;
+}
+
+void tgBatchedRenderer::clear()
+{
+  m_batch.clear();
+  m_bodies.clear();
+}
+
+void tgBatchedRenderer::flush(bool drawCylinders)
+{
+  m_batch.draw(drawCylinders);
+  clear();
+}
+
+void tgBatchedRenderer::addCylinders(const btCollisionShape* pShape,
+                                     const btTransform& transform,
+                                     Batch& batch)
+{
+  switch (pShape->getShapeType())
+  {
+  case COMPOUND_SHAPE_PROXYTYPE:
+    {
+      const btCompoundShape* const pCompound =
+        static_cast<const btCompoundShape*>(pShape);
+      for (int i = 0; i < pCompound->getNumChildShapes(); i++)
+      {
+        addCylinders(pCompound->getChildShape(i),
+                     transform * pCompound->getChildTransform(i), batch);
+      }
+    }
+    break;
+  case CYLINDER_SHAPE_PROXYTYPE:
+    {
+      const btCylinderShape* const pCylinder =
+        static_cast<const btCylinderShape*>(pShape);
+      Batch::Cylinder cylinder;
+      cylinder.transform = transform;
+      cylinder.upAxis = pCylinder->getUpAxis();
+      cylinder.radius = pCylinder->getRadius();
+      cylinder.halfHeight =
+        pCylinder->getHalfExtentsWithMargin()[cylinder.upAxis];
+      batch.cylinders.push_back(cylinder);
+    }
+    break;
+  case CAPSULE_SHAPE_PROXYTYPE:
+    {
+      // Drawn as the cylinder of a rod with a capsule proxy
+      const btCapsuleShape* const pCapsule =
+        static_cast<const btCapsuleShape*>(pShape);
+      Batch::Cylinder cylinder;
+      cylinder.transform = transform;
+      cylinder.upAxis = pCapsule->getUpAxis();
+      cylinder.radius = pCapsule->getRadius();
+      cylinder.halfHeight = pCapsule->getHalfHeight() + pCapsule->getRadius();
+      batch.cylinders.push_back(cylinder);
+    }
+    break;
+  default:
+    break;
+  }
+}
@@ -0,0 +1,188 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_BATCHED_RENDERER_H
+#define TG_BATCHED_RENDERER_H
+
+/**
+ * @file tgBatchedRenderer.h
+ * @brief Contains the definition of class tgBatchedRenderer
+ * $Id$
+ */
+
+// This application
+#include "tgBulletRenderer.h"
+// The Bullet Physics library
+#include "LinearMath/btTransform.h"
+// The C++ Standard Library
+#include <map>
+#include <set>
+#include <vector>
+
+// Forward declarations
+class btCollisionShape;
+class btRigidBody;
+
+/**
+ * A tgBulletRenderer that draws in batches. tgBulletRenderer draws each
+ * cable segment with its own debug drawer call, which is a glBegin()
+ * and glEnd() per line. This one only collects during the visit: cable
+ * and spring segments into one vertex and color array, and the cylinders
+ * of the rods' bodies into a list of instances. draw() then makes one
+ * glDrawArrays() call for all the lines and one for all the cylinders,
+ * whose vertices are placed on the CPU from a shared unit cylinder.
+ * Markers are drawn as in tgBulletRenderer.
+ *
+ * It also culls the models given to tgSimulation: those whose bodies,
+ * cables and markers are all outside the view set by setView(), and
+ * static ones, such as obstacles, with no cables, springs, rods or
+ * markers to draw. The bounds of static models are found once and kept
+ * until the renderer is deleted, as it is on every reset.
+ *
+ * The fixed function OpenGL of the demo application has no instanced
+ * draw call, so the instances are expanded into a single array instead.
+ */
+class tgBatchedRenderer : public tgBulletRenderer
+{
+public:
+
+  /** What one visit collected */
+  struct Batch
+  {
+    /** A cylinder placed in the world */
+    struct Cylinder
+    {
+      btTransform transform;
+      float radius;
+      float halfHeight;
+      int upAxis;
+    };
+
+    /** Forget everything collected */
+    void clear();
+
+    /**
+     * Draw the lines, then the cylinders if drawCylinders, with one
+     * glDrawArrays() call each.
+     * @param[in] drawCylinders false when the bodies are drawn otherwise
+     */
+    void draw(bool drawCylinders) const;
+
+    /** x, y, z of both ends of each line */
+    std::vector<float> lineVertices;
+
+    /** r, g, b of both ends of each line */
+    std::vector<float> lineColors;
+
+    std::vector<Cylinder> cylinders;
+
+    /** The cylinders as triangles, filled by draw() */
+    mutable std::vector<float> triangleVertices;
+    mutable std::vector<float> triangleNormals;
+  };
+
+  /**
+   * @param[in,out] world a reference to the tgWorld being rendered
+   */
+  tgBatchedRenderer(const tgWorld& world);
+
+  /** Add the segments of the cable. */
+  virtual void render(const tgSpringCableActuator& mSCA) const;
+
+  /** Add the segment of the spring. */
+  virtual void render(const tgCompressionSpringActuator& compressionSpringActuator) const;
+
+  /** Add the cylinders of the rod's body, once per body. */
+  virtual void render(const tgRod& rod) const;
+
+  /**
+   * @param[in] model a model given to tgSimulation
+   * @return true if the model is out of view or has nothing to draw
+   */
+  virtual bool culls(const tgModel& model) const;
+
+  /**
+   * Cull against a view from now on.
+   * @param[in] modelview the OpenGL modelview matrix, column major
+   * @param[in] projection the OpenGL projection matrix, column major
+   */
+  void setView(const double modelview[16], const double projection[16]);
+
+  /** Cull only the static models with nothing to draw. */
+  void clearView() { m_hasView = false; }
+
+  /** @return what was collected since the last clear() */
+  Batch& getBatch() { return m_batch; }
+
+  /** Forget what was collected */
+  void clear();
+
+  /**
+   * Draw what was collected and forget it.
+   * @param[in] drawCylinders false when the bodies are drawn otherwise,
+   * as by the demo application
+   */
+  void flush(bool drawCylinders);
+
+  /**
+   * Add the cylinders of a shape, compound children included.
+   * @param[in] pShape the shape
+   * @param[in] transform where the shape is
+   * @param[in,out] batch the batch to add to
+   */
+  static void addCylinders(const btCollisionShape* pShape,
+                           const btTransform& transform, Batch& batch);
+
+private:
+
+  /** What culls() needs to know of a model */
+  struct Bounds
+  {
+    btVector3 min;
+    btVector3 max;
+
+    /** Nothing of the model has a position */
+    bool empty;
+
+    /** No body moves and there are no cables or springs */
+    bool fixed;
+
+    /** Nothing for this renderer to draw */
+    bool blank;
+  };
+
+  /** @return the bounds of the model and its descendants */
+  static Bounds findBounds(const tgModel& model);
+
+  /** Written during a visit, which the const render() functions make. */
+  mutable Batch m_batch;
+
+  /** The bodies whose cylinders are in m_batch */
+  mutable std::set<const btRigidBody*> m_bodies;
+
+  /** The bounds of static models, which do not change */
+  mutable std::map<const tgModel*, Bounds> m_fixedBounds;
+
+  /** left, right, bottom, top, near and far, facing inwards */
+  btVector4 m_planes[6];
+
+  /** True if setView() was called after the last clearView() */
+  bool m_hasView;
+};
+
+#endif
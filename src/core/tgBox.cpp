@@ -76,7 +76,7 @@ tgBox::tgBox(btRigidBody* pRigidBody,
 
 tgBox::~tgBox() { }
 
-void tgBox::onVisit(const tgModelVisitor& v) const
+void tgBox::accept(const tgModelVisitor& v) const
 {
     v.render(*this);
     // Do we need to render the base class?
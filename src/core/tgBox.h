@@ -95,7 +95,7 @@ public:
 
     virtual void teardown();
     
-    virtual void onVisit(const tgModelVisitor& v) const;
+    virtual void accept(const tgModelVisitor& v) const;
     
     /**
      * Return the box's length in application-dependent units.
@@ -60,7 +60,7 @@ tgBoxMoreAnchors::~tgBoxMoreAnchors() { }
 
 // If the tgBoxMoreAnchors ever needed to be rendered differently
 // than tgBox, this method allows that to happen. (I think?)
-void tgBoxMoreAnchors::onVisit(const tgModelVisitor& v) const
+void tgBoxMoreAnchors::accept(const tgModelVisitor& v) const
 {
     v.render(*this);
     // Do we need to render the base class?
@@ -63,7 +63,7 @@ public:
 
   // We do need to be able to have a rendering for this specific type
   // of box, though.
-  virtual void onVisit(const tgModelVisitor& v) const;
+  virtual void accept(const tgModelVisitor& v) const;
   
   /**
    * Since m_length is a private variable, it needs to be stored in this class
@@ -0,0 +1,89 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgBulletAnchorPool.cpp
+ * @brief Contains the definitions of members of class tgBulletAnchorPool
+ * $Id$
+ */
+
+// This module
+#include "tgBulletAnchorPool.h"
+// This application
+#include "tgBulletSpringCableAnchor.h"
+// The C++ Standard Library
+#include <cassert>
+#include <new>
+
+tgBulletAnchorPool::tgBulletAnchorPool() :
+    m_live(0)
+{
+}
+
+tgBulletAnchorPool::~tgBulletAnchorPool()
+{
+    assert(m_live == 0);
+    for (std::size_t i = 0; i < m_free.size(); ++i)
+    {
+        ::operator delete(m_free[i]);
+    }
+}
+
+tgBulletSpringCableAnchor* tgBulletAnchorPool::create(btRigidBody* body,
+                                                      const btVector3& pos,
+                                                      const btVector3& cn,
+                                                      bool perm,
+                                                      bool slide,
+                                                      btPersistentManifold* m)
+{
+    void* pStorage = NULL;
+    if (m_free.empty())
+    {
+        pStorage = ::operator new(sizeof(tgBulletSpringCableAnchor));
+    }
+    else
+    {
+        pStorage = m_free.back();
+        m_free.pop_back();
+    }
+    
+    tgBulletSpringCableAnchor* pAnchor = NULL;
+    try
+    {
+        pAnchor = new (pStorage)
+            tgBulletSpringCableAnchor(body, pos, cn, perm, slide, m);
+    }
+    catch (...)
+    {
+        m_free.push_back(pStorage);
+        throw;
+    }
+    ++m_live;
+    return pAnchor;
+}
+
+void tgBulletAnchorPool::destroy(tgBulletSpringCableAnchor* pAnchor)
+{
+    if (pAnchor)
+    {
+        assert(m_live > 0);
+        pAnchor->~tgBulletSpringCableAnchor();
+        m_free.push_back(pAnchor);
+        --m_live;
+    }
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef SRC_CORE_TG_BULLET_ANCHOR_POOL_H
+#define SRC_CORE_TG_BULLET_ANCHOR_POOL_H
+
+/**
+ * @file tgBulletAnchorPool.h
+ * @brief Contains the definition of class tgBulletAnchorPool
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward references
+class btRigidBody;
+class btPersistentManifold;
+class tgBulletSpringCableAnchor;
+
+/**
+ * Recycles the memory of the sliding anchors a tgBulletContactSpringCable
+ * creates and destroys as contacts come and go. Destroyed anchors keep
+ * their storage on a free list, so once a cable has seen its largest
+ * number of contacts its anchors never reach the global allocator.
+ * Each cable owns its own pool, so pools are not shared between threads.
+ */
+class tgBulletAnchorPool
+{
+public:
+    
+    tgBulletAnchorPool();
+    
+    /**
+     * Frees the recycled storage. Every anchor created by this pool must
+     * have been destroyed first.
+     */
+    ~tgBulletAnchorPool();
+    
+    /**
+     * Construct an anchor in recycled storage. Takes the parameters of
+     * the tgBulletSpringCableAnchor constructor.
+     * @return an anchor to be released with destroy(), not delete
+     */
+    tgBulletSpringCableAnchor* create(btRigidBody* body,
+                                      const btVector3& pos,
+                                      const btVector3& cn,
+                                      bool perm,
+                                      bool slide,
+                                      btPersistentManifold* m);
+    
+    /**
+     * Destroy an anchor made by create() and keep its storage.
+     * @param[in] pAnchor, may be NULL
+     */
+    void destroy(tgBulletSpringCableAnchor* pAnchor);
+    
+private:
+    
+    // Not copyable
+    tgBulletAnchorPool(const tgBulletAnchorPool&);
+    tgBulletAnchorPool& operator=(const tgBulletAnchorPool&);
+    
+    /** Storage for one anchor each, not holding a live anchor */
+    std::vector<void*> m_free;
+    
+    /** The number of anchors created and not yet destroyed */
+    std::size_t m_live;
+};
+
+#endif  // SRC_CORE_TG_BULLET_ANCHOR_POOL_H
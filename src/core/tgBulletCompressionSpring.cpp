@@ -28,6 +28,7 @@
 #include "tgBulletCompressionSpring.h"
 #include "tgBulletSpringCableAnchor.h"
 #include "tgCast.h"
+#include "tgLog.h"
 // The BulletPhysics library
 #include "BulletDynamics/Dynamics/btRigidBody.h"
 
@@ -66,17 +67,9 @@ anchor2(anchors.back())
     }
 
     // Debugging
-    #if (0)
-    btVector3 anchor1pos = anchor1->getWorldPosition();
-    btVector3 anchor2pos = anchor2->getWorldPosition();
-    std::cout << "Location of the starting and ending point of the two anchors:" << std::endl;
-    std::cout << "Anchor1: (" << anchor1pos.x() << ", ";
-    std::cout << anchor1pos.y() << ", ";
-    std::cout << anchor1pos.z() << ")" << std::endl;
-    std::cout << "Anchor2: (" << anchor2pos.x() << ", ";
-    std::cout << anchor2pos.y() << ", ";
-    std::cout << anchor2pos.z() << ")" << std::endl;
-    #endif
+    TG_LOG_TRACE(tgLog::eSpring, "Location of the starting and ending point of the two anchors: "
+                 << "Anchor1: " << anchor1->getWorldPosition()
+                 << " Anchor2: " << anchor2->getWorldPosition());
 	
     m_prevLength = m_restLength;
     
@@ -86,9 +79,7 @@ anchor2(anchors.back())
 // Destructor has to the responsibility of destroying the anchors also.
 tgBulletCompressionSpring::~tgBulletCompressionSpring()
 {
-    #if (0)
-    std::cout << "Destroying tgBulletCompressionSpring" << std::endl;
-    #endif
+    TG_LOG_TRACE(tgLog::eSpring, "Destroying tgBulletCompressionSpring");
     
     std::size_t n = m_anchors.size();
     
@@ -124,7 +115,8 @@ void tgBulletCompressionSpring::step(double dt)
 
     // If the spring distance has gone negative, crash the simulator on purpose.
     // TO-DO: find a way to apply a hard stop here instead.
-    if( getCurrentSpringLength() <= 0.0)
+    // The bodies have not moved, so this is still getCurrentSpringLength()
+    if( m_prevLength <= 0.0)
     {
       throw std::runtime_error("Compression spring has negative length, simulation stopping. Increase your stiffness coefficient. TO-DO: implement a 'hard stop' inside the step method of tgBulletCompressionSpring instead of crashing the simulator.");
     }
@@ -221,11 +213,9 @@ const double tgBulletCompressionSpring::getSpringForce() const
     double springForce = - getCoefK() * (getCurrentSpringLength() - getRestLength());
 
     // Debugging
-    #if (0)
-    std::cout << "getCoefK: " << getCoefK() << " getCurrentSpringLength(): "
-	      << getCurrentSpringLength() << " getRestLength: "
-	      << getRestLength() <<std::endl;
-    #endif
+    TG_LOG_TRACE(tgLog::eSpring, "getCoefK: " << getCoefK() << " getCurrentSpringLength(): "
+	         << getCurrentSpringLength() << " getRestLength: "
+	         << getRestLength());
     
     // A negative delta_X should result in a positive force.
     // note that if m_isFreeEndAttached == false, then springForce >= 0 always,
@@ -246,14 +236,38 @@ const double tgBulletCompressionSpring::getSpringForce() const
  */
 void tgBulletCompressionSpring::calculateAndApplyForce(double dt)
 {
-    // Create variables to hold the results of these computations
-    btVector3 force(0.0, 0.0, 0.0);
-    // the following ONLY includes forces due to K, not due to damping.
-    double magnitude = getSpringForce();
+    // Find the anchor positions once; the accessors above would each
+    // find them again
+    const btVector3 dist =
+	  anchor2->getWorldPosition() - anchor1->getWorldPosition();
+    const double anchorDistance = dist.length();
+    // Same as getAnchorDirectionUnitVector()
+    const btVector3 unitVector = - dist / anchorDistance;
+
+    if (m_isFreeEndAttached)
+    {
+        applySpringForce<true>(anchorDistance, unitVector, dt);
+    }
+    else
+    {
+        applySpringForce<false>(anchorDistance, unitVector, dt);
+    }
+}
 
-    // hold these variables so we don't have to call the accessor function twice.
-    const double currLength = getCurrentSpringLength();
-    const btVector3 unitVector = getAnchorDirectionUnitVector();
+template <bool freeEndAttached>
+void tgBulletCompressionSpring::applySpringForce(double anchorDistance,
+                                                 const btVector3& unitVector,
+                                                 double dt)
+{
+    // Same as getCurrentSpringLength() and getSpringForce(), which
+    // ONLY includes forces due to K, not due to damping.
+    const double currLength =
+        springLength<freeEndAttached>(anchorDistance, m_restLength);
+    double magnitude = - m_coefK * (currLength - m_restLength);
+    if (!freeEndAttached)
+    {
+        assert(magnitude >= 0.0);
+    }
 
     // Calculate the damping force for this timestep.
     // Take an approximated derivative to estimate the velocity of the
@@ -265,19 +279,13 @@ void tgBulletCompressionSpring::calculateAndApplyForce(double dt)
     // The damping force for this timestep
     // Like with spring force, a positive velocity should result in a
     // force acting against the movement of the tip of the spring.
-    m_dampingForce = - getCoefD() * m_velocity;
-
-    // Debugging
-    #if (0)
-      std::cout << "Length: " << getCurrentSpringLength() << " rl: " << getRestLength() <<std::endl;
-      std::cout << "SpringForce: " << magnitude << " DampingForce: " << m_dampingForce <<std::endl;
-    #endif
+    m_dampingForce = - m_coefD * m_velocity;
 
     // Add the damping force to the force from the spring.
     magnitude += m_dampingForce;
     
     // Project the force into the direction of the line between the two anchors
-    force = unitVector * magnitude; 
+    const btVector3 force = unitVector * magnitude; 
     
     // Store the calculated length as the previous length
     m_prevLength = currLength;
@@ -292,6 +300,12 @@ void tgBulletCompressionSpring::calculateAndApplyForce(double dt)
     this->anchor2->attachedBody->applyImpulse(-force*dt,point2);
 }
 
+// Both kernels, for calculateAndApplyForce() here and in tgBulletUnidirComprSpr
+template void tgBulletCompressionSpring::applySpringForce<true>(
+    double anchorDistance, const btVector3& unitVector, double dt);
+template void tgBulletCompressionSpring::applySpringForce<false>(
+    double anchorDistance, const btVector3& unitVector, double dt);
+
 // returns the list of (two) anchors for this class.
 const std::vector<const tgSpringCableAnchor*>tgBulletCompressionSpring::getAnchors() const
 {
@@ -204,8 +204,9 @@ protected:
 
     /**
      * Boolean flag controlling the application of either tension forces or not.
+     * Fixed at construction, so it selects the applySpringForce() kernel.
      */
-    bool m_isFreeEndAttached;
+    const bool m_isFreeEndAttached;
 
     /**
      * The stiffness coefficient
@@ -238,6 +239,32 @@ protected:
      * anchor2
      */
     virtual void calculateAndApplyForce(double dt);
+    
+    /**
+     * The spring length for a given distance between the anchors along
+     * the spring: the distance itself, unless the free end is not
+     * attached and the spring is not in compression.
+     */
+    template <bool freeEndAttached>
+    static double springLength(double anchorDistance, double restLength)
+    {
+        return (freeEndAttached || anchorDistance < restLength) ?
+            anchorDistance : restLength;
+    }
+    
+    /**
+     * The force kernel shared with tgBulletUnidirComprSpr, instantiated
+     * once for each value of m_isFreeEndAttached so the force path has
+     * no further branches or virtual calls. Updates the velocity,
+     * damping force and previous length, and applies the impulses.
+     * @param[in] anchorDistance, the distance between the anchors along
+     * the spring
+     * @param[in] unitVector, the direction of a positive force on anchor1
+     * @param[in] dt, must be positive
+     */
+    template <bool freeEndAttached>
+    void applySpringForce(double anchorDistance, const btVector3& unitVector,
+                          double dt);
 
 private: 
     /** Ensures integrity of member variables */
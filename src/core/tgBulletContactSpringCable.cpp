@@ -30,6 +30,8 @@
 // NTRT
 #include "tgcreator/tgUtil.h"
 #include "core/tgBulletSpringCableAnchor.h"
+#include "core/tgLog.h"
+#include "core/tgPerfCounters.h"
 #include "core/tgCast.h"
 #include "core/tgBulletUtil.h"
 #include "core/tgWorld.h"
@@ -48,11 +50,39 @@
 #include "LinearMath/btQuickprof.h"
 
 // The C++ Standard Library
+#include <algorithm>
 #include <iostream>
 #include <cmath>		// abs
 #include <stdexcept>
 
-//#define VERBOSE
+namespace
+{
+    /**
+     * The bend at an anchor, in radians, from which a contact cable uses
+     * its finest resolution
+     */
+    const double wrapAngle = M_PI / 6.0;
+}
+
+/**
+ * Bullet 2.82 cylinders read their implicit dimensions and ignore local
+ * scaling, so segments are resized by setting those, as the constructor
+ * does
+ */
+class tgBulletContactSpringCable::Segment : public btCylinderShape
+{
+public:
+    Segment(const btVector3& halfExtents) :
+    btCylinderShape(halfExtents)
+    {
+    }
+
+    void setHalfExtents(const btVector3& halfExtents)
+    {
+        const btVector3 margin(getMargin(), getMargin(), getMargin());
+        m_implicitShapeDimensions = (halfExtents * m_localScaling) - margin;
+    }
+};
 
 tgBulletContactSpringCable::tgBulletContactSpringCable(btPairCachingGhostObject* ghostObject,
  tgWorld& world,
@@ -61,12 +91,19 @@ tgBulletContactSpringCable::tgBulletContactSpringCable(btPairCachingGhostObject*
  double dampingCoefficient,
  double pretension,
  double thickness,
- double resolution) :
+ double resolution,
+ double coarseResolution,
+ std::size_t maxAnchors,
+ PairReset pairReset) :
 tgBulletSpringCable (anchors, coefK, dampingCoefficient, pretension),
 m_ghostObject(ghostObject),
 m_world(world),
 m_thickness(thickness),
-m_resolution(resolution)
+m_resolution(resolution),
+m_coarseResolution(coarseResolution),
+m_maxAnchors(maxAnchors),
+m_pairReset(pairReset),
+m_inContact(true)
 {
 
 }
@@ -79,10 +116,29 @@ tgBulletContactSpringCable::~tgBulletContactSpringCable()
     btCollisionShape* shape = m_ghostObject->getCollisionShape();
     deleteCollisionShape(shape);
     delete m_ghostObject;
+    for (std::size_t i = 0; i < m_spareSegments.size(); i++)
+    {
+        delete m_spareSegments[i];
+    }
+    
+    // Sliding anchors live in m_anchorPool; tgBulletSpringCable deletes
+    // the permanent ones
+    std::size_t i = 0;
+    while (i < m_anchors.size())
+    {
+        if (!deleteAnchor(i))
+        {
+            i++;
+        }
+    }
 }
 
 const btScalar tgBulletContactSpringCable::getActualLength() const
 {
+    if (hasStoredLength())
+    {
+        return m_length;
+    }
     btScalar length = 0;
     
     std::size_t n = m_anchors.size() - 1;
@@ -96,28 +152,65 @@ const btScalar tgBulletContactSpringCable::getActualLength() const
 
 void tgBulletContactSpringCable::step(double dt)
 {    
-    updateManifolds();
-#if (0) // Typically causes contacts to be lost
-    int numPruned = 1;
-    while (numPruned > 0)
+    const tgPerfCounters::Scope counters("tgBulletContactSpringCable::step");
     {
-        numPruned = updateAnchorPositions();
-    } 
+#ifndef BT_NO_PROFILE 
+        BT_PROFILE("updateManifolds");
+#endif //BT_NO_PROFILE      
+        findContacts();
+    }
+    commitContacts(dt);
+}
+
+void tgBulletContactSpringCable::findContacts()
+{
+    // With nothing overlapping the ghost object and no sliding anchors
+    // the cable is free: there are no contacts to find or anchors to
+    // prune, and it behaves as a plain tgBulletSpringCable. The ghost
+    // object stays in the broadphase so the cable switches back to
+    // contact handling as soon as something overlaps it
+    m_inContact = m_anchors.size() > 2 ||
+        m_ghostObject->getOverlappingPairCache()->getNumOverlappingPairs() > 0;
+    if (m_inContact)
+    {
+        updateManifolds();
+    }
+}
+
+void tgBulletContactSpringCable::commitContacts(double dt)
+{
+    if (m_inContact)
+    {
+#if (0) // Typically causes contacts to be lost
+        int numPruned = 1;
+        while (numPruned > 0)
+        {
+            numPruned = updateAnchorPositions();
+        } 
 #endif
-	updateAnchorList();
-	
-	// Update positions and remove bad anchors
-	pruneAnchors();
+        updateAnchorList();
+        
+        // Update positions and remove bad anchors
+        pruneAnchors();
+    }
 
-#ifdef VERBOSE 
+#if TG_LOG_MAX_LEVEL >= TG_LOG_LEVEL_DEBUG
     if (getActualLength() > m_prevLength + 0.2)
     {
 //         throw std::runtime_error("Large length change!");
-        std::cout << "Previous length " << m_prevLength << " actual length " << getActualLength() << std::endl;
+        TG_LOG_DEBUG(tgLog::eCable, "Previous length " << m_prevLength << " actual length " << getActualLength());
     }
 #endif
     
-	calculateAndApplyForce(dt);
+    if (m_inContact)
+    {
+        calculateAndApplyForce(dt);
+    }
+    else
+    {
+        calculateForce(dt);
+        applyForce();
+    }
 	
 	// Do this last so the ghost object gets populated with collisions before it is deleted
     updateCollisionObject();
@@ -131,8 +224,10 @@ void tgBulletContactSpringCable::calculateAndApplyForce(double dt)
     BT_PROFILE("calculateAndApplyForce");
 #endif //BT_NO_PROFILE    
     
-	const double tension = getTension();
     const double currLength = getActualLength();
+    // The anchors moved since the world stepped; getTension() reuses it
+    storeLength(currLength);
+	const double tension = getTension();
     
     const double deltaStretch = currLength - m_prevLength;
     m_velocity = deltaStretch / dt;
@@ -150,6 +245,19 @@ void tgBulletContactSpringCable::calculateAndApplyForce(double dt)
     // Apply forces
     std::size_t n = m_anchors.size();
     
+    if (!(tension > 0.0))
+    {
+        // Slack: no force on any anchor, and no directions to find until
+        // it tightens; the zero impulses would only wake the bodies
+        for (std::size_t i = 0; i < n; i++)
+        {
+            m_anchors[i]->force = btVector3(0.0, 0.0, 0.0);
+            m_anchors[i]->attachedBody->activate();
+        }
+        m_prevLength = currLength;
+        return;
+    }
+    
     for (std::size_t i = 0; i < n; i++)
     {
         btVector3 force = btVector3 (0.0, 0.0, 0.0);
@@ -211,7 +319,7 @@ void tgBulletContactSpringCable::calculateAndApplyForce(double dt)
     
     if (!totalForce.fuzzyZero())
     {
-        std::cout << "Total Force Error! " << totalForce << std::endl;
+        TG_LOG_ERROR(tgLog::eCable, "Total Force Error! " << totalForce);
         throw std::runtime_error("Total force did not sum to zero!");
     }
     
@@ -222,13 +330,10 @@ void tgBulletContactSpringCable::calculateAndApplyForce(double dt)
 
 void tgBulletContactSpringCable::updateManifolds()
 {
-#ifndef BT_NO_PROFILE 
-    BT_PROFILE("updateManifolds");
-#endif //BT_NO_PROFILE      
+    // Not profiled here, since it may run on a worker thread; see step()
     
     // Copy this vector so we can remove as necessary
     
-	btManifoldArray	m_manifoldArray;
 	btVector3 m_touchingNormal;
 	
 	btBroadphaseInterface* const m_overlappingPairCache = tgBulletUtil::worldToDynamicsWorld(m_world).getBroadphase();
@@ -237,8 +342,15 @@ void tgBulletContactSpringCable::updateManifolds()
 	btBroadphasePairArray& pairArray = m_ghostObject->getOverlappingPairCache()->getOverlappingPairArray();
 	int numPairs = pairArray.size();
     
-    std::vector<tgBulletSpringCableAnchor*> rejectedAnchors;
+    // Updating manifolds does not move the anchors
+    refreshAnchorPositions();
     
+	// Sliding anchors hold manifolds from the last step, which Bullet
+	// may have freed or given to another pair since. Only the manifolds
+	// found here are read from now on.
+	m_bodyManifolds.clear();
+	m_refreshed.assign(m_anchors.size(), false);
+	
 	for (int i = 0; i < numPairs; i++)
 	{
 		m_manifoldArray.clear();
@@ -247,9 +359,14 @@ void tgBulletContactSpringCable::updateManifolds()
 		
 		// The real broadphase's pair cache has the useful info
 		btBroadphasePair* collisionPair = m_overlappingPairCache->getOverlappingPairCache()->findPair(pair.m_pProxy0,pair.m_pProxy1);
+		if (collisionPair == NULL)
+		{
+			continue;
+		}
 
 		btCollisionObject* obj0 = static_cast<btCollisionObject*>(collisionPair->m_pProxy0->m_clientObject);
                 btCollisionObject* obj1 = static_cast<btCollisionObject*>(collisionPair->m_pProxy1->m_clientObject);
+		btCollisionObject* const other = obj0 == m_ghostObject ? obj1 : obj0;
 
 		if (collisionPair->m_algorithm)
 			collisionPair->m_algorithm->getAllContactManifolds(m_manifoldArray);
@@ -257,7 +374,23 @@ void tgBulletContactSpringCable::updateManifolds()
 		for (int j = 0; j < m_manifoldArray.size(); j++)
 		{
 			btPersistentManifold* manifold = m_manifoldArray[j];
-			btScalar directionSign = manifold->getBody0() == m_ghostObject ? btScalar(-1.0) : btScalar(1.0);
+			const bool ghostIsBody0 = manifold->getBody0() == m_ghostObject;
+			btScalar directionSign = ghostIsBody0 ? btScalar(-1.0) : btScalar(1.0);
+			
+			// A manifold left over from another pair has nothing for us
+			const btCollisionObject* const touched =
+				ghostIsBody0 ? manifold->getBody1() : manifold->getBody0();
+			if ((!ghostIsBody0 && manifold->getBody1() != m_ghostObject) ||
+				touched != other)
+			{
+				continue;
+			}
+			
+			btRigidBody* rb = btRigidBody::upcast(other);
+			if (rb)
+			{
+				m_bodyManifolds.push_back(std::make_pair(rb, manifold));
+			}
             
 			for (int p=0; p < manifold->getNumContacts(); p++)
 			{
@@ -271,36 +404,21 @@ void tgBulletContactSpringCable::updateManifolds()
 					m_touchingNormal = pt.m_normalWorldOnB * directionSign;
 					
                     btVector3 pos = directionSign < 0 ? pt.m_positionWorldOnB : pt.m_positionWorldOnA;
-                    
-					btRigidBody* rb = NULL;
 					
 					//std::cout << pos << " " << manifold << " " << manifold->m_index1a << std::endl;
 					
-					if (manifold->getBody0() == m_ghostObject)
-					{
-						if (manifold->getBody1() == obj1)
-							rb = btRigidBody::upcast(obj1);
-						else if (manifold->getBody1() == obj0)
-							rb = btRigidBody::upcast(obj0);
-						else
-						{
-							throw std::runtime_error("Can't find the right object!!");
-						}
-					}
-					else
-					{
-						if (manifold->getBody0() == obj0)
-							rb = btRigidBody::upcast(obj0);
-						else if (manifold->getBody0() == obj1)
-							rb = btRigidBody::upcast(obj1);
-						else
-						{
-							throw std::runtime_error("Can't find the right object!!");
-						}
-					}	
-					
 					if(rb)
 					{  
+						const tgBulletSpringCableAnchor::ContactId id = ghostIsBody0 ?
+							tgBulletSpringCableAnchor::ContactId(rb, pt.m_partId1, pt.m_index1) :
+							tgBulletSpringCableAnchor::ContactId(rb, pt.m_partId0, pt.m_index0);
+						
+						// A contact an anchor already tracks only needs its
+						// manifold, as long as it hasn't slid away
+						if (refreshAnchor(id, pos, manifold))
+						{
+							continue;
+						}
 						
 						int anchorPos = findNearestPastAnchor(pos);
 						assert(anchorPos < (int)(m_anchors.size() - 1));
@@ -309,7 +427,8 @@ void tgBulletContactSpringCable::updateManifolds()
 						if (anchorPos >= 0)
 						{
 							// Not permanent, sliding contact
-							tgBulletSpringCableAnchor* const newAnchor = new tgBulletSpringCableAnchor(rb, pos, m_touchingNormal, false, true, manifold);
+							tgBulletSpringCableAnchor* const newAnchor = m_anchorPool.create(rb, pos, m_touchingNormal, false, true, manifold);
+							newAnchor->setContactId(id);
 						
 							
 							tgBulletSpringCableAnchor* backAnchor = m_anchors[anchorPos];
@@ -330,14 +449,15 @@ void tgBulletContactSpringCable::updateManifolds()
 							//std::cout << "Update Manifolds " << newAnchor->getManifold() << std::endl;
 							
 							bool del = false;	
+							const double resolution = localResolution(anchorPos, anchorPos + 1);
 										
-							if (lengthB <= m_resolution && rb == backAnchor->attachedBody && mDistB < mDistA)
+							if (lengthB <= resolution && rb == backAnchor->attachedBody && mDistB < mDistA)
 							{
 								if(backAnchor->updateManifold(manifold))
 									del = true;
 									//std::cout << "UpdateB " << mDistB << std::endl;
 							}
-							if (lengthA <= m_resolution && rb == forwardAnchor->attachedBody && (!del || mDistA < mDistB))
+							if (lengthA <= resolution && rb == forwardAnchor->attachedBody && (!del || mDistA < mDistB))
 							{
 								if (forwardAnchor->updateManifold(manifold))
 									del = true;
@@ -347,7 +467,7 @@ void tgBulletContactSpringCable::updateManifolds()
 							if (del)
 							{
 								/// @todo further examination of whether the anchors should be deleted here
-								delete newAnchor;
+								m_anchorPool.destroy(newAnchor);
 							}
 							else
 							{
@@ -361,7 +481,57 @@ void tgBulletContactSpringCable::updateManifolds()
 		} // For number of manifolds
 	} // For pairs of objects
 
-	
+	// The other sliding anchors keep their manifold if Bullet still has
+	// it for their body, or take the nearest one it has
+	for (std::size_t i = 0; i < m_anchors.size(); i++)
+	{
+		tgBulletSpringCableAnchor* const anchor = m_anchors[i];
+		if (anchor->permanent || m_refreshed[i])
+		{
+			continue;
+		}
+		
+		btPersistentManifold* nearest = NULL;
+		btScalar nearestDist = INFINITY;
+		for (std::size_t j = 0; j < m_bodyManifolds.size(); j++)
+		{
+			if (m_bodyManifolds[j].first != anchor->attachedBody)
+			{
+				continue;
+			}
+			btPersistentManifold* const m = m_bodyManifolds[j].second;
+			if (m == anchor->getManifold())
+			{
+				nearest = m;
+				break;
+			}
+			const btScalar dist = anchor->getManifoldDistance(m).first;
+			if (nearest == NULL || dist < nearestDist)
+			{
+				nearest = m;
+				nearestDist = dist;
+			}
+		}
+		anchor->refreshManifold(nearest);
+	}
+}
+
+bool tgBulletContactSpringCable::refreshAnchor(const tgBulletSpringCableAnchor::ContactId& id,
+                                               const btVector3& pos,
+                                               btPersistentManifold* manifold)
+{
+	for (std::size_t i = 1; i + 1 < m_anchors.size(); i++)
+	{
+		tgBulletSpringCableAnchor* const anchor = m_anchors[i];
+		if (!anchor->permanent && anchor->getContactId() == id &&
+			(m_anchorPositions[i] - pos).length() <= m_resolution)
+		{
+			anchor->refreshManifold(manifold);
+			m_refreshed[i] = true;
+			return true;
+		}
+	}
+	return false;
 }
 
 void tgBulletContactSpringCable::updateAnchorList()
@@ -371,16 +541,20 @@ void tgBulletContactSpringCable::updateAnchorList()
 #endif //BT_NO_PROFILE    
 	int numContacts = 2;
     
-    btScalar startLength = getActualLength();
+#if TG_LOG_MAX_LEVEL >= TG_LOG_LEVEL_TRACE
+    const btScalar startLength = getActualLength();
+#endif
     
-	while (m_newAnchors.size() > 0)
+	// Keep the vector's storage for the next step
+	for (std::size_t k = 0; k < m_newAnchors.size(); k++)
 	{
 		// Not permanent, sliding contact
-		tgBulletSpringCableAnchor* const newAnchor = m_newAnchors[0];
-		m_newAnchors.erase(m_newAnchors.begin());
+		tgBulletSpringCableAnchor* const newAnchor = m_newAnchors[k];
 		
 		btVector3 pos1 = newAnchor->getWorldPosition();
 
+		// The previous anchor may have been inserted or deleted
+		refreshAnchorPositions();
 		int anchorPos = findNearestPastAnchor(pos1);
 		
 		assert(anchorPos < (int) (m_anchors.size() - 1));
@@ -414,7 +588,8 @@ void tgBulletContactSpringCable::updateAnchorList()
 			//std::cout << "Update anchor list " << newAnchor->getManifold() << std::endl;
 			
 			// These may have changed, so check again				
-			if (lengthB <= m_resolution && newAnchor->attachedBody == backAnchor->attachedBody && mDistB < mDistA)
+			const double resolution = localResolution(anchorPos, anchorPos + 1);
+			if (lengthB <= resolution && newAnchor->attachedBody == backAnchor->attachedBody && mDistB < mDistA)
 			{
 				if(backAnchor->updateManifold(newAnchor->getManifold()))
 				{	
@@ -422,7 +597,7 @@ void tgBulletContactSpringCable::updateAnchorList()
 					//std::cout << "UpdateB " << mDistB << std::endl;
 				}
 			}
-			if (lengthA <= m_resolution && newAnchor->attachedBody == forwardAnchor->attachedBody && (!del || mDistA < mDistB))
+			if (lengthA <= resolution && newAnchor->attachedBody == forwardAnchor->attachedBody && (!del || mDistA < mDistB))
 			{
 				if(forwardAnchor->updateManifold(newAnchor->getManifold()))
 					del = true;
@@ -434,21 +609,24 @@ void tgBulletContactSpringCable::updateAnchorList()
             
 			if (del)
 			{
-				delete newAnchor;
+				m_anchorPool.destroy(newAnchor);
 			}
 			else if(normalValue1 < 0.0 || normalValue2 < 0.0)
 			{
-				delete newAnchor;
+				m_anchorPool.destroy(newAnchor);
 			}
 			else if ((backNormal.dot(contactNormal) < 0.0 && newAnchor->attachedBody == backAnchor->attachedBody) || 
                         (forwardNormal.dot(contactNormal) < 0.0 && newAnchor->attachedBody == forwardAnchor->attachedBody))
             {
-#ifdef VERBOSE 
-                std::cout << "Deleting based on contact normals! " << backNormal.dot(contactNormal);
-                std::cout << " " << forwardNormal.dot(contactNormal) << std::endl;
-#endif
-                delete newAnchor;
+                TG_LOG_DEBUG(tgLog::eCable, "Deleting based on contact normals! " << backNormal.dot(contactNormal)
+                             << " " << forwardNormal.dot(contactNormal));
+                m_anchorPool.destroy(newAnchor);
             }
+			else if (m_maxAnchors > 0 && m_anchors.size() >= m_maxAnchors)
+			{
+				TG_LOG_DEBUG(tgLog::eCable, "Dropping a contact at " << m_maxAnchors << " anchors");
+				m_anchorPool.destroy(newAnchor);
+			}
 			else
 			{		
 				
@@ -459,9 +637,7 @@ void tgBulletContactSpringCable::updateAnchorList()
 #if (1) // Keeps the energy down very well
                 if (getActualLength() > m_prevLength + 2.0 * m_resolution)
                 {
-#ifdef VERBOSE 
-                    std::cout << "Deleting anchor on basis of length " << std::endl;
-#endif
+                    TG_LOG_DEBUG(tgLog::eCable, "Deleting anchor on basis of length");
                     deleteAnchor(anchorPos + 1);
                 }
                 else
@@ -472,17 +648,16 @@ void tgBulletContactSpringCable::updateAnchorList()
                 numContacts++;
 #endif
                 
-#ifdef VERBOSE                
-                std::cout << "Prev: " << m_prevLength << " LengthDiff " << startLength << " " << getActualLength();
-                std::cout << " Anchors " << m_anchors.size() << std::endl;
-#endif
+                TG_LOG_TRACE(tgLog::eCable, "Prev: " << m_prevLength << " LengthDiff " << startLength << " " << getActualLength()
+                             << " Anchors " << m_anchors.size());
 			}
 		}
 		else
 		{
-			delete newAnchor;
+			m_anchorPool.destroy(newAnchor);
 		}
 	}
+	m_newAnchors.clear();
    
     //std::cout << "contacts " << numContacts << " unprunedAnchors " << m_anchors.size();
     
@@ -582,9 +757,7 @@ void tgBulletContactSpringCable::pruneAnchors()
     }
 #endif
 
-#ifdef VERBOSE 
-    std::cout << "Pruned off the bat " << numPruned << std::endl;
-#endif    
+    TG_LOG_TRACE(tgLog::eCable, "Pruned off the bat " << numPruned);
     // Attempt to eliminate points that would cause the string to push
     while (numPruned > 0 || passes <= 3)
     {
@@ -619,7 +792,8 @@ void tgBulletContactSpringCable::pruneAnchors()
                     btVector3 contactNormal = m_anchors[i]->getContactNormal();
                     
                     
-                    if (lineA.length() < m_resolution / 2.0 || lineB.length() < m_resolution / 2.0)
+                    const double resolution = localResolution(i, i);
+                    if (lineA.length() < resolution / 2.0 || lineB.length() < resolution / 2.0)
                     {
                         // Arbitrary value that deletes the nodes
                         normalValue1 = -1.0;
@@ -636,9 +810,7 @@ void tgBulletContactSpringCable::pruneAnchors()
                     }	
                     if ((normalValue1 < 0.0) || (normalValue2 < 0.0))
                     {
-                        #ifdef VERBOSE
-                            std::cout << "Erased normal: " << normalValue1 << " "  << normalValue2 << " "; 
-                        #endif
+                        TG_LOG_DEBUG(tgLog::eCable, "Erased normal: " << normalValue1 << " "  << normalValue2);
                         if (deleteAnchor(i))
                         {
                             numPruned++;
@@ -669,11 +841,11 @@ void tgBulletContactSpringCable::pruneAnchors()
     
     //std::cout << " Good Normal " << m_anchors.size();
 
-#ifdef VERBOSE   
+#if TG_LOG_MAX_LEVEL >= TG_LOG_LEVEL_TRACE
     std::size_t n = m_anchors.size();
     for (i = 0; i < n; i++)
     {      
-        std::cout << m_anchors[i]->getWorldPosition() << std::endl;
+        TG_LOG_TRACE(tgLog::eCable, m_anchors[i]->getWorldPosition());
     }
 #endif
         
@@ -689,63 +861,139 @@ void tgBulletContactSpringCable::updateCollisionObject()
 	btDispatcher* m_dispatcher = tgBulletUtil::worldToDynamicsWorld(m_world).getDispatcher();
 	btBroadphaseInterface* const m_overlappingPairCache = tgBulletUtil::worldToDynamicsWorld(m_world).getBroadphase();
 	
-    // Clear the existing child shapes
-    btCompoundShape* m_compoundShape = tgCast::cast<btCollisionShape, btCompoundShape> (m_ghostObject->getCollisionShape());
-    clearCompoundShape(m_compoundShape);
+    // A cable whose anchors have not moved, such as one between
+    // sleeping bodies, would get an identical shape
+    refreshAnchorPositions();
+    if (m_anchorPositions != m_shapePositions)
+    {
+        // The builder's shape is replaced by segments
+        btCompoundShape* m_compoundShape = tgCast::cast<btCollisionShape, btCompoundShape> (m_ghostObject->getCollisionShape());
+        if (m_compoundShape->getNumChildShapes() != static_cast<int>(m_segments.size()))
+        {
+            clearCompoundShape(m_compoundShape);
+            m_segments.clear();
+        }
     
-    btVector3 maxes(anchor2->getWorldPosition());
-    btVector3 mins(anchor1->getWorldPosition());
+        btVector3 maxes(m_anchorPositions.back());
+        btVector3 mins(m_anchorPositions.front());
     
-    std::size_t n = m_anchors.size();
+        std::size_t n = m_anchors.size();
     
-    for (std::size_t i = 0; i < n; i++)
-    {
-        btVector3 worldPos = m_anchors[i]->getWorldPosition();
-        for (std::size_t j = 0; j < 3; j++)
+        for (std::size_t i = 0; i < n; i++)
         {
-            if (worldPos[j] > maxes[j])
-            {
-                maxes[j] = worldPos[j];
-            }
-            if (worldPos[j] < mins[j])
+            btVector3 worldPos = m_anchorPositions[i];
+            for (std::size_t j = 0; j < 3; j++)
             {
-                mins[j] = worldPos[j];
+                if (worldPos[j] > maxes[j])
+                {
+                    maxes[j] = worldPos[j];
+                }
+                if (worldPos[j] < mins[j])
+                {
+                    mins[j] = worldPos[j];
+                }
             }
         }
-    }
-    btVector3 center = (maxes + mins)/2.0;
+        btVector3 center = (maxes + mins)/2.0;
     
-    btVector3 from = anchor1->getWorldPosition();
-	btVector3 to = anchor2->getWorldPosition();
-	
-    for (std::size_t i = 0; i < n-1; i++)
-    {
-        btVector3 pos1 = m_anchors[i]->getWorldPosition();
-        btVector3 pos2 = m_anchors[i+1]->getWorldPosition();
+        // Keep the segments a shorter cable doesn't need for later
+        const std::size_t nSegments = n - 1;
+        while (m_segments.size() > nSegments)
+        {
+            m_compoundShape->removeChildShapeByIndex(m_segments.size() - 1);
+            m_spareSegments.push_back(m_segments.back());
+            m_segments.pop_back();
+        }
+    
+        for (std::size_t i = 0; i < nSegments; i++)
+        {
+            btVector3 pos1 = m_anchorPositions[i];
+            btVector3 pos2 = m_anchorPositions[i+1];
         
-        // Children handles the orientation data
-        btTransform t = tgUtil::getTransform(pos2, pos1);
-        t.setOrigin(t.getOrigin() - center);
+            // Children handles the orientation data
+            btTransform t = tgUtil::getTransform(pos2, pos1);
+            t.setOrigin(t.getOrigin() - center);
         
-        btScalar length = (pos2 - pos1).length() / 2.0;
+            btScalar length = (pos2 - pos1).length() / 2.0;
 		
-        /// @todo - seriously examine box vs cylinder shapes
-        btCylinderShape* box = new btCylinderShape(btVector3(m_thickness, length, m_thickness));
-        
-        m_compoundShape->addChildShape(t, box);
-    }
-    // Default margin is 0.04, so larger than default thickness. Behavior is better with larger margin
-    //m_compoundShape->setMargin(m_thickness);
+            /// @todo - seriously examine box vs cylinder shapes
+            const btVector3 halfExtents(m_thickness, length, m_thickness);
+            if (i < m_segments.size())
+            {
+                // Refits the segment's leaf of the compound's tree
+                m_segments[i]->setHalfExtents(halfExtents);
+                m_compoundShape->updateChildTransform(i, t, false);
+            }
+            else
+            {
+                Segment* box;
+                if (m_spareSegments.empty())
+                {
+                    box = new Segment(halfExtents);
+                }
+                else
+                {
+                    box = m_spareSegments.back();
+                    m_spareSegments.pop_back();
+                    box->setHalfExtents(halfExtents);
+                }
+                m_compoundShape->addChildShape(t, box);
+                m_segments.push_back(box);
+            }
+        }
+        m_compoundShape->recalculateLocalAabb();
+        // Default margin is 0.04, so larger than default thickness. Behavior is better with larger margin
+        //m_compoundShape->setMargin(m_thickness);
     
-    btTransform transform;
-    transform.setOrigin(center);
-    transform.setRotation(btQuaternion::getIdentity());
+        btTransform transform;
+        transform.setOrigin(center);
+        transform.setRotation(btQuaternion::getIdentity());
     
-    m_ghostObject->setCollisionShape (m_compoundShape);
-    m_ghostObject->setWorldTransform(transform);
+        m_ghostObject->setCollisionShape (m_compoundShape);
+        m_ghostObject->setWorldTransform(transform);
+        
+        m_shapePositions = m_anchorPositions;
+    }
 	
 	// Delete the existing contacts in bullet to prevent sticking - may exacerbate problems with rotations
-	m_overlappingPairCache->getOverlappingPairCache()->cleanProxyFromPairs(m_ghostObject->getBroadphaseHandle(),m_dispatcher);
+	// A free cable has no pairs, and cleaning scans every pair in the world
+	if (m_inContact)
+	{
+		switch (m_pairReset)
+		{
+		case eCleanPairs:
+			m_overlappingPairCache->getOverlappingPairCache()->cleanProxyFromPairs(m_ghostObject->getBroadphaseHandle(),m_dispatcher);
+			break;
+		case eClearManifolds:
+			clearManifolds();
+			break;
+		case eKeepPairs:
+			break;
+		}
+	}
+}
+
+void tgBulletContactSpringCable::clearManifolds()
+{
+	btBroadphaseInterface* const m_overlappingPairCache = tgBulletUtil::worldToDynamicsWorld(m_world).getBroadphase();
+	
+	btBroadphasePairArray& pairArray = m_ghostObject->getOverlappingPairCache()->getOverlappingPairArray();
+	const int numPairs = pairArray.size();
+	for (int i = 0; i < numPairs; i++)
+	{
+		const btBroadphasePair& pair = pairArray[i];
+		btBroadphasePair* collisionPair = m_overlappingPairCache->getOverlappingPairCache()->findPair(pair.m_pProxy0,pair.m_pProxy1);
+		if (collisionPair == NULL || collisionPair->m_algorithm == NULL)
+		{
+			continue;
+		}
+		m_manifoldArray.clear();
+		collisionPair->m_algorithm->getAllContactManifolds(m_manifoldArray);
+		for (int j = 0; j < m_manifoldArray.size(); j++)
+		{
+			m_manifoldArray[j]->clearManifold();
+		}
+	}
 }
 
 void tgBulletContactSpringCable::deleteCollisionShape(btCollisionShape* pShape)
@@ -797,7 +1045,7 @@ bool tgBulletContactSpringCable::deleteAnchor(int i)
 	
 	if (m_anchors[i]->permanent != true)
 	{
-		delete m_anchors[i];
+		m_anchorPool.destroy(m_anchors[i]);
 		m_anchors.erase(m_anchors.begin() + i);
 		return true;
 	}
@@ -807,9 +1055,12 @@ bool tgBulletContactSpringCable::deleteAnchor(int i)
 	}
 }
 
-int tgBulletContactSpringCable::findNearestPastAnchor(btVector3& pos)
+int tgBulletContactSpringCable::findNearestPastAnchor(const btVector3& pos) const
 {
 
+	const std::vector<btVector3>& positions = m_anchorPositions;
+	assert(positions.size() == m_anchors.size());
+	
 	std::size_t i = 0;
 	std::size_t n = m_anchors.size() - 1;
 	assert (n >= 1);
@@ -817,13 +1068,13 @@ int tgBulletContactSpringCable::findNearestPastAnchor(btVector3& pos)
 	/// @todo Find a way to make this bidirectional. If its actually closer to anchor2 you may want to integrate backwards
 	/// Also deal with the situation that its between anchors 1 and 2 in distance. How do you consider 3D space??
 	// Start by determining the "correct" position
-	btScalar startDist = (pos - m_anchors[i]->getWorldPosition()).length();
+	btScalar startDist = (pos - positions[i]).length();
 	btScalar dist = startDist;
 	
 	while (dist <= startDist && i < n)
 	{
 		i++;
-		btVector3 anchorPos = m_anchors[i]->getWorldPosition();
+		btVector3 anchorPos = positions[i];
 		dist = (pos - anchorPos).length();
 		if (dist < startDist)
 		{
@@ -849,25 +1100,17 @@ int tgBulletContactSpringCable::findNearestPastAnchor(btVector3& pos)
 	else if (n > 1)
 	{
 		// Know we've got 3 anchors, so we need to compare along the line
-		tgBulletSpringCableAnchor* a0 = m_anchors[i - 1];
-		tgBulletSpringCableAnchor* an = m_anchors[i + 1];
-		
-		tgBulletContactSpringCable::anchorCompare m_acTemp(a0, an);
-		
-		btVector3 current = m_anchors[i]->getWorldPosition();
-		
-		m_acTemp.comparePoints(pos, current) ? i-- : i+=0;
+		const btVector3& back = positions[i - 1];
+		if (comparePoints(back, positions[i + 1], pos, positions[i]))
+		{
+			i--;
+		}
 		
-		assert((m_anchors[i]->getWorldPosition() - pos).length() <= (a0->getWorldPosition() - pos).length()); 
+		assert((positions[i] - pos).length() <= (back - pos).length()); 
 	}
 	
 	// Check to make sure it's actually in this line
-	tgBulletSpringCableAnchor* a0 = m_anchors[i];
-	tgBulletSpringCableAnchor* an = m_anchors[i + 1];
-	
-	btVector3 current = a0->getWorldPosition();
-	tgBulletContactSpringCable::anchorCompare m_acTemp(a0, an);
-	if( m_acTemp.comparePoints(current, pos))
+	if (comparePoints(positions[i], positions[i + 1], positions[i], pos))
 	{
 		// Success! do nothing, move on
 	}
@@ -875,7 +1118,7 @@ int tgBulletContactSpringCable::findNearestPastAnchor(btVector3& pos)
 	{
 		//std::cout << "iterating backwards!" << std::endl;
 		// Start over, iterate from the back, see if its better
-		btScalar endDist = (pos - m_anchors[n]->getWorldPosition()).length();
+		btScalar endDist = (pos - positions[n]).length();
 		btScalar dist2 = endDist;
 		
 		int j = n;
@@ -883,7 +1126,7 @@ int tgBulletContactSpringCable::findNearestPastAnchor(btVector3& pos)
 		while (dist2 <= endDist && j > 0)
 		{
 			j--;
-			btVector3 anchorPos = m_anchors[j]->getWorldPosition();
+			btVector3 anchorPos = positions[j];
 			dist2 = (pos - anchorPos).length();
 			if (dist2 < endDist)
 			{
@@ -903,26 +1146,18 @@ int tgBulletContactSpringCable::findNearestPastAnchor(btVector3& pos)
 		else if (n > 1)
 		{
 			// Know we've got 3 anchors, so we need to compare along the line
-			tgBulletSpringCableAnchor* a0 = m_anchors[j - 1];
-			tgBulletSpringCableAnchor* an = m_anchors[j + 1];
-			
-			tgBulletContactSpringCable::anchorCompare m_acTemp(a0, an);
-			
-			btVector3 current = m_anchors[j]->getWorldPosition();
-			
-			m_acTemp.comparePoints(pos, current) ? j-- : j+=0;
+			if (comparePoints(positions[j - 1], positions[j + 1],
+			                  pos, positions[j]))
+			{
+				j--;
+			}
 			
 			// This assert doesn't work due to iteration order. Is there a comparable assert?
-			//assert((m_anchors[j]->getWorldPosition() - pos).length() <= (a0->getWorldPosition() - pos).length());
+			//assert((positions[j] - pos).length() <= (a0->getWorldPosition() - pos).length());
 		}
 		
 		// Check to make sure it's actually in this line
-		tgBulletSpringCableAnchor* a0 = m_anchors[j];
-		tgBulletSpringCableAnchor* an = m_anchors[j + 1];
-		
-		btVector3 current = a0->getWorldPosition();
-		tgBulletContactSpringCable::anchorCompare m_acTemp(a0, an);
-		if( m_acTemp.comparePoints(current, pos))
+		if (comparePoints(positions[j], positions[j + 1], positions[j], pos))
 		{
 			// Success! Set i to j and return
 			i = j;
@@ -931,9 +1166,7 @@ int tgBulletContactSpringCable::findNearestPastAnchor(btVector3& pos)
 		{
 			if ( i !=j )
 			{
-#ifdef VERBOSE 
-				std::cout << "Error in iteration order First try: " << i << " Second Try: " << j << std::endl;
-#endif
+				TG_LOG_DEBUG(tgLog::eCable, "Error in iteration order First try: " << i << " Second Try: " << j);
 				//throw std::runtime_error("Neither the front nor back iterations worked!");
 			}
 			
@@ -942,39 +1175,62 @@ int tgBulletContactSpringCable::findNearestPastAnchor(btVector3& pos)
 		}
 	}
 	
-	tgBulletSpringCableAnchor* prevAnchor = m_anchors[i];
-	assert (prevAnchor);
+	assert (m_anchors[i]);
 	 
 	return i; 
 
 }
 
-tgBulletContactSpringCable::anchorCompare::anchorCompare(const tgBulletSpringCableAnchor* m1, const tgBulletSpringCableAnchor* m2) :
-ma1(m1),
-ma2(m2)
+bool tgBulletContactSpringCable::comparePoints(const btVector3& pt1,
+                                               const btVector3& ptN,
+                                               const btVector3& pt2,
+                                               const btVector3& pt3)
 {
+	const btScalar lhDot = (ptN - pt1).dot(pt2);
+	const btScalar rhDot = (ptN - pt1).dot(pt3);
 	
+	return lhDot < rhDot;
 }
 
-bool tgBulletContactSpringCable::anchorCompare::operator() (const tgBulletSpringCableAnchor* lhs, const tgBulletSpringCableAnchor* rhs) const
+double tgBulletContactSpringCable::localResolution(std::size_t first, std::size_t last) const
 {
-	btVector3 pt2 = lhs->getWorldPosition();
-	btVector3 pt3 = rhs->getWorldPosition();
+	assert(first <= last && last < m_anchors.size());
+	const std::size_t n = m_anchors.size();
+	
+	// The load counts sliding anchors toward the bound
+	double coarseness = 0.0;
+	if (m_maxAnchors > 2)
+	{
+		coarseness = std::min(1.0, (n - 2) / (double) (m_maxAnchors - 2));
+	}
 	
-	return comparePoints(pt2, pt3);
-}  
+	double bend = 0.0;
+	for (std::size_t i = std::max<std::size_t>(first, 1); i <= last && i + 1 < n; i++)
+	{
+		const btVector3 current = m_anchors[i]->getWorldPosition();
+		const btVector3 back = current - m_anchors[i - 1]->getWorldPosition();
+		const btVector3 forward = m_anchors[i + 1]->getWorldPosition() - current;
+		const btScalar lengths = back.length() * forward.length();
+		// Coincident anchors are about to be merged; they don't bend
+		if (lengths > 0.0)
+		{
+			const btScalar cosine = back.dot(forward) / lengths;
+			bend = std::max(bend, (double) btAcos(std::max(btScalar(-1.0), std::min(btScalar(1.0), cosine))));
+		}
+	}
+	coarseness = std::max(coarseness, 1.0 - std::min(1.0, bend / wrapAngle));
+	
+	return m_resolution + (m_coarseResolution - m_resolution) * coarseness;
+}
 
-bool tgBulletContactSpringCable::anchorCompare::comparePoints(btVector3& pt2, btVector3& pt3) const
+void tgBulletContactSpringCable::refreshAnchorPositions()
 {
-	// @todo make sure these are good anchors. Assert?
-	   btVector3 pt1 = ma1->getWorldPosition();
-	   btVector3 ptN = ma2->getWorldPosition();
-	   
-	   btScalar lhDot = (ptN - pt1).dot(pt2);
-	   btScalar rhDot = (ptN - pt1).dot(pt3);
-	   
-	   return lhDot < rhDot;
-
+	const std::size_t n = m_anchors.size();
+	m_anchorPositions.resize(n);
+	for (std::size_t i = 0; i < n; i++)
+	{
+		m_anchorPositions[i] = m_anchors[i]->getWorldPosition();
+	}
 }
 
 bool tgBulletContactSpringCable::invariant(void) const
@@ -988,6 +1244,8 @@ bool tgBulletContactSpringCable::invariant(void) const
     m_anchors.size() >= 2 &&
     m_thickness >= 0.0 &&
     m_resolution > 0 &&
+    m_coarseResolution >= m_resolution &&
+    (m_maxAnchors == 0 || m_maxAnchors >= 2) &&
     m_ghostObject != NULL &&
     m_newAnchors.size() == 0);
 }
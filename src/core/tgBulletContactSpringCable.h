@@ -28,12 +28,16 @@
  */
 
 // NTRT
+#include "core/tgBulletAnchorPool.h"
 #include "core/tgBulletSpringCable.h"
+#include "core/tgBulletSpringCableAnchor.h"
 // The Bullet Physics library
+#include "LinearMath/btAlignedObjectArray.h"
 #include "LinearMath/btScalar.h"
 #include "LinearMath/btVector3.h"
 // The C++ Standard Library
-
+#include <cstddef>
+#include <utility>
 #include <vector>
 
 // Forward references
@@ -43,6 +47,7 @@ class btRigidBody;
 class btCollisionShape;
 class btCompoundShape;
 class btPairCachingGhostObject;
+class btPersistentManifold;
 class btDynamicsWorld;
 
 /**
@@ -61,6 +66,24 @@ class tgBulletContactSpringCable : public tgBulletSpringCable
 {
 public:
 	
+	/**
+	 * What updateCollisionObject() does to the ghost object's contacts
+	 * after changing its shape, so none stick to where it was
+	 */
+	enum PairReset
+	{
+		/**
+		 * Remove its pairs from the broadphase, deleting their
+		 * algorithms and manifolds, to be found again next step. Scans
+		 * every pair in the world
+		 */
+		eCleanPairs,
+		/** Keep the pairs and clear the points of their manifolds */
+		eClearManifolds,
+		/** Keep everything, the narrowphase refreshes the points */
+		eKeepPairs
+	};
+	
 	/**
 	 * The only constructor. Requires a number of parameters typically
 	 * provided by the builder tools, in this case tgMultiPointStringInfo
@@ -78,7 +101,15 @@ public:
 	 * (based on stiffness) such that rest length > 0;
 	 * @param[in] thickness, the radius of the cylinder used for the btCollisionObject
 	 * @param[in] resolution, the spatial resultion used to prune new contacts. 
-	 * also affects runtime (lower corresponds to longer runtime)
+	 * also affects runtime (lower corresponds to longer runtime). This is
+	 * the resolution around wrap points
+	 * @param[in] coarseResolution, the resolution of straight spans, and of
+	 * the whole cable as it nears maxAnchors. Must be at least resolution;
+	 * equal to it gives a fixed resolution
+	 * @param[in] maxAnchors, the most anchors the cable keeps, ends
+	 * included; contacts beyond it are dropped. 0 for no bound
+	 * @param[in] pairReset, what to do to the contacts after the shape
+	 * changes
 	 */
     tgBulletContactSpringCable(btPairCachingGhostObject* ghostObject,
 				tgWorld& world,
@@ -87,7 +118,10 @@ public:
 				double dampingCoefficient,
 				double pretension = 0.0,
 				double thickness = 0.001,
-				double resolution = 0.1);
+				double resolution = 0.1,
+				double coarseResolution = 0.4,
+				std::size_t maxAnchors = 64,
+				PairReset pairReset = eCleanPairs);
     /**
      * The destructor. Removes the ghost object from the world,
      * deletes its collision shape, and then deletes the object.
@@ -107,37 +141,56 @@ public:
     */
     virtual void step(double dt);
     
+    /**
+     * The first part of step(): decides whether the cable is in contact
+     * and, if so, runs updateManifolds(). This reads the world's pair
+     * cache and manifolds and writes only this cable and its sliding
+     * anchors. Ghost objects never pair with each other, so the cables of
+     * a world can find their contacts at the same time, as
+     * tgContactCableSolver does, as long as nothing steps the world or
+     * commits a cable meanwhile.
+     */
+    void findContacts();
+    
+    /**
+     * The rest of step(), after findContacts(): updates and prunes the
+     * anchors, applies the force and updates the collision object. This
+     * changes the ghost object's pairs and the bodies' velocities, so
+     * cables are committed one at a time.
+     * @param[in] dt the step size, must be positive
+     */
+    void commitContacts(double dt);
+    
     /**
      * @return a btScalar of the string's actual length - the sum of the
      * lengths between the anchors.
      */
     virtual const btScalar getActualLength() const;
     
+    /**
+     * @return false if the last step found the cable free: only its two
+     * fixed anchors and nothing overlapping the ghost object. A free
+     * cable skips contact handling and computes its force as a plain
+     * tgBulletSpringCable
+     */
+    bool isInContact() const { return m_inContact; }
+    
 private:
     
     /**
-     * Function object to compare the spatial position of two anchors,
-     * given two other anchors of interest. Used to place new anchors
+     * Sees which of the points pt2 and pt3 is further along the line
+     * from pt1 to ptN. Used to place new anchors
+     * @return true if pt3 is further along than pt2
      */
-    struct anchorCompare
-    {
-        anchorCompare(const tgBulletSpringCableAnchor* m1, const tgBulletSpringCableAnchor* m2);
-        
-        /**
-         * Calls comparePoints on anchors lhs and rhs
-         */
-        bool operator() (const tgBulletSpringCableAnchor* lhs, const tgBulletSpringCableAnchor* rhs) const;
-		
-		/**
-		 * Sees which of the points is further along the line between ma1
-		 * and ma2
-		 */
-        bool comparePoints(btVector3& pt2, btVector3& pt3) const;
-        
-        private:
-           const tgBulletSpringCableAnchor* const ma1;
-           const tgBulletSpringCableAnchor* const ma2;
-    };
+    static bool comparePoints(const btVector3& pt1, const btVector3& ptN,
+                              const btVector3& pt2, const btVector3& pt3);
+    
+    /**
+     * Copy the world positions of m_anchors into m_anchorPositions, so
+     * findNearestPastAnchor() does not recompute the anchor transforms
+     * for every contact point
+     */
+    void refreshAnchorPositions();
     
     /**
      * Calculates and applies the forces (calculating permanent anchors
@@ -150,10 +203,22 @@ private:
      * Iterate through the pairs of objects to find the contact positions
      * Contacts are then compared with existing anchors, and either the
      * btPersistantManifold of the anchors is updated, or the point is
-     * stored in m_newAnchors as a new anchor
+     * stored in m_newAnchors as a new anchor. Every sliding anchor ends
+     * up with a manifold Bullet currently holds, or NULL so that
+     * pruneAnchors() deletes it.
      */
     void updateManifolds();
     
+    /**
+     * Give the manifold to the sliding anchor that tracks a contact,
+     * if there is one within m_resolution of where the contact is now.
+     * Reads m_anchorPositions.
+     * @return true if an anchor took it, so no new anchor is needed
+     */
+    bool refreshAnchor(const tgBulletSpringCableAnchor::ContactId& id,
+                       const btVector3& pos,
+                       btPersistentManifold* manifold);
+    
     /**
      * Iterates through the list of new anchors created by updateManifolds
      * and checks whether new anchors are in the same position as
@@ -180,11 +245,15 @@ private:
     
     /**
      * Uses m_anchors to update the collision shape of the m_ghostObject
-     * Also resets the broadphase's pairCache after collision object
-     * is changed.
+     * Also resets the contacts as m_pairReset says after the collision
+     * object is changed. The segments are resized and moved in place,
+     * and the compound's tree refit, while their number holds.
      */
     void updateCollisionObject();
     
+    /** Clear the contact points of every pair of the ghost object */
+    void clearManifolds();
+    
     /**
      * Deletes a collision shape and it's child shapes
      * @param[in] pShape the btCollisionShape to be deleted
@@ -211,12 +280,24 @@ private:
      * the index of the anchor that would immediately proceed it
      * once it is inserted into m_anchors. Used by both updateManifolds()
      * and updateAnchorList()
+     * Reads m_anchorPositions, so call refreshAnchorPositions() after
+     * m_anchors changes.
      * @param[in] the position of the contact or anchor in question
      * @return the index of the relevant anchor
      * @todo Introduce more flexibility to this function for contacts
      * between the two anchors that are not along a line 
      */
-    int findNearestPastAnchor(btVector3& pos);
+    int findNearestPastAnchor(const btVector3& pos) const;
+    
+    /**
+     * The resolution to merge and prune by around the anchors first to
+     * last: m_resolution where the cable bends by wrapAngle or more at
+     * one of them, m_coarseResolution where it runs straight through
+     * all of them or the cable is at m_maxAnchors, and in between
+     * otherwise. Reads the anchors' world positions, not
+     * m_anchorPositions, so it holds while anchors are pruned.
+     */
+    double localResolution(std::size_t first, std::size_t last) const;
     
     /**
      * An iterator over a list of tgBulletSpringCableAnchors. Used to insert new
@@ -230,6 +311,39 @@ private:
      */
     std::vector<tgBulletSpringCableAnchor*> m_newAnchors;
     
+    /** Recycles the sliding anchors, which come and go with contacts */
+    tgBulletAnchorPool m_anchorPool;
+    
+    /** Scratch space for updateManifolds(), kept between steps */
+    btAlignedObjectArray<btPersistentManifold*> m_manifoldArray;
+    
+    /**
+     * The manifolds of this step by the body they touch, filled by
+     * updateManifolds()
+     */
+    std::vector<std::pair<const btRigidBody*, btPersistentManifold*> > m_bodyManifolds;
+    
+    /** Per anchor: whether updateManifolds() found its contact by id */
+    std::vector<bool> m_refreshed;
+    
+    /** The world positions of m_anchors, see refreshAnchorPositions() */
+    std::vector<btVector3> m_anchorPositions;
+    
+    /**
+     * The anchor positions the ghost object's shape was last built
+     * from. updateCollisionObject() keeps the shape while they hold
+     */
+    std::vector<btVector3> m_shapePositions;
+    
+    /** A cylinder that can be resized in place */
+    class Segment;
+    
+    /** The children of the ghost object's shape, first to last */
+    std::vector<Segment*> m_segments;
+    
+    /** Segments taken off the shape, to be used again. We own these */
+    std::vector<Segment*> m_spareSegments;
+    
     /**
      * A reference to the dynamics world so that we can track the
      * contact points in the broadphase's pairCache and remove
@@ -257,8 +371,23 @@ protected:
 	 * Units of length
 	 */
 	const double m_resolution;
+	
+	/**
+	 * The spatial resolution of straight spans, see localResolution()
+	 * Units of length
+	 */
+	const double m_coarseResolution;
+	
+	/** The most anchors kept, 0 for no bound */
+	const std::size_t m_maxAnchors;
+	
+	/** What to do to the contacts after the shape changes */
+	const PairReset m_pairReset;
 
-private:    
+private:
+    /** Whether the last step used contact handling, see isInContact() */
+    bool m_inContact;
+    
     bool invariant() const;
 };
 
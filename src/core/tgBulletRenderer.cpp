@@ -29,6 +29,7 @@
 #include "abstractMarker.h"
 #include "tgSpringCable.h"
 #include "tgBulletCompressionSpring.h"
+#include "tgCordeCable.h"
 #include "tgSpringCableAnchor.h"
 #include "tgBulletUtil.h"
 #include "tgSpringCableActuator.h"
@@ -73,7 +74,26 @@ void tgBulletRenderer::render(const tgSpringCableActuator& mSCA) const
     
     const tgSpringCable* const pSpringCable = mSCA.getSpringCable();
     
-    if(pDrawer && pSpringCable)
+    const tgCordeCable* const pCorde =
+        tgCast::cast<tgSpringCable, tgCordeCable>(pSpringCable);
+    if (pDrawer && pCorde)
+    {
+        // Along the chain of point masses
+        const double stretch =
+            mSCA.getCurrentLength() - mSCA.getRestLength();
+        const btVector3 color =
+            (stretch < 0.0) ?
+            btVector3(0.0, 0.0, 1.0) :
+            btVector3(0.5 + stretch / 3.0,
+                      0.5 - stretch / 2.0,
+                      0.0);
+        for (std::size_t i = 0; i + 1 < pCorde->getResolution(); i++)
+        {
+            pDrawer->drawLine(pCorde->getPoint(i), pCorde->getPoint(i + 1),
+                              color);
+        }
+    }
+    else if(pDrawer && pSpringCable)
     {
 		const std::vector<const tgSpringCableAnchor*>& anchors = pSpringCable->getAnchors();
 		std::size_t n = anchors.size() - 1;
@@ -25,8 +25,11 @@
 // This module
 #include "tgBulletSpringCable.h"
 #include "tgBulletSpringCableAnchor.h"
+#include "tgCableConstraint.h"
 #include "tgCast.h"
+#include "tgLog.h"
 // The BulletPhysics library
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
 #include "BulletDynamics/Dynamics/btRigidBody.h"
 
 #include <iostream>
@@ -40,7 +43,21 @@ tgSpringCable(tgCast::filter<tgBulletSpringCableAnchor, tgSpringCableAnchor>(anc
                 coefK, dampingCoefficient, pretension),
 m_anchors(anchors),
 anchor1(anchors.front()),
-anchor2(anchors.back())
+anchor2(anchors.back()),
+m_impulse(0.0, 0.0, 0.0),
+m_point1(0.0, 0.0, 0.0),
+m_point2(0.0, 0.0, 0.0),
+m_length(0.0),
+m_substeps(1),
+m_sleepTension(0.0),
+m_sleepVelocity(0.0),
+m_quiescent(false),
+m_slack(false),
+m_pConstraint(NULL),
+m_pConstraintWorld(NULL),
+m_constraintDt(0.0),
+m_pStepStamp(NULL),
+m_lengthStamp(0)
 {
     assert(m_anchors.size() >= 2);
     assert(invariant());
@@ -50,10 +67,14 @@ anchor2(anchors.back())
 
 tgBulletSpringCable::~tgBulletSpringCable()
 {
-    #if (0)
-    std::cout << "Destroying tgBulletSpringCable" << std::endl;
-    #endif
+    TG_LOG_TRACE(tgLog::eCable, "Destroying tgBulletSpringCable");
     
+    if (m_pConstraint != NULL)
+    {
+        m_pConstraintWorld->removeConstraint(m_pConstraint);
+        delete m_pConstraint;
+    }
+
     std::size_t n = m_anchors.size();
     
     // Make absolutely sure these are deleted, in case we have a poorly timed reset
@@ -88,15 +109,44 @@ void tgBulletSpringCable::step(double dt)
 }
 
 void tgBulletSpringCable::calculateAndApplyForce(double dt)
+{
+    calculateForce(dt);
+    applyForce();
+}
+
+void tgBulletSpringCable::calculateForce(double dt)
 {
     btVector3 force(0.0, 0.0, 0.0);
     double magnitude = 0.0;
     const btVector3 dist =
       anchor2->getWorldPosition() - anchor1->getWorldPosition();
       
+    if (m_pConstraint != NULL)
+    {
+        // Bullet's solver applies the force
+        const double currLength = dist.length();
+        storeLength(currLength);
+        m_velocity = (currLength - m_prevLength) / dt;
+        m_damping = m_dampingCoefficient * m_velocity;
+        m_prevLength = currLength;
+        m_pConstraint->setSpring(m_coefK, m_dampingCoefficient, m_restLength);
+        m_constraintDt = dt;
+        m_impulse = btVector3(0.0, 0.0, 0.0);
+        m_quiescent = false;
+        m_slack = false;
+        return;
+    }
+    else if (m_substeps > 1)
+    {
+        // May tighten within the step
+        m_slack = false;
+        calculateSubsteppedForce(dist, dt);
+        return;
+    }
+      
     // These computations should occur for history regardless of motion
     const double currLength = dist.length();
-    const btVector3 unitVector = dist / currLength;
+    storeLength(currLength);
     const double stretch = currLength - m_restLength;
     
     magnitude =  m_coefK * stretch;
@@ -114,34 +164,178 @@ void tgBulletSpringCable::calculateAndApplyForce(double dt)
     
     magnitude += m_damping;
     
-    #if (0)
-    std::cout << "Length: " << dist.length() << " rl: " << m_restLength <<std::endl; 
-    #endif
-      
-    if (dist.length() > m_restLength)
-    {   
-        force = unitVector * magnitude; 
+    TG_LOG_TRACE(tgLog::eCable, "Length: " << currLength << " rl: " << m_restLength);
+    
+    // Finished calculating, so can store things
+    m_prevLength = currLength;
+    
+    m_slack = !(currLength > m_restLength);
+    if (m_slack)
+    {
+        // No impulse, and no anchor points to find until it tightens
+        m_impulse = force;
+        m_quiescent = isQuiescent(m_impulse, m_velocity, dt);
+        return;
     }
-    else
+    force = (dist / currLength) * magnitude;
+
+    // Store the impulse and where it acts for applyForce
+    m_impulse = force * dt;
+    m_point1 = this->anchor1->getRelativePosition();
+    m_point2 = this->anchor2->getRelativePosition();
+    m_quiescent = isQuiescent(m_impulse, m_velocity, dt);
+}
+
+void tgBulletSpringCable::calculateSubsteppedForce(const btVector3& dist,
+                                                   double dt)
+{
+    const double currLength = dist.length();
+    storeLength(currLength);
+    const btVector3 unitVector = dist / currLength;
+    m_point1 = this->anchor1->getRelativePosition();
+    m_point2 = this->anchor2->getRelativePosition();
+    
+    const btRigidBody* const body1 = this->anchor1->attachedBody;
+    const btRigidBody* const body2 = this->anchor2->attachedBody;
+    
+    // Inverse mass of the cable's length coordinate, from both bodies'
+    // translation and rotation about their centers of mass
+    const btVector3 arm1 = m_point1.cross(unitVector);
+    const btVector3 arm2 = m_point2.cross(unitVector);
+    const double inverseMass =
+        body1->getInvMass() + body2->getInvMass() +
+        arm1.dot(body1->getInvInertiaTensorWorld() * arm1) +
+        arm2.dot(body2->getInvInertiaTensorWorld() * arm2);
+    
+    // Rate of change of the length, from the anchor point velocities
+    double length = currLength;
+    double velocity = unitVector.dot(body2->getVelocityInLocalPoint(m_point2) -
+                                     body1->getVelocityInLocalPoint(m_point1));
+    
+    // Semi-implicit Euler: update the velocity from the force, then the
+    // length from the new velocity
+    const double h = dt / m_substeps;
+    double impulse = 0.0;
+    for (std::size_t i = 0; i < m_substeps; ++i)
     {
-        // Leave force as the zero vector
+        const double magnitude = m_coefK * (length - m_restLength);
+        m_damping = m_dampingCoefficient * velocity;
+        if (abs(magnitude) < abs(m_damping))
+        {
+            m_damping = (m_damping > 0.0 ? magnitude : -magnitude);
+        }
+        
+        const double tension =
+            length > m_restLength ? magnitude + m_damping : 0.0;
+        impulse += tension * h;
+        velocity -= inverseMass * tension * h;
+        length += velocity * h;
     }
     
-    // Finished calculating, so can store things
+    m_velocity = velocity;
     m_prevLength = currLength;
+    m_impulse = unitVector * impulse;
+    m_quiescent = isQuiescent(m_impulse, m_velocity, dt);
+}
+
+void tgBulletSpringCable::setSleepThresholds(double sleepTension,
+                                             double sleepVelocity)
+{
+    if (sleepTension < 0.0 || sleepVelocity < 0.0)
+    {
+        throw std::invalid_argument("sleep threshold is negative");
+    }
+    m_sleepTension = sleepTension;
+    m_sleepVelocity = sleepVelocity;
+}
+
+void tgBulletSpringCable::setSubsteps(std::size_t substeps)
+{
+    if (substeps == 0)
+    {
+        throw std::invalid_argument("substeps is zero");
+    }
+    else if (substeps > 1 && m_pConstraint != NULL)
+    {
+        throw std::invalid_argument("constraint cables are not sub-stepped");
+    }
+    m_substeps = substeps;
+}
+
+void tgBulletSpringCable::enableConstraint(btDynamicsWorld& dynamicsWorld)
+{
+    if (m_pConstraint != NULL)
+    {
+        return;
+    }
+    else if (anchor1->sliding || anchor2->sliding)
+    {
+        throw std::invalid_argument("constraint cables need fixed anchors");
+    }
+    else if (m_substeps > 1)
+    {
+        throw std::invalid_argument("constraint cables are not sub-stepped");
+    }
+    btRigidBody& body1 = *anchor1->attachedBody;
+    btRigidBody& body2 = *anchor2->attachedBody;
+    m_pConstraint =
+        new tgCableConstraint(body1, body2,
+            body1.getCenterOfMassTransform().inverse() * anchor1->getWorldPosition(),
+            body2.getCenterOfMassTransform().inverse() * anchor2->getWorldPosition(),
+            m_coefK, m_dampingCoefficient, m_restLength);
+    // The bodies still collide with each other
+    dynamicsWorld.addConstraint(m_pConstraint, false);
+    m_pConstraintWorld = &dynamicsWorld;
+}
+
+void tgBulletSpringCable::applyForce()
+{
+    if (m_pConstraint != NULL)
+    {
+        return;
+    }
 
+    btRigidBody* const body1 = this->anchor1->attachedBody;
+    btRigidBody* const body2 = this->anchor2->attachedBody;
+    if (m_slack)
+    {
+        // A zero impulse only wakes the bodies
+        if (!m_quiescent)
+        {
+            body1->activate();
+            body2->activate();
+        }
+        return;
+    }
+    else if (m_quiescent)
+    {
+        // Leave the bodies' deactivation timers alone, and sleeping
+        // bodies asleep
+        if (body1->isActive())
+        {
+            body1->applyImpulse(m_impulse, m_point1);
+        }
+        if (body2->isActive())
+        {
+            body2->applyImpulse(-m_impulse, m_point2);
+        }
+        return;
+    }
+    
     //Now Apply it to the connected two bodies
-    btVector3 point1 = this->anchor1->getRelativePosition();
-    this->anchor1->attachedBody->activate();
-    this->anchor1->attachedBody->applyImpulse(force*dt,point1);
+    body1->activate();
+    body1->applyImpulse(m_impulse, m_point1);
 
-    btVector3 point2 = this->anchor2->getRelativePosition();
-    this->anchor2->attachedBody->activate();
-    this->anchor2->attachedBody->applyImpulse(-force*dt,point2);
+    body2->activate();
+    body2->applyImpulse(-m_impulse, m_point2);
 }
 
 const double tgBulletSpringCable::getActualLength() const
 {
+    if (hasStoredLength())
+    {
+        return m_length;
+    }
     const btVector3 dist =
       this->anchor2->getWorldPosition() - this->anchor1->getWorldPosition();
     return dist.length();
@@ -149,6 +343,10 @@ const double tgBulletSpringCable::getActualLength() const
 
 const double tgBulletSpringCable::getTension() const
 {
+    if (m_pConstraint != NULL)
+    {
+        return m_constraintDt > 0.0 ? m_pConstraint->getTension(m_constraintDt) : 0.0;
+    }
     double tension = (getActualLength() - m_restLength) * m_coefK;
     tension = (tension < 0.0) ? 0.0 : tension;
     return tension;
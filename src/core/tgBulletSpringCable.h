@@ -32,12 +32,17 @@
 #include "LinearMath/btVector3.h"
 // The C++ Standard Library
 
+#include <cmath>
+#include <cstddef>
 #include <vector>
 
 // Forward references
+class btDynamicsWorld;
 class btRigidBody;
 class tgSpringCableAnchor;
 class tgBulletSpringCableAnchor;
+class tgCableBank;
+class tgCableConstraint;
 
 /**
  * This class defines the passive dynamics of a spring-cable system
@@ -47,6 +52,9 @@ class tgBulletSpringCableAnchor;
 class tgBulletSpringCable : public tgSpringCable
 {
 public: 
+    // tgCableBank runs calculateForce() for many cables at once
+    friend class tgCableBank;
+    
     /**
      * The only constructor. Takes a list of anchors, a coefficient
      * of stiffness, a coefficent of damping, and optionally the amount
@@ -92,9 +100,113 @@ public:
      * @todo figure out how to cast and pass by reference
      */
     virtual const std::vector<const tgSpringCableAnchor*> getAnchors() const;
+
+    /** @return the anchors without a copy, with their bodies */
+    const std::vector<tgBulletSpringCableAnchor*>& getBulletAnchors() const
+    {
+        return m_anchors;
+    }
+    
+    /**
+     * First half of calculateAndApplyForce(): updates the velocity,
+     * damping and previous length and stores the impulse for
+     * applyForce(). Only reads the state of the attached bodies, so
+     * different cables may be calculated concurrently.
+     * @param[in] dt, must be positive
+     */
+    void calculateForce(double dt);
+    
+    /**
+     * Second half of calculateAndApplyForce(): applies the impulse
+     * stored by calculateForce() to the bodies of anchor1 and anchor2.
+     * Writes to the bodies, so must not run concurrently with other
+     * cables on the same bodies.
+     */
+    void applyForce();
+    
+    /**
+     * Set the number of sub-steps calculateForce() divides each step
+     * into. With more than one, the cable is integrated semi-implicitly
+     * along its length, treating the two anchors as points with the
+     * effective mass of their bodies, and the summed impulse is applied
+     * once. This keeps stiff cables stable at a larger world timestep.
+     * @param[in] substeps, must be positive. One, the default, keeps the
+     * explicit force
+     */
+    void setSubsteps(std::size_t substeps);
+    
+    /** @return the number of sub-steps per step */
+    std::size_t getSubsteps() const { return m_substeps; }
+    
+    /**
+     * Let the attached bodies sleep while this cable is quiescent: its
+     * force is below sleepTension and the rate of change of its length
+     * is below sleepVelocity. A quiescent cable applies its impulse
+     * without waking or re-activating the bodies, and not at all to a
+     * body that is asleep, so Bullet can deactivate a still structure
+     * as it does any resting island. The next step above a threshold
+     * wakes the bodies again.
+     * @param[in] sleepTension, units of force. Zero, the default, never
+     * sleeps
+     * @param[in] sleepVelocity, units of length / sec
+     */
+    void setSleepThresholds(double sleepTension, double sleepVelocity);
+
+    /**
+     * Leave the force to a tgCableConstraint from now on, solved by
+     * Bullet together with the contacts and joints. calculateForce() then
+     * only passes the rest length, stiffness and damping to the
+     * constraint, applyForce() does nothing, and getTension() is the
+     * constraint's from the last step.
+     * @param[in,out] dynamicsWorld the world of the anchors' bodies; the
+     * constraint is removed from it when the cable is deleted
+     * @throw std::invalid_argument if an anchor slides, or if the
+     * cable is sub-stepped
+     */
+    void enableConstraint(btDynamicsWorld& dynamicsWorld);
+
+    /** @return true if Bullet's solver applies the force */
+    bool hasConstraint() const { return m_pConstraint != NULL; }
+
+    /**
+     * @return true if the last calculateForce() found the cable no longer
+     * than its rest length. Its impulse is then zero and applyForce()
+     * only keeps the bodies awake, as the impulse would have; the length,
+     * velocity and damping are still kept.
+     */
+    bool isSlack() const { return m_slack; }
+
+    /**
+     * Serve getActualLength(), and so getTension(), from the length the
+     * last calculateForce() found, for as long as the world's stamp
+     * shows that the bodies have not moved since. Loggers, sensors,
+     * controllers and renderers reading the cable after it steps then
+     * share one computation. Earlier in the step, before the force is
+     * calculated, the length is computed as usual, and nothing is
+     * cached by the getters, so they stay safe to call concurrently.
+     * @param[in] pStamp tgWorld::getStepStamp() of the anchors' world,
+     * which must outlive the cable, or NULL to always compute
+     */
+    void setStepStamp(const std::size_t* pStamp) { m_pStepStamp = pStamp; }
     
 protected:
     
+    /** Keep a length of the current state, see setStepStamp() */
+    void storeLength(double length)
+    {
+        if (m_pStepStamp != NULL)
+        {
+            m_length = length;
+            m_lengthStamp = *m_pStepStamp + 1;
+        }
+    }
+    
+    /** @return true if m_length is of the current state */
+    bool hasStoredLength() const
+    {
+        return m_pStepStamp != NULL && m_lengthStamp == *m_pStepStamp + 1;
+    }
+    
     /**
      * The list of contact points. tgBulletSpringCable typically has two
      * whereas tgBulletContactSpringCable will have more. 
@@ -115,8 +227,67 @@ protected:
      */
     tgBulletSpringCableAnchor * const anchor2;
     
+    /** The impulse found by calculateForce(), applied at anchor1 */
+    btVector3 m_impulse;
+    
+    /** anchor1's position relative to its body's center of mass */
+    btVector3 m_point1;
+    
+    /** anchor2's position relative to its body's center of mass */
+    btVector3 m_point2;
+    
+    /** The length stored by storeLength() */
+    double m_length;
+    
 private:
     
+    /**
+     * calculateForce() when m_substeps is greater than one.
+     * @param[in] dist, the vector from anchor1 to anchor2
+     */
+    void calculateSubsteppedForce(const btVector3& dist, double dt);
+    
+    /** Sub-steps per step, see setSubsteps() */
+    std::size_t m_substeps;
+    
+    /** See setSleepThresholds() */
+    double m_sleepTension;
+    double m_sleepVelocity;
+    
+    /** Whether the last calculateForce() found the cable quiescent */
+    bool m_quiescent;
+
+    /** See isSlack() */
+    bool m_slack;
+
+    /** See enableConstraint(); owned */
+    tgCableConstraint* m_pConstraint;
+
+    /** The world m_pConstraint is in */
+    btDynamicsWorld* m_pConstraintWorld;
+
+    /** The step of the last calculateForce(), for the constraint's tension */
+    double m_constraintDt;
+
+    /** See setStepStamp(); not owned, may be NULL */
+    const std::size_t* m_pStepStamp;
+
+    /** The stamp of m_length plus one, zero before the first */
+    std::size_t m_lengthStamp;
+    
+    /**
+     * Whether an impulse over dt and a velocity are below the sleep
+     * thresholds.
+     */
+    bool isQuiescent(const btVector3& impulse, double velocity,
+                     double dt) const
+    {
+        const double minimum = m_sleepTension * dt;
+        return impulse.length2() < minimum * minimum &&
+            std::fabs(velocity) < m_sleepVelocity;
+    }
+    
+    
     /**
      * Calculates the current forces that need to be applied to 
      * the rigid bodies, and applies them to the bodies of anchor1 and 
@@ -23,6 +23,7 @@
  */
  
 #include "tgBulletSpringCableAnchor.h"
+#include "tgLog.h"
 
 // The BulletPhysics library
 #include "BulletDynamics/Dynamics/btRigidBody.h"
@@ -39,7 +40,6 @@
 // Do we update the contact based on the manifold? - Causes contacts to be missed, doesn't prevent angular energy from accumulating
 // Contact update also appears to magnify force direction issues
 #define SKIP_CONTACT_UPDATE
-//#define VERBOSE
 
 tgBulletSpringCableAnchor::tgBulletSpringCableAnchor(btRigidBody * body,
                btVector3 worldPos,
@@ -91,7 +91,12 @@ bool tgBulletSpringCableAnchor::setWorldPosition(btVector3& newPos)
 	bool ret = false;
 
 	// Only sliding anchors should have their positions changed
-	if (sliding)
+	if (sliding && manifold == NULL)
+	{
+		TG_LOG_DEBUG(tgLog::eCable, "Contact lost!");
+		// Return as a delete
+	}
+	else if (sliding)
 	{
 		/// @todo - this is very similar to getManifoldDistance. Is there a good way to combine them??
 		// Figure out which body to use
@@ -135,15 +140,12 @@ bool tgBulletSpringCableAnchor::setWorldPosition(btVector3& newPos)
 #endif
 					dist = pt.getDistance();
 					
-#ifdef VERBOSE
 					if (n >= 2)
 					{
-						std::cout << "Extra contacts!! " << p << " " << dist << std::endl;
+						TG_LOG_DEBUG(tgLog::eCable, "Extra contacts!! " << p << " " << dist);
 					}
-#else
-                    // Suppress compiler warning for unused variable
+                    // Unused where debug messages are compiled out
                     (void) dist;
-#endif
 				}
 				
 			}
@@ -162,9 +164,7 @@ bool tgBulletSpringCableAnchor::setWorldPosition(btVector3& newPos)
 					
 					if ((newNormal + contactNormal).length() < 0.5)
 					{
-                        #ifdef VERBOSE
-						std::cout<< "Reversed normal" << std::endl;
-                        #endif
+						TG_LOG_DEBUG(tgLog::eCable, "Reversed normal");
 					}
 					else
 					{
@@ -185,9 +185,7 @@ bool tgBulletSpringCableAnchor::setWorldPosition(btVector3& newPos)
 		}
 		else
         {
-#ifdef VERBOSE
-            std::cout << "Manifold out of date!" << std::endl;
-#endif
+            TG_LOG_DEBUG(tgLog::eCable, "Manifold out of date!");
         }
 		// Else: neither body is attached, delete
 	}
@@ -227,9 +225,7 @@ bool tgBulletSpringCableAnchor::updateManifold(btPersistentManifold* m)
 		if (!manifold)
 		{
 			//manifold = m;
-#ifdef VERBOSE
-            std::cout << "Old manifold was NULL" << std::endl;
-#endif
+            TG_LOG_DEBUG(tgLog::eCable, "Old manifold was NULL");
 			ret = true;
 		}
 		// Use new manifold
@@ -245,9 +241,7 @@ bool tgBulletSpringCableAnchor::updateManifold(btPersistentManifold* m)
 			btVector3 newNormal = manifoldValues.second;
 			if ((newNormal + contactNormal).length() < 0.5)
 			{
-                #ifdef VERBOSE
-				 std::cout <<"Reversed normal during anchor update" << std::endl;
-                #endif
+				 TG_LOG_DEBUG(tgLog::eCable, "Reversed normal during anchor update");
 				 ret = false;
 			}
 			else
@@ -260,12 +254,10 @@ bool tgBulletSpringCableAnchor::updateManifold(btPersistentManifold* m)
 			#endif
 		}
 	}
-#ifdef VERBOSE
 	if (!ret)
     {
-        std::cout << "Failed to update manifold!" << std::endl;
+        TG_LOG_DEBUG(tgLog::eCable, "Failed to update manifold!");
     }
-#endif
 	
 	return ret;
 }
@@ -277,7 +269,7 @@ std::pair<btScalar, btVector3> tgBulletSpringCableAnchor::getManifoldDistance(bt
 	btScalar length = INFINITY;
 	btVector3 newNormal = contactNormal;
 	
-    if (!permanent)
+    if (!permanent && m != NULL)
     {
         if (m->getBody0() != attachedBody)
         {
@@ -316,15 +308,12 @@ std::pair<btScalar, btVector3> tgBulletSpringCableAnchor::getManifoldDistance(bt
                     }
                     
                     dist = pt.getDistance();
-    #ifdef VERBOSE				
                     if (n >= 2)
                     {
-                        std::cout << "Extra contacts!! " << p << " length " << length << " dist: " << dist << std::endl;
+                        TG_LOG_DEBUG(tgLog::eCable, "Extra contacts!! " << p << " length " << length << " dist: " << dist);
                     }
-    #else
-                        // Suppress compiler warning for unused variable
-                        (void) dist;
-    #endif
+                    // Unused where debug messages are compiled out
+                    (void) dist;
                 }
             }
         }
@@ -38,9 +38,11 @@
 #include <utility> //std::pair
 
 // Forward References
+class btCollisionObject;
 class btRigidBody;
 class btPersistentManifold;
 class tgBulletContactSpringCable;
+class tgCableBank;
 
 /**
  * A class that allows tgBulletSpringCable and tgBulletContactSpringCable to attach to btRigidBodies
@@ -55,6 +57,8 @@ class tgBulletSpringCableAnchor : public tgSpringCableAnchor
 public:
 	// tgBulletContactSpringCable needs to scale the forces
    friend class tgBulletContactSpringCable;
+	// tgCableBank copies the body coordinates of fixed anchors
+   friend class tgCableBank;
 	
 	/**
 	 * The only constructor. At a minimum requires a body and a position
@@ -128,6 +132,54 @@ public:
 		return manifold;
 	}
 	
+	/**
+	 * Names a contact across steps, which its manifold pointer can't:
+	 * Bullet frees and reuses manifolds as pairs come and go. A contact
+	 * is the body touched and the shape part and index of the point on
+	 * that body, which for a compound shape is the child touched.
+	 */
+	struct ContactId
+	{
+		ContactId() : body(NULL), part(-1), index(-1) { }
+		
+		ContactId(const btCollisionObject* b, int p, int i) :
+			body(b), part(p), index(i) { }
+		
+		bool operator==(const ContactId& other) const
+		{
+			return body == other.body && part == other.part &&
+				index == other.index;
+		}
+		
+		const btCollisionObject* body;
+		int part;
+		int index;
+	};
+	
+	/** Return the contact this anchor tracks, empty if none was set */
+	const ContactId& getContactId() const
+	{
+		return contactId;
+	}
+	
+	/** Set the contact this anchor tracks, for later steps */
+	void setContactId(const ContactId& id)
+	{
+		contactId = id;
+	}
+	
+	/**
+	 * Accept a manifold without comparing it to the one we have, which
+	 * may no longer exist. tgBulletContactSpringCable calls this every
+	 * step before our manifold is read.
+	 * @param[in] m a manifold Bullet currently holds for attachedBody,
+	 * or NULL if the contact is gone and the anchor should be pruned
+	 */
+	void refreshManifold(btPersistentManifold* m)
+	{
+		manifold = m;
+	}
+	
 	/**
 	 * The rigid body we affect
 	 * Address should never be changed, body is not const
@@ -140,6 +192,7 @@ public:
      * A pair of the distance between the current world position and 
      * this manifolds contact point, as well as the contact normal
      * of this manifold
+     * @param[in] m a manifold, or NULL for an infinite distance
      * @return distance to the contact, contact normal 
      */
     std::pair<btScalar, btVector3> getManifoldDistance(btPersistentManifold* m) const;
@@ -166,6 +219,9 @@ private:
 	 */
 	btPersistentManifold* manifold;
 	
+	/** The contact that manifold was taken from, see refreshManifold */
+	ContactId contactId;
+	
 };
 
 #endif // SRC_CORE_TG_BULLET_SPRING_CABLE_ANCHOR_H_
@@ -28,6 +28,7 @@
 #include "tgBulletUnidirComprSpr.h"
 #include "tgBulletSpringCableAnchor.h"
 #include "tgCast.h"
+#include "tgLog.h"
 // The BulletPhysics library
 #include "BulletDynamics/Dynamics/btRigidBody.h"
 // The C++ standard library
@@ -55,13 +56,9 @@ m_direction(direction)
 
     assert(invariant());
 
-    #if (0)
-    std::cout << "tgBulletUnidirComprSpr constructor, ";
-    std::cout << "direction is: ";
-    std::cout << "(" << m_direction->x() << ",";
-    std::cout << m_direction->y() << ",";
-    std::cout << m_direction->z() << ")" << std::endl;
-    #endif
+    TG_LOG_TRACE(tgLog::eSpring, "tgBulletUnidirComprSpr constructor, direction is: ("
+                 << m_direction->x() << "," << m_direction->y() << ","
+                 << m_direction->z() << ")");
 
     // Check that m_direction is indeed a unit vector.
     // A dot product with (1,1,1) should always return the scalar 1 if
@@ -72,8 +69,8 @@ m_direction(direction)
     // @TODO: Note that this should also check if the length at start is negative:
     // this would indicate that the dotproduct must be negative.
     if( fabs(dotproduct) != 1.0 ){
-      std::cout << "Error: m_direction is not a unit vector. Its dot product" <<
-	" with (1,1,1) is " << dotproduct << std::endl;
+      TG_LOG_ERROR(tgLog::eSpring, "m_direction is not a unit vector. Its dot product"
+                   " with (1,1,1) is " << dotproduct);
       throw std::invalid_argument("Direction must be a unit vector.");
     }
 }
@@ -82,9 +79,7 @@ m_direction(direction)
 // as well as the btVector3 direction.
 tgBulletUnidirComprSpr::~tgBulletUnidirComprSpr()
 {
-    #if (0)
-    std::cout << "Destroying tgBulletUnidirComprSpr..." << std::endl;
-    #endif
+    TG_LOG_TRACE(tgLog::eSpring, "Destroying tgBulletUnidirComprSpr...");
 }
 
 // The step function is what's called from other places in NTRT.
@@ -99,13 +94,13 @@ void tgBulletUnidirComprSpr::step(double dt)
 
     // If the spring distance has gone negative, output a scary warning.
     // TO-DO: find a way to apply a hard stop here instead.
-    if( getCurrentSpringLength() < 0.0)
+    // The bodies have not moved, so this is still getCurrentSpringLength()
+    if( m_prevLength < 0.0)
     {
-      std::cout << "WARNING! UNIDIRECTIONAL COMPRESSION SPRING IS "
-		<< "LESS THAN ZERO LENGTH. YOUR SIMULATION MAY BE INACCURATE FOR "
-		<< "ANY TIMESTEPS WHEN THIS MESSAGE APPEARS. " << std::endl;
-      std::cout << "Current spring length is " << getCurrentSpringLength()
-		<< std::endl << std::endl;
+      TG_LOG_WARN(tgLog::eSpring, "UNIDIRECTIONAL COMPRESSION SPRING IS "
+		  << "LESS THAN ZERO LENGTH. YOUR SIMULATION MAY BE INACCURATE FOR "
+		  << "ANY TIMESTEPS WHEN THIS MESSAGE APPEARS. "
+		  << "Current spring length is " << m_prevLength);
 
       /* If we wanted the simulator to completely quit instead:
       std::cout << "Error, unidirectional compression spring length "
@@ -198,11 +193,9 @@ const double tgBulletUnidirComprSpr::getSpringForce() const
     double springForce = - getCoefK() * (getCurrentSpringLength() - getRestLength());
 
     //DEBUGGING
-    #if (0)
-    std::cout << "getCoefK: " << getCoefK() << " getCurrentSpringLength(): "
-	      << getCurrentSpringLength() << " getRestLength: "
-	      << getRestLength() <<std::endl;
-    #endif
+    TG_LOG_TRACE(tgLog::eSpring, "getCoefK: " << getCoefK() << " getCurrentSpringLength(): "
+	         << getCurrentSpringLength() << " getRestLength: "
+	         << getRestLength());
 
     //DEBUGGING
     if (0) {
@@ -228,14 +221,10 @@ const double tgBulletUnidirComprSpr::getSpringForce() const
  */
 void tgBulletUnidirComprSpr::calculateAndApplyForce(double dt)
 {
-
-    // Create variables to hold the results of these computations
-    btVector3 force(0.0, 0.0, 0.0);
-    // the following ONLY includes forces due to K, not due to damping.
-    double magnitude = getSpringForce();
-
-    // hold this variable so we don't have to call the accessor function twice.
-    const double currLength = getCurrentSpringLength();
+    // Same as getCurrentAnchorDistanceAlongDirection()
+    const btVector3 dist =
+      anchor2->getWorldPosition() - anchor1->getWorldPosition();
+    const double anchorDistance = dist.dot( (*m_direction) );
 
     // Get the unit vector for the direction of the force.
     // This spring applies a force only along m_direction.
@@ -243,48 +232,21 @@ void tgBulletUnidirComprSpr::calculateAndApplyForce(double dt)
     // Direction is a pointer, so must be dereferenced first.
     // TO-DO: justify the "-" here. This works, not sure exactly why, but probably
     //    has to do with choice of which anchor to subtract from the other.
-    const btVector3 unitVector = - (*getDirection());
-
-    // Calculate the damping force for this timestep.
-    // Take an approximated derivative to estimate the velocity of the
-    // tip of the compression spring:
-    const double changeInDeltaX = currLength - m_prevLength;
-    m_velocity = changeInDeltaX / dt;
-
-    // The damping force for this timestep
-    // Like with spring force, a positive velocity should result in a
-    // force acting against the movement of the tip of the spring.
-    m_dampingForce = - getCoefD() * m_velocity;
+    const btVector3 unitVector = - (*m_direction);
 
-    // Debugging
-    #if (0)
-      std::cout << "tgBulletUnidirComprSpr::calculateAndApplyForce  " << std::endl;
-      std::cout << "Length: " << getCurrentSpringLength() << " rl: " << getRestLength() <<std::endl;
-      std::cout << "SpringForce: " << magnitude << " DampingForce: " << m_dampingForce <<std::endl;
-    #endif
-
-    // Add the damping force to the force from the spring.
-    magnitude += m_dampingForce;
-    
-    // Project the force into the direction of the line between the two anchors
-    force = unitVector * magnitude; 
-    
-    // Store the calculated length as the previous length
-    m_prevLength = currLength;
-    
-    //Now Apply it to the connected two bodies.
     //Note that the point of applied force on the second body is NOT the same
     // as the location specified by getSpringEndpoint. The anchor is the point
     // to apply the force, and getSpringEndpoint is only used for rendering
     // purposes: it makes more sense to have the spring free end "floating in space"
     // in the rendering.
-    btVector3 point1 = this->anchor1->getRelativePosition();
-    this->anchor1->attachedBody->activate();
-    this->anchor1->attachedBody->applyImpulse(force*dt,point1);
-    
-    btVector3 point2 = this->anchor2->getRelativePosition();
-    this->anchor2->attachedBody->activate();
-    this->anchor2->attachedBody->applyImpulse(-force*dt,point2);
+    if (m_isFreeEndAttached)
+    {
+        applySpringForce<true>(anchorDistance, unitVector, dt);
+    }
+    else
+    {
+        applySpringForce<false>(anchorDistance, unitVector, dt);
+    }
 }
 
 bool tgBulletUnidirComprSpr::invariant(void) const
@@ -293,9 +255,9 @@ bool tgBulletUnidirComprSpr::invariant(void) const
   // @TODO: find some way of dealing with Bullet's less-than-zero-length between
   // rigid bodies that are colliding.
   if( (m_prevLength < 0) ) {
-    std::cout << "WARNING! UNIDIRECTIONAL COMPRESSION SPRING IS "
-	      << "LESS THAN ZERO LENGTH. YOUR SIMULATION MAY BE INACCURATE FOR "
-	      << "ANY TIMESTEPS WHEN THIS MESSAGE APPEARS. " << std::endl;
+    TG_LOG_WARN(tgLog::eSpring, "UNIDIRECTIONAL COMPRESSION SPRING IS "
+	        << "LESS THAN ZERO LENGTH. YOUR SIMULATION MAY BE INACCURATE FOR "
+	        << "ANY TIMESTEPS WHEN THIS MESSAGE APPEARS.");
   }
   // Used to have m_prevLength >= 0.0 && 
   return (m_coefK > 0.0 &&
@@ -71,20 +71,26 @@ btRigidBody* tgBulletUtil::createRigidBody(btDynamicsWorld* dynamicsWorld,
     body->setWorldTransform(startTransform);
 #endif//
 
-    dynamicsWorld->addRigidBody(body);
+    if (dynamicsWorld != NULL)
+    {
+        dynamicsWorld->addRigidBody(body);
+    }
 
     return body;
 }
 
 btDynamicsWorld& tgBulletUtil::worldToDynamicsWorld(const tgWorld& world)
+{
+  btDynamicsWorld& result = worldToBulletPhysicsImpl(world).dynamicsWorld();
+  return result;
+}
+
+tgWorldBulletPhysicsImpl& tgBulletUtil::worldToBulletPhysicsImpl(const tgWorld& world)
 {
   // Fetch the world's implementation.
   tgWorldImpl& impl = world.implementation();
   // Downcast it for Bullet Physics.
   // Avoid dynamic_cast because it is slow and this is called frequently.
   /// @todo Use typeinfo to verify that this is correct.
-  tgWorldBulletPhysicsImpl& bulletPhysicsImpl =
-    static_cast<tgWorldBulletPhysicsImpl&>(impl);
-  btDynamicsWorld& result = bulletPhysicsImpl.dynamicsWorld();
-  return result;
+  return static_cast<tgWorldBulletPhysicsImpl&>(impl);
 }
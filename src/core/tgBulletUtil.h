@@ -32,6 +32,7 @@ class btDynamicsWorld;
 class btRigidBody;
 class btTransform;
 class tgWorld;
+class tgWorldBulletPhysicsImpl;
 
 /**
  * Utility class for dealing with Bullet Physics
@@ -42,6 +43,7 @@ public:
 
     // @todo: Move this to the tgRigidInfo => tgModel step
     // NOTE: this is a copy of localCreateRigidBody from the bullet DemoApplication. 
+    // The body is added to dynamicsWorld unless that is NULL.
     static btRigidBody* createRigidBody(btDynamicsWorld* dynamicsWorld, 
                                         float mass, 
                                         const btTransform& startTransform, 
@@ -54,6 +56,13 @@ public:
      * @todo consider implications of casting to include Corde objects
      */
     static btDynamicsWorld& worldToDynamicsWorld(const tgWorld& world);
+
+    /**
+     * Assuming that world has a tgWorldBulletPhysicsImpl, return it.
+     * @param[in] world a tgWorld
+     * @return the world's implementation
+     */
+    static tgWorldBulletPhysicsImpl& worldToBulletPhysicsImpl(const tgWorld& world);
 };
 
 
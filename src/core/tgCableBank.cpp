@@ -0,0 +1,571 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgCableBank.cpp
+ * @brief Contains the definitions of members of class tgCableBank
+ * $Id$
+ */
+
+// This module
+#include "tgCableBank.h"
+// This application
+#include "tgBulletSpringCable.h"
+#include "tgBulletSpringCableAnchor.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btTransform.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/*
+ * The arithmetic below mirrors tgBulletSpringCable::calculateForce()
+ * operation for operation, including Bullet's habit of dividing a vector
+ * by multiplying with the reciprocal, so the results are bit for bit the
+ * same as stepping each cable on its own.
+ */
+
+namespace
+{
+    /** Compares indices by their keys */
+    class LowerKey
+    {
+    public:
+        LowerKey(const std::vector<std::size_t>& keys) : m_keys(keys) { }
+
+        bool operator()(std::size_t a, std::size_t b) const
+        {
+            return m_keys[a] < m_keys[b];
+        }
+
+    private:
+        const std::vector<std::size_t>& m_keys;
+    };
+
+    /** Put v[i] at the place of order[i] */
+    template <typename T>
+    void permute(std::vector<T>& v, const std::vector<std::size_t>& order)
+    {
+        std::vector<T> result(v.size());
+        for (std::size_t i = 0; i < order.size(); ++i)
+        {
+            result[i] = v[order[i]];
+        }
+        v.swap(result);
+    }
+}
+
+tgCableBank::tgCableBank() :
+    m_grouped(true)
+{
+}
+
+bool tgCableBank::AnchorKey::operator<(const AnchorKey& other) const
+{
+    if (body != other.body)
+    {
+        return body < other.body;
+    }
+    for (int j = 0; j < 3; ++j)
+    {
+        if (local[j] != other.local[j])
+        {
+            return local[j] < other.local[j];
+        }
+    }
+    return false;
+}
+
+void tgCableBank::add(tgBulletSpringCable& cable)
+{
+    const tgBulletSpringCableAnchor& anchorA = *cable.anchor1;
+    const tgBulletSpringCableAnchor& anchorB = *cable.anchor2;
+    if (anchorA.sliding || anchorB.sliding)
+    {
+        throw std::invalid_argument("tgCableBank needs fixed anchors");
+    }
+    if (cable.m_substeps != 1)
+    {
+        throw std::invalid_argument("tgCableBank does not sub-step cables");
+    }
+    if (cable.m_pConstraint != NULL)
+    {
+        throw std::invalid_argument("tgCableBank leaves constraints to Bullet");
+    }
+
+    m_cables.push_back(&cable);
+    m_added.push_back(&cable);
+    m_bodyA.push_back(bodyIndex(anchorA.attachedBody));
+    m_bodyB.push_back(bodyIndex(anchorB.attachedBody));
+    double localA[3];
+    double localB[3];
+    for (int j = 0; j < 3; ++j)
+    {
+        localA[j] = anchorA.attachedRelativeOriginalPosition[j];
+        localB[j] = anchorB.attachedRelativeOriginalPosition[j];
+    }
+    m_anchorA.push_back(anchorIndex(m_bodyA.back(), localA));
+    m_anchorB.push_back(anchorIndex(m_bodyB.back(), localB));
+
+    // Scratch space, filled by calculate()
+    const std::size_t n = m_cables.size();
+    m_coefK.resize(n);
+    m_coefD.resize(n);
+    m_restLength.resize(n);
+    m_prevLength.resize(n);
+    m_dx.resize(n);
+    m_dy.resize(n);
+    m_dz.resize(n);
+    m_length.resize(n);
+    m_velocity.resize(n);
+    m_damping.resize(n);
+    m_ix.resize(n);
+    m_iy.resize(n);
+    m_iz.resize(n);
+    m_relA.resize(3 * n);
+    m_relB.resize(3 * n);
+}
+
+void tgCableBank::clear()
+{
+    m_cables.clear();
+    m_added.clear();
+    m_bodies.clear();
+    m_bodyIndices.clear();
+    m_transforms.clear();
+    m_bodyA.clear();
+    m_bodyB.clear();
+    m_anchorBody.clear();
+    m_anchorLocal.clear();
+    m_anchorIndices.clear();
+    m_anchorA.clear();
+    m_anchorB.clear();
+    m_grouped = true;
+    m_groupStart.clear();
+    m_slot.clear();
+    m_lx.clear();
+    m_ly.clear();
+    m_lz.clear();
+    m_wx.clear();
+    m_wy.clear();
+    m_wz.clear();
+    m_coefK.clear();
+    m_coefD.clear();
+    m_restLength.clear();
+    m_prevLength.clear();
+    m_dx.clear();
+    m_dy.clear();
+    m_dz.clear();
+    m_length.clear();
+    m_velocity.clear();
+    m_damping.clear();
+    m_ix.clear();
+    m_iy.clear();
+    m_iz.clear();
+    m_relA.clear();
+    m_relB.clear();
+}
+
+std::size_t tgCableBank::bodyIndex(btRigidBody* pBody)
+{
+    assert(pBody != NULL);
+    std::map<btRigidBody*, std::size_t>::const_iterator it =
+        m_bodyIndices.find(pBody);
+    if (it != m_bodyIndices.end())
+    {
+        return it->second;
+    }
+    const std::size_t index = m_bodies.size();
+    m_bodies.push_back(pBody);
+    m_bodyIndices[pBody] = index;
+    m_transforms.resize(12 * m_bodies.size());
+    return index;
+}
+
+std::size_t tgCableBank::anchorIndex(std::size_t body, const double local[3])
+{
+    AnchorKey key;
+    key.body = body;
+    for (int j = 0; j < 3; ++j)
+    {
+        key.local[j] = local[j];
+    }
+    std::map<AnchorKey, std::size_t>::const_iterator it =
+        m_anchorIndices.find(key);
+    if (it != m_anchorIndices.end())
+    {
+        return it->second;
+    }
+    const std::size_t index = m_anchorBody.size();
+    m_anchorBody.push_back(body);
+    m_anchorLocal.insert(m_anchorLocal.end(), local, local + 3);
+    m_anchorIndices[key] = index;
+    m_grouped = false;
+    return index;
+}
+
+void tgCableBank::groupAnchors()
+{
+    // Counting sort of the anchors by body
+    const std::size_t nBodies = m_bodies.size();
+    const std::size_t nAnchors = m_anchorBody.size();
+    m_groupStart.assign(nBodies + 1, 0);
+    for (std::size_t a = 0; a < nAnchors; ++a)
+    {
+        ++m_groupStart[m_anchorBody[a] + 1];
+    }
+    for (std::size_t b = 0; b < nBodies; ++b)
+    {
+        m_groupStart[b + 1] += m_groupStart[b];
+    }
+    std::vector<std::size_t> next(m_groupStart.begin(), m_groupStart.end() - 1);
+    m_slot.resize(nAnchors);
+    m_lx.resize(nAnchors);
+    m_ly.resize(nAnchors);
+    m_lz.resize(nAnchors);
+    for (std::size_t a = 0; a < nAnchors; ++a)
+    {
+        const std::size_t k = next[m_anchorBody[a]]++;
+        m_slot[a] = k;
+        m_lx[k] = m_anchorLocal[3 * a];
+        m_ly[k] = m_anchorLocal[3 * a + 1];
+        m_lz[k] = m_anchorLocal[3 * a + 2];
+    }
+    m_wx.resize(nAnchors);
+    m_wy.resize(nAnchors);
+    m_wz.resize(nAnchors);
+    m_grouped = true;
+}
+
+void tgCableBank::reorder()
+{
+    const std::size_t nBodies = m_bodies.size();
+    const std::size_t nCables = m_cables.size();
+    const std::size_t nAnchors = m_anchorBody.size();
+
+    // The bodies each body shares a cable with
+    std::vector<std::size_t> linkStart(nBodies + 1, 0);
+    for (std::size_t c = 0; c < nCables; ++c)
+    {
+        ++linkStart[m_bodyA[c] + 1];
+        ++linkStart[m_bodyB[c] + 1];
+    }
+    for (std::size_t b = 0; b < nBodies; ++b)
+    {
+        linkStart[b + 1] += linkStart[b];
+    }
+    std::vector<std::size_t> next(linkStart.begin(), linkStart.end() - 1);
+    std::vector<std::size_t> links(2 * nCables);
+    for (std::size_t c = 0; c < nCables; ++c)
+    {
+        links[next[m_bodyA[c]]++] = m_bodyB[c];
+        links[next[m_bodyB[c]]++] = m_bodyA[c];
+    }
+
+    // Breadth first from each body not yet reached, in the old order
+    const std::size_t unvisited = nBodies;
+    std::vector<std::size_t> newIndex(nBodies, unvisited);
+    std::vector<std::size_t> visits;
+    visits.reserve(nBodies);
+    for (std::size_t root = 0; root < nBodies; ++root)
+    {
+        if (newIndex[root] != unvisited)
+        {
+            continue;
+        }
+        newIndex[root] = visits.size();
+        visits.push_back(root);
+        for (std::size_t q = newIndex[root]; q < visits.size(); ++q)
+        {
+            const std::size_t b = visits[q];
+            for (std::size_t k = linkStart[b]; k < linkStart[b + 1]; ++k)
+            {
+                if (newIndex[links[k]] == unvisited)
+                {
+                    newIndex[links[k]] = visits.size();
+                    visits.push_back(links[k]);
+                }
+            }
+        }
+    }
+
+    permute(m_bodies, visits);
+    m_bodyIndices.clear();
+    for (std::size_t b = 0; b < nBodies; ++b)
+    {
+        m_bodyIndices[m_bodies[b]] = b;
+    }
+    for (std::size_t c = 0; c < nCables; ++c)
+    {
+        m_bodyA[c] = newIndex[m_bodyA[c]];
+        m_bodyB[c] = newIndex[m_bodyB[c]];
+    }
+    m_anchorIndices.clear();
+    for (std::size_t a = 0; a < nAnchors; ++a)
+    {
+        m_anchorBody[a] = newIndex[m_anchorBody[a]];
+        AnchorKey key;
+        key.body = m_anchorBody[a];
+        for (int j = 0; j < 3; ++j)
+        {
+            key.local[j] = m_anchorLocal[3 * a + j];
+        }
+        m_anchorIndices[key] = a;
+    }
+
+    groupAnchors();
+
+    // Then the cables read the anchors, and the impulses, almost in turn
+    std::vector<std::size_t> keys(nCables);
+    std::vector<std::size_t> order(nCables);
+    for (std::size_t c = 0; c < nCables; ++c)
+    {
+        keys[c] = std::min(m_slot[m_anchorA[c]], m_slot[m_anchorB[c]]);
+        order[c] = c;
+    }
+    std::stable_sort(order.begin(), order.end(), LowerKey(keys));
+    permute(m_cables, order);
+    permute(m_bodyA, order);
+    permute(m_bodyB, order);
+    permute(m_anchorA, order);
+    permute(m_anchorB, order);
+}
+
+void tgCableBank::gatherBodies()
+{
+    const std::size_t n = m_bodies.size();
+    for (std::size_t b = 0; b < n; ++b)
+    {
+        const btTransform& t = m_bodies[b]->getWorldTransform();
+        double* const out = &m_transforms[12 * b];
+        for (int r = 0; r < 3; ++r)
+        {
+            const btVector3& row = t.getBasis()[r];
+            out[3 * r] = row.x();
+            out[3 * r + 1] = row.y();
+            out[3 * r + 2] = row.z();
+        }
+        out[9] = t.getOrigin().x();
+        out[10] = t.getOrigin().y();
+        out[11] = t.getOrigin().z();
+    }
+
+    // The anchors of each body, with its transform loaded once
+    if (!m_grouped)
+    {
+        reorder();
+    }
+    for (std::size_t b = 0; b < n; ++b)
+    {
+        const double* const t = &m_transforms[12 * b];
+        std::size_t k = m_groupStart[b];
+        const std::size_t end = m_groupStart[b + 1];
+#ifdef __SSE2__
+        if (k + 2 <= end)
+        {
+            __m128d r[9];
+            for (int e = 0; e < 9; ++e)
+            {
+                r[e] = _mm_set1_pd(t[e]);
+            }
+            const __m128d ox = _mm_set1_pd(t[9]);
+            const __m128d oy = _mm_set1_pd(t[10]);
+            const __m128d oz = _mm_set1_pd(t[11]);
+            for (; k + 2 <= end; k += 2)
+            {
+                const __m128d lx = _mm_loadu_pd(&m_lx[k]);
+                const __m128d ly = _mm_loadu_pd(&m_ly[k]);
+                const __m128d lz = _mm_loadu_pd(&m_lz[k]);
+                _mm_storeu_pd(&m_wx[k], _mm_add_pd(_mm_add_pd(_mm_add_pd(
+                    _mm_mul_pd(lx, r[0]), _mm_mul_pd(ly, r[1])),
+                    _mm_mul_pd(lz, r[2])), ox));
+                _mm_storeu_pd(&m_wy[k], _mm_add_pd(_mm_add_pd(_mm_add_pd(
+                    _mm_mul_pd(lx, r[3]), _mm_mul_pd(ly, r[4])),
+                    _mm_mul_pd(lz, r[5])), oy));
+                _mm_storeu_pd(&m_wz[k], _mm_add_pd(_mm_add_pd(_mm_add_pd(
+                    _mm_mul_pd(lx, r[6]), _mm_mul_pd(ly, r[7])),
+                    _mm_mul_pd(lz, r[8])), oz));
+            }
+        }
+#endif // __SSE2__
+        for (; k < end; ++k)
+        {
+            // Same as btTransform * btVector3
+            m_wx[k] = (m_lx[k] * t[0] + m_ly[k] * t[1] + m_lz[k] * t[2]) + t[9];
+            m_wy[k] = (m_lx[k] * t[3] + m_ly[k] * t[4] + m_lz[k] * t[5]) + t[10];
+            m_wz[k] = (m_lx[k] * t[6] + m_ly[k] * t[7] + m_lz[k] * t[8]) + t[11];
+        }
+    }
+}
+
+void tgCableBank::calculate(std::size_t begin, std::size_t end, double dt)
+{
+    // Precondition
+    assert(begin <= end && end <= m_cables.size());
+    if (dt <= 0.0)
+    {
+        throw std::invalid_argument("dt is not positive!");
+    }
+
+    // Gather: anchor positions and the state set by controllers
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        const tgBulletSpringCable& cable = *m_cables[i];
+        m_coefK[i] = cable.m_coefK;
+        m_coefD[i] = cable.m_dampingCoefficient;
+        m_restLength[i] = cable.m_restLength;
+        m_prevLength[i] = cable.m_prevLength;
+
+        const double* const ta = &m_transforms[12 * m_bodyA[i]];
+        const double* const tb = &m_transforms[12 * m_bodyB[i]];
+        const std::size_t ka = m_slot[m_anchorA[i]];
+        const std::size_t kb = m_slot[m_anchorB[i]];
+        const double wa[3] = { m_wx[ka], m_wy[ka], m_wz[ka] };
+        const double wb[3] = { m_wx[kb], m_wy[kb], m_wz[kb] };
+        for (int j = 0; j < 3; ++j)
+        {
+            // The world positions minus the origins
+            m_relA[3 * i + j] = wa[j] - ta[9 + j];
+            m_relB[3 * i + j] = wb[j] - tb[9 + j];
+        }
+        m_dx[i] = wb[0] - wa[0];
+        m_dy[i] = wb[1] - wa[1];
+        m_dz[i] = wb[2] - wa[2];
+    }
+
+    // Compute: two cables at a time where SSE2 is available
+    std::size_t i = begin;
+#ifdef __SSE2__
+    const __m128d vdt = _mm_set1_pd(dt);
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d signMask = _mm_set1_pd(-0.0);
+    for (; i + 2 <= end; i += 2)
+    {
+        const __m128d dx = _mm_loadu_pd(&m_dx[i]);
+        const __m128d dy = _mm_loadu_pd(&m_dy[i]);
+        const __m128d dz = _mm_loadu_pd(&m_dz[i]);
+        const __m128d rest = _mm_loadu_pd(&m_restLength[i]);
+
+        const __m128d length = _mm_sqrt_pd(
+            _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)),
+                       _mm_mul_pd(dz, dz)));
+        const __m128d inverse = _mm_div_pd(one, length);
+
+        __m128d magnitude =
+            _mm_mul_pd(_mm_loadu_pd(&m_coefK[i]), _mm_sub_pd(length, rest));
+        const __m128d velocity = _mm_div_pd(
+            _mm_sub_pd(length, _mm_loadu_pd(&m_prevLength[i])), vdt);
+        __m128d damping = _mm_mul_pd(_mm_loadu_pd(&m_coefD[i]), velocity);
+
+        // Damping may not exceed the spring force
+        const __m128d exceeds = _mm_cmplt_pd(_mm_andnot_pd(signMask, magnitude),
+                                             _mm_andnot_pd(signMask, damping));
+        const __m128d positive = _mm_cmpgt_pd(damping, zero);
+        const __m128d limited =
+            _mm_or_pd(_mm_and_pd(positive, magnitude),
+                      _mm_andnot_pd(positive, _mm_xor_pd(magnitude, signMask)));
+        damping = _mm_or_pd(_mm_and_pd(exceeds, limited),
+                            _mm_andnot_pd(exceeds, damping));
+        magnitude = _mm_add_pd(magnitude, damping);
+
+        // Slack cables push nothing
+        const __m128d taut = _mm_cmpgt_pd(length, rest);
+        _mm_storeu_pd(&m_ix[i], _mm_and_pd(taut, _mm_mul_pd(
+            _mm_mul_pd(_mm_mul_pd(dx, inverse), magnitude), vdt)));
+        _mm_storeu_pd(&m_iy[i], _mm_and_pd(taut, _mm_mul_pd(
+            _mm_mul_pd(_mm_mul_pd(dy, inverse), magnitude), vdt)));
+        _mm_storeu_pd(&m_iz[i], _mm_and_pd(taut, _mm_mul_pd(
+            _mm_mul_pd(_mm_mul_pd(dz, inverse), magnitude), vdt)));
+        _mm_storeu_pd(&m_length[i], length);
+        _mm_storeu_pd(&m_velocity[i], velocity);
+        _mm_storeu_pd(&m_damping[i], damping);
+    }
+#endif // __SSE2__
+    for (; i < end; ++i)
+    {
+        const double length = std::sqrt(m_dx[i] * m_dx[i] +
+                                        m_dy[i] * m_dy[i] +
+                                        m_dz[i] * m_dz[i]);
+        const double inverse = 1.0 / length;
+        double magnitude = m_coefK[i] * (length - m_restLength[i]);
+        const double velocity = (length - m_prevLength[i]) / dt;
+        double damping = m_coefD[i] * velocity;
+        if (std::fabs(magnitude) < std::fabs(damping))
+        {
+            damping = (damping > 0.0 ? magnitude : -magnitude);
+        }
+        magnitude += damping;
+        if (length > m_restLength[i])
+        {
+            m_ix[i] = m_dx[i] * inverse * magnitude * dt;
+            m_iy[i] = m_dy[i] * inverse * magnitude * dt;
+            m_iz[i] = m_dz[i] * inverse * magnitude * dt;
+        }
+        else
+        {
+            m_ix[i] = 0.0;
+            m_iy[i] = 0.0;
+            m_iz[i] = 0.0;
+        }
+        m_length[i] = length;
+        m_velocity[i] = velocity;
+        m_damping[i] = damping;
+    }
+
+    // Scatter: the cables keep their own state
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        tgBulletSpringCable& cable = *m_cables[i];
+        cable.m_velocity = m_velocity[i];
+        cable.m_damping = m_damping[i];
+        cable.m_prevLength = m_length[i];
+        cable.m_slack = !(m_length[i] > m_restLength[i]);
+        if (cable.m_slack)
+        {
+            // applyForce() needs neither the impulse nor the anchors
+            cable.m_impulse = btVector3(0.0, 0.0, 0.0);
+            cable.m_quiescent =
+                cable.isQuiescent(cable.m_impulse, cable.m_velocity, dt);
+            continue;
+        }
+        cable.m_impulse = btVector3(m_ix[i], m_iy[i], m_iz[i]);
+        cable.m_point1 = btVector3(m_relA[3 * i], m_relA[3 * i + 1],
+                                   m_relA[3 * i + 2]);
+        cable.m_point2 = btVector3(m_relB[3 * i], m_relB[3 * i + 1],
+                                   m_relB[3 * i + 2]);
+        cable.m_quiescent =
+            cable.isQuiescent(cable.m_impulse, cable.m_velocity, dt);
+    }
+}
+
+void tgCableBank::apply()
+{
+    const std::size_t n = m_added.size();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        m_added[i]->applyForce();
+    }
+}
@@ -0,0 +1,227 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_CABLE_BANK_H
+#define TG_CABLE_BANK_H
+
+/**
+ * @file tgCableBank.h
+ * @brief Contains the definition of class tgCableBank
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <map>
+#include <vector>
+
+// Forward declarations
+class btRigidBody;
+class tgBulletSpringCable;
+
+/**
+ * Structure-of-arrays storage for the force calculation of many
+ * tgBulletSpringCables. The bank copies each cable's anchor bodies and
+ * anchor body coordinates into contiguous arrays when the cable is added,
+ * keeping one copy of anchors shared by several cables, such as the
+ * cables meeting at a rod end. Each step it gathers the body transforms
+ * once and transforms the anchors body by body (two at a time with SSE2
+ * where available), then
+ * computes every cable's length, velocity, damping and impulse in tight
+ * loops (two cables at a time with SSE2 where available), and writes the
+ * results back to the cables, so the cables' getters, history and
+ * applyForce() behave exactly as after tgBulletSpringCable::calculateForce().
+ * Slack cables are only given their length, velocity and damping, so
+ * applyForce() passes over them.
+ *
+ * The cables remain the owners of their state: stiffness and damping,
+ * rest lengths set by controllers and previous lengths changed by
+ * tgSimulation::restore() are read back from the cables every step. Only cables with fixed anchors
+ * may be added, since the anchor body coordinates are copied once.
+ *
+ * Before the first step after cables are added, the bank lays itself out
+ * for locality, whatever order the cables were built in: the bodies are
+ * numbered breadth first through the cables, so bodies joined by a cable
+ * sit side by side, the anchors are grouped by body, and the cables are
+ * sorted by their first anchor. apply() still goes in the order the
+ * cables were added, so the results do not change.
+ */
+class tgCableBank
+{
+public:
+
+    /** Construct an empty bank. */
+    tgCableBank();
+
+    /**
+     * Add a cable.
+     * @param[in,out] cable a plain tgBulletSpringCable; not owned, and must
+     * outlive the bank or be removed with clear()
+     */
+    void add(tgBulletSpringCable& cable);
+
+    /** Remove every cable. */
+    void clear();
+
+    /** Return the number of cables. */
+    std::size_t size() const
+    {
+        return m_cables.size();
+    }
+
+    /**
+     * Copy the transforms of the bodies the cables are attached to, and
+     * find the world positions of the anchors.
+     * Call once per step before calculate().
+     */
+    void gatherBodies();
+
+    /**
+     * Calculate the cables in [begin, end) and store the results in the
+     * cables. Calls for disjoint ranges may run concurrently.
+     * @param[in] begin the first cable
+     * @param[in] end one past the last cable; at most size()
+     * @param[in] dt the step size; must be positive
+     */
+    void calculate(std::size_t begin, std::size_t end, double dt);
+
+    /**
+     * Apply every cable's impulse to its bodies, in the order the cables
+     * were added.
+     */
+    void apply();
+
+private:
+
+    /** Return the index of a body in m_bodies, adding it if needed. */
+    std::size_t bodyIndex(btRigidBody* pBody);
+
+    /**
+     * Return the index of an anchor in m_anchorBody, adding it if needed.
+     * @param[in] body the index of the anchor's body in m_bodies
+     * @param[in] local the anchor's body coordinates
+     */
+    std::size_t anchorIndex(std::size_t body, const double local[3]);
+
+    /** Lay the anchors out body by body, in m_lx to m_lz. */
+    void groupAnchors();
+
+    /**
+     * Renumber the bodies breadth first through the cables, group the
+     * anchors, and sort the cables by their first anchor in the groups.
+     */
+    void reorder();
+
+    /** An anchor's body and body coordinates */
+    struct AnchorKey
+    {
+        std::size_t body;
+        double local[3];
+
+        bool operator<(const AnchorKey& other) const;
+    };
+
+private:
+
+    /** The cables, in the order reorder() put them. Not owned. */
+    std::vector<tgBulletSpringCable*> m_cables;
+
+    /** The cables, in the order they were added, for apply() */
+    std::vector<tgBulletSpringCable*> m_added;
+
+    /** The bodies the cables are attached to. Not owned. */
+    std::vector<btRigidBody*> m_bodies;
+
+    /** Maps a body to its index in m_bodies. */
+    std::map<btRigidBody*, std::size_t> m_bodyIndices;
+
+    /**
+     * Twelve values per body: the rows of the basis followed by the
+     * origin, as of the last gatherBodies().
+     */
+    std::vector<double> m_transforms;
+
+    /** Per cable: the indices of the bodies of anchor1 and anchor2 */
+    std::vector<std::size_t> m_bodyA;
+    std::vector<std::size_t> m_bodyB;
+
+    /** Per anchor: the index of its body and its body coordinates */
+    std::vector<std::size_t> m_anchorBody;
+    std::vector<double> m_anchorLocal;
+
+    /** Maps an anchor to its index in m_anchorBody. */
+    std::map<AnchorKey, std::size_t> m_anchorIndices;
+
+    /** Per cable: the indices of anchor1 and anchor2 */
+    std::vector<std::size_t> m_anchorA;
+    std::vector<std::size_t> m_anchorB;
+
+    /** True if the grouped arrays below hold every anchor */
+    bool m_grouped;
+
+    /**
+     * Per body, and one past the last: where its anchors start in the
+     * grouped arrays
+     */
+    std::vector<std::size_t> m_groupStart;
+
+    /** Per anchor: its place in the grouped arrays */
+    std::vector<std::size_t> m_slot;
+
+    /** Grouped by body: the anchors' body coordinates */
+    std::vector<double> m_lx;
+    std::vector<double> m_ly;
+    std::vector<double> m_lz;
+
+    /** Grouped by body: the anchors' world positions at gatherBodies() */
+    std::vector<double> m_wx;
+    std::vector<double> m_wy;
+    std::vector<double> m_wz;
+
+    /** Per cable material properties read from the cables each step */
+    std::vector<double> m_coefK;
+    std::vector<double> m_coefD;
+
+    /** Per cable state read from the cables each step */
+    std::vector<double> m_restLength;
+    std::vector<double> m_prevLength;
+
+    /** Per cable vector from anchor1 to anchor2 */
+    std::vector<double> m_dx;
+    std::vector<double> m_dy;
+    std::vector<double> m_dz;
+
+    /** Per cable results */
+    std::vector<double> m_length;
+    std::vector<double> m_velocity;
+    std::vector<double> m_damping;
+
+    /** Per cable impulse applied at anchor1 */
+    std::vector<double> m_ix;
+    std::vector<double> m_iy;
+    std::vector<double> m_iz;
+
+    /**
+     * Per cable: three coordinates each of the anchors relative to
+     * their bodies' centers of mass
+     */
+    std::vector<double> m_relA;
+    std::vector<double> m_relB;
+};
+
+#endif  // TG_CABLE_BANK_H
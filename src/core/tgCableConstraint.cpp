@@ -0,0 +1,128 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgCableConstraint.cpp
+ * @brief Contains the definitions of members of class tgCableConstraint
+ * $Id$
+ */
+
+// This module
+#include "tgCableConstraint.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btTransform.h"
+// The C++ Standard Library
+#include <stdexcept>
+
+tgCableConstraint::tgCableConstraint(btRigidBody& bodyA, btRigidBody& bodyB,
+                                     const btVector3& pivotA,
+                                     const btVector3& pivotB,
+                                     double stiffness, double damping,
+                                     double restLength) :
+    btTypedConstraint(CONTACT_CONSTRAINT_TYPE, bodyA, bodyB),
+    m_pivotA(pivotA),
+    m_pivotB(pivotB),
+    m_stiffness(0.0),
+    m_damping(0.0),
+    m_restLength(0.0)
+{
+    setSpring(stiffness, damping, restLength);
+    // For getTension()
+    enableFeedback(true);
+}
+
+void tgCableConstraint::getInfo1(btConstraintInfo1* info)
+{
+    const btVector3 a = getRigidBodyA().getCenterOfMassTransform() * m_pivotA;
+    const btVector3 b = getRigidBodyB().getCenterOfMassTransform() * m_pivotB;
+    info->m_numConstraintRows =
+        (b - a).length2() > m_restLength * m_restLength ? 1 : 0;
+    info->nub = 0;
+}
+
+void tgCableConstraint::getInfo2(btConstraintInfo2* info)
+{
+    const btRigidBody& bodyA = getRigidBodyA();
+    const btRigidBody& bodyB = getRigidBodyB();
+    const btVector3 rA = bodyA.getCenterOfMassTransform().getBasis() * m_pivotA;
+    const btVector3 rB = bodyB.getCenterOfMassTransform().getBasis() * m_pivotB;
+    const btVector3 dist = (bodyB.getCenterOfMassPosition() + rB) -
+        (bodyA.getCenterOfMassPosition() + rA);
+    const double length = dist.length();
+    const btVector3 n = length > 0.0 ? dist / length : btVector3(1.0, 0.0, 0.0);
+
+    // A positive impulse pulls A towards B and B towards A
+    const btVector3 angularA = rA.cross(n);
+    const btVector3 angularB = rB.cross(n);
+    for (int j = 0; j < 3; j++)
+    {
+        info->m_J1linearAxis[j] = n[j];
+        info->m_J1angularAxis[j] = angularA[j];
+        info->m_J2linearAxis[j] = -n[j];
+        info->m_J2angularAxis[j] = -angularB[j];
+    }
+
+    // The soft constraint of an implicit spring and damper, with ERP and
+    // CFM as ODE defines them
+    const double h = 1.0 / info->fps;
+    const double hk = h * m_stiffness;
+    const double erp = hk / (hk + m_damping);
+    const double cfm = 1.0 / (h * (hk + m_damping));
+    info->m_constraintError[0] = info->fps * erp * (length - m_restLength);
+
+    // Bullet's solver scales the mixing by the row's effective mass
+    const double inverseMass =
+        bodyA.getInvMass() + bodyB.getInvMass() +
+        angularA.dot(bodyA.getInvInertiaTensorWorld() * angularA) +
+        angularB.dot(bodyB.getInvInertiaTensorWorld() * angularB);
+    info->cfm[0] = inverseMass > 0.0 ? cfm / inverseMass : 0.0;
+
+    // A cable only pulls
+    info->m_lowerLimit[0] = 0.0;
+    info->m_upperLimit[0] = SIMD_INFINITY;
+}
+
+void tgCableConstraint::setSpring(double stiffness, double damping,
+                                  double restLength)
+{
+    if (stiffness <= 0.0)
+    {
+        throw std::invalid_argument("stiffness is not positive");
+    }
+    else if (damping < 0.0)
+    {
+        throw std::invalid_argument("damping is negative");
+    }
+    else if (restLength < 0.0)
+    {
+        throw std::invalid_argument("rest length is negative");
+    }
+    m_stiffness = stiffness;
+    m_damping = damping;
+    m_restLength = restLength;
+}
+
+double tgCableConstraint::getTension(double dt) const
+{
+    if (dt <= 0.0)
+    {
+        throw std::invalid_argument("dt is not positive");
+    }
+    return getAppliedImpulse() / dt;
+}
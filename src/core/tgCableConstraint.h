@@ -0,0 +1,107 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_CABLE_CONSTRAINT_H
+#define TG_CABLE_CONSTRAINT_H
+
+/**
+ * @file tgCableConstraint.h
+ * @brief Contains the definition of class tgCableConstraint
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "BulletDynamics/ConstraintSolver/btTypedConstraint.h"
+#include "LinearMath/btVector3.h"
+
+// Forward declarations
+class btRigidBody;
+
+/**
+ * A cable between points on two bodies as a row of Bullet's constraint
+ * solver, instead of an impulse applied before the solve. The row only
+ * pulls, and only while the points are farther apart than the rest
+ * length. It is made soft with the error reduction and constraint force
+ * mixing that give an implicit spring of the stiffness and damping,
+ * so a stiff cable is stable at a timestep where the explicit spring of
+ * tgBulletSpringCable would blow up, and converges together with the
+ * contacts and joints it pulls against.
+ *
+ * Unlike tgBulletSpringCable, the damping is not limited by the spring
+ * force. Serialized and drawn as a contact constraint, which Bullet
+ * does not draw.
+ */
+class tgCableConstraint : public btTypedConstraint
+{
+public:
+
+    /**
+     * @param[in,out] bodyA the body of the first end
+     * @param[in,out] bodyB the body of the second end
+     * @param[in] pivotA the first end, in bodyA's center of mass frame
+     * @param[in] pivotB the second end, in bodyB's center of mass frame
+     * @param[in] stiffness must be positive
+     * @param[in] damping must be non-negative
+     * @param[in] restLength must be non-negative
+     * @throw std::invalid_argument if a parameter is out of range
+     */
+    tgCableConstraint(btRigidBody& bodyA, btRigidBody& bodyB,
+                      const btVector3& pivotA, const btVector3& pivotB,
+                      double stiffness, double damping, double restLength);
+
+    /** One row while the cable is taut, none while it is slack */
+    virtual void getInfo1(btConstraintInfo1* info);
+
+    /** The row along the cable */
+    virtual void getInfo2(btConstraintInfo2* info);
+
+    /** Has no parameters of Bullet's kind */
+    virtual void setParam(int num, btScalar value, int axis = -1) { }
+
+    /** Has no parameters of Bullet's kind */
+    virtual btScalar getParam(int num, int axis = -1) const { return 0; }
+
+    /**
+     * Set the spring of the next solves.
+     * @param[in] stiffness must be positive
+     * @param[in] damping must be non-negative
+     * @param[in] restLength must be non-negative
+     * @throw std::invalid_argument if a parameter is out of range
+     */
+    void setSpring(double stiffness, double damping, double restLength);
+
+    /**
+     * @return the tension of the last solve, from its impulse over dt
+     * @param[in] dt the step size of the last solve; must be positive
+     */
+    double getTension(double dt) const;
+
+private:
+
+    btVector3 m_pivotA;
+
+    btVector3 m_pivotB;
+
+    double m_stiffness;
+
+    double m_damping;
+
+    double m_restLength;
+};
+
+#endif  // TG_CABLE_CONSTRAINT_H
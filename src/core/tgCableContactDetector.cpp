@@ -0,0 +1,463 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgCableContactDetector.cpp
+ * @brief Contains the definitions of members of class tgCableContactDetector
+ * $Id$
+ */
+
+// This module
+#include "tgCableContactDetector.h"
+// This application
+#include "tgBulletSpringCable.h"
+#include "tgBulletSpringCableAnchor.h"
+#include "tgCast.h"
+#include "tgModel.h"
+#include "tgSpringCableActuator.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    /** Cell coordinates are kept to 21 bits each */
+    const int cellLimit = (1 << 20) - 1;
+
+    double clamp01(double x)
+    {
+        return x < 0.0 ? 0.0 : (x > 1.0 ? 1.0 : x);
+    }
+
+    /** @return the cell of a coordinate, within cellLimit */
+    int cellOf(double x, double cellSize)
+    {
+        const double cell = std::floor(x / cellSize);
+        return static_cast<int>(std::max(-double(cellLimit),
+                                         std::min(double(cellLimit), cell)));
+    }
+
+    bool isFinite(const btVector3& v)
+    {
+        return std::abs(v.x()) <= BT_LARGE_FLOAT &&
+            std::abs(v.y()) <= BT_LARGE_FLOAT &&
+            std::abs(v.z()) <= BT_LARGE_FLOAT;
+    }
+}
+
+tgCableContactDetector::Config::Config(double r, double k, double cell) :
+    radius(r),
+    stiffness(k),
+    cellSize(cell)
+{
+    if (radius <= 0.0)
+    {
+        throw std::invalid_argument("Cable radius is not positive");
+    }
+    if (stiffness < 0.0)
+    {
+        throw std::invalid_argument("Cable contact stiffness is negative");
+    }
+    if (cellSize < 0.0)
+    {
+        throw std::invalid_argument("Cell size is negative");
+    }
+}
+
+tgCableContactDetector::tgCableContactDetector(const Config& config) :
+    m_config(config),
+    m_tests(0),
+    m_moved(0)
+{
+}
+
+void tgCableContactDetector::add(tgModel& model)
+{
+    std::vector<tgModel*> models = model.getDescendants();
+    models.push_back(&model);
+    for (std::size_t i = 0; i < models.size(); ++i)
+    {
+        const tgSpringCableActuator* const pActuator =
+            tgCast::cast<tgModel, tgSpringCableActuator>(models[i]);
+        if (pActuator == NULL)
+        {
+            continue;
+        }
+        // Corde cables have no straight segments
+        const tgBulletSpringCable* const pCable =
+            tgCast::cast<tgSpringCable, tgBulletSpringCable>(pActuator->getSpringCable());
+        if (pCable != NULL)
+        {
+            Cable cable;
+            cable.pCable = pCable;
+            m_cables.push_back(cable);
+        }
+    }
+}
+
+void tgCableContactDetector::release()
+{
+    m_cables.clear();
+    m_segments.clear();
+    m_free.clear();
+    m_cells.clear();
+    m_contacts.clear();
+}
+
+void tgCableContactDetector::step(double dt)
+{
+    assert(dt > 0.0);
+    m_tests = 0;
+    m_moved = 0;
+    m_contacts.clear();
+
+    for (std::size_t i = 0; i < m_cables.size(); ++i)
+    {
+        updateSegments(m_cables[i], i);
+    }
+    fitCellSize();
+    if (m_config.cellSize == 0.0)
+    {
+        // No segments yet
+        return;
+    }
+    for (std::size_t i = 0; i < m_cables.size(); ++i)
+    {
+        const std::vector<std::size_t>& segments = m_cables[i].segments;
+        for (std::size_t j = 0; j < segments.size(); ++j)
+        {
+            place(segments[j]);
+        }
+    }
+
+    for (Cells::const_iterator it = m_cells.begin(); it != m_cells.end(); ++it)
+    {
+        const std::vector<std::size_t>& in = it->second;
+        if (in.size() < 2)
+        {
+            continue;
+        }
+        const int cell[3] = {
+            static_cast<int>((it->first >> 42) & 0x1FFFFF) - cellLimit,
+            static_cast<int>((it->first >> 21) & 0x1FFFFF) - cellLimit,
+            static_cast<int>(it->first & 0x1FFFFF) - cellLimit
+        };
+        for (std::size_t i = 0; i < in.size(); ++i)
+        {
+            const Segment& a = m_segments[in[i]];
+            for (std::size_t j = i + 1; j < in.size(); ++j)
+            {
+                const Segment& b = m_segments[in[j]];
+                // Each pair is tested once, in the lowest cell they share
+                if (cell[0] == std::max(a.lo[0], b.lo[0]) &&
+                    cell[1] == std::max(a.lo[1], b.lo[1]) &&
+                    cell[2] == std::max(a.lo[2], b.lo[2]))
+                {
+                    test(in[i], in[j]);
+                }
+            }
+        }
+    }
+
+    if (m_config.stiffness > 0.0)
+    {
+        for (std::size_t i = 0; i < m_contacts.size(); ++i)
+        {
+            push(m_contacts[i], dt);
+        }
+    }
+}
+
+double tgCableContactDetector::closestPoints(const btVector3& p1,
+                                             const btVector3& q1,
+                                             const btVector3& p2,
+                                             const btVector3& q2,
+                                             double& s, double& t)
+{
+    const double epsilon = 1e-12;
+    const btVector3 d1 = q1 - p1;
+    const btVector3 d2 = q2 - p2;
+    const btVector3 r = p1 - p2;
+    const double a = d1.dot(d1);
+    const double e = d2.dot(d2);
+    const double f = d2.dot(r);
+
+    if (a <= epsilon && e <= epsilon)
+    {
+        s = 0.0;
+        t = 0.0;
+    }
+    else if (a <= epsilon)
+    {
+        s = 0.0;
+        t = clamp01(f / e);
+    }
+    else
+    {
+        const double c = d1.dot(r);
+        if (e <= epsilon)
+        {
+            t = 0.0;
+            s = clamp01(-c / a);
+        }
+        else
+        {
+            const double b = d1.dot(d2);
+            const double denominator = a * e - b * b;
+            // Parallel segments take any s, 0 then
+            s = denominator > 0.0 ?
+                clamp01((b * f - c * e) / denominator) : 0.0;
+            t = (b * s + f) / e;
+            if (t < 0.0)
+            {
+                t = 0.0;
+                s = clamp01(-c / a);
+            }
+            else if (t > 1.0)
+            {
+                t = 1.0;
+                s = clamp01((b - c) / a);
+            }
+        }
+    }
+    return ((p1 + d1 * s) - (p2 + d2 * t)).length();
+}
+
+void tgCableContactDetector::fitCellSize()
+{
+    if (m_config.cellSize > 0.0)
+    {
+        return;
+    }
+    double total = 0.0;
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < m_cables.size(); ++i)
+    {
+        const std::vector<std::size_t>& segments = m_cables[i].segments;
+        for (std::size_t j = 0; j < segments.size(); ++j)
+        {
+            const Segment& segment = m_segments[segments[j]];
+            total += (segment.ends[1] - segment.ends[0]).length();
+            ++n;
+        }
+    }
+    if (n > 0)
+    {
+        m_config.cellSize = std::max(total / n, 4.0 * m_config.radius);
+    }
+}
+
+void tgCableContactDetector::updateSegments(Cable& cable, std::size_t index)
+{
+    const std::vector<tgBulletSpringCableAnchor*>& anchors =
+        cable.pCable->getBulletAnchors();
+    const std::size_t n = anchors.size() < 2 ? 0 : anchors.size() - 1;
+
+    // Sliding anchors come and go; the segments are then made anew
+    if (cable.segments.size() != n)
+    {
+        for (std::size_t i = 0; i < cable.segments.size(); ++i)
+        {
+            remove(cable.segments[i]);
+            m_free.push_back(cable.segments[i]);
+        }
+        cable.segments.clear();
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            std::size_t id = m_segments.size();
+            if (m_free.empty())
+            {
+                m_segments.push_back(Segment());
+            }
+            else
+            {
+                id = m_free.back();
+                m_free.pop_back();
+            }
+            Segment& segment = m_segments[id];
+            // In no cell yet
+            segment.lo[0] = 1;
+            segment.hi[0] = 0;
+            cable.segments.push_back(id);
+        }
+    }
+
+    if (n == 0)
+    {
+        return;
+    }
+    btVector3 start = anchors[0]->getWorldPosition();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        Segment& segment = m_segments[cable.segments[i]];
+        segment.cable = index;
+        segment.first = i;
+        segment.ends[0] = start;
+        segment.ends[1] = anchors[i + 1]->getWorldPosition();
+        start = segment.ends[1];
+    }
+}
+
+void tgCableContactDetector::place(std::size_t id)
+{
+    Segment& segment = m_segments[id];
+    int lo[3];
+    int hi[3];
+    if (isFinite(segment.ends[0]) && isFinite(segment.ends[1]))
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            const double a = segment.ends[0][axis];
+            const double b = segment.ends[1][axis];
+            lo[axis] = cellOf(std::min(a, b) - m_config.radius, m_config.cellSize);
+            hi[axis] = cellOf(std::max(a, b) + m_config.radius, m_config.cellSize);
+        }
+    }
+    else
+    {
+        // A diverged cable touches nothing
+        lo[0] = 1;
+        hi[0] = 0;
+        lo[1] = lo[2] = hi[1] = hi[2] = 0;
+    }
+    if (std::equal(lo, lo + 3, segment.lo) && std::equal(hi, hi + 3, segment.hi))
+    {
+        return;
+    }
+    remove(id);
+    std::copy(lo, lo + 3, segment.lo);
+    std::copy(hi, hi + 3, segment.hi);
+    insert(id);
+    ++m_moved;
+}
+
+void tgCableContactDetector::insert(std::size_t id)
+{
+    const Segment& segment = m_segments[id];
+    for (int x = segment.lo[0]; x <= segment.hi[0]; ++x)
+    {
+        for (int y = segment.lo[1]; y <= segment.hi[1]; ++y)
+        {
+            for (int z = segment.lo[2]; z <= segment.hi[2]; ++z)
+            {
+                m_cells[key(x, y, z)].push_back(id);
+            }
+        }
+    }
+}
+
+void tgCableContactDetector::remove(std::size_t id)
+{
+    Segment& segment = m_segments[id];
+    for (int x = segment.lo[0]; x <= segment.hi[0]; ++x)
+    {
+        for (int y = segment.lo[1]; y <= segment.hi[1]; ++y)
+        {
+            for (int z = segment.lo[2]; z <= segment.hi[2]; ++z)
+            {
+                const Cells::iterator it = m_cells.find(key(x, y, z));
+                assert(it != m_cells.end());
+                std::vector<std::size_t>& in = it->second;
+                // The order in a cell does not matter
+                *std::find(in.begin(), in.end(), id) = in.back();
+                in.pop_back();
+                if (in.empty())
+                {
+                    m_cells.erase(it);
+                }
+            }
+        }
+    }
+    segment.lo[0] = 1;
+    segment.hi[0] = 0;
+}
+
+void tgCableContactDetector::test(std::size_t a, std::size_t b)
+{
+    const Segment& first = m_segments[a];
+    const Segment& second = m_segments[b];
+    const std::vector<tgBulletSpringCableAnchor*>& anchorsA =
+        m_cables[first.cable].pCable->getBulletAnchors();
+    const std::vector<tgBulletSpringCableAnchor*>& anchorsB =
+        m_cables[second.cable].pCable->getBulletAnchors();
+    const btRigidBody* const a0 = anchorsA[first.first]->attachedBody;
+    const btRigidBody* const a1 = anchorsA[first.first + 1]->attachedBody;
+    const btRigidBody* const b0 = anchorsB[second.first]->attachedBody;
+    const btRigidBody* const b1 = anchorsB[second.first + 1]->attachedBody;
+    if (a0 == b0 || a0 == b1 || a1 == b0 || a1 == b1)
+    {
+        return;
+    }
+
+    ++m_tests;
+    double s = 0.0;
+    double t = 0.0;
+    const double distance = closestPoints(first.ends[0], first.ends[1],
+                                          second.ends[0], second.ends[1],
+                                          s, t);
+    if (distance < 2.0 * m_config.radius)
+    {
+        Contact contact;
+        contact.cables[0] = m_cables[first.cable].pCable;
+        contact.cables[1] = m_cables[second.cable].pCable;
+        contact.segments[0] = first.first;
+        contact.segments[1] = second.first;
+        contact.points[0] = first.ends[0].lerp(first.ends[1], s);
+        contact.points[1] = second.ends[0].lerp(second.ends[1], t);
+        contact.along[0] = s;
+        contact.along[1] = t;
+        contact.distance = distance;
+        m_contacts.push_back(contact);
+    }
+}
+
+void tgCableContactDetector::push(const Contact& contact, double dt) const
+{
+    // Crossing segments give no direction to push in
+    if (contact.distance <= 1e-12)
+    {
+        return;
+    }
+    const double overlap = 2.0 * m_config.radius - contact.distance;
+    const btVector3 normal =
+        (contact.points[0] - contact.points[1]) / contact.distance;
+    const btVector3 impulse = normal * (m_config.stiffness * overlap * dt);
+    for (int side = 0; side < 2; ++side)
+    {
+        const std::vector<tgBulletSpringCableAnchor*>& anchors =
+            contact.cables[side]->getBulletAnchors();
+        const tgBulletSpringCableAnchor* const start = anchors[contact.segments[side]];
+        const tgBulletSpringCableAnchor* const end = anchors[contact.segments[side] + 1];
+        const btVector3 onSide = side == 0 ? impulse : -impulse;
+        start->attachedBody->applyImpulse(onSide * (1.0 - contact.along[side]),
+                                          start->getRelativePosition());
+        end->attachedBody->applyImpulse(onSide * contact.along[side],
+                                        end->getRelativePosition());
+    }
+}
+
+boost::uint64_t tgCableContactDetector::key(int x, int y, int z)
+{
+    return (static_cast<boost::uint64_t>(x + cellLimit) << 42) |
+        (static_cast<boost::uint64_t>(y + cellLimit) << 21) |
+        static_cast<boost::uint64_t>(z + cellLimit);
+}
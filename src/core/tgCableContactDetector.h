@@ -0,0 +1,215 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_CABLE_CONTACT_DETECTOR_H
+#define TG_CABLE_CONTACT_DETECTOR_H
+
+/**
+ * @file tgCableContactDetector.h
+ * @brief Contains the definition of class tgCableContactDetector
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "LinearMath/btVector3.h"
+// Boost
+#include <boost/cstdint.hpp>
+#include <boost/unordered_map.hpp>
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class tgBulletSpringCable;
+class tgModel;
+
+/**
+ * Finds the segments of different cables that touch, and optionally
+ * pushes them apart, which tgBulletContactSpringCable's ghost objects
+ * can't do since they only see rigid bodies. Each straight segment
+ * between two anchors is kept in a uniform spatial hash, in every cell
+ * its box grown by the radius overlaps. Segments whose cells did not
+ * change since the last step are not touched, so only moving cables
+ * cost an update, and only segments that share a cell are tested.
+ *
+ * Touching segments are pushed apart with a spring of Config::stiffness
+ * on their overlap. The cables are massless, so the force on a segment
+ * goes to the bodies of its two anchors, split by where along it the
+ * contact is. Segments with an end on the same body never touch, since
+ * cables meeting at a node would otherwise always do.
+ * Used by tgSimulation::enableCableContacts().
+ */
+class tgCableContactDetector
+{
+public:
+
+    struct Config
+    {
+        /**
+         * @param[in] radius the radius of every cable; must be positive
+         * @param[in] stiffness the force per length of overlap; 0 only
+         * finds the contacts
+         * @param[in] cellSize the edge of a hash cell; 0 selects the mean
+         * segment length of the first step, at least four radii
+         * @throw std::invalid_argument if radius is not positive, or
+         * stiffness or cellSize is negative
+         */
+        Config(double radius = 0.05, double stiffness = 0.0,
+               double cellSize = 0.0);
+
+        double radius;
+        double stiffness;
+        double cellSize;
+    };
+
+    /** Two segments closer than two radii */
+    struct Contact
+    {
+        const tgBulletSpringCable* cables[2];
+
+        /** The index of the first anchor of each segment */
+        std::size_t segments[2];
+
+        /** The nearest point of each segment */
+        btVector3 points[2];
+
+        /** Where along each segment, 0 at its first anchor and 1 at the next */
+        double along[2];
+
+        double distance;
+    };
+
+    explicit tgCableContactDetector(const Config& config = Config());
+
+    /**
+     * Add the tgBulletSpringCables, sliding anchors included, of a model
+     * and of every actuator below it.
+     * @param[in] model a model that has been set up
+     */
+    void add(tgModel& model);
+
+    /**
+     * Forget every cable. Must be called before the actuators are torn
+     * down.
+     */
+    void release();
+
+    /**
+     * Update the hash, find the contacts and push their segments apart.
+     * @param[in] dt the step size; must be positive
+     */
+    void step(double dt);
+
+    /** @return the contacts found by the last step() */
+    const std::vector<Contact>& getContacts() const { return m_contacts; }
+
+    /** @return the number of cables */
+    std::size_t size() const { return m_cables.size(); }
+
+    /** @return the segment pairs tested by the last step() */
+    std::size_t getNumTests() const { return m_tests; }
+
+    /** @return the segments moved to other cells by the last step() */
+    std::size_t getNumMoved() const { return m_moved; }
+
+    /**
+     * The nearest points of two segments, from Ericson's Real-Time
+     * Collision Detection, 5.1.9.
+     * @param[in] p1 the start of the first segment
+     * @param[in] q1 its end
+     * @param[in] p2 the start of the second segment
+     * @param[in] q2 its end
+     * @param[out] s where along the first the nearest point is, in [0, 1]
+     * @param[out] t where along the second, in [0, 1]
+     * @return the distance between the nearest points
+     */
+    static double closestPoints(const btVector3& p1, const btVector3& q1,
+                                const btVector3& p2, const btVector3& q2,
+                                double& s, double& t);
+
+private:
+
+    /** A segment in the hash */
+    struct Segment
+    {
+        /** The index of its cable in m_cables */
+        std::size_t cable;
+
+        /** The index of its first anchor */
+        std::size_t first;
+
+        /** The ends, as of this step */
+        btVector3 ends[2];
+
+        /** The cells it is in, lo to hi inclusive on each axis */
+        int lo[3];
+        int hi[3];
+    };
+
+    /** A cable and its segments in m_segments */
+    struct Cable
+    {
+        const tgBulletSpringCable* pCable;
+        std::vector<std::size_t> segments;
+    };
+
+    typedef boost::unordered_map<boost::uint64_t, std::vector<std::size_t> > Cells;
+
+    /** Choose the cell size if it is still 0. */
+    void fitCellSize();
+
+    /**
+     * Give a cable as many segments as it has anchors now, less one, and
+     * read their ends.
+     */
+    void updateSegments(Cable& cable, std::size_t index);
+
+    /** Move a segment to the cells of its ends, if they changed. */
+    void place(std::size_t segment);
+
+    void insert(std::size_t segment);
+    void remove(std::size_t segment);
+
+    /** Test two segments, and add a contact if they touch */
+    void test(std::size_t a, std::size_t b);
+
+    /** Push the segments of a contact apart. */
+    void push(const Contact& contact, double dt) const;
+
+    static boost::uint64_t key(int x, int y, int z);
+
+    Config m_config;
+
+    std::vector<Cable> m_cables;
+
+    /** Every segment, by index, including free ones */
+    std::vector<Segment> m_segments;
+
+    /** The indices of m_segments not in use */
+    std::vector<std::size_t> m_free;
+
+    Cells m_cells;
+
+    std::vector<Contact> m_contacts;
+
+    std::size_t m_tests;
+
+    std::size_t m_moved;
+};
+
+#endif  // TG_CABLE_CONTACT_DETECTOR_H
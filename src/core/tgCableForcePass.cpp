@@ -0,0 +1,159 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgCableForcePass.cpp
+ * @brief Contains the definitions of members of class tgCableForcePass
+ * $Id$
+ */
+
+// This module
+#include "tgCableForcePass.h"
+// This application
+#include "tgCast.h"
+#include "tgKinematicActuator.h"
+#include "tgModel.h"
+#include "tgPerfCounters.h"
+#include "tgSpringCableActuator.h"
+// The Bullet Physics library
+#include "LinearMath/btQuickprof.h"
+// The C++ Standard Library
+#include <cassert>
+#include <stdexcept>
+
+class tgCableForcePass::CalculateTask : public tgThreadPool::Task
+{
+public:
+    CalculateTask(tgCableBank& bank, std::size_t nBlocks, double dt) :
+        m_bank(bank),
+        m_nBlocks(nBlocks),
+        m_dt(dt)
+    {
+    }
+
+    virtual void operator()(std::size_t item)
+    {
+        const std::size_t n = m_bank.size();
+        const std::size_t begin = item * n / m_nBlocks;
+        const std::size_t end = (item + 1) * n / m_nBlocks;
+        const tgPerfCounters::Scope counters("tgCableForcePass::calculate",
+                                             end - begin);
+        m_bank.calculate(begin, end, m_dt);
+    }
+
+private:
+    tgCableBank& m_bank;
+    const std::size_t m_nBlocks;
+    const double m_dt;
+};
+
+tgCableForcePass::tgCableForcePass(std::size_t nThreads) :
+    m_pool(nThreads)
+{
+}
+
+tgCableForcePass::~tgCableForcePass()
+{
+    release();
+}
+
+void tgCableForcePass::add(tgModel& model)
+{
+    std::vector<tgModel*> models = model.getDescendants();
+    models.push_back(&model);
+    for (std::size_t i = 0; i < models.size(); ++i)
+    {
+        tgSpringCableActuator* const pActuator =
+            tgCast::cast<tgModel, tgSpringCableActuator>(models[i]);
+        if (pActuator && !pActuator->cableForcesDeferred() &&
+            pActuator->deferCableForces(true))
+        {
+            tgBulletSpringCable* const pCable = pActuator->getDeferredCable();
+            if (pCable == NULL)
+            {
+                // Corde and contact cables are left to their solvers
+                pActuator->deferCableForces(false);
+                continue;
+            }
+            try
+            {
+                m_bank.add(*pCable);
+            }
+            catch (const std::invalid_argument&)
+            {
+                // Sliding anchors, sub-stepped cables and constraint
+                // cables step themselves
+                pActuator->deferCableForces(false);
+                continue;
+            }
+            m_actuators.push_back(pActuator);
+
+            tgKinematicActuator* const pKinematic =
+                tgCast::cast<tgSpringCableActuator, tgKinematicActuator>(pActuator);
+            if (pKinematic && pKinematic->deferMotor(true))
+            {
+                m_motors.add(*pKinematic);
+            }
+        }
+    }
+}
+
+void tgCableForcePass::release()
+{
+    for (std::size_t i = 0; i < m_actuators.size(); ++i)
+    {
+        m_actuators[i]->deferCableForces(false);
+    }
+    m_actuators.clear();
+    m_bank.clear();
+    m_motors.clear();
+}
+
+void tgCableForcePass::step(double dt)
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("tgCableForcePass::step");
+#endif //BT_NO_PROFILE
+    if (dt <= 0.0)
+    {
+        throw std::invalid_argument("dt is not positive");
+    }
+
+    const std::size_t n = m_actuators.size();
+    if (n == 0)
+    {
+        return;
+    }
+    const tgPerfCounters::Scope counters("tgCableForcePass::step", n);
+
+    // The motors set the rest lengths the cable forces use
+    m_motors.integrate(dt);
+
+    // One contiguous block per worker keeps each cable's data on one core
+    m_bank.gatherBodies();
+    const std::size_t nBlocks = n < m_pool.size() ? n : m_pool.size();
+    CalculateTask task(m_bank, nBlocks, dt);
+    m_pool.run(task, nBlocks);
+
+    // Bodies are shared between cables, so apply in order on this thread
+    m_bank.apply();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        m_actuators[i]->finishDeferredStep(dt);
+    }
+}
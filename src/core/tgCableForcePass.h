@@ -0,0 +1,113 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_CABLE_FORCE_PASS_H
+#define TG_CABLE_FORCE_PASS_H
+
+/**
+ * @file tgCableForcePass.h
+ * @brief Contains the definition of class tgCableForcePass
+ * $Id$
+ */
+
+// This application
+#include "tgCableBank.h"
+#include "tgMotorBank.h"
+#include "tgThreadPool.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class tgModel;
+class tgSpringCableActuator;
+
+/**
+ * Computes the forces of many spring cable actuators in two phases after
+ * the models have stepped: every cable's force is calculated in a
+ * tgCableBank, in blocks on a tgThreadPool, then the impulses are
+ * applied to the bodies serially in a fixed order. Cable forces only
+ * read the body transforms, which do not change while the models step,
+ * so the results match serial stepping, except that controllers reading
+ * another actuator's tension during the model step see the value from
+ * the previous step. Kinematic actuators with Config::batchMotor set
+ * have their motors integrated first, in a tgMotorBank; controllers then
+ * also see the other motors' rest lengths from the previous step.
+ * Used by tgSimulation::enableParallelCableForces().
+ */
+class tgCableForcePass
+{
+public:
+
+    /**
+     * Construct an empty pass.
+     * @param[in] nThreads the number of threads computing forces; 0
+     * selects one per core
+     */
+    tgCableForcePass(std::size_t nThreads = 0);
+
+    /** Hands the cable forces back to any actuators still collected. */
+    ~tgCableForcePass();
+
+    /**
+     * Take over the cable forces of a model and every actuator below it
+     * that supports tgSpringCableActuator::deferCableForces().
+     * @param[in,out] model a model that has been set up
+     */
+    void add(tgModel& model);
+
+    /**
+     * Hand every cable back to its actuator and forget them. Must be
+     * called before the actuators are torn down.
+     */
+    void release();
+
+    /**
+     * Calculate, apply and finish every collected cable.
+     * @param[in] dt the step size; must be positive
+     */
+    void step(double dt);
+
+    /** Return the number of collected actuators. */
+    std::size_t size() const
+    {
+        return m_actuators.size();
+    }
+
+private:
+
+    /** Calculates the forces of one contiguous block of actuators. */
+    class CalculateTask;
+
+    /** The threads that calculate forces. */
+    tgThreadPool m_pool;
+
+    /** The contiguous copy of the collected cables. */
+    tgCableBank m_bank;
+
+    /** The motors of the collected actuators that batch them. */
+    tgMotorBank m_motors;
+
+    /**
+     * The actuators whose cable forces this pass computes, in the order
+     * they were added. Not owned.
+     */
+    std::vector<tgSpringCableActuator*> m_actuators;
+};
+
+#endif  // TG_CABLE_FORCE_PASS_H
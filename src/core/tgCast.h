@@ -119,7 +119,7 @@ public:
     }
     
     template <typename T_FROM, typename T_TO>
-    static std::vector<T_TO*> find(const tgTagSearch& tagSearch, const std::vector<T_FROM*> haystack)
+    static std::vector<T_TO*> find(const tgTagSearch& tagSearch, const std::vector<T_FROM*>& haystack)
     {
         // Filter to the correct type
         std::vector<T_TO*> filtered = filter<T_FROM, T_TO>(haystack);
@@ -0,0 +1,470 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgCompressedSeries.cpp
+ * @brief Contains the definitions of members of class tgCompressedSeries
+ * $Id$
+ */
+
+// This module
+#include "tgCompressedSeries.h"
+// The C++ Standard Library
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    /** Marks a window of no previous XOR, at the start of a chunk */
+    const unsigned noWindow = 64;
+
+    /** The leading zeros are written in 5 bits */
+    const unsigned maxLeading = 31;
+
+    boost::uint64_t toBits(double value)
+    {
+        boost::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    double toDouble(boost::uint64_t bits)
+    {
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    boost::uint64_t mask(unsigned n)
+    {
+        return n >= 64 ? ~boost::uint64_t(0) : (boost::uint64_t(1) << n) - 1;
+    }
+
+    /** The leading zeros of a non-zero word */
+    unsigned leadingZeros(boost::uint64_t x)
+    {
+        assert(x != 0);
+#if defined(__GNUC__)
+        return __builtin_clzll(x);
+#else
+        unsigned n = 0;
+        for (; (x & (boost::uint64_t(1) << 63)) == 0; x <<= 1)
+        {
+            ++n;
+        }
+        return n;
+#endif
+    }
+
+    /** The trailing zeros of a non-zero word */
+    unsigned trailingZeros(boost::uint64_t x)
+    {
+        assert(x != 0);
+#if defined(__GNUC__)
+        return __builtin_ctzll(x);
+#else
+        unsigned n = 0;
+        for (; (x & 1) == 0; x >>= 1)
+        {
+            ++n;
+        }
+        return n;
+#endif
+    }
+
+    /** Reads the bits of a chunk in the order they were written */
+    class BitReader
+    {
+    public:
+        explicit BitReader(const std::vector<boost::uint64_t>& words) :
+        m_words(words),
+        m_pos(0)
+        {
+        }
+
+        boost::uint64_t read(unsigned n)
+        {
+            assert(n > 0 && n <= 64);
+            const std::size_t index = m_pos / 64;
+            const unsigned space = 64 - m_pos % 64;
+            m_pos += n;
+            if (n <= space)
+            {
+                return (m_words[index] >> (space - n)) & mask(n);
+            }
+            const unsigned rest = n - space;
+            return ((m_words[index] & mask(space)) << rest) |
+                (m_words[index + 1] >> (64 - rest));
+        }
+
+    private:
+        const std::vector<boost::uint64_t>& m_words;
+        std::size_t m_pos;
+    };
+
+    /** Keeps the last value decoded */
+    struct LastValue
+    {
+        double value;
+        void operator()(double v) { value = v; }
+    };
+
+    /**
+     * The widths of the delta of delta buckets after the first, a zero
+     * delta: '10' and 7 bits, '110' and 9, '1110' and 12, as in Gorilla's
+     * timestamps, and then '11110' and 20; '11111' and 64 bits take any
+     */
+    const unsigned deltaBuckets[] = { 7, 9, 12, 20 };
+
+    const boost::uint64_t signBit = boost::uint64_t(1) << 63;
+
+    /**
+     * The bits of a double as an integer that grows with the value, so
+     * a value crossing zero changes it a little
+     */
+    boost::uint64_t orderedKey(boost::uint64_t bits)
+    {
+        return (bits & signBit) != 0 ? ~bits : bits ^ signBit;
+    }
+
+    /**
+     * The inverse of orderedKey for a truncated double, whose key has
+     * dropped low bits that are zero
+     */
+    boost::uint64_t fromOrderedKey(boost::uint64_t key, unsigned dropped)
+    {
+        return (key & signBit) != 0 ? key ^ signBit : ~(key | mask(dropped));
+    }
+
+    template <typename Container>
+    struct Append
+    {
+        explicit Append(Container& c) : values(c) { }
+        Container& values;
+        void operator()(double v) { values.push_back(v); }
+    };
+}
+
+boost::uint64_t tgCompressedSeries::truncated(boost::uint64_t bits) const
+{
+    const boost::uint64_t exponent = boost::uint64_t(0x7ff) << exact;
+    const boost::uint64_t quiet = boost::uint64_t(1) << (exact - 1);
+    if ((bits & exponent) == exponent && (bits & mask(exact)) != 0)
+    {
+        // A NaN stays one without its payload
+        return (bits & signBit) | exponent | quiet;
+    }
+    return bits & ~mask(exact - m_mantissaBits);
+}
+
+tgCompressedSeries::Chunk::Chunk() :
+bits(0),
+count(0)
+{
+}
+
+const unsigned tgCompressedSeries::exact;
+const std::size_t tgCompressedSeries::defaultChunkSize;
+
+tgCompressedSeries::tgCompressedSeries(std::size_t chunkSize,
+                                       unsigned mantissaBits) :
+m_chunkSize(chunkSize),
+m_mantissaBits(mantissaBits),
+m_size(0),
+m_last(0),
+m_leading(noWindow),
+m_trailing(0),
+m_lastKey(0),
+m_lastDelta(0)
+{
+    if (chunkSize == 0)
+    {
+        throw std::invalid_argument("chunkSize is zero");
+    }
+    else if (mantissaBits == 0 || mantissaBits > exact)
+    {
+        throw std::invalid_argument("mantissaBits is out of range");
+    }
+}
+
+void tgCompressedSeries::write(boost::uint64_t value, unsigned n)
+{
+    assert(n > 0 && n <= 64);
+    Chunk& chunk = m_chunks.back();
+    value &= mask(n);
+    const unsigned offset = chunk.bits % 64;
+    if (offset == 0)
+    {
+        chunk.words.push_back(0);
+    }
+    const unsigned space = 64 - offset;
+    if (n <= space)
+    {
+        chunk.words.back() |= value << (space - n);
+    }
+    else
+    {
+        const unsigned rest = n - space;
+        chunk.words.back() |= value >> rest;
+        chunk.words.push_back(value << (64 - rest));
+    }
+    chunk.bits += n;
+}
+
+void tgCompressedSeries::encodeXor(boost::uint64_t bits)
+{
+    const boost::uint64_t x = bits ^ m_last;
+    if (x == 0)
+    {
+        write(0, 1);
+        return;
+    }
+    unsigned leading = leadingZeros(x);
+    if (leading > maxLeading)
+    {
+        leading = maxLeading;
+    }
+    const unsigned trailing = trailingZeros(x);
+    if (m_leading != noWindow &&
+        leading >= m_leading && trailing >= m_trailing)
+    {
+        // Inside the previous window: '10' and the window's bits
+        write(2, 2);
+        write(x >> m_trailing, 64 - m_leading - m_trailing);
+    }
+    else
+    {
+        // A new window: '11', its leading zeros and length
+        const unsigned length = 64 - leading - trailing;
+        write(3, 2);
+        write(leading, 5);
+        write(length - 1, 6);
+        write(x >> trailing, length);
+        m_leading = leading;
+        m_trailing = trailing;
+    }
+}
+
+void tgCompressedSeries::encodeDelta(boost::uint64_t key)
+{
+    // Unsigned arithmetic wraps, so every difference reads back exactly
+    const boost::uint64_t delta = key - m_lastKey;
+    const boost::uint64_t dd = delta - m_lastDelta;
+    m_lastDelta = delta;
+
+    const std::size_t buckets = sizeof(deltaBuckets) / sizeof(deltaBuckets[0]);
+    if (dd == 0)
+    {
+        write(0, 1);
+        return;
+    }
+    for (std::size_t i = 0; i < buckets; i++)
+    {
+        // The bucket of n bits holds -(2^(n-1) - 1) to 2^(n-1)
+        const unsigned n = deltaBuckets[i];
+        const boost::uint64_t bias = (boost::uint64_t(1) << (n - 1)) - 1;
+        if (dd + bias <= mask(n))
+        {
+            // i + 1 ones and a zero, then the biased value
+            write(mask(i + 1) << 1, i + 2);
+            write(dd + bias, n);
+            return;
+        }
+    }
+    write(mask(buckets + 1), buckets + 1);
+    write(dd, 64);
+}
+
+void tgCompressedSeries::push_back(double value)
+{
+    boost::uint64_t bits = toBits(value);
+    const bool lossy = m_mantissaBits < exact;
+    const unsigned dropped = exact - m_mantissaBits;
+    if (lossy)
+    {
+        bits = truncated(bits);
+    }
+
+    if (m_chunks.empty() || m_chunks.back().count == m_chunkSize)
+    {
+        // Release the growth slack of the chunk just filled
+        if (!m_chunks.empty())
+        {
+            std::vector<boost::uint64_t>(m_chunks.back().words).swap(
+                m_chunks.back().words);
+        }
+        m_chunks.push_back(Chunk());
+        write(bits, 64);
+        m_leading = noWindow;
+        m_lastKey = orderedKey(bits) >> dropped;
+        m_lastDelta = 0;
+    }
+    else if (lossy)
+    {
+        const boost::uint64_t key = orderedKey(bits) >> dropped;
+        encodeDelta(key);
+        m_lastKey = key;
+    }
+    else
+    {
+        encodeXor(bits);
+    }
+    m_last = bits;
+    ++m_chunks.back().count;
+    ++m_size;
+}
+
+template <typename Visitor>
+void tgCompressedSeries::decodeChunk(const Chunk& chunk, std::size_t n,
+                                     Visitor& visit) const
+{
+    assert(n <= chunk.count);
+    if (n == 0)
+    {
+        return;
+    }
+    BitReader reader(chunk.words);
+    boost::uint64_t bits = reader.read(64);
+    visit(toDouble(bits));
+
+    const std::size_t buckets = sizeof(deltaBuckets) / sizeof(deltaBuckets[0]);
+    const unsigned dropped = exact - m_mantissaBits;
+    if (m_mantissaBits < exact)
+    {
+        boost::uint64_t key = orderedKey(bits) >> dropped;
+        boost::uint64_t delta = 0;
+        for (std::size_t i = 1; i < n; i++)
+        {
+            std::size_t ones = 0;
+            while (ones <= buckets && reader.read(1) != 0)
+            {
+                ++ones;
+            }
+            if (ones > buckets)
+            {
+                delta += reader.read(64);
+            }
+            else if (ones > 0)
+            {
+                const unsigned width = deltaBuckets[ones - 1];
+                const boost::uint64_t bias =
+                    (boost::uint64_t(1) << (width - 1)) - 1;
+                delta += reader.read(width) - bias;
+            }
+            key += delta;
+            visit(toDouble(fromOrderedKey(key << dropped, dropped)));
+        }
+        return;
+    }
+
+    unsigned leading = noWindow;
+    unsigned trailing = 0;
+    for (std::size_t i = 1; i < n; i++)
+    {
+        if (reader.read(1) != 0)
+        {
+            if (reader.read(1) != 0)
+            {
+                leading = static_cast<unsigned>(reader.read(5));
+                const unsigned length =
+                    static_cast<unsigned>(reader.read(6)) + 1;
+                trailing = 64 - leading - length;
+            }
+            assert(leading != noWindow);
+            bits ^= reader.read(64 - leading - trailing) << trailing;
+        }
+        visit(toDouble(bits));
+    }
+}
+
+double tgCompressedSeries::back() const
+{
+    if (empty())
+    {
+        throw std::out_of_range("Series is empty");
+    }
+    return toDouble(m_last);
+}
+
+double tgCompressedSeries::at(std::size_t i) const
+{
+    if (i >= m_size)
+    {
+        throw std::out_of_range("Index is out of range");
+    }
+    // Every chunk but the last is full, trim() drops whole ones
+    LastValue last;
+    decodeChunk(m_chunks[i / m_chunkSize], i % m_chunkSize + 1, last);
+    return last.value;
+}
+
+void tgCompressedSeries::decode(std::deque<double>& values) const
+{
+    values.clear();
+    Append< std::deque<double> > append(values);
+    for (std::size_t i = 0; i < m_chunks.size(); i++)
+    {
+        decodeChunk(m_chunks[i], m_chunks[i].count, append);
+    }
+}
+
+void tgCompressedSeries::decode(std::vector<double>& values) const
+{
+    values.reserve(values.size() + m_size);
+    Append< std::vector<double> > append(values);
+    for (std::size_t i = 0; i < m_chunks.size(); i++)
+    {
+        decodeChunk(m_chunks[i], m_chunks[i].count, append);
+    }
+}
+
+void tgCompressedSeries::trim(std::size_t capacity)
+{
+    if (capacity == 0)
+    {
+        return;
+    }
+    while (m_chunks.size() > 1 &&
+           m_size - m_chunks.front().count >= capacity)
+    {
+        m_size -= m_chunks.front().count;
+        m_chunks.pop_front();
+    }
+}
+
+void tgCompressedSeries::clear()
+{
+    m_chunks.clear();
+    m_size = 0;
+    m_last = 0;
+    m_leading = noWindow;
+    m_trailing = 0;
+    m_lastKey = 0;
+    m_lastDelta = 0;
+}
+
+std::size_t tgCompressedSeries::bytes() const
+{
+    std::size_t result = m_chunks.size() * sizeof(Chunk);
+    for (std::size_t i = 0; i < m_chunks.size(); i++)
+    {
+        result += m_chunks[i].words.capacity() * sizeof(boost::uint64_t);
+    }
+    return result;
+}
@@ -0,0 +1,186 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_COMPRESSED_SERIES_H
+#define TG_COMPRESSED_SERIES_H
+
+/**
+ * @file tgCompressedSeries.h
+ * @brief Contains the definition of class tgCompressedSeries
+ * $Id$
+ */
+
+// Boost
+#include <boost/cstdint.hpp>
+// The C++ Standard Library
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+/**
+ * An append-only series of doubles, such as a cable's tension at every
+ * step, compressed as it is written and decompressed only when it is read.
+ * Each value is stored as the XOR of its bits with the previous value's,
+ * as in Facebook's Gorilla: an unchanged value takes one bit, and a
+ * slowly changing one only the bits that changed, so the smooth histories
+ * of a long trial take a fraction of the 8 bytes per value of a deque.
+ * Decoding returns exactly the values written, NaNs and signed zeros
+ * included. Simulated values change in their last bits at every step,
+ * though, which leaves the XORs little to drop, so a series may also keep
+ * fewer bits of each mantissa. The values then read back truncated toward
+ * zero, to a relative error under 2^-mantissaBits, and NaNs lose their
+ * payloads. The kept bits of such a series change smoothly, so it stores
+ * the difference of the differences of successive values instead, in
+ * buckets of a few bits as Gorilla stores timestamps; a smooth signal
+ * then takes a few bits per value.
+ *
+ * The values are kept in chunks of a fixed number of values, each of
+ * which starts from a raw value, so a chunk decodes on its own and the
+ * oldest chunks can be dropped to bound the series, see trim().
+ */
+class tgCompressedSeries
+{
+public:
+
+    /** The bits of a double's mantissa, kept by default */
+    static const unsigned exact = 52;
+
+    static const std::size_t defaultChunkSize = 1024;
+
+    /**
+     * @param[in] chunkSize the number of values per chunk, positive
+     * @param[in] mantissaBits the bits of each mantissa kept, from 1 to
+     * exact
+     * @throw std::invalid_argument if chunkSize is zero or mantissaBits is
+     * out of range
+     */
+    explicit tgCompressedSeries(std::size_t chunkSize = defaultChunkSize,
+                                unsigned mantissaBits = exact);
+
+    /** Append a value. */
+    void push_back(double value);
+
+    /** @return the last value appended, kept uncompressed */
+    double back() const;
+
+    /**
+     * Decode one value; this decodes its chunk up to it.
+     * @throw std::out_of_range if i is not less than size()
+     */
+    double at(std::size_t i) const;
+
+    /** Replace the contents of a deque with every value, oldest first. */
+    void decode(std::deque<double>& values) const;
+
+    /** Append every value to a vector, oldest first. */
+    void decode(std::vector<double>& values) const;
+
+    /**
+     * Drop whole chunks from the front while at least capacity values
+     * remain, so the series keeps between capacity and capacity plus one
+     * chunk of the latest values. Zero keeps everything.
+     */
+    void trim(std::size_t capacity);
+
+    /** Remove every value. */
+    void clear();
+
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    std::size_t getChunkSize() const
+    {
+        return m_chunkSize;
+    }
+
+    unsigned getMantissaBits() const
+    {
+        return m_mantissaBits;
+    }
+
+    /** @return the bytes of the compressed values */
+    std::size_t bytes() const;
+
+private:
+
+    /** The encoded bits of up to m_chunkSize values */
+    struct Chunk
+    {
+        Chunk();
+
+        /** Bits, most significant first within each word */
+        std::vector<boost::uint64_t> words;
+
+        /** The number of bits written */
+        std::size_t bits;
+
+        /** The number of values */
+        std::size_t count;
+    };
+
+    /** Append the low n bits of value to the last chunk */
+    void write(boost::uint64_t value, unsigned n);
+
+    /** Append the XOR of an exact value with the last one */
+    void encodeXor(boost::uint64_t bits);
+
+    /** Append the delta of delta of the ordered key of a truncated value */
+    void encodeDelta(boost::uint64_t key);
+
+    /** The bits of a value with only m_mantissaBits of its mantissa */
+    boost::uint64_t truncated(boost::uint64_t bits) const;
+
+    /**
+     * Decode the first n values of a chunk.
+     * @param[in] visit called with each value in turn
+     */
+    template <typename Visitor>
+    void decodeChunk(const Chunk& chunk, std::size_t n,
+                     Visitor& visit) const;
+
+    std::size_t m_chunkSize;
+
+    unsigned m_mantissaBits;
+
+    /** Oldest first; only the last one is written to */
+    std::deque<Chunk> m_chunks;
+
+    std::size_t m_size;
+
+    // The encoder's state for the last chunk
+
+    /** The bits of the last value */
+    boost::uint64_t m_last;
+
+    /** The window of meaningful bits of the last XOR, see encodeXor() */
+    unsigned m_leading;
+    unsigned m_trailing;
+
+    /** The last key and delta of a truncated series, see encodeDelta() */
+    boost::uint64_t m_lastKey;
+    boost::uint64_t m_lastDelta;
+};
+
+#endif  // TG_COMPRESSED_SERIES_H
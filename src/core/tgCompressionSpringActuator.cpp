@@ -167,10 +167,10 @@ void tgCompressionSpringActuator::step(double dt)
 }
 
 // Renders the spring in the NTRT window
-void tgCompressionSpringActuator::onVisit(const tgModelVisitor& r) const
+void tgCompressionSpringActuator::accept(const tgModelVisitor& r) const
 {
 #ifndef BT_NO_PROFILE 
-    BT_PROFILE("tgCompressionSpringActuator::onVisit");
+    BT_PROFILE("tgCompressionSpringActuator::accept");
 #endif //BT_NO_PROFILE	
     r.render(*this);
 }
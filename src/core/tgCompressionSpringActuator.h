@@ -179,7 +179,7 @@ public:
    * data logging as of May 2014.
    * @param[in] r, the visiting tgModelVisitor
    */
-  virtual void onVisit(const tgModelVisitor& r) const;
+  virtual void accept(const tgModelVisitor& r) const;
     
   /**
    * Functions for interfacing with tgBulletCompressionSpring.
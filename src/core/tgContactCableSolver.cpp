@@ -0,0 +1,136 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgContactCableSolver.cpp
+ * @brief Contains the definitions of members of class tgContactCableSolver
+ * $Id$
+ */
+
+// This module
+#include "tgContactCableSolver.h"
+// This application
+#include "tgBulletContactSpringCable.h"
+#include "tgCast.h"
+#include "tgModel.h"
+#include "tgPerfCounters.h"
+#include "tgSpringCableActuator.h"
+// The Bullet Physics library
+#include "LinearMath/btQuickprof.h"
+// The C++ Standard Library
+#include <cassert>
+#include <stdexcept>
+
+class tgContactCableSolver::FindTask : public tgThreadPool::Task
+{
+public:
+    FindTask(std::vector<tgBulletContactSpringCable*>& cables) :
+        m_cables(cables)
+    {
+    }
+
+    virtual void operator()(std::size_t item)
+    {
+        const tgPerfCounters::Scope counters("tgContactCableSolver::find");
+        m_cables[item]->findContacts();
+    }
+
+private:
+    std::vector<tgBulletContactSpringCable*>& m_cables;
+};
+
+tgContactCableSolver::tgContactCableSolver(std::size_t nThreads) :
+    m_pool(nThreads)
+{
+}
+
+tgContactCableSolver::~tgContactCableSolver()
+{
+    release();
+}
+
+void tgContactCableSolver::add(tgModel& model)
+{
+    std::vector<tgModel*> models = model.getDescendants();
+    models.push_back(&model);
+    for (std::size_t i = 0; i < models.size(); ++i)
+    {
+        tgSpringCableActuator* const pActuator =
+            tgCast::cast<tgModel, tgSpringCableActuator>(models[i]);
+        if (pActuator && !pActuator->cableForcesDeferred() &&
+            pActuator->deferCableForces(true))
+        {
+            tgBulletContactSpringCable* const pCable =
+                pActuator->getDeferredContactCable();
+            if (pCable == NULL)
+            {
+                // Other cables are left to their own passes
+                pActuator->deferCableForces(false);
+                continue;
+            }
+            m_actuators.push_back(pActuator);
+            m_cables.push_back(pCable);
+        }
+    }
+}
+
+void tgContactCableSolver::release()
+{
+    for (std::size_t i = 0; i < m_actuators.size(); ++i)
+    {
+        m_actuators[i]->deferCableForces(false);
+    }
+    m_actuators.clear();
+    m_cables.clear();
+}
+
+void tgContactCableSolver::step(double dt)
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("tgContactCableSolver::step");
+#endif //BT_NO_PROFILE
+    if (dt <= 0.0)
+    {
+        throw std::invalid_argument("dt is not positive");
+    }
+
+    const std::size_t n = m_cables.size();
+    assert(m_actuators.size() == n);
+    if (n == 0)
+    {
+        return;
+    }
+    const tgPerfCounters::Scope counters("tgContactCableSolver::step", n);
+
+    // Cables in contact cost far more than free ones, and neighbours tend
+    // to touch the same bodies, so the cables are dealt out one per item
+    // rather than in contiguous blocks
+    FindTask task(m_cables);
+    m_pool.run(task, n);
+
+    // Committing changes the pairs and the bodies, so do it in order on
+    // this thread
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        m_cables[i]->commitContacts(dt);
+    }
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        m_actuators[i]->finishDeferredStep(dt);
+    }
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_CONTACT_CABLE_SOLVER_H
+#define TG_CONTACT_CABLE_SOLVER_H
+
+/**
+ * @file tgContactCableSolver.h
+ * @brief Contains the definition of class tgContactCableSolver
+ * $Id$
+ */
+
+// This application
+#include "tgThreadPool.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class tgBulletContactSpringCable;
+class tgModel;
+class tgSpringCableActuator;
+
+/**
+ * Steps the tgBulletContactSpringCables of many actuators in two phases
+ * after the models have stepped. Finding a cable's contacts only reads
+ * the world's pair cache and manifolds, and ghost objects never pair
+ * with each other, so every cable finds its contacts on a tgThreadPool,
+ * one cable per item. The anchor lists are then updated and the forces
+ * applied serially in a fixed order, since that changes the pairs and
+ * the bodies. The results match serial stepping, except that
+ * controllers reading another actuator's tension during the model step
+ * see the value from the previous step.
+ * Used by tgSimulation::enableParallelContactCables().
+ */
+class tgContactCableSolver
+{
+public:
+
+    /**
+     * Construct an empty solver.
+     * @param[in] nThreads the number of threads finding contacts; 0
+     * selects one per core
+     */
+    tgContactCableSolver(std::size_t nThreads = 0);
+
+    /** Hands the cables back to any actuators still collected. */
+    ~tgContactCableSolver();
+
+    /**
+     * Take over the contact cables of a model and every actuator below
+     * it whose cable is a tgBulletContactSpringCable. Actuators already
+     * deferred, such as to a tgCableForcePass, are left alone.
+     * @param[in,out] model a model that has been set up
+     */
+    void add(tgModel& model);
+
+    /**
+     * Hand every cable back to its actuator and forget them. Must be
+     * called before the actuators are torn down.
+     */
+    void release();
+
+    /**
+     * Find the contacts of every collected cable, then commit them.
+     * @param[in] dt the step size; must be positive
+     */
+    void step(double dt);
+
+    /** Return the number of collected actuators. */
+    std::size_t size() const
+    {
+        return m_actuators.size();
+    }
+
+private:
+
+    /** Finds the contacts of one collected cable. */
+    class FindTask;
+
+    /** The threads that find the contacts. */
+    tgThreadPool m_pool;
+
+    /**
+     * The actuators whose cables this solver steps, in the order they
+     * were added. Not owned.
+     */
+    std::vector<tgSpringCableActuator*> m_actuators;
+
+    /** The cable of each actuator, in the same order. Not owned. */
+    std::vector<tgBulletContactSpringCable*> m_cables;
+};
+
+#endif  // TG_CONTACT_CABLE_SOLVER_H
@@ -0,0 +1,134 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgControlInputRecord.cpp
+ * @brief Contains the definitions of members of class tgControlInputRecord
+ * $Id$
+ */
+
+// This module
+#include "tgControlInputRecord.h"
+// This application
+#include "tgCast.h"
+#include "tgModel.h"
+#include "tgSpringCableActuator.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+    const char* const header = "NTRT_CONTROL_INPUTS";
+    const int version = 1;
+}
+
+tgControlInputRecord::tgControlInputRecord() :
+    m_actuators(0)
+{
+}
+
+tgControlInputRecord::~tgControlInputRecord()
+{
+    stop();
+}
+
+void tgControlInputRecord::record(tgModel& model)
+{
+    stop();
+    m_inputs.clear();
+    m_recording = tgCast::filter<tgModel, tgSpringCableActuator>(
+        model.getDescendants());
+    m_actuators = m_recording.size();
+    for (std::size_t i = 0; i < m_recording.size(); i++)
+    {
+        m_recording[i]->setInputRecord(this, i);
+    }
+}
+
+void tgControlInputRecord::stop()
+{
+    for (std::size_t i = 0; i < m_recording.size(); i++)
+    {
+        m_recording[i]->setInputRecord(NULL, 0);
+    }
+    m_recording.clear();
+}
+
+void tgControlInputRecord::add(std::size_t step, std::size_t actuator,
+                               double value, double dt)
+{
+    const Input input = { step, actuator, value, dt };
+    m_inputs.push_back(input);
+}
+
+void tgControlInputRecord::release(tgSpringCableActuator* pActuator)
+{
+    m_recording.erase(std::remove(m_recording.begin(), m_recording.end(),
+                                  pActuator),
+                      m_recording.end());
+}
+
+void tgControlInputRecord::save(const std::string& path) const
+{
+    std::ofstream out(path.c_str());
+    // Enough digits for every double to read back exactly
+    out.precision(std::numeric_limits<double>::digits10 + 2);
+    out << header << " " << version << std::endl
+        << m_actuators << " " << m_inputs.size() << std::endl;
+    for (std::size_t i = 0; i < m_inputs.size(); i++)
+    {
+        const Input& input = m_inputs[i];
+        out << input.step << " " << input.actuator << " "
+            << input.value << " " << input.dt << std::endl;
+    }
+    if (!out)
+    {
+        throw std::runtime_error("Could not write control inputs to " + path);
+    }
+}
+
+void tgControlInputRecord::load(const std::string& path)
+{
+    stop();
+    std::ifstream in(path.c_str());
+    std::string name;
+    int fileVersion = 0;
+    std::size_t actuators = 0;
+    std::size_t n = 0;
+    in >> name >> fileVersion >> actuators >> n;
+    if (!in || name != header || fileVersion != version)
+    {
+        throw std::runtime_error(path + " is not a control input record");
+    }
+
+    std::vector<Input> inputs(n);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        Input& input = inputs[i];
+        in >> input.step >> input.actuator >> input.value >> input.dt;
+        if (!in || input.actuator >= actuators)
+        {
+            throw std::runtime_error(path + " is truncated or corrupt");
+        }
+    }
+    m_actuators = actuators;
+    m_inputs.swap(inputs);
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_CONTROL_INPUT_RECORD_H
+#define TG_CONTROL_INPUT_RECORD_H
+
+/**
+ * @file tgControlInputRecord.h
+ * @brief Contains the definition of class tgControlInputRecord
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class tgModel;
+class tgSpringCableActuator;
+
+/**
+ * The control inputs a model's spring cable actuators received during a
+ * run, in the order they arrived, each tagged with the actuator and its
+ * step count. A trial is recorded once with its real controller and
+ * then replayed with tgControlInputReplay, which repeats the inputs
+ * without parsing or running the controller. With the same model and a
+ * deterministic world the replay reproduces the trial.
+ *
+ * Actuators are numbered in the order of tgModel::getDescendants(), so
+ * a record fits any model built the same way.
+ */
+class tgControlInputRecord
+{
+public:
+
+    /** One call to tgControllable::setControlInput(). */
+    struct Input
+    {
+        /** The number of steps the actuator had completed. */
+        std::size_t step;
+
+        /** The index of the actuator. */
+        std::size_t actuator;
+
+        /** The input. */
+        double value;
+
+        /** The dt passed with the input, or zero for the form without. */
+        double dt;
+    };
+
+    /** Construct an empty record. */
+    tgControlInputRecord();
+
+    /** Stops recording. */
+    ~tgControlInputRecord();
+
+    /**
+     * Start recording the inputs of every spring cable actuator below a
+     * model, replacing the inputs recorded so far. The actuators stop
+     * recording when they are destroyed, for example by a reset.
+     * @param[in,out] model a model that has been set up
+     */
+    void record(tgModel& model);
+
+    /** Stop recording. The inputs are kept. */
+    void stop();
+
+    /**
+     * Append an input. Called by the actuators being recorded.
+     * @param[in] step the actuator's step count
+     * @param[in] actuator the actuator's index
+     * @param[in] value the input
+     * @param[in] dt the dt passed with the input, or zero
+     */
+    void add(std::size_t step, std::size_t actuator, double value,
+             double dt);
+
+    /**
+     * Forget an actuator that is being destroyed. Called by the actuator.
+     * @param[in] pActuator the actuator
+     */
+    void release(tgSpringCableActuator* pActuator);
+
+    /** @return the recorded inputs, in the order they arrived */
+    const std::vector<Input>& getInputs() const { return m_inputs; }
+
+    /** @return the number of actuators the inputs are for */
+    std::size_t getActuators() const { return m_actuators; }
+
+    /**
+     * Write the record as text that load() reads back exactly.
+     * @param[in] path the file
+     * @throw std::runtime_error if the file can't be written
+     */
+    void save(const std::string& path) const;
+
+    /**
+     * Stop recording, then replace the inputs with those in a file
+     * written by save().
+     * @param[in] path the file
+     * @throw std::runtime_error if the file can't be read or is not a
+     * record
+     */
+    void load(const std::string& path);
+
+private:
+
+    /** Not copyable: the actuators point to this record. */
+    tgControlInputRecord(const tgControlInputRecord&);
+    tgControlInputRecord& operator=(const tgControlInputRecord&);
+
+private:
+
+    /** The actuators being recorded. Not owned. */
+    std::vector<tgSpringCableActuator*> m_recording;
+
+    /** The number of actuators the inputs are for. */
+    std::size_t m_actuators;
+
+    /** The inputs, in the order they arrived. */
+    std::vector<Input> m_inputs;
+};
+
+#endif  // TG_CONTROL_INPUT_RECORD_H
@@ -0,0 +1,935 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgCordeCable.cpp
+ * @brief Implementation of class tgCordeCable
+ * @author Brian Mirletz
+ * $Id$
+ */
+
+// This module
+#include "tgCordeCable.h"
+#include "tgBulletSpringCableAnchor.h"
+#include "tgCast.h"
+#include "tgSnapshot.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btQuaternion.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    /** Invert a 3x3 matrix, row major, by its cofactors */
+    void invert(const double a[9], double out[9])
+    {
+        const double c0 = a[4] * a[8] - a[5] * a[7];
+        const double c1 = a[5] * a[6] - a[3] * a[8];
+        const double c2 = a[3] * a[7] - a[4] * a[6];
+        const double inverse = 1.0 / (a[0] * c0 + a[1] * c1 + a[2] * c2);
+        out[0] = c0 * inverse;
+        out[1] = (a[2] * a[7] - a[1] * a[8]) * inverse;
+        out[2] = (a[1] * a[5] - a[2] * a[4]) * inverse;
+        out[3] = c1 * inverse;
+        out[4] = (a[0] * a[8] - a[2] * a[6]) * inverse;
+        out[5] = (a[2] * a[3] - a[0] * a[5]) * inverse;
+        out[6] = c2 * inverse;
+        out[7] = (a[1] * a[6] - a[0] * a[7]) * inverse;
+        out[8] = (a[0] * a[4] - a[1] * a[3]) * inverse;
+    }
+}
+
+tgCordeCable::Config::Config(std::size_t res,
+                             double r, double d,
+                             double ym, double shm,
+                             double csc, double gr) :
+    resolution(res),
+    radius(r),
+    density(d),
+    youngMod(ym),
+    shearMod(shm),
+    consSpringConst(csc),
+    gammaR(gr)
+{
+    if (res < 3)
+    {
+        throw std::invalid_argument("Corde cable needs at least 3 points.");
+    }
+    else if (r <= 0.0)
+    {
+        throw std::invalid_argument("Corde cable radius is not positive.");
+    }
+    else if (d <= 0.0)
+    {
+        throw std::invalid_argument("Corde cable density is not positive.");
+    }
+    else if (ym < 0.0)
+    {
+        throw std::invalid_argument("Young's Modulus is negative.");
+    }
+    else if (shm < 0.0)
+    {
+        throw std::invalid_argument("Shear Modulus is negative.");
+    }
+    else if (csc < 0.0)
+    {
+        throw std::invalid_argument("Spring Constant is negative.");
+    }
+    else if (gr < 0.0)
+    {
+        throw std::invalid_argument("Damping Constant (rotation) is negative.");
+    }
+}
+
+tgCordeCable::tgCordeCable(const std::vector<tgBulletSpringCableAnchor*>& anchors,
+                           double coefK,
+                           double dampingCoefficient,
+                           double pretension,
+                           const Config& config,
+                           const btVector3& gravity) :
+tgSpringCable(tgCast::filter<tgBulletSpringCableAnchor, tgSpringCableAnchor>(anchors),
+              coefK, dampingCoefficient, pretension),
+m_anchors(anchors),
+m_config(config),
+m_gravity(gravity),
+m_substeps(1),
+m_impulse1(0.0, 0.0, 0.0),
+m_impulse2(0.0, 0.0, 0.0),
+m_point1(0.0, 0.0, 0.0),
+m_point2(0.0, 0.0, 0.0)
+{
+    if (m_anchors.size() != 2)
+    {
+        throw std::invalid_argument("Corde cable needs exactly two anchors.");
+    }
+
+    const std::size_t n = m_config.resolution;
+    const std::size_t links = n - 1;
+    m_linkRestLength = m_restLength / links;
+
+    const btVector3 start = m_anchors[0]->getWorldPosition();
+    const btVector3 end = m_anchors[1]->getWorldPosition();
+    const btVector3 unitLength = (end - start) / links;
+    const double pir2 = M_PI * m_config.radius * m_config.radius;
+    m_pointMass = m_config.density * pir2 * unitLength.length();
+
+    // The constants of the prototype. Its inertia is per unit length,
+    // so the cable's total stays the same at any resolution.
+    m_bendingStiffness[0] = m_config.youngMod * pir2 / 4.0;
+    m_bendingStiffness[1] = m_config.youngMod * pir2 / 4.0;
+    m_bendingStiffness[2] = m_config.shearMod * pir2 / 2.0;
+    m_inertia[0] = m_config.density * pir2 / 4.0 * unitLength.length();
+    m_inertia[1] = m_config.density * pir2 / 4.0 * unitLength.length();
+    m_inertia[2] = m_config.density * pir2 / 2.0 * unitLength.length();
+    for (std::size_t j = 0; j < 3; j++)
+    {
+        m_inverseInertia[j] = 1.0 / m_inertia[j];
+    }
+
+    m_x.resize(n);
+    m_y.resize(n);
+    m_z.resize(n);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const btVector3 point = start + unitLength * i;
+        m_x[i] = point.x();
+        m_y[i] = point.y();
+        m_z[i] = point.z();
+    }
+    m_vx.assign(n, 0.0);
+    m_vy.assign(n, 0.0);
+    m_vz.assign(n, 0.0);
+    m_fx.assign(n, 0.0);
+    m_fy.assign(n, 0.0);
+    m_fz.assign(n, 0.0);
+    m_upper.assign(9 * n, 0.0);
+
+    // Each orientation turns z onto its link: no bending or torsion
+    const btQuaternion q =
+        shortestArcQuat(btVector3(0.0, 0.0, 1.0), unitLength.normalized());
+    m_q0.assign(links, q.x());
+    m_q1.assign(links, q.y());
+    m_q2.assign(links, q.z());
+    m_q3.assign(links, q.w());
+    m_qd0.assign(links, 0.0);
+    m_qd1.assign(links, 0.0);
+    m_qd2.assign(links, 0.0);
+    m_qd3.assign(links, 0.0);
+    m_wx.assign(links, 0.0);
+    m_wy.assign(links, 0.0);
+    m_wz.assign(links, 0.0);
+    m_t0.assign(links, 0.0);
+    m_t1.assign(links, 0.0);
+    m_t2.assign(links, 0.0);
+    m_t3.assign(links, 0.0);
+    m_lfx.assign(links, 0.0);
+    m_lfy.assign(links, 0.0);
+    m_lfz.assign(links, 0.0);
+    m_kxx.assign(links, 0.0);
+    m_kxy.assign(links, 0.0);
+    m_kxz.assign(links, 0.0);
+    m_kyy.assign(links, 0.0);
+    m_kyz.assign(links, 0.0);
+    m_kzz.assign(links, 0.0);
+    m_afx.assign(links, 0.0);
+    m_afy.assign(links, 0.0);
+    m_afz.assign(links, 0.0);
+    m_bt0.assign(links, 0.0);
+    m_bt1.assign(links, 0.0);
+    m_bt2.assign(links, 0.0);
+    m_bt3.assign(links, 0.0);
+
+    m_prevLength = getActualLength();
+    assert(invariant());
+}
+
+tgCordeCable::~tgCordeCable()
+{
+    for (std::size_t i = 0; i < m_anchors.size(); i++)
+    {
+        delete m_anchors[i];
+    }
+    m_anchors.clear();
+}
+
+void tgCordeCable::step(double dt)
+{
+    calculateForce(dt);
+    applyForce();
+}
+
+void tgCordeCable::calculateForce(double dt)
+{
+    if (dt <= 0.0)
+    {
+        throw std::invalid_argument("dt is not positive!");
+    }
+
+    const tgBulletSpringCableAnchor& anchor1 = *m_anchors[0];
+    const tgBulletSpringCableAnchor& anchor2 = *m_anchors[1];
+    btRigidBody* const body1 = anchor1.attachedBody;
+    btRigidBody* const body2 = anchor2.attachedBody;
+    m_point1 = anchor1.getRelativePosition();
+    m_point2 = anchor2.getRelativePosition();
+    const btVector3 start = anchor1.getWorldPosition();
+    const btVector3 end = anchor2.getWorldPosition();
+    const btVector3 startVelocity = body1->getVelocityInLocalPoint(m_point1);
+    const btVector3 endVelocity = body2->getVelocityInLocalPoint(m_point2);
+
+    // The ends move with the anchors through the sub-steps
+    const std::size_t last = m_x.size() - 1;
+    const std::size_t substeps = std::max(m_substeps,
+        static_cast<std::size_t>(std::ceil(dt * maxFrequency())));
+    const double h = dt / substeps;
+    m_impulse1 = btVector3(0.0, 0.0, 0.0);
+    m_impulse2 = btVector3(0.0, 0.0, 0.0);
+    for (std::size_t s = 0; s < substeps; s++)
+    {
+        const btVector3 first = start + startVelocity * (h * s);
+        const btVector3 second = end + endVelocity * (h * s);
+        m_x[0] = first.x();
+        m_y[0] = first.y();
+        m_z[0] = first.z();
+        m_x[last] = second.x();
+        m_y[last] = second.y();
+        m_z[last] = second.z();
+        m_vx[0] = startVelocity.x();
+        m_vy[0] = startVelocity.y();
+        m_vz[0] = startVelocity.z();
+        m_vx[last] = endVelocity.x();
+        m_vy[last] = endVelocity.y();
+        m_vz[last] = endVelocity.z();
+
+        substep(h, startVelocity, endVelocity);
+
+        // What the chain pulls on its ends with
+        m_impulse1 += btVector3(m_fx[0], m_fy[0], m_fz[0]) * h;
+        m_impulse2 += btVector3(m_fx[last], m_fy[last], m_fz[last]) * h;
+    }
+
+    const double currLength = getActualLength();
+    m_velocity = (currLength - m_prevLength) / dt;
+    m_damping = m_dampingCoefficient * m_velocity;
+    m_prevLength = currLength;
+
+    assert(invariant());
+}
+
+void tgCordeCable::applyForce()
+{
+    btRigidBody* const body1 = m_anchors[0]->attachedBody;
+    btRigidBody* const body2 = m_anchors[1]->attachedBody;
+    body1->activate();
+    body1->applyImpulse(m_impulse1, m_point1);
+    body2->activate();
+    body2->applyImpulse(m_impulse2, m_point2);
+}
+
+void tgCordeCable::substep(double h, const btVector3& startVelocity,
+                           const btVector3& endVelocity)
+{
+    const std::size_t n = m_x.size();
+    const std::size_t links = n - 1;
+
+    computeLinkForces();
+    computeAlignmentForces();
+    computeBendingTorques();
+
+    // Sum the per link forces onto the points. The ends keep only what
+    // their links pull with, which goes to the anchors' bodies.
+    m_fx[0] = m_lfx[0];
+    m_fy[0] = m_lfy[0];
+    m_fz[0] = m_lfz[0];
+    for (std::size_t i = 1; i < links; i++)
+    {
+        m_fx[i] = m_lfx[i] - m_lfx[i - 1] + m_afx[i - 1] - m_afx[i] +
+            m_pointMass * m_gravity.x();
+        m_fy[i] = m_lfy[i] - m_lfy[i - 1] + m_afy[i - 1] - m_afy[i] +
+            m_pointMass * m_gravity.y();
+        m_fz[i] = m_lfz[i] - m_lfz[i - 1] + m_afz[i - 1] - m_afz[i] +
+            m_pointMass * m_gravity.z();
+    }
+    m_fx[links] = -m_lfx[links - 1];
+    m_fy[links] = -m_lfy[links - 1];
+    m_fz[links] = -m_lfz[links - 1];
+
+    // And the bending from the next link onto the orientations
+    for (std::size_t i = 1; i < links; i++)
+    {
+        m_t0[i] += m_bt0[i - 1];
+        m_t1[i] += m_bt1[i - 1];
+        m_t2[i] += m_bt2[i - 1];
+        m_t3[i] += m_bt3[i - 1];
+    }
+
+    integratePoints(h, startVelocity, endVelocity);
+    integrateOrientations(h);
+}
+
+void tgCordeCable::computeLinkForces()
+{
+    const std::size_t links = m_x.size() - 1;
+    // Links in series: each one is this much stiffer than the cable
+    const double k = m_coefK * links;
+    const double c = m_dampingCoefficient * links;
+    const double rest = m_linkRestLength;
+
+    // Two links at a time where SSE2 is available
+    std::size_t i = 0;
+#ifdef __SSE2__
+    const __m128d vk = _mm_set1_pd(k);
+    const __m128d vc = _mm_set1_pd(c);
+    const __m128d vrest = _mm_set1_pd(rest);
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d signMask = _mm_set1_pd(-0.0);
+    for (; i + 2 <= links; i += 2)
+    {
+        const __m128d dx = _mm_sub_pd(_mm_loadu_pd(&m_x[i + 1]),
+                                      _mm_loadu_pd(&m_x[i]));
+        const __m128d dy = _mm_sub_pd(_mm_loadu_pd(&m_y[i + 1]),
+                                      _mm_loadu_pd(&m_y[i]));
+        const __m128d dz = _mm_sub_pd(_mm_loadu_pd(&m_z[i + 1]),
+                                      _mm_loadu_pd(&m_z[i]));
+        const __m128d dvx = _mm_sub_pd(_mm_loadu_pd(&m_vx[i + 1]),
+                                       _mm_loadu_pd(&m_vx[i]));
+        const __m128d dvy = _mm_sub_pd(_mm_loadu_pd(&m_vy[i + 1]),
+                                       _mm_loadu_pd(&m_vy[i]));
+        const __m128d dvz = _mm_sub_pd(_mm_loadu_pd(&m_vz[i + 1]),
+                                       _mm_loadu_pd(&m_vz[i]));
+
+        const __m128d length = _mm_sqrt_pd(
+            _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)),
+                       _mm_mul_pd(dz, dz)));
+        const __m128d inverse = _mm_div_pd(one, length);
+
+        __m128d magnitude = _mm_mul_pd(vk, _mm_sub_pd(length, vrest));
+        const __m128d velocity = _mm_mul_pd(inverse, _mm_add_pd(
+            _mm_add_pd(_mm_mul_pd(dvx, dx), _mm_mul_pd(dvy, dy)),
+            _mm_mul_pd(dvz, dz)));
+        __m128d damping = _mm_mul_pd(vc, velocity);
+
+        // Damping may not exceed the spring force
+        const __m128d exceeds = _mm_cmplt_pd(_mm_andnot_pd(signMask, magnitude),
+                                             _mm_andnot_pd(signMask, damping));
+        const __m128d positive = _mm_cmpgt_pd(damping, zero);
+        const __m128d limited =
+            _mm_or_pd(_mm_and_pd(positive, magnitude),
+                      _mm_andnot_pd(positive, _mm_xor_pd(magnitude, signMask)));
+        damping = _mm_or_pd(_mm_and_pd(exceeds, limited),
+                            _mm_andnot_pd(exceeds, damping));
+        magnitude = _mm_add_pd(magnitude, damping);
+
+        // Slack links push nothing
+        const __m128d taut = _mm_cmpgt_pd(length, vrest);
+        const __m128d scale = _mm_and_pd(taut, _mm_mul_pd(magnitude, inverse));
+        _mm_storeu_pd(&m_lfx[i], _mm_mul_pd(dx, scale));
+        _mm_storeu_pd(&m_lfy[i], _mm_mul_pd(dy, scale));
+        _mm_storeu_pd(&m_lfz[i], _mm_mul_pd(dz, scale));
+
+        // k along the link and tension / length across it
+        const __m128d across = _mm_and_pd(taut, _mm_mul_pd(
+            _mm_mul_pd(vk, _mm_sub_pd(length, vrest)), inverse));
+        const __m128d along = _mm_mul_pd(
+            _mm_and_pd(taut, _mm_sub_pd(vk, across)),
+            _mm_mul_pd(inverse, inverse));
+        _mm_storeu_pd(&m_kxx[i],
+                      _mm_add_pd(_mm_mul_pd(along, _mm_mul_pd(dx, dx)), across));
+        _mm_storeu_pd(&m_kxy[i], _mm_mul_pd(along, _mm_mul_pd(dx, dy)));
+        _mm_storeu_pd(&m_kxz[i], _mm_mul_pd(along, _mm_mul_pd(dx, dz)));
+        _mm_storeu_pd(&m_kyy[i],
+                      _mm_add_pd(_mm_mul_pd(along, _mm_mul_pd(dy, dy)), across));
+        _mm_storeu_pd(&m_kyz[i], _mm_mul_pd(along, _mm_mul_pd(dy, dz)));
+        _mm_storeu_pd(&m_kzz[i],
+                      _mm_add_pd(_mm_mul_pd(along, _mm_mul_pd(dz, dz)), across));
+    }
+#endif // __SSE2__
+    for (; i < links; i++)
+    {
+        const double dx = m_x[i + 1] - m_x[i];
+        const double dy = m_y[i + 1] - m_y[i];
+        const double dz = m_z[i + 1] - m_z[i];
+        const double length = std::sqrt(dx * dx + dy * dy + dz * dz);
+        const double inverse = 1.0 / length;
+        double magnitude = k * (length - rest);
+        const double velocity = ((m_vx[i + 1] - m_vx[i]) * dx +
+                                 (m_vy[i + 1] - m_vy[i]) * dy +
+                                 (m_vz[i + 1] - m_vz[i]) * dz) * inverse;
+        double damping = c * velocity;
+        if (std::fabs(magnitude) < std::fabs(damping))
+        {
+            damping = (damping > 0.0 ? magnitude : -magnitude);
+        }
+        magnitude += damping;
+        if (length > rest)
+        {
+            m_lfx[i] = dx * inverse * magnitude;
+            m_lfy[i] = dy * inverse * magnitude;
+            m_lfz[i] = dz * inverse * magnitude;
+
+            // k along the link and tension / length across it
+            const double across = k * (length - rest) * inverse;
+            const double along = (k - across) * inverse * inverse;
+            m_kxx[i] = along * dx * dx + across;
+            m_kxy[i] = along * dx * dy;
+            m_kxz[i] = along * dx * dz;
+            m_kyy[i] = along * dy * dy + across;
+            m_kyz[i] = along * dy * dz;
+            m_kzz[i] = along * dz * dz + across;
+        }
+        else
+        {
+            m_lfx[i] = 0.0;
+            m_lfy[i] = 0.0;
+            m_lfz[i] = 0.0;
+            m_kxx[i] = 0.0;
+            m_kxy[i] = 0.0;
+            m_kxz[i] = 0.0;
+            m_kyy[i] = 0.0;
+            m_kyz[i] = 0.0;
+            m_kzz[i] = 0.0;
+        }
+    }
+}
+
+/**
+ * The energy C l / 2 |d - e|^2 of each link, where d is the direction
+ * the orientation gives the link, e the unit vector along it and l its
+ * rest length. Also initializes the orientation forces.
+ */
+void tgCordeCable::computeAlignmentForces()
+{
+    const std::size_t links = m_x.size() - 1;
+    const double C = m_config.consSpringConst * m_linkRestLength;
+
+    // Only arithmetic on the arrays here, so the loop vectorizes
+    for (std::size_t i = 0; i < links; i++)
+    {
+        const double dx = m_x[i + 1] - m_x[i];
+        const double dy = m_y[i + 1] - m_y[i];
+        const double dz = m_z[i + 1] - m_z[i];
+        const double inverse = 1.0 / std::sqrt(dx * dx + dy * dy + dz * dz);
+        const double ex = dx * inverse;
+        const double ey = dy * inverse;
+        const double ez = dz * inverse;
+
+        const double q0 = m_q0[i];
+        const double q1 = m_q1[i];
+        const double q2 = m_q2[i];
+        const double q3 = m_q3[i];
+        const double d0 = 2.0 * (q0 * q2 + q1 * q3);
+        const double d1 = 2.0 * (q1 * q2 - q0 * q3);
+        const double d2 = -q0 * q0 - q1 * q1 + q2 * q2 + q3 * q3;
+
+        // Pulls the link towards the director, on its second point
+        const double along = ex * d0 + ey * d1 + ez * d2;
+        m_afx[i] = C * inverse * (d0 - ex * along);
+        m_afy[i] = C * inverse * (d1 - ey * along);
+        m_afz[i] = C * inverse * (d2 - ez * along);
+
+        // Turns the director towards the link
+        const double f0 = -2.0 * C * (d0 - ex);
+        const double f1 = -2.0 * C * (d1 - ey);
+        const double f2 = -2.0 * C * (d2 - ez);
+        m_t0[i] = q2 * f0 - q3 * f1 - q0 * f2;
+        m_t1[i] = q3 * f0 + q2 * f1 - q1 * f2;
+        m_t2[i] = q0 * f0 + q1 * f1 + q2 * f2;
+        m_t3[i] = q1 * f0 - q0 * f1 + q3 * f2;
+    }
+}
+
+/**
+ * The energy 2 / l sum K_k v_k^2 of each pair of consecutive
+ * orientations q and p, where v is the vector part of q* p, so 2 v / l
+ * is the Darboux vector of the pair, and the dissipation of the same
+ * form in the rate of v with gammaR. The straight cable is at rest.
+ */
+void tgCordeCable::computeBendingTorques()
+{
+    const std::size_t pairs = m_x.size() - 2;
+    const double scale = 4.0 / m_linkRestLength;
+    const double k1 = m_bendingStiffness[0];
+    const double k2 = m_bendingStiffness[1];
+    const double k3 = m_bendingStiffness[2];
+    const double gamma = m_config.gammaR;
+
+    // Only arithmetic on the arrays here, so the loop vectorizes
+    for (std::size_t i = 0; i < pairs; i++)
+    {
+        const double x = m_q0[i];
+        const double y = m_q1[i];
+        const double z = m_q2[i];
+        const double w = m_q3[i];
+        const double a = m_q0[i + 1];
+        const double b = m_q1[i + 1];
+        const double c = m_q2[i + 1];
+        const double d = m_q3[i + 1];
+
+        const double xd = m_qd0[i];
+        const double yd = m_qd1[i];
+        const double zd = m_qd2[i];
+        const double wd = m_qd3[i];
+        const double ad = m_qd0[i + 1];
+        const double bd = m_qd1[i + 1];
+        const double cd = m_qd2[i + 1];
+        const double dd = m_qd3[i + 1];
+
+        const double v1 = w * a - d * x - y * c + z * b;
+        const double v2 = w * b - d * y - z * a + x * c;
+        const double v3 = w * c - d * z - x * b + y * a;
+
+        const double v1d = -d * xd - c * yd + b * zd + a * wd +
+            w * ad + z * bd - y * cd - x * dd;
+        const double v2d = c * xd - d * yd - a * zd + b * wd -
+            z * ad + w * bd + x * cd - y * dd;
+        const double v3d = -b * xd + a * yd - d * zd + c * wd +
+            y * ad - x * bd + w * cd - z * dd;
+
+        const double g1 = scale * (k1 * v1 + gamma * v1d);
+        const double g2 = scale * (k2 * v2 + gamma * v2d);
+        const double g3 = scale * (k3 * v3 + gamma * v3d);
+
+        m_t0[i] -= -g1 * d + g2 * c - g3 * b;
+        m_t1[i] -= -g1 * c - g2 * d + g3 * a;
+        m_t2[i] -= g1 * b - g2 * a - g3 * d;
+        m_t3[i] -= g1 * a + g2 * b + g3 * c;
+
+        m_bt0[i] = -(g1 * w - g2 * z + g3 * y);
+        m_bt1[i] = -(g1 * z + g2 * w - g3 * x);
+        m_bt2[i] = -(-g1 * y + g2 * x + g3 * w);
+        m_bt3[i] = -(-g1 * x - g2 * y - g3 * z);
+    }
+}
+
+/**
+ * Solves (M + h^2 K) v' = M v + h f for the interior points, where K
+ * is the stiffness of the taut links, then moves them by h v'. The end
+ * velocities are known, so their columns move to the right hand side.
+ * The system is block tridiagonal: block Thomas algorithm, with the
+ * eliminated upper blocks in m_upper and the solution in place of the
+ * forces.
+ */
+void tgCordeCable::integratePoints(double h, const btVector3& startVelocity,
+                                   const btVector3& endVelocity)
+{
+    const std::size_t last = m_x.size() - 1;
+    const double h2 = h * h;
+    const double m = m_pointMass;
+
+    // Right hand sides, in place of the forces
+    for (std::size_t i = 1; i < last; i++)
+    {
+        m_fx[i] = m * m_vx[i] + h * m_fx[i];
+        m_fy[i] = m * m_vy[i] + h * m_fy[i];
+        m_fz[i] = m * m_vz[i] + h * m_fz[i];
+    }
+    double start[6];
+    double end[6];
+    linkStiffness(0, h2, start);
+    linkStiffness(last - 1, h2, end);
+    m_fx[1] += start[0] * startVelocity.x() + start[1] * startVelocity.y() +
+        start[2] * startVelocity.z();
+    m_fy[1] += start[1] * startVelocity.x() + start[3] * startVelocity.y() +
+        start[4] * startVelocity.z();
+    m_fz[1] += start[2] * startVelocity.x() + start[4] * startVelocity.y() +
+        start[5] * startVelocity.z();
+    m_fx[last - 1] += end[0] * endVelocity.x() + end[1] * endVelocity.y() +
+        end[2] * endVelocity.z();
+    m_fy[last - 1] += end[1] * endVelocity.x() + end[3] * endVelocity.y() +
+        end[4] * endVelocity.z();
+    m_fz[last - 1] += end[2] * endVelocity.x() + end[4] * endVelocity.y() +
+        end[5] * endVelocity.z();
+
+    // Forward: eliminate the lower blocks, h^2 K of the previous link
+    double before[6];
+    double after[6];
+    linkStiffness(0, h2, after);
+    for (std::size_t i = 1; i < last; i++)
+    {
+        for (std::size_t j = 0; j < 6; j++)
+        {
+            before[j] = after[j];
+        }
+        linkStiffness(i, h2, after);
+
+        // The pivot, less minus the lower block times the previous upper
+        double pivot[9] = {
+            m + before[0] + after[0], before[1] + after[1], before[2] + after[2],
+            before[1] + after[1], m + before[3] + after[3], before[4] + after[4],
+            before[2] + after[2], before[4] + after[4], m + before[5] + after[5]
+        };
+        if (i > 1)
+        {
+            const double* const u = &m_upper[9 * (i - 1)];
+            const double b[9] = {
+                before[0], before[1], before[2],
+                before[1], before[3], before[4],
+                before[2], before[4], before[5]
+            };
+            for (std::size_t r = 0; r < 3; r++)
+            {
+                for (std::size_t c = 0; c < 3; c++)
+                {
+                    pivot[3 * r + c] += b[3 * r] * u[c] +
+                        b[3 * r + 1] * u[3 + c] + b[3 * r + 2] * u[6 + c];
+                }
+            }
+            const double px = m_fx[i - 1];
+            const double py = m_fy[i - 1];
+            const double pz = m_fz[i - 1];
+            m_fx[i] += b[0] * px + b[1] * py + b[2] * pz;
+            m_fy[i] += b[3] * px + b[4] * py + b[5] * pz;
+            m_fz[i] += b[6] * px + b[7] * py + b[8] * pz;
+        }
+
+        double inverse[9];
+        invert(pivot, inverse);
+        const double rx = m_fx[i];
+        const double ry = m_fy[i];
+        const double rz = m_fz[i];
+        m_fx[i] = inverse[0] * rx + inverse[1] * ry + inverse[2] * rz;
+        m_fy[i] = inverse[3] * rx + inverse[4] * ry + inverse[5] * rz;
+        m_fz[i] = inverse[6] * rx + inverse[7] * ry + inverse[8] * rz;
+
+        // The upper block is minus h^2 K of the next link
+        double* const u = &m_upper[9 * i];
+        if (i + 1 < last)
+        {
+            const double a[9] = {
+                after[0], after[1], after[2],
+                after[1], after[3], after[4],
+                after[2], after[4], after[5]
+            };
+            for (std::size_t r = 0; r < 3; r++)
+            {
+                for (std::size_t c = 0; c < 3; c++)
+                {
+                    u[3 * r + c] = -(inverse[3 * r] * a[c] +
+                        inverse[3 * r + 1] * a[3 + c] +
+                        inverse[3 * r + 2] * a[6 + c]);
+                }
+            }
+        }
+        else
+        {
+            for (std::size_t j = 0; j < 9; j++)
+            {
+                u[j] = 0.0;
+            }
+        }
+    }
+
+    // Backward
+    for (std::size_t i = last - 1; i > 0; i--)
+    {
+        if (i + 1 < last)
+        {
+            const double* const u = &m_upper[9 * i];
+            const double nx = m_fx[i + 1];
+            const double ny = m_fy[i + 1];
+            const double nz = m_fz[i + 1];
+            m_fx[i] -= u[0] * nx + u[1] * ny + u[2] * nz;
+            m_fy[i] -= u[3] * nx + u[4] * ny + u[5] * nz;
+            m_fz[i] -= u[6] * nx + u[7] * ny + u[8] * nz;
+        }
+    }
+    for (std::size_t i = 1; i < last; i++)
+    {
+        m_vx[i] = m_fx[i];
+        m_vy[i] = m_fy[i];
+        m_vz[i] = m_fz[i];
+    }
+
+    for (std::size_t i = 0; i <= last; i++)
+    {
+        m_x[i] += h * m_vx[i];
+        m_y[i] += h * m_vy[i];
+        m_z[i] += h * m_vz[i];
+    }
+}
+
+void tgCordeCable::linkStiffness(std::size_t i, double scale,
+                                 double block[6]) const
+{
+    block[0] = scale * m_kxx[i];
+    block[1] = scale * m_kxy[i];
+    block[2] = scale * m_kxz[i];
+    block[3] = scale * m_kyy[i];
+    block[4] = scale * m_kyz[i];
+    block[5] = scale * m_kzz[i];
+}
+
+/**
+ * Euler's equations in each link's frame, whose z axis is the director,
+ * for the torques of the generalized forces on the orientations.
+ */
+void tgCordeCable::integrateOrientations(double h)
+{
+    const std::size_t links = m_q0.size();
+    const double i0 = m_inertia[0];
+    const double i1 = m_inertia[1];
+    const double i2 = m_inertia[2];
+
+    // Only arithmetic on the arrays here, so the loop vectorizes
+    for (std::size_t i = 0; i < links; i++)
+    {
+        const double x = m_q0[i];
+        const double y = m_q1[i];
+        const double z = m_q2[i];
+        const double w = m_q3[i];
+        const double t0 = m_t0[i];
+        const double t1 = m_t1[i];
+        const double t2 = m_t2[i];
+        const double t3 = m_t3[i];
+
+        const double ta = 0.5 * (w * t0 + z * t1 - y * t2 - x * t3);
+        const double tb = 0.5 * (-z * t0 + w * t1 + x * t2 - y * t3);
+        const double tc = 0.5 * (y * t0 - x * t1 + w * t2 - z * t3);
+
+        const double wa = m_wx[i];
+        const double wb = m_wy[i];
+        const double wc = m_wz[i];
+        const double a = wa + h * m_inverseInertia[0] *
+            (ta - (wb * i2 * wc - wc * i1 * wb));
+        const double b = wb + h * m_inverseInertia[1] *
+            (tb - (wc * i0 * wa - wa * i2 * wc));
+        const double c = wc + h * m_inverseInertia[2] *
+            (tc - (wa * i1 * wb - wb * i0 * wa));
+        m_wx[i] = a;
+        m_wy[i] = b;
+        m_wz[i] = c;
+
+        const double xd = 0.5 * (w * a + y * c - z * b);
+        const double yd = 0.5 * (w * b + z * a - x * c);
+        const double zd = 0.5 * (w * c + x * b - y * a);
+        const double wd = -0.5 * (x * a + y * b + z * c);
+        m_qd0[i] = xd;
+        m_qd1[i] = yd;
+        m_qd2[i] = zd;
+        m_qd3[i] = wd;
+
+        const double nx = x + h * xd;
+        const double ny = y + h * yd;
+        const double nz = z + h * zd;
+        const double nw = w + h * wd;
+        const double norm =
+            1.0 / std::sqrt(nx * nx + ny * ny + nz * nz + nw * nw);
+        m_q0[i] = nx * norm;
+        m_q1[i] = ny * norm;
+        m_q2[i] = nz * norm;
+        m_q3[i] = nw * norm;
+    }
+}
+
+/**
+ * Estimates the fastest mode of the explicit terms: the alignment
+ * springs across the points, and alignment and bending on the
+ * orientations. Semi-implicit Euler is stable below two for the step
+ * times this; ceil() of it leaves a margin of two.
+ */
+double tgCordeCable::maxFrequency() const
+{
+    const double transverse = 4.0 * m_config.consSpringConst /
+        (m_linkRestLength * m_pointMass);
+    const double rotational = 2.0 * (m_config.consSpringConst * m_linkRestLength +
+        4.0 * std::max(m_bendingStiffness[0], m_bendingStiffness[2]) /
+        m_linkRestLength) / m_inertia[0];
+    return std::sqrt(std::max(transverse, rotational));
+}
+
+void tgCordeCable::setRestLength(const double newRestLength)
+{
+    tgSpringCable::setRestLength(newRestLength);
+    m_linkRestLength = m_restLength / (m_x.size() - 1);
+}
+
+double tgCordeCable::linkTension(std::size_t i) const
+{
+    const double dx = m_x[i + 1] - m_x[i];
+    const double dy = m_y[i + 1] - m_y[i];
+    const double dz = m_z[i + 1] - m_z[i];
+    const double stretch =
+        std::sqrt(dx * dx + dy * dy + dz * dz) - m_linkRestLength;
+    return stretch > 0.0 ? m_coefK * (m_x.size() - 1) * stretch : 0.0;
+}
+
+const double tgCordeCable::getActualLength() const
+{
+    double length = 0.0;
+    for (std::size_t i = 0; i + 1 < m_x.size(); i++)
+    {
+        const double dx = m_x[i + 1] - m_x[i];
+        const double dy = m_y[i + 1] - m_y[i];
+        const double dz = m_z[i + 1] - m_z[i];
+        length += std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+    return length;
+}
+
+const double tgCordeCable::getTension() const
+{
+    return (linkTension(0) + linkTension(m_x.size() - 2)) / 2.0;
+}
+
+const std::vector<const tgSpringCableAnchor*> tgCordeCable::getAnchors() const
+{
+    return tgCast::constFilter<tgBulletSpringCableAnchor, const tgSpringCableAnchor>(m_anchors);
+}
+
+btVector3 tgCordeCable::getPoint(std::size_t i) const
+{
+    return btVector3(m_x.at(i), m_y.at(i), m_z.at(i));
+}
+
+btVector3 tgCordeCable::getDirector(std::size_t i) const
+{
+    const double q0 = m_q0.at(i);
+    const double q1 = m_q1[i];
+    const double q2 = m_q2[i];
+    const double q3 = m_q3[i];
+    return btVector3(2.0 * (q0 * q2 + q1 * q3),
+                     2.0 * (q1 * q2 - q0 * q3),
+                     -q0 * q0 - q1 * q1 + q2 * q2 + q3 * q3);
+}
+
+void tgCordeCable::setSubsteps(std::size_t substeps)
+{
+    if (substeps == 0)
+    {
+        throw std::invalid_argument("substeps is zero");
+    }
+    m_substeps = substeps;
+}
+
+void tgCordeCable::storeState(tgSnapshot& snapshot) const
+{
+    tgSpringCable::storeState(snapshot);
+    for (std::size_t i = 0; i < m_x.size(); i++)
+    {
+        snapshot.write(m_x[i]);
+        snapshot.write(m_y[i]);
+        snapshot.write(m_z[i]);
+        snapshot.write(m_vx[i]);
+        snapshot.write(m_vy[i]);
+        snapshot.write(m_vz[i]);
+    }
+    for (std::size_t i = 0; i < m_q0.size(); i++)
+    {
+        snapshot.write(m_q0[i]);
+        snapshot.write(m_q1[i]);
+        snapshot.write(m_q2[i]);
+        snapshot.write(m_q3[i]);
+        snapshot.write(m_qd0[i]);
+        snapshot.write(m_qd1[i]);
+        snapshot.write(m_qd2[i]);
+        snapshot.write(m_qd3[i]);
+        snapshot.write(m_wx[i]);
+        snapshot.write(m_wy[i]);
+        snapshot.write(m_wz[i]);
+    }
+}
+
+void tgCordeCable::restoreState(const tgSnapshot& snapshot)
+{
+    tgSpringCable::restoreState(snapshot);
+    m_linkRestLength = m_restLength / (m_x.size() - 1);
+    for (std::size_t i = 0; i < m_x.size(); i++)
+    {
+        m_x[i] = snapshot.read();
+        m_y[i] = snapshot.read();
+        m_z[i] = snapshot.read();
+        m_vx[i] = snapshot.read();
+        m_vy[i] = snapshot.read();
+        m_vz[i] = snapshot.read();
+    }
+    for (std::size_t i = 0; i < m_q0.size(); i++)
+    {
+        m_q0[i] = snapshot.read();
+        m_q1[i] = snapshot.read();
+        m_q2[i] = snapshot.read();
+        m_q3[i] = snapshot.read();
+        m_qd0[i] = snapshot.read();
+        m_qd1[i] = snapshot.read();
+        m_qd2[i] = snapshot.read();
+        m_qd3[i] = snapshot.read();
+        m_wx[i] = snapshot.read();
+        m_wy[i] = snapshot.read();
+        m_wz[i] = snapshot.read();
+    }
+}
+
+bool tgCordeCable::invariant() const
+{
+    const std::size_t n = m_x.size();
+    return (m_coefK > 0.0 &&
+            m_dampingCoefficient >= 0.0 &&
+            m_restLength >= 0.0 &&
+            m_anchors.size() == 2 &&
+            n >= 3 &&
+            m_y.size() == n && m_z.size() == n &&
+            m_q0.size() == n - 1 &&
+            m_substeps > 0);
+}
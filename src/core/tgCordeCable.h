@@ -0,0 +1,325 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef SRC_CORE_TG_CORDE_CABLE_H_
+#define SRC_CORE_TG_CORDE_CABLE_H_
+
+/**
+ * @file tgCordeCable.h
+ * @brief Definition of class tgCordeCable
+ * @author Brian Mirletz
+ * $Id$
+ */
+
+// This module
+#include "tgSpringCable.h"
+// The Bullet Physics library
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward references
+class tgBulletSpringCableAnchor;
+
+/**
+ * A spring cable with mass, bending and torsion, after the Corde model
+ * of Spillman and Teschner that dev/btietz/Corde prototypes. The cable
+ * is a chain of point masses between its two anchors, with an
+ * orientation quaternion on each link. The chain's stretch gives the
+ * cable its coefK and dampingCoefficient, so it behaves as a
+ * tgBulletSpringCable at rest but sags, swings and bends in between.
+ *
+ * The state is kept as structure-of-arrays, one array per coordinate,
+ * and each force is computed for all links in a loop of its own before
+ * being summed onto the points, so the kernels vectorize; the stretch
+ * kernel takes two links at a time with SSE2 as tgCableBank does. The
+ * links are the stiffest part, so the point velocities are found
+ * with a semi-implicit Euler step over the stretch Jacobian of the taut
+ * links, a block tridiagonal system with a 3x3 block per point that is
+ * solved in one sweep each way. The orientations are integrated
+ * explicitly, as in the prototype, so a step is divided into as many
+ * sub-steps as their stiffness needs to stay stable, or as
+ * setSubsteps() asks for if that is more.
+ *
+ * The end points follow the anchors and the force of the first and last
+ * links is applied to the anchors' bodies. A cable with contacts is
+ * not modeled; use tgBulletContactSpringCable for wrapping.
+ */
+class tgCordeCable : public tgSpringCable
+{
+public:
+
+    /** The material of the cable, other than its stretch */
+    struct Config
+    {
+        /**
+         * @param[in] resolution the number of point masses, both ends
+         * included; at least 3
+         * @param[in] radius must be positive
+         * @param[in] density must be positive
+         * @param[in] youngMod the bending modulus, must be non-negative
+         * @param[in] shearMod the torsion modulus, must be non-negative
+         * @param[in] consSpringConst the stiffness aligning the
+         * orientations with the links, must be non-negative
+         * @param[in] gammaR the rotational damping, must be non-negative
+         * @throw std::invalid_argument if a value is out of range
+         */
+        Config(std::size_t resolution = 10,
+               double radius = 0.01,
+               double density = 1300.0,
+               double youngMod = 0.5,
+               double shearMod = 0.5,
+               double consSpringConst = 100.0e3,
+               double gammaR = 1.0e-6);
+
+        std::size_t resolution;
+        double radius;
+        double density;
+        double youngMod;
+        double shearMod;
+        double consSpringConst;
+        double gammaR;
+    };
+
+    /**
+     * Lay the cable out straight between its anchors.
+     * @param[in] anchors the two anchors; owned from now on
+     * @param[in] coefK the stiffness of the whole cable, as for
+     * tgBulletSpringCable. Must be positive
+     * @param[in] dampingCoefficient the damping of the whole cable. Must
+     * be non-negative
+     * @param[in] pretension must be small enough to keep the rest length
+     * positive
+     * @param[in] config the material of the cable
+     * @param[in] gravity the acceleration of the point masses
+     * @throw std::invalid_argument if there aren't two anchors
+     */
+    tgCordeCable(const std::vector<tgBulletSpringCableAnchor*>& anchors,
+                 double coefK,
+                 double dampingCoefficient,
+                 double pretension,
+                 const Config& config,
+                 const btVector3& gravity = btVector3(0.0, 0.0, 0.0));
+
+    /** Deletes the anchors */
+    virtual ~tgCordeCable();
+
+    /**
+     * Advance the chain by dt and apply the force of the end links to
+     * the anchors' bodies.
+     * @param[in] dt must be positive
+     */
+    virtual void step(double dt);
+
+    /**
+     * First half of step(): advances the chain and stores the impulses
+     * for applyForce(). Only reads the state of the anchors' bodies, so
+     * different cables may be advanced concurrently.
+     * @param[in] dt must be positive
+     */
+    void calculateForce(double dt);
+
+    /**
+     * Second half of step(): applies the impulses stored by
+     * calculateForce() to the anchors' bodies. Writes to the bodies, so
+     * must not run concurrently with other cables on the same bodies.
+     */
+    void applyForce();
+
+    /** Also sets the rest length of each link */
+    virtual void setRestLength(const double newRestLength);
+
+    /** @return the length along the chain */
+    virtual const double getActualLength() const;
+
+    /**
+     * @return the stretch force of the end links, averaged, without
+     * damping or slack links' compression
+     */
+    virtual const double getTension() const;
+
+    virtual const std::vector<const tgSpringCableAnchor*> getAnchors() const;
+
+    /** Appends the points and orientations after the base class state */
+    virtual void storeState(tgSnapshot& snapshot) const;
+
+    virtual void restoreState(const tgSnapshot& snapshot);
+
+    /**
+     * @param[in] substeps the least number of sub-steps a step is divided
+     * into; more are taken if the bending and alignment need them. Must
+     * be positive
+     */
+    void setSubsteps(std::size_t substeps);
+
+    /** @return the least number of sub-steps per step */
+    std::size_t getSubsteps() const { return m_substeps; }
+
+    /** @return the number of point masses */
+    std::size_t getResolution() const { return m_x.size(); }
+
+    /**
+     * @param[in] i the point mass, from 0 at the first anchor
+     * @return its position
+     */
+    btVector3 getPoint(std::size_t i) const;
+
+    /**
+     * @param[in] i the link, from 0 at the first anchor
+     * @return the direction its orientation gives the link
+     */
+    btVector3 getDirector(std::size_t i) const;
+
+private:
+
+    /**
+     * Advance by one sub-step of length h, with the end points already
+     * placed. Leaves in the end points' forces what the chain pulls on
+     * the anchors with.
+     */
+    void substep(double h, const btVector3& startVelocity,
+                 const btVector3& endVelocity);
+
+    /**
+     * Stretch and damping of every link, into m_lfx, m_lfy and m_lfz,
+     * and the stretch Jacobian
+     */
+    void computeLinkForces();
+
+    /** Alignment of the orientations with the links */
+    void computeAlignmentForces();
+
+    /** Bending and torsion between consecutive orientations */
+    void computeBendingTorques();
+
+    /** Semi-implicit Euler for the interior point masses */
+    void integratePoints(double h, const btVector3& startVelocity,
+                         const btVector3& endVelocity);
+
+    /**
+     * @param[in] i the link
+     * @param[in] scale multiplies the stretch Jacobian
+     * @param[out] block xx, xy, xz, yy, yz and zz of the scaled Jacobian
+     */
+    void linkStiffness(std::size_t i, double scale, double block[6]) const;
+
+    /** Explicit Euler for the orientations */
+    void integrateOrientations(double h);
+
+    /** @return an upper bound on the angular frequency of the explicit terms */
+    double maxFrequency() const;
+
+    /** @return the stretch force of link i, zero if slack */
+    double linkTension(std::size_t i) const;
+
+    bool invariant() const;
+
+    std::vector<tgBulletSpringCableAnchor*> m_anchors;
+
+    const Config m_config;
+
+    const btVector3 m_gravity;
+
+    std::size_t m_substeps;
+
+    /** The impulses found by calculateForce(), applied at the anchors */
+    btVector3 m_impulse1;
+    btVector3 m_impulse2;
+
+    /** The anchors' positions relative to their bodies' centers of mass */
+    btVector3 m_point1;
+    btVector3 m_point2;
+
+    /** The rest length of every link */
+    double m_linkRestLength;
+
+    /** The mass of every point */
+    double m_pointMass;
+
+    /** Bending about the two normals, then torsion */
+    double m_bendingStiffness[3];
+
+    /** Diagonal inertia of the orientations, and its inverse */
+    double m_inertia[3];
+    double m_inverseInertia[3];
+
+    /** Per point: position, velocity and force */
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<double> m_z;
+    std::vector<double> m_vx;
+    std::vector<double> m_vy;
+    std::vector<double> m_vz;
+    std::vector<double> m_fx;
+    std::vector<double> m_fy;
+    std::vector<double> m_fz;
+
+    /** Per link: the orientation x, y, z, w and its rate */
+    std::vector<double> m_q0;
+    std::vector<double> m_q1;
+    std::vector<double> m_q2;
+    std::vector<double> m_q3;
+    std::vector<double> m_qd0;
+    std::vector<double> m_qd1;
+    std::vector<double> m_qd2;
+    std::vector<double> m_qd3;
+
+    /** Per link: angular velocity */
+    std::vector<double> m_wx;
+    std::vector<double> m_wy;
+    std::vector<double> m_wz;
+
+    /** Per link: the generalized force on the orientation */
+    std::vector<double> m_t0;
+    std::vector<double> m_t1;
+    std::vector<double> m_t2;
+    std::vector<double> m_t3;
+
+    /**
+     * Per link scratch: the force on its first point, which its second
+     * point gets negated
+     */
+    std::vector<double> m_lfx;
+    std::vector<double> m_lfy;
+    std::vector<double> m_lfz;
+
+    /** Per link scratch: the symmetric stretch Jacobian, for the solver */
+    std::vector<double> m_kxx;
+    std::vector<double> m_kxy;
+    std::vector<double> m_kxz;
+    std::vector<double> m_kyy;
+    std::vector<double> m_kyz;
+    std::vector<double> m_kzz;
+
+    /** Per link scratch: the alignment force on its second point */
+    std::vector<double> m_afx;
+    std::vector<double> m_afy;
+    std::vector<double> m_afz;
+
+    /** Per link scratch: the bending force from the next link */
+    std::vector<double> m_bt0;
+    std::vector<double> m_bt1;
+    std::vector<double> m_bt2;
+    std::vector<double> m_bt3;
+
+    /** Per point scratch: the eliminated upper blocks, row major */
+    std::vector<double> m_upper;
+};
+
+#endif  // SRC_CORE_TG_CORDE_CABLE_H_
@@ -0,0 +1,135 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgCordeCableSolver.cpp
+ * @brief Contains the definitions of members of class tgCordeCableSolver
+ * $Id$
+ */
+
+// This module
+#include "tgCordeCableSolver.h"
+// This application
+#include "tgCast.h"
+#include "tgCordeCable.h"
+#include "tgModel.h"
+#include "tgPerfCounters.h"
+#include "tgSpringCableActuator.h"
+// The Bullet Physics library
+#include "LinearMath/btQuickprof.h"
+// The C++ Standard Library
+#include <cassert>
+#include <stdexcept>
+
+class tgCordeCableSolver::CalculateTask : public tgThreadPool::Task
+{
+public:
+    CalculateTask(std::vector<tgCordeCable*>& cables, double dt) :
+        m_cables(cables),
+        m_dt(dt)
+    {
+    }
+
+    virtual void operator()(std::size_t item)
+    {
+        const tgPerfCounters::Scope counters("tgCordeCableSolver::calculate");
+        m_cables[item]->calculateForce(m_dt);
+    }
+
+private:
+    std::vector<tgCordeCable*>& m_cables;
+    const double m_dt;
+};
+
+tgCordeCableSolver::tgCordeCableSolver(std::size_t nThreads) :
+    m_pool(nThreads)
+{
+}
+
+tgCordeCableSolver::~tgCordeCableSolver()
+{
+    release();
+}
+
+void tgCordeCableSolver::add(tgModel& model)
+{
+    std::vector<tgModel*> models = model.getDescendants();
+    models.push_back(&model);
+    for (std::size_t i = 0; i < models.size(); ++i)
+    {
+        tgSpringCableActuator* const pActuator =
+            tgCast::cast<tgModel, tgSpringCableActuator>(models[i]);
+        if (pActuator && !pActuator->cableForcesDeferred() &&
+            pActuator->deferCableForces(true))
+        {
+            tgCordeCable* const pCable = pActuator->getDeferredCordeCable();
+            if (pCable == NULL)
+            {
+                // Other cables are left to their own passes
+                pActuator->deferCableForces(false);
+                continue;
+            }
+            m_actuators.push_back(pActuator);
+            m_cables.push_back(pCable);
+        }
+    }
+}
+
+void tgCordeCableSolver::release()
+{
+    for (std::size_t i = 0; i < m_actuators.size(); ++i)
+    {
+        m_actuators[i]->deferCableForces(false);
+    }
+    m_actuators.clear();
+    m_cables.clear();
+}
+
+void tgCordeCableSolver::step(double dt)
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("tgCordeCableSolver::step");
+#endif //BT_NO_PROFILE
+    if (dt <= 0.0)
+    {
+        throw std::invalid_argument("dt is not positive");
+    }
+
+    const std::size_t n = m_cables.size();
+    assert(m_actuators.size() == n);
+    if (n == 0)
+    {
+        return;
+    }
+    const tgPerfCounters::Scope counters("tgCordeCableSolver::step", n);
+
+    // A Corde cable is costly enough to be an item of its own, and the
+    // pool keeps each one on the same worker from step to step
+    CalculateTask task(m_cables, dt);
+    m_pool.run(task, n);
+
+    // Bodies are shared between cables, so apply in order on this thread
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        m_cables[i]->applyForce();
+    }
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        m_actuators[i]->finishDeferredStep(dt);
+    }
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_CORDE_CABLE_SOLVER_H
+#define TG_CORDE_CABLE_SOLVER_H
+
+/**
+ * @file tgCordeCableSolver.h
+ * @brief Contains the definition of class tgCordeCableSolver
+ * $Id$
+ */
+
+// This application
+#include "tgThreadPool.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class tgCordeCable;
+class tgModel;
+class tgSpringCableActuator;
+
+/**
+ * Advances the tgCordeCables of many actuators at the same time after
+ * the models have stepped. A Corde cable only couples to the rest of
+ * the world through the bodies of its two anchors, which it reads but
+ * does not write while advancing, so each cable is advanced on a
+ * tgThreadPool, one cable per item, and the impulses on the anchors are
+ * then applied serially in a fixed order. The results match serial
+ * stepping, except that controllers reading another actuator's tension
+ * during the model step see the value from the previous step.
+ * Used by tgSimulation::enableParallelCordeCables().
+ */
+class tgCordeCableSolver
+{
+public:
+
+    /**
+     * Construct an empty solver.
+     * @param[in] nThreads the number of threads advancing cables; 0
+     * selects one per core
+     */
+    tgCordeCableSolver(std::size_t nThreads = 0);
+
+    /** Hands the cables back to any actuators still collected. */
+    ~tgCordeCableSolver();
+
+    /**
+     * Take over the Corde cables of a model and every actuator below it
+     * whose cable is a tgCordeCable. Actuators already deferred, such as
+     * to a tgCableForcePass, are left alone.
+     * @param[in,out] model a model that has been set up
+     */
+    void add(tgModel& model);
+
+    /**
+     * Hand every cable back to its actuator and forget them. Must be
+     * called before the actuators are torn down.
+     */
+    void release();
+
+    /**
+     * Advance every collected cable, then apply and finish them.
+     * @param[in] dt the step size; must be positive
+     */
+    void step(double dt);
+
+    /** Return the number of collected actuators. */
+    std::size_t size() const
+    {
+        return m_actuators.size();
+    }
+
+private:
+
+    /** Advances one collected cable. */
+    class CalculateTask;
+
+    /** The threads that advance the cables. */
+    tgThreadPool m_pool;
+
+    /**
+     * The actuators whose cables this solver advances, in the order they
+     * were added. Not owned.
+     */
+    std::vector<tgSpringCableActuator*> m_actuators;
+
+    /** The cable of each actuator, in the same order. Not owned. */
+    std::vector<tgCordeCable*> m_cables;
+};
+
+#endif  // TG_CORDE_CABLE_SOLVER_H
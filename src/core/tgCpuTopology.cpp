@@ -0,0 +1,258 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgCpuTopology.cpp
+ * @brief Contains the definitions of members of class tgCpuTopology
+ * $Id$
+ */
+
+// This module
+#include "tgCpuTopology.h"
+// The Boost library
+#include <boost/thread/thread.hpp>
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#ifdef __linux__
+// POSIX
+#include <sched.h>
+#endif
+
+namespace
+{
+    const char* const nodeDirectory = "/sys/devices/system/node/";
+
+    /** @return the first line of a file, or "" if it can't be read */
+    std::string readLine(const std::string& path)
+    {
+        std::ifstream in(path.c_str());
+        std::string line;
+        std::getline(in, line);
+        return line;
+    }
+
+    /** @return the CPUs this process may run on, or none if unknown */
+    std::vector<int> allowedCpus()
+    {
+        std::vector<int> cpus;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0)
+        {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            {
+                if (CPU_ISSET(cpu, &set))
+                {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+#endif
+        return cpus;
+    }
+
+    /** @return the CPUs of each node, empty if the nodes can't be read */
+    std::vector<std::vector<int> > readNodes(const std::vector<int>& allowed)
+    {
+        std::vector<std::vector<int> > nodes;
+        try
+        {
+            const std::vector<int> online =
+                tgCpuTopology::parseList(readLine(std::string(nodeDirectory) +
+                                                  "online"));
+            for (std::size_t i = 0; i < online.size(); ++i)
+            {
+                std::ostringstream path;
+                path << nodeDirectory << "node" << online[i] << "/cpulist";
+                // A node of memory alone lists no CPUs
+                const std::string list = readLine(path.str());
+                const std::vector<int> cpus = list.empty() ?
+                    std::vector<int>() : tgCpuTopology::parseList(list);
+                std::vector<int> usable;
+                for (std::size_t j = 0; j < cpus.size(); ++j)
+                {
+                    if (allowed.empty() ||
+                        std::binary_search(allowed.begin(), allowed.end(),
+                                           cpus[j]))
+                    {
+                        usable.push_back(cpus[j]);
+                    }
+                }
+                nodes.push_back(usable);
+            }
+        }
+        catch (const std::invalid_argument&)
+        {
+            // Not Linux, or no sysfs; the caller falls back to one node
+            nodes.clear();
+        }
+        return nodes;
+    }
+
+    /** @return the nodes that have CPUs */
+    std::vector<std::vector<int> >
+    withCpus(const std::vector<std::vector<int> >& nodes)
+    {
+        std::vector<std::vector<int> > result;
+        for (std::size_t i = 0; i < nodes.size(); ++i)
+        {
+            if (!nodes[i].empty())
+            {
+                result.push_back(nodes[i]);
+                std::sort(result.back().begin(), result.back().end());
+            }
+        }
+        return result;
+    }
+}
+
+tgCpuTopology::tgCpuTopology()
+{
+    const std::vector<int> allowed = allowedCpus();
+    m_nodes = withCpus(readNodes(allowed));
+    if (m_nodes.empty())
+    {
+        std::vector<int> cpus = allowed;
+        if (cpus.empty())
+        {
+            const int n =
+                std::max(1, static_cast<int>(boost::thread::hardware_concurrency()));
+            for (int cpu = 0; cpu < n; ++cpu)
+            {
+                cpus.push_back(cpu);
+            }
+        }
+        m_nodes.push_back(cpus);
+    }
+
+    // Postcondition
+    assert(invariant());
+}
+
+tgCpuTopology::tgCpuTopology(const std::vector<std::vector<int> >& nodes) :
+    m_nodes(withCpus(nodes))
+{
+    if (m_nodes.empty())
+    {
+        throw std::invalid_argument("No node has a CPU");
+    }
+
+    // Postcondition
+    assert(invariant());
+}
+
+const std::vector<int>& tgCpuTopology::cpus(std::size_t node) const
+{
+    if (node >= m_nodes.size())
+    {
+        throw std::out_of_range("node index is out of range");
+    }
+    return m_nodes[node];
+}
+
+std::size_t tgCpuTopology::size() const
+{
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < m_nodes.size(); ++i)
+    {
+        n += m_nodes[i].size();
+    }
+    return n;
+}
+
+std::size_t tgCpuTopology::nodeOf(std::size_t worker) const
+{
+    return worker % m_nodes.size();
+}
+
+int tgCpuTopology::cpuOf(std::size_t worker) const
+{
+    const std::vector<int>& cpus = m_nodes[nodeOf(worker)];
+    return cpus[(worker / m_nodes.size()) % cpus.size()];
+}
+
+std::vector<int> tgCpuTopology::parseList(const std::string& list)
+{
+    std::vector<int> cpus;
+    std::istringstream in(list);
+    std::string range;
+    while (std::getline(in, range, ','))
+    {
+        const char* const begin = range.c_str();
+        char* end = NULL;
+        const long first = std::strtol(begin, &end, 10);
+        long last = first;
+        if (*end == '-')
+        {
+            const char* const second = end + 1;
+            last = std::strtol(second, &end, 10);
+            if (end == second)
+            {
+                throw std::invalid_argument("Malformed CPU list: " + list);
+            }
+        }
+        if (end == begin || *end != '\0' || first < 0 || last < first)
+        {
+            throw std::invalid_argument("Malformed CPU list: " + list);
+        }
+        for (long cpu = first; cpu <= last; ++cpu)
+        {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+    }
+    if (cpus.empty())
+    {
+        throw std::invalid_argument("Empty CPU list");
+    }
+    return cpus;
+}
+
+bool tgCpuTopology::pin(int cpu)
+{
+#ifdef __linux__
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+    {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    // On Linux, pid 0 is the calling thread rather than the process
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+bool tgCpuTopology::invariant() const
+{
+    for (std::size_t i = 0; i < m_nodes.size(); ++i)
+    {
+        if (m_nodes[i].empty())
+        {
+            return false;
+        }
+    }
+    return !m_nodes.empty();
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_CPU_TOPOLOGY_H
+#define TG_CPU_TOPOLOGY_H
+
+/**
+ * @file tgCpuTopology.h
+ * @brief Contains the definition of class tgCpuTopology
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * The CPUs this process may run on, grouped by NUMA node, and the
+ * placement of pinned workers on them. On Linux the nodes are read from
+ * /sys/devices/system/node; elsewhere, or if that can't be read, every
+ * CPU belongs to node 0 and threads can't be pinned.
+ *
+ * Worker w goes to node w modulo the number of nodes, on that node's
+ * CPUs in turn, so a pool smaller than the machine uses the memory of
+ * every socket. Memory is placed on the node of the thread that first
+ * touches it, so what a pinned worker allocates and writes first stays
+ * local to it.
+ */
+class tgCpuTopology
+{
+public:
+
+    /** Read the topology of this machine. */
+    tgCpuTopology();
+
+    /**
+     * @param[in] nodes the CPUs of each node; nodes without CPUs are
+     * dropped
+     * @throw std::invalid_argument if no node has a CPU
+     */
+    explicit tgCpuTopology(const std::vector<std::vector<int> >& nodes);
+
+    /** @return the number of nodes with CPUs, positive */
+    std::size_t nodes() const { return m_nodes.size(); }
+
+    /**
+     * @return the CPUs of a node, in increasing order
+     * @throw std::out_of_range if node is not less than nodes()
+     */
+    const std::vector<int>& cpus(std::size_t node) const;
+
+    /** @return the number of CPUs of every node */
+    std::size_t size() const;
+
+    /** @return the node of a worker, see the class comment */
+    std::size_t nodeOf(std::size_t worker) const;
+
+    /** @return the CPU of a worker, see the class comment */
+    int cpuOf(std::size_t worker) const;
+
+    /**
+     * Parse a kernel CPU list, such as "0-3,8,10-11".
+     * @throw std::invalid_argument if the list is malformed
+     */
+    static std::vector<int> parseList(const std::string& list);
+
+    /**
+     * Restrict the calling thread to one CPU.
+     * @return false if that is not supported or was refused
+     */
+    static bool pin(int cpu);
+
+private:
+
+    /** Integrity predicate. */
+    bool invariant() const;
+
+private:
+
+    /** The CPUs of each node. None is empty. */
+    std::vector<std::vector<int> > m_nodes;
+};
+
+#endif  // TG_CPU_TOPOLOGY_H
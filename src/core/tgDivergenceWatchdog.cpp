@@ -0,0 +1,130 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgDivergenceWatchdog.cpp
+ * @brief Contains the definitions of members of class tgDivergenceWatchdog
+ * $Id$
+ */
+
+// This module
+#include "tgDivergenceWatchdog.h"
+// This application
+#include "tgRigidPoseBatch.h"
+// The C++ Standard Library
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+    /** False for NaN as well as for the infinities */
+    bool isFinite(double x)
+    {
+        return std::fabs(x) <= std::numeric_limits<double>::max();
+    }
+
+    bool isFinite(const btVector3& v)
+    {
+        return isFinite(v.x()) && isFinite(v.y()) && isFinite(v.z());
+    }
+
+    /**
+     * @return true if squared is more than bound squared; a bound of zero
+     * is none
+     */
+    bool exceeds(double squared, double bound)
+    {
+        return bound > 0.0 && squared > bound * bound;
+    }
+}
+
+tgDivergenceWatchdog::Config::Config(double speed, double angularSpeed,
+                                     double kineticEnergy) :
+    maxSpeed(speed),
+    maxAngularSpeed(angularSpeed),
+    maxKineticEnergy(kineticEnergy)
+{
+}
+
+tgDivergenceWatchdog::tgDivergenceWatchdog(const Config& config) :
+    m_config(config)
+{
+    if (config.maxSpeed < 0.0 || config.maxAngularSpeed < 0.0 ||
+        config.maxKineticEnergy < 0.0)
+    {
+        throw std::invalid_argument("Watchdog bound is negative");
+    }
+}
+
+tgDivergenceWatchdog::Failure
+tgDivergenceWatchdog::check(const tgRigidPoseBatch& poses) const
+{
+    double energy = 0.0;
+    Failure bounded = eNone;
+    for (std::size_t i = 0; i < poses.size(); i++)
+    {
+        const btVector3 v = poses.linearVelocity(i);
+        const btVector3 w = poses.angularVelocity(i);
+        const btQuaternion q = poses.orientation(i);
+        if (!isFinite(poses.position(i)) || !isFinite(v) || !isFinite(w) ||
+            !isFinite(q.x()) || !isFinite(q.y()) || !isFinite(q.z()) ||
+            !isFinite(q.w()))
+        {
+            // Reported over any bound, which it usually follows
+            return eNotFinite;
+        }
+        const double v2 = v.length2();
+        if (bounded == eNone)
+        {
+            if (exceeds(v2, m_config.maxSpeed))
+            {
+                bounded = eSpeed;
+            }
+            else if (exceeds(w.length2(), m_config.maxAngularSpeed))
+            {
+                bounded = eAngularSpeed;
+            }
+        }
+        energy += 0.5 * poses.mass(i) * v2;
+    }
+    if (bounded == eNone && m_config.maxKineticEnergy > 0.0 &&
+        energy > m_config.maxKineticEnergy)
+    {
+        bounded = eEnergy;
+    }
+    return bounded;
+}
+
+const char* tgDivergenceWatchdog::name(Failure failure)
+{
+    switch (failure)
+    {
+    case eNone:
+        return "none";
+    case eNotFinite:
+        return "not finite";
+    case eSpeed:
+        return "speed";
+    case eAngularSpeed:
+        return "angular speed";
+    case eEnergy:
+        return "energy";
+    }
+    return "unknown";
+}
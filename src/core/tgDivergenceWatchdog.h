@@ -0,0 +1,96 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_DIVERGENCE_WATCHDOG_H
+#define TG_DIVERGENCE_WATCHDOG_H
+
+/**
+ * @file tgDivergenceWatchdog.h
+ * @brief Contains the definition of class tgDivergenceWatchdog
+ * $Id$
+ */
+
+// Forward declarations
+class tgRigidPoseBatch;
+
+/**
+ * Decides whether a model's bodies have diverged, from the poses its
+ * tgStateFrame read this step: whether any position, orientation or
+ * velocity is not finite, whether a body moves or spins faster than a
+ * bound, or whether the linear kinetic energy of all the bodies exceeds
+ * one. A controller that drives a model unstable is then stopped within
+ * a step instead of running to the end of its trial, or into the late
+ * exceptions of the contact cables once NaN reaches their anchors.
+ *
+ * A check is one pass over the frame's contiguous buffers, so it is
+ * cheap next to the step itself. See tgSimulation::enableWatchdog().
+ */
+class tgDivergenceWatchdog
+{
+public:
+
+    /** Why a model failed, in the order they are checked */
+    enum Failure
+    {
+        eNone = 0,
+        eNotFinite,
+        eSpeed,
+        eAngularSpeed,
+        eEnergy
+    };
+
+    /** The bounds; a bound of zero is not checked */
+    struct Config
+    {
+        /**
+         * @param[in] speed the largest speed of any body's center of mass
+         * @param[in] angularSpeed the largest angular speed of any body
+         * @param[in] kineticEnergy the largest 1/2 m v^2 of all the
+         * bodies of a model together
+         */
+        Config(double speed = 1000.0, double angularSpeed = 1000.0,
+               double kineticEnergy = 0.0);
+
+        double maxSpeed;
+        double maxAngularSpeed;
+        double maxKineticEnergy;
+    };
+
+    /**
+     * @param[in] config the bounds
+     * @throw std::invalid_argument if a bound is negative
+     */
+    explicit tgDivergenceWatchdog(const Config& config = Config());
+
+    const Config& getConfig() const { return m_config; }
+
+    /**
+     * @param[in] poses the bodies of one model
+     * @return the first bound they break, or eNone
+     */
+    Failure check(const tgRigidPoseBatch& poses) const;
+
+    /** @return a short lower case name of a failure, for logs */
+    static const char* name(Failure failure);
+
+private:
+
+    Config m_config;
+};
+
+#endif  // TG_DIVERGENCE_WATCHDOG_H
@@ -0,0 +1,166 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgGhostFilter.cpp
+ * @brief Contains the definitions of members of class tgGhostFilter
+ * $Id$
+ */
+
+// This module
+#include "tgGhostFilter.h"
+// The Bullet Physics library
+#include "BulletCollision/BroadphaseCollision/btBroadphaseInterface.h"
+#include "BulletCollision/BroadphaseCollision/btBroadphaseProxy.h"
+#include "BulletCollision/BroadphaseCollision/btOverlappingPairCache.h"
+#include "BulletCollision/CollisionDispatch/btGhostObject.h"
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+// The C++ Standard Library
+#include <cassert>
+#include <stdexcept>
+
+namespace
+{
+    /** @return true if a muscle ghost has any use for touching proxy */
+    bool isTouchable(const btBroadphaseProxy* proxy)
+    {
+        const btCollisionObject* const object =
+            static_cast<const btCollisionObject*>(proxy->m_clientObject);
+        const btRigidBody* const body = btRigidBody::upcast(object);
+        return body != NULL && body->hasContactResponse();
+    }
+
+    /**
+     * Keeps the pair lists of ghost objects. It has no state of its own,
+     * so every world with ghosts shares it.
+     */
+    btGhostPairCallback ghostPairCallback;
+
+    /** The last family handed out by tgGhostFilter::newFamily() */
+    int lastFamily = 0;
+}
+
+bool tgGhostFilter::needBroadphaseCollision(btBroadphaseProxy* proxy0,
+                                            btBroadphaseProxy* proxy1) const
+{
+    // The test Bullet makes without a filter
+    if ((proxy0->m_collisionFilterGroup & proxy1->m_collisionFilterMask) == 0 ||
+        (proxy1->m_collisionFilterGroup & proxy0->m_collisionFilterMask) == 0)
+    {
+        return false;
+    }
+
+    const int family = tgGhostFilter::getFamily(
+        static_cast<const btCollisionObject*>(proxy0->m_clientObject));
+    if (family != 0 &&
+        family == tgGhostFilter::getFamily(
+            static_cast<const btCollisionObject*>(proxy1->m_clientObject)))
+    {
+        return false;
+    }
+
+    // The mask keeps ghosts from pairing with each other
+    if (proxy0->m_collisionFilterGroup & ghostGroup)
+    {
+        return isTouchable(proxy1);
+    }
+    else if (proxy1->m_collisionFilterGroup & ghostGroup)
+    {
+        return isTouchable(proxy0);
+    }
+    return true;
+}
+
+void tgGhostFilter::addGhost(btDynamicsWorld& dynamicsWorld,
+                             btCollisionObject* ghost)
+{
+    if (ghost == NULL)
+    {
+        throw std::invalid_argument("Pointer to ghost is NULL");
+    }
+    // Only worlds with ghosts pay for the callback. Setting it again is a
+    // pointer store, and pairs cached before the first ghost involve none.
+    dynamicsWorld.getBroadphase()->getOverlappingPairCache()->
+        setInternalGhostPairCallback(&ghostPairCallback);
+    dynamicsWorld.addCollisionObject(ghost, ghostGroup, ghostMask);
+}
+
+void tgGhostFilter::setGhostContact(btDynamicsWorld& dynamicsWorld,
+                                    btCollisionObject* body,
+                                    bool enabled)
+{
+    if (body == NULL)
+    {
+        throw std::invalid_argument("Pointer to body is NULL");
+    }
+    btBroadphaseProxy* const proxy = body->getBroadphaseHandle();
+    if (proxy == NULL)
+    {
+        throw std::invalid_argument("Body is not in a world");
+    }
+
+    const short mask = enabled ?
+        proxy->m_collisionFilterMask | ghostGroup :
+        proxy->m_collisionFilterMask & ~ghostGroup;
+    if (mask != proxy->m_collisionFilterMask)
+    {
+        proxy->m_collisionFilterMask = mask;
+        // Also takes the pairs out of the ghosts' own caches
+        dynamicsWorld.getBroadphase()->getOverlappingPairCache()->
+            removeOverlappingPairsContainingProxy(proxy,
+                                                  dynamicsWorld.getDispatcher());
+    }
+}
+
+int tgGhostFilter::newFamily()
+{
+    return ++lastFamily;
+}
+
+void tgGhostFilter::setFamily(btDynamicsWorld& dynamicsWorld,
+                              btCollisionObject* body,
+                              int family)
+{
+    if (body == NULL)
+    {
+        throw std::invalid_argument("Pointer to body is NULL");
+    }
+    else if (family < 0)
+    {
+        throw std::invalid_argument("Family is negative");
+    }
+    body->setUserIndex(family);
+
+    // Not in the world yet, as during a bulk insertion
+    btBroadphaseProxy* const proxy = body->getBroadphaseHandle();
+    if (proxy != NULL)
+    {
+        dynamicsWorld.getBroadphase()->getOverlappingPairCache()->
+            removeOverlappingPairsContainingProxy(proxy,
+                                                  dynamicsWorld.getDispatcher());
+    }
+}
+
+int tgGhostFilter::getFamily(const btCollisionObject* body)
+{
+    assert(body != NULL);
+    // Bullet's default user index is -1
+    const int family = body->getUserIndex();
+    return family > 0 ? family : 0;
+}
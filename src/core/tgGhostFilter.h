@@ -0,0 +1,111 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_GHOST_FILTER_H
+#define TG_GHOST_FILTER_H
+
+/**
+ * @file tgGhostFilter.h
+ * @brief Contains the definition of class tgGhostFilter
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "BulletCollision/BroadphaseCollision/btOverlappingPairCache.h"
+
+// Forward declarations
+class btBroadphaseProxy;
+class btCollisionObject;
+class btDynamicsWorld;
+
+/**
+ * The broadphase filter of the world, which keeps the overlaps of muscle
+ * ghosts, such as those of tgBulletContactSpringCable and tgGhostInfo,
+ * to the pairs a muscle can touch. Muscle ghosts are added with
+ * addGhost() to a filter group of their own, outside the ones Bullet
+ * defines, whose mask only holds the default and static groups. Besides
+ * the usual group and mask test, a pair with a ghost is only kept if the
+ * other object is a rigid body with contact response, since only those
+ * become anchors. Bodies that a muscle should never touch, such as the
+ * rods of its own robot that it lies along, leave the pair cache
+ * entirely with setGhostContact().
+ *
+ * The filter also keeps bodies of the same family, the rigids of a
+ * robot built without self collision, from pairing with each other.
+ * The family is kept in the user index of the collision object.
+ */
+class tgGhostFilter : public btOverlapFilterCallback
+{
+public:
+
+    /** The filter group of muscle ghosts */
+    static const short ghostGroup = 0x40;
+
+    /** What muscle ghosts pair with */
+    static const short ghostMask =
+        btBroadphaseProxy::DefaultFilter | btBroadphaseProxy::StaticFilter;
+
+    /**
+     * @return true if the pair is to be cached and sent to the
+     * narrowphase
+     */
+    virtual bool needBroadphaseCollision(btBroadphaseProxy* proxy0,
+                                         btBroadphaseProxy* proxy1) const;
+
+    /**
+     * Add a muscle ghost to the world, in ghostGroup with ghostMask.
+     * The first ghost of a world installs the btGhostPairCallback that
+     * keeps ghosts' pair lists, which worlds without ghosts never pay for.
+     * The world owns it from now on.
+     * @param[in,out] dynamicsWorld the world
+     * @param[in] ghost the ghost object, not yet in a world
+     */
+    static void addGhost(btDynamicsWorld& dynamicsWorld,
+                         btCollisionObject* ghost);
+
+    /**
+     * Let muscle ghosts pair with a body, or stop them. Cached pairs of
+     * the body are dropped, and those still allowed come back the next
+     * time the broadphase finds them.
+     * @param[in,out] dynamicsWorld the world the body is in
+     * @param[in,out] body a body that has been added to the world
+     * @param[in] enabled false to keep muscles from ever touching it
+     */
+    static void setGhostContact(btDynamicsWorld& dynamicsWorld,
+                                btCollisionObject* body,
+                                bool enabled);
+
+    /** @return a family no body is in yet */
+    static int newFamily();
+
+    /**
+     * Put a body in a family, whose bodies never pair with each other.
+     * Cached pairs of the body are dropped if it is already in the world.
+     * @param[in,out] dynamicsWorld the world the body is or will be in
+     * @param[in,out] body the body
+     * @param[in] family from newFamily(), or 0 for none
+     */
+    static void setFamily(btDynamicsWorld& dynamicsWorld,
+                          btCollisionObject* body,
+                          int family);
+
+    /** @return the family of a body, or 0 if it is in none */
+    static int getFamily(const btCollisionObject* body);
+};
+
+#endif  // TG_GHOST_FILTER_H
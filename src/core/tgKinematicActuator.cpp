@@ -28,6 +28,7 @@
 // The NTRT Core libary
 #include "core/tgBulletSpringCable.h"
 #include "core/tgModelVisitor.h"
+#include "core/tgSnapshot.h"
 #include "core/tgWorld.h"
 // The Bullet Physics Library
 #include "LinearMath/btQuickprof.h"
@@ -37,6 +38,7 @@
 #include <deque> // For history
 #include <iostream>
 #include <stdexcept>
+#include <typeinfo>
 
 using namespace std;
 
@@ -60,7 +62,8 @@ tgKinematicActuator::Config::Config(double s,
   motorInertia(moInert),
   backdrivable(back),
   maxOmega(tVel / rad),
-  maxTorque(mf / rad)
+  maxTorque(mf / rad),
+  batchMotor(false)
 {
 	if (rad <= 0.0)
     {
@@ -95,7 +98,8 @@ void tgKinematicActuator::constructorAux()
     }
     else
     {
-        logHistory();
+        // Seed the history with the values at construction
+        logHistory(0.0);
     }
 }
 tgKinematicActuator::tgKinematicActuator(tgBulletSpringCable* muscle,
@@ -104,6 +108,7 @@ tgKinematicActuator::tgKinematicActuator(tgBulletSpringCable* muscle,
     m_motorVel(0.0),
     m_motorAcc(0.0),
     m_appliedTorque(0.0),
+    m_deferMotor(false),
     m_config(config),
     tgSpringCableActuator(muscle, tags, config)
 {
@@ -146,44 +151,113 @@ void tgKinematicActuator::step(double dt)
         // Want to update any controls before applying forces
         notifyStep(dt); 
         // Adjust rest length based on muscle dynamics
-        integrateRestLength(dt);
-        m_springCable->step(dt);
-        logHistory();  
+        if (!m_deferMotor)
+        {
+            integrateRestLength(dt);
+        }
+        if (!m_deferCableForces)
+        {
+            m_springCable->step(dt);
+            logHistory(dt);
+        }
         tgModel::step(dt);
+        ++m_stepCount;
     }
     
     // Reset and wait for next control input
-    m_desiredTorque = 0.0;
+    if (!m_deferMotor)
+    {
+        m_desiredTorque = 0.0;
+    }
 }
 
-void tgKinematicActuator::onVisit(const tgModelVisitor& r) const
+void tgKinematicActuator::accept(const tgModelVisitor& r) const
 {
 #ifndef BT_NO_PROFILE 
-    BT_PROFILE("tgKinematicActuator::onVisit");
+    BT_PROFILE("tgKinematicActuator::accept");
 #endif //BT_NO_PROFILE	
     r.render(*this);
 }
     
-void tgKinematicActuator::logHistory()
+void tgKinematicActuator::storeState(tgSnapshot& snapshot)
 {
-    m_prevVelocity = getVelocity();
+    tgSpringCableActuator::storeState(snapshot);
+    snapshot.write(prevVel);
+    snapshot.write(m_motorVel);
+    snapshot.write(m_motorAcc);
+    snapshot.write(m_desiredTorque);
+    snapshot.write(m_appliedTorque);
+}
+
+void tgKinematicActuator::restoreState(const tgSnapshot& snapshot)
+{
+    tgSpringCableActuator::restoreState(snapshot);
+    prevVel = snapshot.read();
+    m_motorVel = snapshot.read();
+    m_motorAcc = snapshot.read();
+    m_desiredTorque = snapshot.read();
+    m_appliedTorque = snapshot.read();
+}
+    
+bool tgKinematicActuator::deferCableForces(bool defer)
+{
+    if (!defer)
+    {
+        m_deferMotor = false;
+    }
+    return setCableForcesDeferred(defer);
+}
+
+bool tgKinematicActuator::deferMotor(bool defer)
+{
+    if (defer &&
+        (!m_deferCableForces || !m_config.batchMotor ||
+         m_config.substeps != 1 ||
+         typeid(*this) != typeid(tgKinematicActuator)))
+    {
+        return false;
+    }
+    m_deferMotor = defer;
+    return true;
+}
 
-    if (m_config.hist)
+void tgKinematicActuator::finishDeferredStep(double dt)
+{
+    logHistory(dt);
+    if (m_deferMotor)
     {
-        m_pHistory->lastLengths.push_back(m_springCable->getActualLength());
-        m_pHistory->lastVelocities.push_back(m_motorVel);
-        m_pHistory->dampingHistory.push_back(m_springCable->getDamping());
-        m_pHistory->restLengths.push_back(m_springCable->getRestLength());
-        m_pHistory->tensionHistory.push_back(m_appliedTorque);
+        m_desiredTorque = 0.0;
     }
 }
     
+void tgKinematicActuator::logHistory(double dt)
+{
+    m_prevVelocity = getVelocity();
+
+    recordHistory(m_springCable->getActualLength(),
+                  m_motorVel,
+                  m_springCable->getDamping(),
+                  m_springCable->getRestLength(),
+                  m_appliedTorque,
+                  dt);
+}
+    
 const double tgKinematicActuator::getVelocity() const
 {
     return m_motorVel * m_config.radius;
 }
 
 void tgKinematicActuator::integrateRestLength(double dt)
+{
+	// Sub-stepping the motor lets the tension respond to the rest length
+	const double h = dt / m_config.substeps;
+	for (std::size_t i = 0; i < m_config.substeps; ++i)
+	{
+		integrateRestLengthStep(h);
+	}
+}
+
+void tgKinematicActuator::integrateRestLengthStep(double dt)
 {
 	double tension = getTension();
 	m_appliedTorque = getAppliedTorque(m_desiredTorque);
@@ -226,6 +300,7 @@ double tgKinematicActuator::getAppliedTorque(double desiredTorque) const
 
 void tgKinematicActuator::setControlInput(double input)
 {
+	recordControlInput(input, 0.0);
 	m_desiredTorque = input;
 }
 
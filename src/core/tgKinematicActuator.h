@@ -40,6 +40,9 @@ class tgWorld;
 class tgKinematicActuator : public tgSpringCableActuator
 {
 public: 
+	// tgMotorBank integrates many motors at once
+	friend class tgMotorBank;
+	
 	struct Config : public tgSpringCableActuator::Config
 	{
 		Config(double s = 1000.0,
@@ -91,6 +94,15 @@ public:
 		 */
 		double maxOmega;
 		double maxTorque;
+		
+		/**
+		 * When true, and the actuator's cable force is computed by a
+		 * tgCableForcePass, the motor is integrated there together
+		 * with the other motors in a tgMotorBank. Requires a single
+		 * sub-step. Not a constructor parameter; set it after
+		 * construction.
+		 */
+		bool batchMotor;
 	};
 	
     /**
@@ -135,7 +147,45 @@ public:
      * data logging as of May 2014.
      * @param[in] r, the visiting tgModelVisitor
      */
-    virtual void onVisit(const tgModelVisitor& r) const;
+    virtual void accept(const tgModelVisitor& r) const;
+
+    /**
+     * Stores the tgSpringCableActuator state, then the motor velocity, acceleration and torques.
+     * @param[in,out] snapshot the snapshot to append to
+     */
+    virtual void storeState(tgSnapshot& snapshot);
+
+    /**
+     * Reads back what storeState() wrote, in the same order.
+     * @param[in] snapshot the snapshot to read from
+     */
+    virtual void restoreState(const tgSnapshot& snapshot);
+
+    /**
+     * Supported when the spring cable is a plain tgBulletSpringCable.
+     * While deferred, step() still notifies controllers and moves the
+     * motor, but the cable force and history wait for the
+     * tgCableForcePass.
+     * @param[in] defer true to defer
+     * @return true if the request was honored
+     */
+    virtual bool deferCableForces(bool defer);
+    
+    /**
+     * Leave the motor integration to a tgMotorBank as well. Supported
+     * when the cable forces are deferred, Config::batchMotor is set,
+     * there is one sub-step, and the motor model is not overridden.
+     * Ending the cable force deferral ends this too.
+     * @param[in] defer true to defer
+     * @return true if the request was honored
+     */
+    bool deferMotor(bool defer);
+    
+    /**
+     * Logs the history that step() skipped while deferred, and clears
+     * the control input if the motor was deferred.
+     */
+    virtual void finishDeferredStep(double dt);
     
     /**
      * Functions for interfacing with muscle2P, and higher level controllers
@@ -169,6 +219,10 @@ public:
 protected:
 	
 	virtual void integrateRestLength(double dt);
+	
+	/** One sub-step of integrateRestLength() */
+	void integrateRestLengthStep(double dt);
+	
 private:
 
     /**
@@ -178,9 +232,10 @@ private:
 
     /**
      * Append damping, rest length and tension values to the history member
-     * variables.
+     * variables, and update the running aggregates.
+     * @param[in] dt the step just taken, or zero at construction
      */
-    void logHistory();
+    void logHistory(double dt);
 
     /** Integrity predicate. */
     bool invariant() const;
@@ -207,6 +262,9 @@ private:
     
     double m_appliedTorque;
     
+    /** Whether a tgMotorBank integrates the motor, see deferMotor() */
+    bool m_deferMotor;
+    
     /**
      * Override the base config to get the extra parameters
      */
@@ -0,0 +1,170 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgLog.cpp
+ * @brief Contains the definitions of members of class tgLog
+ * $Id$
+ */
+
+// This module
+#include "tgLog.h"
+// Boost
+#include <boost/thread/mutex.hpp>
+// The C++ Standard Library
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+// Constant initialized, so messages written during static initialization
+// see these levels
+int tgLog::s_levels[tgLog::eCategoryCount] = {
+    TG_LOG_LEVEL_INFO, TG_LOG_LEVEL_INFO, TG_LOG_LEVEL_INFO,
+    TG_LOG_LEVEL_INFO, TG_LOG_LEVEL_INFO, TG_LOG_LEVEL_INFO
+};
+
+namespace
+{
+    boost::mutex& writeMutex()
+    {
+        static boost::mutex mutex;
+        return mutex;
+    }
+
+    std::ostream* s_pStream = &std::cout;
+
+    int parseLevel(const std::string& name)
+    {
+        for (int level = TG_LOG_LEVEL_OFF; level <= TG_LOG_LEVEL_TRACE; ++level)
+        {
+            if (name == tgLog::levelName(level))
+            {
+                return level;
+            }
+        }
+        throw std::invalid_argument("Unknown log level " + name);
+    }
+
+    /** Apply the TG_LOG environment variable before main() */
+    struct Environment
+    {
+        Environment()
+        {
+            const char* const spec = std::getenv("TG_LOG");
+            if (spec == NULL)
+            {
+                return;
+            }
+            try
+            {
+                tgLog::configure(spec);
+            }
+            catch (const std::invalid_argument& e)
+            {
+                std::cerr << "Ignoring TG_LOG: " << e.what() << std::endl;
+            }
+        }
+    } s_environment;
+}
+
+void tgLog::setLevel(Category category, int level)
+{
+    s_levels[category] = level;
+}
+
+void tgLog::setLevel(int level)
+{
+    for (int i = 0; i < eCategoryCount; ++i)
+    {
+        s_levels[i] = level;
+    }
+}
+
+void tgLog::configure(const std::string& spec)
+{
+    std::size_t start = 0;
+    while (start <= spec.size())
+    {
+        std::size_t end = spec.find(',', start);
+        if (end == std::string::npos)
+        {
+            end = spec.size();
+        }
+        const std::string item = spec.substr(start, end - start);
+        start = end + 1;
+        if (item.empty())
+        {
+            continue;
+        }
+
+        const std::size_t equals = item.find('=');
+        if (equals == std::string::npos)
+        {
+            setLevel(parseLevel(item));
+            continue;
+        }
+        const std::string name = item.substr(0, equals);
+        const int level = parseLevel(item.substr(equals + 1));
+        if (name == "all")
+        {
+            setLevel(level);
+            continue;
+        }
+        int category = 0;
+        while (category < eCategoryCount &&
+               name != categoryName(static_cast<Category>(category)))
+        {
+            ++category;
+        }
+        if (category == eCategoryCount)
+        {
+            throw std::invalid_argument("Unknown log category " + name);
+        }
+        setLevel(static_cast<Category>(category), level);
+    }
+}
+
+void tgLog::setStream(std::ostream& stream)
+{
+    boost::mutex::scoped_lock lock(writeMutex());
+    s_pStream = &stream;
+}
+
+void tgLog::write(Category category, int level, const std::string& message)
+{
+    boost::mutex::scoped_lock lock(writeMutex());
+    *s_pStream << '[' << levelName(level) << ' ' << categoryName(category)
+               << "] " << message << std::endl;
+}
+
+const char* tgLog::categoryName(Category category)
+{
+    static const char* const names[eCategoryCount] = {
+        "core", "cable", "spring", "cpg", "controller", "learning"
+    };
+    return names[category];
+}
+
+const char* tgLog::levelName(int level)
+{
+    static const char* const names[] = {
+        "off", "error", "warn", "info", "debug", "trace"
+    };
+    return level >= TG_LOG_LEVEL_OFF && level <= TG_LOG_LEVEL_TRACE ?
+        names[level] : "unknown";
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_LOG_H
+#define TG_LOG_H
+
+/**
+ * @file tgLog.h
+ * @brief Contains the definition of class tgLog and the TG_LOG macros
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <iosfwd>
+#include <sstream>
+#include <string>
+
+/** The levels of tgLog, most severe first */
+#define TG_LOG_LEVEL_OFF 0
+#define TG_LOG_LEVEL_ERROR 1
+#define TG_LOG_LEVEL_WARN 2
+#define TG_LOG_LEVEL_INFO 3
+#define TG_LOG_LEVEL_DEBUG 4
+#define TG_LOG_LEVEL_TRACE 5
+
+/**
+ * The most verbose level compiled in. Messages of the levels above it
+ * compile to nothing, their arguments included; build with
+ * -DTG_LOG_MAX_LEVEL=TG_LOG_LEVEL_TRACE to get the debugging output of
+ * the cables and CPGs back.
+ */
+#ifndef TG_LOG_MAX_LEVEL
+#define TG_LOG_MAX_LEVEL TG_LOG_LEVEL_INFO
+#endif
+
+/**
+ * Leveled diagnostics by category, for the output of the simulation
+ * loop that used to go straight to std::cout. A message is formatted only
+ * if its level is compiled in and enabled for its category, so a
+ * disabled message in a hot path costs one comparison, and a message
+ * above TG_LOG_MAX_LEVEL nothing. Write with the macros, e.g.
+ *
+ *     TG_LOG_DEBUG(tgLog::eCable, "Deleting anchor " << i);
+ *
+ * The levels start out as the TG_LOG environment variable says, either
+ * one level for every category or a comma separated list such as
+ * "cable=debug,cpg=warn,all=info", and are info otherwise. Messages go to
+ * std::cout, which the learning scripts capture, one whole line at a time
+ * even from several threads.
+ */
+class tgLog
+{
+public:
+
+    enum Category
+    {
+        eCore,
+        eCable,
+        eSpring,
+        eCPG,
+        eController,
+        eLearning,
+        eCategoryCount
+    };
+
+    /** @return true if messages of level are written for category */
+    static bool enabled(Category category, int level)
+    {
+        return level <= s_levels[category];
+    }
+
+    /** Write messages of category up to level, TG_LOG_LEVEL_OFF for none */
+    static void setLevel(Category category, int level);
+
+    /** Set the level of every category */
+    static void setLevel(int level);
+
+    /**
+     * Set levels from a spec in the format of the TG_LOG variable.
+     * @throw std::invalid_argument if a category or level is unknown
+     */
+    static void configure(const std::string& spec);
+
+    /** Write to stream from now on; it must outlive its use */
+    static void setStream(std::ostream& stream);
+
+    /** Write one message, prefixed by its level and category */
+    static void write(Category category, int level, const std::string& message);
+
+    static const char* categoryName(Category category);
+
+    static const char* levelName(int level);
+
+private:
+
+    static int s_levels[eCategoryCount];
+};
+
+/**
+ * Write a message of any level, given without the TG_LOG_LEVEL_ prefix.
+ * The message is anything that can follow "stream <<".
+ */
+#define TG_LOG(level, category, message)                                \
+    do                                                                  \
+    {                                                                   \
+        if (TG_LOG_LEVEL_##level <= TG_LOG_MAX_LEVEL &&                 \
+            tgLog::enabled(category, TG_LOG_LEVEL_##level))             \
+        {                                                               \
+            std::ostringstream tgLogMessage;                            \
+            tgLogMessage << message;                                    \
+            tgLog::write(category, TG_LOG_LEVEL_##level,                \
+                         tgLogMessage.str());                           \
+        }                                                               \
+    } while (0)
+
+/** A message of a level that is not compiled in */
+#define TG_LOG_NOTHING(category, message) do { } while (0)
+
+#if TG_LOG_MAX_LEVEL >= TG_LOG_LEVEL_ERROR
+#define TG_LOG_ERROR(category, message) TG_LOG(ERROR, category, message)
+#else
+#define TG_LOG_ERROR(category, message) TG_LOG_NOTHING(category, message)
+#endif
+
+#if TG_LOG_MAX_LEVEL >= TG_LOG_LEVEL_WARN
+#define TG_LOG_WARN(category, message) TG_LOG(WARN, category, message)
+#else
+#define TG_LOG_WARN(category, message) TG_LOG_NOTHING(category, message)
+#endif
+
+#if TG_LOG_MAX_LEVEL >= TG_LOG_LEVEL_INFO
+#define TG_LOG_INFO(category, message) TG_LOG(INFO, category, message)
+#else
+#define TG_LOG_INFO(category, message) TG_LOG_NOTHING(category, message)
+#endif
+
+#if TG_LOG_MAX_LEVEL >= TG_LOG_LEVEL_DEBUG
+#define TG_LOG_DEBUG(category, message) TG_LOG(DEBUG, category, message)
+#else
+#define TG_LOG_DEBUG(category, message) TG_LOG_NOTHING(category, message)
+#endif
+
+#if TG_LOG_MAX_LEVEL >= TG_LOG_LEVEL_TRACE
+#define TG_LOG_TRACE(category, message) TG_LOG(TRACE, category, message)
+#else
+#define TG_LOG_TRACE(category, message) TG_LOG_NOTHING(category, message)
+#endif
+
+#endif  // TG_LOG_H
@@ -0,0 +1,455 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgMemoryReport.cpp
+ * @brief Contains the definitions of members of class tgMemoryReport
+ * $Id$
+ */
+
+// This module
+#include "tgMemoryReport.h"
+// This application
+#include "tgBulletContactSpringCable.h"
+#include "tgBulletSpringCable.h"
+#include "tgBulletSpringCableAnchor.h"
+#include "tgBulletUtil.h"
+#include "tgCast.h"
+#include "tgModel.h"
+#include "tgParallelSubject.h"
+#include "tgSpringCableActuator.h"
+#include "tgWorld.h"
+#include "tgWorldArena.h"
+// The Bullet Physics library
+#include "BulletCollision/BroadphaseCollision/btDbvtBroadphase.h"
+#include "BulletCollision/CollisionDispatch/btCollisionConfiguration.h"
+#include "BulletCollision/CollisionDispatch/btCollisionDispatcher.h"
+#include "BulletCollision/CollisionDispatch/btGhostObject.h"
+#include "BulletCollision/CollisionShapes/btBoxShape.h"
+#include "BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h"
+#include "BulletCollision/CollisionShapes/btCapsuleShape.h"
+#include "BulletCollision/CollisionShapes/btCompoundShape.h"
+#include "BulletCollision/CollisionShapes/btConvexHullShape.h"
+#include "BulletCollision/CollisionShapes/btCylinderShape.h"
+#include "BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h"
+#include "BulletCollision/CollisionShapes/btOptimizedBvh.h"
+#include "BulletCollision/CollisionShapes/btSphereShape.h"
+#include "BulletCollision/CollisionShapes/btStaticPlaneShape.h"
+#include "BulletCollision/CollisionShapes/btTriangleIndexVertexArray.h"
+#include "BulletDynamics/ConstraintSolver/btConeTwistConstraint.h"
+#include "BulletDynamics/ConstraintSolver/btGeneric6DofSpringConstraint.h"
+#include "BulletDynamics/ConstraintSolver/btHingeConstraint.h"
+#include "BulletDynamics/ConstraintSolver/btPoint2PointConstraint.h"
+#include "BulletDynamics/ConstraintSolver/btSliderConstraint.h"
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btDefaultMotionState.h"
+#include "LinearMath/btPoolAllocator.h"
+// The C++ Standard Library
+#include <cassert>
+#include <iostream>
+#include <set>
+
+namespace
+{
+    const char* const names[tgMemoryReport::eNumCategories] =
+    {
+        "bodies",
+        "shapes",
+        "bvh",
+        "broadphase",
+        "manifolds",
+        "constraints",
+        "cables",
+        "cableHistory",
+        "sensors",
+        "loggers",
+        "controllers"
+    };
+
+    /** @return the bytes of a tree of leaves leaves */
+    std::size_t treeBytes(int leaves)
+    {
+        return leaves > 0 ? (2 * leaves - 1) * sizeof(btDbvtNode) : 0;
+    }
+
+    /** @return the bytes of the pairs in a cache */
+    std::size_t pairBytes(btOverlappingPairCache* pCache)
+    {
+        if (pCache == NULL)
+        {
+            return 0;
+        }
+        // A hashed cache has a next index and a hash entry per pair
+        return pCache->getNumOverlappingPairs() *
+            (sizeof(btBroadphasePair) + 2 * sizeof(int));
+    }
+
+    /**
+     * Add a shape and its children, each once.
+     * @param[in] pShape the shape, may be NULL
+     * @param[in,out] seen the shapes added so far
+     * @param[in,out] report the report
+     */
+    void addShape(const btCollisionShape* pShape,
+                  std::set<const btCollisionShape*>& seen,
+                  tgMemoryReport& report)
+    {
+        if (pShape == NULL || !seen.insert(pShape).second)
+        {
+            return;
+        }
+
+        std::size_t bytes = sizeof(btCollisionShape);
+        switch (pShape->getShapeType())
+        {
+        case BOX_SHAPE_PROXYTYPE:
+            bytes = sizeof(btBoxShape);
+            break;
+        case SPHERE_SHAPE_PROXYTYPE:
+            bytes = sizeof(btSphereShape);
+            break;
+        case CYLINDER_SHAPE_PROXYTYPE:
+            bytes = sizeof(btCylinderShape);
+            break;
+        case CAPSULE_SHAPE_PROXYTYPE:
+            bytes = sizeof(btCapsuleShape);
+            break;
+        case STATIC_PLANE_PROXYTYPE:
+            bytes = sizeof(btStaticPlaneShape);
+            break;
+        case TERRAIN_SHAPE_PROXYTYPE:
+            // The heights belong to whoever made the shape
+            bytes = sizeof(btHeightfieldTerrainShape);
+            break;
+        case CONVEX_HULL_SHAPE_PROXYTYPE:
+            {
+                const btConvexHullShape* const pHull =
+                    static_cast<const btConvexHullShape*>(pShape);
+                bytes = sizeof(btConvexHullShape) +
+                    pHull->getNumPoints() * sizeof(btVector3);
+            }
+            break;
+        case TRIANGLE_MESH_SHAPE_PROXYTYPE:
+            {
+                btBvhTriangleMeshShape* const pMesh =
+                    const_cast<btBvhTriangleMeshShape*>(
+                        static_cast<const btBvhTriangleMeshShape*>(pShape));
+                bytes = sizeof(btBvhTriangleMeshShape);
+
+                const btOptimizedBvh* const pBvh = pMesh->getOptimizedBvh();
+                if (pBvh != NULL)
+                {
+                    report.add(tgMemoryReport::eBVH,
+                               pBvh->calculateSerializeBufferSize());
+                }
+
+                const btTriangleIndexVertexArray* const pArray =
+                    dynamic_cast<const btTriangleIndexVertexArray*>(
+                        pMesh->getMeshInterface());
+                if (pArray != NULL)
+                {
+                    const IndexedMeshArray& meshes =
+                        const_cast<btTriangleIndexVertexArray*>(pArray)
+                            ->getIndexedMeshArray();
+                    for (int i = 0; i < meshes.size(); i++)
+                    {
+                        bytes +=
+                            meshes[i].m_numTriangles *
+                                meshes[i].m_triangleIndexStride +
+                            meshes[i].m_numVertices * meshes[i].m_vertexStride;
+                    }
+                }
+            }
+            break;
+        case COMPOUND_SHAPE_PROXYTYPE:
+            {
+                const btCompoundShape* const pCompound =
+                    static_cast<const btCompoundShape*>(pShape);
+                const int n = pCompound->getNumChildShapes();
+                bytes = sizeof(btCompoundShape) + n * sizeof(btCompoundShapeChild);
+
+                const btDbvt* const pTree = pCompound->getDynamicAabbTree();
+                if (pTree != NULL)
+                {
+                    report.add(tgMemoryReport::eBVH, treeBytes(pTree->m_leaves));
+                }
+                for (int i = 0; i < n; i++)
+                {
+                    addShape(pCompound->getChildShape(i), seen, report);
+                }
+            }
+            break;
+        default:
+            break;
+        }
+        report.add(tgMemoryReport::eShapes, bytes);
+    }
+
+    /** @return the bytes of a constraint of the types tgWorld makes */
+    std::size_t constraintBytes(const btTypedConstraint& constraint)
+    {
+        switch (constraint.getConstraintType())
+        {
+        case POINT2POINT_CONSTRAINT_TYPE:
+            return sizeof(btPoint2PointConstraint);
+        case HINGE_CONSTRAINT_TYPE:
+            return sizeof(btHingeConstraint);
+        case CONETWIST_CONSTRAINT_TYPE:
+            return sizeof(btConeTwistConstraint);
+        case SLIDER_CONSTRAINT_TYPE:
+            return sizeof(btSliderConstraint);
+        case D6_SPRING_CONSTRAINT_TYPE:
+            return sizeof(btGeneric6DofSpringConstraint);
+        default:
+            return sizeof(btGeneric6DofConstraint);
+        }
+    }
+
+    /** @return the bytes of a pool allocator's preallocated elements */
+    std::size_t poolBytes(const btPoolAllocator* pPool)
+    {
+        return pPool ? pPool->getMaxCount() * pPool->getElementSize() : 0;
+    }
+}
+
+tgMemoryReport::tgMemoryReport() :
+    m_arenaBytes(0)
+{
+    for (std::size_t i = 0; i < eNumCategories; i++)
+    {
+        m_bytes[i] = 0;
+        m_counts[i] = 0;
+    }
+}
+
+void tgMemoryReport::add(Category category, std::size_t bytes,
+                         std::size_t count)
+{
+    assert(category >= 0 && category < eNumCategories);
+    m_bytes[category] += bytes;
+    m_counts[category] += count;
+}
+
+void tgMemoryReport::addWorld(const tgWorld& world)
+{
+    if (world.arena() != NULL)
+    {
+        m_arenaBytes += world.arena()->bytes();
+    }
+
+    btDynamicsWorld& dynamicsWorld = tgBulletUtil::worldToDynamicsWorld(world);
+
+    // Bodies and their shapes
+    const btCollisionObjectArray& objects =
+        dynamicsWorld.getCollisionObjectArray();
+    std::set<const btCollisionShape*> seen;
+    for (int i = 0; i < objects.size(); i++)
+    {
+        const btCollisionObject* const pObject = objects[i];
+        std::size_t bytes = sizeof(btCollisionObject);
+
+        const btRigidBody* const pBody = btRigidBody::upcast(pObject);
+        const btGhostObject* const pGhost = btGhostObject::upcast(pObject);
+        if (pBody != NULL)
+        {
+            bytes = sizeof(btRigidBody) +
+                pBody->getNumConstraintRefs() * sizeof(btTypedConstraint*);
+            if (pBody->getMotionState() != NULL)
+            {
+                bytes += sizeof(btDefaultMotionState);
+            }
+        }
+        else if (pGhost != NULL)
+        {
+            bytes = sizeof(btGhostObject) +
+                pGhost->getNumOverlappingObjects() * sizeof(btCollisionObject*);
+            const btPairCachingGhostObject* const pCaching =
+                dynamic_cast<const btPairCachingGhostObject*>(pGhost);
+            if (pCaching != NULL)
+            {
+                bytes += sizeof(btPairCachingGhostObject) - sizeof(btGhostObject);
+                add(eBroadphase, pairBytes(
+                    const_cast<btPairCachingGhostObject*>(pCaching)
+                        ->getOverlappingPairCache()), 0);
+            }
+        }
+        add(eBodies, bytes);
+        addShape(pObject->getCollisionShape(), seen, *this);
+    }
+    add(eBodies, objects.capacity() * sizeof(btCollisionObject*), 0);
+
+    // A proxy per object, and the trees of a DBVT
+    btBroadphaseInterface* const pBroadphase = dynamicsWorld.getBroadphase();
+    std::size_t broadphase = objects.size() * sizeof(btDbvtProxy);
+    btDbvtBroadphase* const pDbvt = dynamic_cast<btDbvtBroadphase*>(pBroadphase);
+    if (pDbvt != NULL)
+    {
+        broadphase += treeBytes(pDbvt->m_sets[0].m_leaves) +
+            treeBytes(pDbvt->m_sets[1].m_leaves);
+    }
+    broadphase += pairBytes(pBroadphase->getOverlappingPairCache());
+    add(eBroadphase, broadphase);
+
+    // The pools are allocated whole when the world is made
+    btCollisionDispatcher* const pDispatcher =
+        dynamic_cast<btCollisionDispatcher*>(dynamicsWorld.getDispatcher());
+    const int manifolds = dynamicsWorld.getDispatcher()->getNumManifolds();
+    std::size_t narrowphase = 0;
+    if (pDispatcher != NULL && pDispatcher->getCollisionConfiguration())
+    {
+        btCollisionConfiguration* const pConfiguration =
+            pDispatcher->getCollisionConfiguration();
+        const btPoolAllocator* const pPool =
+            pConfiguration->getPersistentManifoldPool();
+        narrowphase += poolBytes(pPool) +
+            poolBytes(pConfiguration->getCollisionAlgorithmPool());
+        // Those beyond the pool come from the heap
+        if (pPool != NULL && manifolds > pPool->getMaxCount())
+        {
+            narrowphase += (manifolds - pPool->getMaxCount()) *
+                sizeof(btPersistentManifold);
+        }
+    }
+    else
+    {
+        narrowphase = manifolds * sizeof(btPersistentManifold);
+    }
+    add(eManifolds, narrowphase, manifolds);
+
+    const int constraints = dynamicsWorld.getNumConstraints();
+    for (int i = 0; i < constraints; i++)
+    {
+        add(eConstraints, constraintBytes(*dynamicsWorld.getConstraint(i)));
+    }
+}
+
+void tgMemoryReport::addModel(const tgModel& model)
+{
+    std::vector<const tgModel*> models(1, &model);
+    const std::vector<tgModel*>& descendants = model.getDescendants();
+    models.insert(models.end(), descendants.begin(), descendants.end());
+
+    for (std::size_t i = 0; i < models.size(); i++)
+    {
+        const tgSpringCableActuator* const pActuator =
+            tgCast::cast<tgModel, tgSpringCableActuator>(models[i]);
+        if (pActuator != NULL)
+        {
+            const tgSpringCableActuator::SpringCableActuatorHistory& history =
+                pActuator->getHistory();
+            add(eCableHistory,
+                sizeof(history) +
+                bytes(history.lastLengths) + bytes(history.restLengths) +
+                bytes(history.dampingHistory) + bytes(history.lastVelocities) +
+                bytes(history.tensionHistory) +
+                history.lengthSeries.bytes() +
+                history.restLengthSeries.bytes() +
+                history.dampingSeries.bytes() +
+                history.velocitySeries.bytes() +
+                history.tensionSeries.bytes());
+
+            const tgBulletSpringCable* const pCable =
+                tgCast::cast<tgSpringCable, tgBulletSpringCable>(
+                    pActuator->getSpringCable());
+            if (pCable != NULL)
+            {
+                const std::size_t anchors = pCable->getBulletAnchors().size();
+                const std::size_t cable =
+                    tgCast::cast<tgSpringCable, tgBulletContactSpringCable>(pCable) ?
+                    sizeof(tgBulletContactSpringCable) :
+                    sizeof(tgBulletSpringCable);
+                add(eCables,
+                    cable + anchors * (sizeof(tgBulletSpringCableAnchor) +
+                                       sizeof(tgBulletSpringCableAnchor*)));
+            }
+        }
+
+        const tgParallelSubject* const pSubject =
+            dynamic_cast<const tgParallelSubject*>(models[i]);
+        if (pSubject != NULL)
+        {
+            pSubject->notifyReportMemory(*this);
+        }
+    }
+}
+
+tgMemoryReport& tgMemoryReport::operator+=(const tgMemoryReport& other)
+{
+    for (std::size_t i = 0; i < eNumCategories; i++)
+    {
+        m_bytes[i] += other.m_bytes[i];
+        m_counts[i] += other.m_counts[i];
+    }
+    m_arenaBytes += other.m_arenaBytes;
+    return *this;
+}
+
+std::size_t tgMemoryReport::getBytes(Category category) const
+{
+    assert(category >= 0 && category < eNumCategories);
+    return m_bytes[category];
+}
+
+std::size_t tgMemoryReport::getCount(Category category) const
+{
+    assert(category >= 0 && category < eNumCategories);
+    return m_counts[category];
+}
+
+std::size_t tgMemoryReport::getTotal() const
+{
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < eNumCategories; i++)
+    {
+        total += m_bytes[i];
+    }
+    return total;
+}
+
+const char* tgMemoryReport::name(Category category)
+{
+    assert(category >= 0 && category < eNumCategories);
+    return names[category];
+}
+
+void tgMemoryReport::writeJSON(std::ostream& os, const char* indent) const
+{
+    os << "{\n" << indent << "  \"total\": " << getTotal()
+       << ",\n" << indent << "  \"arena\": " << m_arenaBytes;
+    for (std::size_t i = 0; i < eNumCategories; i++)
+    {
+        os << ",\n" << indent << "  \"" << names[i] << "\": {\"bytes\": "
+           << m_bytes[i] << ", \"count\": " << m_counts[i] << "}";
+    }
+    os << "\n" << indent << "}";
+}
+
+std::ostream& operator<<(std::ostream& os, const tgMemoryReport& report)
+{
+    for (std::size_t i = 0; i < tgMemoryReport::eNumCategories; i++)
+    {
+        const tgMemoryReport::Category category =
+            static_cast<tgMemoryReport::Category>(i);
+        os << tgMemoryReport::name(category) << ": "
+           << report.getBytes(category) << " bytes, "
+           << report.getCount(category) << std::endl;
+    }
+    os << "total: " << report.getTotal() << " bytes" << std::endl;
+    return os;
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_MEMORY_REPORT_H
+#define TG_MEMORY_REPORT_H
+
+/**
+ * @file tgMemoryReport.h
+ * @brief Contains the definition of class tgMemoryReport
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <deque>
+#include <iosfwd>
+#include <vector>
+
+// Forward declarations
+class tgModel;
+class tgWorld;
+
+/**
+ * The bytes a simulation holds, by category, for sizing the worlds of a
+ * tgBatchSimulation to the memory of a node. addWorld() walks the Bullet
+ * objects of a world and addModel() walks a model, its descendants and
+ * their observers; tgSimulation::getMemoryReport() does both for every
+ * world and model, and asks its data managers. The counts are exact, the
+ * bytes are estimates: sizeof the objects plus the capacity of the arrays
+ * they own, without allocator overhead and without what Bullet allocates
+ * only while stepping.
+ *
+ * Categories outside the core library, sensors, loggers and controllers,
+ * are filled by their owners: tgDataManager::reportMemory() and
+ * tgObserver::onReportMemory(), which call add().
+ */
+class tgMemoryReport
+{
+public:
+
+    enum Category
+    {
+        /** Collision objects, rigid bodies and their motion states */
+        eBodies,
+        /** Collision shapes, counted once however many objects share them */
+        eShapes,
+        /** The bounding volume trees of meshes and compound shapes */
+        eBVH,
+        /** Broadphase proxies, trees and the cache of overlapping pairs */
+        eBroadphase,
+        /** Contact manifolds and the narrowphase pools */
+        eManifolds,
+        /** Constraints between bodies */
+        eConstraints,
+        /** Cables and their anchors */
+        eCables,
+        /** The history deques of tgSpringCableActuator */
+        eCableHistory,
+        /** Sensors and sensor infos */
+        eSensors,
+        /** The buffers of data loggers */
+        eLoggers,
+        /** CPG, neural network and other controller state */
+        eControllers,
+        eNumCategories
+    };
+
+    /** An empty report */
+    tgMemoryReport();
+
+    /**
+     * @param[in] category what the memory is for
+     * @param[in] bytes the bytes to add
+     * @param[in] count the number of objects they are for
+     */
+    void add(Category category, std::size_t bytes, std::size_t count = 1);
+
+    /** Add the Bullet objects of the world, and its arena's total. */
+    void addWorld(const tgWorld& world);
+
+    /**
+     * Add the cables and histories of the model and its descendants, then
+     * let the observers of each add theirs.
+     */
+    void addModel(const tgModel& model);
+
+    /** Add every category of another report, such as another world's. */
+    tgMemoryReport& operator+=(const tgMemoryReport& other);
+
+    std::size_t getBytes(Category category) const;
+
+    std::size_t getCount(Category category) const;
+
+    /** @return the bytes of all categories */
+    std::size_t getTotal() const;
+
+    /**
+     * @return the bytes the arenas of the worlds have handed out, see
+     * tgWorld::Config::worldArena; these hold the bodies, shapes and
+     * constraints above, so they are not part of getTotal()
+     */
+    std::size_t getArenaBytes() const { return m_arenaBytes; }
+
+    /** @return the name of the category in writeJSON() */
+    static const char* name(Category category);
+
+    /**
+     * Write the report as a JSON object of the total, the arena bytes and
+     * the bytes and count of each category.
+     * @param[in,out] os the stream
+     * @param[in] indent put before every line but the first
+     */
+    void writeJSON(std::ostream& os, const char* indent = "") const;
+
+    /** @return the bytes a vector has room for */
+    template <typename T>
+    static std::size_t bytes(const std::vector<T>& v)
+    {
+        return v.capacity() * sizeof(T);
+    }
+
+    /** @return the bytes of the 512 byte nodes a libstdc++ deque holds */
+    template <typename T>
+    static std::size_t bytes(const std::deque<T>& d)
+    {
+        const std::size_t perNode = sizeof(T) < 512 ? 512 / sizeof(T) : 1;
+        return (d.size() / perNode + 1) * perNode * sizeof(T);
+    }
+
+private:
+
+    std::size_t m_bytes[eNumCategories];
+
+    std::size_t m_counts[eNumCategories];
+
+    std::size_t m_arenaBytes;
+};
+
+/**
+ * Overload operator<<() to write the report as one line per category.
+ * @param[in,out] os an ostream
+ * @param[in] report the report
+ * @return os
+ */
+std::ostream& operator<<(std::ostream& os, const tgMemoryReport& report);
+
+#endif  // TG_MEMORY_REPORT_H
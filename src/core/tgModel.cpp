@@ -27,17 +27,29 @@
 // This application
 #include "tgModelVisitor.h"
 #include "abstractMarker.h"
+#include "tgSnapshot.h"
 // The C++ Standard Library
+#include <algorithm>
 #include <stdexcept>
 
-tgModel::tgModel()
+tgModel::tgModel() :
+  m_pParent(NULL),
+  m_descendantsValid(false),
+  m_pStateFrame(NULL),
+  m_stopRequested(false),
+  m_failure(tgDivergenceWatchdog::eNone)
 {
   // Postcondition
   assert(invariant());
 }
 
 tgModel::tgModel(const tgTags& tags) :
-        tgTaggable(tags)
+        tgTaggable(tags),
+        m_pParent(NULL),
+        m_descendantsValid(false),
+        m_pStateFrame(NULL),
+  m_stopRequested(false),
+  m_failure(tgDivergenceWatchdog::eNone)
 {
   assert(invariant());
 }
@@ -73,6 +85,7 @@ void tgModel::teardown()
     delete m_children[i];
   }
   m_children.clear();
+  invalidateDescendants();
   //Clear the markers
   this->m_markers.clear();
 
@@ -106,7 +119,7 @@ void tgModel::step(double dt)
 
 void tgModel::onVisit(const tgModelVisitor& r) const
 {
-  r.render(*this);
+  accept(r);
 
   // Call onRender for all children (if we have any)
   const size_t n = m_children.size();
@@ -119,6 +132,36 @@ void tgModel::onVisit(const tgModelVisitor& r) const
   assert(invariant());
 }
 
+void tgModel::accept(const tgModelVisitor& r) const
+{
+  r.render(*this);
+}
+
+void tgModel::storeState(tgSnapshot& snapshot)
+{
+  const size_t n = m_children.size();
+  for (std::size_t i = 0; i < n; i++)
+  {
+    tgModel * const pChild = m_children[i];
+    assert(pChild != NULL);
+    pChild->storeState(snapshot);
+  }
+}
+
+void tgModel::restoreState(const tgSnapshot& snapshot)
+{
+  const size_t n = m_children.size();
+  for (std::size_t i = 0; i < n; i++)
+  {
+    tgModel * const pChild = m_children[i];
+    assert(pChild != NULL);
+    pChild->restoreState(snapshot);
+  }
+
+  // Postcondition
+  assert(invariant());
+}
+
 void tgModel::addChild(tgModel* pChild)
 {
   // Preconditoin
@@ -132,7 +175,7 @@ void tgModel::addChild(tgModel* pChild)
   } 
   else 
   {
-    const std::vector<tgModel*> descendants = getDescendants();
+    const std::vector<tgModel*>& descendants = getDescendants();
     if (std::find(descendants.begin(), descendants.end(), pChild) !=
     descendants.end())
     {
@@ -141,6 +184,8 @@ void tgModel::addChild(tgModel* pChild)
   }
 
   m_children.push_back(pChild);
+  pChild->m_pParent = this;
+  invalidateDescendants();
 
   // Postcondition
   assert(invariant());
@@ -163,13 +208,19 @@ std::string tgModel::toString(std::string prefix) const
   return os.str();
 }
 
-/**
- * @todo Unnecessary copying can be avoided by pasing the result
- * collection in the recursive step.
- */
-std::vector<tgModel*> tgModel::getDescendants() const
+const std::vector<tgModel*>& tgModel::getDescendants() const
+{
+  if (!m_descendantsValid)
+  {
+    m_descendants.clear();
+    appendDescendants(m_descendants);
+    m_descendantsValid = true;
+  }
+  return m_descendants;
+}
+
+void tgModel::appendDescendants(std::vector<tgModel*>& result) const
 {
-  std::vector<tgModel*> result;
   const size_t n = m_children.size();
   for (std::size_t i = 0; i < n; i++)
   {
@@ -177,10 +228,44 @@ std::vector<tgModel*> tgModel::getDescendants() const
     assert(pChild != NULL);
     result.push_back(pChild);
     // Recursion
-    const std::vector<tgModel*> cd = pChild->getDescendants();
-    result.insert(result.end(), cd.begin(), cd.end());
+    pChild->appendDescendants(result);
+  }
+}
+
+void tgModel::invalidateDescendants()
+{
+  for (tgModel* p = this; p != NULL; p = p->m_pParent)
+  {
+    p->m_descendantsValid = false;
+    p->m_typeIndex.clear();
   }
-  return result;
+}
+
+const tgModel::TypeIndex& tgModel::getTypeIndex(const std::type_info& type,
+                                                void* (*cast)(tgModel*)) const
+{
+  const std::vector<tgModel*>& descendants = getDescendants();
+  for (std::size_t i = 0; i < m_typeIndex.size(); i++)
+  {
+    if (*m_typeIndex[i].type == type)
+    {
+      return m_typeIndex[i];
+    }
+  }
+
+  m_typeIndex.push_back(TypeIndex());
+  TypeIndex& index = m_typeIndex.back();
+  index.type = &type;
+  for (std::size_t i = 0; i < descendants.size(); i++)
+  {
+    void* const pTyped = cast(descendants[i]);
+    if (pTyped != NULL)
+    {
+      index.models.push_back(descendants[i]);
+      index.typed.push_back(pTyped);
+    }
+  }
+  return index;
 }
 
 /**
@@ -190,14 +275,26 @@ std::vector<tgModel*> tgModel::getDescendants() const
  */
 std::vector<tgSenseable*> tgModel::getSenseableDescendants() const
 {
-  // TO-DO: why can't we just return the results of getDescendants?
-  // There seems to be some polymorphism issue here...
-  std::vector<tgModel*> myDescendants = getDescendants();
-  std::vector<tgSenseable*> mySenseableDescendants;
-  for (size_t i=0; i < myDescendants.size(); i++) {
-    mySenseableDescendants.push_back(myDescendants[i]);
+  const std::vector<tgModel*>& myDescendants = getDescendants();
+  return std::vector<tgSenseable*>(myDescendants.begin(),
+                                   myDescendants.end());
+}
+
+const tgStateFrame* tgModel::getStateFrame() const
+{
+  for (const tgModel* p = this; p != NULL; p = p->m_pParent)
+  {
+    if (p->m_pStateFrame != NULL)
+    {
+      return p->m_pStateFrame;
+    }
   }
-  return mySenseableDescendants;
+  return NULL;
+}
+
+void tgModel::setStateFrame(const tgStateFrame* pFrame)
+{
+  m_pStateFrame = pFrame;
 }
 
 const std::vector<abstractMarker>& tgModel::getMarkers() const {
@@ -28,16 +28,21 @@
 
 // This application
 #include "tgCast.h"
+#include "tgDivergenceWatchdog.h"
 #include "tgTaggable.h"
 #include "tgTagSearch.h"
 #include "tgSenseable.h"
 // The C++ Standard Library
+#include <cstddef>
 #include <iostream>
+#include <typeinfo>
 #include <vector>
 
 // Forward declarations
 class tgModelVisitor;
 class tgWorld;
+class tgSnapshot;
+class tgStateFrame;
 class abstractMarker;
 
 /**
@@ -94,10 +99,36 @@ public:
 
     /**
     * Call tgModelVisitor::render() on self and all descendants.
+    * The base class calls accept() and then onVisit() on each child.
     * @param[in,out] r a reference to a tgModelVisitor
     */
     virtual void onVisit(const tgModelVisitor& r) const;
 
+    /**
+    * Call the tgModelVisitor::render() overload for this type on self
+    * only. Subclasses with their own overload override this rather than
+    * onVisit(), so that tgModelTraversal, which visits the models of a
+    * tree separately, sees them as onVisit() does.
+    * @param[in,out] r a reference to a tgModelVisitor
+    */
+    virtual void accept(const tgModelVisitor& r) const;
+
+    /**
+    * Append the dynamic state of this model and its descendants to a
+    * snapshot. The base class holds no state of its own and recurses
+    * into the children. Subclasses with state that is not captured by
+    * their rigid bodies override this and call the base class version.
+    * @param[in,out] snapshot the snapshot to append to
+    */
+    virtual void storeState(tgSnapshot& snapshot);
+
+    /**
+    * Read back the state written by storeState(), in the same order.
+    * @param[in] snapshot the snapshot to read from
+    * @throw std::out_of_range if the snapshot does not match the model
+    */
+    virtual void restoreState(const tgSnapshot& snapshot);
+
     /**
     * Add a sub-model to this model.
     * The model takes ownership of the child sub-model and is responsible for
@@ -120,14 +151,28 @@ public:
 	/**
 	 * Get a vector of descendants sorted by type and a tagsearch.
 	 * Useful for pulling out muscle groups, or similar.
+	 * The descendants of each type T are cast once and kept, with the
+	 * descendant list, until the tree changes, so repeated calls only
+	 * match the tags of the descendants of type T. Tags are matched on
+	 * every call, since they may change without the tree knowing.
 	 * @param[in] tagSearch, a tagSearch that contains the desired tags
 	 * @return a std::vector of pointers to members that match the tag
-	 * search and typename T
+	 * search and typename T, in depth-first order
 	 */
     template <typename T>
     std::vector<T*> find(const tgTagSearch& tagSearch)
     {
-        return tgCast::find<tgModel, T>(tagSearch, getDescendants());
+        const TypeIndex& index = getTypeIndex(typeid(T), &castTo<T>);
+        const bool all = tagSearch.getTags().empty();
+        std::vector<T*> result;
+        for (std::size_t i = 0; i < index.models.size(); i++)
+        {
+            if (all || tagSearch.matches(*index.models[i]))
+            {
+                result.push_back(static_cast<T*>(index.typed[i]));
+            }
+        }
+        return result;
     }
 	
 	/**
@@ -140,16 +185,20 @@ public:
     template <typename T>
     std::vector<T*> find(const std::string& tagSearch)
     {
-        return tgCast::find<tgModel, T>(tgTagSearch(tagSearch), getDescendants());
+        return find<T>(tgTagSearch(tagSearch));
     }
 
     /**
-     * Return a std::vector of const pointers to all sub-models.
+     * Return a std::vector of pointers to all sub-models, in depth-first
+     * order. The list is built on the first call and cached until
+     * addChild() or teardown() changes this model or one of its
+     * descendants, so repeated calls do not allocate.
      * @todo examine whether this should be public, and perhaps create
      * a read only version
-     * @return a std::vector of const pointers all sub-models.
+     * @return a reference to the cached list of all sub-models, valid
+     * until the tree changes
      */
-    std::vector<tgModel*> getDescendants() const;
+    const std::vector<tgModel*>& getDescendants() const;
 
     const std::vector<abstractMarker>& getMarkers() const;
 
@@ -163,11 +212,106 @@ public:
      */
     virtual std::vector<tgSenseable*> getSenseableDescendants() const;
 
+    /**
+     * Return the state of this model's cables and bodies at the start of
+     * the current step. Sub-models share the frame of the model that was
+     * added to the simulation.
+     * @return the frame, or NULL if this model is not in a tgSimulation
+     */
+    const tgStateFrame* getStateFrame() const;
+
+    /**
+     * Attach the frame returned by getStateFrame(). Called by
+     * tgSimulation, which owns the frame and updates it every step.
+     * @param[in] pFrame the frame, or NULL to detach it
+     */
+    void setStateFrame(const tgStateFrame* pFrame);
+
+    /**
+     * Ask the tgSimulation running this model to end the episode after
+     * the current step, e.g. when a controller sees that the robot fell
+     * over. Only requests on the models given to tgSimulation::addModel()
+     * are seen; tgSimulation::run(int) clears them when it starts.
+     */
+    void requestStop() { m_stopRequested = true; }
+
+    /** @return true if requestStop() was called since the last clear */
+    bool isStopRequested() const { return m_stopRequested; }
+
+    /**
+     * Withdraw a stop request and forget a failure. Called by
+     * tgSimulation.
+     */
+    void clearStopRequest()
+    {
+        m_stopRequested = false;
+        m_failure = tgDivergenceWatchdog::eNone;
+    }
+
+    /**
+     * Record that this model's bodies diverged, and stop the episode.
+     * Called by tgSimulation when its watchdog trips.
+     * @param[in] failure why
+     */
+    void fail(tgDivergenceWatchdog::Failure failure)
+    {
+        m_failure = failure;
+        requestStop();
+    }
+
+    /**
+     * @return why the watchdog of tgSimulation stopped this model during
+     * the current run, or eNone. A controller's onTeardown() can score
+     * the trial as failed on anything else. Sub-models report the
+     * failure of the model that was added to the simulation.
+     */
+    tgDivergenceWatchdog::Failure getFailure() const
+    {
+        return m_pParent != NULL ? m_pParent->getFailure() : m_failure;
+    }
+
 private:
 
+    /** The descendants of one type, see find() */
+    struct TypeIndex
+    {
+        const std::type_info* type;
+
+        /** The descendants that cast to the type, depth-first */
+        std::vector<tgModel*> models;
+
+        /** The same descendants, cast, as void* */
+        std::vector<void*> typed;
+    };
+
+    /** The cast find() makes once per descendant */
+    template <typename T>
+    static void* castTo(tgModel* pModel)
+    {
+        return tgCast::cast<tgModel, T>(pModel);
+    }
+
+    /**
+     * Return the index of a type, building it from getDescendants() if
+     * the tree changed since it was last built.
+     * @param[in] type the type
+     * @param[in] cast casts a descendant to the type, or returns NULL
+     */
+    const TypeIndex& getTypeIndex(const std::type_info& type,
+                                  void* (*cast)(tgModel*)) const;
+
     /** Integrity predicate. */
     bool invariant() const;
 
+    /**
+     * Discard the cached descendant list of this model and of every
+     * ancestor, whose lists contain it.
+     */
+    void invalidateDescendants();
+
+    /** Append all sub-models to result, depth-first. */
+    void appendDescendants(std::vector<tgModel*>& result) const;
+
 private:
 
     /**
@@ -177,6 +321,28 @@ private:
      */
     std::vector<tgModel*> m_children;
 
+    /** The model this one was added to with addChild(), or NULL. */
+    tgModel* m_pParent;
+
+    /** Cache for getDescendants(), valid when m_descendantsValid. */
+    mutable std::vector<tgModel*> m_descendants;
+    mutable bool m_descendantsValid;
+
+    /**
+     * The types find() was called with, emptied with m_descendants.
+     * There are few, so they are searched in order.
+     */
+    mutable std::vector<TypeIndex> m_typeIndex;
+
+    /** The frame attached by setStateFrame(), or NULL. Not owned. */
+    const tgStateFrame* m_pStateFrame;
+
+    /** Set by requestStop() */
+    bool m_stopRequested;
+
+    /** Set by fail() */
+    tgDivergenceWatchdog::Failure m_failure;
+
     std::vector<abstractMarker> m_markers;
 
 };
@@ -0,0 +1,129 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgModelTraversal.cpp
+ * @brief Contains the definitions of members of class tgModelTraversal
+ * $Id$
+ */
+
+// This module
+#include "tgModelTraversal.h"
+// This application
+#include "tgModel.h"
+#include "tgModelVisitor.h"
+#include "tgThreadPool.h"
+// The Bullet Physics library
+#include "LinearMath/btQuickprof.h"
+// The C++ Standard Library
+#include <stdexcept>
+
+namespace
+{
+    /**
+     * Below this many models the traversal runs on the calling thread;
+     * waking the pool would cost more than the visits
+     */
+    const std::size_t parallelModels = 64;
+}
+
+class tgModelTraversal::VisitTask : public tgThreadPool::Task
+{
+public:
+    VisitTask(const std::vector<const tgModel*>& models,
+              const tgModelVisitor& visitor) :
+        m_models(models),
+        m_visitor(visitor)
+    {
+    }
+
+    virtual void operator()(std::size_t item)
+    {
+        m_models[item]->accept(m_visitor);
+    }
+
+private:
+    const std::vector<const tgModel*>& m_models;
+    const tgModelVisitor& m_visitor;
+};
+
+tgModelTraversal::tgModelTraversal(tgThreadPool& pool) :
+    m_pool(pool)
+{
+}
+
+void tgModelTraversal::visit(const tgModel& root,
+                             const tgModelVisitor& visitor)
+{
+    flatten(root);
+    run(visitor);
+}
+
+void tgModelTraversal::visit(const std::vector<tgModel*>& roots,
+                             const tgModelVisitor& visitor)
+{
+    for (std::size_t i = 0; i < roots.size(); i++)
+    {
+        if (roots[i] == NULL)
+        {
+            m_models.clear();
+            throw std::invalid_argument("Model is NULL");
+        }
+        if (!visitor.culls(*roots[i]))
+        {
+            flatten(*roots[i]);
+        }
+    }
+    run(visitor);
+}
+
+void tgModelTraversal::flatten(const tgModel& root)
+{
+    // Cached by the model until its tree changes
+    const std::vector<tgModel*>& descendants = root.getDescendants();
+    m_models.push_back(&root);
+    m_models.insert(m_models.end(), descendants.begin(), descendants.end());
+}
+
+void tgModelTraversal::run(const tgModelVisitor& visitor)
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("tgModelTraversal::run");
+#endif //BT_NO_PROFILE
+    try
+    {
+        if (m_models.size() < parallelModels)
+        {
+            for (std::size_t i = 0; i < m_models.size(); i++)
+            {
+                m_models[i]->accept(visitor);
+            }
+        }
+        else
+        {
+            VisitTask task(m_models, visitor);
+            m_pool.run(task, m_models.size());
+        }
+    }
+    catch (...)
+    {
+        m_models.clear();
+        throw;
+    }
+    m_models.clear();
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_MODEL_TRAVERSAL_H
+#define TG_MODEL_TRAVERSAL_H
+
+/**
+ * @file tgModelTraversal.h
+ * @brief Contains the definition of class tgModelTraversal
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class tgModel;
+class tgModelVisitor;
+class tgThreadPool;
+
+/**
+ * Visits model trees on a tgThreadPool. tgModel::onVisit() recurses
+ * through a tree on one thread; this flattens the tree with
+ * tgModel::getDescendants() and calls tgModel::accept() on the models in
+ * parallel, so sensing, logging and analysis visitors can use several
+ * cores. Each model is visited exactly once, in no particular order, and
+ * the visitor must be safe to call for different models at once.
+ * Models that override onVisit() rather than accept() are visited as
+ * their base class is.
+ * Small trees are visited on the calling thread.
+ * A traversal is not reentrant.
+ */
+class tgModelTraversal
+{
+public:
+
+    /**
+     * @param[in] pool the workers; not owned, and must outlive this
+     */
+    tgModelTraversal(tgThreadPool& pool);
+
+    /**
+     * Visit a model and all of its descendants.
+     * @param[in] root the model
+     * @param[in] visitor the visitor
+     * @throw std::runtime_error if the visitor throws on a worker
+     */
+    void visit(const tgModel& root, const tgModelVisitor& visitor);
+
+    /**
+     * Visit the models and their descendants, skipping the trees whose
+     * root the visitor culls, as tgSimulation::onVisit() does.
+     * @param[in] roots the models; none may be NULL
+     * @param[in] visitor the visitor
+     * @throw std::invalid_argument if a model is NULL
+     * @throw std::runtime_error if the visitor throws on a worker
+     */
+    void visit(const std::vector<tgModel*>& roots,
+               const tgModelVisitor& visitor);
+
+private:
+
+    /** Calls accept() on one model of m_models */
+    class VisitTask;
+
+    /** Append a model and its descendants to m_models */
+    void flatten(const tgModel& root);
+
+    /** Visit m_models and empty it */
+    void run(const tgModelVisitor& visitor);
+
+    tgThreadPool& m_pool;
+
+    /** The flattened trees; kept to reuse the storage */
+    std::vector<const tgModel*> m_models;
+};
+
+#endif  // TG_MODEL_TRAVERSAL_H
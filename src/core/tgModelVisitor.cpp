@@ -0,0 +1,62 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgModelVisitor.cpp
+ * @brief Contains the definitions of members of class tgModelVisitor
+ * $Id$
+ */
+
+// This module
+#include "tgModelVisitor.h"
+// This application
+#include "tgBasicActuator.h"
+#include "tgBox.h"
+#include "tgKinematicActuator.h"
+#include "tgSphere.h"
+#include "tgUnidirComprSprActuator.h"
+
+void tgModelVisitor::render(const tgBaseRigid& rigid) const
+{
+  render(static_cast<const tgModel&>(rigid));
+}
+
+void tgModelVisitor::render(const tgBox& box) const
+{
+  render(static_cast<const tgBaseRigid&>(box));
+}
+
+void tgModelVisitor::render(const tgSphere& sphere) const
+{
+  render(static_cast<const tgBaseRigid&>(sphere));
+}
+
+void tgModelVisitor::render(const tgBasicActuator& actuator) const
+{
+  render(static_cast<const tgSpringCableActuator&>(actuator));
+}
+
+void tgModelVisitor::render(const tgKinematicActuator& actuator) const
+{
+  render(static_cast<const tgSpringCableActuator&>(actuator));
+}
+
+void tgModelVisitor::render(const tgUnidirComprSprActuator& actuator) const
+{
+  render(static_cast<const tgCompressionSpringActuator&>(actuator));
+}
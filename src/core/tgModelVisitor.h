@@ -31,9 +31,20 @@ class tgSpringCableActuator;
 class tgModel;
 class tgRod;
 class tgCompressionSpringActuator;
+class tgBaseRigid;
+class tgBox;
+class tgSphere;
+class tgBasicActuator;
+class tgKinematicActuator;
+class tgUnidirComprSprActuator;
 
 /**
  * Interface for ModelVisitor.
+ * The overloads for the more specific types pass the object on to the
+ * overload for its base class unless they are overridden, so a visitor
+ * written for the general types still sees every object. Visitors given
+ * to tgModelTraversal are called from several threads at once, one
+ * object per call.
  */
 class tgModelVisitor {
     
@@ -65,6 +76,58 @@ public:
    * @param[in] model a const reference to a tgModel to render.
    */
   virtual void render(const tgModel& m) const {};
+
+  /**
+   * Render a tgBaseRigid other than a tgRod, tgBox or tgSphere.
+   * Passes it to render(const tgModel&) unless overridden.
+   * @param[in] rigid a const reference to a tgBaseRigid to render
+   */
+  virtual void render(const tgBaseRigid& rigid) const;
+
+  /**
+   * Render a tgBox. Passes it to render(const tgBaseRigid&) unless
+   * overridden.
+   * @param[in] box a const reference to a tgBox to render
+   */
+  virtual void render(const tgBox& box) const;
+
+  /**
+   * Render a tgSphere. Passes it to render(const tgBaseRigid&) unless
+   * overridden.
+   * @param[in] sphere a const reference to a tgSphere to render
+   */
+  virtual void render(const tgSphere& sphere) const;
+
+  /**
+   * Render a tgBasicActuator. Passes it to
+   * render(const tgSpringCableActuator&) unless overridden.
+   * @param[in] actuator a const reference to a tgBasicActuator to render
+   */
+  virtual void render(const tgBasicActuator& actuator) const;
+
+  /**
+   * Render a tgKinematicActuator. Passes it to
+   * render(const tgSpringCableActuator&) unless overridden.
+   * @param[in] actuator a const reference to a tgKinematicActuator to
+   * render
+   */
+  virtual void render(const tgKinematicActuator& actuator) const;
+
+  /**
+   * Render a tgUnidirComprSprActuator. Passes it to
+   * render(const tgCompressionSpringActuator&) unless overridden.
+   * @param[in] actuator a const reference to a tgUnidirComprSprActuator
+   * to render
+   */
+  virtual void render(const tgUnidirComprSprActuator& actuator) const;
+
+  /**
+   * Called by tgSimulation::onVisit() before visiting each model and
+   * obstacle added to it, e.g. to skip those out of view.
+   * @param[in] model a model given to tgSimulation
+   * @return true to skip the model and its descendants
+   */
+  virtual bool culls(const tgModel& model) const { return false; }
 };
 
 #endif
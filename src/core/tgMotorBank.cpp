@@ -0,0 +1,196 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgMotorBank.cpp
+ * @brief Contains the definitions of members of class tgMotorBank
+ * $Id$
+ */
+
+// This module
+#include "tgMotorBank.h"
+// This application
+#include "tgKinematicActuator.h"
+#include "tgSpringCable.h"
+// The C++ Standard Library
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+tgMotorBank::tgMotorBank()
+{
+}
+
+void tgMotorBank::add(tgKinematicActuator& actuator)
+{
+    const tgKinematicActuator::Config& config = actuator.m_config;
+    m_actuators.push_back(&actuator);
+    m_radius.push_back(config.radius);
+    m_friction.push_back(config.motorFriction);
+    m_inertia.push_back(config.motorInertia);
+    m_maxTension.push_back(config.maxTens);
+    m_targetVelocity.push_back(config.targetVelocity);
+    m_minRestLength.push_back(config.minRestLength);
+    m_backdrivable.push_back(config.backdrivable ? 1.0 : 0.0);
+
+    const std::size_t n = m_actuators.size();
+    m_desiredTorque.resize(n);
+    m_tension.resize(n);
+    m_motorVel.resize(n);
+    m_motorAcc.resize(n);
+    m_appliedTorque.resize(n);
+    m_restLength.resize(n);
+}
+
+void tgMotorBank::clear()
+{
+    m_actuators.clear();
+    m_radius.clear();
+    m_friction.clear();
+    m_inertia.clear();
+    m_maxTension.clear();
+    m_targetVelocity.clear();
+    m_minRestLength.clear();
+    m_backdrivable.clear();
+    m_desiredTorque.clear();
+    m_tension.clear();
+    m_motorVel.clear();
+    m_motorAcc.clear();
+    m_appliedTorque.clear();
+    m_restLength.clear();
+}
+
+void tgMotorBank::integrate(double dt)
+{
+    if (dt <= 0.0)
+    {
+        throw std::invalid_argument("dt is not positive!");
+    }
+    const std::size_t n = m_actuators.size();
+
+    // Gather: the controls and the tension at the current rest length
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const tgKinematicActuator& actuator = *m_actuators[i];
+        m_desiredTorque[i] = actuator.m_desiredTorque;
+        m_tension[i] = actuator.getTension();
+        m_motorVel[i] = actuator.m_motorVel;
+        m_restLength[i] = actuator.m_restLength;
+    }
+
+    // Compute: the same operations, in the same order, as
+    // integrateRestLengthStep() and getAppliedTorque()
+    std::size_t i = 0;
+#ifdef __SSE2__
+    const __m128d vdt = _mm_set1_pd(dt);
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d signMask = _mm_set1_pd(-0.0);
+    for (; i + 2 <= n; i += 2)
+    {
+        const __m128d radius = _mm_loadu_pd(&m_radius[i]);
+        const __m128d vel = _mm_loadu_pd(&m_motorVel[i]);
+        const __m128d desired = _mm_loadu_pd(&m_desiredTorque[i]);
+
+        // Linear torque-speed curve, never below zero
+        __m128d maxTorque = _mm_mul_pd(
+            _mm_mul_pd(_mm_loadu_pd(&m_maxTension[i]), radius),
+            _mm_sub_pd(one, _mm_div_pd(
+                _mm_mul_pd(radius, _mm_andnot_pd(signMask, vel)),
+                _mm_loadu_pd(&m_targetVelocity[i]))));
+        maxTorque = _mm_andnot_pd(_mm_cmplt_pd(maxTorque, zero), maxTorque);
+
+        const __m128d absDesired = _mm_andnot_pd(signMask, desired);
+        const __m128d within = _mm_cmplt_pd(absDesired, maxTorque);
+        const __m128d capped =
+            _mm_mul_pd(_mm_div_pd(desired, absDesired), maxTorque);
+        const __m128d applied = _mm_or_pd(_mm_and_pd(within, desired),
+                                          _mm_andnot_pd(within, capped));
+
+        const __m128d acc = _mm_div_pd(
+            _mm_add_pd(
+                _mm_sub_pd(applied,
+                           _mm_mul_pd(_mm_loadu_pd(&m_friction[i]), vel)),
+                _mm_mul_pd(_mm_loadu_pd(&m_tension[i]), radius)),
+            _mm_loadu_pd(&m_inertia[i]));
+
+        // A motor that is not backdrivable stops instead of lengthening
+        const __m128d newVel = _mm_add_pd(vel, _mm_mul_pd(acc, vdt));
+        const __m128d locked = _mm_andnot_pd(
+            _mm_cmpneq_pd(_mm_loadu_pd(&m_backdrivable[i]), zero),
+            _mm_cmple_pd(_mm_mul_pd(acc, applied), zero));
+        const __m128d stop = _mm_and_pd(locked, _mm_cmpgt_pd(newVel, zero));
+        const __m128d motorVel = _mm_andnot_pd(stop, newVel);
+
+        __m128d rest = _mm_add_pd(_mm_loadu_pd(&m_restLength[i]),
+                                  _mm_mul_pd(_mm_mul_pd(radius, motorVel),
+                                             vdt));
+        const __m128d minRest = _mm_loadu_pd(&m_minRestLength[i]);
+        const __m128d above = _mm_cmpgt_pd(rest, minRest);
+        rest = _mm_or_pd(_mm_and_pd(above, rest),
+                         _mm_andnot_pd(above, minRest));
+
+        _mm_storeu_pd(&m_appliedTorque[i], applied);
+        _mm_storeu_pd(&m_motorAcc[i], acc);
+        _mm_storeu_pd(&m_motorVel[i], motorVel);
+        _mm_storeu_pd(&m_restLength[i], rest);
+    }
+#endif // __SSE2__
+    for (; i < n; ++i)
+    {
+        const double radius = m_radius[i];
+        const double vel = m_motorVel[i];
+        const double desired = m_desiredTorque[i];
+
+        double maxTorque = m_maxTension[i] * radius *
+            (1.0 - radius * std::fabs(vel) / m_targetVelocity[i]);
+        maxTorque = maxTorque < 0.0 ? 0.0 : maxTorque;
+        const double applied = std::fabs(desired) < maxTorque ? desired :
+            desired / std::fabs(desired) * maxTorque;
+
+        const double acc = (applied - m_friction[i] * vel +
+                            m_tension[i] * radius) / m_inertia[i];
+        const double newVel = vel + acc * dt;
+        const bool locked =
+            m_backdrivable[i] == 0.0 && acc * applied <= 0.0;
+        const double motorVel = (locked && newVel > 0.0) ? 0.0 : newVel;
+
+        double rest = m_restLength[i] + radius * motorVel * dt;
+        rest = rest > m_minRestLength[i] ? rest : m_minRestLength[i];
+
+        m_appliedTorque[i] = applied;
+        m_motorAcc[i] = acc;
+        m_motorVel[i] = motorVel;
+        m_restLength[i] = rest;
+    }
+
+    // Scatter
+    for (i = 0; i < n; ++i)
+    {
+        tgKinematicActuator& actuator = *m_actuators[i];
+        actuator.m_appliedTorque = m_appliedTorque[i];
+        actuator.m_motorAcc = m_motorAcc[i];
+        actuator.m_motorVel = m_motorVel[i];
+        actuator.m_restLength = m_restLength[i];
+        actuator.m_springCable->setRestLength(m_restLength[i]);
+    }
+}
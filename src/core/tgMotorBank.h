@@ -0,0 +1,100 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef SRC_CORE_TG_MOTOR_BANK_H
+#define SRC_CORE_TG_MOTOR_BANK_H
+
+/**
+ * @file tgMotorBank.h
+ * @brief Contains the definition of class tgMotorBank
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class tgKinematicActuator;
+
+/**
+ * Structure-of-arrays storage for the motor models of many
+ * tgKinematicActuators. The bank copies each motor's radius, friction,
+ * inertia and limits when it is added. Each step it reads the desired
+ * torque, motor velocity, rest length and tension from the actuators,
+ * advances every motor and rest length in one loop (two motors at a time
+ * with SSE2 where available), and writes the results back, so the
+ * actuators end the step exactly as after
+ * tgKinematicActuator::integrateRestLength().
+ */
+class tgMotorBank
+{
+public:
+
+    /** Construct an empty bank. */
+    tgMotorBank();
+
+    /**
+     * Add an actuator.
+     * @param[in,out] actuator whose motor was deferred with
+     * tgKinematicActuator::deferMotor(); not owned, and must outlive the
+     * bank or be removed with clear()
+     */
+    void add(tgKinematicActuator& actuator);
+
+    /** Remove every actuator. */
+    void clear();
+
+    /** Return the number of actuators. */
+    std::size_t size() const
+    {
+        return m_actuators.size();
+    }
+
+    /**
+     * Advance every motor and rest length by dt, and set the rest length
+     * of each spring cable.
+     * @param[in] dt, must be positive
+     */
+    void integrate(double dt);
+
+private:
+
+    /** The actuators, not owned */
+    std::vector<tgKinematicActuator*> m_actuators;
+
+    // Motor parameters, copied once
+    std::vector<double> m_radius;
+    std::vector<double> m_friction;
+    std::vector<double> m_inertia;
+    std::vector<double> m_maxTension;
+    std::vector<double> m_targetVelocity;
+    std::vector<double> m_minRestLength;
+    /** 1.0 if backdrivable, 0.0 if not */
+    std::vector<double> m_backdrivable;
+
+    // Per step state, gathered from and scattered to the actuators
+    std::vector<double> m_desiredTorque;
+    std::vector<double> m_tension;
+    std::vector<double> m_motorVel;
+    std::vector<double> m_motorAcc;
+    std::vector<double> m_appliedTorque;
+    std::vector<double> m_restLength;
+};
+
+#endif  // SRC_CORE_TG_MOTOR_BANK_H
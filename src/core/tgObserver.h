@@ -27,6 +27,10 @@
  * $Id$
  */
 
+// Forward declarations
+class tgMemoryReport;
+class tgSnapshot;
+
 /**
  * A mixin class which makes its derived class the Subject in the Obsever
  * design pattern. These are typically controllers.
@@ -60,11 +64,57 @@ public:
      */
     virtual void onSetup(Subject& subject) { }
 
+    /**
+     * Notify the observers when the subject has been set up again, after
+     * a teardown, for a new episode. Observers that build their state in
+     * onSetup() can override this to keep what they allocated and only
+     * rewrite parameters and state, as long as onTeardown() leaves it in
+     * place. The default calls onSetup().
+     * @param[in,out] subject the subject being observed
+     */
+    virtual void onReset(Subject& subject) { onSetup(subject); }
+
     /**
      * Notify the observers when a teardown action has occurred.
      * @param[in,out] subject the subject being observed
      */    
     virtual void onTeardown(Subject& subject) { }
+
+    /**
+     * Notify the observers when the subject's state is being stored in a
+     * tgSnapshot. Controllers with internal state (phase, integrators,
+     * targets) should append it here so tgSimulation::restore() can
+     * rewind them along with the physics.
+     * @param[in] subject the subject being observed
+     * @param[in,out] snapshot the snapshot to append to
+     */
+    virtual void onStoreState(Subject& subject, tgSnapshot& snapshot) { }
+
+    /**
+     * Notify the observers when the subject's state is being restored.
+     * Must read exactly what onStoreState() wrote, in the same order.
+     * @param[in,out] subject the subject being observed
+     * @param[in] snapshot the snapshot to read from
+     */
+    virtual void onRestoreState(Subject& subject, const tgSnapshot& snapshot) { }
+
+    /**
+     * Add the memory the observer holds, such as CPG or neural network
+     * state, to a tgMemoryReport, usually as
+     * tgMemoryReport::eControllers.
+     * @param[in] subject the subject being observed
+     * @param[in,out] report the report to add to
+     */
+    virtual void onReportMemory(const Subject& subject,
+                                tgMemoryReport& report) const { }
+
+    /**
+     * Return true if onStep() only touches the subject, its children and
+     * the observer itself, so that it may run on a worker thread at the
+     * same time as the observers of other models. Read when attached.
+     * @see tgSimulation::enableParallelControllers
+     */
+    virtual bool isParallelSafe() const { return false; }
     
 };
    
@@ -0,0 +1,116 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgObserverPass.cpp
+ * @brief Contains the definitions of members of class tgObserverPass
+ * $Id$
+ */
+
+// This module
+#include "tgObserverPass.h"
+// This application
+#include "tgModel.h"
+#include "tgParallelSubject.h"
+// The Bullet Physics library
+#include "LinearMath/btQuickprof.h"
+// The C++ Standard Library
+#include <stdexcept>
+
+class tgObserverPass::StepTask : public tgThreadPool::Task
+{
+public:
+    StepTask(std::vector< std::vector<tgParallelSubject*> >& models, double dt) :
+        m_models(models),
+        m_dt(dt)
+    {
+    }
+
+    virtual void operator()(std::size_t item)
+    {
+        std::vector<tgParallelSubject*>& subjects = m_models[item];
+        for (std::size_t i = 0; i < subjects.size(); ++i)
+        {
+            subjects[i]->notifyParallelStep(m_dt);
+        }
+    }
+
+private:
+    std::vector< std::vector<tgParallelSubject*> >& m_models;
+    const double m_dt;
+};
+
+tgObserverPass::tgObserverPass(std::size_t nThreads) :
+    m_pool(nThreads)
+{
+}
+
+tgObserverPass::~tgObserverPass()
+{
+    release();
+}
+
+void tgObserverPass::add(tgModel& model)
+{
+    std::vector<tgModel*> models = model.getDescendants();
+    models.insert(models.begin(), &model);
+    std::vector<tgParallelSubject*> subjects;
+    for (std::size_t i = 0; i < models.size(); ++i)
+    {
+        // tgSubject is a mixin, so cross cast to it
+        tgParallelSubject* const pSubject =
+            dynamic_cast<tgParallelSubject*>(models[i]);
+        if (pSubject && pSubject->deferParallelObservers(true))
+        {
+            subjects.push_back(pSubject);
+        }
+    }
+    if (!subjects.empty())
+    {
+        m_models.push_back(subjects);
+    }
+}
+
+void tgObserverPass::release()
+{
+    for (std::size_t i = 0; i < m_models.size(); ++i)
+    {
+        for (std::size_t j = 0; j < m_models[i].size(); ++j)
+        {
+            m_models[i][j]->deferParallelObservers(false);
+        }
+    }
+    m_models.clear();
+}
+
+void tgObserverPass::step(double dt)
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("tgObserverPass::step");
+#endif //BT_NO_PROFILE
+    if (dt <= 0.0)
+    {
+        throw std::invalid_argument("dt is not positive");
+    }
+    if (m_models.empty())
+    {
+        return;
+    }
+    StepTask task(m_models, dt);
+    m_pool.run(task, m_models.size());
+}
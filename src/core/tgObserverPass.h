@@ -0,0 +1,100 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_OBSERVER_PASS_H
+#define TG_OBSERVER_PASS_H
+
+/**
+ * @file tgObserverPass.h
+ * @brief Contains the definition of class tgObserverPass
+ * $Id$
+ */
+
+// This application
+#include "tgThreadPool.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class tgModel;
+class tgParallelSubject;
+
+/**
+ * Steps the parallel-safe observers of several models at the same time,
+ * after the world steps and before the models do. The observers of one
+ * model run on one worker, in the order of its subjects, and the models
+ * are spread over a tgThreadPool; step() returns once all are done, so
+ * the next world step waits for every controller. The observers of a
+ * model then run before its notifyStep(), where they used to run, and
+ * before those that are not parallel safe. Calls on the workers are not
+ * timed by tgStepTimes, except as part of the model step.
+ * Used by tgSimulation::enableParallelControllers().
+ */
+class tgObserverPass
+{
+public:
+
+    /**
+     * Construct an empty pass.
+     * @param[in] nThreads the number of threads; 0 selects one per core
+     */
+    tgObserverPass(std::size_t nThreads = 0);
+
+    /** Hands the observers back to any subjects still collected. */
+    ~tgObserverPass();
+
+    /**
+     * Take over the parallel-safe observers of a model and of every
+     * model below it.
+     * @param[in,out] model a model that has been set up
+     */
+    void add(tgModel& model);
+
+    /**
+     * Hand every observer back to its subject and forget them. Must be
+     * called before the models are torn down.
+     */
+    void release();
+
+    /**
+     * Step every collected observer that is due.
+     * @param[in] dt the step size; must be positive
+     * @throw std::invalid_argument if dt is not positive
+     * @throw std::runtime_error if an observer throws
+     */
+    void step(double dt);
+
+    /** Return the number of models with collected observers. */
+    std::size_t size() const
+    {
+        return m_models.size();
+    }
+
+private:
+
+    /** Steps the subjects of one model. */
+    class StepTask;
+
+    tgThreadPool m_pool;
+
+    /** The subjects of each model, in the order they were added. */
+    std::vector< std::vector<tgParallelSubject*> > m_models;
+};
+
+#endif  // TG_OBSERVER_PASS_H
@@ -0,0 +1,204 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_OBSERVER_PIPELINE_H
+#define TG_OBSERVER_PIPELINE_H
+
+/**
+ * @file tgObserverPipeline.h
+ * @brief Definition of the tgObserverPipeline class template
+ * $Id$
+ */
+
+// This application
+#include "tgObserver.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <stdexcept>
+
+/** Fills the unused places of a tgObserverPipeline; never called. */
+template <class Subject>
+class tgNoObserver : public tgObserver<Subject>
+{
+public:
+    virtual void onStep(Subject& subject, double dt) { }
+};
+
+/**
+ * A fixed sequence of up to six observers of known types, such as the
+ * sensor, CPG and actuator mapping of a model whose controller stack
+ * never changes, called in order as one observer. Each observer is
+ * called by its qualified member function, without virtual dispatch, so
+ * the compiler can inline the whole chain into the pipeline's functions;
+ * the observers must therefore be of exactly the types named, not of
+ * classes derived from them.
+ *
+ * A pipeline may be attached to a tgSubject as any observer, for one
+ * virtual call per step instead of one per observer, or be the Pipeline
+ * of a tgSubject<T, Pipeline>, whose notifyStep() calls step() directly.
+ * The observers are not owned. The types are listed without gaps, then
+ * left to default; the core is C++03, without variadic templates.
+ */
+template <class Subject,
+          class O1 = tgNoObserver<Subject>,
+          class O2 = tgNoObserver<Subject>,
+          class O3 = tgNoObserver<Subject>,
+          class O4 = tgNoObserver<Subject>,
+          class O5 = tgNoObserver<Subject>,
+          class O6 = tgNoObserver<Subject> >
+class tgObserverPipeline : public tgObserver<Subject>
+{
+public:
+
+    /** The pipeline of the observers after the first */
+    typedef tgObserverPipeline<Subject, O2, O3, O4, O5, O6> Rest;
+
+    /** The number of observers */
+    static const std::size_t size = Rest::size + 1;
+
+    /**
+     * @param[in] p1 ... p6 the observers, one per type named; not owned
+     * @throw std::invalid_argument if one of them is NULL
+     */
+    explicit tgObserverPipeline(O1* p1, O2* p2 = NULL, O3* p3 = NULL,
+                                O4* p4 = NULL, O5* p5 = NULL, O6* p6 = NULL) :
+        m_pFirst(p1),
+        m_rest(p2, p3, p4, p5, p6)
+    {
+        if (p1 == NULL)
+        {
+            throw std::invalid_argument("NULL observer in a pipeline");
+        }
+    }
+
+    /** Call onStep() of every observer, inlined. */
+    void step(Subject& subject, double dt)
+    {
+        m_pFirst->O1::onStep(subject, dt);
+        m_rest.step(subject, dt);
+    }
+
+    virtual void onStep(Subject& subject, double dt)
+    {
+        step(subject, dt);
+    }
+
+    virtual void onAttach(Subject& subject)
+    {
+        m_pFirst->O1::onAttach(subject);
+        m_rest.onAttach(subject);
+    }
+
+    virtual void onSetup(Subject& subject)
+    {
+        m_pFirst->O1::onSetup(subject);
+        m_rest.onSetup(subject);
+    }
+
+    virtual void onReset(Subject& subject)
+    {
+        m_pFirst->O1::onReset(subject);
+        m_rest.onReset(subject);
+    }
+
+    virtual void onTeardown(Subject& subject)
+    {
+        m_pFirst->O1::onTeardown(subject);
+        m_rest.onTeardown(subject);
+    }
+
+    virtual void onStoreState(Subject& subject, tgSnapshot& snapshot)
+    {
+        m_pFirst->O1::onStoreState(subject, snapshot);
+        m_rest.onStoreState(subject, snapshot);
+    }
+
+    virtual void onRestoreState(Subject& subject, const tgSnapshot& snapshot)
+    {
+        m_pFirst->O1::onRestoreState(subject, snapshot);
+        m_rest.onRestoreState(subject, snapshot);
+    }
+
+    virtual void onReportMemory(const Subject& subject,
+                                tgMemoryReport& report) const
+    {
+        m_pFirst->O1::onReportMemory(subject, report);
+        m_rest.onReportMemory(subject, report);
+    }
+
+    /** @return true if every observer is parallel safe */
+    virtual bool isParallelSafe() const
+    {
+        return m_pFirst->O1::isParallelSafe() && m_rest.isParallelSafe();
+    }
+
+    /** @return the first observer */
+    O1& first() const { return *m_pFirst; }
+
+    /** @return the pipeline of the others */
+    Rest& rest() { return m_rest; }
+
+private:
+
+    /** Not owned, never NULL */
+    O1* const m_pFirst;
+
+    Rest m_rest;
+};
+
+/** The empty pipeline, the end of every other, and does nothing. */
+template <class Subject>
+class tgObserverPipeline<Subject,
+                         tgNoObserver<Subject>, tgNoObserver<Subject>,
+                         tgNoObserver<Subject>, tgNoObserver<Subject>,
+                         tgNoObserver<Subject>, tgNoObserver<Subject> > :
+    public tgObserver<Subject>
+{
+public:
+
+    static const std::size_t size = 0;
+
+    explicit tgObserverPipeline(tgNoObserver<Subject>* p1 = NULL,
+                                tgNoObserver<Subject>* p2 = NULL,
+                                tgNoObserver<Subject>* p3 = NULL,
+                                tgNoObserver<Subject>* p4 = NULL,
+                                tgNoObserver<Subject>* p5 = NULL,
+                                tgNoObserver<Subject>* p6 = NULL)
+    {
+    }
+
+    void step(Subject& subject, double dt) { }
+
+    virtual void onStep(Subject& subject, double dt) { }
+
+    virtual bool isParallelSafe() const { return true; }
+};
+
+template <class Subject, class O1, class O2, class O3, class O4, class O5,
+          class O6>
+const std::size_t
+tgObserverPipeline<Subject, O1, O2, O3, O4, O5, O6>::size;
+
+template <class Subject>
+const std::size_t
+tgObserverPipeline<Subject,
+                   tgNoObserver<Subject>, tgNoObserver<Subject>,
+                   tgNoObserver<Subject>, tgNoObserver<Subject>,
+                   tgNoObserver<Subject>, tgNoObserver<Subject> >::size;
+
+#endif  // TG_OBSERVER_PIPELINE_H
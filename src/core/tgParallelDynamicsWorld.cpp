@@ -0,0 +1,223 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgParallelDynamicsWorld.cpp
+ * @brief Contains the definitions of members of class
+ * tgParallelDynamicsWorld
+ * $Id$
+ */
+
+// This module
+#include "tgParallelDynamicsWorld.h"
+// This application
+#include "tgThreadPool.h"
+// The Bullet Physics library
+#include "BulletCollision/CollisionDispatch/btCollisionObject.h"
+#include "BulletDynamics/ConstraintSolver/btConstraintSolver.h"
+#include "BulletDynamics/ConstraintSolver/btTypedConstraint.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btQuickprof.h"
+// The C++ Standard Library
+#include <cassert>
+
+class tgParallelDynamicsWorld::SolveTask : public tgThreadPool::Task
+{
+public:
+    SolveTask(tgParallelDynamicsWorld& world) : m_world(world) { }
+
+    /**
+     * The pool gives item i to worker i % size(), so each worker always
+     * uses its own solver.
+     */
+    virtual void operator()(std::size_t item)
+    {
+        m_world.solveIsland(item, item % m_world.m_pool.size());
+    }
+
+private:
+    tgParallelDynamicsWorld& m_world;
+};
+
+tgParallelDynamicsWorld::tgParallelDynamicsWorld(btDispatcher* dispatcher,
+        btBroadphaseInterface* pairCache,
+        const btAlignedObjectArray<btConstraintSolver*>& solvers,
+        btCollisionConfiguration* collisionConfiguration,
+        tgThreadPool& pool) :
+    btDiscreteDynamicsWorld(dispatcher, pairCache, solvers[0],
+                            collisionConfiguration),
+    m_pool(pool),
+    m_solvers(solvers),
+    m_nIslands(0),
+    m_unsplitIsland(-1),
+    m_pSolverInfo(NULL)
+{
+    // Precondition
+    assert(static_cast<std::size_t>(m_solvers.size()) == m_pool.size());
+
+    // Postcondition
+    assert(invariant());
+}
+
+tgParallelDynamicsWorld::~tgParallelDynamicsWorld()
+{
+    for (std::size_t i = 0; i < m_islands.size(); ++i)
+    {
+        delete m_islands[i];
+    }
+}
+
+void tgParallelDynamicsWorld::solveConstraints(btContactSolverInfo& solverInfo)
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("tgParallelDynamicsWorld::solveConstraints");
+#endif //BT_NO_PROFILE
+
+    const int nObjects = getNumCollisionObjects();
+    btCollisionObjectArray& objects = getCollisionObjectArray();
+    bool hasKinematic = false;
+    for (int i = 0; i < nObjects && !hasKinematic; ++i)
+    {
+        hasKinematic = objects[i]->isKinematicObject();
+    }
+
+    // Gather the awake islands. Island tags are indices of collision
+    // objects, so they index m_islandIndex directly.
+    m_nIslands = 0;
+    m_unsplitIsland = -1;
+    m_islandIndex.assign(nObjects, -1);
+    m_islandManager->buildAndProcessIslands(getDispatcher(), this, this);
+
+    // Assign each constraint to the island of its dynamic body
+    const int nConstraints = m_constraints.size();
+    for (int i = 0; i < nConstraints; ++i)
+    {
+        btTypedConstraint* const pConstraint = m_constraints[i];
+        int index = m_unsplitIsland;
+        if (index < 0)
+        {
+            const int tagA = pConstraint->getRigidBodyA().getIslandTag();
+            const int tagB = pConstraint->getRigidBodyB().getIslandTag();
+            const int tag = tagA >= 0 ? tagA : tagB;
+            if (tag >= 0 && tag < nObjects)
+            {
+                index = m_islandIndex[tag];
+            }
+        }
+        if (index >= 0)
+        {
+            m_islands[index]->constraints.push_back(pConstraint);
+        }
+    }
+
+    for (int i = 0; i < m_solvers.size(); ++i)
+    {
+        m_solvers[i]->prepareSolve(nObjects, getDispatcher()->getNumManifolds());
+    }
+
+    m_pSolverInfo = &solverInfo;
+    if (hasKinematic)
+    {
+        // Every island goes to the first solver on this thread
+        for (std::size_t i = 0; i < m_nIslands; ++i)
+        {
+            solveIsland(i, 0);
+        }
+    }
+    else
+    {
+        SolveTask task(*this);
+        m_pool.run(task, m_nIslands);
+    }
+    m_pSolverInfo = NULL;
+
+    for (int i = 0; i < m_solvers.size(); ++i)
+    {
+        m_solvers[i]->allSolved(solverInfo, m_debugDrawer);
+    }
+
+    // Postcondition
+    assert(invariant());
+}
+
+void tgParallelDynamicsWorld::processIsland(btCollisionObject** bodies,
+                                            int numBodies,
+                                            btPersistentManifold** manifolds,
+                                            int numManifolds,
+                                            int islandId)
+{
+    if (m_nIslands == m_islands.size())
+    {
+        m_islands.push_back(new Island());
+    }
+    const int index = static_cast<int>(m_nIslands);
+    Island& island = *m_islands[m_nIslands++];
+
+    island.bodies.resize(0);
+    for (int i = 0; i < numBodies; ++i)
+    {
+        island.bodies.push_back(bodies[i]);
+    }
+    island.manifolds.resize(0);
+    for (int i = 0; i < numManifolds; ++i)
+    {
+        island.manifolds.push_back(manifolds[i]);
+    }
+    island.constraints.resize(0);
+
+    if (islandId < 0)
+    {
+        m_unsplitIsland = index;
+    }
+    else if (islandId < static_cast<int>(m_islandIndex.size()))
+    {
+        m_islandIndex[islandId] = index;
+    }
+}
+
+void tgParallelDynamicsWorld::solveIsland(std::size_t index,
+                                          std::size_t worker)
+{
+    assert(index < m_nIslands);
+    assert(worker < static_cast<std::size_t>(m_solvers.size()));
+    Island& island = *m_islands[index];
+    const int nManifolds = island.manifolds.size();
+    const int nConstraints = island.constraints.size();
+    if (nManifolds + nConstraints == 0)
+    {
+        // Nothing to solve; the bodies are integrated by the world
+        return;
+    }
+    m_solvers[worker]->solveGroup(&island.bodies[0],
+                                  island.bodies.size(),
+                                  nManifolds ? &island.manifolds[0] : NULL,
+                                  nManifolds,
+                                  nConstraints ? &island.constraints[0] : NULL,
+                                  nConstraints,
+                                  *m_pSolverInfo,
+                                  m_debugDrawer,
+                                  getDispatcher());
+}
+
+bool tgParallelDynamicsWorld::invariant() const
+{
+    return
+        (m_solvers.size() > 0) &&
+        (m_nIslands <= m_islands.size()) &&
+        (m_pSolverInfo == NULL);
+}
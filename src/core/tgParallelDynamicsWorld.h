@@ -0,0 +1,157 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_PARALLEL_DYNAMICS_WORLD_H
+#define TG_PARALLEL_DYNAMICS_WORLD_H
+
+/**
+ * @file tgParallelDynamicsWorld.h
+ * @brief Contains the definition of class tgParallelDynamicsWorld
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "BulletCollision/CollisionDispatch/btSimulationIslandManager.h"
+#include "BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h"
+#include "LinearMath/btAlignedObjectArray.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class btCollisionObject;
+class btPersistentManifold;
+class btTypedConstraint;
+class tgThreadPool;
+
+/**
+ * A btDiscreteDynamicsWorld that solves its simulation islands
+ * concurrently. Bodies in different islands share no contacts or
+ * constraints, so each island can be handed to its own solver. Tensegrity
+ * rods are coupled by cable forces rather than constraints, so a large
+ * model usually breaks into one island per rod or cluster of touching
+ * rods, which spreads well over the threads.
+ *
+ * Collision detection and integration stay serial. Bullet's profiler is
+ * not thread safe, so Bullet and NTRT must both be built with
+ * BT_NO_PROFILE (see BULLET_NO_PROFILE in conf/bullet.conf and
+ * USE_NO_PROFILE in src/inc.CMakeBullet.txt). Worlds that contain
+ * kinematic bodies are solved serially, since a kinematic body can touch
+ * several islands at once.
+ */
+class tgParallelDynamicsWorld : public btDiscreteDynamicsWorld,
+                                private btSimulationIslandManager::IslandCallback
+{
+public:
+
+    /**
+     * The only constructor.
+     * @param[in] dispatcher the collision dispatcher
+     * @param[in] pairCache the broadphase
+     * @param[in] solvers one constraint solver per thread of pool; the
+     * first is also the world's main solver. Not owned.
+     * @param[in] collisionConfiguration the collision configuration
+     * @param[in] pool the threads that solve the islands. Not owned.
+     */
+    tgParallelDynamicsWorld(btDispatcher* dispatcher,
+                            btBroadphaseInterface* pairCache,
+                            const btAlignedObjectArray<btConstraintSolver*>& solvers,
+                            btCollisionConfiguration* collisionConfiguration,
+                            tgThreadPool& pool);
+
+    /** Deletes the island buffers. */
+    virtual ~tgParallelDynamicsWorld();
+
+protected:
+
+    /**
+     * Gather the awake islands with their manifolds and constraints,
+     * then solve them on the thread pool.
+     * @param[in] solverInfo the world's solver settings
+     */
+    virtual void solveConstraints(btContactSolverInfo& solverInfo);
+
+private:
+
+    /** The bodies, contacts and constraints of one island. */
+    struct Island
+    {
+        btAlignedObjectArray<btCollisionObject*> bodies;
+        btAlignedObjectArray<btPersistentManifold*> manifolds;
+        btAlignedObjectArray<btTypedConstraint*> constraints;
+    };
+
+    /**
+     * Copy one island out of the island manager's buffers, which are
+     * reused for the next island.
+     */
+    virtual void processIsland(btCollisionObject** bodies,
+                               int numBodies,
+                               btPersistentManifold** manifolds,
+                               int numManifolds,
+                               int islandId);
+
+    /**
+     * Solve one island.
+     * @param[in] index the island, in [0, m_nIslands)
+     * @param[in] worker the worker running the call, which selects the
+     * solver
+     */
+    void solveIsland(std::size_t index, std::size_t worker);
+
+    /** Runs solveIsland() on the thread pool. */
+    class SolveTask;
+
+    /** Integrity predicate. */
+    bool invariant() const;
+
+private:
+
+    /** The worker threads. Not owned. */
+    tgThreadPool& m_pool;
+
+    /** One solver per worker. Not owned. */
+    btAlignedObjectArray<btConstraintSolver*> m_solvers;
+
+    /**
+     * The islands gathered this step, starting at index 0. Only the
+     * first m_nIslands are in use; the rest are kept to reuse their
+     * storage.
+     */
+    std::vector<Island*> m_islands;
+
+    /** The number of islands gathered this step. */
+    std::size_t m_nIslands;
+
+    /**
+     * Maps a Bullet island tag to an index in m_islands, or -1 if the
+     * island is asleep.
+     */
+    std::vector<int> m_islandIndex;
+
+    /**
+     * The index of the single island passed when the island manager
+     * does not split islands, or -1.
+     */
+    int m_unsplitIsland;
+
+    /** The settings for the current call to solveConstraints(). */
+    const btContactSolverInfo* m_pSolverInfo;
+};
+
+#endif  // TG_PARALLEL_DYNAMICS_WORLD_H
@@ -0,0 +1,65 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_PARALLEL_SUBJECT_H
+#define TG_PARALLEL_SUBJECT_H
+
+/**
+ * @file tgParallelSubject.h
+ * @brief Contains the definition of interface class tgParallelSubject
+ * $Id$
+ */
+
+// Forward declarations
+class tgMemoryReport;
+
+/**
+ * What tgObserverPass needs of a tgSubject, whatever its template
+ * argument: to take the parallel-safe observers out of notifyStep() and
+ * to step them itself. tgMemoryReport reaches the observers through it
+ * too.
+ */
+class tgParallelSubject
+{
+public:
+
+    virtual ~tgParallelSubject() { }
+
+    /**
+     * Leave the parallel-safe observers to notifyParallelStep(), or give
+     * them back to notifyStep().
+     * @param[in] defer true to leave them
+     * @return false if there are no parallel-safe observers
+     */
+    virtual bool deferParallelObservers(bool defer) = 0;
+
+    /**
+     * Call onStep() on the parallel-safe observers that are due.
+     * @param[in] dt the number of seconds since the previous call; do
+     * nothing if not positive
+     */
+    virtual void notifyParallelStep(double dt) = 0;
+
+    /**
+     * Call onReportMemory() on all observers.
+     * @param[in,out] report the report to add to
+     */
+    virtual void notifyReportMemory(tgMemoryReport& report) const = 0;
+};
+
+#endif  // TG_PARALLEL_SUBJECT_H
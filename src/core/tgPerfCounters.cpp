@@ -0,0 +1,334 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgPerfCounters.cpp
+ * @brief Contains the definitions of members of class tgPerfCounters
+ * $Id$
+ */
+
+// This module
+#include "tgPerfCounters.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+// Boost
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+
+int tgPerfCounters::s_enabled = 0;
+
+namespace
+{
+    /** The counter group of one thread and the totals it has counted */
+    class ThreadCounters
+    {
+    public:
+
+        ThreadCounters() :
+            nOpen(0)
+        {
+            std::fill(fds, fds + tgPerfCounters::eNumCounters, -1);
+            std::fill(slots, slots + tgPerfCounters::eNumCounters, -1);
+            open();
+        }
+
+        ~ThreadCounters()
+        {
+#ifdef __linux__
+            // Members before the leader
+            for (int c = tgPerfCounters::eNumCounters - 1; c >= 0; c--)
+            {
+                if (fds[c] >= 0)
+                {
+                    close(fds[c]);
+                }
+            }
+#endif
+        }
+
+        /**
+         * Read the group.
+         * @param[out] values the count of each counter, 0 if not open
+         * @param[out] enabled nanoseconds the group has been enabled
+         * @param[out] running nanoseconds it has been counting
+         * @return false if the group couldn't be read
+         */
+        bool read(long long values[], long long& enabled, long long& running)
+        {
+#ifdef __linux__
+            // nr, time enabled, time running, one value per member
+            unsigned long long buffer[3 + tgPerfCounters::eNumCounters];
+            const int leader = leaderFd();
+            const ssize_t size =
+                static_cast<ssize_t>((3 + nOpen) * sizeof(buffer[0]));
+            if (leader < 0 || ::read(leader, buffer, size) != size)
+            {
+                return false;
+            }
+            enabled = static_cast<long long>(buffer[1]);
+            running = static_cast<long long>(buffer[2]);
+            for (int c = 0; c < tgPerfCounters::eNumCounters; c++)
+            {
+                values[c] = (slots[c] < 0) ? 0 :
+                    static_cast<long long>(buffer[3 + slots[c]]);
+            }
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        bool isCounted(tgPerfCounters::Counter c) const
+        {
+            return fds[c] >= 0;
+        }
+
+        /** The number of counters in the group */
+        int nOpen;
+
+        /** Guards totals, which take() reads from other threads */
+        boost::mutex mutex;
+
+        /** By name literal */
+        std::map<const char*, tgPerfCounters::Totals> totals;
+
+    private:
+
+        int leaderFd() const
+        {
+            for (int c = 0; c < tgPerfCounters::eNumCounters; c++)
+            {
+                if (fds[c] >= 0)
+                {
+                    return fds[c];
+                }
+            }
+            return -1;
+        }
+
+        void open()
+        {
+#ifdef __linux__
+            static const unsigned long long configs[tgPerfCounters::eNumCounters] = {
+                PERF_COUNT_HW_CPU_CYCLES,
+                PERF_COUNT_HW_INSTRUCTIONS,
+                PERF_COUNT_HW_CACHE_MISSES,
+                PERF_COUNT_HW_BRANCH_MISSES
+            };
+            int leader = -1;
+            for (int c = 0; c < tgPerfCounters::eNumCounters; c++)
+            {
+                perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = configs[c];
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP |
+                                   PERF_FORMAT_TOTAL_TIME_ENABLED |
+                                   PERF_FORMAT_TOTAL_TIME_RUNNING;
+                // This thread, any CPU
+                const int fd = static_cast<int>(
+                    syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0));
+                if (fd < 0)
+                {
+                    continue;
+                }
+                if (leader < 0)
+                {
+                    leader = fd;
+                }
+                fds[c] = fd;
+                slots[c] = nOpen++;
+            }
+#endif
+        }
+
+        int fds[tgPerfCounters::eNumCounters];
+
+        /** The position of each counter in a read of the group, or -1 */
+        int slots[tgPerfCounters::eNumCounters];
+    };
+
+    /** Guards threads and retired */
+    boost::mutex registryMutex;
+
+    /** The threads that have opened their counters and not exited */
+    std::vector<ThreadCounters*> threads;
+
+    /** The totals of the threads that have exited since the last take() */
+    std::map<std::string, tgPerfCounters::Totals> retired;
+
+    void merge(std::map<std::string, tgPerfCounters::Totals>& to,
+               const std::map<const char*, tgPerfCounters::Totals>& from)
+    {
+        for (std::map<const char*, tgPerfCounters::Totals>::const_iterator it =
+                 from.begin(); it != from.end(); ++it)
+        {
+            to[it->first].add(it->second);
+        }
+    }
+
+    /** Called as a thread exits */
+    void retire(ThreadCounters* pThread)
+    {
+        {
+            boost::mutex::scoped_lock lock(registryMutex);
+            threads.erase(std::remove(threads.begin(), threads.end(), pThread),
+                          threads.end());
+            merge(retired, pThread->totals);
+        }
+        delete pThread;
+    }
+
+    boost::thread_specific_ptr<ThreadCounters> threadCounters(retire);
+
+    ThreadCounters& current()
+    {
+        ThreadCounters* pThread = threadCounters.get();
+        if (!pThread)
+        {
+            pThread = new ThreadCounters();
+            threadCounters.reset(pThread);
+            boost::mutex::scoped_lock lock(registryMutex);
+            threads.push_back(pThread);
+        }
+        return *pThread;
+    }
+
+    /** Guards tgPerfCounters::s_enabled */
+    boost::mutex enabledMutex;
+}
+
+tgPerfCounters::Totals::Totals() :
+    calls(0),
+    items(0)
+{
+    std::fill(counts, counts + eNumCounters, 0);
+    std::fill(counted, counted + eNumCounters, false);
+}
+
+void tgPerfCounters::Totals::add(const Totals& other)
+{
+    calls += other.calls;
+    items += other.items;
+    for (int c = 0; c < eNumCounters; c++)
+    {
+        counts[c] += other.counts[c];
+        counted[c] = counted[c] || other.counted[c];
+    }
+}
+
+double tgPerfCounters::Totals::ipc() const
+{
+    return (counted[eCycles] && counted[eInstructions] && counts[eCycles] > 0) ?
+        static_cast<double>(counts[eInstructions]) / counts[eCycles] : 0.0;
+}
+
+double tgPerfCounters::Totals::perItem(Counter c) const
+{
+    return (c >= 0 && c < eNumCounters && items > 0) ?
+        static_cast<double>(counts[c]) / items : 0.0;
+}
+
+void tgPerfCounters::Scope::start(const char* name, std::size_t items)
+{
+    ThreadCounters& thread = current();
+    if (thread.nOpen > 0 && thread.read(m_start, m_enabled, m_running))
+    {
+        m_pThread = &thread;
+        m_name = name;
+        m_items = items;
+    }
+}
+
+void tgPerfCounters::Scope::stop()
+{
+    ThreadCounters& thread = *static_cast<ThreadCounters*>(m_pThread);
+    long long end[eNumCounters];
+    long long enabled = 0;
+    long long running = 0;
+    if (!thread.read(end, enabled, running))
+    {
+        return;
+    }
+    // Scale up the counts of a multiplexed group
+    const long long ran = running - m_running;
+    const double scale = (ran > 0) ?
+        static_cast<double>(enabled - m_enabled) / ran : 0.0;
+
+    boost::mutex::scoped_lock lock(thread.mutex);
+    Totals& totals = thread.totals[m_name];
+    totals.calls++;
+    totals.items += m_items;
+    for (int c = 0; c < eNumCounters; c++)
+    {
+        const Counter counter = static_cast<Counter>(c);
+        if (thread.isCounted(counter))
+        {
+            totals.counts[c] +=
+                static_cast<long long>(scale * (end[c] - m_start[c]) + 0.5);
+            totals.counted[c] = true;
+        }
+    }
+}
+
+void tgPerfCounters::setEnabled(bool enabled)
+{
+    boost::mutex::scoped_lock lock(enabledMutex);
+    if (enabled || s_enabled > 0)
+    {
+        s_enabled += enabled ? 1 : -1;
+    }
+}
+
+bool tgPerfCounters::isAvailable()
+{
+    const ThreadCounters& thread = current();
+    return thread.isCounted(eCycles) && thread.isCounted(eInstructions);
+}
+
+std::map<std::string, tgPerfCounters::Totals> tgPerfCounters::take()
+{
+    std::map<std::string, Totals> result;
+    boost::mutex::scoped_lock lock(registryMutex);
+    result.swap(retired);
+    for (std::size_t i = 0; i < threads.size(); i++)
+    {
+        boost::mutex::scoped_lock threadLock(threads[i]->mutex);
+        merge(result, threads[i]->totals);
+        threads[i]->totals.clear();
+    }
+    return result;
+}
+
+const char* tgPerfCounters::getName(Counter c)
+{
+    static const char* const names[eNumCounters] = {
+        "cycles", "instructions", "llc_misses", "branch_misses"
+    };
+    return (c >= 0 && c < eNumCounters) ? names[c] : "";
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_PERF_COUNTERS_H
+#define TG_PERF_COUNTERS_H
+
+/**
+ * @file tgPerfCounters.h
+ * @brief Contains the definition of class tgPerfCounters
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <map>
+#include <string>
+
+/**
+ * Hardware performance counters of the profiled scopes: the cycles,
+ * instructions, last level cache misses and branch misses of each Scope,
+ * summed by name over every thread, with the number of items (cables,
+ * bodies) the scope handled so they can be read per item. The NTRT
+ * BT_PROFILE sites that matter for throughput have a Scope of the same
+ * name next to them; Bullet's own scopes can't be hooked.
+ *
+ * Counting is off until setEnabled(true); while off a Scope only tests
+ * a counter. Each thread opens its own group of Linux perf_event
+ * counters, user space only, the first time it enters a Scope while
+ * enabled, and keeps it until it exits. Counters the kernel or the CPU
+ * won't give (virtual machines, perf_event_paranoid above 2) are left
+ * out and reported as not counted; elsewhere than Linux none are.
+ *
+ * Counts are of the thread that entered the Scope, inclusive of nested
+ * scopes, so work handed to a tgThreadPool is counted by the scopes of
+ * its tasks. If the kernel multiplexes the group they are scaled by the
+ * share of the time it ran.
+ */
+class tgPerfCounters
+{
+public:
+
+    enum Counter
+    {
+        eCycles,
+        eInstructions,
+        /** Last level cache misses */
+        eCacheMisses,
+        eBranchMisses,
+        eNumCounters
+    };
+
+    /** The counts of one scope */
+    struct Totals
+    {
+        Totals();
+
+        /** Add the counts of other */
+        void add(const Totals& other);
+
+        /** @return instructions per cycle, or 0 if not counted */
+        double ipc() const;
+
+        /** @return the count of c per item, or 0 if there were no items */
+        double perItem(Counter c) const;
+
+        std::size_t calls;
+
+        /** The items handled over all calls */
+        std::size_t items;
+
+        long long counts[eNumCounters];
+
+        /** True if c had a counter in any of the calls */
+        bool counted[eNumCounters];
+    };
+
+    /** Counts one call of a scope while it lives */
+    class Scope
+    {
+    public:
+
+        /**
+         * @param[in] name the scope's name, a string literal as for
+         * BT_PROFILE
+         * @param[in] items the items the call handles
+         */
+        Scope(const char* name, std::size_t items = 1) :
+            m_pThread(NULL)
+        {
+            if (s_enabled > 0)
+            {
+                start(name, items);
+            }
+        }
+
+        ~Scope()
+        {
+            if (m_pThread)
+            {
+                stop();
+            }
+        }
+
+    private:
+
+        // Not copyable
+        Scope(const Scope&);
+        Scope& operator=(const Scope&);
+
+        void start(const char* name, std::size_t items);
+
+        void stop();
+
+        /** The counters of this thread, or NULL if not counting */
+        void* m_pThread;
+
+        const char* m_name;
+
+        std::size_t m_items;
+
+        long long m_start[eNumCounters];
+
+        long long m_enabled;
+
+        long long m_running;
+    };
+
+    /**
+     * Start or stop counting. Calls nest: counting goes on while more
+     * calls have enabled it than disabled it.
+     */
+    static void setEnabled(bool enabled);
+
+    static bool isEnabled() { return s_enabled > 0; }
+
+    /**
+     * @return true if this thread has, or can open, the cycle and
+     * instruction counters
+     */
+    static bool isAvailable();
+
+    /**
+     * @return the totals of every scope since the last take(), over every
+     * thread including those that have exited, by name; the totals start
+     * over
+     */
+    static std::map<std::string, Totals> take();
+
+    /** @return a short name of c, such as "cycles" */
+    static const char* getName(Counter c);
+
+private:
+
+    /** The number of setEnabled(true) calls less the setEnabled(false) */
+    static int s_enabled;
+};
+
+#endif  // TG_PERF_COUNTERS_H
@@ -0,0 +1,367 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgProfiler.cpp
+ * @brief Contains the definitions of members of class tgProfiler
+ * $Id$
+ */
+
+// This module
+#include "tgProfiler.h"
+// The Bullet Physics library
+#include "LinearMath/btQuickprof.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+namespace
+{
+    /** Bins of the histograms: 20 a decade from 0.1 microseconds */
+    const int binsPerDecade = 20;
+    const double minTime = 1.0e-4;
+    const std::size_t nBins = 8 * binsPerDecade;
+
+    std::size_t binOf(double time)
+    {
+        if (time <= minTime)
+        {
+            return 0;
+        }
+        const double bin = binsPerDecade * std::log10(time / minTime);
+        return std::min(static_cast<std::size_t>(bin), nBins - 1);
+    }
+
+    /** The geometric middle of a bin */
+    double timeOf(std::size_t bin)
+    {
+        return minTime * std::pow(10.0, (bin + 0.5) / binsPerDecade);
+    }
+
+    /** Write a string as a JSON string */
+    void writeString(std::ostream& os, const std::string& s)
+    {
+        os << '"';
+        for (std::size_t i = 0; i < s.size(); i++)
+        {
+            const char c = s[i];
+            if (c == '"' || c == '\\')
+            {
+                os << '\\' << c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                os << "\\u00" << std::hex << std::setw(2) << std::setfill('0')
+                   << static_cast<int>(c) << std::dec << std::setfill(' ');
+            }
+            else
+            {
+                os << c;
+            }
+        }
+        os << '"';
+    }
+}
+
+tgProfiler::Scope::Scope(const std::string& name, int parent,
+                         std::size_t depth) :
+    name(name),
+    parent(parent),
+    depth(depth),
+    steps(0),
+    calls(0),
+    total(0.0),
+    min(0.0),
+    max(0.0),
+    histogram(nBins, 0)
+{
+}
+
+double tgProfiler::Scope::percentile(double p) const
+{
+    if (steps == 0)
+    {
+        return 0.0;
+    }
+    const std::size_t rank =
+        std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(p * steps)));
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < nBins; i++)
+    {
+        count += histogram[i];
+        if (count >= rank)
+        {
+            return std::max(min, std::min(timeOf(i), max));
+        }
+    }
+    return max;
+}
+
+tgProfiler::tgProfiler(const std::string& path,
+                       Format format,
+                       std::size_t maxTraceSteps,
+                       bool counters) :
+    m_path(path),
+    m_format(format),
+    m_maxTraceSteps(maxTraceSteps),
+    m_steps(0),
+    m_traceTime(0.0),
+    m_tracing(maxTraceSteps > 0),
+    m_hasMemory(false),
+    m_countersEnabled(counters)
+{
+    if (path.empty())
+    {
+        throw std::invalid_argument("Profile path is empty");
+    }
+    if (m_countersEnabled)
+    {
+        tgPerfCounters::setEnabled(true);
+        // Forget what was counted before
+        tgPerfCounters::take();
+    }
+}
+
+tgProfiler::~tgProfiler()
+{
+    if (m_countersEnabled)
+    {
+        tgPerfCounters::setEnabled(false);
+    }
+}
+
+void tgProfiler::sample()
+{
+    if (m_countersEnabled)
+    {
+        const std::map<std::string, tgPerfCounters::Totals> counters =
+            tgPerfCounters::take();
+        for (std::map<std::string, tgPerfCounters::Totals>::const_iterator it =
+                 counters.begin(); it != counters.end(); ++it)
+        {
+            m_counters[it->first].add(it->second);
+        }
+    }
+#ifndef BT_NO_PROFILE
+    CProfileIterator* const pIterator = CProfileManager::Get_Iterator();
+    const double duration = sampleChildren(*pIterator, -1, m_traceTime);
+    CProfileManager::Release_Iterator(pIterator);
+
+    m_steps++;
+    m_traceTime += duration;
+    if (m_steps >= m_maxTraceSteps)
+    {
+        m_tracing = false;
+    }
+#endif //BT_NO_PROFILE
+}
+
+double tgProfiler::sampleChildren(CProfileIterator& iterator, int parent,
+                                  double start)
+{
+    double end = start;
+#ifndef BT_NO_PROFILE
+    // Read the children before entering any, which moves the iterator
+    std::vector<const char*> names;
+    std::vector<int> calls;
+    std::vector<double> times;
+    for (iterator.First(); !iterator.Is_Done(); iterator.Next())
+    {
+        names.push_back(iterator.Get_Current_Name());
+        calls.push_back(iterator.Get_Current_Total_Calls());
+        times.push_back(iterator.Get_Current_Total_Time());
+    }
+
+    for (std::size_t i = 0; i < names.size(); i++)
+    {
+        // Nodes stay in the tree after a reset, with no calls
+        if (calls[i] <= 0)
+        {
+            continue;
+        }
+        const std::size_t index = findScope(parent, names[i]);
+        Scope& scope = m_scopes[index];
+        scope.min = (scope.steps == 0) ? times[i] : std::min(scope.min, times[i]);
+        scope.steps++;
+        scope.calls += calls[i];
+        scope.total += times[i];
+        scope.max = std::max(scope.max, times[i]);
+        scope.histogram[binOf(times[i])]++;
+
+        if (m_tracing)
+        {
+            const Event event = { index, end, times[i] };
+            m_events.push_back(event);
+        }
+
+        iterator.Enter_Child(static_cast<int>(i));
+        sampleChildren(iterator, static_cast<int>(index), end);
+        iterator.Enter_Parent();
+
+        end += times[i];
+    }
+#endif //BT_NO_PROFILE
+    return end - start;
+}
+
+std::size_t tgProfiler::findScope(int parent, const char* name)
+{
+    const std::pair<int, const char*> key(parent, name);
+    const std::map<std::pair<int, const char*>, std::size_t>::const_iterator it =
+        m_index.find(key);
+    if (it != m_index.end())
+    {
+        return it->second;
+    }
+    const std::size_t depth =
+        (parent < 0) ? 0 : m_scopes[parent].depth + 1;
+    m_scopes.push_back(Scope(name, parent, depth));
+    m_index[key] = m_scopes.size() - 1;
+    return m_scopes.size() - 1;
+}
+
+void tgProfiler::clear()
+{
+    m_scopes.clear();
+    m_index.clear();
+    m_steps = 0;
+    m_traceTime = 0.0;
+    m_events.clear();
+    m_tracing = m_maxTraceSteps > 0;
+    m_counters.clear();
+}
+
+void tgProfiler::setMemoryReport(const tgMemoryReport& report)
+{
+    m_memory = report;
+    m_hasMemory = true;
+}
+
+void tgProfiler::write() const
+{
+    std::ofstream os(m_path.c_str());
+    if (!os)
+    {
+        throw std::runtime_error("Can't open profile: " + m_path);
+    }
+    os << std::setprecision(9);
+    if (m_format == eChromeTrace)
+    {
+        writeChromeTrace(os);
+    }
+    else
+    {
+        writeJSON(os);
+    }
+    if (!os)
+    {
+        throw std::runtime_error("Can't write profile: " + m_path);
+    }
+}
+
+void tgProfiler::writeJSON(std::ostream& os) const
+{
+    os << "{\n  \"steps\": " << m_steps << ",\n  \"unit\": \"ms\",\n"
+       << "  \"scopes\": [";
+    for (std::size_t i = 0; i < m_scopes.size(); i++)
+    {
+        const Scope& scope = m_scopes[i];
+
+        std::string path = scope.name;
+        for (int p = scope.parent; p >= 0; p = m_scopes[p].parent)
+        {
+            path = m_scopes[p].name + "/" + path;
+        }
+
+        os << (i == 0 ? "\n" : ",\n") << "    {\"name\": ";
+        writeString(os, scope.name);
+        os << ", \"path\": ";
+        writeString(os, path);
+        os << ", \"depth\": " << scope.depth
+           << ", \"steps\": " << scope.steps
+           << ", \"calls\": " << scope.calls
+           << ", \"total\": " << scope.total
+           << ", \"min\": " << scope.min
+           << ", \"mean\": " << scope.total / scope.steps
+           << ", \"p50\": " << scope.percentile(0.5)
+           << ", \"p99\": " << scope.percentile(0.99)
+           << ", \"max\": " << scope.max << "}";
+    }
+    os << "\n  ]";
+    if (m_hasMemory)
+    {
+        os << ",\n  \"memory\": ";
+        m_memory.writeJSON(os, "  ");
+    }
+    if (m_countersEnabled)
+    {
+        os << ",\n  \"counters\": ";
+        writeCounters(os);
+    }
+    os << "\n}\n";
+}
+
+void tgProfiler::writeCounters(std::ostream& os) const
+{
+    os << "{\"available\": "
+       << (tgPerfCounters::isAvailable() ? "true" : "false")
+       << ", \"scopes\": [";
+    std::size_t i = 0;
+    for (std::map<std::string, tgPerfCounters::Totals>::const_iterator it =
+             m_counters.begin(); it != m_counters.end(); ++it, ++i)
+    {
+        const tgPerfCounters::Totals& totals = it->second;
+        os << (i == 0 ? "\n" : ",\n") << "    {\"name\": ";
+        writeString(os, it->first);
+        os << ", \"calls\": " << totals.calls
+           << ", \"items\": " << totals.items;
+        for (int c = 0; c < tgPerfCounters::eNumCounters; c++)
+        {
+            const tgPerfCounters::Counter counter =
+                static_cast<tgPerfCounters::Counter>(c);
+            if (totals.counted[c])
+            {
+                os << ", \"" << tgPerfCounters::getName(counter) << "\": "
+                   << totals.counts[c]
+                   << ", \"" << tgPerfCounters::getName(counter)
+                   << "_per_item\": " << totals.perItem(counter);
+            }
+        }
+        os << ", \"ipc\": " << totals.ipc() << "}";
+    }
+    os << "\n  ]}";
+}
+
+void tgProfiler::writeChromeTrace(std::ostream& os) const
+{
+    os << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    for (std::size_t i = 0; i < m_events.size(); i++)
+    {
+        const Event& event = m_events[i];
+        // Microseconds
+        os << (i == 0 ? "\n" : ",\n") << "{\"name\": ";
+        writeString(os, m_scopes[event.scope].name);
+        os << ", \"ph\": \"X\", \"pid\": 1, \"tid\": 1"
+           << ", \"ts\": " << 1000.0 * event.start
+           << ", \"dur\": " << 1000.0 * event.duration << "}";
+    }
+    os << "\n]}\n";
+}
@@ -0,0 +1,222 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_PROFILER_H
+#define TG_PROFILER_H
+
+/**
+ * @file tgProfiler.h
+ * @brief Contains the definition of class tgProfiler
+ * $Id$
+ */
+
+// This application
+#include "tgMemoryReport.h"
+#include "tgPerfCounters.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Forward declarations
+class CProfileIterator;
+
+/**
+ * Collects the BT_PROFILE scopes of NTRT and of Bullet, which all land in
+ * Bullet's CProfileManager tree, into statistics per simulation step:
+ * the calls, total, minimum, mean, median, 99th percentile and maximum time of
+ * each scope over the steps it ran in. Give one to tgSimView::setProfiler()
+ * and tgSimulation::step() samples it after every step; tgSimView
+ * writes it at every teardown, so it works with every view, headless or
+ * not.
+ *
+ * Bullet resets the tree at the start of each stepSimulation(), which
+ * tgSimulation::step() calls first, so a sample sees the whole world step
+ * and everything after it. Percentiles come from a histogram with 20
+ * bins a decade, so they are good to about 6%.
+ *
+ * The Chrome trace format (chrome://tracing, Perfetto) holds the first
+ * maxTraceSteps steps. The tree has durations, not start times, so each
+ * scope is placed right after its previous sibling, and each step right
+ * after the previous one.
+ *
+ * The JSON also has the tgMemoryReport given to setMemoryReport(), which
+ * tgSimulation does at every teardown, as "memory", and, if counters is
+ * set, the tgPerfCounters of each counted scope as "counters": the
+ * cycles, instructions, instructions per cycle, last level cache misses
+ * and branch misses, in total and per item (cable or body). The counters
+ * are process wide, so only one profiler at a time should have them.
+ *
+ * Nothing is collected if Bullet is built with BT_NO_PROFILE.
+ */
+class tgProfiler
+{
+public:
+
+    /** What write() writes */
+    enum Format
+    {
+        /** The statistics of each scope */
+        eJSON,
+        /** The steps as trace events */
+        eChromeTrace
+    };
+
+    /**
+     * @param[in] path the file that write() replaces
+     * @param[in] format what write() writes
+     * @param[in] maxTraceSteps the number of steps kept for eChromeTrace
+     * @param[in] counters true to enable tgPerfCounters while this lives
+     * @throw std::invalid_argument if path is empty
+     */
+    tgProfiler(const std::string& path,
+               Format format = eJSON,
+               std::size_t maxTraceSteps = 1000,
+               bool counters = false);
+
+    ~tgProfiler();
+
+    /** Add the scopes of the step that just ended. */
+    void sample();
+
+    /** Forget every sample. */
+    void clear();
+
+    /**
+     * Write the samples so far to the file.
+     * @throw std::runtime_error if the file can't be written
+     */
+    void write() const;
+
+    /** @return the number of steps sampled */
+    std::size_t getSteps() const { return m_steps; }
+
+    /** Write this report with the next eJSON, replacing the last one. */
+    void setMemoryReport(const tgMemoryReport& report);
+
+    /** @return the counters of each scope sampled so far, by name */
+    const std::map<std::string, tgPerfCounters::Totals>& getCounters() const
+    {
+        return m_counters;
+    }
+
+private:
+
+    // Not copyable; it holds a tgPerfCounters::setEnabled()
+    tgProfiler(const tgProfiler&);
+    tgProfiler& operator=(const tgProfiler&);
+
+    /** What is known of one node of the profile tree */
+    struct Scope
+    {
+        Scope(const std::string& name, int parent, std::size_t depth);
+
+        /** @return the time below which a fraction p of the steps took */
+        double percentile(double p) const;
+
+        std::string name;
+
+        /** The index of the parent scope, or -1 at the top */
+        int parent;
+
+        std::size_t depth;
+
+        /** The steps the scope was called in */
+        std::size_t steps;
+
+        std::size_t calls;
+
+        /** Milliseconds, over all steps */
+        double total;
+
+        double min;
+
+        double max;
+
+        /** Counts of the step times, in logarithmic bins */
+        std::vector<std::size_t> histogram;
+    };
+
+    /** A scope in one step of the trace */
+    struct Event
+    {
+        std::size_t scope;
+        double start;
+        double duration;
+    };
+
+    /**
+     * Add the children of the iterator's current parent, and their
+     * children, to the statistics and the trace.
+     * @param[in,out] iterator an iterator of the profile tree
+     * @param[in] parent the index of the parent scope, or -1
+     * @param[in] start the start of the parent in the trace
+     * @return the summed time of the children
+     */
+    double sampleChildren(CProfileIterator& iterator, int parent,
+                          double start);
+
+    /** @return the index of the scope, added if it is new */
+    std::size_t findScope(int parent, const char* name);
+
+    void writeJSON(std::ostream& os) const;
+
+    void writeChromeTrace(std::ostream& os) const;
+
+    void writeCounters(std::ostream& os) const;
+
+    const std::string m_path;
+
+    const Format m_format;
+
+    const std::size_t m_maxTraceSteps;
+
+    std::vector<Scope> m_scopes;
+
+    /**
+     * Index of the scopes by parent and name. BT_PROFILE names are
+     * string literals, so the pointers identify them.
+     */
+    std::map<std::pair<int, const char*>, std::size_t> m_index;
+
+    std::size_t m_steps;
+
+    /** The end of the last step in the trace, in milliseconds */
+    double m_traceTime;
+
+    /** The first maxTraceSteps steps */
+    std::vector<Event> m_events;
+
+    /** True while the trace is being recorded */
+    bool m_tracing;
+
+    tgMemoryReport m_memory;
+
+    /** True once setMemoryReport() has been called */
+    bool m_hasMemory;
+
+    /** True if this enabled tgPerfCounters */
+    const bool m_countersEnabled;
+
+    std::map<std::string, tgPerfCounters::Totals> m_counters;
+};
+
+#endif  // TG_PROFILER_H
@@ -0,0 +1,160 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgRBChain.cpp
+ * @brief Contains the definitions of members of class tgRBChain
+ * $Id$
+ */
+
+// This module
+#include "tgRBChain.h"
+// This application
+#include "tgBulletUtil.h"
+#include "tgWorld.h"
+// The Bullet Physics library
+#include "BulletDynamics/ConstraintSolver/btTypedConstraint.h"
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+// The C++ Standard Library
+#include <cassert>
+#include <stdexcept>
+
+tgRBChain::Config::Config(std::size_t segments,
+                          double chainFraction,
+                          const tgRod::Config& rodConfig,
+                          const tgBasicActuator::Config& cableConfig) :
+    segments(segments),
+    chainFraction(chainFraction),
+    rodConfig(rodConfig),
+    cableConfig(cableConfig)
+{
+    if (segments == 0)
+    {
+        throw std::invalid_argument("A chain needs a segment");
+    }
+    if (chainFraction <= 0.0 || chainFraction >= 1.0)
+    {
+        throw std::invalid_argument("chainFraction must be in (0, 1)");
+    }
+}
+
+tgRBChain::tgRBChain(tgWorld& world,
+                     const tgTags& tags,
+                     const std::vector<tgRod*>& segments,
+                     tgBasicActuator* first,
+                     tgBasicActuator* last,
+                     const std::vector<btTypedConstraint*>& joints,
+                     double chainLength) :
+    tgModel(tags),
+    m_world(world),
+    m_joints(joints),
+    m_segments(segments.size()),
+    m_chainLength(chainLength)
+{
+    if (first == NULL || last == NULL)
+    {
+        throw std::invalid_argument("Pointer to end actuator is NULL");
+    }
+    if (segments.empty() || joints.size() + 1 != segments.size())
+    {
+        throw std::invalid_argument("Segments and joints do not match");
+    }
+    if (chainLength <= 0.0)
+    {
+        throw std::invalid_argument("Chain length is not positive");
+    }
+
+    for (std::size_t i = 0; i < segments.size(); i++)
+    {
+        addChild(segments[i]);
+    }
+    addChild(first);
+    addChild(last);
+    m_pEnds[0] = first;
+    m_pEnds[1] = last;
+
+    // Postcondition
+    assert(invariant());
+}
+
+tgRBChain::~tgRBChain()
+{
+    // teardown() already removed them from the world
+    for (std::size_t i = 0; i < m_joints.size(); i++)
+    {
+        delete m_joints[i];
+    }
+}
+
+void tgRBChain::teardown()
+{
+    // The segments' bodies go with the world, so the joints go first
+    btDynamicsWorld& dynamicsWorld = tgBulletUtil::worldToDynamicsWorld(m_world);
+    for (std::size_t i = 0; i < m_joints.size(); i++)
+    {
+        dynamicsWorld.removeConstraint(m_joints[i]);
+        delete m_joints[i];
+    }
+    m_joints.clear();
+    
+    tgModel::teardown();
+    m_pEnds[0] = NULL;
+    m_pEnds[1] = NULL;
+}
+
+void tgRBChain::setControlInput(double input)
+{
+    if (input < 0.0)
+    {
+        throw std::invalid_argument("Rest length is negative.");
+    }
+    const double each = input > m_chainLength ?
+        (input - m_chainLength) / 2.0 : 0.0;
+    getEnd(0).setControlInput(each);
+    getEnd(1).setControlInput(each);
+}
+
+double tgRBChain::getCurrentLength() const
+{
+    return getEnd(0).getCurrentLength() + m_chainLength +
+        getEnd(1).getCurrentLength();
+}
+
+double tgRBChain::getRestLength() const
+{
+    return getEnd(0).getRestLength() + m_chainLength + getEnd(1).getRestLength();
+}
+
+double tgRBChain::getTension() const
+{
+    return (getEnd(0).getTension() + getEnd(1).getTension()) / 2.0;
+}
+
+tgBasicActuator& tgRBChain::getEnd(std::size_t i) const
+{
+    if (i > 1 || m_pEnds[i] == NULL)
+    {
+        throw std::out_of_range("No such end");
+    }
+    return *m_pEnds[i];
+}
+
+bool tgRBChain::invariant() const
+{
+    return m_segments > 0 && m_chainLength > 0.0;
+}
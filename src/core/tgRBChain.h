@@ -0,0 +1,162 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_RB_CHAIN_H
+#define TG_RB_CHAIN_H
+
+/**
+ * @file tgRBChain.h
+ * @brief Contains the definition of class tgRBChain
+ * $Id$
+ */
+
+// This application
+#include "tgBasicActuator.h"
+#include "tgModel.h"
+#include "tgRod.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class btTypedConstraint;
+class tgWorld;
+
+/**
+ * A string of rigid segments, for strings that need contact along their
+ * length. tgRBString in dev joined its segments with springs, so each
+ * segment paid for a rigid body and four springs, and the stiff springs
+ * between light segments limited the time step. Here neighbouring
+ * segments share a ball joint, which the world's constraint solver
+ * solves together with the contacts, and the stretch of the whole
+ * string is lumped into two tgBasicActuators that join the ends of the
+ * chain to the bodies the string connects. With the MLCP solvers of
+ * tgWorld::Config the joints are solved exactly each step.
+ *
+ * The children are the segments, as tgRods, then the two actuators.
+ * Built by tgRBChainInfo.
+ */
+class tgRBChain : public tgModel
+{
+public:
+
+    struct Config
+    {
+        /**
+         * @param[in] segments the number of rigid segments; must be
+         * positive
+         * @param[in] chainFraction the part of the string's starting
+         * length taken by the segments; must be in (0, 1)
+         * @param[in] rodConfig the radius, density and friction of the
+         * segments
+         * @param[in] cableConfig stiffness, damping and pretension of the
+         * whole string, and the motor of the end actuators
+         * @throw std::invalid_argument if a value is out of range
+         */
+        Config(std::size_t segments = 10,
+               double chainFraction = 0.8,
+               const tgRod::Config& rodConfig = tgRod::Config(0.01, 1300.0),
+               const tgBasicActuator::Config& cableConfig =
+                   tgBasicActuator::Config());
+
+        std::size_t segments;
+
+        double chainFraction;
+
+        tgRod::Config rodConfig;
+
+        tgBasicActuator::Config cableConfig;
+    };
+
+    /**
+     * @param[in] world the world the joints are in
+     * @param[in] tags the tags of the string
+     * @param[in] segments the segments from the first end; become
+     * children
+     * @param[in] first the actuator from the first body to the chain;
+     * becomes a child
+     * @param[in] last the actuator from the chain to the second body;
+     * becomes a child
+     * @param[in] joints the ball joints between the segments, already
+     * added to the world; owned from now on
+     * @param[in] chainLength the length of the segments end to end
+     * @throw std::invalid_argument if a pointer is NULL, if there isn't
+     * one joint less than there are segments or if chainLength is not
+     * positive
+     */
+    tgRBChain(tgWorld& world,
+              const tgTags& tags,
+              const std::vector<tgRod*>& segments,
+              tgBasicActuator* first,
+              tgBasicActuator* last,
+              const std::vector<btTypedConstraint*>& joints,
+              double chainLength);
+
+    virtual ~tgRBChain();
+
+    /** Removes the joints from the world and deletes them */
+    virtual void teardown();
+
+    /**
+     * Move the rest length of the string towards input, with the motors
+     * of the end actuators.
+     * @param[in] input the rest length of the whole string; the part
+     * that is not the chain is shared by the two ends
+     * @throw std::invalid_argument if input is negative
+     */
+    void setControlInput(double input);
+
+    /** @return the length of the string from end to end */
+    double getCurrentLength() const;
+
+    /** @return the rest length of the string */
+    double getRestLength() const;
+
+    /** @return the tension of the string, averaged over the two ends */
+    double getTension() const;
+
+    /** @return the length of the segments end to end */
+    double getChainLength() const { return m_chainLength; }
+
+    /** @return the number of segments */
+    std::size_t getSegments() const { return m_segments; }
+
+    /**
+     * @param[in] i 0 for the first end, 1 for the last
+     * @return the actuator at that end
+     */
+    tgBasicActuator& getEnd(std::size_t i) const;
+
+private:
+
+    bool invariant() const;
+
+    tgWorld& m_world;
+
+    /** The ball joints between neighbouring segments. Owned. */
+    std::vector<btTypedConstraint*> m_joints;
+
+    /** The actuators at the two ends; children, so not owned */
+    tgBasicActuator* m_pEnds[2];
+
+    const std::size_t m_segments;
+
+    const double m_chainLength;
+};
+
+#endif  // TG_RB_CHAIN_H
@@ -0,0 +1,150 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgRandom.cpp
+ * @brief Contains the definition of members of class tgRandom
+ * $Id$
+ */
+
+// This module
+#include "tgRandom.h"
+// This library
+#include "tgLog.h"
+// Boost
+#include <boost/thread/mutex.hpp>
+// The C++ Standard Library
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+// POSIX
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace
+{
+    /** The finalizer of splitmix64, which spreads every input bit */
+    boost::uint64_t mix(boost::uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ull;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBull;
+        x ^= x >> 31;
+        return x;
+    }
+
+    boost::mutex& seedMutex()
+    {
+        static boost::mutex mutex;
+        return mutex;
+    }
+
+    bool hasMasterSeed = false;
+    boost::uint64_t masterSeed = 0;
+} // namespace
+
+tgRandom::tgRandom(Purpose purpose, boost::uint64_t index)
+{
+    seed(purpose, index, getMasterSeed());
+}
+
+tgRandom::tgRandom(Purpose purpose, boost::uint64_t index, boost::uint64_t seed)
+{
+    this->seed(purpose, index, seed);
+}
+
+void tgRandom::seed(Purpose purpose, boost::uint64_t index, boost::uint64_t seed)
+{
+    // Each purpose keys its own family of streams
+    m_rng.seed(mix(seed + static_cast<boost::uint64_t>(purpose) *
+                   0x9E3779B97F4A7C15ull), index);
+    m_used = 4;
+}
+
+boost::uint32_t tgRandom::next()
+{
+    if (m_used == 4)
+    {
+        m_rng.next(m_block);
+        m_used = 0;
+    }
+    return m_block[m_used++];
+}
+
+boost::uint64_t tgRandom::next64()
+{
+    const boost::uint64_t high = next();
+    return (high << 32) | next();
+}
+
+double tgRandom::uniform()
+{
+    return (next64() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+std::size_t tgRandom::below(std::size_t n)
+{
+    assert(n > 0 && n <= 0xFFFFFFFFull);
+    // Lemire's multiply and shift, whose bias is below n / 2^32
+    return static_cast<std::size_t>((static_cast<boost::uint64_t>(next()) * n) >> 32);
+}
+
+double tgRandom::gaussian()
+{
+    // Box-Muller, with the first sample in (0, 1] so its log is finite
+    const double u = 1.0 - uniform();
+    const double v = uniform();
+    return std::sqrt(-2.0 * std::log(u)) * std::cos(2.0 * M_PI * v);
+}
+
+boost::uint64_t tgRandom::index(boost::uint64_t major, boost::uint64_t minor)
+{
+    return mix(major) ^ minor;
+}
+
+void tgRandom::setMasterSeed(boost::uint64_t seed)
+{
+    boost::mutex::scoped_lock lock(seedMutex());
+    masterSeed = seed;
+    hasMasterSeed = true;
+}
+
+boost::uint64_t tgRandom::getMasterSeed()
+{
+    boost::mutex::scoped_lock lock(seedMutex());
+    if (!hasMasterSeed)
+    {
+        const char* const fromEnvironment = std::getenv("TG_SEED");
+        if (fromEnvironment != NULL && *fromEnvironment != '\0')
+        {
+            masterSeed = std::strtoull(fromEnvironment, NULL, 10);
+        }
+        else
+        {
+            timeval now;
+            gettimeofday(&now, NULL);
+            masterSeed = mix(static_cast<boost::uint64_t>(now.tv_sec) * 1000000 +
+                             now.tv_usec) ^ static_cast<boost::uint64_t>(getpid());
+            TG_LOG_INFO(tgLog::eCore, "Random seed " << masterSeed <<
+                        ", set TG_SEED to repeat the run");
+        }
+        hasMasterSeed = true;
+    }
+    return masterSeed;
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_RANDOM_H
+#define TG_RANDOM_H
+
+/**
+ * @file tgRandom.h
+ * @brief Contains the definition of class tgRandom
+ * $Id$
+ */
+
+// This library
+#include "Philox4x32.h"
+// Boost
+#include <boost/cstdint.hpp>
+// The C++ Standard Library
+#include <cstddef>
+
+/**
+ * A stream of random numbers derived from one master seed. Streams are
+ * Philox4x32 sequences named by a purpose and an index, such as the
+ * terrain of world 3 or the noise of world 3 in its fifth episode, so
+ * what each draws depends only on the seed and its name, never on which
+ * thread runs first or what else drew before. Streams share no state;
+ * one stream must not be used by two threads at once.
+ *
+ * The master seed is that of setMasterSeed(), else the TG_SEED
+ * environment variable, else one chosen from the clock when a stream is
+ * first made, and logged so that the run can be repeated.
+ */
+class tgRandom
+{
+public:
+
+    /** What a stream is for; the purposes never share streams */
+    enum Purpose
+    {
+        /** Anything of one world, indexed by tgWorld::getStream() */
+        eWorld = 1,
+        /** Anything of one trial of a batch or learning run */
+        eTrial,
+        /** Generated terrain and obstacles */
+        eTerrain,
+        /** Generated tags, such as those of compounds */
+        eTags,
+        /** Noise added to sensors, actuators or parameters */
+        eNoise,
+        /** The learning algorithms */
+        eLearning
+    };
+
+    /**
+     * The stream of a purpose and index under the master seed.
+     * @param[in] purpose what the stream is for
+     * @param[in] index which of the purpose's streams, see index()
+     */
+    tgRandom(Purpose purpose, boost::uint64_t index = 0);
+
+    /**
+     * The stream of a purpose and index under a seed of its own, for
+     * results that must not change with the master seed.
+     */
+    tgRandom(Purpose purpose, boost::uint64_t index, boost::uint64_t seed);
+
+    /** @return 32 uniform random bits */
+    boost::uint32_t next();
+
+    /** @return 64 uniform random bits, e.g. to seed another generator */
+    boost::uint64_t next64();
+
+    /** @return a uniform sample in [0, 1) with 53 bit resolution */
+    double uniform();
+
+    /**
+     * @param[in] n the number of outcomes, positive and below 2^32
+     * @return a uniform integer in [0, n)
+     */
+    std::size_t below(std::size_t n);
+
+    /** @return a standard normal sample */
+    double gaussian();
+
+    /** @return the index of a stream named by two numbers */
+    static boost::uint64_t index(boost::uint64_t major, boost::uint64_t minor);
+
+    /** Derive every stream made from now on from seed. */
+    static void setMasterSeed(boost::uint64_t seed);
+
+    /** @return the master seed, choosing it if there is none yet */
+    static boost::uint64_t getMasterSeed();
+
+private:
+
+    void seed(Purpose purpose, boost::uint64_t index, boost::uint64_t seed);
+
+    Philox4x32 m_rng;
+
+    /** The outputs of the last block, of which m_used are taken */
+    boost::uint32_t m_block[4];
+    unsigned int m_used;
+};
+
+#endif  // TG_RANDOM_H
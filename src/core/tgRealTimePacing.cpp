@@ -0,0 +1,63 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgRealTimePacing.cpp
+ * @brief Contains the definitions of members of class tgRealTimePacing
+ * $Id$
+ */
+
+// This module
+#include "tgRealTimePacing.h"
+// The C++ Standard Library
+#include <stdexcept>
+
+tgRealTimePacing::tgRealTimePacing(double speed, bool catchUp) :
+    m_speed(speed),
+    m_catchUp(catchUp),
+    m_deadline(0.0)
+{
+    if (speed <= 0.0)
+    {
+        throw std::invalid_argument("speed is not positive");
+    }
+}
+
+void tgRealTimePacing::start()
+{
+    tgSimPacing::start();
+    m_deadline = 0.0;
+}
+
+double tgRealTimePacing::pace(double stepSize)
+{
+    m_deadline += stepSize / m_speed;
+    const double lateness = wallTime() - m_deadline;
+    if (lateness > 0.0)
+    {
+        if (!m_catchUp)
+        {
+            m_deadline += lateness;
+        }
+    }
+    else
+    {
+        waitUntil(m_deadline);
+    }
+    return lateness;
+}
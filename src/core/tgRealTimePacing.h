@@ -0,0 +1,72 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_REAL_TIME_PACING_H
+#define TG_REAL_TIME_PACING_H
+
+/**
+ * @file tgRealTimePacing.h
+ * @brief Contains the definition of class tgRealTimePacing
+ * $Id$
+ */
+
+// This module
+#include "tgSimPacing.h"
+
+/**
+ * Paces tgSimView::run() to the wall clock, e.g. for hardware in the
+ * loop: step k is due k step sizes, divided by the speed, after start().
+ * A step that ends early waits for its deadline; one that ends late is
+ * an overrun. After an overrun the schedule either moves on from the
+ * time the step ended, so that the simulation falls behind the wall
+ * clock but keeps its step rate, or keeps the old deadlines and catches
+ * up by stepping without waiting.
+ */
+class tgRealTimePacing : public tgSimPacing
+{
+public:
+
+    /**
+     * @param[in] speed the ratio of simulation time to wall time
+     * @param[in] catchUp true to keep the deadlines after an overrun
+     * @throw std::invalid_argument if speed is not positive
+     */
+    tgRealTimePacing(double speed = 1.0, bool catchUp = false);
+
+    /** Starts the schedule. */
+    virtual void start();
+
+    /** @return the ratio of simulation time to wall time */
+    double getSpeed() const { return m_speed; }
+
+protected:
+
+    /** Wait for the deadline of the step */
+    virtual double pace(double stepSize);
+
+private:
+
+    const double m_speed;
+
+    const bool m_catchUp;
+
+    /** The wall time the next step is due */
+    double m_deadline;
+};
+
+#endif  // TG_REAL_TIME_PACING_H
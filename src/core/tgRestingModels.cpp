@@ -0,0 +1,129 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgRestingModels.cpp
+ * @brief Contains the definitions of members of class tgRestingModels
+ * $Id$
+ */
+
+// This module
+#include "tgRestingModels.h"
+// This application
+#include "tgBaseRigid.h"
+#include "tgBulletSpringCable.h"
+#include "tgBulletSpringCableAnchor.h"
+#include "tgCast.h"
+#include "tgModel.h"
+#include "tgSpringCableActuator.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+// The C++ Standard Library
+#include <set>
+
+namespace
+{
+    /** Static bodies never move, so they don't keep a model awake */
+    void addBody(const btRigidBody* pBody, std::set<const btRigidBody*>& bodies)
+    {
+        if (pBody != NULL && !pBody->isStaticObject())
+        {
+            bodies.insert(pBody);
+        }
+    }
+}
+
+tgRestingModels::tgRestingModels() :
+    m_starts(1, 0),
+    m_numResting(0)
+{
+}
+
+void tgRestingModels::add(const tgModel& model)
+{
+    std::vector<tgModel*> models = model.getDescendants();
+    models.push_back(const_cast<tgModel*>(&model));
+
+    std::set<const btRigidBody*> bodies;
+    for (std::size_t i = 0; i < models.size(); ++i)
+    {
+        tgBaseRigid* const pRigid =
+            tgCast::cast<tgModel, tgBaseRigid>(models[i]);
+        if (pRigid != NULL)
+        {
+            addBody(pRigid->getPRigidBody(), bodies);
+        }
+
+        // Anchored to another model's body, the model moves with it
+        const tgSpringCableActuator* const pActuator =
+            tgCast::cast<tgModel, tgSpringCableActuator>(models[i]);
+        const tgBulletSpringCable* const pCable = (pActuator == NULL) ? NULL :
+            tgCast::cast<const tgSpringCable, const tgBulletSpringCable>(
+                pActuator->getSpringCable());
+        if (pCable != NULL)
+        {
+            const std::vector<tgBulletSpringCableAnchor*>& anchors =
+                pCable->getBulletAnchors();
+            for (std::size_t j = 0; j < anchors.size(); ++j)
+            {
+                addBody(anchors[j]->attachedBody, bodies);
+            }
+        }
+    }
+
+    // Kinematic bodies are moved by their models, so never come to rest
+    bool kinematic = false;
+    for (std::set<const btRigidBody*>::const_iterator it = bodies.begin();
+         it != bodies.end(); ++it)
+    {
+        kinematic = kinematic || (*it)->isKinematicObject();
+        m_bodies.push_back(*it);
+    }
+    if (kinematic || bodies.empty())
+    {
+        // A model to step every step
+        m_bodies.resize(m_starts.back());
+    }
+    m_starts.push_back(m_bodies.size());
+    m_resting.push_back(0);
+}
+
+void tgRestingModels::clear()
+{
+    m_bodies.clear();
+    m_starts.assign(1, 0);
+    m_resting.clear();
+    m_numResting = 0;
+}
+
+void tgRestingModels::update()
+{
+    m_numResting = 0;
+    for (std::size_t i = 0; i < m_resting.size(); ++i)
+    {
+        const std::size_t begin = m_starts[i];
+        const std::size_t end = m_starts[i + 1];
+        bool resting = begin < end;
+        for (std::size_t b = begin; resting && b < end; ++b)
+        {
+            resting = !m_bodies[b]->isActive();
+        }
+        m_resting[i] = resting ? 1 : 0;
+        m_numResting += resting ? 1 : 0;
+    }
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_RESTING_MODELS_H
+#define TG_RESTING_MODELS_H
+
+/**
+ * @file tgRestingModels.h
+ * @brief Contains the definition of class tgRestingModels
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class btRigidBody;
+class tgModel;
+
+/**
+ * Tells which of a list of models are at rest: every Bullet body of the
+ * model and its descendants, and every body its cables are anchored to,
+ * is static or asleep in a deactivated island. A moving body anywhere in
+ * an island wakes the whole island, so a model stays awake while it
+ * touches, or is tied to, anything that moves. Models without bodies are
+ * never at rest.
+ *
+ * Bullet only deactivates a body once it has been still for a while and
+ * nothing has woken it, so with the default cables, which wake their
+ * bodies every step, only models whose cables have sleep thresholds
+ * (tgBulletSpringCable::setSleepThresholds()) and models of bodies alone,
+ * such as obstacles, come to rest. Used by
+ * tgSimulation::enableIslandStepping().
+ */
+class tgRestingModels
+{
+public:
+
+    tgRestingModels();
+
+    /**
+     * Collect the bodies of a model that has been set up, as the next
+     * index.
+     * @param[in] model the model
+     */
+    void add(const tgModel& model);
+
+    /** Forget every model. */
+    void clear();
+
+    /** Find which models are at rest now. */
+    void update();
+
+    /** @return the number of models */
+    std::size_t size() const
+    {
+        return m_resting.size();
+    }
+
+    /**
+     * @param[in] i the index of a model, in the order they were added
+     * @return true if the model was at rest at the last update()
+     */
+    bool isResting(std::size_t i) const
+    {
+        return m_resting[i] != 0;
+    }
+
+    /** @return the number of models at rest at the last update() */
+    std::size_t getNumResting() const
+    {
+        return m_numResting;
+    }
+
+private:
+
+    /** The moving bodies of every model, model by model. Not owned. */
+    std::vector<const btRigidBody*> m_bodies;
+
+    /** Where each model's bodies start in m_bodies, and one past the last */
+    std::vector<std::size_t> m_starts;
+
+    /** Per model: nonzero if it was at rest at the last update() */
+    std::vector<char> m_resting;
+
+    std::size_t m_numResting;
+};
+
+#endif  // TG_RESTING_MODELS_H
@@ -0,0 +1,179 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgRigidPoseBatch.cpp
+ * @brief Contains the definitions of members of class tgRigidPoseBatch
+ * $Id$
+ */
+
+// This module
+#include "tgRigidPoseBatch.h"
+// This application
+#include "tgBaseRigid.h"
+#include "tgCast.h"
+#include "tgModel.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+// The C++ Standard Library
+#include <cassert>
+#include <stdexcept>
+
+tgRigidPoseBatch::tgRigidPoseBatch()
+{
+}
+
+tgRigidPoseBatch::tgRigidPoseBatch(const std::vector<tgBaseRigid*>& rigids)
+{
+    for (std::size_t i = 0; i < rigids.size(); ++i)
+    {
+        assert(rigids[i] != NULL);
+        add(*rigids[i]);
+    }
+}
+
+std::size_t tgRigidPoseBatch::add(tgBaseRigid& rigid)
+{
+    btRigidBody* const pBody = rigid.getPRigidBody();
+    if (pBody == NULL)
+    {
+        throw std::invalid_argument("rigid has no Bullet body");
+    }
+    m_bodies.push_back(pBody);
+    m_position.resize(3 * m_bodies.size());
+    m_orientation.resize(4 * m_bodies.size());
+    m_linearVelocity.resize(3 * m_bodies.size());
+    m_angularVelocity.resize(3 * m_bodies.size());
+    m_mass.push_back(rigid.mass());
+    update();
+    return m_bodies.size() - 1;
+}
+
+void tgRigidPoseBatch::addModel(const tgModel& model)
+{
+    const std::vector<tgBaseRigid*> rigids =
+        tgCast::filter<tgModel, tgBaseRigid>(model.getDescendants());
+    for (std::size_t i = 0; i < rigids.size(); ++i)
+    {
+        add(*rigids[i]);
+    }
+}
+
+void tgRigidPoseBatch::clear()
+{
+    m_bodies.clear();
+    m_position.clear();
+    m_orientation.clear();
+    m_linearVelocity.clear();
+    m_angularVelocity.clear();
+    m_mass.clear();
+}
+
+void tgRigidPoseBatch::update()
+{
+    const std::size_t n = m_bodies.size();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const btRigidBody& body = *m_bodies[i];
+        const btTransform& transform = body.getCenterOfMassTransform();
+        const btVector3& origin = transform.getOrigin();
+        const btQuaternion rotation = transform.getRotation();
+        const btVector3& v = body.getLinearVelocity();
+        const btVector3& w = body.getAngularVelocity();
+
+        double* const p = &m_position[3 * i];
+        p[0] = origin.x();
+        p[1] = origin.y();
+        p[2] = origin.z();
+        double* const q = &m_orientation[4 * i];
+        q[0] = rotation.x();
+        q[1] = rotation.y();
+        q[2] = rotation.z();
+        q[3] = rotation.w();
+        double* const lv = &m_linearVelocity[3 * i];
+        lv[0] = v.x();
+        lv[1] = v.y();
+        lv[2] = v.z();
+        double* const av = &m_angularVelocity[3 * i];
+        av[0] = w.x();
+        av[1] = w.y();
+        av[2] = w.z();
+    }
+}
+
+btVector3 tgRigidPoseBatch::meanPosition(std::size_t begin,
+                                         std::size_t end) const
+{
+    assert(begin <= end && end <= size());
+    btVector3 sum(0.0, 0.0, 0.0);
+    if (begin == end)
+    {
+        return sum;
+    }
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        sum += position(i);
+    }
+    sum /= static_cast<double>(end - begin);
+    return sum;
+}
+
+btVector3 tgRigidPoseBatch::centerOfMass(std::size_t begin,
+                                         std::size_t end) const
+{
+    assert(begin <= end && end <= size());
+    btVector3 moment(0.0, 0.0, 0.0);
+    const double m = totalMass(begin, end);
+    if (m <= 0.0)
+    {
+        return moment;
+    }
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        moment += position(i) * m_mass[i];
+    }
+    return moment / m;
+}
+
+btVector3 tgRigidPoseBatch::centerOfMassVelocity(std::size_t begin,
+                                                 std::size_t end) const
+{
+    assert(begin <= end && end <= size());
+    btVector3 momentum(0.0, 0.0, 0.0);
+    const double m = totalMass(begin, end);
+    if (m <= 0.0)
+    {
+        return momentum;
+    }
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        momentum += linearVelocity(i) * m_mass[i];
+    }
+    return momentum / m;
+}
+
+double tgRigidPoseBatch::totalMass(std::size_t begin, std::size_t end) const
+{
+    assert(begin <= end && end <= size());
+    double m = 0.0;
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        m += m_mass[i];
+    }
+    return m;
+}
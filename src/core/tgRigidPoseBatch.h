@@ -0,0 +1,164 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_RIGID_POSE_BATCH_H
+#define TG_RIGID_POSE_BATCH_H
+
+/**
+ * @file tgRigidPoseBatch.h
+ * @brief Contains the definition of class tgRigidPoseBatch
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "LinearMath/btQuaternion.h"
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class btRigidBody;
+class tgBaseRigid;
+class tgModel;
+
+/**
+ * Contiguous copies of the poses and velocities of many rigid bodies.
+ * update() reads every body's Bullet state in one pass, without the
+ * virtual calls and motion state round trips of tgBaseRigid; sensors and
+ * controllers then compute positions, orientations and velocities of
+ * single bodies or of groups of them from the buffer. Several readers can
+ * share one batch and one update() per step.
+ *
+ * The batch keeps pointers to the Bullet bodies, so it must be rebuilt
+ * when the rigids are torn down.
+ */
+class tgRigidPoseBatch
+{
+public:
+
+    /** Construct an empty batch. */
+    tgRigidPoseBatch();
+
+    /**
+     * Construct a batch of some rigids, in order, and read their state.
+     * @param[in] rigids the rigids
+     * @throw std::invalid_argument if a rigid has no Bullet body
+     */
+    explicit tgRigidPoseBatch(const std::vector<tgBaseRigid*>& rigids);
+
+    /**
+     * Add a rigid at the end and read its state.
+     * @param[in] rigid a rigid that has been set up
+     * @return the index of the rigid in the batch
+     * @throw std::invalid_argument if the rigid has no Bullet body
+     */
+    std::size_t add(tgBaseRigid& rigid);
+
+    /**
+     * Add every rigid among a model's descendants.
+     * @param[in] model the model
+     */
+    void addModel(const tgModel& model);
+
+    /** Remove every rigid. */
+    void clear();
+
+    /** Read the current state of every body into the buffer. */
+    void update();
+
+    /** @return the number of rigids */
+    std::size_t size() const { return m_bodies.size(); }
+
+    /** @return the center of mass of rigid i at the last update */
+    btVector3 position(std::size_t i) const
+    {
+        return btVector3(m_position[3 * i], m_position[3 * i + 1],
+                         m_position[3 * i + 2]);
+    }
+
+    /** @return the orientation of rigid i at the last update */
+    btQuaternion orientation(std::size_t i) const
+    {
+        return btQuaternion(m_orientation[4 * i], m_orientation[4 * i + 1],
+                            m_orientation[4 * i + 2],
+                            m_orientation[4 * i + 3]);
+    }
+
+    /** @return the velocity of the center of mass of rigid i */
+    btVector3 linearVelocity(std::size_t i) const
+    {
+        return btVector3(m_linearVelocity[3 * i],
+                         m_linearVelocity[3 * i + 1],
+                         m_linearVelocity[3 * i + 2]);
+    }
+
+    /** @return the angular velocity of rigid i */
+    btVector3 angularVelocity(std::size_t i) const
+    {
+        return btVector3(m_angularVelocity[3 * i],
+                         m_angularVelocity[3 * i + 1],
+                         m_angularVelocity[3 * i + 2]);
+    }
+
+    /** @return the mass of rigid i, read when it was added */
+    double mass(std::size_t i) const { return m_mass[i]; }
+
+    /**
+     * @return the unweighted mean of the centers of mass of rigids
+     * [begin, end), or zero if the range is empty
+     */
+    btVector3 meanPosition(std::size_t begin, std::size_t end) const;
+
+    /**
+     * @return the center of mass of rigids [begin, end) taken together,
+     * or zero if they have no mass
+     */
+    btVector3 centerOfMass(std::size_t begin, std::size_t end) const;
+
+    /**
+     * @return the velocity of the center of mass of rigids [begin, end)
+     * taken together, or zero if they have no mass
+     */
+    btVector3 centerOfMassVelocity(std::size_t begin, std::size_t end) const;
+
+    /** @return the total mass of rigids [begin, end) */
+    double totalMass(std::size_t begin, std::size_t end) const;
+
+private:
+
+    /** The Bullet bodies, in order */
+    std::vector<btRigidBody*> m_bodies;
+
+    /** x, y, z of each center of mass */
+    std::vector<double> m_position;
+
+    /** x, y, z, w of each orientation */
+    std::vector<double> m_orientation;
+
+    /** x, y, z of each linear velocity */
+    std::vector<double> m_linearVelocity;
+
+    /** x, y, z of each angular velocity */
+    std::vector<double> m_angularVelocity;
+
+    /** The mass of each rigid */
+    std::vector<double> m_mass;
+};
+
+#endif  // TG_RIGID_POSE_BATCH_H
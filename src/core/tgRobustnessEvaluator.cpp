@@ -0,0 +1,240 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgRobustnessEvaluator.cpp
+ * @brief Contains the definitions of members of class tgRobustnessEvaluator
+ * $Id$
+ */
+
+// This module
+#include "tgRobustnessEvaluator.h"
+// This application
+#include "tgBulletUtil.h"
+#include "tgCast.h"
+#include "tgModel.h"
+#include "tgRandom.h"
+#include "tgSimulation.h"
+#include "tgSpringCableActuator.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+tgRobustnessEvaluator::Config::Config(std::size_t clones,
+                                      double stiffnessSpread,
+                                      double frictionSpread,
+                                      double sensorNoise,
+                                      int settleSteps,
+                                      double stepSize,
+                                      std::size_t nThreads,
+                                      const tgWorld::Config& world) :
+clones(clones),
+stiffnessSpread(stiffnessSpread),
+frictionSpread(frictionSpread),
+sensorNoise(sensorNoise),
+settleSteps(settleSteps),
+stepSize(stepSize),
+nThreads(nThreads),
+world(world)
+{
+}
+
+namespace
+{
+    /** Check the config before the batch is made from it. */
+    const tgRobustnessEvaluator::Config&
+    validated(const tgRobustnessEvaluator::Config& config)
+    {
+        if (config.clones == 0)
+        {
+            throw std::invalid_argument("Number of clones is not positive");
+        }
+        else if (config.stepSize <= 0.0)
+        {
+            throw std::invalid_argument("stepSize is not positive");
+        }
+        else if (config.stiffnessSpread < 0.0 ||
+                 config.frictionSpread < 0.0 ||
+                 config.sensorNoise < 0.0)
+        {
+            throw std::invalid_argument("Perturbations can't be negative");
+        }
+        else if (config.settleSteps < 0)
+        {
+            throw std::invalid_argument("settleSteps is negative");
+        }
+        return config;
+    }
+}
+
+tgRobustnessEvaluator::tgRobustnessEvaluator(Factory& factory,
+                                             const Config& config) :
+m_factory(factory),
+m_config(validated(config)),
+m_batch(config.clones, config.world, config.stepSize, config.nThreads)
+{
+    for (std::size_t i = 0; i < m_batch.size(); i++)
+    {
+        build(i);
+    }
+
+    // Settle concurrently, then keep where each clone came to rest
+    m_batch.run(m_config.settleSteps);
+    for (std::size_t i = 0; i < m_batch.size(); i++)
+    {
+        m_starts.push_back(m_batch.getSimulation(i).snapshot());
+    }
+
+    // Postcondition
+    assert(m_perturbations.size() == size());
+    assert(m_starts.size() == size());
+}
+
+void tgRobustnessEvaluator::build(std::size_t clone)
+{
+    tgSimulation& simulation = m_batch.getSimulation(clone);
+    tgRandom rng = m_batch.getWorld(clone).random(tgRandom::eWorld);
+
+    Perturbation perturbation;
+    perturbation.clone = clone;
+    perturbation.friction = std::exp(m_config.frictionSpread * rng.gaussian());
+    perturbation.sensorNoise = m_config.sensorNoise;
+    perturbation.terrainSeed = rng.next64();
+    m_perturbations.push_back(perturbation);
+
+    tgGround* const pGround = m_factory.ground(perturbation);
+    if (pGround != NULL)
+    {
+        simulation.reset(pGround);
+    }
+
+    tgModel* const pModel = m_factory.build(simulation, perturbation);
+    if (pModel == NULL)
+    {
+        throw std::invalid_argument("Factory built a NULL model");
+    }
+    simulation.addModel(pModel);
+
+    // Every cable draws its own factor, in the order of the model's tree
+    if (m_config.stiffnessSpread > 0.0)
+    {
+        const std::vector<tgSpringCableActuator*> cables =
+            tgCast::filter<tgModel, tgSpringCableActuator>(
+                pModel->getDescendants());
+        for (std::size_t i = 0; i < cables.size(); i++)
+        {
+            const double factor =
+                std::exp(m_config.stiffnessSpread * rng.gaussian());
+            cables[i]->setStiffness(cables[i]->getConfig().stiffness * factor);
+        }
+    }
+
+    // Bullet multiplies the frictions of the two bodies in a contact, so
+    // scaling the static ones scales every contact with the terrain once
+    const btDynamicsWorld& dynamicsWorld =
+        tgBulletUtil::worldToDynamicsWorld(m_batch.getWorld(clone));
+    const btCollisionObjectArray& objects =
+        dynamicsWorld.getCollisionObjectArray();
+    for (int i = 0; i < objects.size(); i++)
+    {
+        btCollisionObject* const pObject = objects[i];
+        if (pObject->isStaticObject())
+        {
+            pObject->setFriction(pObject->getFriction() *
+                                 perturbation.friction);
+        }
+    }
+}
+
+tgRobustnessEvaluator::Statistics tgRobustnessEvaluator::evaluate(int steps)
+{
+    m_batch.restore(m_starts);
+    return run(steps);
+}
+
+tgRobustnessEvaluator::Statistics
+tgRobustnessEvaluator::evaluate(const tgSnapshot& state, int steps)
+{
+    m_batch.restore(state);
+    return run(steps);
+}
+
+tgRobustnessEvaluator::Statistics tgRobustnessEvaluator::run(int steps)
+{
+    m_batch.run(steps);
+
+    std::vector<double> scores;
+    for (std::size_t i = 0; i < m_batch.size(); i++)
+    {
+        scores.push_back(m_factory.score(m_batch.getSimulation(i),
+                                         m_perturbations[i]));
+    }
+    return summarize(scores);
+}
+
+tgRobustnessEvaluator::Statistics
+tgRobustnessEvaluator::summarize(const std::vector<double>& scores)
+{
+    if (scores.empty())
+    {
+        throw std::invalid_argument("No scores to summarize");
+    }
+
+    Statistics result;
+    result.scores = scores;
+
+    const std::size_t n = scores.size();
+    double sum = 0.0;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        sum += scores[i];
+    }
+    result.mean = sum / n;
+
+    double squares = 0.0;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const double d = scores[i] - result.mean;
+        squares += d * d;
+    }
+    result.stddev = n > 1 ? std::sqrt(squares / (n - 1)) : 0.0;
+
+    std::vector<double> sorted(scores);
+    std::sort(sorted.begin(), sorted.end());
+    result.min = sorted.front();
+    result.max = sorted.back();
+    result.median = (n % 2 == 1) ? sorted[n / 2] :
+        0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+
+    return result;
+}
+
+const tgRobustnessEvaluator::Perturbation&
+tgRobustnessEvaluator::getPerturbation(std::size_t clone) const
+{
+    if (clone >= m_perturbations.size())
+    {
+        throw std::out_of_range("clone index is out of range");
+    }
+    return m_perturbations[clone];
+}
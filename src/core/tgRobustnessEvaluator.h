@@ -0,0 +1,251 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_ROBUSTNESS_EVALUATOR_H
+#define TG_ROBUSTNESS_EVALUATOR_H
+
+/**
+ * @file tgRobustnessEvaluator.h
+ * @brief Contains the definition of class tgRobustnessEvaluator
+ * $Id$
+ */
+
+// This application
+#include "tgBatchSimulation.h"
+#include "tgSnapshot.h"
+#include "tgWorld.h"
+// Boost
+#include <boost/cstdint.hpp>
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class tgGround;
+class tgModel;
+class tgSimulation;
+
+/**
+ * Scores one controller over many perturbed copies of its world at once,
+ * in one process, instead of one full trial per noise seed. The clones
+ * are the worlds of a tgBatchSimulation, each built once by a Factory
+ * and perturbed for good: its cables' stiffness and the friction of its
+ * ground and static obstacles are scaled by random factors, and the
+ * factory may give it a ground of its own, such as terrain generated
+ * from the clone's seed, and noise to add to its sensors. Each clone's
+ * start is kept as a snapshot, so every evaluate() only restores and
+ * steps the clones, concurrently, and nothing is rebuilt or settled
+ * again between candidates:
+ *
+ *     tgRobustnessEvaluator robust(factory, config);
+ *     for each candidate:
+ *         set the candidate's parameters in the clones' controllers;
+ *         Statistics s = robust.evaluate(steps);
+ *
+ * The perturbations are drawn from each clone's world stream, see
+ * tgWorld::random(), so they depend only on the master seed and the
+ * clone, and every candidate meets the same clones.
+ *
+ * evaluate(state, steps) starts the clones from the state of another
+ * simulation built by the same factory instead, such as one forked by
+ * tgSimulationFork. That returns every body to the state's pose, static
+ * obstacles included, so only a ground's shape then tells the clones'
+ * terrains apart.
+ */
+class tgRobustnessEvaluator
+{
+public:
+
+    /** What is perturbed, and by how much */
+    struct Config
+    {
+        Config(std::size_t clones = 32,
+               double stiffnessSpread = 0.1,
+               double frictionSpread = 0.2,
+               double sensorNoise = 0.0,
+               int settleSteps = 0,
+               double stepSize = 1.0/1000.0,
+               std::size_t nThreads = 0,
+               const tgWorld::Config& world = tgWorld::Config());
+
+        /** The number of clones, positive */
+        std::size_t clones;
+
+        /**
+         * The standard deviation of the log of each cable's stiffness
+         * factor, so factors are always positive; 0 leaves them alone
+         */
+        double stiffnessSpread;
+
+        /** As stiffnessSpread, for one friction factor per clone */
+        double frictionSpread;
+
+        /**
+         * The standard deviation of the noise the factory's controllers
+         * add to their sensors, passed on in Perturbation
+         */
+        double sensorNoise;
+
+        /** Steps each clone takes after it is built, before its start */
+        int settleSteps;
+
+        /** The step size of every clone, positive */
+        double stepSize;
+
+        /** The threads stepping the clones; 0 for one per core */
+        std::size_t nThreads;
+
+        /** The configuration of every clone's world */
+        tgWorld::Config world;
+    };
+
+    /** How one clone differs from the unperturbed world */
+    struct Perturbation
+    {
+        /** Which clone, the index of its world in the batch */
+        std::size_t clone;
+
+        /** The friction factor of the clone's ground and obstacles */
+        double friction;
+
+        /** The standard deviation of the clone's sensor noise */
+        double sensorNoise;
+
+        /** A seed for the clone's terrain, see Factory::ground() */
+        boost::uint64_t terrainSeed;
+    };
+
+    /** Builds the clones and scores them */
+    class Factory
+    {
+    public:
+        virtual ~Factory() { }
+
+        /**
+         * A ground for a clone, such as hills from its terrainSeed.
+         * @return a new ground, owned by the clone's world, or NULL to
+         * keep the default one
+         */
+        virtual tgGround* ground(const Perturbation& perturbation)
+        {
+            return NULL;
+        }
+
+        /**
+         * Build the model of one clone, with its controllers attached,
+         * such as a copy of the one being scored whose sensors read
+         * with perturbation.sensorNoise, drawn from
+         * simulation.getWorld().random(tgRandom::eNoise). Obstacles may
+         * be added to the simulation here.
+         * @return a new model, owned by the simulation
+         */
+        virtual tgModel* build(tgSimulation& simulation,
+                               const Perturbation& perturbation) = 0;
+
+        /**
+         * Score one clone after a run; called on the calling thread.
+         */
+        virtual double score(const tgSimulation& simulation,
+                             const Perturbation& perturbation) = 0;
+    };
+
+    /** The scores of one evaluate(), in clone order, and their summary */
+    struct Statistics
+    {
+        std::vector<double> scores;
+
+        double mean;
+
+        /** The sample standard deviation, 0 for one clone */
+        double stddev;
+
+        double min;
+
+        double max;
+
+        double median;
+    };
+
+    /**
+     * Build, perturb and settle the clones, and keep their starts.
+     * @param[in] factory builds and scores the clones; not owned, it
+     * must outlive this evaluator
+     * @param[in] config what to perturb
+     * @throw std::invalid_argument if config.clones or config.stepSize is
+     * not positive, a spread or the sensor noise is negative, or
+     * config.settleSteps is negative
+     */
+    tgRobustnessEvaluator(Factory& factory, const Config& config = Config());
+
+    /**
+     * Run every clone from its start and score it.
+     * @param[in] steps the number of steps of each run
+     */
+    Statistics evaluate(int steps);
+
+    /**
+     * Run every clone from the state of another simulation whose world
+     * and models were built like the clones', and score it.
+     * @param[in] state a snapshot of that simulation
+     * @param[in] steps the number of steps of each run
+     * @throw std::runtime_error if the state does not match a clone
+     */
+    Statistics evaluate(const tgSnapshot& state, int steps);
+
+    /** @return the summary of a set of scores, which must not be empty */
+    static Statistics summarize(const std::vector<double>& scores);
+
+    /**
+     * @param[in] clone the index of a clone
+     * @throw std::out_of_range if clone is not less than size()
+     */
+    const Perturbation& getPerturbation(std::size_t clone) const;
+
+    /** @return the clones, e.g. to reach their controllers */
+    tgBatchSimulation& getBatch() { return m_batch; }
+
+    const Config& getConfig() const { return m_config; }
+
+    std::size_t size() const { return m_batch.size(); }
+
+private:
+
+    /** Not copyable, the batch owns the clones */
+    tgRobustnessEvaluator(const tgRobustnessEvaluator&);
+    tgRobustnessEvaluator& operator=(const tgRobustnessEvaluator&);
+
+    /** Build and perturb one clone. */
+    void build(std::size_t clone);
+
+    /** Step the restored clones and score them. */
+    Statistics run(int steps);
+
+    Factory& m_factory;
+
+    const Config m_config;
+
+    tgBatchSimulation m_batch;
+
+    /** One per clone */
+    std::vector<Perturbation> m_perturbations;
+
+    /** The start of each clone, taken after settling */
+    std::vector<tgSnapshot> m_starts;
+};
+
+#endif  // TG_ROBUSTNESS_EVALUATOR_H
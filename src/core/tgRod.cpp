@@ -36,12 +36,14 @@
 #include <iostream> //for strings.
 
 tgRod::Config::Config(double r, double d,
-                        double f, double rf, double res) :
+                        double f, double rf, double res,
+                        CollisionProxy cp) :
   radius(r),
   density(d),
   friction(f),
   rollFriction(rf),
-  restitution(res)
+  restitution(res),
+  collisionProxy(cp)
 {
         if (density < 0.0) { throw std::range_error("Negative density"); }
         if (radius < 0.0)  { throw std::range_error("Negative radius");  }
@@ -75,7 +77,7 @@ tgRod::tgRod(btRigidBody* pRigidBody,
 
 tgRod::~tgRod() { }
 
-void tgRod::onVisit(const tgModelVisitor& v) const
+void tgRod::accept(const tgModelVisitor& v) const
 {
     v.render(*this);
     
@@ -52,15 +52,33 @@ public:
     struct Config
     {
             /**
+             * The shape a rod collides as. Whatever the shape, the rod's
+             * mass and inertia are those of its cylinder.
+             */
+            enum CollisionProxy
+            {
+                /** The cylinder itself */
+                cylinderProxy,
+                /** A capsule of the rod's length, caps included */
+                capsuleProxy,
+                /** A string of spheres of the rod's radius */
+                spheresProxy,
+                /** A box of square section around the cylinder */
+                boxProxy
+            };
+
+            /**
          * Initialize with radius and density, which may default.
          * @param[in] radius the rod's radius; must be non-negative
          * @param[in] density the rod's density; must be non-negative
+         * @param[in] cp the shape the rod collides as
          */
             Config(double r = 0.5,
                     double d = 1.0,
                     double f = 1.0,
                     double rf = 0.0,
-                    double res = 0.2);
+                    double res = 0.2,
+                    CollisionProxy cp = cylinderProxy);
 
 
 
@@ -82,6 +100,9 @@ public:
             /** The rod's coefficient of restitution; 
              * must be between 0 and 1 (inclusive). */
             const double restitution;
+
+            /** The shape the rod collides as. */
+            const CollisionProxy collisionProxy;
     };
     
         tgRod(btRigidBody* pRigidBody,
@@ -93,7 +114,7 @@ public:
     
     virtual void teardown();
     
-    virtual void onVisit(const tgModelVisitor& v) const;
+    virtual void accept(const tgModelVisitor& v) const;
     
     /**
      * Return the rod's length in application-dependent units.
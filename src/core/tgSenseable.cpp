@@ -25,6 +25,7 @@
 
 // This module
 #include "tgSenseable.h"
+#include "tgLog.h"
 
 // From the C++ standard library:
 // ...
@@ -38,7 +39,7 @@ std::vector<tgSenseable*> tgSenseable::getSenseableDescendants() const{
   // For this base class, no descendants are present.
   // In fact, this method should never be called, only the subclasses'
   // methods should be called!
-  std::cout << "WARNING! No tgSenseable descendants are present. Are you calling the right function?." << std::endl;
+  TG_LOG_WARN(tgLog::eCore, "No tgSenseable descendants are present. Are you calling the right function?.");
   return std::vector<tgSenseable*>();
 }
 
@@ -0,0 +1,130 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgSettleCache.cpp
+ * @brief Contains the definitions of members of class tgSettleCache
+ * $Id$
+ */
+
+// This module
+#include "tgSettleCache.h"
+// This application
+#include "tgSimulation.h"
+#include "tgSnapshot.h"
+// The C++ Standard Library
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    /** 64 bit FNV-1a, which is stable across platforms and runs. */
+    typedef unsigned long long hash_t;
+
+    void hashBytes(hash_t& hash, const void* data, std::size_t n)
+    {
+        const unsigned char* const bytes =
+            static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    }
+
+    void hashDouble(hash_t& hash, double value)
+    {
+        unsigned char bytes[sizeof(double)];
+        std::memcpy(bytes, &value, sizeof(double));
+        hashBytes(hash, bytes, sizeof(double));
+    }
+}
+
+tgSettleCache::tgSettleCache(const std::string& directory) :
+    m_directory(directory)
+{
+    if (!m_directory.empty() && m_directory[m_directory.size() - 1] != '/')
+    {
+        m_directory += '/';
+    }
+}
+
+bool tgSettleCache::settle(tgSimulation& simulation,
+                           const std::string& key,
+                           int steps,
+                           double dt) const
+{
+    if (steps <= 0 || dt <= 0.0)
+    {
+        throw std::invalid_argument("steps and dt must be positive");
+    }
+
+    const std::string fileName = getFileName(key);
+    tgSnapshot cached;
+    if (cached.load(fileName))
+    {
+        // Take the current state first, so a stale entry that fails
+        // partway through can be undone before settling again
+        const tgSnapshot initial = simulation.snapshot();
+        try
+        {
+            simulation.restore(cached);
+            return true;
+        }
+        catch (const std::runtime_error&)
+        {
+            simulation.restore(initial);
+        }
+    }
+
+    for (int i = 0; i < steps; ++i)
+    {
+        simulation.step(dt);
+    }
+    simulation.snapshot().save(fileName);
+    return false;
+}
+
+std::string tgSettleCache::makeKey(const std::string& description,
+                                   const tgWorld::Config& config,
+                                   int steps,
+                                   double dt)
+{
+    hash_t hash = 14695981039346656037ULL;
+    hashBytes(hash, description.data(), description.size());
+    hashDouble(hash, config.gravity);
+    hashDouble(hash, config.worldSize);
+    hashDouble(hash, config.solverType);
+    hashDouble(hash, config.solverIterations);
+    hashDouble(hash, config.splitImpulse);
+    hashDouble(hash, config.broadphaseType);
+    hashDouble(hash, config.maxBroadphaseHandles);
+    hashDouble(hash, steps);
+    hashDouble(hash, dt);
+
+    std::ostringstream os;
+    os << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return os.str();
+}
+
+std::string tgSettleCache::getFileName(const std::string& key) const
+{
+    return m_directory + "settle_" + key + ".snap";
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_SETTLE_CACHE_H
+#define TG_SETTLE_CACHE_H
+
+/**
+ * @file tgSettleCache.h
+ * @brief Contains the definition of class tgSettleCache
+ * $Id$
+ */
+
+// This application
+#include "tgWorld.h"
+// The C++ Standard Library
+#include <string>
+
+// Forward declarations
+class tgSimulation;
+
+/**
+ * Saves the state of a simulation after its initial relaxation period so
+ * later runs can load it instead of stepping through the same settling
+ * again. Entries are tgSnapshot files named by a hash of a model
+ * description (typically the contents of the YAML or JSON file that
+ * built the model), the tgWorld::Config, the number of steps and dt.
+ *
+ * Controllers that count the settling time themselves need to implement
+ * tgObserver::onStoreState() and onRestoreState(), or they will wait
+ * for the settling period again after the state is loaded.
+ */
+class tgSettleCache
+{
+public:
+
+    /**
+     * Construct a cache that keeps its files in a directory.
+     * @param[in] directory an existing directory, or "" for the current
+     * working directory
+     */
+    tgSettleCache(const std::string& directory = "");
+
+    /**
+     * Bring the simulation to its settled state. If a matching cache
+     * entry exists it is restored; otherwise the simulation is stepped
+     * and the result saved. An entry that no longer matches the
+     * simulation (the model changed but the description did not) is
+     * replaced. Data managers only see the settling steps when the
+     * entry is missing.
+     * @param[in,out] simulation a freshly set up or reset simulation
+     * @param[in] key a key from makeKey()
+     * @param[in] steps the number of settling steps; must be positive
+     * @param[in] dt the step size; must be positive
+     * @return true if the settled state was loaded from the cache
+     * @throw std::invalid_argument if steps or dt is not positive
+     */
+    bool settle(tgSimulation& simulation,
+                const std::string& key,
+                int steps,
+                double dt) const;
+
+    /**
+     * Build a cache key.
+     * @param[in] description anything that identifies the model, such
+     * as the contents of its YAML file and the controller parameters
+     * that affect settling
+     * @param[in] config the world configuration
+     * @param[in] steps the number of settling steps
+     * @param[in] dt the step size
+     * @return a 16 digit hexadecimal string
+     */
+    static std::string makeKey(const std::string& description,
+                               const tgWorld::Config& config,
+                               int steps,
+                               double dt);
+
+    /**
+     * Return the file that holds the entry for a key.
+     * @param[in] key a key from makeKey()
+     */
+    std::string getFileName(const std::string& key) const;
+
+private:
+
+    /** The directory holding the cache files, with a trailing '/'. */
+    std::string m_directory;
+};
+
+#endif  // TG_SETTLE_CACHE_H
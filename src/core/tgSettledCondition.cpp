@@ -0,0 +1,76 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgSettledCondition.cpp
+ * @brief Contains the implementation of class tgSettledCondition
+ * $Id$
+ */
+
+// This module
+#include "tgSettledCondition.h"
+#include "tgRigidPoseBatch.h"
+#include "tgSimulation.h"
+#include "tgStateFrame.h"
+// The C++ Standard Library
+#include <stdexcept>
+
+tgSettledCondition::tgSettledCondition(double speed, double duration,
+                                       double grace) :
+m_speed(speed),
+m_duration(duration),
+m_grace(grace),
+m_time(0.0),
+m_stillTime(0.0)
+{
+    if (speed <= 0.0 || duration < 0.0 || grace < 0.0)
+    {
+        throw std::invalid_argument("Settled speed must be positive, duration and grace can't be negative");
+    }
+}
+
+void tgSettledCondition::start(const tgSimulation& simulation)
+{
+    m_time = 0.0;
+    m_stillTime = 0.0;
+}
+
+bool tgSettledCondition::shouldStop(const tgSimulation& simulation, double dt)
+{
+    m_time += dt;
+    if (m_time <= m_grace)
+    {
+        return false;
+    }
+
+    const double limit = m_speed * m_speed;
+    for (std::size_t i = 0; i < simulation.getNumModels(); i++)
+    {
+        const tgRigidPoseBatch& poses = simulation.getStateFrame(i).getPoses();
+        for (std::size_t j = 0; j < poses.size(); j++)
+        {
+            if (poses.linearVelocity(j).length2() >= limit)
+            {
+                m_stillTime = 0.0;
+                return false;
+            }
+        }
+    }
+    m_stillTime += dt;
+    return m_stillTime >= m_duration;
+}
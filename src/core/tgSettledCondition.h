@@ -0,0 +1,71 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_SETTLED_CONDITION_H
+#define TG_SETTLED_CONDITION_H
+
+/**
+ * @file tgSettledCondition.h
+ * @brief Contains the definition of class tgSettledCondition
+ * $Id$
+ */
+
+// This module
+#include "tgStopCondition.h"
+
+/**
+ * Stops a run once every body of every model has moved slower than a
+ * speed for a while: a robot that has fallen over or got stuck, whose
+ * distance will not change any more. Speeds are read from the models'
+ * state frames, so a check costs one pass over their buffers.
+ */
+class tgSettledCondition : public tgStopCondition
+{
+public:
+
+    /**
+     * @param[in] speed the speed of a center of mass below which a body
+     * counts as still, in length units per second
+     * @param[in] duration how long every body must stay still, in seconds
+     * of simulation time
+     * @param[in] grace the simulation time after the start of a run in
+     * which nothing counts, so a model that starts at rest is not stopped
+     * before it gets moving
+     * @throw std::invalid_argument if speed is not positive or duration
+     * or grace is negative
+     */
+    tgSettledCondition(double speed, double duration, double grace = 1.0);
+
+    virtual void start(const tgSimulation& simulation);
+
+    virtual bool shouldStop(const tgSimulation& simulation, double dt);
+
+private:
+
+    const double m_speed;
+    const double m_duration;
+    const double m_grace;
+
+    /** Simulation time since start() */
+    double m_time;
+
+    /** How long every body has been still */
+    double m_stillTime;
+};
+
+#endif  // TG_SETTLED_CONDITION_H
@@ -0,0 +1,122 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgSimPacing.cpp
+ * @brief Contains the definitions of members of class tgSimPacing
+ * $Id$
+ */
+
+// This module
+#include "tgSimPacing.h"
+// The Boost library
+#include <boost/thread/thread.hpp>
+// The C++ Standard Library
+#include <algorithm>
+#include <cmath>
+
+tgSimPacing::Statistics::Statistics() :
+    steps(0),
+    renders(0),
+    overruns(0),
+    meanPeriod(0.0),
+    maxPeriod(0.0),
+    jitter(0.0),
+    maxLateness(0.0)
+{
+}
+
+tgSimPacing::tgSimPacing() :
+    m_lastStep(0.0),
+    m_sumSquares(0.0)
+{
+}
+
+tgSimPacing::~tgSimPacing()
+{
+}
+
+void tgSimPacing::start()
+{
+    m_statistics = Statistics();
+    m_lastStep = 0.0;
+    m_sumSquares = 0.0;
+    m_clock.reset();
+}
+
+void tgSimPacing::stepped(double stepSize)
+{
+    const double lateness = pace(stepSize);
+    const double now = wallTime();
+    const double period = now - m_lastStep;
+    m_lastStep = now;
+
+    Statistics& s = m_statistics;
+    s.steps++;
+    s.meanPeriod += (period - s.meanPeriod) / s.steps;
+    s.maxPeriod = std::max(s.maxPeriod, period);
+    m_sumSquares += period * period;
+    const double variance =
+        m_sumSquares / s.steps - s.meanPeriod * s.meanPeriod;
+    s.jitter = (variance > 0.0) ? std::sqrt(variance) : 0.0;
+    if (lateness > 0.0)
+    {
+        s.overruns++;
+        s.maxLateness = std::max(s.maxLateness, lateness);
+    }
+}
+
+bool tgSimPacing::shouldRender(double renderTime, double renderRate)
+{
+    if (renderDue(renderTime, renderRate))
+    {
+        m_statistics.renders++;
+        return true;
+    }
+    return false;
+}
+
+double tgSimPacing::pace(double stepSize)
+{
+    return -1.0;
+}
+
+bool tgSimPacing::renderDue(double renderTime, double renderRate)
+{
+    return renderTime >= renderRate;
+}
+
+double tgSimPacing::wallTime()
+{
+    return m_clock.getTimeMicroseconds() * 1.0e-6;
+}
+
+void tgSimPacing::waitUntil(double time)
+{
+    // Sleeps overshoot by up to a scheduler tick, so spin for the end
+    const double spin = 1.0e-3;
+    const double wait = time - spin - wallTime();
+    if (wait > 0.0)
+    {
+        boost::this_thread::sleep(
+            boost::posix_time::microseconds(static_cast<long>(wait * 1.0e6)));
+    }
+    while (wallTime() < time)
+    {
+    }
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_SIM_PACING_H
+#define TG_SIM_PACING_H
+
+/**
+ * @file tgSimPacing.h
+ * @brief Contains the definition of class tgSimPacing
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "LinearMath/btQuickprof.h"
+// The C++ Standard Library
+#include <cstddef>
+
+/**
+ * Decides when tgSimView::run() renders and how long it waits between
+ * steps, and keeps timing statistics of the run. This base class steps
+ * as fast as possible and renders every renderRate of simulation time,
+ * as tgSimView always has. tgRealTimePacing holds every step to a wall
+ * clock deadline; tgWallClockPacing runs at full speed and renders at
+ * wall clock intervals.
+ */
+class tgSimPacing
+{
+public:
+
+    /** What a run took, in wall clock seconds */
+    struct Statistics
+    {
+        Statistics();
+
+        /** Steps since start() */
+        std::size_t steps;
+
+        /** Frames rendered since start() */
+        std::size_t renders;
+
+        /** Steps that ended after their deadline */
+        std::size_t overruns;
+
+        /** The mean wall time between the ends of steps */
+        double meanPeriod;
+
+        /** The longest wall time between the ends of steps */
+        double maxPeriod;
+
+        /** The standard deviation of that time */
+        double jitter;
+
+        /** How late the latest step was */
+        double maxLateness;
+    };
+
+    tgSimPacing();
+
+    virtual ~tgSimPacing();
+
+    /**
+     * Called by tgSimView::run() before its first step. Clears the
+     * statistics and starts the clock.
+     */
+    virtual void start();
+
+    /**
+     * Called by tgSimView::run() after each step: wait as the policy
+     * requires and update the statistics.
+     * @param[in] stepSize the simulation time of the step
+     */
+    void stepped(double stepSize);
+
+    /**
+     * Called by tgSimView::run() after each step, before stepped().
+     * @param[in] renderTime the simulation time since the last render
+     * @param[in] renderRate the simulation time between renders
+     * @return true if a frame is to be rendered now
+     */
+    bool shouldRender(double renderTime, double renderRate);
+
+    /** @return the statistics since start() */
+    const Statistics& getStatistics() const { return m_statistics; }
+
+protected:
+
+    /**
+     * Wait after a step as the policy requires. Does not wait.
+     * @param[in] stepSize the simulation time of the step
+     * @return how many seconds the step ended after its deadline, or a
+     * negative number if it was on time
+     */
+    virtual double pace(double stepSize);
+
+    /**
+     * The base class renders every renderRate of simulation time.
+     * @param[in] renderTime the simulation time since the last render
+     * @param[in] renderRate the simulation time between renders
+     * @return true if a frame is to be rendered now
+     */
+    virtual bool renderDue(double renderTime, double renderRate);
+
+    /** @return the wall clock seconds since start() */
+    double wallTime();
+
+    /** Wait until wallTime() reaches time */
+    void waitUntil(double time);
+
+private:
+
+    btClock m_clock;
+
+    Statistics m_statistics;
+
+    /** wallTime() at the end of the previous step */
+    double m_lastStep;
+
+    /** The sum of the squared periods, for the jitter */
+    double m_sumSquares;
+};
+
+#endif  // TG_SIM_PACING_H
@@ -27,6 +27,9 @@
 #include "tgSimulation.h"
 // This application
 #include "tgModelVisitor.h"
+#include "tgLog.h"
+#include "tgProfiler.h"
+#include "tgSimPacing.h"
 #include "tgSimView.h"
 // The C++ Standard Library
 #include <cassert>  
@@ -42,6 +45,8 @@ tgSimView::tgSimView(tgWorld& world,
   m_stepSize(stepSize),
   m_renderRate(renderRate),         
   m_renderTime(0.0),
+  m_pPacing(new tgSimPacing()),
+  m_pProfiler(NULL),
   m_initialized(false)
 {
   if (m_stepSize < 0.0)
@@ -71,6 +76,8 @@ tgSimView::~tgSimView()
             teardown();
     }
     delete m_pModelVisitor;
+    delete m_pPacing;
+    delete m_pProfiler;
 }
 
 
@@ -120,6 +127,19 @@ void tgSimView::setup()
 
 void tgSimView::teardown()
 {
+  // This is also called by the destructor, so report rather than throw
+  if (m_pProfiler != NULL)
+  {
+    try
+    {
+      m_pProfiler->write();
+    }
+    catch (const std::runtime_error& e)
+    {
+      std::cerr << e.what() << std::endl;
+    }
+  }
+
   // Just note that this function was called.
   // tgSimViewGraphics needs to know for now.
   m_initialized = false;
@@ -140,20 +160,28 @@ void tgSimView::run(int steps)
     if (m_pSimulation != NULL)
     {
             // The tgSimView has been passed to a tgSimulation
-        std::cout << "SimView::run("<<steps<<")" << std::endl;
+        TG_LOG_INFO(tgLog::eCore, "SimView::run(" << steps << ")");
         // This would normally run forever, but this is just for testing
         m_renderTime = 0;
         double totalTime = 0.0;
+        m_pPacing->start();
         for (int i = 0; i < steps; i++) {
             m_pSimulation->step(m_stepSize);    
             m_renderTime += m_stepSize;
             totalTime += m_stepSize;
             
-            if (m_renderTime >= m_renderRate) {
+            if (m_pPacing->shouldRender(m_renderTime, m_renderRate)) {
                 render();
                 //std::cout << totalTime << std::endl;
                 m_renderTime = 0;
             }
+            m_pPacing->stepped(m_stepSize);
+
+            // A controller ended the episode early
+            if (m_pSimulation->isStopped())
+            {
+                break;
+            }
         }
     }
 }
@@ -185,6 +213,24 @@ void tgSimView::reset()
     }
 }
     
+void tgSimView::setPacing(tgSimPacing* pPacing)
+{
+    delete m_pPacing;
+    m_pPacing = (pPacing != NULL) ? pPacing : new tgSimPacing();
+
+    // Postcondition
+    assert(m_pPacing != NULL);
+}
+
+void tgSimView::setProfiler(tgProfiler* pProfiler)
+{
+    if (pProfiler != m_pProfiler)
+    {
+        delete m_pProfiler;
+        m_pProfiler = pProfiler;
+    }
+}
+
 void tgSimView::setRenderRate(double renderRate)
 {
 	m_renderRate = (renderRate > m_stepSize) ? renderRate : m_stepSize;
@@ -28,6 +28,8 @@
 
 // Forward declarations
 class tgModelVisitor;
+class tgProfiler;
+class tgSimPacing;
 class tgSimulation;
 class tgWorld;
 
@@ -82,7 +84,8 @@ public:
     virtual void run();
 	
 	/**
-	 * Run for a specific number of steps
+	 * Run for a specific number of steps, or until a model calls
+	 * tgModel::requestStop()
 	 */
     virtual void run(int steps);
     
@@ -131,6 +134,36 @@ public:
      * @return the interval in seconds at which the graphics are rendered
      */
     double getStepSize() const { return m_stepSize; }
+
+    /**
+     * Set when run(int) renders and how it waits between steps. The
+     * views that run under GLUT are paced by GLUT instead.
+     * @param[in] pPacing the pacing policy, which the view then owns; NULL
+     * restores the default, which runs as fast as possible and renders
+     * every renderRate of simulation time
+     */
+    void setPacing(tgSimPacing* pPacing);
+
+    /**
+     * Return the pacing policy, with the timing statistics of the latest
+     * run(int).
+     * @return the pacing policy
+     */
+    const tgSimPacing& getPacing() const { return *m_pPacing; }
+
+    /**
+     * Profile every step of the simulation, and write the profile at
+     * every teardown.
+     * @param[in] pProfiler the profiler, which the view then owns, or NULL
+     * to stop profiling
+     */
+    void setProfiler(tgProfiler* pProfiler);
+
+    /**
+     * Return the profiler, sampled by tgSimulation::step().
+     * @return the profiler, or NULL if there is none
+     */
+    tgProfiler* getProfiler() const { return m_pProfiler; }
     
 protected:
 
@@ -203,6 +236,12 @@ protected:
      * It must be non-negative.
      */
     double m_renderTime;
+
+    /** Paces run(int); owned and never NULL */
+    tgSimPacing* m_pPacing;
+
+    /** Samples the steps; owned, or NULL */
+    tgProfiler* m_pProfiler;
     
 private:
 
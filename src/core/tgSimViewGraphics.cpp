@@ -36,7 +36,8 @@
 tgSimViewGraphics::tgSimViewGraphics(tgWorld& world,
                      double stepSize,
                      double renderRate) : 
-  tgSimView(world, stepSize, renderRate)
+  tgSimView(world, stepSize, renderRate),
+  m_pRenderer(NULL)
 {
     /// @todo figure out a good time to delete this
     gDebugDrawer = new tgGLDebugDrawer();
@@ -58,11 +59,11 @@ void tgSimViewGraphics::setup()
         // Just set tgSimView::m_initialized to true
         tgSimView::setup();
 
-        // Cache a pointer to the btSoftRigidDynamicsWorld
+        // Cache a pointer to the btDynamicsWorld
         tgWorld& world = m_pSimulation->getWorld();
         btDynamicsWorld& dynamicsWorld =
                 tgBulletUtil::worldToDynamicsWorld(world);
-        // Store a pointer to the btSoftRigidDynamicsWorld
+        // Store a pointer to the btDynamicsWorld
         // This class is not taking ownership of it
         /// @todo Can this pointer become invalid if a reset occurs?
         m_dynamicsWorld = &dynamicsWorld;
@@ -71,7 +72,8 @@ void tgSimViewGraphics::setup()
         dynamicsWorld.setDebugDrawer(gDebugDrawer);
         
         // @todo Valgrind thinks this is a leak. Perhaps its a GLUT issue?
-        m_pModelVisitor = new tgBulletRenderer(world);
+        m_pRenderer = new tgBatchedRenderer(world);
+        m_pModelVisitor = m_pRenderer;
         std::cout << "setup graphics" << std::endl;
 }
 
@@ -79,6 +81,8 @@ void tgSimViewGraphics::teardown()
 {
     //tgWorld owns this pointer, so we shouldn't delete it
     m_dynamicsWorld = 0;
+    // tgSimView deletes the renderer
+    m_pRenderer = NULL;
     tgSimView::teardown();
 }
 
@@ -91,7 +95,21 @@ void tgSimViewGraphics::render()
             GL_DEPTH_BUFFER_BIT |
             GL_STENCIL_BUFFER_BIT);
         
+        // Skip the models out of the view the lines are drawn with
+        if (m_pRenderer != NULL)
+        {
+            double modelview[16];
+            double projection[16];
+            glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
+            glGetDoublev(GL_PROJECTION_MATRIX, projection);
+            m_pRenderer->setView(modelview, projection);
+        }
         m_pSimulation->onVisit(*m_pModelVisitor);
+        // The demo application draws the bodies
+        if (m_pRenderer != NULL)
+        {
+            m_pRenderer->flush(false);
+        }
 
         //Freeglut code
 #if (0)
@@ -28,7 +28,7 @@
 
 // This application
 #include "tgSimView.h"
-#include "tgBulletRenderer.h"
+#include "tgBatchedRenderer.h"
 // Bullet OpenGL_FreeGlut (patched files)
 #include "tgGlutStuff.h"
 // The Bullet Physics library
@@ -83,7 +83,7 @@ public:
     
     /**
      * Gives us a pointer to the world, sets up the debug drawer for
-     * the dynamics world and sets up a new tgBulletRenderer
+     * the dynamics world and sets up a new tgBatchedRenderer
      */
     void setup();
     
@@ -93,7 +93,8 @@ public:
     void teardown();
     
     /**
-     * Clears the openGL buffer and dispatches a tgBulletRenderer to the world
+     * Clears the openGL buffer, dispatches a tgBatchedRenderer to the world
+     * and draws the cables it collected
      */
     void render();
     
@@ -141,6 +142,10 @@ public:
      */
     virtual void clientResetScene();
 
+protected:
+    /** The model visitor, as its type; owned by tgSimView */
+    tgBatchedRenderer* m_pRenderer;
+
 private:    
     tgGLDebugDrawer*    gDebugDrawer;   
 };
@@ -0,0 +1,188 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgSimViewReplay.cpp
+ * @brief Contains the definitions of members of class tgSimViewReplay
+ * $Id$
+ */
+
+// This module
+#include "tgSimViewReplay.h"
+// Bullet OpenGL_FreeGlut (patched files)
+#include "tgGLDebugDrawer.h"
+
+tgSimViewReplay::tgSimViewReplay(tgWorld& world,
+                                 const std::string& path,
+                                 double renderRate) :
+    tgSimViewGraphics(world, renderRate, renderRate),
+    m_trajectory(path),
+    m_pDrawer(new tgGLDebugDrawer()),
+    m_time(0.0),
+    m_speed(1.0)
+{
+    if (m_trajectory.frames() > 0)
+    {
+        m_time = m_trajectory.time(0);
+    }
+}
+
+tgSimViewReplay::~tgSimViewReplay()
+{
+    delete m_pDrawer;
+}
+
+void tgSimViewReplay::setup()
+{
+    // Just set tgSimView::m_initialized to true. The dynamics world stays
+    // NULL, so renderme() only draws the ground grid and the text.
+    tgSimView::setup();
+    m_dynamicsWorld = 0;
+    m_clock.reset();
+}
+
+void tgSimViewReplay::reset()
+{
+    seek(0.0);
+}
+
+void tgSimViewReplay::render()
+{
+    if (m_trajectory.frames() == 0)
+    {
+        return;
+    }
+    const std::size_t f = m_trajectory.frameAt(m_time);
+
+    const btVector3 bodyColor(0.8, 0.8, 0.8);
+    for (std::size_t i = 0; i < m_trajectory.parts(); i++)
+    {
+        const btTransform transform =
+            m_trajectory.bodyTransform(f, m_trajectory.partBody(i)) *
+            m_trajectory.partTransform(i);
+        const btVector3 size = m_trajectory.partSize(i);
+        switch (m_trajectory.partShape(i))
+        {
+        case tgTrajectoryFile::SHAPE_CYLINDER:
+            m_pDrawer->drawCylinder(size.x(), size.y(),
+                                    static_cast<int>(size.z()),
+                                    transform, bodyColor);
+            break;
+        case tgTrajectoryFile::SHAPE_BOX:
+            m_pDrawer->drawBox(-size, size, transform, bodyColor);
+            break;
+        case tgTrajectoryFile::SHAPE_SPHERE:
+            m_pDrawer->drawSphere(size.x(), transform, bodyColor);
+            break;
+        default:
+            m_pDrawer->drawTransform(transform, 1.0);
+            break;
+        }
+    }
+
+    // The same colors as tgBulletRenderer
+    for (std::size_t i = 0; i < m_trajectory.cables(); i++)
+    {
+        const double stretch = m_trajectory.cableStretch(f, i);
+        const btVector3 color =
+            (stretch < 0.0) ?
+            btVector3(0.0, 0.0, 1.0) :
+            btVector3(0.5 + stretch / 3.0,
+                      0.5 - stretch / 2.0,
+                      0.0);
+        m_pDrawer->drawLine(m_trajectory.cableFrom(f, i),
+                            m_trajectory.cableTo(f, i), color);
+    }
+}
+
+void tgSimViewReplay::clientMoveAndDisplay()
+{
+    if (isInitialzed())
+    {
+        const double wall = m_clock.getTimeMicroseconds() * 1.0e-6;
+        m_clock.reset();
+        seek(m_time + m_speed * wall);
+        displayCallback();
+    }
+}
+
+void tgSimViewReplay::displayCallback()
+{
+    if (isInitialzed())
+    {
+        glClear(GL_COLOR_BUFFER_BIT |
+            GL_DEPTH_BUFFER_BIT |
+            GL_STENCIL_BUFFER_BIT);
+        render();
+        renderme();
+        glFlush();
+        swapBuffers();
+    }
+}
+
+void tgSimViewReplay::clientResetScene()
+{
+    reset();
+}
+
+void tgSimViewReplay::keyboardCallback(unsigned char key, int x, int y)
+{
+    const std::size_t frames = m_trajectory.frames();
+    switch (key)
+    {
+    case '[':
+        m_speed /= 2.0;
+        break;
+    case ']':
+        m_speed *= 2.0;
+        break;
+    case '\\':
+        m_speed = -m_speed;
+        break;
+    case ',':
+        if (frames > 0)
+        {
+            const std::size_t f = m_trajectory.frameAt(m_time);
+            seek(m_trajectory.time(f > 0 ? f - 1 : 0));
+        }
+        break;
+    case '.':
+        if (frames > 0)
+        {
+            const std::size_t f = m_trajectory.frameAt(m_time);
+            seek(m_trajectory.time(f + 1 < frames ? f + 1 : f));
+        }
+        break;
+    default:
+        PlatformDemoApplication::keyboardCallback(key, x, y);
+        break;
+    }
+}
+
+void tgSimViewReplay::seek(double t)
+{
+    const std::size_t frames = m_trajectory.frames();
+    if (frames == 0)
+    {
+        m_time = 0.0;
+        return;
+    }
+    const double first = m_trajectory.time(0);
+    const double last = m_trajectory.time(frames - 1);
+    m_time = (t < first) ? first : ((t > last) ? last : t);
+}
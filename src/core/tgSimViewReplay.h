@@ -0,0 +1,132 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_SIM_VIEW_REPLAY_H
+#define TG_SIM_VIEW_REPLAY_H
+
+/**
+ * @file tgSimViewReplay.h
+ * @brief Contains the definition of class tgSimViewReplay
+ * $Id$
+ */
+
+// This module
+#include "tgSimViewGraphics.h"
+// This application
+#include "tgTrajectoryFile.h"
+// The Bullet Physics library
+#include "LinearMath/btQuickprof.h"
+// The C++ Standard library
+#include <cstddef>
+#include <string>
+
+/**
+ * Plays back a trajectory recorded by tgTrajectoryRecorder in the usual
+ * graphics window, drawing the recorded bodies and cables with the debug
+ * drawer. Nothing is simulated: the world is never stepped, so a long
+ * headless run can be inspected at any speed, in either direction.
+ *
+ * The view still needs a tgSimulation to run; give it one with no
+ * models:
+ * @code
+ * tgWorld world;
+ * tgSimViewReplay view(world, "run.traj");
+ * tgSimulation simulation(view);
+ * simulation.run();
+ * @endcode
+ * Keys: 'i' pauses, '[' and ']' halve and double the speed, '\' reverses
+ * it, ',' and '.' step one frame while paused and the space bar goes
+ * back to the start. The other keys work as in tgSimViewGraphics.
+ */
+class tgSimViewReplay : public tgSimViewGraphics
+{
+public:
+
+    /**
+     * @param[in] world a world for the base class; it is not stepped
+     * @param[in] path the trajectory file
+     * @param[in] renderRate the time interval for updating the graphics
+     * @throw std::runtime_error if the trajectory can't be read
+     */
+    tgSimViewReplay(tgWorld& world,
+                    const std::string& path,
+                    double renderRate = 1.0/60.0);
+
+    virtual ~tgSimViewReplay();
+
+    /** Notes that the view is ready; the world is not drawn. */
+    void setup();
+
+    /** Go back to the start of the trajectory. */
+    void reset();
+
+    /** Draws the bodies and cables of the current frame. */
+    void render();
+
+    /** Advances the playback time with the wall clock, then draws. */
+    virtual void clientMoveAndDisplay();
+
+    /** Draws the current frame without advancing. */
+    virtual void displayCallback();
+
+    /** Goes back to the start of the trajectory. */
+    virtual void clientResetScene();
+
+    /** Handles the playback keys, see the class description. */
+    virtual void keyboardCallback(unsigned char key, int x, int y);
+
+    /**
+     * Jump to a time, clamped to the recorded ones.
+     * @param[in] t a simulation time
+     */
+    void seek(double t);
+
+    /**
+     * @param[in] speed the ratio of playback time to wall time; negative
+     * plays backwards and zero holds the frame
+     */
+    void setSpeed(double speed) { m_speed = speed; }
+
+    /** @return the ratio of playback time to wall time */
+    double getSpeed() const { return m_speed; }
+
+    /** @return the simulation time being shown */
+    double getTime() const { return m_time; }
+
+    /** @return the trajectory being played */
+    const tgTrajectoryFile& getTrajectory() const { return m_trajectory; }
+
+private:
+
+    /** The trajectory. */
+    const tgTrajectoryFile m_trajectory;
+
+    /** Draws the recorded bodies and cables; owned. */
+    tgGLDebugDrawer* m_pDrawer;
+
+    /** Measures the wall time between frames. */
+    btClock m_clock;
+
+    /** The simulation time being shown. */
+    double m_time;
+
+    /** The ratio of playback time to wall time. */
+    double m_speed;
+};
+
+#endif  // TG_SIM_VIEW_REPLAY_H
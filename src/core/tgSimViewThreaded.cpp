@@ -0,0 +1,502 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgSimViewThreaded.cpp
+ * @brief Contains the definitions of members of class tgSimViewThreaded
+ * $Id$
+ */
+
+// This module
+#include "tgSimViewThreaded.h"
+// This application
+#include "tgSimulation.h"
+// Bullet OpenGL_FreeGlut (patched files)
+#include "tgGLDebugDrawer.h"
+// The Bullet Physics library
+#include "BulletCollision/CollisionShapes/btBoxShape.h"
+#include "BulletCollision/CollisionShapes/btCompoundShape.h"
+#include "BulletCollision/CollisionShapes/btSphereShape.h"
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+// Boost
+#include <boost/bind.hpp>
+#include <boost/thread/locks.hpp>
+// The C++ Standard Library
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+struct tgSimViewThreaded::Frame
+{
+    enum Shape
+    {
+        BOX,
+        SPHERE
+    };
+
+    /** A box or sphere of a collision object */
+    struct Part
+    {
+        Shape shape;
+        /** Half extents, or radius */
+        btVector3 size;
+        btTransform transform;
+    };
+
+    /** The markers of the models */
+    struct Sphere
+    {
+        btVector3 center;
+        btScalar radius;
+        btVector3 color;
+    };
+
+    void clear()
+    {
+        parts.clear();
+        batch.clear();
+        spheres.clear();
+    }
+
+    /** Append the parts of a shape at transform */
+    void addShape(const btCollisionShape* pShape, const btTransform& transform)
+    {
+        Part part;
+        part.transform = transform;
+        switch (pShape->getShapeType())
+        {
+        case COMPOUND_SHAPE_PROXYTYPE:
+            {
+                const btCompoundShape* const pCompound =
+                    static_cast<const btCompoundShape*>(pShape);
+                for (int i = 0; i < pCompound->getNumChildShapes(); i++)
+                {
+                    addShape(pCompound->getChildShape(i),
+                             transform * pCompound->getChildTransform(i));
+                }
+            }
+            return;
+        case BOX_SHAPE_PROXYTYPE:
+            part.shape = BOX;
+            part.size =
+                static_cast<const btBoxShape*>(pShape)->getHalfExtentsWithMargin();
+            break;
+        case CYLINDER_SHAPE_PROXYTYPE:
+            // Drawn in one call with the rest
+            tgBatchedRenderer::addCylinders(pShape, transform, batch);
+            return;
+        case SPHERE_SHAPE_PROXYTYPE:
+            part.shape = SPHERE;
+            part.size = btVector3(
+                static_cast<const btSphereShape*>(pShape)->getRadius(), 0.0, 0.0);
+            break;
+        default:
+            return;
+        }
+        parts.push_back(part);
+    }
+
+    std::vector<Part> parts;
+    /** The cylinders, and the lines the models draw */
+    tgBatchedRenderer::Batch batch;
+    std::vector<Sphere> spheres;
+};
+
+class tgSimViewThreaded::Recorder : public btIDebugDraw
+{
+public:
+    Recorder() : m_pFrame(NULL), m_debugMode(0) { }
+
+    /** @param[in] pFrame the frame to add to, or NULL to drop everything */
+    void setFrame(Frame* pFrame) { m_pFrame = pFrame; }
+
+    virtual void drawLine(const btVector3& from, const btVector3& to,
+                          const btVector3& color)
+    {
+        if (m_pFrame != NULL)
+        {
+            const float vertices[6] = { (float)from.x(), (float)from.y(), (float)from.z(),
+                                        (float)to.x(), (float)to.y(), (float)to.z() };
+            const float colors[6] = { (float)color.x(), (float)color.y(), (float)color.z(),
+                                      (float)color.x(), (float)color.y(), (float)color.z() };
+            std::vector<float>& lineVertices = m_pFrame->batch.lineVertices;
+            std::vector<float>& lineColors = m_pFrame->batch.lineColors;
+            lineVertices.insert(lineVertices.end(), vertices, vertices + 6);
+            lineColors.insert(lineColors.end(), colors, colors + 6);
+        }
+    }
+
+    virtual void drawSphere(const btVector3& p, btScalar radius,
+                            const btVector3& color)
+    {
+        if (m_pFrame != NULL)
+        {
+            const Frame::Sphere sphere = { p, radius, color };
+            m_pFrame->spheres.push_back(sphere);
+        }
+    }
+
+    virtual void drawContactPoint(const btVector3&, const btVector3&,
+                                  btScalar, int, const btVector3&) { }
+
+    virtual void reportErrorWarning(const char* warningString)
+    {
+        std::cerr << warningString << std::endl;
+    }
+
+    virtual void draw3dText(const btVector3&, const char*) { }
+
+    virtual void setDebugMode(int debugMode) { m_debugMode = debugMode; }
+
+    virtual int getDebugMode() const { return m_debugMode; }
+
+private:
+    Frame* m_pFrame;
+    int m_debugMode;
+};
+
+class tgSimViewThreaded::InputScope
+{
+public:
+    explicit InputScope(tgSimViewThreaded& view) :
+        m_view(view),
+        m_lock(view.m_worldMutex)
+    {
+        m_view.m_dynamicsWorld = m_view.m_pPhysicsWorld;
+    }
+
+    ~InputScope()
+    {
+        // A reset in the handler has been through setup() again
+        if (m_view.m_dynamicsWorld != NULL)
+        {
+            m_view.m_pPhysicsWorld = m_view.m_dynamicsWorld;
+        }
+        m_view.m_dynamicsWorld = 0;
+    }
+
+private:
+    tgSimViewThreaded& m_view;
+    const boost::lock_guard<boost::recursive_mutex> m_lock;
+};
+
+tgSimViewThreaded::tgSimViewThreaded(tgWorld& world,
+                                     double stepSize,
+                                     double renderRate,
+                                     double speed) :
+    tgSimViewGraphics(world, stepSize, renderRate),
+    m_running(false),
+    m_pPhysicsWorld(NULL),
+    m_pBack(new Frame()),
+    m_pPending(new Frame()),
+    m_pFront(new Frame()),
+    m_fresh(false),
+    m_pRecorder(new Recorder()),
+    m_pDrawer(new tgGLDebugDrawer()),
+    m_speed(0.0),
+    m_pacedTime(0.0)
+{
+    setSpeed(speed);
+}
+
+tgSimViewThreaded::~tgSimViewThreaded()
+{
+    stop();
+    delete m_pDrawer;
+    delete m_pRecorder;
+    delete m_pFront;
+    delete m_pPending;
+    delete m_pBack;
+}
+
+void tgSimViewThreaded::setup()
+{
+    tgSimViewGraphics::setup();
+
+    // Only the physics thread and locked input handlers may use it
+    m_pPhysicsWorld = m_dynamicsWorld;
+    m_dynamicsWorld = 0;
+
+    m_pBack->clear();
+    publishFrame();
+}
+
+void tgSimViewThreaded::run(int steps)
+{
+    if (isInitialzed())
+    {
+        start();
+        tgSimViewGraphics::run(steps);
+        stop();
+    }
+}
+
+void tgSimViewThreaded::render()
+{
+    const btVector3 bodyColor(0.8, 0.8, 0.8);
+    const std::vector<Frame::Part>& parts = m_pFront->parts;
+    for (std::size_t i = 0; i < parts.size(); i++)
+    {
+        const Frame::Part& part = parts[i];
+        switch (part.shape)
+        {
+        case Frame::BOX:
+            m_pDrawer->drawBox(-part.size, part.size, part.transform, bodyColor);
+            break;
+        case Frame::SPHERE:
+            m_pDrawer->drawSphere(part.size.x(), part.transform, bodyColor);
+            break;
+        }
+    }
+
+    m_pFront->batch.draw(true);
+
+    const std::vector<Frame::Sphere>& spheres = m_pFront->spheres;
+    for (std::size_t i = 0; i < spheres.size(); i++)
+    {
+        m_pDrawer->drawSphere(spheres[i].center, spheres[i].radius,
+                              spheres[i].color);
+    }
+}
+
+void tgSimViewThreaded::clientMoveAndDisplay()
+{
+    if (!isInitialzed())
+    {
+        return;
+    }
+
+    bool fresh = false;
+    {
+        const boost::lock_guard<boost::mutex> lock(m_frameMutex);
+        if (m_fresh)
+        {
+            std::swap(m_pPending, m_pFront);
+            m_fresh = false;
+            fresh = true;
+        }
+    }
+
+    if (fresh)
+    {
+        displayCallback();
+    }
+    else
+    {
+        // Don't spin the GLUT thread while the physics catches up
+        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    }
+}
+
+void tgSimViewThreaded::displayCallback()
+{
+    if (isInitialzed())
+    {
+        glClear(GL_COLOR_BUFFER_BIT |
+            GL_DEPTH_BUFFER_BIT |
+            GL_STENCIL_BUFFER_BIT);
+        render();
+        // The dynamics world is NULL here, so this draws the grid and text
+        renderme();
+        glFlush();
+        swapBuffers();
+    }
+}
+
+void tgSimViewThreaded::clientResetScene()
+{
+    const InputScope scope(*this);
+    tgSimViewGraphics::clientResetScene();
+}
+
+void tgSimViewThreaded::keyboardCallback(unsigned char key, int x, int y)
+{
+    switch (key)
+    {
+    case '[':
+        setSpeed(m_speed / 2.0);
+        break;
+    case ']':
+        // Zero stays as fast as possible
+        setSpeed(m_speed * 2.0);
+        break;
+    case 'q':
+        // The base class may exit the process
+        stop();
+        tgSimViewGraphics::keyboardCallback(key, x, y);
+        break;
+    default:
+        {
+            const InputScope scope(*this);
+            tgSimViewGraphics::keyboardCallback(key, x, y);
+        }
+        break;
+    }
+}
+
+void tgSimViewThreaded::specialKeyboard(int key, int x, int y)
+{
+    const InputScope scope(*this);
+    tgSimViewGraphics::specialKeyboard(key, x, y);
+}
+
+void tgSimViewThreaded::mouseFunc(int button, int state, int x, int y)
+{
+    const InputScope scope(*this);
+    tgSimViewGraphics::mouseFunc(button, state, x, y);
+}
+
+void tgSimViewThreaded::mouseMotionFunc(int x, int y)
+{
+    const InputScope scope(*this);
+    tgSimViewGraphics::mouseMotionFunc(x, y);
+}
+
+void tgSimViewThreaded::setSpeed(double speed)
+{
+    if (speed < 0.0)
+    {
+        throw std::invalid_argument("speed is negative");
+    }
+    const boost::lock_guard<boost::recursive_mutex> lock(m_worldMutex);
+    m_speed = speed;
+    m_clock.reset();
+    m_pacedTime = 0.0;
+}
+
+void tgSimViewThreaded::physicsLoop()
+{
+    double renderTime = 0.0;
+    while (true)
+    {
+        double wait = 0.0;
+        {
+            const boost::lock_guard<boost::recursive_mutex> lock(m_worldMutex);
+            if (!m_running)
+            {
+                return;
+            }
+            if (isIdle() || !isInitialzed())
+            {
+                // Paused; don't catch up afterwards
+                m_clock.reset();
+                m_pacedTime = 0.0;
+                wait = 0.01;
+            }
+            else
+            {
+                try
+                {
+                    m_pSimulation->step(m_stepSize);
+                }
+                catch (const std::exception& e)
+                {
+                    std::cerr << "Stopping the simulation: " << e.what()
+                              << std::endl;
+                    m_running = false;
+                    return;
+                }
+                renderTime += m_stepSize;
+                if (renderTime >= m_renderRate)
+                {
+                    publishFrame();
+                    renderTime = 0.0;
+                }
+
+                if (m_speed > 0.0)
+                {
+                    m_pacedTime += m_stepSize;
+                    wait = m_pacedTime / m_speed -
+                        m_clock.getTimeMicroseconds() * 1.0e-6;
+                }
+            }
+        }
+        if (wait > 0.0)
+        {
+            boost::this_thread::sleep(
+                boost::posix_time::microseconds(static_cast<long>(wait * 1.0e6)));
+        }
+    }
+}
+
+void tgSimViewThreaded::publishFrame()
+{
+    m_pBack->clear();
+    if (m_pPhysicsWorld != NULL)
+    {
+        const btCollisionObjectArray& objects =
+            m_pPhysicsWorld->getCollisionObjectArray();
+        for (int i = 0; i < objects.size(); i++)
+        {
+            m_pBack->addShape(objects[i]->getCollisionShape(),
+                              objects[i]->getWorldTransform());
+        }
+
+        // The renderer collects cables and draws markers with the world's
+        // drawer; its rods' cylinders are already in the frame
+        btIDebugDraw* const pDrawer = m_pPhysicsWorld->getDebugDrawer();
+        m_pRecorder->setFrame(m_pBack);
+        m_pPhysicsWorld->setDebugDrawer(m_pRecorder);
+        if (m_pRenderer != NULL)
+        {
+            m_pSimulation->onVisit(*m_pRenderer);
+            const tgBatchedRenderer::Batch& lines = m_pRenderer->getBatch();
+            std::vector<float>& lineVertices = m_pBack->batch.lineVertices;
+            std::vector<float>& lineColors = m_pBack->batch.lineColors;
+            lineVertices.insert(lineVertices.end(), lines.lineVertices.begin(),
+                                lines.lineVertices.end());
+            lineColors.insert(lineColors.end(), lines.lineColors.begin(),
+                              lines.lineColors.end());
+            m_pRenderer->clear();
+        }
+        m_pPhysicsWorld->setDebugDrawer(pDrawer);
+        m_pRecorder->setFrame(NULL);
+    }
+
+    const boost::lock_guard<boost::mutex> lock(m_frameMutex);
+    std::swap(m_pBack, m_pPending);
+    m_fresh = true;
+}
+
+void tgSimViewThreaded::start()
+{
+    const boost::lock_guard<boost::recursive_mutex> lock(m_worldMutex);
+    if (m_pThread)
+    {
+        return;
+    }
+    m_running = true;
+    m_clock.reset();
+    m_pacedTime = 0.0;
+    m_pThread.reset(
+        new boost::thread(boost::bind(&tgSimViewThreaded::physicsLoop, this)));
+}
+
+void tgSimViewThreaded::stop()
+{
+    {
+        const boost::lock_guard<boost::recursive_mutex> lock(m_worldMutex);
+        m_running = false;
+    }
+    if (m_pThread)
+    {
+        m_pThread->join();
+        m_pThread.reset();
+    }
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_SIM_VIEW_THREADED_H
+#define TG_SIM_VIEW_THREADED_H
+
+/**
+ * @file tgSimViewThreaded.h
+ * @brief Contains the definition of class tgSimViewThreaded
+ * $Id$
+ */
+
+// This module
+#include "tgSimViewGraphics.h"
+// The Bullet Physics library
+#include "LinearMath/btQuickprof.h"
+// Boost
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+// Forward declarations
+class btDynamicsWorld;
+
+/**
+ * The graphics view with the simulation stepped on a thread of its own.
+ * tgSimViewGraphics steps on the GLUT thread between frames, so slow
+ * drawing or vsync hold back the physics. Here the physics thread steps
+ * as fast as the speed allows and, every renderRate of simulation time,
+ * copies the transforms and sizes of the boxes, cylinders and spheres in
+ * the world and the lines the models draw into a frame. The frames are
+ * double buffered: the GLUT thread draws the newest one whenever the
+ * display is ready, the cylinders and lines in one call each with
+ * tgBatchedRenderer::Batch and the rest with the debug drawer as
+ * tgSimViewReplay does, and never touches the world while the physics
+ * thread runs. Shapes other than boxes, cylinders and spheres, such as
+ * mesh grounds, are not drawn.
+ *
+ * Keys, mouse picking and reset lock the world against the physics
+ * thread, so they behave as in tgSimViewGraphics. '[' and ']' halve and
+ * double the speed, the ratio of simulation time to wall time; zero is
+ * as fast as possible.
+ */
+class tgSimViewThreaded : public tgSimViewGraphics
+{
+public:
+
+    /**
+     * @param[in] world a reference to the tgWorld being simulated.
+     * @param[in] stepSize the time interval for advancing the simulation
+     * @param[in] renderRate the simulation time between frames
+     * @param[in] speed the ratio of simulation time to wall time; zero
+     * does not wait
+     * @throw std::invalid_argument as tgSimViewGraphics does, or if speed
+     * is negative
+     */
+    tgSimViewThreaded(tgWorld& world,
+                      double stepSize = 1.0/120.0,
+                      double renderRate = 1.0/60.0,
+                      double speed = 1.0);
+
+    /** Stops the physics thread if it is still running */
+    virtual ~tgSimViewThreaded();
+
+    /**
+     * As tgSimViewGraphics::setup(), but keeps the dynamics world from
+     * the base class so that only the physics thread reads it.
+     */
+    void setup();
+
+    /** Start the physics thread, run GLUT, then stop the thread. */
+    virtual void run(int steps);
+
+    /** Draws the newest frame. */
+    void render();
+
+    /** Takes the newest frame from the physics thread and draws it. */
+    virtual void clientMoveAndDisplay();
+
+    /** Draws the current frame. */
+    virtual void displayCallback();
+
+    /** Resets the simulation with the world locked. */
+    virtual void clientResetScene();
+
+    /** Handles the speed keys; the others run with the world locked. */
+    virtual void keyboardCallback(unsigned char key, int x, int y);
+
+    /** Runs with the world locked. */
+    virtual void specialKeyboard(int key, int x, int y);
+
+    /** Runs with the world locked, so that picking sees the world. */
+    virtual void mouseFunc(int button, int state, int x, int y);
+
+    /** Runs with the world locked, so that picking sees the world. */
+    virtual void mouseMotionFunc(int x, int y);
+
+    /**
+     * @param[in] speed the ratio of simulation time to wall time; zero
+     * does not wait
+     * @throw std::invalid_argument if speed is negative
+     */
+    void setSpeed(double speed);
+
+    /** @return the ratio of simulation time to wall time */
+    double getSpeed() const { return m_speed; }
+
+private:
+
+    /** What the physics thread recorded for one render */
+    struct Frame;
+
+    /** A debug drawer that adds what it's given to a frame */
+    class Recorder;
+
+    /** Step, record and wait until stopped */
+    void physicsLoop();
+
+    /** Record the world into m_pBack and swap it with m_pPending */
+    void publishFrame();
+
+    /** Start the physics thread, unless it is running */
+    void start();
+
+    /** Stop the physics thread and wait for it */
+    void stop();
+
+    /**
+     * Give the base class the dynamics world while it handles input
+     * @see tgSimViewGraphics::setup
+     */
+    class InputScope;
+
+    /** Held by the physics thread while stepping and by input handlers */
+    boost::recursive_mutex m_worldMutex;
+
+    /** Guards m_pPending and m_fresh */
+    boost::mutex m_frameMutex;
+
+    /** Runs physicsLoop */
+    boost::scoped_ptr<boost::thread> m_pThread;
+
+    /** Cleared to stop physicsLoop; guarded by m_worldMutex */
+    bool m_running;
+
+    /** The world stepped by the physics thread; not owned */
+    btDynamicsWorld* m_pPhysicsWorld;
+
+    /** Filled by the physics thread */
+    Frame* m_pBack;
+
+    /** The newest complete frame */
+    Frame* m_pPending;
+
+    /** Drawn by the GLUT thread */
+    Frame* m_pFront;
+
+    /** Set when m_pPending is newer than m_pFront */
+    bool m_fresh;
+
+    /** Records the models' lines into m_pBack; owned */
+    Recorder* m_pRecorder;
+
+    /** Draws the frames; owned */
+    tgGLDebugDrawer* m_pDrawer;
+
+    /** The ratio of simulation time to wall time; guarded by m_worldMutex */
+    double m_speed;
+
+    /** Wall time since the speed last changed */
+    btClock m_clock;
+
+    /** Simulation time since the speed last changed */
+    double m_pacedTime;
+};
+
+#endif  // TG_SIM_VIEW_THREADED_H
@@ -0,0 +1,554 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgSimViewVideo.cpp
+ * @brief Contains the definitions of members of class tgSimViewVideo
+ * $Id$
+ */
+
+// This module
+#include "tgSimViewVideo.h"
+// This application
+#include "tgBatchedRenderer.h"
+#include "tgBulletUtil.h"
+#include "tgSimulation.h"
+// The Bullet Physics library
+#include "BulletCollision/CollisionShapes/btBoxShape.h"
+#include "BulletCollision/CollisionShapes/btCompoundShape.h"
+#include "BulletCollision/CollisionShapes/btCylinderShape.h"
+#include "BulletCollision/CollisionShapes/btSphereShape.h"
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    /** Segments of the circles of cylinders and spheres */
+    const int segments = 16;
+
+    /** Nothing nearer the eye than this is drawn */
+    const double nearPlane = 0.1;
+
+    struct Color
+    {
+        unsigned char r, g, b;
+    };
+
+    const Color background = { 32, 32, 40 };
+    const Color bodyColor = { 204, 204, 204 };
+    const Color gridColor = { 80, 80, 90 };
+
+    /** Lines in perspective onto an RGB frame */
+    class Canvas
+    {
+    public:
+        Canvas(std::vector<unsigned char>& pixels, std::size_t width,
+               std::size_t height, const btVector3& eye,
+               const btVector3& target, double fieldOfView) :
+            m_pixels(pixels),
+            m_width(width),
+            m_height(height),
+            m_eye(eye)
+        {
+            m_forward = (target - eye).normalized();
+            btVector3 right = m_forward.cross(btVector3(0.0, 1.0, 0.0));
+            if (right.length2() < 1.0e-12)
+            {
+                // Looking straight up or down
+                right = btVector3(1.0, 0.0, 0.0);
+            }
+            m_right = right.normalized();
+            m_up = m_right.cross(m_forward);
+            m_focal = 0.5 * height / tan(0.5 * fieldOfView * M_PI / 180.0);
+        }
+
+        void clear(const Color& color)
+        {
+            for (std::size_t i = 0; i < m_width * m_height; i++)
+            {
+                m_pixels[3 * i] = color.r;
+                m_pixels[3 * i + 1] = color.g;
+                m_pixels[3 * i + 2] = color.b;
+            }
+        }
+
+        /** Draw the part of a world space segment in front of the eye */
+        void line(const btVector3& from, const btVector3& to, const Color& color)
+        {
+            btVector3 a = toCamera(from);
+            btVector3 b = toCamera(to);
+            if (a.z() < nearPlane && b.z() < nearPlane)
+            {
+                return;
+            }
+            if (a.z() < nearPlane)
+            {
+                a = a + (b - a) * ((nearPlane - a.z()) / (b.z() - a.z()));
+            }
+            else if (b.z() < nearPlane)
+            {
+                b = b + (a - b) * ((nearPlane - b.z()) / (a.z() - b.z()));
+            }
+            pixelLine(project(a), project(b), color);
+        }
+
+    private:
+        btVector3 toCamera(const btVector3& p) const
+        {
+            const btVector3 d = p - m_eye;
+            return btVector3(d.dot(m_right), d.dot(m_up), d.dot(m_forward));
+        }
+
+        btVector3 project(const btVector3& c) const
+        {
+            return btVector3(0.5 * m_width + m_focal * c.x() / c.z(),
+                             0.5 * m_height - m_focal * c.y() / c.z(),
+                             0.0);
+        }
+
+        /** Clip to the frame (Liang-Barsky), then step along the longer axis */
+        void pixelLine(const btVector3& a, const btVector3& b, const Color& color)
+        {
+            const double dx = b.x() - a.x();
+            const double dy = b.y() - a.y();
+            double t0 = 0.0;
+            double t1 = 1.0;
+            const double p[4] = { -dx, dx, -dy, dy };
+            const double q[4] = { a.x(), m_width - 1.0 - a.x(),
+                                  a.y(), m_height - 1.0 - a.y() };
+            for (int i = 0; i < 4; i++)
+            {
+                if (p[i] == 0.0)
+                {
+                    if (q[i] < 0.0)
+                    {
+                        return;
+                    }
+                }
+                else
+                {
+                    const double t = q[i] / p[i];
+                    if (p[i] < 0.0)
+                    {
+                        t0 = std::max(t0, t);
+                    }
+                    else
+                    {
+                        t1 = std::min(t1, t);
+                    }
+                }
+            }
+            if (t0 > t1)
+            {
+                return;
+            }
+
+            const double x0 = a.x() + t0 * dx;
+            const double y0 = a.y() + t0 * dy;
+            const double x1 = a.x() + t1 * dx;
+            const double y1 = a.y() + t1 * dy;
+            const int steps = static_cast<int>(
+                std::max(std::fabs(x1 - x0), std::fabs(y1 - y0))) + 1;
+            for (int i = 0; i <= steps; i++)
+            {
+                const double t = static_cast<double>(i) / steps;
+                const long x = static_cast<long>(x0 + t * (x1 - x0) + 0.5);
+                const long y = static_cast<long>(y0 + t * (y1 - y0) + 0.5);
+                if (x >= 0 && y >= 0 &&
+                    x < static_cast<long>(m_width) && y < static_cast<long>(m_height))
+                {
+                    unsigned char* const pixel = &m_pixels[3 * (y * m_width + x)];
+                    pixel[0] = color.r;
+                    pixel[1] = color.g;
+                    pixel[2] = color.b;
+                }
+            }
+        }
+
+        std::vector<unsigned char>& m_pixels;
+        const std::size_t m_width;
+        const std::size_t m_height;
+        const btVector3 m_eye;
+        btVector3 m_forward;
+        btVector3 m_right;
+        btVector3 m_up;
+        double m_focal;
+    };
+
+    /** A circle of radius r around center in the plane of axes a and b */
+    void circle(Canvas& canvas, const btTransform& transform,
+                const btVector3& center, const btVector3& a,
+                const btVector3& b, double r, const Color& color)
+    {
+        btVector3 previous = transform * (center + a * r);
+        for (int i = 1; i <= segments; i++)
+        {
+            const double angle = 2.0 * M_PI * i / segments;
+            const btVector3 next =
+                transform * (center + (a * cos(angle) + b * sin(angle)) * r);
+            canvas.line(previous, next, color);
+            previous = next;
+        }
+    }
+
+    btVector3 axis(int i)
+    {
+        btVector3 v(0.0, 0.0, 0.0);
+        v[i] = 1.0;
+        return v;
+    }
+
+    void drawShape(Canvas& canvas, const btCollisionShape* pShape,
+                   const btTransform& transform)
+    {
+        switch (pShape->getShapeType())
+        {
+        case COMPOUND_SHAPE_PROXYTYPE:
+            {
+                const btCompoundShape* const pCompound =
+                    static_cast<const btCompoundShape*>(pShape);
+                for (int i = 0; i < pCompound->getNumChildShapes(); i++)
+                {
+                    drawShape(canvas, pCompound->getChildShape(i),
+                              transform * pCompound->getChildTransform(i));
+                }
+            }
+            break;
+        case BOX_SHAPE_PROXYTYPE:
+            {
+                const btVector3 h =
+                    static_cast<const btBoxShape*>(pShape)->getHalfExtentsWithMargin();
+                // Corner i has the signs of bits 0, 1 and 2 of i
+                btVector3 corners[8];
+                for (int i = 0; i < 8; i++)
+                {
+                    corners[i] = transform * btVector3((i & 1) ? h.x() : -h.x(),
+                                                       (i & 2) ? h.y() : -h.y(),
+                                                       (i & 4) ? h.z() : -h.z());
+                }
+                // Join the corners that differ in one bit
+                for (int i = 0; i < 8; i++)
+                {
+                    for (int bit = 1; bit < 8; bit <<= 1)
+                    {
+                        if ((i & bit) == 0)
+                        {
+                            canvas.line(corners[i], corners[i | bit], bodyColor);
+                        }
+                    }
+                }
+            }
+            break;
+        case CYLINDER_SHAPE_PROXYTYPE:
+            {
+                const btCylinderShape* const pCylinder =
+                    static_cast<const btCylinderShape*>(pShape);
+                const int up = pCylinder->getUpAxis();
+                const double r = pCylinder->getRadius();
+                const double h = pCylinder->getHalfExtentsWithMargin()[up];
+                const btVector3 u = axis(up);
+                const btVector3 a = axis((up + 1) % 3);
+                const btVector3 b = axis((up + 2) % 3);
+                circle(canvas, transform, u * h, a, b, r, bodyColor);
+                circle(canvas, transform, -u * h, a, b, r, bodyColor);
+                for (int i = 0; i < 4; i++)
+                {
+                    const double angle = 0.5 * M_PI * i;
+                    const btVector3 side = (a * cos(angle) + b * sin(angle)) * r;
+                    canvas.line(transform * (side + u * h),
+                                transform * (side - u * h), bodyColor);
+                }
+            }
+            break;
+        case SPHERE_SHAPE_PROXYTYPE:
+            {
+                const double r =
+                    static_cast<const btSphereShape*>(pShape)->getRadius();
+                const btVector3 center(0.0, 0.0, 0.0);
+                for (int i = 0; i < 3; i++)
+                {
+                    circle(canvas, transform, center, axis((i + 1) % 3),
+                           axis((i + 2) % 3), r, bodyColor);
+                }
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    unsigned char clampByte(double value)
+    {
+        return static_cast<unsigned char>(
+            std::min(255.0, std::max(0.0, value + 0.5)));
+    }
+
+    /** The frame rate of the video as a fraction */
+    void frameRate(double renderRate, unsigned long& numerator,
+                   unsigned long& denominator)
+    {
+        numerator = 1000000;
+        denominator = static_cast<unsigned long>(renderRate * 1.0e6 + 0.5);
+        unsigned long a = numerator;
+        unsigned long b = denominator;
+        while (b != 0)
+        {
+            const unsigned long t = a % b;
+            a = b;
+            b = t;
+        }
+        numerator /= a;
+        denominator /= a;
+    }
+}
+
+tgSimViewVideo::Camera::Camera(btVector3 offset,
+                               btVector3 target,
+                               double fieldOfView,
+                               bool track) :
+    m_offset(offset),
+    m_target(target),
+    m_fieldOfView(fieldOfView),
+    m_track(track)
+{
+}
+
+tgSimViewVideo::tgSimViewVideo(tgWorld& world,
+                               const std::string& path,
+                               double stepSize,
+                               double renderRate,
+                               std::size_t width,
+                               std::size_t height) :
+    tgSimView(world, stepSize, renderRate),
+    m_path(path),
+    m_width(width),
+    m_height(height),
+    m_pRenderer(NULL),
+    m_pixels(3 * width * height),
+    m_pFile(NULL),
+    m_piped(false),
+    m_frames(0)
+{
+    if (path.empty())
+    {
+        throw std::invalid_argument("Video path is empty");
+    }
+    if (width == 0 || height == 0)
+    {
+        throw std::invalid_argument("Video frames must not be empty");
+    }
+}
+
+tgSimViewVideo::~tgSimViewVideo()
+{
+    close();
+}
+
+void tgSimViewVideo::setup()
+{
+    tgSimView::setup();
+
+    delete m_pRenderer;
+    m_pRenderer = new tgBatchedRenderer(m_pSimulation->getWorld());
+    m_pModelVisitor = m_pRenderer;
+}
+
+void tgSimViewVideo::teardown()
+{
+    m_pModelVisitor = NULL;
+    delete m_pRenderer;
+    m_pRenderer = NULL;
+
+    tgSimView::teardown();
+}
+
+void tgSimViewVideo::render() const
+{
+    if (m_pSimulation == NULL || m_pRenderer == NULL)
+    {
+        return;
+    }
+    btDynamicsWorld& dynamicsWorld =
+        tgBulletUtil::worldToDynamicsWorld(m_pSimulation->getWorld());
+    const btCollisionObjectArray& objects =
+        dynamicsWorld.getCollisionObjectArray();
+
+    btVector3 target = m_camera.m_target;
+    if (m_camera.m_track)
+    {
+        btVector3 moment(0.0, 0.0, 0.0);
+        double mass = 0.0;
+        for (int i = 0; i < objects.size(); i++)
+        {
+            const btRigidBody* const pBody = btRigidBody::upcast(objects[i]);
+            if (pBody != NULL && pBody->getInvMass() > 0.0)
+            {
+                const double m = 1.0 / pBody->getInvMass();
+                moment += m * pBody->getCenterOfMassPosition();
+                mass += m;
+            }
+        }
+        if (mass > 0.0)
+        {
+            target = moment / mass;
+        }
+    }
+
+    Canvas canvas(m_pixels, m_width, m_height, target + m_camera.m_offset,
+                  target, m_camera.m_fieldOfView);
+    canvas.clear(background);
+
+    // The ground plane, following the target in whole cells
+    const double cell = 10.0;
+    const int cells = 20;
+    const double x0 = cell * std::floor(target.x() / cell);
+    const double z0 = cell * std::floor(target.z() / cell);
+    for (int i = -cells; i <= cells; i++)
+    {
+        canvas.line(btVector3(x0 + i * cell, 0.0, z0 - cells * cell),
+                    btVector3(x0 + i * cell, 0.0, z0 + cells * cell), gridColor);
+        canvas.line(btVector3(x0 - cells * cell, 0.0, z0 + i * cell),
+                    btVector3(x0 + cells * cell, 0.0, z0 + i * cell), gridColor);
+    }
+
+    for (int i = 0; i < objects.size(); i++)
+    {
+        drawShape(canvas, objects[i]->getCollisionShape(),
+                  objects[i]->getWorldTransform());
+    }
+
+    // The bodies are drawn above; only the cables are needed
+    m_pSimulation->onVisit(*m_pRenderer);
+    const tgBatchedRenderer::Batch& batch = m_pRenderer->getBatch();
+    for (std::size_t i = 0; i + 5 < batch.lineVertices.size(); i += 6)
+    {
+        const float* const v = &batch.lineVertices[i];
+        const float* const c = &batch.lineColors[i];
+        const Color color = { clampByte(255.0 * c[0]), clampByte(255.0 * c[1]),
+                              clampByte(255.0 * c[2]) };
+        canvas.line(btVector3(v[0], v[1], v[2]), btVector3(v[3], v[4], v[5]),
+                    color);
+    }
+    m_pRenderer->clear();
+
+    writeFrame();
+}
+
+void tgSimViewVideo::close()
+{
+    if (m_pFile == NULL)
+    {
+        return;
+    }
+    if (m_piped)
+    {
+        pclose(m_pFile);
+    }
+    else
+    {
+        std::fclose(m_pFile);
+    }
+    m_pFile = NULL;
+}
+
+void tgSimViewVideo::open() const
+{
+    unsigned long numerator;
+    unsigned long denominator;
+    frameRate(m_renderRate, numerator, denominator);
+
+    const std::string suffix = ".y4m";
+    m_piped = m_path.size() < suffix.size() ||
+        m_path.compare(m_path.size() - suffix.size(), suffix.size(), suffix) != 0;
+    if (m_piped)
+    {
+        // Quote the path for the shell
+        std::string quoted = "'";
+        for (std::size_t i = 0; i < m_path.size(); i++)
+        {
+            quoted += (m_path[i] == '\'') ? std::string("'\\''") : std::string(1, m_path[i]);
+        }
+        quoted += "'";
+
+        std::ostringstream command;
+        command << "ffmpeg -loglevel error -y -f rawvideo -pix_fmt rgb24"
+                << " -s " << m_width << "x" << m_height
+                << " -r " << numerator << "/" << denominator
+                << " -i - -pix_fmt yuv420p " << quoted;
+        m_pFile = popen(command.str().c_str(), "w");
+    }
+    else
+    {
+        m_pFile = std::fopen(m_path.c_str(), "wb");
+        if (m_pFile != NULL)
+        {
+            std::fprintf(m_pFile, "YUV4MPEG2 W%lu H%lu F%lu:%lu Ip A1:1 C444\n",
+                         static_cast<unsigned long>(m_width),
+                         static_cast<unsigned long>(m_height),
+                         numerator, denominator);
+        }
+    }
+    if (m_pFile == NULL)
+    {
+        throw std::runtime_error("Can't open video: " + m_path);
+    }
+    m_frames = 0;
+}
+
+void tgSimViewVideo::writeFrame() const
+{
+    if (m_pFile == NULL)
+    {
+        open();
+    }
+
+    bool written;
+    if (m_piped)
+    {
+        written = std::fwrite(&m_pixels[0], 1, m_pixels.size(), m_pFile) ==
+            m_pixels.size();
+    }
+    else
+    {
+        // Full resolution planes of Y, then Cb, then Cr (BT.601)
+        const std::size_t n = m_width * m_height;
+        std::vector<unsigned char> planes(3 * n);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            const double r = m_pixels[3 * i];
+            const double g = m_pixels[3 * i + 1];
+            const double b = m_pixels[3 * i + 2];
+            planes[i] = clampByte(16.0 + 0.257 * r + 0.504 * g + 0.098 * b);
+            planes[n + i] = clampByte(128.0 - 0.148 * r - 0.291 * g + 0.439 * b);
+            planes[2 * n + i] = clampByte(128.0 + 0.439 * r - 0.368 * g - 0.071 * b);
+        }
+        written = std::fputs("FRAME\n", m_pFile) >= 0 &&
+            std::fwrite(&planes[0], 1, planes.size(), m_pFile) == planes.size();
+    }
+    if (!written)
+    {
+        throw std::runtime_error("Can't write video: " + m_path);
+    }
+    m_frames++;
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_SIM_VIEW_VIDEO_H
+#define TG_SIM_VIEW_VIDEO_H
+
+/**
+ * @file tgSimViewVideo.h
+ * @brief Contains the definition of class tgSimViewVideo
+ * $Id$
+ */
+
+// This module
+#include "tgSimView.h"
+// The Bullet Physics library
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class tgBatchedRenderer;
+
+/**
+ * A view that needs no display: runs like tgSimView and, every
+ * renderRate of simulation time, draws the world into a frame of its own
+ * and appends it to a video file. Drawing is done on the CPU as lines:
+ * the edges of boxes, cylinders and spheres, a grid on the ground plane
+ * and the cables in the colors of tgBulletRenderer. Nothing of OpenGL,
+ * GLUT, EGL or OSMesa is used, so it runs on nodes without a display or
+ * GL drivers.
+ *
+ * A path ending in ".y4m" is written directly as uncompressed
+ * YUV4MPEG2, which ffmpeg and most players read. Any other path is
+ * encoded by piping the frames to ffmpeg, which must be on the PATH.
+ * Each setup, including the one after a reset, continues the same file.
+ */
+class tgSimViewVideo : public tgSimView
+{
+public:
+
+    /** Where the frames are seen from */
+    struct Camera
+    {
+        Camera(btVector3 offset = btVector3(0.0, 30.0, 60.0),
+               btVector3 target = btVector3(0.0, 5.0, 0.0),
+               double fieldOfView = 45.0,
+               bool track = true);
+
+        /** The eye is this far from the target */
+        btVector3 m_offset;
+
+        /** The point looked at, unless tracking */
+        btVector3 m_target;
+
+        /** Vertical field of view in degrees */
+        double m_fieldOfView;
+
+        /** Look at the center of mass of the moving bodies instead */
+        bool m_track;
+    };
+
+    /**
+     * @param[in] world a reference to the tgWorld being simulated.
+     * @param[in] path the video file, replaced when the first frame is
+     * written
+     * @param[in] stepSize the time interval for advancing the simulation
+     * @param[in] renderRate the simulation time between frames; its
+     * inverse is the frame rate of the video
+     * @param[in] width the frame width in pixels
+     * @param[in] height the frame height in pixels
+     * @throw std::invalid_argument as tgSimView does, if path is empty or
+     * if width or height is zero
+     */
+    tgSimViewVideo(tgWorld& world,
+                   const std::string& path,
+                   double stepSize = 1.0/1000.0,
+                   double renderRate = 1.0/30.0,
+                   std::size_t width = 640,
+                   std::size_t height = 480);
+
+    /** Finishes the video */
+    virtual ~tgSimViewVideo();
+
+    /** Sets up the renderer that collects the cables */
+    virtual void setup();
+
+    /** Deletes the renderer */
+    virtual void teardown();
+
+    /**
+     * Draw the world and append the frame to the video.
+     * @throw std::runtime_error if the video can't be written
+     */
+    virtual void render() const;
+
+    /** @param[in] camera where the next frames are seen from */
+    void setCamera(const Camera& camera) { m_camera = camera; }
+
+    /** @return where the frames are seen from */
+    const Camera& getCamera() const { return m_camera; }
+
+    /** @return the number of frames written */
+    std::size_t getFrames() const { return m_frames; }
+
+    /** Finish the video; later frames start the file over */
+    void close();
+
+private:
+
+    /** Open the file or the encoder and write the header */
+    void open() const;
+
+    /** Append m_pixels to the video */
+    void writeFrame() const;
+
+    const std::string m_path;
+
+    const std::size_t m_width;
+
+    const std::size_t m_height;
+
+    Camera m_camera;
+
+    /** Collects the cables; owned while set up */
+    tgBatchedRenderer* m_pRenderer;
+
+    /** RGB, row by row from the top; written by render() */
+    mutable std::vector<unsigned char> m_pixels;
+
+    /** The video file or the encoder's input, once open */
+    mutable std::FILE* m_pFile;
+
+    /** True if m_pFile is a pipe to ffmpeg */
+    mutable bool m_piped;
+
+    mutable std::size_t m_frames;
+};
+
+#endif  // TG_SIM_VIEW_VIDEO_H
@@ -26,19 +26,75 @@
 // This module
 #include "tgSimulation.h"
 // This application
+#include "tgAggregateBroadphase.h"
+#include "tgBaseRigid.h"
+#include "tgCableContactDetector.h"
+#include "tgCableForcePass.h"
+#include "tgCast.h"
+#include "tgContactCableSolver.h"
+#include "tgCordeCableSolver.h"
 #include "tgModel.h"
+#include "tgModelTraversal.h"
+#include "tgModelVisitor.h"
+#include "tgObserverPass.h"
+#include "tgProfiler.h"
+#include "tgRestingModels.h"
 #include "tgSimView.h"
 #include "tgSimViewGraphics.h"
+#include "tgStateFrame.h"
+#include "tgStopCondition.h"
+#include "tgThreadPool.h"
 #include "tgWorld.h"
+#include "tgWorldArena.h"
 #include "sensors/tgDataManager.h" //for loggers etc.
 // The Bullet Physics Library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
 #include "LinearMath/btQuickprof.h"
 
 // The C++ Standard Library
 #include <stdexcept>
 
+namespace
+{
+    /** Step the world of one partition. */
+    class StepWorldTask : public tgThreadPool::Task
+    {
+    public:
+        StepWorldTask(const tgSimulation& simulation, double dt) :
+            m_simulation(simulation),
+            m_dt(dt)
+        {
+        }
+
+        virtual void operator()(std::size_t item)
+        {
+            m_simulation.getWorld(item).step(m_dt);
+        }
+
+    private:
+        const tgSimulation& m_simulation;
+        const double m_dt;
+    };
+}
+
 tgSimulation::tgSimulation(tgSimView& view) :
-  m_view(view)
+  m_view(view),
+  m_pPartitionPool(NULL),
+  m_pCablePass(NULL),
+  m_pCordeSolver(NULL),
+  m_pContactSolver(NULL),
+  m_pCableContacts(NULL),
+  m_pObserverPass(NULL),
+  m_stopped(false),
+  m_stopReason(eNotStopped),
+  m_wallClockLimit(0.0),
+  m_pStopCondition(NULL),
+  m_runStart(0),
+  m_pWatchdog(NULL),
+  m_pResting(NULL),
+  m_restingStale(false),
+  m_failure(tgDivergenceWatchdog::eNone),
+  m_pFork(NULL)
 {
         m_view.bindToSimulation(*this);
 
@@ -51,18 +107,44 @@ tgSimulation::tgSimulation(tgSimView& view) :
 tgSimulation::~tgSimulation()
 {
     teardown();
+    // The kept bodies go with the world now
+    m_view.world().clearPersistentBodies();
+    for (std::size_t i = 0; i < m_obstacles.size(); i++)
+    {
+        m_obstacles[i]->teardown();
+        delete m_obstacles[i];
+    }
     m_view.releaseFromSimulation();
     for (std::size_t i = 0; i < m_models.size(); i++)
     {
         delete m_models[i];
+        delete m_stateFrames[i];
     }
     // Delete the tgDataManagers here too.
     for (std::size_t i=0; i < m_dataManagers.size(); i++) {
       delete m_dataManagers[i];
     }
+    delete m_pCablePass;
+    delete m_pCordeSolver;
+    delete m_pContactSolver;
+    delete m_pCableContacts;
+    delete m_pObserverPass;
+    delete m_pWatchdog;
+    delete m_pResting;
+    delete m_pPartitionPool;
+    // After the models, whose teardown may need their worlds
+    for (std::size_t i = 0; i < m_partitions.size(); i++)
+    {
+        delete m_partitions[i];
+    }
 }
 
 void tgSimulation::addModel(tgModel* pModel)
+{
+    addModel(pModel, 0);
+}
+
+void tgSimulation::addModel(tgModel* pModel, std::size_t partition)
 {
     // Precondition
     if (pModel == NULL)
@@ -71,9 +153,40 @@ void tgSimulation::addModel(tgModel* pModel)
     }
     else
     {
-
-        pModel->setup(m_view.world());
+        tgWorld& world = getWorld(partition);
+        {
+            const tgWorldArena::Scope scope(world.arena());
+            const tgAggregateBroadphase::Scope aggregate(pModel);
+            pModel->setup(world);
+        }
         m_models.push_back(pModel);
+        m_modelPartitions.push_back(partition);
+        if (m_pCablePass)
+        {
+            m_pCablePass->add(*pModel);
+        }
+        if (m_pCordeSolver)
+        {
+            m_pCordeSolver->add(*pModel);
+        }
+        if (m_pContactSolver)
+        {
+            m_pContactSolver->add(*pModel);
+        }
+        if (m_pCableContacts)
+        {
+            m_pCableContacts->add(*pModel);
+        }
+        if (m_pObserverPass)
+        {
+            m_pObserverPass->add(*pModel);
+        }
+
+        tgStateFrame* const pFrame = new tgStateFrame();
+        pFrame->add(*pModel);
+        pModel->setStateFrame(pFrame);
+        m_stateFrames.push_back(pFrame);
+        m_restingStale = true;
     }
 
     // Postcondition
@@ -81,6 +194,25 @@ void tgSimulation::addModel(tgModel* pModel)
     assert(!m_models.empty());
 }
 
+std::size_t tgSimulation::addPartition()
+{
+    m_partitions.push_back(m_view.world().createPartition());
+    return m_partitions.size();
+}
+
+void tgSimulation::enableParallelPartitions(std::size_t nThreads)
+{
+    tgThreadPool* const pPool = new tgThreadPool(nThreads);
+    delete m_pPartitionPool;
+    m_pPartitionPool = pPool;
+}
+
+void tgSimulation::disableParallelPartitions()
+{
+    delete m_pPartitionPool;
+    m_pPartitionPool = NULL;
+}
+
 void tgSimulation::addObstacle(tgModel* pObstacle)
 {
     // Precondition
@@ -91,8 +223,29 @@ void tgSimulation::addObstacle(tgModel* pObstacle)
     else
     {
 
-        pObstacle->setup(m_view.world());
+        {
+            const tgWorldArena::Scope scope(m_view.world().arena());
+            const tgAggregateBroadphase::Scope aggregate(pObstacle);
+            pObstacle->setup(m_view.world());
+        }
         m_obstacles.push_back(pObstacle);
+        if (m_pCablePass)
+        {
+            m_pCablePass->add(*pObstacle);
+        }
+        if (m_pCordeSolver)
+        {
+            m_pCordeSolver->add(*pObstacle);
+        }
+        if (m_pContactSolver)
+        {
+            m_pContactSolver->add(*pObstacle);
+        }
+        if (m_pCableContacts)
+        {
+            m_pCableContacts->add(*pObstacle);
+        }
+        m_restingStale = true;
     }
 
     // Postcondition
@@ -100,17 +253,55 @@ void tgSimulation::addObstacle(tgModel* pObstacle)
     assert(!m_obstacles.empty());
 }
 
+void tgSimulation::addPersistentObstacle(tgModel* pObstacle)
+{
+    addObstacle(pObstacle);
+
+    const std::vector<tgBaseRigid*> rigids =
+        tgCast::filter<tgModel, tgBaseRigid>(pObstacle->getDescendants());
+    for (std::size_t i = 0; i < rigids.size(); i++)
+    {
+        const btRigidBody* const pBody = rigids[i]->getPRigidBody();
+        if (pBody != NULL && !pBody->isStaticObject())
+        {
+            throw std::invalid_argument("Persistent obstacles must be static");
+        }
+    }
+    for (std::size_t i = 0; i < rigids.size(); i++)
+    {
+        // Compound rigids share a body; the world keeps it once
+        btRigidBody* const pBody = rigids[i]->getPRigidBody();
+        if (pBody != NULL)
+        {
+            m_view.world().addPersistentBody(pBody);
+        }
+    }
+    m_persistentObstacles.insert(pObstacle);
+
+    // Postcondition
+    assert(invariant());
+}
+
 // Similar to models and obstacles, add a data manager.
 void tgSimulation::addDataManager(tgDataManager* pDataManager)
+{
+  addDataManager(pDataManager, 0.0);
+}
+
+void tgSimulation::addDataManager(tgDataManager* pDataManager, double period)
 {
   // Precondition
   if( pDataManager == NULL){
     throw std::invalid_argument("NULL pointer to data manager, in tgSimulation.");
   }
+  else if (period < 0.0) {
+    throw std::invalid_argument("Data manager period is negative, in tgSimulation.");
+  }
   else {
     // TO-DO: do data managers need knowledge of the world?
     //pDataManager->setup(m_view.world());
     pDataManager->setup();
+    m_dataManagerSchedule.add(period);
     m_dataManagers.push_back(pDataManager);
   }
   // Postcondition
@@ -126,13 +317,27 @@ void tgSimulation::onVisit(const tgModelVisitor& r) const
         // Removed sending the visitor to the world since it wasn't used
         // Write a worldVisitor if its necessary
         for (std::size_t i = 0; i < m_models.size(); i++) {
-            m_models[i]->onVisit(r);
+            if (!r.culls(*m_models[i])) {
+                m_models[i]->onVisit(r);
+            }
         }
         for (std::size_t i = 0; i < m_obstacles.size(); i++) {
-            m_obstacles[i]->onVisit(r);
+            if (!r.culls(*m_obstacles[i])) {
+                m_obstacles[i]->onVisit(r);
+            }
         }
 }
 
+void tgSimulation::onVisit(const tgModelVisitor& r,
+                           tgModelTraversal& traversal) const
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("tgSimulation::onVisit");
+#endif //BT_NO_PROFILE	
+    traversal.visit(m_models, r);
+    traversal.visit(m_obstacles, r);
+}
+
 void tgSimulation::reset()
 {
 
@@ -142,8 +347,34 @@ void tgSimulation::reset()
     for (std::size_t i = 0; i != m_models.size(); i++)
     {
         
-        m_models[i]->setup(m_view.world());
+        {
+            tgWorld& world = getWorld(m_modelPartitions[i]);
+            const tgWorldArena::Scope scope(world.arena());
+            const tgAggregateBroadphase::Scope aggregate(m_models[i]);
+            m_models[i]->setup(world);
+        }
+        if (m_pCablePass)
+        {
+            m_pCablePass->add(*m_models[i]);
+        }
+        if (m_pCordeSolver)
+        {
+            m_pCordeSolver->add(*m_models[i]);
+        }
+        if (m_pContactSolver)
+        {
+            m_pContactSolver->add(*m_models[i]);
+        }
+        if (m_pCableContacts)
+        {
+            m_pCableContacts->add(*m_models[i]);
+        }
+        if (m_pObserverPass)
+        {
+            m_pObserverPass->add(*m_models[i]);
+        }
     }
+    buildStateFrames();
     // Also, need to set up the data managers again.
     // Note that this MUST occur after calling setup on the models,
     // otherwise the data manager will not create any sensors
@@ -152,8 +383,204 @@ void tgSimulation::reset()
       // As in addDataManager: do the data managers need knowledge of the world?
       m_dataManagers[i]->setup();
     }
+    m_dataManagerSchedule.reset();
     
-    // Don't need to set up obstacles since they will be added after this
+    // Don't need to set up obstacles since they will be added after this,
+    // and persistent ones are static and still in place
+}
+
+tgSnapshot tgSimulation::snapshot() const
+{
+    tgSnapshot result;
+    m_view.world().storeState(result);
+    for (std::size_t i = 0; i < m_partitions.size(); i++)
+    {
+        m_partitions[i]->storeState(result);
+    }
+    for (std::size_t i = 0; i < m_models.size(); i++)
+    {
+        m_models[i]->storeState(result);
+    }
+    for (std::size_t i = 0; i < m_obstacles.size(); i++)
+    {
+        m_obstacles[i]->storeState(result);
+    }
+    return result;
+}
+
+void tgSimulation::restore(const tgSnapshot& state)
+{
+    state.rewind();
+    try
+    {
+        m_view.world().restoreState(state);
+        for (std::size_t i = 0; i < m_partitions.size(); i++)
+        {
+            m_partitions[i]->restoreState(state);
+        }
+        for (std::size_t i = 0; i < m_models.size(); i++)
+        {
+            m_models[i]->restoreState(state);
+        }
+        for (std::size_t i = 0; i < m_obstacles.size(); i++)
+        {
+            m_obstacles[i]->restoreState(state);
+        }
+    }
+    catch (const std::out_of_range&)
+    {
+        throw std::runtime_error("Snapshot does not match the simulation");
+    }
+    if (!state.atEnd())
+    {
+        throw std::runtime_error("Snapshot does not match the simulation");
+    }
+
+    // Controllers must not see the state from before the restore
+    for (std::size_t i = 0; i < m_stateFrames.size(); i++)
+    {
+        m_stateFrames[i]->update();
+    }
+
+    // Postcondition
+    assert(invariant());
+}
+
+void tgSimulation::enableParallelCableForces(std::size_t nThreads)
+{
+    disableParallelCableForces();
+    m_pCablePass = new tgCableForcePass(nThreads);
+    for (std::size_t i = 0; i < m_models.size(); i++)
+    {
+        m_pCablePass->add(*m_models[i]);
+    }
+    for (std::size_t i = 0; i < m_obstacles.size(); i++)
+    {
+        m_pCablePass->add(*m_obstacles[i]);
+    }
+}
+
+void tgSimulation::disableParallelCableForces()
+{
+    // The destructor hands the cables back to their actuators
+    delete m_pCablePass;
+    m_pCablePass = NULL;
+}
+
+void tgSimulation::enableParallelCordeCables(std::size_t nThreads)
+{
+    disableParallelCordeCables();
+    m_pCordeSolver = new tgCordeCableSolver(nThreads);
+    for (std::size_t i = 0; i < m_models.size(); i++)
+    {
+        m_pCordeSolver->add(*m_models[i]);
+    }
+    for (std::size_t i = 0; i < m_obstacles.size(); i++)
+    {
+        m_pCordeSolver->add(*m_obstacles[i]);
+    }
+}
+
+void tgSimulation::disableParallelCordeCables()
+{
+    // The destructor hands the cables back to their actuators
+    delete m_pCordeSolver;
+    m_pCordeSolver = NULL;
+}
+
+void tgSimulation::enableParallelContactCables(std::size_t nThreads)
+{
+    disableParallelContactCables();
+    m_pContactSolver = new tgContactCableSolver(nThreads);
+    for (std::size_t i = 0; i < m_models.size(); i++)
+    {
+        m_pContactSolver->add(*m_models[i]);
+    }
+    for (std::size_t i = 0; i < m_obstacles.size(); i++)
+    {
+        m_pContactSolver->add(*m_obstacles[i]);
+    }
+}
+
+void tgSimulation::disableParallelContactCables()
+{
+    // The destructor hands the cables back to their actuators
+    delete m_pContactSolver;
+    m_pContactSolver = NULL;
+}
+
+void tgSimulation::enableCableContacts(const tgCableContactDetector::Config& config)
+{
+    disableCableContacts();
+    m_pCableContacts = new tgCableContactDetector(config);
+    for (std::size_t i = 0; i < m_models.size(); i++)
+    {
+        m_pCableContacts->add(*m_models[i]);
+    }
+    for (std::size_t i = 0; i < m_obstacles.size(); i++)
+    {
+        m_pCableContacts->add(*m_obstacles[i]);
+    }
+}
+
+void tgSimulation::disableCableContacts()
+{
+    delete m_pCableContacts;
+    m_pCableContacts = NULL;
+}
+
+void tgSimulation::enableParallelControllers(std::size_t nThreads)
+{
+    disableParallelControllers();
+    m_pObserverPass = new tgObserverPass(nThreads);
+    for (std::size_t i = 0; i < m_models.size(); i++)
+    {
+        m_pObserverPass->add(*m_models[i]);
+    }
+}
+
+void tgSimulation::disableParallelControllers()
+{
+    // The destructor hands the observers back to their subjects
+    delete m_pObserverPass;
+    m_pObserverPass = NULL;
+}
+
+void tgSimulation::enableWatchdog(const tgDivergenceWatchdog::Config& config)
+{
+    tgDivergenceWatchdog* const pWatchdog = new tgDivergenceWatchdog(config);
+    delete m_pWatchdog;
+    m_pWatchdog = pWatchdog;
+}
+
+void tgSimulation::disableWatchdog()
+{
+    delete m_pWatchdog;
+    m_pWatchdog = NULL;
+}
+
+void tgSimulation::enableIslandStepping()
+{
+    if (m_pResting == NULL)
+    {
+        m_pResting = new tgRestingModels();
+        m_restingStale = true;
+    }
+}
+
+void tgSimulation::disableIslandStepping()
+{
+    delete m_pResting;
+    m_pResting = NULL;
+}
+
+bool tgSimulation::isResting(std::size_t i) const
+{
+    if (i >= m_models.size())
+    {
+        throw std::out_of_range("No such model");
+    }
+    return m_pResting != NULL && !m_restingStale && m_pResting->isResting(i);
 }
 
 void tgSimulation::reset(tgGround* newGround)
@@ -163,13 +590,44 @@ void tgSimulation::reset(tgGround* newGround)
     
     // This will reset the world twice (once in teardown, once here), but that shouldn't hurt anything
     m_view.world().reset(newGround);
+    // The partitions' ground bodies were made from the old ground
+    for (std::size_t i = 0; i < m_partitions.size(); i++)
+    {
+        m_partitions[i]->reset();
+    }
     
     m_view.setup();
     for (std::size_t i = 0; i != m_models.size(); i++)
     {
         
-        m_models[i]->setup(m_view.world());
+        {
+            tgWorld& world = getWorld(m_modelPartitions[i]);
+            const tgWorldArena::Scope scope(world.arena());
+            const tgAggregateBroadphase::Scope aggregate(m_models[i]);
+            m_models[i]->setup(world);
+        }
+        if (m_pCablePass)
+        {
+            m_pCablePass->add(*m_models[i]);
+        }
+        if (m_pCordeSolver)
+        {
+            m_pCordeSolver->add(*m_models[i]);
+        }
+        if (m_pContactSolver)
+        {
+            m_pContactSolver->add(*m_models[i]);
+        }
+        if (m_pCableContacts)
+        {
+            m_pCableContacts->add(*m_models[i]);
+        }
+        if (m_pObserverPass)
+        {
+            m_pObserverPass->add(*m_models[i]);
+        }
     }
+    buildStateFrames();
     // Also, need to set up the data managers again.
     // Note that this MUST occur after calling setup on the models,
     // otherwise the data manager will not create any sensors
@@ -178,8 +636,10 @@ void tgSimulation::reset(tgGround* newGround)
       // As in addDataManager: do the data managers need knowledge of the world?
       m_dataManagers[i]->setup();
     }
+    m_dataManagerSchedule.reset();
     
-    // Don't need to set up obstacles since they were just added
+    // Don't need to set up obstacles since they were just added, and
+    // persistent ones are static and still in place
 }
 
 /**
@@ -190,6 +650,37 @@ tgWorld& tgSimulation::getWorld() const
     return m_view.world();
 }
 
+tgWorld& tgSimulation::getWorld(std::size_t partition) const
+{
+    if (partition == 0)
+    {
+        return m_view.world();
+    }
+    return *m_partitions.at(partition - 1);
+}
+
+tgMemoryReport tgSimulation::getMemoryReport() const
+{
+    tgMemoryReport report;
+    for (std::size_t i = 0; i < getNumPartitions(); i++)
+    {
+        report.addWorld(getWorld(i));
+    }
+    for (std::size_t i = 0; i < m_models.size(); i++)
+    {
+        report.addModel(*m_models[i]);
+    }
+    for (std::size_t i = 0; i < m_obstacles.size(); i++)
+    {
+        report.addModel(*m_obstacles[i]);
+    }
+    for (std::size_t i = 0; i < m_dataManagers.size(); i++)
+    {
+        m_dataManagers[i]->reportMemory(report);
+    }
+    return report;
+}
+
 void tgSimulation::step(double dt) const
 {
 // Trying to profile here creates trouble for tgLinearString -  this is outside of the profile loop	
@@ -200,32 +691,249 @@ void tgSimulation::step(double dt) const
     }
     else
     {
+        tgStepTimes::Step times(m_stepTimes);
+
         // Step the world.
         // This can be done before or after stepping the models.
-        m_view.world().step(dt);
+        stepWorlds(dt);
+        if (m_pResting)
+        {
+            updateResting();
+        }
+        times.lap(tgStepTimes::eWorld);
+
+        // Read the state the controllers will see during this step
+        for (std::size_t i = 0; i < m_stateFrames.size(); i++)
+        {
+            if (!m_pResting || !m_pResting->isResting(i))
+            {
+                m_stateFrames[i]->update();
+            }
+        }
+        times.lap(tgStepTimes::eStateFrames);
+
+        // A diverged model would only act on garbage from here on
+        if (m_pWatchdog && checkDivergence())
+        {
+            return;
+        }
+
+        // Step the parallel safe controllers of all the models at once
+        if (m_pObserverPass)
+        {
+            m_pObserverPass->step(dt);
+        }
 
         // Step the models
         for (std::size_t i = 0; i < m_models.size(); i++)
         {
-            m_models[i]->step(dt);
+            if (!m_pResting || !m_pResting->isResting(i))
+            {
+                m_models[i]->step(dt);
+            }
         }
+        times.lap(tgStepTimes::eModels);
         
         // Step the obstacles
         /// @todo determine if this is necessary
+        const std::size_t nModels = m_models.size();
         for (std::size_t i = 0; i < m_obstacles.size(); i++)
         {
-            m_obstacles[i]->step(dt);
+            if (!m_pResting || !m_pResting->isResting(nModels + i))
+            {
+                m_obstacles[i]->step(dt);
+            }
         }
+        times.lap(tgStepTimes::eObstacles);
 
-	// Step the data managers
-	for (std::size_t i = 0; i < m_dataManagers.size(); i++) {
-	  m_dataManagers[i]->step(dt);
+        // Calculate and apply the deferred cable forces
+        if (m_pCablePass)
+        {
+            m_pCablePass->step(dt);
+        }
+        if (m_pCordeSolver)
+        {
+            m_pCordeSolver->step(dt);
+        }
+        if (m_pContactSolver)
+        {
+            m_pContactSolver->step(dt);
+        }
+        if (m_pCableContacts)
+        {
+            m_pCableContacts->step(dt);
+        }
+        times.lap(tgStepTimes::eCables);
+
+	// Step the data managers that are due; a lookahead records nothing
+	if (m_pFork == NULL) {
+	  if (!m_dataManagerSchedule.advance(dt)) {
+	    const std::vector<std::size_t>& everyStep = m_dataManagerSchedule.getEveryStep();
+	    for (std::size_t i = 0; i < everyStep.size(); i++) {
+	      m_dataManagers[everyStep[i]]->step(dt);
+	    }
+	  }
+	  else {
+	    for (std::size_t i = 0; i < m_dataManagers.size(); i++) {
+	      const double managerDt = m_dataManagerSchedule.take(i, dt);
+	      if (managerDt > 0) {
+		m_dataManagers[i]->step(managerDt);
+	      }
+	    }
+	  }
 	}
+        times.lap(tgStepTimes::eDataManagers);
+
+        // A controller may have ended the episode
+        for (std::size_t i = 0; i < m_models.size(); i++)
+        {
+            if (m_models[i]->isStopRequested())
+            {
+                stop(eRequested);
+            }
+        }
+
+        // or the run may be over its budget
+        if (m_runStart != 0)
+        {
+            if (m_pStopCondition != NULL && m_pFork == NULL &&
+                m_pStopCondition->shouldStop(*this, dt))
+            {
+                stop(eCondition);
+            }
+            if (m_wallClockLimit > 0.0 &&
+                (tgStepTimes::now() - m_runStart) * 1.0e-9 > m_wallClockLimit)
+            {
+                stop(eWallClock);
+            }
+        }
+
+        tgProfiler* const pProfiler = m_view.getProfiler();
+        if (pProfiler != NULL)
+        {
+            pProfiler->sample();
+        }
     }
 }
   
+void tgSimulation::stepWorlds(double dt) const
+{
+    if (m_pPartitionPool != NULL && !m_partitions.empty())
+    {
+        StepWorldTask task(*this, dt);
+        m_pPartitionPool->run(task, getNumPartitions());
+    }
+    else
+    {
+        m_view.world().step(dt);
+        for (std::size_t i = 0; i < m_partitions.size(); i++)
+        {
+            m_partitions[i]->step(dt);
+        }
+    }
+}
+
+void tgSimulation::updateResting() const
+{
+    assert(m_pResting != NULL);
+    if (m_restingStale)
+    {
+        // After the models and obstacles were set up or added
+        m_pResting->clear();
+        for (std::size_t i = 0; i < m_models.size(); i++)
+        {
+            m_pResting->add(*m_models[i]);
+        }
+        for (std::size_t i = 0; i < m_obstacles.size(); i++)
+        {
+            m_pResting->add(*m_obstacles[i]);
+        }
+        m_restingStale = false;
+    }
+    m_pResting->update();
+}
+
+bool tgSimulation::checkDivergence() const
+{
+    bool diverged = false;
+    for (std::size_t i = 0; i < m_models.size(); i++)
+    {
+        const tgDivergenceWatchdog::Failure failure =
+            m_pWatchdog->check(m_stateFrames[i]->getPoses());
+        if (failure != tgDivergenceWatchdog::eNone)
+        {
+            m_models[i]->fail(failure);
+            if (m_failure == tgDivergenceWatchdog::eNone)
+            {
+                m_failure = failure;
+            }
+            diverged = true;
+        }
+    }
+    if (diverged)
+    {
+        stop(eDiverged);
+    }
+    return diverged;
+}
+
+void tgSimulation::buildStateFrames()
+{
+    assert(m_stateFrames.size() == m_models.size());
+    for (std::size_t i = 0; i < m_models.size(); i++)
+    {
+        m_stateFrames[i]->clear();
+        m_stateFrames[i]->add(*m_models[i]);
+    }
+}
+
+const tgStateFrame& tgSimulation::getStateFrame(std::size_t i) const
+{
+    return *m_stateFrames.at(i);
+}
+
 void tgSimulation::teardown()
 {
+    // While everything is still there to be counted
+    tgProfiler* const pProfiler = m_view.getProfiler();
+    if (pProfiler != NULL)
+    {
+        pProfiler->setMemoryReport(getMemoryReport());
+    }
+
+    // The actuators are about to be deleted
+    if (m_pCablePass)
+    {
+        m_pCablePass->release();
+    }
+    if (m_pCordeSolver)
+    {
+        m_pCordeSolver->release();
+    }
+    if (m_pContactSolver)
+    {
+        m_pContactSolver->release();
+    }
+    if (m_pCableContacts)
+    {
+        m_pCableContacts->release();
+    }
+    if (m_pObserverPass)
+    {
+        m_pObserverPass->release();
+    }
+
+    // The frames point to actuators and bodies that are about to go
+    for (std::size_t i = 0; i < m_stateFrames.size(); i++)
+    {
+        m_stateFrames[i]->clear();
+    }
+    if (m_pResting)
+    {
+        m_pResting->clear();
+    }
+    m_restingStale = true;
+
     const size_t n = m_models.size();
     for (std::size_t i = 0; i < n; i++)
     {
@@ -235,18 +943,26 @@ void tgSimulation::teardown()
         pModel->teardown();
     }
     
+    std::vector<tgModel*> kept;
     while(m_obstacles.size() != 0)
     {
         tgModel * const pModel = m_obstacles.back();
         assert(pModel != NULL);
+        m_obstacles.pop_back();
+        
+        if (m_persistentObstacles.count(pModel) != 0)
+        {
+            // Its bodies move to the next world in one piece
+            kept.push_back(pModel);
+            continue;
+        }
         
         pModel->teardown();
         
         // Remove and destroy element
         delete pModel;
-        m_obstacles.pop_back();
     }
-    assert(m_obstacles.empty());
+    m_obstacles.assign(kept.rbegin(), kept.rend());
 
     // Similar to the models and obstacles, tear down the data managers.
     const size_t num_DM = m_dataManagers.size(); //why not in the loop gaurd?...
@@ -260,6 +976,10 @@ void tgSimulation::teardown()
     // Reset the world after the models - models need world info for
     // their onTeardown() functions
     m_view.world().reset();
+    for (std::size_t i = 0; i < m_partitions.size(); i++)
+    {
+        m_partitions[i]->reset();
+    }
     // Postcondition
     assert(invariant());
 }
@@ -271,10 +991,73 @@ void tgSimulation::run() const
 
 void tgSimulation::run(int steps) const
 {    
-    m_view.run(steps);
+    m_stopped = false;
+    m_stopReason = eNotStopped;
+    m_failure = tgDivergenceWatchdog::eNone;
+    for (std::size_t i = 0; i < m_models.size(); i++)
+    {
+        m_models[i]->clearStopRequest();
+    }
+    if (m_pStopCondition != NULL)
+    {
+        m_pStopCondition->start(*this);
+    }
+    m_runStart = tgStepTimes::now();
+    try
+    {
+        m_view.run(steps);
+    }
+    catch (...)
+    {
+        m_runStart = 0;
+        throw;
+    }
+    m_runStart = 0;
+}
+
+bool tgSimulation::isStopped() const
+{
+    return m_stopped;
+}
+
+void tgSimulation::stop(StopReason reason) const
+{
+    if (!m_stopped)
+    {
+        m_stopReason = reason;
+    }
+    m_stopped = true;
+}
+
+const char* tgSimulation::stopReasonName(StopReason reason)
+{
+    switch (reason)
+    {
+    case eNotStopped:
+        return "not stopped";
+    case eRequested:
+        return "requested";
+    case eDiverged:
+        return "diverged";
+    case eWallClock:
+        return "wall clock";
+    case eCondition:
+        return "condition";
+    }
+    return "unknown";
+}
+
+void tgSimulation::setWallClockLimit(double seconds)
+{
+    if (seconds < 0.0)
+    {
+        throw std::invalid_argument("Wall clock limit is negative");
+    }
+    m_wallClockLimit = seconds;
 }
 
 bool tgSimulation::invariant() const
 {
-  return true;
+  return m_stateFrames.size() == m_models.size() &&
+    m_modelPartitions.size() == m_models.size();
 }   
@@ -26,17 +26,35 @@
  * $Id$
  */
 
+// This module
+#include "tgCableContactDetector.h"
+#include "tgDivergenceWatchdog.h"
+#include "tgMemoryReport.h"
+#include "tgSnapshot.h"
+#include "tgStepSchedule.h"
+#include "tgStepTimes.h"
 // The C++ Standard Library
 #include <iostream>
+#include <set>
 #include <vector>
 
 // Forward declarations
 class tgModel;
+class tgModelTraversal;
 class tgModelVisitor;
 class tgSimView;
 class tgWorld;
 class tgGround;
 class tgDataManager;
+class tgCableForcePass;
+class tgContactCableSolver;
+class tgCordeCableSolver;
+class tgObserverPass;
+class tgRestingModels;
+class tgSimulationFork;
+class tgStateFrame;
+class tgStopCondition;
+class tgThreadPool;
 
 /**
  * Holds objects necessary for simulation, a world, a view
@@ -44,8 +62,25 @@ class tgDataManager;
  */
 class tgSimulation
 {
+    friend class tgSimulationFork;
+
 public:
 
+    /** Why the last run(int) ended, see getStopReason() */
+    enum StopReason
+    {
+        /** It ran all of its steps, or is still running */
+        eNotStopped = 0,
+        /** A model called tgModel::requestStop() */
+        eRequested,
+        /** The watchdog found a diverged model, see getFailure() */
+        eDiverged,
+        /** It ran longer than the wall clock limit */
+        eWallClock,
+        /** The stop condition was met */
+        eCondition
+    };
+
     /**
      * The only constructor.
      * @param[in,out] view the way the world and its models are rendered.
@@ -74,6 +109,96 @@ public:
      */
     void run(int steps) const;
 
+    /**
+     * Return true once a model has called tgModel::requestStop() during
+     * the current run(int), which then returns early, or once the run
+     * has gone over its budget. Cleared when run(int) starts.
+     */
+    bool isStopped() const;
+
+    /**
+     * @return why the current or last run(int) ended early, or
+     * eNotStopped. Cleared when run(int) starts.
+     */
+    StopReason getStopReason() const { return m_stopReason; }
+
+    /** @return the name of a reason, e.g. "wall clock" */
+    static const char* stopReasonName(StopReason reason);
+
+    /**
+     * End each run(int) after the step during which it has taken more
+     * than seconds of wall clock time, so a trial's time is capped
+     * inside the process instead of by killing it. The limit is kept
+     * across reset().
+     * @param[in] seconds the limit; zero for none
+     * @throw std::invalid_argument if seconds is negative
+     */
+    void setWallClockLimit(double seconds);
+
+    /** @return the wall clock limit of run(int), zero if there is none */
+    double getWallClockLimit() const { return m_wallClockLimit; }
+
+    /**
+     * End each run(int) after the step when a condition says so, e.g. a
+     * tgSettledCondition for trials that have converged. The condition
+     * is not asked during the lookahead of a tgSimulationFork. It is kept
+     * across reset().
+     * @param[in] pCondition not owned, or NULL for none
+     */
+    void setStopCondition(tgStopCondition* pCondition)
+    {
+        m_pStopCondition = pCondition;
+    }
+
+    /**
+     * Check the bodies of every model after each world step, before the
+     * models step, and stop the episode as soon as one diverges: see
+     * tgDivergenceWatchdog. The failing model is marked with
+     * tgModel::fail(), so its controllers see tgModel::getFailure() in
+     * onTeardown() and can score the trial, and isStopped() becomes true.
+     * That step goes no further, so the models never act on NaN state.
+     * The watchdog is kept across reset().
+     * @param[in] config the bounds
+     * @throw std::invalid_argument if a bound is negative
+     */
+    void enableWatchdog(const tgDivergenceWatchdog::Config& config =
+                        tgDivergenceWatchdog::Config());
+
+    /** Stop checking for divergence. */
+    void disableWatchdog();
+
+    /**
+     * @return the first failure the watchdog found during the current
+     * run(int), or eNone. Cleared when run(int) starts.
+     */
+    tgDivergenceWatchdog::Failure getFailure() const { return m_failure; }
+
+    /**
+     * Step only the models and obstacles that are awake: after each world
+     * step, those whose bodies are all static or asleep in Bullet's
+     * deactivated islands (see tgRestingModels) are not stepped, and
+     * their state frames are not updated, until a contact or a cable
+     * wakes one of their islands. Their controllers see no time pass
+     * while at rest, so this suits scenes where most of the world sits
+     * still, such as obstacle courses and robots waiting their turn,
+     * whose controllers have nothing to do until disturbed. Parallel safe
+     * controllers, see enableParallelControllers(), the deferred cable
+     * passes and the data managers still visit every model. Kept across
+     * reset().
+     */
+    void enableIslandStepping();
+
+    /** Step every model and obstacle again. */
+    void disableIslandStepping();
+
+    /**
+     * @param[in] i the index of a model, in the order they were added
+     * @return true if island stepping is enabled and the model was at
+     * rest, so not stepped, at the last step
+     * @throw std::out_of_range if there is no such model
+     */
+    bool isResting(std::size_t i) const;
+
     /**
      * Add a Tensegrity to the simulation.
      * @param[in] pModel a pointer to a tgModel representing a Tensegrity;
@@ -81,6 +206,48 @@ public:
      * @throw std::invalid_argument if pModel is NULL
      */
     void addModel(tgModel* pModel);
+
+    /**
+     * Add a Tensegrity to one partition, see addPartition().
+     * @param[in] pModel as for addModel(pModel)
+     * @param[in] partition the index of the partition; 0 is the world of
+     * the view
+     * @throw std::invalid_argument if pModel is NULL
+     * @throw std::out_of_range if there is no such partition
+     */
+    void addModel(tgModel* pModel, std::size_t partition);
+
+    /**
+     * Add a physics partition, a world of its own made by
+     * tgWorld::createPartition(), for models that never interact with
+     * those of the other partitions, such as robots compared side by
+     * side in one scene. Each partition has its own dynamics world and
+     * broadphase, so none pays for the bodies of the others, and
+     * enableParallelPartitions() steps them at the same time. The world
+     * of the view is partition 0. Obstacles always go there, so the
+     * models of the other partitions touch nothing but the ground, and
+     * the graphical view draws only the bodies of partition 0.
+     * Partitions are kept across reset().
+     * @return the index of the new partition
+     */
+    std::size_t addPartition();
+
+    /** @return the number of partitions, at least 1 */
+    std::size_t getNumPartitions() const { return m_partitions.size() + 1; }
+
+    /**
+     * Step the worlds of the partitions at the same time, one per thread,
+     * instead of one after another. The models, controllers and data
+     * managers still step after all of the worlds have. As with
+     * tgBatchSimulation, builds that do so should define BT_NO_PROFILE.
+     * @param[in] nThreads the number of threads; 0 selects one per core
+     */
+    void enableParallelPartitions(std::size_t nThreads = 0);
+
+    /**
+     * Go back to stepping the partitions one after another.
+     */
+    void disableParallelPartitions();
     
     /**
      * Add an obstacle to the simulation.
@@ -91,6 +258,18 @@ public:
      */
     void addObstacle(tgModel* pObstacle);
 
+    /**
+     * Add an obstacle that is kept, not deleted, on reset. Its bodies
+     * stay as they are and are moved into each new world by
+     * tgWorld::addPersistentBody(), so a static terrain feature such as
+     * tgBlockField or tgStairs is built once instead of every episode.
+     * It is deleted with the simulation.
+     * @param[in] pObstacle a tgModel whose rigid bodies are all static
+     * @throw std::invalid_argument if pObstacle is NULL or has a rigid
+     * body with mass, in which case it stays an ordinary obstacle
+     */
+    void addPersistentObstacle(tgModel* pObstacle);
+
     /**
      * Add a data manager to the simulation.
      * For example, add a data logger.
@@ -99,11 +278,32 @@ public:
      * @throw std::invalid_argument if pDataManager is NULL
      */
     void addDataManager(tgDataManager* pDataManager);
+
+    /**
+     * Add a data manager that is stepped every period seconds of
+     * simulation time, counted from the last reset, with all of that
+     * time as its dt.
+     * @param[in] pDataManager as for addDataManager(pDataManager)
+     * @param[in] period the time between steps; zero is every step
+     * @throw std::invalid_argument if pDataManager is NULL or period is
+     * negative
+     */
+    void addDataManager(tgDataManager* pDataManager, double period);
     
     /**
-     * Pass the tgModelVisitor to all of the models
+     * Pass the tgModelVisitor to all of the models and obstacles, except
+     * those it culls
+     * @see tgModelVisitor::culls
      */
     void onVisit(const tgModelVisitor& r) const;
+
+    /**
+     * As onVisit(r), but visiting the models of each tree in parallel
+     * @param[in] r a visitor that is safe to call from several threads
+     * @param[in,out] traversal the traversal to visit with
+     * @see tgModelTraversal
+     */
+    void onVisit(const tgModelVisitor& r, tgModelTraversal& traversal) const;
     
     /**
      * Calls teardown, then calls setup on the view, finally
@@ -117,15 +317,156 @@ public:
      * then calls setup on the view, finally
      * calls setup on the models
      * Will delete and remake the dynamics world, the previous
-     * ground will be deleted
+     * ground will be deleted unless it is newGround. Its shape is only
+     * rebuilt if the ground builds a new one; see tgHillyGround.
      */
     void reset(tgGround* newGround);
+
+    /**
+     * Capture the dynamic state of the world, the models and the
+     * obstacles: rigid body transforms and velocities, actuator rest
+     * lengths, motor state and history, and the state of any controllers
+     * that implement tgObserver::onStoreState().
+     * Cheaper than reset() for repeated episodes from the same start,
+     * since nothing is torn down or rebuilt.
+     * @return a snapshot that can be passed to restore() until the next
+     * reset() or addObstacle()
+     */
+    tgSnapshot snapshot() const;
+
+    /**
+     * Return the world, models and obstacles to the state captured by
+     * snapshot(), without rebuilding the dynamics world. Data managers
+     * are not rewound.
+     * @param[in] state a snapshot taken from this simulation
+     * @throw std::runtime_error if bodies or models were added or removed
+     * since the snapshot was taken
+     * @todo contact cable anchors are regenerated from contacts on the
+     * next step rather than restored
+     */
+    void restore(const tgSnapshot& state);
+
+    /**
+     * Compute the forces of the tgBasicActuators and tgKinematicActuators
+     * that use plain tgBulletSpringCables in a separate pass after the
+     * models step, in parallel, then apply them serially. See
+     * tgCableForcePass. Models and obstacles added later, and models
+     * rebuilt by reset(), are included automatically.
+     * @param[in] nThreads the number of threads; 0 selects one per core
+     */
+    void enableParallelCableForces(std::size_t nThreads = 0);
+
+    /**
+     * Go back to computing each cable's force in its actuator's step().
+     */
+    void disableParallelCableForces();
+
+    /**
+     * Advance the tgCordeCables of the tgBasicActuators in a separate
+     * pass after the models step, one cable per thread at a time, then
+     * apply their forces on the anchors serially. See
+     * tgCordeCableSolver. Models and obstacles added later, and models
+     * rebuilt by reset(), are included automatically.
+     * @param[in] nThreads the number of threads; 0 selects one per core
+     */
+    void enableParallelCordeCables(std::size_t nThreads = 0);
+
+    /**
+     * Go back to advancing each Corde cable in its actuator's step().
+     */
+    void disableParallelCordeCables();
+
+    /**
+     * Step the tgBulletContactSpringCables of the actuators in a separate
+     * pass after the models step: every cable finds its contacts at the
+     * same time, one cable per thread, then the anchors are updated and
+     * the forces applied serially. See tgContactCableSolver. Models and
+     * obstacles added later, and models rebuilt by reset(), are included
+     * automatically.
+     * @param[in] nThreads the number of threads; 0 selects one per core
+     */
+    void enableParallelContactCables(std::size_t nThreads = 0);
+
+    /**
+     * Go back to stepping each contact cable in its actuator's step().
+     */
+    void disableParallelContactCables();
+
+    /**
+     * Find where the segments of plain tgBulletSpringCables touch each
+     * other after the cables are stepped, and push them apart if the
+     * config has a stiffness. See tgCableContactDetector. Models and
+     * obstacles added later, and models rebuilt by reset(), are included
+     * automatically.
+     */
+    void enableCableContacts(const tgCableContactDetector::Config& config =
+                             tgCableContactDetector::Config());
+
+    /** Let cables pass through each other again. */
+    void disableCableContacts();
+
+    /**
+     * @return the contact detector, which holds the last step's contacts,
+     * or NULL if cable contacts are disabled
+     */
+    const tgCableContactDetector* getCableContacts() const
+    {
+        return m_pCableContacts;
+    }
+
+    /**
+     * Step the observers that are parallel safe, see
+     * tgObserver::isParallelSafe(), of every model at the same time on a
+     * pool of threads, after the world steps and before the models do.
+     * See tgObserverPass. Models added later, and models rebuilt by
+     * reset(), are included automatically; obstacles are not.
+     * @param[in] nThreads the number of threads; 0 selects one per core
+     */
+    void enableParallelControllers(std::size_t nThreads = 0);
+
+    /**
+     * Go back to stepping every observer in its subject's notifyStep().
+     */
+    void disableParallelControllers();
+    
+    /**
+     * Return the state frame of a model, which its controllers also reach
+     * through tgModel::getStateFrame(). The frame is updated once per
+     * step, after the world steps and before the models do.
+     * @param[in] i the index of the model, in the order they were added
+     * @throw std::out_of_range if there is no such model
+     */
+    const tgStateFrame& getStateFrame(std::size_t i) const;
+
+    /** @return the number of models added with addModel() */
+    std::size_t getNumModels() const { return m_models.size(); }
+    
+    /**
+     * Return where the time of step() goes; enable them with
+     * tgStepTimes::setEnabled(). They are kept across reset().
+     */
+    tgStepTimes& getStepTimes() { return m_stepTimes; }
+
+    const tgStepTimes& getStepTimes() const { return m_stepTimes; }
+
+    /**
+     * Return the memory of every world, model, obstacle and data manager,
+     * by category; see tgMemoryReport. A profiler given to the view gets
+     * the report of the models as they were at the last teardown.
+     */
+    tgMemoryReport getMemoryReport() const;
     
     /**
      * Returns a reference to the world
      */
     tgWorld& getWorld() const;
 
+    /**
+     * Returns the world of a partition, see addPartition()
+     * @throw std::out_of_range if there is no such partition
+     */
+    tgWorld& getWorld(std::size_t partition) const;
+
  private:
     
     /**
@@ -133,6 +474,25 @@ public:
      */
     void teardown();
 
+    /** Collect the cables and bodies of every model into its frame. */
+    void buildStateFrames();
+
+    /** Step the world of every partition. */
+    void stepWorlds(double dt) const;
+
+    /** Collect the models and obstacles into m_pResting, and update it. */
+    void updateResting() const;
+
+    /**
+     * Give each model's frame to the watchdog and fail the models that
+     * diverged.
+     * @return true if one did
+     */
+    bool checkDivergence() const;
+
+    /** End the run after this step, keeping the first reason given. */
+    void stop(StopReason reason) const;
+
     /** Integrity predicate. */
     bool invariant() const;
 
@@ -147,21 +507,120 @@ private:
      * @todo Should this be std::set?
      */
     std::vector<tgModel*> m_models;
+
+    /** The partition of each model, in the same order. */
+    std::vector<std::size_t> m_modelPartitions;
+
+    /**
+     * The worlds of the partitions after the first, which is the view's.
+     * Owned. All pointers are non-NULL.
+     */
+    std::vector<tgWorld*> m_partitions;
+
+    /**
+     * The threads that step the partitions, or NULL to step them one
+     * after another. Owned.
+     */
+    tgThreadPool* m_pPartitionPool;
+
+    /**
+     * The state frame of each model, in the same order. Owned.
+     */
+    std::vector<tgStateFrame*> m_stateFrames;
     
     /**
-     * Obstacles are models that are deleted after one simulation
+     * Obstacles are models that are deleted after one simulation,
+     * unless added with addPersistentObstacle().
      * This allows their presence or absence to be controlled by
      * main.
      * All pointers should be non-NULL
      */
     std::vector<tgModel*> m_obstacles;
 
+    /** The obstacles of m_obstacles that reset() keeps */
+    std::set<const tgModel*> m_persistentObstacles;
+
     /**
      * All the data managers for this simulation.
      * Similar structure to the models and obstacles.
      * All pointers should be non-NULL.
      */
     std::vector<tgDataManager*> m_dataManagers;
+
+    /** When each of m_dataManagers is due, in the same order. */
+    mutable tgStepSchedule m_dataManagerSchedule;
+
+    /**
+     * The cable force pass, or NULL if actuators step their own cables.
+     * Owned.
+     */
+    tgCableForcePass* m_pCablePass;
+
+    /**
+     * The Corde cable solver, or NULL if actuators step their own Corde
+     * cables. Owned.
+     */
+    tgCordeCableSolver* m_pCordeSolver;
+
+    /**
+     * The contact cable solver, or NULL if actuators step their own
+     * contact cables. Owned.
+     */
+    tgContactCableSolver* m_pContactSolver;
+
+    /**
+     * The cable contact detector, or NULL if cables pass through each
+     * other. Owned.
+     */
+    tgCableContactDetector* m_pCableContacts;
+
+    /**
+     * The observer pass, or NULL if subjects step all their observers.
+     * Owned.
+     */
+    tgObserverPass* m_pObserverPass;
+
+    /** Set by step() when a model requested a stop. */
+    mutable bool m_stopped;
+
+    /** Set by step() when it first sets m_stopped. */
+    mutable StopReason m_stopReason;
+
+    /** Seconds; zero for no limit */
+    double m_wallClockLimit;
+
+    /** Not owned, may be NULL */
+    tgStopCondition* m_pStopCondition;
+
+    /**
+     * The tgStepTimes::now() at which the current run(int) started, or
+     * zero outside of run(int), when no budget applies.
+     */
+    mutable long long m_runStart;
+
+    /** The watchdog, or NULL if divergence is not checked. Owned. */
+    tgDivergenceWatchdog* m_pWatchdog;
+
+    /**
+     * The models, then the obstacles, at rest, or NULL if every model is
+     * stepped. Owned.
+     */
+    tgRestingModels* m_pResting;
+
+    /** True if m_pResting must collect the models again before a step */
+    mutable bool m_restingStale;
+
+    /** Set by step() when the watchdog first trips. */
+    mutable tgDivergenceWatchdog::Failure m_failure;
+
+    /**
+     * The open fork, or NULL. While there is one, step() does not step
+     * the data managers. Not owned.
+     */
+    const tgSimulationFork* m_pFork;
+
+    /** Added to by step(). */
+    mutable tgStepTimes m_stepTimes;
 };
 
 #endif  // TG_SIMULATION_H
@@ -0,0 +1,119 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgSimulationFork.cpp
+ * @brief Contains the definitions of members of class tgSimulationFork
+ * $Id$
+ */
+
+// This module
+#include "tgSimulationFork.h"
+#include "tgModel.h"
+#include "tgSimulation.h"
+// The C++ Standard Library
+#include <cassert>
+#include <stdexcept>
+
+namespace
+{
+    /** Refuse a second fork, before taking another snapshot. */
+    tgSimulation& checked(tgSimulation& simulation,
+                          const tgSimulationFork* pFork)
+    {
+        if (pFork != NULL)
+        {
+            throw std::runtime_error("The simulation is already forked");
+        }
+        return simulation;
+    }
+}
+
+tgSimulationFork::tgSimulationFork(tgSimulation& simulation) :
+  m_simulation(checked(simulation, simulation.m_pFork)),
+  m_state(simulation.snapshot()),
+  m_stopped(simulation.m_stopped),
+  m_failure(simulation.m_failure)
+{
+    for (std::size_t i = 0; i < m_simulation.m_models.size(); i++)
+    {
+        m_stopRequested.push_back(m_simulation.m_models[i]->isStopRequested());
+        m_failures.push_back(m_simulation.m_models[i]->getFailure());
+    }
+    m_simulation.m_pFork = this;
+}
+
+tgSimulationFork::~tgSimulationFork()
+{
+    try
+    {
+        rewind();
+    }
+    catch (const std::exception&)
+    {
+        // A destructor must not throw; the simulation was changed in a
+        // way restore() rejects, such as a body being added
+    }
+    assert(m_simulation.m_pFork == this);
+    m_simulation.m_pFork = NULL;
+}
+
+int tgSimulationFork::run(int steps, double dt)
+{
+    if (dt <= 0.0)
+    {
+        throw std::invalid_argument("dt is not positive");
+    }
+
+    // As tgSimulation::run(int), only stops during this rollout count
+    m_simulation.m_stopped = false;
+    m_simulation.m_failure = tgDivergenceWatchdog::eNone;
+    for (std::size_t i = 0; i < m_simulation.m_models.size(); i++)
+    {
+        m_simulation.m_models[i]->clearStopRequest();
+    }
+
+    int taken = 0;
+    while (taken < steps && !m_simulation.m_stopped)
+    {
+        m_simulation.step(dt);
+        ++taken;
+    }
+    return taken;
+}
+
+void tgSimulationFork::rewind()
+{
+    m_simulation.restore(m_state);
+    m_simulation.m_stopped = m_stopped;
+    m_simulation.m_failure = m_failure;
+    const std::vector<tgModel*>& models = m_simulation.m_models;
+    assert(models.size() == m_stopRequested.size());
+    for (std::size_t i = 0; i < models.size(); i++)
+    {
+        models[i]->clearStopRequest();
+        if (m_failures[i] != tgDivergenceWatchdog::eNone)
+        {
+            models[i]->fail(m_failures[i]);
+        }
+        if (m_stopRequested[i])
+        {
+            models[i]->requestStop();
+        }
+    }
+}
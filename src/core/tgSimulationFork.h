@@ -0,0 +1,113 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_SIMULATION_FORK_H
+#define TG_SIMULATION_FORK_H
+
+/**
+ * @file tgSimulationFork.h
+ * @brief Contains the definition of class tgSimulationFork
+ * $Id$
+ */
+
+// This module
+#include "tgDivergenceWatchdog.h"
+#include "tgSnapshot.h"
+// The C++ Standard Library
+#include <vector>
+
+// Forward declarations
+class tgSimulation;
+
+/**
+ * A lookahead from the current state of a tgSimulation, for controllers
+ * that try candidate actions before committing to one, as model
+ * predictive control does. The fork takes a snapshot; run() then steps
+ * the simulation without stepping its data managers, and rewind() and
+ * the destructor restore the snapshot and the models' stop requests and
+ * failures, so
+ * the simulation continues as if the rollouts never happened:
+ *
+ *     tgSimulationFork fork(simulation);
+ *     for each candidate action:
+ *         apply the action; fork.run(steps, dt); score the result;
+ *         fork.rewind();
+ *
+ * The rollouts step this simulation's one world, one after another. For
+ * K rollouts at once, restore the snapshot, getState(), into the worlds
+ * of a tgBatchSimulation built with the same models, see
+ * tgBatchSimulation::restore().
+ *
+ * Use it between steps, from the code that steps the simulation, rather
+ * than from a controller's onStep(). Only one fork of a simulation may be
+ * open at a time, and the simulation must not be reset while it is.
+ */
+class tgSimulationFork
+{
+public:
+
+    /**
+     * Take a snapshot of the simulation.
+     * @param[in,out] simulation the simulation to look ahead in
+     * @throw std::runtime_error if the simulation is already forked
+     */
+    tgSimulationFork(tgSimulation& simulation);
+
+    /** Rewind, then let the simulation record again. */
+    ~tgSimulationFork();
+
+    /**
+     * Advance the simulation without recording, stopping early if a
+     * model requests a stop or diverges during this call.
+     * @param[in] steps the number of steps
+     * @param[in] dt the step size; must be positive
+     * @return the number of steps taken
+     * @throw std::invalid_argument if dt is not positive
+     */
+    int run(int steps, double dt);
+
+    /** Return the simulation to where it was forked. */
+    void rewind();
+
+    /** @return the state the simulation was forked at */
+    const tgSnapshot& getState() const { return m_state; }
+
+private:
+
+    /** Not copyable: the simulation points to this fork. */
+    tgSimulationFork(const tgSimulationFork&);
+    tgSimulationFork& operator=(const tgSimulationFork&);
+
+    tgSimulation& m_simulation;
+
+    const tgSnapshot m_state;
+
+    /** tgSimulation::isStopped() at the fork */
+    const bool m_stopped;
+
+    /** tgSimulation::getFailure() at the fork */
+    const tgDivergenceWatchdog::Failure m_failure;
+
+    /** tgModel::isStopRequested() of each model at the fork */
+    std::vector<bool> m_stopRequested;
+
+    /** tgModel::getFailure() of each model at the fork */
+    std::vector<tgDivergenceWatchdog::Failure> m_failures;
+};
+
+#endif  // TG_SIMULATION_FORK_H
@@ -0,0 +1,136 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgSnapshot.cpp
+ * @brief Contains the definitions of members of class tgSnapshot
+ * $Id$
+ */
+
+// This module
+#include "tgSnapshot.h"
+// The C++ Standard Library
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+    /** The first line of every saved snapshot. */
+    const std::string magic = "NTRT_SNAPSHOT 1";
+}
+
+tgSnapshot::tgSnapshot() :
+    m_cursor(0)
+{
+}
+
+void tgSnapshot::write(double value)
+{
+    m_values.push_back(value);
+}
+
+void tgSnapshot::write(const std::deque<double>& values)
+{
+    m_values.push_back(static_cast<double>(values.size()));
+    m_values.insert(m_values.end(), values.begin(), values.end());
+}
+
+double tgSnapshot::read() const
+{
+    if (m_cursor >= m_values.size())
+    {
+        throw std::out_of_range("Snapshot does not match the simulation");
+    }
+    return m_values[m_cursor++];
+}
+
+void tgSnapshot::read(std::deque<double>& values) const
+{
+    const std::size_t n = static_cast<std::size_t>(read());
+    if (m_cursor + n > m_values.size())
+    {
+        throw std::out_of_range("Snapshot does not match the simulation");
+    }
+    values.assign(m_values.begin() + m_cursor,
+                  m_values.begin() + m_cursor + n);
+    m_cursor += n;
+}
+
+void tgSnapshot::rewind() const
+{
+    m_cursor = 0;
+}
+
+void tgSnapshot::clear()
+{
+    m_values.clear();
+    m_cursor = 0;
+}
+
+void tgSnapshot::save(const std::string& fileName) const
+{
+    const std::string tempName = fileName + ".tmp";
+    {
+        std::ofstream out(tempName.c_str(),
+                          std::ios::out | std::ios::binary | std::ios::trunc);
+        const unsigned long n = m_values.size();
+        out << magic << "\n" << n << "\n";
+        if (n > 0)
+        {
+            out.write(reinterpret_cast<const char*>(&m_values[0]),
+                      n * sizeof(double));
+        }
+        if (!out)
+        {
+            throw std::runtime_error("Could not write snapshot " + tempName);
+        }
+    }
+    if (std::rename(tempName.c_str(), fileName.c_str()) != 0)
+    {
+        std::remove(tempName.c_str());
+        throw std::runtime_error("Could not write snapshot " + fileName);
+    }
+}
+
+bool tgSnapshot::load(const std::string& fileName)
+{
+    std::ifstream in(fileName.c_str(), std::ios::in | std::ios::binary);
+    std::string line;
+    if (!std::getline(in, line) || line != magic)
+    {
+        return false;
+    }
+    unsigned long n = 0;
+    if (!(in >> n) || in.get() != '\n')
+    {
+        return false;
+    }
+    std::vector<double> values(n);
+    if (n > 0)
+    {
+        in.read(reinterpret_cast<char*>(&values[0]), n * sizeof(double));
+    }
+    if (!in)
+    {
+        return false;
+    }
+    m_values.swap(values);
+    m_cursor = 0;
+    return true;
+}
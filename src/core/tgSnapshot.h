@@ -0,0 +1,128 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_SNAPSHOT_H
+#define TG_SNAPSHOT_H
+
+/**
+ * @file tgSnapshot.h
+ * @brief Contains the definition of class tgSnapshot
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <vector>
+
+/**
+ * A flat record of the dynamic state of a simulation, produced by
+ * tgSimulation::snapshot() and consumed by tgSimulation::restore().
+ * The world writes its rigid body state first, then every model writes
+ * its own state in tree order. Restoring reads the values back in the same
+ * order, so a snapshot is only valid for the simulation that produced it
+ * and only until that simulation is reset.
+ */
+class tgSnapshot
+{
+public:
+
+    /** Construct an empty snapshot. */
+    tgSnapshot();
+
+    /**
+     * Append a value to the snapshot.
+     * @param[in] value the value to store
+     */
+    void write(double value);
+
+    /**
+     * Append a history deque, preceded by its length.
+     * @param[in] values the deque to store
+     */
+    void write(const std::deque<double>& values);
+
+    /**
+     * Return the next value and advance the read position.
+     * @return the next stored value
+     * @throw std::out_of_range if every value has already been read
+     */
+    double read() const;
+
+    /**
+     * Replace the contents of a deque with the next stored deque.
+     * @param[out] values the deque to overwrite
+     * @throw std::out_of_range if the snapshot runs out of values
+     */
+    void read(std::deque<double>& values) const;
+
+    /** Move the read position back to the first value. */
+    void rewind() const;
+
+    /**
+     * Return true if every stored value has been read.
+     */
+    bool atEnd() const
+    {
+        return m_cursor == m_values.size();
+    }
+
+    /**
+     * Return the number of stored values.
+     */
+    std::size_t size() const
+    {
+        return m_values.size();
+    }
+
+    /** Remove every value. */
+    void clear();
+
+    /**
+     * Write the snapshot to a binary file. The data is written to a
+     * temporary file first and renamed into place, so a concurrent reader
+     * never sees a partial snapshot.
+     * @param[in] fileName the file to write
+     * @throw std::runtime_error if the file cannot be written
+     */
+    void save(const std::string& fileName) const;
+
+    /**
+     * Replace the contents of the snapshot with a file written by save().
+     * The file is in native byte order and is not portable between
+     * machines.
+     * @param[in] fileName the file to read
+     * @return false, leaving the snapshot unchanged, if the file does not
+     * exist or is not a snapshot
+     */
+    bool load(const std::string& fileName);
+
+private:
+
+    /** The stored values, in the order they were written. */
+    std::vector<double> m_values;
+
+    /**
+     * The index of the next value to read. Reading does not change what
+     * the snapshot holds, so a const snapshot can be restored repeatedly.
+     */
+    mutable std::size_t m_cursor;
+};
+
+#endif  // TG_SNAPSHOT_H
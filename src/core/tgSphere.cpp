@@ -71,7 +71,7 @@ tgSphere::tgSphere(btRigidBody* pRigidBody,
 
 tgSphere::~tgSphere() { }
 
-void tgSphere::onVisit(const tgModelVisitor& v) const
+void tgSphere::accept(const tgModelVisitor& v) const
 {
     v.render(*this);
     
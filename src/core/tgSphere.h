@@ -100,7 +100,7 @@ public:
      */
     virtual void teardown();
     
-    virtual void onVisit(const tgModelVisitor& v) const;
+    virtual void accept(const tgModelVisitor& v) const;
     
 private:
 
@@ -25,6 +25,7 @@
 // This module
 #include "tgSpringCable.h"
 #include "tgSpringCableAnchor.h"
+#include "tgSnapshot.h"
 
 #include <iostream>
 #include <stdexcept>
@@ -76,3 +77,37 @@ void tgSpringCable::setRestLength( const double newRestLength)
     
     m_restLength = newRestLength;
 }
+
+void tgSpringCable::setCoefK(const double coefK)
+{
+    if (!(coefK > 0.0))
+    {
+        throw std::invalid_argument("Stiffness must be positive");
+    }
+    m_coefK = coefK;
+}
+
+void tgSpringCable::setCoefD(const double dampingCoefficient)
+{
+    if (!(dampingCoefficient >= 0.0))
+    {
+        throw std::invalid_argument("Damping must be non-negative");
+    }
+    m_dampingCoefficient = dampingCoefficient;
+}
+
+void tgSpringCable::storeState(tgSnapshot& snapshot) const
+{
+    snapshot.write(m_restLength);
+    snapshot.write(m_prevLength);
+    snapshot.write(m_velocity);
+    snapshot.write(m_damping);
+}
+
+void tgSpringCable::restoreState(const tgSnapshot& snapshot)
+{
+    m_restLength = snapshot.read();
+    m_prevLength = snapshot.read();
+    m_velocity = snapshot.read();
+    m_damping = snapshot.read();
+}
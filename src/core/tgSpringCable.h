@@ -31,6 +31,7 @@
 
 // Forward references
 class tgSpringCableAnchor;
+class tgSnapshot;
 
 /**
  * An abstract base class defining the interface for a spring cable
@@ -104,6 +105,19 @@ public:
     {
         return m_dampingCoefficient;
     }
+
+    /**
+     * Change the coefficient of stiffness. The rest length is kept, so
+     * the tension changes with it.
+     * @param[in] coefK - the new stiffness, must be positive
+     */
+    virtual void setCoefK(const double coefK);
+
+    /**
+     * Change the coefficient of damping.
+     * @param[in] dampingCoefficient - the new damping, must be non-negative
+     */
+    virtual void setCoefD(const double dampingCoefficient);
     
     /**
      * Get the last change in length / time
@@ -127,6 +141,20 @@ public:
      */
     virtual const std::vector<const tgSpringCableAnchor*> getAnchors() const = 0;
 
+    /**
+     * Append the rest length, previous length, velocity and damping
+     * force to a snapshot. Anchor positions follow their rigid bodies
+     * and are not stored.
+     * @param[in,out] snapshot the snapshot to append to
+     */
+    virtual void storeState(tgSnapshot& snapshot) const;
+
+    /**
+     * Read back the values written by storeState().
+     * @param[in] snapshot the snapshot to read from
+     */
+    virtual void restoreState(const tgSnapshot& snapshot);
+
 protected:
  
     /**
@@ -146,14 +174,14 @@ protected:
      * Units of mass / sec ^2
      * Must be positive
      */
-    const double m_coefK;
+    double m_coefK;
 
     /**
      * The damping coefficient.
      * Units of mass / sec. 
      * Must be non-negative
      */
-    const double m_dampingCoefficient;
+    double m_dampingCoefficient;
     
     
         /**
@@ -26,11 +26,17 @@
 // This Module
 #include "tgSpringCableActuator.h"
 #include "tgSpringCable.h"
+#include "tgBulletContactSpringCable.h"
+#include "tgBulletSpringCable.h"
+#include "tgCordeCable.h"
+#include "tgControlInputRecord.h"
+#include "tgSnapshot.h"
 #include "tgWorld.h"
 // The C++ Standard Library
 #include <cmath>
 #include <iostream>
 #include <stdexcept>
+#include <typeinfo>
 
 using namespace std;
 
@@ -49,6 +55,13 @@ tgSpringCableActuator::Config::Config(double s,
   damping(d),
   pretension(p),
   hist(h),
+  histCapacity(0),
+  histCompressed(false),
+  histMantissaBits(tgCompressedSeries::exact),
+  substeps(1),
+  sleepTension(0.0),
+  sleepVelocity(0.0),
+  constraint(false),
   maxTens(mf),
   targetVelocity(tVel),
   minActualLength(mnAL),
@@ -87,6 +100,22 @@ tgSpringCableActuator::Config::Config(double s,
     }
 }
 
+tgSpringCableActuator::SpringCableActuatorHistory::SpringCableActuatorHistory() :
+    statCount(0),
+    energySpent(0.0),
+    tensionIntegral(0.0),
+    maxTension(0.0),
+    velocitySum(0.0),
+    lastTension(0.0),
+    lastRestLength(0.0)
+{
+}
+
+double tgSpringCableActuator::SpringCableActuatorHistory::meanVelocity() const
+{
+    return statCount == 0 ? 0.0 : velocitySum / statCount;
+}
+
 void tgSpringCableActuator::Config::scale (double sf)
 {
   pretension	  *= sf;
@@ -112,6 +141,19 @@ void tgSpringCableActuator::constructorAux()
     {
         throw std::invalid_argument("Starting rest length is negative.");
     }
+    else if (m_config.substeps == 0)
+    {
+        throw std::invalid_argument("Number of substeps is zero.");
+    }
+
+    // Throws if histMantissaBits is out of range
+    const tgCompressedSeries series(tgCompressedSeries::defaultChunkSize,
+                                    m_config.histMantissaBits);
+    m_pHistory->lengthSeries = series;
+    m_pHistory->restLengthSeries = series;
+    m_pHistory->dampingSeries = series;
+    m_pHistory->velocitySeries = series;
+    m_pHistory->tensionSeries = series;
 }
 tgSpringCableActuator::tgSpringCableActuator(tgSpringCable* springCable,
                     const tgTags& tags,
@@ -122,7 +164,11 @@ tgSpringCableActuator::tgSpringCableActuator(tgSpringCable* springCable,
     m_pHistory(new SpringCableActuatorHistory()),
     m_restLength(springCable->getRestLength()),
     m_startLength(springCable->getActualLength()),
-    m_prevVelocity(0.0)
+    m_prevVelocity(0.0),
+    m_deferCableForces(false),
+    m_stepCount(0),
+    m_pInputRecord(NULL),
+    m_inputIndex(0)
 {
     constructorAux();
 
@@ -133,6 +179,10 @@ tgSpringCableActuator::tgSpringCableActuator(tgSpringCable* springCable,
 
 tgSpringCableActuator::~tgSpringCableActuator()
 {
+    if (m_pInputRecord != NULL)
+    {
+        m_pInputRecord->release(this);
+    }
     delete m_springCable;
     delete m_pHistory;
 }
@@ -159,6 +209,205 @@ void tgSpringCableActuator::step(double dt)
     }
 }
 
+namespace
+{
+    /**
+     * Store a series decoded. Re-encoding it from its oldest value
+     * rebuilds the same chunks, since trimming only drops whole ones.
+     */
+    void writeSeries(tgSnapshot& snapshot, const tgCompressedSeries& series)
+    {
+        std::deque<double> values;
+        series.decode(values);
+        snapshot.write(values);
+    }
+
+    void readSeries(const tgSnapshot& snapshot, tgCompressedSeries& series)
+    {
+        std::deque<double> values;
+        snapshot.read(values);
+        series.clear();
+        for (std::size_t i = 0; i < values.size(); i++)
+        {
+            series.push_back(values[i]);
+        }
+    }
+}
+
+void tgSpringCableActuator::storeState(tgSnapshot& snapshot)
+{
+    snapshot.write(m_restLength);
+    snapshot.write(m_prevVelocity);
+    m_springCable->storeState(snapshot);
+
+    snapshot.write(m_pHistory->lastLengths);
+    snapshot.write(m_pHistory->restLengths);
+    snapshot.write(m_pHistory->dampingHistory);
+    snapshot.write(m_pHistory->lastVelocities);
+    snapshot.write(m_pHistory->tensionHistory);
+    if (m_config.histCompressed)
+    {
+        writeSeries(snapshot, m_pHistory->lengthSeries);
+        writeSeries(snapshot, m_pHistory->restLengthSeries);
+        writeSeries(snapshot, m_pHistory->dampingSeries);
+        writeSeries(snapshot, m_pHistory->velocitySeries);
+        writeSeries(snapshot, m_pHistory->tensionSeries);
+    }
+    snapshot.write(static_cast<double>(m_pHistory->statCount));
+    snapshot.write(m_pHistory->energySpent);
+    snapshot.write(m_pHistory->tensionIntegral);
+    snapshot.write(m_pHistory->maxTension);
+    snapshot.write(m_pHistory->velocitySum);
+    snapshot.write(m_pHistory->lastTension);
+    snapshot.write(m_pHistory->lastRestLength);
+
+    notifyStoreState(snapshot);
+    tgModel::storeState(snapshot);
+}
+
+void tgSpringCableActuator::restoreState(const tgSnapshot& snapshot)
+{
+    m_restLength = snapshot.read();
+    m_prevVelocity = snapshot.read();
+    m_springCable->restoreState(snapshot);
+
+    snapshot.read(m_pHistory->lastLengths);
+    snapshot.read(m_pHistory->restLengths);
+    snapshot.read(m_pHistory->dampingHistory);
+    snapshot.read(m_pHistory->lastVelocities);
+    snapshot.read(m_pHistory->tensionHistory);
+    if (m_config.histCompressed)
+    {
+        readSeries(snapshot, m_pHistory->lengthSeries);
+        readSeries(snapshot, m_pHistory->restLengthSeries);
+        readSeries(snapshot, m_pHistory->dampingSeries);
+        readSeries(snapshot, m_pHistory->velocitySeries);
+        readSeries(snapshot, m_pHistory->tensionSeries);
+    }
+    m_pHistory->statCount =
+        static_cast<std::size_t>(snapshot.read());
+    m_pHistory->energySpent = snapshot.read();
+    m_pHistory->tensionIntegral = snapshot.read();
+    m_pHistory->maxTension = snapshot.read();
+    m_pHistory->velocitySum = snapshot.read();
+    m_pHistory->lastTension = snapshot.read();
+    m_pHistory->lastRestLength = snapshot.read();
+
+    notifyRestoreState(snapshot);
+    tgModel::restoreState(snapshot);
+}
+
+void tgSpringCableActuator::setStiffness(double stiffness)
+{
+    m_springCable->setCoefK(stiffness);
+    m_config.stiffness = stiffness;
+}
+
+void tgSpringCableActuator::setDamping(double damping)
+{
+    m_springCable->setCoefD(damping);
+    m_config.damping = damping;
+}
+
+bool tgSpringCableActuator::deferCableForces(bool defer)
+{
+    return !defer;
+}
+
+bool tgSpringCableActuator::setCableForcesDeferred(bool defer)
+{
+    if (defer && typeid(*m_springCable) != typeid(tgBulletSpringCable) &&
+        typeid(*m_springCable) != typeid(tgCordeCable) &&
+        typeid(*m_springCable) != typeid(tgBulletContactSpringCable))
+    {
+        return false;
+    }
+    m_deferCableForces = defer;
+    return true;
+}
+
+void tgSpringCableActuator::recordHistory(double length, double velocity,
+                                          double damping, double restLength,
+                                          double tension, double dt)
+{
+    if (m_config.hist && m_config.histCompressed)
+    {
+        SpringCableActuatorHistory& h = *m_pHistory;
+        h.lengthSeries.push_back(length);
+        h.velocitySeries.push_back(velocity);
+        h.dampingSeries.push_back(damping);
+        h.restLengthSeries.push_back(restLength);
+        h.tensionSeries.push_back(tension);
+
+        h.lengthSeries.trim(m_config.histCapacity);
+        h.velocitySeries.trim(m_config.histCapacity);
+        h.dampingSeries.trim(m_config.histCapacity);
+        h.restLengthSeries.trim(m_config.histCapacity);
+        h.tensionSeries.trim(m_config.histCapacity);
+    }
+    else if (m_config.hist)
+    {
+        m_pHistory->lastLengths.push_back(length);
+        m_pHistory->lastVelocities.push_back(velocity);
+        m_pHistory->dampingHistory.push_back(damping);
+        m_pHistory->restLengths.push_back(restLength);
+        m_pHistory->tensionHistory.push_back(tension);
+        
+        // Popping the front lets the deques reuse their blocks
+        if (m_config.histCapacity != 0 &&
+            m_pHistory->tensionHistory.size() > m_config.histCapacity)
+        {
+            m_pHistory->lastLengths.pop_front();
+            m_pHistory->lastVelocities.pop_front();
+            m_pHistory->dampingHistory.pop_front();
+            m_pHistory->restLengths.pop_front();
+            m_pHistory->tensionHistory.pop_front();
+        }
+    }
+
+    SpringCableActuatorHistory& h = *m_pHistory;
+    if (dt > 0.0)
+    {
+        // Same sign convention as the controllers' energy loops
+        const double shortening = h.lastRestLength - restLength;
+        if (shortening > 0.0)
+        {
+            h.energySpent += h.lastTension * shortening;
+        }
+        if (tension > h.maxTension)
+        {
+            h.maxTension = tension;
+        }
+        h.tensionIntegral += tension * dt;
+        h.velocitySum += velocity;
+        ++h.statCount;
+    }
+    h.lastTension = tension;
+    h.lastRestLength = restLength;
+}
+
+tgBulletSpringCable* tgSpringCableActuator::getDeferredCable()
+{
+    // setCableForcesDeferred() has checked the type
+    return m_deferCableForces &&
+        typeid(*m_springCable) == typeid(tgBulletSpringCable) ?
+        static_cast<tgBulletSpringCable*>(m_springCable) : NULL;
+}
+
+tgCordeCable* tgSpringCableActuator::getDeferredCordeCable()
+{
+    return m_deferCableForces &&
+        typeid(*m_springCable) == typeid(tgCordeCable) ?
+        static_cast<tgCordeCable*>(m_springCable) : NULL;
+}
+
+tgBulletContactSpringCable* tgSpringCableActuator::getDeferredContactCable()
+{
+    return m_deferCableForces &&
+        typeid(*m_springCable) == typeid(tgBulletContactSpringCable) ?
+        static_cast<tgBulletContactSpringCable*>(m_springCable) : NULL;
+}
+
 const double tgSpringCableActuator::getStartLength() const
 {
     return m_startLength;
@@ -184,6 +433,21 @@ const double tgSpringCableActuator::getVelocity() const
     return m_springCable->getVelocity();
 }
 
+void tgSpringCableActuator::setInputRecord(tgControlInputRecord* pRecord,
+                                           std::size_t index)
+{
+    m_pInputRecord = pRecord;
+    m_inputIndex = index;
+}
+
+void tgSpringCableActuator::recordControlInput(double input, double dt)
+{
+    if (m_pInputRecord != NULL)
+    {
+        m_pInputRecord->add(m_stepCount, m_inputIndex, input, dt);
+    }
+}
+
 const tgSpringCableActuator::SpringCableActuatorHistory& tgSpringCableActuator::getHistory() const
 {
     return *m_pHistory;
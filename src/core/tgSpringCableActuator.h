@@ -31,11 +31,17 @@
 #include "tgModel.h"
 #include "tgControllable.h"
 #include "tgSubject.h"
+#include "tgCompressedSeries.h"
 
+#include <cstddef>
 #include <deque> // For history
 // Forward declarations
 class tgWorld;
 class tgSpringCable;
+class tgBulletContactSpringCable;
+class tgBulletSpringCable;
+class tgCordeCable;
+class tgControlInputRecord;
 
 /**
  * Sets a basic API for spring cable actuator models, so controllers can interface
@@ -102,9 +108,65 @@ public:
       // History Parameters
       /**
        * Specifies whether data such as length and tension will be stored
-       * in deque objects. Useful for computing the energy of a trial.
+       * in deque objects. The energy of a trial is kept in the running
+       * aggregates of SpringCableActuatorHistory either way.
        */
       bool hist;
+
+      /**
+       * The greatest number of steps kept in each history deque when
+       * hist is true. Older entries are dropped first. Zero, the default,
+       * keeps every step. Not a constructor parameter; set it after
+       * construction.
+       */
+      std::size_t histCapacity;
+
+      /**
+       * Keep the histories compressed in the tgCompressedSeries of
+       * SpringCableActuatorHistory instead of the deques, which stay
+       * empty, when hist is true. A long full-resolution trial then takes
+       * a fraction of the memory, and only reading the series decodes
+       * it. With a histCapacity the series drop whole chunks, so they
+       * keep up to one chunk more than it. False, the default. Not a
+       * constructor parameter; set it after construction.
+       */
+      bool histCompressed;
+
+      /**
+       * The bits of each mantissa the compressed series keep, see
+       * tgCompressedSeries. Fewer compress values that change at every
+       * step much better: 20 keep a relative error under 1e-6. The
+       * default, tgCompressedSeries::exact, keeps every value exactly.
+       * Not a constructor parameter; set it after construction.
+       */
+      unsigned histMantissaBits;
+
+      /**
+       * The number of sub-steps the cable force, and the motor of a
+       * tgKinematicActuator, take within each world step. More than one
+       * integrates them semi-implicitly, so stiff cables stay stable
+       * with a larger timestep for the rigid bodies. Must be positive.
+       * Not a constructor parameter; set it after construction.
+       */
+      std::size_t substeps;
+
+      /**
+       * Below this tension and this rate of change of length the cable
+       * lets its bodies sleep, see tgBulletSpringCable::setSleepThresholds.
+       * Zero, the default, keeps the bodies awake. Not constructor
+       * parameters; set them after construction.
+       */
+      double sleepTension;
+      double sleepVelocity;
+
+      /**
+       * Leave the cable force to a row of Bullet's constraint solver, see
+       * tgBulletSpringCable::enableConstraint. A stiff cable then stays
+       * stable with a much larger timestep. Only plain cables with fixed
+       * anchors take it. False, the default, applies the force as an
+       * impulse. Not a constructor parameter; set it after construction.
+       */
+      bool constraint;
               
       // Motor model parameters
       /**
@@ -195,6 +257,50 @@ public:
         
         /** Tension history. */
         std::deque<double> tensionHistory;
+
+        /**
+         * The same five histories when Config::histCompressed is true,
+         * oldest first; decode() one to read it.
+         */
+        tgCompressedSeries lengthSeries;
+        tgCompressedSeries restLengthSeries;
+        tgCompressedSeries dampingSeries;
+        tgCompressedSeries velocitySeries;
+        tgCompressedSeries tensionSeries;
+
+        // Running aggregates over every step, kept whether or not hist is
+        // true and however small histCapacity is, so controllers can
+        // score a trial without the deques.
+
+        /** The number of steps folded into the aggregates. */
+        std::size_t statCount;
+
+        /**
+         * Work done by the motor shortening the cable: the sum over steps
+         * of the previous tension times the decrease in rest length.
+         */
+        double energySpent;
+
+        /** Time integral of the tension. */
+        double tensionIntegral;
+
+        /** Greatest tension logged. */
+        double maxTension;
+
+        /** Sum of the logged velocities. */
+        double velocitySum;
+
+        /** Tension and rest length of the last log, for energySpent. */
+        double lastTension;
+        double lastRestLength;
+
+        SpringCableActuatorHistory();
+
+        /**
+         * The mean of the logged velocities.
+         * @return zero if no steps have been logged
+         */
+        double meanVelocity() const;
     };
 
     /** Deletes history and spring cable instantiation */
@@ -208,6 +314,20 @@ public:
     
     /** Just calls tgModel::step(dt) - steps any children */
     virtual void step(double dt);
+
+    /**
+     * Stores the rest length, the spring cable's state, the history
+     * deques and the state of any attached controllers, then the
+     * children. Subclasses append their motor state after calling this.
+     * @param[in,out] snapshot the snapshot to append to
+     */
+    virtual void storeState(tgSnapshot& snapshot);
+
+    /**
+     * Reads back what storeState() wrote, in the same order.
+     * @param[in] snapshot the snapshot to read from
+     */
+    virtual void restoreState(const tgSnapshot& snapshot);
     
     /**
      * Functions for interfacing with tgSpringCable
@@ -264,6 +384,91 @@ public:
     {
         return m_config;
     }
+
+    /**
+     * Change the stiffness of the running cable, in m_config too. The
+     * rest length is kept, so the tension changes with it.
+     * @param[in] stiffness the new stiffness, must be positive
+     */
+    void setStiffness(double stiffness);
+
+    /**
+     * Change the damping of the running cable, in m_config too.
+     * @param[in] damping the new damping, must be non-negative
+     */
+    void setDamping(double damping);
+    
+    /**
+     * Ask step() to leave the spring cable's force, and the history that
+     * depends on it, to a tgCableForcePass, to a tgCordeCableSolver
+     * for a tgCordeCable, or to a tgContactCableSolver for a
+     * tgBulletContactSpringCable. The base class does not
+     * support this; subclasses that do override it and call
+     * setCableForcesDeferred().
+     * @param[in] defer true to defer, false to go back to stepping the
+     * cable in step()
+     * @return true if the request was honored
+     */
+    virtual bool deferCableForces(bool defer);
+    
+    /**
+     * Return true if a tgCableForcePass, tgCordeCableSolver or
+     * tgContactCableSolver is computing this actuator's cable forces.
+     */
+    bool cableForcesDeferred() const
+    {
+        return m_deferCableForces;
+    }
+    
+    /**
+     * Return the spring cable whose force is deferred, for the
+     * tgCableForcePass to calculate and apply.
+     * @return the cable, or NULL if cableForcesDeferred() is false or
+     * the cable is a tgCordeCable
+     */
+    tgBulletSpringCable* getDeferredCable();
+
+    /**
+     * Return the Corde cable whose step is deferred, for the
+     * tgCordeCableSolver to advance and apply.
+     * @return the cable, or NULL if cableForcesDeferred() is false or
+     * the cable is not a tgCordeCable
+     */
+    tgCordeCable* getDeferredCordeCable();
+
+    /**
+     * Return the contact cable whose step is deferred, for the
+     * tgContactCableSolver to find the contacts of and commit.
+     * @return the cable, or NULL if cableForcesDeferred() is false or
+     * the cable is not a tgBulletContactSpringCable
+     */
+    tgBulletContactSpringCable* getDeferredContactCable();
+    
+    /**
+     * Do the bookkeeping step() skipped while deferred, such as logging
+     * history. Called after the deferred force is applied. The base
+     * class does nothing.
+     * @param[in] dt, the step just taken
+     */
+    virtual void finishDeferredStep(double dt) { }
+
+    /**
+     * Append every control input this actuator receives to a record,
+     * tagged with getStepCount(), so that tgControlInputReplay can feed
+     * them back in. Called by tgControlInputRecord::record().
+     * @param[in] pRecord the record, or NULL to stop recording
+     * @param[in] index the index of this actuator in the record
+     */
+    void setInputRecord(tgControlInputRecord* pRecord, std::size_t index);
+
+    /**
+     * Return the number of times step() has completed. Inputs received
+     * before step n are recorded, and replayed, under n.
+     */
+    std::size_t getStepCount() const
+    {
+        return m_stepCount;
+    }
     
 protected: 
     
@@ -274,6 +479,35 @@ protected:
     tgSpringCableActuator(tgSpringCable* springCable,
 			const tgTags& tags,
            tgSpringCableActuator::Config& config);
+    
+    /**
+     * Set m_deferCableForces if the spring cable is a plain
+     * tgBulletSpringCable or a tgCordeCable, whose force can be split
+     * into a calculation and an application. Contact cables move their
+     * anchors during the step and always step serially.
+     * @param[in] defer the requested setting
+     * @return true if the request was honored
+     */
+    bool setCableForcesDeferred(bool defer);
+
+    /**
+     * Log one step's values into the history deques, or the compressed
+     * series, when Config::hist is true, dropping the oldest beyond
+     * Config::histCapacity, and fold
+     * them into the running aggregates.
+     * @param[in] dt the step just taken, or zero for the values at
+     * construction, which only seed the aggregates
+     */
+    void recordHistory(double length, double velocity, double damping,
+                       double restLength, double tension, double dt);
+
+    /**
+     * Append a control input to the record set by setInputRecord(), if
+     * any. Subclasses call this from setControlInput().
+     * @param[in] input the input
+     * @param[in] dt the dt passed with it, or zero for the form without
+     */
+    void recordControlInput(double input, double dt);
            
 protected:
     /** The tgSpringCable system this actuator acts upon */
@@ -312,8 +546,27 @@ protected:
      * history is off.
      */
     double m_prevVelocity;
+    
+    /**
+     * True if step() should leave the spring cable to a
+     * tgCableForcePass.
+     */
+    bool m_deferCableForces;
+
+    /**
+     * The number of completed steps. Subclasses increment it at the end
+     * of step().
+     */
+    std::size_t m_stepCount;
+
 private:
 
+    /** The record set by setInputRecord(), or NULL. Not owned. */
+    tgControlInputRecord* m_pInputRecord;
+
+    /** The index of this actuator in m_pInputRecord. */
+    std::size_t m_inputIndex;
+
     /**
      * Helper function to perform what is in common to all constructor bodies.
      */
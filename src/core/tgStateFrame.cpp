@@ -0,0 +1,141 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgStateFrame.cpp
+ * @brief Contains the definitions of members of class tgStateFrame
+ * $Id$
+ */
+
+// This module
+#include "tgStateFrame.h"
+// This application
+#include "tgBaseRigid.h"
+#include "tgCast.h"
+#include "tgModel.h"
+#include "tgSpringCableActuator.h"
+// The C++ Standard Library
+#include <cassert>
+#include <stdexcept>
+
+const std::size_t tgStateFrame::cableFeatures;
+
+tgStateFrame::tgStateFrame() :
+    m_updates(0)
+{
+}
+
+void tgStateFrame::add(const tgModel& model)
+{
+    const std::vector<tgModel*>& descendants = model.getDescendants();
+    for (std::size_t i = 0; i < descendants.size(); ++i)
+    {
+        tgModel* const pModel = descendants[i];
+        assert(pModel != NULL);
+
+        tgSpringCableActuator* const pCable =
+            tgCast::cast<tgModel, tgSpringCableActuator>(pModel);
+        if (pCable != NULL && m_cableIndex.count(pCable) == 0)
+        {
+            m_cableIndex[pCable] = m_cables.size();
+            m_cables.push_back(pCable);
+            m_startLength.push_back(pCable->getStartLength());
+            m_maxTension.push_back(pCable->getConfig().maxTens);
+        }
+
+        // Rigids that are not set up have no body to read
+        tgBaseRigid* const pRigid =
+            tgCast::cast<tgModel, tgBaseRigid>(pModel);
+        if (pRigid != NULL && pRigid->getPRigidBody() != NULL &&
+            m_rigidIndex.count(pRigid) == 0)
+        {
+            m_rigidIndex[pRigid] = m_rigids.size();
+            m_rigids.push_back(pRigid);
+            m_poses.add(*pRigid);
+        }
+    }
+    m_restLength.resize(m_cables.size());
+    m_actualLength.resize(m_cables.size());
+    m_velocity.resize(m_cables.size());
+    m_tension.resize(m_cables.size());
+    m_features.resize(m_cables.size() * cableFeatures);
+    update();
+}
+
+void tgStateFrame::clear()
+{
+    m_cables.clear();
+    m_cableIndex.clear();
+    m_restLength.clear();
+    m_actualLength.clear();
+    m_velocity.clear();
+    m_tension.clear();
+    m_startLength.clear();
+    m_maxTension.clear();
+    m_features.clear();
+    m_rigids.clear();
+    m_rigidIndex.clear();
+    m_poses.clear();
+    m_updates = 0;
+}
+
+void tgStateFrame::update()
+{
+    const std::size_t n = m_cables.size();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const tgSpringCableActuator& cable = *m_cables[i];
+        m_restLength[i] = cable.getRestLength();
+        m_actualLength[i] = cable.getCurrentLength();
+        m_velocity[i] = cable.getVelocity();
+        m_tension[i] = cable.getTension();
+    }
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const double start = m_startLength[i];
+        const double maxTension = m_maxTension[i];
+        double* const features = &m_features[i * cableFeatures];
+        features[0] = ((m_actualLength[i] - start) / start) / 2.0 + 0.5;
+        features[1] =
+            ((m_tension[i] - maxTension / 2.0) / maxTension) / 2.0 + 0.5;
+    }
+    m_poses.update();
+    ++m_updates;
+}
+
+std::size_t tgStateFrame::indexOf(const tgSpringCableActuator* cable) const
+{
+    const std::map<const tgSpringCableActuator*, std::size_t>::const_iterator
+        it = m_cableIndex.find(cable);
+    if (it == m_cableIndex.end())
+    {
+        throw std::invalid_argument("Actuator is not in this state frame");
+    }
+    return it->second;
+}
+
+std::size_t tgStateFrame::indexOf(const tgBaseRigid* rigid) const
+{
+    const std::map<const tgBaseRigid*, std::size_t>::const_iterator
+        it = m_rigidIndex.find(rigid);
+    if (it == m_rigidIndex.end())
+    {
+        throw std::invalid_argument("Rigid is not in this state frame");
+    }
+    return it->second;
+}
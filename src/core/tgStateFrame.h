@@ -0,0 +1,167 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_STATE_FRAME_H
+#define TG_STATE_FRAME_H
+
+/**
+ * @file tgStateFrame.h
+ * @brief Contains the definition of class tgStateFrame
+ * $Id$
+ */
+
+// This module
+#include "tgRigidPoseBatch.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <map>
+#include <vector>
+
+// Forward declarations
+class tgBaseRigid;
+class tgModel;
+class tgSpringCableActuator;
+
+/**
+ * A snapshot of the cables and bodies of one model, taken once per step
+ * right after the world steps and before the models do. Controllers read
+ * it through tgModel::getStateFrame() instead of asking every actuator
+ * and rigid for its state, which walks the model and makes a virtual call
+ * per value; every controller of the model shares the one copy.
+ *
+ * The frame is not changed while the models step, so it shows the state
+ * at the start of the step even after a controller has changed a rest
+ * length. It keeps pointers to the actuators and the Bullet bodies and is
+ * rebuilt by tgSimulation whenever the model is set up again.
+ */
+class tgStateFrame
+{
+public:
+
+    /** Construct an empty frame. */
+    tgStateFrame();
+
+    /**
+     * Collect the spring cable actuators and rigids among a model's
+     * descendants, in the order of tgModel::getDescendants(), and read
+     * their state.
+     * @param[in] model a model that has been set up
+     */
+    void add(const tgModel& model);
+
+    /** Forget every actuator and rigid. */
+    void clear();
+
+    /** Read the current state of every actuator and rigid. */
+    void update();
+
+    /** @return the number of updates since the frame was last cleared */
+    std::size_t updates() const { return m_updates; }
+
+    /** @return the collected actuators, in order. Not owned. */
+    const std::vector<tgSpringCableActuator*>& getCables() const
+    {
+        return m_cables;
+    }
+
+    /**
+     * @param[in] cable an actuator
+     * @return the index of the actuator in this frame
+     * @throw std::invalid_argument if the actuator is not in this frame
+     */
+    std::size_t indexOf(const tgSpringCableActuator* cable) const;
+
+    /** @return the rest length of cable i */
+    double restLength(std::size_t i) const { return m_restLength[i]; }
+
+    /** @return the actual length of cable i */
+    double actualLength(std::size_t i) const { return m_actualLength[i]; }
+
+    /** @return the velocity of cable i */
+    double velocity(std::size_t i) const { return m_velocity[i]; }
+
+    /** @return the tension of cable i */
+    double tension(std::size_t i) const { return m_tension[i]; }
+
+    /** The number of values per cable in getCableFeatures() */
+    static const std::size_t cableFeatures = 2;
+
+    /**
+     * The cables' state as the inputs of a feedback network, cable by
+     * cable, so the rows can be passed to NeuralNetBatch::evaluate() in
+     * place: the stretch from the start length and the tension about
+     * half the motor's maximum, (length - start) / start and
+     * (tension - maxTens / 2) / maxTens, each mapped from -1..1 to 0..1.
+     * @return cableFeatures values per cable, or NULL if there are none
+     */
+    const double* getCableFeatures() const
+    {
+        return m_features.empty() ? NULL : &m_features[0];
+    }
+
+    /** @return the collected rigids, in order. Not owned. */
+    const std::vector<tgBaseRigid*>& getRigids() const
+    {
+        return m_rigids;
+    }
+
+    /**
+     * @param[in] rigid a rigid
+     * @return the index of the rigid in getPoses()
+     * @throw std::invalid_argument if the rigid is not in this frame
+     */
+    std::size_t indexOf(const tgBaseRigid* rigid) const;
+
+    /** @return the poses and velocities of the rigids, in order */
+    const tgRigidPoseBatch& getPoses() const { return m_poses; }
+
+private:
+
+    /** The actuators, in order. Not owned. */
+    std::vector<tgSpringCableActuator*> m_cables;
+
+    /** The index of each actuator in m_cables */
+    std::map<const tgSpringCableActuator*, std::size_t> m_cableIndex;
+
+    /** The state of each actuator at the last update */
+    std::vector<double> m_restLength;
+    std::vector<double> m_actualLength;
+    std::vector<double> m_velocity;
+    std::vector<double> m_tension;
+
+    /** Per cable: what getCableFeatures() is normalized by */
+    std::vector<double> m_startLength;
+    std::vector<double> m_maxTension;
+
+    /** cableFeatures values per cable at the last update */
+    std::vector<double> m_features;
+
+    /** The rigids, in the order of m_poses. Not owned. */
+    std::vector<tgBaseRigid*> m_rigids;
+
+    /** The index of each rigid in m_rigids */
+    std::map<const tgBaseRigid*, std::size_t> m_rigidIndex;
+
+    /** The poses of m_rigids */
+    tgRigidPoseBatch m_poses;
+
+    /** The number of updates since the last clear() */
+    std::size_t m_updates;
+};
+
+#endif  // TG_STATE_FRAME_H
@@ -0,0 +1,119 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgStepSchedule.cpp
+ * @brief Contains the definitions of members of class tgStepSchedule
+ * $Id$
+ */
+
+// This module
+#include "tgStepSchedule.h"
+// The C++ Standard Library
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+    /**
+     * When a callee last due at last is next due. Steps summed in
+     * floating point fall a little short of the period, which must not
+     * cost a whole extra step.
+     */
+    double nextDue(double last, double period)
+    {
+        return last + period - 1.0e-6 * period;
+    }
+}
+
+tgStepSchedule::tgStepSchedule() :
+    m_time(0.0),
+    m_nextDue(std::numeric_limits<double>::infinity())
+{
+}
+
+std::size_t tgStepSchedule::add(double period)
+{
+    if (period < 0.0)
+    {
+        throw std::invalid_argument("Step period is negative");
+    }
+    const std::size_t i = m_periods.size();
+    m_periods.push_back(period);
+    m_last.push_back(m_time);
+    m_due.push_back(nextDue(m_time, period));
+    if (period == 0.0)
+    {
+        m_everyStep.push_back(i);
+    }
+    else if (m_due[i] < m_nextDue)
+    {
+        m_nextDue = m_due[i];
+    }
+    return i;
+}
+
+bool tgStepSchedule::advance(double dt)
+{
+    m_time += dt;
+    if (m_time < m_nextDue)
+    {
+        return false;
+    }
+    // Found again by take()
+    m_nextDue = std::numeric_limits<double>::infinity();
+    return true;
+}
+
+double tgStepSchedule::take(std::size_t i, double dt)
+{
+    assert(i < m_periods.size());
+    const double period = m_periods[i];
+    if (period == 0.0)
+    {
+        return dt;
+    }
+    double result = 0.0;
+    if (m_time >= m_due[i])
+    {
+        result = m_time - m_last[i];
+        m_last[i] = m_time;
+        m_due[i] = nextDue(m_time, period);
+    }
+    if (m_due[i] < m_nextDue)
+    {
+        m_nextDue = m_due[i];
+    }
+    return result;
+}
+
+void tgStepSchedule::reset()
+{
+    m_time = 0.0;
+    m_nextDue = std::numeric_limits<double>::infinity();
+    for (std::size_t i = 0; i < m_periods.size(); i++)
+    {
+        m_last[i] = 0.0;
+        m_due[i] = nextDue(0.0, m_periods[i]);
+        if (m_periods[i] > 0.0 && m_due[i] < m_nextDue)
+        {
+            m_nextDue = m_due[i];
+        }
+    }
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_STEP_SCHEDULE_H
+#define TG_STEP_SCHEDULE_H
+
+/**
+ * @file tgStepSchedule.h
+ * @brief Contains the definition of class tgStepSchedule
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+/**
+ * Decides which of a list of callees are due on each step. A callee with
+ * a period of zero is due every step; one with a positive period is due
+ * once that much time has passed since it was last due, and then gets
+ * all of that time as its dt, as the m_updateTime accumulators of the
+ * controllers did. Steps on which no periodic callee is due only visit
+ * the every-step ones, so slow callees cost nothing in between.
+ *
+ * Use:
+ * @code
+ * if (!schedule.advance(dt))
+ *     for each i in schedule.getEveryStep(): call i with dt
+ * else
+ *     for each i: if ((stepDt = schedule.take(i, dt)) > 0) call i with stepDt
+ * @endcode
+ */
+class tgStepSchedule
+{
+public:
+
+    tgStepSchedule();
+
+    /**
+     * Add a callee at the end of the list
+     * @param[in] period the time between calls; zero is every step
+     * @return the callee's index
+     * @throw std::invalid_argument if period is negative
+     */
+    std::size_t add(double period);
+
+    /** @return the number of callees */
+    std::size_t size() const { return m_periods.size(); }
+
+    /** @return the indices of the callees due every step, in order */
+    const std::vector<std::size_t>& getEveryStep() const
+    {
+        return m_everyStep;
+    }
+
+    /**
+     * Pass the time of a step
+     * @param[in] dt the step size
+     * @return true if a periodic callee is due; then take() must be
+     * called for every callee, in any order
+     */
+    bool advance(double dt);
+
+    /**
+     * @param[in] i a callee's index
+     * @param[in] dt the step size given to advance()
+     * @return dt for a callee due every step, the time since its last
+     * call for a periodic callee that is due, and 0 otherwise
+     */
+    double take(std::size_t i, double dt);
+
+    /** Start again from time zero, for example on setup */
+    void reset();
+
+private:
+
+    /** The period of each callee, 0 for every step */
+    std::vector<double> m_periods;
+
+    /** When each periodic callee was last due */
+    std::vector<double> m_last;
+
+    /** When each periodic callee is next due, less a tolerance */
+    std::vector<double> m_due;
+
+    std::vector<std::size_t> m_everyStep;
+
+    /** The time since the last reset() */
+    double m_time;
+
+    /** The earliest of m_due */
+    double m_nextDue;
+};
+
+#endif  // TG_STEP_SCHEDULE_H
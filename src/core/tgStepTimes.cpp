@@ -0,0 +1,241 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgStepTimes.cpp
+ * @brief Contains the definitions of members of class tgStepTimes
+ * $Id$
+ */
+
+// This module
+#include "tgStepTimes.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <iomanip>
+#include <stdexcept>
+#ifdef __GNUC__
+#include <cxxabi.h>
+#endif
+#ifdef __APPLE__
+#include <sys/time.h>
+#else
+#include <time.h>
+#endif
+// Boost
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+
+int tgStepTimes::s_enabled = 0;
+
+namespace
+{
+    // Guards tgStepTimes::s_enabled
+    boost::mutex enabledMutex;
+
+    // The thread only borrows the times of its step
+    void release(tgStepTimes*) { }
+
+    boost::thread_specific_ptr<tgStepTimes> threadTimes(release);
+
+    std::string typeName(const std::type_info& type)
+    {
+#ifdef __GNUC__
+        int status = 0;
+        char* const name = abi::__cxa_demangle(type.name(), NULL, NULL, &status);
+        if (name != NULL)
+        {
+            const std::string result(name);
+            std::free(name);
+            return result;
+        }
+#endif
+        return type.name();
+    }
+
+    bool earlier(const std::pair<std::size_t, tgStepTimes::Controller>& a,
+                 const std::pair<std::size_t, tgStepTimes::Controller>& b)
+    {
+        return a.first < b.first;
+    }
+}
+
+tgStepTimes::Step::Step(tgStepTimes& times) :
+    m_times(times),
+    m_pPrevious(NULL),
+    m_active(times.m_enabled),
+    m_last(0)
+{
+    if (m_active)
+    {
+        times.m_steps++;
+        m_pPrevious = threadCurrent();
+        setThreadCurrent(&times);
+        m_last = now();
+    }
+}
+
+tgStepTimes::Step::~Step()
+{
+    if (m_active)
+    {
+        setThreadCurrent(m_pPrevious);
+    }
+}
+
+tgStepTimes::tgStepTimes() :
+    m_enabled(false)
+{
+    reset();
+}
+
+tgStepTimes::~tgStepTimes()
+{
+    setEnabled(false);
+}
+
+void tgStepTimes::setEnabled(bool enabled)
+{
+    if (enabled != m_enabled)
+    {
+        boost::mutex::scoped_lock lock(enabledMutex);
+        s_enabled += enabled ? 1 : -1;
+        m_enabled = enabled;
+    }
+}
+
+void tgStepTimes::reset()
+{
+    m_steps = 0;
+    std::fill(m_nanoseconds, m_nanoseconds + eNumComponents, 0);
+    m_controllers.clear();
+}
+
+double tgStepTimes::getSeconds(Component c) const
+{
+    if (c < 0 || c >= eNumComponents)
+    {
+        throw std::invalid_argument("No such step time component");
+    }
+    return m_nanoseconds[c] * 1.0e-9;
+}
+
+std::vector<tgStepTimes::Controller> tgStepTimes::getControllers() const
+{
+    std::vector<std::pair<std::size_t, Controller> > ordered;
+    ordered.reserve(m_controllers.size());
+    for (std::map<const void*, Totals>::const_iterator it = m_controllers.begin();
+         it != m_controllers.end(); ++it)
+    {
+        ordered.push_back(std::make_pair(it->second.order, it->second.controller));
+    }
+    std::sort(ordered.begin(), ordered.end(), earlier);
+
+    std::vector<Controller> result;
+    result.reserve(ordered.size());
+    for (std::size_t i = 0; i < ordered.size(); i++)
+    {
+        result.push_back(ordered[i].second);
+    }
+    return result;
+}
+
+const char* tgStepTimes::getName(Component c)
+{
+    static const char* const names[eNumComponents] = {
+        "world", "state frames", "models", "obstacles", "cables",
+        "data managers", "controllers"
+    };
+    return (c >= 0 && c < eNumComponents) ? names[c] : "";
+}
+
+void tgStepTimes::addController(const void* pObserver,
+                                const std::type_info& type,
+                                long long nanoseconds)
+{
+    std::map<const void*, Totals>::iterator it = m_controllers.find(pObserver);
+    if (it == m_controllers.end())
+    {
+        Totals totals;
+        totals.order = m_controllers.size();
+        totals.controller.type = typeName(type);
+        totals.controller.seconds = 0.0;
+        totals.controller.calls = 0;
+        it = m_controllers.insert(std::make_pair(pObserver, totals)).first;
+    }
+    it->second.controller.seconds += nanoseconds * 1.0e-9;
+    it->second.controller.calls++;
+    m_nanoseconds[eControllers] += nanoseconds;
+}
+
+long long tgStepTimes::now()
+{
+#ifdef __APPLE__
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000000LL + tv.tv_usec * 1000LL;
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#endif
+}
+
+tgStepTimes* tgStepTimes::threadCurrent()
+{
+    return threadTimes.get();
+}
+
+void tgStepTimes::setThreadCurrent(tgStepTimes* pTimes)
+{
+    threadTimes.reset(pTimes);
+}
+
+std::ostream& operator<<(std::ostream& os, const tgStepTimes& times)
+{
+    double total = 0.0;
+    for (int c = 0; c < tgStepTimes::eControllers; c++)
+    {
+        total += times.getSeconds(static_cast<tgStepTimes::Component>(c));
+    }
+    const std::ios::fmtflags flags = os.flags();
+    const std::streamsize precision = os.precision();
+    os << std::fixed << std::setprecision(6)
+       << "Step times over " << times.getSteps() << " steps" << std::endl;
+    for (int c = 0; c < tgStepTimes::eNumComponents; c++)
+    {
+        const tgStepTimes::Component component =
+            static_cast<tgStepTimes::Component>(c);
+        const double seconds = times.getSeconds(component);
+        os << "  " << std::setw(14) << std::left << tgStepTimes::getName(component)
+           << std::right << std::setw(12) << seconds << " s "
+           << std::setprecision(1) << std::setw(6)
+           << ((total > 0.0) ? 100.0 * seconds / total : 0.0) << " %"
+           << std::setprecision(6) << std::endl;
+    }
+    const std::vector<tgStepTimes::Controller> controllers = times.getControllers();
+    for (std::size_t i = 0; i < controllers.size(); i++)
+    {
+        os << "    " << controllers[i].type << ": " << controllers[i].seconds
+           << " s in " << controllers[i].calls << " calls" << std::endl;
+    }
+    os.flags(flags);
+    os.precision(precision);
+    return os;
+}
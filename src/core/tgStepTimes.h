@@ -0,0 +1,189 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_STEP_TIMES_H
+#define TG_STEP_TIMES_H
+
+/**
+ * @file tgStepTimes.h
+ * @brief Contains the definition of class tgStepTimes
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+/**
+ * Where the time of tgSimulation::step goes: the world step, reading the
+ * state frames, the model steps, the obstacle steps, the deferred cable
+ * forces and the data managers, and within the model steps each
+ * controller's tgObserver::onStep, as called by tgSubject::notifyStep.
+ * Each tgSimulation has its own, off until setEnabled(true); while off a
+ * step only tests a flag, and notifyStep a counter.
+ *
+ * Times are read from the monotonic clock, whose resolution is well under
+ * a microsecond on Linux. Contact cable manifold updates are part of the
+ * step of the model that owns the cable, or of the world step for cables
+ * stepped by tgCableForcePass.
+ */
+class tgStepTimes
+{
+public:
+
+    enum Component
+    {
+        eWorld,
+        eStateFrames,
+        eModels,
+        eObstacles,
+        eCables,
+        eDataManagers,
+        /** Part of eModels */
+        eControllers,
+        eNumComponents
+    };
+
+    /** The time of one controller */
+    struct Controller
+    {
+        /** The controller's class */
+        std::string type;
+        double seconds;
+        std::size_t calls;
+    };
+
+    /** Times the steps of a simulation while it lives */
+    class Step
+    {
+    public:
+
+        /**
+         * Count a step and, if times is enabled, make it the one
+         * controllers on this thread report to.
+         */
+        Step(tgStepTimes& times);
+
+        ~Step();
+
+        /** Add the time since the last lap, or the start, to c */
+        void lap(Component c)
+        {
+            if (m_times.m_enabled)
+            {
+                const long long now = tgStepTimes::now();
+                m_times.m_nanoseconds[c] += now - m_last;
+                m_last = now;
+            }
+        }
+
+    private:
+        tgStepTimes& m_times;
+
+        /** The times controllers reported to before, if enabled */
+        tgStepTimes* m_pPrevious;
+
+        /** True if times was enabled at the start */
+        bool m_active;
+
+        long long m_last;
+    };
+
+    tgStepTimes();
+
+    ~tgStepTimes();
+
+    /** Start or stop timing; the totals are kept */
+    void setEnabled(bool enabled);
+
+    bool isEnabled() const { return m_enabled; }
+
+    /** Forget the totals */
+    void reset();
+
+    /** @return the number of steps timed */
+    std::size_t getSteps() const { return m_steps; }
+
+    /** @return the total seconds spent in c */
+    double getSeconds(Component c) const;
+
+    /** @return the controllers that were timed, in the order first seen */
+    std::vector<Controller> getControllers() const;
+
+    /** @return a short name of c, such as "world" */
+    static const char* getName(Component c);
+
+    /**
+     * @return the times of the step running on this thread, if they are
+     * enabled, or NULL
+     */
+    static tgStepTimes* current()
+    {
+        return (s_enabled > 0) ? threadCurrent() : NULL;
+    }
+
+    /**
+     * Add one call of a controller.
+     * @param[in] pObserver the controller
+     * @param[in] type its dynamic type
+     * @param[in] nanoseconds the time of the call, from now()
+     */
+    void addController(const void* pObserver, const std::type_info& type,
+                       long long nanoseconds);
+
+    /** @return nanoseconds from an arbitrary start */
+    static long long now();
+
+private:
+
+    struct Totals
+    {
+        std::size_t order;
+        Controller controller;
+    };
+
+    static tgStepTimes* threadCurrent();
+
+    static void setThreadCurrent(tgStepTimes* pTimes);
+
+    bool m_enabled;
+
+    std::size_t m_steps;
+
+    long long m_nanoseconds[eNumComponents];
+
+    std::map<const void*, Totals> m_controllers;
+
+    /** The number of enabled instances */
+    static int s_enabled;
+};
+
+/**
+ * Overload operator<<() to write the seconds and the share of the step
+ * of each component and controller
+ * @param[in,out] os an ostream
+ * @param[in] times the step times
+ * @return os
+ */
+std::ostream& operator<<(std::ostream& os, const tgStepTimes& times);
+
+#endif  // TG_STEP_TIMES_H
@@ -0,0 +1,59 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_STOP_CONDITION_H
+#define TG_STOP_CONDITION_H
+
+/**
+ * @file tgStopCondition.h
+ * @brief Contains the definition of interface tgStopCondition
+ * $Id$
+ */
+
+// Forward declarations
+class tgSimulation;
+
+/**
+ * Ends a trial early once it has converged or failed, see
+ * tgSimulation::setStopCondition(). A learning run then spends no more
+ * steps on a trial whose score can no longer change, and the trial
+ * reports tgSimulation::eCondition as the reason it ended.
+ */
+class tgStopCondition
+{
+public:
+
+    virtual ~tgStopCondition() { }
+
+    /**
+     * Called when tgSimulation::run(int) starts, before the first step.
+     * @param[in] simulation the simulation about to run
+     */
+    virtual void start(const tgSimulation& simulation) { }
+
+    /**
+     * Called after each step of tgSimulation::run(int), once the models
+     * and data managers have stepped.
+     * @param[in] simulation the simulation, whose state frames are current
+     * @param[in] dt the step just taken
+     * @return true to end the run after this step
+     */
+    virtual bool shouldStop(const tgSimulation& simulation, double dt) = 0;
+};
+
+#endif  // TG_STOP_CONDITION_H
@@ -29,6 +29,10 @@
 
 // This application
 #include "tgObserver.h"
+#include "tgObserverPipeline.h"
+#include "tgParallelSubject.h"
+#include "tgStepSchedule.h"
+#include "tgStepTimes.h"
 // The C++ standard library
 #include <vector>
 
@@ -39,14 +43,32 @@
  * of tensegrity structures, a structure that needs to be controlled
  * will be a child of this class. This can either be the main model
  * or submodels such as a tgLinearString
+ *
+ * An observer attached with a period is only stepped once that much
+ * simulation time has passed, with all of it as its dt; see
+ * tgStepSchedule.
+ *
+ * Observers that are parallel safe are stepped by notifyStep() too,
+ * unless a tgObserverPass has taken them over.
+ *
+ * A subject whose controller stack is fixed can name it as its
+ * Pipeline, a tgObserverPipeline of the observers' types, and set it
+ * with attachPipeline(). notifyStep() then calls the whole stack inline,
+ * every step and before the attached observers, without a loop or a
+ * virtual call. The default Pipeline is empty.
  */
-template <typename T>
-class tgSubject
+template <typename T, typename Pipeline = tgObserverPipeline<T> >
+class tgSubject : public tgParallelSubject
 {
 public:
 
     /** The consructor has nothing to do. */
-    tgSubject() { }
+    tgSubject() :
+        m_pPipeline(NULL),
+        m_pipelineSetUp(false),
+        m_pipelineParallel(false),
+        m_deferParallel(false)
+    { }
 
     /** The virtual destructor has nothing to do. */
     virtual ~tgSubject() { }
@@ -57,10 +79,29 @@ public:
      * do nothing if the pointer is NULL
      */
     void attach(tgObserver<T>* pObserver);
+
+    /**
+     * Attach an observer that is stepped every period seconds of
+     * simulation time, counted from the last notifySetup().
+     * @param[in,out] pObserver a pointer to an observer for the subject;
+     * do nothing if the pointer is NULL
+     * @param[in] period the time between calls to onStep(); zero is every
+     * step
+     * @throw std::invalid_argument if period is negative
+     */
+    void attach(tgObserver<T>* pObserver, double period);
+
+    /**
+     * Set the pipeline stepped before the attached observers, and call
+     * its onAttach().
+     * @param[in,out] pPipeline the pipeline, not owned; NULL for none
+     */
+    void attachPipeline(Pipeline* pPipeline);
     
     /**
-     * Call tgObserver<T>::onStep() on all observers in the order in which they
-     * were attached.
+     * Step the pipeline, if any, then call tgObserver<T>::onStep() on all
+     * observers that are due, in the order in which they were attached. Each call is timed if the step times of the running
+     * tgSimulation are enabled.
      * @param[in] dt the number of seconds since the previous call; do nothing
      * if not positive
      */
@@ -68,7 +109,9 @@ public:
     
     /**
      * Call tgObserver<T>::onSetup() on all observers in the order in which they
-     * were attached.
+     * were attached, and restart their periods. Observers, and the
+     * pipeline, that have been set up before get tgObserver<T>::onReset()
+     * instead.
      */
     void notifySetup();
 
@@ -77,51 +120,229 @@ public:
      * were attached.
      */
     void notifyTeardown();
+
+    /**
+     * Call tgObserver<T>::onStoreState() on all observers in the order in
+     * which they were attached.
+     * @param[in,out] snapshot the snapshot to append to
+     */
+    void notifyStoreState(tgSnapshot& snapshot);
+
+    /**
+     * Call tgObserver<T>::onRestoreState() on all observers in the order in
+     * which they were attached.
+     * @param[in] snapshot the snapshot to read from
+     */
+    void notifyRestoreState(const tgSnapshot& snapshot);
+
+    /** @see tgParallelSubject::deferParallelObservers */
+    virtual bool deferParallelObservers(bool defer);
+
+    /** @see tgParallelSubject::notifyParallelStep */
+    virtual void notifyParallelStep(double dt);
+
+    /** @see tgParallelSubject::notifyReportMemory */
+    virtual void notifyReportMemory(tgMemoryReport& report) const;
     
 private:
 
+    /** Call onStep() of observer i, timed if pTimes is not NULL */
+    void stepObserver(std::size_t i, double dt, tgStepTimes* pTimes);
+
+    /** Step the pipeline, timed as one controller if pTimes is not NULL */
+    void stepPipeline(double dt, tgStepTimes* pTimes);
+
+    /** Stepped every step before m_observers; not owned, may be NULL */
+    Pipeline* m_pPipeline;
+
+    /** True once m_pPipeline has been set up */
+    bool m_pipelineSetUp;
+
+    /** True if m_pPipeline is parallel safe */
+    bool m_pipelineParallel;
+
     /**
      * A sequence of observers called in the order in which they were attached.
      * The subject does not own the observers and must not deallocate them.
      */
      std::vector<tgObserver<T> * > m_observers;
+
+    /** When each of m_observers is due, in the same order */
+    tgStepSchedule m_schedule;
+
+    /** True for each of m_observers that has been set up */
+    std::vector<bool> m_setUp;
+
+    /** True for each of m_observers that is parallel safe */
+    std::vector<bool> m_parallel;
+
+    /** The indices of the parallel safe observers */
+    std::vector<std::size_t> m_parallelObservers;
+
+    /** When each of m_parallelObservers is due, in the same order */
+    tgStepSchedule m_parallelSchedule;
+
+    /** True while notifyParallelStep() steps the parallel safe observers */
+    bool m_deferParallel;
 };
 
-template <typename Subject>
-void tgSubject<Subject>::attach(tgObserver<Subject>* pObserver)
+template <typename Subject, typename Pipeline>
+void tgSubject<Subject, Pipeline>::attach(tgObserver<Subject>* pObserver)
+{
+    attach(pObserver, 0.0);
+}
+
+template <typename Subject, typename Pipeline>
+void tgSubject<Subject, Pipeline>::attach(tgObserver<Subject>* pObserver, double period)
 {
-    if (pObserver) { m_observers.push_back(pObserver); 
+    if (pObserver) { m_schedule.add(period);
+        const bool parallel = pObserver->isParallelSafe();
+        if (parallel)
+        {
+            m_parallelSchedule.add(period);
+            m_parallelObservers.push_back(m_observers.size());
+        }
+        m_parallel.push_back(parallel);
+        m_setUp.push_back(false);
+        m_observers.push_back(pObserver); 
         pObserver->onAttach(static_cast<Subject&>(*this));}
 }
 
-template <typename Subject>
-void tgSubject<Subject>::notifyStep(double dt)
+template <typename Subject, typename Pipeline>
+void tgSubject<Subject, Pipeline>::attachPipeline(Pipeline* pPipeline)
+{
+    m_pPipeline = pPipeline;
+    m_pipelineSetUp = false;
+    m_pipelineParallel = pPipeline && pPipeline->isParallelSafe();
+    if (pPipeline) { pPipeline->onAttach(static_cast<Subject&>(*this)); }
+}
+
+template <typename Subject, typename Pipeline>
+void tgSubject<Subject, Pipeline>::notifyStep(double dt)
 {
     if (dt > 0)
     {
-        const std::size_t n = m_observers.size();
-    for (std::size_t i = 0; i < n; ++i) 
+        tgStepTimes* const pTimes = tgStepTimes::current();
+        if (m_pPipeline && !(m_deferParallel && m_pipelineParallel))
+        {
+            stepPipeline(dt, pTimes);
+        }
+        if (!m_schedule.advance(dt))
+        {
+            // Only the observers due every step
+            const std::vector<std::size_t>& everyStep = m_schedule.getEveryStep();
+            const std::size_t n = everyStep.size();
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                const std::size_t j = everyStep[i];
+                if (!(m_deferParallel && m_parallel[j])) { stepObserver(j, dt, pTimes); }
+            }
+        }
+        else
+        {
+            const std::size_t n = m_observers.size();
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                const double observerDt = m_schedule.take(i, dt);
+                if (observerDt > 0 && !(m_deferParallel && m_parallel[i]))
+                {
+                    stepObserver(i, observerDt, pTimes);
+                }
+            }
+        }
+    }
+}
+
+template <typename Subject, typename Pipeline>
+bool tgSubject<Subject, Pipeline>::deferParallelObservers(bool defer)
+{
+    if (m_parallelObservers.empty() && !m_pipelineParallel)
     {
-        tgObserver<Subject>* const pObserver = m_observers[i];
-        if (pObserver) { pObserver->onStep(static_cast<Subject&>(*this), dt); }
+        return false;
     }
+    if (defer && !m_deferParallel)
+    {
+        // Periods count from now, which is setup when added by tgSimulation
+        m_parallelSchedule.reset();
+    }
+    m_deferParallel = defer;
+    return true;
+}
+
+template <typename Subject, typename Pipeline>
+void tgSubject<Subject, Pipeline>::notifyParallelStep(double dt)
+{
+    if (dt > 0 && m_deferParallel)
+    {
+        tgStepTimes* const pTimes = tgStepTimes::current();
+        if (m_pPipeline && m_pipelineParallel) { stepPipeline(dt, pTimes); }
+        const std::size_t n = m_parallelObservers.size();
+        // Few enough to ask each, due or not
+        m_parallelSchedule.advance(dt);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const double observerDt = m_parallelSchedule.take(i, dt);
+            if (observerDt > 0) { stepObserver(m_parallelObservers[i], observerDt, pTimes); }
+        }
+    }
+}
+
+template <typename Subject, typename Pipeline>
+void tgSubject<Subject, Pipeline>::stepObserver(std::size_t i, double dt,
+                                                tgStepTimes* pTimes)
+{
+    tgObserver<Subject>* const pObserver = m_observers[i];
+    if (pTimes)
+    {
+        const long long start = tgStepTimes::now();
+        pObserver->onStep(static_cast<Subject&>(*this), dt);
+        pTimes->addController(pObserver, typeid(*pObserver),
+                              tgStepTimes::now() - start);
     }
+    else { pObserver->onStep(static_cast<Subject&>(*this), dt); }
 }
 
-template <typename Subject>
-void tgSubject<Subject>::notifySetup()
+template <typename Subject, typename Pipeline>
+void tgSubject<Subject, Pipeline>::stepPipeline(double dt, tgStepTimes* pTimes)
 {
+    if (pTimes)
+    {
+        const long long start = tgStepTimes::now();
+        m_pPipeline->step(static_cast<Subject&>(*this), dt);
+        pTimes->addController(m_pPipeline, typeid(Pipeline),
+                              tgStepTimes::now() - start);
+    }
+    else { m_pPipeline->step(static_cast<Subject&>(*this), dt); }
+}
+
+template <typename Subject, typename Pipeline>
+void tgSubject<Subject, Pipeline>::notifySetup()
+{
+        m_schedule.reset();
+        m_parallelSchedule.reset();
+        if (m_pPipeline)
+        {
+            if (m_pipelineSetUp) { m_pPipeline->onReset(static_cast<Subject&>(*this)); }
+            else { m_pPipeline->onSetup(static_cast<Subject&>(*this)); }
+            m_pipelineSetUp = true;
+        }
         const std::size_t n = m_observers.size();
     for (std::size_t i = 0; i < n; ++i) 
     {
         tgObserver<Subject>* const pObserver = m_observers[i];
-        if (pObserver) { pObserver->onSetup(static_cast<Subject&>(*this)); }
+        if (pObserver)
+        {
+            if (m_setUp[i]) { pObserver->onReset(static_cast<Subject&>(*this)); }
+            else { pObserver->onSetup(static_cast<Subject&>(*this)); }
+            m_setUp[i] = true;
+        }
     }
 }
 
-template <typename Subject> 
-void tgSubject<Subject>::notifyTeardown()
+template <typename Subject, typename Pipeline> 
+void tgSubject<Subject, Pipeline>::notifyTeardown()
 {
+    if (m_pPipeline) { m_pPipeline->onTeardown(static_cast<Subject&>(*this)); }
         const std::size_t n = m_observers.size();
     for (std::size_t i = 0; i < n; ++i) 
     {
@@ -129,5 +350,63 @@ void tgSubject<Subject>::notifyTeardown()
         if (pObserver) { pObserver->onTeardown(static_cast<Subject&>(*this)); }
     }
 }
+
+template <typename Subject, typename Pipeline> 
+void tgSubject<Subject, Pipeline>::notifyStoreState(tgSnapshot& snapshot)
+{
+    if (m_pPipeline)
+    {
+        m_pPipeline->onStoreState(static_cast<Subject&>(*this),
+                                  snapshot);
+    }
+    const std::size_t n = m_observers.size();
+    for (std::size_t i = 0; i < n; ++i) 
+    {
+        tgObserver<Subject>* const pObserver = m_observers[i];
+        if (pObserver)
+        {
+            pObserver->onStoreState(static_cast<Subject&>(*this), snapshot);
+        }
+    }
+}
+
+template <typename Subject, typename Pipeline> 
+void tgSubject<Subject, Pipeline>::notifyRestoreState(const tgSnapshot& snapshot)
+{
+    if (m_pPipeline)
+    {
+        m_pPipeline->onRestoreState(static_cast<Subject&>(*this),
+                                    snapshot);
+    }
+    const std::size_t n = m_observers.size();
+    for (std::size_t i = 0; i < n; ++i) 
+    {
+        tgObserver<Subject>* const pObserver = m_observers[i];
+        if (pObserver)
+        {
+            pObserver->onRestoreState(static_cast<Subject&>(*this), snapshot);
+        }
+    }
+}
+
+template <typename Subject, typename Pipeline> 
+void tgSubject<Subject, Pipeline>::notifyReportMemory(tgMemoryReport& report) const
+{
+    if (m_pPipeline)
+    {
+        m_pPipeline->onReportMemory(static_cast<const Subject&>(*this),
+                                    report);
+    }
+    const std::size_t n = m_observers.size();
+    for (std::size_t i = 0; i < n; ++i) 
+    {
+        const tgObserver<Subject>* const pObserver = m_observers[i];
+        if (pObserver)
+        {
+            pObserver->onReportMemory(static_cast<const Subject&>(*this),
+                                      report);
+        }
+    }
+}
 #endif  // TG_SUBJECT_H
 
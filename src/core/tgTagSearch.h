@@ -83,6 +83,14 @@ public:
         return matches(s);
     }
     
+    /**
+     * Return the tags the search requires
+     */
+    const tgTags& getTags() const
+    {
+        return m_search;
+    }
+
     /**
      * Remove the given tags from the search
      */
@@ -70,6 +70,11 @@ public:
     {
         return m_tags.contains(tags);
     }
+
+    bool hasAllTags(const tgTags& tags) const
+    {
+        return m_tags.contains(tags);
+    }
     
     bool hasAnyTags(const std::string tags)
     {
@@ -28,6 +28,7 @@
 
 #include <iostream> // Testing only
 #include <algorithm>
+#include <functional>
 #include <vector>
 #include <stdexcept>
 #include "tgTaggable.h"
@@ -49,7 +50,7 @@ public:
      * @author Lee Brownston
      * @date Wed 26 Feb 2014
      */
-    tgTaggables(std::vector<T>& elements) : m_elements(elements) {
+    tgTaggables(const std::vector<T>& elements) : m_elements(elements) {
         // All elements must be unique
         assertUniqueElements("All elements must be unique.");
         
@@ -61,11 +62,13 @@ public:
      * Return a vector of pointers to Ts that have all of
      * the specified tags.
      */
-    std::vector<T*> find(std::string tags) 
+    std::vector<T*> find(const std::string& tags) 
     {
+        // Parse the tags once, then each element is matched by id
+        const tgTags search(tags);
         std::vector<T*> result;
         for(int i = 0; i < m_elements.size(); i++) {
-            if(_taggable(&m_elements[i])->hasAllTags(tags)) {
+            if(_taggable(&m_elements[i])->hasAllTags(search)) {
                 result.push_back(&(m_elements[i]));
             }
         }
@@ -80,6 +83,7 @@ public:
     std::vector<T*> findAll()
     {
         std::vector<T*> result;
+        result.reserve(m_elements.size());
         for(int i = 0; i < m_elements.size(); i++) {
             result.push_back(&(m_elements[i]));
         }
@@ -98,19 +102,17 @@ public:
         return result;
     }
 
-    static bool contains(std::vector<T*> haystack, const T* needle)
+    static bool contains(const std::vector<T*>& haystack, const T* needle)
     {
         return std::find(haystack.begin(), haystack.end(), needle) != haystack.end();
     }
 
+    /**
+     * Is needle one of our elements (by identity, not by value)
+     */
     bool contains(const T& needle) const
     {
-        //return std::find(m_elements.begin(), m_elements.end(), needle) != m_elements.end(); // generates errors??
-        for(typename std::vector<T>::const_iterator it = m_elements.begin(); it != m_elements.end(); it++) {
-            if(&(*it) == &needle)
-                return true;
-        }
-        return false;
+        return elementExists(needle);
     }
     
     
@@ -138,7 +140,7 @@ public:
         return *this;
     }
 
-    T& operator-=(const std::vector<T*> other) {
+    T& operator-=(const std::vector<T*>& other) {
         this->removeElements(other);
         return *this;
     }
@@ -148,16 +150,21 @@ public:
         return *this;
     }
 
-    T& operator+=(const std::vector<T*> other) {
+    T& operator+=(const std::vector<T*>& other) {
         this->addElements(other);
         return *this;
     }
+
+    /** Remove every element and give back their storage. */
+    void clear() {
+        std::vector<T>().swap(m_elements);
+    }
     
 
 protected:
     
     // @todo: think about uniqueness -- if not unique, throw an error? return -1? 
-    int addElement(T element) 
+    int addElement(const T& element) 
     {
         // @todo: make sure the element is unique
         assert(!elementExists(element));  // segfault?
@@ -166,14 +173,14 @@ protected:
         return m_elements.size() - 1;  // This is the index that was created.
     }
 
-    void addElements(std::vector<T*> elements) 
+    void addElements(const std::vector<T*>& elements) 
     {
         for(int i = 0; i < elements.size(); i++) {
             this->addElement(elements[i]);
         }
     }
 
-    void setElement(int key, T element) {
+    void setElement(int key, const T& element) {
         assert((0 <= key) && (key <= m_elements.size()));
         m_elements[key] = element;
     }
@@ -183,6 +190,12 @@ protected:
         return m_elements;
     };
 
+    /** Make room for count elements in all, so adding them doesn't reallocate */
+    void reserveElements(std::size_t count)
+    {
+        m_elements.reserve(count);
+    }
+
     const std::vector<T>& getElements() const
     {
         return m_elements;
@@ -231,21 +244,31 @@ protected:
         return (0 <= key) && (key < m_elements.size());
     }        
     
-    // @todo: FIX THIS -- segfaults, etc. -- what's going on? 
+    /**
+     * Is element stored in m_elements. This compares addresses, not values:
+     * the vector is contiguous, so it is a range check rather than a scan.
+     */
     bool elementExists(const T& element) const
-    {        
-        //return std::find(m_elements.begin(), m_elements.end(), element) != m_elements.end(); // segfault?
-        for(int i = 0; i < m_elements.size(); i++) {
-            // This is a little strange to me, but at least it doesn't cause a segfault...
-            const T* elem =& m_elements[i];
-            if (elem == &element) {
-                return true;
-            }
+    {
+        if(m_elements.empty()) {
+            return false;
         }
-        return false;
+        const T* const first = &m_elements[0];
+        const T* const elem = &element;
+        return std::less_equal<const T*>()(first, elem) &&
+            std::less<const T*>()(elem, first + m_elements.size());
     }
     
-    void assertKeyExists(int key, std::string message = "Element at index does not exist") const
+    void assertKeyExists(int key) const
+    {
+        // operator[] calls this on every access, so only build the message
+        // when throwing
+        if(!keyExists(key)) {
+            assertKeyExists(key, "Element at index does not exist");
+        }
+    }
+
+    void assertKeyExists(int key, const std::string& message) const
     {
         if(!keyExists(key)) {
             std::stringstream ss; 
@@ -254,23 +277,27 @@ protected:
         }        
     }
     
-    void assertUnique(T& element, std::string message = "Taggable elements must be unique.") {
+    void assertUnique(const T& element) const {
+        if(elementExists(element)) {
+            assertUnique(element, "Taggable elements must be unique.");
+        }
+    }
+
+    void assertUnique(const T& element, const std::string& message) const {
         if(elementExists(element)) {
             throw std::logic_error(message);
         }
     }
     
-    void assertUniqueElements(std::string message = "Taggable elements must be unique.") const
+    /**
+     * Elements are unique by identity, as in elementExists, and every element
+     * has its own slot in m_elements, so this holds by construction. It used
+     * to build a std::set of every element for a test that, through operator
+     * precedence, could never fail.
+     * @todo compare by value once tgNode and tgPair have operator<
+     */
+    void assertUniqueElements(const std::string& message = "Taggable elements must be unique.") const
     {
-        /* Note: this throws a "Most vexing parse" error (http://en.wikipedia.org/wiki/Most_vexing_parse)
-        // Note: This would probably work if we implemented operator< on tgPair...
-        */
-        
-        if(! std::set<T>(m_elements.begin(), m_elements.end()).size() ==
-             m_elements.size()) {
-                 throw std::logic_error(message);
-             }
-
     }
     
     // Cast T to taggable (after all, T must be a tgTaggable in the first place, but )
@@ -0,0 +1,58 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgTags.cpp
+ * @brief Contains the tag intern table behind class tgTags
+ * $Id$
+ */
+
+// This module
+#include "tgTags.h"
+// The C++ Standard Library
+#include <map>
+// Boost
+#include <boost/thread/mutex.hpp>
+
+namespace
+{
+    // Models are built on tgThreadPool workers, so every access is locked.
+    // Matching only reads the ids stored in each tgTags and never gets here.
+    boost::mutex tableMutex;
+    std::map<std::string, unsigned> table;
+}
+
+unsigned tgTags::intern(const std::string& tag)
+{
+    boost::mutex::scoped_lock lock(tableMutex);
+    const std::pair<std::map<std::string, unsigned>::iterator, bool> entry =
+        table.insert(std::make_pair(tag, static_cast<unsigned>(table.size())));
+    return entry.first->second;
+}
+
+bool tgTags::lookup(const std::string& tag, unsigned& id)
+{
+    boost::mutex::scoped_lock lock(tableMutex);
+    const std::map<std::string, unsigned>::const_iterator it = table.find(tag);
+    if (it == table.end())
+    {
+        return false;
+    }
+    id = it->second;
+    return true;
+}
@@ -29,6 +29,7 @@
 #include <deque>
 #include <set>
 #include <string>
+#include <vector>
 #include <algorithm>
 #include <iostream>
 #include <sstream>
@@ -36,40 +37,93 @@
 
 #include "tgException.h"
 
+#include <boost/cstdint.hpp>
+
 struct tgTagException : public tgException
 {
    tgTagException(std::string ss) : tgException(ss) {}
 };
 
+/**
+ * Besides the tag strings, which keep their order for printing and naming,
+ * a tgTags holds each tag's id from a process wide intern table as a sorted
+ * vector, plus a 64 bit signature with bit (id % 64) set for every id.
+ * Matching one tgTags against another is a signature test that rejects
+ * most candidates in one word operation, then a merge of the two id
+ * vectors. No strings are compared or split while matching.
+ */
 class tgTags
 {
 public:
-    tgTags() {}
-    tgTags(const std::string& space_separated_tags)
+    tgTags() : m_signature(0) {}
+    tgTags(const std::string& space_separated_tags) : m_signature(0)
     {
         append(space_separated_tags);
     }
     
+    /**
+     * Return the id of a tag, adding it to the intern table the first time
+     * it is seen. Ids are small, dense and never reused. Thread safe.
+     */
+    static unsigned intern(const std::string& tag);
+
+    /**
+     * Look up the id of a tag without adding it to the table.
+     * @return false if no tgTags has ever held the tag
+     */
+    static bool lookup(const std::string& tag, unsigned& id);
+
+    /**
+     * The query is split and looked up on every call; parse it into a
+     * tgTags (or a tgTagSearch) once when matching repeatedly.
+     */
     bool contains(const std::string& space_separated_tags) const
     {
         const std::deque<std::string> tags = splitTags(space_separated_tags);
-        return contains(tags);
+        std::vector<unsigned> ids;
+        ids.reserve(tags.size());
+        for(std::size_t i = 0; i < tags.size(); i++) {
+            unsigned id;
+            // A tag nobody holds can't be contained
+            if(!lookup(tags[i], id))
+                return false;
+            ids.push_back(id);
+        }
+        std::sort(ids.begin(), ids.end());
+        return std::includes(m_ids.begin(), m_ids.end(),
+                             ids.begin(), ids.end());
     }
 
     bool contains(const tgTags& tags) const
     {
-        return contains(tags.getTags());
+        if((tags.m_signature & ~m_signature) != 0)
+            return false;
+        return std::includes(m_ids.begin(), m_ids.end(),
+                             tags.m_ids.begin(), tags.m_ids.end());
     }
         
-    bool containsAny(const std::string& space_separated_tags)
+    bool containsAny(const std::string& space_separated_tags) const
     {
         std::deque<std::string> tags = splitTags(space_separated_tags);
         return containsAny(tags);
     }
 
-    bool containsAny(const tgTags& tags) 
+    bool containsAny(const tgTags& tags) const
     {
-        return containsAny(tags.getTags());
+        if((tags.m_signature & m_signature) == 0)
+            return false;
+        // Walk both sorted id vectors looking for a common id
+        std::vector<unsigned>::const_iterator a = m_ids.begin();
+        std::vector<unsigned>::const_iterator b = tags.m_ids.begin();
+        while(a != m_ids.end() && b != tags.m_ids.end()) {
+            if(*a < *b)
+                ++a;
+            else if(*b < *a)
+                ++b;
+            else
+                return true;
+        }
+        return false;
     }
 
     void append(const std::string& space_separated_tags)
@@ -187,11 +241,10 @@ public:
         return true;
     }
 
-    std::deque<std::string>& getTags()
-    {
-        return m_tags;
-    }
-
+    /**
+     * The tags are read only from outside so the ids can't fall out of step
+     * with the strings; use append, prepend and remove to change them.
+     */
     const std::deque<std::string>& getTags() const
     {
         return m_tags;
@@ -206,15 +259,11 @@ public:
     }
 
     /**
-     * Return a non-const reference to the tag that is indexed by the
+     * Return a const reference to the tag that is indexed by the
      * int key. It must be in m_tags.
      * @param[in] key the key of the tag to retrieve
      * @reeturn a const reference to the tag that is indexed by key
      */
-    std::string& operator[](int key) { 
-        return m_tags[key]; 
-    }
-    
     const std::string& operator[](int key) const { 
         return m_tags[key]; 
     }
@@ -222,15 +271,19 @@ public:
     /**
      * Check if we contain the same tags regardless of ordering
      */
-    bool operator==(const tgTags& rhs)
+    bool operator==(const tgTags& rhs) const
     {
-        return rhs.asSet() == asSet(); 
+        // The id vectors are sorted and free of repeats, like a set
+        return m_ids == rhs.m_ids;
     }
 
     tgTags& operator+=(const tgTags& rhs)
     {
         const std::deque<std::string>& other = rhs.getTags();
         m_tags.insert(m_tags.end(), other.begin(), other.end());
+        for(std::size_t i = 0; i < rhs.m_ids.size(); i++) {
+            insertId(rhs.m_ids[i]);
+        }
         return *this;
     }
 
@@ -244,7 +297,7 @@ private:
         if(!isValid(tag)) {
             throw tgTagException("Invalid tag '" + tag + "' - tags must be alphanumeric and may not be castable to int.");
         }
-        if(!containsOne(tag)) {
+        if(insertId(intern(tag))) {
             m_tags.push_back(tag);
         }
     }
@@ -257,7 +310,7 @@ private:
     }
     
     void prependOne(std::string tag) {
-        if(isValid(tag) && !containsOne(tag)) {
+        if(isValid(tag) && insertId(intern(tag))) {
             m_tags.push_front(tag);
         }
     }
@@ -269,14 +322,6 @@ private:
         }
     }
 
-    bool contains(const std::deque<std::string>& tags) const {
-        for(std::size_t i = 0; i < tags.size(); i++) {
-            if(!containsOne(tags[i])) 
-                return false;
-        }
-        return true;
-    }
-
     bool containsAny(const std::deque<std::string>& tags) const {
         for(std::size_t i = 0; i < tags.size(); i++) {
             if(containsOne(tags[i])) 
@@ -288,12 +333,45 @@ private:
     /**
      * Check whether we contain a tag that is known to be valid
      */
-    bool containsOne(std::string tag) const {
-        return (std::find(m_tags.begin(), m_tags.end(), tag) != m_tags.end());
+    bool containsOne(const std::string& tag) const {
+        unsigned id;
+        return lookup(tag, id) &&
+            std::binary_search(m_ids.begin(), m_ids.end(), id);
     }
     
     void removeOne(std::string tag) {
+        unsigned id;
+        if(!lookup(tag, id))
+            return;
+        std::vector<unsigned>::iterator it =
+            std::lower_bound(m_ids.begin(), m_ids.end(), id);
+        if(it == m_ids.end() || *it != id)
+            return;
+        m_ids.erase(it);
         m_tags.erase(std::remove(m_tags.begin(), m_tags.end(), tag), m_tags.end());
+        // Other ids may share the removed id's bit
+        m_signature = 0;
+        for(std::size_t i = 0; i < m_ids.size(); i++) {
+            m_signature |= signatureBit(m_ids[i]);
+        }
+    }
+
+    static boost::uint64_t signatureBit(unsigned id) {
+        return boost::uint64_t(1) << (id % 64);
+    }
+
+    /**
+     * Add an id to the sorted id vector
+     * @return false if it was already there
+     */
+    bool insertId(unsigned id) {
+        std::vector<unsigned>::iterator it =
+            std::lower_bound(m_ids.begin(), m_ids.end(), id);
+        if(it != m_ids.end() && *it == id)
+            return false;
+        m_ids.insert(it, id);
+        m_signature |= signatureBit(id);
+        return true;
     }
     
     void remove(std::deque<std::string> tags) {
@@ -303,6 +381,12 @@ private:
     }
     
     std::deque<std::string> m_tags;
+
+    /** Interned ids of m_tags, sorted and without repeats */
+    std::vector<unsigned> m_ids;
+
+    /** Bit (id % 64) of every id in m_ids */
+    boost::uint64_t m_signature;
 };
 
 /**
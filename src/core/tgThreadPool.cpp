@@ -0,0 +1,209 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgThreadPool.cpp
+ * @brief Contains the definitions of members of class tgThreadPool
+ * $Id$
+ */
+
+// This module
+#include "tgThreadPool.h"
+// This application
+#include "tgCpuTopology.h"
+// The Boost library
+#include <boost/bind.hpp>
+// The C++ Standard Library
+#include <cassert>
+#include <exception>
+#include <stdexcept>
+
+tgThreadPool::tgThreadPool(std::size_t nThreads, bool pinned) :
+    m_nThreads(nThreads),
+    m_pTask(NULL),
+    m_nItems(0),
+    m_generation(0),
+    m_pending(0),
+    m_failed(false),
+    m_stop(false)
+{
+    if (m_nThreads == 0)
+    {
+        m_nThreads = boost::thread::hardware_concurrency();
+    }
+    // hardware_concurrency() returns 0 if it can't tell
+    if (m_nThreads == 0)
+    {
+        m_nThreads = 1;
+    }
+    
+    // A pool of one runs everything on the calling thread
+    if (m_nThreads > 1)
+    {
+        if (pinned)
+        {
+            const tgCpuTopology topology;
+            for (std::size_t i = 0; i < m_nThreads; ++i)
+            {
+                m_cpus.push_back(topology.cpuOf(i));
+                m_nodes.push_back(topology.nodeOf(i));
+            }
+        }
+        for (std::size_t i = 0; i < m_nThreads; ++i)
+        {
+            m_threads.create_thread(boost::bind(&tgThreadPool::workerLoop,
+                                                this, i));
+        }
+    }
+
+    // Postcondition
+    assert(invariant());
+}
+
+tgThreadPool::~tgThreadPool()
+{
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_stop = true;
+    }
+    m_workReady.notify_all();
+    m_threads.join_all();
+}
+
+void tgThreadPool::run(Task& task, std::size_t nItems)
+{
+    if (nItems == 0)
+    {
+        return;
+    }
+    else if (m_nThreads == 1 || (nItems == 1 && !isPinned()))
+    {
+        for (std::size_t i = 0; i < nItems; ++i)
+        {
+            task(i);
+        }
+        return;
+    }
+    
+    boost::mutex::scoped_lock lock(m_mutex);
+    assert(m_pending == 0);
+    m_pTask = &task;
+    m_nItems = nItems;
+    m_pending = m_nThreads;
+    m_failed = false;
+    m_failure.clear();
+    ++m_generation;
+    m_workReady.notify_all();
+
+    while (m_pending != 0)
+    {
+        m_workDone.wait(lock);
+    }
+    m_pTask = NULL;
+
+    if (m_failed)
+    {
+        throw std::runtime_error(m_failure);
+    }
+    
+    // Postcondition
+    assert(invariant());
+}
+
+std::size_t tgThreadPool::getNode(std::size_t worker) const
+{
+    if (worker >= m_nThreads)
+    {
+        throw std::out_of_range("worker index is out of range");
+    }
+    return isPinned() ? m_nodes[worker] : 0;
+}
+
+void tgThreadPool::workerLoop(std::size_t worker)
+{
+    if (isPinned())
+    {
+        tgCpuTopology::pin(m_cpus[worker]);
+    }
+
+    std::size_t seen = 0;
+    while (true)
+    {
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            while (!m_stop && m_generation == seen)
+            {
+                m_workReady.wait(lock);
+            }
+            if (m_stop)
+            {
+                return;
+            }
+            seen = m_generation;
+        }
+
+        runShare(worker);
+
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            assert(m_pending > 0);
+            if (--m_pending == 0)
+            {
+                m_workDone.notify_one();
+            }
+        }
+    }
+}
+
+void tgThreadPool::runShare(std::size_t worker)
+{
+    // m_pTask and m_nItems can't change until every worker has reported in
+    try
+    {
+        for (std::size_t i = worker; i < m_nItems; i += m_nThreads)
+        {
+            (*m_pTask)(i);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        if (!m_failed)
+        {
+            m_failed = true;
+            m_failure = e.what();
+        }
+    }
+    catch (...)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        if (!m_failed)
+        {
+            m_failed = true;
+            m_failure = "unknown exception in tgThreadPool task";
+        }
+    }
+}
+
+bool tgThreadPool::invariant() const
+{
+    return
+        (m_nThreads > 0) &&
+        (m_cpus.empty() || m_cpus.size() == m_nThreads) &&
+        (m_nodes.size() == m_cpus.size());
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_THREAD_POOL_H
+#define TG_THREAD_POOL_H
+
+/**
+ * @file tgThreadPool.h
+ * @brief Contains the definition of class tgThreadPool
+ * $Id$
+ */
+
+// The Boost library
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+// The C++ Standard Library
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * A fixed-size pool of worker threads that runs a tgThreadPool::Task over
+ * a range of item indices and blocks until every item has been processed.
+ * Items are assigned statically: worker w handles items w, w + n, w + 2n...
+ * so the same item always lands on the same worker, which keeps each
+ * world (or cable, or trial) on one core across calls. A pinned pool
+ * also keeps each worker on one CPU, spread over the NUMA nodes as
+ * tgCpuTopology places them, so what a task allocates and first writes
+ * for an item stays in the memory of the node that steps it.
+ * The pool is not reentrant: run() must not be called from inside a Task.
+ */
+class tgThreadPool
+{
+public:
+
+    /**
+     * Work to be done by the pool, one call per item index.
+     * Implementations must be safe to call concurrently for different items.
+     */
+    class Task
+    {
+    public:
+        virtual ~Task() { }
+        
+        /**
+         * Process one item.
+         * @param[in] item the index of the item, in [0, nItems)
+         */
+        virtual void operator()(std::size_t item) = 0;
+    };
+
+    /**
+     * Start the worker threads.
+     * @param[in] nThreads the number of workers; 0 selects
+     * boost::thread::hardware_concurrency()
+     * @param[in] pinned true to pin each worker to a CPU of its own, as
+     * far as there are CPUs; a worker the system won't pin runs unpinned
+     */
+    tgThreadPool(std::size_t nThreads = 0, bool pinned = false);
+
+    /** Stop and join the worker threads. */
+    ~tgThreadPool();
+
+    /**
+     * Call task(i) for every i in [0, nItems) and wait until all are done.
+     * If the pool has one worker, or a single item is requested of an
+     * unpinned pool, the task is run on the calling thread. The first exception thrown by a task
+     * is rethrown here as a std::runtime_error after all workers finish.
+     * @param[in] task the work to be done
+     * @param[in] nItems the number of items
+     */
+    void run(Task& task, std::size_t nItems);
+
+    /**
+     * Return the number of worker threads.
+     */
+    std::size_t size() const { return m_nThreads; }
+
+    /** Return the worker that processes an item. */
+    std::size_t getWorker(std::size_t item) const { return item % m_nThreads; }
+
+    /**
+     * Return the NUMA node of a worker's CPU, or 0 unless the pool is
+     * pinned and has more than one worker.
+     * @throw std::out_of_range if worker is not less than size()
+     */
+    std::size_t getNode(std::size_t worker) const;
+
+    /** Return true if the workers are pinned to CPUs. */
+    bool isPinned() const { return !m_cpus.empty(); }
+
+private:
+
+    /** The loop executed by each worker thread. */
+    void workerLoop(std::size_t worker);
+
+    /** Run this worker's share of the current batch. */
+    void runShare(std::size_t worker);
+
+    /** Integrity predicate. */
+    bool invariant() const;
+
+private:
+
+    /** The number of workers. Positive. */
+    std::size_t m_nThreads;
+
+    /** The CPU of each worker if the pool is pinned, otherwise empty. */
+    std::vector<int> m_cpus;
+
+    /** The node of each worker's CPU, parallel to m_cpus. */
+    std::vector<std::size_t> m_nodes;
+
+    /** The worker threads. */
+    boost::thread_group m_threads;
+
+    /** Guards all of the members below. */
+    boost::mutex m_mutex;
+
+    /** Signalled when a new batch is posted or the pool shuts down. */
+    boost::condition_variable m_workReady;
+
+    /** Signalled when the last worker finishes a batch. */
+    boost::condition_variable m_workDone;
+
+    /** The task of the current batch. Not owned. */
+    Task* m_pTask;
+
+    /** The number of items in the current batch. */
+    std::size_t m_nItems;
+
+    /** Incremented each time a batch is posted. */
+    std::size_t m_generation;
+
+    /** The number of workers that have not yet finished the current batch. */
+    std::size_t m_pending;
+
+    /** True if a task threw during the current batch. */
+    bool m_failed;
+
+    /** The message of the first exception thrown during the current batch. */
+    std::string m_failure;
+
+    /** Set by the destructor to end the worker loops. */
+    bool m_stop;
+};
+
+#endif  // TG_THREAD_POOL_H
@@ -0,0 +1,269 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgTiledGround.cpp
+ * @brief Contains the definitions of members of class tgTiledGround
+ * $Id$
+ */
+
+// This module
+#include "tgTiledGround.h"
+// This library
+#include "tgBaseRigid.h"
+#include "tgBulletUtil.h"
+#include "tgCast.h"
+#include "tgWorld.h"
+#include "tgWorldBulletPhysicsImpl.h"
+#include "terrain/tgHeightfieldGround.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+// The C++ Standard Library
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+tgTiledGround::Config::Config(std::size_t tileNodes,
+                              double triangleSize,
+                              int radius,
+                              double margin,
+                              double friction,
+                              double restitution) :
+    m_tileNodes(tileNodes),
+    m_triangleSize(triangleSize),
+    m_radius(radius),
+    m_margin(margin),
+    m_friction(friction),
+    m_restitution(restitution)
+{
+}
+
+tgTiledGround::HillySource::HillySource(double waveHeight, double offset) :
+    m_waveHeight(waveHeight),
+    m_offset(offset)
+{
+}
+
+boost::shared_ptr<const std::vector<float> >
+tgTiledGround::HillySource::heights(int i, int j, const Config& config) const
+{
+    const std::size_t n = config.m_tileNodes;
+    std::vector<float>* const heights = new std::vector<float>(n * n);
+    // Neighbouring tiles share their edge nodes
+    const double x0 = (double)i * (n - 1);
+    const double z0 = (double)j * (n - 1);
+    for (std::size_t k = 0; k < n; k++)
+    {
+        for (std::size_t l = 0; l < n; l++)
+        {
+            (*heights)[k + (l * n)] =
+                m_waveHeight * sin(x0 + k) * cos(z0 + l) + m_offset;
+        }
+    }
+    return boost::shared_ptr<const std::vector<float> >(heights);
+}
+
+tgTiledGround::FileSource::FileSource(const std::string& directory,
+                                      double flatHeight) :
+    m_directory(directory),
+    m_flatHeight(flatHeight)
+{
+}
+
+boost::shared_ptr<const std::vector<float> >
+tgTiledGround::FileSource::heights(int i, int j, const Config& config) const
+{
+    const std::size_t count = config.m_tileNodes * config.m_tileNodes;
+    boost::shared_ptr<std::vector<float> > heights(
+        new std::vector<float>(count, m_flatHeight));
+
+    std::ostringstream path;
+    path << m_directory << "/tile_" << i << "_" << j << ".bin";
+    std::ifstream in(path.str().c_str(), std::ios::in | std::ios::binary);
+    if (in)
+    {
+        const std::streamsize bytes = count * sizeof(float);
+        in.read(reinterpret_cast<char*>(&(*heights)[0]), bytes);
+        if (in.gcount() != bytes || in.peek() != std::ifstream::traits_type::eof())
+        {
+            throw std::runtime_error("Tile file has the wrong size: " + path.str());
+        }
+    }
+    return heights;
+}
+
+tgTiledGround::tgTiledGround(const Config& config, TileSource* pSource,
+                             const tgModel& followed) :
+    m_config(config),
+    m_pSource(pSource),
+    m_followed(followed),
+    m_pWorld(NULL),
+    m_center(0, 0)
+{
+    if (pSource == NULL)
+    {
+        throw std::invalid_argument("Tile source is NULL");
+    }
+    if (config.m_tileNodes < 2 || config.m_triangleSize <= 0.0 ||
+        config.m_radius < 0)
+    {
+        delete pSource;
+        throw std::invalid_argument("Tiles need 2 nodes a side, a positive "
+                                    "spacing and a radius of at least 0");
+    }
+}
+
+tgTiledGround::~tgTiledGround()
+{
+    // Normally done by teardown, while the world still exists
+    assert(m_tiles.empty());
+    delete m_pSource;
+}
+
+void tgTiledGround::setup(tgWorld& world)
+{
+    m_pWorld = &world;
+    m_center = followedTile();
+    moveTo(m_center);
+
+    tgModel::setup(world);
+}
+
+void tgTiledGround::teardown()
+{
+    while (!m_tiles.empty())
+    {
+        removeTile(m_tiles.begin());
+    }
+    m_pWorld = NULL;
+
+    tgModel::teardown();
+}
+
+void tgTiledGround::step(double dt)
+{
+    if (dt <= 0.0)
+    {
+        throw std::invalid_argument("dt is not positive");
+    }
+
+    const std::pair<int, int> center = followedTile();
+    if (center != m_center)
+    {
+        m_center = center;
+        moveTo(m_center);
+    }
+
+    tgModel::step(dt);
+}
+
+std::pair<int, int> tgTiledGround::followedTile() const
+{
+    const std::vector<tgBaseRigid*> rigids =
+        tgCast::filter<tgModel, tgBaseRigid>(m_followed.getDescendants());
+
+    btVector3 moment(0.0, 0.0, 0.0);
+    double mass = 0.0;
+    for (std::size_t i = 0; i < rigids.size(); i++)
+    {
+        if (rigids[i]->getPRigidBody() == NULL) continue;
+        moment += rigids[i]->mass() * rigids[i]->centerOfMass();
+        mass += rigids[i]->mass();
+    }
+    // The origin until the followed model is set up
+    const btVector3 center = mass > 0.0 ? moment / mass : moment;
+
+    const double tileSize =
+        (m_config.m_tileNodes - 1) * m_config.m_triangleSize;
+    return std::make_pair((int)std::floor(center.x() / tileSize),
+                          (int)std::floor(center.z() / tileSize));
+}
+
+void tgTiledGround::moveTo(const std::pair<int, int>& center)
+{
+    assert(m_pWorld != NULL);
+    const int r = m_config.m_radius;
+
+    for (TileMap::iterator tile = m_tiles.begin(); tile != m_tiles.end(); )
+    {
+        const TileMap::iterator current = tile++;
+        if (std::abs(current->first.first - center.first) > r ||
+            std::abs(current->first.second - center.second) > r)
+        {
+            removeTile(current);
+        }
+    }
+
+    for (int i = center.first - r; i <= center.first + r; i++)
+    {
+        for (int j = center.second - r; j <= center.second + r; j++)
+        {
+            if (m_tiles.find(std::make_pair(i, j)) == m_tiles.end())
+            {
+                addTile(std::make_pair(i, j));
+            }
+        }
+    }
+}
+
+void tgTiledGround::addTile(const std::pair<int, int>& index)
+{
+    const std::size_t n = m_config.m_tileNodes;
+    const double ts = m_config.m_triangleSize;
+
+    // tgHeightfieldGround puts node k at x = origin + (k - n / 2) * ts;
+    // node 0 of tile i belongs at x = i * tileSize, and z likewise
+    tgHeightfieldGround::Config groundConfig;
+    groundConfig.m_origin = btVector3((index.first * (n - 1.0) + 0.5 * n) * ts,
+                                      0.0,
+                                      (index.second * (n - 1.0) + 0.5 * n) * ts);
+    groundConfig.m_friction = m_config.m_friction;
+    groundConfig.m_restitution = m_config.m_restitution;
+    groundConfig.m_nx = n;
+    groundConfig.m_ny = n;
+    groundConfig.m_margin = m_config.m_margin;
+    groundConfig.m_triangleSize = ts;
+
+    Tile tile;
+    tile.pGround = new tgHeightfieldGround(
+        groundConfig, m_pSource->heights(index.first, index.second, m_config));
+    tile.pBody = tile.pGround->getGroundRigidBody();
+    tile.pBody->setFriction(m_config.m_friction);
+    tile.pBody->setRestitution(m_config.m_restitution);
+
+    tgBulletUtil::worldToBulletPhysicsImpl(*m_pWorld).addRigidBody(tile.pBody);
+    m_tiles[index] = tile;
+}
+
+void tgTiledGround::removeTile(TileMap::iterator tile)
+{
+    assert(m_pWorld != NULL);
+    btRigidBody* const pBody = tile->second.pBody;
+
+    tgBulletUtil::worldToDynamicsWorld(*m_pWorld).removeRigidBody(pBody);
+    delete pBody->getMotionState();
+    delete pBody;
+    // Deletes the shape, which the body no longer refers to
+    delete tile->second.pGround;
+
+    m_tiles.erase(tile);
+}
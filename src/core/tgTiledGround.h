@@ -0,0 +1,228 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_TILED_GROUND_H
+#define TG_TILED_GROUND_H
+
+/**
+ * @file tgTiledGround.h
+ * @brief Contains the definition of class tgTiledGround
+ * $Id$
+ */
+
+// This library
+#include "tgModel.h"
+// The Bullet Physics library
+#include "LinearMath/btVector3.h"
+// Boost
+#include <boost/shared_ptr.hpp>
+// The C++ Standard Library
+#include <cstddef>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Forward declarations
+class btRigidBody;
+class tgHeightfieldGround;
+class tgWorld;
+
+/**
+ * Ground that follows a model around. The plane is cut into square
+ * heightfield tiles; only the tiles within Config::radius of the tile
+ * under the followed model's center of mass are in the world, and as the
+ * model moves, tiles it leaves behind are removed and deleted and tiles
+ * ahead of it are created. Memory and the number of ground bodies stay
+ * the same however far the model travels.
+ *
+ * Give the world an empty ground (tgEmptyGround) and add this as a model
+ * after the model it follows. Sweep and prune broadphases only cover
+ * tgWorld::Config::worldSize, so for runs that leave that cube use
+ * tgWorld::Config::DBVT, whose size does not depend on the bounds.
+ */
+class tgTiledGround : public tgModel
+{
+public:
+
+    /** The tile grid and the tile bodies */
+    struct Config
+    {
+        Config(std::size_t tileNodes = 33,
+               double triangleSize = 1.0,
+               int radius = 1,
+               double margin = 0.05,
+               double friction = 0.5,
+               double restitution = 0.0);
+
+        /** Grid nodes along each side of a tile; at least 2 */
+        std::size_t m_tileNodes;
+
+        /** Spacing of the grid nodes; must be positive */
+        double m_triangleSize;
+
+        /**
+         * Tiles kept on each side of the current one, so (2r + 1)^2
+         * tiles are in the world; must not be negative
+         */
+        int m_radius;
+
+        double m_margin;
+
+        double m_friction;
+
+        double m_restitution;
+    };
+
+    /**
+     * Supplies the heights of the tiles. Tile (i, j) covers x from
+     * i * tileSize to (i + 1) * tileSize and z likewise with j, where
+     * tileSize = (tileNodes - 1) * triangleSize, so neighbouring tiles
+     * share the nodes along their edge and must agree on their heights.
+     */
+    class TileSource
+    {
+    public:
+        virtual ~TileSource() { }
+
+        /**
+         * The heights of a tile, tileNodes * tileNodes of them, x varying
+         * fastest.
+         * @param[in] i the tile's index along x
+         * @param[in] j the tile's index along z
+         * @param[in] config the tile grid
+         */
+        virtual boost::shared_ptr<const std::vector<float> >
+            heights(int i, int j, const Config& config) const = 0;
+    };
+
+    /**
+     * The hills of tgHillyGround, continued over the whole plane by
+     * indexing the formula with the global node.
+     */
+    class HillySource : public TileSource
+    {
+    public:
+        HillySource(double waveHeight = 5.0, double offset = 0.5);
+
+        virtual boost::shared_ptr<const std::vector<float> >
+            heights(int i, int j, const Config& config) const;
+
+    private:
+        const double m_waveHeight;
+        const double m_offset;
+    };
+
+    /**
+     * Heights read from one file per tile, named tile_<i>_<j>.bin in a
+     * directory and holding tileNodes * tileNodes native floats, x
+     * varying fastest. Tiles without a file are flat.
+     */
+    class FileSource : public TileSource
+    {
+    public:
+        /**
+         * @param[in] directory where the tile files are
+         * @param[in] flatHeight the height of tiles without a file
+         */
+        FileSource(const std::string& directory, double flatHeight = 0.0);
+
+        /** @throw std::runtime_error if a tile file has the wrong size */
+        virtual boost::shared_ptr<const std::vector<float> >
+            heights(int i, int j, const Config& config) const;
+
+    private:
+        const std::string m_directory;
+        const double m_flatHeight;
+    };
+
+    /**
+     * @param[in] config the tile grid
+     * @param[in] pSource the tile heights; this takes ownership
+     * @param[in] followed the model to keep ground under; it must outlive
+     * this, and need not be set up yet
+     * @throw std::invalid_argument if pSource is NULL or config is invalid
+     */
+    tgTiledGround(const Config& config, TileSource* pSource,
+                  const tgModel& followed);
+
+    /** Deletes the tile source */
+    virtual ~tgTiledGround();
+
+    /** Put down the tiles around the followed model */
+    virtual void setup(tgWorld& world);
+
+    /** Remove and delete every tile */
+    virtual void teardown();
+
+    /** Move the tiles when the followed model crosses into another tile */
+    virtual void step(double dt);
+
+    /** The number of tiles in the world */
+    std::size_t getTileCount() const
+    {
+        return m_tiles.size();
+    }
+
+    /** The index of the tile the tiles are currently centered on */
+    std::pair<int, int> getCenterTile() const
+    {
+        return m_center;
+    }
+
+private:
+
+    /** A tile in the world */
+    struct Tile
+    {
+        tgHeightfieldGround* pGround;
+        btRigidBody* pBody;
+    };
+
+    typedef std::map<std::pair<int, int>, Tile> TileMap;
+
+    /** The tile under the followed model's center of mass */
+    std::pair<int, int> followedTile() const;
+
+    /** Remove tiles out of range of center and add the missing ones */
+    void moveTo(const std::pair<int, int>& center);
+
+    void addTile(const std::pair<int, int>& index);
+
+    void removeTile(TileMap::iterator tile);
+
+    const Config m_config;
+
+    /** Owned */
+    TileSource* const m_pSource;
+
+    const tgModel& m_followed;
+
+    /** The world set up in, NULL when torn down */
+    tgWorld* m_pWorld;
+
+    TileMap m_tiles;
+
+    std::pair<int, int> m_center;
+
+    // Not copyable
+    tgTiledGround(const tgTiledGround&);
+    tgTiledGround& operator=(const tgTiledGround&);
+};
+
+#endif  // TG_TILED_GROUND_H
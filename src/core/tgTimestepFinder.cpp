@@ -0,0 +1,332 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgTimestepFinder.cpp
+ * @brief Contains the definitions of members of class tgTimestepFinder
+ * $Id$
+ */
+
+// This module
+#include "tgTimestepFinder.h"
+// This application
+#include "tgBaseRigid.h"
+#include "tgSimView.h"
+#include "tgSimulation.h"
+#include "tgSpringCableActuator.h"
+#include "tgStateFrame.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+    /** One headless simulation of a sweep and the trajectory it sampled */
+    class Run
+    {
+    public:
+        Run(const tgWorld::Config& worldConfig,
+            const tgTimestepFinder::Builder& builder,
+            const tgDivergenceWatchdog::Config& watchdog,
+            double stepSize) :
+            m_world(worldConfig),
+            // The render rate is irrelevant for a headless view
+            m_view(m_world, stepSize, stepSize),
+            m_simulation(m_view),
+            m_stepSize(stepSize),
+            m_complete(false)
+        {
+            builder.build(m_simulation);
+            m_simulation.enableWatchdog(watchdog);
+        }
+
+        /**
+         * Step for duration seconds, sampling every interval seconds,
+         * until done or stopped.
+         */
+        void run(double duration, double interval)
+        {
+            const std::size_t nSamples =
+                static_cast<std::size_t>(duration / interval + 1e-9) + 1;
+            std::vector<double> previous;
+            std::vector<double> current;
+            read(current);
+            m_samples = current;
+            m_width = current.size();
+
+            std::size_t next = 1;
+            double time = 0.0;
+            while (next < nSamples)
+            {
+                m_simulation.step(m_stepSize);
+                if (m_simulation.getFailure() != tgDivergenceWatchdog::eNone)
+                {
+                    return;
+                }
+                previous.swap(current);
+                read(current);
+                if (current.size() != m_width)
+                {
+                    return;
+                }
+
+                // Every sample time in (time, time + m_stepSize]
+                const double end = time + m_stepSize;
+                for (; next < nSamples && next * interval <= end + 1e-12;
+                     ++next)
+                {
+                    const double alpha = (next * interval - time) / m_stepSize;
+                    for (std::size_t i = 0; i < m_width; ++i)
+                    {
+                        m_samples.push_back(previous[i] +
+                                            alpha * (current[i] - previous[i]));
+                    }
+                }
+                time = end;
+            }
+            m_complete = true;
+        }
+
+        /**
+         * @return the largest difference from the reference, infinity if
+         * either run is incomplete or the two sampled different models
+         */
+        double error(const Run& reference) const
+        {
+            if (!m_complete || !reference.m_complete ||
+                m_samples.size() != reference.m_samples.size())
+            {
+                return std::numeric_limits<double>::infinity();
+            }
+            double result = 0.0;
+            for (std::size_t i = 0; i < m_samples.size(); ++i)
+            {
+                result = std::max(result, std::fabs(m_samples[i] -
+                                                    reference.m_samples[i]));
+            }
+            // NaN compares false above
+            return result == result ? result :
+                std::numeric_limits<double>::infinity();
+        }
+
+        tgDivergenceWatchdog::Failure failure() const
+        {
+            return m_simulation.getFailure();
+        }
+
+        double stepSize() const { return m_stepSize; }
+
+    private:
+
+        /** The state after the last step, which the frames show a step late */
+        void read(std::vector<double>& values) const
+        {
+            values.clear();
+            for (std::size_t m = 0; m < m_simulation.getNumModels(); ++m)
+            {
+                const tgStateFrame& frame = m_simulation.getStateFrame(m);
+                const std::vector<tgBaseRigid*>& rigids = frame.getRigids();
+                for (std::size_t i = 0; i < rigids.size(); ++i)
+                {
+                    const btVector3 p = rigids[i]->centerOfMass();
+                    values.push_back(p.x());
+                    values.push_back(p.y());
+                    values.push_back(p.z());
+                }
+                const std::vector<tgSpringCableActuator*>& cables =
+                    frame.getCables();
+                for (std::size_t i = 0; i < cables.size(); ++i)
+                {
+                    values.push_back(cables[i]->getRestLength());
+                }
+            }
+        }
+
+        tgWorld m_world;
+        tgSimView m_view;
+        tgSimulation m_simulation;
+        const double m_stepSize;
+
+        /** m_width values per sample, one sample after another */
+        std::vector<double> m_samples;
+        std::size_t m_width;
+
+        /** Every sample was taken */
+        bool m_complete;
+    };
+
+    class SweepTask : public tgThreadPool::Task
+    {
+    public:
+        SweepTask(const std::vector<Run*>& runs, double duration,
+                  double interval) :
+            m_runs(runs),
+            m_duration(duration),
+            m_interval(interval)
+        {
+        }
+
+        virtual void operator()(std::size_t item)
+        {
+            m_runs[item]->run(m_duration, m_interval);
+        }
+
+    private:
+        const std::vector<Run*>& m_runs;
+        const double m_duration;
+        const double m_interval;
+    };
+
+    void deleteRuns(std::vector<Run*>& runs)
+    {
+        for (std::size_t i = 0; i < runs.size(); ++i)
+        {
+            delete runs[i];
+        }
+        runs.clear();
+    }
+}
+
+tgTimestepFinder::Config::Config(double runDuration, double interval,
+                                 double maxError, double reference) :
+    duration(runDuration),
+    sampleInterval(interval),
+    tolerance(maxError),
+    referenceStep(reference)
+{
+}
+
+tgTimestepFinder::tgTimestepFinder(const tgWorld::Config& worldConfig,
+                                   const Builder& builder,
+                                   const Config& config,
+                                   std::size_t nThreads) :
+    m_worldConfig(worldConfig),
+    m_builder(builder),
+    m_config(config),
+    m_pool(nThreads)
+{
+    if (config.duration <= 0.0 || config.sampleInterval <= 0.0 ||
+        config.referenceStep <= 0.0)
+    {
+        throw std::invalid_argument("Duration, interval or step is not positive");
+    }
+    else if (config.sampleInterval > config.duration)
+    {
+        throw std::invalid_argument("Sample interval exceeds the duration");
+    }
+    else if (config.tolerance < 0.0)
+    {
+        throw std::invalid_argument("Tolerance is negative");
+    }
+}
+
+std::vector<tgTimestepFinder::Result>
+tgTimestepFinder::sweep(const std::vector<double>& stepSizes)
+{
+    std::vector<double> sorted(stepSizes);
+    std::sort(sorted.begin(), sorted.end());
+    if (!sorted.empty() && sorted[0] <= 0.0)
+    {
+        throw std::invalid_argument("Step size is not positive");
+    }
+
+    // Built here rather than on the workers, since the builder need not
+    // be thread safe; the reference is first
+    std::vector<Run*> runs;
+    try
+    {
+        runs.push_back(new Run(m_worldConfig, m_builder, m_config.watchdog,
+                               m_config.referenceStep));
+        for (std::size_t i = 0; i < sorted.size(); ++i)
+        {
+            runs.push_back(new Run(m_worldConfig, m_builder,
+                                   m_config.watchdog, sorted[i]));
+        }
+        SweepTask task(runs, m_config.duration, m_config.sampleInterval);
+        m_pool.run(task, runs.size());
+    }
+    catch (...)
+    {
+        deleteRuns(runs);
+        throw;
+    }
+
+    if (runs[0]->failure() != tgDivergenceWatchdog::eNone)
+    {
+        deleteRuns(runs);
+        throw std::runtime_error("The reference run diverged");
+    }
+
+    std::vector<Result> results;
+    for (std::size_t i = 1; i < runs.size(); ++i)
+    {
+        Result result;
+        result.stepSize = runs[i]->stepSize();
+        result.error = runs[i]->error(*runs[0]);
+        result.failure = runs[i]->failure();
+        result.stable = result.failure == tgDivergenceWatchdog::eNone &&
+            result.error <= m_config.tolerance;
+        results.push_back(result);
+    }
+    deleteRuns(runs);
+
+    // Postcondition
+    assert(results.size() == stepSizes.size());
+    return results;
+}
+
+double tgTimestepFinder::largestStable(const std::vector<Result>& results)
+{
+    double result = 0.0;
+    for (std::size_t i = 0; i < results.size() && results[i].stable; ++i)
+    {
+        result = results[i].stepSize;
+    }
+    return result;
+}
+
+std::vector<double> tgTimestepFinder::candidates(double smallest,
+                                                 double largest,
+                                                 std::size_t n)
+{
+    if (smallest <= 0.0 || largest < smallest)
+    {
+        throw std::invalid_argument("Step size range is empty");
+    }
+    else if (n == 0)
+    {
+        throw std::invalid_argument("No candidates");
+    }
+
+    std::vector<double> result;
+    if (n == 1)
+    {
+        result.push_back(smallest);
+        return result;
+    }
+    const double ratio = std::log(largest / smallest) / (n - 1);
+    for (std::size_t i = 0; i + 1 < n; ++i)
+    {
+        result.push_back(smallest * std::exp(ratio * i));
+    }
+    result.push_back(largest);
+    return result;
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_TIMESTEP_FINDER_H
+#define TG_TIMESTEP_FINDER_H
+
+/**
+ * @file tgTimestepFinder.h
+ * @brief Contains the definition of class tgTimestepFinder
+ * $Id$
+ */
+
+// This application
+#include "tgDivergenceWatchdog.h"
+#include "tgThreadPool.h"
+#include "tgWorld.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class tgSimulation;
+
+/**
+ * Finds the largest step size at which a model and its controller still
+ * behave as they do at a very small one, instead of tuning dt by hand
+ * and choosing it too small out of caution.
+ *
+ * sweep() builds one headless simulation per candidate step size, plus
+ * one at the reference step size, runs them all for the same simulated
+ * time on a tgThreadPool, and samples each trajectory at fixed times:
+ * the center of mass of every rigid and the rest length of every cable
+ * in the models' tgStateFrames, interpolated between steps. A
+ * candidate's error is the largest difference from the reference over
+ * all the samples. Candidates whose bodies diverge are stopped by a
+ * tgDivergenceWatchdog and fail outright.
+ *
+ * @code
+ * tgTimestepFinder finder(worldConfig, builder);
+ * const std::vector<tgTimestepFinder::Result> results =
+ *     finder.sweep(tgTimestepFinder::candidates(1.0/10000, 1.0/100, 12));
+ * const double dt = tgTimestepFinder::largestStable(results);
+ * @endcode
+ */
+class tgTimestepFinder
+{
+public:
+
+    /** Puts the model under test into a simulation */
+    class Builder
+    {
+    public:
+        virtual ~Builder() { }
+
+        /**
+         * Add the models, with their controllers, and any obstacles.
+         * Called once per simulation of a sweep, on the thread that calls
+         * sweep(), so it need not be thread safe.
+         * @param[in,out] simulation a new, empty simulation
+         */
+        virtual void build(tgSimulation& simulation) const = 0;
+    };
+
+    /** How a sweep runs and what it tolerates */
+    struct Config
+    {
+        /**
+         * @param[in] runDuration the simulated seconds of every run
+         * @param[in] interval the seconds between samples
+         * @param[in] maxError the largest difference from the reference
+         * in any sampled position or rest length, in the model's units
+         * @param[in] reference the step size of the reference run
+         */
+        Config(double runDuration = 5.0, double interval = 0.05,
+               double maxError = 0.05, double reference = 1.0/10000.0);
+
+        double duration;
+        double sampleInterval;
+        double tolerance;
+        double referenceStep;
+
+        /** The bounds of the watchdog of every run */
+        tgDivergenceWatchdog::Config watchdog;
+    };
+
+    /** How one step size did */
+    struct Result
+    {
+        double stepSize;
+
+        /**
+         * The largest difference from the reference, or infinity if the
+         * run stopped early or sampled a different model
+         */
+        double error;
+
+        /** Why the watchdog stopped the run, or eNone */
+        tgDivergenceWatchdog::Failure failure;
+
+        /** The error is within the tolerance and nothing diverged */
+        bool stable;
+    };
+
+    /**
+     * @param[in] worldConfig the configuration of every world
+     * @param[in] builder not owned, must outlive this finder
+     * @param[in] config the sweep
+     * @param[in] nThreads the number of workers; 0 selects one per core
+     * @throw std::invalid_argument if a duration, interval or step size
+     * is not positive, the interval exceeds the duration, or the
+     * tolerance is negative
+     */
+    tgTimestepFinder(const tgWorld::Config& worldConfig,
+                     const Builder& builder,
+                     const Config& config = Config(),
+                     std::size_t nThreads = 0);
+
+    /**
+     * Run the reference and every candidate.
+     * @param[in] stepSizes the candidates
+     * @return a result per candidate, in order of increasing step size
+     * @throw std::invalid_argument if a candidate is not positive
+     * @throw std::runtime_error if the reference diverges, or a run
+     * throws
+     */
+    std::vector<Result> sweep(const std::vector<double>& stepSizes);
+
+    /**
+     * @param[in] results the results of sweep()
+     * @return the largest step size that is stable along with every
+     * smaller one, since a step size that happens to land near the
+     * reference beyond an unstable one is luck; zero if the smallest is
+     * not stable
+     */
+    static double largestStable(const std::vector<Result>& results);
+
+    /**
+     * @return n step sizes spaced evenly in log from smallest to
+     * largest, both included
+     * @throw std::invalid_argument if smallest is not positive, largest
+     * is less than it, or n is zero
+     */
+    static std::vector<double> candidates(double smallest, double largest,
+                                          std::size_t n);
+
+    const Config& getConfig() const { return m_config; }
+
+private:
+
+    const tgWorld::Config m_worldConfig;
+
+    /** Not owned */
+    const Builder& m_builder;
+
+    const Config m_config;
+
+    tgThreadPool m_pool;
+};
+
+#endif  // TG_TIMESTEP_FINDER_H
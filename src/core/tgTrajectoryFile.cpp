@@ -0,0 +1,112 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgTrajectoryFile.cpp
+ * @brief Contains the definitions of members of class tgTrajectoryFile
+ * $Id$
+ */
+
+// This module
+#include "tgTrajectoryFile.h"
+// Boost
+#include <boost/static_assert.hpp>
+// The C++ Standard Library
+#include <cstring>
+#include <stdexcept>
+
+// Readers in other languages rely on the parts starting at byte 48.
+BOOST_STATIC_ASSERT(sizeof(tgTrajectoryFile::Header) == 48);
+
+const char tgTrajectoryFile::magic[16] = "NTRT_TRAJECTORY";
+
+const std::size_t tgTrajectoryFile::partWidth;
+
+tgTrajectoryFile::tgTrajectoryFile(const std::string& path) :
+    m_bodies(0),
+    m_cables(0),
+    m_parts(0),
+    m_frames(0),
+    m_frameWidth(0),
+    m_pParts(NULL),
+    m_pFrames(NULL)
+{
+    using namespace boost::interprocess;
+    try
+    {
+        file_mapping file(path.c_str(), read_only);
+        mapped_region region(file, read_only);
+        m_file.swap(file);
+        m_region.swap(region);
+    }
+    catch (const interprocess_exception& e)
+    {
+        throw std::runtime_error("Could not map trajectory " + path + ": " +
+                                 e.what());
+    }
+
+    const std::size_t size = m_region.get_size();
+    const char* const base = static_cast<const char*>(m_region.get_address());
+    if (size < sizeof(Header) ||
+        std::memcmp(base, magic, sizeof(magic)) != 0)
+    {
+        throw std::runtime_error(path + " is not a trajectory file");
+    }
+
+    Header header;
+    std::memcpy(&header, base, sizeof(Header));
+    m_bodies = header.bodies;
+    m_cables = header.cables;
+    m_parts = header.parts;
+    m_frameWidth = frameWidth(m_bodies, m_cables);
+
+    const std::size_t framesOffset =
+        sizeof(Header) + partWidth * m_parts * sizeof(double);
+    if (size < framesOffset)
+    {
+        throw std::runtime_error(path + " is truncated");
+    }
+    // Frames past the end of the file have not been written yet
+    const std::size_t available =
+        (size - framesOffset) / (m_frameWidth * sizeof(double));
+    m_frames = (header.frames < available) ?
+        static_cast<std::size_t>(header.frames) : available;
+
+    m_pParts = reinterpret_cast<const double*>(base + sizeof(Header));
+    m_pFrames = reinterpret_cast<const double*>(base + framesOffset);
+}
+
+std::size_t tgTrajectoryFile::frameAt(double t) const
+{
+    // Binary search for the last frame with time() <= t
+    std::size_t lo = 0;
+    std::size_t hi = m_frames;
+    while (hi - lo > 1)
+    {
+        const std::size_t mid = lo + (hi - lo) / 2;
+        if (time(mid) <= t)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
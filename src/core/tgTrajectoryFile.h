@@ -0,0 +1,232 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_TRAJECTORY_FILE_H
+#define TG_TRAJECTORY_FILE_H
+
+/**
+ * @file tgTrajectoryFile.h
+ * @brief Contains the definition of class tgTrajectoryFile
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "LinearMath/btQuaternion.h"
+#include "LinearMath/btTransform.h"
+#include "LinearMath/btVector3.h"
+// Boost
+#include <boost/cstdint.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+// The C++ Standard Library
+#include <cstddef>
+#include <string>
+
+/**
+ * Read access to a trajectory recorded by tgTrajectoryRecorder, through
+ * a read-only memory mapping of the file: opening it reads nothing but
+ * the header, and any frame can be reached in constant time, so a
+ * tgSimViewReplay can scrub through a long run at any speed.
+ *
+ * The file holds, in native byte order:
+ *   16 bytes  the magic string "NTRT_TRAJECTORY", NUL-padded
+ *   uint64    the number of bodies, B
+ *   uint64    the number of cables, C
+ *   uint64    the number of parts, P
+ *   uint64    the number of complete frames, F
+ *   P parts of 12 doubles: the body index, the shape (see Shape), three
+ *             sizes, then the position and orientation (x, y, z, w) of
+ *             the part in its body's frame
+ *   F frames of 1 + 7 * (B + C) doubles: the time, the position and
+ *             orientation of every body, then for every cable the world
+ *             positions of its first and last anchors and its stretch,
+ *             the actual length less the rest length
+ * A body with a compound shape has one part per child shape. The file
+ * may be larger than its frames; everything past frame F is ignored, so
+ * a file left by a run that did not finish can still be read.
+ */
+class tgTrajectoryFile
+{
+public:
+
+    /** The shapes of parts. */
+    enum Shape
+    {
+        /** Sizes are unused; drawn as a coordinate frame */
+        SHAPE_OTHER = 0,
+        /** Sizes are the radius, the half height and the up axis */
+        SHAPE_CYLINDER = 1,
+        /** Sizes are the half extents */
+        SHAPE_BOX = 2,
+        /** The first size is the radius */
+        SHAPE_SPHERE = 3
+    };
+
+    /** The start of a trajectory file; see the class description. */
+    struct Header
+    {
+        char magic[16];
+        boost::uint64_t bodies;
+        boost::uint64_t cables;
+        boost::uint64_t parts;
+        boost::uint64_t frames;
+    };
+
+    /** The number of doubles that describe each part. */
+    static const std::size_t partWidth = 12;
+
+    /** The magic string at the start of every trajectory file. */
+    static const char magic[16];
+
+    /**
+     * @param[in] bodies the number of bodies
+     * @param[in] cables the number of cables
+     * @return the number of doubles in each frame
+     */
+    static std::size_t frameWidth(std::size_t bodies, std::size_t cables)
+    {
+        return 1 + 7 * (bodies + cables);
+    }
+
+    /**
+     * Map a trajectory file.
+     * @param[in] path the file
+     * @throw std::runtime_error if the file can't be mapped or is not a
+     * trajectory
+     */
+    explicit tgTrajectoryFile(const std::string& path);
+
+    /** @return the number of bodies */
+    std::size_t bodies() const { return m_bodies; }
+
+    /** @return the number of cables */
+    std::size_t cables() const { return m_cables; }
+
+    /** @return the number of parts */
+    std::size_t parts() const { return m_parts; }
+
+    /** @return the number of frames there were when the file was mapped */
+    std::size_t frames() const { return m_frames; }
+
+    /** @return the index of the body that part i belongs to */
+    std::size_t partBody(std::size_t i) const
+    {
+        return static_cast<std::size_t>(part(i)[0]);
+    }
+
+    /** @return the shape of part i */
+    Shape partShape(std::size_t i) const
+    {
+        return static_cast<Shape>(static_cast<int>(part(i)[1]));
+    }
+
+    /** @return the sizes of part i, whose meaning depends on its shape */
+    btVector3 partSize(std::size_t i) const
+    {
+        return btVector3(part(i)[2], part(i)[3], part(i)[4]);
+    }
+
+    /** @return the transform of part i relative to its body */
+    btTransform partTransform(std::size_t i) const
+    {
+        return transformAt(part(i) + 5);
+    }
+
+    /** @return the simulation time of frame f */
+    double time(std::size_t f) const { return frame(f)[0]; }
+
+    /** @return the transform of body b in frame f */
+    btTransform bodyTransform(std::size_t f, std::size_t b) const
+    {
+        return transformAt(frame(f) + 1 + 7 * b);
+    }
+
+    /** @return the position of the first anchor of cable c in frame f */
+    btVector3 cableFrom(std::size_t f, std::size_t c) const
+    {
+        const double* const p = cable(f, c);
+        return btVector3(p[0], p[1], p[2]);
+    }
+
+    /** @return the position of the last anchor of cable c in frame f */
+    btVector3 cableTo(std::size_t f, std::size_t c) const
+    {
+        const double* const p = cable(f, c);
+        return btVector3(p[3], p[4], p[5]);
+    }
+
+    /** @return the actual length less the rest length of cable c */
+    double cableStretch(std::size_t f, std::size_t c) const
+    {
+        return cable(f, c)[6];
+    }
+
+    /**
+     * @param[in] t a simulation time
+     * @return the last frame recorded at or before t, or 0 if there is
+     * none
+     */
+    std::size_t frameAt(double t) const;
+
+private:
+
+    /** @return the first double of part i */
+    const double* part(std::size_t i) const
+    {
+        return m_pParts + partWidth * i;
+    }
+
+    /** @return the first double of frame f */
+    const double* frame(std::size_t f) const
+    {
+        return m_pFrames + m_frameWidth * f;
+    }
+
+    /** @return the first double of cable c in frame f */
+    const double* cable(std::size_t f, std::size_t c) const
+    {
+        return frame(f) + 1 + 7 * (m_bodies + c);
+    }
+
+    /** @return the transform stored at p as x, y, z, then x, y, z, w */
+    static btTransform transformAt(const double* p)
+    {
+        return btTransform(btQuaternion(p[3], p[4], p[5], p[6]),
+                           btVector3(p[0], p[1], p[2]));
+    }
+
+private:
+
+    /** The file. */
+    boost::interprocess::file_mapping m_file;
+
+    /** The read-only mapping of the whole file. */
+    boost::interprocess::mapped_region m_region;
+
+    std::size_t m_bodies;
+    std::size_t m_cables;
+    std::size_t m_parts;
+    std::size_t m_frames;
+    std::size_t m_frameWidth;
+
+    /** The first part and the first frame, in m_region. */
+    const double* m_pParts;
+    const double* m_pFrames;
+};
+
+#endif  // TG_TRAJECTORY_FILE_H
@@ -171,10 +171,10 @@ void tgUnidirComprSprActuator::step(double dt)
 }
 
 // Renders the spring in the NTRT window
-void tgUnidirComprSprActuator::onVisit(const tgModelVisitor& r) const
+void tgUnidirComprSprActuator::accept(const tgModelVisitor& r) const
 {
 #ifndef BT_NO_PROFILE 
-    BT_PROFILE("tgUnidirComprSprActuator::onVisit");
+    BT_PROFILE("tgUnidirComprSprActuator::accept");
 #endif //BT_NO_PROFILE	
     r.render(*this);
 }
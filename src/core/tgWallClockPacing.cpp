@@ -0,0 +1,55 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgWallClockPacing.cpp
+ * @brief Contains the definitions of members of class tgWallClockPacing
+ * $Id$
+ */
+
+// This module
+#include "tgWallClockPacing.h"
+// The C++ Standard Library
+#include <stdexcept>
+
+tgWallClockPacing::tgWallClockPacing(double interval) :
+    m_interval(interval),
+    m_nextRender(0.0)
+{
+    if (interval < 0.0)
+    {
+        throw std::invalid_argument("interval is negative");
+    }
+}
+
+void tgWallClockPacing::start()
+{
+    tgSimPacing::start();
+    m_nextRender = m_interval;
+}
+
+bool tgWallClockPacing::renderDue(double renderTime, double renderRate)
+{
+    const double now = wallTime();
+    if (now < m_nextRender)
+    {
+        return false;
+    }
+    m_nextRender = now + m_interval;
+    return true;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_WALL_CLOCK_PACING_H
+#define TG_WALL_CLOCK_PACING_H
+
+/**
+ * @file tgWallClockPacing.h
+ * @brief Contains the definition of class tgWallClockPacing
+ * $Id$
+ */
+
+// This module
+#include "tgSimPacing.h"
+
+/**
+ * Runs tgSimView::run() as fast as possible, for batch runs, and renders
+ * once every interval of wall clock time instead of every renderRate of
+ * simulation time, so that watching or logging a fast run costs the same
+ * however fast it goes.
+ */
+class tgWallClockPacing : public tgSimPacing
+{
+public:
+
+    /**
+     * @param[in] interval the wall clock seconds between renders
+     * @throw std::invalid_argument if interval is negative
+     */
+    tgWallClockPacing(double interval = 1.0);
+
+    /** Starts the interval. */
+    virtual void start();
+
+protected:
+
+    /** True once per interval of wall clock time */
+    virtual bool renderDue(double renderTime, double renderRate);
+
+private:
+
+    const double m_interval;
+
+    /** The wall time of the next render */
+    double m_nextRender;
+};
+
+#endif  // TG_WALL_CLOCK_PACING_H
@@ -0,0 +1,340 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgWarmDantzigSolver.cpp
+ * @brief Contains the definitions of members of class tgWarmDantzigSolver
+ * $Id$
+ */
+
+// This module
+#include "tgWarmDantzigSolver.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+    /** The relative tolerance of the checks */
+    const double tolerance = 1e-9;
+
+    /** The bounds of row i at x, friction following its normal row */
+    template <class Vector>
+    void bounds(const Vector& x, const btVectorXu& lo,
+                const btVectorXu& hi,
+                const btAlignedObjectArray<int>& limitDependency, int i,
+                double& lower, double& upper)
+    {
+        const int d = limitDependency[i];
+        if (d >= 0)
+        {
+            upper = std::fabs(hi[i] * x[d]);
+            lower = -upper;
+        }
+        else
+        {
+            lower = lo[i];
+            upper = hi[i];
+        }
+    }
+
+    /**
+     * Solve the n by n row major system in place by Gaussian elimination
+     * with partial pivoting, leaving the solution in rhs.
+     * @return false if the matrix is singular
+     */
+    bool solveDense(std::vector<double>& matrix, std::vector<double>& rhs,
+                    std::size_t n)
+    {
+        double scale = 0.0;
+        for (std::size_t i = 0; i < n * n; ++i)
+        {
+            scale = std::max(scale, std::fabs(matrix[i]));
+        }
+        const double singular = scale * 1e-13;
+        for (std::size_t k = 0; k < n; ++k)
+        {
+            std::size_t pivot = k;
+            for (std::size_t i = k + 1; i < n; ++i)
+            {
+                if (std::fabs(matrix[i * n + k]) >
+                    std::fabs(matrix[pivot * n + k]))
+                {
+                    pivot = i;
+                }
+            }
+            if (!(std::fabs(matrix[pivot * n + k]) > singular))
+            {
+                return false;
+            }
+            if (pivot != k)
+            {
+                std::swap_ranges(&matrix[k * n], &matrix[k * n] + n,
+                                 &matrix[pivot * n]);
+                std::swap(rhs[k], rhs[pivot]);
+            }
+            const double inverse = 1.0 / matrix[k * n + k];
+            for (std::size_t i = k + 1; i < n; ++i)
+            {
+                const double factor = matrix[i * n + k] * inverse;
+                if (factor == 0.0)
+                {
+                    continue;
+                }
+                for (std::size_t j = k + 1; j < n; ++j)
+                {
+                    matrix[i * n + j] -= factor * matrix[k * n + j];
+                }
+                rhs[i] -= factor * rhs[k];
+            }
+        }
+        for (std::size_t k = n; k-- > 0; )
+        {
+            double sum = rhs[k];
+            for (std::size_t j = k + 1; j < n; ++j)
+            {
+                sum -= matrix[k * n + j] * rhs[j];
+            }
+            rhs[k] = sum / matrix[k * n + k];
+        }
+        return true;
+    }
+}
+
+tgWarmDantzigSolver::tgWarmDantzigSolver(int maxPivots) :
+    m_maxPivots(maxPivots),
+    m_warmSolves(0),
+    m_coldSolves(0)
+{
+    if (maxPivots < 0)
+    {
+        throw std::invalid_argument("maxPivots is negative");
+    }
+}
+
+bool tgWarmDantzigSolver::solveMLCP(const btMatrixXu& A, const btVectorXu& b,
+                                    btVectorXu& x, const btVectorXu& lo,
+                                    const btVectorXu& hi,
+                                    const btAlignedObjectArray<int>& limitDependency,
+                                    int numIterations, bool useSparsity)
+{
+    if (b.rows() == 0)
+    {
+        return true;
+    }
+    if (solveWarm(A, b, x, lo, hi, limitDependency))
+    {
+        ++m_warmSolves;
+        return true;
+    }
+    ++m_coldSolves;
+    return btDantzigSolver::solveMLCP(A, b, x, lo, hi, limitDependency,
+                                      numIterations, useSparsity);
+}
+
+bool tgWarmDantzigSolver::solveWarm(const btMatrixXu& A, const btVectorXu& b,
+                                    btVectorXu& x, const btVectorXu& lo,
+                                    const btVectorXu& hi,
+                                    const btAlignedObjectArray<int>& limitDependency)
+{
+    const int n = b.rows();
+    if (limitDependency.size() < n)
+    {
+        return false;
+    }
+
+    // The guess: the side each row's warm started impulse is on
+    m_sides.resize(n);
+    for (int i = 0; i < n; ++i)
+    {
+        const int d = limitDependency[i];
+        if (d >= n || (d >= 0 && limitDependency[d] >= 0))
+        {
+            // Only friction on a normal row is linear in the unknowns
+            return false;
+        }
+        double lower;
+        double upper;
+        bounds(x, lo, hi, limitDependency, i, lower, upper);
+        const double margin = tolerance * (1.0 + std::fabs(x[i]));
+        if (x[i] <= lower + margin)
+        {
+            m_sides[i] = eLower;
+        }
+        else if (x[i] >= upper - margin)
+        {
+            m_sides[i] = eUpper;
+        }
+        else
+        {
+            m_sides[i] = eFree;
+        }
+    }
+
+    double bScale = 0.0;
+    for (int i = 0; i < n; ++i)
+    {
+        bScale = std::max(bScale, std::fabs(b[i]));
+    }
+
+    m_position.resize(n);
+    m_x.resize(n);
+    for (int round = 0; round <= m_maxPivots; ++round)
+    {
+        m_free.clear();
+        for (int i = 0; i < n; ++i)
+        {
+            m_position[i] = m_sides[i] == eFree ?
+                static_cast<int>(m_free.size()) : -1;
+            if (m_sides[i] == eFree)
+            {
+                m_free.push_back(i);
+            }
+        }
+
+        // A held row is its bound: a constant, or a multiple of the
+        // normal impulse it depends on
+        const std::size_t nFree = m_free.size();
+        m_matrix.assign(nFree * nFree, 0.0);
+        m_rhs.resize(nFree);
+        for (std::size_t p = 0; p < nFree; ++p)
+        {
+            const int row = m_free[p];
+            m_rhs[p] = b[row];
+            for (int j = 0; j < n; ++j)
+            {
+                const double a = A(row, j);
+                if (a == 0.0)
+                {
+                    continue;
+                }
+                if (m_sides[j] == eFree)
+                {
+                    m_matrix[p * nFree + m_position[j]] += a;
+                    continue;
+                }
+                const double sign = m_sides[j] == eUpper ? 1.0 : -1.0;
+                const int d = limitDependency[j];
+                if (d < 0)
+                {
+                    m_rhs[p] -= a * (m_sides[j] == eUpper ? hi[j] : lo[j]);
+                }
+                else if (m_sides[d] == eFree)
+                {
+                    m_matrix[p * nFree + m_position[d]] +=
+                        a * sign * std::fabs(hi[j]);
+                }
+                else
+                {
+                    m_rhs[p] -= a * sign * std::fabs(hi[j]) *
+                        (m_sides[d] == eUpper ? hi[d] : lo[d]);
+                }
+            }
+        }
+        if (!solveDense(m_matrix, m_rhs, nFree))
+        {
+            return false;
+        }
+
+        // Normal rows first, so friction can follow them
+        for (int i = 0; i < n; ++i)
+        {
+            if (m_sides[i] == eFree)
+            {
+                m_x[i] = m_rhs[m_position[i]];
+            }
+            else if (limitDependency[i] < 0)
+            {
+                m_x[i] = m_sides[i] == eUpper ? hi[i] : lo[i];
+            }
+        }
+        double xScale = 0.0;
+        for (int i = 0; i < n; ++i)
+        {
+            const int d = limitDependency[i];
+            if (m_sides[i] != eFree && d >= 0)
+            {
+                const double sign = m_sides[i] == eUpper ? 1.0 : -1.0;
+                m_x[i] = sign * std::fabs(hi[i]) * m_x[d];
+            }
+            if (!(std::fabs(m_x[i]) < m_acceptableUpperLimitSolution))
+            {
+                // Also NaN; btDantzigSolver rejects such solutions too
+                return false;
+            }
+            xScale = std::max(xScale, std::fabs(m_x[i]));
+        }
+
+        // Check every condition, moving the rows that break one
+        const double xMargin = tolerance * (1.0 + xScale);
+        const double wMargin = tolerance * (1.0 + bScale);
+        bool solved = true;
+        for (int i = 0; i < n; ++i)
+        {
+            double w = -b[i];
+            for (int j = 0; j < n; ++j)
+            {
+                w += A(i, j) * m_x[j];
+            }
+            double lower;
+            double upper;
+            bounds(m_x, lo, hi, limitDependency, i, lower, upper);
+            switch (m_sides[i])
+            {
+            case eFree:
+                if (m_x[i] < lower - xMargin)
+                {
+                    m_sides[i] = eLower;
+                    solved = false;
+                }
+                else if (m_x[i] > upper + xMargin)
+                {
+                    m_sides[i] = eUpper;
+                    solved = false;
+                }
+                break;
+            case eLower:
+                // A friction row with no normal impulse is held either way
+                if (w < -wMargin && upper - lower > xMargin)
+                {
+                    m_sides[i] = eFree;
+                    solved = false;
+                }
+                break;
+            case eUpper:
+                if (w > wMargin && upper - lower > xMargin)
+                {
+                    m_sides[i] = eFree;
+                    solved = false;
+                }
+                break;
+            }
+        }
+        if (solved)
+        {
+            for (int i = 0; i < n; ++i)
+            {
+                x[i] = m_x[i];
+            }
+            return true;
+        }
+    }
+    return false;
+}
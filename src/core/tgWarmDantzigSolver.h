@@ -0,0 +1,107 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_WARM_DANTZIG_SOLVER_H
+#define TG_WARM_DANTZIG_SOLVER_H
+
+/**
+ * @file tgWarmDantzigSolver.h
+ * @brief Contains the definition of class tgWarmDantzigSolver
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "BulletDynamics/MLCPSolvers/btDantzigSolver.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+/**
+ * A btDantzigSolver that first tries the active set of the last step.
+ * btDantzigSolver pivots its way to the solution of every step from
+ * scratch, ignoring the initial x that btMLCPSolver passes in. With
+ * Bullet's warm starting on, as it is by default, that x holds the
+ * impulses each persistent contact point kept from the previous step, so
+ * which rows sat at a bound and which were free is already known for the
+ * quasi-static contacts of a tensegrity.
+ *
+ * This solver classifies the rows from x, solves the rows that are free
+ * with the others held at their bounds, friction bounds following their
+ * normal impulses, and checks the result against every bound and sign
+ * condition of the LCP. Rows that break one change sides, as in a block
+ * principal pivoting method, for up to maxPivots rounds. A result that
+ * passes the checks is a solution of the LCP, whatever the guess was;
+ * otherwise btDantzigSolver solves the step. A steady state then costs
+ * one linear solve over the free rows instead of a pivot per row.
+ */
+class tgWarmDantzigSolver : public btDantzigSolver
+{
+public:
+
+    /**
+     * @param[in] maxPivots the rounds of changing sides before falling
+     * back to btDantzigSolver; 0 only tries the guess
+     */
+    explicit tgWarmDantzigSolver(int maxPivots = 8);
+
+    /** Solve A x = b + w, see btMLCPSolverInterface */
+    virtual bool solveMLCP(const btMatrixXu& A, const btVectorXu& b,
+                           btVectorXu& x, const btVectorXu& lo,
+                           const btVectorXu& hi,
+                           const btAlignedObjectArray<int>& limitDependency,
+                           int numIterations, bool useSparsity = true);
+
+    /** @return the solves the warm start alone finished */
+    std::size_t getWarmSolves() const { return m_warmSolves; }
+
+    /** @return the solves left to btDantzigSolver */
+    std::size_t getColdSolves() const { return m_coldSolves; }
+
+private:
+
+    /** Which side of its bounds a row is on */
+    enum Side
+    {
+        eLower,
+        eUpper,
+        eFree
+    };
+
+    /**
+     * Solve from the active set in x, writing x only on success.
+     * @return true if the checks passed
+     */
+    bool solveWarm(const btMatrixXu& A, const btVectorXu& b, btVectorXu& x,
+                   const btVectorXu& lo, const btVectorXu& hi,
+                   const btAlignedObjectArray<int>& limitDependency);
+
+    const int m_maxPivots;
+
+    std::size_t m_warmSolves;
+    std::size_t m_coldSolves;
+
+    /** Scratch space, kept between steps */
+    std::vector<char> m_sides;
+    std::vector<int> m_free;
+    std::vector<int> m_position;
+    std::vector<double> m_matrix;
+    std::vector<double> m_rhs;
+    std::vector<double> m_x;
+};
+
+#endif  // TG_WARM_DANTZIG_SOLVER_H
@@ -26,15 +26,29 @@
 // This module
 #include "tgWorld.h"
 // This application
+#include "tgWorldArena.h"
 #include "tgWorldBulletPhysicsImpl.h"
 #include "terrain/tgBoxGround.h"
 // The C++ Standard Library
+#include <algorithm>
 #include <cassert>
 #include <stdexcept>
 
 tgWorld::Config::Config(double g, double ws) :
 gravity(g),
-worldSize(ws)
+worldSize(ws),
+solverType(MLCP_DANTZIG),
+warmStartMLCP(false),
+solverIterations(10),
+splitImpulse(true),
+broadphaseType(AXIS_SWEEP),
+maxBroadphaseHandles(16384),
+fitBroadphase(false),
+localBodyOrder(false),
+solverThreads(1),
+softBodies(false),
+worldArena(false),
+prescreen(false)
 {
   if (ws <= 0.0)
   {
@@ -42,6 +56,16 @@ worldSize(ws)
   }
 }
 
+tgWorld::Config tgWorld::Config::prescreenConfig() const
+{
+  Config result(*this);
+  result.prescreen = true;
+  result.solverType = SEQUENTIAL_IMPULSE;
+  result.solverIterations = std::min(solverIterations, 4);
+  result.splitImpulse = false;
+  return result;
+}
+
 /**
  * @todo Use the factory method design pattern to
  * create the m_pImpl object.
@@ -49,7 +73,12 @@ worldSize(ws)
 tgWorld::tgWorld() :
   m_config(),
   m_pGround(new tgBoxGround()),
-  m_pImpl(new tgWorldBulletPhysicsImpl(m_config, (tgBulletGround*)m_pGround))
+  m_pGroundOwner(NULL),
+  m_pArena(m_config.worldArena ? new tgWorldArena() : NULL),
+  m_pImpl(createImpl()),
+  m_stream(0),
+  m_episode(0),
+  m_stepStamp(0)
 {
   // Postcondition
   assert(invariant());
@@ -62,7 +91,12 @@ tgWorld::tgWorld() :
 tgWorld::tgWorld(const tgWorld::Config& config) :
   m_config(config),
   m_pGround(new tgBoxGround()),
-  m_pImpl(new tgWorldBulletPhysicsImpl(m_config, (tgBulletGround*)m_pGround))
+  m_pGroundOwner(NULL),
+  m_pArena(m_config.worldArena ? new tgWorldArena() : NULL),
+  m_pImpl(createImpl()),
+  m_stream(0),
+  m_episode(0),
+  m_stepStamp(0)
 {
   // Postcondition
   assert(invariant());
@@ -75,7 +109,26 @@ tgWorld::tgWorld(const tgWorld::Config& config) :
 tgWorld::tgWorld(const tgWorld::Config& config, tgGround* ground) :
   m_config(config),
   m_pGround(ground),
-  m_pImpl(new tgWorldBulletPhysicsImpl(m_config, (tgBulletGround*)m_pGround))
+  m_pGroundOwner(NULL),
+  m_pArena(m_config.worldArena ? new tgWorldArena() : NULL),
+  m_pImpl(createImpl()),
+  m_stream(0),
+  m_episode(0),
+  m_stepStamp(0)
+{
+  // Postcondition
+  assert(invariant());
+}
+
+tgWorld::tgWorld(const tgWorld& groundOwner, const tgWorld::Config& config) :
+  m_config(config),
+  m_pGround(groundOwner.m_pGround),
+  m_pGroundOwner(&groundOwner),
+  m_pArena(m_config.worldArena ? new tgWorldArena() : NULL),
+  m_pImpl(createImpl()),
+  m_stream(0),
+  m_episode(0),
+  m_stepStamp(0)
 {
   // Postcondition
   assert(invariant());
@@ -84,13 +137,53 @@ tgWorld::tgWorld(const tgWorld::Config& config, tgGround* ground) :
 tgWorld::~tgWorld()
 {
   delete m_pImpl;
-  delete m_pGround;
+  // Frees the arena's chunks, now that its objects are gone
+  delete m_pArena;
+  if (m_pGroundOwner == NULL)
+  {
+    delete m_pGround;
+  }
+}
+
+tgWorld* tgWorld::createPartition() const
+{
+  return new tgWorld(*this, m_config);
 }
 
 void tgWorld::reset()
 {
+  // Take the kept bodies and their shapes out before the rest is deleted
+  const std::size_t nKept = m_persistentBodies.size();
+  std::vector<short> groups(nKept);
+  std::vector<short> masks(nKept);
+  std::vector<btCollisionShape*> shapes;
+  tgWorldBulletPhysicsImpl& old = static_cast<tgWorldBulletPhysicsImpl&>(*m_pImpl);
+  for (std::size_t i = 0; i < nKept; ++i)
+  {
+    old.detachRigidBody(m_persistentBodies[i], groups[i], masks[i], shapes);
+  }
+
   delete m_pImpl;
-  m_pImpl = new tgWorldBulletPhysicsImpl(m_config, (tgBulletGround*)m_pGround);
+  delete m_pArena;
+  if (m_pGroundOwner != NULL)
+  {
+    // The owner may have been given a new ground since
+    m_pGround = m_pGroundOwner->m_pGround;
+  }
+  m_pArena = m_config.worldArena ? new tgWorldArena() : NULL;
+  m_pImpl = createImpl();
+  ++m_episode;
+  ++m_stepStamp;
+
+  tgWorldBulletPhysicsImpl& impl = static_cast<tgWorldBulletPhysicsImpl&>(*m_pImpl);
+  for (std::size_t i = 0; i < nKept; ++i)
+  {
+    impl.attachRigidBody(m_persistentBodies[i], groups[i], masks[i]);
+  }
+  for (std::size_t i = 0; i < shapes.size(); ++i)
+  {
+    impl.addCollisionShape(shapes[i]);
+  }
   // Postcondition
   assert(invariant());
 }
@@ -108,7 +201,15 @@ void tgWorld::reset(const tgWorld::Config& config)
 
 void tgWorld::reset(tgGround * ground)
 {
-    delete m_pGround;
+    if (m_pGroundOwner != NULL)
+    {
+        throw std::logic_error("A partition's ground is not its own");
+    }
+    // Keeping the same ground is allowed, its shape is reused as is
+    if (ground != m_pGround)
+    {
+        delete m_pGround;
+    }
     
     m_pGround = ground;
     
@@ -126,9 +227,21 @@ void tgWorld::step(double dt) const
   {
     // Forward to the implementation
     m_pImpl->step(dt);
+    ++m_stepStamp;
   }
 }
 
+void tgWorld::storeState(tgSnapshot& snapshot) const
+{
+  m_pImpl->storeState(snapshot);
+}
+
+void tgWorld::restoreState(const tgSnapshot& snapshot) const
+{
+  ++m_stepStamp;
+  m_pImpl->restoreState(snapshot);
+}
+
 // Add a function that returns the amount of gravity in the world.
 // This is useful for calculating the forces applied by rigid bodies
 // inside models (e.g., ForcePlateModel.)
@@ -138,6 +251,25 @@ double tgWorld::getWorldGravity() const
   return m_config.gravity;
 }
 
+void tgWorld::addPersistentBody(btRigidBody* pBody)
+{
+  if (pBody == NULL)
+  {
+    throw std::invalid_argument("NULL pointer to btRigidBody");
+  }
+  if (std::find(m_persistentBodies.begin(), m_persistentBodies.end(), pBody) ==
+      m_persistentBodies.end())
+  {
+    m_persistentBodies.push_back(pBody);
+  }
+}
+
+tgWorldImpl* tgWorld::createImpl()
+{
+  const tgWorldArena::Scope scope(m_pArena);
+  return new tgWorldBulletPhysicsImpl(m_config, (tgBulletGround*)m_pGround);
+}
+
 bool tgWorld::invariant() const
 {
   return m_pImpl != 0;
@@ -26,9 +26,18 @@
  * $Id$
  */
 
+// This application
+#include "tgRandom.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
 // Forward declarations
+class btRigidBody;
 class tgWorldImpl;
+class tgWorldArena;
 class tgGround;
+class tgSnapshot;
 
 /**
  * Represents the world in which the Tensegrities operate, including
@@ -44,6 +53,34 @@ public:
    */
   struct Config
   {
+    /** The constraint solvers tgWorldBulletPhysicsImpl can build. */
+    enum SolverType
+    {
+      /** btMLCPSolver with btDantzigSolver: accurate but slow */
+      MLCP_DANTZIG,
+      /** btMLCPSolver with btSolveProjectedGaussSeidel */
+      MLCP_PGS,
+      /** btSequentialImpulseConstraintSolver: fast, iterative */
+      SEQUENTIAL_IMPULSE
+    };
+
+    /** The broadphases tgWorldBulletPhysicsImpl can build. */
+    enum BroadphaseType
+    {
+      /** btAxisSweep3, at most 32766 handles */
+      AXIS_SWEEP,
+      /** bt32BitAxisSweep3, for very large worlds */
+      AXIS_SWEEP_32,
+      /** btDbvtBroadphase, which needs no world bounds or handle count */
+      DBVT,
+      /**
+       * tgAggregateBroadphase, one box per model at the top level, for
+       * scenes of many robots or obstacles. Needs no world bounds or
+       * handle count.
+       */
+      AGGREGATE
+    };
+
 	Config(double g = 9.81, double ws = 1000);
     /**
      * Gravitational acceleration.
@@ -56,6 +93,104 @@ public:
      * the length of one side of the detection cube. Must be positive.
      */
     double worldSize;
+    /**
+     * The constraint solver. Defaults to MLCP_DANTZIG.
+     */
+    SolverType solverType;
+    /**
+     * Whether MLCP_DANTZIG first tries the previous step's active set,
+     * see tgWarmDantzigSolver, and only pivots from scratch when that
+     * fails the LCP's checks. The results match to rounding whenever the
+     * LCP has one solution. Ignored by the other solvers: MLCP_PGS and
+     * SEQUENTIAL_IMPULSE already start from Bullet's warm started
+     * impulses. Defaults to false.
+     */
+    bool warmStartMLCP;
+    /**
+     * Number of solver iterations per step. Must be positive.
+     * Defaults to 10, the Bullet default.
+     */
+    int solverIterations;
+    /**
+     * Whether penetration recovery uses split impulses, which keeps
+     * it from adding energy to the system. Defaults to true.
+     */
+    bool splitImpulse;
+    /**
+     * The broadphase collision detection. Defaults to AXIS_SWEEP.
+     */
+    BroadphaseType broadphaseType;
+    /**
+     * The maximum number of collision objects for the axis sweep
+     * broadphases. Ignored by DBVT and AGGREGATE. Defaults to 16384.
+     */
+    unsigned int maxBroadphaseHandles;
+    /**
+     * Whether the axis sweep broadphases are rebuilt before the first
+     * step to fit what was built: the bounds of the models, obstacles
+     * and ground grown by their largest side on every side, and four
+     * times as many handles as collision objects, at least 1024. Small
+     * robots then keep their quantization precision, and models too
+     * large for AXIS_SWEEP's 16 bit handles get a bt32BitAxisSweep3.
+     * worldSize and maxBroadphaseHandles only size the broadphase until
+     * then. Objects added after the first step must fit the handles
+     * left. Ignored by DBVT and AGGREGATE. Defaults to false, which
+     * keeps the pair
+     * order, and so the results, of existing runs.
+     */
+    bool fitBroadphase;
+    /**
+     * Whether the rigid bodies built together, such as those of one
+     * model, go into the collision object array in the Z order (Morton
+     * order) of their centers instead of the order they were built in,
+     * which follows tag matching. Neighbouring bodies then sit side by
+     * side in Bullet's arrays, its simulation islands and the solver's
+     * body pool. Changes the order, and so the rounding, of the solver;
+     * snapshots are only comparable between worlds with the same
+     * setting. Defaults to false.
+     */
+    bool localBodyOrder;
+    /**
+     * The number of threads that solve simulation islands, see
+     * tgParallelDynamicsWorld. 1, the default, builds the usual serial
+     * world; 0 uses one thread per core. Values other than 1 require
+     * Bullet and NTRT to be built with BT_NO_PROFILE.
+     */
+    std::size_t solverThreads;
+
+    /**
+     * Whether the world can hold Bullet soft bodies. No NTRT component
+     * creates any, so by default the world is a btDiscreteDynamicsWorld
+     * with the default collision configuration, which registers fewer
+     * collision algorithms and does no soft body work per step. True
+     * builds a btSoftRigidDynamicsWorld instead, and requires
+     * solverThreads of 1. Defaults to false.
+     */
+    bool softBodies;
+
+    /**
+     * Whether the Bullet objects of the world and of the models set up
+     * by tgSimulation come from a tgWorldArena, which is replaced on
+     * every reset. Defaults to false.
+     */
+    bool worldArena;
+
+    /**
+     * Whether the world only prescreens controllers, trading fidelity
+     * for speed: builders then give rods capsule proxies, the cheapest
+     * rod contact, and make contact cables plain tgBulletSpringCables,
+     * which have no ghost object and no anchors to track. Use
+     * prescreenConfig(), which also lowers the solver settings, and a
+     * larger step size in the tgSimView. Defaults to false.
+     */
+    bool prescreen;
+
+    /**
+     * @return a copy for prescreening runs: prescreen set, the
+     * sequential impulse solver, at most 4 solver iterations and no
+     * split impulse
+     */
+    Config prescreenConfig() const;
   };
 
   /** Construct with the default configuration. */
@@ -78,6 +213,22 @@ public:
   /** Delete the implementation. */
   ~tgWorld();
 
+  /**
+   * Return a new world for models that never touch those of this one,
+   * so the two can be stepped at the same time. It has this world's
+   * configuration and shares its ground, read only: each world builds
+   * its own ground body from the ground's shape. The partition neither
+   * deletes nor replaces the ground, and each reset() takes up this
+   * world's current one. Persistent bodies stay in this world. See
+   * tgSimulation::addPartition().
+   * @return the partition, owned by the caller, which must delete it
+   * before this world
+   */
+  tgWorld* createPartition() const;
+
+  /** @return true if this world was made by createPartition() */
+  bool isPartition() const { return m_pGroundOwner != NULL; }
+
   /** Replace the implementation. */
   void reset();
 
@@ -88,8 +239,11 @@ public:
   void reset(const Config& config);
 
   /**
-   * Replace the implementation with a new ground.
+   * Replace the implementation with a new ground. The old ground is
+   * deleted unless it is the one passed in.
    * @param[in] ground the new ground
+   * @throw std::logic_error if this is a partition, whose ground is
+   * that of the world it was made from
    */
   void reset(tgGround* ground);
     
@@ -100,6 +254,21 @@ public:
    */
   void step(double dt) const;
 
+  /**
+   * Append the state of every body in the world to a snapshot.
+   * Forwards to the implementation.
+   * @param[in,out] snapshot the snapshot to append to
+   */
+  void storeState(tgSnapshot& snapshot) const;
+
+  /**
+   * Restore the state written by storeState(). The world must contain
+   * the same bodies it did when the snapshot was taken.
+   * @param[in] snapshot the snapshot to read from
+   * @throw std::runtime_error if the world has changed since the snapshot
+   */
+  void restoreState(const tgSnapshot& snapshot) const;
+
   /**
    * Return a pointer to the implementation.
    * @return a pointer to the implementation; may be NULL.
@@ -110,16 +279,77 @@ public:
     return *m_pImpl;
   }
 
+  /**
+   * @return the arena of the current implementation, for a
+   * tgWorldArena::Scope around model setup; NULL unless
+   * Config::worldArena
+   */
+  tgWorldArena* arena() const { return m_pArena; }
+
+  /**
+   * Keep a static body in the worlds built by later resets, instead of
+   * deleting it with the rest. Its shapes and motion state go with it,
+   * and it keeps its filter group and mask. The next implementation
+   * gets the kept bodies right after its ground, in the order they were
+   * added. See tgSimulation::addPersistentObstacle().
+   * @param[in] pBody a static body in this world, with no constraints;
+   * checked on the next reset, which throws std::invalid_argument if it
+   * is not
+   */
+  void addPersistentBody(btRigidBody* pBody);
+
+  /** Let later resets delete the kept bodies with the rest again. */
+  void clearPersistentBodies() { m_persistentBodies.clear(); }
+
+  /** The configuration passed at construction or upon reset. */
+  const Config& getConfig() const { return m_config; }
+
   /**
    * Returns the level of gravity in this world.
    */
   double getWorldGravity() const;
+
+  /**
+   * Name this world's random streams, such as by its index in a
+   * tgBatchSimulation, which does so. Defaults to 0.
+   * @param[in] stream the index of the world
+   */
+  void setStream(std::size_t stream) { m_stream = stream; }
+
+  std::size_t getStream() const { return m_stream; }
+
+  /** @return the number of reset() calls since construction */
+  std::size_t getEpisode() const { return m_episode; }
+
+  /**
+   * @return a count of the steps, restores and resets of this world,
+   * at the same address for the life of the world. Values computed from
+   * the bodies' state stay valid for as long as it does not change, see
+   * tgBulletSpringCable::setStepStamp().
+   */
+  const std::size_t* getStepStamp() const { return &m_stepStamp; }
+
+  /**
+   * @param[in] purpose what the stream is for
+   * @return the stream of this world in its current episode, the same
+   * whichever thread runs the world
+   */
+  tgRandom random(tgRandom::Purpose purpose) const
+  {
+    return tgRandom(purpose, tgRandom::index(m_stream, m_episode));
+  }
  
 private:
 
+  /** The constructor of createPartition() */
+  tgWorld(const tgWorld& groundOwner, const Config& config);
+
   /** Integrity predicate */
   bool invariant() const;
 
+  /** @return a new implementation, built in m_pArena if there is one */
+  tgWorldImpl* createImpl();
+
  private:
 
   /**
@@ -130,8 +360,27 @@ private:
   /** Implementation of the ground, such as a box, hills or ramp */
   tgGround* m_pGround;
 
+  /**
+   * The world whose ground this partition shares, or NULL if m_pGround
+   * is owned. Not owned.
+   */
+  const tgWorld* m_pGroundOwner;
+
+  /** Owned, may be NULL, see Config::worldArena */
+  tgWorldArena* m_pArena;
+
   /** The implementation of the tgWorld. */
   tgWorldImpl * m_pImpl;
+
+  /** See addPersistentBody() */
+  std::vector<btRigidBody*> m_persistentBodies;
+
+  /** Names the random streams, see random() */
+  std::size_t m_stream;
+  std::size_t m_episode;
+
+  /** See getStepStamp(); step() and restoreState() are const */
+  mutable std::size_t m_stepStamp;
 };
 
 #endif //TG_BULLET_WORLD_H
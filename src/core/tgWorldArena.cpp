@@ -0,0 +1,217 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgWorldArena.cpp
+ * @brief Contains the definitions of members of class tgWorldArena
+ * $Id$
+ */
+
+// This module
+#include "tgWorldArena.h"
+// The Bullet Physics library
+#include "LinearMath/btAlignedAllocator.h"
+// Boost
+#include <boost/detail/atomic_count.hpp>
+#include <boost/thread/tss.hpp>
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <vector>
+
+struct tgWorldArena::State
+{
+    explicit State(std::size_t size) :
+        live(1),
+        chunkSize(size),
+        next(NULL),
+        end(NULL),
+        bytes(0)
+    {
+    }
+
+    /** The blocks in use, plus one for the tgWorldArena itself */
+    boost::detail::atomic_count live;
+
+    const std::size_t chunkSize;
+    std::vector<char*> chunks;
+
+    /** The unused part of the last ordinary chunk */
+    char* next;
+    char* end;
+
+    std::size_t bytes;
+};
+
+namespace
+{
+    /**
+     * Every block starts with the State it came from, NULL for malloc.
+     * 16 bytes keep the block as aligned as malloc's.
+     */
+    const std::size_t headerSize = 16;
+
+    /** Blocks are rounded up to this */
+    const std::size_t blockAlignment = 16;
+
+    // The cleanup of thread_specific_ptr, for pointers it does not own
+    void keep(tgWorldArena::State*) { }
+
+    /**
+     * The arena of each thread's open Scope. Never deleted, since Bullet
+     * may allocate during static destruction.
+     */
+    boost::thread_specific_ptr<tgWorldArena::State>* pCurrent = NULL;
+
+    void destroy(tgWorldArena::State* pState)
+    {
+        for (std::size_t i = 0; i < pState->chunks.size(); ++i)
+        {
+            std::free(pState->chunks[i]);
+        }
+        delete pState;
+    }
+
+    void unref(tgWorldArena::State* pState)
+    {
+        // Exactly one caller sees the count reach 0
+        if (--pState->live == 0)
+        {
+            destroy(pState);
+        }
+    }
+
+    /** Installs the allocator when the core library is loaded */
+    struct Installer
+    {
+        Installer()
+        {
+            pCurrent = new boost::thread_specific_ptr<tgWorldArena::State>(keep);
+            btAlignedAllocSetCustom(tgWorldArena::allocate,
+                                    tgWorldArena::release);
+        }
+    } installer;
+}
+
+tgWorldArena::Scope::Scope(tgWorldArena* pArena) :
+    m_active(pArena != NULL && pCurrent != NULL),
+    m_pPrevious(NULL)
+{
+    if (m_active)
+    {
+        m_pPrevious = pCurrent->get();
+        pCurrent->reset(pArena->m_pState);
+    }
+}
+
+tgWorldArena::Scope::~Scope()
+{
+    if (m_active)
+    {
+        pCurrent->reset(static_cast<State*>(m_pPrevious));
+    }
+}
+
+tgWorldArena::tgWorldArena(std::size_t chunkSize) :
+    m_pState(new State(std::max(chunkSize, 4 * headerSize)))
+{
+}
+
+tgWorldArena::~tgWorldArena()
+{
+    unref(m_pState);
+}
+
+std::size_t tgWorldArena::bytes() const
+{
+    return m_pState->bytes;
+}
+
+std::size_t tgWorldArena::chunks() const
+{
+    return m_pState->chunks.size();
+}
+
+void* tgWorldArena::allocate(std::size_t size)
+{
+    State* const pState = pCurrent ? pCurrent->get() : NULL;
+    char* pHeader = NULL;
+    if (pState == NULL)
+    {
+        pHeader = static_cast<char*>(std::malloc(headerSize + size));
+        if (pHeader == NULL)
+        {
+            return NULL;
+        }
+    }
+    else
+    {
+        const std::size_t need = (headerSize + size + blockAlignment - 1) &
+            ~(blockAlignment - 1);
+        if (need > pState->chunkSize / 2)
+        {
+            // A chunk of its own, leaving the ordinary one in use
+            pHeader = static_cast<char*>(std::malloc(need));
+            if (pHeader == NULL)
+            {
+                return NULL;
+            }
+            pState->chunks.push_back(pHeader);
+        }
+        else
+        {
+            if (static_cast<std::size_t>(pState->end - pState->next) < need)
+            {
+                char* const pChunk =
+                    static_cast<char*>(std::malloc(pState->chunkSize));
+                if (pChunk == NULL)
+                {
+                    return NULL;
+                }
+                pState->chunks.push_back(pChunk);
+                pState->next = pChunk;
+                pState->end = pChunk + pState->chunkSize;
+            }
+            pHeader = pState->next;
+            pState->next += need;
+        }
+        ++pState->live;
+        pState->bytes += need;
+    }
+    *reinterpret_cast<State**>(pHeader) = pState;
+    return pHeader + headerSize;
+}
+
+void tgWorldArena::release(void* pBlock)
+{
+    if (pBlock == NULL)
+    {
+        return;
+    }
+    char* const pHeader = static_cast<char*>(pBlock) - headerSize;
+    State* const pState = *reinterpret_cast<State**>(pHeader);
+    if (pState == NULL)
+    {
+        std::free(pHeader);
+    }
+    else
+    {
+        unref(pState);
+    }
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_WORLD_ARENA_H
+#define TG_WORLD_ARENA_H
+
+/**
+ * @file tgWorldArena.h
+ * @brief Contains the definition of class tgWorldArena
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+
+/**
+ * A bump allocator for the Bullet objects of one tgWorld: bodies, motion
+ * states, shapes, constraints and the arrays they make while the world
+ * and its models are built. The core library hands Bullet allocate() and
+ * release() with btAlignedAllocSetCustom() when it is loaded, before
+ * any Bullet allocation. While a Scope is open on a thread, what Bullet
+ * allocates on it comes from that Scope's arena. Everything else, such
+ * as what the solver threads or the steps allocate, comes from malloc.
+ *
+ * Freeing a block of an arena only counts it. The arena's chunks go back
+ * to malloc all at once when the arena has been deleted and all its
+ * blocks have been freed, whichever comes last and on whichever thread.
+ * Building a world is then a pointer increment per object, and the
+ * teardown of a short episode returns a few chunks instead of every
+ * object, without fragmenting the heap shared by the worlds of a
+ * tgBatchSimulation. An object kept past its world, such as a shape
+ * cached by a ground, keeps its arena's chunks until it is freed.
+ *
+ * The anchors of tgBulletContactSpringCable already come from a
+ * tgBulletAnchorPool, and are unaffected.
+ */
+class tgWorldArena
+{
+public:
+
+    /**
+     * Makes an arena the current one of this thread until destroyed, and
+     * then restores the one before.
+     */
+    class Scope
+    {
+    public:
+        /** @param[in] pArena the arena, or NULL to leave the current one */
+        explicit Scope(tgWorldArena* pArena);
+
+        ~Scope();
+
+    private:
+        // Not copyable
+        Scope(const Scope&);
+        Scope& operator=(const Scope&);
+
+        bool m_active;
+        void* m_pPrevious;
+    };
+
+    /**
+     * @param[in] chunkSize the bytes taken from malloc at a time; larger
+     * blocks get a chunk of their own
+     */
+    explicit tgWorldArena(std::size_t chunkSize = 64 * 1024);
+
+    /** Frees the chunks now if no block is still in use. */
+    ~tgWorldArena();
+
+    /** @return the bytes handed out so far, headers included */
+    std::size_t bytes() const;
+
+    /** @return the chunks taken from malloc so far */
+    std::size_t chunks() const;
+
+    /**
+     * Bullet's allocation function: a block from the current arena of
+     * this thread, or from malloc if there is none.
+     * @param[in] size the bytes wanted
+     * @return the block, 16 byte aligned, or NULL if out of memory
+     */
+    static void* allocate(std::size_t size);
+
+    /**
+     * Bullet's free function, for blocks of allocate() only.
+     * @param[in] pBlock the block, may be NULL
+     */
+    static void release(void* pBlock);
+
+    struct State;
+
+private:
+
+    // Not copyable
+    tgWorldArena(const tgWorldArena&);
+    tgWorldArena& operator=(const tgWorldArena&);
+
+    State* const m_pState;
+};
+
+#endif  // TG_WORLD_ARENA_H
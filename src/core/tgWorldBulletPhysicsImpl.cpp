@@ -28,7 +28,14 @@
 #include "tgWorldBulletPhysicsImpl.h"
 // This application
 #include "tgWorld.h"
+#include "tgAggregateBroadphase.h"
 #include "tgCast.h"
+#include "tgGhostFilter.h"
+#include "tgParallelDynamicsWorld.h"
+#include "tgPerfCounters.h"
+#include "tgSnapshot.h"
+#include "tgThreadPool.h"
+#include "tgWarmDantzigSolver.h"
 #include "terrain/tgBulletGround.h"
 #include "terrain/tgEmptyGround.h"
 // The Bullet Physics library
@@ -39,83 +46,275 @@
 #include "BulletCollision/CollisionDispatch/btDefaultCollisionConfiguration.h"
 #include "BulletCollision/CollisionShapes/btBoxShape.h"
 #include "BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h"
+#include "BulletCollision/CollisionShapes/btCapsuleShape.h"
 #include "BulletCollision/CollisionShapes/btCompoundShape.h"
+#include "BulletCollision/CollisionShapes/btCylinderShape.h"
+#include "BulletCollision/CollisionShapes/btSphereShape.h"
+#include "BulletCollision/BroadphaseCollision/btBroadphaseProxy.h"
 #include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h"
 #include "BulletDynamics/Dynamics/btDynamicsWorld.h"
 #include "BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolver.h"
 #include "BulletSoftBody/btSoftBodyRigidBodyCollisionConfiguration.h"
 #include "BulletSoftBody/btSoftRigidDynamicsWorld.h"
 #include "LinearMath/btDefaultMotionState.h"
+#include "LinearMath/btQuaternion.h"
 #include "LinearMath/btScalar.h"
 #include "LinearMath/btTransform.h"
 #include "LinearMath/btVector3.h"
 #include "LinearMath/btQuickprof.h"
+// Boost
+#include <boost/cstdint.hpp>
+#include <boost/scoped_ptr.hpp>
+// The C++ Standard Library
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
 
 // Ghost objects
-#include "BulletCollision/CollisionDispatch/btGhostObject.h"
 #include "BulletCollision/BroadphaseCollision/btOverlappingPairCache.h"
 
-#define MLCP_SOLVER
-
-#ifdef MLCP_SOLVER
-
 #include "BulletDynamics/MLCPSolvers/btDantzigSolver.h"
 #include "BulletDynamics/MLCPSolvers/btSolveProjectedGaussSeidel.h"
 #include "BulletDynamics/MLCPSolvers/btMLCPSolver.h"
 
-#endif //MLCP_SOLVER
+namespace
+{
+    /** Orders indexes into a list of bodies by their AABB's lowest x */
+    class LowerAabbX
+    {
+    public:
+        LowerAabbX(const std::vector<btScalar>& minX) : m_minX(minX) { }
+
+        bool operator()(std::size_t a, std::size_t b) const
+        {
+            return m_minX[a] < m_minX[b];
+        }
+
+    private:
+        const std::vector<btScalar>& m_minX;
+    };
+
+    /** Compares indices by their Z order keys */
+    class LowerKey
+    {
+    public:
+        LowerKey(const std::vector<boost::uint32_t>& keys) : m_keys(keys) { }
+
+        bool operator()(std::size_t a, std::size_t b) const
+        {
+            return m_keys[a] < m_keys[b];
+        }
+
+    private:
+        const std::vector<boost::uint32_t>& m_keys;
+    };
+
+    /** @return the low 10 bits of v, spread out to every third bit */
+    boost::uint32_t spreadBits(boost::uint32_t v)
+    {
+        v &= 0x3ff;
+        v = (v | (v << 16)) & 0x030000ff;
+        v = (v | (v << 8)) & 0x0300f00f;
+        v = (v | (v << 4)) & 0x030c30c3;
+        v = (v | (v << 2)) & 0x09249249;
+        return v;
+    }
+
+    /**
+     * @return a new broadphase of this type; the bounds and handle count
+     * are ignored by DBVT
+     */
+    btBroadphaseInterface* newBroadphase(tgWorld::Config::BroadphaseType type,
+                                         const btVector3& worldMin,
+                                         const btVector3& worldMax,
+                                         unsigned int maxHandles)
+    {
+        switch (type)
+        {
+            case tgWorld::Config::AXIS_SWEEP:
+                return new btAxisSweep3(worldMin, worldMax,
+                        static_cast<unsigned short>(maxHandles));
+            case tgWorld::Config::AXIS_SWEEP_32:
+                return new bt32BitAxisSweep3(worldMin, worldMax, maxHandles);
+            case tgWorld::Config::AGGREGATE:
+                return new tgAggregateBroadphase();
+            default:
+                assert(type == tgWorld::Config::DBVT);
+                return new btDbvtBroadphase();
+        }
+    }
+
+    /**
+     * Check the solver and broadphase settings before anything is built.
+     * @param[in] config the configuration passed to the constructor
+     * @return config
+     * @throw std::invalid_argument if a setting is out of range
+     */
+    const tgWorld::Config& validate(const tgWorld::Config& config)
+    {
+        if (config.solverType != tgWorld::Config::MLCP_DANTZIG &&
+            config.solverType != tgWorld::Config::MLCP_PGS &&
+            config.solverType != tgWorld::Config::SEQUENTIAL_IMPULSE)
+        {
+            throw std::invalid_argument("Unknown solver type");
+        }
+        if (config.solverIterations <= 0)
+        {
+            throw std::invalid_argument("solverIterations is not positive");
+        }
+#ifndef BT_NO_PROFILE
+        if (config.solverThreads != 1)
+        {
+            // Bullet's profiler would be entered from several threads
+            throw std::invalid_argument(
+                "solverThreads other than 1 requires BT_NO_PROFILE");
+        }
+#endif //BT_NO_PROFILE
+        if (config.softBodies && config.solverThreads != 1)
+        {
+            // tgParallelDynamicsWorld is a rigid body world
+            throw std::invalid_argument(
+                "softBodies requires solverThreads of 1");
+        }
+        switch (config.broadphaseType)
+        {
+            case tgWorld::Config::AXIS_SWEEP:
+                // btAxisSweep3 uses 16 bit handles
+                if (config.maxBroadphaseHandles < 2 ||
+                    config.maxBroadphaseHandles > 32766)
+                {
+                    throw std::invalid_argument(
+                        "maxBroadphaseHandles must be in [2, 32766] for AXIS_SWEEP");
+                }
+                break;
+            case tgWorld::Config::AXIS_SWEEP_32:
+                if (config.maxBroadphaseHandles < 2)
+                {
+                    throw std::invalid_argument(
+                        "maxBroadphaseHandles must be at least 2");
+                }
+                break;
+            case tgWorld::Config::DBVT:
+            case tgWorld::Config::AGGREGATE:
+                break;
+            default:
+                throw std::invalid_argument("Unknown broadphase type");
+        }
+        return config;
+    }
+}
 
 /**
  * Helper class to bundle objects that have the same life cycle, so they can be
- * constructed and destructed together.
+ * constructed and destructed together. The broadphase and solver are chosen
+ * by the tgWorld::Config.
  */
 class IntermediateBuildProducts
 {
     public:
-        IntermediateBuildProducts(double worldSize) : 
-            corner1 (-worldSize,-worldSize, -worldSize),
-            corner2 (worldSize, worldSize, worldSize),
-            dispatcher(&collisionConfiguration),
-            ghostCallback(),
-#ifndef   MLCP_SOLVER       
-	#if (1) // More acc broadphase - remeber the comma (consider doing ifndef)
-				broadphase(corner1, corner2, 16384)
-	#endif // Broadphase
-#else
-			broadphase(corner1, corner2, 16384),
-			solver(&mlcp)
-#endif //MLCP_SOLVER  
-			
+        IntermediateBuildProducts(const tgWorld::Config& config) : 
+            corner1 (-config.worldSize,-config.worldSize, -config.worldSize),
+            corner2 (config.worldSize, config.worldSize, config.worldSize),
+            softBodies(config.softBodies),
+            pCollisionConfiguration(createCollisionConfiguration(config)),
+            dispatcher(pCollisionConfiguration.get()),
+            ghostFilter(),
+            pBroadphase(createBroadphase(config)),
+            pPool(config.solverThreads == 1 ? NULL :
+                  new tgThreadPool(config.solverThreads))
   {
-	  broadphase.getOverlappingPairCache()->setInternalGhostPairCallback(&ghostCallback);
+      // The ghost pair callback is left to tgGhostFilter::addGhost(), so
+      // worlds without muscle ghosts skip it on every pair change
+      pBroadphase->getOverlappingPairCache()->setOverlapFilterCallback(&ghostFilter);
+      // One solver per thread, since solvers keep scratch space
+      const std::size_t nSolvers = pPool ? pPool->size() : 1;
+      for (std::size_t i = 0; i < nSolvers; ++i)
+      {
+          btMLCPSolverInterface* pMlcp = NULL;
+          switch (config.solverType)
+          {
+              case tgWorld::Config::MLCP_DANTZIG:
+                  pMlcp = config.warmStartMLCP ?
+                      new tgWarmDantzigSolver() : new btDantzigSolver();
+                  solvers.push_back(new btMLCPSolver(pMlcp));
+                  break;
+              case tgWorld::Config::MLCP_PGS:
+                  pMlcp = new btSolveProjectedGaussSeidel();
+                  solvers.push_back(new btMLCPSolver(pMlcp));
+                  break;
+              case tgWorld::Config::SEQUENTIAL_IMPULSE:
+                  solvers.push_back(new btSequentialImpulseConstraintSolver());
+                  break;
+              default:
+                  assert(false);
+          }
+          if (pMlcp)
+          {
+              mlcps.push_back(pMlcp);
+          }
+      }
   }
+
+  ~IntermediateBuildProducts()
+  {
+      for (int i = 0; i < solvers.size(); ++i)
+      {
+          delete solvers[i];
+      }
+      for (int i = 0; i < mlcps.size(); ++i)
+      {
+          delete mlcps[i];
+      }
+      delete pPool;
+      delete pBroadphase;
+  }
+
   const btVector3 corner1;
   const btVector3 corner2;
-  btSoftBodyRigidBodyCollisionConfiguration collisionConfiguration;
+  /** Whether to build a btSoftRigidDynamicsWorld */
+  const bool softBodies;
+  /** Soft body algorithms are only registered if softBodies */
+  const boost::scoped_ptr<btCollisionConfiguration> pCollisionConfiguration;
   btCollisionDispatcher dispatcher;
-  btGhostPairCallback ghostCallback;
-#if (0) // Default broadphase
-        btDbvtBroadphase broadphase;
-#else
-        // More accurate broadphase:
-        btAxisSweep3 broadphase;
-#endif
-
-#ifdef MLCP_SOLVER
-		btDantzigSolver mlcp;
-        //btSolveProjectedGaussSeidel mlcp;
-		btMLCPSolver solver;
-#else
-		btSequentialImpulseConstraintSolver solver;
-#endif
-	
+  /** Keeps muscle ghosts to the pairs they can touch */
+  tgGhostFilter ghostFilter;
+  /** Replaced by tgWorldBulletPhysicsImpl::fitBroadphase() */
+  btBroadphaseInterface* pBroadphase;
+  /** The threads of a tgParallelDynamicsWorld, or NULL for a serial world */
+  tgThreadPool* const pPool;
+  /** One per thread of pPool, or a single solver */
+  btAlignedObjectArray<btConstraintSolver*> solvers;
+  /** The MLCP back ends of the solvers, if an MLCP solver was selected */
+  btAlignedObjectArray<btMLCPSolverInterface*> mlcps;
+
+    private:
+        static btCollisionConfiguration*
+        createCollisionConfiguration(const tgWorld::Config& config)
+        {
+            if (config.softBodies)
+            {
+                return new btSoftBodyRigidBodyCollisionConfiguration();
+            }
+            return new btDefaultCollisionConfiguration();
+        }
+
+        btBroadphaseInterface* createBroadphase(const tgWorld::Config& config) const
+        {
+            return newBroadphase(config.broadphaseType, corner1, corner2,
+                                 config.maxBroadphaseHandles);
+        }
 };
 
 tgWorldBulletPhysicsImpl::tgWorldBulletPhysicsImpl(const tgWorld::Config& config,
         tgBulletGround* ground) :
     tgWorldImpl(config, ground),
-    m_pIntermediateBuildProducts(new IntermediateBuildProducts(config.worldSize)),
-    m_pDynamicsWorld(createDynamicsWorld())
+    m_pIntermediateBuildProducts(new IntermediateBuildProducts(validate(config))),
+    m_pDynamicsWorld(createDynamicsWorld()),
+    m_bulkInsertionDepth(0),
+    m_broadphaseType(config.broadphaseType),
+    m_fitPending(config.fitBroadphase),
+    m_localBodyOrder(config.localBodyOrder)
 {
 
     // Gravitational acceleration is down on the Y axis
@@ -127,23 +326,10 @@ tgWorldBulletPhysicsImpl::tgWorldBulletPhysicsImpl(const tgWorld::Config& config
 		m_pDynamicsWorld->addRigidBody(ground->getGroundRigidBody());
 	}
 	
-	/*
-	 * These are lines from the old BasicLearningApp.cpp that we aren't using.
-	 * http://bulletphysics.org/mediawiki-1.5.8/index.php/BtContactSolverInfo
-	 */
-    #if (0) 
-		// Split impulse is on by default
-        m_pDynamicsWorld->getSolverInfo().m_splitImpulse = true;
-        m_pDynamicsWorld->getSolverInfo().m_splitImpulsePenetrationThreshold = -0.02;
-        
-        // Default is 10 - increases runtime but decreases odds of penetration
-        // Makes tetraspine sine waves more accurate and static test less accurate
-        m_pDynamicsWorld->getSolverInfo().m_numIterations = 20;
-        
-        // Ground contact params:
-        m_pDynamicsWorld->getSolverInfo().m_erp = 0.8;
-        
-    #endif	
+	// Default is 10 - increases runtime but decreases odds of penetration
+	// Makes tetraspine sine waves more accurate and static test less accurate
+	m_pDynamicsWorld->getSolverInfo().m_numIterations = config.solverIterations;
+	m_pDynamicsWorld->getSolverInfo().m_splitImpulse = config.splitImpulse;
     
 
     
@@ -153,6 +339,13 @@ tgWorldBulletPhysicsImpl::tgWorldBulletPhysicsImpl(const tgWorld::Config& config
 
 tgWorldBulletPhysicsImpl::~tgWorldBulletPhysicsImpl()
 {
+    // Bodies still held by an unfinished bulk insertion are ours too
+    for (std::size_t i = 0; i < m_heldBodies.size(); ++i)
+    {
+        delete m_heldBodies[i]->getMotionState();
+        delete m_heldBodies[i];
+    }
+
     // Delete all the collision objects. The dynamics world must exist.
     // Delete in reverse order of creation.
     const size_t nco = m_pDynamicsWorld->getNumCollisionObjects();
@@ -189,21 +382,34 @@ tgWorldBulletPhysicsImpl::~tgWorldBulletPhysicsImpl()
 }
 
 /**
- * Create and return a new instance of a btSoftRigidDynamicsWorld.
- * @return a pointer to a new instance of a btSoftRigidDynamicsWorld
+ * Create and return a new dynamics world: a tgParallelDynamicsWorld if
+ * solver threads were asked for, a btSoftRigidDynamicsWorld if soft
+ * bodies were, else a btDiscreteDynamicsWorld.
+ * @return a pointer to the new dynamics world
  */
 btDynamicsWorld* tgWorldBulletPhysicsImpl::createDynamicsWorld() const
 {    
    
-  btSoftRigidDynamicsWorld* const result =
-    new btSoftRigidDynamicsWorld(&m_pIntermediateBuildProducts->dispatcher,
-                 &m_pIntermediateBuildProducts->broadphase,
-                 &m_pIntermediateBuildProducts->solver, 
-                 &m_pIntermediateBuildProducts->collisionConfiguration);
-#ifdef MLCPSOLVER	
-		result ->getSolverInfo().m_minimumSolverBatchSize = 1;//for direct solver it is better to have a small A matrix
-#endif	
-  return result;
+  IntermediateBuildProducts& ibp = *m_pIntermediateBuildProducts;
+  if (ibp.pPool)
+  {
+    return new tgParallelDynamicsWorld(&ibp.dispatcher,
+                 ibp.pBroadphase,
+                 ibp.solvers,
+                 ibp.pCollisionConfiguration.get(),
+                 *ibp.pPool);
+  }
+  if (ibp.softBodies)
+  {
+    return new btSoftRigidDynamicsWorld(&ibp.dispatcher,
+                 ibp.pBroadphase,
+                 ibp.solvers[0], 
+                 ibp.pCollisionConfiguration.get());
+  }
+  return new btDiscreteDynamicsWorld(&ibp.dispatcher,
+               ibp.pBroadphase,
+               ibp.solvers[0],
+               ibp.pCollisionConfiguration.get());
 }
 
 void tgWorldBulletPhysicsImpl::step(double dt)
@@ -211,15 +417,131 @@ void tgWorldBulletPhysicsImpl::step(double dt)
     // Precondition
     assert(dt > 0.0);
 
+    if (m_fitPending)
+    {
+        // Everything setup() builds is in the world by now
+        m_fitPending = false;
+        fitBroadphase();
+    }
+
     const btScalar timeStep = dt;
     const int maxSubSteps = 1;
     const btScalar fixedTimeStep = dt;
+    // Counted per collision object: the bodies, and the ghosts of contact
+    // cables
+    const tgPerfCounters::Scope counters(
+        "stepSimulation", m_pDynamicsWorld->getNumCollisionObjects());
     m_pDynamicsWorld->stepSimulation(timeStep, maxSubSteps, fixedTimeStep);
 
     // Postcondition
     assert(invariant());
 }
 
+void tgWorldBulletPhysicsImpl::storeState(tgSnapshot& snapshot) const
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("storeState");
+#endif //BT_NO_PROFILE
+
+    const btCollisionObjectArray& objects =
+        m_pDynamicsWorld->getCollisionObjectArray();
+    const int n = objects.size();
+    snapshot.write(n);
+    for (int i = 0; i < n; ++i)
+    {
+        const btRigidBody* const pBody = btRigidBody::upcast(objects[i]);
+        if (pBody)
+        {
+            const btTransform& t = pBody->getWorldTransform();
+            const btVector3& origin = t.getOrigin();
+            const btQuaternion rotation = t.getRotation();
+            const btVector3& linVel = pBody->getLinearVelocity();
+            const btVector3& angVel = pBody->getAngularVelocity();
+            snapshot.write(origin.x());
+            snapshot.write(origin.y());
+            snapshot.write(origin.z());
+            snapshot.write(rotation.x());
+            snapshot.write(rotation.y());
+            snapshot.write(rotation.z());
+            snapshot.write(rotation.w());
+            snapshot.write(linVel.x());
+            snapshot.write(linVel.y());
+            snapshot.write(linVel.z());
+            snapshot.write(angVel.x());
+            snapshot.write(angVel.y());
+            snapshot.write(angVel.z());
+            snapshot.write(pBody->getActivationState());
+        }
+    }
+}
+
+void tgWorldBulletPhysicsImpl::restoreState(const tgSnapshot& snapshot)
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("restoreState");
+#endif //BT_NO_PROFILE
+
+    btCollisionObjectArray& objects =
+        m_pDynamicsWorld->getCollisionObjectArray();
+    const int n = objects.size();
+    if (static_cast<int>(snapshot.read()) != n)
+    {
+        throw std::runtime_error("World has changed since the snapshot");
+    }
+
+    btBroadphaseInterface* const pBroadphase =
+        m_pDynamicsWorld->getBroadphase();
+    btDispatcher* const pDispatcher = m_pDynamicsWorld->getDispatcher();
+    for (int i = 0; i < n; ++i)
+    {
+        btRigidBody* const pBody = btRigidBody::upcast(objects[i]);
+        if (pBody)
+        {
+            // Read one value per statement; the evaluation order of
+            // function arguments is unspecified
+            const double x = snapshot.read();
+            const double y = snapshot.read();
+            const double z = snapshot.read();
+            const double qx = snapshot.read();
+            const double qy = snapshot.read();
+            const double qz = snapshot.read();
+            const double qw = snapshot.read();
+            const double vx = snapshot.read();
+            const double vy = snapshot.read();
+            const double vz = snapshot.read();
+            const double wx = snapshot.read();
+            const double wy = snapshot.read();
+            const double wz = snapshot.read();
+            const int activationState = static_cast<int>(snapshot.read());
+
+            const btTransform t(btQuaternion(qx, qy, qz, qw), btVector3(x, y, z));
+            pBody->setCenterOfMassTransform(t);
+            pBody->setInterpolationWorldTransform(t);
+            if (pBody->getMotionState())
+            {
+                pBody->getMotionState()->setWorldTransform(t);
+            }
+            pBody->setLinearVelocity(btVector3(vx, vy, vz));
+            pBody->setAngularVelocity(btVector3(wx, wy, wz));
+            pBody->setInterpolationLinearVelocity(btVector3(vx, vy, vz));
+            pBody->setInterpolationAngularVelocity(btVector3(wx, wy, wz));
+            pBody->clearForces();
+            pBody->forceActivationState(activationState);
+            pBody->setDeactivationTime(0.0);
+        }
+        if (objects[i]->getBroadphaseHandle())
+        {
+            pBroadphase->getOverlappingPairCache()->cleanProxyFromPairs(
+                objects[i]->getBroadphaseHandle(), pDispatcher);
+        }
+    }
+    pBroadphase->resetPool(pDispatcher);
+    m_pDynamicsWorld->getConstraintSolver()->reset();
+
+    // Postcondition
+    assert(invariant());
+}
+
 void tgWorldBulletPhysicsImpl::addCollisionShape(btCollisionShape* pShape)
 {
 #ifndef BT_NO_PROFILE 
@@ -243,6 +565,15 @@ void tgWorldBulletPhysicsImpl::deleteCollisionShape(btCollisionShape* pShape)
 	
     if (pShape)
     {
+        // Other rigids may still use a shared shape; it goes with the world
+        for (std::map<SharedShapeKey, btCollisionShape*>::const_iterator it =
+                 m_sharedShapes.begin(); it != m_sharedShapes.end(); ++it)
+        {
+            if (it->second == pShape)
+            {
+                return;
+            }
+        }
 		btCompoundShape* cShape = tgCast::cast<btCollisionShape, btCompoundShape>(pShape);
 		if (cShape)
 		{
@@ -260,6 +591,364 @@ void tgWorldBulletPhysicsImpl::deleteCollisionShape(btCollisionShape* pShape)
       assert(invariant());
 }
 
+bool tgWorldBulletPhysicsImpl::SharedShapeKey::operator<(
+        const SharedShapeKey& other) const
+{
+    if (type != other.type) { return type < other.type; }
+    if (x != other.x) { return x < other.x; }
+    if (y != other.y) { return y < other.y; }
+    return z < other.z;
+}
+
+btCollisionShape* tgWorldBulletPhysicsImpl::findSharedShape(
+        const SharedShapeKey& key) const
+{
+    const std::map<SharedShapeKey, btCollisionShape*>::const_iterator it =
+        m_sharedShapes.find(key);
+    return it == m_sharedShapes.end() ? NULL : it->second;
+}
+
+btCollisionShape* tgWorldBulletPhysicsImpl::addSharedShape(
+        const SharedShapeKey& key, btCollisionShape* pShape)
+{
+    addCollisionShape(pShape);
+    m_sharedShapes[key] = pShape;
+    return pShape;
+}
+
+btCollisionShape* tgWorldBulletPhysicsImpl::getBoxShape(
+        const btVector3& halfExtents)
+{
+    const SharedShapeKey key(BOX_SHAPE_PROXYTYPE,
+                             halfExtents.x(), halfExtents.y(), halfExtents.z());
+    btCollisionShape* const pShape = findSharedShape(key);
+    return pShape ? pShape : addSharedShape(key, new btBoxShape(halfExtents));
+}
+
+btCollisionShape* tgWorldBulletPhysicsImpl::getCylinderShape(
+        const btVector3& halfExtents)
+{
+    const SharedShapeKey key(CYLINDER_SHAPE_PROXYTYPE,
+                             halfExtents.x(), halfExtents.y(), halfExtents.z());
+    btCollisionShape* const pShape = findSharedShape(key);
+    return pShape ?
+        pShape : addSharedShape(key, new btCylinderShape(halfExtents));
+}
+
+btCollisionShape* tgWorldBulletPhysicsImpl::getSphereShape(double radius)
+{
+    const SharedShapeKey key(SPHERE_SHAPE_PROXYTYPE, radius, 0.0, 0.0);
+    btCollisionShape* const pShape = findSharedShape(key);
+    return pShape ? pShape : addSharedShape(key, new btSphereShape(radius));
+}
+
+btCollisionShape* tgWorldBulletPhysicsImpl::getCapsuleShape(double radius,
+                                                            double height)
+{
+    const SharedShapeKey key(CAPSULE_SHAPE_PROXYTYPE, radius, height, 0.0);
+    btCollisionShape* const pShape = findSharedShape(key);
+    return pShape ?
+        pShape : addSharedShape(key, new btCapsuleShape(radius, height));
+}
+
+btCollisionShape* tgWorldBulletPhysicsImpl::getSphereStringShape(double radius,
+                                                                 double length)
+{
+    const SharedShapeKey key(COMPOUND_SHAPE_PROXYTYPE, radius, length, 0.0);
+    btCollisionShape* pShape = findSharedShape(key);
+    if (pShape == NULL)
+    {
+        // One more sphere than gaps of at most a radius
+        const int gaps = (radius > 0.0 && length > 0.0) ?
+            static_cast<int>(std::ceil(length / radius)) : 0;
+        btCompoundShape* const pString = new btCompoundShape(gaps > 8);
+        btCollisionShape* const pSphere = getSphereShape(radius);
+        btTransform t;
+        t.setIdentity();
+        for (int i = 0; i <= gaps; i++)
+        {
+            const double y = (gaps == 0) ? 0.0 : length * (double(i) / gaps - 0.5);
+            t.setOrigin(btVector3(0.0, y, 0.0));
+            pString->addChildShape(t, pSphere);
+        }
+        pShape = addSharedShape(key, pString);
+    }
+    return pShape;
+}
+
+void tgWorldBulletPhysicsImpl::addRigidBody(btRigidBody* pBody)
+{
+    if (pBody == NULL)
+    {
+        return;
+    }
+    if (m_bulkInsertionDepth > 0)
+    {
+        m_heldBodies.push_back(pBody);
+    }
+    else
+    {
+        m_pDynamicsWorld->addRigidBody(pBody);
+    }
+}
+
+void tgWorldBulletPhysicsImpl::beginBulkInsertion()
+{
+    ++m_bulkInsertionDepth;
+}
+
+void tgWorldBulletPhysicsImpl::endBulkInsertion()
+{
+    assert(m_bulkInsertionDepth > 0);
+    if (--m_bulkInsertionDepth == 0)
+    {
+        insertHeldBodies();
+    }
+}
+
+void tgWorldBulletPhysicsImpl::detachRigidBody(btRigidBody* pBody,
+                                               short& group, short& mask,
+                                               std::vector<btCollisionShape*>& shapes)
+{
+    if (pBody == NULL || pBody->getBroadphaseHandle() == NULL ||
+        m_pDynamicsWorld->getCollisionObjectArray().findLinearSearch(pBody) ==
+        m_pDynamicsWorld->getNumCollisionObjects())
+    {
+        throw std::invalid_argument("Body is not in this world");
+    }
+    if (!pBody->isStaticObject() || pBody->getNumConstraintRefs() > 0)
+    {
+        throw std::invalid_argument("Only static bodies without constraints can be kept");
+    }
+    group = pBody->getBroadphaseHandle()->m_collisionFilterGroup;
+    mask = pBody->getBroadphaseHandle()->m_collisionFilterMask;
+    m_pDynamicsWorld->removeRigidBody(pBody);
+
+    std::vector<btCollisionShape*> pending(1, pBody->getCollisionShape());
+    while (!pending.empty())
+    {
+        btCollisionShape* const pShape = pending.back();
+        pending.pop_back();
+        if (pShape == NULL ||
+            std::find(shapes.begin(), shapes.end(), pShape) != shapes.end())
+        {
+            continue;
+        }
+        shapes.push_back(pShape);
+        m_collisionShapes.remove(pShape);
+        for (std::map<SharedShapeKey, btCollisionShape*>::iterator it =
+                 m_sharedShapes.begin(); it != m_sharedShapes.end(); ++it)
+        {
+            if (it->second == pShape)
+            {
+                m_sharedShapes.erase(it);
+                break;
+            }
+        }
+        btCompoundShape* const pCompound =
+            tgCast::cast<btCollisionShape, btCompoundShape>(pShape);
+        if (pCompound)
+        {
+            for (int i = 0; i < pCompound->getNumChildShapes(); ++i)
+            {
+                pending.push_back(pCompound->getChildShape(i));
+            }
+        }
+    }
+}
+
+void tgWorldBulletPhysicsImpl::attachRigidBody(btRigidBody* pBody,
+                                               short group, short mask)
+{
+    assert(pBody != NULL);
+    m_pDynamicsWorld->addRigidBody(pBody, group, mask);
+}
+
+void tgWorldBulletPhysicsImpl::insertHeldBodies()
+{
+    const std::size_t n = m_heldBodies.size();
+    if (n == 0)
+    {
+        return;
+    }
+    btCollisionObjectArray& objects =
+        m_pDynamicsWorld->getCollisionObjectArray();
+    const int first = objects.size();
+    const std::vector<btRigidBody*> arrayOrder = heldBodyOrder();
+
+    if (m_broadphaseType == tgWorld::Config::DBVT)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            m_pDynamicsWorld->addRigidBody(arrayOrder[i]);
+        }
+        static_cast<btDbvtBroadphase*>(m_pIntermediateBuildProducts->pBroadphase)
+            ->optimize();
+    }
+    else
+    {
+        std::vector<btScalar> minX(n);
+        std::vector<std::size_t> order(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            btVector3 aabbMin;
+            btVector3 aabbMax;
+            m_heldBodies[i]->getAabb(aabbMin, aabbMax);
+            minX[i] = aabbMin.x();
+            order[i] = i;
+        }
+        // Stable, so that the insertion order is the same from run to run
+        std::stable_sort(order.begin(), order.end(), LowerAabbX(minX));
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            m_pDynamicsWorld->addRigidBody(m_heldBodies[order[i]]);
+        }
+        // Snapshots and simulation islands follow the collision object
+        // array, so put it back in the order the bodies were made, or in
+        // Z order. Bullet 2.82 keeps no array index in the objects
+        // themselves.
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            objects[first + static_cast<int>(i)] = arrayOrder[i];
+        }
+    }
+    m_heldBodies.clear();
+}
+
+std::vector<btRigidBody*> tgWorldBulletPhysicsImpl::heldBodyOrder() const
+{
+    const std::size_t n = m_heldBodies.size();
+    if (!m_localBodyOrder || n < 2)
+    {
+        return m_heldBodies;
+    }
+
+    std::vector<btVector3> centers(n);
+    btVector3 boundsMin(BT_LARGE_FLOAT, BT_LARGE_FLOAT, BT_LARGE_FLOAT);
+    btVector3 boundsMax(-BT_LARGE_FLOAT, -BT_LARGE_FLOAT, -BT_LARGE_FLOAT);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        btVector3 aabbMin;
+        btVector3 aabbMax;
+        m_heldBodies[i]->getAabb(aabbMin, aabbMax);
+        centers[i] = (aabbMin + aabbMax) * 0.5;
+        boundsMin.setMin(centers[i]);
+        boundsMax.setMax(centers[i]);
+    }
+
+    // 1024 cells along each side of the bounds of the centers
+    const btVector3 size = boundsMax - boundsMin;
+    const btScalar scale = 1023.0 / std::max(size[size.maxAxis()], btScalar(1e-9));
+    std::vector<boost::uint32_t> keys(n);
+    std::vector<std::size_t> order(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const btVector3 cell = (centers[i] - boundsMin) * scale;
+        keys[i] = spreadBits(static_cast<boost::uint32_t>(cell.x())) |
+            spreadBits(static_cast<boost::uint32_t>(cell.y())) << 1 |
+            spreadBits(static_cast<boost::uint32_t>(cell.z())) << 2;
+        order[i] = i;
+    }
+    // Stable, so that bodies in one cell keep the order they were made in
+    std::stable_sort(order.begin(), order.end(), LowerKey(keys));
+
+    std::vector<btRigidBody*> result(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        result[i] = m_heldBodies[order[i]];
+    }
+    return result;
+}
+
+void tgWorldBulletPhysicsImpl::fitBroadphase()
+{
+    // Neither has bounds to fit, and the aggregates would be lost
+    if (m_broadphaseType == tgWorld::Config::DBVT ||
+        m_broadphaseType == tgWorld::Config::AGGREGATE)
+    {
+        return;
+    }
+    btCollisionObjectArray& objects =
+        m_pDynamicsWorld->getCollisionObjectArray();
+    const int n = objects.size();
+    if (n == 0)
+    {
+        return;
+    }
+
+    // Removing an object destroys its proxy, so keep what is needed to
+    // insert it again
+    std::vector<btCollisionObject*> saved(n);
+    std::vector<short> groups(n);
+    std::vector<short> masks(n);
+    std::vector<btScalar> minX(n);
+    std::vector<std::size_t> order(n);
+    btVector3 boundsMin(BT_LARGE_FLOAT, BT_LARGE_FLOAT, BT_LARGE_FLOAT);
+    btVector3 boundsMax(-BT_LARGE_FLOAT, -BT_LARGE_FLOAT, -BT_LARGE_FLOAT);
+    for (int i = 0; i < n; ++i)
+    {
+        const btBroadphaseProxy* const proxy = objects[i]->getBroadphaseHandle();
+        assert(proxy != NULL);
+        saved[i] = objects[i];
+        groups[i] = proxy->m_collisionFilterGroup;
+        masks[i] = proxy->m_collisionFilterMask;
+        minX[i] = proxy->m_aabbMin.x();
+        order[i] = i;
+        boundsMin.setMin(proxy->m_aabbMin);
+        boundsMax.setMax(proxy->m_aabbMax);
+    }
+
+    // Room to move, and for what is added later
+    const btVector3 size = boundsMax - boundsMin;
+    const btScalar margin = std::max(size[size.maxAxis()], btScalar(1.0));
+    const btVector3 grow(margin, margin, margin);
+    const unsigned int handles =
+        std::max(4 * static_cast<unsigned int>(n), 1024u);
+    if (m_broadphaseType == tgWorld::Config::AXIS_SWEEP && handles > 32766)
+    {
+        m_broadphaseType = tgWorld::Config::AXIS_SWEEP_32;
+    }
+
+    for (int i = n - 1; i >= 0; --i)
+    {
+        m_pDynamicsWorld->removeCollisionObject(saved[i]);
+    }
+    IntermediateBuildProducts& ibp = *m_pIntermediateBuildProducts;
+    delete ibp.pBroadphase;
+    ibp.pBroadphase = newBroadphase(m_broadphaseType,
+                                    boundsMin - grow, boundsMax + grow,
+                                    handles);
+    ibp.pBroadphase->getOverlappingPairCache()->
+        setOverlapFilterCallback(&ibp.ghostFilter);
+    m_pDynamicsWorld->setBroadphase(ibp.pBroadphase);
+
+    // In order of lowest x, as insertHeldBodies() does
+    std::stable_sort(order.begin(), order.end(), LowerAabbX(minX));
+    for (int i = 0; i < n; ++i)
+    {
+        btCollisionObject* const pObject = saved[order[i]];
+        btRigidBody* const pBody = btRigidBody::upcast(pObject);
+        if (pBody)
+        {
+            m_pDynamicsWorld->addRigidBody(pBody, groups[order[i]],
+                                           masks[order[i]]);
+        }
+        else if (groups[order[i]] & tgGhostFilter::ghostGroup)
+        {
+            tgGhostFilter::addGhost(*m_pDynamicsWorld, pObject);
+        }
+        else
+        {
+            m_pDynamicsWorld->addCollisionObject(pObject, groups[order[i]],
+                                                 masks[order[i]]);
+        }
+    }
+    for (int i = 0; i < n; ++i)
+    {
+        objects[i] = saved[i];
+    }
+}
+
 bool tgWorldBulletPhysicsImpl::invariant() const
 {
     return (m_pDynamicsWorld != 0);
@@ -31,6 +31,9 @@
 #include "tgWorld.h"
 #include "tgWorldImpl.h"
 #include "LinearMath/btAlignedObjectArray.h"
+// The C++ Standard Library
+#include <map>
+#include <vector>
 
 
 
@@ -38,6 +41,7 @@
 class btCollisionShape;
 class btTypedConstraint;
 class btDynamicsWorld;
+class btVector3;
 class btRigidBody;
 class IntermediateBuildProducts;
 class btBroadphaseInterface;
@@ -67,12 +71,40 @@ class tgWorldBulletPhysicsImpl : public tgWorldImpl
   ~tgWorldBulletPhysicsImpl();
 
   /**
-   * Advance the simulation.
+   * Advance the simulation. The first call fits the broadphase if
+   * tgWorld::Config::fitBroadphase is set.
    * @param[in] dt the number of seconds since the previous call;
    * must be positive
    */
   virtual void step(double dt);
 
+  /**
+   * Replace an axis sweep broadphase with one sized to the collision
+   * objects in the world now, see tgWorld::Config::fitBroadphase. The
+   * objects are reinserted with their filter groups and masks, and the
+   * collision object array keeps its order. Does nothing for DBVT or an
+   * empty world.
+   */
+  void fitBroadphase();
+
+  /**
+   * Store the transform and velocities of every rigid body in the
+   * dynamics world, in the order of its collision object array.
+   * @param[in,out] snapshot the snapshot to append to
+   */
+  virtual void storeState(tgSnapshot& snapshot) const;
+
+  /**
+   * Put every rigid body back where storeState() found it, then clear
+   * the cached contact pairs and the solver's warm start data so the
+   * next step behaves like the first step after the snapshot.
+   * Ghost objects (such as those of tgBulletContactSpringCable) are
+   * moved by their owners and are not restored here.
+   * @param[in] snapshot the snapshot to read from
+   * @throw std::runtime_error if the collision objects have changed
+   */
+  virtual void restoreState(const tgSnapshot& snapshot);
+
   /**
    * Return a reference to the dynamics world.
    * @return a reference to the dynamics world
@@ -94,6 +126,42 @@ class tgWorldBulletPhysicsImpl : public tgWorldImpl
 	 * @param[in] pShape a pointer to a btCollisionShape; do nothing if NULL
 	 */
 	void deleteCollisionShape(btCollisionShape* pShape);
+
+	/**
+	 * Return a btBoxShape with these half extents. Every caller asking for
+	 * the same extents gets the same shape, which the world owns and
+	 * deletes like those given to addCollisionShape. Shared shapes must not
+	 * be modified; deleteCollisionShape leaves them alone.
+	 * @param[in] halfExtents the half extents, matched exactly
+	 */
+	btCollisionShape* getBoxShape(const btVector3& halfExtents);
+
+	/**
+	 * Return a shared btCylinderShape (Y axis) with these half extents.
+	 * @see getBoxShape
+	 */
+	btCollisionShape* getCylinderShape(const btVector3& halfExtents);
+
+	/**
+	 * Return a shared btSphereShape with this radius.
+	 * @see getBoxShape
+	 */
+	btCollisionShape* getSphereShape(double radius);
+
+	/**
+	 * Return a shared btCapsuleShape (Y axis) with this radius and this
+	 * distance between the centers of its caps.
+	 * @see getBoxShape
+	 */
+	btCollisionShape* getCapsuleShape(double radius, double height);
+
+	/**
+	 * Return a shared btCompoundShape of spheres of this radius along the
+	 * Y axis, centered on the origin and no more than a radius apart. The
+	 * centers of the two end spheres are length apart.
+	 * @see getBoxShape
+	 */
+	btCollisionShape* getSphereStringShape(double radius, double length);
 	
         /**
      * Add a btTypedConstraint to a collection for deletion upon
@@ -101,8 +169,73 @@ class tgWorldBulletPhysicsImpl : public tgWorldImpl
      * @param[in] pConstraint a pointer to a btTypedConstraint; do nothing if NULL
      */
         void addConstraint(btTypedConstraint* pConstaint);
+
+	/**
+	 * Add a rigid body to the dynamics world, or hold it until
+	 * endBulkInsertion if a bulk insertion is under way.
+	 * @param[in] pBody a rigid body not in any world yet
+	 */
+	void addRigidBody(btRigidBody* pBody);
+
+	/**
+	 * Start holding the bodies given to addRigidBody. Calls may nest; the
+	 * bodies go in at the outermost endBulkInsertion.
+	 */
+	void beginBulkInsertion();
+
+	/**
+	 * Insert the held bodies. Sweep and prune broadphases get them in order
+	 * of their AABB's lowest x, so that on the x axis each new body passes
+	 * only the edges of those it overlaps, instead of every edge in the
+	 * world. A DBVT broadphase is rebalanced once at the end instead. The
+	 * collision object array ends up in the order the bodies were given.
+	 */
+	void endBulkInsertion();
+
+	/**
+	 * Take a static rigid body out of the world without deleting it, so
+	 * that tgWorld can hand it to the next implementation on reset. Its
+	 * shape, and the children of a compound shape, are no longer owned
+	 * or shared by this world.
+	 * @param[in] pBody a static body in this world, with no constraints
+	 * @param[out] group its broadphase filter group
+	 * @param[out] mask its broadphase filter mask
+	 * @param[in,out] shapes the shapes released are appended
+	 * @throw std::invalid_argument if the body is not a static body of
+	 * this world or has constraints
+	 */
+	void detachRigidBody(btRigidBody* pBody, short& group, short& mask,
+	                     std::vector<btCollisionShape*>& shapes);
+
+	/**
+	 * Add a body detached from another world, with the filter group and
+	 * mask it had there. Its shapes are handed over separately with
+	 * addCollisionShape.
+	 */
+	void attachRigidBody(btRigidBody* pBody, short group, short mask);
 private:
 
+    /** Identifies a shared shape by its Bullet shape type and dimensions */
+    struct SharedShapeKey
+    {
+        SharedShapeKey(int t, double a, double b, double c) :
+            type(t), x(a), y(b), z(c) { }
+
+        bool operator<(const SharedShapeKey& other) const;
+
+        int type;
+        double x;
+        double y;
+        double z;
+    };
+
+    /** Return the shared shape for key, or NULL if there is none yet */
+    btCollisionShape* findSharedShape(const SharedShapeKey& key) const;
+
+    /** Take ownership of pShape and share it under key */
+    btCollisionShape* addSharedShape(const SharedShapeKey& key,
+                                     btCollisionShape* pShape);
+
     /**
      * Delete all the collision objects. The dynamics world must exist.
      * Delete in reverse order of creation.
@@ -115,10 +248,20 @@ private:
      */
     void removeConstraints();
 
+    /** Hand the held bodies to the dynamics world */
+    void insertHeldBodies();
+
+    /**
+     * @return the held bodies in the order they go into the collision
+     * object array: as built, or in the Z order of their centers if
+     * m_localBodyOrder
+     */
+    std::vector<btRigidBody*> heldBodyOrder() const;
+
         /**
      * Create a new dynamics world. Needs to be in the namespace so we
      * can free the pointers it creates.
-     * @return the newly-created btSoftRigidDynamicsWorld
+     * @return the newly-created btDynamicsWorld
      */
         btDynamicsWorld* createDynamicsWorld() const;
     
@@ -127,7 +270,7 @@ private:
 
  private:
     
-    /** Used to build the btSoftRigidDynamicsWorld. */
+    /** Used to build the btDynamicsWorld. */
     IntermediateBuildProducts * const m_pIntermediateBuildProducts;
     
 
@@ -144,12 +287,33 @@ private:
      */
     btAlignedObjectArray<btCollisionShape*> m_collisionShapes;
 
+    /**
+     * The shapes handed out by getBoxShape, getCylinderShape and
+     * getSphereShape. They are also in m_collisionShapes, which owns them.
+     */
+    std::map<SharedShapeKey, btCollisionShape*> m_sharedShapes;
+
     /* 
      * A vector of constraints for easy reference. Does not affect
      * physics or rendering unles the constraint is placed into the dynamics
      * world.
      */
     btAlignedObjectArray<btTypedConstraint*> m_constraints;
+
+    /** Bodies given to addRigidBody during a bulk insertion, in order */
+    std::vector<btRigidBody*> m_heldBodies;
+
+    /** How many beginBulkInsertion calls have not been ended yet */
+    int m_bulkInsertionDepth;
+
+    /** AXIS_SWEEP becomes AXIS_SWEEP_32 if fitBroadphase needs it */
+    tgWorld::Config::BroadphaseType m_broadphaseType;
+
+    /** Whether the next step() fits the broadphase first */
+    bool m_fitPending;
+
+    /** See tgWorld::Config::localBodyOrder */
+    const bool m_localBodyOrder;
 };
 
 #endif  // TG_WORLDBULLETPHYSICSIMPL_H
@@ -31,6 +31,7 @@
 
 // Forward declarations
 class tgGround;
+class tgSnapshot;
 
 /**
  * Abstract base class to encapsulate the implementation of the tgWorld.
@@ -55,6 +56,19 @@ public:
    * must be positive
    */
   virtual void step(double dt) = 0;
+
+  /**
+   * Append the state of every body in the world to a snapshot.
+   * @param[in,out] snapshot the snapshot to append to
+   */
+  virtual void storeState(tgSnapshot& snapshot) const = 0;
+
+  /**
+   * Read back the state written by storeState() without rebuilding
+   * the world.
+   * @param[in] snapshot the snapshot to read from
+   */
+  virtual void restoreState(const tgSnapshot& snapshot) = 0;
 };
 
 
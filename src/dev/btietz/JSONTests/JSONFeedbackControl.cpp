@@ -32,6 +32,7 @@
 // to a cpp over there
 #include "core/tgSpringCableActuator.h"
 #include "core/tgBasicActuator.h"
+#include "core/tgStateFrame.h"
 #include "controllers/tgImpedanceController.h"
 #include "examples/learningSpines/tgCPGActuatorControl.h"
 #include "examples/learningSpines/tgCPGCableControl.h"
@@ -45,7 +46,7 @@
 #include "util/CPGEquationsFB.h"
 #include "examples/learningSpines/tgCPGCableControl.h"
 
-#include "neuralNet/Neural Network v2/neuralNetwork.h"
+#include "util/NeuralNetBatch.h"
 
 #include <json/json.h>
 
@@ -101,7 +102,8 @@ JSONFeedbackControl::JSONFeedbackControl(JSONFeedbackControl::Config config,
                                                 std::string args,
                                                 std::string resourcePath) :
 JSONCPGControl(config, args, resourcePath),
-m_config(config)
+m_config(config),
+m_pFeedbackNets(NULL)
 {
     // Path and filename handled by base class
     
@@ -109,7 +111,7 @@ m_config(config)
 
 JSONFeedbackControl::~JSONFeedbackControl()
 {
-    delete nn;
+    delete m_pFeedbackNets;
 }
 
 void JSONFeedbackControl::onSetup(BaseSpineModelLearning& subject)
@@ -152,9 +154,10 @@ void JSONFeedbackControl::onSetup(BaseSpineModelLearning& subject)
     
     std::string nnFile = controlFilePath + feedbackParams.get("neuralFilename", "UTF-8").asString();
     
-    nn = new neuralNetwork(m_config.numStates, m_config.numStates*2, m_config.numActions);
+    delete m_pFeedbackNets;
+    m_pFeedbackNets = new NeuralNetBatch(m_config.numStates, m_config.numStates*2, m_config.numActions);
     
-    nn->loadWeights(nnFile.c_str());
+    m_pFeedbackNets->addNetwork(nnFile);
     
     initConditions = subject.getSegmentCOM(m_config.segmentNumber);
     for (int i = 0; i < initConditions.size(); i++)
@@ -171,6 +174,8 @@ void JSONFeedbackControl::onSetup(BaseSpineModelLearning& subject)
 #endif    
     m_updateTime = 0.0;
     bogus = false;
+    // The cables are new, so look them up in the frame again
+    m_frameIndex.clear();
 }
 
 void JSONFeedbackControl::onStep(BaseSpineModelLearning& subject, double dt)
@@ -210,9 +215,9 @@ void JSONFeedbackControl::onStep(BaseSpineModelLearning& subject, double dt)
     /// @todo add to config
     if (currentHeight > 25 || currentHeight < 1.0)
     {
-		/// @todo if bogus, stop trial (reset simulation)
+		// No point running the rest of the episode
 		bogus = true;
-		throw std::runtime_error("Height out of range");
+		subject.requestStop();
 	}
 }
 
@@ -390,40 +395,68 @@ array_2D JSONFeedbackControl::scaleNodeActions (Json::Value actions)
 
 std::vector<double> JSONFeedbackControl::getFeedback(BaseSpineModelLearning& subject)
 {
-    // Placeholder
-    std::vector<double> feedback;
-    
     const std::vector<tgSpringCableActuator*>& allCables = subject.getAllMuscles();
     
-    double *inputs = new double[m_config.numStates];
+    const std::size_t numStates = m_config.numStates;
+    const std::size_t numActions = m_config.numActions;
     
     std::size_t n = allCables.size();
-    for(std::size_t i = 0; i != n; i++)
+    std::vector<double> feedback(n * numActions);
+    
+    const tgStateFrame* const pFrame = subject.getStateFrame();
+    if (pFrame != NULL && numStates == tgStateFrame::cableFeatures)
     {
-        std::vector< std::vector<double> > actions;
-        
-        const tgSpringCableActuator& cable = *(allCables[i]);
-        std::vector<double > state = getCableState(cable);
-        
-        // Rescale to 0 to 1 (consider doing this inside getState
-        for (std::size_t i = 0; i < state.size(); i++)
+        // The frame's features are already the network's inputs, so
+        // every cable of the model goes through in place
+        if (m_frameIndex.size() != n)
         {
-            inputs[i]=state[i] / 2.0 + 0.5;
+            m_frameIndex.resize(n);
+            for(std::size_t i = 0; i != n; i++)
+            {
+                m_frameIndex[i] = pFrame->indexOf(allCables[i]);
+            }
         }
-        
-        double *output = nn->feedForwardPattern(inputs);
-        vector<double> tmpAct;
-        for(int j=0;j<m_config.numActions;j++)
+        const std::size_t m = pFrame->getCables().size();
+        m_nnOutputs.resize(m * numActions);
+        if (m > 0)
         {
-            tmpAct.push_back(output[j]);
+            m_pFeedbackNets->evaluate(0, pFrame->getCableFeatures(), m, &m_nnOutputs[0]);
+        }
+    }
+    else
+    {
+        m_frameIndex.resize(n);
+        m_nnInputs.assign(n * numStates, 0.0);
+        m_nnOutputs.resize(n * numActions);
+        for(std::size_t i = 0; i != n; i++)
+        {
+            m_frameIndex[i] = i;
+            const tgSpringCableActuator& cable = *(allCables[i]);
+            std::vector<double > state = getCableState(cable);
+            
+            // Rescale to 0 to 1 (consider doing this inside getState
+            for (std::size_t j = 0; j < state.size(); j++)
+            {
+                m_nnInputs[i * numStates + j] = state[j] / 2.0 + 0.5;
+            }
         }
-        actions.push_back(tmpAct);
-
-        std::vector<double> cableFeedback = transformFeedbackActions(actions);
         
-        feedback.insert(feedback.end(), cableFeedback.begin(), cableFeedback.end());
+        // Every cable goes through the network in one pass
+        if (n > 0)
+        {
+            m_pFeedbackNets->evaluate(0, &m_nnInputs[0], n, &m_nnOutputs[0]);
+        }
     }
     
+    // Scale values back to -1 to +1, straight into the commands
+    for(std::size_t i = 0; i != n; i++)
+    {
+        const double* output = &m_nnOutputs[m_frameIndex[i] * numActions];
+        for (std::size_t j = 0; j < numActions; j++)
+        {
+            feedback[i * numActions + j] = output[j] * 2.0 - 1.0;
+        }
+    }
     
     return feedback;
 }
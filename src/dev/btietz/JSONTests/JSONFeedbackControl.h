@@ -32,7 +32,7 @@
 #include <json/value.h>
 
 // Forward Declarations
-class neuralNetwork;
+class NeuralNetBatch;
 class tgSpringCableActuator;
 
 /**
@@ -117,8 +117,18 @@ protected:
     
     JSONFeedbackControl::Config m_config;
     
-    /// @todo generalize this if we need more than one
-    neuralNetwork* nn;
+    /**
+     * The feedback network, evaluated for every cable at once.
+     * @todo generalize this if we need more than one
+     */
+    NeuralNetBatch* m_pFeedbackNets;
+    
+    /** Per cable network inputs and outputs, kept between steps */
+    std::vector<double> m_nnInputs;
+    std::vector<double> m_nnOutputs;
+    
+    /** The row of m_nnOutputs of each muscle */
+    std::vector<std::size_t> m_frameIndex;
     
 };
 
@@ -27,21 +27,34 @@
 
 #include "AppSpineControl.h"
 #include "dev/btietz/JSONTests/tgCPGJSONLogger.h"
+#include "helpers/WorkerProtocol.h"
+#include "core/tgSettledCondition.h"
+
+#include <stdexcept>
 
 AppSpineControl::AppSpineControl(int argc, char** argv)
 {
     bSetup = false;
+    world = NULL;
+    view = NULL;
+    simulation = NULL;
+    control = NULL;
     use_graphics = false;
     add_controller = true;
     add_blocks = false;
     add_hills = false;
     all_terrain = false;
+    worker_mode = false;
     timestep_physics = 1.0f/1000.0f;
     timestep_graphics = 1.0f/60.0f;
     nEpisodes = 1;
     nSteps = 60000;
     nSegments = 7;
     nTypes = 3;
+    timeLimit = 0.0;
+    settleSpeed = 0.0;
+    settleTime = 2.0;
+    settled = NULL;
 
     startX = 0;
     startY = 20; //May need adjustment
@@ -67,6 +80,14 @@ bool AppSpineControl::setup()
 
     // Third create the simulation
     simulation = new tgSimulation(*view);
+    
+    // Budgets of each episode, checked inside the run
+    simulation->setWallClockLimit(timeLimit);
+    if (settleSpeed > 0.0)
+    {
+        settled = new tgSettledCondition(settleSpeed, settleTime);
+        simulation->setStopCondition(settled);
+    }
 
     // Fourth create the models with their controllers and add the models to the
     // simulation
@@ -138,9 +159,10 @@ bool AppSpineControl::setup()
                                                     pfMax,
 						    maxH,
 						    minH);
-        /// @todo fix memory leak that occurs here
+        // Deleted by cleanup(), after the simulation's teardown
        JSONQuadFeedbackControl* const myControl =
         new JSONQuadFeedbackControl(control_config, suffix, lowerPath);
+        control = myControl;
 
 #if (0)        
             tgCPGJSONLogger* const myLogger = 
@@ -187,6 +209,10 @@ void AppSpineControl::handleOptions(int argc, char **argv)
         ("goal_angle,B", po::value<double>(&goalAngle), "Angle of starting rotation for goal box. Degrees. Default = 0")
         ("learning_controller,l", po::value<std::string>(&suffix), "Which learned controller to write to or use. Default = default")
 	("lower_path,P", po::value<std::string>(&lowerPath), "Which resources folder in which you want to store controllers. Default = default")
+        ("time_limit,T", po::value<double>(&timeLimit), "Wall clock seconds an episode may take before it is ended. Default=0, no limit")
+        ("settle_speed", po::value<double>(&settleSpeed), "End an episode once no body moves faster than this for settle_time seconds. Default=0, off")
+        ("settle_time", po::value<double>(&settleTime), "Seconds of simulation time every body must be slower than settle_speed. Default=2")
+        ("worker,w", po::bool_switch(&worker_mode), "Run the trials read from stdin until it closes, see helpers/WorkerProtocol.h. Implies no graphics")
     ;
 
     po::variables_map vm;
@@ -263,20 +289,21 @@ tgWorld* AppSpineControl::createWorld()
         981 // gravity, cm/sec^2
     );
     
-    tgBulletGround* ground;
-    
+    return new tgWorld(config, createGround());
+}
+
+tgBulletGround* AppSpineControl::createGround()
+{
     if (add_hills)
     {
         const tgHillyGround::Config hillGroundConfig = getHillyConfig();
-        ground = new tgHillyGround(hillGroundConfig);
+        return new tgHillyGround(hillGroundConfig);
     }
     else
     {
         const tgBoxGround::Config groundConfig = getBoxConfig();
-        ground = new tgBoxGround(groundConfig);
+        return new tgBoxGround(groundConfig);
     }
-    
-    return new tgWorld(config, ground);
 }
 
 tgSimViewGraphics *AppSpineControl::createGraphicsView(tgWorld *world)
@@ -307,14 +334,94 @@ bool AppSpineControl::run()
         simulate(simulation);
     }
     
-    ///@todo consider app.cleanup()
-   delete simulation;
-   delete view;
-   delete world;
+    cleanup();
     
     return true;
 }
 
+bool AppSpineControl::serve(std::istream& input, std::ostream& output)
+{
+    use_graphics = false;
+    
+    bool succeeded = true;
+    std::vector<WorkerJob> jobs;
+    while (WorkerProtocol::readJobs(input, jobs))
+    {
+        try
+        {
+            sweep(jobs);
+            cleanup();
+            WorkerProtocol::writeDone(output, jobs[0]);
+        }
+        catch (std::exception& e)
+        {
+            cleanup();
+            WorkerProtocol::writeFail(output, jobs[0], e.what());
+            succeeded = false;
+        }
+    }
+    
+    return succeeded;
+}
+
+void AppSpineControl::sweep(const std::vector<WorkerJob>& jobs)
+{
+    for (std::size_t i = 0; i < jobs.size(); i++)
+    {
+        const bool hills = add_hills;
+        applyJob(jobs[i]);
+        
+        if (i == 0)
+        {
+            setup();
+        }
+        else
+        {
+            // Keep the model and controller, only swap what changed
+            if (add_hills != hills)
+            {
+                simulation->reset(createGround());
+            }
+            else
+            {
+                simulation->reset();
+            }
+            if (add_blocks)
+            {
+                simulation->addObstacle(getBlocks());
+            }
+        }
+        simulate(simulation);
+    }
+}
+
+void AppSpineControl::applyJob(const WorkerJob& job)
+{
+    suffix = job.filename;
+    lowerPath = job.path;
+    nSteps = job.steps;
+    add_blocks = job.blocks;
+    add_hills = job.hills;
+    startAngle = job.angle;
+    goalAngle = job.goalAngle;
+}
+
+void AppSpineControl::cleanup()
+{
+    delete simulation;
+    simulation = NULL;
+    delete view;
+    view = NULL;
+    delete world;
+    world = NULL;
+    delete control;
+    control = NULL;
+    delete settled;
+    settled = NULL;
+    
+    bSetup = false;
+}
+
 void AppSpineControl::simulate(tgSimulation *simulation)
 {
     for (int i=0; i<nEpisodes; i++) {
@@ -322,6 +429,11 @@ void AppSpineControl::simulate(tgSimulation *simulation)
         try
         {
             simulation->run(nSteps);
+            if (simulation->isStopped())
+            {
+                fprintf(stderr, "Episode %d ended early: %s\n", i,
+                        tgSimulation::stopReasonName(simulation->getStopReason()));
+            }
         }
         catch (std::runtime_error e)
         {
@@ -374,7 +486,9 @@ int main(int argc, char** argv)
     std::cout << "AppSpineControl" << std::endl;
     AppSpineControl app (argc, argv);
 
-    if (app.setup())
+    if (app.isWorker())
+        return app.serve(std::cin, std::cout) ? 0 : 1;
+    else if (app.setup())
         app.run();
     
     //Teardown is handled by delete, so that should be automatic
@@ -50,6 +50,10 @@
 // The C++ Standard Library
 #include <iostream>
 #include <string>
+#include <vector>
+
+class tgSettledCondition;
+struct WorkerJob;
 
 namespace po = boost::program_options;
 
@@ -62,6 +66,14 @@ public:
     bool setup();
     /** Run the simulation */
     bool run();
+    /**
+     * Run the trials read from input until it ends, replying on output.
+     * Selected with --worker, see helpers/WorkerProtocol.h
+     * @return false if any request failed
+     */
+    bool serve(std::istream& input, std::ostream& output);
+    
+    bool isWorker() const { return worker_mode; }
 
 private:
     /** Parse command line options */
@@ -75,6 +87,9 @@ private:
     
     /** Create the tgWorld object */
     tgWorld *createWorld();
+    
+    /** Create the ground add_hills asks for */
+    tgBulletGround* createGround();
 
     /** Use for displaying tensegrities in simulation */
     tgSimViewGraphics *createGraphicsView(tgWorld *world);
@@ -85,23 +100,42 @@ private:
     /** Run a series of episodes for nSteps each */
     void simulate(tgSimulation *simulation);
     
+    /**
+     * Run the jobs of one request on a single model and controller,
+     * resetting the simulation to the next job's terrain between them
+     */
+    void sweep(const std::vector<WorkerJob>& jobs);
+    
+    /** Take the trial options of a worker job */
+    void applyJob(const WorkerJob& job);
+    
+    /** Delete the simulation, so the controller writes its scores */
+    void cleanup();
+    
     
     // Keep these around for cleanup
     tgWorld* world;
     tgSimView* view;
     tgSimulation* simulation;
+    JSONQuadFeedbackControl* control;
 
     bool use_graphics;
     bool add_controller;
     bool add_blocks;
     bool add_hills;
     bool all_terrain;
+    bool worker_mode;
     double timestep_physics; //Seconds
     double timestep_graphics; // Seconds, AKA render rate. Leave at 1/60 for real-time viewing
     int nEpisodes; // Number of episodes ("trial runs")
     int nSteps; // Number of steps in each episode, 60k is 100 seconds (timestep_physics*nSteps)
     int nSegments; // Number of segments in the tensegrity spine
     int nTypes; // Number of types of terrain to be used. Currently 3
+    double timeLimit; // Wall clock seconds per episode, 0 for none
+    double settleSpeed; // Ends an episode once every body is slower, 0 for off
+    double settleTime; // Seconds every body must be slower than settleSpeed
+    /** Given to the simulation when settleSpeed is set, deleted by cleanup() */
+    tgSettledCondition* settled;
 
     double startX;
     double startY;
@@ -39,6 +39,7 @@
 #include "examples/learningSpines/BaseSpineCPGControl.h"
 
 #include "helpers/FileHelpers.h"
+#include "helpers/ParameterBlob.h"
 
 #include "util/CPGEquations.h"
 #include "util/CPGNode.h"
@@ -166,29 +167,47 @@ void JSONQuadCPGControl::onSetup(BaseQuadModelLearning& subject)
 	m_pCPGSys = new CPGEquations(200);
     //Initialize the Learning Adapters
 
-    Json::Value root; // will contains the root value after parsing.
-    Json::Reader reader;
-
-    bool parsingSuccessful = reader.parse( FileHelpers::getFileString(controlFilename.c_str()), root );
-    if ( !parsingSuccessful )
+    if (ParameterBlob::isBlob(controlFilename))
     {
-        // report to the user the failure and their locations in the document.
-        std::cout << "Failed to parse configuration\n"
-            << reader.getFormattedErrorMessages();
-        throw std::invalid_argument("Bad filename for JSON");
+        // Written by jsonToBlob.py, loads without parsing
+        ParameterBlob blob;
+        blob.load(controlFilename);
+        
+        std::size_t rows;
+        std::size_t cols;
+        const double* edgeVals = blob.get("edgeVals/params", rows, cols);
+        array_4D edgeParams = scaleEdgeActions(edgeVals, rows, cols);
+        const double* nodeVals = blob.get("nodeVals/params", rows, cols);
+        array_2D nodeParams = scaleNodeActions(nodeVals, rows, cols);
+        
+        setupCPGs(subject, nodeParams, edgeParams);
     }
-    // Get the value of the member of root named 'encoding', return 'UTF-8' if there is no
-    // such member.
-    Json::Value nodeVals = root.get("nodeVals", "UTF-8");
-    Json::Value edgeVals = root.get("edgeVals", "UTF-8");
+    else
+    {
+        Json::Value root; // will contains the root value after parsing.
+        Json::Reader reader;
+
+        bool parsingSuccessful = reader.parse( FileHelpers::getFileString(controlFilename.c_str()), root );
+        if ( !parsingSuccessful )
+        {
+            // report to the user the failure and their locations in the document.
+            std::cout << "Failed to parse configuration\n"
+                << reader.getFormattedErrorMessages();
+            throw std::invalid_argument("Bad filename for JSON");
+        }
+        // Get the value of the member of root named 'encoding', return 'UTF-8' if there is no
+        // such member.
+        Json::Value nodeVals = root.get("nodeVals", "UTF-8");
+        Json::Value edgeVals = root.get("edgeVals", "UTF-8");
     
-    nodeVals = nodeVals.get("params", "UTF-8");
-    edgeVals = edgeVals.get("params", "UTF-8");
+        nodeVals = nodeVals.get("params", "UTF-8");
+        edgeVals = edgeVals.get("params", "UTF-8");
     
-    array_4D edgeParams = scaleEdgeActions(edgeVals);
-    array_2D nodeParams = scaleNodeActions(nodeVals);
+        array_4D edgeParams = scaleEdgeActions(edgeVals);
+        array_2D nodeParams = scaleNodeActions(nodeVals);
     
-    setupCPGs(subject, nodeParams, edgeParams);
+        setupCPGs(subject, nodeParams, edgeParams);
+    }
     
     initConditions = subject.getSegmentCOM(m_config.segmentNumber);
 #ifdef LOGGING // Conditional compile for data logging    
@@ -330,10 +349,16 @@ void JSONQuadCPGControl::onTeardown(BaseQuadModelLearning& subject)
     
         std::cout << "Dist travelled " << scores[0] << std::endl;
     
+    // A blob can't hold scores, they go to a JSON file beside it
+    const std::string scoresFilename = ParameterBlob::isBlob(controlFilename) ?
+                                        controlFilename + ".json" :
+                                        controlFilename;
+    
     Json::Value root; // will contains the root value after parsing.
     Json::Reader reader;
-
-    bool parsingSuccessful = reader.parse( FileHelpers::getFileString(controlFilename.c_str()), root );
+    
+    const std::string scoresString = FileHelpers::getFileString(scoresFilename.c_str());
+    bool parsingSuccessful = scoresString.empty() || reader.parse( scoresString, root );
     if ( !parsingSuccessful )
     {
         // report to the user the failure and their locations in the document.
@@ -352,7 +377,7 @@ void JSONQuadCPGControl::onTeardown(BaseQuadModelLearning& subject)
     root["scores"] = prevScores;
     
     ofstream payloadLog;
-    payloadLog.open(controlFilename.c_str(),ofstream::out);
+    payloadLog.open(scoresFilename.c_str(),ofstream::out);
     
     payloadLog << root << std::endl;
     
@@ -390,6 +415,26 @@ array_4D JSONQuadCPGControl::scaleEdgeActions
 {
     assert(edgeParam[0].size() == 2);
     
+    std::vector<double> params;
+    params.reserve(edgeParam.size() * 2);
+    for (Json::Value::iterator edgeIt = edgeParam.begin(); edgeIt != edgeParam.end(); edgeIt++)
+    {
+        Json::Value edge = *edgeIt;
+        assert(edge.size() == 2);
+        params.push_back(edge[0].asDouble());
+        params.push_back(edge[1].asDouble());
+    }
+    
+    return scaleEdgeActions(params.empty() ? NULL : &params[0], edgeParam.size(), 2);
+}
+
+array_4D JSONQuadCPGControl::scaleEdgeActions  
+                            (const double* edgeParam,
+                            std::size_t rows,
+                            std::size_t cols)
+{
+    assert(cols == 2);
+    
     double lowerLimit = m_config.lowPhase;
     double upperLimit = m_config.highPhase;
     double range = upperLimit - lowerLimit;
@@ -410,7 +455,7 @@ array_4D JSONQuadCPGControl::scaleEdgeActions
     int k = 0;
     
     // Quirk of the old learning code. Future examples can move forward
-    Json::Value::iterator edgeIt = edgeParam.end();
+    std::size_t edgeIt = rows;
     
     int count = 0;
     
@@ -420,7 +465,7 @@ array_4D JSONQuadCPGControl::scaleEdgeActions
         {
             while(k < m_config.ourMuscles)
             {
-                if (edgeIt == edgeParam.begin())
+                if (edgeIt == 0)
                 {
                     std::cout << "ran out before table populated!"
                     << std::endl;
@@ -437,13 +482,12 @@ array_4D JSONQuadCPGControl::scaleEdgeActions
                     else
                     {
                         edgeIt--;
-                        Json::Value edgeParam = *edgeIt;
-                        assert(edgeParam.size() == 2);
+                        const double* const edge = edgeParam + edgeIt * cols;
                         // Weight from 0 to 1
-                        actionList[i][j][k][0] = edgeParam[0].asDouble();
+                        actionList[i][j][k][0] = edge[0];
                         //std::cout << actionList[i][j][k][0] << " ";
                         // Phase offset from -pi to pi
-                        actionList[i][j][k][1] = edgeParam[1].asDouble() * 
+                        actionList[i][j][k][1] = edge[1] * 
                                                 (range) + lowerLimit;
                         //std::cout <<  actionList[i][j][k][1] << std::endl;
                         count++;
@@ -462,16 +506,40 @@ array_4D JSONQuadCPGControl::scaleEdgeActions
     
     std::cout<< "Params used: " << count << std::endl;
     
-    assert(edgeParam.begin() == edgeIt);
+    assert(edgeIt == 0);
     
     return actionList;
 }
+
 array_2D JSONQuadCPGControl::scaleNodeActions  
                             (Json::Value actions)
 {
     std::size_t numControllers = actions.size();
     std::size_t numActions = actions[0].size();
     
+    std::vector<double> params;
+    params.reserve(numControllers * numActions);
+    
+    Json::Value::iterator nodeIt = actions.begin();
+    
+    for( std::size_t i = 0; i < numControllers; i++)
+    {
+        Json::Value nodeParam = *nodeIt;
+        for( std::size_t j = 0; j < numActions; j++)
+        {
+            params.push_back((nodeParam.get(j, 0.0)).asDouble());
+        }
+        nodeIt++;
+    }
+    
+    return scaleNodeActions(params.empty() ? NULL : &params[0], numControllers, numActions);
+}
+
+array_2D JSONQuadCPGControl::scaleNodeActions  
+                            (const double* actions,
+                            std::size_t numControllers,
+                            std::size_t numActions)
+{
     array_2D nodeActions(boost::extents[numControllers][numActions]);
     
     array_2D limits(boost::extents[2][numActions]);
@@ -484,18 +552,15 @@ array_2D JSONQuadCPGControl::scaleNodeActions
 	limits[0][1] = m_config.lowAmp;
 	limits[1][1] = m_config.highAmp;
     
-    Json::Value::iterator nodeIt = actions.begin();
-    
     // This one is square
     for( std::size_t i = 0; i < numControllers; i++)
     {
-        Json::Value nodeParam = *nodeIt;
+        const double* const nodeParam = actions + i * numActions;
         for( std::size_t j = 0; j < numActions; j++)
         {
-            nodeActions[i][j] = ( (nodeParam.get(j, 0.0)).asDouble() *  
+            nodeActions[i][j] = ( nodeParam[j] *  
                     (limits[1][j] - limits[0][j])) + limits[0][j];
         }
-        nodeIt++;
     }
     
     return nodeActions;
@@ -138,6 +138,17 @@ protected:
     virtual array_4D scaleEdgeActions (Json::Value edgeParam);
     virtual array_2D scaleNodeActions (Json::Value actions);
     
+    /**
+     * The same from rows of a ParameterBlob section, so blobs skip
+     * building Json::Values. The Json::Value versions call these.
+     */
+    array_4D scaleEdgeActions (const double* edgeParam,
+                                std::size_t rows,
+                                std::size_t cols);
+    array_2D scaleNodeActions (const double* actions,
+                                std::size_t numControllers,
+                                std::size_t numActions);
+    
     virtual void setupCPGs(BaseQuadModelLearning& subject, array_2D nodeActions, array_4D edgeActions);
 
     CPGEquations* m_pCPGSys;
@@ -105,7 +105,9 @@ JSONQuadFeedbackControl::JSONQuadFeedbackControl(JSONQuadFeedbackControl::Config
                                                 std::string args,
                                                 std::string resourcePath) :
 JSONCPGControl(config, args, resourcePath),
-m_config(config)
+m_config(config),
+nn(NULL),
+m_loaded(false)
 {
     // Path and filename handled by base class
     
@@ -120,17 +122,9 @@ void JSONQuadFeedbackControl::onSetup(BaseSpineModelLearning& subject)
 {
 	m_pCPGSys = new CPGEquationsFB(100);
 
-    Json::Value root; // will contains the root value after parsing.
-    Json::Reader reader;
-
-    bool parsingSuccessful = reader.parse( FileHelpers::getFileString(controlFilename.c_str()), root );
-    if ( !parsingSuccessful )
-    {
-        // report to the user the failure and their locations in the document.
-        std::cout << "Failed to parse configuration\n"
-            << reader.getFormattedErrorMessages();
-        throw std::invalid_argument("Bad filename for JSON");
-    }
+    loadParameters();
+    const Json::Value& root = m_root;
+    
     // Get the value of the member of root named 'encoding', return 'UTF-8' if there is no
     // such member.
     Json::Value nodeVals = root.get("nodeVals", "UTF-8");
@@ -156,9 +150,13 @@ void JSONQuadFeedbackControl::onSetup(BaseSpineModelLearning& subject)
     
     std::string nnFile = controlFilePath + feedbackParams.get("neuralFilename", "UTF-8").asString();
     
-    nn = new neuralNetwork(m_config.numStates, m_config.numStates*2, m_config.numActions);
-    
-    nn->loadWeights(nnFile.c_str());
+    // The weights don't change between resets
+    if (nn == NULL)
+    {
+        nn = new neuralNetwork(m_config.numStates, m_config.numStates*2, m_config.numActions);
+        
+        nn->loadWeights(nnFile.c_str());
+    }
     
     initConditions = subject.getSegmentCOM(m_config.segmentNumber);
     for (int i = 0; i < initConditions.size(); i++)
@@ -214,9 +212,9 @@ void JSONQuadFeedbackControl::onStep(BaseSpineModelLearning& subject, double dt)
     /// Max and min heights added to config
     if (currentHeight > m_config.maxHeight || currentHeight < m_config.minHeight)
     {
-		/// @todo if bogus, stop trial (reset simulation)
+		// No point running the rest of the episode
 		bogus = true;
-		throw std::runtime_error("Height out of range");
+		subject.requestStop();
 	}
 }
 
@@ -272,17 +270,8 @@ void JSONQuadFeedbackControl::onTeardown(BaseSpineModelLearning& subject)
     
     std::cout << "Dist travelled " << scores[0] << std::endl;
     
-    Json::Value root; // will contains the root value after parsing.
-    Json::Reader reader;
-
-    bool parsingSuccessful = reader.parse( FileHelpers::getFileString(controlFilename.c_str()), root );
-    if ( !parsingSuccessful )
-    {
-        // report to the user the failure and their locations in the document.
-        std::cout << "Failed to parse configuration\n"
-            << reader.getFormattedErrorMessages();
-        throw std::invalid_argument("Bad filename for JSON");
-    }
+    loadParameters();
+    Json::Value& root = m_root;
     
     Json::Value prevScores = root.get("scores", Json::nullValue);
     
@@ -308,6 +297,26 @@ void JSONQuadFeedbackControl::onTeardown(BaseSpineModelLearning& subject)
     m_spineControllers.clear();    
 }
 
+void JSONQuadFeedbackControl::loadParameters()
+{
+    if (m_loaded)
+    {
+        return;
+    }
+    
+    Json::Reader reader;
+
+    bool parsingSuccessful = reader.parse( FileHelpers::getFileString(controlFilename.c_str()), m_root );
+    if ( !parsingSuccessful )
+    {
+        // report to the user the failure and their locations in the document.
+        std::cout << "Failed to parse configuration\n"
+            << reader.getFormattedErrorMessages();
+        throw std::invalid_argument("Bad filename for JSON");
+    }
+    m_loaded = true;
+}
+
 void JSONQuadFeedbackControl::setupCPGs(BaseSpineModelLearning& subject, array_2D nodeActions, array_4D edgeActions)
 {
 	    
@@ -112,6 +112,14 @@ protected:
 
     virtual void setupCPGs(BaseSpineModelLearning& subject, array_2D nodeActions, array_4D edgeActions);
     
+    /**
+     * Parse the parameter file into m_root, once per controller. A
+     * simulation reset to a new terrain reuses it, and onTeardown adds
+     * its scores to it before writing it back.
+     * @throw std::invalid_argument if the file can't be parsed
+     */
+    void loadParameters();
+    
     virtual array_2D scaleNodeActions (Json::Value actions);
     
     std::vector<double> getFeedback(BaseSpineModelLearning& subject);
@@ -127,6 +135,11 @@ protected:
     /// @todo generalize this if we need more than one
     neuralNetwork* nn;
     
+    /** The parameter file, with the scores written so far */
+    Json::Value m_root;
+    
+    bool m_loaded;
+    
 };
 
 #endif // JSON_QUAD_FEEDBACK_CONTROL_H
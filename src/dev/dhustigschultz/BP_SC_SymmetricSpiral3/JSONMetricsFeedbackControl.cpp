@@ -52,6 +52,7 @@
 
 #include <string>
 #include <iostream>
+#include <sstream>
 #include <vector>
 
 //#define LOGGING
@@ -209,10 +210,18 @@ void JSONMetricsFeedbackControl::onSetup(BaseQuadModelLearning& subject)
 #ifdef PRINT_METRICS
     //Just so we know how many vector rows we need:
     std::vector<tgSpringCableActuator* > tmpStrings = subject.find<tgSpringCableActuator> ("spine ");
-    //Add the rows:
+    //Add the columns: time, then the tensions, then the lengths
+    m_metrics = tgMetricsStore();
+    m_metrics.addColumn("time");
     for(std::size_t i=0; i<tmpStrings.size(); i++){
-	m_muscleTensionsAll.push_back(vector <double> ());
-        m_muscleLengthsAll.push_back(vector <double> ());
+	std::ostringstream name;
+	name << "tension " << i;
+	m_metrics.addColumn(name.str());
+    }
+    for(std::size_t i=0; i<tmpStrings.size(); i++){
+	std::ostringstream name;
+	name << "length " << i;
+	m_metrics.addColumn(name.str());
     }
 #endif
 }
@@ -264,7 +273,7 @@ void JSONMetricsFeedbackControl::onStep(BaseQuadModelLearning& subject, double d
 #ifdef PRINT_METRICS
     static int count = 0;
     if(count > 100) {
-	m_timeStep.push_back(m_totalTime);
+	m_metrics.append(0, m_totalTime);
 
 	//Getting the center of mass of the entire structure:
 	std::vector<double> structureCOM = subject.getCOM(m_config.segmentNumber);
@@ -277,14 +286,14 @@ void JSONMetricsFeedbackControl::onStep(BaseQuadModelLearning& subject, double d
 	for(std::size_t i=0; i<tmpStrings.size(); i++)
 	{
 	    double tension = tmpStrings[i]->getTension();
-            m_muscleTensionsAll.at(i).push_back(tension);
+            m_metrics.append(1 + i, tension);
 	}
 
 	//The lengths of all active muscles during this timestep
 	for(std::size_t i=0; i<tmpStrings.size(); i++)
 	{
 	    double length = tmpStrings[i]->getCurrentLength();
-            m_muscleLengthsAll.at(i).push_back(length);
+            m_metrics.append(1 + tmpStrings.size() + i, length);
 	}
 
 	count = 0;
@@ -582,25 +591,13 @@ void JSONMetricsFeedbackControl::printMetrics(BaseQuadModelLearning& subject){
     }
     cout << endl;
 
-    //Printing the timesteps for which metrics were gathered: 
-    for (int i = 0; i < m_timeStep.size(); ++i) {
-        cout << m_timeStep[i] << ",";
-    }
-    cout << endl;
-
-    //Printing the tensions of each muscle:
-    for (int i = 0; i < m_muscleTensionsAll.size(); i++){
-	for(int j = 0; j < m_muscleTensionsAll[i].size(); j++){
-	    cout << m_muscleTensionsAll[i][j] << ",";
+    //Printing the timesteps for which metrics were gathered, then the
+    //tensions and the lengths of each muscle, one column per line:
+    for (std::size_t c = 0; c < m_metrics.columns(); c++){
+	const std::vector<double>& values = m_metrics.getValues(c);
+	for(std::size_t j = 0; j < values.size(); j++){
+	    cout << values[j] << ",";
 	}
 	cout << endl;
     }
-
-    //Printing the lengths of each muscle:
-    for (int i = 0; i < m_muscleLengthsAll.size(); i++){
-	for(int j = 0; j < m_muscleLengthsAll[i].size(); j++){
-	    cout << m_muscleLengthsAll[i][j] << ",";
-	}
-	cout << endl;
-    }   
 }
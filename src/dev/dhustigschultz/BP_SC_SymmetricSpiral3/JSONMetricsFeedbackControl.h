@@ -29,6 +29,7 @@
  */
 
 #include "dev/dhustigschultz/BP_SC_NoLegs_Stats/JSONQuadCPGControl.h"
+#include "util/tgMetricsStore.h"
 
 #include <json/value.h>
 
@@ -239,11 +240,11 @@ protected:
     std::vector<double> m_muscleLengthFifty;
     std::vector<double> m_muscleLengthFiftyOne;
 
-    std::vector< std::vector<double> > m_muscleTensionsAll;
-    std::vector< std::vector<double> > m_muscleLengthsAll; 
+    // The time, then the tension of each spine muscle, then the length
+    // of each, every 100 steps
+    tgMetricsStore m_metrics;
 
     std::vector< std::vector<double> > m_quadCOM;
-    std::vector<double> m_timeStep;
 
     std::vector<double> m_tensions;
     std::vector<double> m_lengths;
@@ -33,6 +33,7 @@
 #include "tgcreator/tgPairs.h"
 // The NTRT Core Libary
 #include "core/tgBulletUtil.h"
+#include "core/tgGhostFilter.h"
 #include "core/tgTagSearch.h"
 #include "tgcreator/tgUtil.h"
 #include "core/tgBulletUtil.h"
@@ -95,8 +96,8 @@ void tgGhostInfo::initRigidBody(tgWorld& world)
 			ghostObject->setWorldTransform(transform);
 			ghostObject->setCollisionFlags (btCollisionObject::CF_NO_CONTACT_RESPONSE);
 			
-			// @todo look up what the second and third arguments of this are
-			m_dynamicsWorld.addCollisionObject(ghostObject,btBroadphaseProxy::CharacterFilter, btBroadphaseProxy::StaticFilter|btBroadphaseProxy::DefaultFilter);
+			// In the muscle ghosts' own filter group, see tgGhostFilter
+			tgGhostFilter::addGhost(m_dynamicsWorld, ghostObject);
 			
 			rigid->setCollisionObject(ghostObject);
 		}
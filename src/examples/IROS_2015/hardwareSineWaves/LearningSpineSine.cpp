@@ -129,20 +129,8 @@ void LearningSpineSine::onTeardown(BaseSpineModelLearning& subject)
     vector<tgBasicActuator* > tmpStrings = tgCast::filter<tgSpringCableActuator, tgBasicActuator>(tmpSCAs);
     for(std::size_t i=0; i<tmpStrings.size(); i++)
     {
-        tgSpringCableActuator::SpringCableActuatorHistory stringHist = tmpStrings[i]->getHistory();
-        
-        for(std::size_t j=1; j<stringHist.tensionHistory.size(); j++)
-        {
-            const double previousTension = stringHist.tensionHistory[j-1];
-            const double previousLength = stringHist.restLengths[j-1];
-            const double currentLength = stringHist.restLengths[j];
-            //TODO: examine this assumption - free spinning motor may require more power
-            double motorSpeed = (currentLength-previousLength);
-            if(motorSpeed > 0) // Vestigial code
-                motorSpeed = 0;
-            const double workDone = previousTension * motorSpeed;
-            totalEnergySpent += workDone;
-        }
+        // Negative, as the work is done shortening the cable
+        totalEnergySpent -= tmpStrings[i]->getHistory().energySpent;
     }
     
     scores.push_back(totalEnergySpent);
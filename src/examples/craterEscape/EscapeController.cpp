@@ -30,6 +30,7 @@
 #include "EscapeModel.h"
 // This library
 #include "core/tgBasicActuator.h"
+#include "core/tgRandom.h"
 // For AnnealEvolution
 #include "learning/Configuration/configuration.h"
 #include "learning/AnnealEvolution/AnnealEvolution.h"
@@ -222,20 +223,8 @@ double EscapeController::totalEnergySpent(EscapeModel& subject) {
     std::vector<tgBasicActuator* > tmpStrings = subject.getAllMuscles();
     for(int i=0; i<tmpStrings.size(); i++)
     {
-        tgSpringCableActuator::SpringCableActuatorHistory stringHist = tmpStrings[i]->getHistory();
-
-        for(int j=1; j<stringHist.tensionHistory.size(); j++)
-        {
-            const double previousTension = stringHist.tensionHistory[j-1];
-            const double previousLength = stringHist.restLengths[j-1];
-            const double currentLength = stringHist.restLengths[j];
-            //TODO: examine this assumption - free spinning motor may require more power         
-            double motorSpeed = (currentLength-previousLength);
-            if(motorSpeed > 0) // Vestigial code
-                motorSpeed = 0;
-            const double workDone = previousTension * motorSpeed;
-            totalEnergySpent += workDone;
-        }
+        // Negative, as the work is done shortening the cable
+        totalEnergySpent -= tmpStrings[i]->getHistory().energySpent;
     }
     return totalEnergySpent;
 }
@@ -374,9 +363,10 @@ std::vector<double> EscapeController::readManualParams(int lineNumber, std::stri
     bool tweaking = false;
     if (tweaking) {
         // Tweak each read-in parameter by as much as 0.5% (params range: [0,1])
+        tgRandom noise(tgRandom::eNoise, lineNumber);
         for (int i=0; i < result.size(); i++) {
             std::cout<<"Entered Cell " << i << ": " << result[i] << "\n";
-            double seed = ((double) (rand() % 100)) / 100;
+            double seed = ((double) noise.below(100)) / 100;
             result[i] += (0.01 * seed) - 0.005; // Value +/- 0.005 of original
         }
     } else {
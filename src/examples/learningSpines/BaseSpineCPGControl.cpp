@@ -27,12 +27,15 @@
 #include "BaseSpineCPGControl.h"
 
 #include <string>
+#include <stdexcept>
 
 
 // Should include tgString, but compiler complains since its been
 // included from BaseSpineModelLearning. Perhaps we should move things
 // to a cpp over there
 #include "core/tgSpringCableActuator.h"
+#include "core/tgBasicActuator.h"
+#include "core/tgCast.h"
 #include "controllers/tgImpedanceController.h"
 #include "tgCPGActuatorControl.h"
 
@@ -64,13 +67,15 @@ BaseSpineCPGControl::Config::Config(int ss,
 										bool def,
 										double cl,
 										double lf,
-										double hf) :
+										double hf,
+										CPGEquations::Interpolation ci) :
 	segmentSpan(ss),
 	theirMuscles(tm),
 	ourMuscles(om),
 	params(param),
 	segmentNumber(segnum),
 	controlTime(ct),
+	cpgInterpolation(ci),
 	lowAmp(la),
 	highAmp(ha),
 	lowPhase(lp),
@@ -148,7 +153,8 @@ edgeLearning(false),
 m_dataObserver("logs/TCData"),
 m_pCPGSys(NULL),
 m_updateTime(0.0),
-bogus(false)
+bogus(false),
+m_reuseOnReset(false)
 {
 	std::string path;
 	if (resourcePath != "")
@@ -170,19 +176,24 @@ bogus(false)
 BaseSpineCPGControl::~BaseSpineCPGControl() 
 {
     scores.clear();
+    // Kept after the last teardown if reused
+    releaseCPGs();
 }
 
 void BaseSpineCPGControl::onSetup(BaseSpineModelLearning& subject)
 {
+    // Anything kept for a reset is rebuilt
+    releaseCPGs();
+    
     // Maximum number of sub-steps allowed by CPG
 	m_pCPGSys = new CPGEquations(200);
-    //Initialize the Learning Adapters
+	m_pCPGSys->setUpdatePeriod(m_config.controlTime, m_config.cpgInterpolation);
+    //Initialize the Learning Adapters, with the configurations the
+    // evolution objects parsed when they were constructed
     nodeAdapter.initialize(&nodeEvolution,
-                            nodeLearning,
-                            nodeConfigData);
+                            nodeLearning);
     edgeAdapter.initialize(&edgeEvolution,
-                            edgeLearning,
-                            edgeConfigData);
+                            edgeLearning);
     /* Empty vector signifying no state information
      * All parameters are stateless parameters, so we can get away with
      * only doing this once
@@ -207,6 +218,87 @@ void BaseSpineCPGControl::onSetup(BaseSpineModelLearning& subject)
     bogus = false;
 }
 
+void BaseSpineCPGControl::onReset(BaseSpineModelLearning& subject)
+{
+    if (!m_reuseOnReset || m_pCPGSys == NULL)
+    {
+        onSetup(subject);
+        return;
+    }
+    
+    // The next parameters, as in onSetup
+    nodeAdapter.initialize(&nodeEvolution,
+                            nodeLearning);
+    edgeAdapter.initialize(&edgeEvolution,
+                            edgeLearning);
+    std::vector<double> state;
+    double dt = 0;
+    
+    array_4D edgeParams = scaleEdgeActions(edgeAdapter.step(dt, state));
+    array_2D nodeParams = scaleNodeActions(nodeAdapter.step(dt, state));
+    
+    resetCPGs(subject, nodeParams, edgeParams);
+    
+    initConditions = subject.getSegmentCOM(m_config.segmentNumber);
+#ifdef LOGGING // Conditional compile for data logging    
+    m_dataObserver.onSetup(subject);
+#endif    
+    m_updateTime = 0.0;
+    bogus = false;
+}
+
+void BaseSpineCPGControl::resetCPGs(BaseSpineModelLearning& subject,
+                                    const array_2D& nodeActions,
+                                    const array_4D& edgeActions)
+{
+    // The model built new muscles and bodies, with the same topology
+    std::vector <tgSpringCableActuator*> allMuscles = subject.getAllMuscles();
+    if (allMuscles.size() != m_allControllers.size())
+    {
+        throw std::runtime_error("The muscles changed since setup");
+    }
+    
+    for (std::size_t i = 0; i < m_allControllers.size(); i++)
+    {
+        m_allControllers[i]->onAttach(*allMuscles[i]);
+        m_allControllers[i]->resetNodeParams(nodeActions);
+    }
+    
+    for (std::size_t i = 0; i < m_allControllers.size(); i++)
+    {
+        tgCPGActuatorControl * const pStringInfo = m_allControllers[i];
+        pStringInfo->resetConnectivity(m_allControllers, edgeActions);
+        
+        // The impedance controller's gains come from m_config, so it is
+        // kept; only the control length, reread by onAttach, is set again
+        if (!m_config.useDefault)
+        {
+            pStringInfo->updateControlLength(m_config.controlLength);
+        }
+        
+        tgBasicActuator* const pActuator =
+            tgCast::cast<tgSpringCableActuator, tgBasicActuator>(allMuscles[i]);
+        assert(pActuator != NULL);
+        m_actuatorBank.add(*pActuator, *pStringInfo);
+    }
+    
+    m_pCPGSys->restart();
+}
+
+void BaseSpineCPGControl::releaseCPGs()
+{
+    delete m_pCPGSys;
+    m_pCPGSys = NULL;
+    
+    m_actuatorBank.clear();
+    
+    for(size_t i = 0; i < m_allControllers.size(); i++)
+    {
+		delete m_allControllers[i];
+	}
+	m_allControllers.clear();
+}
+
 void BaseSpineCPGControl::setupCPGs(BaseSpineModelLearning& subject, array_2D nodeActions, array_4D edgeActions)
 {
 	    
@@ -215,7 +307,8 @@ void BaseSpineCPGControl::setupCPGs(BaseSpineModelLearning& subject, array_2D no
     for (std::size_t i = 0; i < allMuscles.size(); i++)
     {
 		tgCPGActuatorControl* pStringControl = new tgCPGActuatorControl();
-        allMuscles[i]->attach(pStringControl);
+        // Not attached, m_actuatorBank steps the muscles
+        pStringControl->onAttach(*allMuscles[i]);
         
         m_allControllers.push_back(pStringControl);
     }
@@ -246,35 +339,41 @@ void BaseSpineCPGControl::setupCPGs(BaseSpineModelLearning& subject, array_2D no
 		{
 			pStringInfo->setupControl(*p_ipc, m_config.controlLength);
 		}
+        
+        tgBasicActuator* const pActuator =
+            tgCast::cast<tgSpringCableActuator, tgBasicActuator>(allMuscles[i]);
+        assert(pActuator != NULL);
+        m_actuatorBank.add(*pActuator, *pStringInfo);
     }
 	
 }
 
 void BaseSpineCPGControl::onStep(BaseSpineModelLearning& subject, double dt)
 {
-    m_updateTime += dt;
-    if (m_updateTime >= m_config.controlTime)
+    std::size_t numControllers = subject.getNumberofMuslces();
+    
+    double descendingCommand = 2.0;
+    m_desComs.assign(numControllers, descendingCommand);
+    
+    // The CPG keeps its own control frequency
+    if (m_pCPGSys->step(m_desComs, dt))
     {
-        std::size_t numControllers = subject.getNumberofMuslces();
-        
-        double descendingCommand = 2.0;
-        std::vector<double> desComs (numControllers, descendingCommand);
-        
-        m_pCPGSys->update(desComs, m_updateTime);
 #ifdef LOGGING // Conditional compile for data logging        
-        m_dataObserver.onStep(subject, m_updateTime);
+        m_dataObserver.onStep(subject, m_config.controlTime);
 #endif
-		notifyStep(m_updateTime);
-        m_updateTime = 0;
+		notifyStep(m_config.controlTime);
     }
     
+    m_actuatorBank.step(dt);
+    
     double currentHeight = subject.getSegmentCOM(m_config.segmentNumber)[1];
     
     /// @todo add to config
     if (currentHeight > 25 || currentHeight < 1.0)
     {
-		/// @todo if bogus, stop trial (reset simulation)
+		// No point running the rest of the episode
 		bogus = true;
+		subject.requestStop();
 	}
 }
 
@@ -310,20 +409,8 @@ void BaseSpineCPGControl::onTeardown(BaseSpineModelLearning& subject)
     
     for(int i=0; i<tmpStrings.size(); i++)
     {
-        tgSpringCableActuator::SpringCableActuatorHistory stringHist = tmpStrings[i]->getHistory();
-        
-        for(int j=1; j<stringHist.tensionHistory.size(); j++)
-        {
-            const double previousTension = stringHist.tensionHistory[j-1];
-            const double previousLength = stringHist.restLengths[j-1];
-            const double currentLength = stringHist.restLengths[j];
-            //TODO: examine this assumption - free spinning motor may require more power
-            double motorSpeed = (currentLength-previousLength);
-            if(motorSpeed > 0) // Vestigial code
-                motorSpeed = 0;
-            const double workDone = previousTension * motorSpeed;
-            totalEnergySpent += workDone;
-        }
+        // Negative, as the work is done shortening the cable
+        totalEnergySpent -= tmpStrings[i]->getHistory().energySpent;
     }
     
     scores.push_back(totalEnergySpent);
@@ -331,14 +418,15 @@ void BaseSpineCPGControl::onTeardown(BaseSpineModelLearning& subject)
     edgeAdapter.endEpisode(scores);
     nodeAdapter.endEpisode(scores);
     
-    delete m_pCPGSys;
-    m_pCPGSys = NULL;
-    
-    for(size_t i = 0; i < m_allControllers.size(); i++)
+    if (m_reuseOnReset)
     {
-		delete m_allControllers[i];
-	}
-	m_allControllers.clear();
+        // The muscles go with the model, the rest is kept for onReset
+        m_actuatorBank.clear();
+    }
+    else
+    {
+        releaseCPGs();
+    }
 }
 
 const double BaseSpineCPGControl::getCPGValue(std::size_t i) const
@@ -347,6 +435,11 @@ const double BaseSpineCPGControl::getCPGValue(std::size_t i) const
 	return (*m_pCPGSys)[i];
 }
 
+void BaseSpineCPGControl::getCPGValues(std::vector<double>& values) const
+{
+	m_pCPGSys->getOutputs(values);
+}
+
 double BaseSpineCPGControl::getScore() const
 {
 	if (scores.size() == 2)
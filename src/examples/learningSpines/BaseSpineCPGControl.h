@@ -36,6 +36,9 @@
 
 #include "learning/Adapters/AnnealAdapter.h"
 
+#include "util/CPGEquations.h"
+#include "util/tgCPGActuatorBank.h"
+
 //This should probably be a forward declaration
 #include "BaseSpineModelLearning.h"
 
@@ -44,7 +47,6 @@ class tgImpedanceController;
 class AnnealEvolution;
 class configuration;
 class tgCPGActuatorControl;
-class CPGEquations;
 class tgCPGLogger;
 
 typedef boost::multi_array<double, 2> array_2D;
@@ -84,7 +86,8 @@ struct Config
         bool def = true,
         double cl = 10.0,
         double lf = 0.0,
-        double hf = 30.0);
+        double hf = 30.0,
+        CPGEquations::Interpolation ci = CPGEquations::HOLD);
       
 		// Learning Parameters
 		const int segmentSpan; // 3 possible muscles touching two rigid bodies
@@ -95,6 +98,8 @@ struct Config
         
         // CPG control frequency
         const double controlTime;
+        // How muscles read the CPG between control steps
+        const CPGEquations::Interpolation cpgInterpolation;
         
         // Limit Params
         const double lowAmp;
@@ -124,10 +129,35 @@ struct Config
     
     virtual void onSetup(BaseSpineModelLearning& subject);
     
+    /**
+     * With setReuseOnReset(true), take the next parameters and rewrite
+     * the CPG system, string controllers and impedance controllers kept
+     * from the last episode, instead of building them again; otherwise
+     * the same as onSetup().
+     */
+    virtual void onReset(BaseSpineModelLearning& subject);
+    
     virtual void onTeardown(BaseSpineModelLearning& subject);
+    
+    /**
+     * Keep the CPG system and controllers across episodes, for learning
+     * runs of many short trials. A subclass that builds its own CPG in
+     * onSetup() or setupCPGs() must also override resetCPGs() to use
+     * this.
+     */
+    void setReuseOnReset(bool reuse)
+    {
+        m_reuseOnReset = reuse;
+    }
 
 	const double getCPGValue(std::size_t i) const;
 	
+	/**
+	 * Copy the value of every CPG node, as getCPGValue() would
+	 * @param[out] values resized to the number of nodes
+	 */
+	void getCPGValues(std::vector<double>& values) const;
+	
 	double getScore() const;
 	
 protected:
@@ -140,11 +170,27 @@ protected:
     virtual array_2D scaleNodeActions (std::vector< std::vector <double> > actions);
     
     virtual void setupCPGs(BaseSpineModelLearning& subject, array_2D nodeActions, array_4D edgeActions);
+    
+    /**
+     * Give the CPG system setupCPGs built new parameters in place, and
+     * bind its controllers to the model's new muscles
+     * @throw std::runtime_error if the model's muscles have changed
+     */
+    virtual void resetCPGs(BaseSpineModelLearning& subject, const array_2D& nodeActions, const array_4D& edgeActions);
+    
+    /** Delete the CPG system and the controllers */
+    void releaseCPGs();
 
     CPGEquations* m_pCPGSys;
     
     std::vector<tgCPGActuatorControl*> m_allControllers;
     
+    /**
+     * Drives the muscles set up by setupCPGs in one pass per step, in
+     * place of attaching m_allControllers to the muscles as observers
+     */
+    tgCPGActuatorBank m_actuatorBank;
+    
     BaseSpineCPGControl::Config m_config;
 
     /**
@@ -189,9 +235,15 @@ protected:
     
     double m_updateTime;
     
+    /** Descending commands, kept to avoid allocating every step */
+    std::vector<double> m_desComs;
+    
     std::vector<double> scores;
     
     bool bogus;
+    
+    /** True to keep the CPG system and controllers between episodes */
+    bool m_reuseOnReset;
 };
 
 #endif // BASE_SPINE_CPG_CONTROL_H
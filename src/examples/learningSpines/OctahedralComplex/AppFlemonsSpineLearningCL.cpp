@@ -88,6 +88,8 @@ int main(int argc, char** argv)
 												tension, kPosition, kVelocity);
     BaseSpineCPGControl* const myControl =
       new BaseSpineCPGControl(control_config, suffix, "learningSpines/OctahedralComplex/");
+    // Rewrite the CPG each episode rather than building it again
+    myControl->setReuseOnReset(true);
     myModel->attach(myControl);
     
     simulation.addModel(myModel);
@@ -75,6 +75,8 @@ int main(int argc, char** argv)
     BaseSpineCPGControl::Config control_config(segmentSpan, numMuscles, numMuscles, numParams);
     BaseSpineCPGControl* const myControl =
       new BaseSpineCPGControl(control_config, suffix, "learningSpines/ribDemo/");
+    // Rewrite the CPG each episode rather than building it again
+    myControl->setReuseOnReset(true);
     myModel->attach(myControl);
     
     simulation.addModel(myModel);
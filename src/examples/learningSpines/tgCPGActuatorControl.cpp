@@ -99,36 +99,78 @@ void tgCPGActuatorControl::onStep(tgSpringCableActuator& subject, double dt)
 	}
 }
 
+namespace
+{
+    /** The parameters of a node, as CPGEquations::addNode takes them */
+    std::vector<double> nodeParamsOf(const array_2D& nodeParams)
+    {
+        std::vector<double> params (7);
+        params[0] = nodeParams[0][0]; // Frequency Offset
+        params[1] = nodeParams[0][0]; // Frequency Scale
+        params[2] = nodeParams[0][1]; // Radius Offset
+        params[3] = nodeParams[0][1]; // Radius Scale
+        params[4] = 20.0; // rConst (a constant)
+        params[5] = 0.0; // dMin for descending commands
+        params[6] = 5.0; // dMax for descending commands
+        return params;
+    }
+}
+
 void tgCPGActuatorControl::assignNodeNumber (CPGEquations& CPGSys, array_2D nodeParams)
 {
     // Ensure that this hasn't already been assigned
     assert(m_nodeNumber == -1);
     
     m_pCPGSystem = &CPGSys;
-
-    std::vector<double> params (7);
-    params[0] = nodeParams[0][0]; // Frequency Offset
-    params[1] = nodeParams[0][0]; // Frequency Scale
-    params[2] = nodeParams[0][1]; // Radius Offset
-    params[3] = nodeParams[0][1]; // Radius Scale
-    params[4] = 20.0; // rConst (a constant)
-    params[5] = 0.0; // dMin for descending commands
-    params[6] = 5.0; // dMax for descending commands
-            
+    
+    std::vector<double> params = nodeParamsOf(nodeParams);
     m_nodeNumber = m_pCPGSystem->addNode(params);
 }
 
+void tgCPGActuatorControl::resetNodeParams(const array_2D& nodeParams)
+{
+    if (m_nodeNumber == -1)
+    {
+        throw std::runtime_error("Not yet initialized");
+    }
+    m_pCPGSystem->setNodeParams(m_nodeNumber, nodeParamsOf(nodeParams));
+}
+
 void
 tgCPGActuatorControl::setConnectivity(const std::vector<tgCPGActuatorControl*>& allStrings,
                        array_4D edgeParams) 
 {
-    assert(m_nodeNumber >= 0);
-    
-    int muscleSize = edgeParams.shape()[1];
+    std::vector<int> connectivityList;
+    std::vector<double> weights;
+    std::vector<double> phases;
+    findConnectivity(allStrings, edgeParams, connectivityList, weights, phases);
     
+    m_pCPGSystem->defineConnections(m_nodeNumber, connectivityList, weights, phases);
+}
+
+void
+tgCPGActuatorControl::resetConnectivity(const std::vector<tgCPGActuatorControl*>& allStrings,
+                       const array_4D& edgeParams)
+{
     std::vector<int> connectivityList;
     std::vector<double> weights;
     std::vector<double> phases;
+    findConnectivity(allStrings, edgeParams, connectivityList, weights, phases);
+    
+    // Throws if the bodies connect the strings differently than before
+    m_pCPGSystem->setConnectionParams(m_nodeNumber, connectivityList, weights, phases);
+}
+
+void
+tgCPGActuatorControl::findConnectivity(const std::vector<tgCPGActuatorControl*>& allStrings,
+                       const array_4D& edgeParams,
+                       std::vector<int>& connectivityList,
+                       std::vector<double>& weights,
+                       std::vector<double>& phases) const
+{
+    assert(m_nodeNumber >= 0);
+    
+    int muscleSize = edgeParams.shape()[1];
     
     // Assuming all coupling is two way, there ought to be a way
     // to search faster than O((2N)^2) since every other
@@ -168,8 +210,6 @@ tgCPGActuatorControl::setConnectivity(const std::vector<tgCPGActuatorControl*>&
             }
         }
     }
-    
-    m_pCPGSystem->defineConnections(m_nodeNumber, connectivityList, weights, phases);
 }
 
 void tgCPGActuatorControl::setupControl(tgImpedanceController& ipc)
@@ -60,6 +60,12 @@ public:
      */
     
     void assignNodeNumber (CPGEquations& CPGSys, array_2D nodeParams);
+    
+    /**
+     * Give the assigned node new parameters for another trial, in place.
+     * @throw std::runtime_error if no node has been assigned
+     */
+    void resetNodeParams(const array_2D& nodeParams);
  
     /**
      * Iterate through all other tgSpringCableActuatorCPGInfos, and determine
@@ -68,6 +74,15 @@ public:
     void setConnectivity(const std::vector<tgCPGActuatorControl*>& allStrings,
              array_4D edgeParams);
     
+    /**
+     * Give the couplings setConnectivity defined new weights and phases,
+     * after onAttach() to the same strings of a model that was set up
+     * again
+     * @throw std::invalid_argument if the strings now connect differently
+     */
+    void resetConnectivity(const std::vector<tgCPGActuatorControl*>& allStrings,
+             const array_4D& edgeParams);
+    
     const int getNodeNumber() const
     {
         return m_nodeNumber;
@@ -102,6 +117,16 @@ public:
 	}
 	
 protected:
+    /**
+     * The couplings of this string to the others that share a rigid
+     * body, with their weights and phases from edgeParams
+     */
+    void findConnectivity(const std::vector<tgCPGActuatorControl*>& allStrings,
+             const array_4D& edgeParams,
+             std::vector<int>& connectivityList,
+             std::vector<double>& weights,
+             std::vector<double>& phases) const;
+    
     /**
      * Member variable for keeping track of how long its been since the 
      * last update step
@@ -26,9 +26,9 @@
 #include "tgCPGLogger.h"
 
 #include "BaseSpineCPGControl.h"
+#include "sensors/tgBufferedFileWriter.h"
 
-#include <iostream>
-#include <fstream>
+#include <cstdio>
 #include <string>
 
 /**
@@ -36,42 +36,46 @@
  */
 tgCPGLogger::tgCPGLogger(std::string fileName) :
 time (0.0),
-m_fileName(fileName)
+m_fileName(fileName),
+m_pOutput(new tgBufferedFileWriter(1 << 16, true))
 {
 }
 
 /** Virtual base classes must have a virtual destructor. */
 tgCPGLogger::~tgCPGLogger()
-{ }
+{
+	// Writes out what is buffered
+	delete m_pOutput;
+}
 
 void tgCPGLogger::onStep(BaseSpineCPGControl& subject, double dt)
 {
 	time += dt;
 	
-      // Then, open our output stream and render!
-      std::ofstream tgOutput;
-      tgOutput.open(m_fileName.c_str(), std::ios::app);
-	
-	tgOutput << time << ",";
+	if (!m_pOutput->isOpen())
+	{
+		// Appended to, as the file always was, unless another logger
+		// of this process has it open
+		const std::string::size_type slash = m_fileName.rfind('/');
+		std::string::size_type dot = m_fileName.rfind('.');
+		if (dot == std::string::npos ||
+			(slash != std::string::npos && dot < slash))
+		{
+			dot = m_fileName.size();
+		}
+		m_fileName = m_pOutput->openUnique(m_fileName.substr(0, dot),
+										   m_fileName.substr(dot),
+										   std::ios::app);
+	}
 	
-	bool runLoop = true;
-	std::size_t i = 0;
+	subject.getCPGValues(m_values);
 	
-	while (runLoop)
+	// %g is what operator<< writes at the default precision
+	char text[32];
+	m_pOutput->write(text, snprintf(text, sizeof(text), "%g,", time));
+	for (std::size_t i = 0; i < m_values.size(); i++)
 	{
-		// Don't know how many nodes are in CPG, so just try until we fail
-	  try 
-	  {
-        tgOutput << subject.getCPGValue(i) << ",";
-        i++;
-	  }
-	  catch (std::invalid_argument e)
-	  {
-		// Got the error we expected, end the loop
-		tgOutput << std::endl;
-		runLoop = false;
-	  }
+		m_pOutput->write(text, snprintf(text, sizeof(text), "%g,", m_values[i]));
 	}
-	
-	tgOutput.close();
+	m_pOutput->write("\n", 1);
 }
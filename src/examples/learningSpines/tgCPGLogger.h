@@ -30,12 +30,17 @@
 // This library
 #include "core/tgObserver.h"
 #include <string>
+#include <vector>
 
 // Forward declarations
 class BaseSpineCPGControl;
+class tgBufferedFileWriter;
 
 /**
- * Interface for an observer of the CPG values
+ * Interface for an observer of the CPG values. Appends the time and the
+ * value of every node to a file each step, buffered in memory and
+ * written by a background thread. Loggers of one process sharing a file
+ * name each get their own file, with "_1", "_2" ... before the extension.
  */
 class tgCPGLogger : public tgObserver <BaseSpineCPGControl>
 {
@@ -52,9 +57,15 @@ public:
 
   virtual void onStep(BaseSpineCPGControl& subject, double dt);
   
+  /** @return the file written, which is only known after the first step */
+  const std::string& getFileName() const { return m_fileName; }
+  
 private:
 	double time;
 	std::string m_fileName;
+	tgBufferedFileWriter* m_pOutput;
+	/** The values of one step, kept to avoid allocating */
+	std::vector<double> m_values;
 
 };
 
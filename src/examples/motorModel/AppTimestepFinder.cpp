@@ -0,0 +1,98 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file AppTimestepFinder.cpp
+ * @brief Contains the definition function main() for a sweep of the
+ * step sizes of the motor test rig
+ * $Id$
+ */
+
+// This application
+#include "tsTestRig.h"
+// This library
+#include "core/tgSimulation.h"
+#include "core/tgTimestepFinder.h"
+#include "core/tgWorld.h"
+// The C++ Standard Library
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    /** Builds the rig with the motor model chosen on the command line */
+    class RigBuilder : public tgTimestepFinder::Builder
+    {
+    public:
+        explicit RigBuilder(bool kinematic) : m_kinematic(kinematic) { }
+
+        virtual void build(tgSimulation& simulation) const
+        {
+            simulation.addModel(new tsTestRig(m_kinematic));
+        }
+
+    private:
+        const bool m_kinematic;
+    };
+}
+
+/**
+ * The entry point.
+ * @param[in] argc the number of command-line arguments
+ * @param[in] argv argv[0] is the executable name; argv[1], if given, is
+ * "linear" to sweep the linear motor model instead of the kinematic one,
+ * and argv[2] the largest step size to try
+ * @return 0 if some step size is stable, 1 otherwise
+ */
+int main(int argc, char** argv)
+{
+    const bool kinematic = argc < 2 || std::string(argv[1]) != "linear";
+    const double largest = argc < 3 ? 1.0/100.0 : std::atof(argv[2]);
+
+    const tgWorld::Config config(981); // gravity, dm/sec^2
+    const RigBuilder builder(kinematic);
+    // 1 second, as MotorTimestep_test runs, within its 0.03 tolerance
+    const tgTimestepFinder::Config sweep(1.0, 0.01, 0.03, 1.0/10000.0);
+    tgTimestepFinder finder(config, builder, sweep);
+
+    const std::vector<tgTimestepFinder::Result> results =
+        finder.sweep(tgTimestepFinder::candidates(1.0/5000.0, largest, 12));
+    for (std::size_t i = 0; i < results.size(); i++)
+    {
+        const tgTimestepFinder::Result& result = results[i];
+        std::cout << result.stepSize << " error " << result.error
+                  << (result.stable ? " stable" : " unstable");
+        if (result.failure != tgDivergenceWatchdog::eNone)
+        {
+            std::cout << " (" << tgDivergenceWatchdog::name(result.failure)
+                      << ")";
+        }
+        std::cout << std::endl;
+    }
+
+    const double dt = tgTimestepFinder::largestStable(results);
+    if (dt == 0.0)
+    {
+        std::cout << "No step size is within tolerance" << std::endl;
+        return 1;
+    }
+    std::cout << "Largest stable step size: " << dt << std::endl;
+    return 0;
+}
@@ -25,16 +25,20 @@
 #include <string>
 #include <fstream>
 #include <sstream>
+#include <stdexcept>
 #include "FileHelpers.h"
 #include "resources.h"
+#include "core/tgAssetCache.h"
 
 using namespace std;
 
 std::string FileHelpers::getFileString(std::string fileName) {
-    std::ifstream fileInput(fileName.c_str());
-    stringstream buffer;
-    buffer << fileInput.rdbuf();
-    return buffer.str();
+    // Read once per process however many controllers ask, "" if missing
+    try {
+        return tgAssetCache::read(fileName)->str();
+    } catch (const std::runtime_error&) {
+        return "";
+    }
 }
 
 std::string FileHelpers::getResourcePath(std::string relPath) {
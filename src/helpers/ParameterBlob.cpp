@@ -0,0 +1,141 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file ParameterBlob.cpp
+ * @brief Contains the definition of class ParameterBlob
+ * $Id$
+ */
+
+#include "ParameterBlob.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+    const char kMagic[8] = {'N', 'T', 'R', 'T', 'P', 'B', '1', '\0'};
+    
+    /** Read a little endian uint32 at pos, advancing pos */
+    std::size_t readSize(const std::vector<char>& bytes, std::size_t& pos)
+    {
+        if (pos + 4 > bytes.size())
+        {
+            throw std::runtime_error("Truncated parameter blob");
+        }
+        const unsigned char* p =
+            reinterpret_cast<const unsigned char*>(&bytes[pos]);
+        pos += 4;
+        return static_cast<std::size_t>(p[0]) |
+                (static_cast<std::size_t>(p[1]) << 8) |
+                (static_cast<std::size_t>(p[2]) << 16) |
+                (static_cast<std::size_t>(p[3]) << 24);
+    }
+}
+
+ParameterBlob::ParameterBlob()
+{
+}
+
+bool ParameterBlob::isBlob(const std::string& fileName)
+{
+    std::ifstream input(fileName.c_str(), std::ios::in | std::ios::binary);
+    char magic[sizeof(kMagic)];
+    input.read(magic, sizeof(magic));
+    return input.good() && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
+
+void ParameterBlob::load(const std::string& fileName)
+{
+    std::ifstream input(fileName.c_str(),
+                        std::ios::in | std::ios::binary | std::ios::ate);
+    if (!input.is_open())
+    {
+        throw std::invalid_argument("Bad filename for parameter blob");
+    }
+    
+    std::vector<char> bytes(static_cast<std::size_t>(input.tellg()));
+    input.seekg(0);
+    if (!bytes.empty())
+    {
+        input.read(&bytes[0], bytes.size());
+    }
+    if (bytes.size() < sizeof(kMagic) ||
+        std::memcmp(&bytes[0], kMagic, sizeof(kMagic)) != 0)
+    {
+        throw std::runtime_error("Not a parameter blob");
+    }
+    
+    std::size_t pos = sizeof(kMagic);
+    const std::size_t count = readSize(bytes, pos);
+    
+    std::map<std::string, Section> sections;
+    std::size_t values = 0;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        const std::size_t length = readSize(bytes, pos);
+        if (pos + length > bytes.size())
+        {
+            throw std::runtime_error("Truncated parameter blob");
+        }
+        const std::string name(&bytes[pos], length);
+        pos += length;
+        
+        Section section;
+        section.rows = readSize(bytes, pos);
+        section.cols = readSize(bytes, pos);
+        section.offset = values;
+        values += section.rows * section.cols;
+        sections[name] = section;
+    }
+    
+    // The doubles start on an 8 byte boundary
+    pos = (pos + 7) & ~static_cast<std::size_t>(7);
+    if (pos + values * sizeof(double) != bytes.size())
+    {
+        throw std::runtime_error("Parameter blob size does not match its headers");
+    }
+    
+    m_sections.swap(sections);
+    m_data.resize(values);
+    if (values > 0)
+    {
+        std::memcpy(&m_data[0], &bytes[pos], values * sizeof(double));
+    }
+}
+
+bool ParameterBlob::has(const std::string& name) const
+{
+    return m_sections.find(name) != m_sections.end();
+}
+
+const double* ParameterBlob::get(const std::string& name,
+                                    std::size_t& rows,
+                                    std::size_t& cols) const
+{
+    std::map<std::string, Section>::const_iterator it = m_sections.find(name);
+    if (it == m_sections.end())
+    {
+        throw std::invalid_argument("No such section in parameter blob: " + name);
+    }
+    rows = it->second.rows;
+    cols = it->second.cols;
+    // Empty sections have no storage of their own
+    return m_data.empty() ? NULL : &m_data[0] + it->second.offset;
+}
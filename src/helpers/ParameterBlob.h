@@ -0,0 +1,92 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file ParameterBlob.h
+ * @brief A binary alternative to JSON controller parameter files
+ * $Id$
+ */
+
+#ifndef PARAMETER_BLOB_H
+#define PARAMETER_BLOB_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Named two dimensional arrays of doubles, read from a binary file
+ * written by scripts/learning/src/helpers/jsonToBlob.py. Each numeric
+ * array of a controller's JSON file becomes a section named by its path,
+ * so root["nodeVals"]["params"] is found as "nodeVals/params".
+ *
+ * The file is an 8 byte magic "NTRTPB1", a uint32 section count, one
+ * header per section (uint32 name length, the name, uint32 rows, uint32
+ * columns), zero padding to a multiple of 8 bytes and then every
+ * section's doubles, row major, in header order. Integers and doubles are
+ * little endian. load() reads the file with one read and copies the
+ * doubles with one memcpy.
+ */
+class ParameterBlob
+{
+public:
+    
+    ParameterBlob();
+    
+    /**
+     * Return true if the file exists and starts with the magic, so
+     * callers can accept either a JSON or a binary file under one name
+     */
+    static bool isBlob(const std::string& fileName);
+    
+    /**
+     * Replace the contents with those of a file.
+     * @throw std::invalid_argument if the file can't be read
+     * @throw std::runtime_error if it is not a valid blob
+     */
+    void load(const std::string& fileName);
+    
+    bool has(const std::string& name) const;
+    
+    /**
+     * Return the doubles of a section, row major.
+     * @param[out] rows the number of rows
+     * @param[out] cols the number of columns
+     * @throw std::invalid_argument if there is no such section
+     */
+    const double* get(const std::string& name,
+                        std::size_t& rows,
+                        std::size_t& cols) const;
+    
+private:
+    
+    struct Section
+    {
+        std::size_t rows;
+        std::size_t cols;
+        /** The index of the first value in m_data */
+        std::size_t offset;
+    };
+    
+    std::map<std::string, Section> m_sections;
+    
+    std::vector<double> m_data;
+};
+
+#endif  // PARAMETER_BLOB_H
@@ -0,0 +1,125 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file WorkerProtocol.cpp
+ * @brief Contains the definitions of the WorkerProtocol functions
+ * $Id$
+ */
+
+#include "WorkerProtocol.h"
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    const char kReplyPrefix[] = "NTRTWORKER ";
+}
+
+WorkerJob::WorkerJob() :
+steps(0),
+blocks(false),
+hills(false),
+angle(0.0),
+goalAngle(0.0)
+{
+}
+
+bool WorkerProtocol::readJobs(std::istream& input,
+                                std::vector<WorkerJob>& jobs)
+{
+    std::string line;
+    while (std::getline(input, line))
+    {
+        std::istringstream request(line);
+        std::string command;
+        if (!(request >> command))
+        {
+            continue;
+        }
+        if (command == "quit")
+        {
+            return false;
+        }
+        if (command != "run" && command != "sweep")
+        {
+            throw std::invalid_argument("Unknown worker request: " + line);
+        }
+        
+        WorkerJob job;
+        std::vector<std::string> fields;
+        std::string field;
+        if (!(request >> job.filename >> job.path))
+        {
+            throw std::invalid_argument("Malformed worker request: " + line);
+        }
+        while (request >> field)
+        {
+            fields.push_back(field);
+        }
+        if (fields.empty() || fields.size() % 5 != 0 ||
+            (command == "run" && fields.size() != 5))
+        {
+            throw std::invalid_argument("Malformed worker request: " + line);
+        }
+        
+        std::vector<WorkerJob> next;
+        for (std::size_t i = 0; i < fields.size(); i += 5)
+        {
+            std::istringstream terrain(fields[i] + " " + fields[i + 1] + " " +
+                                        fields[i + 2] + " " + fields[i + 3] +
+                                        " " + fields[i + 4]);
+            if (!(terrain >> job.steps >> job.blocks >> job.hills
+                          >> job.angle >> job.goalAngle) ||
+                !(terrain >> std::ws).eof())
+            {
+                throw std::invalid_argument("Malformed worker request: " +
+                                            line);
+            }
+            next.push_back(job);
+        }
+        jobs.swap(next);
+        return true;
+    }
+    return false;
+}
+
+void WorkerProtocol::writeDone(std::ostream& output, const WorkerJob& job)
+{
+    output << kReplyPrefix << "done " << job.filename << std::endl;
+}
+
+void WorkerProtocol::writeFail(std::ostream& output,
+                                const WorkerJob& job,
+                                const std::string& message)
+{
+    // Keep the reply on one line
+    std::string oneLine(message);
+    for (std::size_t i = 0; i < oneLine.size(); i++)
+    {
+        if (oneLine[i] == '\n' || oneLine[i] == '\r')
+        {
+            oneLine[i] = ' ';
+        }
+    }
+    output << kReplyPrefix << "fail " << job.filename << " "
+            << oneLine << std::endl;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file WorkerProtocol.h
+ * @brief The line protocol between a persistent simulation worker and
+ * scripts/learning/src/interfaces/worker_scheduler.py
+ * $Id$
+ */
+
+#ifndef WORKER_PROTOCOL_H
+#define WORKER_PROTOCOL_H
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/**
+ * One trial for a worker. The fields mirror the command line options the
+ * learning scripts pass to a one shot app (-l, -P, -s, -b, -H, -a, -B).
+ * The controller still reads its parameters from and writes its scores
+ * to resources/<path><filename>, exactly as in a one shot run.
+ */
+struct WorkerJob
+{
+    WorkerJob();
+    
+    std::string filename;
+    std::string path;
+    int steps;
+    bool blocks;
+    bool hills;
+    double angle;
+    double goalAngle;
+};
+
+/**
+ * A worker reads one request per line from its standard input:
+ *
+ *     run <filename> <path> <steps> <blocks> <hills> <angle> <goalAngle>
+ *     sweep <filename> <path> <steps> <blocks> <hills> <angle> <goalAngle> ...
+ *     quit
+ *
+ * A sweep repeats the last five fields once per terrain. Its trials share
+ * one parameter file, so the worker builds the model and the controller
+ * once and only resets the simulation between them; the scores file gets
+ * one entry per terrain, in order.
+ *
+ * The worker answers each request on its standard output with
+ *
+ *     NTRTWORKER done <filename>
+ *     NTRTWORKER fail <filename> <message>
+ *
+ * Replies carry a prefix since the models and controllers also print to
+ * standard output; the scheduler ignores other lines.
+ */
+namespace WorkerProtocol
+{
+    /**
+     * Read the next request, skipping blank lines.
+     * @param[out] jobs one job for a run, one per terrain for a sweep,
+     * all with the same filename and path
+     * @return false at end of input or on quit
+     * @throw std::invalid_argument if the line is malformed
+     */
+    bool readJobs(std::istream& input, std::vector<WorkerJob>& jobs);
+    
+    /** Write and flush the reply for a finished request */
+    void writeDone(std::ostream& output, const WorkerJob& job);
+    
+    /** Write and flush the reply for a request that threw */
+    void writeFail(std::ostream& output,
+                    const WorkerJob& job,
+                    const std::string& message);
+}
+
+#endif  // WORKER_PROTOCOL_H
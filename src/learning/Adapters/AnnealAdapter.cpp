@@ -32,21 +32,35 @@
 #include "AnnealAdapter.h"
 #include "learning/Configuration/configuration.h"
 #include "helpers/FileHelpers.h"
+#include "ParameterChannel.h"
 
 using namespace std;
 
 AnnealAdapter::AnnealAdapter() :
-totalTime(0.0)
+totalTime(0.0),
+m_pChannel(NULL),
+m_channelTrial(0)
 {
 }
 AnnealAdapter::~AnnealAdapter(){};
 
 void AnnealAdapter::initialize(AnnealEvolution *evo,bool isLearning,configuration configdata)
 {
-    numberOfActions=configdata.getDoubleValue("numberOfActions");
-    numberOfStates=configdata.getDoubleValue("numberOfStates");
-    numberOfControllers=configdata.getDoubleValue("numberOfControllers");
+    initialize(evo, isLearning, LearningConfig(configdata));
+}
+
+void AnnealAdapter::initialize(AnnealEvolution *evo,bool isLearning)
+{
+    initialize(evo, isLearning, evo->getConfig());
+}
+
+void AnnealAdapter::initialize(AnnealEvolution *evo,bool isLearning,const LearningConfig& configdata)
+{
+    numberOfActions=configdata.get(LearningConfig::numberOfActions);
+    numberOfStates=configdata.get(LearningConfig::numberOfStates);
+    numberOfControllers=configdata.get(LearningConfig::numberOfControllers);
     totalTime=0.0;
+    m_pChannel = NULL;
 
     //This Function initializes the parameterset from evo.
     this->annealEvo = evo;
@@ -68,10 +82,36 @@ void AnnealAdapter::initialize(AnnealEvolution *evo,bool isLearning,configuratio
     errorOfFirstController=0.0;
 }
 
+bool AnnealAdapter::initialize(ParameterChannel& channel,configuration configdata)
+{
+    return initialize(channel, LearningConfig(configdata));
+}
+
+bool AnnealAdapter::initialize(ParameterChannel& channel,const LearningConfig& configdata)
+{
+    numberOfActions=configdata.get(LearningConfig::numberOfActions);
+    numberOfStates=configdata.get(LearningConfig::numberOfStates);
+    numberOfControllers=configdata.get(LearningConfig::numberOfControllers);
+    totalTime=0.0;
+    errorOfFirstController=0.0;
+
+    if (!channel.take(m_channelTrial, m_channelParameters))
+    {
+        m_pChannel = NULL;
+        return false;
+    }
+    m_pChannel = &channel;
+    return true;
+}
+
 vector<vector<double> > AnnealAdapter::step(double deltaTimeSeconds,vector<double> state)
 {
     totalTime+=deltaTimeSeconds;
 //  cout<<"NN adapter, state: "<<state[0]<<" "<<state[1]<<" "<<state[2]<<" "<<state[3]<<" "<<state[4]<<" "<<endl;
+    if (m_pChannel != NULL)
+    {
+        return m_channelParameters;
+    }
     vector< vector<double> > actions;
 
     for(int i=0;i<currentControllers.size();i++)
@@ -89,6 +129,14 @@ vector<vector<double> > AnnealAdapter::step(double deltaTimeSeconds,vector<doubl
 
 void AnnealAdapter::endEpisode(vector<double> scores)
 {
+    if (m_pChannel != NULL)
+    {
+        // Exploded trials score -1 as with an evolution object
+        m_pChannel->submitScores(m_channelTrial,
+                                scores.empty() ? vector<double>(1, -1.0) : scores);
+        m_pChannel = NULL;
+        return;
+    }
     if(scores.size()==0)
     {
         vector< double > tmp(1);
@@ -29,9 +29,14 @@
  */
 
 #include <vector>
+#include "learning/Configuration/configuration.h"
+#include "learning/Configuration/LearningConfig.h"
 #include "learning/AnnealEvolution/AnnealEvolution.h"
 #include "learning/AnnealEvolution/AnnealEvoMember.h"
 
+// Forward declarations
+class ParameterChannel;
+
 class AnnealAdapter
 {
 public:
@@ -42,7 +47,20 @@ public:
      * For NTRT this means main or simulator needs to own the pointer to
      * AnnealEvolution, we can't create it here
      */
+    void initialize(AnnealEvolution *evo,bool isLearning,const LearningConfig& config);
+    /** As above, with the configuration evo has already parsed */
+    void initialize(AnnealEvolution *evo,bool isLearning);
+    /** As above, parsing config first */
     void initialize(AnnealEvolution *evo,bool isLearning,configuration config);
+    /**
+     * Take the next trial's parameters from a channel instead of an
+     * evolution object. step() returns them unchanged and endEpisode()
+     * submits the scores to the channel. Blocks until a trial is posted.
+     * @return false if the channel was closed with no trials left
+     */
+    bool initialize(ParameterChannel& channel,const LearningConfig& config);
+    /** As above, parsing config first */
+    bool initialize(ParameterChannel& channel,configuration config);
     std::vector<std::vector<double> > step(double deltaTimeSeconds, std::vector<double> state);
     void endEpisode(std::vector<double> state);
 
@@ -55,6 +73,10 @@ private:
     std::vector<double> initialPosition;
     double errorOfFirstController;
     double totalTime;
+    /** The channel of the current trial, or NULL. Not owned. */
+    ParameterChannel* m_pChannel;
+    std::size_t m_channelTrial;
+    std::vector< std::vector<double> > m_channelParameters;
 };
 
 #endif /* ANNEALADAPTER_H_ */
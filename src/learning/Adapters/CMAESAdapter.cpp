@@ -0,0 +1,95 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file CMAESAdapter.cpp
+ * @brief Contains the implementation of class CMAESAdapter.
+ * $Id$
+ */
+
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include "CMAESAdapter.h"
+
+using namespace std;
+
+CMAESAdapter::CMAESAdapter() :
+cmaesEvo(NULL),
+totalTime(0.0)
+{
+}
+CMAESAdapter::~CMAESAdapter(){}
+
+void CMAESAdapter::initialize(CMAESEvolution *evo,bool isLearning,configuration configdata)
+{
+    initialize(evo, isLearning, LearningConfig(configdata));
+}
+
+void CMAESAdapter::initialize(CMAESEvolution *evo,bool isLearning)
+{
+    initialize(evo, isLearning, evo->getConfig());
+}
+
+void CMAESAdapter::initialize(CMAESEvolution *evo,bool isLearning,const LearningConfig& configdata)
+{
+    numberOfActions=configdata.get(LearningConfig::numberOfActions);
+    numberOfStates=configdata.get(LearningConfig::numberOfStates);
+    numberOfControllers=configdata.get(LearningConfig::numberOfControllers);
+    totalTime=0.0;
+
+    //This Function initializes the parameterset from evo.
+    this->cmaesEvo = evo;
+    currentControllers = this->cmaesEvo->nextSetOfControllers();
+    if(!isLearning)
+    {
+        for(std::size_t i=0;i<currentControllers.size();i++)
+        {
+            stringstream ss;
+            ss << cmaesEvo->resourcePath << "logs/bestParameters-" << this->cmaesEvo->suffix << "-" << i << ".nnw";
+            currentControllers[i]->loadFromFile(ss.str().c_str());
+        }
+    }
+}
+
+vector<vector<double> > CMAESAdapter::step(double deltaTimeSeconds,vector<double> state)
+{
+    totalTime+=deltaTimeSeconds;
+    vector< vector<double> > actions;
+    for(std::size_t i=0;i<currentControllers.size();i++)
+    {
+        actions.push_back(currentControllers[i]->statelessParameters);
+    }
+    return actions;
+}
+
+void CMAESAdapter::endEpisode(vector<double> scores)
+{
+    if(scores.size()==0)
+    {
+        vector< double > tmp(1);
+        tmp[0]=-1;
+        cmaesEvo->updateScores(tmp);
+        cout<<"Exploded"<<endl;
+    }
+    else
+    {
+        cout<<"Dist Moved: "<<scores[0]<<" energy: "<<scores[1]<<endl;
+        cmaesEvo->updateScores(scores);
+    }
+}
@@ -27,6 +27,7 @@
 #include "NeuroAdapter.h"
 #include "learning/Configuration/configuration.h"
 #include "helpers/FileHelpers.h"
+#include "ParameterChannel.h"
 #include "neuralNet/Neural Network v2/neuralNetwork.h"
 
 #include <vector>
@@ -38,17 +39,30 @@
 using namespace std;
 
 NeuroAdapter::NeuroAdapter() :
-totalTime(0.0)
+totalTime(0.0),
+m_pChannel(NULL),
+m_channelTrial(0)
 {
 }
 NeuroAdapter::~NeuroAdapter(){};
 
 void NeuroAdapter::initialize(NeuroEvolution *evo,bool isLearning,configuration configdata)
 {
-	numberOfActions=configdata.getDoubleValue("numberOfActions");
-	numberOfStates=configdata.getDoubleValue("numberOfStates");
-	numberOfControllers=configdata.getDoubleValue("numberOfControllers");
+	initialize(evo, isLearning, LearningConfig(configdata));
+}
+
+void NeuroAdapter::initialize(NeuroEvolution *evo,bool isLearning)
+{
+	initialize(evo, isLearning, evo->getConfig());
+}
+
+void NeuroAdapter::initialize(NeuroEvolution *evo,bool isLearning,const LearningConfig& configdata)
+{
+	numberOfActions=configdata.get(LearningConfig::numberOfActions);
+	numberOfStates=configdata.get(LearningConfig::numberOfStates);
+	numberOfControllers=configdata.get(LearningConfig::numberOfControllers);
 	totalTime=0.0;
+	m_pChannel = NULL;
 
 	//This Function initializes the parameterset from evo.
 	this->neuroEvo = evo;
@@ -69,10 +83,36 @@ void NeuroAdapter::initialize(NeuroEvolution *evo,bool isLearning,configuration
 	errorOfFirstController=0.0;
 }
 
+bool NeuroAdapter::initialize(ParameterChannel& channel,configuration configdata)
+{
+	return initialize(channel, LearningConfig(configdata));
+}
+
+bool NeuroAdapter::initialize(ParameterChannel& channel,const LearningConfig& configdata)
+{
+	numberOfActions=configdata.get(LearningConfig::numberOfActions);
+	numberOfStates=configdata.get(LearningConfig::numberOfStates);
+	numberOfControllers=configdata.get(LearningConfig::numberOfControllers);
+	totalTime=0.0;
+	errorOfFirstController=0.0;
+
+	if (!channel.take(m_channelTrial, m_channelParameters))
+	{
+		m_pChannel = NULL;
+		return false;
+	}
+	m_pChannel = &channel;
+	return true;
+}
+
 vector<vector<double> > NeuroAdapter::step(double deltaTimeSeconds,vector<double> state)
 {
 	totalTime+=deltaTimeSeconds;
 //	cout<<"NN adapter, state: "<<state[0]<<" "<<state[1]<<" "<<state[2]<<" "<<state[3]<<" "<<state[4]<<" "<<endl;
+	if (m_pChannel != NULL)
+	{
+		return m_channelParameters;
+	}
 	vector< vector<double> > actions;
 	if(numberOfStates>0)
 	{
@@ -116,6 +156,14 @@ vector<vector<double> > NeuroAdapter::step(double deltaTimeSeconds,vector<double
 
 void NeuroAdapter::endEpisode(vector<double> scores)
 {
+	if (m_pChannel != NULL)
+	{
+		// Exploded trials score -1 as with an evolution object
+		m_pChannel->submitScores(m_channelTrial,
+								scores.empty() ? vector<double>(1, -1.0) : scores);
+		m_pChannel = NULL;
+		return;
+	}
 	if(scores.size()==0)
 	{
 		vector< double > tmp(1);
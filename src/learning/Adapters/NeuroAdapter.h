@@ -28,9 +28,14 @@
  */
 
 #include <vector>
+#include "learning/Configuration/configuration.h"
+#include "learning/Configuration/LearningConfig.h"
 #include "../NeuroEvolution/NeuroEvolution.h"
 #include "../NeuroEvolution/NeuroEvoMember.h"
 
+// Forward declarations
+class ParameterChannel;
+
 class NeuroAdapter
 {
 public:
@@ -41,7 +46,20 @@ public:
 	 * For NTRT this means main or simulator needs to own the pointer to
 	 * NeuroEvolution, we can't create it here
 	 */
+	void initialize(NeuroEvolution *evo,bool isLearning,const LearningConfig& config);
+	/** As above, with the configuration evo has already parsed */
+	void initialize(NeuroEvolution *evo,bool isLearning);
+	/** As above, parsing config first */
 	void initialize(NeuroEvolution *evo,bool isLearning,configuration config);
+	/**
+	 * Take the next trial's parameters from a channel instead of an
+	 * evolution object. step() returns them unchanged and endEpisode()
+	 * submits the scores to the channel. Blocks until a trial is posted.
+	 * @return false if the channel was closed with no trials left
+	 */
+	bool initialize(ParameterChannel& channel,const LearningConfig& config);
+	/** As above, parsing config first */
+	bool initialize(ParameterChannel& channel,configuration config);
 	std::vector<std::vector<double> > step(double deltaTimeSeconds, std::vector<double> state);
 	void endEpisode(std::vector<double> state);
 
@@ -55,6 +73,10 @@ private:
 	double errorOfFirstController;
     /** Appears unused */
 	double totalTime;
+	/** The channel of the current trial, or NULL. Not owned. */
+	ParameterChannel* m_pChannel;
+	std::size_t m_channelTrial;
+	std::vector< std::vector<double> > m_channelParameters;
 };
 
 #endif /* NEUROADAPTER_H_ */
@@ -0,0 +1,101 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file ParameterChannel.cpp
+ * @brief Contains the implementation of class ParameterChannel.
+ * $Id$
+ */
+
+#include "ParameterChannel.h"
+
+#include <stdexcept>
+
+ParameterChannel::ParameterChannel() :
+m_nextTrial(0),
+m_closed(false)
+{
+}
+
+std::size_t ParameterChannel::post(const Parameters& parameters)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    const std::size_t trial = m_nextTrial++;
+    m_queue.push_back(std::make_pair(trial, parameters));
+    m_scores[trial];
+    m_done[trial] = false;
+    m_posted.notify_one();
+    return trial;
+}
+
+bool ParameterChannel::take(std::size_t& trial, Parameters& parameters)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (m_queue.empty() && !m_closed)
+    {
+        m_posted.wait(lock);
+    }
+    if (m_queue.empty())
+    {
+        return false;
+    }
+    trial = m_queue.front().first;
+    parameters.swap(m_queue.front().second);
+    m_queue.pop_front();
+    return true;
+}
+
+void ParameterChannel::submitScores(std::size_t trial,
+                                    const std::vector<double>& scores)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    std::map<std::size_t, bool>::iterator it = m_done.find(trial);
+    if (it == m_done.end() || it->second)
+    {
+        throw std::invalid_argument("Trial is not awaiting scores");
+    }
+    m_scores[trial] = scores;
+    it->second = true;
+    m_scored.notify_all();
+}
+
+std::vector<double> ParameterChannel::takeScores(std::size_t trial)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    std::map<std::size_t, bool>::iterator it = m_done.find(trial);
+    if (it == m_done.end())
+    {
+        throw std::invalid_argument("Trial was not posted");
+    }
+    while (!it->second)
+    {
+        m_scored.wait(lock);
+    }
+    std::vector<double> scores;
+    scores.swap(m_scores[trial]);
+    m_scores.erase(trial);
+    m_done.erase(it);
+    return scores;
+}
+
+void ParameterChannel::close()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_closed = true;
+    m_posted.notify_all();
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef PARAMETERCHANNEL_H_
+#define PARAMETERCHANNEL_H_
+
+/**
+ * @file ParameterChannel.h
+ * @brief Defines a class ParameterChannel to hand parameters to trials
+ * and scores back to an optimizer within one process.
+ * $Id$
+ */
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <vector>
+
+/**
+ * A thread safe queue of trials between an optimizer living in the same
+ * process as the simulations and the adapters of those simulations. The
+ * optimizer posts one parameter vector per controller for each trial and
+ * collects the scores; AnnealAdapter and NeuroAdapter take the parameters
+ * in initialize() and return the scores in endEpisode(), so no parameter
+ * or score files are written between trials.
+ */
+class ParameterChannel
+{
+public:
+    typedef std::vector< std::vector<double> > Parameters;
+    
+    ParameterChannel();
+    
+    /**
+     * Queue a trial.
+     * @param[in] parameters one vector per controller, returned as is by
+     * the adapter's step()
+     * @return the trial's id, for takeScores()
+     */
+    std::size_t post(const Parameters& parameters);
+    
+    /**
+     * Take the oldest queued trial, blocking until one is posted or the
+     * channel is closed.
+     * @param[out] trial the id to pass to submitScores()
+     * @param[out] parameters the trial's parameters
+     * @return false if the channel was closed with no trials left
+     */
+    bool take(std::size_t& trial, Parameters& parameters);
+    
+    /**
+     * Return the scores of a trial taken with take().
+     * @throw std::invalid_argument if the trial is not awaiting scores
+     */
+    void submitScores(std::size_t trial, const std::vector<double>& scores);
+    
+    /**
+     * Wait for the scores of a posted trial and forget the trial.
+     * @throw std::invalid_argument if the trial was never posted or its
+     * scores were already taken
+     */
+    std::vector<double> takeScores(std::size_t trial);
+    
+    /** Wake every take() waiting for a trial once the queue is empty. */
+    void close();
+    
+private:
+    boost::mutex m_mutex;
+    
+    /** Signalled when a trial is posted or the channel closes */
+    boost::condition_variable m_posted;
+    
+    /** Signalled when scores are submitted */
+    boost::condition_variable m_scored;
+    
+    /** Trials waiting to be taken, oldest first */
+    std::deque< std::pair<std::size_t, Parameters> > m_queue;
+    
+    /** Trials posted but not yet collected; empty until scored */
+    std::map< std::size_t, std::vector<double> > m_scores;
+    
+    /** Trials whose scores have been submitted */
+    std::map< std::size_t, bool > m_done;
+    
+    std::size_t m_nextTrial;
+    
+    bool m_closed;
+};
+
+#endif /* PARAMETERCHANNEL_H_ */
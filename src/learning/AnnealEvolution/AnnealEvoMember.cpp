@@ -26,6 +26,7 @@
  */
 
 #include "AnnealEvoMember.h"
+#include "util/ParameterKernels.h"
 #include <fstream>
 #include <iostream>
 #include <assert.h>
@@ -33,12 +34,12 @@
 
 using namespace std;
 
-AnnealEvoMember::AnnealEvoMember(configuration config)
+AnnealEvoMember::AnnealEvoMember(const LearningConfig& config)
 {
     //readConfigFromXML(configFile);
-    this->numOutputs=config.getintvalue("numberOfActions");
-    this->devBase=config.getDoubleValue("deviation");
-    this->monteCarlo=config.getintvalue("MonteCarlo");
+    this->numOutputs=config.get(LearningConfig::numberOfActions);
+    this->devBase=config.get(LearningConfig::deviation);
+    this->monteCarlo=config.get(LearningConfig::MonteCarlo);
     
     statelessParameters.resize(numOutputs);
     for(int i=0;i<numOutputs;i++)
@@ -51,38 +52,26 @@ AnnealEvoMember::~AnnealEvoMember()
 {
 }
 
-void AnnealEvoMember::mutate(std::tr1::ranlux64_base_01 *eng, double T){
+void AnnealEvoMember::mutate(ParameterKernels& kernels, double T){
     
     assert (T <= 1.0);
-    std::tr1::uniform_real<double> unif(0, 1);
 
-    //TODO: for each weight of the NN with 0.5 probability mutate it
-
-    double dev = devBase * T / 100.0; 
-    std::tr1::normal_distribution<double> normal(0, dev);
-    for(std::size_t i=0;i<statelessParameters.size();i++)
+    if (statelessParameters.empty())
     {
-        double newParam;
-        if (monteCarlo)
-        {
-            newParam= unif(*eng);
-        }
-        else
-        {   
-            double mutAmount = normal(*eng);
-              //std::cout<<"param: "<<i<<" dev: "<<dev<<" rand: "<<mutAmount<<endl;
-            newParam= statelessParameters[i] + mutAmount;
-        }
-
-        if(newParam < 0.0)
-            statelessParameters[i] = 0.0;
-        else if(newParam > 1.0)
-            statelessParameters[i] = 1.0;
-        else
-            statelessParameters[i] =newParam;
+        return;
     }
 
-
+    if (monteCarlo)
+    {
+        kernels.randomize(&statelessParameters[0], statelessParameters.size());
+    }
+    else
+    {
+        // Every parameter moves, clamped to [0, 1]
+        double dev = devBase * T / 100.0; 
+        kernels.mutate(&statelessParameters[0], statelessParameters.size(),
+                        1.0, dev);
+    }
 }
 
 void AnnealEvoMember::copyFrom(AnnealEvoMember* otherMember)
@@ -30,16 +30,18 @@
 
 #include <string>
 #include <vector>
-#include <tr1/random>
-#include "learning/Configuration/configuration.h"
+#include "learning/Configuration/LearningConfig.h"
+
+// Forward Declarations
+class ParameterKernels;
 
 
 class AnnealEvoMember
 {
 public:
-    AnnealEvoMember(configuration config);
+    AnnealEvoMember(const LearningConfig& config);
     ~AnnealEvoMember();
-    void mutate(std::tr1::ranlux64_base_01 *eng, double T);
+    void mutate(ParameterKernels& kernels, double T);
 
     void copyFrom(AnnealEvoMember *otherMember);
     void saveToFile(const char* outputFilename);
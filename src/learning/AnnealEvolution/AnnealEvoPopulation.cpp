@@ -35,12 +35,13 @@
 
 using namespace std;
 
-AnnealEvoPopulation::AnnealEvoPopulation(int populationSize,configuration config)
+AnnealEvoPopulation::AnnealEvoPopulation(int populationSize,const LearningConfig& config) :
+m_config(config)
 {
     compareAverageScores=true;
     clearScoresBetweenGenerations=false;
-    this->compareAverageScores=config.getintvalue("compareAverageScores");
-    this->clearScoresBetweenGenerations=config.getintvalue("clearScoresBetweenGenerations");
+    this->compareAverageScores=config.get(LearningConfig::compareAverageScores);
+    this->clearScoresBetweenGenerations=config.get(LearningConfig::clearScoresBetweenGenerations);
 
     for(int i=0;i<populationSize;i++)
     {
@@ -57,14 +58,14 @@ AnnealEvoPopulation::~AnnealEvoPopulation()
     }
 }
 
-void AnnealEvoPopulation::mutate(std::tr1::ranlux64_base_01 *engPntr,std::size_t numMutate, double T)
+void AnnealEvoPopulation::mutate(ParameterKernels& kernels,std::size_t numMutate, double T)
 {
     for(std::size_t i=0;i<numMutate;i++)
     {
         int copyFrom = 0; // Always copy from the best
         int copyTo = this->controllers.size()-1-i;
         controllers.at(copyTo)->copyFrom(controllers.at(copyFrom));
-        controllers.at(copyTo)->mutate(engPntr, T);
+        controllers.at(copyTo)->mutate(kernels, T);
     }
     return;
 }
@@ -79,14 +80,19 @@ bool AnnealEvoPopulation::comparisonFuncForMax(AnnealEvoMember * elm1, AnnealEvo
 }
 
 
+void AnnealEvoPopulation::average(AnnealEvoMember* member)
+{
+    double ave = std::accumulate(member->pastScores.begin(),member->pastScores.end(),0);
+    ave /=  (double) member->pastScores.size();
+    member->averageScore=ave;
+}
+
 void AnnealEvoPopulation::orderPopulation()
 {
     //calculate each member's average score
     for(std::size_t i=0;i<this->controllers.size();i++)
     {
-        double ave = std::accumulate(controllers[i]->pastScores.begin(),controllers[i]->pastScores.end(),0);
-        ave /=  (double) controllers[i]->pastScores.size();
-        controllers[i]->averageScore=ave;
+        average(controllers[i]);
         if(clearScoresBetweenGenerations)
             controllers[i]->pastScores.clear();
     }
@@ -98,6 +104,44 @@ void AnnealEvoPopulation::orderPopulation()
 
 }
 
+AnnealEvoMember* AnnealEvoPopulation::breed(ParameterKernels& kernels, double T)
+{
+    AnnealEvoMember* newController = new AnnealEvoMember(m_config);
+    newController->copyFrom(controllers.at(0)); // Always copy from the best
+    newController->mutate(kernels, T);
+    return newController;
+}
+
+bool AnnealEvoPopulation::insert(AnnealEvoMember* member)
+{
+    average(member);
+    if (controllers.empty() || !isBetter(member, controllers.back()))
+    {
+        delete member;
+        return false;
+    }
+    delete controllers.back();
+    controllers.pop_back();
+    
+    // The first place it beats, ties go after the members already there
+    std::vector<AnnealEvoMember*>::iterator it = controllers.begin();
+    while (it != controllers.end() && !isBetter(member, *it))
+    {
+        ++it;
+    }
+    controllers.insert(it, member);
+    return true;
+}
+
+bool AnnealEvoPopulation::isBetter(const AnnealEvoMember* elm1, const AnnealEvoMember* elm2) const
+{
+    if (compareAverageScores)
+    {
+        return elm1->averageScore > elm2->averageScore;
+    }
+    return elm1->maxScore > elm2->maxScore;
+}
+
 void AnnealEvoPopulation::readConfigFromXML(std::string configFile)
 {
     int intValue;
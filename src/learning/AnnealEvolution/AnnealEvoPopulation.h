@@ -33,21 +33,39 @@
 
 class AnnealEvoPopulation {
 public:
-    AnnealEvoPopulation(int numControllers,configuration config);
+    AnnealEvoPopulation(int numControllers,const LearningConfig& config);
     ~AnnealEvoPopulation();
     std::vector<AnnealEvoMember *> controllers;
-    void mutate(std::tr1::ranlux64_base_01 *eng,std::size_t numToMutate, double T);
+    void mutate(ParameterKernels& kernels,std::size_t numToMutate, double T);
     void orderPopulation();
     AnnealEvoMember * selectMemberToEvaluate();
     AnnealEvoMember * getMember(int i){return controllers[i];};
+    
+    /**
+     * Breed one new member for steady state evolution: a copy of the best
+     * member, mutated at temperature T. The caller owns it.
+     */
+    AnnealEvoMember* breed(ParameterKernels& kernels, double T);
+    
+    /**
+     * Score a bred member as orderPopulation() would and, if it beats the
+     * last member, put it in its place in the order and delete the last.
+     * Takes ownership.
+     * @return false if the member was deleted instead
+     */
+    bool insert(AnnealEvoMember* member);
 
 private:
+    /** Set the member's averageScore, as orderPopulation() does */
+    static void average(AnnealEvoMember* member);
+    bool isBetter(const AnnealEvoMember* elm1, const AnnealEvoMember* elm2) const;
     static bool comparisonFuncForAverage(AnnealEvoMember * elm1, AnnealEvoMember * elm2);
     static bool comparisonFuncForMax(AnnealEvoMember * elm1, AnnealEvoMember * elm2);
     void readConfigFromXML(std::string configFile);
     bool compareAverageScores;
     bool clearScoresBetweenGenerations;
     int populationSize;
+    LearningConfig m_config;
 };
 
 
@@ -26,36 +26,36 @@
  */
  
 #include "AnnealEvolution.h"
-#include "learning/Configuration/configuration.h"
+#include "learning/Configuration/LearningConfig.h"
+#include "core/tgRandom.h"
 #include "core/tgString.h"
 #include "helpers/FileHelpers.h"
+#include "core/tgStepTimes.h"
+#include "core/tgThreadPool.h"
+#include <algorithm>
 #include <iostream>
+#include <map>
 #include <numeric>
 #include <string>
 #include <sstream>
 #include <stdexcept>
+// Boost
+#include <boost/functional/hash.hpp>
 
 using namespace std;
 
-#ifdef _WIN32
-
-//  Windows
-#define rdtsc  __rdtsc
-
-#else
-
-//  For everything else
-unsigned long long rdtsc(){
-    unsigned int lo,hi;
-    __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
-    return ((unsigned long long)hi << 32) | lo;
-}
-
-#endif
-
 AnnealEvolution::AnnealEvolution(std::string suff, std::string config, std::string path) :
 suffix(suff),
-Temp(1.0)
+Temp(1.0),
+fitnessCache(NULL),
+surrogateNeighbors(0),
+surrogateQuantile(0.25),
+trialTimeLimit(0.0),
+steadyStarted(false),
+steadyTrials(0),
+steadyHanded(0),
+steadyFinished(0),
+generationApplied(0)
 {
     currentTest=0;
     subTests = 0;
@@ -72,26 +72,47 @@ Temp(1.0)
 	
 	std::string configPath = resourcePath + config;
 	
-    configuration myconfigdataaa;
-    myconfigdataaa.readFile(configPath);
-    populationSize=myconfigdataaa.getintvalue("populationSize");
-    numberOfElementsToMutate=myconfigdataaa.getintvalue("numberOfElementsToMutate");
-    numberOfTestsBetweenGenerations=myconfigdataaa.getintvalue("numberOfTestsBetweenGenerations");
-    numberOfSubtests=myconfigdataaa.getintvalue("numberOfSubtests");
-    numberOfControllers=myconfigdataaa.getintvalue("numberOfControllers"); //shared with ManhattanToyController
-    leniencyCoef=myconfigdataaa.getDoubleValue("leniencyCoef");
-    coevolution=myconfigdataaa.getintvalue("coevolution");
-    seeded = myconfigdataaa.getintvalue("startSeed");
+    learningConfig = LearningConfig(configPath);
+    populationSize=learningConfig.get(LearningConfig::populationSize);
+    numberOfElementsToMutate=learningConfig.get(LearningConfig::numberOfElementsToMutate);
+    numberOfTestsBetweenGenerations=learningConfig.get(LearningConfig::numberOfTestsBetweenGenerations);
+    numberOfSubtests=learningConfig.get(LearningConfig::numberOfSubtests);
+    numberOfControllers=learningConfig.get(LearningConfig::numberOfControllers); //shared with ManhattanToyController
+    leniencyCoef=learningConfig.get(LearningConfig::leniencyCoef);
+    coevolution=learningConfig.get(LearningConfig::coevolution);
+    seeded = learningConfig.get(LearningConfig::startSeed);
+    
+    bool learning = learningConfig.get(LearningConfig::learning);
     
-    bool learning = myconfigdataaa.getintvalue("learning");
+    checkpointInterval = learningConfig.get(LearningConfig::checkpointInterval, 1);
+    saveCheckpoints = learningConfig.get(LearningConfig::saveCheckpoints, 0);
+
+    if (learningConfig.has(LearningConfig::fitnessCacheResolution))
+    {
+        if (numberOfSubtests != 1)
+        {
+            throw std::invalid_argument("The fitness cache needs numberOfSubtests of 1");
+        }
+        const int capacity = learningConfig.get(LearningConfig::fitnessCacheSize, 10000);
+        fitnessCache = new FitnessCache(learningConfig.get(LearningConfig::fitnessCacheResolution), capacity);
+        surrogateNeighbors = learningConfig.get(LearningConfig::surrogateNeighbors, surrogateNeighbors);
+        surrogateQuantile = learningConfig.get(LearningConfig::surrogateQuantile, surrogateQuantile);
+    }
+    trialTimeLimit = learningConfig.get(LearningConfig::trialTimeLimit, trialTimeLimit);
 
-    srand(rdtsc());
-    eng.seed(rdtsc());
+    // Every draw follows the master seed, see tgRandom. A learner's
+    // stream is named by its suffix, so two learners differ.
+    tgRandom rng(tgRandom::eLearning, boost::hash<std::string>()(suffix));
+    // neuralNetwork draws its initial weights from rand()
+    srand(rng.next());
+    kernels.seed(rng.next64(), 0);
 
     for(int j=0;j<numberOfControllers;j++)
     {
-        populations.push_back(new AnnealEvoPopulation(populationSize,myconfigdataaa));
+        populations.push_back(new AnnealEvoPopulation(populationSize,learningConfig));
     }
+    // The members drew their parameters from rand(); draw them again
+    randomizeMembers();
     
     // Overwrite the random parameters based on data
     if(seeded) // Test that the file exists
@@ -104,18 +125,24 @@ Temp(1.0)
             seededPop->loadFromFile(ss.str().c_str());
         }
     }
+    // The crashed run's logs are continued
+    const bool resumed = learningConfig.get(LearningConfig::resume, 0) && loadCheckpoint();
     if(learning)
     {
-        evolutionLog.open((resourcePath + "logs/evolution" + suffix + ".csv").c_str(),ios::out);
+        evolutionLog.open((resourcePath + "logs/evolution" + suffix + ".csv").c_str(),
+                            resumed ? ios::app : ios::out);
         if (!evolutionLog.is_open())
         {
 			throw std::runtime_error("Logs does not exist. Please create a logs folder in your build directory or update your cmake file");
 		}
     }
+    
+    scoresLog.open((resourcePath + "logs/scores.csv").c_str(),ios::app);
 }
 
 AnnealEvolution::~AnnealEvolution()
 {
+    delete fitnessCache;
     // @todo - solve the invalid pointer that occurs here
     #if (0)
     for(std::size_t i = 0; i < populations.size(); i++)
@@ -130,7 +157,7 @@ void AnnealEvolution::mutateEveryController()
 {
     for(std::size_t i=0;i<populations.size();i++)
     {
-        populations.at(i)->mutate(&eng,numberOfElementsToMutate, Temp);
+        populations.at(i)->mutate(kernels,numberOfElementsToMutate, Temp);
     }
 }
 
@@ -139,12 +166,22 @@ void AnnealEvolution::mutateEveryController()
 void AnnealEvolution::orderAllPopulations()
 {
     generationNumber++;
-    double aveScore1 = 0.0;
-    double aveScore2 = 0.0;
 #if (0)
     // Disable definition of unused variables to suppress compiler warning
     double maxScore1,maxScore2;
 #endif
+
+    for(std::size_t i=0;i<populations.size();i++)
+    {
+        populations.at(i)->orderPopulation();
+    }
+    logGeneration();
+}
+
+void AnnealEvolution::logGeneration()
+{
+    double aveScore1 = 0.0;
+    double aveScore2 = 0.0;
     for(std::size_t i=0;i<scoresOfTheGeneration.size();i++)
     {
         aveScore1+=scoresOfTheGeneration[i][0];
@@ -153,11 +190,6 @@ void AnnealEvolution::orderAllPopulations()
     aveScore1 /= scoresOfTheGeneration.size();
     aveScore2 /= scoresOfTheGeneration.size();
 
-
-    for(std::size_t i=0;i<populations.size();i++)
-    {
-        populations.at(i)->orderPopulation();
-    }
     evolutionLog<<generationNumber*numberOfTestsBetweenGenerations<<","<<aveScore1<<","<<aveScore2<<",";
     evolutionLog<<populations.at(0)->getMember(0)->maxScore<<","<<populations.at(0)->getMember(0)->maxScore1<<","<<populations.at(0)->getMember(0)->maxScore2<<endl;
     
@@ -165,7 +197,12 @@ void AnnealEvolution::orderAllPopulations()
     // what if member at 0 isn't the best of all time for some reason? 
     // This seems biased towards average scores
     // We actually order the populations, so member 0 is the current best according to the assigned fitness
-    ofstream logfileLeader;
+    // Leader files and buffered scores only reach the disk at checkpoints
+    if (generationNumber % checkpointInterval != 0)
+    {
+        return;
+    }
+    scoresLog.flush();
     for(std::size_t i=0;i<populations.size();i++)
     {
         stringstream ss;
@@ -186,13 +223,7 @@ double diffclock(clock_t clock1,clock_t clock2)
 
 vector <AnnealEvoMember *> AnnealEvolution::nextSetOfControllers()
 {
-    int testsToDo=0;
-    if(coevolution)
-        testsToDo=numberOfTestsBetweenGenerations; //stop when we reach x amount of random tests
-    else
-        testsToDo=populationSize; //stop when we test each element once
-
-    if(currentTest == testsToDo)
+    if(currentTest == testsToDo())
     {
         orderAllPopulations();
         mutateEveryController();
@@ -204,6 +235,12 @@ vector <AnnealEvoMember *> AnnealEvolution::nextSetOfControllers()
             currentTest=0;//Start from 0
         else
             currentTest=populationSize-numberOfElementsToMutate; //start from the mutated ones only (last x)
+        
+        // Nothing of the new generation has run, so it resumes from here
+        if (saveCheckpoints && generationNumber % checkpointInterval == 0)
+        {
+            saveCheckpoint();
+        }
     }
 
     selectedControllers.clear();
@@ -211,7 +248,7 @@ vector <AnnealEvoMember *> AnnealEvolution::nextSetOfControllers()
     {
         int selectedOne=0;
         if(coevolution)
-            selectedOne=rand()%populationSize; //select random one from each pool
+            selectedOne=static_cast<int>(kernels.uniform()*populationSize); //select random one from each pool
         else
             selectedOne=currentTest; //select the same from each pool
 
@@ -232,6 +269,13 @@ vector <AnnealEvoMember *> AnnealEvolution::nextSetOfControllers()
 }
 
 void AnnealEvolution::updateScores(vector <double> multiscore)
+{
+    cacheScores(selectedControllers, multiscore);
+    applyScores(selectedControllers, multiscore);
+}
+
+void AnnealEvolution::applyScores(const vector <AnnealEvoMember *>& controllers,
+                        vector <double> multiscore)
 {
     if(multiscore.size()==2)
         this->scoresOfTheGeneration.push_back(multiscore);
@@ -240,13 +284,11 @@ void AnnealEvolution::updateScores(vector <double> multiscore)
     double score=1.0* multiscore[0] - 0.0 * multiscore[1];
     
     //Record it to the file
-    ofstream payloadLog;
-    payloadLog.open((resourcePath + "logs/scores.csv").c_str(),ios::app);
-    payloadLog<<multiscore[0]<<","<<multiscore[1];
+    scoresLog<<multiscore[0]<<","<<multiscore[1];
     
-    for(std::size_t oneElem=0;oneElem<selectedControllers.size();oneElem++)
+    for(std::size_t oneElem=0;oneElem<controllers.size();oneElem++)
     {
-        AnnealEvoMember * controllerPointer=selectedControllers.at(oneElem);
+        AnnealEvoMember * controllerPointer=controllers.at(oneElem);
 
         controllerPointer->pastScores.push_back(score);
         double prevScore=controllerPointer->maxScore;
@@ -264,11 +306,424 @@ void AnnealEvolution::updateScores(vector <double> multiscore)
         std::size_t n = controllerPointer->statelessParameters.size();
         for (std::size_t i = 0; i < n; i++)
         {
-            payloadLog << "," << controllerPointer->statelessParameters[i];
+            scoresLog << "," << controllerPointer->statelessParameters[i];
         }
     }
 
-    payloadLog<<endl;
-    payloadLog.close();
+    scoresLog<<"\n";
     return;
 }
+
+bool AnnealEvolution::trialParameters(const vector <AnnealEvoMember *>& controllers,
+                        vector<double>& params) const
+{
+    params.clear();
+    for (std::size_t i = 0; i < controllers.size(); i++)
+    {
+        const vector<double>& p = controllers[i]->statelessParameters;
+        if (p.empty())
+        {
+            return false;
+        }
+        params.insert(params.end(), p.begin(), p.end());
+    }
+    return !params.empty();
+}
+
+bool AnnealEvolution::screenTrial(const vector <AnnealEvoMember *>& controllers,
+                        vector<double>& scores) const
+{
+    vector<double> params;
+    if (fitnessCache == NULL || !trialParameters(controllers, params))
+    {
+        return false;
+    }
+    if (fitnessCache->find(params, scores))
+    {
+        return true;
+    }
+    
+    // A predicted score stays out of the generation's averages, as an
+    // exploded trial's does
+    double predicted = 0.0;
+    if (surrogateNeighbors > 0 &&
+        fitnessCache->predict(params, surrogateNeighbors, predicted) &&
+        predicted < fitnessCache->quantile(surrogateQuantile))
+    {
+        scores.assign(1, predicted);
+        return true;
+    }
+    return false;
+}
+
+void AnnealEvolution::cacheScores(const vector <AnnealEvoMember *>& controllers,
+                        const vector<double>& scores)
+{
+    vector<double> params;
+    if (fitnessCache != NULL && trialParameters(controllers, params))
+    {
+        fitnessCache->insert(params, scores);
+    }
+}
+
+std::string AnnealEvolution::checkpointPath() const
+{
+    return resourcePath + "logs/checkpoint" + suffix + ".bin";
+}
+
+void AnnealEvolution::randomizeMembers()
+{
+    for (std::size_t i = 0; i < populations.size(); i++)
+    {
+        for (std::size_t j = 0; j < populations[i]->controllers.size(); j++)
+        {
+            std::vector<double>& params = populations[i]->controllers[j]->statelessParameters;
+            if (!params.empty())
+            {
+                kernels.randomize(&params[0], params.size());
+            }
+        }
+    }
+}
+
+void AnnealEvolution::saveCheckpoint()
+{
+    // The last save must be done with the buffer before it is refilled
+    checkpoint.wait();
+    
+    checkpoint.generationNumber = generationNumber;
+    checkpoint.currentTest = currentTest;
+    checkpoint.subTests = subTests;
+    checkpoint.temperature = Temp;
+    checkpoint.kernels = kernels.getState();
+    
+    checkpoint.populations.resize(populations.size());
+    for (std::size_t i = 0; i < populations.size(); i++)
+    {
+        const vector<AnnealEvoMember*>& members = populations[i]->controllers;
+        vector<EvolutionCheckpoint::Member>& saved = checkpoint.populations[i];
+        saved.resize(members.size());
+        for (std::size_t j = 0; j < members.size(); j++)
+        {
+            saved[j].parameters = members[j]->statelessParameters;
+            saved[j].pastScores = members[j]->pastScores;
+            saved[j].maxScore = members[j]->maxScore;
+            saved[j].maxScore1 = members[j]->maxScore1;
+            saved[j].maxScore2 = members[j]->maxScore2;
+            saved[j].averageScore = members[j]->averageScore;
+        }
+    }
+    
+    checkpoint.save(checkpointPath());
+}
+
+bool AnnealEvolution::loadCheckpoint()
+{
+    if (!checkpoint.load(checkpointPath()))
+    {
+        return false;
+    }
+    
+    if (checkpoint.populations.size() != populations.size())
+    {
+        throw std::invalid_argument("The checkpoint has a different numberOfControllers");
+    }
+    for (std::size_t i = 0; i < populations.size(); i++)
+    {
+        const vector<AnnealEvoMember*>& members = populations[i]->controllers;
+        const vector<EvolutionCheckpoint::Member>& saved = checkpoint.populations[i];
+        if (saved.size() != members.size())
+        {
+            throw std::invalid_argument("The checkpoint has a different populationSize");
+        }
+        for (std::size_t j = 0; j < members.size(); j++)
+        {
+            if (saved[j].parameters.size() != members[j]->statelessParameters.size())
+            {
+                throw std::invalid_argument("The checkpoint has a different numberOfActions");
+            }
+            members[j]->statelessParameters = saved[j].parameters;
+            members[j]->pastScores = saved[j].pastScores;
+            members[j]->maxScore = saved[j].maxScore;
+            members[j]->maxScore1 = saved[j].maxScore1;
+            members[j]->maxScore2 = saved[j].maxScore2;
+            members[j]->averageScore = saved[j].averageScore;
+        }
+    }
+    
+    if (checkpoint.currentTest < 0 || checkpoint.currentTest > testsToDo() ||
+        checkpoint.subTests < 0 || checkpoint.subTests >= numberOfSubtests)
+    {
+        throw std::invalid_argument("The checkpoint's trial doesn't fit the configuration");
+    }
+    generationNumber = checkpoint.generationNumber;
+    currentTest = checkpoint.currentTest;
+    subTests = checkpoint.subTests;
+    Temp = checkpoint.temperature;
+    kernels.setState(checkpoint.kernels);
+    
+    cout << "Resuming from generation " << generationNumber << endl;
+    return true;
+}
+
+int AnnealEvolution::testsToDo() const
+{
+    if(coevolution)
+        return numberOfTestsBetweenGenerations; //stop when we reach x amount of random tests
+    else
+        return populationSize; //stop when we test each element once
+}
+
+vector< vector <AnnealEvoMember *> > AnnealEvolution::nextGeneration()
+{
+    boost::mutex::scoped_lock lock(scoresMutex);
+    if (generationApplied < generationTrials.size())
+    {
+        throw std::runtime_error("Scores of the last generation are missing");
+    }
+    
+    generationTrials.clear();
+    do
+    {
+        generationTrials.push_back(nextSetOfControllers());
+    }
+    while (currentTest < testsToDo());
+    
+    generationScores.assign(generationTrials.size(), vector<double>());
+    generationScored.assign(generationTrials.size(), false);
+    generationSimulated.assign(generationTrials.size(), true);
+    generationApplied = 0;
+    
+    return generationTrials;
+}
+
+void AnnealEvolution::updateScores(std::size_t trial, vector <double> scores)
+{
+    boost::mutex::scoped_lock lock(scoresMutex);
+    if (trial >= generationTrials.size() || generationScored[trial])
+    {
+        throw std::invalid_argument("Trial is not awaiting scores");
+    }
+    generationScores[trial] = scores;
+    generationScored[trial] = true;
+    
+    // Apply in trial order, as a serial run would
+    while (generationApplied < generationTrials.size() &&
+            generationScored[generationApplied])
+    {
+        if (generationSimulated[generationApplied])
+        {
+            cacheScores(generationTrials[generationApplied],
+                        generationScores[generationApplied]);
+        }
+        applyScores(generationTrials[generationApplied],
+                    generationScores[generationApplied]);
+        generationApplied++;
+    }
+}
+
+namespace
+{
+    /** Runs the listed trials of one generation on a tgThreadPool */
+    class AnnealEvolutionTask : public tgThreadPool::Task
+    {
+    public:
+        AnnealEvolutionTask(AnnealEvolution& evolution,
+                    AnnealEvolution::Evaluator& evaluator,
+                    const vector< vector <AnnealEvoMember *> >& trials,
+                    const vector<std::size_t>& items) :
+        m_evolution(evolution),
+        m_evaluator(evaluator),
+        m_trials(trials),
+        m_items(items)
+        {
+        }
+        
+        virtual void operator()(std::size_t item)
+        {
+            const std::size_t trial = m_items[item];
+            m_evolution.updateScores(trial, m_evaluator.evaluate(m_trials[trial], trial));
+        }
+        
+    private:
+        AnnealEvolution& m_evolution;
+        AnnealEvolution::Evaluator& m_evaluator;
+        const vector< vector <AnnealEvoMember *> >& m_trials;
+        const vector<std::size_t>& m_items;
+    };
+}
+
+void AnnealEvolution::evaluateGeneration(Evaluator& evaluator, tgThreadPool& pool)
+{
+    const vector< vector <AnnealEvoMember *> > trials = nextGeneration();
+    
+    // Simulate each distinct trial once; the others take the cache's
+    // scores, the surrogate's, or those of their twin in this generation
+    vector<std::size_t> simulated;
+    vector< std::pair<std::size_t, std::size_t> > twins;
+    std::map<FitnessCache::Key, std::size_t> firstOf;
+    vector<double> params;
+    vector<double> scores;
+    for (std::size_t t = 0; t < trials.size(); t++)
+    {
+        if (screenTrial(trials[t], scores))
+        {
+            {
+                boost::mutex::scoped_lock lock(scoresMutex);
+                generationSimulated[t] = false;
+            }
+            updateScores(t, scores);
+            continue;
+        }
+        if (fitnessCache != NULL && trialParameters(trials[t], params))
+        {
+            const FitnessCache::Key key = fitnessCache->quantize(params);
+            std::map<FitnessCache::Key, std::size_t>::const_iterator it = firstOf.find(key);
+            if (it != firstOf.end())
+            {
+                twins.push_back(std::make_pair(t, it->second));
+                continue;
+            }
+            firstOf[key] = t;
+        }
+        simulated.push_back(t);
+    }
+    
+    AnnealEvolutionTask task(*this, evaluator, trials, simulated);
+    pool.run(task, simulated.size());
+    
+    for (std::size_t i = 0; i < twins.size(); i++)
+    {
+        {
+            boost::mutex::scoped_lock lock(scoresMutex);
+            scores = generationScores[twins[i].second];
+            generationSimulated[twins[i].first] = false;
+        }
+        updateScores(twins[i].first, scores);
+    }
+}
+
+namespace
+{
+    /** One worker of evaluateSteadyState() */
+    class SteadyStateTask : public tgThreadPool::Task
+    {
+    public:
+        SteadyStateTask(AnnealEvolution& evolution,
+                    AnnealEvolution::Evaluator& evaluator) :
+        m_evolution(evolution),
+        m_evaluator(evaluator)
+        {
+        }
+        
+        virtual void operator()(std::size_t item)
+        {
+            m_evolution.runSteadyState(m_evaluator);
+        }
+        
+    private:
+        AnnealEvolution& m_evolution;
+        AnnealEvolution::Evaluator& m_evaluator;
+    };
+}
+
+void AnnealEvolution::evaluateSteadyState(Evaluator& evaluator, tgThreadPool& pool, std::size_t trials)
+{
+    if (coevolution)
+    {
+        throw std::invalid_argument("Steady state evolution needs coevolution 0");
+    }
+    
+    // Every member needs a score to be bred by
+    if (!steadyStarted)
+    {
+        evaluateGeneration(evaluator, pool);
+        for (std::size_t i = 0; i < populations.size(); i++)
+        {
+            populations[i]->orderPopulation();
+        }
+        scoresOfTheGeneration.clear();
+        steadyStarted = true;
+    }
+    
+    {
+        boost::mutex::scoped_lock lock(scoresMutex);
+        steadyTrials = trials;
+        steadyHanded = 0;
+    }
+    SteadyStateTask task(*this, evaluator);
+    pool.run(task, std::min(pool.size(), trials));
+}
+
+void AnnealEvolution::runSteadyState(Evaluator& evaluator)
+{
+    while (true)
+    {
+        vector <AnnealEvoMember *> children;
+        vector <double> scores;
+        std::size_t trial = 0;
+        bool screened = false;
+        {
+            boost::mutex::scoped_lock lock(scoresMutex);
+            if (steadyHanded == steadyTrials)
+            {
+                return;
+            }
+            trial = steadyHanded++;
+            for (std::size_t i = 0; i < populations.size(); i++)
+            {
+                children.push_back(populations[i]->breed(kernels, Temp));
+            }
+            screened = screenTrial(children, scores);
+            if (screened)
+            {
+                applyScores(children, scores);
+            }
+        }
+        
+        bool inTime = true;
+        for (int i = 0; i < numberOfSubtests && !screened; i++)
+        {
+            const long long start = tgStepTimes::now();
+            scores = evaluator.evaluateWithin(children, trial, trialTimeLimit);
+            if (trialTimeLimit > 0.0 &&
+                (tgStepTimes::now() - start) * 1.0e-9 > trialTimeLimit)
+            {
+                inTime = false;
+                break;
+            }
+            boost::mutex::scoped_lock lock(scoresMutex);
+            if (i == 0)
+            {
+                cacheScores(children, scores);
+            }
+            applyScores(children, scores);
+        }
+        
+        boost::mutex::scoped_lock lock(scoresMutex);
+        for (std::size_t i = 0; i < children.size(); i++)
+        {
+            if (inTime)
+            {
+                populations[i]->insert(children[i]);
+            }
+            else
+            {
+                delete children[i];
+            }
+        }
+        if (!inTime)
+        {
+            cout << "Dropped trial " << trial << " over the time limit" << endl;
+            continue;
+        }
+        
+        // As many trials as a generation has make one in the logs
+        if (++steadyFinished % testsToDo() == 0 && !scoresOfTheGeneration.empty())
+        {
+            generationNumber++;
+            logGeneration();
+            scoresOfTheGeneration.clear();
+        }
+    }
+}
@@ -30,12 +30,51 @@
 
 #include "AnnealEvoPopulation.h"
 #include "AnnealEvoMember.h"
+#include "util/ParameterKernels.h"
+#include "util/FitnessCache.h"
+#include "util/EvolutionCheckpoint.h"
 #include <fstream>
+#include <boost/thread/mutex.hpp>
 #include <boost/iterator/iterator_concepts.hpp>
 
+// Forward declarations
+class tgThreadPool;
+
 class AnnealEvolution
 {
 public:
+    /**
+     * Runs one trial for evaluateGeneration(). Implementations are called
+     * concurrently, so each call must use its own simulation.
+     */
+    class Evaluator
+    {
+    public:
+        virtual ~Evaluator() { }
+        
+        /**
+         * @param[in] controllers one member of each population
+         * @param[in] trial the index of the trial in the generation
+         * @return the scores, as passed to updateScores()
+         */
+        virtual std::vector<double> evaluate(const std::vector< AnnealEvoMember *>& controllers,
+                                                std::size_t trial) = 0;
+        
+        /**
+         * Score a trial of evaluateSteadyState() that should end within
+         * timeLimit seconds of wall clock time, from the trialTimeLimit
+         * key. A trial can't be interrupted, so an evaluator keeps to the
+         * limit itself, e.g. by a controller calling
+         * tgModel::requestStop() once it passed. The default ignores it;
+         * the scores of trials that overran are discarded either way.
+         */
+        virtual std::vector<double> evaluateWithin(const std::vector< AnnealEvoMember *>& controllers,
+                                                    std::size_t trial, double timeLimit)
+        {
+            return evaluate(controllers, trial);
+        }
+    };
+    
     AnnealEvolution(std::string suffix, std::string config = "config.ini", std::string path = "");
     ~AnnealEvolution();
     void mutateEveryController();
@@ -43,14 +82,127 @@ public:
     void evaluatePopulation();
     std::vector< AnnealEvoMember *> nextSetOfControllers();
     void updateScores(std::vector<double> scores);
+    
+    /**
+     * Hand out every trial left before the populations are next ordered,
+     * as nextSetOfControllers() would one at a time. Scores may then be
+     * given in any order, from any thread, with updateScores(trial, ...);
+     * they are applied in trial order, so the outcome matches a serial run.
+     * @throw std::runtime_error if scores of the last generation are missing
+     */
+    std::vector< std::vector< AnnealEvoMember *> > nextGeneration();
+    
+    /**
+     * Record the scores of one trial from nextGeneration(). Thread safe.
+     * @throw std::invalid_argument if the trial is out of range or was
+     * already scored
+     */
+    void updateScores(std::size_t trial, std::vector<double> scores);
+    
+    /**
+     * Run a whole generation from nextGeneration() on a pool, one trial
+     * per item, and record the scores. With the optional
+     * fitnessCacheResolution key, trials whose parameters were already
+     * simulated, or repeat another trial of the generation, take the
+     * earlier scores instead; with surrogateNeighbors, trials whose
+     * nearest neighbours predict a score below the surrogateQuantile
+     * (default 0.25) of the cache take the prediction. Both assume
+     * deterministic trials and a numberOfSubtests of 1.
+     */
+    void evaluateGeneration(Evaluator& evaluator, tgThreadPool& pool);
+    
+    /**
+     * Evolve without waiting for generations: as soon as a worker of the
+     * pool finishes a trial, it breeds the next, a copy of the best
+     * members as they are mutated at the current temperature, and the
+     * child takes the place of the worst member if it beats it. Workers
+     * never wait for the slowest trial, which suits trials of very
+     * different lengths.
+     *
+     * The first call scores the initial population with
+     * evaluateGeneration(). Each trial is run numberOfSubtests times, and
+     * with the optional trialTimeLimit key (seconds of wall clock time) a
+     * trial that overruns is dropped. The fitness cache is used as by
+     * evaluateGeneration(). Every testsToDo() trials count as a
+     * generation in the logs and leader files. There are no checkpoints;
+     * don't mix with nextGeneration().
+     * @param[in] trials the number of children to try
+     * @throw std::invalid_argument if coevolution is set, since the
+     * other populations' partners could be replaced while in a trial
+     */
+    void evaluateSteadyState(Evaluator& evaluator, tgThreadPool& pool, std::size_t trials);
+    
+    /**
+     * Breed, run and insert trials of evaluateSteadyState() until the
+     * number asked for are handed out. Called by each worker.
+     */
+    void runSteadyState(Evaluator& evaluator);
+    
+    /** The configuration, parsed once, for the adapters */
+    const LearningConfig& getConfig() const { return learningConfig; }
+    
+    /**
+     * logs/checkpoint<suffix>.bin, written every checkpointInterval
+     * generations if saveCheckpoints is set and read at construction if
+     * resume is set
+     */
+    std::string checkpointPath() const;
+    
     const std::string suffix;
     /// @todo make this const if we decide to force everyone to put their logs in resources
     std::string resourcePath;
     
 private:
+    /** The number of trials between orderings of the populations */
+    int testsToDo() const;
+    
+    /**
+     * Log the generation's scores and, every checkpointInterval
+     * generations, write the leaders' parameter files
+     */
+    void logGeneration();
+    
+    /** Score one set of controllers */
+    void applyScores(const std::vector< AnnealEvoMember *>& controllers,
+                        std::vector<double> multiscore);
+    
+    /**
+     * Concatenate the parameters of one set of controllers
+     * @return false if a controller has none
+     */
+    bool trialParameters(const std::vector< AnnealEvoMember *>& controllers,
+                            std::vector<double>& params) const;
+    
+    /**
+     * Find the scores of a trial in the cache, or predict them
+     * @return false if the trial has to be simulated
+     */
+    bool screenTrial(const std::vector< AnnealEvoMember *>& controllers,
+                        std::vector<double>& scores) const;
+    
+    /** Add the simulated scores of a trial to the cache, if any */
+    void cacheScores(const std::vector< AnnealEvoMember *>& controllers,
+                        const std::vector<double>& scores);
+    
+    /** Draw the stateless members' parameters from kernels */
+    void randomizeMembers();
+    
+    /** Copy the state between generations to checkpoint and save it */
+    void saveCheckpoint();
+    
+    /**
+     * Continue from the checkpoint file. The populations, counters,
+     * temperature and kernels, and so the coevolution pairing, are
+     * exactly those of the crashed run.
+     * @return false if there is no checkpoint
+     * @throw std::invalid_argument if it doesn't fit the configuration
+     */
+    bool loadCheckpoint();
+    
+    LearningConfig learningConfig;
     int populationSize;
     int numberOfControllers;
-    std::tr1::ranlux64_base_01 eng;
+    ParameterKernels kernels;
     std::vector< AnnealEvoPopulation *> populations;
     std::vector <AnnealEvoMember *>  selectedControllers;
     std::vector< std::vector< double > > scoresOfTheGeneration;
@@ -62,12 +214,50 @@ private:
     double Temp;
     bool coevolution;
     std::ofstream evolutionLog;
+    /** logs/scores.csv, kept open and flushed at each checkpoint */
+    std::ofstream scoresLog;
+    /**
+     * Generations between writes of the leaders' parameter files, from
+     * the optional checkpointInterval key; 1 if absent
+     */
+    int checkpointInterval;
+    /** Whether to save checkpoints, from the optional saveCheckpoints key */
+    bool saveCheckpoints;
+    /** The state last saved or loaded; saves in the background */
+    EvolutionCheckpoint checkpoint;
     int currentTest;
     int numberOfTestsBetweenGenerations;
     int generationNumber;
     int numberOfElementsToMutate;
     int numberOfSubtests;
     int subTests;
+    
+    /** Scores by the parameters of their trial, NULL if not cached */
+    FitnessCache* fitnessCache;
+    /** The neighbours of the surrogate, 0 to only reuse repeats */
+    int surrogateNeighbors;
+    double surrogateQuantile;
+    
+    /** Seconds of wall clock time a steady state trial may take, 0 for any */
+    double trialTimeLimit;
+    /** Whether evaluateSteadyState() scored the initial population */
+    bool steadyStarted;
+    /** The trials of the current evaluateSteadyState() and those handed out */
+    std::size_t steadyTrials;
+    std::size_t steadyHanded;
+    /** The steady state trials finished, for the generations of the logs */
+    std::size_t steadyFinished;
+    
+    /** The trials handed out by nextGeneration() */
+    std::vector< std::vector< AnnealEvoMember *> > generationTrials;
+    std::vector< std::vector<double> > generationScores;
+    std::vector<bool> generationScored;
+    /** False for the trials whose scores were not simulated */
+    std::vector<bool> generationSimulated;
+    /** The trials whose scores have been applied, a prefix */
+    std::size_t generationApplied;
+    /** Guards the generation's scores and everything they update */
+    boost::mutex scoresMutex;
 };
 
 #endif /* ANNEALEVOLUTION_H_ */
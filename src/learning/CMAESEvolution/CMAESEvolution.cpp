@@ -0,0 +1,817 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file CMAESEvolution.cpp
+ * @brief Contains the implementation of class CMAESEvolution
+ * $Id$
+ */
+ 
+#include "CMAESEvolution.h"
+#include "learning/Configuration/LearningConfig.h"
+#include "helpers/FileHelpers.h"
+#include "core/tgThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace
+{
+    /**
+     * Reduce the symmetric matrix V (row major) to tridiagonal form by
+     * Householder reflections, accumulating the transformation in V.
+     * The diagonal is left in d and the subdiagonal in e[1..n-1].
+     * After the EISPACK routine tred2, by way of JAMA.
+     */
+    void tridiagonalize(vector<double>& V, vector<double>& d,
+                        vector<double>& e, int n)
+    {
+        for (int j = 0; j < n; j++)
+        {
+            d[j] = V[(n - 1) * n + j];
+        }
+        
+        for (int i = n - 1; i > 0; i--)
+        {
+            double scale = 0.0;
+            double h = 0.0;
+            for (int k = 0; k < i; k++)
+            {
+                scale += fabs(d[k]);
+            }
+            if (scale == 0.0)
+            {
+                e[i] = d[i - 1];
+                for (int j = 0; j < i; j++)
+                {
+                    d[j] = V[(i - 1) * n + j];
+                    V[i * n + j] = 0.0;
+                    V[j * n + i] = 0.0;
+                }
+            }
+            else
+            {
+                for (int k = 0; k < i; k++)
+                {
+                    d[k] /= scale;
+                    h += d[k] * d[k];
+                }
+                double f = d[i - 1];
+                double g = sqrt(h);
+                if (f > 0.0)
+                {
+                    g = -g;
+                }
+                e[i] = scale * g;
+                h -= f * g;
+                d[i - 1] = f - g;
+                for (int j = 0; j < i; j++)
+                {
+                    e[j] = 0.0;
+                }
+                for (int j = 0; j < i; j++)
+                {
+                    f = d[j];
+                    V[j * n + i] = f;
+                    g = e[j] + V[j * n + j] * f;
+                    for (int k = j + 1; k <= i - 1; k++)
+                    {
+                        g += V[k * n + j] * d[k];
+                        e[k] += V[k * n + j] * f;
+                    }
+                    e[j] = g;
+                }
+                f = 0.0;
+                for (int j = 0; j < i; j++)
+                {
+                    e[j] /= h;
+                    f += e[j] * d[j];
+                }
+                const double hh = f / (h + h);
+                for (int j = 0; j < i; j++)
+                {
+                    e[j] -= hh * d[j];
+                }
+                for (int j = 0; j < i; j++)
+                {
+                    f = d[j];
+                    g = e[j];
+                    for (int k = j; k <= i - 1; k++)
+                    {
+                        V[k * n + j] -= (f * e[k] + g * d[k]);
+                    }
+                    d[j] = V[(i - 1) * n + j];
+                    V[i * n + j] = 0.0;
+                }
+            }
+            d[i] = h;
+        }
+        
+        // Accumulate the transformations
+        for (int i = 0; i < n - 1; i++)
+        {
+            V[(n - 1) * n + i] = V[i * n + i];
+            V[i * n + i] = 1.0;
+            const double h = d[i + 1];
+            if (h != 0.0)
+            {
+                for (int k = 0; k <= i; k++)
+                {
+                    d[k] = V[k * n + i + 1] / h;
+                }
+                for (int j = 0; j <= i; j++)
+                {
+                    double g = 0.0;
+                    for (int k = 0; k <= i; k++)
+                    {
+                        g += V[k * n + i + 1] * V[k * n + j];
+                    }
+                    for (int k = 0; k <= i; k++)
+                    {
+                        V[k * n + j] -= g * d[k];
+                    }
+                }
+            }
+            for (int k = 0; k <= i; k++)
+            {
+                V[k * n + i + 1] = 0.0;
+            }
+        }
+        for (int j = 0; j < n; j++)
+        {
+            d[j] = V[(n - 1) * n + j];
+            V[(n - 1) * n + j] = 0.0;
+        }
+        V[(n - 1) * n + n - 1] = 1.0;
+        e[0] = 0.0;
+    }
+    
+    /**
+     * Diagonalize the tridiagonal matrix from tridiagonalize() by the
+     * implicit QL method, leaving the eigenvalues in d and the
+     * eigenvectors in the columns of V. After the EISPACK routine tql2.
+     */
+    void diagonalize(vector<double>& V, vector<double>& d,
+                     vector<double>& e, int n)
+    {
+        for (int i = 1; i < n; i++)
+        {
+            e[i - 1] = e[i];
+        }
+        e[n - 1] = 0.0;
+        
+        double f = 0.0;
+        double tst1 = 0.0;
+        const double eps = pow(2.0, -52.0);
+        for (int l = 0; l < n; l++)
+        {
+            tst1 = max(tst1, fabs(d[l]) + fabs(e[l]));
+            int m = l;
+            while (m < n - 1 && fabs(e[m]) > eps * tst1)
+            {
+                m++;
+            }
+            
+            if (m > l)
+            {
+                // Iterate until e[l] vanishes, bounded in case it won't
+                for (int iter = 0; iter < 60 && fabs(e[l]) > eps * tst1; iter++)
+                {
+                    double g = d[l];
+                    double p = (d[l + 1] - g) / (2.0 * e[l]);
+                    double r = sqrt(p * p + 1.0);
+                    if (p < 0.0)
+                    {
+                        r = -r;
+                    }
+                    d[l] = e[l] / (p + r);
+                    d[l + 1] = e[l] * (p + r);
+                    const double dl1 = d[l + 1];
+                    double h = g - d[l];
+                    for (int i = l + 2; i < n; i++)
+                    {
+                        d[i] -= h;
+                    }
+                    f += h;
+                    
+                    p = d[m];
+                    double c = 1.0;
+                    double c2 = c;
+                    double c3 = c;
+                    const double el1 = e[l + 1];
+                    double s = 0.0;
+                    double s2 = 0.0;
+                    for (int i = m - 1; i >= l; i--)
+                    {
+                        c3 = c2;
+                        c2 = c;
+                        s2 = s;
+                        g = c * e[i];
+                        h = c * p;
+                        r = sqrt(p * p + e[i] * e[i]);
+                        e[i + 1] = s * r;
+                        s = e[i] / r;
+                        c = p / r;
+                        p = c * d[i] - s * g;
+                        d[i + 1] = h + s * (c * g + s * d[i]);
+                        
+                        for (int k = 0; k < n; k++)
+                        {
+                            h = V[k * n + i + 1];
+                            V[k * n + i + 1] = s * V[k * n + i] + c * h;
+                            V[k * n + i] = c * V[k * n + i] - s * h;
+                        }
+                    }
+                    p = -s * s2 * c3 * el1 * e[l] / dl1;
+                    e[l] = s * p;
+                    d[l] = c * p;
+                }
+            }
+            d[l] += f;
+            e[l] = 0.0;
+        }
+    }
+    
+    /** Orders member indices by descending average score */
+    class ByScore
+    {
+    public:
+        ByScore(const vector<CMAESMember *>& members) :
+        m_members(members)
+        {
+        }
+        
+        bool operator()(std::size_t a, std::size_t b) const
+        {
+            return m_members[a]->averageScore() > m_members[b]->averageScore();
+        }
+        
+    private:
+        const vector<CMAESMember *>& m_members;
+    };
+}
+
+CMAESEvolution::CMAESEvolution(std::string suff, std::string config, std::string path) :
+suffix(suff),
+currentTest(0),
+generationNumber(0),
+subTests(0),
+generationApplied(0)
+{
+	if (path != "")
+	{
+		resourcePath = FileHelpers::getResourcePath(path);
+	}
+	else
+	{
+		resourcePath = "";
+	}
+	
+	std::string configPath = resourcePath + config;
+	
+    learningConfig = LearningConfig(configPath);
+    numParameters=learningConfig.get(LearningConfig::numberOfActions);
+    numberOfSubtests=learningConfig.get(LearningConfig::numberOfSubtests);
+    numberOfControllers=learningConfig.get(LearningConfig::numberOfControllers); //shared with ManhattanToyController
+    const bool seeded = learningConfig.get(LearningConfig::startSeed);
+    const bool learning = learningConfig.get(LearningConfig::learning);
+    
+    const double n = numParameters;
+    populationSize = learningConfig.get(LearningConfig::populationSize, 0);
+    if (populationSize <= 0)
+    {
+        populationSize = 4 + (int) floor(3.0 * log(n));
+    }
+    const double initialSigma = learningConfig.get(LearningConfig::initialSigma, 0.3);
+    diagonal = learningConfig.get(LearningConfig::diagonalCovariance, 0) != 0;
+    
+    checkpointInterval = learningConfig.get(LearningConfig::checkpointInterval, 1);
+    if (numParameters < 1 || populationSize < 2 || numberOfSubtests < 1 ||
+        initialSigma <= 0.0)
+    {
+        throw std::invalid_argument("numberOfActions, populationSize, numberOfSubtests and initialSigma must be positive");
+    }
+    
+    // The default strategy parameters of Hansen's tutorial, "The CMA
+    // Evolution Strategy", 2016
+    const int mu = populationSize / 2;
+    double sum = 0.0;
+    for (int i = 0; i < mu; i++)
+    {
+        weights.push_back(log(mu + 0.5) - log(i + 1.0));
+        sum += weights.back();
+    }
+    double sumSquares = 0.0;
+    for (int i = 0; i < mu; i++)
+    {
+        weights[i] /= sum;
+        sumSquares += weights[i] * weights[i];
+    }
+    muEff = 1.0 / sumSquares;
+    
+    cSigma = (muEff + 2.0) / (n + muEff + 5.0);
+    dSigma = 1.0 + 2.0 * max(0.0, sqrt((muEff - 1.0) / (n + 1.0)) - 1.0) + cSigma;
+    cC = (4.0 + muEff / n) / (n + 4.0 + 2.0 * muEff / n);
+    c1 = 2.0 / ((n + 1.3) * (n + 1.3) + muEff);
+    cMu = min(1.0 - c1,
+                2.0 * (muEff - 2.0 + 1.0 / muEff) / ((n + 2.0) * (n + 2.0) + muEff));
+    if (diagonal)
+    {
+        // sep-CMA-ES learns the n variances faster
+        c1 = min(1.0, c1 * (n + 2.0) / 3.0);
+        cMu = min(1.0 - c1, cMu * (n + 2.0) / 3.0);
+    }
+    chiN = sqrt(n) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+    eigenInterval = max(1, (int) floor(1.0 / ((c1 + cMu) * n * 10.0)));
+    
+    kernels.seed(time(NULL), clock());
+    
+    const std::size_t entries = diagonal ? numParameters : numParameters * numParameters;
+    populations.resize(numberOfControllers);
+    for(int j=0;j<numberOfControllers;j++)
+    {
+        Distribution& dist = populations[j];
+        dist.mean.assign(numParameters, 0.5);
+        dist.sigma = initialSigma;
+        dist.pathSigma.assign(numParameters, 0.0);
+        dist.pathC.assign(numParameters, 0.0);
+        dist.C.assign(entries, 0.0);
+        dist.D.assign(numParameters, 1.0);
+        if (diagonal)
+        {
+            dist.C.assign(numParameters, 1.0);
+        }
+        else
+        {
+            dist.B.assign(entries, 0.0);
+            for (std::size_t i = 0; i < numParameters; i++)
+            {
+                dist.C[i * numParameters + i] = 1.0;
+                dist.B[i * numParameters + i] = 1.0;
+            }
+        }
+        for (int k = 0; k < populationSize; k++)
+        {
+            dist.members.push_back(new CMAESMember(numParameters));
+        }
+        dist.steps.assign(populationSize, vector<double>(numParameters, 0.0));
+        dist.best = CMAESMember(numParameters);
+        
+        // Search around the last leader
+        if(seeded)
+        {
+            stringstream ss;
+            ss<< resourcePath <<"logs/bestParameters-"<<this->suffix<<"-"<<j<<".nnw";
+            dist.best.loadFromFile(ss.str().c_str());
+            dist.mean = dist.best.statelessParameters;
+        }
+    }
+    scratch.resize(numParameters);
+    scratch2.resize(numParameters);
+    
+    if(learning)
+    {
+        evolutionLog.open((resourcePath + "logs/evolution" + suffix + ".csv").c_str(),ios::out);
+        if (!evolutionLog.is_open())
+        {
+			throw std::runtime_error("Logs does not exist. Please create a logs folder in your build directory or update your cmake file");
+		}
+    }
+    
+    scoresLog.open((resourcePath + "logs/scores.csv").c_str(),ios::app);
+    
+    sampleGeneration();
+}
+
+CMAESEvolution::~CMAESEvolution()
+{
+    for(std::size_t i = 0; i < populations.size(); i++)
+    {
+        for (std::size_t k = 0; k < populations[i].members.size(); k++)
+        {
+            delete populations[i].members[k];
+        }
+    }
+}
+
+void CMAESEvolution::sampleGeneration()
+{
+    const std::size_t n = numParameters;
+    for (std::size_t p = 0; p < populations.size(); p++)
+    {
+        Distribution& dist = populations[p];
+        for (std::size_t k = 0; k < dist.members.size(); k++)
+        {
+            vector<double>& y = dist.steps[k];
+            vector<double>& x = dist.members[k]->statelessParameters;
+            
+            // y = B D z
+            kernels.normal(&scratch[0], n);
+            if (diagonal)
+            {
+                for (std::size_t i = 0; i < n; i++)
+                {
+                    y[i] = dist.D[i] * scratch[i];
+                }
+            }
+            else
+            {
+                for (std::size_t j = 0; j < n; j++)
+                {
+                    scratch[j] *= dist.D[j];
+                }
+                for (std::size_t i = 0; i < n; i++)
+                {
+                    const double* const row = &dist.B[i * n];
+                    double sum = 0.0;
+                    for (std::size_t j = 0; j < n; j++)
+                    {
+                        sum += row[j] * scratch[j];
+                    }
+                    y[i] = sum;
+                }
+            }
+            
+            // Clamp, and learn from where the member actually was
+            for (std::size_t i = 0; i < n; i++)
+            {
+                const double v = dist.mean[i] + dist.sigma * y[i];
+                x[i] = v < 0.0 ? 0.0 : (v > 1.0 ? 1.0 : v);
+                y[i] = (x[i] - dist.mean[i]) / dist.sigma;
+            }
+            dist.members[k]->pastScores.clear();
+            dist.members[k]->maxScore = -1000;
+        }
+    }
+}
+
+void CMAESEvolution::updateDistributions()
+{
+    generationNumber++;
+    for (std::size_t p = 0; p < populations.size(); p++)
+    {
+        updateDistribution(populations[p]);
+    }
+    writeLog();
+    scoresOfTheGeneration.clear();
+}
+
+void CMAESEvolution::updateDistribution(Distribution& dist)
+{
+    const std::size_t n = numParameters;
+    const std::size_t mu = weights.size();
+    
+    order.resize(dist.members.size());
+    for (std::size_t k = 0; k < order.size(); k++)
+    {
+        order[k] = k;
+    }
+    std::sort(order.begin(), order.end(), ByScore(dist.members));
+    
+    CMAESMember* const leader = dist.members[order[0]];
+    if (leader->averageScore() > dist.best.maxScore || dist.best.pastScores.empty())
+    {
+        dist.best.statelessParameters = leader->statelessParameters;
+        dist.best.pastScores = leader->pastScores;
+        dist.best.maxScore = leader->averageScore();
+        dist.best.maxScore1 = leader->maxScore1;
+        dist.best.maxScore2 = leader->maxScore2;
+    }
+    
+    // The weighted mean step of the best mu, and the new mean
+    vector<double>& yw = scratch;
+    yw.assign(n, 0.0);
+    for (std::size_t r = 0; r < mu; r++)
+    {
+        const vector<double>& y = dist.steps[order[r]];
+        for (std::size_t i = 0; i < n; i++)
+        {
+            yw[i] += weights[r] * y[i];
+        }
+    }
+    for (std::size_t i = 0; i < n; i++)
+    {
+        dist.mean[i] += dist.sigma * yw[i];
+    }
+    
+    // C^(-1/2) yw
+    vector<double>& white = scratch2;
+    if (diagonal)
+    {
+        for (std::size_t i = 0; i < n; i++)
+        {
+            white[i] = yw[i] / dist.D[i];
+        }
+    }
+    else
+    {
+        vector<double> projected(n, 0.0);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            const double* const row = &dist.B[i * n];
+            for (std::size_t j = 0; j < n; j++)
+            {
+                projected[j] += row[j] * yw[i];
+            }
+        }
+        for (std::size_t j = 0; j < n; j++)
+        {
+            projected[j] /= dist.D[j];
+        }
+        for (std::size_t i = 0; i < n; i++)
+        {
+            const double* const row = &dist.B[i * n];
+            double sum = 0.0;
+            for (std::size_t j = 0; j < n; j++)
+            {
+                sum += row[j] * projected[j];
+            }
+            white[i] = sum;
+        }
+    }
+    
+    const double sigmaRate = sqrt(cSigma * (2.0 - cSigma) * muEff);
+    double normSigma = 0.0;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        dist.pathSigma[i] = (1.0 - cSigma) * dist.pathSigma[i] + sigmaRate * white[i];
+        normSigma += dist.pathSigma[i] * dist.pathSigma[i];
+    }
+    normSigma = sqrt(normSigma);
+    
+    // Stall the covariance path while the step size is growing fast
+    const double bias = sqrt(1.0 - pow(1.0 - cSigma, 2.0 * generationNumber));
+    const bool hSigma = normSigma / bias < (1.4 + 2.0 / (n + 1.0)) * chiN;
+    const double cRate = hSigma ? sqrt(cC * (2.0 - cC) * muEff) : 0.0;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        dist.pathC[i] = (1.0 - cC) * dist.pathC[i] + cRate * yw[i];
+    }
+    
+    // Rank one and rank mu updates of the covariance
+    const double decay = 1.0 - c1 - cMu + (hSigma ? 0.0 : c1 * cC * (2.0 - cC));
+    if (diagonal)
+    {
+        for (std::size_t i = 0; i < n; i++)
+        {
+            double rankMu = 0.0;
+            for (std::size_t r = 0; r < mu; r++)
+            {
+                const double y = dist.steps[order[r]][i];
+                rankMu += weights[r] * y * y;
+            }
+            dist.C[i] = decay * dist.C[i] + c1 * dist.pathC[i] * dist.pathC[i] +
+                        cMu * rankMu;
+            dist.D[i] = sqrt(max(dist.C[i], 1e-20));
+        }
+    }
+    else
+    {
+        for (std::size_t i = 0; i < n; i++)
+        {
+            for (std::size_t j = 0; j <= i; j++)
+            {
+                double rankMu = 0.0;
+                for (std::size_t r = 0; r < mu; r++)
+                {
+                    const vector<double>& y = dist.steps[order[r]];
+                    rankMu += weights[r] * y[i] * y[j];
+                }
+                const double c = decay * dist.C[i * n + j] +
+                                 c1 * dist.pathC[i] * dist.pathC[j] + cMu * rankMu;
+                dist.C[i * n + j] = c;
+                dist.C[j * n + i] = c;
+            }
+        }
+        if (generationNumber % eigenInterval == 0)
+        {
+            decompose(dist);
+        }
+    }
+    
+    dist.sigma *= exp((cSigma / dSigma) * (normSigma / chiN - 1.0));
+}
+
+void CMAESEvolution::decompose(Distribution& dist)
+{
+    const int n = numParameters;
+    dist.B = dist.C;
+    vector<double> e(n, 0.0);
+    tridiagonalize(dist.B, dist.D, e, n);
+    diagonalize(dist.B, dist.D, e, n);
+    for (int i = 0; i < n; i++)
+    {
+        // Rounding can leave tiny negative eigenvalues
+        dist.D[i] = sqrt(max(dist.D[i], 1e-20));
+    }
+}
+
+void CMAESEvolution::writeLog()
+{
+    double aveScore1 = 0.0;
+    double aveScore2 = 0.0;
+    for(std::size_t i=0;i<scoresOfTheGeneration.size();i++)
+    {
+        aveScore1+=scoresOfTheGeneration[i][0];
+        aveScore2+=scoresOfTheGeneration[i][1];
+    }
+    if (!scoresOfTheGeneration.empty())
+    {
+        aveScore1 /= scoresOfTheGeneration.size();
+        aveScore2 /= scoresOfTheGeneration.size();
+    }
+    
+    const CMAESMember& best = populations.at(0).best;
+    evolutionLog<<generationNumber*testsToDo()<<","<<aveScore1<<","<<aveScore2<<",";
+    evolutionLog<<best.maxScore<<","<<best.maxScore1<<","<<best.maxScore2<<",";
+    evolutionLog<<populations.at(0).sigma<<endl;
+    
+    // Leader files and buffered scores only reach the disk at checkpoints
+    if (generationNumber % checkpointInterval != 0)
+    {
+        return;
+    }
+    scoresLog.flush();
+    for(std::size_t i=0;i<populations.size();i++)
+    {
+        stringstream ss;
+        ss << resourcePath << "logs/bestParameters-" << suffix << "-" << i << ".nnw";
+        populations[i].best.saveToFile(ss.str().c_str());
+    }
+}
+
+vector <CMAESMember *> CMAESEvolution::nextSetOfControllers()
+{
+    if(currentTest == testsToDo())
+    {
+        updateDistributions();
+        sampleGeneration();
+        currentTest = 0;
+    }
+
+    selectedControllers.clear();
+    for(std::size_t i=0;i<populations.size();i++)
+    {
+        selectedControllers.push_back(populations[i].members[currentTest]);
+    }
+    
+    subTests++;
+    
+    if (subTests == numberOfSubtests)
+    {
+        currentTest++;
+        subTests = 0;
+    }
+
+    return selectedControllers;
+}
+
+void CMAESEvolution::updateScores(vector <double> multiscore)
+{
+    applyScores(selectedControllers, multiscore);
+}
+
+void CMAESEvolution::applyScores(const vector <CMAESMember *>& controllers,
+                        vector <double> multiscore)
+{
+    if(multiscore.size()==2)
+        this->scoresOfTheGeneration.push_back(multiscore);
+    else
+        multiscore.push_back(-1.0);
+    const double score = multiscore[0];
+    
+    //Record it to the file
+    scoresLog<<multiscore[0]<<","<<multiscore[1];
+    
+    for(std::size_t oneElem=0;oneElem<controllers.size();oneElem++)
+    {
+        CMAESMember * controllerPointer=controllers.at(oneElem);
+
+        controllerPointer->pastScores.push_back(score);
+        if(score > controllerPointer->maxScore)
+        {
+            controllerPointer->maxScore=score;
+            controllerPointer->maxScore1=multiscore[0];
+            controllerPointer->maxScore2=multiscore[1];
+        }
+        std::size_t n = controllerPointer->statelessParameters.size();
+        for (std::size_t i = 0; i < n; i++)
+        {
+            scoresLog << "," << controllerPointer->statelessParameters[i];
+        }
+    }
+
+    scoresLog<<"\n";
+}
+
+int CMAESEvolution::testsToDo() const
+{
+    return populationSize;
+}
+
+double CMAESEvolution::stepSize(std::size_t population) const
+{
+    return populations.at(population).sigma;
+}
+
+const std::vector<double>& CMAESEvolution::distributionMean(std::size_t population) const
+{
+    return populations.at(population).mean;
+}
+
+vector< vector <CMAESMember *> > CMAESEvolution::nextGeneration()
+{
+    boost::mutex::scoped_lock lock(scoresMutex);
+    if (generationApplied < generationTrials.size())
+    {
+        throw std::runtime_error("Scores of the last generation are missing");
+    }
+    
+    generationTrials.clear();
+    do
+    {
+        generationTrials.push_back(nextSetOfControllers());
+    }
+    while (currentTest < testsToDo());
+    
+    generationScores.assign(generationTrials.size(), vector<double>());
+    generationScored.assign(generationTrials.size(), false);
+    generationApplied = 0;
+    
+    return generationTrials;
+}
+
+void CMAESEvolution::updateScores(std::size_t trial, vector <double> scores)
+{
+    boost::mutex::scoped_lock lock(scoresMutex);
+    if (trial >= generationTrials.size() || generationScored[trial])
+    {
+        throw std::invalid_argument("Trial is not awaiting scores");
+    }
+    generationScores[trial] = scores;
+    generationScored[trial] = true;
+    
+    // Apply in trial order, as a serial run would
+    while (generationApplied < generationTrials.size() &&
+            generationScored[generationApplied])
+    {
+        applyScores(generationTrials[generationApplied],
+                    generationScores[generationApplied]);
+        generationApplied++;
+    }
+}
+
+namespace
+{
+    /** Runs the trials of one generation on a tgThreadPool */
+    class CMAESEvolutionTask : public tgThreadPool::Task
+    {
+    public:
+        CMAESEvolutionTask(CMAESEvolution& evolution,
+                    CMAESEvolution::Evaluator& evaluator,
+                    const vector< vector <CMAESMember *> >& trials) :
+        m_evolution(evolution),
+        m_evaluator(evaluator),
+        m_trials(trials)
+        {
+        }
+        
+        virtual void operator()(std::size_t item)
+        {
+            m_evolution.updateScores(item, m_evaluator.evaluate(m_trials[item], item));
+        }
+        
+    private:
+        CMAESEvolution& m_evolution;
+        CMAESEvolution::Evaluator& m_evaluator;
+        const vector< vector <CMAESMember *> >& m_trials;
+    };
+}
+
+void CMAESEvolution::evaluateGeneration(Evaluator& evaluator, tgThreadPool& pool)
+{
+    const vector< vector <CMAESMember *> > trials = nextGeneration();
+    CMAESEvolutionTask task(*this, evaluator, trials);
+    pool.run(task, trials.size());
+}
@@ -0,0 +1,208 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef CMAESEVOLUTION_H_
+#define CMAESEVOLUTION_H_
+
+/**
+ * @file CMAESEvolution.h
+ * @brief Contains the definition of class CMAESEvolution.
+ * $Id$
+ */
+
+#include "CMAESMember.h"
+#include "learning/Configuration/LearningConfig.h"
+#include "util/ParameterKernels.h"
+#include <fstream>
+#include <string>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+
+// Forward declarations
+class tgThreadPool;
+
+/**
+ * A covariance matrix adaptation evolution strategy (CMA-ES) with the
+ * interface of AnnealEvolution. Each of the numberOfControllers
+ * populations keeps its own search distribution over numberOfActions
+ * parameters in [0, 1]; a generation samples populationSize members from
+ * each (defaulting to 4 + 3 ln n if the key is absent or not positive),
+ * runs every member numberOfSubtests times, and moves the mean, the
+ * covariance and the step size toward the best half by their average
+ * score. Trial k of a generation uses member k of every population.
+ *
+ * Further keys: initialSigma (default 0.3) is the starting step size;
+ * diagonalCovariance (default 0) adapts only the variances, which costs
+ * O(n) instead of O(n^2) per sample for controllers with thousands of
+ * parameters. Samples are clamped to [0, 1] and the distribution is
+ * updated from the clamped parameters.
+ */
+class CMAESEvolution
+{
+public:
+    /**
+     * Runs one trial for evaluateGeneration(). Implementations are called
+     * concurrently, so each call must use its own simulation.
+     */
+    class Evaluator
+    {
+    public:
+        virtual ~Evaluator() { }
+        
+        /**
+         * @param[in] controllers one member of each population
+         * @param[in] trial the index of the trial in the generation
+         * @return the scores, as passed to updateScores()
+         */
+        virtual std::vector<double> evaluate(const std::vector< CMAESMember *>& controllers,
+                                                std::size_t trial) = 0;
+    };
+    
+    CMAESEvolution(std::string suffix, std::string config = "config.ini", std::string path = "");
+    ~CMAESEvolution();
+    std::vector< CMAESMember *> nextSetOfControllers();
+    void updateScores(std::vector<double> scores);
+    
+    /**
+     * Hand out every trial left in the generation, as
+     * nextSetOfControllers() would one at a time. Scores may then be
+     * given in any order, from any thread, with updateScores(trial, ...);
+     * they are applied in trial order, so the outcome matches a serial run.
+     * @throw std::runtime_error if scores of the last generation are missing
+     */
+    std::vector< std::vector< CMAESMember *> > nextGeneration();
+    
+    /**
+     * Record the scores of one trial from nextGeneration(). Thread safe.
+     * @throw std::invalid_argument if the trial is out of range or was
+     * already scored
+     */
+    void updateScores(std::size_t trial, std::vector<double> scores);
+    
+    /**
+     * Run a whole generation from nextGeneration() on a pool, one trial
+     * per item, and record the scores.
+     */
+    void evaluateGeneration(Evaluator& evaluator, tgThreadPool& pool);
+    
+    /** @return the step size of a population's distribution */
+    double stepSize(std::size_t population) const;
+    
+    /** @return the mean of a population's distribution */
+    const std::vector<double>& distributionMean(std::size_t population) const;
+    
+    /** The configuration, parsed once, for the adapters */
+    const LearningConfig& getConfig() const { return learningConfig; }
+    
+    const std::string suffix;
+    std::string resourcePath;
+    
+private:
+    /** The search distribution and current samples of one controller */
+    struct Distribution
+    {
+        std::vector<double> mean;
+        double sigma;
+        /** The evolution paths of the step size and of the covariance */
+        std::vector<double> pathSigma;
+        std::vector<double> pathC;
+        /** The covariance, row major, or its diagonal */
+        std::vector<double> C;
+        /** The eigenvectors of C in columns, row major; empty if diagonal */
+        std::vector<double> B;
+        /** The square roots of the eigenvalues of C */
+        std::vector<double> D;
+        std::vector< CMAESMember *> members;
+        /** (x - mean) / sigma of each member, after clamping */
+        std::vector< std::vector<double> > steps;
+        /** The best member seen, written to the leader file */
+        CMAESMember best;
+    };
+    
+    /** Draw the members of every population from its distribution */
+    void sampleGeneration();
+    
+    /** Move every distribution toward its best scoring members */
+    void updateDistributions();
+    
+    void updateDistribution(Distribution& dist);
+    
+    /** Recompute B and D from C */
+    void decompose(Distribution& dist);
+    
+    void writeLog();
+    
+    /** The number of trials in a generation */
+    int testsToDo() const;
+    
+    /** Score one set of controllers */
+    void applyScores(const std::vector< CMAESMember *>& controllers,
+                        std::vector<double> multiscore);
+    
+    LearningConfig learningConfig;
+    std::size_t numParameters;
+    int populationSize;
+    int numberOfControllers;
+    int numberOfSubtests;
+    bool diagonal;
+    
+    /** The recombination weights of the best mu members, summing to 1 */
+    std::vector<double> weights;
+    double muEff;
+    double cSigma;
+    double dSigma;
+    double cC;
+    double c1;
+    double cMu;
+    /** The expected length of a standard normal vector */
+    double chiN;
+    /** Generations between decompositions of C */
+    int eigenInterval;
+    
+    ParameterKernels kernels;
+    std::vector<Distribution> populations;
+    std::vector <CMAESMember *>  selectedControllers;
+    std::vector< std::vector< double > > scoresOfTheGeneration;
+    /** Scratch for sampling and updating */
+    std::vector<double> scratch;
+    std::vector<double> scratch2;
+    std::vector<std::size_t> order;
+    
+    std::ofstream evolutionLog;
+    /** logs/scores.csv, kept open and flushed at each checkpoint */
+    std::ofstream scoresLog;
+    /**
+     * Generations between writes of the leaders' parameter files, from
+     * the optional checkpointInterval key; 1 if absent
+     */
+    int checkpointInterval;
+    int currentTest;
+    int generationNumber;
+    int subTests;
+    
+    /** The trials handed out by nextGeneration() */
+    std::vector< std::vector< CMAESMember *> > generationTrials;
+    std::vector< std::vector<double> > generationScores;
+    std::vector<bool> generationScored;
+    /** The trials whose scores have been applied, a prefix */
+    std::size_t generationApplied;
+    /** Guards the generation's scores and everything they update */
+    boost::mutex scoresMutex;
+};
+
+#endif /* CMAESEVOLUTION_H_ */
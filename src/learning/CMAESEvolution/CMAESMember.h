@@ -0,0 +1,57 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef CMAESMEMBER_H_
+#define CMAESMEMBER_H_
+
+/**
+ * @file CMAESMember.h
+ * @brief Contains the definition of class CMAESMember
+ * $Id$
+ */
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * One sample of a CMAESEvolution population, handed to the adapters like
+ * an AnnealEvoMember. The parameters are in [0, 1] and are read and
+ * written as the same comma separated leader files.
+ */
+class CMAESMember
+{
+public:
+    CMAESMember(std::size_t numParameters = 0);
+    ~CMAESMember();
+
+    void saveToFile(const char* outputFilename);
+    /** @throw std::invalid_argument if the file does not exist */
+    void loadFromFile(const char* inputFilename);
+
+    /** @return the mean of pastScores, or -1 if there are none */
+    double averageScore() const;
+
+    std::vector<double> statelessParameters;
+    //scores for evaluation
+    std::vector<double> pastScores;
+    double maxScore;
+    double maxScore1;
+    double maxScore2;
+};
+
+#endif /* CMAESMEMBER_H_ */
@@ -0,0 +1,165 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file LearningConfig.cpp
+ * @brief Contains the implementation of class LearningConfig.
+ * $Id$
+ */
+
+#include "LearningConfig.h"
+#include "configuration.h"
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+#define LEARNING_CONFIG_NAME(name) #name,
+    const char* const intNames[] =
+    {
+        LEARNING_CONFIG_INT_KEYS(LEARNING_CONFIG_NAME)
+    };
+    const char* const doubleNames[] =
+    {
+        LEARNING_CONFIG_DOUBLE_KEYS(LEARNING_CONFIG_NAME)
+    };
+#undef LEARNING_CONFIG_NAME
+
+    void malformed(const std::string& key, const std::string& value,
+                    const std::string& expected)
+    {
+        throw std::invalid_argument("Configuration key " + key + " = " + value +
+                                    " is not " + expected);
+    }
+
+    /** Whole value parses, as configuration::getintvalue requires */
+    template <typename T>
+    bool parseValue(const std::string& text, T& value)
+    {
+        std::istringstream ss(text);
+        ss >> value;
+        return !ss.fail() && ss.eof();
+    }
+}
+
+LearningConfig::LearningConfig() :
+m_raw(new configuration())
+{
+    parse();
+}
+
+LearningConfig::LearningConfig(const std::string& filename)
+{
+    configuration* const config = new configuration();
+    m_raw.reset(config);
+    config->readFile(filename);
+    parse();
+}
+
+LearningConfig::LearningConfig(const configuration& config) :
+m_raw(new configuration(config))
+{
+    parse();
+}
+
+void LearningConfig::parse()
+{
+    for (int i = 0; i < numIntKeys; i++)
+    {
+        m_ints[i] = 0;
+        m_hasInt[i] = m_raw->iskey(intNames[i]);
+        if (m_hasInt[i])
+        {
+            const std::string& text = m_raw->data.find(intNames[i])->second;
+            if (!parseValue(text, m_ints[i]))
+            {
+                malformed(intNames[i], text, "an integer");
+            }
+        }
+    }
+    for (int i = 0; i < numDoubleKeys; i++)
+    {
+        m_doubles[i] = 0.0;
+        m_hasDouble[i] = m_raw->iskey(doubleNames[i]);
+        if (m_hasDouble[i])
+        {
+            const std::string& text = m_raw->data.find(doubleNames[i])->second;
+            if (!parseValue(text, m_doubles[i]))
+            {
+                malformed(doubleNames[i], text, "a number");
+            }
+        }
+    }
+    
+    // Counts can't be negative; the flags take any integer, as before
+    const IntKey counts[] = {numberOfActions, numberOfStates, numberOfControllers,
+                            numberHidden, populationSize, numberOfElementsToMutate,
+                            numberOfChildren, numberOfTestsBetweenGenerations,
+                            numberOfSubtests, fitnessCacheSize, surrogateNeighbors,
+                            prescreenAudit};
+    for (std::size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+    {
+        if (get(counts[i], 0) < 0)
+        {
+            malformed(name(counts[i]), m_raw->data.find(name(counts[i]))->second,
+                        "a count");
+        }
+    }
+    if (get(checkpointInterval, 1) < 1)
+    {
+        throw std::invalid_argument("checkpointInterval must be positive");
+    }
+    
+    const double leniency = get(leniencyCoef, 0.0);
+    const double quantile = get(surrogateQuantile, 0.0);
+    const double prescreen = get(prescreenQuantile, 0.0);
+    if (leniency < 0.0 || leniency > 1.0 || quantile < 0.0 || quantile > 1.0 ||
+        prescreen < 0.0 || prescreen > 1.0)
+    {
+        throw std::invalid_argument("leniencyCoef, surrogateQuantile and prescreenQuantile must be in [0, 1]");
+    }
+    if (get(deviation, 0.0) < 0.0 || get(initialSigma, 1.0) <= 0.0 ||
+        get(fitnessCacheResolution, 1.0) <= 0.0)
+    {
+        throw std::invalid_argument("deviation can't be negative, initialSigma and fitnessCacheResolution must be positive");
+    }
+    if (get(trialTimeLimit, 0.0) < 0.0)
+    {
+        throw std::invalid_argument("trialTimeLimit can't be negative");
+    }
+    if (get(gradientSamples, 1) < 1 || get(spsaGain, 1.0) <= 0.0 ||
+        get(spsaStability, 0.0) < 0.0 || get(spsaPerturbation, 1.0) <= 0.0)
+    {
+        throw std::invalid_argument("gradientSamples, spsaGain and spsaPerturbation must be positive, spsaStability can't be negative");
+    }
+}
+
+const char* LearningConfig::name(IntKey key)
+{
+    return intNames[key];
+}
+
+const char* LearningConfig::name(DoubleKey key)
+{
+    return doubleNames[key];
+}
+
+void LearningConfig::missing(const char* key)
+{
+    throw std::invalid_argument(std::string("Configuration key ") + key + " is missing");
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef LEARNING_CONFIG_H_
+#define LEARNING_CONFIG_H_
+
+/**
+ * @file LearningConfig.h
+ * @brief A learning configuration parsed and validated once, with typed
+ * accessors.
+ * $Id$
+ */
+
+#include <string>
+#include <boost/shared_ptr.hpp>
+
+// Forward declarations
+class configuration;
+
+/**
+ * The keys of the learning libraries, as X(name) lists. Adding a key here
+ * adds its enumerator to LearningConfig.
+ */
+#define LEARNING_CONFIG_INT_KEYS(X) \
+    X(numberOfActions) \
+    X(numberOfStates) \
+    X(numberOfControllers) \
+    X(numberHidden) \
+    X(populationSize) \
+    X(numberOfElementsToMutate) \
+    X(numberOfChildren) \
+    X(numberOfTestsBetweenGenerations) \
+    X(numberOfSubtests) \
+    X(coevolution) \
+    X(startSeed) \
+    X(learning) \
+    X(checkpointInterval) \
+    X(saveCheckpoints) \
+    X(resume) \
+    X(binaryWeights) \
+    X(MonteCarlo) \
+    X(compareAverageScores) \
+    X(clearScoresBetweenGenerations) \
+    X(diagonalCovariance) \
+    X(fitnessCacheSize) \
+    X(surrogateNeighbors) \
+    X(prescreenAudit) \
+    X(gradientSamples)
+
+#define LEARNING_CONFIG_DOUBLE_KEYS(X) \
+    X(leniencyCoef) \
+    X(deviation) \
+    X(initialSigma) \
+    X(fitnessCacheResolution) \
+    X(surrogateQuantile) \
+    X(prescreenQuantile) \
+    X(trialTimeLimit) \
+    X(spsaGain) \
+    X(spsaStability) \
+    X(spsaPerturbation)
+
+/**
+ * The configuration of a learning run. The .ini file (or a configuration
+ * already read) is parsed once: every known key found is converted to its
+ * type and checked, so a malformed value fails at startup rather than in
+ * the middle of a run. Known keys are enumerators, so a misspelled key
+ * does not compile, and reading one is an array lookup.
+ *
+ * A LearningConfig is immutable. Copies share the raw strings of the
+ * other keys and are cheap, and one object may be read from any number
+ * of threads, e.g. by every simulation of a batch.
+ */
+class LearningConfig
+{
+public:
+#define LEARNING_CONFIG_ENUMERATOR(name) name,
+    enum IntKey
+    {
+        LEARNING_CONFIG_INT_KEYS(LEARNING_CONFIG_ENUMERATOR)
+        numIntKeys
+    };
+    enum DoubleKey
+    {
+        LEARNING_CONFIG_DOUBLE_KEYS(LEARNING_CONFIG_ENUMERATOR)
+        numDoubleKeys
+    };
+#undef LEARNING_CONFIG_ENUMERATOR
+
+    /** An empty configuration, every key absent */
+    LearningConfig();
+
+    /**
+     * Read and parse a .ini file, as configuration::readFile() does.
+     * @throw std::invalid_argument if a known key has a malformed or out
+     * of range value
+     */
+    explicit LearningConfig(const std::string& filename);
+
+    /** @throw std::invalid_argument as for a file */
+    explicit LearningConfig(const configuration& config);
+
+    bool has(IntKey key) const { return m_hasInt[key]; }
+    bool has(DoubleKey key) const { return m_hasDouble[key]; }
+
+    /** @throw std::invalid_argument if the key is absent */
+    int get(IntKey key) const
+    {
+        if (!m_hasInt[key])
+        {
+            missing(name(key));
+        }
+        return m_ints[key];
+    }
+
+    /** @throw std::invalid_argument if the key is absent */
+    double get(DoubleKey key) const
+    {
+        if (!m_hasDouble[key])
+        {
+            missing(name(key));
+        }
+        return m_doubles[key];
+    }
+
+    int get(IntKey key, int fallback) const
+    {
+        return m_hasInt[key] ? m_ints[key] : fallback;
+    }
+
+    double get(DoubleKey key, double fallback) const
+    {
+        return m_hasDouble[key] ? m_doubles[key] : fallback;
+    }
+
+    /**
+     * The configuration as read, for keys of applications that are not
+     * known here.
+     */
+    const configuration& raw() const { return *m_raw; }
+
+    static const char* name(IntKey key);
+    static const char* name(DoubleKey key);
+
+private:
+    void parse();
+
+    static void missing(const char* key);
+
+    int m_ints[numIntKeys];
+    double m_doubles[numDoubleKeys];
+    bool m_hasInt[numIntKeys];
+    bool m_hasDouble[numDoubleKeys];
+
+    boost::shared_ptr<const configuration> m_raw;
+};
+
+#endif /* LEARNING_CONFIG_H_ */
@@ -26,6 +26,10 @@
 
 #include "NeuroEvoMember.h"
 #include "neuralNet/Neural Network v2/neuralNetwork.h"
+#include "util/ParameterKernels.h"
+#include "util/NeuralNetWeights.h"
+#include <algorithm>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <assert.h>
@@ -33,11 +37,12 @@
 
 using namespace std;
 
-NeuroEvoMember::NeuroEvoMember(configuration config)
+NeuroEvoMember::NeuroEvoMember(const LearningConfig& config)
 {
-	this->numInputs=config.getintvalue("numberOfStates");
-    this->numOutputs=config.getintvalue("numberOfActions");
-	int numHidden = config.getintvalue("numberHidden");
+	this->numInputs=config.get(LearningConfig::numberOfStates);
+    this->numOutputs=config.get(LearningConfig::numberOfActions);
+	int numHidden = config.get(LearningConfig::numberHidden);
+	binaryWeights = config.get(LearningConfig::binaryWeights, 0);
     assert(numOutputs > 0);
 	cout<<"creating NN"<<endl;
 	if(numInputs>0)
@@ -56,37 +61,22 @@ NeuroEvoMember::~NeuroEvoMember()
 	delete nn;
 }
 
-void NeuroEvoMember::mutate(std::tr1::ranlux64_base_01 *eng){
-	std::tr1::uniform_real<double> unif(0, 1);
-	if(unif(*eng)  > 0.5)
+void NeuroEvoMember::mutate(std::tr1::ranlux64_base_01 *eng, ParameterKernels& kernels){
+	if(kernels.uniform()  > 0.5)
 	{
 		return;
 	}
 	//TODO: for each weight of the NN with 0.5 probability mutate it
 
+	// neuralNetwork draws from the engine itself
 	if(numInputs>0)
 		this->nn->mutate(eng);
-	else
+	else if(!statelessParameters.empty())
 	{
 		double dev = 3.0 / 100.0;   // 10 percent of interval 0-1
-		std::tr1::normal_distribution<double> normal(0, dev);
-		for(std::size_t i=0;i<statelessParameters.size();i++)
-		{
-			if(unif(*eng)  > 0.5)
-			{
-				continue;
-			}
-			double mutAmount = normal(*eng);
-//			cout<<"param: "<<i<<" dev: "<<dev<<" rand: "<<mutAmount<<endl;
-			double newParam= statelessParameters[i] + mutAmount;
-			if(newParam < 0.0)
-				statelessParameters[i] = 0.0;
-			else if(newParam > 1.0)
-				statelessParameters[i] = 1.0;
-			else
-				statelessParameters[i] =newParam;
-		}
-
+		// Each parameter with probability 0.5, clamped to [0, 1]
+		kernels.mutate(&statelessParameters[0], statelessParameters.size(),
+						0.5, dev);
 	}
 }
 
@@ -104,7 +94,7 @@ void NeuroEvoMember::copyFrom(NeuroEvoMember* otherMember)
 	}
 }
 
-void NeuroEvoMember::copyFrom(NeuroEvoMember *otherMember1, NeuroEvoMember *otherMember2, std::tr1::ranlux64_base_01 *eng)
+void NeuroEvoMember::copyFrom(NeuroEvoMember *otherMember1, NeuroEvoMember *otherMember2, std::tr1::ranlux64_base_01 *eng, ParameterKernels& kernels)
 {
     if(numInputs>0)
     {
@@ -112,20 +102,12 @@ void NeuroEvoMember::copyFrom(NeuroEvoMember *otherMember1, NeuroEvoMember *othe
         this->maxScore=-10000;
         this->pastScores.clear();
     }
-    else
+    else if (numOutputs > 0)
     {
-        std::tr1::uniform_real<double> unif(0, 1);
-        for (int i = 0; i < numOutputs; i++)
-        {
-            if (unif(*eng) > 0.5)
-            {
-                this->statelessParameters[i] = otherMember1->statelessParameters[i];
-            }
-            else
-            {
-                this->statelessParameters[i] = otherMember2->statelessParameters[i];
-            }
-        }
+        kernels.crossover(&statelessParameters[0],
+                            &otherMember1->statelessParameters[0],
+                            &otherMember2->statelessParameters[0],
+                            numOutputs);
     }    
 }
 
@@ -133,6 +115,9 @@ void NeuroEvoMember::saveToFile(const char * outputFilename)
 {
 	if(numInputs > 0 )
 		this->getNn()->saveWeights(outputFilename);
+	else if(binaryWeights)
+		NeuralNetWeights::writeBinary(outputFilename, &statelessParameters[0],
+										statelessParameters.size());
 	else
 	{
 		ofstream ss(outputFilename);
@@ -149,42 +134,32 @@ void NeuroEvoMember::saveToFile(const char * outputFilename)
 void NeuroEvoMember::loadFromFile(const char * outputFilename)
 {
 	if(numInputs > 0 )
-		this->getNn()->loadWeights(outputFilename);
-	else
 	{
-		//cout<<"loading parameters from file "<<outputFilename<<endl;
-		ifstream ss(outputFilename);
-		int i=0;
-		string value;
-#if (0)
-		// Disable definition of unused variable to suppress compiler warning
-		double valueDbl;
-#endif
-		if(ss.is_open())
+		if(NeuralNetWeights::isBinary(outputFilename))
 		{
-			while(!ss.eof())
-			{
-				//cout<<"success opening file"<<endl;
-				if(!getline( ss, value, ',' ).eof())
-				{
-					//cout<<"value read as string: "<<value<<endl;
-					statelessParameters[i++]=atof(value.c_str());
-					//cout<<statelessParameters[i-1]<<",";
-				}
-			}
-			//cout<<"reading complete"<<endl;
-			cout<<endl;
-			ss.close();
+			// neuralNetwork only reads text
+			const string text = string(outputFilename) + ".txt";
+			NeuralNetWeights::toText(outputFilename, text);
+			this->getNn()->loadWeights(text.c_str());
+			std::remove(text.c_str());
 		}
 		else
-		{
-			cout << "File of name " << outputFilename << " does not exist" << std::endl;
-			cout << "Try turning learning on in config.ini to generate parameters" << std::endl;
-			throw std::invalid_argument("Parameter file does not exist");
-		}
-		//cout<<"reading complete"<<endl;
-		//cout<<endl;
-		ss.close();
+			this->getNn()->loadWeights(outputFilename);
+		return;
 	}
 
+	try
+	{
+		const NeuralNetWeights values(outputFilename);
+		if(values.size() > statelessParameters.size())
+			throw std::invalid_argument("Too many parameters in file");
+		std::copy(values.data(), values.data() + values.size(),
+					statelessParameters.begin());
+	}
+	catch (const std::invalid_argument&)
+	{
+		cout << "File of name " << outputFilename << " could not be read" << std::endl;
+		cout << "Try turning learning on in config.ini to generate parameters" << std::endl;
+		throw;
+	}
 }
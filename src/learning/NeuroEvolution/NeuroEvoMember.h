@@ -30,25 +30,36 @@
 #include <string>
 #include <vector>
 #include <tr1/random>
-#include "learning/Configuration/configuration.h"
+#include "learning/Configuration/LearningConfig.h"
 
 // Forward Declarations
 class neuralNetwork;
+class ParameterKernels;
 
 class NeuroEvoMember
 {
 public:
-	NeuroEvoMember(configuration config);
+	NeuroEvoMember(const LearningConfig& config);
 	~NeuroEvoMember();
-	void mutate(std::tr1::ranlux64_base_01 *eng);
+	void mutate(std::tr1::ranlux64_base_01 *eng, ParameterKernels& kernels);
 
 	neuralNetwork* getNn(){
 		return nn;
 	}
 
     void copyFrom(NeuroEvoMember *otherMember);
-    void copyFrom(NeuroEvoMember *otherMember1, NeuroEvoMember *otherMember2, std::tr1::ranlux64_base_01 *eng);
+    void copyFrom(NeuroEvoMember *otherMember1, NeuroEvoMember *otherMember2, std::tr1::ranlux64_base_01 *eng, ParameterKernels& kernels);
+	/**
+	 * Write the network's weights, or the parameters, in the binary
+	 * format of NeuralNetWeights if the binaryWeights key is set. The
+	 * weights of a network are text, neuralNetwork only writes those.
+	 */
 	void saveToFile(const char* outputFilename);
+	/**
+	 * Read a file of either format, mapping a binary one.
+	 * @throw std::invalid_argument if it does not exist or holds too
+	 * many parameters
+	 */
 	void loadFromFile(const char* inputFilename);
 
 	std::vector<double> statelessParameters;
@@ -64,6 +75,7 @@ private:
 
 	int numInputs;
 	int numOutputs;
+	bool binaryWeights;
 };
 
 
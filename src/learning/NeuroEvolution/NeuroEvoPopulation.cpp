@@ -25,6 +25,7 @@
  */
 
 #include "NeuroEvoPopulation.h"
+#include "util/ParameterKernels.h"
 // The C++ Standard Library
 #include <string>
 #include <vector>
@@ -37,13 +38,13 @@
 
 using namespace std;
 
-NeuroEvoPopulation::NeuroEvoPopulation(int populationSize,configuration& config) :
+NeuroEvoPopulation::NeuroEvoPopulation(int populationSize,const LearningConfig& config) :
 m_config(config),
 compareAverageScores(true),
 clearScoresBetweenGenerations(false)
 {
-	this->compareAverageScores=config.getintvalue("compareAverageScores");
-	this->clearScoresBetweenGenerations=config.getintvalue("clearScoresBetweenGenerations");
+	this->compareAverageScores=config.get(LearningConfig::compareAverageScores);
+	this->clearScoresBetweenGenerations=config.get(LearningConfig::clearScoresBetweenGenerations);
 
 	for(int i=0;i<populationSize;i++)
 	{
@@ -60,7 +61,7 @@ NeuroEvoPopulation::~NeuroEvoPopulation()
 	}
 }
 
-void NeuroEvoPopulation::mutate(std::tr1::ranlux64_base_01 *engPntr,std::size_t numMutate)
+void NeuroEvoPopulation::mutate(std::tr1::ranlux64_base_01 *engPntr, ParameterKernels& kernels,std::size_t numMutate)
 {
 	if(numMutate>controllers.size()/2)
 	{
@@ -72,14 +73,13 @@ void NeuroEvoPopulation::mutate(std::tr1::ranlux64_base_01 *engPntr,std::size_t
 		int copyFrom = i;
 		int copyTo = this->controllers.size()-1-i;
 		controllers.at(copyTo)->copyFrom(controllers.at(copyFrom));
-		controllers.at(copyTo)->mutate(engPntr);
+		controllers.at(copyTo)->mutate(engPntr, kernels);
 	}
 	return;
 }
 
-void NeuroEvoPopulation::combineAndMutate(std::tr1::ranlux64_base_01 *eng, std::size_t numToMutate, std::size_t numToCombine)
+void NeuroEvoPopulation::combineAndMutate(std::tr1::ranlux64_base_01 *eng, ParameterKernels& kernels, std::size_t numToMutate, std::size_t numToCombine)
 {
-    std::tr1::uniform_real<double> unif(0, 1);
     
     if(numToMutate + numToCombine > controllers.size())
     {
@@ -92,8 +92,8 @@ void NeuroEvoPopulation::combineAndMutate(std::tr1::ranlux64_base_01 *eng, std::
     for(int i = 0; i < numToCombine; i++)
     {
         
-        double val1 = unif(*eng);
-        double val2 = unif(*eng);
+        double val1 = kernels.uniform();
+        double val2 = kernels.uniform();
         
         int index1 = getIndexFromProbability(probabilities, val1);
         int index2 = getIndexFromProbability(probabilities, val2);
@@ -111,11 +111,11 @@ void NeuroEvoPopulation::combineAndMutate(std::tr1::ranlux64_base_01 *eng, std::
         }
         
         NeuroEvoMember* newController = new NeuroEvoMember(m_config);
-        newController->copyFrom(controllers[index1], controllers[index2], eng);
+        newController->copyFrom(controllers[index1], controllers[index2], eng, kernels);
         
-        if(unif(*eng) > 0.9)
+        if(kernels.uniform() > 0.9)
         {
-            newController->mutate(eng);
+            newController->mutate(eng, kernels);
         }
         
         newControllers.push_back(newController);
@@ -123,11 +123,11 @@ void NeuroEvoPopulation::combineAndMutate(std::tr1::ranlux64_base_01 *eng, std::
     
     for(int i = 0; i < numToMutate; i++)
     {
-        double val1 = unif(*eng);
+        double val1 = kernels.uniform();
         int index1 = getIndexFromProbability(probabilities, val1);
         NeuroEvoMember* newController = new NeuroEvoMember(m_config);
         newController->copyFrom(controllers[index1]);
-        newController->mutate(eng);
+        newController->mutate(eng, kernels);
         newControllers.push_back(newController);
     }
     
@@ -145,26 +145,31 @@ void NeuroEvoPopulation::combineAndMutate(std::tr1::ranlux64_base_01 *eng, std::
 }
 
 
+void NeuroEvoPopulation::average(NeuroEvoMember* member)
+{
+	double ave = std::accumulate(member->pastScores.begin(),member->pastScores.end(),0);
+	
+    double n = (double) member->pastScores.size(); 
+    if (n > 0)
+    {
+        ave /= n;
+    }
+    else
+    {
+        ave = -100000;
+    }
+    
+    //assert(member->pastScores.size() > 0);
+    
+	member->averageScore=ave;
+}
+
 void NeuroEvoPopulation::orderPopulation()
 {
 	//calculate each member's average score
 	for(std::size_t i=0;i<this->controllers.size();i++)
 	{
-		double ave = std::accumulate(controllers[i]->pastScores.begin(),controllers[i]->pastScores.end(),0);
-		
-        double n = (double) controllers[i]->pastScores.size(); 
-        if (n > 0)
-        {
-            ave /= n;
-        }
-        else
-        {
-            ave = -100000;
-        }
-        
-        //assert(controllers[i]->pastScores.size() > 0);
-        
-		controllers[i]->averageScore=ave;
+		average(controllers[i]);
 		if(clearScoresBetweenGenerations)
 			controllers[i]->pastScores.clear();
 	}
@@ -176,6 +181,71 @@ void NeuroEvoPopulation::orderPopulation()
     
 }
 
+NeuroEvoMember* NeuroEvoPopulation::breed(std::tr1::ranlux64_base_01 *eng, ParameterKernels& kernels, bool combine)
+{
+    std::vector<double> probabilities = generateMatingProbabilities();
+    NeuroEvoMember* newController = new NeuroEvoMember(m_config);
+    
+    int index1 = getIndexFromProbability(probabilities, kernels.uniform());
+    if (combine && controllers.size() > 1)
+    {
+        int index2 = getIndexFromProbability(probabilities, kernels.uniform());
+        if(index1 == index2)
+        {
+            if(index2 == 0)
+            {
+                index2++;
+            }
+            else
+            {
+                index2--;
+            }
+        }
+        newController->copyFrom(controllers[index1], controllers[index2], eng, kernels);
+        
+        if(kernels.uniform() > 0.9)
+        {
+            newController->mutate(eng, kernels);
+        }
+    }
+    else
+    {
+        newController->copyFrom(controllers[index1]);
+        newController->mutate(eng, kernels);
+    }
+    return newController;
+}
+
+bool NeuroEvoPopulation::insert(NeuroEvoMember* member)
+{
+    average(member);
+    if (controllers.empty() || !isBetter(member, controllers.back()))
+    {
+        delete member;
+        return false;
+    }
+    delete controllers.back();
+    controllers.pop_back();
+    
+    // The first place it beats, ties go after the members already there
+    std::vector<NeuroEvoMember*>::iterator it = controllers.begin();
+    while (it != controllers.end() && !isBetter(member, *it))
+    {
+        ++it;
+    }
+    controllers.insert(it, member);
+    return true;
+}
+
+bool NeuroEvoPopulation::isBetter(const NeuroEvoMember* elm1, const NeuroEvoMember* elm2) const
+{
+    if (compareAverageScores)
+    {
+        return elm1->averageScore > elm2->averageScore;
+    }
+    return elm1->maxScore > elm2->maxScore;
+}
+
 std::vector<double> NeuroEvoPopulation::generateMatingProbabilities()
 {
     double totalScore = 0.0;
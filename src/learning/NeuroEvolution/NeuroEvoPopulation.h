@@ -33,15 +33,34 @@
 
 class NeuroEvoPopulation {
 public:
-	NeuroEvoPopulation(int numControllers, configuration& config);
+	NeuroEvoPopulation(int numControllers, const LearningConfig& config);
 	~NeuroEvoPopulation();
 	std::vector<NeuroEvoMember *> controllers;
-    void mutate(std::tr1::ranlux64_base_01 *eng,std::size_t numToMutate);
-	void combineAndMutate(std::tr1::ranlux64_base_01 *eng, std::size_t numToMutate, std::size_t numToCombine);
+    void mutate(std::tr1::ranlux64_base_01 *eng, ParameterKernels& kernels,std::size_t numToMutate);
+	void combineAndMutate(std::tr1::ranlux64_base_01 *eng, ParameterKernels& kernels, std::size_t numToMutate, std::size_t numToCombine);
 	void orderPopulation();
 	NeuroEvoMember * getMember(int i){return controllers[i];};
+	
+	/**
+	 * Breed one new member from the ordered population, for steady state
+	 * evolution: a crossover of two members drawn by their mating
+	 * probabilities, sometimes mutated, if combine, else a mutated copy
+	 * of one member drawn the same way. The caller owns it.
+	 */
+	NeuroEvoMember* breed(std::tr1::ranlux64_base_01 *eng, ParameterKernels& kernels, bool combine);
+	
+	/**
+	 * Score a bred member as orderPopulation() would and, if it beats the
+	 * last member, put it in its place in the order and delete the last.
+	 * Takes ownership.
+	 * @return false if the member was deleted instead
+	 */
+	bool insert(NeuroEvoMember* member);
 
 private:
+	/** Set the member's averageScore, as orderPopulation() does */
+	static void average(NeuroEvoMember* member);
+	bool isBetter(const NeuroEvoMember* elm1, const NeuroEvoMember* elm2) const;
     std::vector<double> generateMatingProbabilities();
     int getIndexFromProbability(std::vector<double>& probs, double val);
 	static bool comparisonFuncForAverage(NeuroEvoMember * elm1, NeuroEvoMember * elm2);
@@ -49,7 +68,7 @@ private:
 	bool compareAverageScores;
 	bool clearScoresBetweenGenerations;
 	int populationSize;
-    configuration m_config;
+    LearningConfig m_config;
 };
 
 
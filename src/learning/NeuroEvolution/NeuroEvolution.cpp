@@ -25,38 +25,42 @@
  */
 
 #include "NeuroEvolution.h"
-#include "learning/Configuration/configuration.h"
+#include "learning/Configuration/LearningConfig.h"
+#include "core/tgRandom.h"
 #include "core/tgString.h"
 #include "helpers/FileHelpers.h"
+#include "core/tgStepTimes.h"
+#include "core/tgThreadPool.h"
 // The C++ Standard Library
+#include <algorithm>
 #include <iostream>
+#include <map>
 #include <numeric>
 #include <string>
 #include <sstream>
 #include <stdexcept>
+// Boost
+#include <boost/functional/hash.hpp>
 
 using namespace std;
 
-#ifdef _WIN32
-
-//  Windows
-#define rdtsc  __rdtsc
-
-#else
-
-//  For everything else
-unsigned long long rdtsc(){
-    unsigned int lo,hi;
-    __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
-    return ((unsigned long long)hi << 32) | lo;
-}
-
-#endif
-
 NeuroEvolution::NeuroEvolution(std::string suff, std::string config, std::string path) :
-suffix(suff)
+suffix(suff),
+fitnessCache(NULL),
+surrogateNeighbors(0),
+surrogateQuantile(0.25),
+prescreenQuantile(0.0),
+prescreenAudit(0),
+prescreenScreenedOut(0),
+trialTimeLimit(0.0),
+steadyStarted(false),
+steadyTrials(0),
+steadyHanded(0),
+steadyFinished(0),
+generationApplied(0)
 {
 	currentTest=0;
+	subTests=0;
 	generationNumber=0;
 	if (path != "")
 	{
@@ -69,33 +73,57 @@ suffix(suff)
 
 	std::string configPath = resourcePath + config;
 
-    configuration myconfigdataaa;
-	myconfigdataaa.readFile(configPath);
-	populationSize=myconfigdataaa.getintvalue("populationSize");
-    numberOfElementsToMutate=myconfigdataaa.getintvalue("numberOfElementsToMutate");
-	numberOfChildren=myconfigdataaa.getintvalue("numberOfChildren");
-	numberOfTestsBetweenGenerations=myconfigdataaa.getintvalue("numberOfTestsBetweenGenerations");
-    numberOfSubtests=myconfigdataaa.getintvalue("numberOfSubtests");
-	numberOfControllers=myconfigdataaa.getintvalue("numberOfControllers"); //shared with ManhattanToyController
-	leniencyCoef=myconfigdataaa.getDoubleValue("leniencyCoef");
-	coevolution=myconfigdataaa.getintvalue("coevolution");
-    seeded = myconfigdataaa.getintvalue("startSeed");
+    learningConfig = LearningConfig(configPath);
+	populationSize=learningConfig.get(LearningConfig::populationSize);
+    numberOfElementsToMutate=learningConfig.get(LearningConfig::numberOfElementsToMutate);
+	numberOfChildren=learningConfig.get(LearningConfig::numberOfChildren);
+	numberOfTestsBetweenGenerations=learningConfig.get(LearningConfig::numberOfTestsBetweenGenerations);
+    numberOfSubtests=learningConfig.get(LearningConfig::numberOfSubtests);
+	numberOfControllers=learningConfig.get(LearningConfig::numberOfControllers); //shared with ManhattanToyController
+	leniencyCoef=learningConfig.get(LearningConfig::leniencyCoef);
+	coevolution=learningConfig.get(LearningConfig::coevolution);
+    seeded = learningConfig.get(LearningConfig::startSeed);
+    
+    bool learning = learningConfig.get(LearningConfig::learning);
     
-    bool learning = myconfigdataaa.getintvalue("learning");
+    checkpointInterval = learningConfig.get(LearningConfig::checkpointInterval, 1);
+    saveCheckpoints = learningConfig.get(LearningConfig::saveCheckpoints, 0);
     
     if (populationSize < numberOfElementsToMutate + numberOfChildren)
     {
         throw std::invalid_argument("Population will grow with given parameters");
     }
     
-   srand(rdtsc());
-	eng.seed(rdtsc());
+	if (learningConfig.has(LearningConfig::fitnessCacheResolution))
+	{
+		if (numberOfSubtests != 1)
+		{
+			throw std::invalid_argument("The fitness cache needs numberOfSubtests of 1");
+		}
+		const int capacity = learningConfig.get(LearningConfig::fitnessCacheSize, 10000);
+		fitnessCache = new FitnessCache(learningConfig.get(LearningConfig::fitnessCacheResolution), capacity);
+		surrogateNeighbors = learningConfig.get(LearningConfig::surrogateNeighbors, surrogateNeighbors);
+		surrogateQuantile = learningConfig.get(LearningConfig::surrogateQuantile, surrogateQuantile);
+	}
+	prescreenQuantile = learningConfig.get(LearningConfig::prescreenQuantile, prescreenQuantile);
+	prescreenAudit = learningConfig.get(LearningConfig::prescreenAudit, prescreenAudit);
+	trialTimeLimit = learningConfig.get(LearningConfig::trialTimeLimit, trialTimeLimit);
+
+	// Every draw follows the master seed, see tgRandom. A learner's
+	// stream is named by its suffix, so two learners differ.
+	tgRandom rng(tgRandom::eLearning, boost::hash<std::string>()(suffix));
+	// neuralNetwork draws its initial weights from rand()
+	srand(rng.next());
+	eng.seed(static_cast<unsigned long>(rng.next64()));
+	kernels.seed(rng.next64(), 0);
 
 	for(int j=0;j<numberOfControllers;j++)
 	{
 		cout<<"creating Populations"<<endl;
-		populations.push_back(new NeuroEvoPopulation(populationSize,myconfigdataaa));
+		populations.push_back(new NeuroEvoPopulation(populationSize,learningConfig));
 	}
+	// The members drew their parameters from rand(); draw them again
+	randomizeMembers();
 
     // Overwrite the random parameters based on data
     if(seeded) // Test that the file exists
@@ -108,18 +136,29 @@ suffix(suff)
             seededPop->loadFromFile(ss.str().c_str());
         }
     }
+    // The crashed run's logs are continued
+    const bool resumed = learningConfig.get(LearningConfig::resume, 0) && loadCheckpoint();
     if(learning)
     {
-		evolutionLog.open((resourcePath + "logs/evolution"+suffix+".csv").c_str(),ios::out);
+		evolutionLog.open((resourcePath + "logs/evolution"+suffix+".csv").c_str(),
+							resumed ? ios::app : ios::out);
 		if (!evolutionLog.is_open())
 		{
 			throw std::runtime_error("Logs does not exist. Please create a logs folder in your build directory or update your cmake file");
 		}
     }
+    
+    scoresLog.open((resourcePath + "logs/scores.csv").c_str(),ios::app);
+    if (prescreenQuantile > 0.0)
+    {
+        prescreenLog.open((resourcePath + "logs/prescreen" + suffix + ".csv").c_str(),
+                            resumed ? ios::app : ios::out);
+    }
 }
 
 NeuroEvolution::~NeuroEvolution()
 {
+	delete fitnessCache;
 	// @todo - solve the invalid pointer that occurs here
 	#if (0)
 	for(std::size_t i = 0; i < populations.size(); i++)
@@ -134,7 +173,7 @@ void NeuroEvolution::mutateEveryController()
 {
 	for(std::size_t i=0;i<populations.size();i++)
 	{
-		populations.at(i)->mutate(&eng,numberOfElementsToMutate);
+		populations.at(i)->mutate(&eng, kernels,numberOfElementsToMutate);
 	}
 }
 
@@ -142,19 +181,29 @@ void NeuroEvolution::combineAndMutate()
 {
     for(std::size_t i=0;i<populations.size();i++)
     {
-        populations.at(i)->combineAndMutate(&eng, numberOfElementsToMutate, numberOfChildren);
+        populations.at(i)->combineAndMutate(&eng, kernels, numberOfElementsToMutate, numberOfChildren);
     }    
 }
 
 void NeuroEvolution::orderAllPopulations()
 {
 	generationNumber++;
-	double aveScore1 = 0.0;
-	double aveScore2 = 0.0;
 #if (0)
 	// Disable definition of unused variables to suppress compiler warning
 	double maxScore1,maxScore2;
 #endif
+
+	for(std::size_t i=0;i<populations.size();i++)
+	{
+		populations.at(i)->orderPopulation();
+	}
+	logGeneration();
+}
+
+void NeuroEvolution::logGeneration()
+{
+	double aveScore1 = 0.0;
+	double aveScore2 = 0.0;
 	for(std::size_t i=0;i<scoresOfTheGeneration.size();i++)
 	{
 		aveScore1+=scoresOfTheGeneration[i][0];
@@ -163,11 +212,6 @@ void NeuroEvolution::orderAllPopulations()
 	aveScore1 /= scoresOfTheGeneration.size();
 	aveScore2 /= scoresOfTheGeneration.size();
 
-
-	for(std::size_t i=0;i<populations.size();i++)
-	{
-		populations.at(i)->orderPopulation();
-	}
 	/// @todo numberOfTestsBetweenGenerations may not be accurate
 	evolutionLog<<generationNumber*numberOfTestsBetweenGenerations<<","<<aveScore1<<","<<aveScore2<<",";
 	evolutionLog<<populations.at(0)->getMember(0)->maxScore<<","<<populations.at(0)->getMember(0)->maxScore1<<","<<populations.at(0)->getMember(0)->maxScore2<<endl;
@@ -175,7 +219,12 @@ void NeuroEvolution::orderAllPopulations()
 	
 	// what if member at 0 isn't the best of all time for some reason? 
 	// This seems biased towards average scores
-	ofstream logfileLeader;
+	// Leader files and buffered scores only reach the disk at checkpoints
+	if (generationNumber % checkpointInterval != 0)
+	{
+		return;
+	}
+	scoresLog.flush();
 	for(std::size_t i=0;i<populations.size();i++)
 	{
 		stringstream ss;
@@ -193,13 +242,7 @@ double diffclock(clock_t clock1,clock_t clock2)
 
 vector <NeuroEvoMember *> NeuroEvolution::nextSetOfControllers()
 {
-	int testsToDo=0;
-	if(coevolution)
-		testsToDo=numberOfTestsBetweenGenerations; //stop when we reach x amount of random tests
-	else
-		testsToDo=populationSize; //stop when we test each element once
-
-	if(currentTest == testsToDo)
+	if(currentTest == testsToDo())
 	{
 		orderAllPopulations();
         if (numberOfChildren == 0)
@@ -217,6 +260,12 @@ vector <NeuroEvoMember *> NeuroEvolution::nextSetOfControllers()
 			currentTest=0;//Start from 0
 		else
 			currentTest=populationSize - numberOfElementsToMutate - numberOfChildren; //start from the mutated ones only (last x)
+		
+		// Nothing of the new generation has run, so it resumes from here
+		if (saveCheckpoints && generationNumber % checkpointInterval == 0)
+		{
+			saveCheckpoint();
+		}
 	}
 
 	selectedControllers.clear();
@@ -224,7 +273,7 @@ vector <NeuroEvoMember *> NeuroEvolution::nextSetOfControllers()
 	{
 		int selectedOne=0;
 		if(coevolution)
-			selectedOne=rand()%populationSize; //select random one from each pool
+			selectedOne=static_cast<int>(kernels.uniform()*populationSize); //select random one from each pool
 		else
 			selectedOne=currentTest; //select the same from each pool
 
@@ -244,15 +293,22 @@ vector <NeuroEvoMember *> NeuroEvolution::nextSetOfControllers()
 }
 
 void NeuroEvolution::updateScores(vector <double> multiscore)
+{
+	cacheScores(selectedControllers, multiscore);
+	applyScores(selectedControllers, multiscore);
+}
+
+void NeuroEvolution::applyScores(const vector <NeuroEvoMember *>& controllers,
+						vector <double> multiscore)
 {
 	if(multiscore.size()==2)
 		this->scoresOfTheGeneration.push_back(multiscore);
 	else
 		multiscore.push_back(-1.0);
 	double score=1.0* multiscore[0] - 0.0 * multiscore[1];
-	for(std::size_t oneElem=0;oneElem<selectedControllers.size();oneElem++)
+	for(std::size_t oneElem=0;oneElem<controllers.size();oneElem++)
 	{
-		NeuroEvoMember * controllerPointer=selectedControllers.at(oneElem);
+		NeuroEvoMember * controllerPointer=controllers.at(oneElem);
 
 		controllerPointer->pastScores.push_back(score);
 		double prevScore=controllerPointer->maxScore;
@@ -270,9 +326,561 @@ void NeuroEvolution::updateScores(vector <double> multiscore)
 	}
 
 	//Record it to the file
-	ofstream payloadLog;
-	payloadLog.open((resourcePath + "logs/scores.csv").c_str(),ios::app);
-	payloadLog<<multiscore[0]<<","<<multiscore[1]<<endl;
-	payloadLog.close();
+	scoresLog<<multiscore[0]<<","<<multiscore[1]<<"\n";
 	return;
 }
+
+bool NeuroEvolution::trialParameters(const vector <NeuroEvoMember *>& controllers,
+						vector<double>& params) const
+{
+	params.clear();
+	for (std::size_t i = 0; i < controllers.size(); i++)
+	{
+		const vector<double>& p = controllers[i]->statelessParameters;
+		if (p.empty())
+		{
+			return false;
+		}
+		params.insert(params.end(), p.begin(), p.end());
+	}
+	return !params.empty();
+}
+
+bool NeuroEvolution::screenTrial(const vector <NeuroEvoMember *>& controllers,
+						vector<double>& scores) const
+{
+	vector<double> params;
+	if (fitnessCache == NULL || !trialParameters(controllers, params))
+	{
+		return false;
+	}
+	if (fitnessCache->find(params, scores))
+	{
+		return true;
+	}
+	
+	// A predicted score stays out of the generation's averages, as an
+	// exploded trial's does
+	double predicted = 0.0;
+	if (surrogateNeighbors > 0 &&
+		fitnessCache->predict(params, surrogateNeighbors, predicted) &&
+		predicted < fitnessCache->quantile(surrogateQuantile))
+	{
+		scores.assign(1, predicted);
+		return true;
+	}
+	return false;
+}
+
+void NeuroEvolution::cacheScores(const vector <NeuroEvoMember *>& controllers,
+						const vector<double>& scores)
+{
+	vector<double> params;
+	if (fitnessCache != NULL && trialParameters(controllers, params))
+	{
+		fitnessCache->insert(params, scores);
+	}
+}
+
+std::string NeuroEvolution::checkpointPath() const
+{
+	return resourcePath + "logs/checkpoint" + suffix + ".bin";
+}
+
+std::string NeuroEvolution::networkPath(std::size_t population, std::size_t member) const
+{
+	stringstream ss;
+	ss << checkpointPath() << "-" << population << "-" << member << ".nnw";
+	return ss.str();
+}
+
+void NeuroEvolution::randomizeMembers()
+{
+	for (std::size_t i = 0; i < populations.size(); i++)
+	{
+		for (std::size_t j = 0; j < populations[i]->controllers.size(); j++)
+		{
+			std::vector<double>& params = populations[i]->controllers[j]->statelessParameters;
+			if (!params.empty())
+			{
+				kernels.randomize(&params[0], params.size());
+			}
+		}
+	}
+}
+
+void NeuroEvolution::saveCheckpoint()
+{
+	// The last save must be done with the buffer before it is refilled
+	checkpoint.wait();
+	
+	checkpoint.generationNumber = generationNumber;
+	checkpoint.currentTest = currentTest;
+	checkpoint.subTests = subTests;
+	checkpoint.kernels = kernels.getState();
+	stringstream engine;
+	engine << eng;
+	checkpoint.engine = engine.str();
+	
+	checkpoint.populations.resize(populations.size());
+	for (std::size_t i = 0; i < populations.size(); i++)
+	{
+		const vector<NeuroEvoMember*>& members = populations[i]->controllers;
+		vector<EvolutionCheckpoint::Member>& saved = checkpoint.populations[i];
+		saved.resize(members.size());
+		for (std::size_t j = 0; j < members.size(); j++)
+		{
+			const NeuroEvoMember& member = *members[j];
+			saved[j].parameters = member.statelessParameters;
+			saved[j].pastScores = member.pastScores;
+			saved[j].maxScore = member.maxScore;
+			saved[j].maxScore1 = member.maxScore1;
+			saved[j].maxScore2 = member.maxScore2;
+			saved[j].averageScore = member.averageScore;
+			// The network is mutated next, so its weights can't wait
+			if (member.statelessParameters.empty())
+			{
+				members[j]->saveToFile(networkPath(i, j).c_str());
+			}
+		}
+	}
+	
+	checkpoint.save(checkpointPath());
+}
+
+bool NeuroEvolution::loadCheckpoint()
+{
+	if (!checkpoint.load(checkpointPath()))
+	{
+		return false;
+	}
+	
+	if (checkpoint.populations.size() != populations.size())
+	{
+		throw std::invalid_argument("The checkpoint has a different numberOfControllers");
+	}
+	for (std::size_t i = 0; i < populations.size(); i++)
+	{
+		const vector<NeuroEvoMember*>& members = populations[i]->controllers;
+		const vector<EvolutionCheckpoint::Member>& saved = checkpoint.populations[i];
+		if (saved.size() != members.size())
+		{
+			throw std::invalid_argument("The checkpoint has a different populationSize");
+		}
+		for (std::size_t j = 0; j < members.size(); j++)
+		{
+			NeuroEvoMember& member = *members[j];
+			if (saved[j].parameters.size() != member.statelessParameters.size())
+			{
+				throw std::invalid_argument("The checkpoint has a different numberOfActions");
+			}
+			member.statelessParameters = saved[j].parameters;
+			if (member.statelessParameters.empty())
+			{
+				member.loadFromFile(networkPath(i, j).c_str());
+			}
+			member.pastScores = saved[j].pastScores;
+			member.maxScore = saved[j].maxScore;
+			member.maxScore1 = saved[j].maxScore1;
+			member.maxScore2 = saved[j].maxScore2;
+			member.averageScore = saved[j].averageScore;
+		}
+	}
+	
+	if (checkpoint.currentTest < 0 || checkpoint.currentTest > testsToDo() ||
+		checkpoint.subTests < 0 || checkpoint.subTests >= numberOfSubtests)
+	{
+		throw std::invalid_argument("The checkpoint's trial doesn't fit the configuration");
+	}
+	generationNumber = checkpoint.generationNumber;
+	currentTest = checkpoint.currentTest;
+	subTests = checkpoint.subTests;
+	kernels.setState(checkpoint.kernels);
+	stringstream engine(checkpoint.engine);
+	if (!(engine >> eng))
+	{
+		throw std::invalid_argument("The checkpoint's engine state is corrupt");
+	}
+	
+	cout << "Resuming from generation " << generationNumber << endl;
+	return true;
+}
+
+int NeuroEvolution::testsToDo() const
+{
+	if(coevolution)
+		return numberOfTestsBetweenGenerations; //stop when we reach x amount of random tests
+	else
+		return populationSize; //stop when we test each element once
+}
+
+vector< vector <NeuroEvoMember *> > NeuroEvolution::nextGeneration()
+{
+	boost::mutex::scoped_lock lock(scoresMutex);
+	if (generationApplied < generationTrials.size())
+	{
+		throw std::runtime_error("Scores of the last generation are missing");
+	}
+	
+	generationTrials.clear();
+	do
+	{
+		generationTrials.push_back(nextSetOfControllers());
+	}
+	while (currentTest < testsToDo());
+	
+	generationScores.assign(generationTrials.size(), vector<double>());
+	generationScored.assign(generationTrials.size(), false);
+	generationSimulated.assign(generationTrials.size(), true);
+	generationPrescreen.assign(generationTrials.size(), vector<double>());
+	generationApplied = 0;
+	
+	return generationTrials;
+}
+
+void NeuroEvolution::updateScores(std::size_t trial, vector <double> scores)
+{
+	boost::mutex::scoped_lock lock(scoresMutex);
+	if (trial >= generationTrials.size() || generationScored[trial])
+	{
+		throw std::invalid_argument("Trial is not awaiting scores");
+	}
+	generationScores[trial] = scores;
+	generationScored[trial] = true;
+	
+	// Apply in trial order, as a serial run would
+	while (generationApplied < generationTrials.size() &&
+			generationScored[generationApplied])
+	{
+		if (generationSimulated[generationApplied])
+		{
+			cacheScores(generationTrials[generationApplied],
+						generationScores[generationApplied]);
+		}
+		applyScores(generationTrials[generationApplied],
+					generationScores[generationApplied]);
+		generationApplied++;
+	}
+}
+
+namespace
+{
+	/** Runs the listed trials of one generation on a tgThreadPool */
+	class NeuroEvolutionTask : public tgThreadPool::Task
+	{
+	public:
+		NeuroEvolutionTask(NeuroEvolution& evolution,
+					NeuroEvolution::Evaluator& evaluator,
+					const vector< vector <NeuroEvoMember *> >& trials,
+					const vector<std::size_t>& items) :
+		m_evolution(evolution),
+		m_evaluator(evaluator),
+		m_trials(trials),
+		m_items(items)
+		{
+		}
+		
+		virtual void operator()(std::size_t item)
+		{
+			const std::size_t trial = m_items[item];
+			m_evolution.updateScores(trial, m_evaluator.evaluate(m_trials[trial], trial));
+		}
+		
+	private:
+		NeuroEvolution& m_evolution;
+		NeuroEvolution::Evaluator& m_evaluator;
+		const vector< vector <NeuroEvoMember *> >& m_trials;
+		const vector<std::size_t>& m_items;
+	};
+}
+
+namespace
+{
+	/** Prescreens the listed trials of one generation on a tgThreadPool */
+	class PrescreenTask : public tgThreadPool::Task
+	{
+	public:
+		PrescreenTask(NeuroEvolution::Evaluator& evaluator,
+					const vector< vector <NeuroEvoMember *> >& trials,
+					const vector<std::size_t>& items,
+					vector< vector<double> >& scores,
+					vector<char>& screened) :
+		m_evaluator(evaluator),
+		m_trials(trials),
+		m_items(items),
+		m_scores(scores),
+		m_screened(screened)
+		{
+		}
+		
+		virtual void operator()(std::size_t item)
+		{
+			// Each item writes its own elements only
+			const std::size_t trial = m_items[item];
+			m_screened[item] = m_evaluator.prescreen(m_trials[trial], trial, m_scores[item]) &&
+								!m_scores[item].empty();
+		}
+		
+	private:
+		NeuroEvolution::Evaluator& m_evaluator;
+		const vector< vector <NeuroEvoMember *> >& m_trials;
+		const vector<std::size_t>& m_items;
+		vector< vector<double> >& m_scores;
+		vector<char>& m_screened;
+	};
+}
+
+void NeuroEvolution::prescreenTrials(Evaluator& evaluator, tgThreadPool& pool,
+						const vector< vector <NeuroEvoMember *> >& trials,
+						vector<std::size_t>& simulated)
+{
+	vector< vector<double> > cheap(simulated.size());
+	vector<char> screened(simulated.size(), 0);
+	PrescreenTask task(evaluator, trials, simulated, cheap, screened);
+	pool.run(task, simulated.size());
+	
+	vector<double> ranked;
+	for (std::size_t i = 0; i < simulated.size(); i++)
+	{
+		if (screened[i])
+		{
+			ranked.push_back(cheap[i][0]);
+		}
+	}
+	if (ranked.empty())
+	{
+		return;
+	}
+	const std::size_t k = static_cast<std::size_t>(prescreenQuantile * (ranked.size() - 1));
+	std::nth_element(ranked.begin(), ranked.begin() + k, ranked.end());
+	const double threshold = ranked[k];
+	
+	vector<std::size_t> full;
+	for (std::size_t i = 0; i < simulated.size(); i++)
+	{
+		const std::size_t t = simulated[i];
+		{
+			boost::mutex::scoped_lock lock(scoresMutex);
+			generationPrescreen[t] = cheap[i];
+		}
+		if (!screened[i] || cheap[i][0] >= threshold ||
+			(prescreenAudit > 0 && ++prescreenScreenedOut % prescreenAudit == 0))
+		{
+			full.push_back(t);
+			continue;
+		}
+		// Neither cached nor averaged as a simulated score would be
+		{
+			boost::mutex::scoped_lock lock(scoresMutex);
+			generationSimulated[t] = false;
+		}
+		updateScores(t, cheap[i]);
+	}
+	simulated.swap(full);
+}
+
+void NeuroEvolution::evaluateGeneration(Evaluator& evaluator, tgThreadPool& pool)
+{
+	const vector< vector <NeuroEvoMember *> > trials = nextGeneration();
+	
+	// Simulate each distinct trial once; the others take the cache's
+	// scores, the surrogate's, or those of their twin in this generation
+	vector<std::size_t> simulated;
+	vector< std::pair<std::size_t, std::size_t> > twins;
+	std::map<FitnessCache::Key, std::size_t> firstOf;
+	vector<double> params;
+	vector<double> scores;
+	for (std::size_t t = 0; t < trials.size(); t++)
+	{
+		if (screenTrial(trials[t], scores))
+		{
+			{
+				boost::mutex::scoped_lock lock(scoresMutex);
+				generationSimulated[t] = false;
+			}
+			updateScores(t, scores);
+			continue;
+		}
+		if (fitnessCache != NULL && trialParameters(trials[t], params))
+		{
+			const FitnessCache::Key key = fitnessCache->quantize(params);
+			std::map<FitnessCache::Key, std::size_t>::const_iterator it = firstOf.find(key);
+			if (it != firstOf.end())
+			{
+				twins.push_back(std::make_pair(t, it->second));
+				continue;
+			}
+			firstOf[key] = t;
+		}
+		simulated.push_back(t);
+	}
+	
+	// Full scores are logged beside the prescreen ones once they are in
+	const std::size_t prescreened = simulated.size();
+	vector<std::size_t> full = simulated;
+	if (prescreenQuantile > 0.0)
+	{
+		prescreenTrials(evaluator, pool, trials, full);
+	}
+	
+	NeuroEvolutionTask task(*this, evaluator, trials, full);
+	pool.run(task, full.size());
+	
+	if (prescreenLog.is_open())
+	{
+		boost::mutex::scoped_lock lock(scoresMutex);
+		for (std::size_t i = 0; i < prescreened; i++)
+		{
+			const std::size_t t = simulated[i];
+			const bool isFull = generationSimulated[t];
+			prescreenLog << generationNumber << "," << t << ","
+						<< (isFull ? "full" : "prescreen") << ",";
+			if (!generationPrescreen[t].empty())
+			{
+				prescreenLog << generationPrescreen[t][0];
+			}
+			prescreenLog << ",";
+			if (isFull && !generationScores[t].empty())
+			{
+				prescreenLog << generationScores[t][0];
+			}
+			prescreenLog << "\n";
+		}
+		prescreenLog.flush();
+	}
+	
+	for (std::size_t i = 0; i < twins.size(); i++)
+	{
+		{
+			boost::mutex::scoped_lock lock(scoresMutex);
+			scores = generationScores[twins[i].second];
+			generationSimulated[twins[i].first] = false;
+		}
+		updateScores(twins[i].first, scores);
+	}
+}
+
+namespace
+{
+	/** One worker of evaluateSteadyState() */
+	class SteadyStateTask : public tgThreadPool::Task
+	{
+	public:
+		SteadyStateTask(NeuroEvolution& evolution,
+					NeuroEvolution::Evaluator& evaluator) :
+		m_evolution(evolution),
+		m_evaluator(evaluator)
+		{
+		}
+		
+		virtual void operator()(std::size_t item)
+		{
+			m_evolution.runSteadyState(m_evaluator);
+		}
+		
+	private:
+		NeuroEvolution& m_evolution;
+		NeuroEvolution::Evaluator& m_evaluator;
+	};
+}
+
+void NeuroEvolution::evaluateSteadyState(Evaluator& evaluator, tgThreadPool& pool, std::size_t trials)
+{
+	if (coevolution)
+	{
+		throw std::invalid_argument("Steady state evolution needs coevolution 0");
+	}
+	
+	// Every member needs a score to be bred by
+	if (!steadyStarted)
+	{
+		evaluateGeneration(evaluator, pool);
+		for (std::size_t i = 0; i < populations.size(); i++)
+		{
+			populations[i]->orderPopulation();
+		}
+		scoresOfTheGeneration.clear();
+		steadyStarted = true;
+	}
+	
+	{
+		boost::mutex::scoped_lock lock(scoresMutex);
+		steadyTrials = trials;
+		steadyHanded = 0;
+	}
+	SteadyStateTask task(*this, evaluator);
+	pool.run(task, std::min(pool.size(), trials));
+}
+
+void NeuroEvolution::runSteadyState(Evaluator& evaluator)
+{
+	while (true)
+	{
+		vector <NeuroEvoMember *> children;
+		vector <double> scores;
+		std::size_t trial = 0;
+		bool screened = false;
+		{
+			boost::mutex::scoped_lock lock(scoresMutex);
+			if (steadyHanded == steadyTrials)
+			{
+				return;
+			}
+			trial = steadyHanded++;
+			for (std::size_t i = 0; i < populations.size(); i++)
+			{
+				children.push_back(populations[i]->breed(&eng, kernels, numberOfChildren > 0));
+			}
+			screened = screenTrial(children, scores);
+			if (screened)
+			{
+				applyScores(children, scores);
+			}
+		}
+		
+		bool inTime = true;
+		for (int i = 0; i < numberOfSubtests && !screened; i++)
+		{
+			const long long start = tgStepTimes::now();
+			scores = evaluator.evaluateWithin(children, trial, trialTimeLimit);
+			if (trialTimeLimit > 0.0 &&
+				(tgStepTimes::now() - start) * 1.0e-9 > trialTimeLimit)
+			{
+				inTime = false;
+				break;
+			}
+			boost::mutex::scoped_lock lock(scoresMutex);
+			if (i == 0)
+			{
+				cacheScores(children, scores);
+			}
+			applyScores(children, scores);
+		}
+		
+		boost::mutex::scoped_lock lock(scoresMutex);
+		for (std::size_t i = 0; i < children.size(); i++)
+		{
+			if (inTime)
+			{
+				populations[i]->insert(children[i]);
+			}
+			else
+			{
+				delete children[i];
+			}
+		}
+		if (!inTime)
+		{
+			cout << "Dropped trial " << trial << " over the time limit" << endl;
+			continue;
+		}
+		
+		// As many trials as a generation has make one in the logs
+		if (++steadyFinished % testsToDo() == 0 && !scoresOfTheGeneration.empty())
+		{
+			generationNumber++;
+			logGeneration();
+			scoresOfTheGeneration.clear();
+		}
+	}
+}
@@ -0,0 +1,402 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file SPSAEvolution.cpp
+ * @brief Contains the implementation of class SPSAEvolution
+ * $Id$
+ */
+ 
+#include "SPSAEvolution.h"
+#include "learning/Configuration/LearningConfig.h"
+#include "helpers/FileHelpers.h"
+#include "core/tgThreadPool.h"
+#include <cmath>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+SPSAEvolution::SPSAEvolution(std::string suff, std::string config, std::string path) :
+suffix(suff),
+currentTest(0),
+generationNumber(0),
+subTests(0),
+bestScore(-1000),
+bestScore1(-1000),
+bestScore2(-1000),
+generationApplied(0)
+{
+	if (path != "")
+	{
+		resourcePath = FileHelpers::getResourcePath(path);
+	}
+	else
+	{
+		resourcePath = "";
+	}
+	
+	std::string configPath = resourcePath + config;
+	
+    learningConfig = LearningConfig(configPath);
+    numParameters=learningConfig.get(LearningConfig::numberOfActions);
+    numberOfSubtests=learningConfig.get(LearningConfig::numberOfSubtests);
+    numberOfControllers=learningConfig.get(LearningConfig::numberOfControllers); //shared with ManhattanToyController
+    const bool seeded = learningConfig.get(LearningConfig::startSeed);
+    const bool learning = learningConfig.get(LearningConfig::learning);
+    
+    gradientSamples = learningConfig.get(LearningConfig::gradientSamples, 1);
+    gain = learningConfig.get(LearningConfig::spsaGain, 0.0625);
+    stability = learningConfig.get(LearningConfig::spsaStability, 15.0);
+    perturbationGain = learningConfig.get(LearningConfig::spsaPerturbation, 0.1);
+    
+    checkpointInterval = learningConfig.get(LearningConfig::checkpointInterval, 1);
+    if (numParameters < 1 || numberOfSubtests < 1 || gradientSamples < 1)
+    {
+        throw std::invalid_argument("numberOfActions, numberOfSubtests and gradientSamples must be positive");
+    }
+    
+    kernels.seed(time(NULL), clock());
+    
+    populations.resize(numberOfControllers);
+    for(int j=0;j<numberOfControllers;j++)
+    {
+        Population& pop = populations[j];
+        pop.estimate = SPSAMember(numParameters);
+        for (int k = 0; k < 2 * gradientSamples; k++)
+        {
+            pop.members.push_back(new SPSAMember(numParameters));
+        }
+        pop.directions.assign(gradientSamples, vector<double>(numParameters, 1.0));
+        
+        // Continue from the last estimate
+        if(seeded)
+        {
+            stringstream ss;
+            ss<< resourcePath <<"logs/bestParameters-"<<this->suffix<<"-"<<j<<".nnw";
+            pop.estimate.loadFromFile(ss.str().c_str());
+        }
+    }
+    scratch.resize(numParameters);
+    
+    if(learning)
+    {
+        evolutionLog.open((resourcePath + "logs/evolution" + suffix + ".csv").c_str(),ios::out);
+        if (!evolutionLog.is_open())
+        {
+			throw std::runtime_error("Logs does not exist. Please create a logs folder in your build directory or update your cmake file");
+		}
+    }
+    
+    scoresLog.open((resourcePath + "logs/scores.csv").c_str(),ios::app);
+    
+    perturbGeneration();
+}
+
+SPSAEvolution::~SPSAEvolution()
+{
+    for(std::size_t i = 0; i < populations.size(); i++)
+    {
+        for (std::size_t k = 0; k < populations[i].members.size(); k++)
+        {
+            delete populations[i].members[k];
+        }
+    }
+}
+
+double SPSAEvolution::perturbation() const
+{
+    return perturbationGain / pow(generationNumber + 1.0, 0.166);
+}
+
+void SPSAEvolution::perturbGeneration()
+{
+    const double ck = perturbation();
+    for (std::size_t p = 0; p < populations.size(); p++)
+    {
+        Population& pop = populations[p];
+        const vector<double>& x = pop.estimate.statelessParameters;
+        for (int s = 0; s < gradientSamples; s++)
+        {
+            // Bernoulli +-1 with equal probability
+            vector<double>& d = pop.directions[s];
+            kernels.randomize(&scratch[0], numParameters);
+            for (std::size_t i = 0; i < numParameters; i++)
+            {
+                d[i] = scratch[i] < 0.5 ? -1.0 : 1.0;
+            }
+            
+            vector<double>& plus = pop.members[2 * s]->statelessParameters;
+            vector<double>& minus = pop.members[2 * s + 1]->statelessParameters;
+            for (std::size_t i = 0; i < numParameters; i++)
+            {
+                const double a = x[i] + ck * d[i];
+                const double b = x[i] - ck * d[i];
+                plus[i] = a < 0.0 ? 0.0 : (a > 1.0 ? 1.0 : a);
+                minus[i] = b < 0.0 ? 0.0 : (b > 1.0 ? 1.0 : b);
+            }
+        }
+        for (std::size_t k = 0; k < pop.members.size(); k++)
+        {
+            pop.members[k]->pastScores.clear();
+            pop.members[k]->maxScore = -1000;
+        }
+    }
+}
+
+void SPSAEvolution::updateEstimates()
+{
+    const double k = generationNumber + 1.0;
+    const double ak = gain / (stability + k);
+    const double ck = perturbation();
+    
+    for (std::size_t p = 0; p < populations.size(); p++)
+    {
+        Population& pop = populations[p];
+        vector<double>& x = pop.estimate.statelessParameters;
+        
+        // ak times the gradient averaged over the samples; d is +-1, so
+        // dividing by it is multiplying by it
+        const double scale = ak / (2.0 * ck * gradientSamples);
+        for (int s = 0; s < gradientSamples; s++)
+        {
+            const double difference = pop.members[2 * s]->averageScore() -
+                                        pop.members[2 * s + 1]->averageScore();
+            const vector<double>& d = pop.directions[s];
+            for (std::size_t i = 0; i < numParameters; i++)
+            {
+                x[i] += scale * difference * d[i];
+            }
+        }
+        for (std::size_t i = 0; i < numParameters; i++)
+        {
+            x[i] = x[i] < 0.0 ? 0.0 : (x[i] > 1.0 ? 1.0 : x[i]);
+        }
+    }
+    
+    generationNumber++;
+    writeLog();
+    scoresOfTheGeneration.clear();
+}
+
+void SPSAEvolution::writeLog()
+{
+    double aveScore1 = 0.0;
+    double aveScore2 = 0.0;
+    for(std::size_t i=0;i<scoresOfTheGeneration.size();i++)
+    {
+        aveScore1+=scoresOfTheGeneration[i][0];
+        aveScore2+=scoresOfTheGeneration[i][1];
+    }
+    if (!scoresOfTheGeneration.empty())
+    {
+        aveScore1 /= scoresOfTheGeneration.size();
+        aveScore2 /= scoresOfTheGeneration.size();
+    }
+    
+    evolutionLog<<generationNumber*testsToDo()<<","<<aveScore1<<","<<aveScore2<<",";
+    evolutionLog<<bestScore<<","<<bestScore1<<","<<bestScore2<<",";
+    evolutionLog<<perturbation()<<endl;
+    
+    // Leader files and buffered scores only reach the disk at checkpoints
+    if (generationNumber % checkpointInterval != 0)
+    {
+        return;
+    }
+    scoresLog.flush();
+    for(std::size_t i=0;i<populations.size();i++)
+    {
+        stringstream ss;
+        ss << resourcePath << "logs/bestParameters-" << suffix << "-" << i << ".nnw";
+        populations[i].estimate.saveToFile(ss.str().c_str());
+    }
+}
+
+vector <SPSAMember *> SPSAEvolution::nextSetOfControllers()
+{
+    if(currentTest == testsToDo())
+    {
+        updateEstimates();
+        perturbGeneration();
+        currentTest = 0;
+    }
+
+    selectedControllers.clear();
+    for(std::size_t i=0;i<populations.size();i++)
+    {
+        selectedControllers.push_back(populations[i].members[currentTest]);
+    }
+    
+    subTests++;
+    
+    if (subTests == numberOfSubtests)
+    {
+        currentTest++;
+        subTests = 0;
+    }
+
+    return selectedControllers;
+}
+
+void SPSAEvolution::updateScores(vector <double> multiscore)
+{
+    applyScores(selectedControllers, multiscore);
+}
+
+void SPSAEvolution::applyScores(const vector <SPSAMember *>& controllers,
+                        vector <double> multiscore)
+{
+    if(multiscore.size()==2)
+        this->scoresOfTheGeneration.push_back(multiscore);
+    else
+        multiscore.push_back(-1.0);
+    const double score = multiscore[0];
+    
+    if (score > bestScore)
+    {
+        bestScore = score;
+        bestScore1 = multiscore[0];
+        bestScore2 = multiscore[1];
+    }
+    
+    //Record it to the file
+    scoresLog<<multiscore[0]<<","<<multiscore[1];
+    
+    for(std::size_t oneElem=0;oneElem<controllers.size();oneElem++)
+    {
+        SPSAMember * controllerPointer=controllers.at(oneElem);
+
+        controllerPointer->pastScores.push_back(score);
+        if(score > controllerPointer->maxScore)
+        {
+            controllerPointer->maxScore=score;
+            controllerPointer->maxScore1=multiscore[0];
+            controllerPointer->maxScore2=multiscore[1];
+        }
+        std::size_t n = controllerPointer->statelessParameters.size();
+        for (std::size_t i = 0; i < n; i++)
+        {
+            scoresLog << "," << controllerPointer->statelessParameters[i];
+        }
+    }
+
+    scoresLog<<"\n";
+}
+
+int SPSAEvolution::testsToDo() const
+{
+    return 2 * gradientSamples;
+}
+
+const std::vector<double>& SPSAEvolution::estimate(std::size_t population) const
+{
+    return populations.at(population).estimate.statelessParameters;
+}
+
+vector< vector <SPSAMember *> > SPSAEvolution::nextGeneration()
+{
+    boost::mutex::scoped_lock lock(scoresMutex);
+    if (generationApplied < generationTrials.size())
+    {
+        throw std::runtime_error("Scores of the last generation are missing");
+    }
+    
+    generationTrials.clear();
+    do
+    {
+        generationTrials.push_back(nextSetOfControllers());
+    }
+    while (currentTest < testsToDo());
+    
+    generationScores.assign(generationTrials.size(), vector<double>());
+    generationScored.assign(generationTrials.size(), false);
+    generationApplied = 0;
+    
+    return generationTrials;
+}
+
+void SPSAEvolution::updateScores(std::size_t trial, vector <double> scores)
+{
+    boost::mutex::scoped_lock lock(scoresMutex);
+    if (trial >= generationTrials.size() || generationScored[trial])
+    {
+        throw std::invalid_argument("Trial is not awaiting scores");
+    }
+    generationScores[trial] = scores;
+    generationScored[trial] = true;
+    
+    // Apply in trial order, as a serial run would
+    while (generationApplied < generationTrials.size() &&
+            generationScored[generationApplied])
+    {
+        applyScores(generationTrials[generationApplied],
+                    generationScores[generationApplied]);
+        generationApplied++;
+    }
+}
+
+namespace
+{
+    /** Runs the trials of one generation on a tgThreadPool */
+    class SPSAEvolutionTask : public tgThreadPool::Task
+    {
+    public:
+        SPSAEvolutionTask(SPSAEvolution& evolution,
+                    SPSAEvolution::Evaluator& evaluator,
+                    const vector< vector <SPSAMember *> >& trials) :
+        m_evolution(evolution),
+        m_evaluator(evaluator),
+        m_trials(trials)
+        {
+        }
+        
+        virtual void operator()(std::size_t item)
+        {
+            m_evolution.updateScores(item, m_evaluator.evaluate(m_trials[item], item));
+        }
+        
+    private:
+        SPSAEvolution& m_evolution;
+        SPSAEvolution::Evaluator& m_evaluator;
+        const vector< vector <SPSAMember *> >& m_trials;
+    };
+}
+
+void SPSAEvolution::evaluateGeneration(Evaluator& evaluator, tgThreadPool& pool)
+{
+    const vector< vector <SPSAMember *> > trials = nextGeneration();
+    SPSAEvolutionTask task(*this, evaluator, trials);
+    pool.run(task, trials.size());
+}
+
+void SPSAEvolution::evaluateBatch(BatchEvaluator& evaluator)
+{
+    const vector< vector <SPSAMember *> > trials = nextGeneration();
+    const vector< vector <double> > scores = evaluator.evaluate(trials);
+    if (scores.size() != trials.size())
+    {
+        throw std::runtime_error("The batch did not score every trial");
+    }
+    for (std::size_t trial = 0; trial < trials.size(); trial++)
+    {
+        updateScores(trial, scores[trial]);
+    }
+}
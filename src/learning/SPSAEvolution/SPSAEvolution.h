@@ -0,0 +1,215 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef SPSAEVOLUTION_H_
+#define SPSAEVOLUTION_H_
+
+/**
+ * @file SPSAEvolution.h
+ * @brief Contains the definition of class SPSAEvolution.
+ * $Id$
+ */
+
+#include "SPSAMember.h"
+#include "learning/Configuration/LearningConfig.h"
+#include "util/ParameterKernels.h"
+#include <fstream>
+#include <string>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+
+// Forward declarations
+class tgThreadPool;
+
+/**
+ * Simultaneous perturbation stochastic approximation (SPSA) with the
+ * interface of AnnealEvolution, after scripts/learning/src/SPSA. Each of
+ * the numberOfControllers populations keeps one estimate x of its
+ * numberOfActions parameters in [0, 1]. Iteration k draws gradientSamples
+ * random directions d of +-1 per population, and a generation is the
+ * 2 * gradientSamples trials x + ck d and x - ck d (clamped) that estimate
+ * the gradient, trial 2s and 2s + 1 being the pair of sample s. Every
+ * trial runs numberOfSubtests times. The estimate then moves by
+ * ak (s+ - s-) / (2 ck d), averaged over the samples, and is clamped.
+ *
+ * The gains are ak = spsaGain / (spsaStability + k) and
+ * ck = spsaPerturbation / k^0.166, as in the script; the defaults are
+ * those of its testSPSASpec.json, 0.0625, 15 and 0.1.
+ *
+ * No trial depends on another of its generation, so all of them should
+ * be run at once: on a pool with evaluateGeneration(), or as one batch,
+ * such as one tgBatchSimulation world per trial, with evaluateBatch().
+ * An estimate of the gradient then takes about as long as one trial.
+ */
+class SPSAEvolution
+{
+public:
+    /**
+     * Runs one trial for evaluateGeneration(). Implementations are called
+     * concurrently, so each call must use its own simulation.
+     */
+    class Evaluator
+    {
+    public:
+        virtual ~Evaluator() { }
+        
+        /**
+         * @param[in] controllers one member of each population
+         * @param[in] trial the index of the trial in the generation
+         * @return the scores, as passed to updateScores()
+         */
+        virtual std::vector<double> evaluate(const std::vector< SPSAMember *>& controllers,
+                                                std::size_t trial) = 0;
+    };
+    
+    /**
+     * Runs every trial of a generation at once for evaluateBatch(), e.g.
+     * in the worlds of one tgBatchSimulation stepped together.
+     */
+    class BatchEvaluator
+    {
+    public:
+        virtual ~BatchEvaluator() { }
+        
+        /**
+         * @param[in] trials one member of each population per trial, each
+         * trial listed numberOfSubtests times in a row
+         * @return the scores of each trial, as passed to updateScores()
+         */
+        virtual std::vector< std::vector<double> >
+        evaluate(const std::vector< std::vector< SPSAMember *> >& trials) = 0;
+    };
+    
+    SPSAEvolution(std::string suffix, std::string config = "config.ini", std::string path = "");
+    ~SPSAEvolution();
+    std::vector< SPSAMember *> nextSetOfControllers();
+    void updateScores(std::vector<double> scores);
+    
+    /**
+     * Hand out every trial left in the generation, as
+     * nextSetOfControllers() would one at a time. Scores may then be
+     * given in any order, from any thread, with updateScores(trial, ...);
+     * they are applied in trial order, so the outcome matches a serial run.
+     * @throw std::runtime_error if scores of the last generation are missing
+     */
+    std::vector< std::vector< SPSAMember *> > nextGeneration();
+    
+    /**
+     * Record the scores of one trial from nextGeneration(). Thread safe.
+     * @throw std::invalid_argument if the trial is out of range or was
+     * already scored
+     */
+    void updateScores(std::size_t trial, std::vector<double> scores);
+    
+    /**
+     * Run a whole generation from nextGeneration() on a pool, one trial
+     * per item, and record the scores.
+     */
+    void evaluateGeneration(Evaluator& evaluator, tgThreadPool& pool);
+    
+    /**
+     * Run a whole generation from nextGeneration() as one batch and
+     * record the scores.
+     * @throw std::runtime_error if the batch doesn't return one set of
+     * scores per trial
+     */
+    void evaluateBatch(BatchEvaluator& evaluator);
+    
+    /** @return the current estimate of a population's parameters */
+    const std::vector<double>& estimate(std::size_t population) const;
+    
+    /** @return the perturbation size ck of the current iteration */
+    double perturbation() const;
+    
+    /** The configuration, parsed once, for the adapters */
+    const LearningConfig& getConfig() const { return learningConfig; }
+    
+    const std::string suffix;
+    std::string resourcePath;
+    
+private:
+    /** The estimate and current perturbations of one controller */
+    struct Population
+    {
+        /** The estimate, written to the leader file */
+        SPSAMember estimate;
+        /** x + ck d and x - ck d of each sample, alternating */
+        std::vector< SPSAMember *> members;
+        /** The direction d of each sample, +1 or -1 per parameter */
+        std::vector< std::vector<double> > directions;
+    };
+    
+    /** Draw the directions and place the members of every population */
+    void perturbGeneration();
+    
+    /** Move every estimate along its gradient estimate */
+    void updateEstimates();
+    
+    void writeLog();
+    
+    /** The number of trials in a generation */
+    int testsToDo() const;
+    
+    /** Score one set of controllers */
+    void applyScores(const std::vector< SPSAMember *>& controllers,
+                        std::vector<double> multiscore);
+    
+    LearningConfig learningConfig;
+    std::size_t numParameters;
+    int numberOfControllers;
+    int numberOfSubtests;
+    int gradientSamples;
+    
+    double gain;
+    double stability;
+    double perturbationGain;
+    
+    ParameterKernels kernels;
+    std::vector<Population> populations;
+    std::vector <SPSAMember *>  selectedControllers;
+    std::vector< std::vector< double > > scoresOfTheGeneration;
+    /** Scratch for drawing directions */
+    std::vector<double> scratch;
+    
+    std::ofstream evolutionLog;
+    /** logs/scores.csv, kept open and flushed at each checkpoint */
+    std::ofstream scoresLog;
+    /**
+     * Generations between writes of the leaders' parameter files, from
+     * the optional checkpointInterval key; 1 if absent
+     */
+    int checkpointInterval;
+    int currentTest;
+    int generationNumber;
+    int subTests;
+    /** The best trial score seen, with its two parts */
+    double bestScore;
+    double bestScore1;
+    double bestScore2;
+    
+    /** The trials handed out by nextGeneration() */
+    std::vector< std::vector< SPSAMember *> > generationTrials;
+    std::vector< std::vector<double> > generationScores;
+    std::vector<bool> generationScored;
+    /** The trials whose scores have been applied, a prefix */
+    std::size_t generationApplied;
+    /** Guards the generation's scores and everything they update */
+    boost::mutex scoresMutex;
+};
+
+#endif /* SPSAEVOLUTION_H_ */
@@ -0,0 +1,89 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file SPSAMember.cpp
+ * @brief Contains the implementation of class SPSAMember
+ * $Id$
+ */
+
+#include "SPSAMember.h"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+SPSAMember::SPSAMember(std::size_t numParameters) :
+statelessParameters(numParameters, 0.5),
+maxScore(-1000),
+maxScore1(-1000),
+maxScore2(-1000)
+{
+}
+
+SPSAMember::~SPSAMember()
+{
+}
+
+void SPSAMember::saveToFile(const char * outputFilename)
+{
+    ofstream ss(outputFilename);
+    for(std::size_t i=0;i<statelessParameters.size();i++)
+    {
+        ss<<statelessParameters[i];
+        if(i!=statelessParameters.size()-1)
+            ss<<",";
+    }
+    ss.close();
+}
+
+void SPSAMember::loadFromFile(const char * inputFilename)
+{
+    ifstream ss(inputFilename);
+    if(!ss.is_open())
+    {
+        cout << "File of name " << inputFilename << " does not exist" << std::endl;
+        cout << "Try turning learning on in config.ini to generate parameters" << std::endl;
+        throw std::invalid_argument("Parameter file does not exist");
+    }
+    
+    string value;
+    std::size_t i = 0;
+    while(i < statelessParameters.size() && getline(ss, value, ','))
+    {
+        statelessParameters[i++]=atof(value.c_str());
+    }
+    ss.close();
+}
+
+double SPSAMember::averageScore() const
+{
+    if (pastScores.empty())
+    {
+        return -1.0;
+    }
+    double sum = 0.0;
+    for (std::size_t i = 0; i < pastScores.size(); i++)
+    {
+        sum += pastScores[i];
+    }
+    return sum / pastScores.size();
+}
@@ -96,8 +96,8 @@ int main(int argc, char** argv)
     simulation.addModel(myObstacle);
     
 	tgStairs* bigStairs = new tgStairs();
-	// Add the stairs to the world
-	simulation.addObstacle(bigStairs);
+	// Add the stairs to the world, built once and kept on every reset
+	simulation.addPersistentObstacle(bigStairs);
 
     for (int i = 0; i < 3; i++)
     {
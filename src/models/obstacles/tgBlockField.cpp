@@ -26,10 +26,9 @@
 #include "tgBlockField.h"
 // This library
 #include "core/tgBox.h"
-#include "tgcreator/tgBuildSpec.h"
-#include "tgcreator/tgBoxInfo.h"
+#include "core/tgRandom.h"
+#include "tgObstacleCompound.h"
 #include "tgcreator/tgStructure.h"
-#include "tgcreator/tgStructureInfo.h"
 #include "tgcreator/tgNode.h"
 #include "tgcreator/tgUtil.h"
 // The Bullet Physics library
@@ -37,7 +36,6 @@
 // The C++ Standard Library
 #include <stdexcept>
 #include <vector>
-#include <numeric> // RAND_MAX
 
 tgBlockField::Config::Config(btVector3 origin,
                              btScalar friction, 
@@ -47,7 +45,8 @@ tgBlockField::Config::Config(btVector3 origin,
                              size_t nBlocks, 
                              double blockLength, 
                              double blockWidth, 
-                             double blockHeight) :
+                             double blockHeight,
+                             unsigned int seed) :
 m_origin(origin),
 m_friction(friction),
 m_restitution(restitution),
@@ -56,7 +55,8 @@ m_maxPos(maxPos),
 m_nBlocks(nBlocks),
 m_length(blockLength),
 m_width(blockWidth),
-m_height(blockHeight)
+m_height(blockHeight),
+m_seed(seed)
 {
     assert(m_friction >= 0.0);
     assert(m_restitution >= 0.0);
@@ -70,18 +70,12 @@ tgBlockField::tgBlockField() :
 tgModel(),
 m_config()
 {
-    // Seed the random number generator
-    /// @todo assess if doing this multiple times in a trial (here and evolution) causes problems
-    tgUtil::seedRandom(1);
 }
 
 tgBlockField::tgBlockField(tgBlockField::Config& config) :
 tgModel(),
 m_config(config)
 {
-    // Seed the random number generator
-    /// @todo assess if doing this multiple times in a trial (here and evolution) causes problems
-    tgUtil::seedRandom(1);
 }
 
 tgBlockField::~tgBlockField() {}
@@ -94,15 +88,8 @@ void tgBlockField::setup(tgWorld& world) {
     tgStructure s;
     addNodes(s);
 
-    // Create the build spec that uses tags to turn the structure into a real model
-    tgBuildSpec spec;
-    spec.addBuilder("box", new tgBoxInfo(boxConfig));
-
-    // Create your structureInfo
-    tgStructureInfo structureInfo(s, spec);
-
-    // Use the structureInfo to build ourselves
-    structureInfo.buildInto(*this, world);
+    // Build the boxes as one static compound body
+    tgObstacleCompound::buildInto(*this, world, s, boxConfig);
 
     // Actually setup the children
     tgModel::setup(world);
@@ -131,10 +118,13 @@ void tgBlockField::addNodes(tgStructure& s) {
     
     btVector3 fieldSize = m_config.m_maxPos - m_config.m_minPos;
     
+    // The same field in every world and episode, whatever else draws
+    tgRandom rng(tgRandom::eTerrain, 0, m_config.m_seed);
+    
     for(size_t i = 0; i < 2 * m_config.m_nBlocks; i += 2) {
-        double xOffset = fieldSize.getX() * rand() / RAND_MAX;
-        double yOffset = fieldSize.getY() * rand() / RAND_MAX;
-        double zOffset = fieldSize.getZ() * rand() / RAND_MAX;
+        double xOffset = fieldSize.getX() * rng.uniform();
+        double yOffset = fieldSize.getY() * rng.uniform();
+        double zOffset = fieldSize.getZ() * rng.uniform();
         
         btVector3 offset(xOffset, yOffset, zOffset);
         
@@ -59,7 +59,8 @@ public:
                     size_t nBlocks = 500,
                     double blockLength = 5.0,
                     double blockWidth = 5.0,
-                    double blockHeight = 5.0);
+                    double blockHeight = 5.0,
+                    unsigned int seed = 1);
 
             /** Origin position of the block field */
             btVector3 m_origin;
@@ -87,6 +88,13 @@ public:
             
             /** Height of the blocks */
             double m_height;
+
+            /**
+             * Seeds the tgRandom stream that places the blocks, which the
+             * master seed doesn't change, so a field is the same in
+             * every run
+             */
+            unsigned int m_seed;
     };
     
    /**
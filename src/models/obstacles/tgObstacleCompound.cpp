@@ -0,0 +1,93 @@
+/*
+ * Copyright © 2014, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+
+/**
+ * @file tgObstacleCompound.cpp
+ * @brief Contains the definitions of members of class tgObstacleCompound
+ * $Id$
+ */
+
+// This module
+#include "tgObstacleCompound.h"
+// This library
+#include "core/tgModel.h"
+#include "tgcreator/tgBoxInfo.h"
+#include "tgcreator/tgCompoundRigidInfo.h"
+#include "tgcreator/tgPair.h"
+#include "tgcreator/tgPairs.h"
+#include "tgcreator/tgStructure.h"
+#include "core/tgTagSearch.h"
+// The C++ Standard Library
+#include <cassert>
+#include <vector>
+
+namespace
+{
+    void collectBoxes(const tgStructure& structure, const tgBox::Config& config,
+                      const tgTagSearch& search, std::vector<tgBoxInfo*>& boxes)
+    {
+        const tgPairs& pairs = structure.getPairs();
+        for (int i = 0; i < pairs.size(); i++)
+        {
+            if (search.matches(pairs[i].getTags()))
+            {
+                boxes.push_back(new tgBoxInfo(config, pairs[i]));
+            }
+        }
+
+        const std::vector<tgStructure*>& children = structure.getChildren();
+        for (std::size_t i = 0; i < children.size(); i++)
+        {
+            collectBoxes(*children[i], config, search, boxes);
+        }
+    }
+} // namespace
+
+void tgObstacleCompound::buildInto(tgModel& model, tgWorld& world,
+                                   const tgStructure& structure,
+                                   const tgBox::Config& config,
+                                   const std::string& tag)
+{
+    std::vector<tgBoxInfo*> boxes;
+    collectBoxes(structure, config, tgTagSearch(tag), boxes);
+    if (boxes.empty())
+    {
+        return;
+    }
+
+    // The infos only describe the body; the world owns what they create
+    tgCompoundRigidInfo compound;
+    for (std::size_t i = 0; i < boxes.size(); i++)
+    {
+        compound.addRigid(*boxes[i]);
+        boxes[i]->setRigidInfoGroup(&compound);
+    }
+
+    // The first box creates the body for the whole group, the others find
+    // it already set and only apply their friction and restitution
+    for (std::size_t i = 0; i < boxes.size(); i++)
+    {
+        model.addChild(boxes[i]->createModel(world));
+    }
+    assert(compound.getRigidBody() != NULL);
+
+    for (std::size_t i = 0; i < boxes.size(); i++)
+    {
+        delete boxes[i];
+    }
+}
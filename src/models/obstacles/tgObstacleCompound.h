@@ -0,0 +1,67 @@
+/*
+ * Copyright © 2014, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+
+#ifndef TG_OBSTACLE_COMPOUND_H
+#define TG_OBSTACLE_COMPOUND_H
+
+/**
+ * @file tgObstacleCompound.h
+ * @brief Contains the definition of class tgObstacleCompound.
+ * $Id$
+ */
+
+// This library
+#include "core/tgBox.h"
+// The C++ Standard Library
+#include <string>
+
+// Forward declarations
+class tgModel;
+class tgStructure;
+class tgWorld;
+
+/**
+ * Builds the boxes of an obstacle as one static body. Built by a
+ * tgStructureInfo, every box is its own btRigidBody and broadphase proxy,
+ * so a crater or block field adds dozens of proxies that overlap each
+ * other and the robot. Here the boxes become children of a single
+ * btCompoundShape, whose dynamic AABB tree finds the boxes near a contact,
+ * so the broadphase sees one proxy. Each box is still a tgBox child of the
+ * model, sharing the body.
+ */
+class tgObstacleCompound
+{
+public:
+
+    /**
+     * Build every pair of structure and its children tagged with tag as
+     * a box of config, all in one body. The config's density should be
+     * zero so the body is static.
+     * @param[in,out] model receives a tgBox per box
+     * @param[in,out] world the world to build in
+     * @param[in] structure the obstacle
+     * @param[in] config the boxes
+     * @param[in] tag the tag of the box pairs
+     */
+    static void buildInto(tgModel& model, tgWorld& world,
+                          const tgStructure& structure,
+                          const tgBox::Config& config,
+                          const std::string& tag = "box");
+};
+
+#endif  // TG_OBSTACLE_COMPOUND_H
@@ -26,10 +26,8 @@
 #include "tgWall.h"
 // This library
 #include "core/tgBox.h"
-#include "tgcreator/tgBuildSpec.h"
-#include "tgcreator/tgBoxInfo.h"
+#include "tgObstacleCompound.h"
 #include "tgcreator/tgStructure.h"
-#include "tgcreator/tgStructureInfo.h"
 #include "tgcreator/tgNode.h"
 // The Bullet Physics library
 #include "LinearMath/btVector3.h"
@@ -76,15 +74,8 @@ void Wall::setup(tgWorld& world) {
     tgStructure s;
     addNodes(s);
 
-    // Create the build spec that uses tags to turn the structure into a real model
-    tgBuildSpec spec;
-    spec.addBuilder("box", new tgBoxInfo(boxConfig));
-
-    // Create your structureInfo
-    tgStructureInfo structureInfo(s, spec);
-
-    // Use the structureInfo to build ourselves
-    structureInfo.buildInto(*this, world);
+    // Build the boxes as one static compound body
+    tgObstacleCompound::buildInto(*this, world, s, boxConfig);
 
     // call the onSetup methods of all observed things e.g. controllers
     notifySetup();
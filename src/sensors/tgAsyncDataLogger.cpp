@@ -0,0 +1,343 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgAsyncDataLogger.cpp
+ * @brief Contains the implementation of concrete class tgAsyncDataLogger
+ * $Id$
+ */
+
+// This module
+#include "tgAsyncDataLogger.h"
+// This application
+#include "tgSensor.h"
+#include "core/tgMemoryReport.h"
+#include "tgSampleRing.h"
+#include "tgBufferedFileWriter.h"
+#include "tgBinaryDataLogger.h"
+#include "tgSamplingPolicy.h"
+// Includes from Boost:
+#include <boost/bind.hpp>
+// The C++ Standard Library
+#include <stdexcept>
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <time.h> // for the file name of the log file
+#include <cstdlib> // for getenv
+
+tgAsyncDataLogger::tgAsyncDataLogger(std::string fileNamePrefix,
+				     double timeInterval,
+				     Format format,
+				     std::size_t capacity,
+				     Overflow overflow) :
+  tgDataManager(),
+  m_fileNamePrefix(fileNamePrefix),
+  m_format(format),
+  m_capacity(capacity),
+  m_overflow(overflow),
+  m_pRing(NULL),
+  m_pWriter(NULL),
+  m_stop(false),
+  m_totalTime(0.0),
+  m_timeInterval(timeInterval),
+  m_updateTime(0.0),
+  m_dropped(0),
+  m_decimation(1),
+  m_skipped(0)
+{
+  // Same checks as tgDataLogger2.
+  if (m_fileNamePrefix == "") {
+    throw std::invalid_argument("File name cannot be the empty string. Please pass in a path to a file that can be opened.");
+  }
+  if (m_timeInterval < 0.0 ) {
+    throw std::invalid_argument("Time interval must be nonnegative. Negative time intervals do not make sense.");
+  }
+  if (m_capacity == 0) {
+    throw std::invalid_argument("Capacity must be positive in tgAsyncDataLogger.");
+  }
+  // Expand "~" to the home directory.
+  if (m_fileNamePrefix.at(0) == '~') {
+    std::string home = std::getenv("HOME");
+    m_fileNamePrefix.erase(0,1);
+    m_fileNamePrefix = home + m_fileNamePrefix;
+  }
+  // The writer thread does the file output itself, so the writer doesn't
+  // need one of its own.
+  m_pWriter = new tgBufferedFileWriter();
+  
+  // Postcondition  
+  assert(invariant());
+}
+
+tgAsyncDataLogger::~tgAsyncDataLogger()
+{
+  stopWriter();
+  // The writer's destructor writes out anything buffered and closes the file.
+  delete m_pWriter;
+  delete m_pRing;
+}
+
+void tgAsyncDataLogger::setCompression(int level)
+{
+  m_pWriter->setCompression(level);
+}
+
+/**
+ * As in tgBinaryDataLogger: create the sensors, name the file after the
+ * current time and write the header. The writer thread then owns the file
+ * until teardown.
+ */
+void tgAsyncDataLogger::setup()
+{
+  // A reset calls setup again without a teardown in between.
+  stopWriter();
+  m_pWriter->close();
+
+  // Call the parent's setup method, which creates the sensors.
+  tgDataManager::setup();
+
+  time_t rawtime;
+  tm* currentTime;
+  const int fileTimeSize = 64;
+  char fileTime [fileTimeSize];
+  time (&rawtime);
+  currentTime = localtime(&rawtime);
+  strftime(fileTime, fileTimeSize, "%m%d%Y_%H%M%S", currentTime);
+  m_fileName = m_fileNamePrefix + "_" + fileTime +
+    (m_format == BINARY ? ".bin" : ".txt");
+  if (m_pWriter->getCompression() > 0) {
+    m_fileName += ".gz";
+  }
+
+  std::cout << "tgAsyncDataLogger will be saving data to the file: "
+	    << std::endl << m_fileName << std::endl;
+
+  // Collect the column names. A record has a fixed width, so the numeric
+  // data must line up with the headings.
+  std::vector<std::string> columns;
+  columns.push_back("time");
+  m_sensorWidths.clear();
+  for (std::size_t i=0; i < m_sensors.size(); i++) {
+    std::vector<std::string> headings = m_sensors[i]->getSensorDataHeadings();
+    if (m_sensors[i]->getSensorDataSize() != headings.size()) {
+      throw std::runtime_error("A sensor's data size does not match its number of headings, in tgAsyncDataLogger.");
+    }
+    m_sensorWidths.push_back(headings.size());
+    for (std::size_t j=0; j < headings.size(); j++) {
+      std::ostringstream column;
+      column << i << "_" << headings[j];
+      columns.push_back(column.str());
+    }
+  }
+
+  std::ostringstream description;
+  description << "tgAsyncDataLogger started logging at time " << fileTime
+	      << ", with " << m_sensors.size() << " sensors on "
+	      << m_senseables.size() << " senseable objects.";
+  std::ostringstream header;
+  if (m_format == BINARY) {
+    tgBinaryDataLogger::writeHeader(header, description.str(), columns);
+    m_pWriter->open(m_fileName, std::ios::out | std::ios::binary);
+  }
+  else {
+    // The same layout as tgDataLogger2.
+    header << description.str() << std::endl;
+    for (std::size_t i=0; i < columns.size(); i++) {
+      header << columns[i] << ",";
+    }
+    header << std::endl;
+    m_pWriter->open(m_fileName, std::ios::out);
+  }
+  m_pWriter->write(header.str());
+
+  delete m_pRing;
+  m_pRing = NULL;
+  m_pRing = new tgSampleRing(columns.size(), m_capacity);
+
+  m_totalTime = 0.0;
+  m_updateTime = 0.0;
+  m_dropped = 0;
+  m_decimation = 1;
+  m_skipped = 0;
+
+  m_stop.store(false);
+  m_thread = boost::thread(boost::bind(&tgAsyncDataLogger::writerLoop, this));
+  
+  // Postcondition
+  assert(invariant());
+}
+
+void tgAsyncDataLogger::teardown()
+{
+  // Call the parent's teardown method! This is important!
+  // The writer thread only reads the ring, never the sensors.
+  tgDataManager::teardown();
+  stopWriter();
+  m_pWriter->close();
+  if (m_dropped > 0) {
+    std::cout << "tgAsyncDataLogger dropped " << m_dropped
+	      << " samples because the writer fell behind." << std::endl;
+  }
+  // Postcondition
+  assert(invariant());
+}
+
+void tgAsyncDataLogger::step(double dt) 
+{
+  if (dt <= 0.0)
+  {
+    throw std::invalid_argument("dt is not positive");
+  }
+  else
+  {
+    m_totalTime += dt;
+    m_updateTime += dt;
+    const bool due = (m_pSamplingPolicy != NULL) ?
+      m_pSamplingPolicy->step(m_totalTime, dt) :
+      (m_updateTime >= m_timeInterval);
+    if (due && m_pRing != NULL) {
+      m_updateTime = 0.0;
+      if (m_overflow == DECIMATE) {
+	// Recover the full rate once the writer has caught up.
+	if (m_decimation > 1 && m_pRing->size() < m_capacity / 4) {
+	  m_decimation /= 2;
+	}
+	if (++m_skipped < m_decimation) {
+	  return;
+	}
+	m_skipped = 0;
+      }
+
+      double* record = m_pRing->beginPush();
+      if (record == NULL && m_overflow == BLOCK) {
+	while ((record = m_pRing->beginPush()) == NULL) {
+	  boost::this_thread::yield();
+	}
+      }
+      if (record != NULL) {
+	sampleSensors(record);
+	m_pRing->commitPush();
+      }
+      else {
+	++m_dropped;
+	if (m_overflow == DECIMATE) {
+	  m_decimation *= 2;
+	}
+      }
+    }
+  }
+
+  // Postcondition
+  assert(invariant());
+}
+
+void tgAsyncDataLogger::sampleSensors(double* record)
+{
+  // With a sampling policy, the policy has already read the sensors,
+  // into the same columns.
+  if (m_pSamplingPolicy != NULL) {
+    const std::vector<double>& sample = m_pSamplingPolicy->getRecord();
+    assert(sample.size() == m_pRing->width());
+    std::copy(sample.begin(), sample.end(), record);
+    return;
+  }
+  assert(m_sensorWidths.size() == m_sensors.size());
+  std::size_t column = 0;
+  record[column++] = m_totalTime;
+  for (std::size_t i=0; i < m_sensors.size(); i++) {
+    // The sensors write their numbers straight into the ring.
+    if (m_sensorWidths[i] > 0) {
+      m_sensors[i]->getSensorDataInto(&record[column]);
+    }
+    column += m_sensorWidths[i];
+  }
+  assert(column == m_pRing->width());
+}
+
+void tgAsyncDataLogger::writeRecord(const double* record)
+{
+  const std::size_t n = m_pRing->width();
+  m_pWriter->markTime(record[0]);
+  if (m_format == BINARY) {
+    m_pWriter->write(reinterpret_cast<const char*>(record),
+		     n * sizeof(double));
+    return;
+  }
+  // As in tgDataLogger2::writeSample.
+  m_row.str("");
+  for (std::size_t i=0; i < n; i++) {
+    m_row << record[i] << ",";
+  }
+  m_row << std::endl;
+  m_pWriter->write(m_row.str());
+}
+
+void tgAsyncDataLogger::writerLoop()
+{
+  while (true) {
+    // Read the flag before draining, so that every sample pushed before
+    // it was set gets written.
+    const bool stopping = m_stop.load(boost::memory_order_acquire);
+    bool wrote = false;
+    const double* record;
+    while ((record = m_pRing->beginPop()) != NULL) {
+      writeRecord(record);
+      m_pRing->commitPop();
+      wrote = true;
+    }
+    if (stopping) {
+      return;
+    }
+    if (!wrote) {
+      // Nothing to do; don't spin on an idle simulation.
+      boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    }
+  }
+}
+
+void tgAsyncDataLogger::stopWriter()
+{
+  if (m_thread.joinable()) {
+    m_stop.store(true, boost::memory_order_release);
+    m_thread.join();
+  }
+}
+
+std::string tgAsyncDataLogger::toString() const
+{
+  std::ostringstream os;
+  os << tgDataManager::toString()
+     << "This tgDataManager is a tgAsyncDataLogger. " << std::endl;
+
+  return os.str();
+}
+
+void tgAsyncDataLogger::reportMemory(tgMemoryReport& report) const
+{
+  tgDataManager::reportMemory(report);
+  std::size_t bytes = 0;
+  if (m_pRing != NULL) {
+    bytes += m_pRing->width() * (m_pRing->capacity() + 1) * sizeof(double);
+  }
+  if (m_pWriter != NULL) {
+    bytes += m_pWriter->bytes();
+  }
+  bytes += tgMemoryReport::bytes(m_sensorWidths);
+  report.add(tgMemoryReport::eLoggers, bytes);
+}
@@ -0,0 +1,272 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_ASYNC_DATA_LOGGER_H
+#define TG_ASYNC_DATA_LOGGER_H
+
+/**
+ * @file tgAsyncDataLogger.h
+ * @brief Contains the definition of concrete class tgAsyncDataLogger.
+ * $Id$
+ */
+
+// Includes from NTRTsim
+#include "tgDataManager.h"
+// Includes from Boost:
+#include <boost/atomic.hpp>
+#include <boost/thread/thread.hpp>
+// Includes from the C++ standard library
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class tgBufferedFileWriter;
+class tgSampleRing;
+
+/**
+ * tgAsyncDataLogger is a tgDataManager that never makes the simulation
+ * wait on formatting or on the file system. At each sample, step() copies
+ * the time and the sensors' raw numbers into a tgSampleRing; a writer
+ * thread takes them out, formats them and writes them to the log. The
+ * output is the same as either tgDataLogger2 (CSV) or tgBinaryDataLogger.
+ *
+ * If the writer falls behind and the ring fills up, the Overflow policy
+ * decides what step() does with the next sample.
+ */
+class tgAsyncDataLogger : public tgDataManager
+{
+ public:
+
+  /**
+   * The file format of the log.
+   */
+  enum Format
+  {
+    /** Comma-separated text, as written by tgDataLogger2 */
+    CSV,
+    /** Packed doubles, as written by tgBinaryDataLogger */
+    BINARY
+  };
+
+  /**
+   * What step() does when the ring is full.
+   */
+  enum Overflow
+  {
+    /** Drop the sample, and count it in getDropped() */
+    DROP,
+    /** Wait for the writer thread to make room */
+    BLOCK,
+    /**
+     * Drop the sample and halve the sampling rate. The rate is doubled
+     * again whenever the ring drains below a quarter of its capacity,
+     * up to the rate set by timeInterval.
+     */
+    DECIMATE
+  };
+
+  /**
+   * @param[in] fileNamePrefix the path to the log file to write. The
+   * current time and ".txt" or ".bin" are appended to this prefix; a
+   * leading "~" is expanded to $HOME.
+   * @param[in] timeInterval the time between sensor readings. Zero means
+   * sensors are read at each call of step().
+   * @param[in] format the file format.
+   * @param[in] capacity the number of samples the ring holds. Must be
+   * positive.
+   * @param[in] overflow what to do with a sample when the ring is full.
+   */
+  tgAsyncDataLogger(std::string fileNamePrefix, double timeInterval = 0.0,
+		    Format format = CSV, std::size_t capacity = 4096,
+		    Overflow overflow = DROP);
+
+  /**
+   * Stops the writer thread and closes the log file, if they're still
+   * running.
+   */
+  ~tgAsyncDataLogger();
+
+  /**
+   * Compress the log: the file name gets ".gz" appended, and an index of
+   * time chunks is written next to it, see tgBufferedFileWriter.
+   * Takes effect at the next call to setup(). The compression happens on
+   * the writer thread.
+   * @param[in] level the zlib compression level, 1 to 9; zero turns
+   * compression off.
+   */
+  void setCompression(int level);
+
+  /**
+   * Create the sensors, open a new log file, write the header and start
+   * the writer thread.
+   */
+  virtual void setup();
+
+  /**
+   * Wait for the writer thread to write out every queued sample, then
+   * close the log file.
+   */
+  virtual void teardown();
+
+  /**
+   * Queue one sample, if timeInterval has elapsed since the last one.
+   * @param[in] dt the amount of time since the last step.
+   */
+  virtual void step(double dt);
+
+  /**
+   * Overwrite toString for the superclass to specify that this data manager
+   * is a tgAsyncDataLogger.
+   */
+  virtual std::string toString() const;
+
+  /**
+   * Add the sensors, and the ring and the writer's buffers.
+   * @see tgDataManager::reportMemory
+   */
+  virtual void reportMemory(tgMemoryReport& report) const;
+
+  /**
+   * @return the name of the current log file.
+   */
+  const std::string& getFileName() const { return m_fileName; }
+
+  /**
+   * @return the number of samples dropped since setup because the ring
+   * was full. Always zero with BLOCK.
+   */
+  std::size_t getDropped() const { return m_dropped; }
+
+ protected:
+
+  /**
+   * Fill a record with the time and the data of every sensor.
+   * Called on the simulation thread.
+   * @param[out] record room for one record of the ring's width.
+   */
+  virtual void sampleSensors(double* record);
+
+  /**
+   * Format and write one record. Called on the writer thread.
+   * @param[in] record one record of the ring's width.
+   */
+  virtual void writeRecord(const double* record);
+
+  /**
+   * The full name of the current log file, created in setup.
+   */
+  std::string m_fileName;
+
+  /**
+   * The prefix passed to the constructor, after "~" expansion.
+   */
+  std::string m_fileNamePrefix;
+
+  /**
+   * The file format.
+   */
+  const Format m_format;
+
+  /**
+   * The number of samples the ring holds.
+   */
+  const std::size_t m_capacity;
+
+  /**
+   * What to do with a sample when the ring is full.
+   */
+  const Overflow m_overflow;
+
+  /**
+   * The number of values each sensor contributes to a record, checked
+   * against its headings at setup.
+   */
+  std::vector<std::size_t> m_sensorWidths;
+
+  /**
+   * The queue between step() and the writer thread, created in setup.
+   */
+  tgSampleRing* m_pRing;
+
+  /**
+   * The log file. Only the writer thread touches it while it runs.
+   */
+  tgBufferedFileWriter* m_pWriter;
+
+  /**
+   * Scratch space for formatting CSV rows, used by the writer thread.
+   */
+  std::ostringstream m_row;
+
+  /**
+   * Set by teardown() to end the writer loop once the ring is empty.
+   */
+  boost::atomic<bool> m_stop;
+
+  /**
+   * The writer thread, between setup and teardown.
+   */
+  boost::thread m_thread;
+
+  /**
+   * The total time since setup.
+   */
+  double m_totalTime;
+
+  /**
+   * The time interval between sensor readings. Unused while a sampling
+   * policy is set.
+   */
+  double m_timeInterval;
+
+  /**
+   * The time since the last sensor reading.
+   */
+  double m_updateTime;
+
+  /**
+   * Samples dropped since setup.
+   */
+  std::size_t m_dropped;
+
+  /**
+   * With DECIMATE, only every m_decimation'th sample is queued.
+   */
+  std::size_t m_decimation;
+
+  /**
+   * Samples skipped since the last queued one, with DECIMATE.
+   */
+  std::size_t m_skipped;
+
+ private:
+
+  /**
+   * The loop run by the writer thread.
+   */
+  void writerLoop();
+
+  /**
+   * Stop the writer thread, if it's running, after it empties the ring.
+   */
+  void stopWriter();
+};
+
+#endif // TG_ASYNC_DATA_LOGGER_H
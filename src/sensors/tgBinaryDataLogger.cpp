@@ -0,0 +1,249 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgBinaryDataLogger.cpp
+ * @brief Contains the implementation of concrete class tgBinaryDataLogger
+ * $Id$
+ */
+
+// This module
+#include "tgBinaryDataLogger.h"
+// This application
+#include "tgSensor.h"
+#include "core/tgMemoryReport.h"
+#include "tgBufferedFileWriter.h"
+#include "tgSamplingPolicy.h"
+// The C++ Standard Library
+#include <stdexcept>
+#include <cassert>
+#include <sstream>
+#include <algorithm>
+#include <time.h> // for the file name of the log file
+#include <cstdlib> // for getenv
+
+namespace
+{
+  /**
+   * The byte order of this machine, as written in the header.
+   */
+  const char* byteOrder()
+  {
+    const unsigned int one = 1;
+    return (*reinterpret_cast<const unsigned char*>(&one) == 1) ?
+      "little" : "big";
+  }
+}
+
+tgBinaryDataLogger::tgBinaryDataLogger(std::string fileNamePrefix,
+				       double timeInterval,
+				       std::size_t bufferSize,
+				       bool backgroundWriter) :
+  tgDataManager(),
+  m_fileNamePrefix(fileNamePrefix),
+  m_pWriter(new tgBufferedFileWriter(bufferSize, backgroundWriter)),
+  m_totalTime(0.0),
+  m_timeInterval(timeInterval),
+  m_updateTime(0.0)
+{
+  // Same checks as tgDataLogger2.
+  if (m_fileNamePrefix == "") {
+    delete m_pWriter;
+    throw std::invalid_argument("File name cannot be the empty string. Please pass in a path to a file that can be opened.");
+  }
+  if (m_timeInterval < 0.0 ) {
+    delete m_pWriter;
+    throw std::invalid_argument("Time interval must be nonnegative. Negative time intervals do not make sense.");
+  }
+  // Expand "~" to the home directory.
+  if (m_fileNamePrefix.at(0) == '~') {
+    std::string home = std::getenv("HOME");
+    m_fileNamePrefix.erase(0,1);
+    m_fileNamePrefix = home + m_fileNamePrefix;
+  }
+  
+  // Postcondition  
+  assert(invariant());
+}
+
+tgBinaryDataLogger::~tgBinaryDataLogger()
+{
+  // The writer's destructor writes out anything buffered and closes the file.
+  delete m_pWriter;
+}
+
+void tgBinaryDataLogger::setCompression(int level)
+{
+  m_pWriter->setCompression(level);
+}
+
+/**
+ * As in tgDataLogger2: create the sensors, name the file after the current
+ * time, then write the header. Unlike tgDataLogger2, the file then stays
+ * open until teardown.
+ */
+void tgBinaryDataLogger::setup()
+{
+  // Call the parent's setup method, which creates the sensors.
+  tgDataManager::setup();
+
+  time_t rawtime;
+  tm* currentTime;
+  const int fileTimeSize = 64;
+  char fileTime [fileTimeSize];
+  time (&rawtime);
+  currentTime = localtime(&rawtime);
+  strftime(fileTime, fileTimeSize, "%m%d%Y_%H%M%S", currentTime);
+  m_fileName = m_fileNamePrefix + "_" + fileTime + ".bin";
+  if (m_pWriter->getCompression() > 0) {
+    m_fileName += ".gz";
+  }
+
+  std::cout << "tgBinaryDataLogger will be saving data to the file: "
+	    << std::endl << m_fileName << std::endl;
+
+  // Collect the column names, and remember how wide each sensor is so
+  // that step can check the data against them.
+  std::vector<std::string> columns;
+  columns.push_back("time");
+  m_sensorWidths.clear();
+  for (std::size_t i=0; i < m_sensors.size(); i++) {
+    std::vector<std::string> headings = m_sensors[i]->getSensorDataHeadings();
+    // A record has a fixed width, so the numeric data must line up with
+    // the headings.
+    if (m_sensors[i]->getSensorDataSize() != headings.size()) {
+      throw std::runtime_error("A sensor's data size does not match its number of headings, in tgBinaryDataLogger.");
+    }
+    m_sensorWidths.push_back(headings.size());
+    for (std::size_t j=0; j < headings.size(); j++) {
+      std::ostringstream column;
+      column << i << "_" << headings[j];
+      columns.push_back(column.str());
+    }
+  }
+  m_record.assign(columns.size(), 0.0);
+
+  // The header is text, so that it can be inspected with head.
+  std::ostringstream description;
+  description << "tgBinaryDataLogger started logging at time " << fileTime
+	      << ", with " << m_sensors.size() << " sensors on "
+	      << m_senseables.size() << " senseable objects.";
+  std::ostringstream header;
+  writeHeader(header, description.str(), columns);
+
+  // Opening truncates any file left over from a previous run.
+  m_pWriter->open(m_fileName, std::ios::out | std::ios::binary);
+  m_pWriter->write(header.str());
+
+  m_totalTime = 0.0;
+  m_updateTime = 0.0;
+  
+  // Postcondition
+  assert(invariant());
+}
+
+void tgBinaryDataLogger::teardown()
+{
+  // Call the parent's teardown method! This is important!
+  tgDataManager::teardown();
+  m_pWriter->close();
+  // Postcondition
+  assert(invariant());
+}
+
+void tgBinaryDataLogger::step(double dt) 
+{
+  if (dt <= 0.0)
+  {
+    throw std::invalid_argument("dt is not positive");
+  }
+  else
+  {
+    m_totalTime += dt;
+    m_updateTime += dt;
+    const bool due = (m_pSamplingPolicy != NULL) ?
+      m_pSamplingPolicy->step(m_totalTime, dt) :
+      (m_updateTime >= m_timeInterval);
+    if (due) {
+      sampleSensors();
+      m_pWriter->markTime(m_record[0]);
+      m_pWriter->write(reinterpret_cast<const char*>(&m_record[0]),
+		       m_record.size() * sizeof(double));
+      m_updateTime = 0.0;
+    }
+  }
+
+  // Postcondition
+  assert(invariant());
+}
+
+void tgBinaryDataLogger::sampleSensors()
+{
+  // With a sampling policy, the policy has already read the sensors,
+  // into the same columns.
+  if (m_pSamplingPolicy != NULL) {
+    const std::vector<double>& record = m_pSamplingPolicy->getRecord();
+    assert(record.size() == m_record.size());
+    std::copy(record.begin(), record.end(), m_record.begin());
+    return;
+  }
+  assert(m_sensorWidths.size() == m_sensors.size());
+  std::size_t column = 0;
+  m_record[column++] = m_totalTime;
+  for (std::size_t i=0; i < m_sensors.size(); i++) {
+    // The sensors write their numbers straight into the record.
+    if (m_sensorWidths[i] > 0) {
+      m_sensors[i]->getSensorDataInto(&m_record[column]);
+    }
+    column += m_sensorWidths[i];
+  }
+  assert(column == m_record.size());
+}
+
+void tgBinaryDataLogger::writeHeader(std::ostream& out,
+				     const std::string& description,
+				     const std::vector<std::string>& columns)
+{
+  out << "NTRT_BINARY_LOG 1" << std::endl
+      << description << std::endl
+      << byteOrder() << std::endl
+      << columns.size() << std::endl;
+  for (std::size_t i=0; i < columns.size(); i++) {
+    out << columns[i] << std::endl;
+  }
+}
+
+std::string tgBinaryDataLogger::toString() const
+{
+  std::ostringstream os;
+  os << tgDataManager::toString()
+     << "This tgDataManager is a tgBinaryDataLogger. " << std::endl;
+
+  return os.str();
+}
+
+void tgBinaryDataLogger::reportMemory(tgMemoryReport& report) const
+{
+  tgDataManager::reportMemory(report);
+  std::size_t bytes = tgMemoryReport::bytes(m_record) +
+    tgMemoryReport::bytes(m_sensorWidths);
+  if (m_pWriter != NULL) {
+    bytes += m_pWriter->bytes();
+  }
+  report.add(tgMemoryReport::eLoggers, bytes);
+}
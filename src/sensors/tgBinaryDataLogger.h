@@ -0,0 +1,182 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_BINARY_DATA_LOGGER_H
+#define TG_BINARY_DATA_LOGGER_H
+
+/**
+ * @file tgBinaryDataLogger.h
+ * @brief Contains the definition of class tgBinaryDataLogger.
+ * $Id$
+ */
+
+// Includes from NTRTsim
+#include "tgDataManager.h"
+// Includes from the C++ standard library
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class tgBufferedFileWriter;
+
+/**
+ * tgBinaryDataLogger is a tgDataManager that records the same data as
+ * tgDataLogger2, but as packed binary records instead of CSV text.
+ * Formatting every value as text is slow, and makes the files about three
+ * times larger than the raw doubles.
+ *
+ * The file starts with a text header, one item per line:
+ *   NTRT_BINARY_LOG 1
+ *   a free-form description (start time, number of sensors...)
+ *   the byte order of the records, "little" or "big"
+ *   the number of columns, N
+ *   N column names: "time", then the sensor headings, each prefixed with
+ *   the sensor number as in tgDataLogger2.
+ * The rest of the file is a sequence of records, each being N 64-bit IEEE
+ * doubles in the stated byte order. bin/python_scripts/src/utilities/
+ * binary_log_reader.py reads these files and can convert them to CSV.
+ */
+class tgBinaryDataLogger : public tgDataManager
+{
+ public:
+
+  /**
+   * @param[in] fileNamePrefix the path to the log file to write. The
+   * current time and ".bin" are appended to this prefix; a leading "~" is
+   * expanded to $HOME.
+   * @param[in] timeInterval the time between sensor readings. Zero means
+   * sensors are read at each call of step().
+   * @param[in] bufferSize the number of bytes to collect before writing.
+   * @param[in] backgroundWriter if true, a separate thread writes the
+   * records to disk.
+   */
+  tgBinaryDataLogger(std::string fileNamePrefix, double timeInterval = 0.0,
+		     std::size_t bufferSize = 1 << 20,
+		     bool backgroundWriter = false);
+
+  /**
+   * Closes the log file, if it's still open.
+   */
+  ~tgBinaryDataLogger();
+
+  /**
+   * Compress the log: the file name gets ".gz" appended, and an index of
+   * time chunks is written next to it, see tgBufferedFileWriter.
+   * Takes effect at the next call to setup(). With a background writer,
+   * the compression happens on that thread.
+   * @param[in] level the zlib compression level, 1 to 9; zero turns
+   * compression off.
+   */
+  void setCompression(int level);
+
+  /**
+   * Create the sensors, open a new log file, and write the header.
+   */
+  virtual void setup();
+
+  /**
+   * Write out anything buffered, and close the log file.
+   */
+  virtual void teardown();
+
+  /**
+   * Append one record, if timeInterval has elapsed since the last one.
+   * @param[in] dt the amount of time since the last step.
+   */
+  virtual void step(double dt);
+
+  /**
+   * Overwrite toString for the superclass to specify that this data manager
+   * is a tgBinaryDataLogger.
+   */
+  virtual std::string toString() const;
+
+  /**
+   * Add the sensors, and the record and the writer's buffers.
+   * @see tgDataManager::reportMemory
+   */
+  virtual void reportMemory(tgMemoryReport& report) const;
+
+  /**
+   * @return the name of the current log file.
+   */
+  const std::string& getFileName() const { return m_fileName; }
+
+  /**
+   * Write the text header described above, for any writer of this format.
+   * @param[in,out] out the stream to write to.
+   * @param[in] description the free-form second line, without a newline.
+   * @param[in] columns the column names, starting with "time".
+   */
+  static void writeHeader(std::ostream& out, const std::string& description,
+			  const std::vector<std::string>& columns);
+
+ protected:
+
+  /**
+   * Fill m_record with the time and the data of every sensor, using the
+   * sensors' numeric path (tgSensor::getSensorDataInto).
+   */
+  virtual void sampleSensors();
+
+  /**
+   * The full name of the current log file, created in setup.
+   */
+  std::string m_fileName;
+
+  /**
+   * The prefix passed to the constructor, after "~" expansion.
+   */
+  std::string m_fileNamePrefix;
+
+  /**
+   * The writer that holds the log file open between setup and teardown.
+   */
+  tgBufferedFileWriter* m_pWriter;
+
+  /**
+   * The number of values each sensor contributes to a record, checked
+   * against its headings at setup.
+   */
+  std::vector<std::size_t> m_sensorWidths;
+
+  /**
+   * One record. Kept as a member so that logging doesn't allocate.
+   */
+  std::vector<double> m_record;
+
+  /**
+   * The total time since setup.
+   */
+  double m_totalTime;
+
+  /**
+   * The time interval between sensor readings. Unused while a sampling
+   * policy is set.
+   */
+  double m_timeInterval;
+
+  /**
+   * The time since the last sensor reading.
+   */
+  double m_updateTime;
+};
+
+#endif // TG_BINARY_DATA_LOGGER_H
@@ -0,0 +1,334 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgBufferedFileWriter.cpp
+ * @brief Contains the implementation of class tgBufferedFileWriter.
+ * $Id$
+ */
+
+// This module
+#include "tgBufferedFileWriter.h"
+// Includes from Boost:
+#include <boost/bind.hpp>
+// Includes from zlib:
+#include <zlib.h>
+// The C++ Standard Library
+#include <stdexcept>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <set>
+#include <sstream>
+// POSIX
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+  /** The names reserved by openUnique() in this process */
+  std::set<std::string>& uniqueNames()
+  {
+    static std::set<std::string> names;
+    return names;
+  }
+
+  boost::mutex& uniqueNamesMutex()
+  {
+    static boost::mutex mutex;
+    return mutex;
+  }
+
+  /** @return true if the name was free, and is now reserved */
+  bool reserveName(const std::string& name)
+  {
+    boost::mutex::scoped_lock lock(uniqueNamesMutex());
+    return uniqueNames().insert(name).second;
+  }
+
+  void releaseName(const std::string& name)
+  {
+    boost::mutex::scoped_lock lock(uniqueNamesMutex());
+    uniqueNames().erase(name);
+  }
+}
+
+tgBufferedFileWriter::tgBufferedFileWriter(std::size_t bufferSize,
+					   bool backgroundThread) :
+  m_bufferSize(bufferSize),
+  m_useThread(backgroundThread),
+  m_isOpen(false),
+  m_hasPending(false),
+  m_compression(0),
+  m_pStream(NULL),
+  m_fileOffset(0),
+  m_stop(false)
+{
+  if (m_bufferSize == 0) {
+    throw std::invalid_argument("Buffer size must be positive in tgBufferedFileWriter.");
+  }
+}
+
+tgBufferedFileWriter::~tgBufferedFileWriter()
+{
+  // Destructors must not throw, and a failed write at this point has
+  // nobody to report to.
+  try {
+    close();
+  }
+  catch (...) {
+  }
+}
+
+void tgBufferedFileWriter::setCompression(int level)
+{
+  if (level < 0 || level > 9) {
+    throw std::invalid_argument("Compression level must be from 0 to 9 in tgBufferedFileWriter.");
+  }
+  m_compression = level;
+}
+
+void tgBufferedFileWriter::markTime(double time)
+{
+  if (!m_bufferTimes.valid) {
+    m_bufferTimes.first = time;
+    m_bufferTimes.valid = true;
+  }
+  m_bufferTimes.last = time;
+}
+
+void tgBufferedFileWriter::open(const std::string& fileName,
+				std::ios_base::openmode mode)
+{
+  // Re-opening closes the old file first.
+  close();
+
+  if (m_compression > 0) {
+    // Gzip members can't be appended to as text, and are binary.
+    mode = (mode & ~std::ios_base::app) | std::ios_base::binary;
+  }
+  m_file.open(fileName.c_str(), mode);
+  if (!m_file.is_open()) {
+    throw std::runtime_error("tgBufferedFileWriter could not open " + fileName);
+  }
+
+  if (m_compression > 0) {
+    const std::string indexName = fileName + ".idx";
+    m_index.open(indexName.c_str());
+    if (!m_index.is_open()) {
+      m_file.close();
+      throw std::runtime_error("tgBufferedFileWriter could not open " + indexName);
+    }
+    m_index.precision(std::numeric_limits<double>::digits10);
+    m_index << "NTRT_CHUNK_INDEX 1" << std::endl;
+
+    m_pStream = new z_stream();
+    // 16 + 15 window bits: a gzip wrapper around each chunk.
+    if (deflateInit2(m_pStream, m_compression, Z_DEFLATED, 16 + 15, 8,
+		     Z_DEFAULT_STRATEGY) != Z_OK) {
+      delete m_pStream;
+      m_pStream = NULL;
+      m_index.close();
+      m_file.close();
+      throw std::runtime_error("tgBufferedFileWriter could not start zlib.");
+    }
+    // write() flushes at the first append past the buffer size, so a
+    // chunk can be up to twice as large; compressed() grows if a single
+    // write is even larger.
+    m_compressed.resize(deflateBound(m_pStream, 2 * m_bufferSize));
+  }
+  m_fileOffset = 0;
+  m_bufferTimes = ChunkTimes();
+  m_isOpen = true;
+
+  // Allocate both buffers up front, so that steady-state logging never
+  // allocates: flush() swaps them instead of copying.
+  m_buffer.reserve(m_bufferSize);
+  if (m_useThread) {
+    m_pending.reserve(m_bufferSize);
+    m_stop = false;
+    m_hasPending = false;
+    m_thread = boost::thread(boost::bind(&tgBufferedFileWriter::writerLoop,
+					 this));
+  }
+}
+
+std::string tgBufferedFileWriter::openUnique(const std::string& prefix,
+					     const std::string& suffix,
+					     std::ios_base::openmode mode)
+{
+  close();
+
+  const bool exclusive = (mode & std::ios_base::app) == 0;
+  for (unsigned int n = 0; ; ++n) {
+    std::ostringstream name;
+    name << prefix;
+    if (n > 0) {
+      name << "_" << n;
+    }
+    name << suffix;
+    const std::string fileName = name.str();
+    if (!reserveName(fileName)) {
+      continue;
+    }
+    if (exclusive) {
+      // Create the file only if it doesn't exist, atomically
+      const int fd = ::open(fileName.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+      if (fd < 0) {
+	const int error = errno;
+	releaseName(fileName);
+	if (error == EEXIST) {
+	  continue;
+	}
+	throw std::runtime_error("tgBufferedFileWriter could not open " +
+				 fileName + ": " + std::strerror(error));
+      }
+      ::close(fd);
+    }
+    try {
+      open(fileName, mode);
+    }
+    catch (...) {
+      releaseName(fileName);
+      throw;
+    }
+    m_uniqueName = fileName;
+    return fileName;
+  }
+}
+
+void tgBufferedFileWriter::write(const char* data, std::size_t size)
+{
+  assert(m_isOpen);
+  m_buffer.append(data, size);
+  if (m_buffer.size() >= m_bufferSize) {
+    flush();
+  }
+}
+
+void tgBufferedFileWriter::flush()
+{
+  if (!m_isOpen || m_buffer.empty()) {
+    return;
+  }
+  if (!m_useThread) {
+    writeOut(m_buffer, m_bufferTimes);
+    m_bufferTimes = ChunkTimes();
+    return;
+  }
+
+  boost::mutex::scoped_lock lock(m_mutex);
+  // Only blocks if the thread is still writing the previous buffer.
+  while (m_hasPending) {
+    m_pendingDone.wait(lock);
+  }
+  m_pending.swap(m_buffer);
+  m_pendingTimes = m_bufferTimes;
+  m_bufferTimes = ChunkTimes();
+  m_hasPending = true;
+  m_pendingReady.notify_one();
+}
+
+void tgBufferedFileWriter::close()
+{
+  if (!m_isOpen) {
+    return;
+  }
+  flush();
+  if (m_useThread) {
+    {
+      boost::mutex::scoped_lock lock(m_mutex);
+      m_stop = true;
+    }
+    m_pendingReady.notify_one();
+    m_thread.join();
+  }
+  m_file.close();
+  if (m_pStream != NULL) {
+    deflateEnd(m_pStream);
+    delete m_pStream;
+    m_pStream = NULL;
+    m_index.close();
+  }
+  m_isOpen = false;
+  if (!m_uniqueName.empty()) {
+    releaseName(m_uniqueName);
+    m_uniqueName.clear();
+  }
+}
+
+void tgBufferedFileWriter::writerLoop()
+{
+  boost::mutex::scoped_lock lock(m_mutex);
+  while (true) {
+    while (!m_hasPending && !m_stop) {
+      m_pendingReady.wait(lock);
+    }
+    if (!m_hasPending) {
+      // Stopped, and nothing left to write.
+      return;
+    }
+    // The caller doesn't touch m_pending while m_hasPending is set,
+    // so the disk write can happen outside the lock.
+    lock.unlock();
+    writeOut(m_pending, m_pendingTimes);
+    lock.lock();
+    m_hasPending = false;
+    m_pendingDone.notify_one();
+  }
+}
+
+void tgBufferedFileWriter::writeOut(std::string& buffer,
+				    const ChunkTimes& times)
+{
+  if (m_pStream == NULL) {
+    m_file.write(buffer.data(), buffer.size());
+    // clear() keeps the capacity, so the buffer is reused.
+    buffer.clear();
+    return;
+  }
+
+  // One whole gzip member per chunk.
+  const uLong bound = deflateBound(m_pStream, buffer.size());
+  if (m_compressed.size() < bound) {
+    m_compressed.resize(bound);
+  }
+  m_pStream->next_in =
+    reinterpret_cast<Bytef*>(const_cast<char*>(buffer.data()));
+  m_pStream->avail_in = buffer.size();
+  m_pStream->next_out = reinterpret_cast<Bytef*>(&m_compressed[0]);
+  m_pStream->avail_out = m_compressed.size();
+  const int result = deflate(m_pStream, Z_FINISH);
+  // deflateBound guarantees that one call finishes the member.
+  assert(result == Z_STREAM_END);
+  (void) result;
+  const std::size_t size = m_compressed.size() - m_pStream->avail_out;
+  deflateReset(m_pStream);
+
+  m_file.write(&m_compressed[0], size);
+  m_index << m_fileOffset << " " << size << " ";
+  if (times.valid) {
+    m_index << times.first << " " << times.last << std::endl;
+  }
+  else {
+    m_index << "nan nan" << std::endl;
+  }
+  m_fileOffset += size;
+  buffer.clear();
+}
@@ -0,0 +1,298 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_BUFFERED_FILE_WRITER_H
+#define TG_BUFFERED_FILE_WRITER_H
+
+/**
+ * @file tgBufferedFileWriter.h
+ * @brief Contains the definition of class tgBufferedFileWriter.
+ * $Id$
+ */
+
+// Includes from Boost:
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+// Includes from the C++ standard library:
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Forward declarations
+struct z_stream_s;
+
+/**
+ * tgBufferedFileWriter keeps one file open and collects writes in memory,
+ * so that data managers don't pay an open/write/close cycle per sample.
+ * When the buffer fills up (or flush() is called), its contents are
+ * written out, either directly or by a background writer thread.
+ * With the writer thread, the buffer is double-buffered: the caller keeps
+ * filling one buffer while the thread writes the other, and the caller
+ * only blocks if the disk falls a whole buffer behind.
+ * None of the methods are safe to call from more than one thread at once;
+ * the writer thread is entirely internal.
+ *
+ * With compression on (see setCompression), each buffer is written as an
+ * independent gzip member, compressed on the writer thread if there is
+ * one. The members concatenate to an ordinary gzip file, so zcat and
+ * gzip -d read it whole. A text index next to it, the file name plus
+ * ".idx", lists one chunk per line:
+ *   byte offset, compressed size, first time, last time
+ * where the times are the ones passed to markTime() for the data in that
+ * chunk ("nan" if none was). A reader can seek to a chunk and inflate it
+ * alone; bin/python_scripts/src/utilities/chunked_log_reader.py does so.
+ */
+class tgBufferedFileWriter
+{
+ public:
+
+  /**
+   * Create a closed writer.
+   * @param[in] bufferSize the number of bytes to collect before writing.
+   * Must be positive.
+   * @param[in] backgroundThread if true, open() starts a thread that does
+   * all of the file output, so that write() and flush() don't wait on the
+   * disk.
+   */
+  tgBufferedFileWriter(std::size_t bufferSize = 1 << 20,
+		       bool backgroundThread = false);
+
+  /**
+   * Closes the file, if it's still open.
+   */
+  ~tgBufferedFileWriter();
+
+  /**
+   * Compress the output, see the class description.
+   * Takes effect at the next open().
+   * @param[in] level the zlib compression level, 1 (fastest) to 9
+   * (smallest). Zero turns compression off.
+   */
+  void setCompression(int level);
+
+  /**
+   * @return the compression level, zero if off.
+   */
+  int getCompression() const { return m_compression; }
+
+  /**
+   * Note the time of the data about to be written, for the chunk index.
+   * Call it before each write() of a sample; a sample never spans two
+   * chunks.
+   * @param[in] time the simulation time of the next write.
+   */
+  void markTime(double time);
+
+  /**
+   * Open a file and, if requested, start the writer thread.
+   * @param[in] fileName the path to the file.
+   * @param[in] mode the mode to open the file in, as for std::ofstream.
+   * @throw std::runtime_error if the file could not be opened.
+   */
+  void open(const std::string& fileName,
+	    std::ios_base::openmode mode = std::ios_base::out);
+
+  /**
+   * Open a file whose name no other writer of this process has open, so
+   * that simulations sharing a logs directory and prefix don't write into
+   * one file: prefix + suffix, else prefix + "_1" + suffix, and so on.
+   * Unless the mode appends, a name is only taken if no file of that name
+   * exists yet, which keeps separate processes apart as well.
+   * @param[in] prefix the path to the file, up to its extension.
+   * @param[in] suffix the extension, such as ".txt".
+   * @param[in] mode the mode to open the file in, as for std::ofstream.
+   * @return the path of the file opened.
+   * @throw std::runtime_error if the file could not be opened.
+   */
+  std::string openUnique(const std::string& prefix, const std::string& suffix,
+			 std::ios_base::openmode mode = std::ios_base::out);
+
+  /**
+   * Append data to the buffer, writing it out if the buffer is full.
+   * @param[in] data the bytes to write.
+   * @param[in] size the number of bytes.
+   */
+  void write(const char* data, std::size_t size);
+
+  /**
+   * Append a string to the buffer.
+   * @param[in] data the string to write.
+   */
+  void write(const std::string& data) { write(data.data(), data.size()); }
+
+  /**
+   * Hand the buffered data to the file (or to the writer thread).
+   * This does not wait for the writer thread to finish.
+   */
+  void flush();
+
+  /**
+   * Write out everything that's buffered, stop the writer thread and
+   * close the file. Safe to call on a closed writer.
+   */
+  void close();
+
+  /**
+   * @return true if open() has been called without a matching close().
+   */
+  bool isOpen() const { return m_isOpen; }
+
+  /**
+   * @return the number of bytes waiting in the caller's buffer.
+   */
+  std::size_t buffered() const { return m_buffer.size(); }
+
+  /**
+   * @return the bytes the writer holds for its buffers, taking the
+   * writer thread's buffer to be as large as the caller's, which it
+   * swaps with.
+   */
+  std::size_t bytes() const
+  {
+    return m_buffer.capacity() * (m_useThread && m_isOpen ? 2 : 1) +
+      m_compressed.capacity();
+  }
+
+ private:
+
+  /**
+   * The loop run by the background writer thread.
+   */
+  void writerLoop();
+
+  /**
+   * The range of times marked for one buffer.
+   */
+  struct ChunkTimes
+  {
+    ChunkTimes() : first(0.0), last(0.0), valid(false) { }
+    double first;
+    double last;
+    bool valid;
+  };
+
+  /**
+   * Write out a buffer on the calling thread, then clear it.
+   * @param[in,out] buffer the data to write.
+   * @param[in] times the times marked for the buffer, for the index.
+   */
+  void writeOut(std::string& buffer, const ChunkTimes& times);
+
+  /**
+   * The number of bytes to collect before writing.
+   */
+  const std::size_t m_bufferSize;
+
+  /**
+   * Whether open() should start a writer thread.
+   */
+  const bool m_useThread;
+
+  /**
+   * Whether the file is currently open.
+   */
+  bool m_isOpen;
+
+  /**
+   * The name openUnique() reserved for this writer until close(), empty
+   * otherwise.
+   */
+  std::string m_uniqueName;
+
+  /**
+   * The output file. Only the writer thread touches it while it runs.
+   */
+  std::ofstream m_file;
+
+  /**
+   * The buffer being filled by the caller.
+   */
+  std::string m_buffer;
+
+  /**
+   * The buffer being written by the writer thread.
+   */
+  std::string m_pending;
+
+  /**
+   * True while m_pending holds data that the thread hasn't written yet.
+   */
+  bool m_hasPending;
+
+  /**
+   * The times marked for m_buffer and for m_pending.
+   */
+  ChunkTimes m_bufferTimes;
+  ChunkTimes m_pendingTimes;
+
+  /**
+   * The zlib compression level, zero if off.
+   */
+  int m_compression;
+
+  /**
+   * The deflate stream while a compressed file is open, reset and reused
+   * for every chunk.
+   */
+  z_stream_s* m_pStream;
+
+  /**
+   * Room for one compressed chunk, sized at open() so that writing
+   * doesn't allocate.
+   */
+  std::vector<char> m_compressed;
+
+  /**
+   * The chunk index of a compressed file.
+   */
+  std::ofstream m_index;
+
+  /**
+   * The number of bytes written to the file so far, for the index.
+   */
+  std::size_t m_fileOffset;
+
+  /**
+   * Set by close() to end the writer loop.
+   */
+  bool m_stop;
+
+  /**
+   * Guards m_hasPending and m_stop.
+   */
+  boost::mutex m_mutex;
+
+  /**
+   * Signalled when m_pending is filled, or on close().
+   */
+  boost::condition_variable m_pendingReady;
+
+  /**
+   * Signalled when the writer thread has emptied m_pending.
+   */
+  boost::condition_variable m_pendingDone;
+
+  /**
+   * The writer thread, if one is running.
+   */
+  boost::thread m_thread;
+};
+
+#endif // TG_BUFFERED_FILE_WRITER_H
@@ -68,7 +68,9 @@ tgCompoundRigidSensor::tgCompoundRigidSensor(tgModel* pModel) : tgSensor(pModel)
  */
 tgCompoundRigidSensor::tgCompoundRigidSensor(tgModel* pModel, std::string tag) :
   tgSensor(pModel),
-  m_tag(tag)
+  m_tag(tag),
+  m_pBody(NULL),
+  m_mass(0.0)
 {
   // Note that this pointer may be 0 (equivalent to NULL) if the cast in
   // the calling function from tgSenseable to tgModel fails.
@@ -83,6 +85,18 @@ tgCompoundRigidSensor::tgCompoundRigidSensor(tgModel* pModel, std::string tag) :
     throw std::runtime_error("tgCompoundRigidSensor found no rigid bodies with its tag - something is wrong (inside constructor.)");
   }
   // TO-DO: better validation.
+  // The parts of an auto-compounded rigid share one body, whose center of
+  // mass and orientation are those of the compound.
+  m_pBody = m_rigids[0]->getPRigidBody();
+  for (std::size_t i = 0; i < m_rigids.size(); i++) {
+    m_mass += m_rigids[i]->mass();
+    if (m_rigids[i]->getPRigidBody() != m_pBody) {
+      m_pBody = NULL;
+    }
+  }
+  if (m_pBody == NULL) {
+    m_poses = tgRigidPoseBatch(m_rigids);
+  }
   
   // Next, get the initial orientation of the rigid body.
   // This will be needed for comparison later.
@@ -117,21 +131,17 @@ tgCompoundRigidSensor::~tgCompoundRigidSensor()
 // return zeroes if m_rigids is empty.
 // NEED TO DO ASAP: this is INCORRECT, we need to average / integrate
 //   over all the volume of the rigids, not just avg their individual COMs.
+//   (tgRigidPoseBatch::centerOfMass weights them by mass, but switching
+//   would change existing logs.)
 btVector3 tgCompoundRigidSensor::getCenterOfMass()
 {
   // This method takes the average of all the centers of mass.
   // It should be sufficient to just add then divide each component
   // of the 3D vector.
-  // The resulting vector:
-  btVector3* pCom = new btVector3(0.0, 0.0, 0.0);
-  // Iterate and add all the centers of mass of the components.
-  for( size_t i=0; i < m_rigids.size(); i++){
-    *pCom += m_rigids[i]->centerOfMass();
+  if (m_pBody != NULL) {
+    return m_pBody->getCenterOfMassPosition();
   }
-  // Average the components:
-  *pCom /= m_rigids.size();
-
-  return *pCom;
+  return m_poses.meanPosition(0, m_poses.size());
 }
 
 btVector3 tgCompoundRigidSensor::getOrientation()
@@ -142,7 +152,8 @@ btVector3 tgCompoundRigidSensor::getOrientation()
   // To get the "difference" between wherever the first rigid body was,
   // and where it is now, multiply Q_curr * inv(Q_0).
   // First, get the orientation of the underlying Bullet rigid body:
-  btQuaternion currentOrientQuat = m_rigids[0]->getPRigidBody()->getOrientation();
+  btQuaternion currentOrientQuat = (m_pBody != NULL) ?
+    m_pBody->getOrientation() : m_poses.orientation(0);
   // The "difference" is then
   btQuaternion diffOrientQuat = currentOrientQuat * origOrientQuatInv;
   // Convert to roll/pitch/yaw just like inside tgBaseRigid::orientation().
@@ -169,12 +180,8 @@ btVector3 tgCompoundRigidSensor::getOrientation()
 
 double tgCompoundRigidSensor::getMass()
 {
-  // Add the mass of all the rigid bodies.
-  double mass = 0;
-  for( size_t i=0; i < m_rigids.size(); i++){
-    mass += m_rigids[i]->mass();
-  }
-  return mass;
+  // The mass of all the rigid bodies, added up in the constructor.
+  return m_mass;
 }
 
 /**
@@ -224,63 +231,45 @@ std::vector<std::string> tgCompoundRigidSensor::getSensorDataHeadings() {
 
 /**
  * The method that collects the actual data from this compound rigid body.
+ * This is now just the formatted version of getSensorDataInto.
  */
 std::vector<std::string> tgCompoundRigidSensor::getSensorData() {
-  // Note that this method uses m_rigids directly, no need to deal
-  // with the parent class' pointer to m_pSens.
-  
-  // The floats (btScalars?) need to be converted to strings
-  // via a stringstream.
-  std::stringstream ss;
+  double sensordata[7];
+  getSensorDataInto(sensordata);
+  return formatSensorData(sensordata, 7);
+}
 
-  // The list of sensor data that will be returned:
-  std::vector<std::string> sensordata;
+/**
+ * A compound always gives its position, orientation, and mass.
+ */
+std::size_t tgCompoundRigidSensor::getSensorDataSize() {
+  return 7;
+}
 
+/**
+ * Collect the data from this compound rigid body as numbers, in the same
+ * order as the headings.
+ * Note that this method uses m_rigids directly, no need to deal
+ * with the parent class' pointer to m_pSens.
+ */
+void tgCompoundRigidSensor::getSensorDataInto(double* out) {
+  // One read of every body's state, shared by the helpers below.
+  if (m_pBody == NULL) {
+    m_poses.update();
+  }
   // Get the position and orientation of this compound body.
   // Call the helper functions
   btVector3 com = getCenterOfMass();
   btVector3 orient = getOrientation();
-  
-  // com[0]
-  ss << com[0];
-  sensordata.push_back( ss.str() );
-  // Reset the stream.
-  ss.str("");
-  
-  // com[1]
-  ss << com[1];
-  sensordata.push_back( ss.str() );
-  ss.str("");
-  // com[2]
-  ss << com[2];
-  sensordata.push_back( ss.str() );
-  ss.str("");
 
-  // yaw
-  ss << orient[0];
-  sensordata.push_back( ss.str() );
-  ss.str("");
-
-  // pitch
-  ss << orient[1];
-  sensordata.push_back( ss.str() );
-  ss.str("");
-
-  // roll
-  ss << orient[2];
-  sensordata.push_back( ss.str() );
-  ss.str("");
-  
-  //sensordata.push_back( "" );
-  //sensordata.push_back( "" );
-  //sensordata.push_back( "" );
-
-  // mass
-  ss << getMass();
-  sensordata.push_back( ss.str() );
-  ss.str("");
-  
-  return sensordata;
+  out[0] = com[0];
+  out[1] = com[1];
+  out[2] = com[2];
+  // yaw, pitch, roll
+  out[3] = orient[0];
+  out[4] = orient[1];
+  out[5] = orient[2];
+  out[6] = getMass();
 }
 
 //end.
@@ -31,6 +31,7 @@
 // Includes from the NTRT core directory:
 #include "core/tgModel.h"
 #include "core/tgBaseRigid.h"
+#include "core/tgRigidPoseBatch.h"
 // Includes from the C++ standard library:
 #include <vector>
 // Includes from Bullet Physics:
@@ -84,6 +85,13 @@ public:
   virtual std::vector<std::string> getSensorDataHeadings();
   virtual std::vector<std::string> getSensorData();
 
+  /**
+   * The numeric versions of the data collection methods. getSensorData
+   * formats the output of getSensorDataInto, so the two always agree.
+   */
+  virtual std::size_t getSensorDataSize();
+  virtual void getSensorDataInto(double* out);
+
  private:
 
   /**
@@ -105,6 +113,23 @@ public:
    */
   std::vector<tgBaseRigid*> m_rigids;
 
+  /**
+   * The poses of m_rigids, read from Bullet in one pass per sample.
+   * Only used if the rigids are not all parts of one body.
+   */
+  tgRigidPoseBatch m_poses;
+
+  /**
+   * The body that the rigids are all parts of, or NULL. Its transform is
+   * already that of the compound, so it is read directly.
+   */
+  const btRigidBody* m_pBody;
+
+  /**
+   * The total mass of m_rigids, found once.
+   */
+  double m_mass;
+
   /**
    * Store the original orientation of the compound rigid,
    * for comparison later to get the current orientation.
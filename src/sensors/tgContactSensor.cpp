@@ -0,0 +1,101 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgContactSensor.cpp
+ * @brief Implementation of the tgContactSensor class.
+ * $Id$
+ */
+
+// This class:
+#include "tgContactSensor.h"
+
+// Includes from the sensors directory:
+#include "tgContactTable.h"
+
+// Includes from NTRT:
+#include "core/tgTags.h"
+
+// Includes from the c++ standard library:
+#include <stdexcept>
+#include <string>
+
+tgContactSensor::tgContactSensor(tgBaseRigid* pRigid,
+				 const boost::shared_ptr<const tgContactTable>& pTable) :
+  tgTypedSensor<tgBaseRigid>(pRigid),
+  m_pTable(pTable)
+{
+  if (pRigid == NULL) {
+    throw std::invalid_argument("Pointer to pRigid is NULL inside tgContactSensor.");
+  }
+  if (!m_pTable) {
+    throw std::invalid_argument("Contact table is NULL inside tgContactSensor.");
+  }
+}
+
+tgContactSensor::~tgContactSensor()
+{
+}
+
+/**
+ * Headings of the form "contact(tags).X", as for the other sensors.
+ */
+std::vector<std::string> tgContactSensor::getSensorDataHeadings() {
+  std::vector<std::string> headings;
+  const tgTags& m_tags = m_pTyped->getTags();
+  std::string prefix = "contact(";
+  headings.push_back( prefix + m_tags + ").Fx" );
+  headings.push_back( prefix + m_tags + ").Fy" );
+  headings.push_back( prefix + m_tags + ").Fz" );
+  headings.push_back( prefix + m_tags + ").normalForce" );
+  headings.push_back( prefix + m_tags + ").points" );
+  return headings;
+}
+
+std::vector<std::string> tgContactSensor::getSensorData() {
+  double sensordata[5];
+  getSensorDataInto(sensordata);
+  return formatSensorData(sensordata, 5);
+}
+
+std::size_t tgContactSensor::getSensorDataSize() {
+  return 5;
+}
+
+/**
+ * One lookup in the table; zeros when nothing touches the body, or the
+ * rigid has no body yet.
+ */
+void tgContactSensor::getSensorDataInto(double* out) {
+  const btRigidBody* const pBody = m_pTyped->getPRigidBody();
+  const tgContactTable::Contact* const pContact =
+    pBody == NULL ? NULL : m_pTable->find(pBody);
+  if (pContact == NULL) {
+    for (int i = 0; i < 5; i++) {
+      out[i] = 0.0;
+    }
+    return;
+  }
+  out[0] = pContact->force.x();
+  out[1] = pContact->force.y();
+  out[2] = pContact->force.z();
+  out[3] = pContact->normalForce;
+  out[4] = pContact->points;
+}
+
+//end.
@@ -0,0 +1,77 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgContactSensor.h
+ * @brief Contains the definition of concrete class tgContactSensor.
+ * $Id$
+ */
+
+#ifndef TG_CONTACT_SENSOR_H
+#define TG_CONTACT_SENSOR_H
+
+// Includes from the sensors directory:
+#include "tgTypedSensor.h"
+// Includes from the NTRT core directory:
+#include "core/tgBaseRigid.h"
+// The Boost library
+#include <boost/shared_ptr.hpp>
+
+// Forward declarations
+class tgContactTable;
+
+/**
+ * This class extends tgTypedSensor to sense what touches a rigid body,
+ * such as whether a foot is on the ground and how hard it pushes. It
+ * looks its body up in a tgContactTable shared by every contact sensor
+ * of a world, see tgContactSensorInfo. Rigids of one compound share a
+ * body, and so report the contacts of the whole compound.
+ */
+class tgContactSensor : public tgTypedSensor<tgBaseRigid>
+{
+public:
+
+  /**
+   * @param[in] pRigid a pointer to the rigid this sensor will attach itself to.
+   * @param[in] pTable the contacts of the rigid's world
+   * @throw std::invalid_argument if either is NULL
+   */
+  tgContactSensor(tgBaseRigid* pRigid,
+		  const boost::shared_ptr<const tgContactTable>& pTable);
+
+  // Classes with virtual member functions must also have virtual destructors.
+  virtual ~tgContactSensor();
+
+  /**
+   * The force on the body, X, Y and Z, the sum of its normal forces and
+   * the number of touching points.
+   */
+  virtual std::vector<std::string> getSensorDataHeadings();
+  virtual std::vector<std::string> getSensorData();
+
+  virtual std::size_t getSensorDataSize();
+  virtual void getSensorDataInto(double* out);
+
+private:
+
+  /** Shared with the other contact sensors of the world */
+  boost::shared_ptr<const tgContactTable> m_pTable;
+
+};
+
+#endif //TG_CONTACT_SENSOR_H
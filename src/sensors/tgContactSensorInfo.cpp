@@ -0,0 +1,74 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgContactSensorInfo.cpp
+ * @brief Contains the implementation of concrete class tgContactSensorInfo
+ * $Id$
+ */
+
+// This module
+#include "tgContactSensorInfo.h"
+// Other includes from NTRTsim
+#include "tgContactSensor.h"
+#include "tgContactTable.h"
+#include "core/tgBaseRigid.h"
+#include "core/tgModel.h"
+#include "core/tgTagSearch.h"
+#include "core/tgCast.h"
+#include "core/tgSenseable.h"
+// Other includes from the C++ standard library
+#include <stdexcept>
+
+tgContactSensorInfo::tgContactSensorInfo(const tgWorld& world) :
+  m_pTable(new tgContactTable(world))
+{
+}
+
+/**
+ * The sensors keep the table for as long as they need it.
+ */
+tgContactSensorInfo::~tgContactSensorInfo()
+{
+}
+
+bool tgContactSensorInfo::isThisMySenseable(tgSenseable* pSenseable)
+{
+  return tgCast::cast<tgSenseable, tgBaseRigid>(pSenseable) != NULL;
+}
+
+std::vector<tgSensor*> tgContactSensorInfo::createSensorsIfAppropriate(tgSenseable* pSenseable)
+{
+  if (!isThisMySenseable(pSenseable)) {
+    throw std::invalid_argument("pSenseable is NOT a tgBaseRigid, inside tgContactSensorInfo.");
+  }
+  std::vector<tgSensor*> newSensors;
+  newSensors.push_back( new tgContactSensor( tgCast::cast<tgSenseable, tgBaseRigid>(pSenseable), m_pTable ));
+  return newSensors;
+}
+
+/**
+ * tgModel::find() keeps the tgBaseRigids of each model, so this is one pass over
+ * them rather than a cast of every descendant.
+ */
+bool tgContactSensorInfo::findSenseables(tgModel& model, std::vector<tgModel*>& matches)
+{
+  const std::vector<tgBaseRigid*> found = model.find<tgBaseRigid>(tgTagSearch());
+  matches.insert(matches.end(), found.begin(), found.end());
+  return true;
+}
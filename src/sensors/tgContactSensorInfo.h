@@ -0,0 +1,88 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_CONTACT_SENSOR_INFO_H
+#define TG_CONTACT_SENSOR_INFO_H
+
+/**
+ * @file tgContactSensorInfo.h
+ * @brief Definition of concrete class tgContactSensorInfo 
+ * $Id$
+ */
+
+// This module
+#include "tgSensorInfo.h"
+// The Boost library
+#include <boost/shared_ptr.hpp>
+
+// Forward references
+class tgContactTable;
+class tgSenseable;
+class tgSensor;
+class tgWorld;
+
+/**
+ * tgContactSensorInfo creates tgContactSensors for the rigids of a
+ * world, such as tgRods, tgBoxes and tgSpheres. Every sensor it creates
+ * shares its tgContactTable, so the manifolds are scanned once per step
+ * however many bodies are sensed.
+ */
+class tgContactSensorInfo : public tgSensorInfo
+{
+ public:
+
+  /**
+   * @param[in] world the world the sensed models are in; must outlive
+   * the sensors
+   */
+  tgContactSensorInfo(const tgWorld& world);
+
+  ~tgContactSensorInfo();
+
+  /**
+   * @param[in] pSenseable a pointer to a tgSenseable object
+   * @return true if pSenseable is a tgBaseRigid
+   */
+  virtual bool isThisMySenseable(tgSenseable* pSenseable);
+
+  /**
+   * @param[in] pSenseable pointer to a senseable object.
+   * @return a list of one tgContactSensor
+   * @throws invalid_argument if pSenseable is not a tgBaseRigid
+   */
+  virtual std::vector<tgSensor*> createSensorsIfAppropriate(tgSenseable* pSenseable);
+
+  /**
+   * From tgSensorInfo, list the tgBaseRigids among a model's descendants.
+   * @return true, since a tgBaseRigid is sensed by type alone
+   */
+  virtual bool findSenseables(tgModel& model, std::vector<tgModel*>& matches);
+
+  /**
+   * @return the table the sensors read, which controllers can also look
+   * their bodies up in
+   */
+  const tgContactTable& getTable() const { return *m_pTable; }
+
+ private:
+
+  boost::shared_ptr<const tgContactTable> m_pTable;
+
+};
+
+#endif // TG_CONTACT_SENSOR_INFO_H
@@ -0,0 +1,130 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgContactTable.cpp
+ * @brief Contains the implementation of class tgContactTable.
+ * $Id$
+ */
+
+// This module
+#include "tgContactTable.h"
+// The NTRT Core Library
+#include "core/tgBulletUtil.h"
+#include "core/tgWorld.h"
+// The Bullet Physics library
+#include "BulletCollision/BroadphaseCollision/btDispatcher.h"
+#include "BulletCollision/CollisionDispatch/btCollisionObject.h"
+#include "BulletCollision/NarrowPhaseCollision/btPersistentManifold.h"
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+// The C++ Standard Library
+#include <cassert>
+
+tgContactTable::Contact::Contact() :
+  force(0.0, 0.0, 0.0),
+  normalForce(0.0),
+  normal(0.0, 0.0, 0.0),
+  points(0)
+{
+}
+
+tgContactTable::tgContactTable(const tgWorld& world) :
+  m_world(world),
+  m_stamp(0),
+  m_built(false)
+{
+}
+
+const tgContactTable::Contact* tgContactTable::find(const btCollisionObject* pBody) const
+{
+  update();
+  const Table::const_iterator it = m_table.find(pBody);
+  return it == m_table.end() ? NULL : &it->second;
+}
+
+std::size_t tgContactTable::size() const
+{
+  update();
+  return m_table.size();
+}
+
+void tgContactTable::update() const
+{
+  const std::size_t stamp = *m_world.getStepStamp();
+  if (m_built && stamp == m_stamp)
+  {
+    return;
+  }
+  m_built = true;
+  m_stamp = stamp;
+  m_table.clear();
+
+  btDynamicsWorld& dynamicsWorld = tgBulletUtil::worldToDynamicsWorld(m_world);
+  const double dt = dynamicsWorld.getSolverInfo().m_timeStep;
+  assert(dt > 0.0);
+  btDispatcher* const pDispatcher = dynamicsWorld.getDispatcher();
+  const int n = pDispatcher->getNumManifolds();
+  for (int i = 0; i < n; i++)
+  {
+    const btPersistentManifold* const pManifold =
+      pDispatcher->getManifoldByIndexInternal(i);
+    const btCollisionObject* const pBody0 = pManifold->getBody0();
+    const btCollisionObject* const pBody1 = pManifold->getBody1();
+    if (!pBody0->hasContactResponse() || !pBody1->hasContactResponse())
+    {
+      continue;
+    }
+    Contact* pContact0 = NULL;
+    Contact* pContact1 = NULL;
+    for (int j = 0; j < pManifold->getNumContacts(); j++)
+    {
+      const btManifoldPoint& point = pManifold->getContactPoint(j);
+      if (point.getDistance() > 0.0)
+      {
+        continue;
+      }
+      if (pContact0 == NULL)
+      {
+        pContact0 = &m_table[pBody0];
+        pContact1 = &m_table[pBody1];
+      }
+      // The normal points from body 1 into body 0
+      const double normalForce = point.m_appliedImpulse / dt;
+      const btVector3 force = point.m_normalWorldOnB * normalForce;
+      // Points that carry no force still give a direction
+      const btVector3 weighted = point.m_normalWorldOnB * (normalForce + 1e-9);
+      pContact0->force += force;
+      pContact0->normalForce += normalForce;
+      pContact0->normal += weighted;
+      pContact0->points++;
+      pContact1->force -= force;
+      pContact1->normalForce += normalForce;
+      pContact1->normal -= weighted;
+      pContact1->points++;
+    }
+  }
+
+  for (Table::iterator it = m_table.begin(); it != m_table.end(); ++it)
+  {
+    btVector3& normal = it->second.normal;
+    if (normal.length2() > 0.0)
+    {
+      normal.normalize();
+    }
+  }
+}
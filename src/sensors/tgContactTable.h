@@ -0,0 +1,108 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_CONTACT_TABLE_H
+#define TG_CONTACT_TABLE_H
+
+/**
+ * @file tgContactTable.h
+ * @brief Contains the definition of class tgContactTable.
+ * $Id$
+ */
+
+// The Bullet Physics library
+#include "LinearMath/btVector3.h"
+// The Boost library
+#include <boost/unordered_map.hpp>
+// The C++ Standard Library
+#include <cstddef>
+
+// Forward declarations
+class btCollisionObject;
+class tgWorld;
+
+/**
+ * The contact forces on every body of a world, found in one pass over
+ * the persistent manifolds of its dispatcher. The pass is made on the
+ * first lookup after the world steps, restores or resets, so any number
+ * of tgContactSensors and controllers can look their bodies up in
+ * constant time instead of each scanning the manifolds.
+ *
+ * Forces are the impulses Bullet's solver applied in the last step,
+ * divided by the step size. Bodies that don't respond to contacts, such
+ * as the ghost objects of contact cables, are left out, and so are the
+ * points on them.
+ */
+class tgContactTable
+{
+public:
+
+  /** What touches one body */
+  struct Contact
+  {
+    Contact();
+
+    /** The total contact force on the body, in world coordinates */
+    btVector3 force;
+
+    /** The sum of the magnitudes of the normal forces */
+    double normalForce;
+
+    /**
+     * The mean contact normal, pointing into the body and weighted by
+     * the normal force of each point
+     */
+    btVector3 normal;
+
+    /** The number of touching points */
+    std::size_t points;
+  };
+
+  /**
+   * @param[in] world the world whose bodies are looked up; must outlive
+   * the table
+   */
+  explicit tgContactTable(const tgWorld& world);
+
+  /**
+   * @param[in] pBody a body of the world
+   * @return what touches it as of the last step, or NULL if nothing does
+   */
+  const Contact* find(const btCollisionObject* pBody) const;
+
+  /** @return the number of bodies touching something */
+  std::size_t size() const;
+
+private:
+
+  /** Rebuild the table if the world changed since the last pass. */
+  void update() const;
+
+  typedef boost::unordered_map<const btCollisionObject*, Contact> Table;
+
+  const tgWorld& m_world;
+
+  /** The world's step stamp when the table was built */
+  mutable std::size_t m_stamp;
+
+  mutable bool m_built;
+
+  mutable Table m_table;
+};
+
+#endif // TG_CONTACT_TABLE_H
@@ -24,6 +24,7 @@
  */
 
 #include "tgDataLogger.h"
+#include "tgBufferedFileWriter.h"
 
 #include "util/tgBaseCPGNode.h"
 #include "core/tgSpringCableActuator.h"
@@ -32,11 +33,10 @@
 
 #include "LinearMath/btVector3.h"
 
-#include <iostream>
-#include <fstream>
+#include <cstdio>
 
-tgDataLogger::tgDataLogger(std::string fileName) :
-m_fileName(fileName)
+tgDataLogger::tgDataLogger(tgBufferedFileWriter& output) :
+m_output(output)
 {}
 
 /** Virtual base classes must have a virtual destructor. */
@@ -44,31 +44,29 @@ tgDataLogger::~tgDataLogger()
 
 { }
 
+void tgDataLogger::write(double value) const
+{
+    // %g is what operator<< writes at the default precision
+    char text[32];
+    const int length = snprintf(text, sizeof(text), "%g,", value);
+    m_output.write(text, length);
+}
+
 void tgDataLogger::render(const tgRod& rod) const
 {
-    std::ofstream tgOutput;
-    tgOutput.open(m_fileName.c_str(), std::ios::app);
-    
     btVector3 com = rod.centerOfMass();
     
-    tgOutput << com[0] << ","
-    << com[1] << ","
-    << com[2] << ","
-    << rod.mass() << ",";
-    
-    tgOutput.close();
+    write(com[0]);
+    write(com[1]);
+    write(com[2]);
+    write(rod.mass());
 }
     
 void tgDataLogger::render(const tgSpringCableActuator& mSCA) const
 {
-    std::ofstream tgOutput;
-    tgOutput.open(m_fileName.c_str(), std::ios::app);
-    
-    tgOutput << mSCA.getRestLength() << ","    
-    << mSCA.getCurrentLength() << ","
-    << mSCA.getTension() << ",";
-    
-    tgOutput.close();
+    write(mSCA.getRestLength());
+    write(mSCA.getCurrentLength());
+    write(mSCA.getTension());
 }
 
 void tgDataLogger::render(const tgModel& model) const
@@ -78,16 +76,10 @@ void tgDataLogger::render(const tgModel& model) const
     const std::size_t n = 0;
     for (std::size_t i = 0; i < n; i++)
     {
-        std::ofstream tgOutput;
-            tgOutput.open(m_fileName.c_str(), std::ios::app);
-            
-            btVector3 worldPos = markers[i].getWorldPosition();
-            
-            tgOutput << worldPos[0] << ","    
-            << worldPos[1]  << ","
-            << worldPos[2]  << ",";
-            
-            tgOutput.close();
-
+        btVector3 worldPos = markers[i].getWorldPosition();
+        
+        write(worldPos[0]);
+        write(worldPos[1]);
+        write(worldPos[2]);
     }
 }
@@ -31,19 +31,26 @@
 #include <string>
 
 // Forward declarations
+class tgBufferedFileWriter;
 class tgSpringCableActuator;
 class tgBasicActuator;
 class tgModel;
 class tgRod;
 
 /**
- * Interface for Data Logger.
+ * Interface for Data Logger. Appends the values of each rod, cable and
+ * marker visited to a writer, comma separated, as tgDataObserver's
+ * header names them.
  */
 class tgDataLogger : public tgModelVisitor {
     
 public:
     
-    tgDataLogger(std::string fileName);
+    /**
+     * @param[in] output where the values are written, which must outlive
+     * this logger
+     */
+    tgDataLogger(tgBufferedFileWriter& output);
     
   /** Virtual base classes must have a virtual destructor. */
   virtual ~tgDataLogger();
@@ -60,8 +67,10 @@ public:
 
 private:
     
-    std::string m_fileName;
+    /** Append a value and a comma, formatted as std::ostream would */
+    void write(double value) const;
     
+    tgBufferedFileWriter& m_output;
 
 };
 
@@ -27,6 +27,9 @@
 #include "tgDataLogger2.h"
 // This application
 #include "tgSensor.h"
+#include "core/tgMemoryReport.h"
+#include "tgBufferedFileWriter.h"
+#include "tgSamplingPolicy.h"
 // The C++ Standard Library
 #include <stdexcept>
 #include <cassert>
@@ -46,7 +49,10 @@
 tgDataLogger2::tgDataLogger2(std::string fileNamePrefix, double timeInterval) :
   tgDataManager(),
   m_fileNamePrefix(fileNamePrefix),
-  m_timeInterval(timeInterval)
+  m_timeInterval(timeInterval),
+  m_pWriter(NULL),
+  m_flushInterval(0.0),
+  m_flushTime(0.0)
 {
   // A quick check on the passed-in string: it must not be the empty
   // string. Must be a correct linux path.
@@ -84,7 +90,8 @@ tgDataLogger2::tgDataLogger2(std::string fileNamePrefix, double timeInterval) :
  * lets the simulator compile, but then complains when it's called.
  * DO NOT USE THIS ONE: use the one with the string passed in!
  */
-tgDataLogger2::tgDataLogger2()
+tgDataLogger2::tgDataLogger2() :
+  m_pWriter(NULL)
 {
   throw std::invalid_argument("Cannot create a tgDataLogger2 without a path to the log file! Please use the constructor that takes a string.");
 }
@@ -97,6 +104,37 @@ tgDataLogger2::tgDataLogger2()
 tgDataLogger2::~tgDataLogger2()
 {
   // TO-DO: should we double-check and close the tgOutput filestream here too?
+  // The writer's destructor closes its file, writing out anything buffered.
+  delete m_pWriter;
+}
+
+/**
+ * Buffered mode replaces the writer (if any) with a new one, which will be
+ * opened during the next setup.
+ */
+void tgDataLogger2::setBuffering(std::size_t bufferSize, double flushInterval,
+				 bool backgroundWriter)
+{
+  if (flushInterval < 0.0) {
+    throw std::invalid_argument("Flush interval must be nonnegative.");
+  }
+  // Constructing first means a bad bufferSize leaves the logger unchanged.
+  tgBufferedFileWriter* pWriter =
+    new tgBufferedFileWriter(bufferSize, backgroundWriter);
+  if (m_pWriter != NULL) {
+    pWriter->setCompression(m_pWriter->getCompression());
+  }
+  delete m_pWriter;
+  m_pWriter = pWriter;
+  m_flushInterval = flushInterval;
+}
+
+void tgDataLogger2::setCompression(int level)
+{
+  if (m_pWriter == NULL) {
+    throw std::runtime_error("Compression needs buffered mode. Call setBuffering first.");
+  }
+  m_pWriter->setCompression(level);
 }
 
 /**
@@ -126,25 +164,25 @@ void tgDataLogger2::setup()
   strftime(fileTime, fileTimeSize, "%m%d%Y_%H%M%S", currentTime);
   // Result: fileTime is a string with the time information.
   m_fileName = m_fileNamePrefix + "_" + fileTime + ".txt";
+  if (m_pWriter != NULL && m_pWriter->getCompression() > 0) {
+    m_fileName += ".gz";
+  }
 
   // DEBUGGING output:
   std::cout << "tgDataLogger2 will be saving data to the file: " << std::endl
 	    << m_fileName << std::endl;
 
-  // Attempt to open the log file
-  tgOutput.open(m_fileName.c_str());
-  if (!tgOutput.is_open()) {
-    throw std::runtime_error("Log file could not be opened. Usually, this is because the directory you specified does not exist. Check for spelling errors.");
-  }
-
+  // Build the heading in memory, so that it can go to either the plain
+  // file or the compressed one.
+  std::ostringstream header;
   // Output a first line of the header.
-  tgOutput << "tgDataLogger2 started logging at time " << fileTime << ", with "
-	   << m_sensors.size() << " sensors on " << m_senseables.size()
-	   << " senseable objects." << std::endl;
+  header << "tgDataLogger2 started logging at time " << fileTime << ", with "
+	 << m_sensors.size() << " sensors on " << m_senseables.size()
+	 << " senseable objects." << std::endl;
 
   // The first column of data will be "time", the m_totalTime since beginning
   // of the simulation.
-  tgOutput << "time,";
+  header << "time,";
 
   // Iterate. For each sensor, output its header.
   // Prepend each label with the sensor number, which we choose to be the index in
@@ -157,18 +195,49 @@ void tgDataLogger2::setup()
     for (std::size_t j=0; j < headings.size(); j++) {
       // Prepend with the sensor number and an underscore.
       // Also, end with a comma, since this is a comma-separated-value log file.
-      tgOutput << i << "_" << headings[j] << ",";
+      header << i << "_" << headings[j] << ",";
     }
   }
   // End with a new line.
-  tgOutput << std::endl;
+  header << std::endl;
 
-  // Done! Close the output for now, will be re-opened during step.
-  tgOutput.close();
+  // Size the scratch space for the numeric sensor data once, here.
+  std::size_t maxSensorDataSize = 0;
+  for (std::size_t i=0; i < m_sensors.size(); i++) {
+    const std::size_t n = m_sensors[i]->getSensorDataSize();
+    if (n > maxSensorDataSize) {
+      maxSensorDataSize = n;
+    }
+  }
+  m_sensorData.assign(maxSensorDataSize, 0.0);
+
+  if (m_pWriter != NULL && m_pWriter->getCompression() > 0) {
+    // Compressed: the whole log, heading included, goes through the
+    // writer, which stays open until teardown.
+    m_pWriter->open(m_fileName, std::ios::out);
+    m_pWriter->write(header.str());
+  }
+  else {
+    // Attempt to open the log file
+    tgOutput.open(m_fileName.c_str());
+    if (!tgOutput.is_open()) {
+      throw std::runtime_error("Log file could not be opened. Usually, this is because the directory you specified does not exist. Check for spelling errors.");
+    }
+    tgOutput << header.str();
+    // Done! Close the output for now, will be re-opened during step.
+    tgOutput.close();
+
+    // In buffered mode, the file is opened once here and stays open
+    // until teardown.
+    if (m_pWriter != NULL) {
+      m_pWriter->open(m_fileName, std::ios::app);
+    }
+  }
 
   // Initialize/reset the values of the time variables.
   m_totalTime = 0.0;
   m_updateTime = 0.0;
+  m_flushTime = 0.0;
   
   // Postcondition
   assert(invariant());
@@ -183,6 +252,10 @@ void tgDataLogger2::teardown()
   tgDataManager::teardown();
   // Close the log file.
   tgOutput.close();
+  // In buffered mode, this writes out whatever is left in the buffer.
+  if (m_pWriter != NULL) {
+    m_pWriter->close();
+  }
   // Postcondition
   assert(invariant());
 }
@@ -206,33 +279,83 @@ void tgDataLogger2::step(double dt)
     // also, add to the current time between sensor readings.
     m_updateTime += dt;
     // Then, if enough time has elapsed between the previous sensor reading,
-    if (m_updateTime >= m_timeInterval) {
-      // Open the log file for writing, appending and not overwriting.
-      tgOutput.open(m_fileName.c_str(), std::ios::app);
-      // Then output the time.
-      tgOutput << m_totalTime << ",";
-      // Collect the data and output it to the file!
-      for (size_t i=0; i < m_sensors.size(); i++) {
-	// Get the vector of sensor data from this sensor
-	std::vector<std::string> sensordata = m_sensors[i]->getSensorData();
-	// Iterate and output each data sample
-	for (std::size_t j=0; j < sensordata.size(); j++) {
-	  // Include a comma, since this is a comma-separated-value log file.
-	  tgOutput << sensordata[j] << ",";
-	}
+    // or the sampling policy says so,
+    const bool due = (m_pSamplingPolicy != NULL) ?
+      m_pSamplingPolicy->step(m_totalTime, dt) :
+      (m_updateTime >= m_timeInterval);
+    if (due) {
+      if (m_pWriter != NULL) {
+	// Buffered mode: format the row in memory and hand it to the writer,
+	// which keeps the file open.
+	m_row.str("");
+	writeSample(m_row);
+	m_pWriter->markTime(m_totalTime);
+	m_pWriter->write(m_row.str());
+      }
+      else {
+	// Open the log file for writing, appending and not overwriting.
+	tgOutput.open(m_fileName.c_str(), std::ios::app);
+	writeSample(tgOutput);
+	// Close the output, to be re-opened next step.
+	tgOutput.close();
       }
-      tgOutput << std::endl;
-      // Close the output, to be re-opened next step.
-      tgOutput.close();
       // Now that the sensors have been read, reset the counter.
       m_updateTime = 0.0;
     }
+    // In buffered mode, also flush on a timer, so that the file doesn't
+    // lag too far behind the simulation.
+    if (m_pWriter != NULL && m_flushInterval > 0.0) {
+      m_flushTime += dt;
+      if (m_flushTime >= m_flushInterval) {
+	m_pWriter->flush();
+	m_flushTime = 0.0;
+      }
+    }
   }
 
   // Postcondition
   assert(invariant());
 }
 
+/**
+ * One row of the log: the time, then the data of every sensor, in the same
+ * order as the heading that was written in setup.
+ */
+void tgDataLogger2::writeSample(std::ostream& out)
+{
+  // With a sampling policy, the policy has already read the sensors.
+  if (m_pSamplingPolicy != NULL) {
+    const std::vector<double>& record = m_pSamplingPolicy->getRecord();
+    for (std::size_t j=0; j < record.size(); j++) {
+      out << record[j] << ",";
+    }
+    out << std::endl;
+    return;
+  }
+  // First, output the time.
+  out << m_totalTime << ",";
+  // Collect the data and output it!
+  // The numeric path skips building a vector of strings for every sensor;
+  // the doubles are formatted straight into the stream, which gives the
+  // same text as the sensors' own string conversion.
+  for (size_t i=0; i < m_sensors.size(); i++) {
+    const std::size_t n = m_sensors[i]->getSensorDataSize();
+    if (n > m_sensorData.size()) {
+      m_sensorData.resize(n);
+    }
+    if (n == 0) {
+      continue;
+    }
+    m_sensors[i]->getSensorDataInto(&m_sensorData[0]);
+    // Iterate and output each data sample
+    for (std::size_t j=0; j < n; j++) {
+      // Include a comma, since this is a comma-separated-value log file.
+      out << m_sensorData[j] << ",";
+    }
+  }
+  out << std::endl;
+}
+
 /**
  * The toString method for tgDataLogger2 should have some specific information
  * about (for example) the log file...
@@ -247,6 +370,16 @@ std::string tgDataLogger2::toString() const
   return os.str();
 }
 
+void tgDataLogger2::reportMemory(tgMemoryReport& report) const
+{
+  tgDataManager::reportMemory(report);
+  std::size_t bytes = tgMemoryReport::bytes(m_sensorData);
+  if (m_pWriter != NULL) {
+    bytes += m_pWriter->bytes();
+  }
+  report.add(tgMemoryReport::eLoggers, bytes);
+}
+
 std::ostream&
 operator<<(std::ostream& os, const tgDataLogger2& obj)
 {
@@ -30,6 +30,11 @@
 #include "tgDataManager.h"
 // Includes from the C++ standard library
 #include <fstream> // for writing to a file
+#include <sstream> // for formatting a row in buffered mode
+#include <vector>
+
+// Forward declarations
+class tgBufferedFileWriter;
 
 /**
  * tgDataLogger2 is a tgDataManager. It records data from sensors and outputs
@@ -58,10 +63,37 @@ class tgDataLogger2 : public tgDataManager
 
   /**
    * The base class handles destruction of the sensors and sensorInfos,
-   * so nothing to do here.
+   * so this only closes and deletes the buffered writer, if there is one.
    */
   ~tgDataLogger2();
 
+  /**
+   * Switch to buffered mode: the log file stays open from setup() to
+   * teardown(), and rows are collected in memory and written out in large
+   * blocks instead of re-opening the file at every sample.
+   * Takes effect at the next call to setup().
+   * @param[in] bufferSize the number of bytes to collect before writing.
+   * Must be positive.
+   * @param[in] flushInterval the simulated time, in seconds, after which
+   * the buffer is written out even if it isn't full. Zero means only flush
+   * when the buffer is full (and at teardown).
+   * @param[in] backgroundWriter if true, a separate thread writes the
+   * buffers to disk, so that step() does not wait on the file system.
+   */
+  void setBuffering(std::size_t bufferSize, double flushInterval = 0.0,
+		    bool backgroundWriter = false);
+
+  /**
+   * Compress the log: the file name gets ".gz" appended, and an index of
+   * time chunks is written next to it, see tgBufferedFileWriter.
+   * Needs buffered mode, and takes effect at the next call to setup().
+   * With a background writer, the compression happens on that thread.
+   * @param[in] level the zlib compression level, 1 to 9; zero turns
+   * compression off.
+   * @throw std::runtime_error if setBuffering has not been called
+   */
+  void setCompression(int level);
+
   /**
    * The setup function for tgDataLogger2 will:
    * (1) create all the sensors, (2) create a heading from the sensors, and
@@ -80,6 +112,8 @@ class tgDataLogger2 : public tgDataManager
   /**
    * The step function for tgDataLogger2 will open the log file for output,
    * write a line of sensor data, then close the log file.
+   * In buffered mode (see setBuffering), the line goes to an in-memory
+   * buffer instead, and the file stays open.
    * Declared virtual here just in case any classes inherit from this.
    * @param[in] dt a double, the amount of time since the last step. 
    */
@@ -91,10 +125,23 @@ class tgDataLogger2 : public tgDataManager
    */
   virtual std::string toString() const;
 
+  /**
+   * Add the sensors, and the row of data and the writer's buffers.
+   * @see tgDataManager::reportMemory
+   */
+  virtual void reportMemory(tgMemoryReport& report) const;
+
   // TO-DO: write a new invariant for this subclass, instead of using the parent's.
 
  protected:
 
+  /**
+   * Write one row of data (time, then every sensor's data) to a stream.
+   * This is shared between the buffered and unbuffered modes.
+   * @param[in,out] out the stream to write to.
+   */
+  virtual void writeSample(std::ostream& out);
+
   /**
    * Store the full name of the file for writing data.
    * note that this is NOT what is passed into the constructor:
@@ -125,7 +172,8 @@ class tgDataLogger2 : public tgDataManager
   /**
    * The time interval for sensor readings. Taking sensor data at each call 
    * of step() can result in very very large files, so this parameter allows querying
-   * at a slower interval.
+   * at a slower interval. Unused while a sampling policy is set, see
+   * tgDataManager::setSamplingPolicy.
    */
   double m_timeInterval;
 
@@ -134,6 +182,35 @@ class tgDataLogger2 : public tgDataManager
    * check m_timeInterval.
    */
   double m_updateTime;
+
+  /**
+   * In buffered mode, the writer that holds the log file open.
+   * NULL in the default (open, append, close) mode.
+   */
+  tgBufferedFileWriter* m_pWriter;
+
+  /**
+   * In buffered mode, the simulated time between forced flushes of the
+   * buffer. Zero means flush only when the buffer is full.
+   */
+  double m_flushInterval;
+
+  /**
+   * In buffered mode, the simulated time since the last flush.
+   */
+  double m_flushTime;
+
+  /**
+   * In buffered mode, rows are formatted here before being handed to
+   * m_pWriter. Kept as a member to reuse its storage between rows.
+   */
+  std::ostringstream m_row;
+
+  /**
+   * Scratch space for one sensor's numeric data, sized in setup to the
+   * largest sensor so that step doesn't allocate.
+   */
+  std::vector<double> m_sensorData;
   
 };
 
@@ -27,10 +27,15 @@
 #include "tgDataManager.h"
 // This application
 #include "tgSensor.h"
+#include "core/tgCast.h"
+#include "core/tgMemoryReport.h"
+#include "core/tgModel.h"
 #include "core/tgSenseable.h"
 #include "tgSensorInfo.h"
+#include "tgSamplingPolicy.h"
 // The C++ Standard Library
 //#include <stdio.h> // for sprintf
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
 #include <cassert>
@@ -38,7 +43,8 @@
 /**
  * Nothing to do, in this abstract base class.
  */
-tgDataManager::tgDataManager()
+tgDataManager::tgDataManager() :
+  m_pSamplingPolicy(NULL)
 {
   // Postcondition
   assert(invariant());
@@ -81,6 +87,8 @@ tgDataManager::~tgDataManager()
     m_sensorInfos[i] = NULL;
   }
 
+  delete m_pSamplingPolicy;
+
   // Note that the creation and deletion of the senseable objects, e.g.
   // the tgModels, is handled externally.
   // tgDataManagers should NOT destroy the objects they are sensing.
@@ -88,28 +96,102 @@ tgDataManager::~tgDataManager()
 
 /**
  * Helper for setup.
- * This function abstracts away the loop over the sensor infos list.
+ * This function adds the sensors of one sensor info for one senseable.
  */
-void tgDataManager::addSensorsHelper(tgSenseable* pSenseable)
+void tgDataManager::addSensorsHelper(tgSensorInfo* pSensorInfo,
+				     tgSenseable* pSenseable)
 {
-  // Loop over all tgSensorInfos in the list.
+  // Possibly create sensors (usually, this returns a list of size 1.
+  std::vector<tgSensor*> newSensors =
+    pSensorInfo->createSensorsIfAppropriate(pSenseable);
+  // Add everything in the list to m_sensors.
+  // If an empty list has been returned, no sensors will be added.
+  // Also, need to check if any of the pointers are NULL.
+  for( size_t i=0; i < newSensors.size(); i++ ){
+    // If this sensor pointer is not null...
+    if( newSensors[i] != NULL) {
+      m_sensors.push_back(newSensors[i]);
+    }
+  }
+}
+
+/**
+ * List each senseable followed by its descendants. A tgModel's cached
+ * descendant list is read in place rather than copied.
+ */
+void tgDataManager::flatten()
+{
+  m_flattened.clear();
+  m_rootStarts.clear();
+  for (size_t j=0; j < m_senseables.size(); j++){
+    tgSenseable* const pSenseable = m_senseables[j];
+    m_rootStarts.push_back(m_flattened.size());
+    m_flattened.push_back(pSenseable);
+    const tgModel* const pModel =
+      tgCast::cast<tgSenseable, tgModel>(pSenseable);
+    if (pModel != NULL) {
+      const std::vector<tgModel*>& descendants = pModel->getDescendants();
+      m_flattened.insert(m_flattened.end(),
+			 descendants.begin(), descendants.end());
+    }
+    else {
+      const std::vector<tgSenseable*> descendants =
+	pSenseable->getSenseableDescendants();
+      m_flattened.insert(m_flattened.end(),
+			 descendants.begin(), descendants.end());
+    }
+  }
+}
+
+/**
+ * Ask each sensor info for its senseables among the descendants of each
+ * model. Those lists and m_flattened are both depth-first, so one
+ * pass over each model's part of m_flattened places the matches.
+ */
+void tgDataManager::findMatches()
+{
+  m_typed.assign(m_sensorInfos.size(), true);
+  m_matches.clear();
+  std::vector<tgModel*> found;
   for (size_t i=0; i < m_sensorInfos.size(); i++){
-    // If this particular sensor info is appropriate for the pSenseable,
-    if( m_sensorInfos[i]->isThisMySenseable(pSenseable) ) {
-      // Possibly create sensors (usually, this returns a list of size 1.
-      std::vector<tgSensor*> newSensors =
-	m_sensorInfos[i]->createSensorsIfAppropriate(pSenseable);
-      // Add everything in the list to m_sensors.
-      // If an empty list has been returned, no sensors will be added.
-      // Also, need to check if any of the pointers are NULL.
-      for( size_t i=0; i < newSensors.size(); i++ ){
-	// If this sensor pointer is not null...
-	if( newSensors[i] != NULL) {
-	  m_sensors.push_back(newSensors[i]);
+    tgSensorInfo* const pSensorInfo = m_sensorInfos[i];
+    const size_t first = m_matches.size();
+    for (size_t j=0; j < m_senseables.size() && m_typed[i]; j++){
+      const size_t begin = m_rootStarts[j];
+      const size_t end = j + 1 < m_rootStarts.size() ?
+	m_rootStarts[j + 1] : m_flattened.size();
+      tgModel* const pModel =
+	tgCast::cast<tgSenseable, tgModel>(m_senseables[j]);
+      found.clear();
+      if (pModel != NULL && pSensorInfo->findSenseables(*pModel, found)) {
+	// A model is not its own descendant
+	if (pSensorInfo->isThisMySenseable(m_flattened[begin])) {
+	  m_matches.push_back(std::make_pair(begin, i));
+	}
+	size_t next = 0;
+	for (size_t k = begin + 1; k < end && next < found.size(); k++) {
+	  if (m_flattened[k] == static_cast<tgSenseable*>(found[next])) {
+	    m_matches.push_back(std::make_pair(k, i));
+	    next++;
+	  }
+	}
+      }
+      else if (pModel != NULL) {
+	// This info decides by more than type; setup() asks it each time
+	m_typed[i] = false;
+	m_matches.resize(first);
+      }
+      else {
+	for (size_t k = begin; k < end; k++) {
+	  if (pSensorInfo->isThisMySenseable(m_flattened[k])) {
+	    m_matches.push_back(std::make_pair(k, i));
+	  }
 	}
       }
     }
   }
+  // The same order as asking every info about every senseable in turn
+  std::sort(m_matches.begin(), m_matches.end());
 }
 
 /**
@@ -117,23 +199,56 @@ void tgDataManager::addSensorsHelper(tgSenseable* pSenseable)
  * Note that it is up to the child classes to do any other type of setup besides
  * sensor creation. For example, a data logger will have to first call this parent
  * function, then ask for the sensor heading from each sensor, then... etc.
+ * The sensors are created in the order of asking every sensor info about
+ * each senseable in turn, depth-first, but only the infos that don't
+ * decide by type are asked.
  */
 void tgDataManager::setup()
 {
-  // Iterate over all sensables and their descendants, adding sensors
-  // if appropriate.
-  for (size_t j=0; j < m_senseables.size(); j++){
-    // For each senseable object, create sensors for it and its descendants.
-    // First, the senseable itself:
-    addSensorsHelper(m_senseables[j]);
-    // Then, for all its descendants:
-    std::vector<tgSenseable*> descendants =
-      m_senseables[j]->getSenseableDescendants();
-    // Loop through.
-    for (size_t k=0; k < descendants.size(); k++) {
-      addSensorsHelper(descendants[k]);
+  flatten();
+  std::vector<const std::type_info*> topology;
+  topology.reserve(m_flattened.size());
+  for (size_t k=0; k < m_flattened.size(); k++){
+    topology.push_back(&typeid(*m_flattened[k]));
+  }
+  // Models rebuilt on reset have new addresses but the same types
+  if (m_typed.size() != m_sensorInfos.size() || topology != m_topology) {
+    findMatches();
+    m_topology.swap(topology);
+  }
+
+  if (std::find(m_typed.begin(), m_typed.end(), false) == m_typed.end()) {
+    for (size_t m=0; m < m_matches.size(); m++){
+      addSensorsHelper(m_sensorInfos[m_matches[m].second],
+		       m_flattened[m_matches[m].first]);
+    }
+  }
+  else {
+    size_t next = 0;
+    for (size_t k=0; k < m_flattened.size(); k++){
+      for (size_t i=0; i < m_sensorInfos.size(); i++){
+	bool mine;
+	if (m_typed[i]) {
+	  mine = next < m_matches.size() &&
+	    m_matches[next] == std::make_pair(k, i);
+	  if (mine) {
+	    next++;
+	  }
+	}
+	else {
+	  mine = m_sensorInfos[i]->isThisMySenseable(m_flattened[k]);
+	}
+	if (mine) {
+	  addSensorsHelper(m_sensorInfos[i], m_flattened[k]);
+	}
+      }
     }
   }
+
+  // The policy reads the sensors directly.
+  if (m_pSamplingPolicy != NULL) {
+    m_pSamplingPolicy->setup(m_sensors);
+  }
   
   // Postcondition
   assert(invariant());
@@ -190,6 +305,14 @@ void tgDataManager::step(double dt)
   assert(invariant());
 }
 
+void tgDataManager::setSamplingPolicy(tgSamplingPolicy* pPolicy)
+{
+  if (pPolicy != m_pSamplingPolicy) {
+    delete m_pSamplingPolicy;
+    m_pSamplingPolicy = pPolicy;
+  }
+}
+
 /**
  * This method adds sensor info objects to this data manager.
  * It takes in a pointer to a sensor info and pushes it to the
@@ -255,6 +378,16 @@ std::string tgDataManager::toString() const
 }
 
 
+void tgDataManager::reportMemory(tgMemoryReport& report) const
+{
+  report.add(tgMemoryReport::eSensors,
+             m_sensors.size() * sizeof(tgSensor) +
+             tgMemoryReport::bytes(m_sensors) +
+             m_sensorInfos.size() * sizeof(tgSensorInfo) +
+             tgMemoryReport::bytes(m_sensorInfos),
+             m_sensors.size());
+}
+
 bool tgDataManager::invariant() const
 {
   // TO-DO:
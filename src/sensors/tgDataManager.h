@@ -32,9 +32,13 @@
 #include <string>
 #include <sstream>
 #include <iostream>
+#include <typeinfo>
+#include <utility>
 #include <vector>
 
 // Forward declarations
+class tgMemoryReport;
+class tgSamplingPolicy;
 class tgSensor;
 class tgSensorInfo;
 
@@ -64,6 +68,9 @@ public:
     /**
      * Setup creates the sensors via sensor info classes,
      * and may do other things (ex., open a log file and put in a header.)
+     * Sensor infos that decide by type take their senseables from the
+     * type index of each model (see tgSensorInfo::findSenseables()),
+     * and keep them across resets that rebuild the same types.
      */
     virtual void setup();
     
@@ -94,6 +101,15 @@ public:
      * @param[in] pSensorInfo a pointer to a tgSensorInfo.
      */
     virtual void addSensorInfo(tgSensorInfo* pSensorInfo);
+
+    /**
+     * Choose which sensors are read at each step, and which steps are
+     * logged, instead of the data loggers' fixed time interval.
+     * Takes effect at the next call to setup().
+     * @param[in] pPolicy the policy, which this data manager takes
+     * ownership of and deletes. NULL restores the fixed interval.
+     */
+    void setSamplingPolicy(tgSamplingPolicy* pPolicy);
 	
     /**
      * Returns some basic information about this tgDataManager,
@@ -103,14 +119,57 @@ public:
      */
     virtual std::string toString() const;
 
+    /**
+     * Add the sensors and sensor infos to a tgMemoryReport. Subclasses
+     * with buffers add those too, as tgMemoryReport::eLoggers.
+     * @param[in,out] report the report to add to
+     */
+    virtual void reportMemory(tgMemoryReport& report) const;
+
  private:
 
     /**
-     * A helper function for setup. Since there will be a loop over
-     * the sensor infos, this function abstracts it away.
-     * @param[in] pSenseable a pointer to one of this object's senseables.
+     * A helper function for setup: add the sensors one sensor info
+     * creates for a senseable.
+     * @param[in] pSensorInfo one of this object's sensor infos
+     * @param[in] pSenseable one of this object's senseables or their
+     * descendants.
+     */
+    void addSensorsHelper(tgSensorInfo* pSensorInfo, tgSenseable* pSenseable);
+
+    /** Fill m_flattened and m_rootStarts from m_senseables. */
+    void flatten();
+
+    /**
+     * Find which of m_flattened the sensor infos that decide by type
+     * make sensors for, from the type indices of the models.
+     */
+    void findMatches();
+
+    /**
+     * Every senseable and its descendants, depth-first, in the order
+     * sensors are created. Rebuilt by setup().
+     */
+    std::vector<tgSenseable*> m_flattened;
+
+    /** The index in m_flattened of each of m_senseables. */
+    std::vector<std::size_t> m_rootStarts;
+
+    /**
+     * The dynamic type of each of m_flattened when m_matches was found.
+     * The matches of a sensor info that decides by type depend on
+     * nothing else, so they are kept across resets while it holds.
+     */
+    std::vector<const std::type_info*> m_topology;
+
+    /** For each sensor info, true if it finds its senseables by type. */
+    std::vector<bool> m_typed;
+
+    /**
+     * The index in m_flattened and the sensor info of each match of the
+     * typed sensor infos, in the order sensors are created.
      */
-    void addSensorsHelper(tgSenseable* pSenseable);
+    std::vector<std::pair<std::size_t, std::size_t> > m_matches;
 
 protected:
 
@@ -136,6 +195,12 @@ protected:
      */
     std::vector<tgSenseable*> m_senseables;
 
+    /**
+     * The sampling policy, or NULL for the data loggers' fixed interval.
+     * setup() hands it the sensors once they have been created.
+     */
+    tgSamplingPolicy* m_pSamplingPolicy;
+
 };
 
 /**
@@ -26,6 +26,7 @@
 
 #include "tgDataObserver.h"
 
+#include "tgBufferedFileWriter.h"
 #include "tgDataLogger.h"
 
 #include "core/tgCast.h"
@@ -36,15 +37,17 @@
 
 #include "core/tgSpringCableActuator.h"
 
+#include <cstdio>
 #include <iostream>
 #include <sstream>  
 #include <time.h>
 #include <stdexcept>
 
 tgDataObserver::tgDataObserver(std::string filePrefix) :
+m_pOutput(new tgBufferedFileWriter(1 << 16, true)),
+m_filePrefix(filePrefix),
 m_totalTime(0.0),
-m_dataLogger(NULL),
-m_filePrefix(filePrefix)
+m_dataLogger(NULL)
 {
 
 }
@@ -53,7 +56,8 @@ m_filePrefix(filePrefix)
 tgDataObserver::~tgDataObserver()
 { 
     delete m_dataLogger;
-    tgOutput.close();
+    // Writes out what is buffered
+    delete m_pOutput;
 }
 
 /**@todo move functions to constructor when possible */
@@ -70,27 +74,27 @@ void tgDataObserver::onSetup(tgModel& model)
     
     time (&rawtime);
     currentTime = localtime(&rawtime);
-    strftime(fileTime, fileTimeSize, "%m%d%Y_%H%M%S.txt", currentTime);
-    m_fileName = m_filePrefix + fileTime;
-    std::cout << m_fileName << std::endl;
+    strftime(fileTime, fileTimeSize, "%m%d%Y_%H%M%S", currentTime);
     
-    if (m_dataLogger != NULL)
+    // Closes the last episode's log
+    try
+    {
+        m_fileName = m_pOutput->openUnique(m_filePrefix + fileTime, ".txt");
+    }
+    catch (const std::runtime_error&)
     {
-        // prevent leaks on loop behavior (better than teardown?)
-        delete m_dataLogger;
+        throw std::runtime_error("Logs does not exist. Please create a logs folder in your build directory or update your cmake file");
     }
+    std::cout << m_fileName << std::endl;
     
-    m_dataLogger = new tgDataLogger(m_fileName);
+    if (m_dataLogger == NULL)
+    {
+        m_dataLogger = new tgDataLogger(*m_pOutput);
+    }
     
     m_totalTime = 0.0;
     
-    // First time opening this, so nothing to append to
-    tgOutput.open(m_fileName.c_str());
-    
-	if (!tgOutput.is_open())
-	{
-		throw std::runtime_error("Logs does not exist. Please create a logs folder in your build directory or update your cmake file");
-	}
+    std::ostringstream tgOutput;
     
     std::vector<tgModel*> children = model.getDescendants();
     
@@ -148,7 +152,7 @@ void tgDataObserver::onSetup(tgModel& model)
     
     tgOutput << std::endl;
     
-    tgOutput.close();
+    m_pOutput->write(tgOutput.str());
 }
 
 /**
@@ -159,13 +163,12 @@ void tgDataObserver::onSetup(tgModel& model)
 void tgDataObserver::onStep(tgModel& model, double dt)
 {  
     m_totalTime += dt;
-    tgOutput.open(m_fileName.c_str(), std::ios::app);
-    tgOutput << m_totalTime << ",";
-    tgOutput.close();
+    
+    char time[32];
+    const int length = snprintf(time, sizeof(time), "%g,", m_totalTime);
+    m_pOutput->write(time, length);
 
     model.onVisit(*m_dataLogger);
     
-    tgOutput.open(m_fileName.c_str(), std::ios::app);
-    tgOutput << std::endl;
-    tgOutput.close();
+    m_pOutput->write("\n", 1);
 }
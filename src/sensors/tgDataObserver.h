@@ -27,9 +27,9 @@
  * $Id$
  */
 
-#include <fstream>
 #include <string>
 
+class tgBufferedFileWriter;
 class tgModel;
 class tgDataLogger;
 
@@ -37,6 +37,11 @@ class tgDataLogger;
  * A class that dispatches data loggers. Should be included by observers,
  * since they will know when to step this, and we don't have any model
  * specific information here.
+ *
+ * Each setup opens a new log, named by the prefix and the time, with a
+ * "_1", "_2" ... added if another observer already has that name, so the
+ * worlds of a batch sharing a prefix each get their own file. Lines are
+ * collected in memory and written by a background thread.
  */
 
 class tgDataObserver
@@ -61,7 +66,7 @@ public:
      * the simulation resets */
 private:
     
-    std::ofstream tgOutput;
+    tgBufferedFileWriter* m_pOutput;
     
     std::string m_fileName;
     
@@ -0,0 +1,321 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgGoldenTrajectory.cpp
+ * @brief Contains the implementation of concrete class tgGoldenTrajectory
+ * $Id$
+ */
+
+// This module
+#include "tgGoldenTrajectory.h"
+#include "tgTrajectoryRecorder.h"
+// This application
+#include "core/tgSpringCableActuator.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+// Boost
+#include <boost/cstdint.hpp>
+// The C++ Standard Library
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+  /** The start of a golden trajectory file */
+  struct Header
+  {
+    char magic[16];
+    boost::uint64_t bodies;
+    boost::uint64_t cables;
+    boost::uint64_t frames;
+  };
+
+  const char goldenMagic[16] = "NTRT_GOLDEN";
+
+  const char* const bodyFields[tgGoldenTrajectory::bodyWidth] = {
+    "x", "y", "z", "qx", "qy", "qz", "qw",
+    "vx", "vy", "vz", "wx", "wy", "wz"
+  };
+
+  const char* const cableFields[tgGoldenTrajectory::cableWidth] = {
+    "restLength", "actualLength", "tension"
+  };
+
+  /** Name column c of a frame of the given number of bodies */
+  void nameColumn(std::size_t c, std::size_t bodies,
+		  std::string& component, std::string& field)
+  {
+    std::ostringstream os;
+    if (c == 0) {
+      component = "time";
+      field = "t";
+      return;
+    }
+    c -= 1;
+    if (c < bodies * tgGoldenTrajectory::bodyWidth) {
+      os << "body " << c / tgGoldenTrajectory::bodyWidth;
+      field = bodyFields[c % tgGoldenTrajectory::bodyWidth];
+    } else {
+      c -= bodies * tgGoldenTrajectory::bodyWidth;
+      os << "cable " << c / tgGoldenTrajectory::cableWidth;
+      field = cableFields[c % tgGoldenTrajectory::cableWidth];
+    }
+    component = os.str();
+  }
+}
+
+tgGoldenTrajectory::Divergence::Divergence() :
+  diverged(false),
+  step(0),
+  expected(0.0),
+  actual(0.0),
+  worstSigmas(0.0)
+{
+}
+
+std::string tgGoldenTrajectory::Divergence::toString() const
+{
+  std::ostringstream os;
+  os.precision(17);
+  if (!diverged) {
+    os << "No divergence, worst error " << worstSigmas << " sigmas";
+  } else {
+    os << "Diverged at step " << step << ", " << component << " " << field
+       << ": expected " << expected << ", actual " << actual;
+  }
+  return os.str();
+}
+
+tgGoldenTrajectory::tgGoldenTrajectory() :
+  tgDataManager(),
+  m_numBodies(0),
+  m_numCables(0),
+  m_totalTime(0.0),
+  m_recording(false)
+{
+  // Postcondition
+  assert(invariant());
+}
+
+void tgGoldenTrajectory::setup()
+{
+  // Call the parent's setup method, which creates the sensors.
+  tgDataManager::setup();
+
+  tgTrajectoryRecorder::collect(m_senseables, m_bodies, m_cables);
+  m_numBodies = m_bodies.size();
+  m_numCables = m_cables.size();
+  m_values.clear();
+  m_totalTime = 0.0;
+  m_recording = true;
+  record();
+
+  // Postcondition
+  assert(invariant());
+}
+
+void tgGoldenTrajectory::teardown()
+{
+  // Call the parent's teardown method! This is important!
+  tgDataManager::teardown();
+  m_bodies.clear();
+  m_cables.clear();
+  m_recording = false;
+  // Postcondition
+  assert(invariant());
+}
+
+void tgGoldenTrajectory::step(double dt)
+{
+  if (dt <= 0.0)
+  {
+    throw std::invalid_argument("dt is not positive");
+  }
+  else
+  {
+    m_totalTime += dt;
+    if (m_recording) {
+      record();
+    }
+  }
+
+  // Postcondition
+  assert(invariant());
+}
+
+std::string tgGoldenTrajectory::toString() const
+{
+  return "tgGoldenTrajectory";
+}
+
+std::size_t tgGoldenTrajectory::getFrames() const
+{
+  return m_values.size() /
+    (1 + bodyWidth * m_numBodies + cableWidth * m_numCables);
+}
+
+void tgGoldenTrajectory::record()
+{
+  m_values.push_back(m_totalTime);
+  for (std::size_t i=0; i < m_bodies.size(); i++) {
+    const btRigidBody& body = *m_bodies[i];
+    const btTransform& transform = body.getWorldTransform();
+    const btVector3& origin = transform.getOrigin();
+    const btQuaternion rotation = transform.getRotation();
+    const btVector3& v = body.getLinearVelocity();
+    const btVector3& w = body.getAngularVelocity();
+    const double state[bodyWidth] = {
+      origin.x(), origin.y(), origin.z(),
+      rotation.x(), rotation.y(), rotation.z(), rotation.w(),
+      v.x(), v.y(), v.z(), w.x(), w.y(), w.z()
+    };
+    m_values.insert(m_values.end(), state, state + bodyWidth);
+  }
+  for (std::size_t i=0; i < m_cables.size(); i++) {
+    const tgSpringCableActuator& cable = *m_cables[i];
+    m_values.push_back(cable.getRestLength());
+    m_values.push_back(cable.getCurrentLength());
+    m_values.push_back(cable.getTension());
+  }
+}
+
+void tgGoldenTrajectory::save(const std::string& fileName) const
+{
+  Header header;
+  std::memcpy(header.magic, goldenMagic, sizeof(header.magic));
+  header.bodies = m_numBodies;
+  header.cables = m_numCables;
+  header.frames = getFrames();
+
+  std::ofstream out(fileName.c_str(),
+		    std::ios::out | std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  if (!m_values.empty()) {
+    out.write(reinterpret_cast<const char*>(&m_values[0]),
+	      m_values.size() * sizeof(double));
+  }
+  if (!out) {
+    throw std::runtime_error("tgGoldenTrajectory could not write " + fileName);
+  }
+}
+
+void tgGoldenTrajectory::load(const std::string& fileName)
+{
+  std::ifstream in(fileName.c_str(), std::ios::in | std::ios::binary);
+  Header header;
+  if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+      std::memcmp(header.magic, goldenMagic, sizeof(header.magic)) != 0) {
+    throw std::runtime_error(fileName + " is not a golden trajectory");
+  }
+  const std::size_t width =
+    1 + bodyWidth * header.bodies + cableWidth * header.cables;
+  std::vector<double> values(width * header.frames);
+  if (!values.empty() &&
+      !in.read(reinterpret_cast<char*>(&values[0]),
+	       values.size() * sizeof(double))) {
+    throw std::runtime_error(fileName + " is missing frames");
+  }
+  m_numBodies = header.bodies;
+  m_numCables = header.cables;
+  m_values.swap(values);
+  m_recording = false;
+}
+
+tgGoldenTrajectory::Divergence
+tgGoldenTrajectory::compare(const tgGoldenTrajectory& reference,
+			    const Tolerance& tolerance) const
+{
+  Divergence result;
+  if (m_numBodies != reference.m_numBodies ||
+      m_numCables != reference.m_numCables) {
+    result.diverged = true;
+    result.component = "layout";
+    result.field = m_numBodies != reference.m_numBodies ? "bodies" : "cables";
+    result.expected = m_numBodies != reference.m_numBodies ?
+      reference.m_numBodies : reference.m_numCables;
+    result.actual = m_numBodies != reference.m_numBodies ?
+      m_numBodies : m_numCables;
+    return result;
+  }
+
+  const std::size_t width =
+    1 + bodyWidth * m_numBodies + cableWidth * m_numCables;
+  const std::size_t frames = std::min(getFrames(), reference.getFrames());
+  const double* const e = reference.m_values.empty() ? NULL : &reference.m_values[0];
+  const double* const a = m_values.empty() ? NULL : &m_values[0];
+
+  // The spread of each column of the reference, in one pass
+  std::vector<double> sigma(width, 0.0);
+  if (!tolerance.isBitwise() && reference.getFrames() > 1) {
+    std::vector<double> mean(width, 0.0);
+    const std::size_t n = reference.getFrames();
+    for (std::size_t f=0; f < n; f++) {
+      for (std::size_t c=0; c < width; c++) {
+	const double delta = e[f * width + c] - mean[c];
+	mean[c] += delta / (f + 1);
+	sigma[c] += delta * (e[f * width + c] - mean[c]);
+      }
+    }
+    for (std::size_t c=0; c < width; c++) {
+      sigma[c] = std::sqrt(sigma[c] / (n - 1));
+    }
+  }
+
+  const std::size_t columns = frames * width;
+  for (std::size_t i=0; i < columns; i++) {
+    const std::size_t c = i % width;
+    bool match;
+    if (tolerance.isBitwise()) {
+      match = std::memcmp(&e[i], &a[i], sizeof(double)) == 0;
+    } else {
+      const double error = std::fabs(a[i] - e[i]);
+      // NaN never matches
+      match = error <= tolerance.absolute + tolerance.sigmas * sigma[c];
+      if (sigma[c] > 0.0 && error / sigma[c] > result.worstSigmas) {
+	result.worstSigmas = error / sigma[c];
+      }
+    }
+    if (!match && !result.diverged) {
+      result.diverged = true;
+      result.step = i / width;
+      result.expected = e[i];
+      result.actual = a[i];
+      nameColumn(c, m_numBodies, result.component, result.field);
+      if (tolerance.isBitwise()) {
+	return result;
+      }
+    }
+  }
+
+  // A run cut short, or run longer, diverges where one of them ends
+  if (!result.diverged && getFrames() != reference.getFrames()) {
+    result.diverged = true;
+    result.step = frames;
+    result.component = "layout";
+    result.field = "frames";
+    result.expected = reference.getFrames();
+    result.actual = getFrames();
+  }
+  return result;
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_GOLDEN_TRAJECTORY_H
+#define TG_GOLDEN_TRAJECTORY_H
+
+/**
+ * @file tgGoldenTrajectory.h
+ * @brief Contains the definition of concrete class tgGoldenTrajectory.
+ * $Id$
+ */
+
+// Includes from NTRTsim
+#include "tgDataManager.h"
+
+// Includes from the C++ standard library
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class btRigidBody;
+class tgSpringCableActuator;
+
+/**
+ * tgGoldenTrajectory keeps, at every step, the full state of the rigid
+ * bodies and spring cables of its senseables: per body the position,
+ * orientation (x, y, z, w), linear and angular velocity, per cable the
+ * rest length, actual length and tension. A reference scenario is run
+ * once to save() a golden trajectory, and later builds run it again and
+ * compare() against the loaded file, so performance work on the step
+ * (cable banks, parallel passes, solvers) can't drift silently.
+ *
+ * The comparison is either bitwise, for a deterministic world on the same
+ * machine and compiler, or statistical: a value matches if it is within
+ * absolute plus sigmas times the standard deviation of its column over
+ * the whole reference, which scales the tolerance to how much each value
+ * moves. Either way the first divergent step and component are reported.
+ *
+ * Bodies and cables are collected as tgTrajectoryRecorder does, so
+ * models built the same way give the same columns. Each setup, including
+ * the one after a reset, starts over. The file is in native byte order.
+ */
+class tgGoldenTrajectory : public tgDataManager
+{
+ public:
+
+  /** How close a trajectory must be to its reference */
+  struct Tolerance
+  {
+    /**
+     * @param[in] s the allowed error in standard deviations of each
+     * column of the reference
+     * @param[in] a the allowed error regardless of the column
+     */
+    Tolerance(double s = 0.0, double a = 0.0) :
+      sigmas(s),
+      absolute(a)
+    {
+    }
+
+    /** @return true if only the same bits match */
+    bool isBitwise() const { return sigmas == 0.0 && absolute == 0.0; }
+
+    double sigmas;
+    double absolute;
+  };
+
+  /** The outcome of compare() */
+  struct Divergence
+  {
+    Divergence();
+
+    /** @return a line naming the step, component and values */
+    std::string toString() const;
+
+    /** False if the trajectories match */
+    bool diverged;
+
+    /** The first divergent frame; frame 0 is the state at setup */
+    std::size_t step;
+
+    /** e.g. "body 3", "cable 12", "time", or "layout" if the counts differ */
+    std::string component;
+
+    /** e.g. "vx" or "tension" */
+    std::string field;
+
+    double expected;
+    double actual;
+
+    /**
+     * The largest error over every frame compared, in standard deviations
+     * of its column, or 0 when comparing bitwise
+     */
+    double worstSigmas;
+  };
+
+  /** The number of values per body and per cable in a frame */
+  static const std::size_t bodyWidth = 13;
+  static const std::size_t cableWidth = 3;
+
+  tgGoldenTrajectory();
+
+  /**
+   * Collect the bodies and cables of the senseables and keep the first
+   * frame.
+   */
+  virtual void setup();
+
+  /**
+   * Forget the bodies and cables. The frames are kept.
+   */
+  virtual void teardown();
+
+  /**
+   * Keep a frame.
+   * @param[in] dt the amount of time since the last step.
+   */
+  virtual void step(double dt);
+
+  /**
+   * Overwrite toString for the superclass to specify that this data manager
+   * is a tgGoldenTrajectory.
+   */
+  virtual std::string toString() const;
+
+  /** @return the number of frames kept */
+  std::size_t getFrames() const;
+
+  std::size_t getBodies() const { return m_numBodies; }
+  std::size_t getCables() const { return m_numCables; }
+
+  /** @return the frames, 1 + 13 bodies + 3 cables values each */
+  const std::vector<double>& getValues() const { return m_values; }
+
+  /**
+   * Write the frames.
+   * @throw std::runtime_error if the file can't be written
+   */
+  void save(const std::string& fileName) const;
+
+  /**
+   * Replace the frames with those of a file written by save(), and stop
+   * recording until the next setup.
+   * @throw std::runtime_error if the file can't be read or is not a
+   * golden trajectory
+   */
+  void load(const std::string& fileName);
+
+  /**
+   * Compare the frames with those of a reference, frame by frame and in
+   * column order, stopping at the first difference.
+   * @param[in] reference the golden trajectory, usually loaded
+   * @param[in] tolerance what counts as a difference
+   */
+  Divergence compare(const tgGoldenTrajectory& reference,
+		     const Tolerance& tolerance = Tolerance()) const;
+
+ private:
+
+  /** Append the current state as a frame */
+  void record();
+
+  /** The distinct bodies of the senseables' rigids, in order. */
+  std::vector<btRigidBody*> m_bodies;
+
+  /** The spring cable actuators among the senseables, in order. */
+  std::vector<tgSpringCableActuator*> m_cables;
+
+  /** The layout of m_values, which outlives the bodies and cables */
+  std::size_t m_numBodies;
+  std::size_t m_numCables;
+
+  /** The frames, one after the other */
+  std::vector<double> m_values;
+
+  /** The total time since setup. */
+  double m_totalTime;
+
+  /** True between setup and teardown, unless frames were loaded since */
+  bool m_recording;
+};
+
+#endif // TG_GOLDEN_TRAJECTORY_H
@@ -0,0 +1,85 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgPerSensorSampling.cpp
+ * @brief Contains the implementation of concrete class tgPerSensorSampling.
+ * $Id$
+ */
+
+// This module
+#include "tgPerSensorSampling.h"
+// The C++ Standard Library
+#include <stdexcept>
+
+tgPerSensorSampling::tgPerSensorSampling(double interval) :
+  m_defaultInterval(interval),
+  m_anyDue(false)
+{
+  if (m_defaultInterval < 0.0) {
+    throw std::invalid_argument("Time interval must be nonnegative.");
+  }
+}
+
+void tgPerSensorSampling::setInterval(const std::string& key, double interval)
+{
+  if (interval < 0.0) {
+    throw std::invalid_argument("Time interval must be nonnegative.");
+  }
+  m_keys.push_back(key);
+  m_keyIntervals.push_back(interval);
+}
+
+void tgPerSensorSampling::onSetup()
+{
+  const std::size_t n = m_offsets.size() - 1;
+  m_intervals.assign(n, m_defaultInterval);
+  m_elapsed.assign(n, 0.0);
+  m_due.assign(n, false);
+  for (std::size_t i=0; i < n; i++) {
+    for (std::size_t k=0; k < m_keys.size(); k++) {
+      for (std::size_t c = m_offsets[i]; c < m_offsets[i + 1]; c++) {
+	if (m_columns[c].find(m_keys[k]) != std::string::npos) {
+	  m_intervals[i] = m_keyIntervals[k];
+	  break;
+	}
+      }
+    }
+  }
+}
+
+void tgPerSensorSampling::advance(double dt)
+{
+  // Same timing as the loggers' own interval: read once the interval
+  // has elapsed, then start counting again.
+  m_anyDue = false;
+  for (std::size_t i=0; i < m_elapsed.size(); i++) {
+    m_elapsed[i] += dt;
+    const bool due = (m_elapsed[i] >= m_intervals[i]);
+    m_due[i] = due;
+    if (due) {
+      m_elapsed[i] = 0.0;
+      m_anyDue = true;
+    }
+  }
+}
+
+bool tgPerSensorSampling::accept(double dt)
+{
+  return m_anyDue;
+}
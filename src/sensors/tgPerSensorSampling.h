@@ -0,0 +1,92 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_PER_SENSOR_SAMPLING_H
+#define TG_PER_SENSOR_SAMPLING_H
+
+/**
+ * @file tgPerSensorSampling.h
+ * @brief Contains the definition of concrete class tgPerSensorSampling.
+ * $Id$
+ */
+
+// This module
+#include "tgSamplingPolicy.h"
+// The C++ Standard Library
+#include <string>
+#include <vector>
+
+/**
+ * A sampling policy that reads each sensor at its own rate. Sensors are
+ * picked by a piece of their headings, such as a tag or "rod(". A record
+ * is logged whenever at least one sensor was read; the others repeat
+ * their last values.
+ */
+class tgPerSensorSampling : public tgSamplingPolicy
+{
+public:
+
+  /**
+   * @param[in] interval the time between readings of the sensors that
+   * no call to setInterval matches. Zero reads them at every step.
+   */
+  tgPerSensorSampling(double interval = 0.0);
+
+  /**
+   * Read the sensors whose headings contain key every interval seconds.
+   * Takes effect at the next setup; later calls win over earlier ones.
+   * @param[in] key a substring of a sensor's headings.
+   * @param[in] interval the time between readings, nonnegative.
+   */
+  void setInterval(const std::string& key, double interval);
+
+protected:
+
+  virtual void onSetup();
+
+  virtual void advance(double dt);
+
+  virtual bool isDue(std::size_t sensor) const { return m_due[sensor]; }
+
+  virtual bool accept(double dt);
+
+private:
+
+  /** The interval of sensors that no key matches */
+  const double m_defaultInterval;
+
+  /** The keys passed to setInterval() */
+  std::vector<std::string> m_keys;
+
+  /** The intervals passed to setInterval() */
+  std::vector<double> m_keyIntervals;
+
+  /** The interval of each sensor */
+  std::vector<double> m_intervals;
+
+  /** Time since each sensor was last read */
+  std::vector<double> m_elapsed;
+
+  /** Whether each sensor is read this step */
+  std::vector<bool> m_due;
+
+  /** Whether any sensor is read this step */
+  bool m_anyDue;
+};
+
+#endif // TG_PER_SENSOR_SAMPLING_H
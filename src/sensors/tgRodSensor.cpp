@@ -29,7 +29,6 @@
 
 // Includes from NTRT:
 #include "core/tgSenseable.h"
-#include "core/tgCast.h"
 #include "core/tgTags.h"
 
 // Includes from the c++ standard library:
@@ -44,9 +43,10 @@
 
 /**
  * This class is a sensor for tgRods.
- * Its constructor just calls tgSensor's constructor.
+ * Its constructor just calls tgTypedSensor's constructor, which keeps
+ * the typed pointer.
  */
-tgRodSensor::tgRodSensor(tgRod* pRod) : tgSensor(pRod)
+tgRodSensor::tgRodSensor(tgRod* pRod) : tgTypedSensor<tgRod>(pRod)
 {
   // Note that this pointer may be 0 (equivalent to NULL) if the cast in
   // the calling function from tgSenseable to tgRod fails.
@@ -71,19 +71,12 @@ tgRodSensor::~tgRodSensor()
  * so do that here for consistency. (even though mass doesn't change with time.)
  */
 std::vector<std::string> tgRodSensor::getSensorDataHeadings() {
-  // Note that this class has access to the parent's pointer, m_pSens.
-  // Let's cast that to a pointer to a tgRod right now.
-  // Here, "m_pRod" stands for "my pointer to a tgRod."
-  tgRod* m_pRod = tgCast::cast<tgSenseable, tgRod>(m_pSens);
-  // Check: if the cast failed, this will return 0.
-  // In that case, this tgRodSensor does not point to a tgRod!!!
-  assert( m_pRod != 0);
 
   // The list to which we'll append all the sensor headings:
   std::vector<std::string> headings;
   
   // Pull out the tags for this rod, so we only have to call the accessor once.
-  tgTags m_tags = m_pRod->getTags();
+  const tgTags& m_tags = m_pTyped->getTags();
 
   // Copied from tgSensor.h:
   /**
@@ -117,70 +110,38 @@ std::vector<std::string> tgRodSensor::getSensorDataHeadings() {
 
 /**
  * The method that collects the actual data from this tgRod.
+ * This is now just the formatted version of getSensorDataInto.
  */
 std::vector<std::string> tgRodSensor::getSensorData() {
-  // Similar to getSensorDataHeading, cast the a pointer to a tgRod right now.
-  tgRod* m_pRod = tgCast::cast<tgSenseable, tgRod>(m_pSens);
-  // Check: if the cast failed, this will return 0.
-  // In that case, this tgRodSensor does not point to a tgRod!!!
-  assert( m_pRod != 0);
+  double sensordata[7];
+  getSensorDataInto(sensordata);
+  return formatSensorData(sensordata, 7);
+}
+
+/**
+ * A rod always gives its position, orientation, and mass.
+ */
+std::size_t tgRodSensor::getSensorDataSize() {
+  return 7;
+}
+
+/**
+ * Collect the data from this tgRod as numbers, in the same order as
+ * the headings. No strings, and no allocation.
+ */
+void tgRodSensor::getSensorDataInto(double* out) {
   // Pick out the XYZ position of the center of mass of this rod.
-  btVector3 com = m_pRod->centerOfMass();
-  btVector3 orient = m_pRod->orientation();
+  btVector3 com = m_pTyped->centerOfMass();
+  btVector3 orient = m_pTyped->orientation();
   // Note that the 'orientation' method also returns a btVector3.
 
-  // The list of sensor data that will be returned:
-  std::vector<std::string> sensordata;
-
-  /**
-   * The original version of this section of code, which 
-   * output one string, looked like:
-   * std::stringstream sensordata;
-   * sensordata << com[0] << ","
-   *	     << com[1] << ","
-   *	     << com[2] << ","
-   *	     << orient[0] << ","
-   *	     << orient[1] << ","
-   *	     << orient[2] << ","
-   *	     << m_pRod->mass() << ",";
-   */
-  
-  // The floats (btScalars?) need to be converted to strings
-  // via a stringstream.
-  std::stringstream ss;
-
-  // com[0]
-  ss << com[0];
-  sensordata.push_back( ss.str() );
-  // Reset the stream.
-  ss.str("");
-  
-  // com[1]
-  ss << com[1];
-  sensordata.push_back( ss.str() );
-  ss.str("");
-  // com[2]
-  ss << com[2];
-  sensordata.push_back( ss.str() );
-  ss.str("");
-  // orient[0]
-  ss << orient[0];
-  sensordata.push_back( ss.str() );
-  ss.str("");
-  // orient[1]
-  ss << orient[1];
-  sensordata.push_back( ss.str() );
-  ss.str("");
-  // orient[2]
-  ss << orient[2];
-  sensordata.push_back( ss.str() );
-  ss.str("");
-  // mass
-  ss << m_pRod->mass();
-  sensordata.push_back( ss.str() );
-  ss.str("");
-  
-  return sensordata;
+  out[0] = com[0];
+  out[1] = com[1];
+  out[2] = com[2];
+  out[3] = orient[0];
+  out[4] = orient[1];
+  out[5] = orient[2];
+  out[6] = m_pTyped->mass();
 }
 
 //end.
@@ -27,16 +27,16 @@
 #define TG_ROD_SENSOR_H
 
 // Includes from the sensors directory:
-#include "tgSensor.h"
+#include "tgTypedSensor.h"
 // Includes from the NTRT core directory:
 #include "core/tgRod.h"
 
 /**
- * This class extends tgSensor to sense a tgRod.
+ * This class extends tgTypedSensor to sense a tgRod.
  * Its functionality is similar to what was hard-coded in earlier work
  * on tgDataLogger/Observer.
  */
-class tgRodSensor : public tgSensor
+class tgRodSensor : public tgTypedSensor<tgRod>
 {
 public:
 
@@ -57,6 +57,13 @@ public:
   virtual std::vector<std::string> getSensorDataHeadings();
   virtual std::vector<std::string> getSensorData();
 
+  /**
+   * The numeric versions of the data collection methods. getSensorData
+   * formats the output of getSensorDataInto, so the two always agree.
+   */
+  virtual std::size_t getSensorDataSize();
+  virtual void getSensorDataInto(double* out);
+
 };
 
 #endif //TG_ROD_SENSOR_H
@@ -28,6 +28,8 @@
 // Other includes from NTRTsim
 #include "tgRodSensor.h"
 #include "core/tgRod.h"
+#include "core/tgModel.h"
+#include "core/tgTagSearch.h"
 #include "core/tgSenseable.h"
 #include "core/tgCast.h"
 // Other includes from the C++ standard library
@@ -78,3 +80,14 @@ std::vector<tgSensor*> tgRodSensorInfo::createSensorsIfAppropriate(tgSenseable*
   newSensors.push_back( new tgRodSensor( tgCast::cast<tgSenseable, tgRod>(pSenseable) ));
   return newSensors;
 }
+
+/**
+ * tgModel::find() keeps the tgRods of each model, so this is one pass over
+ * them rather than a cast of every descendant.
+ */
+bool tgRodSensorInfo::findSenseables(tgModel& model, std::vector<tgModel*>& matches)
+{
+  const std::vector<tgRod*> found = model.find<tgRod>(tgTagSearch());
+  matches.insert(matches.end(), found.begin(), found.end());
+  return true;
+}
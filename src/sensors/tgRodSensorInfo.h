@@ -82,6 +82,12 @@ class tgRodSensorInfo : public tgSensorInfo
    */
   virtual std::vector<tgSensor*> createSensorsIfAppropriate(tgSenseable* pSenseable);
 
+  /**
+   * From tgSensorInfo, list the tgRods among a model's descendants.
+   * @return true, since a tgRod is sensed by type alone
+   */
+  virtual bool findSenseables(tgModel& model, std::vector<tgModel*>& matches);
+
 };
 
 #endif // TG_ROD_SENSOR_INFO_H
@@ -0,0 +1,85 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgSampleRing.cpp
+ * @brief Contains the implementation of class tgSampleRing.
+ * $Id$
+ */
+
+// This module
+#include "tgSampleRing.h"
+// The C++ Standard Library
+#include <stdexcept>
+#include <cassert>
+
+tgSampleRing::tgSampleRing(std::size_t width, std::size_t capacity) :
+  m_width(width),
+  m_slots(capacity + 1),
+  m_head(0),
+  m_tail(0)
+{
+  if (m_width == 0) {
+    throw std::invalid_argument("Record width must be positive in tgSampleRing.");
+  }
+  if (capacity == 0) {
+    throw std::invalid_argument("Capacity must be positive in tgSampleRing.");
+  }
+  m_data.assign(m_slots * m_width, 0.0);
+}
+
+double* tgSampleRing::beginPush()
+{
+  const std::size_t head = m_head.load(boost::memory_order_relaxed);
+  // Acquire: the consumer is done reading the slot it released.
+  if (next(head) == m_tail.load(boost::memory_order_acquire)) {
+    return NULL;
+  }
+  return &m_data[head * m_width];
+}
+
+void tgSampleRing::commitPush()
+{
+  const std::size_t head = m_head.load(boost::memory_order_relaxed);
+  assert(next(head) != m_tail.load(boost::memory_order_relaxed));
+  // Release: the record is written before the consumer can see it.
+  m_head.store(next(head), boost::memory_order_release);
+}
+
+const double* tgSampleRing::beginPop() const
+{
+  const std::size_t tail = m_tail.load(boost::memory_order_relaxed);
+  if (tail == m_head.load(boost::memory_order_acquire)) {
+    return NULL;
+  }
+  return &m_data[tail * m_width];
+}
+
+void tgSampleRing::commitPop()
+{
+  const std::size_t tail = m_tail.load(boost::memory_order_relaxed);
+  assert(tail != m_head.load(boost::memory_order_relaxed));
+  m_tail.store(next(tail), boost::memory_order_release);
+}
+
+std::size_t tgSampleRing::size() const
+{
+  const std::size_t head = m_head.load(boost::memory_order_acquire);
+  const std::size_t tail = m_tail.load(boost::memory_order_acquire);
+  return (head >= tail) ? head - tail : head + m_slots - tail;
+}
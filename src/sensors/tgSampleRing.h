@@ -0,0 +1,138 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_SAMPLE_RING_H
+#define TG_SAMPLE_RING_H
+
+/**
+ * @file tgSampleRing.h
+ * @brief Contains the definition of class tgSampleRing.
+ * $Id$
+ */
+
+// Includes from Boost:
+#include <boost/atomic.hpp>
+// Includes from the C++ standard library:
+#include <cstddef>
+#include <vector>
+
+/**
+ * tgSampleRing is a fixed-size, lock-free ring of sensor records, each
+ * being the same number of doubles. It hands samples from exactly one
+ * producer thread (the simulation) to exactly one consumer thread (a
+ * writer), so neither side ever takes a lock or allocates.
+ * The producer fills a slot returned by beginPush() and publishes it with
+ * commitPush(); the consumer reads a slot returned by beginPop() and
+ * releases it with commitPop().
+ */
+class tgSampleRing
+{
+ public:
+
+  /**
+   * @param[in] width the number of doubles in a record. Must be positive.
+   * @param[in] capacity the number of records the ring holds. Must be
+   * positive.
+   */
+  tgSampleRing(std::size_t width, std::size_t capacity);
+
+  /**
+   * Producer only.
+   * @return the slot for the next record, or NULL if the ring is full.
+   * The slot is not visible to the consumer until commitPush().
+   */
+  double* beginPush();
+
+  /**
+   * Producer only. Publish the slot returned by the last beginPush().
+   */
+  void commitPush();
+
+  /**
+   * Consumer only.
+   * @return the oldest record, or NULL if the ring is empty.
+   */
+  const double* beginPop() const;
+
+  /**
+   * Consumer only. Release the record returned by the last beginPop().
+   */
+  void commitPop();
+
+  /**
+   * @return the number of records waiting. Exact only when called from
+   * one of the two threads with the other one idle.
+   */
+  std::size_t size() const;
+
+  /**
+   * @return the number of doubles in a record.
+   */
+  std::size_t width() const { return m_width; }
+
+  /**
+   * @return the number of records the ring holds.
+   */
+  std::size_t capacity() const { return m_slots - 1; }
+
+ private:
+
+  /** @return the slot after slot i. */
+  std::size_t next(std::size_t i) const
+  {
+    return (i + 1 == m_slots) ? 0 : i + 1;
+  }
+
+  /**
+   * The number of doubles in a record.
+   */
+  const std::size_t m_width;
+
+  /**
+   * One more than the capacity, so that a full ring differs from an
+   * empty one.
+   */
+  const std::size_t m_slots;
+
+  /**
+   * The records, m_slots * m_width doubles.
+   */
+  std::vector<double> m_data;
+
+  /**
+   * The slot the producer writes next. Written only by the producer.
+   */
+  boost::atomic<std::size_t> m_head;
+
+  /**
+   * Keeps m_head and m_tail on separate cache lines, so that the two
+   * threads don't invalidate each other's line on every record.
+   */
+  char m_padding[64];
+
+  /**
+   * The slot the consumer reads next. Written only by the consumer.
+   */
+  boost::atomic<std::size_t> m_tail;
+
+  // Not copyable
+  tgSampleRing(const tgSampleRing&);
+  tgSampleRing& operator=(const tgSampleRing&);
+};
+
+#endif // TG_SAMPLE_RING_H
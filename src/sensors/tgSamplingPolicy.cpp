@@ -0,0 +1,79 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgSamplingPolicy.cpp
+ * @brief Contains the implementation of abstract class tgSamplingPolicy.
+ * $Id$
+ */
+
+// This module
+#include "tgSamplingPolicy.h"
+// This application
+#include "tgSensor.h"
+// The C++ Standard Library
+#include <stdexcept>
+#include <cassert>
+#include <sstream>
+
+tgSamplingPolicy::tgSamplingPolicy()
+{
+}
+
+tgSamplingPolicy::~tgSamplingPolicy()
+{
+}
+
+void tgSamplingPolicy::setup(const std::vector<tgSensor*>& sensors)
+{
+  m_sensors = sensors;
+  m_columns.clear();
+  m_offsets.clear();
+  m_columns.push_back("time");
+  for (std::size_t i=0; i < m_sensors.size(); i++) {
+    m_offsets.push_back(m_columns.size());
+    std::vector<std::string> headings = m_sensors[i]->getSensorDataHeadings();
+    // The record has a fixed width, so the numeric data must line up
+    // with the headings.
+    if (m_sensors[i]->getSensorDataSize() != headings.size()) {
+      throw std::runtime_error("A sensor's data size does not match its number of headings, in tgSamplingPolicy.");
+    }
+    for (std::size_t j=0; j < headings.size(); j++) {
+      std::ostringstream column;
+      column << i << "_" << headings[j];
+      m_columns.push_back(column.str());
+    }
+  }
+  m_offsets.push_back(m_columns.size());
+  m_record.assign(m_columns.size(), 0.0);
+
+  onSetup();
+}
+
+bool tgSamplingPolicy::step(double time, double dt)
+{
+  assert(m_offsets.size() == m_sensors.size() + 1);
+  advance(dt);
+  m_record[0] = time;
+  for (std::size_t i=0; i < m_sensors.size(); i++) {
+    if (m_offsets[i + 1] > m_offsets[i] && isDue(i)) {
+      m_sensors[i]->getSensorDataInto(&m_record[m_offsets[i]]);
+    }
+  }
+  return accept(dt);
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_SAMPLING_POLICY_H
+#define TG_SAMPLING_POLICY_H
+
+/**
+ * @file tgSamplingPolicy.h
+ * @brief Contains the definition of abstract class tgSamplingPolicy.
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class tgSensor;
+
+/**
+ * A tgSamplingPolicy decides, at each step of a tgDataManager, which
+ * sensors to read and whether the result is worth logging. It replaces
+ * the data loggers' fixed time interval; see
+ * tgDataManager::setSamplingPolicy.
+ *
+ * The policy keeps one record: the time, then the data of every sensor in
+ * order, with the same columns as the loggers' headings. Sensors that
+ * aren't due keep their previous values. Subclasses choose which sensors
+ * are due (isDue), and whether to log the record (accept), possibly after
+ * rewriting it.
+ */
+class tgSamplingPolicy
+{
+public:
+
+  tgSamplingPolicy();
+
+  virtual ~tgSamplingPolicy();
+
+  /**
+   * Size the record for a new set of sensors, and name its columns.
+   * Called by tgDataManager::setup once the sensors exist.
+   * @param[in] sensors the data manager's sensors. The policy reads them
+   * until the next setup, but does not own them.
+   * @throw std::runtime_error if a sensor's data size does not match its
+   * number of headings.
+   */
+  void setup(const std::vector<tgSensor*>& sensors);
+
+  /**
+   * Read the sensors that are due into the record.
+   * @param[in] time the time since setup, written to the first column.
+   * @param[in] dt the time since the last step.
+   * @return true if the record should be logged.
+   */
+  bool step(double time, double dt);
+
+  /**
+   * @return the record: the time, then the data of every sensor.
+   */
+  const std::vector<double>& getRecord() const { return m_record; }
+
+  /**
+   * @return the column names of the record: "time", then each sensor's
+   * headings prefixed with the sensor number, as in the data loggers.
+   */
+  const std::vector<std::string>& getColumns() const { return m_columns; }
+
+protected:
+
+  /**
+   * Called at the end of setup(), once the columns are known.
+   */
+  virtual void onSetup() { }
+
+  /**
+   * Called at the start of each step, before any sensor is read.
+   * @param[in] dt the time since the last step.
+   */
+  virtual void advance(double dt) { }
+
+  /**
+   * @param[in] sensor the index of a sensor.
+   * @return true if the sensor should be read this step. The default
+   * reads every sensor at every step.
+   */
+  virtual bool isDue(std::size_t sensor) const { return true; }
+
+  /**
+   * Decide whether to log this step. May rewrite m_record, for example
+   * with aggregates.
+   * @param[in] dt the time since the last step.
+   * @return true if the record should be logged.
+   */
+  virtual bool accept(double dt) = 0;
+
+  /**
+   * The column names, see getColumns().
+   */
+  std::vector<std::string> m_columns;
+
+  /**
+   * Sensor i fills the columns from m_offsets[i] to m_offsets[i + 1].
+   * Holds one more entry than there are sensors.
+   */
+  std::vector<std::size_t> m_offsets;
+
+  /**
+   * The record, see getRecord().
+   */
+  std::vector<double> m_record;
+
+private:
+
+  /**
+   * The sensors passed to setup().
+   */
+  std::vector<tgSensor*> m_sensors;
+};
+
+#endif // TG_SAMPLING_POLICY_H
@@ -29,7 +29,9 @@
 #include "core/tgSenseable.h"
 
 // Includes from the c++ standard library:
+#include <sstream>
 #include <stdexcept>
+#include <cstdlib> // for strtod
 
 /**
  * This cpp file only implements the constructor for tgSensor.
@@ -54,4 +56,40 @@ tgSensor::~tgSensor()
   // likely a tgModel, which is handled by other classes.
 }
 
+/**
+ * The default for the number of data values just counts the headings.
+ * Subclasses know this number without building any strings.
+ */
+std::size_t tgSensor::getSensorDataSize()
+{
+  return getSensorDataHeadings().size();
+}
+
+/**
+ * The default numeric path goes through the string path, for sensors
+ * that only implement getSensorData.
+ */
+void tgSensor::getSensorDataInto(double* out)
+{
+  std::vector<std::string> sensordata = getSensorData();
+  for (std::size_t i = 0; i < sensordata.size(); i++) {
+    out[i] = std::strtod(sensordata[i].c_str(), NULL);
+  }
+}
+
+std::vector<std::string> tgSensor::formatSensorData(const double* data,
+						    std::size_t n)
+{
+  std::vector<std::string> sensordata;
+  sensordata.reserve(n);
+  std::stringstream ss;
+  for (std::size_t i = 0; i < n; i++) {
+    ss << data[i];
+    sensordata.push_back( ss.str() );
+    // Reset the stream.
+    ss.str("");
+  }
+  return sensordata;
+}
+
 //end.
@@ -33,6 +33,7 @@ class tgSenseable;
 // From the C++ standard library:
 #include <iostream> //for strings
 #include <vector> // for returning lists of strings
+#include <cstddef> // for std::size_t
 
 /**
  * This class defines methods for use with sensors.
@@ -89,10 +90,42 @@ public:
    */
   virtual std::vector<std::string> getSensorData() = 0;
 
+  /**
+   * The number of values returned by getSensorData and getSensorDataInto.
+   * This must not change once the sensor has been created, so that callers
+   * can size their buffers once during setup.
+   * The default counts the headings, which is slow; sensors should
+   * override it with a constant.
+   * @return the number of pieces of sensor data.
+   */
+  virtual std::size_t getSensorDataSize();
+
+  /**
+   * Return the data from this class as numbers, without converting to
+   * strings, in the same order as the headings.
+   * The default parses the strings from getSensorData, so that older
+   * sensors keep working, but sensors should override it to skip the
+   * conversion and the allocation of the strings entirely.
+   * @param[out] out an array with room for getSensorDataSize() doubles.
+   */
+  virtual void getSensorDataInto(double* out);
+
   // TO-DO: should any of this be const?
 
 protected:
 
+  /**
+   * Format numeric sensor data as strings, the same way the sensors
+   * always have (a std::stringstream with default precision.)
+   * Sensors that implement getSensorDataInto can use this to implement
+   * getSensorData.
+   * @param[in] data the values to format.
+   * @param[in] n the number of values.
+   * @return a list of strings, one per value.
+   */
+  static std::vector<std::string> formatSensorData(const double* data,
+						   std::size_t n);
+
   /**
    * This class stores a pointer to its tgSenseable object.
    * Note that it is protected so that subclasses can access it,
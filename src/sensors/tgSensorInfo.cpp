@@ -43,4 +43,13 @@ tgSensorInfo::~tgSensorInfo()
 {
 }
 
+/**
+ * By default, a sensor info is asked about each senseable in turn.
+ */
+bool tgSensorInfo::findSenseables(tgModel& model,
+				  std::vector<tgModel*>& matches)
+{
+  return false;
+}
+
 //end.
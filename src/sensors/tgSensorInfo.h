@@ -37,6 +37,7 @@
 // ...
 
 // Forward references
+class tgModel;
 class tgSenseable;
 class tgSensor;
 
@@ -87,6 +88,20 @@ public:
    */
   virtual std::vector<tgSensor*> createSensorsIfAppropriate(tgSenseable* pSenseable) = 0;
 
+  /**
+   * Optionally, a sensor info that decides by type alone can list its
+   * senseables among a model's descendants with tgModel::find(), which
+   * casts each descendant once per type and keeps the result, so that
+   * tgDataManager does not have to ask isThisMySenseable of every one.
+   * The model itself is not included.
+   * @param[in] model the model whose descendants are searched
+   * @param[out] matches the descendants isThisMySenseable would accept,
+   * in depth-first order
+   * @return false if this sensor info must be asked about each senseable
+   * instead, which is the default.
+   */
+  virtual bool findSenseables(tgModel& model, std::vector<tgModel*>& matches);
+
 };
 
 
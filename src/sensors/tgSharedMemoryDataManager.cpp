@@ -0,0 +1,258 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgSharedMemoryDataManager.cpp
+ * @brief Contains the implementation of concrete class tgSharedMemoryDataManager
+ * $Id$
+ */
+
+// This module
+#include "tgSharedMemoryDataManager.h"
+// This application
+#include "tgSensor.h"
+#include "tgSamplingPolicy.h"
+// Includes from Boost:
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/static_assert.hpp>
+// The C++ Standard Library
+#include <stdexcept>
+#include <cassert>
+#include <cstring>
+#include <new>
+#include <sstream>
+#include <algorithm>
+
+namespace
+{
+  const char magic[16] = "NTRT_TELEMETRY1";
+
+  /**
+   * The start of the segment, see the class description.
+   */
+  struct TelemetryHeader
+  {
+    char magic[16];
+    boost::uint64_t columns;
+    boost::uint64_t namesSize;
+    boost::atomic<boost::uint64_t> sequence;
+  };
+
+  // Readers in other languages rely on the frame starting at byte 40.
+  BOOST_STATIC_ASSERT(sizeof(TelemetryHeader) == 40);
+
+  TelemetryHeader* header(const boost::interprocess::mapped_region& region)
+  {
+    return static_cast<TelemetryHeader*>(region.get_address());
+  }
+
+  double* frameOf(const boost::interprocess::mapped_region& region)
+  {
+    return reinterpret_cast<double*>(
+      static_cast<char*>(region.get_address()) + sizeof(TelemetryHeader));
+  }
+}
+
+tgSharedMemoryDataManager::tgSharedMemoryDataManager(const std::string& name,
+						     double timeInterval) :
+  tgDataManager(),
+  m_name(name),
+  m_totalTime(0.0),
+  m_timeInterval(timeInterval),
+  m_updateTime(0.0)
+{
+  if (m_name.empty() || m_name.find('/') != std::string::npos) {
+    throw std::invalid_argument("Shared memory name must be non-empty and must not contain a '/'.");
+  }
+  if (m_timeInterval < 0.0 ) {
+    throw std::invalid_argument("Time interval must be nonnegative. Negative time intervals do not make sense.");
+  }
+  
+  // Postcondition  
+  assert(invariant());
+}
+
+tgSharedMemoryDataManager::~tgSharedMemoryDataManager()
+{
+  boost::interprocess::shared_memory_object::remove(m_name.c_str());
+}
+
+void tgSharedMemoryDataManager::setup()
+{
+  // Call the parent's setup method, which creates the sensors.
+  tgDataManager::setup();
+
+  // The column names, as in tgDataLogger2.
+  std::ostringstream names;
+  names << "time" << std::endl;
+  std::size_t columns = 1;
+  m_sensorWidths.clear();
+  for (std::size_t i=0; i < m_sensors.size(); i++) {
+    std::vector<std::string> headings = m_sensors[i]->getSensorDataHeadings();
+    if (m_sensors[i]->getSensorDataSize() != headings.size()) {
+      throw std::runtime_error("A sensor's data size does not match its number of headings, in tgSharedMemoryDataManager.");
+    }
+    m_sensorWidths.push_back(headings.size());
+    for (std::size_t j=0; j < headings.size(); j++) {
+      names << i << "_" << headings[j] << std::endl;
+    }
+    columns += headings.size();
+  }
+  const std::string namesText = names.str();
+  m_frame.assign(columns, 0.0);
+
+  // Replace any segment left over from a run that didn't tear down.
+  using namespace boost::interprocess;
+  shared_memory_object::remove(m_name.c_str());
+  try {
+    shared_memory_object segment(create_only, m_name.c_str(), read_write);
+    segment.truncate(sizeof(TelemetryHeader) + columns * sizeof(double) +
+		     namesText.size());
+    mapped_region region(segment, read_write);
+    m_segment.swap(segment);
+    m_region.swap(region);
+  }
+  catch (const interprocess_exception& e) {
+    throw std::runtime_error(std::string("tgSharedMemoryDataManager could not create the segment ") + m_name + ": " + e.what());
+  }
+
+  TelemetryHeader* const pHeader = new (m_region.get_address()) TelemetryHeader;
+  if (!pHeader->sequence.is_lock_free()) {
+    throw std::runtime_error("tgSharedMemoryDataManager needs lock-free 64-bit atomics.");
+  }
+  std::memcpy(pHeader->magic, magic, sizeof(magic));
+  pHeader->columns = columns;
+  pHeader->namesSize = namesText.size();
+  std::fill(frameOf(m_region), frameOf(m_region) + columns, 0.0);
+  std::memcpy(frameOf(m_region) + columns, namesText.data(), namesText.size());
+  // Readers see no frame until the first publish makes this 2.
+  pHeader->sequence.store(0, boost::memory_order_release);
+
+  m_totalTime = 0.0;
+  m_updateTime = 0.0;
+
+  // Postcondition
+  assert(invariant());
+}
+
+void tgSharedMemoryDataManager::teardown()
+{
+  // Call the parent's teardown method! This is important!
+  tgDataManager::teardown();
+  boost::interprocess::shared_memory_object::remove(m_name.c_str());
+  boost::interprocess::mapped_region().swap(m_region);
+  boost::interprocess::shared_memory_object().swap(m_segment);
+  // Postcondition
+  assert(invariant());
+}
+
+void tgSharedMemoryDataManager::step(double dt) 
+{
+  if (dt <= 0.0)
+  {
+    throw std::invalid_argument("dt is not positive");
+  }
+  else
+  {
+    m_totalTime += dt;
+    m_updateTime += dt;
+    const bool due = (m_pSamplingPolicy != NULL) ?
+      m_pSamplingPolicy->step(m_totalTime, dt) :
+      (m_updateTime >= m_timeInterval);
+    if (due && m_region.get_address() != NULL) {
+      publish();
+      m_updateTime = 0.0;
+    }
+  }
+
+  // Postcondition
+  assert(invariant());
+}
+
+void tgSharedMemoryDataManager::publish()
+{
+  // Read the sensors outside the seqlock, so that readers only retry
+  // during the copy.
+  if (m_pSamplingPolicy != NULL) {
+    const std::vector<double>& record = m_pSamplingPolicy->getRecord();
+    assert(record.size() == m_frame.size());
+    std::copy(record.begin(), record.end(), m_frame.begin());
+  }
+  else {
+    std::size_t column = 0;
+    m_frame[column++] = m_totalTime;
+    for (std::size_t i=0; i < m_sensors.size(); i++) {
+      if (m_sensorWidths[i] > 0) {
+	m_sensors[i]->getSensorDataInto(&m_frame[column]);
+      }
+      column += m_sensorWidths[i];
+    }
+    assert(column == m_frame.size());
+  }
+
+  TelemetryHeader* const pHeader = header(m_region);
+  const boost::uint64_t sequence =
+    pHeader->sequence.load(boost::memory_order_relaxed);
+  // Odd: a frame is being written.
+  pHeader->sequence.store(sequence + 1, boost::memory_order_relaxed);
+  boost::atomic_thread_fence(boost::memory_order_release);
+  std::memcpy(frameOf(m_region), &m_frame[0], m_frame.size() * sizeof(double));
+  pHeader->sequence.store(sequence + 2, boost::memory_order_release);
+}
+
+unsigned long long tgSharedMemoryDataManager::readFrame(
+  const boost::interprocess::mapped_region& region,
+  std::vector<double>& frame, std::size_t maxTries)
+{
+  if (region.get_address() == NULL || region.get_size() < sizeof(TelemetryHeader) ||
+      std::memcmp(header(region)->magic, magic, sizeof(magic)) != 0) {
+    throw std::runtime_error("Not a tgSharedMemoryDataManager segment.");
+  }
+  TelemetryHeader* const pHeader = header(region);
+  const std::size_t columns = pHeader->columns;
+  if (region.get_size() < sizeof(TelemetryHeader) + columns * sizeof(double)) {
+    throw std::runtime_error("tgSharedMemoryDataManager segment is truncated.");
+  }
+  frame.resize(columns);
+  for (std::size_t i = 0; i < maxTries; i++) {
+    const boost::uint64_t before =
+      pHeader->sequence.load(boost::memory_order_acquire);
+    if (before == 0) {
+      return 0;
+    }
+    if (before % 2 != 0) {
+      continue;
+    }
+    std::memcpy(&frame[0], frameOf(region), columns * sizeof(double));
+    boost::atomic_thread_fence(boost::memory_order_acquire);
+    if (pHeader->sequence.load(boost::memory_order_relaxed) == before) {
+      return before;
+    }
+  }
+  return 0;
+}
+
+std::string tgSharedMemoryDataManager::toString() const
+{
+  std::ostringstream os;
+  os << tgDataManager::toString()
+     << "This tgDataManager is a tgSharedMemoryDataManager. " << std::endl;
+
+  return os.str();
+}
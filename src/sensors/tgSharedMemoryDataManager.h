@@ -0,0 +1,167 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_SHARED_MEMORY_DATA_MANAGER_H
+#define TG_SHARED_MEMORY_DATA_MANAGER_H
+
+/**
+ * @file tgSharedMemoryDataManager.h
+ * @brief Contains the definition of concrete class tgSharedMemoryDataManager.
+ * $Id$
+ */
+
+// Includes from NTRTsim
+#include "tgDataManager.h"
+// Includes from Boost:
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+// Includes from the C++ standard library
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * tgSharedMemoryDataManager publishes the latest sensor data through a
+ * shared memory segment, for live dashboards and hardware in the loop.
+ * Other processes map the segment and read the newest frame whenever they
+ * like; the simulation never waits for them, and nothing is written to
+ * disk.
+ *
+ * The segment (on Linux, /dev/shm/<name>) holds, in native byte order:
+ *   16 bytes  the magic string "NTRT_TELEMETRY1", NUL-padded
+ *   uint64    the number of columns, N
+ *   uint64    the size in bytes of the column names
+ *   uint64    the sequence number
+ *   N doubles the frame: the time, then every sensor's data
+ *   the column names, each followed by a newline, named as in
+ *   tgDataLogger2
+ * The frame is guarded by a seqlock: the sequence number is odd while a
+ * frame is being written, and even otherwise. A reader copies the frame
+ * between two reads of an even sequence number, and retries if they
+ * differ. readFrame() does this for C++ readers.
+ */
+class tgSharedMemoryDataManager : public tgDataManager
+{
+ public:
+
+  /**
+   * @param[in] name the name of the shared memory segment. Must not be
+   * empty or contain a "/".
+   * @param[in] timeInterval the time between frames. Zero publishes a
+   * frame at every step.
+   */
+  tgSharedMemoryDataManager(const std::string& name,
+			    double timeInterval = 0.0);
+
+  /**
+   * Removes the segment, if it's still there.
+   */
+  ~tgSharedMemoryDataManager();
+
+  /**
+   * Create the sensors, then create the segment, replacing any left over
+   * from an earlier run, and write the column names.
+   * @throw std::runtime_error if the segment can't be created.
+   */
+  virtual void setup();
+
+  /**
+   * Remove the segment. Readers that still have it mapped keep the last
+   * frame.
+   */
+  virtual void teardown();
+
+  /**
+   * Publish a frame, if timeInterval has elapsed since the last one.
+   * @param[in] dt the amount of time since the last step.
+   */
+  virtual void step(double dt);
+
+  /**
+   * Overwrite toString for the superclass to specify that this data manager
+   * is a tgSharedMemoryDataManager.
+   */
+  virtual std::string toString() const;
+
+  /**
+   * Read the newest frame of a segment written by this class, from any
+   * process.
+   * @param[in] region a mapping of the segment.
+   * @param[out] frame the frame: the time, then every sensor's data.
+   * @param[in] maxTries how many times to retry while a frame is being
+   * written.
+   * @return the sequence number of the frame that was read, or zero if
+   * none has been published yet or every try collided with a write.
+   * @throw std::runtime_error if the region isn't such a segment.
+   */
+  static unsigned long long readFrame(
+    const boost::interprocess::mapped_region& region,
+    std::vector<double>& frame, std::size_t maxTries = 100);
+
+ protected:
+
+  /**
+   * Copy the time and every sensor's data into the frame, under the
+   * seqlock.
+   */
+  virtual void publish();
+
+  /**
+   * The name of the segment.
+   */
+  const std::string m_name;
+
+  /**
+   * The segment, between setup and teardown.
+   */
+  boost::interprocess::shared_memory_object m_segment;
+
+  /**
+   * The mapping of the segment.
+   */
+  boost::interprocess::mapped_region m_region;
+
+  /**
+   * The number of values each sensor contributes to a frame.
+   */
+  std::vector<std::size_t> m_sensorWidths;
+
+  /**
+   * Scratch space for one frame, so that the frame in shared memory is
+   * written with a single copy.
+   */
+  std::vector<double> m_frame;
+
+  /**
+   * The total time since setup.
+   */
+  double m_totalTime;
+
+  /**
+   * The time interval between frames. Unused while a sampling policy is
+   * set.
+   */
+  double m_timeInterval;
+
+  /**
+   * The time since the last frame.
+   */
+  double m_updateTime;
+};
+
+#endif // TG_SHARED_MEMORY_DATA_MANAGER_H
@@ -29,7 +29,6 @@
 
 // Includes from NTRT:
 #include "core/tgSenseable.h"
-#include "core/tgCast.h"
 #include "core/tgTags.h"
 
 // Includes from the c++ standard library:
@@ -43,9 +42,10 @@
 
 /**
  * This class is a sensor for tgSpringCableActuators.
- * Its constructor just calls tgSensor's constructor.
+ * Its constructor just calls tgTypedSensor's constructor, which keeps
+ * the typed pointer.
  */
-tgSpringCableActuatorSensor::tgSpringCableActuatorSensor(tgSpringCableActuator* pSCA) : tgSensor(pSCA)
+tgSpringCableActuatorSensor::tgSpringCableActuatorSensor(tgSpringCableActuator* pSCA) : tgTypedSensor<tgSpringCableActuator>(pSCA)
 {
   // Note that this pointer may be 0 (equivalent to NULL) if the cast in
   // the calling function from tgSenseable to tgSpringCableActuator fails.
@@ -70,22 +70,13 @@ tgSpringCableActuatorSensor::~tgSpringCableActuatorSensor()
  * and damping constant.
  */
 std::vector<std::string> tgSpringCableActuatorSensor::getSensorDataHeadings() {
-  // Note that this class has access to the parent's pointer, m_pSens.
-  // Let's cast that to a pointer to a tgSpringCableActuator right now.
-  // Here, "m_pSCA" stands for "my pointer to a tgSpringCableActuator."
-  tgSpringCableActuator* m_pSCA =
-    tgCast::cast<tgSenseable, tgSpringCableActuator>(m_pSens);
-  // Check: if the cast failed, this will return 0.
-  // In that case, this tgSpringCableActuatorSensor does
-  // not point to a tgSpringCableActuator!!!
-  assert( m_pSCA != 0);
 
   // The list to which we'll append all the sensor headings:
   std::vector<std::string> headings;
 
   // Pull out the tags for this spring cable actuator,
   // so we only have to call the accessor once.
-  tgTags m_tags = m_pSCA->getTags();
+  const tgTags& m_tags = m_pTyped->getTags();
 
   // Copied from tgSensor.h:
   /**
@@ -111,40 +102,30 @@ std::vector<std::string> tgSpringCableActuatorSensor::getSensorDataHeadings() {
 
 /**
  * The method that collects the actual data from this tgSpringCableActuator.
+ * This is now just the formatted version of getSensorDataInto.
  */
 std::vector<std::string> tgSpringCableActuatorSensor::getSensorData() {
-  // Similar to getSensorDataHeading, cast the a pointer
-  // to a tgSpringCableActuator right now.
-  tgSpringCableActuator* m_pSCA =
-    tgCast::cast<tgSenseable, tgSpringCableActuator>(m_pSens);
-  // Check: if the cast failed, this will return 0.
-  // In that case, this tgSpringCableActuatorSensor does not point
-  // to a tgSpringCableActuator!!!
-  assert( m_pSCA != 0);
-
-  // The list of sensor data that will be returned:
-  std::vector<std::string> sensordata;
-
-  // The floats doubles need to be converted to strings via a stringstream.
-  std::stringstream ss;
-
-  // rest length
-  ss << m_pSCA->getRestLength();
-  sensordata.push_back( ss.str() );
-  // Reset the stream.
-  ss.str("");
-
-  // current length
-  ss << m_pSCA->getCurrentLength();
-  sensordata.push_back( ss.str() );
-  ss.str("");
-
-  // tension
-  ss << m_pSCA->getTension();
-  sensordata.push_back( ss.str() );
-  ss.str("");
-  
-  return sensordata;
+  double sensordata[3];
+  getSensorDataInto(sensordata);
+  return formatSensorData(sensordata, 3);
+}
+
+/**
+ * A spring cable actuator always gives its rest length, current length,
+ * and tension.
+ */
+std::size_t tgSpringCableActuatorSensor::getSensorDataSize() {
+  return 3;
+}
+
+/**
+ * Collect the data from this tgSpringCableActuator as numbers, in the
+ * same order as the headings.
+ */
+void tgSpringCableActuatorSensor::getSensorDataInto(double* out) {
+  out[0] = m_pTyped->getRestLength();
+  out[1] = m_pTyped->getCurrentLength();
+  out[2] = m_pTyped->getTension();
 }
 
 //end.
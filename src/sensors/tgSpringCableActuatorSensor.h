@@ -27,16 +27,16 @@
 #define TG_SPRING_CABLE_ACTUATOR_SENSOR_H
 
 // Includes from the sensors directory:
-#include "tgSensor.h"
+#include "tgTypedSensor.h"
 // Includes from the NTRT core directory:
 #include "core/tgSpringCableActuator.h"
 
 /**
- * This class extends tgSensor to sense a tgSpringCableActuator.
+ * This class extends tgTypedSensor to sense a tgSpringCableActuator.
  * Its functionality is similar to what was hard-coded in earlier work
  * on tgDataLogger/Observer.
  */
-class tgSpringCableActuatorSensor : public tgSensor
+class tgSpringCableActuatorSensor : public tgTypedSensor<tgSpringCableActuator>
 {
 public:
 
@@ -57,6 +57,13 @@ public:
   virtual std::vector<std::string> getSensorDataHeadings();
   virtual std::vector<std::string> getSensorData();
 
+  /**
+   * The numeric versions of the data collection methods. getSensorData
+   * formats the output of getSensorDataInto, so the two always agree.
+   */
+  virtual std::size_t getSensorDataSize();
+  virtual void getSensorDataInto(double* out);
+
 };
 
 #endif //TG_SPRING_CABLE_ACTUATOR_SENSOR_H
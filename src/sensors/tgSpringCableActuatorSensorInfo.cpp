@@ -29,6 +29,8 @@
 // Other includes from NTRTsim
 #include "tgSpringCableActuatorSensor.h"
 #include "core/tgSpringCableActuator.h"
+#include "core/tgModel.h"
+#include "core/tgTagSearch.h"
 #include "core/tgSenseable.h"
 #include "core/tgCast.h"
 // Other includes from the C++ standard library
@@ -81,3 +83,14 @@ std::vector<tgSensor*> tgSpringCableActuatorSensorInfo::createSensorsIfAppropria
   newSensors.push_back( new tgSpringCableActuatorSensor( tgCast::cast<tgSenseable, tgSpringCableActuator>(pSenseable) ));
   return newSensors;
 }
+
+/**
+ * tgModel::find() keeps the tgSpringCableActuators of each model, so this is one pass over
+ * them rather than a cast of every descendant.
+ */
+bool tgSpringCableActuatorSensorInfo::findSenseables(tgModel& model, std::vector<tgModel*>& matches)
+{
+  const std::vector<tgSpringCableActuator*> found = model.find<tgSpringCableActuator>(tgTagSearch());
+  matches.insert(matches.end(), found.begin(), found.end());
+  return true;
+}
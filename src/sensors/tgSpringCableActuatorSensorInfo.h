@@ -82,6 +82,12 @@ class tgSpringCableActuatorSensorInfo : public tgSensorInfo
    */
   virtual std::vector<tgSensor*> createSensorsIfAppropriate(tgSenseable* pSenseable);
 
+  /**
+   * From tgSensorInfo, list the tgSpringCableActuators among a model's descendants.
+   * @return true, since a tgSpringCableActuator is sensed by type alone
+   */
+  virtual bool findSenseables(tgModel& model, std::vector<tgModel*>& matches);
+
 };
 
 #endif // TG_SPRING_CABLE_ACTUATOR_SENSOR_INFO_H
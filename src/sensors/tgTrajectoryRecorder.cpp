@@ -0,0 +1,347 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgTrajectoryRecorder.cpp
+ * @brief Contains the implementation of concrete class tgTrajectoryRecorder
+ * $Id$
+ */
+
+// This module
+#include "tgTrajectoryRecorder.h"
+// This application
+#include "core/tgBaseRigid.h"
+#include "core/tgCast.h"
+#include "core/tgModel.h"
+#include "core/tgSpringCable.h"
+#include "core/tgSpringCableActuator.h"
+#include "core/tgSpringCableAnchor.h"
+#include "core/tgTrajectoryFile.h"
+// The Bullet Physics library
+#include "BulletCollision/CollisionShapes/btBoxShape.h"
+#include "BulletCollision/CollisionShapes/btCompoundShape.h"
+#include "BulletCollision/CollisionShapes/btCylinderShape.h"
+#include "BulletCollision/CollisionShapes/btSphereShape.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+// The C++ Standard Library
+#include <stdexcept>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+// POSIX, for growing and trimming the file
+#include <unistd.h>
+
+namespace
+{
+  /**
+   * Append the parts of a shape, placed at local in body's frame.
+   */
+  void appendParts(std::vector<double>& parts, std::size_t body,
+		   const btCollisionShape* pShape, const btTransform& local)
+  {
+    switch (pShape->getShapeType()) {
+    case COMPOUND_SHAPE_PROXYTYPE:
+      {
+	const btCompoundShape* const pCompound =
+	  static_cast<const btCompoundShape*>(pShape);
+	for (int i = 0; i < pCompound->getNumChildShapes(); i++) {
+	  appendParts(parts, body, pCompound->getChildShape(i),
+		      local * pCompound->getChildTransform(i));
+	}
+	return;
+      }
+    default:
+      break;
+    }
+
+    double shape = tgTrajectoryFile::SHAPE_OTHER;
+    btVector3 size(0.0, 0.0, 0.0);
+    switch (pShape->getShapeType()) {
+    case CYLINDER_SHAPE_PROXYTYPE:
+      {
+	const btCylinderShape* const pCylinder =
+	  static_cast<const btCylinderShape*>(pShape);
+	const int up = pCylinder->getUpAxis();
+	shape = tgTrajectoryFile::SHAPE_CYLINDER;
+	size = btVector3(pCylinder->getRadius(),
+			 pCylinder->getHalfExtentsWithMargin()[up], up);
+	break;
+      }
+    case BOX_SHAPE_PROXYTYPE:
+      shape = tgTrajectoryFile::SHAPE_BOX;
+      size = static_cast<const btBoxShape*>(pShape)->getHalfExtentsWithMargin();
+      break;
+    case SPHERE_SHAPE_PROXYTYPE:
+      shape = tgTrajectoryFile::SHAPE_SPHERE;
+      size.setX(static_cast<const btSphereShape*>(pShape)->getRadius());
+      break;
+    default:
+      break;
+    }
+
+    const btVector3& origin = local.getOrigin();
+    const btQuaternion rotation = local.getRotation();
+    const double part[tgTrajectoryFile::partWidth] = {
+      static_cast<double>(body), shape, size.x(), size.y(), size.z(),
+      origin.x(), origin.y(), origin.z(),
+      rotation.x(), rotation.y(), rotation.z(), rotation.w()
+    };
+    parts.insert(parts.end(), part, part + tgTrajectoryFile::partWidth);
+  }
+
+  /**
+   * Store a transform as x, y, z, then x, y, z, w.
+   */
+  double* storeTransform(double* p, const btTransform& transform)
+  {
+    const btVector3& origin = transform.getOrigin();
+    const btQuaternion rotation = transform.getRotation();
+    *p++ = origin.x();
+    *p++ = origin.y();
+    *p++ = origin.z();
+    *p++ = rotation.x();
+    *p++ = rotation.y();
+    *p++ = rotation.z();
+    *p++ = rotation.w();
+    return p;
+  }
+}
+
+tgTrajectoryRecorder::tgTrajectoryRecorder(const std::string& fileName,
+					   double timeInterval) :
+  tgDataManager(),
+  m_fileName(fileName),
+  m_framesOffset(0),
+  m_frames(0),
+  m_capacity(0),
+  m_totalTime(0.0),
+  m_timeInterval(timeInterval),
+  m_updateTime(0.0)
+{
+  if (m_fileName.empty()) {
+    throw std::invalid_argument("Trajectory file name must not be empty.");
+  }
+  if (m_timeInterval < 0.0 ) {
+    throw std::invalid_argument("Time interval must be nonnegative. Negative time intervals do not make sense.");
+  }
+
+  // Postcondition  
+  assert(invariant());
+}
+
+tgTrajectoryRecorder::~tgTrajectoryRecorder()
+{
+  close();
+}
+
+void tgTrajectoryRecorder::setup()
+{
+  // Call the parent's setup method, which creates the sensors.
+  tgDataManager::setup();
+  close();
+
+  collect(m_senseables, m_bodies, m_cables);
+
+  std::vector<double> parts;
+  for (std::size_t i=0; i < m_bodies.size(); i++) {
+    btTransform identity;
+    identity.setIdentity();
+    appendParts(parts, i, m_bodies[i]->getCollisionShape(), identity);
+  }
+
+  // Write the header and the parts, then map the file for the frames.
+  tgTrajectoryFile::Header header;
+  std::memcpy(header.magic, tgTrajectoryFile::magic, sizeof(header.magic));
+  header.bodies = m_bodies.size();
+  header.cables = m_cables.size();
+  header.parts = parts.size() / tgTrajectoryFile::partWidth;
+  header.frames = 0;
+  {
+    std::ofstream out(m_fileName.c_str(),
+		      std::ios::out | std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!parts.empty()) {
+      out.write(reinterpret_cast<const char*>(&parts[0]),
+		parts.size() * sizeof(double));
+    }
+    if (!out) {
+      throw std::runtime_error("tgTrajectoryRecorder could not write " + m_fileName);
+    }
+  }
+  m_framesOffset = sizeof(header) + parts.size() * sizeof(double);
+  m_frames = 0;
+  m_capacity = 0;
+  reserve(1024);
+
+  m_totalTime = 0.0;
+  m_updateTime = 0.0;
+  record();
+
+  // Postcondition
+  assert(invariant());
+}
+
+void tgTrajectoryRecorder::collect(const std::vector<tgSenseable*>& senseables,
+				   std::vector<btRigidBody*>& bodies,
+				   std::vector<tgSpringCableActuator*>& cables)
+{
+  // Collect the bodies once each: the rigids of a compound share one.
+  bodies.clear();
+  cables.clear();
+  for (std::size_t i=0; i < senseables.size(); i++) {
+    tgModel* const pModel = dynamic_cast<tgModel*>(senseables[i]);
+    if (pModel == NULL) {
+      continue;
+    }
+    std::vector<tgModel*> models(1, pModel);
+    const std::vector<tgModel*>& descendants = pModel->getDescendants();
+    models.insert(models.end(), descendants.begin(), descendants.end());
+    for (std::size_t j=0; j < models.size(); j++) {
+      tgBaseRigid* const pRigid = tgCast::cast<tgModel, tgBaseRigid>(models[j]);
+      btRigidBody* const pBody = (pRigid != NULL) ? pRigid->getPRigidBody() : NULL;
+      if (pBody != NULL &&
+	  std::find(bodies.begin(), bodies.end(), pBody) == bodies.end()) {
+	bodies.push_back(pBody);
+      }
+      tgSpringCableActuator* const pCable =
+	tgCast::cast<tgModel, tgSpringCableActuator>(models[j]);
+      if (pCable != NULL && pCable->getSpringCable() != NULL) {
+	cables.push_back(pCable);
+      }
+    }
+  }
+}
+
+void tgTrajectoryRecorder::teardown()
+{
+  // Call the parent's teardown method! This is important!
+  tgDataManager::teardown();
+  close();
+  m_bodies.clear();
+  m_cables.clear();
+  // Postcondition
+  assert(invariant());
+}
+
+void tgTrajectoryRecorder::step(double dt) 
+{
+  if (dt <= 0.0)
+  {
+    throw std::invalid_argument("dt is not positive");
+  }
+  else
+  {
+    m_totalTime += dt;
+    m_updateTime += dt;
+    if (m_updateTime >= m_timeInterval && m_region.get_address() != NULL) {
+      record();
+      m_updateTime = 0.0;
+    }
+  }
+
+  // Postcondition
+  assert(invariant());
+}
+
+void tgTrajectoryRecorder::record()
+{
+  if (m_frames == m_capacity) {
+    reserve(2 * m_capacity);
+  }
+  const std::size_t width =
+    tgTrajectoryFile::frameWidth(m_bodies.size(), m_cables.size());
+  char* const base = static_cast<char*>(m_region.get_address());
+  double* p = reinterpret_cast<double*>(base + m_framesOffset) + width * m_frames;
+
+  *p++ = m_totalTime;
+  for (std::size_t i=0; i < m_bodies.size(); i++) {
+    p = storeTransform(p, m_bodies[i]->getWorldTransform());
+  }
+  for (std::size_t i=0; i < m_cables.size(); i++) {
+    const tgSpringCableActuator& cable = *m_cables[i];
+    const std::vector<const tgSpringCableAnchor*> anchors =
+      cable.getSpringCable()->getAnchors();
+    assert(!anchors.empty());
+    const btVector3 from = anchors.front()->getWorldPosition();
+    const btVector3 to = anchors.back()->getWorldPosition();
+    *p++ = from.x();
+    *p++ = from.y();
+    *p++ = from.z();
+    *p++ = to.x();
+    *p++ = to.y();
+    *p++ = to.z();
+    *p++ = cable.getCurrentLength() - cable.getRestLength();
+  }
+
+  // Readers only look at frames the header counts.
+  ++m_frames;
+  reinterpret_cast<tgTrajectoryFile::Header*>(base)->frames = m_frames;
+}
+
+void tgTrajectoryRecorder::reserve(std::size_t frames)
+{
+  if (frames <= m_capacity) {
+    return;
+  }
+  const std::size_t width =
+    tgTrajectoryFile::frameWidth(m_bodies.size(), m_cables.size());
+  const std::size_t size = m_framesOffset + frames * width * sizeof(double);
+
+  using namespace boost::interprocess;
+  mapped_region().swap(m_region);
+  if (::truncate(m_fileName.c_str(), static_cast<off_t>(size)) != 0) {
+    throw std::runtime_error("tgTrajectoryRecorder could not grow " + m_fileName);
+  }
+  try {
+    file_mapping file(m_fileName.c_str(), read_write);
+    mapped_region region(file, read_write);
+    m_file.swap(file);
+    m_region.swap(region);
+  }
+  catch (const interprocess_exception& e) {
+    throw std::runtime_error(std::string("tgTrajectoryRecorder could not map ") + m_fileName + ": " + e.what());
+  }
+  m_capacity = frames;
+}
+
+void tgTrajectoryRecorder::close()
+{
+  if (m_region.get_address() == NULL) {
+    return;
+  }
+  boost::interprocess::mapped_region().swap(m_region);
+  boost::interprocess::file_mapping().swap(m_file);
+  const std::size_t width =
+    tgTrajectoryFile::frameWidth(m_bodies.size(), m_cables.size());
+  // A destructor calls this, so a failure to trim only leaves the file
+  // longer than its frames, which readers allow.
+  (void) ::truncate(m_fileName.c_str(),
+		    static_cast<off_t>(m_framesOffset + m_frames * width * sizeof(double)));
+  m_capacity = 0;
+}
+
+std::string tgTrajectoryRecorder::toString() const
+{
+  std::ostringstream os;
+  os << tgDataManager::toString()
+     << "This tgDataManager is a tgTrajectoryRecorder. " << std::endl;
+
+  return os.str();
+}
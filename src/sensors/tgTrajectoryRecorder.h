@@ -0,0 +1,185 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_TRAJECTORY_RECORDER_H
+#define TG_TRAJECTORY_RECORDER_H
+
+/**
+ * @file tgTrajectoryRecorder.h
+ * @brief Contains the definition of concrete class tgTrajectoryRecorder.
+ * $Id$
+ */
+
+// Includes from NTRTsim
+#include "tgDataManager.h"
+// Includes from Boost:
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+// Includes from the C++ standard library
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class btRigidBody;
+class tgSenseable;
+class tgSpringCableActuator;
+
+/**
+ * tgTrajectoryRecorder writes the transform of every rigid body and the
+ * end points of every spring cable of its senseables to a trajectory
+ * file (see tgTrajectoryFile) at a fixed interval, by default the usual
+ * render rate. A headless run can then be watched later in a
+ * tgSimViewReplay, without simulating it again.
+ *
+ * The file is memory mapped while recording and grows by doubling, so a
+ * frame costs one copy; the frame count in its header is advanced after
+ * each frame is complete, which lets a tgTrajectoryFile read a run that
+ * is still going or that was killed. Teardown trims the file to its
+ * frames. Each setup, including the one after a reset, starts the file
+ * over. Bodies and cables created after setup are not recorded, and
+ * sampling policies are not used.
+ */
+class tgTrajectoryRecorder : public tgDataManager
+{
+ public:
+
+  /**
+   * @param[in] fileName the trajectory file, created or replaced at setup.
+   * @param[in] timeInterval the time between frames. Zero records a frame
+   * at every step.
+   */
+  tgTrajectoryRecorder(const std::string& fileName,
+		       double timeInterval = 1.0/60.0);
+
+  /**
+   * Trims the file, if it's still open.
+   */
+  ~tgTrajectoryRecorder();
+
+  /**
+   * Collect the bodies and cables of the senseables, create the file,
+   * write the shapes of the bodies and record the first frame.
+   * @throw std::runtime_error if the file can't be created or mapped.
+   */
+  virtual void setup();
+
+  /**
+   * Trim the file to the frames recorded and close it.
+   */
+  virtual void teardown();
+
+  /**
+   * Record a frame, if timeInterval has elapsed since the last one.
+   * @param[in] dt the amount of time since the last step.
+   */
+  virtual void step(double dt);
+
+  /**
+   * Overwrite toString for the superclass to specify that this data manager
+   * is a tgTrajectoryRecorder.
+   */
+  virtual std::string toString() const;
+
+  /**
+   * @return the number of frames recorded since setup.
+   */
+  std::size_t getFrames() const
+  {
+    return m_frames;
+  }
+
+  /**
+   * Collect the distinct bodies of the senseables' rigids and their
+   * spring cable actuators, in the order of tgModel::getDescendants().
+   * @param[in] senseables the senseables, of which only models count.
+   * @param[out] bodies the bodies, once each.
+   * @param[out] cables the actuators.
+   */
+  static void collect(const std::vector<tgSenseable*>& senseables,
+		      std::vector<btRigidBody*>& bodies,
+		      std::vector<tgSpringCableActuator*>& cables);
+
+ protected:
+
+  /**
+   * Write the current state as the next frame, growing the file if it's
+   * full.
+   */
+  virtual void record();
+
+  /**
+   * Map the file again with room for at least frames frames.
+   * @param[in] frames the number of frames the file must hold.
+   */
+  void reserve(std::size_t frames);
+
+  /**
+   * Unmap the file and cut it to the recorded frames.
+   */
+  void close();
+
+  /**
+   * The name of the file.
+   */
+  const std::string m_fileName;
+
+  /**
+   * The file and its mapping, between setup and teardown.
+   */
+  boost::interprocess::file_mapping m_file;
+  boost::interprocess::mapped_region m_region;
+
+  /**
+   * The distinct bodies of the senseables' rigids, in order.
+   */
+  std::vector<btRigidBody*> m_bodies;
+
+  /**
+   * The spring cable actuators among the senseables, in order.
+   */
+  std::vector<tgSpringCableActuator*> m_cables;
+
+  /**
+   * The byte offset of the first frame in the file.
+   */
+  std::size_t m_framesOffset;
+
+  /**
+   * The number of frames recorded, and the number the file has room for.
+   */
+  std::size_t m_frames;
+  std::size_t m_capacity;
+
+  /**
+   * The total time since setup.
+   */
+  double m_totalTime;
+
+  /**
+   * The time interval between frames.
+   */
+  double m_timeInterval;
+
+  /**
+   * The time since the last frame.
+   */
+  double m_updateTime;
+};
+
+#endif // TG_TRAJECTORY_RECORDER_H
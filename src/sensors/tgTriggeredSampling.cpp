@@ -0,0 +1,84 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgTriggeredSampling.cpp
+ * @brief Contains the implementation of concrete class tgTriggeredSampling.
+ * $Id$
+ */
+
+// This module
+#include "tgTriggeredSampling.h"
+// The C++ Standard Library
+#include <stdexcept>
+
+tgTriggeredSampling::tgTriggeredSampling(double interval,
+					 const std::string& key,
+					 double threshold, double holdTime,
+					 bool above) :
+  m_interval(interval),
+  m_key(key),
+  m_threshold(threshold),
+  m_holdTime(holdTime),
+  m_above(above),
+  m_updateTime(0.0),
+  m_holdLeft(0.0)
+{
+  if (m_interval < 0.0 || m_holdTime < 0.0) {
+    throw std::invalid_argument("Time interval and hold time must be nonnegative.");
+  }
+  if (m_key.empty()) {
+    throw std::invalid_argument("The column key cannot be the empty string.");
+  }
+}
+
+void tgTriggeredSampling::onSetup()
+{
+  m_watched.clear();
+  // Column 0 is the time.
+  for (std::size_t c = 1; c < m_columns.size(); c++) {
+    if (m_columns[c].find(m_key) != std::string::npos) {
+      m_watched.push_back(c);
+    }
+  }
+  if (m_watched.empty()) {
+    throw std::runtime_error("No sensor heading matches the key " + m_key +
+			     " in tgTriggeredSampling.");
+  }
+  m_updateTime = 0.0;
+  m_holdLeft = 0.0;
+}
+
+bool tgTriggeredSampling::accept(double dt)
+{
+  m_updateTime += dt;
+  m_holdLeft = (m_holdLeft > dt) ? m_holdLeft - dt : 0.0;
+  for (std::size_t i = 0; i < m_watched.size(); i++) {
+    const double value = m_record[m_watched[i]];
+    if (m_above ? (value > m_threshold) : (value < m_threshold)) {
+      // Counts this step, so that a zero hold time logs just the event.
+      m_holdLeft = m_holdTime + dt;
+      break;
+    }
+  }
+  if (m_holdLeft > 0.0 || m_updateTime >= m_interval) {
+    m_updateTime = 0.0;
+    return true;
+  }
+  return false;
+}
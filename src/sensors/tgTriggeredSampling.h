@@ -0,0 +1,90 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_TRIGGERED_SAMPLING_H
+#define TG_TRIGGERED_SAMPLING_H
+
+/**
+ * @file tgTriggeredSampling.h
+ * @brief Contains the definition of concrete class tgTriggeredSampling.
+ * $Id$
+ */
+
+// This module
+#include "tgSamplingPolicy.h"
+// The C++ Standard Library
+#include <string>
+#include <vector>
+
+/**
+ * A sampling policy that logs at a slow interval until an event, then at
+ * every step for a while. The event is any column whose name contains a
+ * key crossing a threshold: for example "tension" above a spike level, or
+ * a rod's "Y" below the height of the ground.
+ * Every sensor is read at every step, so that events aren't missed; only
+ * the logging is slowed down.
+ */
+class tgTriggeredSampling : public tgSamplingPolicy
+{
+public:
+
+  /**
+   * @param[in] interval the time between records without an event.
+   * @param[in] key a substring of the names of the columns to watch.
+   * @param[in] threshold the value that triggers a capture.
+   * @param[in] holdTime how long to log at every step after the last
+   * step that met the threshold.
+   * @param[in] above if true, values above the threshold trigger;
+   * otherwise, values below it do.
+   */
+  tgTriggeredSampling(double interval, const std::string& key,
+		      double threshold, double holdTime, bool above = true);
+
+  /**
+   * @return true if the last step was logged because of an event.
+   */
+  bool isCapturing() const { return m_holdLeft > 0.0; }
+
+protected:
+
+  /**
+   * @throw std::runtime_error if no column matches the key.
+   */
+  virtual void onSetup();
+
+  virtual bool accept(double dt);
+
+private:
+
+  const double m_interval;
+  const std::string m_key;
+  const double m_threshold;
+  const double m_holdTime;
+  const bool m_above;
+
+  /** The columns whose names contain m_key */
+  std::vector<std::size_t> m_watched;
+
+  /** Time since the last record */
+  double m_updateTime;
+
+  /** Time left in the current capture */
+  double m_holdLeft;
+};
+
+#endif // TG_TRIGGERED_SAMPLING_H
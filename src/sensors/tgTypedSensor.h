@@ -0,0 +1,65 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_TYPED_SENSOR_H
+#define TG_TYPED_SENSOR_H
+
+/**
+ * @file tgTypedSensor.h
+ * @brief Contains the definition of template class tgTypedSensor.
+ * $Id$
+ */
+
+// Includes from the sensors directory:
+#include "tgSensor.h"
+
+/**
+ * A tgSensor for one type of tgSenseable. The sensor infos already cast
+ * the tgSenseable to its real type when they create a sensor, so this
+ * class keeps the typed pointer: the sensor never has to cast m_pSens
+ * (a dynamic_cast) again when it is sampled.
+ * @tparam T the type of tgSenseable, e.g. tgRod
+ */
+template <class T>
+class tgTypedSensor : public tgSensor
+{
+public:
+
+  /**
+   * @param[in] pSenseable a pointer to the object this sensor will attach
+   * itself to.
+   * @throw std::invalid_argument if pSenseable is NULL
+   */
+  tgTypedSensor(T* pSenseable) :
+    tgSensor(pSenseable),
+    m_pTyped(pSenseable)
+  {
+  }
+
+  // Classes with virtual member functions must also have virtual destructors.
+  virtual ~tgTypedSensor() { }
+
+protected:
+
+  /**
+   * The same object as m_pSens, as its real type.
+   */
+  T* const m_pTyped;
+};
+
+#endif // TG_TYPED_SENSOR_H
@@ -0,0 +1,86 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgWindowedSampling.cpp
+ * @brief Contains the implementation of concrete class tgWindowedSampling.
+ * $Id$
+ */
+
+// This module
+#include "tgWindowedSampling.h"
+// The C++ Standard Library
+#include <stdexcept>
+#include <algorithm>
+
+tgWindowedSampling::tgWindowedSampling(double window, Mode mode) :
+  m_window(window),
+  m_mode(mode),
+  m_count(0),
+  m_elapsed(0.0)
+{
+  if (m_window <= 0.0) {
+    throw std::invalid_argument("Window must be positive in tgWindowedSampling.");
+  }
+}
+
+void tgWindowedSampling::onSetup()
+{
+  m_accumulator.assign(m_record.size(), 0.0);
+  m_count = 0;
+  m_elapsed = 0.0;
+}
+
+bool tgWindowedSampling::accept(double dt)
+{
+  const std::size_t n = m_record.size();
+  // Column 0 is the time, which is never aggregated.
+  if (m_count == 0) {
+    std::copy(m_record.begin(), m_record.end(), m_accumulator.begin());
+  }
+  else {
+    for (std::size_t c = 1; c < n; c++) {
+      const double value = m_record[c];
+      switch (m_mode) {
+      case MIN:
+	m_accumulator[c] = std::min(m_accumulator[c], value);
+	break;
+      case MAX:
+	m_accumulator[c] = std::max(m_accumulator[c], value);
+	break;
+      case MEAN:
+	m_accumulator[c] += value;
+	break;
+      }
+    }
+  }
+  ++m_count;
+  m_elapsed += dt;
+  if (m_elapsed < m_window) {
+    return false;
+  }
+
+  // The record keeps this step's time, the end of the window.
+  for (std::size_t c = 1; c < n; c++) {
+    m_record[c] = (m_mode == MEAN) ?
+      m_accumulator[c] / static_cast<double>(m_count) : m_accumulator[c];
+  }
+  m_count = 0;
+  m_elapsed = 0.0;
+  return true;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_WINDOWED_SAMPLING_H
+#define TG_WINDOWED_SAMPLING_H
+
+/**
+ * @file tgWindowedSampling.h
+ * @brief Contains the definition of concrete class tgWindowedSampling.
+ * $Id$
+ */
+
+// This module
+#include "tgSamplingPolicy.h"
+// The C++ Standard Library
+#include <vector>
+
+/**
+ * A sampling policy that reads every sensor at every step, but logs one
+ * record per window of time: the minimum, maximum or mean of each column
+ * over the window. The time column is the end of the window.
+ * Unlike a slow interval, short transients still show up in a MIN or MAX
+ * log.
+ */
+class tgWindowedSampling : public tgSamplingPolicy
+{
+public:
+
+  /**
+   * How a window of samples is reduced to one record.
+   */
+  enum Mode
+  {
+    MIN,
+    MAX,
+    MEAN
+  };
+
+  /**
+   * @param[in] window the length of a window, in seconds. Must be
+   * positive.
+   * @param[in] mode how to combine the samples in a window.
+   */
+  tgWindowedSampling(double window, Mode mode = MEAN);
+
+protected:
+
+  virtual void onSetup();
+
+  virtual bool accept(double dt);
+
+private:
+
+  const double m_window;
+  const Mode m_mode;
+
+  /** The running minimum, maximum or sum of each column */
+  std::vector<double> m_accumulator;
+
+  /** The number of samples in the current window */
+  std::size_t m_count;
+
+  /** Time since the window started */
+  double m_elapsed;
+};
+
+#endif // TG_WINDOWED_SAMPLING_H
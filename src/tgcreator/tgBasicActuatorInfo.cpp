@@ -28,6 +28,8 @@
 
 #include "core/tgBulletSpringCable.h"
 #include "core/tgBulletSpringCableAnchor.h"
+#include "core/tgBulletUtil.h"
+#include "core/tgWorld.h"
 
 tgBasicActuatorInfo::tgBasicActuatorInfo(const tgBasicActuator::Config& config) : 
 m_config(config),
@@ -54,6 +56,12 @@ void tgBasicActuatorInfo::initConnector(tgWorld& world)
 {
     // Note: tgBulletSpringCable holds pointers to things in the world, but it doesn't actually have any in-world representation.
     m_bulletSpringCable = createTgBulletSpringCable();
+    m_bulletSpringCable->setStepStamp(world.getStepStamp());
+    // Unless the cable is a row of Bullet's constraint solver
+    if (m_config.constraint)
+    {
+        m_bulletSpringCable->enableConstraint(tgBulletUtil::worldToDynamicsWorld(world));
+    }
 }
 
 tgModel* tgBasicActuatorInfo::createModel(tgWorld& world)
@@ -121,6 +129,10 @@ tgBulletSpringCable* tgBasicActuatorInfo::createTgBulletSpringCable()
     tgBulletSpringCableAnchor* anchor2 = new tgBulletSpringCableAnchor(toBody, to);
     anchorList.push_back(anchor2);
 	
-    return new tgBulletSpringCable(anchorList, m_config.stiffness, m_config.damping, m_config.pretension);
+    tgBulletSpringCable* const cable =
+        new tgBulletSpringCable(anchorList, m_config.stiffness, m_config.damping, m_config.pretension);
+    cable->setSubsteps(m_config.substeps);
+    cable->setSleepThresholds(m_config.sleepTension, m_config.sleepVelocity);
+    return cable;
 }
     
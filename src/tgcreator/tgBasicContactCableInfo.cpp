@@ -27,9 +27,12 @@
 #include "tgBasicContactCableInfo.h"
 
 #include "core/tgBulletContactSpringCable.h"
+#include "core/tgBulletSpringCable.h"
+#include "core/tgWorld.h"
 
 #include "core/tgBulletUtil.h"
 #include "core/tgBulletSpringCableAnchor.h"
+#include "core/tgGhostFilter.h"
 
 #include "tgcreator/tgNode.h"
 
@@ -61,8 +64,22 @@ tgConnectorInfo* tgBasicContactCableInfo::createConnectorInfo(const tgPair& pair
 
 void tgBasicContactCableInfo::initConnector(tgWorld& world)
 {
+    if (world.getConfig().prescreen)
+    {
+        // Without contacts, a cable between fixed anchors
+        std::vector<tgBulletSpringCableAnchor*> anchorList;
+        anchorList.push_back(new tgBulletSpringCableAnchor(getFromRigidBody(),
+            getFromRigidInfo()->getConnectionPoint(getFrom(), getTo(), m_config.rotation)));
+        anchorList.push_back(new tgBulletSpringCableAnchor(getToRigidBody(),
+            getToRigidInfo()->getConnectionPoint(getTo(), getFrom(), m_config.rotation)));
+        m_bulletContactSpringCable = new tgBulletSpringCable(anchorList,
+            m_config.stiffness, m_config.damping, m_config.pretension);
+        m_bulletContactSpringCable->setStepStamp(world.getStepStamp());
+        return;
+    }
     // Note: tgBulletContactSpringCable holds pointers to things in the world, but it doesn't actually have any in-world representation.
     m_bulletContactSpringCable = createTgBulletContactSpringCable(world);
+    m_bulletContactSpringCable->setStepStamp(world.getStepStamp());
 }
 
 tgModel* tgBasicContactCableInfo::createModel(tgWorld& world)
@@ -134,7 +151,7 @@ tgBulletContactSpringCable* tgBasicContactCableInfo::createTgBulletContactSpring
 	// Add ghost object to world
 	// @todo tgBulletContactSpringCable handles deleting from world - should it handle adding too?
 	btDynamicsWorld& m_dynamicsWorld = tgBulletUtil::worldToDynamicsWorld(world);
-	m_dynamicsWorld.addCollisionObject(m_ghostObject,btBroadphaseProxy::CharacterFilter, btBroadphaseProxy::StaticFilter|btBroadphaseProxy::DefaultFilter);
+	tgGhostFilter::addGhost(m_dynamicsWorld, m_ghostObject);
 	
     return new tgBulletContactSpringCable(m_ghostObject, world, anchorList, m_config.stiffness, m_config.damping, m_config.pretension);
 }
@@ -37,6 +37,7 @@
 #include "core/tgTags.h"
 
 class tgBulletContactSpringCable;
+class tgBulletSpringCable;
 
 class tgBasicContactCableInfo : public tgConnectorInfo
 {
@@ -80,7 +81,8 @@ public:
     double getMass();
 
 protected:
-    tgBulletContactSpringCable* m_bulletContactSpringCable;
+    /** A plain tgBulletSpringCable in a prescreening world */
+    tgBulletSpringCable* m_bulletContactSpringCable;
     
 private:    
     
@@ -105,13 +105,12 @@ btCollisionShape* tgBoxInfo::getCollisionShape(tgWorld& world) const
         const double height = m_config.height;
         const double length = getLength();
         // Nominally x, y, z should we adjust here or the transform?
-        m_collisionShape =
-            new btBoxShape(btVector3(width, length / 2.0, height));
-    
-        // Add the collision shape to the array so we can delete it later
+        // Boxes of the same dimensions share one shape, which the world
+        // deletes
         tgWorldBulletPhysicsImpl& bulletWorld =
       (tgWorldBulletPhysicsImpl&)world.implementation();
-        bulletWorld.addCollisionShape(m_collisionShape);
+        m_collisionShape =
+            bulletWorld.getBoxShape(btVector3(width, length / 2.0, height));
     }
     return m_collisionShape;
 }
@@ -0,0 +1,245 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgBuildCache.cpp
+ * @brief Contains the definitions of members of class tgBuildCache
+ * $Id$
+ */
+
+// This module
+#include "tgBuildCache.h"
+// This library
+#include "tgBuildSpec.h"
+#include "tgConnectorInfo.h"
+#include "tgNode.h"
+#include "tgPair.h"
+#include "tgRigidInfo.h"
+#include "tgStructure.h"
+// The C++ Standard Library
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <typeinfo>
+
+namespace
+{
+    /** Bump when the plan layout or the meaning of its fields changes */
+    const std::string magic = "NTRT_BUILD_PLAN 1";
+
+    /** 64 bit FNV-1a, which is stable across platforms and runs. */
+    typedef unsigned long long hash_t;
+
+    void hashBytes(hash_t& hash, const void* data, std::size_t n)
+    {
+        const unsigned char* const bytes =
+            static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    }
+
+    void hashDouble(hash_t& hash, double value)
+    {
+        unsigned char bytes[sizeof(double)];
+        std::memcpy(bytes, &value, sizeof(double));
+        hashBytes(hash, bytes, sizeof(double));
+    }
+
+    /** Strings are length prefixed so "a" "bc" and "ab" "c" differ */
+    void hashString(hash_t& hash, const std::string& s)
+    {
+        hashDouble(hash, s.size());
+        hashBytes(hash, s.data(), s.size());
+    }
+
+    void hashTags(hash_t& hash, const tgTags& tags)
+    {
+        hashDouble(hash, tags.size());
+        for (int i = 0; i < tags.size(); ++i)
+        {
+            hashString(hash, tags[i]);
+        }
+    }
+
+    void hashVector(hash_t& hash, const btVector3& v)
+    {
+        hashDouble(hash, v.x());
+        hashDouble(hash, v.y());
+        hashDouble(hash, v.z());
+    }
+
+    void hashStructure(hash_t& hash, const tgStructure& structure)
+    {
+        hashTags(hash, structure.getTags());
+
+        const tgNodes& nodes = structure.getNodes();
+        hashDouble(hash, nodes.size());
+        for (int i = 0; i < nodes.size(); ++i)
+        {
+            hashVector(hash, nodes[i]);
+            hashTags(hash, nodes[i].getTags());
+        }
+
+        const tgPairs& pairs = structure.getPairs();
+        hashDouble(hash, pairs.size());
+        for (int i = 0; i < pairs.size(); ++i)
+        {
+            hashVector(hash, pairs[i].getFrom());
+            hashVector(hash, pairs[i].getTo());
+            hashTags(hash, pairs[i].getTags());
+        }
+
+        const std::vector<tgStructure*>& children = structure.getChildren();
+        hashDouble(hash, children.size());
+        for (std::size_t i = 0; i < children.size(); ++i)
+        {
+            hashStructure(hash, *children[i]);
+        }
+    }
+
+    void writeInts(std::ostream& out, const std::vector<boost::int32_t>& values)
+    {
+        out << values.size() << "\n";
+        if (!values.empty())
+        {
+            out.write(reinterpret_cast<const char*>(&values[0]),
+                      values.size() * sizeof(boost::int32_t));
+        }
+    }
+
+    bool readInts(std::istream& in, std::vector<boost::int32_t>& values)
+    {
+        unsigned long n = 0;
+        if (!(in >> n) || in.get() != '\n')
+        {
+            return false;
+        }
+        values.resize(n);
+        if (n > 0)
+        {
+            in.read(reinterpret_cast<char*>(&values[0]),
+                    n * sizeof(boost::int32_t));
+        }
+        return static_cast<bool>(in);
+    }
+}
+
+tgBuildCache::tgBuildCache(const std::string& directory) :
+    m_directory(directory)
+{
+    if (!m_directory.empty() && m_directory[m_directory.size() - 1] != '/')
+    {
+        m_directory += '/';
+    }
+}
+
+bool tgBuildCache::load(const std::string& key, Plan& plan) const
+{
+    std::ifstream in(getFileName(key).c_str(), std::ios::in | std::ios::binary);
+    std::string line;
+    if (!std::getline(in, line) || line != magic)
+    {
+        return false;
+    }
+    if (!std::getline(in, line) || line != key)
+    {
+        return false;
+    }
+    Plan p;
+    if (!readInts(in, p.rigidAgents) ||
+        !readInts(in, p.connectorAgents) ||
+        !readInts(in, p.groups) ||
+        !readInts(in, p.fromRigids) ||
+        !readInts(in, p.toRigids))
+    {
+        return false;
+    }
+    if (p.rigidAgents.size() != p.connectorAgents.size() ||
+        p.fromRigids.size() != p.toRigids.size())
+    {
+        return false;
+    }
+    plan = p;
+    return true;
+}
+
+void tgBuildCache::save(const std::string& key, const Plan& plan) const
+{
+    const std::string fileName = getFileName(key);
+    const std::string tempName = fileName + ".tmp";
+    {
+        std::ofstream out(tempName.c_str(),
+                          std::ios::out | std::ios::binary | std::ios::trunc);
+        out << magic << "\n" << key << "\n";
+        writeInts(out, plan.rigidAgents);
+        writeInts(out, plan.connectorAgents);
+        writeInts(out, plan.groups);
+        writeInts(out, plan.fromRigids);
+        writeInts(out, plan.toRigids);
+        if (!out)
+        {
+            throw std::runtime_error("Could not write build plan " + tempName);
+        }
+    }
+    if (std::rename(tempName.c_str(), fileName.c_str()) != 0)
+    {
+        std::remove(tempName.c_str());
+        throw std::runtime_error("Could not write build plan " + fileName);
+    }
+}
+
+std::string tgBuildCache::makeKey(const tgStructure& structure,
+                                  tgBuildSpec& spec)
+{
+    hash_t hash = 14695981039346656037ULL;
+    hashString(hash, magic);
+    hashStructure(hash, structure);
+
+    const std::vector<tgBuildSpec::RigidAgent*> rigidAgents =
+        spec.getRigidAgents();
+    hashDouble(hash, rigidAgents.size());
+    for (std::size_t i = 0; i < rigidAgents.size(); ++i)
+    {
+        hashTags(hash, rigidAgents[i]->tagSearch.getTags());
+        hashString(hash, typeid(*rigidAgents[i]->infoFactory).name());
+    }
+
+    const std::vector<tgBuildSpec::ConnectorAgent*> connectorAgents =
+        spec.getConnectorAgents();
+    hashDouble(hash, connectorAgents.size());
+    for (std::size_t i = 0; i < connectorAgents.size(); ++i)
+    {
+        hashTags(hash, connectorAgents[i]->tagSearch.getTags());
+        hashString(hash, typeid(*connectorAgents[i]->infoFactory).name());
+    }
+
+    std::ostringstream os;
+    os << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return os.str();
+}
+
+std::string tgBuildCache::getFileName(const std::string& key) const
+{
+    return m_directory + "build_" + key + ".plan";
+}
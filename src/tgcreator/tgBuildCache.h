@@ -0,0 +1,117 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_BUILD_CACHE_H
+#define TG_BUILD_CACHE_H
+
+/**
+ * @file tgBuildCache.h
+ * @brief Contains the definition of class tgBuildCache
+ * $Id$
+ */
+
+// Boost
+#include <boost/cstdint.hpp>
+// The C++ Standard Library
+#include <string>
+#include <vector>
+
+// Forward declarations
+class tgBuildSpec;
+class tgStructure;
+
+/**
+ * Saves the decisions tgStructureInfo::buildInto makes while resolving a
+ * tgStructure against a tgBuildSpec, so later builds of the same model can
+ * replay them: which agent builds each node and pair, which rigids are
+ * compounded together, and which rigids each connector attaches to. The
+ * tag matching, grouping and rigid selection are skipped on a hit; the
+ * infos, shapes and bodies are still created, since they belong to the
+ * world being built.
+ *
+ * Entries are named by a hash of the structure tree (tags, node and pair
+ * positions) and of the spec (agent searches and info types). Agent
+ * configs are not part of the key: a connector whose recorded rigid no
+ * longer contains its endpoint chooses again.
+ */
+class tgBuildCache
+{
+public:
+
+    /**
+     * The recorded decisions. Candidates are the nodes then pairs of each
+     * structure, in the same pre-order as the structure tree; rigids and
+     * connectors are numbered in that order too.
+     */
+    struct Plan
+    {
+        /** Per candidate, the rigid agent that built it, or -1 */
+        std::vector<boost::int32_t> rigidAgents;
+
+        /** Per candidate, the connector agent that built it, or -1 */
+        std::vector<boost::int32_t> connectorAgents;
+
+        /** Per rigid, its group in tgRigidAutoCompound's order */
+        std::vector<boost::int32_t> groups;
+
+        /** Per connector, the rigid at each end, or -1 */
+        std::vector<boost::int32_t> fromRigids;
+        std::vector<boost::int32_t> toRigids;
+    };
+
+    /**
+     * Construct a cache that keeps its files in a directory.
+     * @param[in] directory an existing directory, or "" for the current
+     * working directory
+     */
+    tgBuildCache(const std::string& directory = "");
+
+    /**
+     * Read the plan for a key.
+     * @param[in] key a key from makeKey()
+     * @param[out] plan the plan; unchanged if there is no usable entry
+     * @return false if the entry is missing or unreadable
+     */
+    bool load(const std::string& key, Plan& plan) const;
+
+    /**
+     * Write the plan for a key, replacing any existing entry.
+     * @throw std::runtime_error if the file can't be written
+     */
+    void save(const std::string& key, const Plan& plan) const;
+
+    /**
+     * Build a cache key.
+     * @return a 16 digit hexadecimal string
+     */
+    static std::string makeKey(const tgStructure& structure,
+                               tgBuildSpec& spec);
+
+    /**
+     * Return the file that holds the entry for a key.
+     * @param[in] key a key from makeKey()
+     */
+    std::string getFileName(const std::string& key) const;
+
+private:
+
+    /** The directory holding the cache files, with a trailing '/'. */
+    std::string m_directory;
+};
+
+#endif  // TG_BUILD_CACHE_H
@@ -32,6 +32,37 @@
 #include "core/tgTags.h"
 #include "core/tgTagSearch.h"
 
+#include <typeinfo>
+
+namespace
+{
+    /**
+     * Agents are tried newest first, so an older agent with the same search
+     * and the same kind of builder as a new one can never be reached again.
+     * Delete it, so that registering the same builder repeatedly (as every
+     * YAML file naming a tag does) leaves a single agent to match against.
+     */
+    template <class Agent, class Info>
+    void removeShadowed(std::vector<Agent*>& agents, const tgTagSearch& search,
+                        const Info* infoFactory)
+    {
+        if (infoFactory == NULL) {
+            return;
+        }
+        // Each addition removes the one it shadows, so there is at most one
+        for (typename std::vector<Agent*>::iterator it = agents.begin();
+             it != agents.end(); ++it) {
+            if ((*it)->infoFactory != NULL &&
+                typeid(*(*it)->infoFactory) == typeid(*infoFactory) &&
+                (*it)->tagSearch.getTags() == search.getTags()) {
+                delete *it;
+                agents.erase(it);
+                return;
+            }
+        }
+    }
+}
+
 tgBuildSpec::RigidAgent::~RigidAgent()  
 {
     delete infoFactory;
@@ -42,6 +73,11 @@ tgBuildSpec::ConnectorAgent::~ConnectorAgent()
 }
 
 tgBuildSpec::~tgBuildSpec() {
+    clear();
+}
+
+void tgBuildSpec::clear()
+{
     while (!m_rigidAgents.empty()){
          RigidAgent* agent = m_rigidAgents.back();
          m_rigidAgents.pop_back();
@@ -52,6 +88,9 @@ tgBuildSpec::~tgBuildSpec() {
           m_connectorAgents.pop_back();
           delete agent;
       }
+    std::vector<RigidAgent*>().swap(m_rigidAgents);
+    std::vector<ConnectorAgent*>().swap(m_connectorAgents);
+    std::vector<std::pair<tgTagSearch, bool> >().swap(m_selfCollision);
 }
 
 void tgBuildSpec::addBuilder(std::string tag_search, tgRigidInfo* infoFactory)
@@ -63,12 +102,33 @@ void tgBuildSpec::addBuilder(std::string tag_search, tgRigidInfo* infoFactory)
     // goes downhill from there. tgTagSearch should be able to handle that,
     // but user messaging would be difficult here.)
     
+    // An identical search for the same kind of builder is the one exception,
+    // the older agent is dropped.
+    
     //m_infoFactorys.push_back(tgBuildSpec::Entry(tgTagSearch(tag_search), infoFactory)); // @todo: make this work
-    m_rigidAgents.push_back(new RigidAgent(tag_search, infoFactory));
+    RigidAgent* const agent = new RigidAgent(tag_search, infoFactory);
+    removeShadowed(m_rigidAgents, agent->tagSearch, infoFactory);
+    m_rigidAgents.push_back(agent);
 }
 
 void tgBuildSpec::addBuilder(std::string tag_search, tgConnectorInfo* infoFactory)
 {
-    m_connectorAgents.push_back(new ConnectorAgent(tag_search, infoFactory));
+    ConnectorAgent* const agent = new ConnectorAgent(tag_search, infoFactory);
+    removeShadowed(m_connectorAgents, agent->tagSearch, infoFactory);
+    m_connectorAgents.push_back(agent);
+}
+
+void tgBuildSpec::setSelfCollision(std::string tag_search, bool enabled)
+{
+    m_selfCollision.push_back(std::make_pair(tgTagSearch(tag_search), enabled));
 }
 
+bool tgBuildSpec::selfCollides(const tgTags& tags) const
+{
+    for (std::size_t i = m_selfCollision.size(); i > 0; i--) {
+        if (m_selfCollision[i - 1].first.matches(tags)) {
+            return m_selfCollision[i - 1].second;
+        }
+    }
+    return true;
+}
@@ -27,6 +27,7 @@
 #ifndef TG_BUILD_SPEC_H
 #define TG_BUILD_SPEC_H
 
+#include <utility>
 #include <vector>
 
 #include "core/tgTagSearch.h"
@@ -74,6 +75,17 @@ public:
     tgBuildSpec() {}
     virtual ~tgBuildSpec();
 
+    /**
+     * Add a builder for elements matching tag_search. Builders added later
+     * take precedence. Replaces an earlier builder of the same class with
+     * the same search, since that one could no longer match anything.
+     */
+    /**
+     * Delete the agents and their info factories, and forget the self
+     * collision settings, once the structures are built.
+     */
+    void clear();
+
     void addBuilder(std::string tag_search, tgRigidInfo* infoFactory);
     
     void addBuilder(std::string tag_search, tgConnectorInfo* infoFactory);
@@ -87,10 +99,24 @@ public:
     {
         return m_connectorAgents;
     }
+
+    /**
+     * Let the rigids matching tag_search collide with the other such
+     * rigids of the same build, or stop them. Later searches take
+     * precedence; rigids no search matches collide as usual.
+     */
+    void setSelfCollision(std::string tag_search, bool enabled);
+
+    /**
+     * @return false if a rigid with these tags is kept from colliding
+     * with the others of its build that also don't self collide
+     */
+    bool selfCollides(const tgTags& tags) const;
     
 private:
     std::vector<RigidAgent*> m_rigidAgents;
     std::vector<ConnectorAgent*> m_connectorAgents;  
+    std::vector<std::pair<tgTagSearch, bool> > m_selfCollision;
 };
 
 #endif
@@ -25,8 +25,15 @@
  */
 #include "tgCompoundRigidInfo.h"
 
-tgCompoundRigidInfo::tgCompoundRigidInfo() : m_compoundShape(NULL), tgRigidInfo()
+tgCompoundRigidInfo::tgCompoundRigidInfo() :
+    tgRigidInfo(),
+    m_compoundShape(NULL),
+    m_massPropertiesValid(false),
+    m_mass(0.0),
+    m_centerOfMass(0.0, 0.0, 0.0),
+    m_principalInertia(0.0, 0.0, 0.0)
 {
+    m_principal.setIdentity();
 }
 
 tgModel* tgCompoundRigidInfo::createModel(tgWorld& world)
@@ -42,38 +49,82 @@ tgModel* tgCompoundRigidInfo::createModel(tgWorld& world)
 void tgCompoundRigidInfo::addRigid(tgRigidInfo& rigid)
 {
     m_rigids.push_back(&rigid);
+    m_massPropertiesValid = false;
 }
-    
-btVector3 tgCompoundRigidInfo::getCenterOfMass() const
+
+void tgCompoundRigidInfo::updateMassProperties() const
 {
+    if (m_massPropertiesValid)
+    {
+        return;
+    }
+    m_mass = 0.0;
     btVector3 sum = btVector3(0.0, 0.0, 0.0);
     for (int ii = 0; ii < m_rigids.size(); ii++)
     {
         /* const */ tgRigidInfo * const rigid = m_rigids[ii];
-        sum += (rigid->getCenterOfMass() * rigid->getMass());
+        const double mass = rigid->getMass();
+        m_mass += mass;
+        sum += (rigid->getCenterOfMass() * mass);
     }
-    const double totalMass = getMass();
-    return
-      (totalMass == 0.0) ? btVector3(0.0, 0.0, 0.0) : (sum / totalMass);
+    m_centerOfMass =
+      (m_mass == 0.0) ? btVector3(0.0, 0.0, 0.0) : (sum / m_mass);
+    // Until the shape is made
+    m_principal.setIdentity();
+    m_principal.setOrigin(m_centerOfMass);
+    m_massPropertiesValid = true;
+}
+
+btVector3 tgCompoundRigidInfo::getCenterOfMass() const
+{
+    updateMassProperties();
+    return m_centerOfMass;
 }
-    
+
+btVector3 tgCompoundRigidInfo::getPrincipalInertia() const
+{
+    return m_principalInertia;
+}
+
 
 btCompoundShape* tgCompoundRigidInfo::createCompoundShape(tgWorld& world) const
 {
     if (m_compoundShape == 0)
     {
-        // Deallocated by the world implementation
-        m_compoundShape = new btCompoundShape(&world);
+        // Deallocated by the world implementation. The dynamic AABB tree
+        // lets contacts visit only the children they overlap
+        m_compoundShape = new btCompoundShape(true);
 
-        const btVector3 com = getCenterOfMass();
+        updateMassProperties();
+        const btVector3 com = m_centerOfMass;
 
         for (int ii = 0; ii < m_rigids.size(); ii++)
         {
             tgRigidInfo* const rigid = m_rigids[ii];
+            // A nested compound has its frame once it has its shape
+            btCollisionShape* const shape = rigid->getCollisionShape(world);
             btTransform t = rigid->getTransform();
             t.setOrigin(t.getOrigin() - com);
-            m_compoundShape->addChildShape(t, rigid->getCollisionShape(world));
-        }        
+            m_compoundShape->addChildShape(t, shape);
+        }
+
+        // Move the children into the frame of the principal axes, whose
+        // moments are then exact where calculateLocalInertia() would
+        // approximate the compound by its bounding box
+        if (m_mass > 0.0)
+        {
+            const btTransform principal = findPrincipalAxes(world);
+            const btTransform toPrincipal = principal.inverse();
+            for (int ii = 0; ii < m_compoundShape->getNumChildShapes(); ii++)
+            {
+                m_compoundShape->updateChildTransform(ii,
+                    toPrincipal * m_compoundShape->getChildTransform(ii),
+                    false);
+            }
+            m_compoundShape->recalculateLocalAabb();
+            m_principal = principal;
+            m_principal.setOrigin(com + principal.getOrigin());
+        }
         // Add the collision shape to the array so we can delete it later
         tgWorldBulletPhysicsImpl& bulletWorld =
           (tgWorldBulletPhysicsImpl&)world.implementation();
@@ -83,6 +134,70 @@ btCompoundShape* tgCompoundRigidInfo::createCompoundShape(tgWorld& world) const
     return m_compoundShape;
 }
 
+btTransform tgCompoundRigidInfo::findPrincipalAxes(tgWorld& world) const
+{
+    // As btCompoundShape::calculatePrincipalAxisTransform(), but with the
+    // moments each component gives, which need not be its shape's
+    btMatrix3x3 tensor(0, 0, 0, 0, 0, 0, 0, 0, 0);
+    btVector3 center(0.0, 0.0, 0.0);
+    for (int ii = 0; ii < m_compoundShape->getNumChildShapes(); ii++)
+    {
+        center += m_compoundShape->getChildTransform(ii).getOrigin() *
+            m_rigids[ii]->getMass();
+    }
+    center /= m_mass;
+
+    for (int ii = 0; ii < m_compoundShape->getNumChildShapes(); ii++)
+    {
+        tgRigidInfo* const rigid = m_rigids[ii];
+        const double mass = rigid->getMass();
+        btVector3 i;
+        if (!rigid->getLocalInertia(world, i))
+        {
+            m_compoundShape->getChildShape(ii)->calculateLocalInertia(mass, i);
+        }
+        const btTransform& t = m_compoundShape->getChildTransform(ii);
+        const btVector3 o = t.getOrigin() - center;
+
+        // The component's tensor, rotated into the compound's frame
+        btMatrix3x3 j = t.getBasis().transpose();
+        j[0] *= i[0];
+        j[1] *= i[1];
+        j[2] *= i[2];
+        j = t.getBasis() * j;
+        tensor[0] += j[0];
+        tensor[1] += j[1];
+        tensor[2] += j[2];
+
+        // Moved to the center of mass
+        const double o2 = o.length2();
+        j[0].setValue(o2, 0, 0);
+        j[1].setValue(0, o2, 0);
+        j[2].setValue(0, 0, o2);
+        j[0] += o * -o.x();
+        j[1] += o * -o.y();
+        j[2] += o * -o.z();
+        tensor[0] += j[0] * mass;
+        tensor[1] += j[1] * mass;
+        tensor[2] += j[2] * mass;
+    }
+
+    btTransform principal;
+    principal.setIdentity();
+    tensor.diagonalize(principal.getBasis(), 0.00001, 20);
+    principal.setOrigin(center);
+    m_principalInertia.setValue(tensor[0][0], tensor[1][1], tensor[2][2]);
+    return principal;
+}
+
+bool tgCompoundRigidInfo::getLocalInertia(tgWorld& world,
+                                          btVector3& inertia) const
+{
+    getCollisionShape(world);
+    inertia = m_principalInertia;
+    return m_mass > 0.0;
+}
+
 btCollisionShape* tgCompoundRigidInfo::getCollisionShape(tgWorld& world) const
 {
     if (m_compoundShape == 0)
@@ -94,21 +209,14 @@ btCollisionShape* tgCompoundRigidInfo::getCollisionShape(tgWorld& world) const
 
 btTransform tgCompoundRigidInfo::getTransform() const
 {
-    btTransform t;
-    t.setIdentity();
-    t.setOrigin(getCenterOfMass());
-    return t;
+    updateMassProperties();
+    return m_principal;
 }
     
 double tgCompoundRigidInfo::getMass() const
 {
-    /// @todo Use std::accumulate()
-    double mass = 0.0;
-    for (int ii = 0; ii < m_rigids.size(); ii++)
-    {
-        mass += m_rigids[ii]->getMass();
-    }
-    return mass;
+    updateMassProperties();
+    return m_mass;
 }
 
 btRigidBody* tgCompoundRigidInfo::getRigidBody()
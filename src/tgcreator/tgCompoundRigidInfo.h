@@ -40,8 +40,7 @@ class tgCompoundRigidInfo : public tgRigidInfo
     /**
      * The null constructor is the default constructor.
      * @todo Require both m_rigidBody and m_rigids to be supplied in the
-     * constructor. Initialize m_compoundShape, store mass and center of mass
-     * in member variables.
+     * constructor and initialize m_compoundShape there.
      */
     tgCompoundRigidInfo();
 
@@ -60,7 +59,7 @@ class tgCompoundRigidInfo : public tgRigidInfo
     /**
      * Insert a pointer to the supplied tgRigidInfo into a container.
      * The tgCompoundRigidInfo does not assume ownership of the tgRigidInfo, and must not
-     * deallocate it.
+     * deallocate it. Forgets the mass properties found so far.
      * @param[in,out] rigit a tgRigidInfo
      * @todo Get rid of this. Require all m_rigids to be supplied in the
      * constructor.
@@ -72,15 +71,26 @@ class tgCompoundRigidInfo : public tgRigidInfo
      * @return the center of mass of all the tgRigidInfo objects in the tree
      * @retval a zero vector if the mass is zero
      * @todo Make this const here and in all base classes and derived classes.
-     * @todo Make rigid const when tgCompoundRigidInfo::getCenterOfMass() is const.
-     * @todo If all m_rigids are supplied in the constructor, this can be
-     * calculated in the constructor and cashed as a const member variable.
+     * Found once, with the mass and the principal inertia.
      */
     virtual btVector3 getCenterOfMass() const;
     
+    /**
+     * Return the principal moments of inertia about the center of mass.
+     * @return the local inertia of the compound's btRigidBody
+     */
+    btVector3 getPrincipalInertia() const;
+
+    /**
+     * Return the principal moments in place of the bounding box estimate
+     * of btCompoundShape, making the shape if needed.
+     */
+    virtual bool getLocalInertia(tgWorld& world, btVector3& inertia) const;
+
     /**
      * Return a pointer to the corresponding btCollisionShape, lazily creating
-     * it if it does not exist..
+     * it if it does not exist. The children are placed in the frame of the
+     * principal axes.
      * @return  a pointer to the corresponding btCollisionShape
      */
     btCompoundShape* createCompoundShape(tgWorld& world) const;
@@ -92,8 +102,8 @@ class tgCompoundRigidInfo : public tgRigidInfo
     virtual btCollisionShape* getCollisionShape(tgWorld& world) const;
 
     /**
-     * Return an identity btTransform with the origin being the center of mass.
-     * @return an identity btTransform with the origin being the center of mass
+     * Return the frame of the principal axes of inertia.
+     * @return a btTransform with the origin being the center of mass
      */
     virtual btTransform getTransform() const;
     
@@ -101,8 +111,6 @@ class tgCompoundRigidInfo : public tgRigidInfo
      * Return the compound's mass.
      * The mass is the sum of the masses of all the tgRigidInfo objects in the
      * compound.
-     * @todo Do this in the constructor and cache the result as a member
-     * variable.
      */
     virtual double getMass() const;
 
@@ -203,6 +211,19 @@ class tgCompoundRigidInfo : public tgRigidInfo
 
 protected:
 
+    /**
+     * Find the mass, center of mass and principal axes of the components,
+     * unless they have been found since the last addRigid().
+     */
+    void updateMassProperties() const;
+
+    /**
+     * Find the principal axes of the children of m_compoundShape, in its
+     * frame, and their moments.
+     * @return the frame of the principal axes
+     */
+    btTransform findPrincipalAxes(tgWorld& world) const;
+
     /**
      * A collection of tgRigidInfo pointers, each supplied by the client.
      * @todo Change this to std::set to prevent duplication.
@@ -215,6 +236,18 @@ protected:
      */
     mutable btCompoundShape * m_compoundShape;
 
+    /** True if the members below describe m_rigids */
+    mutable bool m_massPropertiesValid;
+
+    mutable double m_mass;
+
+    mutable btVector3 m_centerOfMass;
+
+    /** The principal axes, about the center of mass */
+    mutable btTransform m_principal;
+
+    mutable btVector3 m_principalInertia;
+
 };
 
 
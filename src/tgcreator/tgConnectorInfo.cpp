@@ -59,7 +59,7 @@ std::vector<tgConnectorInfo*> tgConnectorInfo::createConnectorInfos(const tgPair
     return result;
 }
 
-void tgConnectorInfo::chooseRigids(std::set<tgRigidInfo*> rigids) 
+void tgConnectorInfo::chooseRigids(const std::set<tgRigidInfo*>& rigids) 
 {
 
     // @todo: find and set pointers to appropriate rigids from the set provided. 
@@ -79,7 +79,7 @@ void tgConnectorInfo::chooseRigids(std::set<tgRigidInfo*> rigids)
     }
 }
 
-tgRigidInfo* tgConnectorInfo::chooseRigid(std::set<tgRigidInfo*> rigids, const btVector3& v) {
+tgRigidInfo* tgConnectorInfo::chooseRigid(const std::set<tgRigidInfo*>& rigids, const btVector3& v) {
 
     std::set<tgRigidInfo*> candidateRigids = findRigidsContaining(rigids, v);
     
@@ -160,11 +160,11 @@ btRigidBody* tgConnectorInfo::getFromRigidBody() {
 // Protected:
 
 
-tgRigidInfo* tgConnectorInfo::findClosestCenterOfMass(std::set<tgRigidInfo*> rigids, const btVector3& v) {
+tgRigidInfo* tgConnectorInfo::findClosestCenterOfMass(const std::set<tgRigidInfo*>& rigids, const btVector3& v) {
     if (rigids.size() == 0) {
         return NULL;
     }
-    std::set<tgRigidInfo*>::iterator it;
+    std::set<tgRigidInfo*>::const_iterator it;
     it = rigids.begin();
     tgRigidInfo* closest = *it;  // First member
     it++;
@@ -178,9 +178,9 @@ tgRigidInfo* tgConnectorInfo::findClosestCenterOfMass(std::set<tgRigidInfo*> rig
 }
 
 
-std::set<tgRigidInfo*> tgConnectorInfo::findRigidsContaining(std::set<tgRigidInfo*> rigids, const btVector3& toFind) {
+std::set<tgRigidInfo*> tgConnectorInfo::findRigidsContaining(const std::set<tgRigidInfo*>& rigids, const btVector3& toFind) {
     std::set<tgRigidInfo*> found;
-    std::set<tgRigidInfo*>::iterator it;
+    std::set<tgRigidInfo*>::const_iterator it;
     for(it=rigids.begin(); it != rigids.end(); ++it) {
         if ((*it)->containsNode(toFind)) {
             found.insert(*it);
@@ -190,9 +190,9 @@ std::set<tgRigidInfo*> tgConnectorInfo::findRigidsContaining(std::set<tgRigidInf
 };
 
 // @todo: Remove this? Is it used by anything? It's protected...
-bool tgConnectorInfo::rigidFoundIn(std::set<tgRigidInfo*> rigids, tgRigidInfo* rigid) {
+bool tgConnectorInfo::rigidFoundIn(const std::set<tgRigidInfo*>& rigids, tgRigidInfo* rigid) {
     //return (std::find(rigids.begin(), rigids.end(), rigid) != rigids.end()); // Doesn't work on some compilers (RDA 2014-Jan-28)
-    std::set<tgRigidInfo*>::iterator it;
+    std::set<tgRigidInfo*>::const_iterator it;
     for(it = rigids.begin(); it != rigids.end(); ++it) {
         if(*it == rigid) 
             return true;
@@ -147,28 +147,27 @@ public:
     
     
     // Choose the appropriate rigids for the connector and give the connector pointers to them
-    virtual void chooseRigids(std::set<tgRigidInfo*> rigids);
+    virtual void chooseRigids(const std::set<tgRigidInfo*>& rigids);
 
     // @todo: in the process of switching ti std::vector for these...
-    virtual void chooseRigids(std::vector<tgRigidInfo*> rigids) 
+    virtual void chooseRigids(const std::vector<tgRigidInfo*>& rigids) 
     {
-        std::set<tgRigidInfo*> s;
-        s.insert(rigids.begin(), rigids.end());
+        const std::set<tgRigidInfo*> s(rigids.begin(), rigids.end());
         chooseRigids(s);
     }
 
     
-    tgRigidInfo* chooseRigid(std::set<tgRigidInfo*> rigids, const btVector3& v);
+    tgRigidInfo* chooseRigid(const std::set<tgRigidInfo*>& rigids, const btVector3& v);
     
     
 protected:
-    tgRigidInfo* findClosestCenterOfMass(std::set<tgRigidInfo*> rigids, const btVector3& v);
+    tgRigidInfo* findClosestCenterOfMass(const std::set<tgRigidInfo*>& rigids, const btVector3& v);
 
     // @todo: should this be protected/private?
-    std::set<tgRigidInfo*> findRigidsContaining(std::set<tgRigidInfo*> rigids, const btVector3& toFind);
+    std::set<tgRigidInfo*> findRigidsContaining(const std::set<tgRigidInfo*>& rigids, const btVector3& toFind);
     
     // @todo: Remove this? Is it used by anything?
-    bool rigidFoundIn(std::set<tgRigidInfo*> rigids, tgRigidInfo* rigid);
+    bool rigidFoundIn(const std::set<tgRigidInfo*>& rigids, tgRigidInfo* rigid);
     
     
     // Step 1: Define the points that we're connecting
@@ -0,0 +1,111 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgCordeCableInfo.cpp
+ * @brief Implementation of class tgCordeCableInfo
+ * $Id$
+ */
+
+#include "tgCordeCableInfo.h"
+
+#include "core/tgBulletUtil.h"
+#include "core/tgBulletSpringCableAnchor.h"
+
+#include "tgcreator/tgNode.h"
+
+// The Bullet Physics Library
+#include "btBulletDynamicsCommon.h"
+
+// The C++ Standard Library
+#include <cmath>
+
+tgCordeCableInfo::tgCordeCableInfo(const tgBasicActuator::Config& config,
+                                   const tgCordeCable::Config& cordeConfig) :
+tgConnectorInfo(),
+m_cordeCable(NULL),
+m_config(config),
+m_cordeConfig(cordeConfig)
+{}
+
+tgCordeCableInfo::tgCordeCableInfo(const tgBasicActuator::Config& config,
+                                   const tgCordeCable::Config& cordeConfig,
+                                   tgTags tags) :
+tgConnectorInfo(tags),
+m_cordeCable(NULL),
+m_config(config),
+m_cordeConfig(cordeConfig)
+{}
+
+tgCordeCableInfo::tgCordeCableInfo(const tgBasicActuator::Config& config,
+                                   const tgCordeCable::Config& cordeConfig,
+                                   const tgPair& pair) :
+tgConnectorInfo(pair),
+m_cordeCable(NULL),
+m_config(config),
+m_cordeConfig(cordeConfig)
+{}
+
+tgConnectorInfo* tgCordeCableInfo::createConnectorInfo(const tgPair& pair)
+{
+    return new tgCordeCableInfo(m_config, m_cordeConfig, pair);
+}
+
+void tgCordeCableInfo::initConnector(tgWorld& world)
+{
+    // The cable's points are not in the world, only its anchors' bodies
+    m_cordeCable = createTgCordeCable(world);
+}
+
+tgModel* tgCordeCableInfo::createModel(tgWorld& world)
+{
+    // ensure connector has been initialized
+    assert(m_cordeCable);
+    return new tgBasicActuator(m_cordeCable, getTags(), m_config);
+}
+
+double tgCordeCableInfo::getMass()
+{
+    // Not part of any rigid body, but the points do have mass
+    const double length = (getFrom() - getTo()).length();
+    return m_cordeConfig.density * M_PI * m_cordeConfig.radius *
+        m_cordeConfig.radius * length;
+}
+
+tgCordeCable* tgCordeCableInfo::createTgCordeCable(tgWorld& world)
+{
+    btRigidBody* fromBody = getFromRigidBody();
+    btRigidBody* toBody = getToRigidBody();
+
+    tgNode from = getFromRigidInfo()->getConnectionPoint(getFrom(), getTo(), m_config.rotation);
+    tgNode to = getToRigidInfo()->getConnectionPoint(getTo(), getFrom(), m_config.rotation);
+
+    std::vector<tgBulletSpringCableAnchor*> anchorList;
+
+    tgBulletSpringCableAnchor* anchor1 = new tgBulletSpringCableAnchor(fromBody, from);
+    anchorList.push_back(anchor1);
+
+    tgBulletSpringCableAnchor* anchor2 = new tgBulletSpringCableAnchor(toBody, to);
+    anchorList.push_back(anchor2);
+
+    const btVector3 gravity =
+        tgBulletUtil::worldToDynamicsWorld(world).getGravity();
+
+    return new tgCordeCable(anchorList, m_config.stiffness, m_config.damping,
+                            m_config.pretension, m_cordeConfig, gravity);
+}
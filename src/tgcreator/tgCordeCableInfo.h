@@ -0,0 +1,90 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgCordeCableInfo.h
+ * @brief Definition of class tgCordeCableInfo
+ * $Id$
+ */
+
+#ifndef SRC_TGCREATOR_TG_CORDE_CABLE_INFO_H
+#define SRC_TGCREATOR_TG_CORDE_CABLE_INFO_H
+
+#include "tgcreator/tgConnectorInfo.h"
+
+#include "core/tgBasicActuator.h"
+#include "core/tgCordeCable.h"
+#include "core/tgTags.h"
+
+/**
+ * Builds tgBasicActuators whose spring cable is a tgCordeCable, for a
+ * pair of nodes as tgBasicActuatorInfo does. The cable's stiffness,
+ * damping and pretension come from the actuator's config, the rest of
+ * its material from the Corde config, and its gravity from the world.
+ */
+class tgCordeCableInfo : public tgConnectorInfo
+{
+public:
+
+    /**
+     * Construct a tgCordeCableInfo with just the configs. The pair must be
+     * filled in later, or factory methods can be used to create instances
+     * with pairs.
+     */
+    tgCordeCableInfo(const tgBasicActuator::Config& config,
+                     const tgCordeCable::Config& cordeConfig);
+
+    /** As above, with tags */
+    tgCordeCableInfo(const tgBasicActuator::Config& config,
+                     const tgCordeCable::Config& cordeConfig,
+                     tgTags tags);
+
+    /** As above, with a pair */
+    tgCordeCableInfo(const tgBasicActuator::Config& config,
+                     const tgCordeCable::Config& cordeConfig,
+                     const tgPair& pair);
+
+    virtual ~tgCordeCableInfo() {}
+
+    /**
+     * Create a tgConnectorInfo* from a tgPair
+     */
+    virtual tgConnectorInfo* createConnectorInfo(const tgPair& pair);
+
+    void initConnector(tgWorld& world);
+
+    virtual tgModel* createModel(tgWorld& world);
+
+    /** @return the mass of the cable's points */
+    double getMass();
+
+protected:
+    tgCordeCable* m_cordeCable;
+
+private:
+
+    tgCordeCable* createTgCordeCable(tgWorld& world);
+
+private:
+
+    tgBasicActuator::Config m_config;
+
+    tgCordeCable::Config m_cordeConfig;
+};
+
+#endif // SRC_TGCREATOR_TG_CORDE_CABLE_INFO_H
@@ -27,7 +27,7 @@
 #include "tgNodes.h"
 #include "tgPair.h"
 
-tgPair tgNodes::pair(int from, int to, std::string tags)
+tgPair tgNodes::pair(int from, int to, const std::string& tags)
 {
     std::vector<tgNode>& nodes = getNodes();
     return tgPair(nodes[from], nodes[to], tags);
@@ -56,17 +56,26 @@ public:
     {
     }
 
+    /** Remove every node and name, and give back their storage. */
+    void clear()
+    {
+        tgTaggables<tgNode>::clear();
+        m_names.clear();
+    }
+
     /**
      * Create a set of nodes given a vector of btVector3.
      * @param[in] nodes a vector of btVector3; the elements must be unique
      * @author Lee Brownston
      * @date Wed 26 Feb 2014
      */
-    tgNodes(std::vector<btVector3>& nodes) : tgTaggables()
+    tgNodes(const std::vector<btVector3>& nodes) : tgTaggables()
     {
         // All elements must be unique
         assertUniqueElements("All nodes must be unique.");
 
+        reserveElements(nodes.size());
+
         // @todo: There has to be a better way to do this (maybe initializer lists with upcasting btVector3 => tgNode?) 
         for(std::size_t i = 0; i < nodes.size(); i++) {
             addElement(tgNode(nodes[i]));
@@ -74,7 +83,7 @@ public:
         
     }
      
-    tgNodes(std::vector<tgNode>& nodes) : tgTaggables(nodes) {
+    tgNodes(const std::vector<tgNode>& nodes) : tgTaggables(nodes) {
         // All elements must be unique
         assertUniqueElements("All nodes must be unique.");
         
@@ -130,7 +139,7 @@ public:
         return addNode(tgNode(node));
     };
 
-    int addNode(const btVector3& node, std::string tags) {
+    int addNode(const btVector3& node, const std::string& tags) {
         return addNode(tgNode(node, tags));
     };
     
@@ -156,7 +165,7 @@ public:
         return addNode(node);
     }
 
-    int addNode(double x, double y, double z, std::string tags)
+    int addNode(double x, double y, double z, const std::string& tags)
     {
         const tgNode node(x, y, z, tags);
         return addNode(node);
@@ -165,7 +174,7 @@ public:
     /**
      * Create a tgPair by connecting two contained nodes
      */
-    tgPair pair(int from, int to, std::string tags = "");
+    tgPair pair(int from, int to, const std::string& tags = "");
 
     /**
      * Add the given btVector3 to all btVector3 objects in elements.
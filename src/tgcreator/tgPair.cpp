@@ -37,10 +37,10 @@ tgPair::tgPair() : tgTaggable() {}
  * @param[in] to a btVector3
  * @todo Is it OK for from == to, either the same object or the same value?
  */
-tgPair::tgPair(btVector3 from, btVector3 to) : m_pair(from, to), tgTaggable() 
+tgPair::tgPair(const btVector3& from, const btVector3& to) : m_pair(from, to), tgTaggable() 
 {}
 
-tgPair::tgPair(btVector3 from, btVector3 to, std::string tags) : m_pair(from, to), tgTaggable(tags) 
+tgPair::tgPair(const btVector3& from, const btVector3& to, const std::string& tags) : m_pair(from, to), tgTaggable(tags) 
 {}
     
 /**
@@ -65,7 +65,7 @@ const btVector3& tgPair::getFrom() const
  * Set the from (first) member of the pair.
  * @param[in] from the to (first) member of the pair
  */
-void tgPair::setFrom(btVector3 from) { m_pair.first = from; }
+void tgPair::setFrom(const btVector3& from) { m_pair.first = from; }
 
 /**
 * Return the to (second) member of the pair.
@@ -89,7 +89,7 @@ const btVector3& tgPair::getTo() const
  * Set the to (second) member of the pair.
  * @param[in] to the to (second) member of the pair
  */
-void tgPair::setTo(btVector3 to) 
+void tgPair::setTo(const btVector3& to) 
 { 
     m_pair.second = to; 
 }
@@ -57,9 +57,9 @@ public:
      * @param[in] to a btVector3
      * @todo Is it OK for from == to, either the same object or the same value?
      */
-    tgPair(btVector3 from, btVector3 to);
+    tgPair(const btVector3& from, const btVector3& to);
 
-    tgPair(btVector3 from, btVector3 to, std::string tags);
+    tgPair(const btVector3& from, const btVector3& to, const std::string& tags);
         
    /**
     * Return the from (first) member of the pair.
@@ -75,7 +75,7 @@ public:
      * Set the from (first) member of the pair.
      * @param[in] from the to (first) member of the pair
      */
-    void setFrom(btVector3 from);
+    void setFrom(const btVector3& from);
     
    /**
     * Return the to (second) member of the pair.
@@ -91,7 +91,7 @@ public:
      * Set the to (second) member of the pair.
      * @param[in] to the to (second) member of the pair
      */
-    void setTo(btVector3 to);
+    void setTo(const btVector3& to);
     
     void addRotation(const btVector3& fixedPoint,
                      const btVector3& axis,
@@ -42,8 +42,9 @@ public:
     tgPairs() : tgTaggables() {}
     
     // tgPairs(std::vector<tgPair>& pairs) : tgTaggables(pairs) { // @todo: Fix this -- casting is a problem...
-    tgPairs(std::vector<tgPair>& pairs) : tgTaggables() {
+    tgPairs(const std::vector<tgPair>& pairs) : tgTaggables() {
         // @todo: make sure each pair is unique
+        reserveElements(pairs.size());
         for(std::size_t i = 0; i < pairs.size(); i++) {
             addElement(pairs[i]);
         }
@@ -87,7 +88,7 @@ public:
         removeElement(pair);
     }
 
-    void setPair(int key, tgPair pair) {
+    void setPair(int key, const tgPair& pair) {
         setElement(key, pair);
     }
 
@@ -146,7 +147,7 @@ public:
         return *this;
     }
 
-    tgPairs& operator-=(const std::vector<tgPair*> other) {
+    tgPairs& operator-=(const std::vector<tgPair*>& other) {
         this->removeElements(other);
         return *this;
     }
@@ -0,0 +1,195 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgRBChainInfo.cpp
+ * @brief Implementation of class tgRBChainInfo
+ * $Id$
+ */
+
+#include "tgRBChainInfo.h"
+
+#include "core/tgBulletSpringCable.h"
+#include "core/tgBulletSpringCableAnchor.h"
+#include "core/tgBulletUtil.h"
+#include "core/tgWorld.h"
+#include "core/tgString.h"
+
+#include "tgcreator/tgNode.h"
+#include "tgcreator/tgPair.h"
+#include "tgcreator/tgRodInfo.h"
+
+// The Bullet Physics Library
+#include "btBulletDynamicsCommon.h"
+
+// The C++ Standard Library
+#include <cassert>
+#include <stdexcept>
+
+namespace
+{
+    /** The actuators at the ends are in series, so each is twice as stiff */
+    tgBasicActuator::Config endConfig(const tgBasicActuator::Config& config)
+    {
+        tgBasicActuator::Config result(config);
+        result.stiffness *= 2.0;
+        result.damping *= 2.0;
+        return result;
+    }
+}
+
+tgRBChainInfo::tgRBChainInfo(const tgRBChain::Config& config) :
+tgConnectorInfo(),
+m_config(config),
+m_endConfig(endConfig(config.cableConfig)),
+m_chainLength(0.0)
+{
+    m_endCables[0] = m_endCables[1] = NULL;
+}
+
+tgRBChainInfo::tgRBChainInfo(const tgRBChain::Config& config, tgTags tags) :
+tgConnectorInfo(tags),
+m_config(config),
+m_endConfig(endConfig(config.cableConfig)),
+m_chainLength(0.0)
+{
+    m_endCables[0] = m_endCables[1] = NULL;
+}
+
+tgRBChainInfo::tgRBChainInfo(const tgRBChain::Config& config, const tgPair& pair) :
+tgConnectorInfo(pair),
+m_config(config),
+m_endConfig(endConfig(config.cableConfig)),
+m_chainLength(0.0)
+{
+    m_endCables[0] = m_endCables[1] = NULL;
+}
+
+tgRBChainInfo::~tgRBChainInfo()
+{
+    for (std::size_t i = 0; i < m_segments.size(); i++)
+    {
+        delete m_segments[i];
+    }
+}
+
+tgConnectorInfo* tgRBChainInfo::createConnectorInfo(const tgPair& pair)
+{
+    return new tgRBChainInfo(m_config, pair);
+}
+
+void tgRBChainInfo::initConnector(tgWorld& world)
+{
+    btRigidBody* fromBody = getFromRigidBody();
+    btRigidBody* toBody = getToRigidBody();
+
+    const btVector3 from = getFrom();
+    const btVector3 to = getTo();
+    const double length = (to - from).length();
+    if (length <= 0.0)
+    {
+        throw std::invalid_argument("A chain needs two distinct points");
+    }
+    const btVector3 direction = (to - from) / length;
+
+    // The chain is centered, leaving the same gap at each end
+    const std::size_t n = m_config.segments;
+    m_chainLength = m_config.chainFraction * length;
+    const double gap = (length - m_chainLength) / 2.0;
+    const btVector3 start = from + direction * gap;
+    const btVector3 step = direction * (m_chainLength / n);
+
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const tgPair pair(start + step * i, start + step * (i + 1),
+                          tgString("segment", i + 1));
+        tgRodInfo* const pSegment = new tgRodInfo(m_config.rodConfig, pair);
+        pSegment->initRigidBody(world);
+        m_segments.push_back(pSegment);
+    }
+
+    // Neighbours share a pivot and don't collide with each other
+    btDynamicsWorld& dynamicsWorld = tgBulletUtil::worldToDynamicsWorld(world);
+    for (std::size_t i = 1; i < n; i++)
+    {
+        btRigidBody& bodyA = *m_segments[i - 1]->getRigidBody();
+        btRigidBody& bodyB = *m_segments[i]->getRigidBody();
+        const btVector3 pivot = start + step * i;
+        btTypedConstraint* const pJoint =
+            new btPoint2PointConstraint(bodyA, bodyB,
+                bodyA.getWorldTransform().inverse() * pivot,
+                bodyB.getWorldTransform().inverse() * pivot);
+        dynamicsWorld.addConstraint(pJoint, true);
+        m_joints.push_back(pJoint);
+    }
+
+    m_endCables[0] = createEndCable(fromBody, from,
+                                    m_segments.front()->getRigidBody(), start);
+    m_endCables[1] = createEndCable(m_segments.back()->getRigidBody(),
+                                    start + step * n, toBody, to);
+    m_endCables[0]->setStepStamp(world.getStepStamp());
+    m_endCables[1]->setStepStamp(world.getStepStamp());
+}
+
+tgModel* tgRBChainInfo::createModel(tgWorld& world)
+{
+    // ensure connector has been initialized
+    assert(m_endCables[0] && m_endCables[1]);
+
+    std::vector<tgRod*> segments;
+    for (std::size_t i = 0; i < m_segments.size(); i++)
+    {
+        segments.push_back(static_cast<tgRod*>(m_segments[i]->createModel(world)));
+    }
+    tgBasicActuator* const first =
+        new tgBasicActuator(m_endCables[0], getTags() + tgTags("end 1"), m_endConfig);
+    tgBasicActuator* const last =
+        new tgBasicActuator(m_endCables[1], getTags() + tgTags("end 2"), m_endConfig);
+
+    tgRBChain* const pChain = new tgRBChain(world, getTags(), segments,
+                                            first, last, m_joints,
+                                            m_chainLength);
+    m_joints.clear();
+    m_endCables[0] = m_endCables[1] = NULL;
+    return pChain;
+}
+
+double tgRBChainInfo::getMass()
+{
+    // The segments are rigid bodies of their own, not part of the pair's
+    const double radius = m_config.rodConfig.radius;
+    const double length = m_config.chainFraction * (getFrom() - getTo()).length();
+    return m_config.rodConfig.density * M_PI * radius * radius * length;
+}
+
+tgBulletSpringCable* tgRBChainInfo::createEndCable(btRigidBody* fromBody,
+                                                   const btVector3& from,
+                                                   btRigidBody* toBody,
+                                                   const btVector3& to) const
+{
+    std::vector<tgBulletSpringCableAnchor*> anchorList;
+    anchorList.push_back(new tgBulletSpringCableAnchor(fromBody, from));
+    anchorList.push_back(new tgBulletSpringCableAnchor(toBody, to));
+
+    tgBulletSpringCable* const cable =
+        new tgBulletSpringCable(anchorList, m_endConfig.stiffness,
+                                m_endConfig.damping, m_endConfig.pretension);
+    cable->setSubsteps(m_endConfig.substeps);
+    cable->setSleepThresholds(m_endConfig.sleepTension, m_endConfig.sleepVelocity);
+    return cable;
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgRBChainInfo.h
+ * @brief Definition of class tgRBChainInfo
+ * $Id$
+ */
+
+#ifndef SRC_TGCREATOR_TG_RB_CHAIN_INFO_H
+#define SRC_TGCREATOR_TG_RB_CHAIN_INFO_H
+
+#include "tgcreator/tgConnectorInfo.h"
+
+#include "core/tgRBChain.h"
+#include "core/tgTags.h"
+
+// The C++ Standard Library
+#include <vector>
+
+class btTypedConstraint;
+class tgBulletSpringCable;
+class tgRodInfo;
+
+/**
+ * Builds a tgRBChain for a pair of nodes: the segments are laid out
+ * along the middle of the pair and joined with ball joints, and each end
+ * of the chain is joined to its body by a tgBasicActuator with twice the
+ * stiffness and damping of the config, so that the string as a whole
+ * has the config's.
+ */
+class tgRBChainInfo : public tgConnectorInfo
+{
+public:
+
+    /**
+     * Construct a tgRBChainInfo with just a config. The pair must be
+     * filled in later, or factory methods can be used to create instances
+     * with pairs.
+     */
+    tgRBChainInfo(const tgRBChain::Config& config);
+
+    /** As above, with tags */
+    tgRBChainInfo(const tgRBChain::Config& config, tgTags tags);
+
+    /** As above, with a pair */
+    tgRBChainInfo(const tgRBChain::Config& config, const tgPair& pair);
+
+    /** Deletes the segments' infos; the world has their bodies */
+    virtual ~tgRBChainInfo();
+
+    /**
+     * Create a tgConnectorInfo* from a tgPair
+     */
+    virtual tgConnectorInfo* createConnectorInfo(const tgPair& pair);
+
+    /** Creates the segments' bodies, the joints and the end cables */
+    void initConnector(tgWorld& world);
+
+    virtual tgModel* createModel(tgWorld& world);
+
+    /** @return the mass of the segments */
+    double getMass();
+
+private:
+
+    /** @return a cable from a point on a body to a point on another */
+    tgBulletSpringCable* createEndCable(btRigidBody* fromBody,
+                                        const btVector3& from,
+                                        btRigidBody* toBody,
+                                        const btVector3& to) const;
+
+    tgRBChain::Config m_config;
+
+    /** The config of the end actuators */
+    tgBasicActuator::Config m_endConfig;
+
+    /** Owned */
+    std::vector<tgRodInfo*> m_segments;
+
+    /** Handed to the chain by createModel() */
+    std::vector<btTypedConstraint*> m_joints;
+
+    /** Handed to the end actuators by createModel() */
+    tgBulletSpringCable* m_endCables[2];
+
+    double m_chainLength;
+};
+
+#endif // SRC_TGCREATOR_TG_RB_CHAIN_INFO_H
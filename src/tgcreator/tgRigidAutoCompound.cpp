@@ -31,26 +31,28 @@
 #include "tgCompoundRigidInfo.h"
 // The C++ standard library
 #include <map>
-#include <cstdlib> // for random number generator
+#include <set>
 #include <sstream> // for string streams, tags.
 // Boost
-#include <boost/random/random_device.hpp> // used for the random compound tag hash
-#include <boost/random/uniform_int_distribution.hpp> // used for the random compound tag hash
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
 
 // Debugging
 #include <iostream>
 #include "tgUtil.h"
+#include "core/tgRandom.h"
 
 using namespace std;
 
     
 // @todo: we want to start using this and get rid of the set-based constructor, but until we can refactor...
-tgRigidAutoCompound::tgRigidAutoCompound(std::vector<tgRigidInfo*> rigids)
+tgRigidAutoCompound::tgRigidAutoCompound(const std::vector<tgRigidInfo*>& rigids) :
+    m_rigids(rigids.begin(), rigids.end())
 {
-    m_rigids.insert(m_rigids.end(), rigids.begin(), rigids.end());
 }
 
-tgRigidAutoCompound::tgRigidAutoCompound(std::deque<tgRigidInfo*> rigids) : m_rigids(rigids)
+tgRigidAutoCompound::tgRigidAutoCompound(const std::deque<tgRigidInfo*>& rigids) : m_rigids(rigids)
 {}
     
 std::vector< tgRigidInfo* > tgRigidAutoCompound::execute() {
@@ -58,6 +60,15 @@ std::vector< tgRigidInfo* > tgRigidAutoCompound::execute() {
     // Determine the grouping of our rigids
     groupRigids();
 
+    return execute(m_groups);
+};
+
+std::vector< tgRigidInfo* > tgRigidAutoCompound::execute(const std::vector< std::deque<tgRigidInfo*> >& groups) {
+
+    if (&groups != &m_groups) {
+        m_groups = groups;
+    }
+
     // Create the compounds as necessary
     createCompounds();
 
@@ -85,51 +96,121 @@ void tgRigidAutoCompound::setRigidInfoForGroup(tgRigidInfo* rigidInfo, std::dequ
     }
 }
 
-void tgRigidAutoCompound::groupRigids()
+namespace
 {
-    std::deque<tgRigidInfo*> ungrouped = std::deque<tgRigidInfo*>(m_rigids); // Copy of m_rigids
+    /**
+     * A node position, compared exactly the way sharesNodesWith compares
+     * nodes (btVector3::operator==)
+     */
+    struct NodeKey
+    {
+        NodeKey(const btVector3& v) :
+            // Adding zero folds -0.0 into 0.0, which operator== treats as equal
+            x(v.x() + 0.0), y(v.y() + 0.0), z(v.z() + 0.0)
+        {
+        }
+
+        bool operator==(const NodeKey& other) const
+        {
+            return x == other.x && y == other.y && z == other.z;
+        }
 
-    while(ungrouped.size() > 0) {
-        // go through each ungrouped element and find the groups for it
-        tgRigidInfo* elem = ungrouped[0]; // Note: the 0 element is removed by findGroup, so ungrouped[0] is different each iteration
+        btScalar x;
+        btScalar y;
+        btScalar z;
+    };
 
-        // Find all elements linked to the first item in ungrouped
-        // This will also remove the elements in the group from ungrouped
-        std::deque<tgRigidInfo*> group = findGroup(elem, ungrouped);
+    std::size_t hash_value(const NodeKey& key)
+    {
+        std::size_t seed = 0;
+        boost::hash_combine(seed, key.x);
+        boost::hash_combine(seed, key.y);
+        boost::hash_combine(seed, key.z);
+        return seed;
+    }
 
-        // Add the group to the groups list
-        m_groups.push_back(group);            
+    /** Union-find root lookup with path halving */
+    std::size_t findRoot(std::vector<std::size_t>& parent, std::size_t i)
+    {
+        while (parent[i] != i)
+        {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    void unite(std::vector<std::size_t>& parent, std::vector<std::size_t>& rank,
+               std::size_t a, std::size_t b)
+    {
+        a = findRoot(parent, a);
+        b = findRoot(parent, b);
+        if (a == b)
+        {
+            return;
+        }
+        if (rank[a] < rank[b])
+        {
+            std::swap(a, b);
+        }
+        parent[b] = a;
+        if (rank[a] == rank[b])
+        {
+            ++rank[a];
+        }
     }
 }
 
-// Find all rigids that should be in a group with the given rigid
-// @todo: This may contain an off-by-one error (the last rigid may not be grouped properly...)
-std::deque<tgRigidInfo*> tgRigidAutoCompound::findGroup(tgRigidInfo* rigid, std::deque<tgRigidInfo*>& ungrouped) {
+void tgRigidAutoCompound::groupRigids()
+{
+    // A rigid listed twice is grouped once, at its first position
+    std::vector<tgRigidInfo*> rigids;
+    boost::unordered_set<tgRigidInfo*> seen;
+    for (std::size_t i = 0; i < m_rigids.size(); ++i)
+    {
+        if (seen.insert(m_rigids[i]).second)
+        {
+            rigids.push_back(m_rigids[i]);
+        }
+    }
 
-    std::deque<tgRigidInfo*> group;
+    // Union every rigid with the first rigid seen at each of its nodes
+    std::vector<std::size_t> parent(rigids.size());
+    std::vector<std::size_t> rank(rigids.size(), 0);
+    for (std::size_t i = 0; i < rigids.size(); ++i)
+    {
+        parent[i] = i;
+    }
+    boost::unordered_map<NodeKey, std::size_t> firstAtNode;
+    for (std::size_t i = 0; i < rigids.size(); ++i)
+    {
+        const std::set<btVector3> nodes = rigids[i]->getContainedNodes();
+        for (std::set<btVector3>::const_iterator it = nodes.begin();
+             it != nodes.end(); ++it)
+        {
+            const std::pair<boost::unordered_map<NodeKey, std::size_t>::iterator, bool>
+                entry = firstAtNode.insert(std::make_pair(NodeKey(*it), i));
+            if (!entry.second)
+            {
+                unite(parent, rank, entry.first->second, i);
+            }
+        }
+    }
 
-    // Add the rigid to the current group
-    group.push_back(rigid);     
-    
-    // Remove the rigid from the ungrouped since it's now in a group
-    ungrouped.erase(std::remove(ungrouped.begin(), ungrouped.end(), rigid), ungrouped.end());
-    
-    // Recursively find linked elements
-    int i = 0;
-    while(i < ungrouped.size()) {
-        tgRigidInfo* other = ungrouped[i];
-        if(rigid->sharesNodesWith(*other)) {
-            std::deque<tgRigidInfo*> links = findGroup(other, ungrouped);
-            group.insert(group.end(), links.begin(), links.end());
-            i = 0;
-        } else {
-            i++;
+    // Number the groups in order of their first rigid
+    std::vector<int> groupOfRoot(rigids.size(), -1);
+    for (std::size_t i = 0; i < rigids.size(); ++i)
+    {
+        const std::size_t root = findRoot(parent, i);
+        if (groupOfRoot[root] < 0)
+        {
+            groupOfRoot[root] = m_groups.size();
+            m_groups.push_back(std::deque<tgRigidInfo*>());
         }
+        m_groups[groupOfRoot[root]].push_back(rigids[i]);
     }
+}
 
-    return group;
-};
-    
 void tgRigidAutoCompound::createCompounds() {
     for(int i=0; i < m_groups.size(); i++) {
         std::deque<tgRigidInfo*>& group = m_groups[i];
@@ -143,20 +224,22 @@ void tgRigidAutoCompound::createCompounds() {
     }
 }
 
-tgRigidInfo* tgRigidAutoCompound::createCompound(std::deque<tgRigidInfo*> rigids) {
+tgRigidInfo* tgRigidAutoCompound::createCompound(const std::deque<tgRigidInfo*>& rigids) {
     tgCompoundRigidInfo* c = new tgCompoundRigidInfo();
     // Add an additional tag to this compound rigid info.
     // This is of the form "compound_3qhA8L" for example.
     std::stringstream newtag;
-    newtag << "compound_" << random_tag_hash();
+    newtag << "compound_" << random_tag_hash(rigids);
+    // Parsed once for the whole group
+    const tgTags tags(newtag.str());
     for(int i = 0; i < rigids.size(); i++) {
-      rigids[i]->addTags(newtag.str());
+      rigids[i]->addTags(tags);
       c->addRigid(*rigids[i]);
     }
     return (tgRigidInfo*)c;
 }
 
-bool tgRigidAutoCompound::rigidBelongsIn(tgRigidInfo* rigid, std::deque<tgRigidInfo*> group) {
+bool tgRigidAutoCompound::rigidBelongsIn(tgRigidInfo* rigid, const std::deque<tgRigidInfo*>& group) {
     for(int i = 0; i < group.size(); i++) {
         tgRigidInfo* other = group[i];
         if(rigid->sharesNodesWith(*other))
@@ -165,43 +248,29 @@ bool tgRigidAutoCompound::rigidBelongsIn(tgRigidInfo* rigid, std::deque<tgRigidI
     return false;
 };
 
-std::string tgRigidAutoCompound::random_tag_hash() {
-  /**
-   * Many thanks to StackOverflow users Ates Goral and Mehrdad Afshari
-   * for a framework for this function.
-   * http://stackoverflow.com/questions/440133/how-do-i-create-a-random-alpha-numeric-string-in-c
-   *
-   * This function should generate a random string with a uniform distribution
-   * over the characters in the 'alphanum' char array below.
-   */
-  // Create the string (character array) to put the random characters into
-  size_t length = 6;
-  char s[length];
-
-  // The random number generator to pick characters out of the array
-  boost::random::random_device rng;
-
-  // A constant variable for the chracters that will be chosen from
+std::string tgRigidAutoCompound::random_tag_hash(const std::deque<tgRigidInfo*>& rigids) {
+  // Name the stream by the group's nodes, so the same structure gets the
+  // same tags in every world and run, whichever thread builds it first
+  std::size_t nodes = 0;
+  for (std::size_t i = 0; i < rigids.size(); ++i) {
+    const std::set<btVector3> contained = rigids[i]->getContainedNodes();
+    for (std::set<btVector3>::const_iterator it = contained.begin();
+         it != contained.end(); ++it) {
+      boost::hash_combine(nodes, NodeKey(*it));
+    }
+  }
+  tgRandom rng(tgRandom::eTags, nodes);
+
+  // The characters that will be chosen from, all with equal probability
   static const char alphanum[] =
     "0123456789"
     "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-    "0123456789"
     "abcdefghijklmnopqrstuvwxyz";
 
-  // A uniform distribution over the indices into the character array
-  boost::random::uniform_int_distribution<> alphanum_dist(0, sizeof(alphanum) - 1);
-
-  // Insert a random one of these characters into the array
-  // Thanks to the Boost library random number generator tutorial,
-  // http://www.boost.org/doc/libs/1_62_0/doc/html/boost_random/tutorial.html
-  for (int i = 0; i < length; ++i) {
-    //s[i] = alphanum[rand() % (sizeof(alphanum) - 1)];
-    s[i] = alphanum[ alphanum_dist(rng) ];
+  const std::size_t length = 6;
+  std::string s(length, '0');
+  for (std::size_t i = 0; i < length; ++i) {
+    s[i] = alphanum[rng.below(sizeof(alphanum) - 1)];
   }
-
-  // set the string termination character
-  s[length] = 0;
-
-  // Returning a character array is the same as returning a string.
   return s;
 }
@@ -48,9 +48,9 @@ public:
 
 public:       
     // @todo: we want to start using this and get rid of the set-based constructor, but until we can refactor...
-    tgRigidAutoCompound(std::vector<tgRigidInfo*> rigids);
+    tgRigidAutoCompound(const std::vector<tgRigidInfo*>& rigids);
     
-    tgRigidAutoCompound(std::deque<tgRigidInfo*> rigids);
+    tgRigidAutoCompound(const std::deque<tgRigidInfo*>& rigids);
     
     ~tgRigidAutoCompound()
     {
@@ -58,6 +58,14 @@ public:
     
     std::vector< tgRigidInfo* > execute();
 
+    /**
+     * Compound groups that are already known, such as those recorded in a
+     * tgBuildCache, instead of finding them.
+     * @param[in] groups every rigid given to the constructor, each in
+     * exactly one group
+     */
+    std::vector< tgRigidInfo* > execute(const std::vector< std::deque<tgRigidInfo*> >& groups);
+
 protected:
     
     // @todo: we probably don't need this any more -- this will be taken care of in the tgRigidInfo => tgModel step
@@ -66,31 +74,36 @@ protected:
    
     void setRigidInfoForGroup(tgRigidInfo* rigidInfo, std::deque<tgRigidInfo*>& group);
     
+    /**
+     * Fill m_groups with the sets of rigids that are linked through shared
+     * nodes. Each node position is looked up in a hash table and rigids that
+     * meet at a node are merged with union-find, so this is near linear in
+     * the number of nodes. Groups are ordered by their first rigid in
+     * m_rigids, and the rigids in a group keep m_rigids' order.
+     */
     void groupRigids();
 
-    // Find all rigids that should be in a group with the given rigid
-    // @todo: This may contain an off-by-one error (the last rigid may not be grouped properly...)
-    std::deque<tgRigidInfo*> findGroup(tgRigidInfo* rigid, std::deque<tgRigidInfo*>& ungrouped);
-
     /**
      * Creates tgCompoundRigidInfos for compounded bodies.
      * Also, adds tags to each of the consitutent tgRigidInfos 
      * that designate what compound each of the models will belong to.
      * These tags are in the form "compound_h8A0k2", where the second part
-     * is a random 6-digit alphanumeric hash via random_tag_hash().
+     * is a 6-digit alphanumeric hash via random_tag_hash().
      */
     void createCompounds();
     
-    tgRigidInfo* createCompound(std::deque<tgRigidInfo*> rigids);
+    tgRigidInfo* createCompound(const std::deque<tgRigidInfo*>& rigids);
     
-    bool rigidBelongsIn(tgRigidInfo* rigid, std::deque<tgRigidInfo*> group);
+    bool rigidBelongsIn(tgRigidInfo* rigid, const std::deque<tgRigidInfo*>& group);
 
     /**
      * For adding tags to compounded rigid bodies.
-     * This function generates a 6-digit alphanumeric hash.
+     * This function generates a 6-digit alphanumeric hash, drawn from the
+     * tgRandom stream of the group's node positions.
+     * @param[in] rigids the group to be compounded
      * @return a 6-character string of random alphanumberic characters.
      */
-    std::string random_tag_hash();
+    std::string random_tag_hash(const std::deque<tgRigidInfo*>& rigids);
     
     // Doesn't look like we own these
     std::deque<tgRigidInfo*> m_rigids;
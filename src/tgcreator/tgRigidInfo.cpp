@@ -36,6 +36,7 @@
 #include "tgUtil.h"
 #include "core/tgBulletUtil.h"
 #include "core/tgWorld.h"
+#include "core/tgWorldBulletPhysicsImpl.h"
 
 
 // The Bullet Physics library
@@ -107,16 +108,25 @@ void tgRigidInfo::initRigidBody(tgWorld& world)
             if (rigid->getRigidBody() == NULL) { // Init only if it doesn't have a btRigidBody (has already been initialized)
 
                 double mass = rigid->getMass();
-                btTransform transform = rigid->getTransform();
+                // A compound finds its principal axes with its shape
                 btCollisionShape* shape = rigid->getCollisionShape(world);
+                btTransform transform = rigid->getTransform();
                 
                 btRigidBody* body = 
-          tgBulletUtil::createRigidBody(&tgBulletUtil::worldToDynamicsWorld(world),
+          tgBulletUtil::createRigidBody(NULL,
                         mass,
                         transform,
                         shape);
+                btVector3 inertia;
+                if (mass != 0.0 && rigid->getLocalInertia(world, inertia))
+                {
+                    body->setMassProps(mass, inertia);
+                    body->updateInertiaTensor();
+                }
                 body->setFlags(BT_ENABLE_GYROPSCOPIC_FORCE);
                 rigid->setRigidBody(body);
+                // Held back if the world is inserting in bulk
+                tgBulletUtil::worldToBulletPhysicsImpl(world).addRigidBody(body);
             }
         }
     }
@@ -229,6 +229,18 @@ public:
      */
     virtual btVector3 getCenterOfMass() const = 0;
 
+    /**
+     * Return the principal moments of inertia of the rigid body, if they
+     * are not those of its collision shape.
+     * @param[in] world the world the shapes are made for
+     * @param[out] inertia the moments, if true is returned
+     * @retval false to let the collision shape calculate them
+     */
+    virtual bool getLocalInertia(tgWorld& world, btVector3& inertia) const
+    {
+        return false;
+    }
+
     /**
      * Add this (for determining, for instance, an edge connection point for a
      * cylinder, a surface point on a ball, etc.)
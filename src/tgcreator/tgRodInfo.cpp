@@ -102,17 +102,57 @@ btCollisionShape* tgRodInfo::getCollisionShape(tgWorld& world) const
     {
         const double radius = m_config.radius;
         const double length = getLength();
-        m_collisionShape =
-            new btCylinderShape(btVector3(radius, length / 2.0, radius));
-    
-        // Add the collision shape to the array so we can delete it later
+        // Rods of the same radius and length share one shape, which the
+        // world deletes
         tgWorldBulletPhysicsImpl& bulletWorld =
       (tgWorldBulletPhysicsImpl&)world.implementation();
-        bulletWorld.addCollisionShape(m_collisionShape);
+        // Prescreening worlds use the cheapest proxy whatever the config
+        const tgRod::Config::CollisionProxy proxy =
+            world.getConfig().prescreen ? tgRod::Config::capsuleProxy :
+                                          m_config.collisionProxy;
+        switch (proxy)
+        {
+        case tgRod::Config::capsuleProxy:
+            // The caps are within the rod's length
+            m_collisionShape =
+                bulletWorld.getCapsuleShape(radius,
+                                            std::max(length - 2.0 * radius, 0.0));
+            break;
+        case tgRod::Config::spheresProxy:
+            m_collisionShape =
+                bulletWorld.getSphereStringShape(radius,
+                                                 std::max(length - 2.0 * radius, 0.0));
+            break;
+        case tgRod::Config::boxProxy:
+            m_collisionShape =
+                bulletWorld.getBoxShape(btVector3(radius, length / 2.0, radius));
+            break;
+        default:
+            m_collisionShape =
+                bulletWorld.getCylinderShape(btVector3(radius, length / 2.0, radius));
+            break;
+        }
     }
     return m_collisionShape;
 }
 
+bool tgRodInfo::getLocalInertia(tgWorld& world, btVector3& inertia) const
+{
+    if (m_config.collisionProxy == tgRod::Config::cylinderProxy)
+    {
+        return false;
+    }
+    const double radius = m_config.radius;
+    const double length = getLength();
+    tgWorldBulletPhysicsImpl& bulletWorld =
+      (tgWorldBulletPhysicsImpl&)world.implementation();
+    // As createRigidBody would for the cylinder
+    const float mass = getMass();
+    bulletWorld.getCylinderShape(btVector3(radius, length / 2.0, radius))->
+        calculateLocalInertia(mass, inertia);
+    return true;
+}
+
 double tgRodInfo::getMass() const
 {
     const double length = getLength();
@@ -114,7 +114,7 @@ public:
     
     /**
      * Return a pointer to the corresponding btCollisionShape, lazily creating
-     * it if it does not exist.
+     * it if it does not exist. Its kind is the config's collision proxy.
      */
     virtual btCollisionShape* getCollisionShape(tgWorld& world) const;
     
@@ -127,6 +127,12 @@ public:
         return tgUtil::getTransform(getFrom(), getTo());
     }
     
+    /**
+     * Return the inertia of the rod's cylinder if it collides as another
+     * shape.
+     */
+    virtual bool getLocalInertia(tgWorld& world, btVector3& inertia) const;
+
     /**
      * Return the rod's mass.
      * The mass is the volume times the density.
@@ -32,8 +32,11 @@
 // The Bullet Physics library
 #include <LinearMath/btQuaternion.h>
 #include <LinearMath/btVector3.h>
+// The C++ Standard Library
+#include <stdexcept>
  
-tgStructure::tgStructure() : tgTaggable() 
+tgStructure::tgStructure() : tgTaggable(), m_parent(NULL),
+    m_pending(btTransform::getIdentity()), m_hasPending(false)
 {
 }
 
@@ -41,21 +44,28 @@ tgStructure::tgStructure() : tgTaggable()
 /**
  * Copy constructor
  */
-tgStructure::tgStructure(const tgStructure& orig) : tgTaggable(orig.getTags()), 
-        m_children(orig.m_children.size()), m_nodes(orig.m_nodes), m_pairs(orig.m_pairs)
+tgStructure::tgStructure(const tgStructure& orig) :
+        tgTaggable(readyToCopy(orig).getTags()),
+        m_children(orig.m_children.size()), m_nodes(orig.m_nodes), m_pairs(orig.m_pairs),
+        m_parent(NULL), m_prototype(orig.m_prototype),
+        m_pending(orig.m_pending), m_hasPending(orig.m_hasPending)
 {
     
     // Copy children
     for (std::size_t i = 0; i < orig.m_children.size(); ++i) {
         m_children[i] = new tgStructure(*orig.m_children[i]);
+        m_children[i]->m_parent = this;
     }
 }
 
-tgStructure::tgStructure(const tgTags& tags) : tgTaggable(tags)
+tgStructure::tgStructure(const tgTags& tags) : tgTaggable(tags), m_parent(NULL),
+    m_pending(btTransform::getIdentity()), m_hasPending(false)
 {
 }
 
-tgStructure::tgStructure(const std::string& space_separated_tags) : tgTaggable(space_separated_tags)
+tgStructure::tgStructure(const std::string& space_separated_tags) :
+    tgTaggable(space_separated_tags), m_parent(NULL),
+    m_pending(btTransform::getIdentity()), m_hasPending(false)
 {
 }
 
@@ -67,24 +77,45 @@ tgStructure::~tgStructure()
     }
 }
 
-void tgStructure::addNode(double x, double y, double z, std::string tags)
+void tgStructure::clear()
 {
+    for (std::size_t i = 0; i < m_children.size(); ++i)
+    {
+        delete m_children[i];
+    }
+    std::vector<tgStructure*>().swap(m_children);
+    m_nodes.clear();
+    m_pairs.clear();
+    m_prototype.reset();
+    m_hasPending = false;
+    m_pending = btTransform::getIdentity();
+    invalidateIndex();
+}
+
+void tgStructure::addNode(double x, double y, double z, const std::string& tags)
+{
+    resolve();
     m_nodes.addNode(x, y, z, tags);
+    invalidateIndex();
 }
 
 void tgStructure::addNode(tgNode& newNode)
 {
+    resolve();
     m_nodes.addNode(newNode);
+    invalidateIndex();
 }
 
-void tgStructure::addPair(int fromNodeIdx, int toNodeIdx, std::string tags)
+void tgStructure::addPair(int fromNodeIdx, int toNodeIdx, const std::string& tags)
 {
+    resolve();
     addPair(m_nodes[fromNodeIdx], m_nodes[toNodeIdx], tags);
 }
 
-void tgStructure::addPair(const btVector3& from, const btVector3& to, std::string tags)
+void tgStructure::addPair(const btVector3& from, const btVector3& to, const std::string& tags)
 {
     // @todo: do we need to pass in tags here? might be able to save some proc time if not...
+    resolve();
     tgPair p = tgPair(from, to);
     if (!m_pairs.contains(p))
     {
@@ -99,6 +130,7 @@ void tgStructure::addPair(const btVector3& from, const btVector3& to, std::strin
 }
 
 void tgStructure::removePair(const tgPair& pair) {
+    resolve();
     m_pairs.removePair(pair);
     for (unsigned int i = 0; i < m_children.size(); i++) {
         m_children[i]->removePair(pair);
@@ -107,14 +139,7 @@ void tgStructure::removePair(const tgPair& pair) {
 
 void tgStructure::move(const btVector3& offset)
 {
-    m_nodes.move(offset);
-    m_pairs.move(offset);
-    for (size_t i = 0; i < m_children.size(); ++i)
-    {
-        tgStructure * const pStructure = m_children[i];
-    assert(pStructure != NULL);
-        pStructure->move(offset);
-    }
+    transform(btTransform(btMatrix3x3::getIdentity(), offset));
 }
 
 void tgStructure::addRotation(const btVector3& fixedPoint,
@@ -137,15 +162,9 @@ void tgStructure::addRotation(const btVector3& fixedPoint,
 void tgStructure::addRotation(const btVector3& fixedPoint,
                  const btQuaternion& rotation)
 {
-    m_nodes.addRotation(fixedPoint, rotation);
-    m_pairs.addRotation(fixedPoint, rotation);
-
-    for (std::size_t i = 0; i < m_children.size(); ++i)
-    {
-        tgStructure * const pStructure = m_children[i];
-    assert(pStructure != NULL);
-        pStructure->addRotation(fixedPoint, rotation);
-    }
+    // Rotate about the fixed point: p -> R (p - f) + f
+    const btMatrix3x3 basis(rotation);
+    transform(btTransform(basis, fixedPoint - basis * fixedPoint));
 }
 
 void tgStructure::scale(double scaleFactor) {
@@ -154,14 +173,22 @@ void tgStructure::scale(double scaleFactor) {
 }
 
 void tgStructure::scale(const btVector3& referencePoint, double scaleFactor) {
-    m_nodes.scale(referencePoint, scaleFactor);
-    m_pairs.scale(referencePoint, scaleFactor);
+    // p -> k (p - r) + r
+    transform(btTransform(btMatrix3x3::getIdentity() * scaleFactor,
+                             referencePoint - referencePoint * scaleFactor));
+}
 
-    for (int i = 0; i < m_children.size(); i++) {
-        tgStructure* const childStructure = m_children[i];
-        assert(childStructure != NULL);
-        childStructure->scale(referencePoint, scaleFactor);
-    }
+void tgStructure::transform(const btTransform& transform)
+{
+    // Whatever our ancestors have pending came before this
+    resolveAncestors();
+    addTransform(transform);
+}
+
+void tgStructure::addTransform(const btTransform& transform)
+{
+    m_pending = transform * m_pending;
+    m_hasPending = true;
 }
 
 void tgStructure::addChild(tgStructure* pChild)
@@ -172,14 +199,111 @@ void tgStructure::addChild(tgStructure* pChild)
     /// structure may build the pairs, while another may not depending on its tags.
     if (pChild != NULL)
     {
+        resolve();
+        pChild->m_parent = this;
         m_children.push_back(pChild);
+        invalidateIndex();
     }
 }
 
 void tgStructure::addChild(const tgStructure& child)
 {
-    m_children.push_back(new tgStructure(child));
-    
+    addChild(new tgStructure(child));
+}
+
+tgStructure& tgStructure::addChildInstance(
+    const boost::shared_ptr<const tgStructure>& prototype, const tgTags& tags)
+{
+    if (!prototype) {
+        throw std::invalid_argument("Instance of a NULL prototype");
+    }
+    // Instances copy straight from the prototype's members
+    prototype->resolve();
+
+    tgStructure* const pChild = new tgStructure(prototype->getTags() + tags);
+    pChild->m_prototype = prototype;
+    addChild(pChild);
+    return *pChild;
+}
+
+void tgStructure::resolve() const
+{
+    resolveAncestors();
+    resolveHere();
+}
+
+const tgStructure& tgStructure::readyToCopy(const tgStructure& orig)
+{
+    orig.resolveAncestors();
+    // An unresolved instance has no children to hand a transform to, so it
+    // can keep it and stay unresolved in the copy
+    if (!orig.isInstance()) {
+        orig.resolveHere();
+    }
+    return orig;
+}
+
+void tgStructure::resolveAncestors() const
+{
+    // Only the chain up to the farthest pending transform needs resolving
+    const tgStructure* top = NULL;
+    for (const tgStructure* s = m_parent; s != NULL; s = s->m_parent) {
+        if (s->m_hasPending) {
+            top = s;
+        }
+    }
+    if (top == NULL) {
+        return;
+    }
+    std::vector<const tgStructure*> ancestors;
+    for (const tgStructure* s = m_parent; s != top; s = s->m_parent) {
+        ancestors.push_back(s);
+    }
+    ancestors.push_back(top);
+    // From the root down, so that each hands its transform to the next
+    for (std::size_t i = ancestors.size(); i > 0; --i) {
+        ancestors[i - 1]->resolveHere();
+    }
+}
+
+void tgStructure::resolveHere() const
+{
+    if (!isInstance() && !m_hasPending) {
+        return;
+    }
+    tgStructure* const self = const_cast<tgStructure*>(this);
+
+    if (isInstance()) {
+        boost::shared_ptr<const tgStructure> prototype;
+        prototype.swap(self->m_prototype);
+        self->m_nodes = prototype->m_nodes;
+        self->m_pairs = prototype->m_pairs;
+        for (std::size_t i = 0; i < prototype->m_children.size(); ++i) {
+            tgStructure* const pChild =
+                new tgStructure(*prototype->m_children[i]);
+            pChild->m_parent = self;
+            self->m_children.push_back(pChild);
+        }
+    }
+
+    if (m_hasPending) {
+        const btTransform& t = m_pending;
+        for (int i = 0; i < self->m_nodes.size(); i++) {
+            btVector3& node = self->m_nodes[i];
+            node = t(node);
+        }
+        for (int i = 0; i < self->m_pairs.size(); i++) {
+            tgPair& pair = self->m_pairs[i];
+            pair.getFrom() = t(pair.getFrom());
+            pair.getTo() = t(pair.getTo());
+        }
+        // Our children apply it after whatever they have pending themselves
+        for (std::size_t i = 0; i < m_children.size(); ++i) {
+            m_children[i]->addTransform(t);
+        }
+        self->m_pending.setIdentity();
+        self->m_hasPending = false;
+    }
 }
 
 btVector3 tgStructure::getCentroid() const {
@@ -192,6 +316,7 @@ btVector3 tgStructure::getCentroid() const {
     while (!q.empty()) {
         const tgStructure* structure = q.front();
         q.pop();
+        structure->resolve();
         for (int i = 0; i < structure->m_nodes.size(); i++) {
             centroid += structure->m_nodes[i];
             numNodes++;
@@ -203,7 +328,100 @@ btVector3 tgStructure::getCentroid() const {
     return centroid/numNodes;
 }
 
+void tgStructure::buildIndex()
+{
+    m_index.clear();
+
+    std::queue<tgStructure*> q;
+    q.push(this);
+
+    while (!q.empty()) {
+        tgStructure* structure = q.front();
+        q.pop();
+        structure->resolve();
+        // findChild doesn't return the structure it was called on
+        if (structure != this) {
+            const std::deque<std::string>& tags = structure->getTags().getTags();
+            for (std::size_t j = 0; j < tags.size(); j++) {
+                m_index.children[tgTags::intern(tags[j])].push_back(structure);
+            }
+        }
+        for (int i = 0; i < structure->m_nodes.size(); i++) {
+            const std::deque<std::string>& tags =
+                structure->m_nodes[i].getTags().getTags();
+            for (std::size_t j = 0; j < tags.size(); j++) {
+                m_index.nodes[tgTags::intern(tags[j])].push_back(
+                    std::make_pair(structure, i));
+            }
+        }
+        for (int i = 0; i < structure->m_children.size(); i++) {
+            q.push(structure->m_children[i]);
+        }
+    }
+    m_index.built = true;
+}
+
+void tgStructure::invalidateIndex()
+{
+    for (tgStructure* s = this; s != NULL; s = s->m_parent) {
+        s->m_index.clear();
+    }
+}
+
+namespace
+{
+    /**
+     * Return the shortest list in index among the lists of the searched
+     * tags, or NULL if one of the tags is on nothing in the index
+     */
+    template <class T>
+    const std::vector<T>* shortestList(
+        const std::map<unsigned, std::vector<T> >& index, const tgTags& search)
+    {
+        const std::vector<T>* shortest = NULL;
+        for (int i = 0; i < search.size(); i++) {
+            unsigned id;
+            if (!tgTags::lookup(search[i], id)) {
+                return NULL;
+            }
+            typename std::map<unsigned, std::vector<T> >::const_iterator it =
+                index.find(id);
+            if (it == index.end()) {
+                return NULL;
+            }
+            if (shortest == NULL || it->second.size() < shortest->size()) {
+                shortest = &it->second;
+            }
+        }
+        return shortest;
+    }
+}
+
 tgNode& tgStructure::findNode(const std::string& tags) {
+    const tgTags search(tags);
+
+    if (!search.empty()) {
+        if (!m_index.built) {
+            buildIndex();
+        }
+        const std::vector<std::pair<tgStructure*, int> >* candidates =
+            shortestList(m_index.nodes, search);
+        if (candidates != NULL) {
+            // The list is in BFS order, so the first match is the BFS answer
+            for (std::size_t i = 0; i < candidates->size(); i++) {
+                tgStructure* const owner = (*candidates)[i].first;
+                tgNode& node = owner->m_nodes[(*candidates)[i].second];
+                if (node.hasAllTags(search)) {
+                    // Transforms don't change the index, only positions
+                    owner->resolve();
+                    return node;
+                }
+            }
+        }
+    }
+
+    // Nothing indexed matches: a node may have been tagged since the index
+    // was built, so search the whole structure
     std::queue<tgStructure*> q;
 
     q.push(this);
@@ -211,8 +429,10 @@ tgNode& tgStructure::findNode(const std::string& tags) {
     while (!q.empty()) {
         tgStructure* structure = q.front();
         q.pop();
+        structure->resolve();
         for (int i = 0; i < structure->m_nodes.size(); i++) {
-            if (structure->m_nodes[i].hasAllTags(tags)) {
+            if (structure->m_nodes[i].hasAllTags(search)) {
+                m_index.clear();
                 return structure->m_nodes[i];
             }
         }
@@ -231,6 +451,7 @@ tgPair& tgStructure::findPair(const btVector3& from, const btVector3& to) {
     while (!q.empty()) {
         tgStructure* structure = q.front();
         q.pop();
+        structure->resolve();
         for (int i = 0; i < structure->m_pairs.size(); i++) {
             if ((structure->m_pairs[i].getFrom() == from && structure->m_pairs[i].getTo() == to) ||
                 (structure->m_pairs[i].getFrom() == to && structure->m_pairs[i].getTo() == from)) {
@@ -247,6 +468,24 @@ tgPair& tgStructure::findPair(const btVector3& from, const btVector3& to) {
 }
 
 tgStructure& tgStructure::findChild(const std::string& tags) {
+    const tgTags search(tags);
+
+    if (!search.empty()) {
+        if (!m_index.built) {
+            buildIndex();
+        }
+        const std::vector<tgStructure*>* candidates =
+            shortestList(m_index.children, search);
+        if (candidates != NULL) {
+            for (std::size_t i = 0; i < candidates->size(); i++) {
+                if ((*candidates)[i]->hasAllTags(search)) {
+                    return *(*candidates)[i];
+                }
+            }
+        }
+    }
+
+    // As in findNode, a miss may only mean the index is out of date
     std::queue<tgStructure*> q;
 
     for (int i = 0; i < m_children.size(); i++) {
@@ -256,7 +495,9 @@ tgStructure& tgStructure::findChild(const std::string& tags) {
     while (!q.empty()) {
         tgStructure* structure = q.front();
         q.pop();
-        if (structure->hasAllTags(tags)) {
+        structure->resolve();
+        if (structure->hasAllTags(search)) {
+            m_index.clear();
             return *structure;
         }
         for (int i = 0; i < structure->m_children.size(); i++) {
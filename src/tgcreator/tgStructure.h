@@ -32,14 +32,18 @@
 #include "tgPairs.h"
 // The NTRT Core Library
 #include "core/tgTaggable.h"
+#include "LinearMath/btQuaternion.h"
+#include "LinearMath/btTransform.h"
+#include "LinearMath/btVector3.h"
+#include "boost/shared_ptr.hpp"
 // The C++ Standard Library
+#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 #include <queue>
 
 // Forward declarations
-class btQuaternion;
-class btVector3;
 class tgNode;
 class tgTags;
 
@@ -68,7 +72,7 @@ public:
     /**
      * Add a node using x, y, and z (just for convenience)
      */
-    void addNode(double x, double y, double z, std::string tags = "");
+    void addNode(double x, double y, double z, const std::string& tags = "");
     
     /**
      * Add a node using a node - since keeping track of nodes seems
@@ -79,12 +83,12 @@ public:
     /**
      * Add a pair that connects two of our nodes together
      */
-    void addPair(int fromNodeIdx, int toNodeIdx, std::string tags = "");
+    void addPair(int fromNodeIdx, int toNodeIdx, const std::string& tags = "");
     
     /**
      * Add a pair that connects any two vector3s 
      */
-    void addPair(const btVector3& from, const btVector3& to, std::string tags = "");
+    void addPair(const btVector3& from, const btVector3& to, const std::string& tags = "");
 
     /*
      * Removes the pair that's passed in as a parameter from the structure
@@ -93,6 +97,15 @@ public:
      */
     void removePair(const tgPair& pair);
 
+    /*
+     * Moves, rotations and scales are not applied right away. They are
+     * composed into one pending transform for the structure, which is
+     * applied to our nodes and pairs in one pass, and handed down to our
+     * children, the next time the contents are needed (getNodes, getCentroid,
+     * the find functions, adding to the structure, or building it).
+     * References to nodes or pairs taken before a transform see it only
+     * after that next access.
+     */
     void move(const btVector3& offset);
     
     /**
@@ -130,6 +143,31 @@ public:
 
     void addChild(const tgStructure& child);
 
+    /**
+     * Add a child that shares prototype's nodes, pairs and children instead
+     * of copying them. The child carries prototype's tags plus tags. Like any
+     * structure it can be moved, rotated and scaled without touching its
+     * contents; the first call that needs them copies the prototype and
+     * applies the pending transform, so the result is the same as adding a
+     * copy and transforming that.
+     * The prototype must not be changed while instances of it are unresolved.
+     * @param[in] prototype the structure to instance, must not be NULL
+     * @param[in] tags extra tags for the new child
+     * @return the new child, so it can be placed
+     */
+    tgStructure& addChildInstance(
+        const boost::shared_ptr<const tgStructure>& prototype,
+        const tgTags& tags);
+
+    /**
+     * True while this is an instance added with addChildInstance whose
+     * contents have not been copied from its prototype yet
+     */
+    bool isInstance() const
+    {
+        return m_prototype.get() != NULL;
+    }
+
     /**
      * Get all of our nodes
      * Note: This only includes nodes owned by this structure. use 'findNodes'
@@ -137,6 +175,7 @@ public:
      */
     const tgNodes& getNodes() const
     {
+        resolve();
         return m_nodes;
     }
 
@@ -144,6 +183,10 @@ public:
      * Looks through nodes that we own and those that belong to child nodes
      * (using BFS) and returns the first node with a matching name.
      * Throws an error if a node is not a found with a matching name.
+     * Searches go through an index by tag that is built on first use and
+     * rebuilt after nodes or children are added anywhere below us. Tags added
+     * to a node after that are still found, through a full BFS when the
+     * index has no match.
      * (added to accommodate structures encoded in YAML)
      * @param[in] name the name of the node to find and return
      * @return a reference to the node that was found
@@ -164,6 +207,7 @@ public:
      */
     const tgPairs& getPairs() const
     {
+        resolve();
         return m_pairs;
     }
 
@@ -183,6 +227,7 @@ public:
      */
     const std::vector<tgStructure*>& getChildren() const
     {
+        resolve();
         return m_children;
     }
 
@@ -190,20 +235,112 @@ public:
      * Looks through children we own and those that belong to our children (using BFS)
      * and returns the first child with a matching name.
      * Throws an error if a child is not a found with a matching name.
+     * Indexed the same way as findNode.
      * (added to accommodate structures encoded in YAML)
      * @param[in] name the name of the structure to find and return
      * @return a reference to the structure that was found
      */
     tgStructure& findChild(const std::string& name);
 
+    /**
+     * Delete the children, nodes and pairs, and give back their storage.
+     * The tags are kept. Instances made from this structure keep their
+     * own copy of it.
+     */
+    void clear();
+
 private:
 
+    /**
+     * For each tag id, the nodes and children under a structure that held it
+     * when the index was built, in the BFS order findNode and findChild
+     * search. Copies start out empty, so a copied structure never points
+     * into the original's children.
+     */
+    class SearchIndex
+    {
+    public:
+        SearchIndex() : built(false) {}
+        SearchIndex(const SearchIndex&) : built(false) {}
+        SearchIndex& operator=(const SearchIndex&)
+        {
+            clear();
+            return *this;
+        }
+
+        void clear()
+        {
+            built = false;
+            nodes.clear();
+            children.clear();
+        }
+
+        bool built;
+        /** A node is kept as its owner and index, the owner's node vector may grow */
+        std::map<unsigned, std::vector<std::pair<tgStructure*, int> > > nodes;
+        std::map<unsigned, std::vector<tgStructure*> > children;
+    };
+
+    /** Compose transform after everything pending on us and our ancestors */
+    void transform(const btTransform& transform);
+
+    /** Compose transform after the pending one */
+    void addTransform(const btTransform& transform);
+
+    /**
+     * Bring our contents up to date: resolve our ancestors, then ourselves.
+     * The contents are the same before and after, only their representation
+     * changes, hence const.
+     */
+    void resolve() const;
+
+    /**
+     * Resolve what a copy of orig needs resolved, so that the copy's
+     * children don't get orig's pending transform twice
+     */
+    static const tgStructure& readyToCopy(const tgStructure& orig);
+
+    /** Resolve each ancestor, starting at the root */
+    void resolveAncestors() const;
+
+    /**
+     * Copy the prototype into an unresolved instance, then apply the
+     * pending transform to our nodes and pairs and hand it to our children
+     */
+    void resolveHere() const;
+
+    /** Fill m_index from a BFS over this structure and its descendants */
+    void buildIndex();
+
+    /**
+     * Drop the index of this structure and of every ancestor, since theirs
+     * cover our nodes and children too
+     */
+    void invalidateIndex();
+
     tgNodes m_nodes;
 
     tgPairs m_pairs;
 
     // we own these
     std::vector<tgStructure*> m_children;
+
+    /** The structure that owns us, NULL at the root */
+    tgStructure* m_parent;
+
+    SearchIndex m_index;
+
+    /** What an unresolved instance copies from, NULL otherwise */
+    boost::shared_ptr<const tgStructure> m_prototype;
+
+    /**
+     * Moves, rotations and scales not applied yet, starting from the
+     * contents as they are stored. The basis may carry a uniform scale, so
+     * this is only ever used to map points.
+     */
+    btTransform m_pending;
+
+    bool m_hasPending;
     
 };
 
@@ -30,9 +30,18 @@
 #include "tgConnectorInfo.h"
 #include "tgRigidAutoCompound.h"
 #include "tgStructure.h"
+#include "core/tgBulletUtil.h"
+#include "core/tgGhostFilter.h"
 #include "core/tgWorld.h"
+#include "core/tgWorldBulletPhysicsImpl.h"
 #include "core/tgModel.h"
+#include "core/tgThreadPool.h"
 // The C++ Standard Library
+#include <cassert>
+#include <map>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 #include <stdexcept>
 
 tgStructureInfo::tgStructureInfo(tgStructure& structure, tgBuildSpec& buildSpec) : 
@@ -53,6 +62,11 @@ tgStructureInfo::tgStructureInfo(tgStructure& structure, tgBuildSpec& buildSpec,
 }
 
 tgStructureInfo::~tgStructureInfo()
+{
+    releaseInfos();
+}
+
+void tgStructureInfo::releaseInfos()
 {
     // Have to do this first, if all the rigids are deleted it segfaults
     for (std::size_t i = 0; i < m_compounded.size(); i++)
@@ -81,6 +95,84 @@ tgStructureInfo::~tgStructureInfo()
     {
     delete m_children[i];
     }
+
+    std::vector<tgRigidInfo*>().swap(m_compounded);
+    std::vector<tgRigidInfo*>().swap(m_rigids);
+    std::vector<tgConnectorInfo*>().swap(m_connectors);
+    std::vector<tgStructureInfo*>().swap(m_children);
+    std::vector<tgBuildSpec::RigidAgent*>().swap(m_rigidAgents);
+    std::vector<tgBuildSpec::ConnectorAgent*>().swap(m_connectorAgents);
+    std::vector<tgTagSearch>().swap(m_rigidSearches);
+    std::vector<tgTagSearch>().swap(m_connectorSearches);
+}
+
+tgStructureInfo::Footprint::Footprint() :
+    structures(0),
+    nodes(0),
+    pairs(0),
+    structureInfos(0),
+    rigids(0),
+    connectors(0),
+    agents(0),
+    bytes(0)
+{
+}
+
+namespace
+{
+    void countStructure(const tgStructure& structure,
+                        tgStructureInfo::Footprint& footprint)
+    {
+        footprint.structures++;
+        footprint.nodes += structure.getNodes().size();
+        footprint.pairs += structure.getPairs().size();
+        const std::vector<tgStructure*>& children = structure.getChildren();
+        for (std::size_t i = 0; i < children.size(); i++)
+        {
+            countStructure(*children[i], footprint);
+        }
+    }
+
+    /** @return the bytes malloc has handed out and not had back */
+    std::size_t heapInUse()
+    {
+#ifdef __GLIBC__
+        const struct mallinfo info = mallinfo();
+        // The counters are ints, and wrap above 2 GB
+        return static_cast<unsigned int>(info.uordblks) +
+            static_cast<unsigned int>(info.hblkhd);
+#else
+        return 0;
+#endif
+    }
+}
+
+tgStructureInfo::Footprint tgStructureInfo::finalize()
+{
+    Footprint footprint;
+    countStructure(m_structure, footprint);
+    footprint.rigids = getAllRigids().size();
+    std::vector<tgConnectorInfo*> connectors;
+    getAllConnectors(connectors);
+    footprint.connectors = connectors.size();
+    std::vector<const tgStructureInfo*> infos(1, this);
+    for (std::size_t i = 0; i < infos.size(); i++)
+    {
+        const std::vector<tgStructureInfo*>& children = infos[i]->m_children;
+        infos.insert(infos.end(), children.begin(), children.end());
+    }
+    footprint.structureInfos = infos.size();
+    footprint.agents = m_buildSpec.getRigidAgents().size() +
+        m_buildSpec.getConnectorAgents().size();
+
+    const std::size_t before = heapInUse();
+    // The infos point into the structure and were made by the agents
+    releaseInfos();
+    m_buildSpec.clear();
+    m_structure.clear();
+    const std::size_t after = heapInUse();
+    footprint.bytes = before > after ? before - after : 0;
+    return footprint;
 }
 
 void tgStructureInfo::createTree(tgStructureInfo& structureInfo,
@@ -118,61 +210,143 @@ std::vector<tgRigidInfo*> tgStructureInfo::getAllRigids() const
 // Build methods
 ////////////////////////////
 
-void tgStructureInfo::addRigidsAndConnectors() {
-    const std::vector<tgBuildSpec::RigidAgent*> rigidAgents = m_buildSpec.getRigidAgents();
-    const std::vector<tgBuildSpec::ConnectorAgent*> connectorAgents = m_buildSpec.getConnectorAgents();
+namespace
+{
+    /**
+     * Below this many nodes and pairs in the whole tree the infos are
+     * created on the calling thread; starting a pool would cost more
+     */
+    const std::size_t parallelCandidates = 1024;
+}
+
+class tgStructureInfo::CandidateTask : public tgThreadPool::Task
+{
+public:
+    CandidateTask(std::vector<Candidate>& candidates) : m_candidates(candidates) { }
 
-    const tgNodes& nodes = m_structure.getNodes();
-    const tgPairs& pairs = m_structure.getPairs();
+    virtual void operator()(std::size_t item)
+    {
+        Candidate& candidate = m_candidates[item];
+        candidate.owner->createInfo(candidate);
+    }
 
-    // for each node, create a rigidInfo object using a matching rigidAgent
-    for (int i = 0; i < nodes.size(); i++) {
-        tgRigidInfo* nodeRigid = initRigidInfo<tgNode>(nodes[i], rigidAgents);
-        if (nodeRigid) {
-            m_rigids.push_back(nodeRigid);
+private:
+    std::vector<Candidate>& m_candidates;
+};
+
+void tgStructureInfo::addRigidsAndConnectors(std::vector<Candidate>& candidates) {
+    collectCandidates(candidates);
+
+    try
+    {
+        if (candidates.size() < parallelCandidates)
+        {
+            for (std::size_t i = 0; i < candidates.size(); i++) {
+                candidates[i].owner->createInfo(candidates[i]);
+            }
+        }
+        else
+        {
+            CandidateTask task(candidates);
+            tgThreadPool pool;
+            pool.run(task, candidates.size());
         }
     }
-    // for each pair, create a rigidInfo or connectorInfo object using a matching rigidAgent or connectorAgent
-    for (int i = 0; i < pairs.size(); i++) {
-        tgRigidInfo* pairRigid = initRigidInfo<tgPair>(pairs[i], rigidAgents);
-        if (pairRigid) {
-	  m_rigids.push_back(pairRigid);
+    catch (...)
+    {
+        // Hand what was made to the owners first so their destructors
+        // delete it
+        adoptInfos(candidates);
+        throw;
+    }
+
+    adoptInfos(candidates);
+}
+
+void tgStructureInfo::adoptInfos(std::vector<Candidate>& candidates) {
+    // Candidates are grouped by owner, nodes before pairs, so this keeps the
+    // order the serial build produced
+    for (std::size_t i = 0; i < candidates.size(); i++) {
+        if (candidates[i].rigid) {
+            candidates[i].owner->m_rigids.push_back(candidates[i].rigid);
         }
-        else {
-            tgConnectorInfo* pairConnector = initConnectorInfo<tgPair>(pairs[i], connectorAgents);
-            if (pairConnector) {
-                m_connectors.push_back(pairConnector);
-            }
+        if (candidates[i].connector) {
+            candidates[i].owner->m_connectors.push_back(candidates[i].connector);
         }
     }
+}
+
+void tgStructureInfo::collectCandidates(std::vector<Candidate>& candidates) {
+    m_rigidAgents = m_buildSpec.getRigidAgents();
+    m_connectorAgents = m_buildSpec.getConnectorAgents();
+
+    // Remove our tags so that subcomponents 'inherit' them (because of the
+    // way tags work, removing a tag from the search is the same as adding
+    // the tag to children to be searched). This only depends on the agent,
+    // so it is done once here rather than once per node and pair.
+    m_rigidSearches.clear();
+    for (std::size_t i = 0; i < m_rigidAgents.size(); i++) {
+        assert(m_rigidAgents[i] != NULL);
+        m_rigidSearches.push_back(m_rigidAgents[i]->tagSearch);
+        m_rigidSearches.back().remove(getTags());
+    }
+    m_connectorSearches.clear();
+    for (std::size_t i = 0; i < m_connectorAgents.size(); i++) {
+        assert(m_connectorAgents[i] != NULL);
+        m_connectorSearches.push_back(m_connectorAgents[i]->tagSearch);
+        m_connectorSearches.back().remove(getTags());
+    }
+
+    const tgNodes& nodes = m_structure.getNodes();
+    const tgPairs& pairs = m_structure.getPairs();
+    for (int i = 0; i < nodes.size(); i++) {
+        candidates.push_back(Candidate(this, &nodes[i], NULL));
+    }
+    for (int i = 0; i < pairs.size(); i++) {
+        candidates.push_back(Candidate(this, NULL, &pairs[i]));
+    }
 
     // Children
     for (std::size_t i = 0; i < m_children.size(); i++) {
         tgStructureInfo* const pStructureInfo = m_children[i];
 
         assert(pStructureInfo != NULL);
-        pStructureInfo->addRigidsAndConnectors();
+        pStructureInfo->collectCandidates(candidates);
+    }
+}
+
+void tgStructureInfo::createInfo(Candidate& candidate) const {
+    // for each node, create a rigidInfo object using a matching rigidAgent
+    if (candidate.node) {
+        candidate.rigid = initRigidInfo<tgNode>(*candidate.node, m_rigidAgents, m_rigidSearches,
+                                                candidate.rigidAgent);
+        return;
+    }
+    // for each pair, create a rigidInfo or connectorInfo object using a matching rigidAgent or connectorAgent
+    assert(candidate.pair != NULL);
+    candidate.rigid = initRigidInfo<tgPair>(*candidate.pair, m_rigidAgents, m_rigidSearches,
+                                            candidate.rigidAgent);
+    if (!candidate.rigid) {
+        candidate.connector =
+            initConnectorInfo<tgPair>(*candidate.pair, m_connectorAgents, m_connectorSearches,
+                                      candidate.connectorAgent);
     }
 }
 
 template <class T>
-tgRigidInfo* tgStructureInfo::initRigidInfo(const T& rigidCandidate, const std::vector<tgBuildSpec::RigidAgent*>& rigidAgents) const {
+tgRigidInfo* tgStructureInfo::initRigidInfo(const T& rigidCandidate, const std::vector<tgBuildSpec::RigidAgent*>& rigidAgents,
+                                            const std::vector<tgTagSearch>& searches, int& agent) const {
+    agent = -1;
     for (int i = rigidAgents.size() - 1; i >= 0; i--) {
         const tgBuildSpec::RigidAgent* pRigidAgent = rigidAgents[i];
         assert(pRigidAgent != NULL);
 
-        tgTagSearch tagSearch = tgTagSearch(pRigidAgent->tagSearch);
-
-        // Remove our tags so that subcomponents 'inherit' them (because of the
-        // way tags work, removing a tag from the search is the same as adding
-        // the tag to children to be searched)
-        tagSearch.remove(getTags());
-
         tgRigidInfo* pRigidInfo = pRigidAgent->infoFactory;
         assert(pRigidInfo != NULL);
 
-        tgRigidInfo* rigid = pRigidInfo->createRigidInfo(rigidCandidate, tagSearch);
+        tgRigidInfo* rigid = pRigidInfo->createRigidInfo(rigidCandidate, searches[i]);
         if (rigid) {// check if a tgRigidInfo was found
+	  agent = i;
 	  return rigid;
 	}
     }
@@ -180,24 +354,21 @@ tgRigidInfo* tgStructureInfo::initRigidInfo(const T& rigidCandidate, const std::
 }
 
 template <class T>
-tgConnectorInfo* tgStructureInfo::initConnectorInfo(const T& connectorCandidate, const std::vector<tgBuildSpec::ConnectorAgent*>& connectorAgents) const {
+tgConnectorInfo* tgStructureInfo::initConnectorInfo(const T& connectorCandidate, const std::vector<tgBuildSpec::ConnectorAgent*>& connectorAgents,
+                                                    const std::vector<tgTagSearch>& searches, int& agent) const {
+    agent = -1;
     for (int i = connectorAgents.size() - 1; i >= 0; i--) {
         const tgBuildSpec::ConnectorAgent*  pConnectorAgent = connectorAgents[i];
         assert(pConnectorAgent != NULL);
 
-        tgTagSearch tagSearch = tgTagSearch(pConnectorAgent->tagSearch);
-
-        // Remove our tags so that subcomponents 'inherit' them (because of the
-        // way tags work, removing a tag from the search is the same as adding
-        // the tag to children to be searched)
-        tagSearch.remove(getTags());
-
         tgConnectorInfo* pConnectorInfo = pConnectorAgent->infoFactory;
         assert(pConnectorInfo != NULL);
 
-        tgConnectorInfo* connector = pConnectorInfo->createConnectorInfo(connectorCandidate, tagSearch);
-        if (connector) // check if a tgConnectorInfo was found
+        tgConnectorInfo* connector = pConnectorInfo->createConnectorInfo(connectorCandidate, searches[i]);
+        if (connector) { // check if a tgConnectorInfo was found
+            agent = i;
             return connector;
+        }
     }
     return 0;
 }
@@ -213,7 +384,13 @@ void tgStructureInfo::chooseConnectorRigids()
     chooseConnectorRigids(getAllRigids());
 }
 
-void tgStructureInfo::chooseConnectorRigids(std::vector<tgRigidInfo*> allRigids)
+void tgStructureInfo::chooseConnectorRigids(const std::vector<tgRigidInfo*>& allRigids)
+{
+    const std::set<tgRigidInfo*> rigids(allRigids.begin(), allRigids.end());
+    chooseConnectorRigids(rigids);
+}
+
+void tgStructureInfo::chooseConnectorRigids(const std::set<tgRigidInfo*>& allRigids)
 {
     for (std::size_t i = 0; i < m_connectors.size(); i++)
     {
@@ -231,8 +408,36 @@ void tgStructureInfo::chooseConnectorRigids(std::vector<tgRigidInfo*> allRigids)
     }
 }
 
+namespace
+{
+    /**
+     * Holds the rigid bodies made while it lives back from the world, so
+     * they go into the broadphase together
+     */
+    class BulkInsertion
+    {
+    public:
+        BulkInsertion(tgWorld& world) :
+            m_impl(tgBulletUtil::worldToBulletPhysicsImpl(world))
+        {
+            m_impl.beginBulkInsertion();
+        }
+
+        ~BulkInsertion()
+        {
+            m_impl.endBulkInsertion();
+        }
+
+    private:
+        tgWorldBulletPhysicsImpl& m_impl;
+    };
+}
+
 void tgStructureInfo::initRigidBodies(tgWorld& world) 
 {
+    // Children nest theirs in ours
+    const BulkInsertion bulk(world);
+
     // Rigids
     for (std::size_t i = 0; i < m_rigids.size(); i++)
     {
@@ -277,15 +482,11 @@ void tgStructureInfo::initConnectors(tgWorld& world)
 void tgStructureInfo::buildInto(tgModel& model, tgWorld& world) 
 {
     // These take care of things on a global level
-    addRigidsAndConnectors();    
+    std::vector<Candidate> candidates;
+    addRigidsAndConnectors(candidates);    
     autoCompoundRigids();    
     chooseConnectorRigids();
-    initRigidBodies(world);
-    // Note: Muscle2Ps won't show up yet -- 
-    // they need to be part of a model to have rendering...
-    initConnectors(world);
-    // Now build into the model
-    buildIntoHelper(model, world, *this);
+    buildModels(model, world);
 
     /*
     // DEBUGGING: What are the connector infos and rigid infos that
@@ -310,6 +511,256 @@ void tgStructureInfo::buildInto(tgModel& model, tgWorld& world)
     */
 }
 
+std::vector<const tgPair*> tgStructureInfo::resolve()
+{
+    std::vector<Candidate> candidates;
+    addRigidsAndConnectors(candidates);
+    autoCompoundRigids();
+    chooseConnectorRigids();
+
+    std::vector<const tgPair*> unbuilt;
+    for (std::size_t i = 0; i < candidates.size(); i++)
+    {
+        const Candidate& candidate = candidates[i];
+        if (candidate.pair != NULL && candidate.rigid == NULL &&
+            candidate.connector == NULL)
+        {
+            unbuilt.push_back(candidate.pair);
+        }
+    }
+    return unbuilt;
+}
+
+bool tgStructureInfo::buildInto(tgModel& model, tgWorld& world,
+                                const tgBuildCache& cache)
+{
+    const std::string key = tgBuildCache::makeKey(m_structure, m_buildSpec);
+    tgBuildCache::Plan plan;
+    const bool replayed = cache.load(key, plan) && replayPlan(plan);
+    if (!replayed)
+    {
+        std::vector<Candidate> candidates;
+        addRigidsAndConnectors(candidates);
+        autoCompoundRigids();
+        chooseConnectorRigids();
+        cache.save(key, recordPlan(candidates));
+    }
+    buildModels(model, world);
+    return replayed;
+}
+
+void tgStructureInfo::buildModels(tgModel& model, tgWorld& world)
+{
+    initRigidBodies(world);
+    filterSelfCollision(world);
+    // Note: Muscle2Ps won't show up yet -- 
+    // they need to be part of a model to have rendering...
+    initConnectors(world);
+    // Now build into the model
+    buildIntoHelper(model, world, *this);
+}
+
+void tgStructureInfo::filterSelfCollision(tgWorld& world)
+{
+    const std::vector<tgRigidInfo*> rigids = getAllRigids();
+    int family = 0;
+    for (std::size_t i = 0; i < rigids.size(); i++)
+    {
+        btCollisionObject* const body = rigids[i]->getCollisionObject();
+        if (body == NULL || m_buildSpec.selfCollides(rigids[i]->getTags()))
+        {
+            continue;
+        }
+        if (family == 0)
+        {
+            family = tgGhostFilter::newFamily();
+        }
+        tgGhostFilter::setFamily(tgBulletUtil::worldToDynamicsWorld(world),
+                                 body, family);
+    }
+}
+
+bool tgStructureInfo::replayPlan(const tgBuildCache::Plan& plan)
+{
+    std::vector<Candidate> candidates;
+    collectCandidates(candidates);
+    if (plan.rigidAgents.size() != candidates.size())
+    {
+        return false;
+    }
+
+    // Every owner has the same agents, those of the build spec
+    const int nRigidAgents = m_rigidAgents.size();
+    const int nConnectorAgents = m_connectorAgents.size();
+    bool fits = true;
+    for (std::size_t i = 0; fits && i < candidates.size(); i++)
+    {
+        Candidate& candidate = candidates[i];
+        const int r = plan.rigidAgents[i];
+        const int c = plan.connectorAgents[i];
+        if (r >= nRigidAgents || c >= nConnectorAgents ||
+            (r >= 0 && c >= 0) || (c >= 0 && candidate.pair == NULL))
+        {
+            fits = false;
+        }
+        else if (r >= 0)
+        {
+            tgRigidInfo* const pFactory = m_rigidAgents[r]->infoFactory;
+            candidate.rigid = candidate.node ?
+                pFactory->createRigidInfo(*candidate.node) :
+                pFactory->createRigidInfo(*candidate.pair);
+            fits = candidate.rigid != NULL;
+        }
+        else if (c >= 0)
+        {
+            candidate.connector =
+                m_connectorAgents[c]->infoFactory->createConnectorInfo(*candidate.pair);
+            fits = candidate.connector != NULL;
+        }
+    }
+    adoptInfos(candidates);
+
+    // Check the rest of the plan before anything is compounded
+    const std::vector<tgRigidInfo*> allRigids = getAllRigids();
+    std::vector<tgConnectorInfo*> allConnectors;
+    getAllConnectors(allConnectors);
+    const int nRigids = allRigids.size();
+    fits = fits &&
+        plan.groups.size() == allRigids.size() &&
+        plan.fromRigids.size() == allConnectors.size();
+
+    std::vector< std::deque<tgRigidInfo*> > groups;
+    for (int i = 0; fits && i < nRigids; i++)
+    {
+        const int g = plan.groups[i];
+        if (g < 0 || g > static_cast<int>(groups.size()))
+        {
+            // Groups are numbered in order of their first rigid
+            fits = false;
+        }
+        else
+        {
+            if (g == static_cast<int>(groups.size()))
+            {
+                groups.push_back(std::deque<tgRigidInfo*>());
+            }
+            groups[g].push_back(allRigids[i]);
+        }
+    }
+    for (std::size_t i = 0; fits && i < allConnectors.size(); i++)
+    {
+        fits = plan.fromRigids[i] < nRigids && plan.toRigids[i] < nRigids;
+    }
+
+    if (!fits)
+    {
+        clearInfos();
+        return false;
+    }
+
+    tgRigidAutoCompound compounder(allRigids);
+    m_compounded = compounder.execute(groups);
+
+    bool choose = false;
+    for (std::size_t i = 0; i < allConnectors.size(); i++)
+    {
+        tgConnectorInfo* const pConnectorInfo = allConnectors[i];
+        const int from = plan.fromRigids[i];
+        const int to = plan.toRigids[i];
+        // The agent configs aren't in the key, so a rigid may have changed
+        // shape since; such ends are chosen again below
+        if (from >= 0 && allRigids[from]->containsNode(pConnectorInfo->getFrom()))
+        {
+            pConnectorInfo->setFromRigidInfo(allRigids[from]);
+        }
+        if (to >= 0 && allRigids[to]->containsNode(pConnectorInfo->getTo()))
+        {
+            pConnectorInfo->setToRigidInfo(allRigids[to]);
+        }
+        choose = choose || pConnectorInfo->getFromRigidInfo() == NULL ||
+            pConnectorInfo->getToRigidInfo() == NULL;
+    }
+    if (choose)
+    {
+        // Only the ends that are still unset are chosen
+        chooseConnectorRigids();
+    }
+    return true;
+}
+
+tgBuildCache::Plan tgStructureInfo::recordPlan(const std::vector<Candidate>& candidates) const
+{
+    tgBuildCache::Plan plan;
+    for (std::size_t i = 0; i < candidates.size(); i++)
+    {
+        plan.rigidAgents.push_back(candidates[i].rigidAgent);
+        plan.connectorAgents.push_back(candidates[i].connectorAgent);
+    }
+
+    // m_compounded holds a compound, or the rigid itself, per group
+    std::map<const tgRigidInfo*, int> groupOf;
+    for (std::size_t i = 0; i < m_compounded.size(); i++)
+    {
+        groupOf[m_compounded[i]] = i;
+    }
+    const std::vector<tgRigidInfo*> allRigids = getAllRigids();
+    std::map<const tgRigidInfo*, int> indexOf;
+    for (std::size_t i = 0; i < allRigids.size(); i++)
+    {
+        indexOf[allRigids[i]] = i;
+        const std::map<const tgRigidInfo*, int>::const_iterator it =
+            groupOf.find(allRigids[i]->getRigidInfoGroup());
+        plan.groups.push_back(it == groupOf.end() ? -1 : it->second);
+    }
+
+    std::vector<tgConnectorInfo*> allConnectors;
+    getAllConnectors(allConnectors);
+    for (std::size_t i = 0; i < allConnectors.size(); i++)
+    {
+        const tgConnectorInfo* const pConnectorInfo = allConnectors[i];
+        std::map<const tgRigidInfo*, int>::const_iterator it =
+            indexOf.find(pConnectorInfo->getFromRigidInfo());
+        plan.fromRigids.push_back(it == indexOf.end() ? -1 : it->second);
+        it = indexOf.find(pConnectorInfo->getToRigidInfo());
+        plan.toRigids.push_back(it == indexOf.end() ? -1 : it->second);
+    }
+    return plan;
+}
+
+void tgStructureInfo::clearInfos()
+{
+    for (std::size_t i = 0; i < m_rigids.size(); i++)
+    {
+        delete m_rigids[i];
+    }
+    m_rigids.clear();
+    for (std::size_t i = 0; i < m_connectors.size(); i++)
+    {
+        delete m_connectors[i];
+    }
+    m_connectors.clear();
+    for (std::size_t i = 0; i < m_children.size(); i++)
+    {
+        m_children[i]->clearInfos();
+    }
+}
+
+std::vector<tgConnectorInfo*> tgStructureInfo::getAllConnectors() const
+{
+    std::vector<tgConnectorInfo*> connectors;
+    getAllConnectors(connectors);
+    return connectors;
+}
+
+void tgStructureInfo::getAllConnectors(std::vector<tgConnectorInfo*>& connectors) const
+{
+    connectors.insert(connectors.end(), m_connectors.begin(), m_connectors.end());
+    for (std::size_t i = 0; i < m_children.size(); i++)
+    {
+        m_children[i]->getAllConnectors(connectors);
+    }
+}
+
 void tgStructureInfo::buildIntoHelper(tgModel& model, tgWorld& world,
                       tgStructureInfo& structureInfo)
 {
@@ -400,6 +851,18 @@ operator<<(std::ostream& os, const tgStructureInfo& obj)
     return os;
 }
 
+std::ostream&
+operator<<(std::ostream& os, const tgStructureInfo::Footprint& footprint)
+{
+    os << "Freed " << footprint.structures << " structures, "
+       << footprint.nodes << " nodes, " << footprint.pairs << " pairs, "
+       << footprint.structureInfos << " structure infos, "
+       << footprint.rigids << " rigid infos, "
+       << footprint.connectors << " connector infos and "
+       << footprint.agents << " agents: " << footprint.bytes << " bytes";
+    return os;
+}
+
 
 
 
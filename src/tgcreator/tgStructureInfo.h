@@ -28,17 +28,22 @@
 #define TG_STRUCTURE_INFO_H
 
 // This library
+#include "tgBuildCache.h"
 #include "tgBuildSpec.h"
 // NTRT Core library
 #include "core/tgTaggable.h"
 // The C++ Standard Library
+#include <cstddef>
 #include <iostream>
+#include <set>
 #include <vector>
 
 // Forward declarations
 class tgBuildSpec;
 class tgConnectorInfo;
 class tgModel;
+class tgNode;
+class tgPair;
 class tgRigidInfo;
 class tgStructure;
 class tgWorld;
@@ -68,33 +73,168 @@ public:
         return m_connectors;
     }
 
+    /** Return all connectors in this structure and its descendants */
+    std::vector<tgConnectorInfo*> getAllConnectors() const;
+
     // Build our info into the provided model
     void buildInto(tgModel& model, tgWorld& world);
 
+    /**
+     * Do everything buildInto() does short of building: match the nodes
+     * and pairs to the build spec's builders, compound the rigids and
+     * choose each connector's rigids, without a world or any Bullet
+     * objects, so a structure can be checked and counted quickly. Call
+     * it instead of buildInto(), once.
+     * @return the pairs that no builder made a rigid or connector of
+     */
+    std::vector<const tgPair*> resolve();
+
+    /**
+     * Build our info into the provided model, replaying the tag matching,
+     * compounding and connector attachment recorded in cache for this
+     * structure and build spec. On a miss, or if the entry doesn't fit the
+     * structure, the build runs in full and the entry is written.
+     * @return true if the entry was replayed
+     * @throw std::runtime_error if the entry can't be written
+     */
+    bool buildInto(tgModel& model, tgWorld& world, const tgBuildCache& cache);
+
+    /** What finalize() freed */
+    struct Footprint
+    {
+        Footprint();
+
+        std::size_t structures;
+        std::size_t nodes;
+        std::size_t pairs;
+        std::size_t structureInfos;
+        std::size_t rigids;
+        std::size_t connectors;
+        std::size_t agents;
+
+        /**
+         * The drop in the heap in use, from glibc's allocator statistics;
+         * 0 elsewhere, or if other threads allocated meanwhile
+         */
+        std::size_t bytes;
+    };
+
+    /**
+     * Free the build scaffolding once buildInto() has made the models,
+     * whose bodies and cables no longer need it: the rigid and connector
+     * infos of this structureInfo and its children, the children
+     * themselves, the build spec's agents and the structure's children,
+     * nodes and pairs. The structure and build spec stay valid but empty,
+     * and this structureInfo can then only be destroyed. Models that keep
+     * their structure or structureInfo as a member should call this at
+     * the end of setup().
+     * @return counts of what was freed, and the bytes given back
+     */
+    Footprint finalize();
+
 private:
 
+    /**
+     * A node or pair of one structureInfo, and the info created for it
+     */
+    struct Candidate
+    {
+        Candidate(tgStructureInfo* o, const tgNode* n, const tgPair* p) :
+            owner(o), node(n), pair(p), rigid(NULL), connector(NULL),
+            rigidAgent(-1), connectorAgent(-1) {}
+
+        tgStructureInfo* owner;
+        /** Exactly one of node and pair is set */
+        const tgNode* node;
+        const tgPair* pair;
+        tgRigidInfo* rigid;
+        tgConnectorInfo* connector;
+        /** The index of the agent that built rigid or connector, or -1 */
+        int rigidAgent;
+        int connectorAgent;
+    };
+
+    /** Runs createInfo over the candidates on a tgThreadPool */
+    class CandidateTask;
+
     /*
-     * Initialize all the rigidInfo and connectorInfo objects for this structureInfo and all of its children
+     * Initialize all the rigidInfo and connectorInfo objects for this structureInfo and all of its children.
+     * The infos are created independently for each node and pair, in
+     * parallel for large structures, so the agents' info factories must be
+     * safe to call concurrently.
      */
-    void addRigidsAndConnectors();
+    void addRigidsAndConnectors(std::vector<Candidate>& candidates);
+
+    /** Give each candidate's info to its owner, in candidate order */
+    static void adoptInfos(std::vector<Candidate>& candidates);
+
+    /** Delete the rigids and connectors of this structureInfo and its children */
+    void clearInfos();
+
+    /**
+     * Delete the compounds, rigids, connectors and children, and give
+     * back the storage of the lists
+     */
+    void releaseInfos();
+
+    /** Append our connectors, then those of our children, to connectors */
+    void getAllConnectors(std::vector<tgConnectorInfo*>& connectors) const;
+
+    /**
+     * Do what addRigidsAndConnectors, autoCompoundRigids and
+     * chooseConnectorRigids would, as recorded in plan
+     * @return false, with nothing built, if plan doesn't fit the structure
+     */
+    bool replayPlan(const tgBuildCache::Plan& plan);
+
+    /** Record the decisions of a full build */
+    tgBuildCache::Plan recordPlan(const std::vector<Candidate>& candidates) const;
+
+    /** Create bodies and connectors and add the models, after the infos are resolved */
+    void buildModels(tgModel& model, tgWorld& world);
+
+    /**
+     * Put the bodies of the rigids that the build spec keeps from self
+     * colliding, in this structure and its descendants, in a family of
+     * their own. A compound's body is in it if any of its parts is.
+     */
+    void filterSelfCollision(tgWorld& world);
+
+    /**
+     * Compute our agents' searches and append our nodes and pairs, then
+     * those of our children, to candidates
+     */
+    void collectCandidates(std::vector<Candidate>& candidates);
+
+    /** Fill in the rigid or connector of one of our candidates */
+    void createInfo(Candidate& candidate) const;
 
     /*
-     * Create and return a rigidInfo object using a matching rigidAgent
+     * Create and return a rigidInfo object using a matching rigidAgent.
+     * searches[i] is the search of rigidAgents[i] with our tags removed.
+     * agent is set to the index of the agent used.
      */
     template <class T>
-    tgRigidInfo* initRigidInfo(const T& rigidCandidate, const std::vector<tgBuildSpec::RigidAgent*>& rigidAgents) const;
+    tgRigidInfo* initRigidInfo(const T& rigidCandidate, const std::vector<tgBuildSpec::RigidAgent*>& rigidAgents,
+                               const std::vector<tgTagSearch>& searches, int& agent) const;
 
     /*
-     * Create and return a connectorInfo object using a matching connectorAgent
+     * Create and return a connectorInfo object using a matching connectorAgent.
+     * searches[i] is the search of connectorAgents[i] with our tags removed.
+     * agent is set to the index of the agent used.
      */
     template <class T>
-    tgConnectorInfo* initConnectorInfo(const T& connectorCandidate, const std::vector<tgBuildSpec::ConnectorAgent*>& connectorAgents) const;
+    tgConnectorInfo* initConnectorInfo(const T& connectorCandidate, const std::vector<tgBuildSpec::ConnectorAgent*>& connectorAgents,
+                                       const std::vector<tgTagSearch>& searches, int& agent) const;
 
     void autoCompoundRigids();
     
     void chooseConnectorRigids();
 
-    void chooseConnectorRigids(std::vector<tgRigidInfo*> allRigids);
+    void chooseConnectorRigids(const std::vector<tgRigidInfo*>& allRigids);
+
+    /** The set is built once for every connector in the tree */
+    void chooseConnectorRigids(const std::set<tgRigidInfo*>& allRigids);
     
     void initRigidBodies(tgWorld& world);
     
@@ -135,6 +275,12 @@ private:
     std::vector<tgStructureInfo*> m_children;
     
     std::vector<tgRigidInfo*> m_compounded;
+
+    /** The build spec's agents and their searches, set by collectCandidates */
+    std::vector<tgBuildSpec::RigidAgent*> m_rigidAgents;
+    std::vector<tgBuildSpec::ConnectorAgent*> m_connectorAgents;
+    std::vector<tgTagSearch> m_rigidSearches;
+    std::vector<tgTagSearch> m_connectorSearches;
 };
 
 /**
@@ -146,4 +292,13 @@ private:
  */
 std::ostream& operator<<(std::ostream& os, const tgStructureInfo& obj);
 
+/**
+ * Overload operator<<() to report what tgStructureInfo::finalize() freed
+ * @param[in,out] os an ostream
+ * @param[in] footprint the report
+ * @return os
+ */
+std::ostream& operator<<(std::ostream& os,
+                         const tgStructureInfo::Footprint& footprint);
+
 #endif
@@ -16,8 +16,6 @@
  * governing permissions and limitations under the License.
 */
 
-/// Rand seeding simular to the evolution and terrain classes. 
-
 #ifndef TG_UTIL_H
 #define TG_UTIL_H
 
@@ -358,10 +356,13 @@ public:
         return floor(d * m + 0.5)/m;
     }
     
+    /**
+     * Seed rand() from tgRandom's master seed. New code should draw from
+     * a tgRandom stream instead, which no other thread disturbs.
+     */
     static void seedRandom();
     
-    /// @todo is this necessary? If everyone uses the above function we can just change the 
-    /// definition of rdtsc to seed random everywhere. 
+    /** Set tgRandom's master seed, and seed rand() with it. */
     static void seedRandom(int seed);
 };
 
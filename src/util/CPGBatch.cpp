@@ -0,0 +1,306 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file CPGBatch.cpp
+ * @brief Implementation of class CPGBatch
+ * $Id$
+ */
+
+#include "CPGBatch.h"
+#include "CPGEquations.h"
+#include "CPGNode.h"
+
+// The Bullet Physics Library
+#include "LinearMath/btQuickprof.h"
+
+// The C++ Standard Library
+#include <assert.h>
+#include <cmath>
+#include <math.h>
+#include <stdexcept>
+
+template <typename Scalar>
+CPGBatchT<Scalar>::CPGBatchT() :
+m_systems(0),
+m_nodes(0)
+{
+}
+
+template <typename Scalar>
+void CPGBatchT<Scalar>::build(const std::vector<CPGEquations*>& systems)
+{
+	const std::size_t K = systems.size();
+	const std::size_t n = K == 0 ? 0 : systems[0]->nodeList.size();
+	for (std::size_t s = 0; s != K; s++)
+	{
+		if (systems[s]->nodeList.size() != n)
+		{
+			throw std::invalid_argument("CPG systems differ in size");
+		}
+	}
+	m_systems = K;
+	m_nodes = n;
+	
+	m_freqOffset.resize(n * K);
+	m_freqScale.resize(n * K);
+	m_radiusOffset.resize(n * K);
+	m_radiusScale.resize(n * K);
+	m_rConst.resize(n * K);
+	m_dMin.resize(n * K);
+	m_dMax.resize(n * K);
+	m_omega.resize(n * K);
+	m_rTarget.resize(n * K);
+	m_phi.resize(n * K);
+	m_r.resize(n * K);
+	m_rDot.resize(n * K);
+	for (int k = 0; k != 12; k++)
+	{
+		m_k[k].resize(n * K);
+	}
+	for (int k = 0; k != 3; k++)
+	{
+		m_stage[k].resize(n * K);
+	}
+	
+	m_couplingStart.assign(1, 0);
+	m_couplingTarget.clear();
+	m_couplingWeight.clear();
+	m_couplingPhase.clear();
+	if (K == 0)
+	{
+		return;
+	}
+	
+	// The first system gives the topology, the others must match it
+	const CPGCoupling& topology = systems[0]->coupling;
+	for (std::size_t i = 0; i != n; i++)
+	{
+		m_couplingStart.push_back(topology.end(i));
+	}
+	for (std::size_t c = 0; c != topology.couplings(); c++)
+	{
+		m_couplingTarget.push_back(topology.target(c));
+	}
+	m_couplingWeight.resize(topology.couplings() * K);
+	m_couplingPhase.resize(topology.couplings() * K);
+	
+	for (std::size_t s = 0; s != K; s++)
+	{
+		const CPGCoupling& coupling = systems[s]->coupling;
+		if (coupling.couplings() != topology.couplings())
+		{
+			throw std::invalid_argument("CPG systems differ in topology");
+		}
+		for (std::size_t c = 0; c != coupling.couplings(); c++)
+		{
+			if (coupling.target(c) != m_couplingTarget[c])
+			{
+				throw std::invalid_argument("CPG systems differ in topology");
+			}
+			m_couplingWeight[c * K + s] = coupling.weight(c);
+			m_couplingPhase[c * K + s] = coupling.phase(c);
+		}
+		
+		for (std::size_t i = 0; i != n; i++)
+		{
+			if (coupling.end(i) != m_couplingStart[i + 1])
+			{
+				throw std::invalid_argument("CPG systems differ in topology");
+			}
+			const CPGNode& node = *systems[s]->nodeList[i];
+			m_freqOffset[i * K + s] = node.frequencyOffset;
+			m_freqScale[i * K + s] = node.frequencyScale;
+			m_radiusOffset[i * K + s] = node.radiusOffset;
+			m_radiusScale[i * K + s] = node.radiusScale;
+			m_rConst[i * K + s] = node.rConst;
+			m_dMin[i * K + s] = node.dMin;
+			m_dMax[i * K + s] = node.dMax;
+		}
+	}
+	
+	load(systems);
+}
+
+template <typename Scalar>
+void CPGBatchT<Scalar>::load(const std::vector<CPGEquations*>& systems)
+{
+	assert(systems.size() == m_systems);
+	const std::size_t K = m_systems;
+	for (std::size_t s = 0; s != K; s++)
+	{
+		for (std::size_t i = 0; i != m_nodes; i++)
+		{
+			const CPGNode& node = *systems[s]->nodeList[i];
+			m_phi[i * K + s] = node.phiValue;
+			m_r[i * K + s] = node.rValue;
+			m_rDot[i * K + s] = node.rDotValue;
+		}
+	}
+}
+
+template <typename Scalar>
+void CPGBatchT<Scalar>::store(const std::vector<CPGEquations*>& systems) const
+{
+	assert(systems.size() == m_systems);
+	const std::size_t K = m_systems;
+	for (std::size_t s = 0; s != K; s++)
+	{
+		for (std::size_t i = 0; i != m_nodes; i++)
+		{
+			CPGNode& node = *systems[s]->nodeList[i];
+			node.updateNodeValues(m_phi[i * K + s], m_r[i * K + s],
+									m_rDot[i * K + s]);
+			node.phiDotValue = m_k[0][i * K + s];
+			node.rDoubleDotValue = m_k[2][i * K + s];
+		}
+	}
+}
+
+template <typename Scalar>
+double CPGBatchT<Scalar>::value(std::size_t node, std::size_t system) const
+{
+	assert(node < m_nodes && system < m_systems);
+	const std::size_t i = node * m_systems + system;
+	return static_cast<double>(m_r[i]) * cos(static_cast<double>(m_phi[i]));
+}
+
+template <typename Scalar>
+void CPGBatchT<Scalar>::derivatives(const Scalar* phi, const Scalar* r, const Scalar* rDot,
+						Scalar* kPhi, Scalar* kR, Scalar* kRDot) const
+{
+	const std::size_t K = m_systems;
+	for (std::size_t i = 0; i != m_nodes; i++)
+	{
+		const Scalar* phiI = phi + i * K;
+		const Scalar* omega = &m_omega[i * K];
+		Scalar* kPhiI = kPhi + i * K;
+		for (std::size_t s = 0; s != K; s++)
+		{
+			kPhiI[s] = omega[s];
+		}
+		
+		const std::size_t end = m_couplingStart[i + 1];
+		for (std::size_t c = m_couplingStart[i]; c != end; c++)
+		{
+			const std::size_t j = m_couplingTarget[c];
+			const Scalar* phiJ = phi + j * K;
+			const Scalar* rJ = r + j * K;
+			const Scalar* weight = &m_couplingWeight[c * K];
+			const Scalar* phase = &m_couplingPhase[c * K];
+			for (std::size_t s = 0; s != K; s++)
+			{
+				kPhiI[s] += weight[s] * rJ[s] * std::sin(phiJ[s] - phiI[s] - phase[s]);
+			}
+		}
+	}
+	
+	const std::size_t m = m_nodes * K;
+	for (std::size_t i = 0; i != m; i++)
+	{
+		const Scalar k = m_rConst[i];
+		kR[i] = rDot[i];
+		kRDot[i] = k * (k / 4 * (m_rTarget[i] - r[i]) - rDot[i]);
+	}
+}
+
+template <typename Scalar>
+void CPGBatchT<Scalar>::update(const std::vector<double>& descCom, double dt, double step)
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("CPGBatch::update");
+#endif //BT_NO_PROFILE
+	const std::size_t m = m_nodes * m_systems;
+	if (m == 0 || dt <= 0.0)
+	{
+		return;
+	}
+	assert(descCom.size() == m);
+	assert(step > 0.0);
+	
+	// Commands are constant over the interval
+	const Scalar twoPi = static_cast<Scalar>(2 * M_PI);
+	for (std::size_t i = 0; i != m; i++)
+	{
+		const Scalar d = static_cast<Scalar>(descCom[i]);
+		const bool active = (d >= m_dMin[i] && d <= m_dMax[i]);
+		m_omega[i] = active ? twoPi * (m_freqScale[i] * d + m_freqOffset[i]) : Scalar(0);
+		m_rTarget[i] = active ? m_radiusScale[i] * d + m_radiusOffset[i] : Scalar(0);
+	}
+	
+	Scalar* x[3] = { &m_phi[0], &m_r[0], &m_rDot[0] };
+	Scalar* y[3] = { &m_stage[0][0], &m_stage[1][0], &m_stage[2][0] };
+	Scalar* k[12];
+	for (int i = 0; i != 12; i++)
+	{
+		k[i] = &m_k[i][0];
+	}
+	
+	double t = 0.0;
+	while (t < dt)
+	{
+		const bool last = (t + step >= dt);
+		const double hStep = last ? dt - t : step;
+		const Scalar h = static_cast<Scalar>(hStep);
+		const Scalar halfH = h / 2;
+		const Scalar sixthH = h / 6;
+		
+		derivatives(x[0], x[1], x[2], k[0], k[1], k[2]);
+		for (int v = 0; v != 3; v++)
+		{
+			for (std::size_t i = 0; i != m; i++)
+			{
+				y[v][i] = x[v][i] + halfH * k[v][i];
+			}
+		}
+		derivatives(y[0], y[1], y[2], k[3], k[4], k[5]);
+		for (int v = 0; v != 3; v++)
+		{
+			for (std::size_t i = 0; i != m; i++)
+			{
+				y[v][i] = x[v][i] + halfH * k[3 + v][i];
+			}
+		}
+		derivatives(y[0], y[1], y[2], k[6], k[7], k[8]);
+		for (int v = 0; v != 3; v++)
+		{
+			for (std::size_t i = 0; i != m; i++)
+			{
+				y[v][i] = x[v][i] + h * k[6 + v][i];
+			}
+		}
+		derivatives(y[0], y[1], y[2], k[9], k[10], k[11]);
+		for (int v = 0; v != 3; v++)
+		{
+			for (std::size_t i = 0; i != m; i++)
+			{
+				x[v][i] += sixthH * (k[v][i] + 2 * k[3 + v][i] +
+									2 * k[6 + v][i] + k[9 + v][i]);
+			}
+		}
+		
+		t = last ? dt : t + hStep;
+	}
+	
+	// Leave the end derivatives for store()
+	derivatives(x[0], x[1], x[2], k[0], k[1], k[2]);
+}
+
+template class CPGBatchT<double>;
+template class CPGBatchT<float>;
@@ -0,0 +1,131 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef SRC_UTIL_CPGS_CPGBATCH
+#define SRC_UTIL_CPGS_CPGBATCH
+
+/**
+ * @file CPGBatch.h
+ * @brief Definition of class CPGBatch
+ * $Id$
+ */
+
+#include <cstddef>
+#include <vector>
+
+class CPGEquations;
+
+/**
+ * Advances several CPGEquations with the same topology in lockstep,
+ * with fixed step Runge-Kutta. Parameters, weights, phases and state
+ * may differ between systems; the coupling targets may not. Every
+ * array is laid out [node][system] (or [coupling][system]), so the
+ * inner loops run over contiguous systems and vectorize; the batch
+ * should be at least as wide as the vector unit to profit.
+ * Updating allocates nothing after build().
+ *
+ * The integration is done in Scalar: CPGBatch is double, as
+ * CPGEquations is, and CPGBatchF is float, which fits twice as many
+ * systems in a vector and rounds as float32 embedded controllers do.
+ * Parameters and state are converted on build(), load() and store().
+ * Only float and double are instantiated.
+ */
+template <typename Scalar>
+class CPGBatchT
+{
+public:
+
+	CPGBatchT();
+
+	/**
+	 * Copy the parameters, couplings and state of the systems.
+	 * @throw std::invalid_argument if the systems differ in their
+	 * number of nodes or coupling targets
+	 */
+	void build(const std::vector<CPGEquations*>& systems);
+
+	/** @return the number of systems */
+	std::size_t systems() const { return m_systems; }
+
+	/** @return the number of nodes in each system */
+	std::size_t nodes() const { return m_nodes; }
+
+	/** Read the state of the systems, as in build() */
+	void load(const std::vector<CPGEquations*>& systems);
+
+	/** Write the state back to the systems' nodes */
+	void store(const std::vector<CPGEquations*>& systems) const;
+
+	/**
+	 * Integrate every system over dt.
+	 * @param[in] descCom the commands, [node][system]
+	 * @param[in] dt the length of the interval
+	 * @param[in] step the Runge-Kutta step, the last one is shortened
+	 * to land on dt
+	 */
+	void update(const std::vector<double>& descCom, double dt, double step);
+
+	/** @return r cos(phi) of a node of a system */
+	double value(std::size_t node, std::size_t system) const;
+
+private:
+
+	/** k = f(x) for the state arrays phi, r, rDot */
+	void derivatives(const Scalar* phi, const Scalar* r, const Scalar* rDot,
+					Scalar* kPhi, Scalar* kR, Scalar* kRDot) const;
+
+	std::size_t m_systems;
+	std::size_t m_nodes;
+
+	/** [node][system] parameters */
+	std::vector<Scalar> m_freqOffset;
+	std::vector<Scalar> m_freqScale;
+	std::vector<Scalar> m_radiusOffset;
+	std::vector<Scalar> m_radiusScale;
+	std::vector<Scalar> m_rConst;
+	std::vector<Scalar> m_dMin;
+	std::vector<Scalar> m_dMax;
+
+	/** Couplings of node i are [m_couplingStart[i], m_couplingStart[i+1]) */
+	std::vector<std::size_t> m_couplingStart;
+	std::vector<std::size_t> m_couplingTarget;
+	/** [coupling][system] */
+	std::vector<Scalar> m_couplingWeight;
+	std::vector<Scalar> m_couplingPhase;
+
+	/** [node][system], per update */
+	std::vector<Scalar> m_omega;
+	std::vector<Scalar> m_rTarget;
+
+	/** State, [node][system] */
+	std::vector<Scalar> m_phi;
+	std::vector<Scalar> m_r;
+	std::vector<Scalar> m_rDot;
+
+	/** Stage derivatives, 4 stages of phi, r, rDot */
+	std::vector<Scalar> m_k[12];
+	/** Stage state */
+	std::vector<Scalar> m_stage[3];
+};
+
+typedef CPGBatchT<double> CPGBatch;
+
+typedef CPGBatchT<float> CPGBatchF;
+
+#endif // SRC_UTIL_CPGS_CPGBATCH
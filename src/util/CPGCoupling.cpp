@@ -0,0 +1,165 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file CPGCoupling.cpp
+ * @brief Implementation of class CPGCoupling
+ * $Id$
+ */
+
+#include "CPGCoupling.h"
+
+// The C++ Standard Library
+#include <algorithm>
+#include <stdexcept>
+
+CPGCoupling::CPGCoupling() :
+m_start(1, 0),
+m_sinTerms(0)
+{
+}
+
+void CPGCoupling::addNode()
+{
+	m_start.push_back(m_target.size());
+}
+
+void CPGCoupling::connect(std::size_t node,
+						const std::vector<int>& targets,
+						const std::vector<double>& weights,
+						const std::vector<double>& phases)
+{
+	if (node >= size())
+	{
+		throw std::invalid_argument("Node index out of bounds");
+	}
+	if (targets.size() != weights.size() || targets.size() != phases.size())
+	{
+		throw std::invalid_argument("Couplings, weights and phases differ in size");
+	}
+	for (std::size_t i = 0; i != targets.size(); i++)
+	{
+		if (targets[i] < 0 || static_cast<std::size_t>(targets[i]) >= size())
+		{
+			throw std::invalid_argument("Coupling index out of bounds");
+		}
+	}
+	
+	const std::size_t at = m_start[node + 1];
+	m_target.insert(m_target.begin() + at, targets.begin(), targets.end());
+	m_weight.insert(m_weight.begin() + at, weights.begin(), weights.end());
+	m_phase.insert(m_phase.begin() + at, phases.begin(), phases.end());
+	for (std::size_t i = node + 1; i != m_start.size(); i++)
+	{
+		m_start[i] += targets.size();
+	}
+	m_sin.resize(m_target.size());
+	m_scale.resize(m_target.size());
+}
+
+void CPGCoupling::sumAll(const double* phi,
+						const double* r,
+						std::size_t stride,
+						double* out,
+						std::size_t outStride) const
+{
+	const std::size_t n = size();
+	if (m_sinTerms == 0)
+	{
+		for (std::size_t i = 0; i != n; i++)
+		{
+			out[i * outStride] = sum(i, phi, r, stride);
+		}
+		return;
+	}
+	
+	// Gather the arguments and scales
+	for (std::size_t i = 0; i != n; i++)
+	{
+		const double phiNode = phi[i * stride];
+		const std::size_t last = m_start[i + 1];
+		for (std::size_t c = m_start[i]; c != last; c++)
+		{
+			const std::size_t j = m_target[c] * stride;
+			m_sin[c] = phi[j] - phiNode - m_phase[c];
+			m_scale[c] = m_weight[c] * r[j];
+		}
+	}
+	
+	switch (m_sinTerms)
+	{
+		case 1: fastSines<1>(); break;
+		case 2: fastSines<2>(); break;
+		case 3: fastSines<3>(); break;
+		case 4: fastSines<4>(); break;
+		case 5: fastSines<5>(); break;
+		case 6: fastSines<6>(); break;
+		case 7: fastSines<7>(); break;
+		case 8: fastSines<8>(); break;
+		default: fastSines<9>(); break;
+	}
+	
+	for (std::size_t i = 0; i != n; i++)
+	{
+		double total = 0.0;
+		const std::size_t last = m_start[i + 1];
+		for (std::size_t c = m_start[i]; c != last; c++)
+		{
+			total += m_scale[c] * m_sin[c];
+		}
+		out[i * outStride] = total;
+	}
+}
+
+void CPGCoupling::reweight(std::size_t node,
+						const std::vector<int>& targets,
+						const std::vector<double>& weights,
+						const std::vector<double>& phases)
+{
+	if (node >= size())
+	{
+		throw std::invalid_argument("Node index out of bounds");
+	}
+	const std::size_t first = m_start[node];
+	const std::size_t n = m_start[node + 1] - first;
+	if (targets.size() != n || weights.size() != n || phases.size() != n)
+	{
+		throw std::invalid_argument("Couplings differ from the node's");
+	}
+	for (std::size_t i = 0; i != n; i++)
+	{
+		if (targets[i] < 0 ||
+			static_cast<std::size_t>(targets[i]) != m_target[first + i])
+		{
+			throw std::invalid_argument("Couplings differ from the node's");
+		}
+	}
+	std::copy(weights.begin(), weights.end(), m_weight.begin() + first);
+	std::copy(phases.begin(), phases.end(), m_phase.begin() + first);
+}
+
+void CPGCoupling::clear()
+{
+	m_start.assign(1, 0);
+	m_target.clear();
+	m_weight.clear();
+	m_phase.clear();
+	m_sin.clear();
+	m_scale.clear();
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef SRC_UTIL_CPGS_CPGCOUPLING
+#define SRC_UTIL_CPGS_CPGCOUPLING
+
+/**
+ * @file CPGCoupling.h
+ * @brief Definition of class CPGCoupling
+ * $Id$
+ */
+
+#include <cstddef>
+#include <vector>
+#include <math.h>
+
+#include "CPGFastSin.h"
+
+/**
+ * The couplings of a CPG as a sparse matrix in compressed rows: the
+ * couplings of node i are [begin(i), end(i)), and each has the index of
+ * the node it reads, a weight and a phase offset. Summing a row reads
+ * contiguous arrays instead of following pointers between nodes.
+ */
+class CPGCoupling
+{
+public:
+
+	CPGCoupling();
+
+	/** Append a node without couplings */
+	void addNode();
+
+	/**
+	 * Append couplings to a node's row. Rows are best filled in node
+	 * order; filling an earlier row moves the rows after it.
+	 * @throw std::invalid_argument if an index is out of range or the
+	 * lists differ in size
+	 */
+	void connect(std::size_t node,
+				const std::vector<int>& targets,
+				const std::vector<double>& weights,
+				const std::vector<double>& phases);
+
+	/**
+	 * Rewrite the weights and phases of a node's row, in place.
+	 * @throw std::invalid_argument if the node is out of range or the
+	 * targets are not those of its row, in the same order
+	 */
+	void reweight(std::size_t node,
+				const std::vector<int>& targets,
+				const std::vector<double>& weights,
+				const std::vector<double>& phases);
+
+	void clear();
+
+	/**
+	 * Use CPGFastSin in sum() instead of the C library's sin.
+	 * @param[in] tolerance the accuracy of each sine, or 0 for the C
+	 * library
+	 */
+	void setSinTolerance(double tolerance)
+	{
+		m_sinTerms = CPGFastSin::termsFor(tolerance);
+	}
+
+	/** @return the terms of CPGFastSin in use, 0 for the C library */
+	std::size_t sinTerms() const { return m_sinTerms; }
+
+	/** @return the number of nodes */
+	std::size_t size() const { return m_start.size() - 1; }
+
+	/** @return the number of couplings of all nodes */
+	std::size_t couplings() const { return m_target.size(); }
+
+	std::size_t begin(std::size_t node) const { return m_start[node]; }
+	std::size_t end(std::size_t node) const { return m_start[node + 1]; }
+
+	std::size_t target(std::size_t c) const { return m_target[c]; }
+	double weight(std::size_t c) const { return m_weight[c]; }
+	double phase(std::size_t c) const { return m_phase[c]; }
+
+	/**
+	 * The coupling term of CPGNode::updateDTs for one node,
+	 * sum of weight * r[target] * sin(phi[target] - phi[node] - phase)
+	 * @param[in] phi the phase of node j at phi[j * stride]
+	 * @param[in] r the radius of node j at r[j * stride]
+	 */
+	double sum(std::size_t node,
+				const double* phi,
+				const double* r,
+				std::size_t stride) const
+	{
+		const double phiNode = phi[node * stride];
+		double total = 0.0;
+		const std::size_t last = m_start[node + 1];
+		for (std::size_t c = m_start[node]; c != last; c++)
+		{
+			const std::size_t j = m_target[c] * stride;
+			const double x = phi[j] - phiNode - m_phase[c];
+			total += m_weight[c] * r[j] *
+				(m_sinTerms == 0 ? sin(x) : CPGFastSin::sin(x, m_sinTerms));
+		}
+		return total;
+	}
+
+	/**
+	 * sum() for every node. With CPGFastSin, the arguments are
+	 * gathered first so the sines run over one contiguous array.
+	 * @param[out] out the sum of node i at out[i * outStride]
+	 */
+	void sumAll(const double* phi,
+				const double* r,
+				std::size_t stride,
+				double* out,
+				std::size_t outStride = 1) const;
+
+	/** @return the bytes of the coupling arrays and their scratch */
+	std::size_t bytes() const
+	{
+		return (m_start.capacity() + m_target.capacity()) * sizeof(std::size_t) +
+			(m_weight.capacity() + m_phase.capacity() +
+			 m_sin.capacity() + m_scale.capacity()) * sizeof(double);
+	}
+
+private:
+
+	/** Pass 2 of sumAll: the sine of every argument in m_sin */
+	template <std::size_t Terms>
+	void fastSines() const
+	{
+		double* s = &m_sin[0];
+		const std::size_t n = m_sin.size();
+		for (std::size_t c = 0; c != n; c++)
+		{
+			s[c] = CPGFastSin::sin<Terms>(s[c]);
+		}
+	}
+
+	std::vector<std::size_t> m_start;
+	std::vector<std::size_t> m_target;
+	std::vector<double> m_weight;
+	std::vector<double> m_phase;
+
+	/** Scratch of sumAll, per coupling */
+	mutable std::vector<double> m_sin;
+	mutable std::vector<double> m_scale;
+
+	std::size_t m_sinTerms;
+};
+
+#endif // SRC_UTIL_CPGS_CPGCOUPLING
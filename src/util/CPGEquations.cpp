@@ -25,9 +25,7 @@
  */
 
 #include "CPGEquations.h"
-
-#include "boost/array.hpp"
-#include "boost/numeric/odeint.hpp"
+#include "core/tgLog.h"
 
 // The Bullet Physics Library
 #include "LinearMath/btQuickprof.h"
@@ -35,23 +33,63 @@
 
 // The C++ Standard Library
 #include <assert.h>
+#include <iostream>
+#include <map>
+#include <math.h>
 #include <stdexcept>
 
-using namespace boost::numeric::odeint;
-
-typedef std::vector<double > cpgVars_type;
-
 CPGEquations::CPGEquations(int maxSteps) :
 stepSize(0.1),
 numSteps(0),
-m_maxSteps(maxSteps)
+m_maxSteps(maxSteps),
+m_rejectedSteps(0),
+m_integratorDirty(true),
+m_fixedStep(false),
+m_throwOnStiffness(true),
+m_stiffUpdates(0),
+m_updatePeriod(0.0),
+m_interpolation(LINEAR),
+m_tickTime(0.0),
+m_ticked(false)
  {}
 CPGEquations::CPGEquations(std::vector<CPGNode*>& newNodeList, int maxSteps) :
 nodeList(newNodeList),
 stepSize(0.1), //TODO: specify as a parameter somewhere
 numSteps(0),
-m_maxSteps(maxSteps)
+m_maxSteps(maxSteps),
+m_rejectedSteps(0),
+m_integratorDirty(true),
+m_fixedStep(false),
+m_throwOnStiffness(true),
+m_stiffUpdates(0),
+m_updatePeriod(0.0),
+m_interpolation(LINEAR),
+m_tickTime(0.0),
+m_ticked(false)
 {
+	std::map<const CPGNode*, int> index;
+	for (std::size_t i = 0; i != nodeList.size(); i++)
+	{
+		index[nodeList[i]] = i;
+		coupling.addNode();
+	}
+	
+	for (std::size_t i = 0; i != nodeList.size(); i++)
+	{
+		const CPGNode& node = *nodeList[i];
+		std::vector<int> connections;
+		for (std::size_t j = 0; j != node.couplingList.size(); j++)
+		{
+			std::map<const CPGNode*, int>::const_iterator it =
+				index.find(node.couplingList[j]);
+			if (it == index.end())
+			{
+				throw std::invalid_argument("Coupling to a node outside the CPG");
+			}
+			connections.push_back(it->second);
+		}
+		coupling.connect(i, connections, node.weightList, node.phaseList);
+	}
 }
 
 CPGEquations::~CPGEquations()
@@ -68,12 +106,19 @@ CPGEquations::~CPGEquations()
 int CPGEquations::addNode(std::vector<double>& newParams) 
 {
 	int index = nodeList.size();
-	CPGNode* newNode = new CPGNode(index, newParams);
+	CPGNode* newNode = createNode(index, newParams);
 	nodeList.push_back(newNode);
+	coupling.addNode();
+	m_integratorDirty = true;
 	
 	return index;
 }
 
+CPGNode* CPGEquations::createNode(int index, std::vector<double>& params)
+{
+	return new CPGNode(index, params);
+}
+
 void CPGEquations::defineConnections (	int nodeIndex,
 								std::vector<int> connections,
 								std::vector<double> newWeights,
@@ -86,6 +131,46 @@ void CPGEquations::defineConnections (	int nodeIndex,
 	for(int i = 0; i != connections.size(); i++){
 		nodeList[nodeIndex]->addCoupling(nodeList[connections[i]], newWeights[i], newPhaseOffsets[i]); 
 	}
+	coupling.connect(nodeIndex, connections, newWeights, newPhaseOffsets);
+	m_integratorDirty = true;
+}
+
+void CPGEquations::setNodeParams(int nodeIndex,
+								const std::vector<double>& params)
+{
+	if (nodeIndex < 0 || static_cast<std::size_t>(nodeIndex) >= nodeList.size())
+	{
+		throw std::invalid_argument("Node index out of bounds");
+	}
+	nodeList[nodeIndex]->reset(params);
+	m_integratorDirty = true;
+}
+
+void CPGEquations::setConnectionParams(int nodeIndex,
+								const std::vector<int>& connections,
+								const std::vector<double>& newWeights,
+								const std::vector<double>& newPhaseOffsets)
+{
+	if (nodeIndex < 0 || static_cast<std::size_t>(nodeIndex) >= nodeList.size())
+	{
+		throw std::invalid_argument("Node index out of bounds");
+	}
+	// Checks the connections against the node's
+	coupling.reweight(nodeIndex, connections, newWeights, newPhaseOffsets);
+	CPGNode& node = *nodeList[nodeIndex];
+	node.weightList.assign(newWeights.begin(), newWeights.end());
+	node.phaseList.assign(newPhaseOffsets.begin(), newPhaseOffsets.end());
+	m_integratorDirty = true;
+}
+
+void CPGEquations::restart()
+{
+	numSteps = 0;
+	m_rejectedSteps = 0;
+	m_stiffUpdates = 0;
+	m_tickTime = 0.0;
+	m_ticked = false;
+	m_integratorDirty = true;
 }
 
 const double CPGEquations::operator[](const std::size_t i) const
@@ -99,6 +184,31 @@ const double CPGEquations::operator[](const std::size_t i) const
 		nodeValue = NAN;
 		throw std::invalid_argument("Node index out of bounds");
 	}
+	else if (m_ticked)
+	{
+		const double s = m_tickTime / m_updatePeriod;
+		const double a = m_lastValues[i];
+		const double b = m_nextValues[i];
+		switch (m_interpolation)
+		{
+			case HOLD:
+				nodeValue = a;
+				break;
+			case LINEAR:
+				nodeValue = a + s * (b - a);
+				break;
+			case HERMITE:
+			{
+				const double s2 = s * s;
+				const double s3 = s2 * s;
+				nodeValue = (2 * s3 - 3 * s2 + 1) * a +
+							(s3 - 2 * s2 + s) * m_updatePeriod * m_lastRates[i] +
+							(-2 * s3 + 3 * s2) * b +
+							(s3 - s2) * m_updatePeriod * m_nextRates[i];
+				break;
+			}
+		}
+	}
 	else
 	{
 		nodeValue = (*nodeList[i]).nodeValue;
@@ -107,6 +217,34 @@ const double CPGEquations::operator[](const std::size_t i) const
 	return nodeValue;
 }
 
+void CPGEquations::getOutputs(std::vector<double>& values) const
+{
+	const std::size_t n = nodeList.size();
+	values.resize(n);
+	if (!m_ticked || m_interpolation == HOLD)
+	{
+		for (std::size_t i = 0; i < n; i++)
+		{
+			values[i] = m_ticked ? m_lastValues[i] : (*nodeList[i]).nodeValue;
+		}
+	}
+	else if (m_interpolation == LINEAR)
+	{
+		const double s = m_tickTime / m_updatePeriod;
+		for (std::size_t i = 0; i < n; i++)
+		{
+			values[i] = m_lastValues[i] + s * (m_nextValues[i] - m_lastValues[i]);
+		}
+	}
+	else
+	{
+		for (std::size_t i = 0; i < n; i++)
+		{
+			values[i] = (*this)[i];
+		}
+	}
+}
+
 std::vector<double>& CPGEquations::getXVars() {
 #ifndef BT_NO_PROFILE 
     BT_PROFILE("CPGEquations::getXVars");
@@ -139,8 +277,22 @@ void CPGEquations::updateNodes(std::vector<double>& descCom)
 #ifndef BT_NO_PROFILE 
     BT_PROFILE("CPGEquations::updateNodes");
 #endif //BT_NO_PROFILE
+	gatherNodeState();
+	const double* phi = &nodeState[0];
+	const double* r = phi + 1;
 	for(int i = 0; i != nodeList.size(); i++){
-		nodeList[i]->updateDTs(descCom[i]);
+		nodeList[i]->updateDTs(descCom[i], coupling.sum(i, phi, r, 2));
+	}
+}
+
+void CPGEquations::gatherNodeState()
+{
+	// One spare keeps &nodeState[0] valid for an empty CPG
+	nodeState.resize(2 * nodeList.size() + 1);
+	for (std::size_t i = 0; i != nodeList.size(); i++)
+	{
+		nodeState[2 * i] = nodeList[i]->phiValue;
+		nodeState[2 * i + 1] = nodeList[i]->rValue;
 	}
 }
 
@@ -156,114 +308,111 @@ void CPGEquations::updateNodeData(std::vector<double> newXVals)
 	}
 }
 
-/**
- * Function object for interfacing with ODE Int
- */
-class integrate_function {
-	public:
-	
-	integrate_function(CPGEquations* pCPGs, std::vector<double> newComs) :
-	theseCPGs(pCPGs),
-	descCom(newComs)
-	{
-		
-	}
-	
-	void operator()  (const cpgVars_type &x ,
-					cpgVars_type &dxdt ,
-					double t )
-	{
+void CPGEquations::update(std::vector<double>& descCom, double dt)
+{
 #ifndef BT_NO_PROFILE 
-        BT_PROFILE("CPGEquations::integrate_function");
+    BT_PROFILE("CPGEquations::update");
 #endif //BT_NO_PROFILE
-		theseCPGs->updateNodeData(x);
-		theseCPGs->updateNodes(descCom);
-	
-		/**
-		 * Read information from nodes into variables that work for ODEInt
-		 */
-		std::vector<double> dXVars = theseCPGs->getDXVars();
-		/**
-		 * Values are pre-computed by nodes, so we just have to transfer
-		 * them
-		 */
-		for(std::size_t i = 0; i != x.size(); i++){
-			dxdt[i] = dXVars[i];
+	integrate(m_integrator, descCom, dt);
+    
+	 TG_LOG_TRACE(tgLog::eCPG, dt << '\t' << nodeList[0]->nodeValue <<
+	  '\t' << nodeList[1]->nodeValue <<
+	   '\t' << nodeList[2]->nodeValue);
+	   
+}
+
+void CPGEquations::setSinTolerance(double tolerance)
+{
+	coupling.setSinTolerance(tolerance);
+	m_integratorDirty = true;
+}
+
+void CPGEquations::checkBudget()
+{
+    if (numSteps > m_maxSteps)
+    {
+		m_stiffUpdates++;
+		if (m_throwOnStiffness)
+		{
+			TG_LOG_INFO(tgLog::eCPG, "Ending trial due to inefficient equations " << numSteps);
+			throw std::runtime_error("Inefficient CPG Parameters");
 		}
-		//std::cout<<"operator call"<<std::endl;
-		
-		theseCPGs->countStep();
-		
+    }
+}
+
+void CPGEquations::setUpdatePeriod(double period, Interpolation interpolation)
+{
+	if (period < 0.0)
+	{
+		throw std::invalid_argument("Update period is negative");
 	}
-	
-	private:
-	CPGEquations* theseCPGs;
-	std::vector<double> descCom;
-};
+	m_updatePeriod = period;
+	m_interpolation = interpolation;
+	m_tickTime = 0.0;
+	m_ticked = false;
+}
 
-/**
- * ODE_Int Output function, can do nothing, but needs to exist
- */
-class output_function {
-	public: 
+bool CPGEquations::step(std::vector<double>& descCom, double dt)
+{
+	if (m_updatePeriod <= 0.0)
+	{
+		update(descCom, dt);
+		return true;
+	}
 	
-	output_function(CPGEquations* pCPGs) :
-	theseCPGs(pCPGs)
+	bool ticked = false;
+	if (!m_ticked)
 	{
+		// The first tick runs from now to one period ahead
+		captureOutputs(m_lastValues, m_lastRates);
+		update(descCom, m_updatePeriod);
+		captureOutputs(m_nextValues, m_nextRates);
+		m_tickTime = 0.0;
+		m_ticked = true;
+		ticked = true;
 	}
 	
-	void operator() ( 	const cpgVars_type &x ,
-						const double t )
+	m_tickTime += dt;
+	while (m_tickTime > m_updatePeriod)
 	{
-		/**
-		 * Push integrated vars back to nodes
-		 */
-		theseCPGs->updateNodeData(x);
-		#if (0) // Suppress output
-		std::cout << t << '\t' << (*theseCPGs)[0]  << '\t' << (*theseCPGs)[1]  << '\t' << (*theseCPGs)[2]  << std::endl;
-		#endif
+		m_tickTime -= m_updatePeriod;
+		m_lastValues.swap(m_nextValues);
+		m_lastRates.swap(m_nextRates);
+		update(descCom, m_updatePeriod);
+		captureOutputs(m_nextValues, m_nextRates);
+		ticked = true;
 	}
 	
-	private:
-	CPGEquations* theseCPGs;
-};
+	return ticked;
+}
 
-void CPGEquations::update(std::vector<double>& descCom, double dt)
+void CPGEquations::captureOutputs(std::vector<double>& values,
+								std::vector<double>& rates) const
 {
-#ifndef BT_NO_PROFILE 
-    BT_PROFILE("CPGEquations::update");
-#endif //BT_NO_PROFILE
-	if (dt <= 0.1){ //TODO: specify default step size as a parameter during construction
-		stepSize = dt;
+	values.resize(nodeList.size());
+	rates.resize(nodeList.size());
+	for (std::size_t i = 0; i != nodeList.size(); i++)
+	{
+		const CPGNode& node = *nodeList[i];
+		values[i] = node.nodeValue;
+		// d/dt r cos(phi)
+		rates[i] = node.rDotValue * cos(node.phiValue) -
+					node.rValue * node.phiDotValue * sin(node.phiValue);
 	}
-	else{
-		stepSize = 0.1;
+}
+
+std::size_t CPGEquations::bytes() const
+{
+	std::size_t total = sizeof(*this) + coupling.bytes() + m_integrator.bytes() +
+		nodeList.capacity() * sizeof(CPGNode*);
+	for (std::size_t i = 0; i < nodeList.size(); i++)
+	{
+		total += nodeList[i]->bytes();
 	}
-	
-	numSteps = 0;
-	
-	/**
-	 * Read information from nodes into variables that work for ODEInt
-	 */
-	std::vector<double>& xVars = getXVars(); 
-	
-	/**
-	 * Run ODEInt. This will change the data in xVars
-	 */
-	integrate(integrate_function(this, descCom), xVars, 0.0, dt, stepSize, output_function(this));
-	
-    if (numSteps > m_maxSteps)
-    {
-        std::cout << "Ending trial due to inefficient equations " << numSteps << std::endl;
-        throw std::runtime_error("Inefficient CPG Parameters");
-    }
-    
-	 #if (0)
-	 std::cout << dt << '\t' << nodeList[0]->nodeValue <<
-	  '\t' << nodeList[1]->nodeValue <<
-	   '\t' << nodeList[2]->nodeValue << std::endl;
-	 #endif
-	   
+	const std::size_t values = nodeState.capacity() + XVars.capacity() +
+		DXVars.capacity() + m_lastValues.capacity() + m_lastRates.capacity() +
+		m_nextValues.capacity() + m_nextRates.capacity();
+	return total + values * sizeof(double);
 }
 
 std::string CPGEquations::toString(const std::string& prefix) const
@@ -31,15 +31,33 @@
 #include <sstream>
 
 #include "CPGNode.h"
+#include "CPGCoupling.h"
+#include "CPGIntegrator.h"
+#include "CPGNodeDynamics.h"
 
 /**
  * The top level class for interfacing with CPGs. Contains the definition
- * of the CPG (list of nodes) as well as functions to interface with ODEInt
+ * of the CPG (list of nodes), and integrates it over flat arrays with a
+ * CPGIntegrator. Subclasses with other node equations override
+ * createNode() and update(), passing integrate() their own policy.
  */
 class CPGEquations
 {
+	template <typename Scalar> friend class CPGBatchT;
+	
  public:
 	
+	/** How operator[] reads the outputs between ticks of step() */
+	enum Interpolation
+	{
+		/** The output of the last tick, as from a hand-coded timer */
+		HOLD,
+		/** Linear between the outputs of the last and the next tick */
+		LINEAR,
+		/** Cubic Hermite, matching the outputs' rates at both ticks */
+		HERMITE
+	};
+	
 	CPGEquations(int maxSteps = 200);
 
 	CPGEquations(std::vector<CPGNode*>& newNodeList, int maxSteps = 200);
@@ -53,7 +71,45 @@ class CPGEquations
 				 std::vector<double> newWeights,
 				 std::vector<double> newPhaseOffsets);
 	
+	/**
+	 * Give a node new parameters, as addNode takes them, and put it
+	 * back to the state a new node starts in. With setConnectionParams
+	 * and restart this prepares the same network for another trial
+	 * without allocating.
+	 * @throw std::invalid_argument if the index is out of bounds or
+	 * there are too few parameters
+	 */
+	void setNodeParams(int nodeIndex, const std::vector<double>& params);
+	
+	/**
+	 * Give a node's couplings new weights and phase offsets. The
+	 * connections must be those defineConnections gave the node, in the
+	 * same order.
+	 * @throw std::invalid_argument if they are not
+	 */
+	void setConnectionParams(int nodeIndex,
+				 const std::vector<int>& connections,
+				 const std::vector<double>& newWeights,
+				 const std::vector<double>& newPhaseOffsets);
+	
+	/**
+	 * Restart the ticks of step and forget earlier stiff updates, as in
+	 * a new system; the nodes keep their state.
+	 */
+	void restart();
+	
+	/**
+	 * The output of node i. Once step() has ticked, this is
+	 * interpolated between ticks.
+	 */
 	const double operator[](const std::size_t i) const;
+	
+	/**
+	 * Copy the output of every node into values, the same as reading
+	 * operator[] for each node
+	 * @param[out] values resized to the number of nodes
+	 */
+	void getOutputs(std::vector<double>& values) const;
 
 	virtual std::vector<double>& getXVars();
 	
@@ -64,11 +120,96 @@ class CPGEquations
 	virtual void updateNodeData(std::vector<double> newXVals);
 	
 	/**
-	 * Call the integrator a the specified timestep
+	 * Call the integrator a the specified timestep. Integration stops
+	 * early once it takes more than maxSteps derivative evaluations.
+	 * @throw std::runtime_error if it stopped early, unless
+	 * setThrowOnStiffness(false) was called
+	 */
+	virtual void update(std::vector<double>& descCom, double dt);
+	
+	/**
+	 * Integrate with fixed step Runge-Kutta instead of the adaptive
+	 * Dormand-Prince pair. The step is the same as the initial step of
+	 * the adaptive integrator.
+	 */
+	void setFixedStep(bool fixedStep)
+	{
+		m_fixedStep = fixedStep;
+	}
+	
+	/**
+	 * Evaluate the coupling terms with CPGFastSin.
+	 * @param[in] tolerance the accuracy of each sine, or 0 for the C
+	 * library, the default
 	 */
-	void update(std::vector<double>& descCom, double dt);
+	void setSinTolerance(double tolerance);
+	
+	/**
+	 * Let step() integrate the CPG at its own rate, independent of the
+	 * physics timestep. Restarts the ticks.
+	 * @param[in] period the time between ticks, or 0 to integrate over
+	 * every step as update() does
+	 * @param[in] interpolation how outputs are read between ticks
+	 * @throw std::invalid_argument if period is negative
+	 */
+	void setUpdatePeriod(double period, Interpolation interpolation = LINEAR);
+	
+	/**
+	 * Advance the CPG by a physics timestep. With an update period,
+	 * the CPG integrates one period ahead of the simulation whenever
+	 * the simulation reaches the end of the last tick, and the commands
+	 * are those passed on that step.
+	 * @return true if the CPG ticked during this step
+	 */
+	bool step(std::vector<double>& descCom, double dt);
+	
+	/**
+	 * Choose whether update throws when the CPG is too stiff to
+	 * integrate within maxSteps, or only records it, so a learner can
+	 * score the trial as failed and keep the process.
+	 */
+	void setThrowOnStiffness(bool throwOnStiffness)
+	{
+		m_throwOnStiffness = throwOnStiffness;
+	}
+	
+	/** @return true if an update stopped early since clearStiffness() */
+	bool isStiff() const
+	{
+		return m_stiffUpdates > 0;
+	}
+	
+	/** @return the number of updates that stopped early */
+	int getStiffUpdates() const
+	{
+		return m_stiffUpdates;
+	}
+	
+	/** @return the derivative evaluations of the last update */
+	int getStepCount() const
+	{
+		return numSteps;
+	}
+	
+	/** @return the steps the adaptive integrator rejected in the last update */
+	int getRejectedSteps() const
+	{
+		return m_rejectedSteps;
+	}
+	
+	/** Forget earlier stiff updates, e.g. between trials */
+	void clearStiffness()
+	{
+		m_stiffUpdates = 0;
+	}
 	
 	std::string toString(const std::string& prefix = "") const;
+
+	/**
+	 * @return the bytes of the nodes, the coupling, the integrator and
+	 * the interpolated outputs, for tgMemoryReport
+	 */
+	virtual std::size_t bytes() const;
 	
     void countStep()
     {
@@ -77,18 +218,119 @@ class CPGEquations
     
 protected:
 	
+	/**
+	 * Copy phi and r of every node into nodeState, interleaved, so
+	 * coupling.sum can read them with a stride of 2
+	 */
+	void gatherNodeState();
+	
+	/**
+	 * Make the node that addNode appends, subclasses make their own
+	 * node type
+	 */
+	virtual CPGNode* createNode(int index, std::vector<double>& params);
+	
 	std::vector<CPGNode*> nodeList;
 	
+	/**
+	 * The couplings of nodeList, filled by addNode and
+	 * defineConnections
+	 */
+	CPGCoupling coupling;
+	
+	std::vector<double> nodeState;
+	
     std::vector<double> XVars;
     std::vector<double> DXVars;
     
 	double stepSize;
     
+	/**
+	 * Record the result of an update, and throw if it stopped early
+	 * and the CPG should throw
+	 */
+	void checkBudget();
+	
+	/**
+	 * The body of update: integrate nodeList over dt with the given
+	 * flat integrator, rebuilding it first if the CPG changed
+	 */
+	template <class Dynamics>
+	void integrate(CPGIntegrator<Dynamics>& integrator,
+					std::vector<double>& descCom,
+					double dt);
+	
     int m_maxSteps;
     int numSteps;
+    int m_rejectedSteps;
+    
+private:
+    
+    /**
+     * Flat copy of nodeList, rebuilt on the next update after a node
+     * or a connection is added
+     */
+    CPGIntegrator<CPGNodeDynamics> m_integrator;
+    bool m_integratorDirty;
+    bool m_fixedStep;
+    
+    bool m_throwOnStiffness;
+    int m_stiffUpdates;
+    
+    /** Copy every node's output and its rate into values and rates */
+    void captureOutputs(std::vector<double>& values,
+                        std::vector<double>& rates) const;
+    
+    double m_updatePeriod;
+    Interpolation m_interpolation;
+    /** Time since the start of the current tick, in [0, m_updatePeriod] */
+    double m_tickTime;
+    bool m_ticked;
+    /** Outputs and their rates at the start and end of the current tick */
+    std::vector<double> m_lastValues;
+    std::vector<double> m_lastRates;
+    std::vector<double> m_nextValues;
+    std::vector<double> m_nextRates;
     
 };
 
+template <class Dynamics>
+void CPGEquations::integrate(CPGIntegrator<Dynamics>& integrator,
+							std::vector<double>& descCom,
+							double dt)
+{
+	if (dt <= 0.1){ //TODO: specify default step size as a parameter during construction
+		stepSize = dt;
+	}
+	else{
+		stepSize = 0.1;
+	}
+	
+	if (m_integratorDirty)
+	{
+		integrator.build(nodeList, coupling);
+		m_integratorDirty = false;
+	}
+	
+	/**
+	 * The integrator works on its own copy of the state, the nodes only
+	 * see the result
+	 */
+	integrator.load(nodeList);
+	if (m_fixedStep)
+	{
+		numSteps = integrator.integrateFixed(descCom, dt, stepSize, m_maxSteps);
+	}
+	else
+	{
+		numSteps = integrator.integrateAdaptive(descCom, dt, stepSize, m_maxSteps);
+	}
+	m_rejectedSteps = integrator.rejected();
+	integrator.store(nodeList);
+	
+	checkBudget();
+}
+
 /**
  * Overload operator<<() to handle CPGEquations
  * @param[in,out] os an ostream
@@ -28,9 +28,6 @@
 
 #include "core/tgCast.h"
 
-#include "boost/array.hpp"
-#include "boost/numeric/odeint.hpp"
-
 // The Bullet Physics Library
 #include "LinearMath/btQuickprof.h"
 
@@ -39,10 +36,6 @@
 #include <stdexcept>
 #include <iterator> 
 
-using namespace boost::numeric::odeint;
-
-typedef std::vector<double > cpgVars_type;
-
 CPGEquationsFB::CPGEquationsFB(int maxSteps) :
 CPGEquations(maxSteps)
  {}
@@ -56,13 +49,14 @@ CPGEquationsFB::~CPGEquationsFB()
   //CPGEquations
 }
 
-int CPGEquationsFB::addNode(std::vector<double>& newParams) 
+std::size_t CPGEquationsFB::bytes() const
 {
-	int index = nodeList.size();
-	CPGNodeFB* newNode = new CPGNodeFB(index, newParams);
-	nodeList.push_back(newNode);
-	
-	return index;
+	return CPGEquations::bytes() + m_feedbackIntegrator.bytes();
+}
+
+CPGNode* CPGEquationsFB::createNode(int index, std::vector<double>& params)
+{
+	return new CPGNodeFB(index, params);
 }
 
 std::vector<double>& CPGEquationsFB::getXVars() {
@@ -103,16 +97,14 @@ void CPGEquationsFB::updateNodes(std::vector<double>& descCom)
 #ifndef BT_NO_PROFILE 
     BT_PROFILE("CPGEquationsFB:updateNodes");
 #endif //BT_NO_PROFILE
-	std::vector<double>::iterator comIt = descCom.begin();
-	
 	assert(descCom.size() == nodeList.size() * 3);
 	
+	gatherNodeState();
+	const double* phi = &nodeState[0];
+	const double* r = phi + 1;
 	for(int i = 0; i != nodeList.size(); i++){
 		CPGNodeFB* currentNode = tgCast::cast<CPGNode, CPGNodeFB>(nodeList[i]);
-		std::vector<double> comGroup(comIt, comIt + 3);
-		currentNode->updateDTs(comGroup);
-		
-		comIt += 3;
+		currentNode->updateDTs(&descCom[3 * i], coupling.sum(i, phi, r, 2));
 	}
 }
 
@@ -128,3 +120,13 @@ void CPGEquationsFB::updateNodeData(std::vector<double> newXVals)
 		currentNode->updateNodeValues(newXVals[3*i], newXVals[3*i+1], newXVals[3*i+2]);
 	}
 }
+
+void CPGEquationsFB::update(std::vector<double>& descCom, double dt)
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("CPGEquationsFB::update");
+#endif //BT_NO_PROFILE
+	assert(descCom.size() == nodeList.size() * 3);
+	
+	integrate(m_feedbackIntegrator, descCom, dt);
+}
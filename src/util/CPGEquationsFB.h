@@ -38,8 +38,9 @@
 
 
 /**
- * The top level class for interfacing with CPGs. Contains the definition
- * of the CPG (list of nodes) as well as functions to interface with ODEInt
+ * A CPG of CPGNodeFB, which take three feedback values per node
+ * instead of one descending command. It shares the flat integrator of
+ * CPGEquations, with the CPGNodeFBDynamics equations.
  */
 class CPGEquationsFB : public CPGEquations
 {
@@ -51,8 +52,6 @@ class CPGEquationsFB : public CPGEquations
 	
 	~CPGEquationsFB();
 	
-    int addNode(std::vector<double>& newParams);
-    
 	std::vector<double>& getXVars();
 	
 	std::vector<double>& getDXVars();
@@ -60,6 +59,24 @@ class CPGEquationsFB : public CPGEquations
 	void updateNodes(std::vector<double>& descCom);
 	
 	void updateNodeData(std::vector<double> newXVals);
+	
+	/**
+	 * Integrate over dt
+	 * @param[in] descCom three feedback values per node
+	 */
+	void update(std::vector<double>& descCom, double dt);
+
+	/** @return CPGEquations::bytes() and the feedback integrator's */
+	std::size_t bytes() const;
+
+protected:
+	
+	/** Make a CPGNodeFB, params needs size 11 */
+	CPGNode* createNode(int index, std::vector<double>& params);
+	
+private:
+	
+	CPGIntegrator<CPGNodeFBDynamics> m_feedbackIntegrator;
 
 };
 
@@ -0,0 +1,132 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef SRC_UTIL_CPGS_CPGFASTSIN
+#define SRC_UTIL_CPGS_CPGFASTSIN
+
+/**
+ * @file CPGFastSin.h
+ * @brief Definition and implementation of class CPGFastSin
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <math.h>
+
+/**
+ * A branch-free sine for the coupling terms of a CPG. The argument is
+ * reduced to [-pi/2, pi/2] and the sine approximated by its odd Taylor
+ * polynomial, with as many terms as a requested accuracy needs. With
+ * no branches or calls, loops over it can vectorize.
+ */
+class CPGFastSin
+{
+public:
+
+	/** The most terms sin() evaluates, for an error near 1e-15 */
+	static const std::size_t maxTerms = 9;
+
+	/**
+	 * @param[in] tolerance the largest acceptable absolute error
+	 * @return the fewest terms whose truncation error is within
+	 * tolerance, or 0 if tolerance is not positive
+	 */
+	static std::size_t termsFor(double tolerance)
+	{
+		if (tolerance <= 0.0)
+		{
+			return 0;
+		}
+		// The first omitted term of the series bounds the error
+		const double h = M_PI / 2.0;
+		double bound = h;
+		for (std::size_t terms = 1; terms < maxTerms; terms++)
+		{
+			bound *= h * h / ((2.0 * terms) * (2.0 * terms + 1.0));
+			if (bound <= tolerance)
+			{
+				return terms;
+			}
+		}
+		return maxTerms;
+	}
+
+	/**
+	 * @param[in] x an angle of magnitude below 1e9; arguments near
+	 * 1e6 lose about 1e-10 to the reduction
+	 * @tparam Terms from termsFor, 1 to maxTerms
+	 */
+	template <std::size_t Terms>
+	static double sin(double x)
+	{
+		// Reduce to [-pi, pi], then fold onto [-pi/2, pi/2]
+		const double k = static_cast<double>(static_cast<int>(
+			x * (0.5 / M_PI) + (x < 0.0 ? -0.5 : 0.5)));
+		double y = x - k * (2.0 * M_PI);
+		y = y > M_PI / 2.0 ? M_PI - y : y;
+		y = y < -M_PI / 2.0 ? -M_PI - y : y;
+		
+		const double y2 = y * y;
+		double p = coefficient(Terms - 1);
+		for (std::size_t i = Terms - 1; i != 0; i--)
+		{
+			p = p * y2 + coefficient(i - 1);
+		}
+		return y * p;
+	}
+
+	/** As above, with the number of terms known only at run time */
+	static double sin(double x, std::size_t terms)
+	{
+		switch (terms)
+		{
+			case 1: return sin<1>(x);
+			case 2: return sin<2>(x);
+			case 3: return sin<3>(x);
+			case 4: return sin<4>(x);
+			case 5: return sin<5>(x);
+			case 6: return sin<6>(x);
+			case 7: return sin<7>(x);
+			case 8: return sin<8>(x);
+			default: return sin<9>(x);
+		}
+	}
+
+private:
+
+	/** @return (-1)^k / (2k+1)! */
+	static double coefficient(std::size_t k)
+	{
+		static const double c[maxTerms] = {
+			1.0,
+			-1.0 / 6.0,
+			1.0 / 120.0,
+			-1.0 / 5040.0,
+			1.0 / 362880.0,
+			-1.0 / 39916800.0,
+			1.0 / 6227020800.0,
+			-1.0 / 1307674368000.0,
+			1.0 / 355687428096000.0
+		};
+		return c[k];
+	}
+};
+
+#endif // SRC_UTIL_CPGS_CPGFASTSIN
@@ -0,0 +1,53 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file CPGIntegrator.cpp
+ * @brief The Dormand-Prince tableau of CPGIntegrator
+ * $Id$
+ */
+
+#include "CPGIntegrator.h"
+
+const double CPGDormandPrince::a21 = 1.0 / 5.0;
+const double CPGDormandPrince::a31 = 3.0 / 40.0;
+const double CPGDormandPrince::a32 = 9.0 / 40.0;
+const double CPGDormandPrince::a41 = 44.0 / 45.0;
+const double CPGDormandPrince::a42 = -56.0 / 15.0;
+const double CPGDormandPrince::a43 = 32.0 / 9.0;
+const double CPGDormandPrince::a51 = 19372.0 / 6561.0;
+const double CPGDormandPrince::a52 = -25360.0 / 2187.0;
+const double CPGDormandPrince::a53 = 64448.0 / 6561.0;
+const double CPGDormandPrince::a54 = -212.0 / 729.0;
+const double CPGDormandPrince::a61 = 9017.0 / 3168.0;
+const double CPGDormandPrince::a62 = -355.0 / 33.0;
+const double CPGDormandPrince::a63 = 46732.0 / 5247.0;
+const double CPGDormandPrince::a64 = 49.0 / 176.0;
+const double CPGDormandPrince::a65 = -5103.0 / 18656.0;
+const double CPGDormandPrince::b1 = 35.0 / 384.0;
+const double CPGDormandPrince::b3 = 500.0 / 1113.0;
+const double CPGDormandPrince::b4 = 125.0 / 192.0;
+const double CPGDormandPrince::b5 = -2187.0 / 6784.0;
+const double CPGDormandPrince::b6 = 11.0 / 84.0;
+const double CPGDormandPrince::e1 = 71.0 / 57600.0;
+const double CPGDormandPrince::e3 = -71.0 / 16695.0;
+const double CPGDormandPrince::e4 = 71.0 / 1920.0;
+const double CPGDormandPrince::e5 = -17253.0 / 339200.0;
+const double CPGDormandPrince::e6 = 22.0 / 525.0;
+const double CPGDormandPrince::e7 = -1.0 / 40.0;
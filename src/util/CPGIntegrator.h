@@ -0,0 +1,422 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef SRC_UTIL_CPGS_CPGINTEGRATOR
+#define SRC_UTIL_CPGS_CPGINTEGRATOR
+
+/**
+ * @file CPGIntegrator.h
+ * @brief Definition and implementation of class template CPGIntegrator
+ * $Id$
+ */
+
+#include "CPGCoupling.h"
+
+// The Bullet Physics Library
+#include "LinearMath/btQuickprof.h"
+
+// The C++ Standard Library
+#include <algorithm>
+#include <assert.h>
+#include <cstddef>
+#include <math.h>
+#include <stdexcept>
+#include <vector>
+
+class CPGNode;
+
+/**
+ * The Dormand-Prince 5(4) tableau, defined in CPGIntegrator.cpp
+ */
+struct CPGDormandPrince
+{
+	static const double a21;
+	static const double a31, a32;
+	static const double a41, a42, a43;
+	static const double a51, a52, a53, a54;
+	static const double a61, a62, a63, a64, a65;
+	static const double b1, b3, b4, b5, b6;
+	/** Fifth minus fourth order weights */
+	static const double e1, e3, e4, e5, e6, e7;
+};
+
+/**
+ * Integrates a CPG over flat arrays: three state variables per node,
+ * with phi and r first, and the couplings as a CPGCoupling. The node
+ * equations are the Dynamics policy, chosen at compile time, e.g.
+ * CPGNodeDynamics or CPGNodeFBDynamics. It must provide
+ * - static const std::size_t inputs, the commands per node
+ * - void build(const std::vector<CPGNode*>&), copying parameters
+ * - std::size_t size() const
+ * - void load(const std::vector<CPGNode*>&, double* x) const
+ * - void store(const std::vector<CPGNode*>&, const double* x,
+ *   const double* dxdt) const
+ * - void setCommands(const std::vector<double>&), once per call
+ * - void derivatives(const CPGCoupling&, const double* x,
+ *   double* dxdt) const
+ * All buffers are sized by build(), so integrating allocates nothing
+ * until the CPG changes.
+ */
+template <class Dynamics>
+class CPGIntegrator
+{
+public:
+
+	CPGIntegrator() :
+	m_absTol(1.0e-6),
+	m_relTol(1.0e-6),
+	m_rejected(0),
+	m_finished(true)
+	{
+	}
+
+	/**
+	 * Copy the parameters of the nodes and their couplings.
+	 * @throw std::invalid_argument if the sizes differ, or the policy
+	 * rejects the nodes
+	 */
+	void build(const std::vector<CPGNode*>& nodes, const CPGCoupling& coupling)
+	{
+		if (coupling.size() != nodes.size())
+		{
+			throw std::invalid_argument("Coupling and node list differ in size");
+		}
+		m_dynamics.build(nodes);
+		m_coupling = coupling;
+		
+		const std::size_t m = 3 * nodes.size();
+		m_x.resize(m);
+		m_dxdt.resize(m);
+		for (int s = 0; s != 7; s++)
+		{
+			m_k[s].resize(m);
+		}
+		m_xStage.resize(m);
+		m_xNew.resize(m);
+		m_xErr.resize(m);
+	}
+
+	/** @return the number of nodes of the last build */
+	std::size_t size() const { return m_dynamics.size(); }
+
+	/** Read the state from the nodes */
+	void load(const std::vector<CPGNode*>& nodes)
+	{
+		assert(nodes.size() == size());
+		if (size() != 0)
+		{
+			m_dynamics.load(nodes, &m_x[0]);
+		}
+	}
+
+	/** Write the state and the last derivatives back to the nodes */
+	void store(const std::vector<CPGNode*>& nodes) const
+	{
+		assert(nodes.size() == size());
+		if (size() != 0)
+		{
+			m_dynamics.store(nodes, &m_x[0], &m_dxdt[0]);
+		}
+	}
+
+	/**
+	 * Integrate over dt with the adaptive Dormand-Prince pair, using
+	 * the error control of odeint's controlled dopri5.
+	 * @param[in] descCom Dynamics::inputs commands per node
+	 * @param[in] dt the length of the interval
+	 * @param[in] initialStep the first step to try
+	 * @param[in] maxEvaluations stop at the last accepted step once
+	 * more derivatives than this were evaluated, or 0 for no limit
+	 * @return the number of derivative evaluations
+	 */
+	int integrateAdaptive(const std::vector<double>& descCom,
+						double dt,
+						double initialStep,
+						int maxEvaluations = 0);
+
+	/**
+	 * Integrate over dt with classic Runge-Kutta at a fixed step. The
+	 * last step is shortened to land on dt.
+	 * @param[in] maxEvaluations as for integrateAdaptive
+	 * @return the number of derivative evaluations
+	 */
+	int integrateFixed(const std::vector<double>& descCom,
+						double dt,
+						double step,
+						int maxEvaluations = 0);
+
+	/** @return the steps integrateAdaptive rejected in its last call */
+	int rejected() const { return m_rejected; }
+
+	/** @return false if the last call stopped before the end of dt */
+	bool finished() const { return m_finished; }
+
+	/** Absolute and relative error tolerances of integrateAdaptive */
+	void setTolerance(double absolute, double relative)
+	{
+		m_absTol = absolute;
+		m_relTol = relative;
+	}
+
+	/** @return the bytes of the coupling, the state and the stages */
+	std::size_t bytes() const
+	{
+		std::size_t n = m_x.capacity() + m_dxdt.capacity() +
+			m_xStage.capacity() + m_xNew.capacity() + m_xErr.capacity();
+		for (std::size_t i = 0; i < 7; i++)
+		{
+			n += m_k[i].capacity();
+		}
+		return m_coupling.bytes() + n * sizeof(double);
+	}
+
+private:
+
+	void derivatives(const double* x, double* dxdt) const
+	{
+		m_dynamics.derivatives(m_coupling, x, dxdt);
+	}
+
+	/**
+	 * One Dormand-Prince step of h from m_x, with m_k[0] = f(m_x).
+	 * Leaves the fifth order result in m_xNew, its derivative in
+	 * m_k[6] and the error estimate in m_xErr.
+	 */
+	void dopriStep(double h);
+
+	Dynamics m_dynamics;
+	CPGCoupling m_coupling;
+
+	/** State and derivative, 3 per node */
+	std::vector<double> m_x;
+	std::vector<double> m_dxdt;
+
+	/** Stage buffers */
+	std::vector<double> m_k[7];
+	std::vector<double> m_xStage;
+	std::vector<double> m_xNew;
+	std::vector<double> m_xErr;
+
+	double m_absTol;
+	double m_relTol;
+
+	int m_rejected;
+	bool m_finished;
+};
+
+template <class Dynamics>
+void CPGIntegrator<Dynamics>::dopriStep(double h)
+{
+	typedef CPGDormandPrince DP;
+	const std::size_t m = m_x.size();
+	const double* x = &m_x[0];
+	double* y = &m_xStage[0];
+	const double* k1 = &m_k[0][0];
+	double* k2 = &m_k[1][0];
+	double* k3 = &m_k[2][0];
+	double* k4 = &m_k[3][0];
+	double* k5 = &m_k[4][0];
+	double* k6 = &m_k[5][0];
+	double* k7 = &m_k[6][0];
+	
+	for (std::size_t i = 0; i != m; i++)
+	{
+		y[i] = x[i] + h * DP::a21 * k1[i];
+	}
+	derivatives(y, k2);
+	for (std::size_t i = 0; i != m; i++)
+	{
+		y[i] = x[i] + h * (DP::a31 * k1[i] + DP::a32 * k2[i]);
+	}
+	derivatives(y, k3);
+	for (std::size_t i = 0; i != m; i++)
+	{
+		y[i] = x[i] + h * (DP::a41 * k1[i] + DP::a42 * k2[i] + DP::a43 * k3[i]);
+	}
+	derivatives(y, k4);
+	for (std::size_t i = 0; i != m; i++)
+	{
+		y[i] = x[i] + h * (DP::a51 * k1[i] + DP::a52 * k2[i] + DP::a53 * k3[i] +
+							DP::a54 * k4[i]);
+	}
+	derivatives(y, k5);
+	for (std::size_t i = 0; i != m; i++)
+	{
+		y[i] = x[i] + h * (DP::a61 * k1[i] + DP::a62 * k2[i] + DP::a63 * k3[i] +
+							DP::a64 * k4[i] + DP::a65 * k5[i]);
+	}
+	derivatives(y, k6);
+	double* xNew = &m_xNew[0];
+	for (std::size_t i = 0; i != m; i++)
+	{
+		xNew[i] = x[i] + h * (DP::b1 * k1[i] + DP::b3 * k3[i] + DP::b4 * k4[i] +
+							DP::b5 * k5[i] + DP::b6 * k6[i]);
+	}
+	derivatives(xNew, k7);
+	double* xErr = &m_xErr[0];
+	for (std::size_t i = 0; i != m; i++)
+	{
+		xErr[i] = h * (DP::e1 * k1[i] + DP::e3 * k3[i] + DP::e4 * k4[i] +
+							DP::e5 * k5[i] + DP::e6 * k6[i] + DP::e7 * k7[i]);
+	}
+}
+
+template <class Dynamics>
+int CPGIntegrator<Dynamics>::integrateAdaptive(const std::vector<double>& descCom,
+									double dt,
+									double initialStep,
+									int maxEvaluations)
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("CPGIntegrator::integrateAdaptive");
+#endif //BT_NO_PROFILE
+	m_rejected = 0;
+	m_finished = true;
+	if (size() == 0 || dt <= 0.0)
+	{
+		return 0;
+	}
+	assert(descCom.size() >= Dynamics::inputs * size());
+	m_dynamics.setCommands(descCom);
+	
+	const std::size_t m = m_x.size();
+	derivatives(&m_x[0], &m_k[0][0]);
+	int evaluations = 1;
+	
+	double t = 0.0;
+	double h = initialStep;
+	while (t < dt)
+	{
+		if (maxEvaluations > 0 && evaluations > maxEvaluations)
+		{
+			m_finished = false;
+			break;
+		}
+		
+		const bool last = (t + h >= dt);
+		if (last)
+		{
+			h = dt - t;
+		}
+		
+		dopriStep(h);
+		evaluations += 6;
+		
+		double error = 0.0;
+		for (std::size_t i = 0; i != m; i++)
+		{
+			const double scale = m_absTol + m_relTol *
+				(fabs(m_x[i]) + fabs(h) * fabs(m_k[0][i]));
+			error = std::max(error, fabs(m_xErr[i]) / scale);
+		}
+		
+		if (error > 1.0)
+		{
+			// Reject, and retry with a smaller step
+			h *= std::max(0.9 * pow(error, -1.0 / 3.0), 0.2);
+			m_rejected++;
+			continue;
+		}
+		
+		t = last ? dt : t + h;
+		m_x.swap(m_xNew);
+		// First same as last, the end derivative starts the next step
+		m_k[0].swap(m_k[6]);
+		
+		if (error < 0.5)
+		{
+			error = std::max(pow(5.0, -5.0), error);
+			h *= 0.9 * pow(error, -1.0 / 5.0);
+		}
+	}
+	
+	std::copy(m_k[0].begin(), m_k[0].end(), m_dxdt.begin());
+	return evaluations;
+}
+
+template <class Dynamics>
+int CPGIntegrator<Dynamics>::integrateFixed(const std::vector<double>& descCom,
+								double dt,
+								double step,
+								int maxEvaluations)
+{
+#ifndef BT_NO_PROFILE 
+    BT_PROFILE("CPGIntegrator::integrateFixed");
+#endif //BT_NO_PROFILE
+	m_rejected = 0;
+	m_finished = true;
+	if (size() == 0 || dt <= 0.0)
+	{
+		return 0;
+	}
+	assert(step > 0.0);
+	assert(descCom.size() >= Dynamics::inputs * size());
+	m_dynamics.setCommands(descCom);
+	
+	const std::size_t m = m_x.size();
+	double* x = &m_x[0];
+	double* y = &m_xStage[0];
+	double* k1 = &m_k[0][0];
+	double* k2 = &m_k[1][0];
+	double* k3 = &m_k[2][0];
+	double* k4 = &m_k[3][0];
+	int evaluations = 0;
+	
+	double t = 0.0;
+	while (t < dt)
+	{
+		if (maxEvaluations > 0 && evaluations > maxEvaluations)
+		{
+			m_finished = false;
+			break;
+		}
+		
+		const bool last = (t + step >= dt);
+		const double h = last ? dt - t : step;
+		
+		derivatives(x, k1);
+		for (std::size_t i = 0; i != m; i++)
+		{
+			y[i] = x[i] + 0.5 * h * k1[i];
+		}
+		derivatives(y, k2);
+		for (std::size_t i = 0; i != m; i++)
+		{
+			y[i] = x[i] + 0.5 * h * k2[i];
+		}
+		derivatives(y, k3);
+		for (std::size_t i = 0; i != m; i++)
+		{
+			y[i] = x[i] + h * k3[i];
+		}
+		derivatives(y, k4);
+		for (std::size_t i = 0; i != m; i++)
+		{
+			x[i] += h / 6.0 * (k1[i] + 2.0 * k2[i] + 2.0 * k3[i] + k4[i]);
+		}
+		evaluations += 4;
+		
+		t = last ? dt : t + h;
+	}
+	
+	derivatives(x, &m_dxdt[0]);
+	return evaluations + 1;
+}
+
+#endif // SRC_UTIL_CPGS_CPGINTEGRATOR
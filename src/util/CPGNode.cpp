@@ -31,6 +31,7 @@
 #include <algorithm> //for_each
 #include <math.h> 
 #include <assert.h>
+#include <stdexcept>
 
 CPGNode::CPGNode(int nodeNum, const std::vector<double> & params):
 nodeValue(0),
@@ -68,20 +69,52 @@ void CPGNode::addCoupling(	CPGNode* cNode,
     assert(couplingList.size() == weightList.size() && couplingList.size() == phaseList.size());
 }
 	
-void CPGNode::updateDTs(double descCom)
+void CPGNode::reset(const std::vector<double>& params)
 {
-	phiDotValue = 2 * M_PI * nodeEquation(descCom, frequencyOffset, frequencyScale);
+	if (params.size() < 7)
+	{
+		throw std::invalid_argument("Too few node parameters");
+	}
+	nodeValue = 0;
+	phiValue = 0;
+	phiDotValue = 0;
+	rValue = 0;
+	rDotValue = 0;
+	rDoubleDotValue = 0;
+	rConst = params[4];
+	frequencyOffset = params[0];
+	frequencyScale = params[1];
+	radiusOffset = params[2];
+	radiusScale = params[3];
+	dMin = params[5];
+	dMax = params[6];
+}
 	
+void CPGNode::updateDTs(double descCom)
+{
+	updateDTs(descCom, couplingSum());
+}
+
+double CPGNode::couplingSum() const
+{
 	/**
 	 * Iterate through every edge and affect the phase of this node
 	 * accordingly.
 	 * @todo ask about refactoring to use for_each
 	 */
+	double coupling = 0.0;
 	const std::size_t n = couplingList.size();
 	for (std::size_t i = 0; i != n; i++){
         const CPGNode& targetNode = *(couplingList[i]);
-        phiDotValue += weightList[i] * targetNode.rValue * sin (targetNode.phiValue - phiValue - phaseList[i]);
+        coupling += weightList[i] * targetNode.rValue * sin (targetNode.phiValue - phiValue - phaseList[i]);
 	}
+	return coupling;
+}
+
+void CPGNode::updateDTs(double descCom, double coupling)
+{
+	phiDotValue = 2 * M_PI * nodeEquation(descCom, frequencyOffset, frequencyScale)
+		+ coupling;
 	
 	rDoubleDotValue = rConst * (rConst / 4 * (nodeEquation(descCom, radiusOffset, radiusScale)
 		- rValue) - rDotValue);
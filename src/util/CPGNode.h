@@ -37,6 +37,9 @@ class CPGEdge;
 class CPGNode
 {
 	friend class CPGEquations;
+	friend class CPGNodeDynamics;
+	friend class CPGNodeFBDynamics;
+	template <typename Scalar> friend class CPGBatchT;
 	friend class CPGNodeFB;
     
 	public:
@@ -52,6 +55,13 @@ class CPGNode
 						const double cWeight,
 						const double cPhase);
 
+	/**
+	 * Take new parameters, as the constructor does, and go back to the
+	 * state a new node starts in. The couplings are kept.
+	 * @throw std::invalid_argument if there are too few parameters
+	 */
+	virtual void reset(const std::vector<double>& params);
+
 	/**
 	 * Update phiDotValue and rDoubleDotValue based on Node equations and
 	 * coupling equations
@@ -59,6 +69,17 @@ class CPGNode
 	 */
 	virtual void updateDTs(	double descCom);
 	
+	/**
+	 * Update phiDotValue and rDoubleDotValue with a coupling term that
+	 * was already summed, e.g. by CPGCoupling::sum
+	 */
+	void updateDTs(double descCom, double coupling);
+	
+	/**
+	 * Sum the coupling term over couplingList
+	 */
+	double couplingSum() const;
+	
 	/**
 	 * Compute the base node equation for R and Phi
 	 */
@@ -83,6 +104,13 @@ class CPGNode
 	}
 	
 	std::string toString(const std::string& prefix = "") const;
+
+	/** @return sizeof(CPGNode) and the bytes of the coupling lists */
+	std::size_t bytes() const
+	{
+		return sizeof(CPGNode) + couplingList.capacity() * sizeof(CPGNode*) +
+			(phaseList.capacity() + weightList.capacity()) * sizeof(double);
+	}
     
 	protected:
 	
@@ -106,18 +134,18 @@ class CPGNode
 	const int m_nodeNumber;
 	
 	/**
-	 * Parameters for node equations:
+	 * Parameters for node equations, rewritten only by reset()
 	 */
-	const double rConst;
+	double rConst;
 	
-	const double frequencyOffset;
-	const double frequencyScale;
+	double frequencyOffset;
+	double frequencyScale;
 	
-	const double radiusOffset;
-	const double radiusScale;
+	double radiusOffset;
+	double radiusScale;
 	
-	const double dMin;
-	const double dMax;
+	double dMin;
+	double dMax;
 	
 };
 
@@ -0,0 +1,160 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file CPGNodeDynamics.cpp
+ * @brief Implementation of the node equation policies of CPGIntegrator
+ * $Id$
+ */
+
+#include "CPGNodeDynamics.h"
+#include "CPGNode.h"
+#include "CPGNodeFB.h"
+
+// The C++ Standard Library
+#include <assert.h>
+#include <math.h>
+#include <stdexcept>
+
+const std::size_t CPGNodeDynamics::inputs;
+const std::size_t CPGNodeFBDynamics::inputs;
+
+void CPGNodeDynamics::build(const std::vector<CPGNode*>& nodes)
+{
+	const std::size_t n = nodes.size();
+	m_freqOffset.resize(n);
+	m_freqScale.resize(n);
+	m_radiusOffset.resize(n);
+	m_radiusScale.resize(n);
+	m_rConst.resize(n);
+	m_dMin.resize(n);
+	m_dMax.resize(n);
+	m_omega.resize(n);
+	m_rTarget.resize(n);
+	
+	for (std::size_t i = 0; i != n; i++)
+	{
+		const CPGNode& node = *nodes[i];
+		m_freqOffset[i] = node.frequencyOffset;
+		m_freqScale[i] = node.frequencyScale;
+		m_radiusOffset[i] = node.radiusOffset;
+		m_radiusScale[i] = node.radiusScale;
+		m_rConst[i] = node.rConst;
+		m_dMin[i] = node.dMin;
+		m_dMax[i] = node.dMax;
+	}
+}
+
+void CPGNodeDynamics::load(const std::vector<CPGNode*>& nodes, double* x) const
+{
+	for (std::size_t i = 0; i != nodes.size(); i++)
+	{
+		x[3 * i] = nodes[i]->phiValue;
+		x[3 * i + 1] = nodes[i]->rValue;
+		x[3 * i + 2] = nodes[i]->rDotValue;
+	}
+}
+
+void CPGNodeDynamics::store(const std::vector<CPGNode*>& nodes,
+							const double* x,
+							const double* dxdt) const
+{
+	for (std::size_t i = 0; i != nodes.size(); i++)
+	{
+		CPGNode& node = *nodes[i];
+		node.updateNodeValues(x[3 * i], x[3 * i + 1], x[3 * i + 2]);
+		node.phiDotValue = dxdt[3 * i];
+		node.rDoubleDotValue = dxdt[3 * i + 2];
+	}
+}
+
+void CPGNodeDynamics::setCommands(const std::vector<double>& descCom)
+{
+	assert(descCom.size() >= size());
+	for (std::size_t i = 0; i != size(); i++)
+	{
+		const double d = descCom[i];
+		const bool active = (d >= m_dMin[i] && d <= m_dMax[i]);
+		m_omega[i] = active ? 2 * M_PI * (m_freqScale[i] * d + m_freqOffset[i]) : 0.0;
+		m_rTarget[i] = active ? m_radiusScale[i] * d + m_radiusOffset[i] : 0.0;
+	}
+}
+
+void CPGNodeFBDynamics::build(const std::vector<CPGNode*>& nodes)
+{
+	const std::size_t n = nodes.size();
+	m_rConst.resize(n);
+	m_radiusOffset.resize(n);
+	m_kFreq.resize(n);
+	m_kAmp.resize(n);
+	m_kPhase.resize(n);
+	m_freqFeedback.resize(n);
+	m_radius.resize(n);
+	m_phaseFeedback.resize(n);
+	
+	for (std::size_t i = 0; i != n; i++)
+	{
+		const CPGNodeFB* node = dynamic_cast<const CPGNodeFB*>(nodes[i]);
+		if (node == NULL)
+		{
+			throw std::invalid_argument("Feedback CPG node is not a CPGNodeFB");
+		}
+		m_rConst[i] = node->rConst;
+		m_radiusOffset[i] = node->radiusOffset;
+		m_kFreq[i] = node->kFreq;
+		m_kAmp[i] = node->kAmp;
+		m_kPhase[i] = node->kPhase;
+	}
+}
+
+void CPGNodeFBDynamics::load(const std::vector<CPGNode*>& nodes, double* x) const
+{
+	for (std::size_t i = 0; i != nodes.size(); i++)
+	{
+		const CPGNodeFB& node = static_cast<const CPGNodeFB&>(*nodes[i]);
+		x[3 * i] = node.phiValue;
+		x[3 * i + 1] = node.rValue;
+		x[3 * i + 2] = node.omega;
+	}
+}
+
+void CPGNodeFBDynamics::store(const std::vector<CPGNode*>& nodes,
+							const double* x,
+							const double* dxdt) const
+{
+	for (std::size_t i = 0; i != nodes.size(); i++)
+	{
+		CPGNodeFB& node = static_cast<CPGNodeFB&>(*nodes[i]);
+		node.updateNodeValues(x[3 * i], x[3 * i + 1], x[3 * i + 2]);
+		node.phiDotValue = dxdt[3 * i];
+		node.rDotValue = dxdt[3 * i + 1];
+		node.omegaDot = dxdt[3 * i + 2];
+	}
+}
+
+void CPGNodeFBDynamics::setCommands(const std::vector<double>& feedback)
+{
+	assert(feedback.size() >= 3 * size());
+	for (std::size_t i = 0; i != size(); i++)
+	{
+		m_freqFeedback[i] = m_kFreq[i] * feedback[3 * i];
+		m_radius[i] = m_radiusOffset[i] + m_kAmp[i] * feedback[3 * i + 1];
+		m_phaseFeedback[i] = m_kPhase[i] * feedback[3 * i + 2];
+	}
+}
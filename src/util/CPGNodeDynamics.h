@@ -0,0 +1,151 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef SRC_UTIL_CPGS_CPGNODEDYNAMICS
+#define SRC_UTIL_CPGS_CPGNODEDYNAMICS
+
+/**
+ * @file CPGNodeDynamics.h
+ * @brief Definition of the node equation policies of CPGIntegrator
+ * $Id$
+ */
+
+#include "CPGCoupling.h"
+
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+class CPGNode;
+
+/**
+ * The equations of CPGNode::updateDTs, without feedback. The state of
+ * a node is phi, r and rDot, and its input is one descending command.
+ */
+class CPGNodeDynamics
+{
+public:
+
+	static const std::size_t inputs = 1;
+
+	void build(const std::vector<CPGNode*>& nodes);
+
+	std::size_t size() const { return m_rConst.size(); }
+
+	void load(const std::vector<CPGNode*>& nodes, double* x) const;
+
+	void store(const std::vector<CPGNode*>& nodes,
+				const double* x,
+				const double* dxdt) const;
+
+	/** Evaluate the node equations for the commands of this call */
+	void setCommands(const std::vector<double>& descCom);
+
+	void derivatives(const CPGCoupling& coupling,
+					const double* x,
+					double* dxdt) const
+	{
+		coupling.sumAll(x, x + 1, 3, dxdt, 3);
+		const std::size_t n = size();
+		for (std::size_t i = 0; i != n; i++)
+		{
+			const double r = x[3 * i + 1];
+			const double rDot = x[3 * i + 2];
+			const double k = m_rConst[i];
+			dxdt[3 * i] += m_omega[i];
+			dxdt[3 * i + 1] = rDot;
+			dxdt[3 * i + 2] = k * (k / 4 * (m_rTarget[i] - r) - rDot);
+		}
+	}
+
+private:
+
+	/** Node parameters, copied from CPGNode */
+	std::vector<double> m_freqOffset;
+	std::vector<double> m_freqScale;
+	std::vector<double> m_radiusOffset;
+	std::vector<double> m_radiusScale;
+	std::vector<double> m_rConst;
+	std::vector<double> m_dMin;
+	std::vector<double> m_dMax;
+
+	/** Per call: 2 pi times the frequency equation, and the target radius */
+	std::vector<double> m_omega;
+	std::vector<double> m_rTarget;
+};
+
+/**
+ * The equations of CPGNodeFB::updateDTs, with linear feedback. The
+ * state of a node is phi, r and omega, and its inputs are three
+ * feedback values, scaled by the node's kFreq, kAmp and kPhase.
+ * Feedback from a neural network enters the same way, as those inputs.
+ */
+class CPGNodeFBDynamics
+{
+public:
+
+	static const std::size_t inputs = 3;
+
+	/** @throw std::invalid_argument if a node is not a CPGNodeFB */
+	void build(const std::vector<CPGNode*>& nodes);
+
+	std::size_t size() const { return m_rConst.size(); }
+
+	void load(const std::vector<CPGNode*>& nodes, double* x) const;
+
+	void store(const std::vector<CPGNode*>& nodes,
+				const double* x,
+				const double* dxdt) const;
+
+	/** Scale the feedback of this call by the gains */
+	void setCommands(const std::vector<double>& feedback);
+
+	void derivatives(const CPGCoupling& coupling,
+					const double* x,
+					double* dxdt) const
+	{
+		coupling.sumAll(x, x + 1, 3, dxdt, 3);
+		const std::size_t n = size();
+		for (std::size_t i = 0; i != n; i++)
+		{
+			const double phi = x[3 * i];
+			const double r = x[3 * i + 1];
+			const double omega = x[3 * i + 2];
+			dxdt[3 * i] += omega + m_phaseFeedback[i];
+			dxdt[3 * i + 1] = m_rConst[i] * (m_radius[i] - r * r) * r;
+			dxdt[3 * i + 2] = m_freqFeedback[i] * sin(phi);
+		}
+	}
+
+private:
+
+	/** Node parameters, copied from CPGNodeFB */
+	std::vector<double> m_rConst;
+	std::vector<double> m_radiusOffset;
+	std::vector<double> m_kFreq;
+	std::vector<double> m_kAmp;
+	std::vector<double> m_kPhase;
+
+	/** Per call: the scaled feedback, and the target of r squared */
+	std::vector<double> m_freqFeedback;
+	std::vector<double> m_radius;
+	std::vector<double> m_phaseFeedback;
+};
+
+#endif // SRC_UTIL_CPGS_CPGNODEDYNAMICS
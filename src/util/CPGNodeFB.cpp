@@ -33,6 +33,7 @@
 #include <algorithm> //for_each
 #include <math.h> 
 #include <assert.h>
+#include <stdexcept>
 
 CPGNodeFB::CPGNodeFB(int nodeNum, const std::vector<double> & params):
 CPGNode(nodeNum, params),
@@ -51,6 +52,21 @@ CPGNodeFB::~CPGNodeFB()
 {
 
 }
+
+void CPGNodeFB::reset(const std::vector<double>& params)
+{
+	if (params.size() < 11)
+	{
+		throw std::invalid_argument("Too few node parameters");
+	}
+	CPGNode::reset(params);
+	omega = params[7];
+	omegaDot = 0;
+	kFreq = params[8];
+	kAmp = params[9];
+	kPhase = params[10];
+	rValue = sqrt(radiusOffset); // Jumpstart integration, as constructed
+}
 		
 void CPGNodeFB::updateDTs(const std::vector<double>& feedback)
 {
@@ -59,18 +75,12 @@ void CPGNodeFB::updateDTs(const std::vector<double>& feedback)
 #endif //BT_NO_PROFILE
 	assert(feedback.size() >= 3);
 	
-	phiDotValue = omega + kPhase * feedback [2];
-	
-	/**
-	 * Iterate through every edge and affect the phase of this node
-	 * accordingly.
-	 * @todo ask about refactoring to use for_each
-	 */
-    const std::size_t n = couplingList.size();
-	for (std::size_t i = 0; i != n; i++){
-        const CPGNode& targetNode = *couplingList[i];
-        phiDotValue += weightList[i] * targetNode.rValue * sin (targetNode.phiValue - phiValue - phaseList[i]);
-	}
+	updateDTs(&feedback[0], couplingSum());
+}
+
+void CPGNodeFB::updateDTs(const double* feedback, double coupling)
+{
+	phiDotValue = omega + kPhase * feedback [2] + coupling;
 	
 	omegaDot = kFreq * feedback[0] * sin(phiValue);
 	
@@ -38,6 +38,7 @@ class CPGEdge;
 class CPGNodeFB : public CPGNode
 {
 	friend class CPGEquationsFB;
+	friend class CPGNodeFBDynamics;
 	
 	public:
 	
@@ -49,12 +50,21 @@ class CPGNodeFB : public CPGNode
 	
 	virtual ~CPGNodeFB();
 	
+	/** @see CPGNode::reset; the feedback gains too */
+	virtual void reset(const std::vector<double>& params);
+	
 	/**
 	 * Update phiDotValue and rDoubleDotValue based on Node equations and
 	 * coupling equations
 	 * @todo better name?
 	 */
 	virtual void updateDTs(const std::vector<double>& feedback);
+	
+	/**
+	 * As above, with three feedback values and a coupling term that
+	 * was already summed, e.g. by CPGCoupling::sum
+	 */
+	void updateDTs(const double* feedback, double coupling);
 			
 	void updateNodeValues (	double newR,
 							double newPhi,
@@ -68,9 +78,9 @@ class CPGNodeFB : public CPGNode
 	double omega;
 	double omegaDot;
 	
-	const double kFreq;
-	const double kAmp;
-	const double kPhase;
+	double kFreq;
+	double kAmp;
+	double kPhase;
 	
 };
 #endif // SIMULATOR_SRC_LIB_MODELS_SNAKE_CPGS_CPGNODE
@@ -0,0 +1,266 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file EvolutionCheckpoint.cpp
+ * @brief Implementation of class EvolutionCheckpoint
+ * $Id$
+ */
+
+#include "EvolutionCheckpoint.h"
+
+// Boost
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+// The C++ Standard Library
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace
+{
+	const char kMagic[8] = {'N', 'T', 'R', 'T', 'C', 'K', '1', '\0'};
+
+	void putRaw(std::string& out, const void* data, std::size_t size)
+	{
+		out.append(static_cast<const char*>(data), size);
+	}
+
+	void putInt(std::string& out, boost::int32_t value)
+	{
+		putRaw(out, &value, sizeof(value));
+	}
+
+	void putDouble(std::string& out, double value)
+	{
+		putRaw(out, &value, sizeof(value));
+	}
+
+	void putDoubles(std::string& out, const std::vector<double>& values)
+	{
+		putInt(out, static_cast<boost::int32_t>(values.size()));
+		if (!values.empty())
+		{
+			putRaw(out, &values[0], values.size() * sizeof(double));
+		}
+	}
+
+	/** Reads what the put functions wrote, checking every length */
+	class Reader
+	{
+	public:
+		Reader(const std::string& data) : m_data(data), m_offset(0) { }
+
+		void raw(void* out, std::size_t size)
+		{
+			if (size > m_data.size() - m_offset)
+			{
+				throw std::runtime_error("Checkpoint file is truncated");
+			}
+			std::memcpy(out, m_data.data() + m_offset, size);
+			m_offset += size;
+		}
+
+		boost::int32_t integer()
+		{
+			boost::int32_t value;
+			raw(&value, sizeof(value));
+			return value;
+		}
+
+		/** A size, which can't be negative */
+		std::size_t count()
+		{
+			const boost::int32_t value = integer();
+			// Every element takes at least a byte
+			if (value < 0 ||
+				static_cast<std::size_t>(value) > m_data.size() - m_offset)
+			{
+				throw std::runtime_error("Checkpoint file is corrupt");
+			}
+			return static_cast<std::size_t>(value);
+		}
+
+		double real()
+		{
+			double value;
+			raw(&value, sizeof(value));
+			return value;
+		}
+
+		void reals(std::vector<double>& out)
+		{
+			const std::size_t n = count();
+			if (n > (m_data.size() - m_offset) / sizeof(double))
+			{
+				throw std::runtime_error("Checkpoint file is truncated");
+			}
+			out.resize(n);
+			if (n > 0)
+			{
+				raw(&out[0], n * sizeof(double));
+			}
+		}
+
+		bool done() const { return m_offset == m_data.size(); }
+
+	private:
+		const std::string& m_data;
+		std::size_t m_offset;
+	};
+}
+
+EvolutionCheckpoint::Member::Member() :
+	maxScore(0.0),
+	maxScore1(0.0),
+	maxScore2(0.0),
+	averageScore(0.0)
+{
+}
+
+EvolutionCheckpoint::EvolutionCheckpoint() :
+	generationNumber(0),
+	currentTest(0),
+	subTests(0),
+	temperature(0.0),
+	kernels(ParameterKernels().getState())
+{
+}
+
+EvolutionCheckpoint::~EvolutionCheckpoint()
+{
+	if (m_pWriter)
+	{
+		m_pWriter->join();
+	}
+}
+
+void EvolutionCheckpoint::save(const std::string& path)
+{
+	// m_buffer belongs to the writer until it finishes
+	wait();
+
+	m_buffer.clear();
+	putRaw(m_buffer, kMagic, sizeof(kMagic));
+	putInt(m_buffer, generationNumber);
+	putInt(m_buffer, currentTest);
+	putInt(m_buffer, subTests);
+	putDouble(m_buffer, temperature);
+	putRaw(m_buffer, &kernels, sizeof(kernels));
+	putInt(m_buffer, static_cast<boost::int32_t>(engine.size()));
+	putRaw(m_buffer, engine.data(), engine.size());
+	putInt(m_buffer, static_cast<boost::int32_t>(populations.size()));
+	for (std::size_t i = 0; i < populations.size(); i++)
+	{
+		const std::vector<Member>& members = populations[i];
+		putInt(m_buffer, static_cast<boost::int32_t>(members.size()));
+		for (std::size_t j = 0; j < members.size(); j++)
+		{
+			putDoubles(m_buffer, members[j].parameters);
+			putDoubles(m_buffer, members[j].pastScores);
+			putDouble(m_buffer, members[j].maxScore);
+			putDouble(m_buffer, members[j].maxScore1);
+			putDouble(m_buffer, members[j].maxScore2);
+			putDouble(m_buffer, members[j].averageScore);
+		}
+	}
+
+	m_pWriter.reset(new boost::thread(boost::bind(&EvolutionCheckpoint::write,
+													this, path)));
+}
+
+void EvolutionCheckpoint::wait()
+{
+	if (m_pWriter)
+	{
+		m_pWriter->join();
+		m_pWriter.reset();
+	}
+	if (!m_error.empty())
+	{
+		const std::string error = m_error;
+		m_error.clear();
+		throw std::runtime_error(error);
+	}
+}
+
+void EvolutionCheckpoint::write(std::string path)
+{
+	const std::string temporary = path + ".tmp";
+	std::ofstream file(temporary.c_str(), std::ios::out | std::ios::binary);
+	file.write(m_buffer.data(), m_buffer.size());
+	file.close();
+	if (!file || std::rename(temporary.c_str(), path.c_str()) != 0)
+	{
+		m_error = "Could not write checkpoint " + path;
+	}
+}
+
+bool EvolutionCheckpoint::load(const std::string& path)
+{
+	wait();
+
+	std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+	const std::string data((std::istreambuf_iterator<char>(file)),
+							std::istreambuf_iterator<char>());
+
+	Reader in(data);
+	char magic[sizeof(kMagic)];
+	in.raw(magic, sizeof(magic));
+	if (std::memcmp(magic, kMagic, sizeof(kMagic)) != 0)
+	{
+		throw std::runtime_error(path + " is not a checkpoint");
+	}
+	generationNumber = in.integer();
+	currentTest = in.integer();
+	subTests = in.integer();
+	temperature = in.real();
+	in.raw(&kernels, sizeof(kernels));
+	engine.resize(in.count());
+	if (!engine.empty())
+	{
+		in.raw(&engine[0], engine.size());
+	}
+	populations.resize(in.count());
+	for (std::size_t i = 0; i < populations.size(); i++)
+	{
+		std::vector<Member>& members = populations[i];
+		members.resize(in.count());
+		for (std::size_t j = 0; j < members.size(); j++)
+		{
+			in.reals(members[j].parameters);
+			in.reals(members[j].pastScores);
+			members[j].maxScore = in.real();
+			members[j].maxScore1 = in.real();
+			members[j].maxScore2 = in.real();
+			members[j].averageScore = in.real();
+		}
+	}
+	if (!in.done())
+	{
+		throw std::runtime_error(path + " has trailing data");
+	}
+	return true;
+}
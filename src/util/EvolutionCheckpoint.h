@@ -0,0 +1,122 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef SRC_UTIL_EVOLUTION_CHECKPOINT
+#define SRC_UTIL_EVOLUTION_CHECKPOINT
+
+/**
+ * @file EvolutionCheckpoint.h
+ * @brief Definition of class EvolutionCheckpoint
+ * $Id$
+ */
+
+#include "ParameterKernels.h"
+
+// Boost
+#include <boost/scoped_ptr.hpp>
+
+// The C++ Standard Library
+#include <string>
+#include <vector>
+
+// Forward declarations
+namespace boost
+{
+	class thread;
+}
+
+/**
+ * The state of a NeuroEvolution or AnnealEvolution run between two
+ * generations: the populations' parameters and score histories, the
+ * counters and the random engines. save() copies it into a buffer and
+ * writes that to disk on a thread of its own, so the learner carries on
+ * while the file is written; the file is only replaced once complete.
+ *
+ * The file is an 8 byte magic "NTRTCK1", then everything in declaration
+ * order: integers as 32 bits, sizes before their vectors, doubles and
+ * integers little endian like ParameterBlob. The engine is stored as the
+ * text its operator<< writes.
+ */
+class EvolutionCheckpoint
+{
+public:
+
+	/** One member of a population */
+	struct Member
+	{
+		Member();
+
+		/** Stateless parameters; empty for a neural network */
+		std::vector<double> parameters;
+		std::vector<double> pastScores;
+		double maxScore;
+		double maxScore1;
+		double maxScore2;
+		double averageScore;
+	};
+
+	EvolutionCheckpoint();
+
+	/** Waits for the last save() */
+	~EvolutionCheckpoint();
+
+	/**
+	 * Write the state to path in the background. An earlier save is
+	 * waited for first. The file is written as path + ".tmp" and renamed.
+	 */
+	void save(const std::string& path);
+
+	/**
+	 * Wait for the last save() to finish
+	 * @throw std::runtime_error if it failed
+	 */
+	void wait();
+
+	/**
+	 * Replace the state with the contents of a file
+	 * @return false if there is no such file
+	 * @throw std::runtime_error if it is not a valid checkpoint
+	 */
+	bool load(const std::string& path);
+
+	int generationNumber;
+	int currentTest;
+	int subTests;
+	/** The annealing temperature; unused by NeuroEvolution */
+	double temperature;
+	ParameterKernels::State kernels;
+	/** The std::tr1 engine as written by operator<<, empty if none */
+	std::string engine;
+	/** Each population's members, in order */
+	std::vector< std::vector<Member> > populations;
+
+private:
+
+	/** Write m_buffer to disk; runs on m_pWriter */
+	void write(std::string path);
+
+	/** The serialized state of the save in progress */
+	std::string m_buffer;
+
+	boost::scoped_ptr<boost::thread> m_pWriter;
+
+	/** Set by write() if the file could not be written */
+	std::string m_error;
+};
+
+#endif // SRC_UTIL_EVOLUTION_CHECKPOINT
@@ -0,0 +1,228 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file FitnessCache.cpp
+ * @brief Implementation of class FitnessCache
+ * $Id$
+ */
+
+#include "FitnessCache.h"
+
+// The C++ Standard Library
+#include <algorithm>
+#include <math.h>
+#include <stdexcept>
+
+FitnessCache::FitnessCache(double resolution, std::size_t capacity) :
+	m_resolution(resolution),
+	m_capacity(capacity)
+{
+	if (resolution <= 0.0 || capacity == 0)
+	{
+		throw std::invalid_argument("Resolution and capacity must be positive");
+	}
+}
+
+FitnessCache::Key FitnessCache::quantize(const std::vector<double>& params) const
+{
+	Key key(params.size());
+	for (std::size_t i = 0; i < params.size(); i++)
+	{
+		key[i] = static_cast<boost::int64_t>(floor(params[i] / m_resolution + 0.5));
+	}
+	return key;
+}
+
+boost::uint64_t FitnessCache::hash(const Key& key)
+{
+	// FNV-1a over the bytes of each step
+	boost::uint64_t h = 14695981039346656037ULL;
+	for (std::size_t i = 0; i < key.size(); i++)
+	{
+		boost::uint64_t v = static_cast<boost::uint64_t>(key[i]);
+		for (int b = 0; b < 8; b++)
+		{
+			h ^= (v >> (8 * b)) & 0xff;
+			h *= 1099511628211ULL;
+		}
+	}
+	return h;
+}
+
+std::size_t FitnessCache::locate(const Key& key, boost::uint64_t h) const
+{
+	typedef std::multimap<boost::uint64_t, std::size_t>::const_iterator Iterator;
+	const std::pair<Iterator, Iterator> range = m_index.equal_range(h);
+	for (Iterator it = range.first; it != range.second; ++it)
+	{
+		if (m_entries[it->second].key == key)
+		{
+			return it->second;
+		}
+	}
+	return m_entries.size();
+}
+
+bool FitnessCache::find(const std::vector<double>& params,
+						std::vector<double>& scores) const
+{
+	const Key key = quantize(params);
+	const std::size_t i = locate(key, hash(key));
+	if (i == m_entries.size())
+	{
+		return false;
+	}
+	scores = m_entries[i].scores;
+	return true;
+}
+
+void FitnessCache::insert(const std::vector<double>& params,
+						  const std::vector<double>& scores)
+{
+	const Key key = quantize(params);
+	const boost::uint64_t h = hash(key);
+	const std::size_t i = locate(key, h);
+	if (i < m_entries.size())
+	{
+		// A running mean of every simulation of the vector
+		Entry& entry = m_entries[i];
+		entry.count++;
+		const std::size_t n = std::min(entry.scores.size(), scores.size());
+		entry.scores.resize(n);
+		for (std::size_t j = 0; j < n; j++)
+		{
+			entry.scores[j] += (scores[j] - entry.scores[j]) / entry.count;
+		}
+		return;
+	}
+
+	std::size_t slot = m_entries.size();
+	if (slot == m_capacity)
+	{
+		slot = evictOldest();
+	}
+	else
+	{
+		m_entries.push_back(Entry());
+	}
+	Entry& entry = m_entries[slot];
+	entry.key = key;
+	entry.params = params;
+	entry.scores = scores;
+	entry.count = 1;
+	m_index.insert(std::make_pair(h, slot));
+	m_order.push_back(slot);
+}
+
+std::size_t FitnessCache::evictOldest()
+{
+	const std::size_t slot = m_order.front();
+	m_order.pop_front();
+
+	typedef std::multimap<boost::uint64_t, std::size_t>::iterator Iterator;
+	const std::pair<Iterator, Iterator> range =
+		m_index.equal_range(hash(m_entries[slot].key));
+	for (Iterator it = range.first; it != range.second; ++it)
+	{
+		if (it->second == slot)
+		{
+			m_index.erase(it);
+			break;
+		}
+	}
+	return slot;
+}
+
+bool FitnessCache::predict(const std::vector<double>& params, std::size_t k,
+						   double& score) const
+{
+	if (k == 0 || m_entries.size() < k)
+	{
+		return false;
+	}
+
+	// (squared distance, entry) of every scored vector, nearest k first
+	std::vector< std::pair<double, std::size_t> > nearest;
+	nearest.reserve(m_entries.size());
+	for (std::size_t i = 0; i < m_entries.size(); i++)
+	{
+		const Entry& entry = m_entries[i];
+		if (entry.scores.empty() || entry.params.size() != params.size())
+		{
+			continue;
+		}
+		double d2 = 0.0;
+		for (std::size_t j = 0; j < params.size(); j++)
+		{
+			const double d = entry.params[j] - params[j];
+			d2 += d * d;
+		}
+		nearest.push_back(std::make_pair(d2, i));
+	}
+	if (nearest.size() < k)
+	{
+		return false;
+	}
+	std::partial_sort(nearest.begin(), nearest.begin() + k, nearest.end());
+
+	double weights = 0.0;
+	double sum = 0.0;
+	for (std::size_t n = 0; n < k; n++)
+	{
+		const Entry& entry = m_entries[nearest[n].second];
+		const double distance = sqrt(nearest[n].first);
+		if (distance < m_resolution)
+		{
+			score = entry.scores[0];
+			return true;
+		}
+		weights += 1.0 / distance;
+		sum += entry.scores[0] / distance;
+	}
+	score = sum / weights;
+	return true;
+}
+
+double FitnessCache::quantile(double q) const
+{
+	std::vector<double> scores;
+	scores.reserve(m_entries.size());
+	for (std::size_t i = 0; i < m_entries.size(); i++)
+	{
+		if (!m_entries[i].scores.empty())
+		{
+			scores.push_back(m_entries[i].scores[0]);
+		}
+	}
+	if (scores.empty())
+	{
+		throw std::runtime_error("No scores are cached");
+	}
+	q = std::max(0.0, std::min(1.0, q));
+	const std::size_t i = static_cast<std::size_t>(q * (scores.size() - 1));
+	std::nth_element(scores.begin(), scores.begin() + i, scores.end());
+	return scores[i];
+}
+
+void FitnessCache::clear()
+{
+	m_entries.clear();
+	m_order.clear();
+	m_index.clear();
+}
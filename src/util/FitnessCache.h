@@ -0,0 +1,123 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef SRC_UTIL_FITNESS_CACHE
+#define SRC_UTIL_FITNESS_CACHE
+
+/**
+ * @file FitnessCache.h
+ * @brief Definition of class FitnessCache
+ * $Id$
+ */
+
+// Boost
+#include <boost/cstdint.hpp>
+
+// The C++ Standard Library
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <vector>
+
+/**
+ * Scores of the parameter vectors a learning run has already simulated,
+ * so evolution can skip trials it would only repeat: elites carried into
+ * the next generation, children of identical parents, or members that
+ * mutation left inside one quantization step. Vectors are quantized to
+ * multiples of the resolution and found by a 64 bit hash of the result;
+ * repeated scores of one vector are averaged.
+ *
+ * predict() is a k nearest neighbour surrogate of the first score over
+ * the cached vectors, for screening out candidates that are likely to be
+ * poor before simulating them. Both only make sense for deterministic
+ * trials. The oldest entries are dropped beyond the capacity.
+ */
+class FitnessCache
+{
+public:
+
+	typedef std::vector<boost::int64_t> Key;
+
+	/**
+	 * @param[in] resolution the quantization step, must be positive
+	 * @param[in] capacity the number of vectors kept, must be positive
+	 * @throw std::invalid_argument if either is not positive
+	 */
+	FitnessCache(double resolution = 1.0e-6, std::size_t capacity = 10000);
+
+	/**
+	 * @param[out] scores the mean scores of params, if cached
+	 * @return true if params was cached
+	 */
+	bool find(const std::vector<double>& params,
+			  std::vector<double>& scores) const;
+
+	/** Record the scores of one simulation of params */
+	void insert(const std::vector<double>& params,
+				const std::vector<double>& scores);
+
+	/**
+	 * Predict the first score of params as the inverse distance weighted
+	 * mean over its k nearest cached vectors.
+	 * @return false if fewer than k vectors are cached
+	 */
+	bool predict(const std::vector<double>& params, std::size_t k,
+				 double& score) const;
+
+	/**
+	 * @return the q quantile, in [0, 1], of the cached first scores
+	 * @throw std::runtime_error if no scores are cached
+	 */
+	double quantile(double q) const;
+
+	std::size_t size() const { return m_entries.size(); }
+
+	void clear();
+
+	/** @return params in multiples of the resolution, the key compared */
+	Key quantize(const std::vector<double>& params) const;
+
+private:
+
+	struct Entry
+	{
+		Key key;
+		std::vector<double> params;
+		std::vector<double> scores;
+		std::size_t count;
+	};
+
+	static boost::uint64_t hash(const Key& key);
+
+	/** @return the index of the entry of key, or m_entries.size() */
+	std::size_t locate(const Key& key, boost::uint64_t h) const;
+
+	/** Remove the oldest entry from the index, @return its slot */
+	std::size_t evictOldest();
+
+	double m_resolution;
+	std::size_t m_capacity;
+
+	std::vector<Entry> m_entries;
+	/** Indices into m_entries, oldest first */
+	std::deque<std::size_t> m_order;
+	/** Entry indices by hash; collisions share a hash */
+	std::multimap<boost::uint64_t, std::size_t> m_index;
+};
+
+#endif // SRC_UTIL_FITNESS_CACHE
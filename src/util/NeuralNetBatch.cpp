@@ -0,0 +1,233 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file NeuralNetBatch.cpp
+ * @brief Implementation of class NeuralNetBatch
+ * $Id$
+ */
+
+#include "NeuralNetBatch.h"
+#include "NeuralNetWeights.h"
+
+// The C++ Standard Library
+#include <assert.h>
+#include <math.h>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	std::size_t layerSize(int n)
+	{
+		if (n <= 0)
+		{
+			throw std::invalid_argument("Layer sizes must be positive");
+		}
+		return n;
+	}
+}
+
+NeuralNetBatch::NeuralNetBatch(int inputs, int hidden, int outputs) :
+m_inputs(layerSize(inputs)),
+m_hidden(layerSize(hidden)),
+m_outputs(layerSize(outputs)),
+m_networks(0),
+m_batch(0),
+m_stride(0)
+{
+}
+
+std::size_t NeuralNetBatch::addNetwork(const std::string& weightsFile)
+{
+	const NeuralNetWeights weights(weightsFile);
+	const bool shaped = weights.inputs() != 0 || weights.hidden() != 0 ||
+						weights.outputs() != 0;
+	if (weights.size() != weightCount() ||
+		(shaped && (weights.inputs() != static_cast<int>(m_inputs) ||
+					weights.hidden() != static_cast<int>(m_hidden) ||
+					weights.outputs() != static_cast<int>(m_outputs))))
+	{
+		throw std::invalid_argument("Wrong number of weights in " + weightsFile);
+	}
+	return addNetwork(weights.data());
+}
+
+std::size_t NeuralNetBatch::addNetwork(const double* weights)
+{
+	m_weights.insert(m_weights.end(), weights, weights + weightCount());
+	return m_networks++;
+}
+
+void NeuralNetBatch::clear()
+{
+	m_weights.clear();
+	m_networks = 0;
+}
+
+void NeuralNetBatch::evaluate(std::size_t network,
+								const double* inputs,
+								std::size_t count,
+								double* outputs)
+{
+	if (network >= m_networks)
+	{
+		throw std::invalid_argument("Network index out of bounds");
+	}
+
+	m_patterns.resize(count);
+	for (std::size_t p = 0; p < count; p++)
+	{
+		m_patterns[p] = p;
+	}
+	m_batch = count;
+	reserve(count);
+
+	for (std::size_t p = 0; p < count; p++)
+	{
+		for (std::size_t i = 0; i < m_inputs; i++)
+		{
+			m_in[i * m_stride + p] = inputs[p * m_inputs + i];
+		}
+	}
+
+	feedForward(network);
+
+	for (std::size_t p = 0; p < count; p++)
+	{
+		for (std::size_t k = 0; k < m_outputs; k++)
+		{
+			outputs[p * m_outputs + k] = m_out[k * m_stride + p];
+		}
+	}
+}
+
+void NeuralNetBatch::evaluateAll(const std::size_t* networks,
+									const double* inputs,
+									std::size_t count,
+									double* outputs)
+{
+	reserve(count);
+	for (std::size_t p = 0; p < count; p++)
+	{
+		if (networks[p] >= m_networks)
+		{
+			throw std::invalid_argument("Network index out of bounds");
+		}
+	}
+	m_patterns.reserve(count);
+
+	for (std::size_t n = 0; n < m_networks; n++)
+	{
+		// Gather this network's patterns, transposed
+		m_patterns.clear();
+		for (std::size_t p = 0; p < count; p++)
+		{
+			if (networks[p] == n)
+			{
+				const std::size_t b = m_patterns.size();
+				for (std::size_t i = 0; i < m_inputs; i++)
+				{
+					m_in[i * m_stride + b] = inputs[p * m_inputs + i];
+				}
+				m_patterns.push_back(p);
+			}
+		}
+		m_batch = m_patterns.size();
+		if (m_batch == 0)
+		{
+			continue;
+		}
+
+		feedForward(n);
+
+		for (std::size_t b = 0; b < m_batch; b++)
+		{
+			const std::size_t p = m_patterns[b];
+			for (std::size_t k = 0; k < m_outputs; k++)
+			{
+				outputs[p * m_outputs + k] = m_out[k * m_stride + b];
+			}
+		}
+	}
+}
+
+void NeuralNetBatch::reserve(std::size_t count)
+{
+	if (m_stride < count)
+	{
+		m_stride = count;
+		m_in.resize(m_inputs * m_stride);
+		m_hiddenValues.resize(m_hidden * m_stride);
+		m_out.resize(m_outputs * m_stride);
+	}
+}
+
+void NeuralNetBatch::feedForward(std::size_t network)
+{
+	const double* w = &m_weights[network * weightCount()];
+	layer(w, m_inputs, m_hidden, &m_in[0], &m_hiddenValues[0]);
+	layer(w + (m_inputs + 1) * m_hidden, m_hidden, m_outputs,
+			&m_hiddenValues[0], &m_out[0]);
+}
+
+void NeuralNetBatch::layer(const double* w, std::size_t n, std::size_t m,
+							const double* in, double* out)
+{
+	const std::size_t stride = m_stride;
+	const std::size_t batch = m_batch;
+	for (std::size_t j = 0; j < m; j++)
+	{
+		double* const acc = out + j * stride;
+		for (std::size_t p = 0; p < batch; p++)
+		{
+			acc[p] = 0.0;
+		}
+
+		for (std::size_t i = 0; i < n; i++)
+		{
+			const double wij = w[i * m + j];
+			const double* const x = in + i * stride;
+			std::size_t p = 0;
+#ifdef __SSE2__
+			const __m128d vw = _mm_set1_pd(wij);
+			for (; p + 2 <= batch; p += 2)
+			{
+				const __m128d sum = _mm_add_pd(_mm_loadu_pd(acc + p),
+									_mm_mul_pd(vw, _mm_loadu_pd(x + p)));
+				_mm_storeu_pd(acc + p, sum);
+			}
+#endif
+			for (; p < batch; p++)
+			{
+				acc[p] += wij * x[p];
+			}
+		}
+
+		// The bias neuron is -1, summed last as neuralNetwork does
+		const double bias = w[n * m + j];
+		for (std::size_t p = 0; p < batch; p++)
+		{
+			acc[p] = 1.0 / (1.0 + exp(-(acc[p] - bias)));
+		}
+	}
+}
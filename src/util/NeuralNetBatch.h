@@ -0,0 +1,167 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef SRC_UTIL_NEURAL_NET_BATCH
+#define SRC_UTIL_NEURAL_NET_BATCH
+
+/**
+ * @file NeuralNetBatch.h
+ * @brief Definition of class NeuralNetBatch
+ * $Id$
+ */
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * Inference for several networks of the shape used by neuralNetwork
+ * from nnImplementationV2: one sigmoid hidden layer and sigmoid outputs,
+ * with a bias input of -1 on the input and hidden layers. The weights
+ * files written by neuralNetwork::saveWeights() load unchanged.
+ *
+ * evaluate() runs many input patterns at once, such as the state of
+ * every actuator, or of every actuator in several worlds. The patterns
+ * of each network are transposed to [input][pattern] so the
+ * multiply-adds run over contiguous patterns, two at a time with SSE2
+ * where available. Evaluating allocates nothing once the scratch space
+ * has grown to the largest batch.
+ */
+class NeuralNetBatch
+{
+public:
+
+	/**
+	 * @throw std::invalid_argument if a layer size is not positive
+	 */
+	NeuralNetBatch(int inputs, int hidden, int outputs);
+
+	/**
+	 * Add a network from a weights file in neuralNetwork's format: the
+	 * input to hidden weights, input major, then the hidden to output
+	 * weights, hidden major, each layer including its bias row, separated
+	 * by commas. The same values in the binary format of NeuralNetWeights
+	 * are mapped rather than parsed.
+	 * @return the index of the network
+	 * @throw std::invalid_argument if the file can't be read or holds
+	 * the wrong number of weights, or a binary file is of another shape
+	 */
+	std::size_t addNetwork(const std::string& weightsFile);
+
+	/**
+	 * Add a network from weights in the order of a weights file.
+	 * @param[in] weights weightCount() values
+	 * @return the index of the network
+	 */
+	std::size_t addNetwork(const double* weights);
+
+	void clear();
+
+	std::size_t size() const
+	{
+		return m_networks;
+	}
+
+	std::size_t weightCount() const
+	{
+		return (m_inputs + 1) * m_hidden + (m_hidden + 1) * m_outputs;
+	}
+
+	/**
+	 * Feed count patterns through one network, the same as calling
+	 * neuralNetwork::feedForwardPattern() on each.
+	 * @param[in] inputs count patterns of getInputs() values
+	 * @param[out] outputs count patterns of getOutputs() values
+	 */
+	void evaluate(std::size_t network,
+					const double* inputs,
+					std::size_t count,
+					double* outputs);
+
+	/**
+	 * Feed count patterns through the networks they are assigned to,
+	 * one pass per network.
+	 * @param[in] networks the network of each pattern
+	 */
+	void evaluateAll(const std::size_t* networks,
+						const double* inputs,
+						std::size_t count,
+						double* outputs);
+
+	std::size_t getInputs() const
+	{
+		return m_inputs;
+	}
+
+	std::size_t getOutputs() const
+	{
+		return m_outputs;
+	}
+
+	/** @return the bytes of the weights and the scratch, for tgMemoryReport */
+	std::size_t bytes() const
+	{
+		return sizeof(*this) + m_patterns.capacity() * sizeof(std::size_t) +
+			(m_weights.capacity() + m_in.capacity() +
+			 m_hiddenValues.capacity() + m_out.capacity()) * sizeof(double);
+	}
+
+private:
+
+	/** Grow the scratch to hold count patterns */
+	void reserve(std::size_t count);
+
+	/**
+	 * Evaluate the m_batch patterns in m_in, leaving the outputs in
+	 * m_out, both laid out [neuron][pattern]
+	 */
+	void feedForward(std::size_t network);
+
+	/**
+	 * Set out[j][p] = sigmoid(sum over i of in[i][p] * w[i][j]), where
+	 * the last of the n + 1 rows of w weighs the bias
+	 */
+	void layer(const double* w, std::size_t n, std::size_t m,
+				const double* in, double* out);
+
+	const std::size_t m_inputs;
+	const std::size_t m_hidden;
+	const std::size_t m_outputs;
+
+	std::size_t m_networks;
+
+	/** weightCount() values per network, in the order of the files */
+	std::vector<double> m_weights;
+
+	/** Scratch, [neuron][pattern] with a stride of m_stride */
+	std::vector<double> m_in;
+	std::vector<double> m_hiddenValues;
+	std::vector<double> m_out;
+
+	/** The patterns of the current pass */
+	std::size_t m_batch;
+
+	/** Room for patterns per neuron in the scratch */
+	std::size_t m_stride;
+
+	/** The patterns gathered into the current pass */
+	std::vector<std::size_t> m_patterns;
+};
+
+#endif
@@ -0,0 +1,209 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file NeuralNetWeights.cpp
+ * @brief Implementation of class NeuralNetWeights
+ * $Id$
+ */
+
+#include "NeuralNetWeights.h"
+
+// The C++ Standard Library
+#include <stdlib.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+	const char magic[8] = { 'N', 'T', 'R', 'T', 'N', 'N', 'W', '\0' };
+
+	/** The layout of the start of a binary file */
+	struct Header
+	{
+		char magic[8];
+		boost::uint32_t version;
+		boost::int32_t inputs;
+		boost::int32_t hidden;
+		boost::int32_t outputs;
+		boost::uint64_t count;
+	};
+
+	/** Write to a temporary file, renamed over path once complete */
+	void writeFile(const std::string& path, const std::string& contents)
+	{
+		const std::string temporary = path + ".tmp";
+		std::ofstream file(temporary.c_str(), std::ios::out | std::ios::binary);
+		file.write(contents.data(), contents.size());
+		file.close();
+		if (!file || std::rename(temporary.c_str(), path.c_str()) != 0)
+		{
+			std::remove(temporary.c_str());
+			throw std::runtime_error("Could not write weights file " + path);
+		}
+	}
+}
+
+const boost::uint32_t NeuralNetWeights::version;
+
+NeuralNetWeights::NeuralNetWeights(const std::string& path) :
+m_data(NULL),
+m_size(0),
+m_inputs(0),
+m_hidden(0),
+m_outputs(0)
+{
+	if (isBinary(path))
+	{
+		map(path);
+	}
+	else
+	{
+		parse(path);
+	}
+}
+
+bool NeuralNetWeights::isBinary(const std::string& path)
+{
+	std::ifstream input(path.c_str(), std::ios::in | std::ios::binary);
+	char start[sizeof(magic)];
+	return input.read(start, sizeof(start)) &&
+			std::memcmp(start, magic, sizeof(magic)) == 0;
+}
+
+void NeuralNetWeights::map(const std::string& path)
+{
+	try
+	{
+		m_file = tgAssetCache::map(path);
+	}
+	catch (const std::runtime_error& e)
+	{
+		throw std::invalid_argument("Could not map weights file " + path + ": " + e.what());
+	}
+
+	if (m_file->size() < sizeof(Header))
+	{
+		throw std::invalid_argument("Truncated weights file " + path);
+	}
+	const char* start = m_file->data();
+	Header header;
+	std::memcpy(&header, start, sizeof(header));
+
+	if (header.version != version)
+	{
+		// A file of the other byte order reads its version swapped
+		throw std::invalid_argument("Unsupported version or byte order of weights file " + path);
+	}
+	if (m_file->size() != sizeof(Header) + header.count * sizeof(double))
+	{
+		throw std::invalid_argument("Wrong length of weights file " + path);
+	}
+
+	// The header is a multiple of 8 bytes and pages are aligned
+	m_data = reinterpret_cast<const double*>(start + sizeof(Header));
+	m_size = header.count;
+	m_inputs = header.inputs;
+	m_hidden = header.hidden;
+	m_outputs = header.outputs;
+}
+
+void NeuralNetWeights::parse(const std::string& path)
+{
+	std::ifstream input(path.c_str());
+	if (!input.is_open())
+	{
+		throw std::invalid_argument("Could not open weights file " + path);
+	}
+	std::stringstream buffer;
+	buffer << input.rdbuf();
+	const std::string text = buffer.str();
+
+	// Values are separated by commas, and possibly line breaks
+	const char* p = text.c_str();
+	while (*p != '\0')
+	{
+		char* end;
+		const double value = strtod(p, &end);
+		if (end == p)
+		{
+			p++;
+		}
+		else
+		{
+			m_text.push_back(value);
+			p = end;
+		}
+	}
+
+	m_data = m_text.empty() ? NULL : &m_text[0];
+	m_size = m_text.size();
+}
+
+void NeuralNetWeights::writeBinary(const std::string& path,
+									const double* values, std::size_t count,
+									int inputs, int hidden, int outputs)
+{
+	Header header;
+	std::memcpy(header.magic, magic, sizeof(magic));
+	header.version = version;
+	header.inputs = inputs;
+	header.hidden = hidden;
+	header.outputs = outputs;
+	header.count = count;
+
+	std::string contents(reinterpret_cast<const char*>(&header), sizeof(header));
+	contents.append(reinterpret_cast<const char*>(values), count * sizeof(double));
+	writeFile(path, contents);
+}
+
+void NeuralNetWeights::writeText(const std::string& path,
+									const double* values, std::size_t count)
+{
+	std::string contents;
+	char value[32];
+	for (std::size_t i = 0; i < count; i++)
+	{
+		// Enough digits to read back the same double
+		std::sprintf(value, i == 0 ? "%.17g" : ",%.17g", values[i]);
+		contents += value;
+	}
+	writeFile(path, contents);
+}
+
+void NeuralNetWeights::toBinary(const std::string& from, const std::string& to,
+								int inputs, int hidden, int outputs)
+{
+	const NeuralNetWeights weights(from);
+	if (weights.isMapped() && inputs == 0 && hidden == 0 && outputs == 0)
+	{
+		inputs = weights.inputs();
+		hidden = weights.hidden();
+		outputs = weights.outputs();
+	}
+	writeBinary(to, weights.data(), weights.size(), inputs, hidden, outputs);
+}
+
+void NeuralNetWeights::toText(const std::string& from, const std::string& to)
+{
+	const NeuralNetWeights weights(from);
+	writeText(to, weights.data(), weights.size());
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef SRC_UTIL_NEURAL_NET_WEIGHTS
+#define SRC_UTIL_NEURAL_NET_WEIGHTS
+
+/**
+ * @file NeuralNetWeights.h
+ * @brief Definition of class NeuralNetWeights
+ * $Id$
+ */
+
+// The NTRT Core Library
+#include "core/tgAssetCache.h"
+
+// Boost
+#include <boost/cstdint.hpp>
+
+// The C++ Standard Library
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * The weights of a network, or the parameters of a stateless member, read
+ * from either of two formats:
+ *
+ * - text, the comma separated values of neuralNetwork::saveWeights() and
+ *   of the scripts' .nnw files, which are parsed
+ * - binary, a 32 byte header followed by the values as native doubles,
+ *   which is mapped read only through tgAssetCache, so the workers of a
+ *   batch reading one file share one mapping instead of each parsing a copy
+ *
+ * The binary header is the magic "NTRTNNW" and a NUL, then as native
+ * 32 bit integers the version, the input, hidden and output layer sizes
+ * (all 0 for plain parameters), then the number of values as a native
+ * 64 bit integer. Files of another byte order fail to load rather than
+ * loading garbage. scripts/learning/src/helpers/nnwConvert.py reads and
+ * writes the same format.
+ */
+class NeuralNetWeights
+{
+public:
+
+	/** The version written by writeBinary() */
+	static const boost::uint32_t version = 1;
+
+	/**
+	 * Map a binary file or parse a text one.
+	 * @throw std::invalid_argument if the file can't be opened or is a
+	 * binary file of another version, byte order or a wrong length
+	 */
+	explicit NeuralNetWeights(const std::string& path);
+
+	/** @return the values, valid as long as this object */
+	const double* data() const
+	{
+		return m_data;
+	}
+
+	std::size_t size() const
+	{
+		return m_size;
+	}
+
+	/** @return true if the file was binary, and mapped */
+	bool isMapped() const
+	{
+		return m_file && m_file->isMapped();
+	}
+
+	/** The layer sizes of a binary file, 0 if unknown */
+	int inputs() const { return m_inputs; }
+	int hidden() const { return m_hidden; }
+	int outputs() const { return m_outputs; }
+
+	/** @return true if the file starts with the binary magic */
+	static bool isBinary(const std::string& path);
+
+	/**
+	 * Write values in the binary format, to a temporary file that is then
+	 * renamed, so workers mapping the old file are undisturbed.
+	 * @throw std::runtime_error if the file can't be written
+	 */
+	static void writeBinary(const std::string& path,
+							const double* values, std::size_t count,
+							int inputs = 0, int hidden = 0, int outputs = 0);
+
+	/**
+	 * Write values as text, exactly, in the format neuralNetwork loads.
+	 * @throw std::runtime_error if the file can't be written
+	 */
+	static void writeText(const std::string& path,
+							const double* values, std::size_t count);
+
+	/** Convert a file of either format to binary. */
+	static void toBinary(const std::string& from, const std::string& to,
+							int inputs = 0, int hidden = 0, int outputs = 0);
+
+	/** Convert a file of either format to text. */
+	static void toText(const std::string& from, const std::string& to);
+
+private:
+
+	/** Not copyable, m_data points into the object */
+	NeuralNetWeights(const NeuralNetWeights&);
+	NeuralNetWeights& operator=(const NeuralNetWeights&);
+
+	void map(const std::string& path);
+
+	void parse(const std::string& path);
+
+	/** A binary file, mapped once per process by tgAssetCache */
+	tgAssetCache::Handle m_file;
+
+	/** The values of a text file */
+	std::vector<double> m_text;
+
+	const double* m_data;
+	std::size_t m_size;
+
+	int m_inputs;
+	int m_hidden;
+	int m_outputs;
+};
+
+#endif
@@ -0,0 +1,199 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+/**
+ * @file ParameterKernels.cpp
+ * @brief Implementation of class ParameterKernels
+ * $Id$
+ */
+
+#include "ParameterKernels.h"
+
+// The C++ Standard Library
+#include <math.h>
+#include <stdexcept>
+
+namespace
+{
+	/** One output scaled to the open interval (0, 1) */
+	inline double toUnit(boost::uint32_t word)
+	{
+		return (static_cast<double>(word) + 0.5) * (1.0 / 4294967296.0);
+	}
+}
+
+ParameterKernels::ParameterKernels(boost::uint64_t key, boost::uint64_t stream)
+{
+	seed(key, stream);
+}
+
+void ParameterKernels::seed(boost::uint64_t key, boost::uint64_t stream)
+{
+	m_rng.seed(key, stream);
+	m_used = 4;
+}
+
+ParameterKernels::State ParameterKernels::getState() const
+{
+	State state;
+	m_rng.getState(state.key, state.counter);
+	for (int i = 0; i < 4; i++)
+	{
+		state.block[i] = m_block[i];
+	}
+	state.used = static_cast<boost::uint32_t>(m_used);
+	return state;
+}
+
+void ParameterKernels::setState(const State& state)
+{
+	if (state.used > 4)
+	{
+		throw std::invalid_argument("ParameterKernels state is corrupt");
+	}
+	m_rng.setState(state.key, state.counter);
+	for (int i = 0; i < 4; i++)
+	{
+		m_block[i] = state.block[i];
+	}
+	m_used = state.used;
+}
+
+double ParameterKernels::uniform()
+{
+	if (m_used == 4)
+	{
+		m_rng.next(m_block);
+		m_used = 0;
+	}
+	return toUnit(m_block[m_used++]);
+}
+
+void ParameterKernels::fillWords(std::size_t n)
+{
+	const std::size_t blocks = (n + 3) / 4;
+	if (m_words.size() < 4 * blocks)
+	{
+		m_words.resize(4 * blocks);
+	}
+	if (blocks > 0)
+	{
+		m_rng.next(&m_words[0], blocks);
+	}
+}
+
+void ParameterKernels::fillUniform(std::size_t n)
+{
+	fillWords(n);
+	if (m_uniform.size() < n)
+	{
+		m_uniform.resize(n);
+	}
+	for (std::size_t i = 0; i < n; i++)
+	{
+		m_uniform[i] = toUnit(m_words[i]);
+	}
+}
+
+void ParameterKernels::fillNormal(std::size_t n)
+{
+	// Box-Muller, a pair of normals from a pair of words
+	const std::size_t pairs = (n + 1) / 2;
+	fillWords(2 * pairs);
+	if (m_normal.size() < 2 * pairs)
+	{
+		m_normal.resize(2 * pairs);
+	}
+	for (std::size_t i = 0; i < 2 * pairs; i += 2)
+	{
+		const double r = sqrt(-2.0 * log(toUnit(m_words[i])));
+		const double theta = 2.0 * M_PI * toUnit(m_words[i + 1]);
+		m_normal[i] = r * cos(theta);
+		m_normal[i + 1] = r * sin(theta);
+	}
+}
+
+void ParameterKernels::randomize(double* params, std::size_t n)
+{
+	fillUniform(n);
+	const double* const u = n > 0 ? &m_uniform[0] : NULL;
+	for (std::size_t i = 0; i < n; i++)
+	{
+		params[i] = u[i];
+	}
+}
+
+void ParameterKernels::normal(double* out, std::size_t n)
+{
+	fillNormal(n);
+	const double* const z = n > 0 ? &m_normal[0] : NULL;
+	for (std::size_t i = 0; i < n; i++)
+	{
+		out[i] = z[i];
+	}
+}
+
+void ParameterKernels::mutate(double* params, std::size_t n,
+							  double probability, double deviation)
+{
+	if (n == 0)
+	{
+		return;
+	}
+	fillUniform(n);
+	
+	// Gather the parameters that move without branching, so normals are
+	// only drawn for them
+	if (m_index.size() < n)
+	{
+		m_index.resize(n);
+	}
+	const double* const u = &m_uniform[0];
+	std::size_t* const index = &m_index[0];
+	std::size_t k = 0;
+	for (std::size_t i = 0; i < n; i++)
+	{
+		index[k] = i;
+		k += (u[i] < probability);
+	}
+	if (k == 0)
+	{
+		return;
+	}
+	
+	fillNormal(k);
+	const double* const z = &m_normal[0];
+	for (std::size_t j = 0; j < k; j++)
+	{
+		const std::size_t i = index[j];
+		const double p = params[i] + deviation * z[j];
+		params[i] = p < 0.0 ? 0.0 : (p > 1.0 ? 1.0 : p);
+	}
+}
+
+void ParameterKernels::crossover(double* out, const double* a,
+								 const double* b, std::size_t n)
+{
+	fillUniform(n);
+	const double* const u = n > 0 ? &m_uniform[0] : NULL;
+	for (std::size_t i = 0; i < n; i++)
+	{
+		out[i] = u[i] < 0.5 ? a[i] : b[i];
+	}
+}
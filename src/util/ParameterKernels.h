@@ -0,0 +1,116 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+
+#ifndef SRC_UTIL_PARAMETER_KERNELS
+#define SRC_UTIL_PARAMETER_KERNELS
+
+/**
+ * @file ParameterKernels.h
+ * @brief Definition of class ParameterKernels
+ * $Id$
+ */
+
+#include "core/Philox4x32.h"
+
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+/**
+ * Mutation and crossover of parameter vectors in [0, 1] for the
+ * NeuroEvolution and AnnealEvolution populations. Each call draws the
+ * random numbers of a whole vector into scratch arrays, four 32 bit
+ * uniforms per block of a Philox4x32 stream, and then updates the
+ * parameters in branch free loops over contiguous arrays. mutate()
+ * gathers the indices it moves first and draws normals only for them.
+ * Nothing is allocated once the scratch arrays have grown to the longest
+ * vector.
+ *
+ * Seed with a stream per population member (or per thread) to make the
+ * result of each member independent of the order they are processed in.
+ */
+class ParameterKernels
+{
+public:
+
+	ParameterKernels(boost::uint64_t key = 0, boost::uint64_t stream = 0);
+
+	/** Restart at the beginning of a stream */
+	void seed(boost::uint64_t key, boost::uint64_t stream);
+
+	/** The position in a stream, everything a checkpoint needs */
+	struct State
+	{
+		boost::uint32_t key[2];
+		boost::uint32_t counter[4];
+		boost::uint32_t block[4];
+		boost::uint32_t used;
+	};
+
+	State getState() const;
+
+	/** Continue from a State getState() returned */
+	void setState(const State& state);
+
+	/** @return a uniform sample in (0, 1) with 32 bit resolution */
+	double uniform();
+
+	/** Fill params with uniform samples in (0, 1) */
+	void randomize(double* params, std::size_t n);
+
+	/** Fill out with standard normal samples */
+	void normal(double* out, std::size_t n);
+
+	/**
+	 * Add a normal sample of the given deviation to each parameter with
+	 * the given probability, then clamp the parameters to [0, 1].
+	 */
+	void mutate(double* params, std::size_t n,
+				double probability, double deviation);
+
+	/** Take each parameter from a or from b with equal probability */
+	void crossover(double* out, const double* a, const double* b,
+				   std::size_t n);
+
+private:
+
+	/** Fill m_words with at least n outputs */
+	void fillWords(std::size_t n);
+
+	/** Fill m_uniform with n samples in (0, 1) */
+	void fillUniform(std::size_t n);
+
+	/** Fill m_normal with n standard normal samples */
+	void fillNormal(std::size_t n);
+
+	Philox4x32 m_rng;
+
+	/** The unused outputs of the last block, for uniform() */
+	boost::uint32_t m_block[4];
+	std::size_t m_used;
+
+	std::vector<boost::uint32_t> m_words;
+	std::vector<double> m_uniform;
+	std::vector<double> m_normal;
+
+	/** The parameters mutate() moves */
+	std::vector<std::size_t> m_index;
+};
+
+#endif // SRC_UTIL_PARAMETER_KERNELS
@@ -0,0 +1,103 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgActuatorSpectrum.cpp
+ * @brief Implementation of class tgActuatorSpectrum
+ * $Id$
+ */
+
+// This module
+#include "tgActuatorSpectrum.h"
+// This application
+#include "core/tgModel.h"
+#include "core/tgSpringCableActuator.h"
+// The C++ Standard Library
+#include <stdexcept>
+
+tgActuatorSpectrum::tgActuatorSpectrum(const tgGaitSpectrum::Config& config,
+                                       const std::string& tags) :
+m_config(config),
+m_tags(tags),
+m_pSpectrum(NULL),
+m_elapsed(0.0)
+{
+    // Check the configuration now rather than at setup
+    const tgGaitSpectrum check(1, config);
+}
+
+tgActuatorSpectrum::~tgActuatorSpectrum()
+{
+    delete m_pSpectrum;
+}
+
+void tgActuatorSpectrum::onSetup(tgModel& subject)
+{
+    m_actuators = subject.find<tgSpringCableActuator>(m_tags);
+    if (m_actuators.empty())
+    {
+        throw std::runtime_error("No actuators to analyze match '" +
+                                 m_tags + "'");
+    }
+    tgGaitSpectrum* const pSpectrum =
+        new tgGaitSpectrum(m_actuators.size(), m_config);
+    delete m_pSpectrum;
+    m_pSpectrum = pSpectrum;
+    m_lengths.resize(m_actuators.size());
+    m_elapsed = 0.0;
+}
+
+void tgActuatorSpectrum::onStep(tgModel& subject, double dt)
+{
+    if (m_actuators.empty())
+    {
+        return;
+    }
+    m_elapsed += dt;
+    // Allow for the rounding of a sum of steps
+    const double period = m_config.samplePeriod;
+    if (m_elapsed >= period * (1.0 - 1e-6))
+    {
+        m_elapsed -= period;
+        if (m_elapsed > period)
+        {
+            // Steps longer than the period sample once per step
+            m_elapsed = 0.0;
+        }
+        for (std::size_t i = 0; i < m_actuators.size(); i++)
+        {
+            m_lengths[i] = m_actuators[i]->getCurrentLength();
+        }
+        m_pSpectrum->sample(m_lengths);
+    }
+}
+
+void tgActuatorSpectrum::onTeardown(tgModel& subject)
+{
+    // The actuators go with the model; the spectrum stays to be read
+    m_actuators.clear();
+}
+
+const tgGaitSpectrum& tgActuatorSpectrum::getSpectrum() const
+{
+    if (!m_pSpectrum)
+    {
+        throw std::logic_error("No spectrum before setup");
+    }
+    return *m_pSpectrum;
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_ACTUATOR_SPECTRUM_H
+#define TG_ACTUATOR_SPECTRUM_H
+
+/**
+ * @file tgActuatorSpectrum.h
+ * @brief Definition of class tgActuatorSpectrum
+ * $Id$
+ */
+
+// This library
+#include "tgGaitSpectrum.h"
+// This application
+#include "core/tgObserver.h"
+// The C++ Standard Library
+#include <string>
+#include <vector>
+
+// Forward declarations
+class tgModel;
+class tgSpringCableActuator;
+
+/**
+ * Attaches to a model and keeps the tgGaitSpectrum of the lengths of its
+ * spring cable actuators, or of the ones matching a tag search, one
+ * channel per actuator in the order tgModel::find() returns them. The
+ * lengths are sampled every Config::samplePeriod of simulation time,
+ * which should be a whole number of steps. The spectrum starts over at
+ * each setup, so a gait is scored from getSpectrum() at teardown without
+ * logging the lengths.
+ */
+class tgActuatorSpectrum : public tgObserver<tgModel>
+{
+public:
+
+    /**
+     * @param[in] config the spectrum of each actuator
+     * @param[in] tags the tags of the actuators, or "" for all of them
+     * @throw std::invalid_argument if the configuration is out of range
+     */
+    explicit tgActuatorSpectrum(
+        const tgGaitSpectrum::Config& config = tgGaitSpectrum::Config(),
+        const std::string& tags = "");
+
+    virtual ~tgActuatorSpectrum();
+
+    /**
+     * Find the actuators and start a spectrum.
+     * @throw std::runtime_error if no actuator matches
+     */
+    virtual void onSetup(tgModel& subject);
+
+    virtual void onStep(tgModel& subject, double dt);
+
+    virtual void onTeardown(tgModel& subject);
+
+    /** Only reads its subject's actuators */
+    virtual bool isParallelSafe() const { return true; }
+
+    /**
+     * @return the spectrum of the actuators
+     * @throw std::logic_error before onSetup()
+     */
+    const tgGaitSpectrum& getSpectrum() const;
+
+    /** @return the actuator of each channel; none after teardown */
+    const std::vector<tgSpringCableActuator*>& getActuators() const
+    {
+        return m_actuators;
+    }
+
+private:
+
+    // Not copyable
+    tgActuatorSpectrum(const tgActuatorSpectrum&);
+    tgActuatorSpectrum& operator=(const tgActuatorSpectrum&);
+
+    const tgGaitSpectrum::Config m_config;
+
+    const std::string m_tags;
+
+    /** Not owned */
+    std::vector<tgSpringCableActuator*> m_actuators;
+
+    /** Owned, NULL before onSetup() */
+    tgGaitSpectrum* m_pSpectrum;
+
+    /** The simulation time since the last sample */
+    double m_elapsed;
+
+    /** The lengths of one sample, kept to avoid allocating */
+    std::vector<double> m_lengths;
+};
+
+#endif  // TG_ACTUATOR_SPECTRUM_H
@@ -41,6 +41,8 @@ class tgImpedanceController;
 
 class tgBaseCPGNode
 {
+    friend class tgCPGActuatorBank;
+    
 public:
     
     virtual ~tgBaseCPGNode();                   
@@ -0,0 +1,182 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgCPGActuatorBank.cpp
+ * @brief Implementation of class tgCPGActuatorBank
+ * $Id$
+ */
+
+// This module
+#include "tgCPGActuatorBank.h"
+// This library
+#include "CPGEquations.h"
+#include "tgBaseCPGNode.h"
+#include "controllers/tgImpedanceController.h"
+#include "core/tgBasicActuator.h"
+#include "core/tgSpringCable.h"
+// The C++ Standard Library
+#include <cassert>
+#include <stdexcept>
+
+tgCPGActuatorBank::tgCPGActuatorBank(double controlStep) :
+m_controlStep(controlStep),
+m_controlTime(0.0),
+m_pCPGSystem(NULL)
+{
+    if (m_controlStep < 0.0)
+    {
+        throw std::invalid_argument("Negative control step");
+    }
+}
+
+void tgCPGActuatorBank::add(tgBasicActuator& actuator,
+                            const tgBaseCPGNode& node)
+{
+    if (node.m_pCPGSystem == NULL || node.m_nodeNumber < 0)
+    {
+        throw std::invalid_argument("CPG node not initialized");
+    }
+    add(actuator, *node.m_pCPGSystem, node.m_nodeNumber,
+        node.controlLength(), node.motorControl());
+}
+
+void tgCPGActuatorBank::add(tgBasicActuator& actuator,
+                            const CPGEquations& system,
+                            std::size_t node, double controlLength,
+                            const tgImpedanceController& gains)
+{
+    if (m_pCPGSystem != NULL && m_pCPGSystem != &system)
+    {
+        throw std::invalid_argument("Actuators must share a CPG system");
+    }
+
+    m_pCPGSystem = &system;
+    m_actuators.push_back(&actuator);
+    m_nodes.push_back(node);
+    m_controlLength.push_back(controlLength);
+    m_offsetTension.push_back(gains.getOffsetTension());
+    m_lengthStiffness.push_back(gains.getLengthStiffness());
+    m_velStiffness.push_back(gains.getVelStiffness());
+
+    const std::size_t n = m_actuators.size();
+    m_length.resize(n);
+    m_velocity.resize(n);
+    m_tension.resize(n);
+    m_coefK.resize(n);
+    m_restLength.resize(n);
+    m_setTension.resize(n, 0.0);
+    m_setLength.resize(n);
+}
+
+std::size_t tgCPGActuatorBank::bytes() const
+{
+    const std::size_t values = m_controlLength.capacity() +
+        m_offsetTension.capacity() + m_lengthStiffness.capacity() +
+        m_velStiffness.capacity() + m_outputs.capacity() +
+        m_length.capacity() + m_velocity.capacity() + m_tension.capacity() +
+        m_coefK.capacity() + m_restLength.capacity() +
+        m_setTension.capacity() + m_setLength.capacity();
+    return m_actuators.capacity() * sizeof(tgBasicActuator*) +
+        m_nodes.capacity() * sizeof(std::size_t) + values * sizeof(double);
+}
+
+void tgCPGActuatorBank::clear()
+{
+    m_pCPGSystem = NULL;
+    m_controlTime = 0.0;
+    m_actuators.clear();
+    m_nodes.clear();
+    m_controlLength.clear();
+    m_offsetTension.clear();
+    m_lengthStiffness.clear();
+    m_velStiffness.clear();
+    m_length.clear();
+    m_velocity.clear();
+    m_tension.clear();
+    m_coefK.clear();
+    m_restLength.clear();
+    m_setTension.clear();
+    m_setLength.clear();
+}
+
+void tgCPGActuatorBank::step(double dt)
+{
+    if (dt <= 0.0)
+    {
+        throw std::invalid_argument("dt is not positive");
+    }
+
+    m_controlTime += dt;
+    if (m_controlTime >= m_controlStep)
+    {
+        control(m_controlTime);
+        m_controlTime = 0.0;
+    }
+    else
+    {
+        const std::size_t n = m_actuators.size();
+        for (std::size_t i = 0; i < n; i++)
+        {
+            m_actuators[i]->moveMotors(dt);
+        }
+    }
+}
+
+void tgCPGActuatorBank::control(double dt)
+{
+    const std::size_t n = m_actuators.size();
+    if (n == 0)
+    {
+        return;
+    }
+
+    // Every output is read once, even if nodes drive several actuators
+    m_pCPGSystem->getOutputs(m_outputs);
+
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const tgBasicActuator& actuator = *m_actuators[i];
+        const tgSpringCable* const pCable = actuator.getSpringCable();
+        m_length[i] = actuator.getCurrentLength();
+        m_velocity[i] = actuator.getVelocity();
+        m_tension[i] = pCable->getTension();
+        m_coefK[i] = pCable->getCoefK();
+        m_restLength[i] = actuator.getRestLength();
+        assert(m_coefK[i] > 0.0);
+    }
+
+    // The impedance law of tgImpedanceController, then the rest length
+    // that closes the tension error as in tgTensionController
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const double setTension = m_offsetTension[i] +
+            m_lengthStiffness[i] * (m_length[i] - m_controlLength[i]) +
+            m_velStiffness[i] * (m_velocity[i] - m_outputs[m_nodes[i]]);
+        m_setTension[i] = setTension > 0.0 ? setTension : 0.0;
+
+        const double setLength = m_restLength[i] -
+            (m_setTension[i] - m_tension[i]) / m_coefK[i];
+        m_setLength[i] = setLength < 0.1 ? 0.1 : setLength;
+    }
+
+    for (std::size_t i = 0; i < n; i++)
+    {
+        m_actuators[i]->setControlInput(m_setLength[i], dt);
+    }
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_CPG_ACTUATOR_BANK_H
+#define TG_CPG_ACTUATOR_BANK_H
+
+/**
+ * @file tgCPGActuatorBank.h
+ * @brief Definition of class tgCPGActuatorBank
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class CPGEquations;
+class tgBaseCPGNode;
+class tgBasicActuator;
+class tgImpedanceController;
+
+/**
+ * Structure-of-arrays impedance control of many tgBasicActuators from
+ * one CPGEquations system. The bank copies each actuator's CPG node
+ * number, control length and impedance gains when it is added. Each
+ * control step it reads every CPG output at once, gathers the actuators'
+ * lengths, velocities and tensions, computes every tension and rest
+ * length setpoint in one loop, and then sets the actuators' control
+ * inputs. The setpoints are the same as tgImpedanceController::control()
+ * followed by tgTensionController::control() gives a single actuator,
+ * so a bank can replace one tgCPGActuatorControl observer per actuator.
+ */
+class tgCPGActuatorBank
+{
+public:
+
+    /**
+     * Construct an empty bank.
+     * @param[in] controlStep how often the setpoints are recomputed, in
+     * seconds; must be non-negative. Zero recomputes them every step.
+     */
+    tgCPGActuatorBank(double controlStep = 1.0/10000.0);
+
+    /**
+     * Add an actuator driven by a CPG node.
+     * @param[in,out] actuator not owned, must outlive the bank or be
+     * removed with clear()
+     * @param[in] node a node whose CPG system, node number and motor
+     * control have been set up. The gains are copied, so later changes
+     * to the node's controller do not reach the bank.
+     * @throw std::invalid_argument if the node uses a different CPG
+     * system than the actuators already added
+     */
+    void add(tgBasicActuator& actuator, const tgBaseCPGNode& node);
+
+    /**
+     * Add an actuator driven by a node of a CPG system, for controllers
+     * that build the system themselves.
+     * @param[in,out] actuator not owned, as above
+     * @param[in] system the system; not owned
+     * @param[in] node the node of the system
+     * @param[in] controlLength the length the actuator is pulled towards
+     * @param[in] gains the impedance gains, which are copied
+     * @throw std::invalid_argument if the system differs from that of
+     * the actuators already added
+     */
+    void add(tgBasicActuator& actuator, const CPGEquations& system,
+             std::size_t node, double controlLength,
+             const tgImpedanceController& gains);
+
+    /** Remove every actuator. */
+    void clear();
+
+    /** Return the number of actuators. */
+    std::size_t size() const
+    {
+        return m_actuators.size();
+    }
+
+    /**
+     * Advance the bank's clock. Once a control step has elapsed the
+     * setpoints are recomputed from the CPG outputs, otherwise the
+     * actuators' motors move towards the last setpoints.
+     * @param[in] dt the step size; must be positive
+     */
+    void step(double dt);
+
+    /**
+     * Return the tension last commanded to actuator i, the same as
+     * tgCPGActuatorControl::getCommandedTension()
+     */
+    double getCommandedTension(std::size_t i) const
+    {
+        return m_setTension[i];
+    }
+
+    /** Return the bytes of the per actuator state, for tgMemoryReport */
+    std::size_t bytes() const;
+
+private:
+
+    /** Recompute and apply every setpoint */
+    void control(double dt);
+
+private:
+
+    /** How often the setpoints are recomputed, in seconds */
+    const double m_controlStep;
+
+    /** The time since the setpoints were last recomputed */
+    double m_controlTime;
+
+    /** The system every actuator reads. Not owned. */
+    const CPGEquations* m_pCPGSystem;
+
+    /** The actuators, in the order they were added. Not owned. */
+    std::vector<tgBasicActuator*> m_actuators;
+
+    /** Per actuator CPG node numbers */
+    std::vector<std::size_t> m_nodes;
+
+    /** Per actuator control lengths and impedance gains */
+    std::vector<double> m_controlLength;
+    std::vector<double> m_offsetTension;
+    std::vector<double> m_lengthStiffness;
+    std::vector<double> m_velStiffness;
+
+    /** The output of every CPG node, as of the last control step */
+    std::vector<double> m_outputs;
+
+    /** Per actuator state read from the actuators each control step */
+    std::vector<double> m_length;
+    std::vector<double> m_velocity;
+    std::vector<double> m_tension;
+    std::vector<double> m_coefK;
+    std::vector<double> m_restLength;
+
+    /** Per actuator results */
+    std::vector<double> m_setTension;
+    std::vector<double> m_setLength;
+};
+
+#endif  // TG_CPG_ACTUATOR_BANK_H
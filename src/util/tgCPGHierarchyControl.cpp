@@ -0,0 +1,380 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgCPGHierarchyControl.cpp
+ * @brief Implementation of class tgCPGHierarchyControl
+ * $Id$
+ */
+
+// This module
+#include "tgCPGHierarchyControl.h"
+// This library
+#include "CPGEquationsFB.h"
+#include "NeuralNetBatch.h"
+// The NTRT core library
+#include "controllers/tgImpedanceController.h"
+#include "core/tgBaseRigid.h"
+#include "core/tgBasicActuator.h"
+#include "core/tgCast.h"
+#include "core/tgMemoryReport.h"
+#include "core/tgModel.h"
+#include "core/tgStateFrame.h"
+// The C++ Standard Library
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    /** The feedback network's outputs per muscle, one per CPGNodeFB input */
+    const std::size_t feedbackOutputs = 3;
+
+    /** @throw std::invalid_argument unless edges fit n nodes */
+    void checkEdges(const std::vector<tgCPGHierarchyControl::Edge>& edges,
+                    std::size_t n)
+    {
+        if (edges.size() > 1 && edges.size() != n * (n - 1) / 2)
+        {
+            throw std::invalid_argument("Need one edge, or one per pair of nodes");
+        }
+    }
+}
+
+tgCPGHierarchyControl::Node::Node() :
+frequency(0.0),
+amplitude(0.0),
+frequencyFeedback(0.0),
+amplitudeFeedback(0.0),
+phaseFeedback(0.0)
+{
+}
+
+tgCPGHierarchyControl::Edge::Edge(double weight, double phase) :
+weight(weight),
+phase(phase)
+{
+}
+
+tgCPGHierarchyControl::Group::Group() :
+parent(-1)
+{
+}
+
+tgCPGHierarchyControl::Spec::Spec() :
+controlTime(0.1),
+offsetTension(0.0),
+lengthStiffness(1000.0),
+velStiffness(100.0),
+controlLength(-1.0),
+feedbackHidden(4)
+{
+}
+
+tgCPGHierarchyControl::tgCPGHierarchyControl(const Spec& spec) :
+m_spec(spec),
+m_pCPGs(NULL),
+m_pFeedback(NULL),
+m_updateTime(0.0),
+m_initialPosition(0.0, 0.0, 0.0),
+m_distanceMoved(0.0)
+{
+    if (m_spec.controlTime < 0.0)
+    {
+        throw std::invalid_argument("Negative control time");
+    }
+    checkEdges(m_spec.highEdges, m_spec.highNodes.size());
+    for (std::size_t i = 0; i < m_spec.groups.size(); i++)
+    {
+        const int parent = m_spec.groups[i].parent;
+        if (parent >= static_cast<int>(m_spec.highNodes.size()))
+        {
+            throw std::invalid_argument("Parent is not a high node");
+        }
+    }
+}
+
+tgCPGHierarchyControl::~tgCPGHierarchyControl()
+{
+    delete m_pCPGs;
+    delete m_pFeedback;
+}
+
+void tgCPGHierarchyControl::onSetup(tgModel& subject)
+{
+    delete m_pCPGs;
+    delete m_pFeedback;
+    m_pCPGs = new CPGEquationsFB(100);
+    m_pFeedback = NULL;
+    m_bank.clear();
+    m_muscles.clear();
+    m_frameRows.clear();
+
+    // The muscles of each group, then the high nodes
+    std::vector<std::size_t> groupStart;
+    for (std::size_t g = 0; g < m_spec.groups.size(); g++)
+    {
+        const Group& group = m_spec.groups[g];
+        const std::vector<tgBasicActuator*> muscles =
+            subject.find<tgBasicActuator>(group.tags);
+        checkEdges(group.edges, muscles.size());
+        groupStart.push_back(m_muscles.size());
+        m_muscles.insert(m_muscles.end(), muscles.begin(), muscles.end());
+    }
+    groupStart.push_back(m_muscles.size());
+    const std::size_t highStart = m_muscles.size();
+    const std::size_t nodes = highStart + m_spec.highNodes.size();
+
+    std::vector<double> params(11);
+    for (std::size_t i = 0; i < nodes; i++)
+    {
+        std::size_t g = 0;
+        while (g < m_spec.groups.size() && groupStart[g + 1] <= i)
+        {
+            g++;
+        }
+        const Node& node = (i < highStart) ? m_spec.groups[g].node :
+            m_spec.highNodes[i - highStart];
+        params[0] = node.frequency; // Frequency Offset
+        params[1] = node.frequency; // Frequency Scale
+        params[2] = node.amplitude; // Radius Offset
+        params[3] = node.amplitude; // Radius Scale
+        params[4] = 1.0; // rConst (a constant)
+        params[5] = 0.0; // dMin for descending commands
+        params[6] = 5.0; // dMax for descending commands
+        params[7] = node.frequency; // Omega (initialize variable)
+        params[8] = node.frequencyFeedback;
+        params[9] = node.amplitudeFeedback;
+        params[10] = node.phaseFeedback;
+        const int index = m_pCPGs->addNode(params);
+        assert(index == static_cast<int>(i));
+        (void)index;
+    }
+
+    // Every node's couplings are gathered, then defined at once
+    m_connections.assign(nodes, std::vector<int>());
+    m_weights.assign(nodes, std::vector<double>());
+    m_phases.assign(nodes, std::vector<double>());
+    for (std::size_t g = 0; g < m_spec.groups.size(); g++)
+    {
+        const Group& group = m_spec.groups[g];
+        const std::size_t first = groupStart[g];
+        const std::size_t n = groupStart[g + 1] - first;
+        connect(first, n, group.edges);
+        if (group.parent >= 0)
+        {
+            const int parent = static_cast<int>(highStart) + group.parent;
+            for (std::size_t i = first; i < first + n; i++)
+            {
+                m_connections[i].push_back(parent);
+                m_weights[i].push_back(group.parentEdge.weight);
+                m_phases[i].push_back(group.parentEdge.phase);
+            }
+        }
+    }
+    connect(highStart, m_spec.highNodes.size(), m_spec.highEdges);
+    for (std::size_t i = 0; i < nodes; i++)
+    {
+        if (!m_connections[i].empty())
+        {
+            m_pCPGs->defineConnections(i, m_connections[i], m_weights[i],
+                                       m_phases[i]);
+        }
+    }
+
+    const tgImpedanceController gains(m_spec.offsetTension,
+                                      m_spec.lengthStiffness,
+                                      m_spec.velStiffness);
+    for (std::size_t i = 0; i < m_muscles.size(); i++)
+    {
+        const double controlLength = (m_spec.controlLength < 0.0) ?
+            m_muscles[i]->getStartLength() : m_spec.controlLength;
+        m_bank.add(*m_muscles[i], *m_pCPGs, i, controlLength, gains);
+    }
+
+    if (!m_spec.feedbackWeights.empty())
+    {
+        m_pFeedback = new NeuralNetBatch(tgStateFrame::cableFeatures,
+                                         m_spec.feedbackHidden,
+                                         feedbackOutputs);
+        m_pFeedback->addNetwork(m_spec.feedbackWeights);
+    }
+    m_feedback.assign(nodes * feedbackOutputs, 0.0);
+
+    m_updateTime = 0.0;
+    m_initialPosition = centerOfMass(subject);
+}
+
+void tgCPGHierarchyControl::connect(std::size_t first, std::size_t n,
+                                    const std::vector<Edge>& edges)
+{
+    if (edges.empty())
+    {
+        return;
+    }
+    std::size_t pair = 0;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        for (std::size_t j = i + 1; j < n; j++, pair++)
+        {
+            const Edge& edge = (edges.size() == 1) ? edges[0] : edges[pair];
+            const int a = static_cast<int>(first + i);
+            const int b = static_cast<int>(first + j);
+            // Both ways get the same edge, as in
+            // tgCPGActuatorControl::setConnectivity()
+            m_connections[a].push_back(b);
+            m_weights[a].push_back(edge.weight);
+            m_phases[a].push_back(edge.phase);
+            m_connections[b].push_back(a);
+            m_weights[b].push_back(edge.weight);
+            m_phases[b].push_back(edge.phase);
+        }
+    }
+}
+
+void tgCPGHierarchyControl::onStep(tgModel& subject, double dt)
+{
+    assert(m_pCPGs != NULL);
+    m_updateTime += dt;
+    if (m_updateTime >= m_spec.controlTime)
+    {
+        if (m_pFeedback != NULL)
+        {
+            findFeedback(subject);
+        }
+        m_pCPGs->update(m_feedback, m_updateTime);
+        m_updateTime = 0.0;
+    }
+    m_bank.step(dt);
+}
+
+void tgCPGHierarchyControl::findFeedback(const tgModel& subject)
+{
+    const std::size_t n = m_muscles.size();
+    if (n == 0)
+    {
+        return;
+    }
+
+    // Read the frame's features in place when the model has one
+    const tgStateFrame* const pFrame = subject.getStateFrame();
+    const double* pInputs = NULL;
+    std::size_t patterns = n;
+    if (pFrame != NULL)
+    {
+        if (m_frameRows.size() != n)
+        {
+            m_frameRows.resize(n);
+            for (std::size_t i = 0; i < n; i++)
+            {
+                m_frameRows[i] = pFrame->indexOf(m_muscles[i]);
+            }
+        }
+        pInputs = pFrame->getCableFeatures();
+        patterns = pFrame->getCables().size();
+    }
+    else
+    {
+        m_frameRows.resize(n);
+        m_inputs.resize(n * tgStateFrame::cableFeatures);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            const tgBasicActuator& cable = *m_muscles[i];
+            const double start = cable.getStartLength();
+            const double maxTension = cable.getConfig().maxTens;
+            m_inputs[2 * i] =
+                ((cable.getCurrentLength() - start) / start) / 2.0 + 0.5;
+            m_inputs[2 * i + 1] =
+                ((cable.getTension() - maxTension / 2.0) / maxTension) / 2.0 + 0.5;
+            m_frameRows[i] = i;
+        }
+        pInputs = &m_inputs[0];
+    }
+
+    m_outputs.resize(patterns * feedbackOutputs);
+    m_pFeedback->evaluate(0, pInputs, patterns, &m_outputs[0]);
+
+    // Scale back to -1 to 1; the high nodes keep no feedback
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const double* const output = &m_outputs[m_frameRows[i] * feedbackOutputs];
+        for (std::size_t j = 0; j < feedbackOutputs; j++)
+        {
+            m_feedback[i * feedbackOutputs + j] = output[j] * 2.0 - 1.0;
+        }
+    }
+}
+
+void tgCPGHierarchyControl::onTeardown(tgModel& subject)
+{
+    const btVector3 finalPosition = centerOfMass(subject);
+    const double dx = finalPosition.x() - m_initialPosition.x();
+    const double dz = finalPosition.z() - m_initialPosition.z();
+    m_distanceMoved = std::sqrt(dx * dx + dz * dz);
+
+    m_bank.clear();
+    m_muscles.clear();
+    m_frameRows.clear();
+    delete m_pCPGs;
+    m_pCPGs = NULL;
+    delete m_pFeedback;
+    m_pFeedback = NULL;
+}
+
+void tgCPGHierarchyControl::onReportMemory(const tgModel& subject,
+                                           tgMemoryReport& report) const
+{
+    std::size_t bytes = sizeof(*this) + m_bank.bytes() +
+        (m_inputs.capacity() + m_outputs.capacity() + m_feedback.capacity()) *
+        sizeof(double) +
+        m_frameRows.capacity() * sizeof(std::size_t);
+    for (std::size_t i = 0; i < m_weights.size(); i++)
+    {
+        bytes += tgMemoryReport::bytes(m_connections[i]) +
+            tgMemoryReport::bytes(m_weights[i]) +
+            tgMemoryReport::bytes(m_phases[i]);
+    }
+    if (m_pCPGs != NULL)
+    {
+        bytes += m_pCPGs->bytes();
+    }
+    if (m_pFeedback != NULL)
+    {
+        bytes += m_pFeedback->bytes();
+    }
+    report.add(tgMemoryReport::eControllers, bytes);
+}
+
+btVector3 tgCPGHierarchyControl::centerOfMass(const tgModel& subject)
+{
+    const std::vector<tgBaseRigid*> rigids =
+        tgCast::filter<tgModel, tgBaseRigid>(subject.getDescendants());
+    btVector3 sum(0.0, 0.0, 0.0);
+    double mass = 0.0;
+    for (std::size_t i = 0; i < rigids.size(); i++)
+    {
+        // Rigids that are not set up have no body to read
+        if (rigids[i]->getPRigidBody() == NULL)
+        {
+            continue;
+        }
+        sum += rigids[i]->centerOfMass() * rigids[i]->mass();
+        mass += rigids[i]->mass();
+    }
+    return (mass > 0.0) ? sum / mass : sum;
+}
@@ -0,0 +1,233 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_CPG_HIERARCHY_CONTROL_H
+#define TG_CPG_HIERARCHY_CONTROL_H
+
+/**
+ * @file tgCPGHierarchyControl.h
+ * @brief Definition of class tgCPGHierarchyControl
+ * $Id$
+ */
+
+// This library
+#include "tgCPGActuatorBank.h"
+// The NTRT core library
+#include "core/tgObserver.h"
+// The Bullet Physics library
+#include "LinearMath/btVector3.h"
+// The C++ Standard Library
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class CPGEquationsFB;
+class NeuralNetBatch;
+class tgBasicActuator;
+class tgMemoryReport;
+class tgModel;
+
+/**
+ * A hierarchical CPG controller with cable feedback, configured by a
+ * Spec rather than written anew for each model as the JSON*Control
+ * classes in dev are. The muscles are split into groups by tags; each
+ * muscle is a CPGNodeFB with its group's parameters, coupled to the
+ * other muscles of its group and, optionally, to a node of a higher
+ * level of CPGs that are coupled among themselves. Every control step
+ * the cables' stretch and tension go through one feedback network in a
+ * single batch, its outputs become the three feedback values of each
+ * muscle's node, and the system is integrated with the flat integrator
+ * of CPGEquations. Every step a tgCPGActuatorBank sets all the rest
+ * lengths in one pass. tgCPGHierarchyJSON.h reads a Spec from JSON.
+ */
+class tgCPGHierarchyControl : public tgObserver<tgModel>
+{
+public:
+
+    /** The learned parameters of a node, already scaled */
+    struct Node
+    {
+        Node();
+
+        double frequency;
+        double amplitude;
+        double frequencyFeedback;
+        double amplitudeFeedback;
+        double phaseFeedback;
+    };
+
+    /** A coupling between two nodes */
+    struct Edge
+    {
+        Edge(double weight = 0.0, double phase = 0.0);
+
+        double weight;
+
+        /** In radians */
+        double phase;
+    };
+
+    /** Muscles that share node parameters */
+    struct Group
+    {
+        Group();
+
+        /** Found with tgModel::find() */
+        std::string tags;
+
+        Node node;
+
+        /**
+         * The couplings between the group's muscles, the same both
+         * ways: one shared by every pair, or one per pair (i, j) with
+         * i < j in the order (0, 1), (0, 2), ..., (1, 2), ...; empty
+         * for none
+         */
+        std::vector<Edge> edges;
+
+        /** The index of the high node driving the group, or -1 */
+        int parent;
+
+        /** How the group's nodes follow the parent */
+        Edge parentEdge;
+    };
+
+    struct Spec
+    {
+        Spec();
+
+        /** How often the CPGs are updated, in seconds */
+        double controlTime;
+
+        /** The impedance gains of every muscle */
+        double offsetTension;
+        double lengthStiffness;
+        double velStiffness;
+
+        /**
+         * The length the muscles are pulled towards, or negative for
+         * each muscle's start length
+         */
+        double controlLength;
+
+        std::vector<Group> groups;
+
+        /** The higher level, which drives no muscles of its own */
+        std::vector<Node> highNodes;
+
+        /** The couplings among the high nodes, as Group::edges */
+        std::vector<Edge> highEdges;
+
+        /**
+         * A NeuralNetBatch weights file with 2 inputs and 3 outputs, or
+         * empty for no feedback
+         */
+        std::string feedbackWeights;
+
+        /** The hidden layer of the feedback network */
+        int feedbackHidden;
+    };
+
+    /**
+     * @param[in] spec what to build on every setup
+     * @throw std::invalid_argument if controlTime is negative, an edge
+     * list has the wrong size or a parent is not a high node
+     */
+    tgCPGHierarchyControl(const Spec& spec);
+
+    virtual ~tgCPGHierarchyControl();
+
+    /**
+     * Build the CPG system, the bank and the feedback network.
+     * @throw std::invalid_argument if the feedback weights can't be read
+     */
+    virtual void onSetup(tgModel& subject);
+
+    /**
+     * Update the CPGs once a control step has passed, then control the
+     * muscles.
+     * @throw std::runtime_error if the CPGs became stiff
+     */
+    virtual void onStep(tgModel& subject, double dt);
+
+    /** Score the trial and delete what onSetup() built */
+    virtual void onTeardown(tgModel& subject);
+
+    /** Add the CPGs, the feedback network and the bank, as controllers */
+    virtual void onReportMemory(const tgModel& subject,
+                                tgMemoryReport& report) const;
+
+    /**
+     * @return the horizontal distance the model's center of mass moved
+     * from setup to the last teardown
+     */
+    double getDistanceMoved() const { return m_distanceMoved; }
+
+    /** @return the muscles, in node order; valid while set up */
+    const std::vector<tgBasicActuator*>& getMuscles() const
+    {
+        return m_muscles;
+    }
+
+private:
+
+    /** Connect nodes [first, first + n) among themselves */
+    void connect(std::size_t first, std::size_t n,
+                 const std::vector<Edge>& edges);
+
+    /** Fill m_feedback from the cables */
+    void findFeedback(const tgModel& subject);
+
+    /** @return the mass weighted center of the model's rigids */
+    static btVector3 centerOfMass(const tgModel& subject);
+
+    const Spec m_spec;
+
+    /** Null unless set up; owned */
+    CPGEquationsFB* m_pCPGs;
+
+    NeuralNetBatch* m_pFeedback;
+
+    tgCPGActuatorBank m_bank;
+
+    std::vector<tgBasicActuator*> m_muscles;
+
+    /** Per node: the nodes it couples to, and how */
+    std::vector<std::vector<int> > m_connections;
+    std::vector<std::vector<double> > m_weights;
+    std::vector<std::vector<double> > m_phases;
+
+    /** The row of each muscle in the model's state frame, once found */
+    std::vector<std::size_t> m_frameRows;
+
+    /** Scratch of the feedback network, kept between steps */
+    std::vector<double> m_inputs;
+    std::vector<double> m_outputs;
+
+    /** Three per node, zero for the high nodes */
+    std::vector<double> m_feedback;
+
+    double m_updateTime;
+
+    btVector3 m_initialPosition;
+
+    double m_distanceMoved;
+};
+
+#endif  // TG_CPG_HIERARCHY_CONTROL_H
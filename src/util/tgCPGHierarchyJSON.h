@@ -0,0 +1,208 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_CPG_HIERARCHY_JSON_H
+#define TG_CPG_HIERARCHY_JSON_H
+
+/**
+ * @file tgCPGHierarchyJSON.h
+ * @brief Reads a tgCPGHierarchyControl::Spec from JSON
+ * $Id$
+ *
+ * Header only, so that only the applications that read specs link
+ * jsoncpp, as they do for the JSON controllers in dev. A spec is
+ *
+ *     {
+ *       "controlTime": 0.1,
+ *       "impedance": {"tension": 0, "kPosition": 1000, "kVelocity": 100,
+ *                     "controlLength": -1},
+ *       "limits": {"low": [freq, amp, freqFB, ampFB, phaseFB],
+ *                  "high": [...], "phase": [-3.14159, 3.14159]},
+ *       "groups": [{"tags": "spine", "params": [5 values],
+ *                   "edges": [[weight, phase], ...],
+ *                   "parent": 0, "parentEdge": [weight, phase]}],
+ *       "high": {"params": [[5 values], ...], "edges": [...],
+ *                "limits": {...}},
+ *       "feedback": {"neuralFilename": "weights.nnw", "numHidden": 4}
+ *     }
+ *
+ * where node params and edge phases are learned values from 0 to 1,
+ * scaled to the limits as JSONCPGControl scales its node and edge
+ * values, and edge weights are used as they are. "high" may have
+ * limits of its own. Only "groups" is required.
+ */
+
+// This library
+#include "tgCPGHierarchyControl.h"
+// Includes from jsoncpp
+#include <json/json.h>
+// The C++ Standard Library
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace tgCPGHierarchyJSON
+{
+    /** The range of each node parameter, and of the phases */
+    struct Limits
+    {
+        double low[5];
+        double high[5];
+        double lowPhase;
+        double highPhase;
+    };
+
+    inline Limits readLimits(const Json::Value& value, const Limits& defaults)
+    {
+        Limits limits = defaults;
+        for (Json::Value::ArrayIndex i = 0; i < 5; i++)
+        {
+            limits.low[i] = value["low"].get(i, limits.low[i]).asDouble();
+            limits.high[i] = value["high"].get(i, limits.high[i]).asDouble();
+        }
+        limits.lowPhase = value["phase"].get(0u, limits.lowPhase).asDouble();
+        limits.highPhase = value["phase"].get(1u, limits.highPhase).asDouble();
+        return limits;
+    }
+
+    /** @throw std::invalid_argument unless value holds 5 numbers */
+    inline tgCPGHierarchyControl::Node readNode(const Json::Value& value,
+                                                 const Limits& limits)
+    {
+        if (!value.isArray() || value.size() != 5)
+        {
+            throw std::invalid_argument("Node params need 5 values");
+        }
+        double scaled[5];
+        for (Json::Value::ArrayIndex i = 0; i < 5; i++)
+        {
+            scaled[i] = value[i].asDouble() * (limits.high[i] - limits.low[i]) +
+                limits.low[i];
+        }
+        tgCPGHierarchyControl::Node node;
+        node.frequency = scaled[0];
+        node.amplitude = scaled[1];
+        node.frequencyFeedback = scaled[2];
+        node.amplitudeFeedback = scaled[3];
+        node.phaseFeedback = scaled[4];
+        return node;
+    }
+
+    /** @throw std::invalid_argument unless value holds 2 numbers */
+    inline tgCPGHierarchyControl::Edge readEdge(const Json::Value& value,
+                                                 const Limits& limits)
+    {
+        if (!value.isArray() || value.size() != 2)
+        {
+            throw std::invalid_argument("Edges need a weight and a phase");
+        }
+        return tgCPGHierarchyControl::Edge(value[0u].asDouble(),
+            value[1u].asDouble() * (limits.highPhase - limits.lowPhase) +
+            limits.lowPhase);
+    }
+
+    inline std::vector<tgCPGHierarchyControl::Edge>
+    readEdges(const Json::Value& value, const Limits& limits)
+    {
+        std::vector<tgCPGHierarchyControl::Edge> edges;
+        for (Json::Value::ArrayIndex i = 0; i < value.size(); i++)
+        {
+            edges.push_back(readEdge(value[i], limits));
+        }
+        return edges;
+    }
+
+    /**
+     * Read a spec, see the file description.
+     * @param[in] root the parsed file
+     * @param[in] resourcePath prepended to the feedback weights file
+     * @throw std::invalid_argument if there are no groups or a value has
+     * the wrong shape
+     */
+    inline tgCPGHierarchyControl::Spec read(const Json::Value& root,
+                                            const std::string& resourcePath = "")
+    {
+        tgCPGHierarchyControl::Spec spec;
+        spec.controlTime = root.get("controlTime", spec.controlTime).asDouble();
+
+        const Json::Value& impedance = root["impedance"];
+        spec.offsetTension =
+            impedance.get("tension", spec.offsetTension).asDouble();
+        spec.lengthStiffness =
+            impedance.get("kPosition", spec.lengthStiffness).asDouble();
+        spec.velStiffness =
+            impedance.get("kVelocity", spec.velStiffness).asDouble();
+        spec.controlLength =
+            impedance.get("controlLength", spec.controlLength).asDouble();
+
+        // The defaults of JSONCPGControl::Config
+        Limits defaults;
+        const double lowParams[5] = {0.0, 0.0, 0.0, 0.0, 0.0};
+        const double highParams[5] = {30.0, 30.0, 0.0, 0.0, 0.0};
+        for (std::size_t i = 0; i < 5; i++)
+        {
+            defaults.low[i] = lowParams[i];
+            defaults.high[i] = highParams[i];
+        }
+        defaults.lowPhase = -M_PI;
+        defaults.highPhase = M_PI;
+        const Limits limits = readLimits(root["limits"], defaults);
+
+        const Json::Value& groups = root["groups"];
+        if (!groups.isArray() || groups.size() == 0)
+        {
+            throw std::invalid_argument("A spec needs groups");
+        }
+        for (Json::Value::ArrayIndex i = 0; i < groups.size(); i++)
+        {
+            const Json::Value& value = groups[i];
+            tgCPGHierarchyControl::Group group;
+            group.tags = value["tags"].asString();
+            group.node = readNode(value["params"], limits);
+            group.edges = readEdges(value["edges"], limits);
+            group.parent = value.get("parent", -1).asInt();
+            if (value.isMember("parentEdge"))
+            {
+                group.parentEdge = readEdge(value["parentEdge"], limits);
+            }
+            spec.groups.push_back(group);
+        }
+
+        const Json::Value& high = root["high"];
+        const Limits highLimits = readLimits(high["limits"], limits);
+        const Json::Value& highNodes = high["params"];
+        for (Json::Value::ArrayIndex i = 0; i < highNodes.size(); i++)
+        {
+            spec.highNodes.push_back(readNode(highNodes[i], highLimits));
+        }
+        spec.highEdges = readEdges(high["edges"], highLimits);
+
+        const Json::Value& feedback = root["feedback"];
+        if (feedback.isMember("neuralFilename"))
+        {
+            spec.feedbackWeights =
+                resourcePath + feedback["neuralFilename"].asString();
+        }
+        spec.feedbackHidden =
+            feedback.get("numHidden", spec.feedbackHidden).asInt();
+        return spec;
+    }
+}
+
+#endif  // TG_CPG_HIERARCHY_JSON_H
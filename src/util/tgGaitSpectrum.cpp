@@ -0,0 +1,299 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgGaitSpectrum.cpp
+ * @brief Implementation of class tgGaitSpectrum
+ * $Id$
+ */
+
+// This module
+#include "tgGaitSpectrum.h"
+// This library
+#include "CPGEquations.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+    const double pi = 3.14159265358979323846;
+
+    /** The smallest window analyzed, in samples */
+    const std::size_t minWindow = 8;
+
+    /** @return an angle wrapped to (-pi, pi] */
+    double wrap(double angle)
+    {
+        angle = std::fmod(angle + pi, 2.0 * pi);
+        if (angle <= 0.0)
+        {
+            angle += 2.0 * pi;
+        }
+        return angle - pi;
+    }
+}
+
+tgGaitSpectrum::Config::Config(double samplePeriod,
+                               double window,
+                               double minFrequency,
+                               double maxFrequency) :
+samplePeriod(samplePeriod),
+window(window),
+minFrequency(minFrequency),
+maxFrequency(maxFrequency)
+{
+}
+
+tgGaitSpectrum::Peak::Peak() :
+frequency(0.0),
+amplitude(0.0),
+bin(0)
+{
+}
+
+tgGaitSpectrum::tgGaitSpectrum(std::size_t channels, const Config& config) :
+m_config(config),
+m_channels(channels),
+m_window(0),
+m_minBin(0),
+m_maxBin(0),
+m_firstBin(0),
+m_bins(0),
+m_next(0),
+m_samples(0),
+m_sinceRefresh(0)
+{
+    if (channels == 0)
+    {
+        throw std::invalid_argument("A spectrum needs a channel");
+    }
+    else if (!(config.samplePeriod > 0.0))
+    {
+        throw std::invalid_argument("Sample period is not positive");
+    }
+    else if (!(config.window / config.samplePeriod >= minWindow))
+    {
+        throw std::invalid_argument("Window is under 8 samples");
+    }
+    else if (!(config.minFrequency >= 0.0) ||
+             !(config.maxFrequency >= config.minFrequency))
+    {
+        throw std::invalid_argument("Frequency range is not ordered");
+    }
+
+    m_window = static_cast<std::size_t>(config.window / config.samplePeriod +
+                                        0.5);
+    // Bin k is k / window Hz; the top two are kept for the Hann window
+    const double binsPerHz = m_window * config.samplePeriod;
+    m_minBin = std::max<std::size_t>(1,
+        static_cast<std::size_t>(std::ceil(config.minFrequency * binsPerHz)));
+    const double top = std::floor(config.maxFrequency * binsPerHz);
+    m_maxBin = top < m_window / 2 - 2 ?
+        static_cast<std::size_t>(top) : m_window / 2 - 2;
+    if (m_minBin > m_maxBin)
+    {
+        throw std::invalid_argument("No bins in the frequency range");
+    }
+    // Two either side, for the window of the bins either side of a peak
+    m_firstBin = m_minBin > 2 ? m_minBin - 2 : 1;
+    m_bins = m_maxBin + 2 - m_firstBin + 1;
+
+    m_cos.resize(m_window);
+    m_sin.resize(m_window);
+    for (std::size_t m = 0; m < m_window; m++)
+    {
+        m_cos[m] = std::cos(2.0 * pi * m / m_window);
+        m_sin[m] = std::sin(2.0 * pi * m / m_window);
+    }
+    m_history.assign(m_window * m_channels, 0.0);
+    m_re.assign(m_bins * m_channels, 0.0);
+    m_im.assign(m_bins * m_channels, 0.0);
+}
+
+void tgGaitSpectrum::sample(const std::vector<double>& values)
+{
+    if (values.size() != m_channels)
+    {
+        throw std::invalid_argument("Not one value per channel");
+    }
+
+    // Slide each bin over the oldest sample:
+    // X'(k) = (X(k) - oldest + newest) e^(2 pi i k / window)
+    double* const pOldest = &m_history[m_next * m_channels];
+    for (std::size_t c = 0; c < m_channels; c++)
+    {
+        const double d = values[c] - pOldest[c];
+        pOldest[c] = values[c];
+        double* const pRe = &m_re[c * m_bins];
+        double* const pIm = &m_im[c * m_bins];
+        for (std::size_t b = 0; b < m_bins; b++)
+        {
+            const std::size_t k = m_firstBin + b;
+            const double re = pRe[b] + d;
+            const double im = pIm[b];
+            pRe[b] = re * m_cos[k] - im * m_sin[k];
+            pIm[b] = re * m_sin[k] + im * m_cos[k];
+        }
+    }
+    m_next = (m_next + 1) % m_window;
+    m_samples++;
+
+    if (++m_sinceRefresh >= m_window)
+    {
+        refresh();
+    }
+}
+
+void tgGaitSpectrum::sample(const CPGEquations& equations)
+{
+    equations.getOutputs(m_values);
+    sample(m_values);
+}
+
+void tgGaitSpectrum::reset()
+{
+    std::fill(m_history.begin(), m_history.end(), 0.0);
+    std::fill(m_re.begin(), m_re.end(), 0.0);
+    std::fill(m_im.begin(), m_im.end(), 0.0);
+    m_next = 0;
+    m_samples = 0;
+    m_sinceRefresh = 0;
+}
+
+void tgGaitSpectrum::refresh()
+{
+    // The oldest sample is sample 0 of the window
+    for (std::size_t c = 0; c < m_channels; c++)
+    {
+        for (std::size_t b = 0; b < m_bins; b++)
+        {
+            const std::size_t k = m_firstBin + b;
+            double re = 0.0;
+            double im = 0.0;
+            for (std::size_t m = 0; m < m_window; m++)
+            {
+                const double x =
+                    m_history[((m_next + m) % m_window) * m_channels + c];
+                const std::size_t j = (k * m) % m_window;
+                re += x * m_cos[j];
+                im -= x * m_sin[j];
+            }
+            m_re[c * m_bins + b] = re;
+            m_im[c * m_bins + b] = im;
+        }
+    }
+    m_sinceRefresh = 0;
+}
+
+void tgGaitSpectrum::hann(std::size_t channel, std::size_t k,
+                          double& re, double& im) const
+{
+    // Bin 0 is the mean, which is removed
+    const std::size_t base = channel * m_bins;
+    const std::size_t b = k - m_firstBin;
+    const double belowRe = k - 1 == 0 ? 0.0 : m_re[base + b - 1];
+    const double belowIm = k - 1 == 0 ? 0.0 : m_im[base + b - 1];
+    re = 0.5 * m_re[base + b] - 0.25 * (belowRe + m_re[base + b + 1]);
+    im = 0.5 * m_im[base + b] - 0.25 * (belowIm + m_im[base + b + 1]);
+}
+
+tgGaitSpectrum::Peak tgGaitSpectrum::getPeak(std::size_t channel) const
+{
+    requireChannel(channel);
+    Peak peak;
+    if (!isReady())
+    {
+        return peak;
+    }
+
+    double best = 0.0;
+    for (std::size_t k = m_minBin; k <= m_maxBin; k++)
+    {
+        double re;
+        double im;
+        hann(channel, k, re, im);
+        const double power = re * re + im * im;
+        if (power > best)
+        {
+            best = power;
+            peak.bin = k;
+        }
+    }
+    if (best == 0.0)
+    {
+        return peak;
+    }
+
+    // Fit a parabola to the log magnitudes around the peak; the bin
+    // below the first has no window but is the mean
+    const double beta = 0.5 * std::log(best);
+    double offset = 0.0;
+    double logPeak = beta;
+    if (peak.bin > 1)
+    {
+        const double tiny = std::numeric_limits<double>::min();
+        double re;
+        double im;
+        hann(channel, peak.bin - 1, re, im);
+        const double alpha = 0.5 * std::log(re * re + im * im + tiny);
+        hann(channel, peak.bin + 1, re, im);
+        const double gamma = 0.5 * std::log(re * re + im * im + tiny);
+        const double curvature = alpha - 2.0 * beta + gamma;
+        if (curvature < 0.0)
+        {
+            offset = std::max(-0.5,
+                              std::min(0.5, 0.5 * (alpha - gamma) / curvature));
+            logPeak = beta - 0.25 * (alpha - gamma) * offset;
+        }
+    }
+
+    const double binsPerHz = m_window * m_config.samplePeriod;
+    peak.frequency = (peak.bin + offset) / binsPerHz;
+    // A Hann window passes a quarter of window * amplitude
+    peak.amplitude = 4.0 * std::exp(logPeak) / m_window;
+    return peak;
+}
+
+double tgGaitSpectrum::getPhaseLag(std::size_t channel,
+                                   std::size_t reference) const
+{
+    requireChannel(channel);
+    const Peak peak = getPeak(reference);
+    if (peak.bin == 0)
+    {
+        return 0.0;
+    }
+    double re;
+    double im;
+    hann(channel, peak.bin, re, im);
+    double refRe;
+    double refIm;
+    hann(reference, peak.bin, refRe, refIm);
+    return wrap(std::atan2(im, re) - std::atan2(refIm, refRe));
+}
+
+void tgGaitSpectrum::requireChannel(std::size_t channel) const
+{
+    if (channel >= m_channels)
+    {
+        throw std::out_of_range("channel index is out of range");
+    }
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_GAIT_SPECTRUM_H
+#define TG_GAIT_SPECTRUM_H
+
+/**
+ * @file tgGaitSpectrum.h
+ * @brief Definition of class tgGaitSpectrum
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <vector>
+
+// Forward declarations
+class CPGEquations;
+
+/**
+ * The spectrum of a few signals sampled at a fixed interval, such as
+ * the lengths of a model's cables or the outputs of its CPG nodes, over
+ * a sliding window of the latest samples. Each sample updates the bins
+ * between the minimum and maximum frequency with a sliding DFT, one
+ * complex multiply per bin and signal, so a gait's stride frequency,
+ * amplitude and phase lags can be read at any step instead of being
+ * found offline from a log of every value. The bins are recomputed
+ * exactly once per window, so rounding does not accumulate.
+ *
+ * The peaks are read through a Hann window, applied to the bins, with
+ * the mean removed. Their frequency and amplitude are interpolated
+ * between bins, so they are finer than the 1 / window resolution.
+ */
+class tgGaitSpectrum
+{
+public:
+
+    struct Config
+    {
+        Config(double samplePeriod = 0.01,
+               double window = 5.0,
+               double minFrequency = 0.2,
+               double maxFrequency = 10.0);
+
+        /** The seconds between samples, positive */
+        double samplePeriod;
+
+        /** The seconds of samples analyzed, at least 8 samples */
+        double window;
+
+        /** The range of frequencies searched for peaks, in Hz */
+        double minFrequency;
+        double maxFrequency;
+    };
+
+    /** The strongest frequency of a signal */
+    struct Peak
+    {
+        Peak();
+
+        /** In Hz */
+        double frequency;
+
+        /** The amplitude of that frequency, half the peak to peak */
+        double amplitude;
+
+        /** The nearest bin */
+        std::size_t bin;
+    };
+
+    /**
+     * @param[in] channels the number of signals, positive
+     * @throw std::invalid_argument if there are no channels, the
+     * configuration is out of range or it leaves no bins to search
+     */
+    tgGaitSpectrum(std::size_t channels, const Config& config = Config());
+
+    /**
+     * Add the next sample of every signal.
+     * @param[in] values one value per channel
+     * @throw std::invalid_argument if there is not one value per channel
+     */
+    void sample(const std::vector<double>& values);
+
+    /**
+     * Add the outputs of a CPG system, one channel per node.
+     * @throw std::invalid_argument if there is not one node per channel
+     */
+    void sample(const CPGEquations& equations);
+
+    /** Forget every sample. */
+    void reset();
+
+    /** @return true once a whole window has been sampled */
+    bool isReady() const { return m_samples >= m_window; }
+
+    /**
+     * @return the peak of a channel; zero until isReady()
+     * @throw std::out_of_range if channel is not less than getChannels()
+     */
+    Peak getPeak(std::size_t channel) const;
+
+    /** @return the frequency of the peak of a channel, in Hz */
+    double getFrequency(std::size_t channel) const
+    {
+        return getPeak(channel).frequency;
+    }
+
+    /** @return the amplitude of the peak of a channel */
+    double getAmplitude(std::size_t channel) const
+    {
+        return getPeak(channel).amplitude;
+    }
+
+    /**
+     * @return the phase of a channel less that of a reference channel, at
+     * the frequency of the reference's peak, in radians from -pi to pi;
+     * positive if the channel leads. Zero until isReady().
+     * @throw std::out_of_range if either is not less than getChannels()
+     */
+    double getPhaseLag(std::size_t channel, std::size_t reference) const;
+
+    std::size_t getChannels() const { return m_channels; }
+
+    /** @return the samples in a window */
+    std::size_t getWindowSamples() const { return m_window; }
+
+    const Config& getConfig() const { return m_config; }
+
+private:
+
+    /** Recompute every bin from the samples in the window */
+    void refresh();
+
+    /** The Hann windowed bin k of a channel, with the mean removed */
+    void hann(std::size_t channel, std::size_t k,
+              double& re, double& im) const;
+
+    /** @throw std::out_of_range if channel is out of range */
+    void requireChannel(std::size_t channel) const;
+
+private:
+
+    const Config m_config;
+
+    const std::size_t m_channels;
+
+    /** The samples in a window */
+    std::size_t m_window;
+
+    /** The bins searched for peaks, inclusive */
+    std::size_t m_minBin;
+    std::size_t m_maxBin;
+
+    /** The first bin kept, two below m_minBin for the window, at least 1 */
+    std::size_t m_firstBin;
+
+    /** The number of bins kept, through m_maxBin + 2 */
+    std::size_t m_bins;
+
+    /** The cosine and sine of 2 pi m / m_window, for m below m_window */
+    std::vector<double> m_cos;
+    std::vector<double> m_sin;
+
+    /** The last m_window samples of each channel, sample major */
+    std::vector<double> m_history;
+
+    /** The next sample to be replaced in m_history */
+    std::size_t m_next;
+
+    /** The samples since reset(), up to the end of the current window */
+    std::size_t m_samples;
+
+    /** The samples since the last refresh() */
+    std::size_t m_sinceRefresh;
+
+    /** The kept bins of each channel, channel major */
+    std::vector<double> m_re;
+    std::vector<double> m_im;
+
+    /** Scratch space for the outputs of a CPG system */
+    std::vector<double> m_values;
+};
+
+#endif  // TG_GAIT_SPECTRUM_H
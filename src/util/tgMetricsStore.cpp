@@ -0,0 +1,188 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file tgMetricsStore.cpp
+ * @brief Implementation of class tgMetricsStore
+ * $Id$
+ */
+
+// This module
+#include "tgMetricsStore.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <stdexcept>
+
+tgMetricsStore::tgMetricsStore(std::size_t capacity) :
+    m_capacity(capacity)
+{
+}
+
+std::size_t tgMetricsStore::addColumn(const std::string& name)
+{
+    if (hasColumn(name))
+    {
+        throw std::invalid_argument("Metrics store already has column " + name);
+    }
+    const std::size_t c = m_values.size();
+    m_names.push_back(name);
+    m_index[name] = c;
+    m_values.push_back(std::vector<double>());
+    m_values.back().reserve(m_capacity);
+    return c;
+}
+
+std::size_t tgMetricsStore::getColumn(const std::string& name) const
+{
+    const std::map<std::string, std::size_t>::const_iterator it =
+        m_index.find(name);
+    if (it == m_index.end())
+    {
+        throw std::invalid_argument("Metrics store has no column " + name);
+    }
+    return it->second;
+}
+
+bool tgMetricsStore::hasColumn(const std::string& name) const
+{
+    return m_index.find(name) != m_index.end();
+}
+
+void tgMetricsStore::reserve(std::size_t capacity)
+{
+    m_capacity = capacity;
+    for (std::size_t c = 0; c < m_values.size(); c++)
+    {
+        m_values[c].reserve(capacity);
+    }
+}
+
+void tgMetricsStore::clear()
+{
+    for (std::size_t c = 0; c < m_values.size(); c++)
+    {
+        m_values[c].clear();
+    }
+}
+
+double tgMetricsStore::sum(std::size_t c) const
+{
+    const std::vector<double>& v = m_values[c];
+    const std::size_t n = v.size();
+    double result = 0.0;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        result += v[i];
+    }
+    return result;
+}
+
+double tgMetricsStore::mean(std::size_t c) const
+{
+    requireValues(c);
+    return sum(c) / m_values[c].size();
+}
+
+double tgMetricsStore::variance(std::size_t c) const
+{
+    // Two passes: summing squares directly loses precision when the
+    // mean is large
+    const double m = mean(c);
+    const std::vector<double>& v = m_values[c];
+    const std::size_t n = v.size();
+    double result = 0.0;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const double d = v[i] - m;
+        result += d * d;
+    }
+    return result / n;
+}
+
+double tgMetricsStore::min(std::size_t c) const
+{
+    requireValues(c);
+    return *std::min_element(m_values[c].begin(), m_values[c].end());
+}
+
+double tgMetricsStore::max(std::size_t c) const
+{
+    requireValues(c);
+    return *std::max_element(m_values[c].begin(), m_values[c].end());
+}
+
+double tgMetricsStore::percentile(std::size_t c, double p) const
+{
+    if (p < 0.0 || p > 100.0)
+    {
+        throw std::invalid_argument("Percentile is not between 0 and 100");
+    }
+    requireValues(c);
+
+    m_sorted = m_values[c];
+    const double rank = p / 100.0 * (m_sorted.size() - 1);
+    const std::size_t below = static_cast<std::size_t>(rank);
+    std::nth_element(m_sorted.begin(), m_sorted.begin() + below,
+                     m_sorted.end());
+    const double low = m_sorted[below];
+    if (below + 1 == m_sorted.size())
+    {
+        return low;
+    }
+    // The next rank is the smallest of the values above
+    const double high = *std::min_element(m_sorted.begin() + below + 1,
+                                          m_sorted.end());
+    return low + (rank - below) * (high - low);
+}
+
+double tgMetricsStore::integral(std::size_t c, double dt) const
+{
+    const std::vector<double>& v = m_values[c];
+    const std::size_t n = v.size();
+    if (n < 2)
+    {
+        return 0.0;
+    }
+    // The trapezoid rule counts the end points half
+    return dt * (sum(c) - 0.5 * (v[0] + v[n - 1]));
+}
+
+double tgMetricsStore::integral(std::size_t c, std::size_t t) const
+{
+    const std::vector<double>& v = m_values[c];
+    const std::vector<double>& time = m_values[t];
+    if (v.size() != time.size())
+    {
+        throw std::invalid_argument("Columns " + m_names[c] + " and " +
+                                    m_names[t] + " differ in size");
+    }
+    double result = 0.0;
+    for (std::size_t i = 1; i < v.size(); i++)
+    {
+        result += 0.5 * (v[i] + v[i - 1]) * (time[i] - time[i - 1]);
+    }
+    return result;
+}
+
+void tgMetricsStore::requireValues(std::size_t c) const
+{
+    if (m_values[c].empty())
+    {
+        throw std::runtime_error("Metrics column " + m_names[c] + " is empty");
+    }
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ * 
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TG_METRICS_STORE_H
+#define TG_METRICS_STORE_H
+
+/**
+ * @file tgMetricsStore.h
+ * @brief Definition of class tgMetricsStore
+ * $Id$
+ */
+
+// The C++ Standard Library
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Named columns of doubles that controllers and loggers append to while
+ * a trial runs and reduce at teardown, instead of each keeping its own
+ * vectors and statistics code. Columns are independent, so metrics
+ * sampled at different rates can share a store. Appending is constant
+ * time, and free of allocation up to the reserved number of rows; the
+ * reductions run over contiguous memory.
+ */
+class tgMetricsStore
+{
+public:
+
+    /**
+     * @param[in] capacity the number of values to reserve in each column
+     */
+    explicit tgMetricsStore(std::size_t capacity = 0);
+
+    /**
+     * Add an empty column, with the reserved capacity.
+     * @param[in] name the name of the column
+     * @return the index of the column, for append() and the reductions
+     * @throw std::invalid_argument if the store already has the column
+     */
+    std::size_t addColumn(const std::string& name);
+
+    /**
+     * @param[in] name the name of a column
+     * @return the index of the column
+     * @throw std::invalid_argument if there is no such column
+     */
+    std::size_t getColumn(const std::string& name) const;
+
+    /** @return true if the store has a column of that name */
+    bool hasColumn(const std::string& name) const;
+
+    /** @return the number of columns */
+    std::size_t columns() const { return m_values.size(); }
+
+    /** @return the name of column c */
+    const std::string& getName(std::size_t c) const { return m_names[c]; }
+
+    /**
+     * Reserve room for a number of values in every column, now and in
+     * columns added later.
+     * @param[in] capacity the number of values
+     */
+    void reserve(std::size_t capacity);
+
+    /** Append a value to column c. */
+    void append(std::size_t c, double value) { m_values[c].push_back(value); }
+
+    /**
+     * Empty every column, keeping the columns and their capacity, for
+     * the next trial.
+     */
+    void clear();
+
+    /** @return the number of values in column c */
+    std::size_t size(std::size_t c) const { return m_values[c].size(); }
+
+    /** @return the values of column c, in the order they were appended */
+    const std::vector<double>& getValues(std::size_t c) const
+    {
+        return m_values[c];
+    }
+
+    /** @return the sum of column c, or zero if it is empty */
+    double sum(std::size_t c) const;
+
+    /**
+     * @return the mean of column c
+     * @throw std::runtime_error if the column is empty
+     */
+    double mean(std::size_t c) const;
+
+    /**
+     * @return the population variance of column c
+     * @throw std::runtime_error if the column is empty
+     */
+    double variance(std::size_t c) const;
+
+    /**
+     * @return the smallest value in column c
+     * @throw std::runtime_error if the column is empty
+     */
+    double min(std::size_t c) const;
+
+    /**
+     * @return the largest value in column c
+     * @throw std::runtime_error if the column is empty
+     */
+    double max(std::size_t c) const;
+
+    /**
+     * Interpolates linearly between the two nearest ranks, so the 50th
+     * percentile of an even number of values is the mean of the middle
+     * two.
+     * @param[in] c a column
+     * @param[in] p the percentile, from 0 to 100
+     * @return the pth percentile of column c
+     * @throw std::invalid_argument if p is not between 0 and 100
+     * @throw std::runtime_error if the column is empty
+     */
+    double percentile(std::size_t c, double p) const;
+
+    /**
+     * @param[in] c a column sampled at a fixed interval
+     * @param[in] dt the interval
+     * @return the trapezoidal integral of column c over time, or zero if
+     * it has fewer than two values
+     */
+    double integral(std::size_t c, double dt) const;
+
+    /**
+     * @param[in] c a column
+     * @param[in] t a column of the same size holding the time of each
+     * value in c
+     * @return the trapezoidal integral of column c over the times in t
+     * @throw std::invalid_argument if the columns differ in size
+     */
+    double integral(std::size_t c, std::size_t t) const;
+
+private:
+
+    /** @throw std::runtime_error naming column c if it is empty */
+    void requireValues(std::size_t c) const;
+
+private:
+
+    /** The number of values reserved in each column. */
+    std::size_t m_capacity;
+
+    /** The name of each column. */
+    std::vector<std::string> m_names;
+
+    /** The index of each column by name. */
+    std::map<std::string, std::size_t> m_index;
+
+    /** The values of each column. */
+    std::vector<std::vector<double> > m_values;
+
+    /** Scratch space for percentile(), kept to avoid reallocating. */
+    mutable std::vector<double> m_sorted;
+};
+
+#endif  // TG_METRICS_STORE_H
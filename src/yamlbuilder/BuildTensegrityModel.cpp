@@ -35,17 +35,56 @@
 // Bullet Physics
 #include "LinearMath/btVector3.h"
 // The C++ Standard Library
+#include <cstddef>
+#include <cstring>
+#include <ctime>
 #include <iostream>
 
 /**
  * The entry point.
  * @param[in] argc the number of command-line arguments
  * @param[in] argv argv[0] is the executable name
- * @param[in] argv argv[1] is the path of the YAML encoded structure
- * @return 0
+ * @param[in] argv argv[1] is the path of the YAML encoded structure, or of
+ * a compiled model. With '--compile structure output' instead, the structure
+ * is compiled to the file output and nothing is simulated, and with
+ * '--generate structure ClassName directory' it is written as the C++ model
+ * ClassName.h and ClassName.cpp in directory. '--preview structure [wireframe.obj]'
+ * resolves the structure and its builders without any physics, reports the counts
+ * and problems found and optionally writes the pairs as a wireframe.
+ * @return 0, or 1 if a preview found problems
  */
 int main(int argc, char** argv)
 {
+    if (argc > 1 && std::strcmp(argv[1], "--compile") == 0) {
+        if (argc != 4) {
+            std::cerr << "Usage: " << argv[0] << " --compile structure.yaml output" << std::endl;
+            return 1;
+        }
+        TensegrityModel model(argv[2], false);
+        model.compile(argv[3]);
+        return 0;
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--generate") == 0) {
+        if (argc != 5) {
+            std::cerr << "Usage: " << argv[0] << " --generate structure.yaml ClassName directory" << std::endl;
+            return 1;
+        }
+        TensegrityModel model(argv[2], false);
+        model.generate(argv[3], argv[4]);
+        return 0;
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--preview") == 0) {
+        if (argc != 3 && argc != 4) {
+            std::cerr << "Usage: " << argv[0] << " --preview structure.yaml [wireframe.obj]" << std::endl;
+            return 1;
+        }
+        const std::clock_t start = std::clock();
+        TensegrityModel model(argv[2], false);
+        const std::size_t problems = model.preview(std::cout, argc == 4 ? argv[3] : "");
+        std::cout << "Previewed in " << double(std::clock() - start) / CLOCKS_PER_SEC << " s" << std::endl;
+        return problems == 0 ? 0 : 1;
+    }
+
     // create the ground and world. Specify ground rotation in radians
     const double yaw = 0.0;
     const double pitch = 0.0;
@@ -24,23 +24,321 @@
  */
 
 #include "TensegrityModel.h"
+#include "TensegrityModelFile.h"
+#include "TensegrityModelGenerator.h"
 // C++ Standard Library
+#include <cctype>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
 #include <iostream>
+#include <queue>
+#include <set>
+#include <sstream>
 #include <stdexcept>
 // NTRT Core and tgCreator Libraries
+#include "core/tgAssetCache.h"
+#include "core/tgBaseRigid.h"
 #include "core/tgBasicActuator.h"
 #include "core/tgKinematicActuator.h"
 #include "core/tgRod.h"
 #include "core/tgBox.h"
 #include "core/tgSphere.h"
+#include "core/tgThreadPool.h"
+#include "core/tgWorld.h"
+#include "core/terrain/tgEmptyGround.h"
 #include "tgcreator/tgBasicActuatorInfo.h"
 #include "tgcreator/tgBasicContactCableInfo.h"
 #include "tgcreator/tgKinematicActuatorInfo.h"
 #include "tgcreator/tgKinematicContactCableInfo.h"
 #include "tgcreator/tgRodInfo.h"
 #include "tgcreator/tgBoxInfo.h"
+#include "tgcreator/tgConnectorInfo.h"
+#include "tgcreator/tgRigidInfo.h"
 #include "tgcreator/tgSphereInfo.h"
 #include "tgcreator/tgStructureInfo.h"
+// Boost
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_map.hpp>
+
+namespace
+{
+    /**
+     * A pair endpoint, compared exactly the way tgStructure::findPair
+     * compares them (btVector3::operator==)
+     */
+    struct PointKey
+    {
+        PointKey(const btVector3& v) :
+            // Adding zero folds -0.0 into 0.0, which operator== treats as equal
+            x(v.x() + 0.0), y(v.y() + 0.0), z(v.z() + 0.0)
+        {
+        }
+
+        bool operator==(const PointKey& other) const
+        {
+            return x == other.x && y == other.y && z == other.z;
+        }
+
+        btScalar x;
+        btScalar y;
+        btScalar z;
+    };
+
+    std::size_t hash_value(const PointKey& key)
+    {
+        std::size_t seed = 0;
+        boost::hash_combine(seed, key.x);
+        boost::hash_combine(seed, key.y);
+        boost::hash_combine(seed, key.z);
+        return seed;
+    }
+
+    /** The endpoints of a pair, in either order, as findPair matches them */
+    struct EndpointsKey
+    {
+        EndpointsKey(const btVector3& from, const btVector3& to) :
+            from(from), to(to)
+        {
+        }
+
+        bool operator==(const EndpointsKey& other) const
+        {
+            return (from == other.from && to == other.to) ||
+                (from == other.to && to == other.from);
+        }
+
+        PointKey from;
+        PointKey to;
+    };
+
+    std::size_t hash_value(const EndpointsKey& key)
+    {
+        // Symmetric, so that both orders land in the same bucket
+        return hash_value(key.from) + hash_value(key.to);
+    }
+
+    /** The problems of each kind listed by preview, the rest are only counted */
+    const std::size_t shownProblems = 10;
+
+    /** Appends structure and every structure below it, parents first */
+    void collectStructures(const tgStructure& structure, std::vector<const tgStructure*>& structures) {
+        structures.push_back(&structure);
+        const std::vector<tgStructure*>& children = structure.getChildren();
+        for (std::size_t i = 0; i < children.size(); i++) {
+            collectStructures(*children[i], structures);
+        }
+    }
+
+    bool isFinite(const btVector3& v) {
+        return std::isfinite(v.x()) && std::isfinite(v.y()) && std::isfinite(v.z());
+    }
+
+    std::string describe(const btVector3& from, const btVector3& to, const std::string& tags) {
+        std::ostringstream out;
+        out << "(" << from.x() << ", " << from.y() << ", " << from.z() << ") to ("
+            << to.x() << ", " << to.y() << ", " << to.z() << ") tagged '" << tags << "'";
+        return out.str();
+    }
+
+    /** Lists a kind of problem, the first shownProblems of them in full */
+    std::size_t reportProblems(std::ostream& report, const std::string& kind,
+                               const std::vector<std::string>& problems) {
+        if (problems.empty()) return 0;
+        report << problems.size() << " " << kind << ":" << std::endl;
+        for (std::size_t i = 0; i < problems.size() && i < shownProblems; i++) {
+            report << "  " << problems[i] << std::endl;
+        }
+        if (problems.size() > shownProblems) {
+            report << "  ... and " << problems.size() - shownProblems << " more" << std::endl;
+        }
+        return problems.size();
+    }
+
+    /** An OBJ group name for a set of tags, which can't contain spaces */
+    std::string groupName(const std::string& tags) {
+        std::string name = tags.empty() ? std::string("untagged") : tags;
+        for (std::size_t i = 0; i < name.size(); i++) {
+            if (std::isspace(static_cast<unsigned char>(name[i]))) name[i] = '_';
+        }
+        return name;
+    }
+
+    void writeWireframe(const std::string& path, const std::vector<const tgPair*>& pairs,
+                        const std::set<const tgPair*>& unbuilt) {
+        // one group per set of tags, unbuilt pairs by themselves
+        std::map<std::string, std::vector<const tgPair*> > groups;
+        for (std::size_t i = 0; i < pairs.size(); i++) {
+            const std::string name = unbuilt.count(pairs[i]) ? "unbuilt" : groupName(pairs[i]->getTagStr());
+            groups[name].push_back(pairs[i]);
+        }
+
+        std::ofstream out(path.c_str());
+        if (!out) {
+            throw std::runtime_error("Can't write wireframe: " + path);
+        }
+        out.precision(17);
+        out << "# Pairs of a TensegrityModel preview, one line each" << std::endl;
+        std::size_t vertex = 1;
+        for (std::map<std::string, std::vector<const tgPair*> >::const_iterator group = groups.begin();
+             group != groups.end(); ++group) {
+            out << "g " << group->first << std::endl;
+            for (std::size_t i = 0; i < group->second.size(); i++) {
+                const btVector3& from = group->second[i]->getFrom();
+                const btVector3& to = group->second[i]->getTo();
+                out << "v " << from.x() << " " << from.y() << " " << from.z() << std::endl
+                    << "v " << to.x() << " " << to.y() << " " << to.z() << std::endl
+                    << "l " << vertex << " " << vertex + 1 << std::endl;
+                vertex += 2;
+            }
+        }
+        if (!out) {
+            throw std::runtime_error("Can't write wireframe: " + path);
+        }
+    }
+
+    /**
+     * Returns the canonical form of path, so that two relative paths to
+     * the same file share one entry. A path that can't be resolved is
+     * returned as is and left for YAML::LoadFile to report.
+     */
+    std::string canonicalPath(const std::string& path)
+    {
+        char resolved[PATH_MAX];
+        if (realpath(path.c_str(), resolved) == NULL) {
+            return path;
+        }
+        return std::string(resolved);
+    }
+
+    /**
+     * Returns the path of a child structure file, which is relative to its
+     * parent's directory unless it is absolute.
+     */
+    std::string childStructurePath(const std::string& parentPath, const std::string& childPath)
+    {
+        if (childPath[0] != '/') {
+            return parentPath.substr(0, parentPath.rfind("/") + 1) + childPath;
+        }
+        return childPath;
+    }
+}
+
+/**
+ * The pairs under one structure by their endpoints, each list in the BFS
+ * order tgStructure::findPair searches them. A node_edge bond builds one
+ * per bonded structure rather than searching it for every pair it removes.
+ */
+class TensegrityModel::PairIndex
+{
+public:
+    explicit PairIndex(tgStructure& structure)
+    {
+        std::queue<tgStructure*> q;
+        q.push(&structure);
+        while (!q.empty()) {
+            tgStructure* const owner = q.front();
+            q.pop();
+            const tgPairs& pairs = owner->getPairs();
+            for (int i = 0; i < pairs.size(); i++) {
+                m_pairs[EndpointsKey(pairs[i].getFrom(), pairs[i].getTo())]
+                    .push_back(Entry(owner, pairs[i]));
+            }
+            const std::vector<tgStructure*>& children = owner->getChildren();
+            for (std::size_t i = 0; i < children.size(); i++) {
+                q.push(children[i]);
+            }
+        }
+    }
+
+    /** Returns the pair findPair would, or NULL if there is none */
+    const tgPair* find(const btVector3& from, const btVector3& to) const
+    {
+        const Pairs::const_iterator found = m_pairs.find(EndpointsKey(from, to));
+        return found == m_pairs.end() ? NULL : &found->second.front().pair;
+    }
+
+    /**
+     * Removes pair from every structure holding it, with the same result
+     * as tgStructure::removePair on the indexed structure
+     */
+    void remove(const tgPair& pair)
+    {
+        const tgPair removed = pair;
+        const Pairs::iterator found =
+            m_pairs.find(EndpointsKey(removed.getFrom(), removed.getTo()));
+        if (found == m_pairs.end()) return;
+        std::vector<Entry>& entries = found->second;
+        std::vector<Entry> kept;
+        for (std::size_t i = 0; i < entries.size(); i++) {
+            if (entries[i].pair == removed) {
+                entries[i].owner->removePair(removed);
+            }
+            else {
+                kept.push_back(entries[i]);
+            }
+        }
+        if (kept.empty()) {
+            m_pairs.erase(found);
+        }
+        else {
+            entries.swap(kept);
+        }
+    }
+
+private:
+    struct Entry
+    {
+        Entry(tgStructure* owner, const tgPair& pair) : owner(owner), pair(pair) {}
+        tgStructure* owner;
+        tgPair pair;
+    };
+
+    typedef boost::unordered_map<EndpointsKey, std::vector<Entry> > Pairs;
+    Pairs m_pairs;
+};
+
+/**
+ * Reads and parses one structure file per item. A file that fails is only
+ * marked, so that the build reads it again and reports it where a build
+ * without preloading would.
+ */
+class TensegrityModel::ParseTask : public tgThreadPool::Task
+{
+public:
+    ParseTask(const TensegrityModel& model, const std::vector<std::string>& paths) :
+        m_model(model),
+        m_paths(paths),
+        m_roots(paths.size()),
+        m_parsed(paths.size(), 0)
+    {
+    }
+
+    virtual void operator()(std::size_t item)
+    {
+        try {
+            const tgAssetCache::Handle file = tgAssetCache::read(m_paths[item]);
+            m_roots[item] = m_model.parseStructureDocument(file->str(), m_paths[item]);
+            m_parsed[item] = 1;
+        }
+        catch (const std::exception&) {
+        }
+    }
+
+    /** Returns true if the file of item was read and is valid */
+    bool parsed(std::size_t item) const { return m_parsed[item] != 0; }
+
+    const Yam& root(std::size_t item) const { return m_roots[item]; }
+
+private:
+    const TensegrityModel& m_model;
+    const std::vector<std::string>& m_paths;
+    std::vector<Yam> m_roots;
+    // char rather than bool, so that items can be written concurrently
+    std::vector<char> m_parsed;
+};
 
 /**
  * Constructor that only takes the path to the YAML file.
@@ -85,17 +383,15 @@ void TensegrityModel::trace(const tgStructure& structure,
 void TensegrityModel::setup(tgWorld& world) {
     // create the build spec that uses tags to turn the structure into a model
     tgBuildSpec spec;
+    addDefaultBuilders(spec);
 
-    // add default builders (rods, strings, boxes) that match the tags (rods, strings, boxes, spheres)
-    // (these will be overwritten if a different builder is specified for those tags)
-    Yam emptyYam = Yam();
-    addRodBuilder("tgRodInfo", "rod", emptyYam, spec);
-    addBasicActuatorBuilder("tgBasicActuatorInfo", "string", emptyYam, spec);
-    addBoxBuilder("tgBoxInfo", "box", emptyYam, spec);
-    addSphereBuilder("tgSphereInfo", "sphere", emptyYam, spec);
-
-    tgStructure structure;
-    buildStructure(structure, topLvlStructurePath, spec);
+    // the structure files are only read by the first setup, later ones (resets) and
+    // parameter overrides start from the resolved structure
+    resolveStructure();
+    for (std::size_t i = 0; i < resolvedBuilders.size(); ++i) {
+        addBuilders(spec, resolvedBuilders[i]);
+    }
+    tgStructure structure(*resolvedStructure);
 
     tgStructureInfo structureInfo(structure, spec);
     structureInfo.buildInto(*this, world);
@@ -115,70 +411,289 @@ void TensegrityModel::setup(tgWorld& world) {
     tgModel::setup(world);
 }
 
-void TensegrityModel::addChildren(tgStructure& structure, const std::string& structurePath, tgBuildSpec& spec, const Yam& children) {
-    if (!children) return;
-    std::string structureAttributeKeys[] = {"path", "rotation", "translation", "scale", "offset"};
-    std::vector<std::string> structureAttributeKeysVector(structureAttributeKeys, structureAttributeKeys + sizeof(structureAttributeKeys) / sizeof(std::string));
+/**
+ * Builds the structure as setup would and writes it, along with the builders, to
+ * compiledPath. Passing that file to the constructor later skips the YAML files.
+ */
+void TensegrityModel::compile(const std::string& compiledPath) {
+    resolveStructure();
+    TensegrityModelFile::write(compiledPath, *resolvedStructure, resolvedBuilders);
+}
 
-    // add all the children first
-    for (YAML::const_iterator child = children.begin(); child != children.end(); ++child) {
-        Yam childAttributes = child->second;
-        yamlContainsOnly(childAttributes, structurePath, structureAttributeKeysVector);
-        // multiple children can be defined using the syntax: child1/child2/child3...
-        // (add a slash so that each child is a string with a its name and a slash at the end)
-        std::string childCombos = child->first.as<std::string>() + "/";
-        while (childCombos.find("/") != std::string::npos) {
-            std::string childName = childCombos.substr(0, childCombos.find("/"));
-            addChild(structure, structurePath, childName, childAttributes["path"], spec);
-            childCombos = childCombos.substr(childCombos.find("/") + 1);
+/**
+ * Writes the structure as a C++ model. The builders are recorded as they are added to a spec, and one build in an
+ * empty world counts the actuators and rigids they make.
+ */
+void TensegrityModel::generate(const std::string& className, const std::string& outputDir) {
+    resolveStructure();
+
+    std::string builders;
+    tgBuildSpec spec;
+    generatedBuilders = &builders;
+    try {
+        addDefaultBuilders(spec);
+        for (std::size_t i = 0; i < resolvedBuilders.size(); ++i) {
+            addBuilders(spec, resolvedBuilders[i]);
         }
     }
+    catch (...) {
+        generatedBuilders = NULL;
+        throw;
+    }
+    generatedBuilders = NULL;
+
+    TensegrityModelGenerator::Model model;
+    model.className = className;
+    model.structurePath = topLvlStructurePath;
+    model.structure = resolvedStructure.get();
+    model.builders = builders;
+
+    tgWorld world(tgWorld::Config(), new tgEmptyGround());
+    setup(world);
+    for (std::size_t i = 0; i < allActuators.size(); i++) {
+        model.actuatorTags.push_back(allActuators[i]->getTagStr());
+    }
+    model.rigidCount = tgCast::filter<tgModel, tgBaseRigid>(getDescendants()).size();
+    teardown();
 
-    // apply rotation attribute to children
-    for (YAML::const_iterator child = children.begin(); child != children.end(); ++child) {
-        Yam childAttributes = child->second;
-        // multiple children can be defined using the syntax: child1/child2/child3...
-        // (add a slash so that each child is a string with a its name and a slash at the end)
-        std::string childCombos = child->first.as<std::string>() + "/";
-        while (childCombos.find("/") != std::string::npos) {
-            std::string childName = childCombos.substr(0, childCombos.find("/"));
-            tgStructure& childStructure = structure.findChild(childName);
-            addChildRotation(childStructure, childAttributes["rotation"]);
-            childCombos = childCombos.substr(childCombos.find("/") + 1);
+    TensegrityModelGenerator::write(model, outputDir);
+}
+
+/**
+ * Resolves the structure and the builders' infos exactly as setup does, stopping before buildInto would create
+ * any bodies or cables, and checks what was resolved.
+ */
+std::size_t TensegrityModel::preview(std::ostream& report, const std::string& wireframePath) {
+    tgBuildSpec spec;
+    addDefaultBuilders(spec);
+    resolveStructure();
+    for (std::size_t i = 0; i < resolvedBuilders.size(); ++i) {
+        addBuilders(spec, resolvedBuilders[i]);
+    }
+    tgStructure structure(*resolvedStructure);
+    tgStructureInfo structureInfo(structure, spec);
+    const std::vector<const tgPair*> unbuiltPairs = structureInfo.resolve();
+    const std::set<const tgPair*> unbuilt(unbuiltPairs.begin(), unbuiltPairs.end());
+
+    std::vector<const tgStructure*> structures;
+    collectStructures(structure, structures);
+    std::size_t nodes = 0;
+    std::vector<const tgPair*> pairs;
+    std::vector<std::string> unbuiltProblems;
+    std::vector<std::string> degenerateProblems;
+    for (std::size_t i = 0; i < structures.size(); i++) {
+        const tgNodes& structureNodes = structures[i]->getNodes();
+        nodes += structureNodes.size();
+        for (int j = 0; j < structureNodes.size(); j++) {
+            if (!isFinite(structureNodes[j])) {
+                degenerateProblems.push_back("node tagged '" + structureNodes[j].getTagStr() + "' is not finite");
+            }
+        }
+        const tgPairs& structurePairs = structures[i]->getPairs();
+        for (int j = 0; j < structurePairs.size(); j++) {
+            const tgPair& pair = structurePairs[j];
+            pairs.push_back(&pair);
+            const std::string description = describe(pair.getFrom(), pair.getTo(), pair.getTagStr());
+            if (unbuilt.count(&pair)) {
+                unbuiltProblems.push_back(description);
+            }
+            if (!isFinite(pair.getFrom()) || !isFinite(pair.getTo())) {
+                degenerateProblems.push_back(description + " is not finite");
+            }
+            else if (pair.getFrom() == pair.getTo()) {
+                degenerateProblems.push_back(description + " has zero length");
+            }
+        }
+    }
+
+    const std::vector<tgRigidInfo*> rigids = structureInfo.getAllRigids();
+    std::set<const tgRigidInfo*> bodies;
+    for (std::size_t i = 0; i < rigids.size(); i++) {
+        bodies.insert(rigids[i]->getRigidInfoGroup());
+    }
+    const std::vector<tgConnectorInfo*> connectors = structureInfo.getAllConnectors();
+    std::vector<std::string> unattachedProblems;
+    for (std::size_t i = 0; i < connectors.size(); i++) {
+        const tgConnectorInfo& connector = *connectors[i];
+        if (connector.getFromRigidInfo() == NULL || connector.getToRigidInfo() == NULL) {
+            unattachedProblems.push_back(describe(connector.getFrom(), connector.getTo(), connector.getTagStr()) +
+                (connector.getFromRigidInfo() == NULL ? " at its from end" : " at its to end"));
+        }
+    }
+
+    report << "Structure: " << topLvlStructurePath << std::endl
+           << "  structures: " << structures.size() << ", nodes: " << nodes << ", pairs: " << pairs.size() << std::endl
+           << "  rigids: " << rigids.size() << " in " << bodies.size() << " bodies, connectors: "
+           << connectors.size() << std::endl;
+    std::size_t problems = 0;
+    problems += reportProblems(report, "pairs that no builder matches", unbuiltProblems);
+    problems += reportProblems(report, "degenerate nodes or pairs", degenerateProblems);
+    problems += reportProblems(report, "connectors with no rigid", unattachedProblems);
+    if (problems == 0) {
+        report << "No problems found" << std::endl;
+    }
+    else {
+        report << "Problems found: " << problems << std::endl;
+    }
+
+    if (!wireframePath.empty()) {
+        writeWireframe(wireframePath, pairs, unbuilt);
+    }
+    return problems;
+}
+
+bool TensegrityModel::setParameterOverrides(const std::map<std::string, double>& overrides) {
+    bool applied = true;
+    // an override dropped from the map goes back to the YAML value, which needs a new setup
+    for (std::map<std::string, double>::const_iterator previous = parameterOverrides.begin();
+         previous != parameterOverrides.end(); ++previous) {
+        if (overrides.find(previous->first) == overrides.end()) applied = false;
+    }
+
+    for (std::map<std::string, double>::const_iterator entry = overrides.begin();
+         entry != overrides.end(); ++entry) {
+        const std::string& key = entry->first;
+        const std::string::size_type dot = key.rfind('.');
+        if (dot == std::string::npos || dot == 0 || dot + 1 == key.size()) {
+            throw std::invalid_argument("Parameter overrides must be named 'tag.parameter': " + key);
+        }
+        std::map<std::string, double>::const_iterator previous = parameterOverrides.find(key);
+        if (previous != parameterOverrides.end() && previous->second == entry->second) continue;
+
+        // stiffness and damping can change in the running cables, everything else is
+        // fixed by construction
+        const std::string parameterName = key.substr(dot + 1);
+        if (parameterName != "stiffness" && parameterName != "damping") {
+            applied = false;
+            continue;
+        }
+        const tgTagSearch search(key.substr(0, dot));
+        for (std::size_t i = 0; i < allActuators.size(); i++) {
+            if (!search.matches(*allActuators[i])) continue;
+            if (parameterName == "stiffness") {
+                allActuators[i]->setStiffness(entry->second);
+            }
+            else {
+                allActuators[i]->setDamping(entry->second);
+            }
         }
     }
 
-    // apply scale, offset and translation attributes to children
+    parameterOverrides = overrides;
+    return applied;
+}
+
+void TensegrityModel::setLoadThreads(std::size_t threads) {
+    loadThreads = threads;
+}
+
+void TensegrityModel::resolveStructure() {
+    if (resolvedStructure) return;
+
+    // builders are only applied here so that node_edge bonds see the ones registered so far,
+    // setup applies resolvedBuilders to its own spec
+    tgBuildSpec spec;
+    addDefaultBuilders(spec);
+    boost::shared_ptr<tgStructure> structure(new tgStructure());
+    loadStructure(*structure, spec);
+    resolvedBuilders.swap(builderHistory);
+    builderHistory.clear();
+    resolvedStructure = structure;
+}
+
+void TensegrityModel::addDefaultBuilders(tgBuildSpec& spec) {
+    // add default builders (rods, strings, boxes) that match the tags (rods, strings, boxes, spheres)
+    // (these will be overwritten if a different builder is specified for those tags)
+    Yam emptyYam = Yam();
+    addRodBuilder("tgRodInfo", "rod", emptyYam, spec);
+    addBasicActuatorBuilder("tgBasicActuatorInfo", "string", emptyYam, spec);
+    addBoxBuilder("tgBoxInfo", "box", emptyYam, spec);
+    addSphereBuilder("tgSphereInfo", "sphere", emptyYam, spec);
+}
+
+void TensegrityModel::loadStructure(tgStructure& structure, tgBuildSpec& spec) {
+    builderHistory.clear();
+
+    if (TensegrityModelFile::isCompiled(topLvlStructurePath)) {
+        // already resolved: only the builders need applying
+        std::vector<Yam> builders;
+        TensegrityModelFile::read(topLvlStructurePath, structure, builders);
+        for (std::size_t i = 0; i < builders.size(); ++i) {
+            recordBuilders(spec, builders[i]);
+        }
+        return;
+    }
+
+    // each structure file is parsed once per setup, however many children use it
+    structureDocuments.clear();
+    nodeEdgeBondCount = 0;
+    preloadStructureDocuments(topLvlStructurePath);
+    buildStructure(structure, topLvlStructurePath, spec);
+    structureDocuments.clear();
+}
+
+void TensegrityModel::addChildren(tgStructure& structure, const std::string& structurePath, tgBuildSpec& spec, const Yam& children) {
+    if (!children) return;
+    std::string structureAttributeKeys[] = {"path", "rotation", "translation", "scale", "offset"};
+    std::vector<std::string> structureAttributeKeysVector(structureAttributeKeys, structureAttributeKeys + sizeof(structureAttributeKeys) / sizeof(std::string));
+
+    // each child is added and then rotated, scaled, offset and translated in one pass;
+    // the attributes of one child never depend on its siblings
     for (YAML::const_iterator child = children.begin(); child != children.end(); ++child) {
         Yam childAttributes = child->second;
+        yamlContainsOnly(childAttributes, structurePath, structureAttributeKeysVector);
+        const Yam path = childAttributes["path"];
+        const Yam rotation = childAttributes["rotation"];
+        const Yam scale = childAttributes["scale"];
+        const Yam offset = childAttributes["offset"];
+        const Yam translation = childAttributes["translation"];
         // multiple children can be defined using the syntax: child1/child2/child3...
-        // (add a slash so that each child is a string with a its name and a slash at the end)
-        std::string childCombos = child->first.as<std::string>() + "/";
+        const std::string childCombos = child->first.as<std::string>();
+        std::string::size_type nameBegin = 0;
         int childComboIndex = 0;
-        while (childCombos.find("/") != std::string::npos) {
-            std::string childName = childCombos.substr(0, childCombos.find("/"));
-            tgStructure& childStructure = structure.findChild(childName);
-            addChildScale(childStructure, childAttributes["scale"]);
-            addChildOffset(childStructure, childComboIndex, childAttributes["offset"]);
-            addChildTranslation(childStructure, childAttributes["translation"]);
-            childCombos = childCombos.substr(childCombos.find("/") + 1);
+        while (nameBegin <= childCombos.size()) {
+            std::string::size_type nameEnd = childCombos.find('/', nameBegin);
+            if (nameEnd == std::string::npos) nameEnd = childCombos.size();
+            const std::string childName = childCombos.substr(nameBegin, nameEnd - nameBegin);
+            tgStructure* childStructure = addChild(structure, structurePath, childName, path, spec);
+            if (!childStructure) childStructure = &structure.findChild(childName);
+            addChildRotation(*childStructure, rotation);
+            addChildScale(*childStructure, scale);
+            addChildOffset(*childStructure, childComboIndex, offset);
+            addChildTranslation(*childStructure, translation);
+            nameBegin = nameEnd + 1;
             childComboIndex++;
         }
     }
 }
 
-void TensegrityModel::addChild(tgStructure& structure, const std::string &parentPath,
+tgStructure* TensegrityModel::addChild(tgStructure& structure, const std::string &parentPath,
     const std::string& childName, const Yam& childStructurePath, tgBuildSpec& spec) {
 
-    if (!childStructurePath) return;
-    std::string childPath = childStructurePath.as<std::string>();
+    if (!childStructurePath) return NULL;
     // if path is relative, use path relative to parent structure
-    if (childPath[0] != '/') {
-        childPath = parentPath.substr(0, parentPath.rfind("/") + 1) + childPath;
+    const std::string childPath = ::childStructurePath(parentPath, childStructurePath.as<std::string>());
+    StructureDocument& document = loadStructureDocument(childPath);
+    if (document.prototype) {
+        // seen before: re-apply its builders in the same order as a fresh build would
+        for (std::size_t i = document.buildersBegin; i < document.buildersEnd; ++i) {
+            const Yam builders = builderHistory[i];
+            recordBuilders(spec, builders);
+        }
+        return &structure.addChildInstance(document.prototype, tgTags(childName));
+    }
+
+    const std::size_t buildersBegin = builderHistory.size();
+    const std::size_t nodeEdgeBonds = nodeEdgeBondCount;
+    boost::shared_ptr<tgStructure> prototype(new tgStructure());
+    buildStructure(*prototype, childPath, spec);
+    tgStructure& childStructure = structure.addChildInstance(prototype, tgTags(childName));
+    if (nodeEdgeBondCount == nodeEdgeBonds) {
+        document.prototype = prototype;
+        document.buildersBegin = buildersBegin;
+        document.buildersEnd = builderHistory.size();
     }
-    tgStructure childStructure = tgStructure(childName);
-    buildStructure(childStructure, childPath, spec);
-    structure.addChild(childStructure);
+    return &childStructure;
 }
 
 void TensegrityModel::addChildRotation(tgStructure& childStructure, const Yam& rotation) {
@@ -234,40 +749,107 @@ void TensegrityModel::addChildTranslation(tgStructure& childStructure, const Yam
 }
 
 void TensegrityModel::buildStructure(tgStructure& structure, const std::string& structurePath, tgBuildSpec& spec) {
+    const Yam root = loadStructureDocument(structurePath).root;
+
+    addChildren(structure, structurePath, spec, root["substructures"]);
+    recordBuilders(spec, root["builders"]);
+    addNodes(structure, root["nodes"]);
+    addPairGroups(structure, root["pair_groups"]);
+    addBondGroups(structure, root["bond_groups"], spec);
+}
+
+TensegrityModel::StructureDocument& TensegrityModel::loadStructureDocument(const std::string& structurePath) {
+    const std::string key = canonicalPath(structurePath);
+    std::map<std::string, StructureDocument>::iterator cached = structureDocuments.find(key);
+    if (cached != structureDocuments.end()) {
+        return cached->second;
+    }
+
     /** 
-     * This call to YAML::LoadFile can return the exception YAML::BadFile 
-     * if any of the yaml files or substructure files cannot be found. 
+     * The file is read through tgAssetCache, once per process however
+     * many models load it. This throws std::runtime_error if any of the
+     * yaml files or substructure files cannot be found. 
      * Make this error more explicit through a try and catch.
      */
-    Yam root;
+    tgAssetCache::Handle file;
     try
     {
-      root = YAML::LoadFile(structurePath);
+      file = tgAssetCache::read(structurePath);
     }
-    catch( YAML::BadFile badfileexception )
+    catch( const std::runtime_error& )
     {
-      // If a BadFile exception is thrown, output a detailed message first:
-      std::cout << std::endl << "The YAML parser threw a BadFile exception when" <<
+      // If the file can't be read, output a detailed message first:
+      std::cout << std::endl << "The asset cache threw an exception when" <<
 	" trying to load one of your YAML files. " << std::endl <<
 	"The path of the structure that the parser attempted to load is: '" <<
 	structurePath << "'. " << std::endl <<
 	"Check to be sure that the file exists, and " <<
 	"that you didn't spell the path name incorrectly." <<
 	std::endl << std::endl;
-      // Then, throw the exception again, so that the program stops.
-      throw badfileexception;
+      // Then, throw the exception, so that the program stops.
+      throw;
     }
+    const Yam root = parseStructureDocument(file->str(), structurePath);
+
+    StructureDocument& document = structureDocuments[key];
+    document.root = root;
+    document.buildersBegin = 0;
+    document.buildersEnd = 0;
+    return document;
+}
+
+Yam TensegrityModel::parseStructureDocument(const std::string& text, const std::string& structurePath) const {
+    Yam root = YAML::Load(text);
     // Validate YAML
     std::string rootKeys[] = {"nodes", "pair_groups", "builders", "substructures", "bond_groups"};
     std::vector<std::string> rootKeysVector(rootKeys, rootKeys + sizeof(rootKeys) / sizeof(std::string));
     yamlContainsOnly(root, structurePath, rootKeysVector);
     yamlNoDuplicates(root, structurePath);
+    return root;
+}
 
-    addChildren(structure, structurePath, spec, root["substructures"]);
-    addBuilders(spec, root["builders"]);
-    addNodes(structure, root["nodes"]);
-    addPairGroups(structure, root["pair_groups"]);
-    addBondGroups(structure, root["bond_groups"], spec);
+void TensegrityModel::preloadStructureDocuments(const std::string& structurePath) {
+    const std::size_t threads = loadThreads > 0 ? loadThreads :
+        std::max(1u, boost::thread::hardware_concurrency());
+    std::set<std::string> seen;
+    seen.insert(canonicalPath(structurePath));
+    std::vector<std::string> level(1, structurePath);
+    while (!level.empty()) {
+        ParseTask task(*this, level);
+        if (threads > 1 && level.size() > 1) {
+            tgThreadPool pool(std::min(threads, level.size()));
+            pool.run(task, level.size());
+        }
+        else {
+            for (std::size_t i = 0; i < level.size(); i++) {
+                task(i);
+            }
+        }
+
+        // the next level is every file this one references that no level before did,
+        // in the order the build would reach them
+        std::vector<std::string> next;
+        for (std::size_t i = 0; i < level.size(); i++) {
+            if (!task.parsed(i)) continue;
+            StructureDocument& document = structureDocuments[canonicalPath(level[i])];
+            document.root = task.root(i);
+            document.buildersBegin = 0;
+            document.buildersEnd = 0;
+            const Yam& root = document.root;
+            const Yam children = root["substructures"];
+            if (!children || !children.IsMap()) continue;
+            for (YAML::const_iterator child = children.begin(); child != children.end(); ++child) {
+                if (!child->second.IsMap()) continue;
+                const Yam path = child->second["path"];
+                if (!path || !path.IsScalar()) continue;
+                const std::string childPath = childStructurePath(level[i], path.as<std::string>());
+                if (seen.insert(canonicalPath(childPath)).second) {
+                    next.push_back(childPath);
+                }
+            }
+        }
+        level.swap(next);
+    }
 }
 
 void TensegrityModel::addNodes(tgStructure& structure, const Yam& nodes) {
@@ -432,6 +1014,7 @@ void TensegrityModel::addNodeEdgePairs(tgStructure& structure, const std::string
     if (pairs.size() < 3) {
         throw std::invalid_argument("Error: node_edge bonds must specify at least 3 node_edge pairs");
     }
+    nodeEdgeBondCount++;
 
     tgStructure& childStructure1 = structure.findChild(*childStructure1Name);
     tgStructure& childStructure2 = structure.findChild(*childStructure2Name);
@@ -450,18 +1033,21 @@ void TensegrityModel::addNodeEdgePairs(tgStructure& structure, const std::string
     rotateAndTranslate(childStructure2, structure1RefNodes, structure2RefNodes);
 
     std::vector<tgBuildSpec::RigidAgent*> rigidAgents = spec.getRigidAgents();
+    // index both children once, after they have been moved into place
+    PairIndex childPairs1(childStructure1);
+    PairIndex childPairs2(childStructure2);
     for (unsigned int i = 0; i < ligands.size(); i++) {
 
         // remove old edge connections
         // try removing from both children since we are not sure which child the pair belongs to
         // (could add more information to receptors array so we don't have to do this)
-        removePair(childStructure1, receptors[i].first, receptors[i].second, true, rigidAgents, spec);
-        removePair(childStructure2, receptors[i].first, receptors[i].second, true, rigidAgents, spec);
+        removePair(childPairs1, receptors[i].first, receptors[i].second, true, rigidAgents, spec);
+        removePair(childPairs2, receptors[i].first, receptors[i].second, true, rigidAgents, spec);
         for (unsigned int j = 0; j < ligands.size(); j++) {
             // remove old string connections between nodes/ligands
             // try removing from both children since we are not sure which child the node belongs to
-            removePair(childStructure1, ligands[i], ligands[j], false, rigidAgents, spec);
-            removePair(childStructure2, ligands[i], ligands[j], false, rigidAgents, spec);
+            removePair(childPairs1, ligands[i], ligands[j], false, rigidAgents, spec);
+            removePair(childPairs2, ligands[i], ligands[j], false, rigidAgents, spec);
         }
         // make new connection from edge -> node -> edge
         structure.addPair(*(receptors[i].first), *ligands[i], tags);
@@ -548,15 +1134,11 @@ void TensegrityModel::rotateAndTranslate(tgStructure& childStructure2,
 }
 
 
-void TensegrityModel::removePair(tgStructure& structure, const tgNode* from, const tgNode* to, bool isEdgePair,
+void TensegrityModel::removePair(PairIndex& pairs, const tgNode* from, const tgNode* to, bool isEdgePair,
     const std::vector<tgBuildSpec::RigidAgent*>& rigidAgents, tgBuildSpec& spec) {
 
-    tgPair *pair;
-    try {
-        pair = &structure.findPair(*from, *to);
-    } catch (std::invalid_argument e) {
-        return;
-    }
+    const tgPair* pair = pairs.find(*from, *to);
+    if (!pair) return;
     for (int i = 0; i < rigidAgents.size(); i++) {
         tgTagSearch tagSearch = rigidAgents[i]->tagSearch;
         if (tagSearch.matches(*pair)) {
@@ -567,7 +1149,7 @@ void TensegrityModel::removePair(tgStructure& structure, const tgNode* from, con
             return;
         }
     }
-    structure.removePair(*pair);
+    pairs.remove(*pair);
 }
 
 tgNode& TensegrityModel::getNode(tgStructure& structure, const std::string& nodePath) {
@@ -596,6 +1178,12 @@ tgStructure& TensegrityModel::getStructure(tgStructure& parentStructure, const s
     }
 }
 
+void TensegrityModel::recordBuilders(tgBuildSpec& spec, const Yam& builders) {
+    if (!builders) return;
+    addBuilders(spec, builders);
+    builderHistory.push_back(builders);
+}
+
 void TensegrityModel::addBuilders(tgBuildSpec& spec, const Yam& builders) {
     for (YAML::const_iterator builder = builders.begin(); builder != builders.end(); ++builder) {
         std::string tagMatch = builder->first.as<std::string>();
@@ -622,9 +1210,48 @@ void TensegrityModel::addBuilders(tgBuildSpec& spec, const Yam& builders) {
         else {
             throw std::invalid_argument("Unsupported builder class: " + builderClass);
         }
+
+        // "self_collide: false" keeps the rigids matching the tag from
+        // colliding with each other
+        if (builder->second["self_collide"]) {
+            spec.setSelfCollision(tagMatch, builder->second["self_collide"].as<bool>());
+            if (generatedBuilders) {
+                *generatedBuilders += TensegrityModelGenerator::selfCollision(tagMatch,
+                    builder->second["self_collide"].as<bool>());
+            }
+        }
+    }
+}
+
+void TensegrityModel::overrideParameters(const std::string& builderClass, const std::string& tagMatch,
+    std::map<std::string, double>& doubles, std::map<std::string, bool>* booleans) {
+    const std::string prefix = tagMatch + ".";
+    for (std::map<std::string, double>::const_iterator entry = parameterOverrides.lower_bound(prefix);
+         entry != parameterOverrides.end() && entry->first.compare(0, prefix.size(), prefix) == 0;
+         ++entry) {
+        const std::string parameterName = entry->first.substr(prefix.size());
+        // belongs to a longer tag that starts with this one
+        if (parameterName.find('.') != std::string::npos) continue;
+        if (doubles.find(parameterName) != doubles.end()) {
+            doubles[parameterName] = entry->second;
+        }
+        else if (booleans && booleans->find(parameterName) != booleans->end()) {
+            (*booleans)[parameterName] = entry->second != 0.0;
+        }
+        else {
+            throw std::invalid_argument("Unsupported " + builderClass + " parameter override: " + entry->first);
+        }
     }
 }
 
+tgRod::Config::CollisionProxy TensegrityModel::rodCollisionProxy(const std::string& name) {
+    if (name == "cylinder") return tgRod::Config::cylinderProxy;
+    if (name == "capsule") return tgRod::Config::capsuleProxy;
+    if (name == "spheres") return tgRod::Config::spheresProxy;
+    if (name == "box") return tgRod::Config::boxProxy;
+    throw std::invalid_argument("Unsupported rod collision_proxy: " + name);
+}
+
 void TensegrityModel::addRodBuilder(const std::string& builderClass, const std::string& tagMatch, const Yam& parameters, tgBuildSpec& spec) {
     // rodParameters
     std::map<std::string, double> rp;
@@ -633,10 +1260,15 @@ void TensegrityModel::addRodBuilder(const std::string& builderClass, const std::
     rp["friction"] = rodFriction;
     rp["roll_friction"] = rodRollFriction;
     rp["restitution"] = rodRestitution;
+    tgRod::Config::CollisionProxy proxy = tgRod::Config::cylinderProxy;
 
     if (parameters) {
         for (YAML::const_iterator parameter = parameters.begin(); parameter != parameters.end(); ++parameter) {
             std::string parameterName = parameter->first.as<std::string>();
+            if (parameterName == "collision_proxy") {
+                proxy = rodCollisionProxy(parameter->second.as<std::string>());
+                continue;
+            }
             if (rp.find(parameterName) == rp.end()) {
                 throw std::invalid_argument("Unsupported " + builderClass + " parameter: " + parameterName);
             }
@@ -645,12 +1277,18 @@ void TensegrityModel::addRodBuilder(const std::string& builderClass, const std::
         }
     }
 
+    overrideParameters(builderClass, tagMatch, rp);
+
     const tgRod::Config rodConfig = tgRod::Config(rp["radius"], rp["density"], rp["friction"],
-        rp["roll_friction"], rp["restitution"]);
+        rp["roll_friction"], rp["restitution"], proxy);
     if (builderClass == "tgRodInfo") {
         // tgBuildSpec takes ownership of the tgRodInfo object
         spec.addBuilder(tagMatch, new tgRodInfo(rodConfig));
     }
+    if (generatedBuilders) {
+        *generatedBuilders += TensegrityModelGenerator::builder(builderClass, tagMatch,
+            TensegrityModelGenerator::config(rodConfig));
+    }
     // add more builders that use tgRod::Config here
 }
 
@@ -707,6 +1345,9 @@ void TensegrityModel::addBasicActuatorBuilder(const std::string& builderClass, c
         }
     }
 
+    // parameter overrides of this model take precedence over the YAML file
+    overrideParameters(builderClass, tagMatch, bap_doubles, &bap_booleans);
+
     // Create the config struct.
     // Note that this calls the constructor for Config, so the parameters
     // are passed in according to order not name.
@@ -732,6 +1373,10 @@ void TensegrityModel::addBasicActuatorBuilder(const std::string& builderClass, c
         // tgBuildSpec takes ownership of the tgBasicContactCableInfo object
         spec.addBuilder(tagMatch, new tgBasicContactCableInfo(basicActuatorConfig));
     }
+    if (generatedBuilders) {
+        *generatedBuilders += TensegrityModelGenerator::builder(builderClass, tagMatch,
+            TensegrityModelGenerator::config(basicActuatorConfig));
+    }
     // add more builders that use tgBasicActuator::Config here
 }
 
@@ -763,6 +1408,8 @@ void TensegrityModel::addKinematicActuatorBuilder(const std::string& builderClas
         }
     }
 
+    overrideParameters(builderClass, tagMatch, kap);
+
     const tgKinematicActuator::Config kinematicActuatorConfig =
         tgKinematicActuator::Config(kap["stiffness"], kap["damping"], kap["pretension"], kap["radius"],
         kap["motor_friction"], kap["motor_inertia"],  kap["back_drivable"], kap["history"], kap["max_tension"],
@@ -775,6 +1422,10 @@ void TensegrityModel::addKinematicActuatorBuilder(const std::string& builderClas
         // tgBuildSpec takes ownership of the tgKinematicActuatorInfo object
         spec.addBuilder(tagMatch, new tgKinematicActuatorInfo(kinematicActuatorConfig));
     }
+    if (generatedBuilders) {
+        *generatedBuilders += TensegrityModelGenerator::builder(builderClass, tagMatch,
+            TensegrityModelGenerator::config(kinematicActuatorConfig));
+    }
     // add more builders that use tgKinematicActuator::Config here
 }
 
@@ -785,8 +1436,8 @@ void TensegrityModel::addBoxBuilder(const std::string& builderClass, const std::
      * them to the defaults in TensegrityModel.h
      * (2) substitute these defaults with any parameters from the YAMl file
      * (3) create the tgBoxInfo object and add it to the list of builders
-     * @TO-DO: this seems to be called multiple times per "builder" block in a YAML file.
-     * That's probably not correct. Why?
+     * Every structure file that names a builder registers it again; tgBuildSpec
+     * drops the earlier registration, which the newer one shadows.
      */
 
     // (1)
@@ -814,6 +1465,8 @@ void TensegrityModel::addBoxBuilder(const std::string& builderClass, const std::
         }
     }
 
+    overrideParameters(builderClass, tagMatch, bp);
+
     // (3)
     // this usage is the same as in NTRT v1.0 models.
     const tgBox::Config boxConfig = tgBox::Config(bp["width"], bp["height"],
@@ -822,6 +1475,10 @@ void TensegrityModel::addBoxBuilder(const std::string& builderClass, const std::
         // tgBuildSpec takes ownership of the tgBoxInfo object
         spec.addBuilder(tagMatch, new tgBoxInfo(boxConfig));
     }
+    if (generatedBuilders) {
+        *generatedBuilders += TensegrityModelGenerator::builder(builderClass, tagMatch,
+            TensegrityModelGenerator::config(boxConfig));
+    }
 }
 
 void TensegrityModel::addSphereBuilder(const std::string& builderClass, const std::string& tagMatch, const Yam& parameters, tgBuildSpec& spec){
@@ -859,6 +1516,8 @@ void TensegrityModel::addSphereBuilder(const std::string& builderClass, const st
     }
   }
 
+  overrideParameters(builderClass, tagMatch, sp);
+
   // (3)
   // VALIDATION. We need the node locations to be the same.
   // Can't create a sphere in two different places.
@@ -875,10 +1534,14 @@ void TensegrityModel::addSphereBuilder(const std::string& builderClass, const st
     // tgBuildSpec takes ownership of the tgSphereInfo object
     spec.addBuilder(tagMatch, new tgSphereInfo(sphereConfig));
   }
+  if (generatedBuilders) {
+    *generatedBuilders += TensegrityModelGenerator::builder(builderClass, tagMatch,
+      TensegrityModelGenerator::config(sphereConfig));
+  }
   
 }
 
-void TensegrityModel::yamlNoDuplicates(const Yam& yam, const std::string structurePath) {
+void TensegrityModel::yamlNoDuplicates(const Yam& yam, const std::string structurePath) const {
     std::set<std::string> keys;
     for (YAML::const_iterator iter = yam.begin(); iter != yam.end(); ++iter) {
         Yam child = iter->second;
@@ -895,7 +1558,7 @@ void TensegrityModel::yamlNoDuplicates(const Yam& yam, const std::string structu
     }
 }
 
-void TensegrityModel::yamlContainsOnly(const Yam& yam, const std::string structurePath, const std::vector<std::string> keys) {
+void TensegrityModel::yamlContainsOnly(const Yam& yam, const std::string structurePath, const std::vector<std::string> keys) const {
     for (YAML::const_iterator key = yam.begin(); key != yam.end(); ++key) {
         std::string keyName = key->first.as<std::string>();
         if (std::find(keys.begin(), keys.end(), keyName) == keys.end()) {
@@ -925,4 +1588,5 @@ const std::vector<tgSpringCableActuator*>& TensegrityModel::getAllActuators() co
 void TensegrityModel::teardown() {
     notifyTeardown();
     tgModel::teardown();
+    allActuators.clear();
 }
@@ -28,17 +28,21 @@
  */
 
 // C++ Standard Library
+#include <cstddef>
+#include <iosfwd>
 #include <map>
 #include <string>
 #include <vector>
 // NTRT Core and tgCreator Libraries
 #include "core/tgModel.h"
+#include "core/tgRod.h"
 #include "core/tgSubject.h"
 #include "tgcreator/tgBuildSpec.h"
 #include "tgcreator/tgStructure.h"
 // Bullet Physics library
 #include "LinearMath/btVector3.h"
 // Helper libraries
+#include <boost/shared_ptr.hpp>
 #include <yaml-cpp/yaml.h>
 
 // Forward declarations
@@ -201,13 +205,13 @@ public:
     /**
      * The simplest constructor.
      * This constructor sets debugging_on = false.
-     * @param[in] structurePath the path of the YAML-encoded structure
+     * @param[in] structurePath the path of the YAML-encoded structure, or of a compiled model
      */
     TensegrityModel(const std::string& structurePath);
 
     /**
      * Constructor that takes 'debugging' as a parameter.
-     * @param[in] structurePath the path of the YAML-encoded structure
+     * @param[in] structurePath the path of the YAML-encoded structure, or of a compiled model
      * @param[in] debugging the flag that controls debugging output on/off.
      */
     TensegrityModel(const std::string& structurePath, bool debugging);
@@ -228,6 +232,66 @@ public:
      */
     virtual void setup(tgWorld& world);
 
+    /**
+     * Build the structure without a world and write it, fully resolved and
+     * with its builders, to a compiled model file. Constructing a
+     * TensegrityModel with that file's path then loads it without parsing
+     * any YAML.
+     * @param[in] compiledPath the file to write
+     */
+    void compile(const std::string& compiledPath);
+
+    /**
+     * Build the structure once in an empty world and write a C++ model of
+     * it, <className>.h and <className>.cpp, with the topology, builders
+     * and actuator count of this build fixed at compile time. Structures
+     * that never change between runs can then be built and stepped without
+     * YAML or tag lookups; see TensegrityModelGenerator.
+     * @param[in] className the name of the generated class
+     * @param[in] outputDir the directory to write the files to
+     */
+    void generate(const std::string& className, const std::string& outputDir);
+
+    /**
+     * Resolve the structure and its builders as setup would, without a world
+     * or any physics objects, and report what a build would make and the
+     * problems found: pairs that no builder makes anything of, pairs of zero
+     * length or with non-finite ends, and connectors with no rigid at an end.
+     * A large structure file can then be checked after each edit in a
+     * fraction of the time of a build. Errors in the YAML itself are thrown,
+     * as they are by setup.
+     * @param[out] report where the counts and problems are written
+     * @param[in] wireframePath if not empty, a Wavefront OBJ file to write the
+     * pairs to as lines, grouped by their tags, for any mesh viewer
+     * @return the number of problems
+     */
+    std::size_t preview(std::ostream& report, const std::string& wireframePath = "");
+
+    /**
+     * Override builder parameters of the YAML file, for example
+     * {"string.stiffness": 500, "rod.density": 0.2}. Each key is the tag of a
+     * builder and one of its parameters; builders registered for other tags
+     * are unaffected. The structure files are only read once, so later setups
+     * with new overrides rebuild from the resolved structure.
+     * Stiffness and damping are also changed in the actuators already built
+     * that match the tag. Every other parameter takes effect at the next setup.
+     * @param[in] overrides the overrides, replacing any set before
+     * @return true if the running model already reflects every override, false
+     * if it has to be reset for all of them to take effect
+     */
+    bool setParameterOverrides(const std::map<std::string, double>& overrides);
+
+    /**
+     * Set the number of threads that parse the structure files. The files a
+     * structure references are found level by level, and each level's new
+     * files are parsed at once before the structure is assembled in order,
+     * so the result does not depend on the threads.
+     * @param[in] threads the number of threads; 0, the default, uses one per
+     * core, and 1 parses on the calling thread, as a model built by a worker
+     * of a batch would
+     */
+    void setLoadThreads(std::size_t threads);
+
     /**
      * Undoes setup. Deletes child models. Called automatically on
      * reset and end of simulation. Notifies controllers of teardown
@@ -256,11 +320,92 @@ public:
     const std::vector<tgSpringCableActuator*>& getAllActuators() const;
 
 private:
+    /*
+     * The pairs under a structure, looked up by their endpoints.
+     */
+    class PairIndex;
+
+    /*
+     * Parses one level of the structure files found by preloadStructureDocuments.
+     */
+    class ParseTask;
+
     /**
      * A list of all of the spring cable actuators.
      */
     std::vector<tgSpringCableActuator*> allActuators;
 
+    /*
+     * A structure file parsed and validated during one call to setup, shared by
+     * every child that points to the same file.
+     */
+    struct StructureDocument {
+        Yam root;
+        // Built once and cloned for every further child, NULL until then
+        boost::shared_ptr<const tgStructure> prototype;
+        // The builders sections applied while building the prototype,
+        // as a range of builderHistory, replayed for each clone
+        std::size_t buildersBegin;
+        std::size_t buildersEnd;
+    };
+
+    /*
+     * Structure files loaded by the current build, keyed by canonical path.
+     */
+    std::map<std::string, StructureDocument> structureDocuments;
+
+    /*
+     * Every builders section applied to the spec by the current build, in order.
+     */
+    std::vector<Yam> builderHistory;
+
+    /*
+     * The top level structure with every child resolved, from the first setup or compile.
+     */
+    boost::shared_ptr<const tgStructure> resolvedStructure;
+
+    /*
+     * The builders sections applied while resolving the structure, in order.
+     */
+    std::vector<Yam> resolvedBuilders;
+
+    /*
+     * Builder parameter values taking precedence over the YAML file, keyed 'tag.parameter'.
+     */
+    std::map<std::string, double> parameterOverrides;
+
+    /*
+     * Number of node_edge bonds made by the current build. A prototype whose build
+     * made one is not reused, since those bonds depend on the builders registered so far.
+     */
+    std::size_t nodeEdgeBondCount;
+
+    /*
+     * See setLoadThreads.
+     */
+    std::size_t loadThreads = 0;
+
+    /*
+     * While generate() runs, receives the C++ statements adding each builder to a spec.
+     */
+    std::string* generatedBuilders = NULL;
+
+    /*
+     * Adds the builders used for the rod, string, box and sphere tags unless a structure file overrides them.
+     */
+    void addDefaultBuilders(tgBuildSpec& spec);
+
+    /*
+     * Builds the top level structure, from its YAML files or from a compiled model file, leaving the builders
+     * it applied in builderHistory.
+     */
+    void loadStructure(tgStructure& structure, tgBuildSpec& spec);
+
+    /*
+     * Fills resolvedStructure and resolvedBuilders, unless an earlier setup or compile already has.
+     */
+    void resolveStructure();
+
     /*
      * Responsible for adding all the children defined in a structure file, and apply their
      * rotation, scale, offset and translation attributes.
@@ -269,8 +414,9 @@ private:
 
     /*
      * Responsible for adding the child structure defined in the file childStructurePath.
+     * Returns the added child, or NULL if no path was given.
      */
-    void addChild(tgStructure& structure, const std::string& parentPath,
+    tgStructure* addChild(tgStructure& structure, const std::string& parentPath,
         const std::string& childName, const Yam& childStructurePath, tgBuildSpec& spec);
 
     /*
@@ -299,6 +445,25 @@ private:
      */
     void buildStructure(tgStructure& structure, const std::string& structurePath, tgBuildSpec& spec);
 
+    /*
+     * Returns the parsed and validated structure file at structurePath, loading it only the first
+     * time that file is seen during the current setup.
+     */
+    StructureDocument& loadStructureDocument(const std::string& structurePath);
+
+    /*
+     * Parses and validates the text of the structure file at structurePath. Only reads
+     * its arguments, so files can be parsed concurrently.
+     */
+    Yam parseStructureDocument(const std::string& text, const std::string& structurePath) const;
+
+    /*
+     * Loads every structure file that structurePath references, directly or through its
+     * substructures, into structureDocuments, parsing the files of each level of the graph
+     * in parallel. A file that can't be read or parsed is left for the build to report.
+     */
+    void preloadStructureDocuments(const std::string& structurePath);
+
     /*
      * Responsible for adding nodes to the structure.
      */
@@ -361,9 +526,10 @@ private:
         std::vector<btVector3>& structure1RefNodes, std::vector<btVector3>& structure2RefNodes);
 
     /*
-     * Responsible for removing a pair from a structure. Makes sure only pairs that are strings can be removed.
+     * Responsible for removing a pair from the structure indexed by pairs. Makes sure only pairs that are strings
+     * can be removed.
      */
-    void removePair(tgStructure& structure, const tgNode* from, const tgNode* to, bool isEdgePair,
+    void removePair(PairIndex& pairs, const tgNode* from, const tgNode* to, bool isEdgePair,
         const std::vector<tgBuildSpec::RigidAgent*>& rigidAgents, tgBuildSpec& spec);
 
     /*
@@ -381,6 +547,24 @@ private:
      */
     void addBuilders(tgBuildSpec& spec, const Yam& builders);
 
+    /*
+     * Adds the builders to the build spec and records them in builderHistory
+     */
+    void recordBuilders(tgBuildSpec& spec, const Yam& builders);
+
+    /*
+     * Replaces the builder parameters that parameterOverrides sets for tagMatch. Boolean parameters are true
+     * for any non-zero override.
+     */
+    void overrideParameters(const std::string& builderClass, const std::string& tagMatch,
+        std::map<std::string, double>& doubles, std::map<std::string, bool>* booleans = NULL);
+
+    /*
+     * Parses the collision_proxy parameter of a rod builder: cylinder,
+     * capsule, spheres or box
+     */
+    static tgRod::Config::CollisionProxy rodCollisionProxy(const std::string& name);
+
     /*
      * Responsible for adding a builder that uses the tgRod config
      */
@@ -409,12 +593,12 @@ private:
     /*
      * Ensures YAML node contains only keys from the supplied vector
      */
-    void yamlContainsOnly(const Yam& yam, const std::string structurePath, const std::vector<std::string> keys);
+    void yamlContainsOnly(const Yam& yam, const std::string structurePath, const std::vector<std::string> keys) const;
 
     /*
      * Ensures that YAML has all unique keys within each map
      */
-    void yamlNoDuplicates(const Yam& yam, const std::string structurePath);
+    void yamlNoDuplicates(const Yam& yam, const std::string structurePath) const;
 
     /**
      * Output debugging information for this model and structure.
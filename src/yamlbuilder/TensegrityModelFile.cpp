@@ -0,0 +1,271 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file TensegrityModelFile.cpp
+ * @brief Contains the definition of the members of the class TensegrityModelFile.
+ * $Id$
+ */
+
+#include "TensegrityModelFile.h"
+// C++ Standard Library
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <stdint.h>
+// NTRT Core Library
+#include "core/tgAssetCache.h"
+// NTRT tgCreator Library
+#include "tgcreator/tgNode.h"
+#include "tgcreator/tgNodes.h"
+#include "tgcreator/tgPair.h"
+#include "tgcreator/tgPairs.h"
+#include "tgcreator/tgStructure.h"
+
+namespace
+{
+    /*
+     * Layout, all integers uint32_t and all coordinates double:
+     *   magic, version
+     *   builders: section count, then per section an entry count and per
+     *     entry tag, class, parameter count and name/value strings
+     *   structure: tags, node count, nodes (x y z tags), pair count,
+     *     pairs (from xyz, to xyz, tags), child count, children
+     * A string is its length followed by its characters.
+     */
+    const char magic[8] = {'N', 'T', 'R', 'T', 'M', 'D', 'L', '\0'};
+    const uint32_t version = 1;
+
+    void writeUInt(std::ofstream& out, uint32_t value)
+    {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void writeDouble(std::ofstream& out, double value)
+    {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void writeString(std::ofstream& out, const std::string& value)
+    {
+        writeUInt(out, value.size());
+        out.write(value.data(), value.size());
+    }
+
+    void writeVector(std::ofstream& out, const btVector3& value)
+    {
+        writeDouble(out, value.x());
+        writeDouble(out, value.y());
+        writeDouble(out, value.z());
+    }
+
+    void writeStructure(std::ofstream& out, const tgStructure& structure)
+    {
+        writeString(out, structure.getTagStr());
+
+        const tgNodes& nodes = structure.getNodes();
+        writeUInt(out, nodes.size());
+        for (int i = 0; i < nodes.size(); i++) {
+            writeVector(out, nodes[i]);
+            writeString(out, nodes[i].getTagStr());
+        }
+
+        const tgPairs& pairs = structure.getPairs();
+        writeUInt(out, pairs.size());
+        for (int i = 0; i < pairs.size(); i++) {
+            writeVector(out, pairs[i].getFrom());
+            writeVector(out, pairs[i].getTo());
+            writeString(out, pairs[i].getTagStr());
+        }
+
+        const std::vector<tgStructure*>& children = structure.getChildren();
+        writeUInt(out, children.size());
+        for (std::size_t i = 0; i < children.size(); i++) {
+            writeStructure(out, *children[i]);
+        }
+    }
+
+    /** Reads values in order from a range, throwing if it runs out */
+    class Reader
+    {
+    public:
+        Reader(const char* begin, const char* end, const std::string& path) :
+            m_position(begin), m_end(end), m_path(path)
+        {
+        }
+
+        void bytes(void* destination, std::size_t count)
+        {
+            if (static_cast<std::size_t>(m_end - m_position) < count) {
+                throw std::runtime_error("Truncated compiled model: " + m_path);
+            }
+            std::memcpy(destination, m_position, count);
+            m_position += count;
+        }
+
+        uint32_t readUInt()
+        {
+            uint32_t value;
+            bytes(&value, sizeof(value));
+            return value;
+        }
+
+        double readDouble()
+        {
+            double value;
+            bytes(&value, sizeof(value));
+            return value;
+        }
+
+        std::string readString()
+        {
+            const uint32_t size = readUInt();
+            if (static_cast<std::size_t>(m_end - m_position) < size) {
+                throw std::runtime_error("Truncated compiled model: " + m_path);
+            }
+            const std::string value(m_position, size);
+            m_position += size;
+            return value;
+        }
+
+        btVector3 readVector()
+        {
+            const double x = readDouble();
+            const double y = readDouble();
+            const double z = readDouble();
+            return btVector3(x, y, z);
+        }
+
+    private:
+        const char* m_position;
+        const char* const m_end;
+        const std::string& m_path;
+    };
+
+    void readContents(Reader& in, tgStructure& structure)
+    {
+        const uint32_t nodeCount = in.readUInt();
+        for (uint32_t i = 0; i < nodeCount; i++) {
+            const btVector3 position = in.readVector();
+            structure.addNode(position.x(), position.y(), position.z(), in.readString());
+        }
+
+        const uint32_t pairCount = in.readUInt();
+        for (uint32_t i = 0; i < pairCount; i++) {
+            const btVector3 from = in.readVector();
+            const btVector3 to = in.readVector();
+            structure.addPair(from, to, in.readString());
+        }
+
+        const uint32_t childCount = in.readUInt();
+        for (uint32_t i = 0; i < childCount; i++) {
+            tgStructure* const child = new tgStructure(in.readString());
+            try {
+                readContents(in, *child);
+            }
+            catch (...) {
+                delete child;
+                throw;
+            }
+            structure.addChild(child);
+        }
+    }
+}
+
+bool TensegrityModelFile::isCompiled(const std::string& path)
+{
+    std::ifstream in(path.c_str(), std::ios::in | std::ios::binary);
+    char header[sizeof(magic)];
+    return in.read(header, sizeof(header)) &&
+        std::memcmp(header, magic, sizeof(magic)) == 0;
+}
+
+void TensegrityModelFile::write(const std::string& path, const tgStructure& structure,
+                                const std::vector<YAML::Node>& builders)
+{
+    // Written aside and renamed over, since the file may be mapped
+    const std::string temporary = path + ".tmp";
+    std::ofstream out(temporary.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Can't write compiled model: " + path);
+    }
+    out.write(magic, sizeof(magic));
+    writeUInt(out, version);
+
+    writeUInt(out, builders.size());
+    for (std::size_t i = 0; i < builders.size(); i++) {
+        writeUInt(out, builders[i].size());
+        for (YAML::const_iterator builder = builders[i].begin(); builder != builders[i].end(); ++builder) {
+            writeString(out, builder->first.as<std::string>());
+            writeString(out, builder->second["class"].as<std::string>());
+            const YAML::Node parameters = builder->second["parameters"];
+            writeUInt(out, parameters ? parameters.size() : 0);
+            if (!parameters) continue;
+            for (YAML::const_iterator parameter = parameters.begin(); parameter != parameters.end(); ++parameter) {
+                writeString(out, parameter->first.as<std::string>());
+                writeString(out, parameter->second.as<std::string>());
+            }
+        }
+    }
+
+    writeStructure(out, structure);
+    out.close();
+    if (!out || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("Can't write compiled model: " + path);
+    }
+}
+
+void TensegrityModelFile::read(const std::string& path, tgStructure& structure,
+                               std::vector<YAML::Node>& builders)
+{
+    const tgAssetCache::Handle file = tgAssetCache::map(path);
+    Reader in(file->data(), file->data() + file->size(), path);
+
+    char header[sizeof(magic)];
+    in.bytes(header, sizeof(header));
+    if (std::memcmp(header, magic, sizeof(magic)) != 0 || in.readUInt() != version) {
+        throw std::runtime_error("Not a compiled model of this version: " + path);
+    }
+
+    const uint32_t sectionCount = in.readUInt();
+    for (uint32_t i = 0; i < sectionCount; i++) {
+        YAML::Node section(YAML::NodeType::Map);
+        const uint32_t builderCount = in.readUInt();
+        for (uint32_t j = 0; j < builderCount; j++) {
+            const std::string tagMatch = in.readString();
+            YAML::Node builder(YAML::NodeType::Map);
+            builder["class"] = in.readString();
+            const uint32_t parameterCount = in.readUInt();
+            if (parameterCount > 0) {
+                YAML::Node parameters(YAML::NodeType::Map);
+                for (uint32_t k = 0; k < parameterCount; k++) {
+                    const std::string name = in.readString();
+                    parameters[name] = in.readString();
+                }
+                builder["parameters"] = parameters;
+            }
+            section[tagMatch] = builder;
+        }
+        builders.push_back(section);
+    }
+
+    structure.addTags(in.readString());
+    readContents(in, structure);
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TENSEGRITY_MODEL_FILE_H
+#define TENSEGRITY_MODEL_FILE_H
+
+/**
+ * @file TensegrityModelFile.h
+ * @brief Contains the definition of class TensegrityModelFile.
+ * $Id$
+ */
+
+// C++ Standard Library
+#include <string>
+#include <vector>
+// Helper libraries
+#include <yaml-cpp/yaml.h>
+
+// Forward declarations
+class tgStructure;
+
+/**
+ * Reads and writes compiled tensegrity models: the fully resolved
+ * tgStructure that TensegrityModel builds from a YAML structure file,
+ * together with every builders section applied along the way, in order.
+ * Loading a compiled model skips YAML parsing, validation, substructure
+ * files and all child transforms.
+ *
+ * The file holds native doubles and integers, so it is only meant to be
+ * read on the kind of machine that wrote it.
+ */
+class TensegrityModelFile
+{
+public:
+
+    /**
+     * True if the file at path starts like a compiled model.
+     * @param[in] path the file to check
+     */
+    static bool isCompiled(const std::string& path);
+
+    /**
+     * Write a compiled model.
+     * @param[in] path the file to write
+     * @param[in] structure the resolved structure
+     * @param[in] builders the builders sections to apply, in order
+     */
+    static void write(const std::string& path, const tgStructure& structure,
+                      const std::vector<YAML::Node>& builders);
+
+    /**
+     * Read a compiled model, mapping the file rather than streaming it.
+     * Throws std::runtime_error if the file can't be read or is malformed.
+     * @param[in] path the file to read
+     * @param[out] structure an empty structure to fill in
+     * @param[out] builders receives the builders sections, in order
+     */
+    static void read(const std::string& path, tgStructure& structure,
+                     std::vector<YAML::Node>& builders);
+};
+
+#endif
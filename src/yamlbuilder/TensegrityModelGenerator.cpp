@@ -0,0 +1,494 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+/**
+ * @file TensegrityModelGenerator.cpp
+ * @brief Contains the definition of the members of the class TensegrityModelGenerator.
+ * $Id$
+ */
+
+#include "TensegrityModelGenerator.h"
+// C++ Standard Library
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+// NTRT tgCreator Library
+#include "tgcreator/tgNode.h"
+#include "tgcreator/tgNodes.h"
+#include "tgcreator/tgPair.h"
+#include "tgcreator/tgPairs.h"
+#include "tgcreator/tgStructure.h"
+
+namespace
+{
+    /** The structures of a tree in pre-order, each after its parent */
+    struct Flattened
+    {
+        struct Structure
+        {
+            std::string tags;
+            int parent;
+            std::size_t firstNode;
+            std::size_t nodes;
+            std::size_t firstPair;
+            std::size_t pairs;
+        };
+
+        std::vector<Structure> structures;
+        std::ostringstream nodes;
+        std::ostringstream pairs;
+        std::size_t nodeCount;
+        std::size_t pairCount;
+
+        explicit Flattened(const tgStructure& root) : nodeCount(0), pairCount(0)
+        {
+            add(root, -1);
+        }
+
+        void add(const tgStructure& structure, int parent)
+        {
+            Structure entry;
+            entry.tags = structure.getTagStr();
+            entry.parent = parent;
+            const int index = structures.size();
+
+            const tgNodes& n = structure.getNodes();
+            entry.firstNode = nodeCount;
+            entry.nodes = n.size();
+            for (int i = 0; i < n.size(); i++) {
+                nodes << "        { " << TensegrityModelGenerator::literal(n[i].x()) << ", "
+                      << TensegrityModelGenerator::literal(n[i].y()) << ", "
+                      << TensegrityModelGenerator::literal(n[i].z()) << ", "
+                      << TensegrityModelGenerator::literal(n[i].getTagStr()) << " },\n";
+            }
+            nodeCount += n.size();
+
+            const tgPairs& p = structure.getPairs();
+            entry.firstPair = pairCount;
+            entry.pairs = p.size();
+            for (int i = 0; i < p.size(); i++) {
+                const btVector3& from = p[i].getFrom();
+                const btVector3& to = p[i].getTo();
+                pairs << "        { { " << TensegrityModelGenerator::literal(from.x()) << ", "
+                      << TensegrityModelGenerator::literal(from.y()) << ", "
+                      << TensegrityModelGenerator::literal(from.z()) << " }, { "
+                      << TensegrityModelGenerator::literal(to.x()) << ", "
+                      << TensegrityModelGenerator::literal(to.y()) << ", "
+                      << TensegrityModelGenerator::literal(to.z()) << " }, "
+                      << TensegrityModelGenerator::literal(p[i].getTagStr()) << " },\n";
+            }
+            pairCount += p.size();
+            structures.push_back(entry);
+
+            const std::vector<tgStructure*>& children = structure.getChildren();
+            for (std::size_t i = 0; i < children.size(); i++) {
+                add(*children[i], index);
+            }
+        }
+    };
+
+    std::string boolean(bool value)
+    {
+        return value ? "true" : "false";
+    }
+
+    /** At least one, since C++ has no arrays of none */
+    std::size_t extent(std::size_t count)
+    {
+        return count > 0 ? count : 1;
+    }
+
+    void open(std::ofstream& out, const std::string& path)
+    {
+        out.open(path.c_str(), std::ios::out | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Can't write generated model: " + path);
+        }
+    }
+
+    void writeHeader(const TensegrityModelGenerator::Model& model, const Flattened& flat,
+                     const std::string& path)
+    {
+        const std::string& name = model.className;
+        std::string guard;
+        for (std::size_t i = 0; i < name.size(); i++) {
+            guard += std::toupper(static_cast<unsigned char>(name[i]));
+        }
+        guard += "_GENERATED_H";
+        const std::size_t actuators = model.actuatorTags.size();
+
+        std::ofstream out;
+        open(out, path);
+        out << "// Generated from " << model.structurePath << " by BuildModel --generate.\n"
+            << "// Do not edit; regenerate it when the structure changes.\n\n"
+            << "#ifndef " << guard << "\n"
+            << "#define " << guard << "\n\n"
+            << "/**\n"
+            << " * @file " << name << ".h\n"
+            << " * @brief Contains the definition of class " << name << ", generated from a YAML structure.\n"
+            << " */\n\n"
+            << "// NTRT Core Library\n"
+            << "#include \"core/tgModel.h\"\n"
+            << "#include \"core/tgSubject.h\"\n"
+            << "// C++ Standard Library\n"
+            << "#include <cstddef>\n\n"
+            << "// Forward declarations\n"
+            << "class tgBuildSpec;\n"
+            << "class tgSpringCableActuator;\n"
+            << "class tgStructure;\n"
+            << "class tgWorld;\n\n"
+            << "/**\n"
+            << " * The structure of " << model.structurePath << " as TensegrityModel\n"
+            << " * builds it, with its topology fixed when it was generated. step()\n"
+            << " * steps the actuators from a fixed array, as long as every other\n"
+            << " * descendant is a rigid or a plain tgModel with nothing to step.\n"
+            << " */\n"
+            << "class " << name << " : public tgSubject<" << name << ">, public tgModel\n"
+            << "{\n"
+            << "public:\n\n"
+            << "    static constexpr std::size_t structureCount = " << flat.structures.size() << ";\n"
+            << "    static constexpr std::size_t nodeCount = " << flat.nodeCount << ";\n"
+            << "    static constexpr std::size_t pairCount = " << flat.pairCount << ";\n"
+            << "    static constexpr std::size_t rigidCount = " << model.rigidCount << ";\n"
+            << "    static constexpr std::size_t actuatorCount = " << actuators << ";\n\n";
+        if (actuators > 0) {
+            out << "    /** The tags of each actuator, in the order of getActuator() */\n"
+                << "    static constexpr const char* actuatorTags[actuatorCount] = {\n";
+            for (std::size_t i = 0; i < actuators; i++) {
+                out << "        " << TensegrityModelGenerator::literal(model.actuatorTags[i])
+                    << (i + 1 < actuators ? ",\n" : "\n");
+            }
+            out << "    };\n\n";
+        }
+        out << "    " << name << "();\n\n"
+            << "    virtual ~" << name << "();\n\n"
+            << "    /**\n"
+            << "     * Build the structure into the world, and notify controllers.\n"
+            << "     * Throws std::logic_error if it doesn't build the actuators it\n"
+            << "     * was generated with.\n"
+            << "     */\n"
+            << "    virtual void setup(tgWorld& world);\n\n"
+            << "    virtual void teardown();\n\n"
+            << "    virtual void step(double dt);\n\n"
+            << "    /** One of the actuators, between setup and teardown */\n"
+            << "    tgSpringCableActuator& getActuator(std::size_t i) const\n"
+            << "    {\n"
+            << "        return *m_actuators[i];\n"
+            << "    }\n\n"
+            << "    /** Add the resolved structure to an empty one */\n"
+            << "    static void buildStructure(tgStructure& structure);\n\n"
+            << "    /** Add the builders, in the order TensegrityModel adds them */\n"
+            << "    static void addBuilders(tgBuildSpec& spec);\n\n"
+            << "private:\n\n"
+            << "    tgSpringCableActuator* m_actuators[" << extent(actuators) << "];\n\n"
+            << "    /** The number of descendants built, while step() can go flat */\n"
+            << "    std::size_t m_descendants;\n\n"
+            << "    /** True if only the actuators have anything to step */\n"
+            << "    bool m_flat;\n"
+            << "};\n\n"
+            << "#endif\n";
+        if (!out) {
+            throw std::runtime_error("Can't write generated model: " + path);
+        }
+    }
+
+    void writeSource(const TensegrityModelGenerator::Model& model, const Flattened& flat,
+                     const std::string& path)
+    {
+        const std::string& name = model.className;
+        const std::size_t actuators = model.actuatorTags.size();
+
+        std::ofstream out;
+        open(out, path);
+        out << "// Generated from " << model.structurePath << " by BuildModel --generate.\n"
+            << "// Do not edit; regenerate it when the structure changes.\n\n"
+            << "/**\n"
+            << " * @file " << name << ".cpp\n"
+            << " * @brief Contains the definition of the members of the class " << name << ".\n"
+            << " */\n\n"
+            << "#include \"" << name << ".h\"\n"
+            << "// NTRT Core and tgCreator Libraries\n"
+            << "#include \"core/tgBaseRigid.h\"\n"
+            << "#include \"core/tgBasicActuator.h\"\n"
+            << "#include \"core/tgBox.h\"\n"
+            << "#include \"core/tgCast.h\"\n"
+            << "#include \"core/tgKinematicActuator.h\"\n"
+            << "#include \"core/tgRod.h\"\n"
+            << "#include \"core/tgSphere.h\"\n"
+            << "#include \"tgcreator/tgBasicActuatorInfo.h\"\n"
+            << "#include \"tgcreator/tgBasicContactCableInfo.h\"\n"
+            << "#include \"tgcreator/tgBoxInfo.h\"\n"
+            << "#include \"tgcreator/tgBuildSpec.h\"\n"
+            << "#include \"tgcreator/tgKinematicActuatorInfo.h\"\n"
+            << "#include \"tgcreator/tgKinematicContactCableInfo.h\"\n"
+            << "#include \"tgcreator/tgRodInfo.h\"\n"
+            << "#include \"tgcreator/tgSphereInfo.h\"\n"
+            << "#include \"tgcreator/tgStructure.h\"\n"
+            << "#include \"tgcreator/tgStructureInfo.h\"\n"
+            << "// C++ Standard Library\n"
+            << "#include <stdexcept>\n"
+            << "#include <typeinfo>\n"
+            << "#include <vector>\n\n"
+            << "namespace\n"
+            << "{\n"
+            << "    /** A structure of the tree, after its parent, and its nodes and pairs */\n"
+            << "    struct Structure\n"
+            << "    {\n"
+            << "        const char* tags;\n"
+            << "        int parent;\n"
+            << "        std::size_t firstNode;\n"
+            << "        std::size_t nodes;\n"
+            << "        std::size_t firstPair;\n"
+            << "        std::size_t pairs;\n"
+            << "    };\n\n"
+            << "    struct Node\n"
+            << "    {\n"
+            << "        double x;\n"
+            << "        double y;\n"
+            << "        double z;\n"
+            << "        const char* tags;\n"
+            << "    };\n\n"
+            << "    struct Pair\n"
+            << "    {\n"
+            << "        double from[3];\n"
+            << "        double to[3];\n"
+            << "        const char* tags;\n"
+            << "    };\n\n"
+            << "    constexpr Structure structures[" << name << "::structureCount] = {\n";
+        for (std::size_t i = 0; i < flat.structures.size(); i++) {
+            const Flattened::Structure& s = flat.structures[i];
+            out << "        { " << TensegrityModelGenerator::literal(s.tags) << ", " << s.parent << ", "
+                << s.firstNode << ", " << s.nodes << ", " << s.firstPair << ", " << s.pairs << " },\n";
+        }
+        out << "    };\n\n"
+            << "    constexpr Node nodes[" << extent(flat.nodeCount) << "] = {\n"
+            << flat.nodes.str()
+            << "    };\n\n"
+            << "    constexpr Pair pairs[" << extent(flat.pairCount) << "] = {\n"
+            << flat.pairs.str()
+            << "    };\n"
+            << "}\n\n";
+        if (actuators > 0) {
+            out << "constexpr const char* " << name << "::actuatorTags[];\n\n";
+        }
+        out << name << "::" << name << "() :\n"
+            << "m_descendants(0),\n"
+            << "m_flat(false)\n"
+            << "{\n"
+            << "    for (std::size_t i = 0; i < sizeof(m_actuators) / sizeof(m_actuators[0]); i++) {\n"
+            << "        m_actuators[i] = NULL;\n"
+            << "    }\n"
+            << "}\n\n"
+            << name << "::~" << name << "()\n"
+            << "{\n"
+            << "}\n\n"
+            << "void " << name << "::buildStructure(tgStructure& structure)\n"
+            << "{\n"
+            << "    std::vector<tgStructure*> built(structureCount, &structure);\n"
+            << "    structure.addTags(structures[0].tags);\n"
+            << "    for (std::size_t s = 0; s < structureCount; s++) {\n"
+            << "        if (s > 0) {\n"
+            << "            built[s] = new tgStructure(structures[s].tags);\n"
+            << "            built[structures[s].parent]->addChild(built[s]);\n"
+            << "        }\n"
+            << "        for (std::size_t i = structures[s].firstNode; i < structures[s].firstNode + structures[s].nodes; i++) {\n"
+            << "            built[s]->addNode(nodes[i].x, nodes[i].y, nodes[i].z, nodes[i].tags);\n"
+            << "        }\n"
+            << "        for (std::size_t i = structures[s].firstPair; i < structures[s].firstPair + structures[s].pairs; i++) {\n"
+            << "            built[s]->addPair(btVector3(pairs[i].from[0], pairs[i].from[1], pairs[i].from[2]),\n"
+            << "                              btVector3(pairs[i].to[0], pairs[i].to[1], pairs[i].to[2]), pairs[i].tags);\n"
+            << "        }\n"
+            << "    }\n"
+            << "}\n\n"
+            << "void " << name << "::addBuilders(tgBuildSpec& spec)\n"
+            << "{\n"
+            << model.builders
+            << "}\n\n"
+            << "void " << name << "::setup(tgWorld& world)\n"
+            << "{\n"
+            << "    tgStructure structure;\n"
+            << "    buildStructure(structure);\n"
+            << "    tgBuildSpec spec;\n"
+            << "    addBuilders(spec);\n"
+            << "    tgStructureInfo structureInfo(structure, spec);\n"
+            << "    structureInfo.buildInto(*this, world);\n\n"
+            << "    const std::vector<tgSpringCableActuator*> actuators =\n"
+            << "        tgCast::filter<tgModel, tgSpringCableActuator>(getDescendants());\n"
+            << "    if (actuators.size() != actuatorCount) {\n"
+            << "        throw std::logic_error(\"" << name << " built a different set of actuators than it was generated with\");\n"
+            << "    }\n"
+            << "    for (std::size_t i = 0; i < actuatorCount; i++) {\n"
+            << "        m_actuators[i] = actuators[i];\n"
+            << "    }\n\n"
+            << "    // The actuators are in the order tgModel::step() steps them\n"
+            << "    const std::vector<tgModel*>& descendants = getDescendants();\n"
+            << "    m_flat = true;\n"
+            << "    for (std::size_t i = 0; i < descendants.size(); i++) {\n"
+            << "        tgModel* const pDescendant = descendants[i];\n"
+            << "        if (typeid(*pDescendant) != typeid(tgModel) &&\n"
+            << "            !tgCast::cast<tgModel, tgBaseRigid>(pDescendant) &&\n"
+            << "            !tgCast::cast<tgModel, tgSpringCableActuator>(pDescendant)) {\n"
+            << "            m_flat = false;\n"
+            << "        }\n"
+            << "    }\n"
+            << "    m_descendants = descendants.size();\n\n"
+            << "    notifySetup();\n"
+            << "    tgModel::setup(world);\n"
+            << "}\n\n"
+            << "void " << name << "::teardown()\n"
+            << "{\n"
+            << "    notifyTeardown();\n"
+            << "    tgModel::teardown();\n"
+            << "    m_flat = false;\n"
+            << "    m_descendants = 0;\n"
+            << "    for (std::size_t i = 0; i < sizeof(m_actuators) / sizeof(m_actuators[0]); i++) {\n"
+            << "        m_actuators[i] = NULL;\n"
+            << "    }\n"
+            << "}\n\n"
+            << "void " << name << "::step(double dt)\n"
+            << "{\n"
+            << "    if (dt <= 0.0) {\n"
+            << "        throw std::invalid_argument(\"time step is not positive\");\n"
+            << "    }\n"
+            << "    notifyStep(dt);\n"
+            << "    // A child added since setup may have something to step\n"
+            << "    if (m_flat && getDescendants().size() == m_descendants) {\n"
+            << "        for (std::size_t i = 0; i < actuatorCount; i++) {\n"
+            << "            m_actuators[i]->step(dt);\n"
+            << "        }\n"
+            << "    }\n"
+            << "    else {\n"
+            << "        tgModel::step(dt);\n"
+            << "    }\n"
+            << "}\n";
+        if (!out) {
+            throw std::runtime_error("Can't write generated model: " + path);
+        }
+    }
+}
+
+void TensegrityModelGenerator::write(const Model& model, const std::string& outputDir)
+{
+    const std::string& name = model.className;
+    bool identifier = !name.empty() && !std::isdigit(static_cast<unsigned char>(name[0]));
+    for (std::size_t i = 0; i < name.size(); i++) {
+        identifier = identifier && (std::isalnum(static_cast<unsigned char>(name[i])) || name[i] == '_');
+    }
+    if (!identifier) {
+        throw std::invalid_argument("Generated model name is not a C++ identifier: " + name);
+    }
+
+    const Flattened flat(*model.structure);
+    const std::string prefix = outputDir.empty() ? name : outputDir + "/" + name;
+    writeHeader(model, flat, prefix + ".h");
+    writeSource(model, flat, prefix + ".cpp");
+}
+
+std::string TensegrityModelGenerator::builder(const std::string& builderClass,
+                                              const std::string& tagMatch,
+                                              const std::string& config)
+{
+    return "    spec.addBuilder(" + literal(tagMatch) + ",\n        new " + builderClass +
+        "(" + config + "));\n";
+}
+
+std::string TensegrityModelGenerator::selfCollision(const std::string& tagMatch, bool enabled)
+{
+    return "    spec.setSelfCollision(" + literal(tagMatch) + ", " + boolean(enabled) + ");\n";
+}
+
+std::string TensegrityModelGenerator::config(const tgRod::Config& config)
+{
+    static const char* const proxies[] = {
+        "tgRod::Config::cylinderProxy", "tgRod::Config::capsuleProxy",
+        "tgRod::Config::spheresProxy", "tgRod::Config::boxProxy"
+    };
+    return "tgRod::Config(" + literal(config.radius) + ", " + literal(config.density) + ", " +
+        literal(config.friction) + ", " + literal(config.rollFriction) + ", " +
+        literal(config.restitution) + ", " + proxies[config.collisionProxy] + ")";
+}
+
+std::string TensegrityModelGenerator::config(const tgBox::Config& config)
+{
+    return "tgBox::Config(" + literal(config.width) + ", " + literal(config.height) + ", " +
+        literal(config.density) + ", " + literal(config.friction) + ", " +
+        literal(config.rollFriction) + ", " + literal(config.restitution) + ")";
+}
+
+std::string TensegrityModelGenerator::config(const tgSphere::Config& config)
+{
+    return "tgSphere::Config(" + literal(config.radius) + ", " + literal(config.density) + ", " +
+        literal(config.friction) + ", " + literal(config.rollFriction) + ", " +
+        literal(config.restitution) + ")";
+}
+
+std::string TensegrityModelGenerator::config(const tgSpringCableActuator::Config& config)
+{
+    return "tgBasicActuator::Config(" + literal(config.stiffness) + ", " + literal(config.damping) + ", " +
+        literal(config.pretension) + ", " + boolean(config.hist) + ", " + literal(config.maxTens) + ", " +
+        literal(config.targetVelocity) + ", " + literal(config.minActualLength) + ", " +
+        literal(config.minRestLength) + ", " + literal(config.rotation) + ", " +
+        boolean(config.moveCablePointAToEdge) + ", " + boolean(config.moveCablePointBToEdge) + ")";
+}
+
+std::string TensegrityModelGenerator::config(const tgKinematicActuator::Config& config)
+{
+    return "tgKinematicActuator::Config(" + literal(config.stiffness) + ", " + literal(config.damping) + ", " +
+        literal(config.pretension) + ", " + literal(config.radius) + ", " +
+        literal(config.motorFriction) + ", " + literal(config.motorInertia) + ", " +
+        boolean(config.backdrivable) + ", " + boolean(config.hist) + ", " + literal(config.maxTens) + ", " +
+        literal(config.targetVelocity) + ", " + literal(config.minActualLength) + ", " +
+        literal(config.minRestLength) + ", " + literal(config.rotation) + ")";
+}
+
+std::string TensegrityModelGenerator::literal(double value)
+{
+    // The fewest digits that read back as the same double; 17 always do
+    char buffer[32];
+    for (int digits = 15; digits <= 17; digits++) {
+        std::snprintf(buffer, sizeof(buffer), "%.*g", digits, value);
+        if (std::strtod(buffer, NULL) == value) break;
+    }
+    std::string result(buffer);
+    if (result.find_first_of(".eEn") == std::string::npos) {
+        result += ".0";
+    }
+    return result;
+}
+
+std::string TensegrityModelGenerator::literal(const std::string& value)
+{
+    std::string result = "\"";
+    for (std::size_t i = 0; i < value.size(); i++) {
+        const char c = value[i];
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        }
+        else if (c == '\n') {
+            result += "\\n";
+        }
+        else {
+            result += c;
+        }
+    }
+    return result + "\"";
+}
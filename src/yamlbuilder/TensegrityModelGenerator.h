@@ -0,0 +1,110 @@
+/*
+ * Copyright © 2012, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * All rights reserved.
+ *
+ * The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+ * under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * http://www.apache.org/licenses/LICENSE-2.0.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+*/
+
+#ifndef TENSEGRITY_MODEL_GENERATOR_H
+#define TENSEGRITY_MODEL_GENERATOR_H
+
+/**
+ * @file TensegrityModelGenerator.h
+ * @brief Contains the definition of class TensegrityModelGenerator.
+ * $Id$
+ */
+
+// C++ Standard Library
+#include <cstddef>
+#include <string>
+#include <vector>
+// NTRT Core Library
+#include "core/tgBox.h"
+#include "core/tgKinematicActuator.h"
+#include "core/tgRod.h"
+#include "core/tgSphere.h"
+#include "core/tgSpringCableActuator.h"
+
+// Forward declarations
+class tgStructure;
+
+/**
+ * Writes a C++ model for a structure whose topology never changes: the
+ * fully resolved tgStructure that TensegrityModel builds from a YAML
+ * structure file, as constexpr tables, and its builders as the calls
+ * that add them to a tgBuildSpec. The generated class builds exactly
+ * what TensegrityModel would, without YAML, files or tag lookups, knows
+ * its node, pair, rigid and actuator counts at compile time, and steps
+ * its actuators from a fixed array instead of walking its tree of
+ * children. See TensegrityModel::generate() and add_generated_model()
+ * in this directory's CMakeLists.txt.
+ */
+class TensegrityModelGenerator
+{
+public:
+
+    /** Everything the generated class is made from */
+    struct Model
+    {
+        /** The name of the class, a C++ identifier */
+        std::string className;
+
+        /** The structure file, mentioned in the generated comments */
+        std::string structurePath;
+
+        /** The resolved structure */
+        const tgStructure* structure;
+
+        /** Statements adding the builders to a tgBuildSpec named spec */
+        std::string builders;
+
+        /** The tags of each actuator, in the order of getDescendants() */
+        std::vector<std::string> actuatorTags;
+
+        /** The number of rigid bodies built */
+        std::size_t rigidCount;
+    };
+
+    /**
+     * Write <className>.h and <className>.cpp.
+     * Throws std::invalid_argument if the class name is not an identifier,
+     * std::runtime_error if a file can't be written.
+     * @param[in] model what to generate
+     * @param[in] outputDir the directory to write to
+     */
+    static void write(const Model& model, const std::string& outputDir);
+
+    /** A statement adding a builder of class builderClass for tagMatch */
+    static std::string builder(const std::string& builderClass,
+                               const std::string& tagMatch,
+                               const std::string& config);
+
+    /** A statement letting or stopping tagMatch's rigids collide */
+    static std::string selfCollision(const std::string& tagMatch, bool enabled);
+
+    /** Constructor calls rebuilding each config exactly */
+    static std::string config(const tgRod::Config& config);
+    static std::string config(const tgBox::Config& config);
+    static std::string config(const tgSphere::Config& config);
+    static std::string config(const tgSpringCableActuator::Config& config);
+    static std::string config(const tgKinematicActuator::Config& config);
+
+    /** A C++ literal reading back as value, bit for bit */
+    static std::string literal(double value);
+
+    /** A C++ string literal */
+    static std::string literal(const std::string& value);
+};
+
+#endif
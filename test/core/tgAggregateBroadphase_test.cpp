@@ -0,0 +1,166 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgAggregateBroadphase_test.cpp
+* @brief Contains a test of the two level broadphase against all pairs
+* $Id$
+*/
+
+// This application
+#include "core/tgAggregateBroadphase.h"
+// The Bullet Physics library
+#include "LinearMath/btAabbUtil2.h"
+// Google Test
+#include "gtest/gtest.h"
+// The C++ Standard Library
+#include <algorithm>
+#include <cstdlib>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace {
+
+	typedef std::pair<const void*, const void*> Pair;
+
+	double uniform(double lower, double upper) {
+		return lower + (upper - lower) * (std::rand() / (double) RAND_MAX);
+	}
+
+	Pair ordered(const void* a, const void* b) {
+		return a < b ? Pair(a, b) : Pair(b, a);
+	}
+
+	/** Robots of several boxes each, and loose boxes, moving at random */
+	class tgAggregateBroadphaseTest : public ::testing::Test {
+		protected:
+			tgAggregateBroadphaseTest() : loose(0) {
+				std::srand(7);
+				for (int robot = 0; robot < 8; robot++) {
+					// The last two are made outside a scope, one box each
+					const tgAggregateBroadphase::Scope scope(robot < 6 ? &keys[robot] : NULL);
+					const double x = robot * uniform(0.0, 10.0);
+					const int n = 1 + std::rand() % 12;
+					for (int i = 0; i < n; i++) {
+						const btVector3 center(x + uniform(-2.0, 2.0), uniform(0.0, 3.0), uniform(-2.0, 2.0));
+						const btVector3 half(uniform(0.1, 1.0), uniform(0.1, 1.0), uniform(0.1, 1.0));
+						proxies.push_back(broadphase.createProxy(center - half, center + half, 0, NULL,
+																 btBroadphaseProxy::DefaultFilter,
+																 btBroadphaseProxy::AllFilter, NULL, NULL));
+						halves.push_back(half);
+					}
+					if (robot >= 6) {
+						loose += n;
+					}
+				}
+			}
+
+			~tgAggregateBroadphaseTest() {
+				for (std::size_t i = 0; i < proxies.size(); i++) {
+					broadphase.destroyProxy(proxies[i], NULL);
+				}
+			}
+
+			void move() {
+				for (std::size_t i = 0; i < proxies.size(); i++) {
+					const btVector3 center = (proxies[i]->m_aabbMin + proxies[i]->m_aabbMax) * 0.5 +
+						btVector3(uniform(-0.3, 0.3), uniform(-0.3, 0.3), uniform(-0.3, 0.3));
+					broadphase.setAabb(proxies[i], center - halves[i], center + halves[i], NULL);
+				}
+			}
+
+			std::set<Pair> cached() {
+				std::set<Pair> result;
+				btBroadphasePairArray& pairs = broadphase.getOverlappingPairCache()->getOverlappingPairArray();
+				for (int i = 0; i < pairs.size(); i++) {
+					result.insert(ordered(pairs[i].m_pProxy0, pairs[i].m_pProxy1));
+				}
+				return result;
+			}
+
+			std::set<Pair> allPairs() {
+				std::set<Pair> result;
+				for (std::size_t i = 0; i < proxies.size(); i++) {
+					for (std::size_t j = i + 1; j < proxies.size(); j++) {
+						if (TestAabbAgainstAabb2(proxies[i]->m_aabbMin, proxies[i]->m_aabbMax,
+												 proxies[j]->m_aabbMin, proxies[j]->m_aabbMax)) {
+							result.insert(ordered(proxies[i], proxies[j]));
+						}
+					}
+				}
+				return result;
+			}
+
+			int keys[6];
+			std::size_t loose;
+			tgAggregateBroadphase broadphase;
+			std::vector<btBroadphaseProxy*> proxies;
+			std::vector<btVector3> halves;
+	};
+
+	TEST_F(tgAggregateBroadphaseTest, OneAggregatePerScope) {
+		EXPECT_EQ(6 + loose, broadphase.getNumAggregates());
+	}
+
+	TEST_F(tgAggregateBroadphaseTest, FindsEveryPairAsTheBoxesMove) {
+		for (int step = 0; step < 40; step++) {
+			move();
+			if (step % 7 == 3) {
+				// Destroying proxies also empties and removes aggregates
+				const std::size_t i = std::rand() % proxies.size();
+				broadphase.destroyProxy(proxies[i], NULL);
+				proxies.erase(proxies.begin() + i);
+				halves.erase(halves.begin() + i);
+			}
+			broadphase.calculateOverlappingPairs(NULL);
+			EXPECT_EQ(allPairs(), cached()) << "step " << step;
+		}
+	}
+
+	TEST_F(tgAggregateBroadphaseTest, DistantRobotsAreNotTested) {
+		tgAggregateBroadphase apart;
+		std::vector<btBroadphaseProxy*> mine;
+		for (int robot = 0; robot < 2; robot++) {
+			const tgAggregateBroadphase::Scope scope(&keys[robot]);
+			for (int i = 0; i < 10; i++) {
+				// A row of touching boxes, the robots 100 apart
+				const btVector3 center(100.0 * robot + i, 0.0, 0.0);
+				const btVector3 half(0.6, 0.5, 0.5);
+				mine.push_back(apart.createProxy(center - half, center + half, 0, NULL,
+												 btBroadphaseProxy::DefaultFilter,
+												 btBroadphaseProxy::AllFilter, NULL, NULL));
+			}
+		}
+		apart.calculateOverlappingPairs(NULL);
+		EXPECT_EQ(2u, apart.getNumAggregates());
+		// Neighbours only, within each robot
+		EXPECT_EQ(18, apart.getOverlappingPairCache()->getNumOverlappingPairs());
+		EXPECT_EQ(18u, apart.getNumTests());
+		for (std::size_t i = 0; i < mine.size(); i++) {
+			apart.destroyProxy(mine[i], NULL);
+		}
+		EXPECT_EQ(0u, apart.getNumAggregates());
+	}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,106 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgAssetCache_test.cpp
+* @brief Contains a test of the shared read-only asset cache
+* $Id$
+*/
+
+// This application
+#include "core/tgAssetCache.h"
+// Google Test
+#include "gtest/gtest.h"
+// The C++ Standard Library
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+// POSIX
+#include <unistd.h>
+
+namespace {
+
+	void writeFile(const std::string& path, const std::string& contents) {
+		const std::string temporary = path + ".tmp";
+		std::ofstream out(temporary.c_str(), std::ios::binary);
+		out << contents;
+		out.close();
+		std::rename(temporary.c_str(), path.c_str());
+	}
+
+	class tgAssetCacheTest : public ::testing::Test {
+	protected:
+		virtual void SetUp() {
+			tgAssetCache::clear();
+			path = "tgAssetCache_test.txt";
+			writeFile(path, "first");
+		}
+
+		virtual void TearDown() {
+			std::remove(path.c_str());
+			tgAssetCache::clear();
+		}
+
+		std::string path;
+	};
+
+	TEST_F(tgAssetCacheTest, testLoadsOnce) {
+		const tgAssetCache::Handle a = tgAssetCache::read(path);
+		const tgAssetCache::Handle b = tgAssetCache::read(path);
+		EXPECT_EQ(a.get(), b.get());
+		EXPECT_EQ("first", a->str());
+		EXPECT_FALSE(a->isMapped());
+		EXPECT_EQ(1u, tgAssetCache::size());
+	}
+
+	TEST_F(tgAssetCacheTest, testMapsApartFromReads) {
+		const tgAssetCache::Handle read = tgAssetCache::read(path);
+		const tgAssetCache::Handle mapped = tgAssetCache::map(path);
+		EXPECT_NE(read.get(), mapped.get());
+		EXPECT_TRUE(mapped->isMapped());
+		EXPECT_EQ(std::string("first"), std::string(mapped->data(), mapped->size()));
+		EXPECT_EQ(mapped.get(), tgAssetCache::map(path).get());
+	}
+
+	TEST_F(tgAssetCacheTest, testReloadsReplacedFile) {
+		const tgAssetCache::Handle old = tgAssetCache::map(path);
+		writeFile(path, "second, longer");
+		const tgAssetCache::Handle replaced = tgAssetCache::map(path);
+		EXPECT_NE(old.get(), replaced.get());
+		EXPECT_EQ("second, longer", replaced->str());
+		// The old contents stay valid while held
+		EXPECT_EQ("first", old->str());
+	}
+
+	TEST_F(tgAssetCacheTest, testEmptyAndMissingFiles) {
+		writeFile(path, "");
+		const tgAssetCache::Handle empty = tgAssetCache::map(path);
+		EXPECT_EQ(0u, empty->size());
+		EXPECT_FALSE(empty->isMapped());
+
+		EXPECT_THROW(tgAssetCache::read("tgAssetCache_test_missing.txt"), std::runtime_error);
+		EXPECT_THROW(tgAssetCache::map("tgAssetCache_test_missing.txt"), std::runtime_error);
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
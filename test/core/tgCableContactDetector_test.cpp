@@ -0,0 +1,114 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgCableContactDetector_test.cpp
+* @brief Contains a test of the segment distance of tgCableContactDetector
+* $Id$
+*/
+
+// This application
+#include "core/tgCableContactDetector.h"
+// Google Test
+#include "gtest/gtest.h"
+// The C++ Standard Library
+#include <cstdlib>
+#include <stdexcept>
+
+namespace {
+
+	double uniform(double lower, double upper) {
+		return lower + (upper - lower) * (std::rand() / (double) RAND_MAX);
+	}
+
+	btVector3 randomPoint() {
+		return btVector3(uniform(-1.0, 1.0), uniform(-1.0, 1.0), uniform(-1.0, 1.0));
+	}
+
+	TEST(tgCableContactDetectorTest, CrossingSegments) {
+		double s = -1.0;
+		double t = -1.0;
+		const double d = tgCableContactDetector::closestPoints(
+			btVector3(-1.0, 0.0, 0.0), btVector3(1.0, 0.0, 0.0),
+			btVector3(0.0, -1.0, 0.5), btVector3(0.0, 3.0, 0.5), s, t);
+		EXPECT_DOUBLE_EQ(0.5, d);
+		EXPECT_DOUBLE_EQ(0.5, s);
+		EXPECT_DOUBLE_EQ(0.25, t);
+	}
+
+	TEST(tgCableContactDetectorTest, ParallelAndDegenerateSegments) {
+		double s = -1.0;
+		double t = -1.0;
+		// Parallel, overlapping along x
+		EXPECT_DOUBLE_EQ(2.0, tgCableContactDetector::closestPoints(
+			btVector3(0.0, 0.0, 0.0), btVector3(2.0, 0.0, 0.0),
+			btVector3(1.0, 2.0, 0.0), btVector3(3.0, 2.0, 0.0), s, t));
+		EXPECT_LE(0.0, s);
+		EXPECT_GE(1.0, t);
+		// Two points
+		EXPECT_DOUBLE_EQ(5.0, tgCableContactDetector::closestPoints(
+			btVector3(0.0, 0.0, 0.0), btVector3(0.0, 0.0, 0.0),
+			btVector3(3.0, 4.0, 0.0), btVector3(3.0, 4.0, 0.0), s, t));
+		// A point and a segment
+		EXPECT_DOUBLE_EQ(1.0, tgCableContactDetector::closestPoints(
+			btVector3(0.5, 1.0, 0.0), btVector3(0.5, 1.0, 0.0),
+			btVector3(0.0, 0.0, 0.0), btVector3(1.0, 0.0, 0.0), s, t));
+		EXPECT_DOUBLE_EQ(0.5, t);
+	}
+
+	/** No sampled pair of points is nearer than the nearest points */
+	TEST(tgCableContactDetectorTest, NearestOfSamples) {
+		std::srand(11);
+		for (int trial = 0; trial < 200; trial++) {
+			const btVector3 p1 = randomPoint();
+			const btVector3 q1 = randomPoint();
+			const btVector3 p2 = randomPoint();
+			const btVector3 q2 = randomPoint();
+			double s = -1.0;
+			double t = -1.0;
+			const double d = tgCableContactDetector::closestPoints(p1, q1, p2, q2, s, t);
+			ASSERT_LE(0.0, s);
+			ASSERT_GE(1.0, s);
+			ASSERT_LE(0.0, t);
+			ASSERT_GE(1.0, t);
+			EXPECT_NEAR(d, (p1.lerp(q1, s) - p2.lerp(q2, t)).length(), 1e-9);
+			for (int i = 0; i <= 20; i++) {
+				for (int j = 0; j <= 20; j++) {
+					const double sample =
+						(p1.lerp(q1, i / 20.0) - p2.lerp(q2, j / 20.0)).length();
+					ASSERT_LE(d, sample + 1e-9);
+				}
+			}
+		}
+	}
+
+	TEST(tgCableContactDetectorTest, Config) {
+		EXPECT_THROW(tgCableContactDetector::Config(0.0), std::invalid_argument);
+		EXPECT_THROW(tgCableContactDetector::Config(0.1, -1.0), std::invalid_argument);
+		EXPECT_THROW(tgCableContactDetector::Config(0.1, 1.0, -1.0), std::invalid_argument);
+		const tgCableContactDetector detector;
+		EXPECT_EQ(0u, detector.size());
+		EXPECT_TRUE(detector.getContacts().empty());
+	}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,168 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgCompressedSeries_test.cpp
+* @brief Contains a test of tgCompressedSeries: exact round trips,
+* compression of smooth histories and trimming by whole chunks
+* $Id$
+*/
+
+// This application
+#include "core/tgCompressedSeries.h"
+// The C++ Standard Library
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	bool sameBits(double a, double b)
+	{
+		return std::memcmp(&a, &b, sizeof(a)) == 0;
+	}
+
+	TEST(tgCompressedSeriesTest, RoundTripIsExact) {
+		std::vector<double> values;
+		values.push_back(0.0);
+		values.push_back(-0.0);
+		values.push_back(std::numeric_limits<double>::quiet_NaN());
+		values.push_back(std::numeric_limits<double>::infinity());
+		values.push_back(-std::numeric_limits<double>::denorm_min());
+		values.push_back(1.0);
+		values.push_back(1.0);
+		unsigned int state = 12345;
+		for (int i = 0; i < 5000; i++) {
+			state = state * 1103515245u + 12345u;
+			values.push_back(std::sin(i * 0.01) * 100.0 + (state >> 16) * 1e-9);
+		}
+
+		tgCompressedSeries series(100);
+		for (std::size_t i = 0; i < values.size(); i++) {
+			series.push_back(values[i]);
+		}
+		ASSERT_EQ(values.size(), series.size());
+		EXPECT_TRUE(sameBits(values.back(), series.back()));
+
+		std::deque<double> decoded;
+		series.decode(decoded);
+		ASSERT_EQ(values.size(), decoded.size());
+		for (std::size_t i = 0; i < values.size(); i++) {
+			EXPECT_TRUE(sameBits(values[i], decoded[i])) << "at " << i;
+		}
+		for (std::size_t i = 0; i < values.size(); i += 37) {
+			EXPECT_TRUE(sameBits(values[i], series.at(i))) << "at " << i;
+		}
+		EXPECT_THROW(series.at(values.size()), std::out_of_range);
+	}
+
+	TEST(tgCompressedSeriesTest, SmoothHistoriesAreSmall) {
+		// A rest length that is held, as a damping always is, then moves
+		const std::size_t n = 100000;
+		tgCompressedSeries held;
+		tgCompressedSeries moving;
+		for (std::size_t i = 0; i < n; i++) {
+			held.push_back(i < n / 2 ? 12.5 : 10.0);
+			moving.push_back(12.5 + std::sin(i * 0.001));
+		}
+		EXPECT_LT(held.bytes() * 20, n * sizeof(double));
+
+		std::vector<double> decoded;
+		moving.decode(decoded);
+		ASSERT_EQ(n, decoded.size());
+		EXPECT_EQ(12.5, decoded[0]);
+		EXPECT_EQ(12.5 + std::sin((n - 1) * 0.001), decoded[n - 1]);
+	}
+
+	TEST(tgCompressedSeriesTest, FewerMantissaBitsCompressMore) {
+		EXPECT_THROW(tgCompressedSeries(16, 0), std::invalid_argument);
+		EXPECT_THROW(tgCompressedSeries(16, 53), std::invalid_argument);
+
+		const std::size_t n = 100000;
+		tgCompressedSeries series(tgCompressedSeries::defaultChunkSize, 20);
+		for (std::size_t i = 0; i < n; i++) {
+			series.push_back(12.5 + std::sin(i * 0.001));
+		}
+		EXPECT_LT(series.bytes() * 5, n * sizeof(double));
+
+		std::vector<double> decoded;
+		series.decode(decoded);
+		ASSERT_EQ(n, decoded.size());
+		for (std::size_t i = 0; i < n; i += 101) {
+			const double value = 12.5 + std::sin(i * 0.001);
+			EXPECT_LE(decoded[i], value);
+			EXPECT_LT(value - decoded[i], value * 1e-6);
+		}
+
+		// Velocities cross zero, and contacts jump
+		tgCompressedSeries velocity(64, 20);
+		std::vector<double> values;
+		for (int i = 0; i < 1000; i++) {
+			values.push_back(std::cos(i * 0.01) * (i % 250 == 0 ? 1e6 : 1.0));
+			velocity.push_back(values.back());
+		}
+		std::vector<double> read;
+		velocity.decode(read);
+		ASSERT_EQ(values.size(), read.size());
+		for (std::size_t i = 0; i < values.size(); i++) {
+			EXPECT_LE(std::fabs(read[i]), std::fabs(values[i])) << "at " << i;
+			EXPECT_LE(std::fabs(values[i] - read[i]),
+				std::fabs(values[i]) * 1e-6) << "at " << i;
+		}
+
+		// Infinities and NaNs are kept
+		series.push_back(std::numeric_limits<double>::infinity());
+		EXPECT_EQ(std::numeric_limits<double>::infinity(), series.back());
+		series.push_back(std::numeric_limits<double>::quiet_NaN());
+		EXPECT_TRUE(std::isnan(series.at(n + 1)));
+	}
+
+	TEST(tgCompressedSeriesTest, TrimDropsWholeChunks) {
+		EXPECT_THROW(tgCompressedSeries(0), std::invalid_argument);
+
+		tgCompressedSeries series(10);
+		for (int i = 0; i < 95; i++) {
+			series.push_back(i);
+			series.trim(30);
+		}
+		// Between the capacity and one chunk more, the latest kept
+		EXPECT_GE(series.size(), 30u);
+		EXPECT_LT(series.size(), 40u);
+		std::vector<double> decoded;
+		series.decode(decoded);
+		EXPECT_EQ(94.0, decoded.back());
+		EXPECT_EQ(95.0 - series.size(), decoded.front());
+
+		series.clear();
+		EXPECT_TRUE(series.empty());
+		EXPECT_THROW(series.back(), std::out_of_range);
+		series.push_back(2.0);
+		EXPECT_EQ(2.0, series.at(0));
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,104 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgCpuTopology_test.cpp
+* @brief Contains a test of tgCpuTopology: CPU lists and the placement
+* of workers over nodes
+* $Id$
+*/
+
+// This application
+#include "core/tgCpuTopology.h"
+#include "core/tgThreadPool.h"
+// The C++ Standard Library
+#include <stdexcept>
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	std::vector<int> range(int first, int last)
+	{
+		std::vector<int> cpus;
+		for (int cpu = first; cpu <= last; cpu++) {
+			cpus.push_back(cpu);
+		}
+		return cpus;
+	}
+
+	TEST(tgCpuTopologyTest, ParsesLists) {
+		EXPECT_EQ(range(0, 0), tgCpuTopology::parseList("0"));
+		EXPECT_EQ(range(0, 3), tgCpuTopology::parseList("0-3"));
+
+		std::vector<int> expected = range(0, 1);
+		expected.push_back(8);
+		expected.push_back(10);
+		expected.push_back(11);
+		EXPECT_EQ(expected, tgCpuTopology::parseList("0-1,8,10-11"));
+
+		EXPECT_THROW(tgCpuTopology::parseList(""), std::invalid_argument);
+		EXPECT_THROW(tgCpuTopology::parseList("3-1"), std::invalid_argument);
+		EXPECT_THROW(tgCpuTopology::parseList("0-"), std::invalid_argument);
+		EXPECT_THROW(tgCpuTopology::parseList("a"), std::invalid_argument);
+	}
+
+	TEST(tgCpuTopologyTest, SpreadsWorkersOverNodes) {
+		std::vector<std::vector<int> > nodes;
+		nodes.push_back(range(0, 3));
+		// A node of memory alone
+		nodes.push_back(std::vector<int>());
+		nodes.push_back(range(4, 7));
+		const tgCpuTopology topology(nodes);
+
+		EXPECT_EQ(2u, topology.nodes());
+		EXPECT_EQ(8u, topology.size());
+		EXPECT_EQ(0u, topology.nodeOf(0));
+		EXPECT_EQ(1u, topology.nodeOf(1));
+		EXPECT_EQ(0, topology.cpuOf(0));
+		EXPECT_EQ(4, topology.cpuOf(1));
+		EXPECT_EQ(1, topology.cpuOf(2));
+		EXPECT_EQ(7, topology.cpuOf(7));
+		// More workers than CPUs share them
+		EXPECT_EQ(0, topology.cpuOf(8));
+		EXPECT_THROW(topology.cpus(2), std::out_of_range);
+
+		EXPECT_THROW(tgCpuTopology(std::vector<std::vector<int> >(2)),
+					 std::invalid_argument);
+	}
+
+	TEST(tgCpuTopologyTest, ReadsThisMachine) {
+		const tgCpuTopology topology;
+		ASSERT_GT(topology.nodes(), 0u);
+		for (std::size_t node = 0; node < topology.nodes(); node++) {
+			EXPECT_FALSE(topology.cpus(node).empty());
+		}
+
+		const tgThreadPool pool(2, true);
+		EXPECT_TRUE(pool.isPinned());
+		EXPECT_EQ(topology.nodeOf(1), pool.getNode(1));
+		EXPECT_EQ(1u, pool.getWorker(3));
+	}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,119 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgMemoryReport_test.cpp
+* @brief Contains a test of the categories of tgMemoryReport and of the
+* observers it reaches through a model tree
+* $Id$
+*/
+
+// This application
+#include "core/tgMemoryReport.h"
+#include "core/tgModel.h"
+#include "core/tgObserver.h"
+#include "core/tgSubject.h"
+// The C++ Standard Library
+#include <deque>
+#include <sstream>
+#include <string>
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	class Robot : public tgModel, public tgSubject<Robot> {
+	};
+
+	class Controller : public tgObserver<Robot> {
+		public:
+			Controller(std::size_t bytes) : m_bytes(bytes) {}
+
+			virtual void onStep(Robot& subject, double dt) {}
+
+			virtual void onReportMemory(const Robot& subject,
+										tgMemoryReport& report) const
+			{
+				report.add(tgMemoryReport::eControllers, m_bytes);
+			}
+
+		private:
+			std::size_t m_bytes;
+	};
+
+	TEST(tgMemoryReportTest, AddAndSum) {
+		tgMemoryReport report;
+		EXPECT_EQ(0u, report.getTotal());
+
+		report.add(tgMemoryReport::eShapes, 100, 2);
+		report.add(tgMemoryReport::eSensors, 30);
+		EXPECT_EQ(100u, report.getBytes(tgMemoryReport::eShapes));
+		EXPECT_EQ(2u, report.getCount(tgMemoryReport::eShapes));
+		EXPECT_EQ(130u, report.getTotal());
+
+		tgMemoryReport other;
+		other.add(tgMemoryReport::eShapes, 50);
+		report += other;
+		EXPECT_EQ(150u, report.getBytes(tgMemoryReport::eShapes));
+		EXPECT_EQ(3u, report.getCount(tgMemoryReport::eShapes));
+		EXPECT_EQ(0u, report.getArenaBytes());
+
+		std::ostringstream os;
+		report.writeJSON(os);
+		EXPECT_NE(std::string::npos, os.str().find("\"total\": 180"));
+		EXPECT_NE(std::string::npos,
+				  os.str().find("\"shapes\": {\"bytes\": 150, \"count\": 3}"));
+		EXPECT_NE(std::string::npos, os.str().find("\"controllers\""));
+	}
+
+	TEST(tgMemoryReportTest, ContainerBytes) {
+		std::vector<double> v;
+		v.reserve(10);
+		EXPECT_EQ(10 * sizeof(double), tgMemoryReport::bytes(v));
+
+		// A node of 64 doubles, even when empty
+		std::deque<double> d;
+		EXPECT_EQ(512u, tgMemoryReport::bytes(d));
+		d.resize(64);
+		EXPECT_EQ(1024u, tgMemoryReport::bytes(d));
+	}
+
+	TEST(tgMemoryReportTest, ReachesTheObserversOfDescendants) {
+		tgModel root;
+		Robot* const pRobot = new Robot();
+		root.addChild(pRobot);
+
+		Controller first(100);
+		Controller second(20);
+		pRobot->attach(&first);
+		pRobot->attach(&second);
+
+		tgMemoryReport report;
+		report.addModel(root);
+		EXPECT_EQ(120u, report.getBytes(tgMemoryReport::eControllers));
+		EXPECT_EQ(2u, report.getCount(tgMemoryReport::eControllers));
+		EXPECT_EQ(0u, report.getBytes(tgMemoryReport::eCables));
+	}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
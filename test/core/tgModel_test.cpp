@@ -0,0 +1,219 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgModel_test.cpp
+* @brief Contains a test of the cached descendant list of tgModel and its
+* type index, of the shared state frame, of stop requests and a check that
+* stepping a model tree does not allocate
+* $Id$
+*/
+
+// This application
+#include "core/tgModel.h"
+#include "core/tgStateFrame.h"
+// The C++ Standard Library
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+// Count every heap allocation made by this process
+static std::size_t allocations = 0;
+
+void* operator new(std::size_t size) throw(std::bad_alloc)
+{
+	++allocations;
+	void* const p = std::malloc(size == 0 ? 1 : size);
+	if (p == NULL)
+	{
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void operator delete(void* p) throw()
+{
+	std::free(p);
+}
+
+void* operator new[](std::size_t size) throw(std::bad_alloc)
+{
+	return operator new(size);
+}
+
+void operator delete[](void* p) throw()
+{
+	operator delete(p);
+}
+
+namespace {
+
+	class Leaf : public tgModel {
+		public:
+			Leaf(const std::string& tags) : tgModel(tgTags(tags)) {}
+	};
+
+	// The fixture builds root -> (a -> (a1, a2), b)
+	class tgModelTest : public ::testing::Test {
+		protected:
+
+			tgModelTest() :
+			root(new tgModel()),
+			a(new tgModel()),
+			a1(new tgModel()),
+			a2(new tgModel()),
+			b(new tgModel())
+			{
+				a->addChild(a1);
+				a->addChild(a2);
+				root->addChild(a);
+				root->addChild(b);
+			}
+
+			virtual ~tgModelTest() {
+				// Deletes the children too
+				delete root;
+			}
+
+			tgModel* root;
+			tgModel* a;
+			tgModel* a1;
+			tgModel* a2;
+			tgModel* b;
+	};
+
+	TEST_F(tgModelTest, testDescendantOrder) {
+		const std::vector<tgModel*>& descendants = root->getDescendants();
+		ASSERT_EQ(4u, descendants.size());
+		EXPECT_EQ(a, descendants[0]);
+		EXPECT_EQ(a1, descendants[1]);
+		EXPECT_EQ(a2, descendants[2]);
+		EXPECT_EQ(b, descendants[3]);
+
+		EXPECT_EQ(2u, a->getDescendants().size());
+		EXPECT_TRUE(b->getDescendants().empty());
+	}
+
+	TEST_F(tgModelTest, testAddChildInvalidatesAncestors) {
+		// Fill the caches
+		EXPECT_EQ(4u, root->getDescendants().size());
+		EXPECT_TRUE(a1->getDescendants().empty());
+
+		// Adding below a grandchild must reach the root's list
+		tgModel* const leaf = new tgModel();
+		a1->addChild(leaf);
+
+		const std::vector<tgModel*>& descendants = root->getDescendants();
+		ASSERT_EQ(5u, descendants.size());
+		EXPECT_EQ(leaf, descendants[2]);
+		EXPECT_EQ(1u, a1->getDescendants().size());
+
+		// The cached list still rejects a repeated child
+		EXPECT_THROW(root->addChild(leaf), std::invalid_argument);
+	}
+
+	TEST_F(tgModelTest, testFindByTypeAndTags) {
+		Leaf* const x = new Leaf("leg left");
+		Leaf* const y = new Leaf("leg right");
+		Leaf* const z = new Leaf("spine");
+		a2->addChild(x);
+		b->addChild(y);
+		root->addChild(z);
+
+		EXPECT_EQ(7u, root->find<tgModel>("").size());
+		const std::vector<Leaf*> legs = root->find<Leaf>("leg");
+		ASSERT_EQ(2u, legs.size());
+		EXPECT_EQ(x, legs[0]);
+		EXPECT_EQ(y, legs[1]);
+		EXPECT_EQ(3u, root->find<Leaf>("").size());
+		EXPECT_TRUE(root->find<Leaf>("arm").empty());
+
+		// Tags may change without the tree knowing
+		z->addTags("leg");
+		EXPECT_EQ(3u, root->find<Leaf>("leg").size());
+
+		// Adding below a descendant reaches the root's index
+		Leaf* const w = new Leaf("leg");
+		a1->addChild(w);
+		const std::vector<Leaf*> after = root->find<Leaf>("leg");
+		ASSERT_EQ(4u, after.size());
+		EXPECT_EQ(w, after[0]);
+		EXPECT_EQ(1u, a->find<Leaf>("right").size() + a->find<Leaf>("left").size());
+	}
+
+	TEST_F(tgModelTest, testStateFrameIsSharedWithDescendants) {
+		EXPECT_TRUE(a1->getStateFrame() == NULL);
+
+		tgStateFrame frame;
+		root->setStateFrame(&frame);
+		EXPECT_EQ(&frame, root->getStateFrame());
+		EXPECT_EQ(&frame, a1->getStateFrame());
+		EXPECT_EQ(&frame, b->getStateFrame());
+
+		// A nearer frame hides the root's
+		tgStateFrame inner;
+		a->setStateFrame(&inner);
+		EXPECT_EQ(&inner, a2->getStateFrame());
+		EXPECT_EQ(&frame, b->getStateFrame());
+
+		root->setStateFrame(NULL);
+		a->setStateFrame(NULL);
+		EXPECT_TRUE(a2->getStateFrame() == NULL);
+	}
+
+	TEST_F(tgModelTest, testStopRequest) {
+		EXPECT_FALSE(root->isStopRequested());
+
+		root->requestStop();
+		EXPECT_TRUE(root->isStopRequested());
+		// Requests are per model, tgSimulation reads the root's
+		EXPECT_FALSE(a->isStopRequested());
+
+		root->clearStopRequest();
+		EXPECT_FALSE(root->isStopRequested());
+	}
+
+	TEST_F(tgModelTest, testSteadyStateDoesNotAllocate) {
+		// Warm up: the first call builds each cache
+		root->getDescendants();
+		a->getDescendants();
+
+		// No assertions inside the counted loop, they may allocate
+		std::size_t found = 0;
+		const std::size_t before = allocations;
+		for (int i = 0; i < 100; i++)
+		{
+			root->step(0.001);
+			found += root->getDescendants().size();
+			found += a->getDescendants().size();
+		}
+		const std::size_t after = allocations;
+
+		EXPECT_EQ(600u, found);
+		EXPECT_EQ(before, after);
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,142 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgObserverPipeline_test.cpp
+* @brief Contains a test of tgObserverPipeline, attached or held by a
+* tgSubject
+* $Id$
+*/
+
+// This application
+#include "core/tgObserverPipeline.h"
+#include "core/tgSubject.h"
+// The C++ Standard Library
+#include <stdexcept>
+#include <string>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	class Model;
+
+	/** Appends its letter to the model's log */
+	template <char Letter>
+	class Stage : public tgObserver<Model> {
+	public:
+		Stage() : setups(0), resets(0) { }
+		virtual void onStep(Model& model, double dt);
+		virtual void onSetup(Model& model) { setups++; }
+		virtual void onReset(Model& model) { resets++; }
+		int setups;
+		int resets;
+	};
+
+	/** Would append a letter of its own if called virtually */
+	class Derived : public Stage<'b'> {
+	public:
+		virtual void onStep(Model& model, double dt);
+	};
+
+	typedef tgObserverPipeline<Model, Stage<'a'>, Stage<'b'>, Stage<'c'> >
+		Pipeline;
+
+	class Model : public tgSubject<Model, Pipeline> {
+	public:
+		std::string log;
+	};
+
+	template <char Letter>
+	void Stage<Letter>::onStep(Model& model, double dt) {
+		model.log += Letter;
+	}
+
+	void Derived::onStep(Model& model, double dt) {
+		model.log += 'x';
+	}
+
+	TEST(tgObserverPipelineTest, StepsInOrderBeforeTheObservers) {
+		Stage<'a'> a;
+		Derived b;
+		Stage<'c'> c;
+		Stage<'d'> d;
+		Pipeline pipeline(&a, &b, &c);
+		EXPECT_EQ(3u, Pipeline::size);
+		EXPECT_EQ(&a, &pipeline.first());
+
+		Model model;
+		model.attach(&d);
+		model.attachPipeline(&pipeline);
+		model.notifySetup();
+		model.notifyStep(0.01);
+		model.notifyStep(0.01);
+		// b is called as a Stage<'b'>, by its qualified name
+		EXPECT_EQ("abcdabcd", model.log);
+		EXPECT_EQ(1, a.setups);
+		EXPECT_EQ(1, c.setups);
+		EXPECT_EQ(1, d.setups);
+	}
+
+	TEST(tgObserverPipelineTest, AttachesAsOneObserver) {
+		Stage<'a'> a;
+		Stage<'b'> b;
+		Stage<'c'> c;
+		Pipeline pipeline(&a, &b, &c);
+		Model model;
+		model.attach(&pipeline);
+		model.notifyStep(0.01);
+		EXPECT_EQ("abc", model.log);
+		EXPECT_FALSE(pipeline.isParallelSafe());
+
+		EXPECT_THROW(Pipeline(&a, NULL, &c), std::invalid_argument);
+	}
+
+	TEST(tgObserverPipelineTest, ResetsWhatWasSetUp) {
+		Stage<'a'> a;
+		Stage<'b'> b;
+		Stage<'c'> c;
+		Stage<'d'> d;
+		Pipeline pipeline(&a, &b, &c);
+		Model model;
+		model.attach(&d);
+		model.attachPipeline(&pipeline);
+		model.notifySetup();
+		model.notifyTeardown();
+		model.notifySetup();
+		EXPECT_EQ(1, a.setups);
+		EXPECT_EQ(1, a.resets);
+		EXPECT_EQ(1, c.resets);
+		EXPECT_EQ(1, d.setups);
+		EXPECT_EQ(1, d.resets);
+
+		// Observers attached since are set up
+		Stage<'e'> e;
+		model.attach(&e);
+		model.notifySetup();
+		EXPECT_EQ(1, e.setups);
+		EXPECT_EQ(0, e.resets);
+		EXPECT_EQ(2, d.resets);
+	}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
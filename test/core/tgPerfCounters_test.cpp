@@ -0,0 +1,124 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgPerfCounters_test.cpp
+* @brief Contains a test of tgPerfCounters: the totals of scopes over
+* threads, where the machine has the counters
+* $Id$
+*/
+
+// This application
+#include "core/tgPerfCounters.h"
+#include "core/tgThreadPool.h"
+// The C++ Standard Library
+#include <map>
+#include <string>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	volatile double sink = 0.0;
+
+	void work(std::size_t items)
+	{
+		const tgPerfCounters::Scope counters("work", items);
+		for (int i = 0; i < 100000; i++) {
+			sink = sink + 0.5 * i;
+		}
+	}
+
+	class WorkTask : public tgThreadPool::Task
+	{
+	public:
+		virtual void operator()(std::size_t item)
+		{
+			work(2);
+		}
+	};
+
+	TEST(tgPerfCountersTest, ReadsTotals) {
+		tgPerfCounters::Totals totals;
+		EXPECT_EQ(0.0, totals.ipc());
+		EXPECT_EQ(0.0, totals.perItem(tgPerfCounters::eCycles));
+
+		totals.items = 4;
+		totals.counts[tgPerfCounters::eCycles] = 200;
+		totals.counts[tgPerfCounters::eInstructions] = 300;
+		totals.counts[tgPerfCounters::eCacheMisses] = 6;
+		totals.counted[tgPerfCounters::eCycles] = true;
+		// Not counted: no ratio
+		EXPECT_EQ(0.0, totals.ipc());
+		totals.counted[tgPerfCounters::eInstructions] = true;
+		EXPECT_DOUBLE_EQ(1.5, totals.ipc());
+		EXPECT_DOUBLE_EQ(1.5, totals.perItem(tgPerfCounters::eCacheMisses));
+
+		tgPerfCounters::Totals sum;
+		sum.add(totals);
+		sum.add(totals);
+		EXPECT_EQ(8u, sum.items);
+		EXPECT_EQ(400, sum.counts[tgPerfCounters::eCycles]);
+		EXPECT_TRUE(sum.counted[tgPerfCounters::eInstructions]);
+		EXPECT_FALSE(sum.counted[tgPerfCounters::eBranchMisses]);
+
+		EXPECT_STREQ("llc_misses",
+					 tgPerfCounters::getName(tgPerfCounters::eCacheMisses));
+	}
+
+	TEST(tgPerfCountersTest, CountsOnlyWhileEnabled) {
+		ASSERT_FALSE(tgPerfCounters::isEnabled());
+		work(1);
+		EXPECT_TRUE(tgPerfCounters::take().empty());
+
+		if (!tgPerfCounters::isAvailable()) {
+			// A virtual machine, or a kernel that forbids it
+			return;
+		}
+
+		tgPerfCounters::setEnabled(true);
+		work(3);
+		work(3);
+		{
+			tgThreadPool pool(2);
+			WorkTask task;
+			pool.run(task, 4);
+		}
+		tgPerfCounters::setEnabled(false);
+		work(1);
+
+		std::map<std::string, tgPerfCounters::Totals> counters =
+			tgPerfCounters::take();
+		ASSERT_EQ(1u, counters.count("work"));
+		const tgPerfCounters::Totals& totals = counters["work"];
+		EXPECT_EQ(6u, totals.calls);
+		EXPECT_EQ(14u, totals.items);
+		EXPECT_TRUE(totals.counted[tgPerfCounters::eCycles]);
+		EXPECT_GT(totals.counts[tgPerfCounters::eInstructions], 100000);
+		EXPECT_GT(totals.ipc(), 0.0);
+
+		// The totals start over
+		EXPECT_TRUE(tgPerfCounters::take().empty());
+	}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
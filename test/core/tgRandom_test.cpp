@@ -0,0 +1,89 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgRandom_test.cpp
+* @brief Contains a test of the random streams derived from one seed
+* $Id$
+*/
+
+// This application
+#include "core/tgRandom.h"
+// Google Test
+#include "gtest/gtest.h"
+// The C++ Standard Library
+#include <cmath>
+
+namespace {
+
+	TEST(tgRandomTest, testStreamsRepeat) {
+		tgRandom::setMasterSeed(42);
+		tgRandom a(tgRandom::eNoise, 3);
+		tgRandom b(tgRandom::eNoise, 3);
+		for (int i = 0; i < 100; i++) {
+			EXPECT_EQ(a.next(), b.next());
+		}
+	}
+
+	TEST(tgRandomTest, testStreamsDiffer) {
+		tgRandom::setMasterSeed(42);
+		tgRandom world0(tgRandom::eNoise, tgRandom::index(0, 1));
+		tgRandom world1(tgRandom::eNoise, tgRandom::index(1, 1));
+		tgRandom terrain(tgRandom::eTerrain, tgRandom::index(0, 1));
+		const boost::uint64_t first = world0.next64();
+		EXPECT_NE(first, world1.next64());
+		EXPECT_NE(first, terrain.next64());
+
+		tgRandom::setMasterSeed(43);
+		tgRandom reseeded(tgRandom::eNoise, tgRandom::index(0, 1));
+		EXPECT_NE(first, reseeded.next64());
+	}
+
+	TEST(tgRandomTest, testOwnSeedIgnoresMaster) {
+		tgRandom::setMasterSeed(1);
+		tgRandom a(tgRandom::eTerrain, 0, 7);
+		tgRandom::setMasterSeed(2);
+		tgRandom b(tgRandom::eTerrain, 0, 7);
+		EXPECT_EQ(a.next64(), b.next64());
+	}
+
+	TEST(tgRandomTest, testRanges) {
+		tgRandom::setMasterSeed(5);
+		tgRandom rng(tgRandom::eTrial);
+		double sum = 0.0;
+		double squares = 0.0;
+		const int n = 10000;
+		for (int i = 0; i < n; i++) {
+			const double u = rng.uniform();
+			EXPECT_GE(u, 0.0);
+			EXPECT_LT(u, 1.0);
+			EXPECT_LT(rng.below(6), 6u);
+			const double g = rng.gaussian();
+			sum += g;
+			squares += g * g;
+		}
+		EXPECT_NEAR(0.0, sum / n, 0.05);
+		EXPECT_NEAR(1.0, squares / n, 0.05);
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,173 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgRobustnessEvaluator_test.cpp
+* @brief Contains a test of tgRobustnessEvaluator: building, perturbing
+* and scoring the clones, and summarizing their scores
+* $Id$
+*/
+
+// This application
+#include "core/tgBulletUtil.h"
+#include "core/tgModel.h"
+#include "core/tgRandom.h"
+#include "core/tgRobustnessEvaluator.h"
+#include "core/tgSimulation.h"
+// The Bullet Physics library
+#include "BulletDynamics/Dynamics/btDynamicsWorld.h"
+// The C++ Standard Library
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	/** Counts its steps */
+	class Counter : public tgModel {
+		public:
+			Counter() : steps(0) {}
+
+			virtual void step(double dt)
+			{
+				steps++;
+				tgModel::step(dt);
+			}
+
+			int steps;
+	};
+
+	/** Builds counters and scores a clone by its steps and friction */
+	class CounterFactory : public tgRobustnessEvaluator::Factory {
+		public:
+			virtual tgModel* build(tgSimulation& simulation,
+								   const tgRobustnessEvaluator::Perturbation& perturbation)
+			{
+				counters.push_back(new Counter());
+				return counters.back();
+			}
+
+			virtual double score(const tgSimulation& simulation,
+								 const tgRobustnessEvaluator::Perturbation& perturbation)
+			{
+				return counters[perturbation.clone]->steps * perturbation.friction;
+			}
+
+			std::vector<Counter*> counters;
+	};
+
+	/** The friction of the first static body of a world, its ground */
+	double groundFriction(const tgWorld& world)
+	{
+		const btCollisionObjectArray& objects =
+			tgBulletUtil::worldToDynamicsWorld(world).getCollisionObjectArray();
+		for (int i = 0; i < objects.size(); i++)
+		{
+			if (objects[i]->isStaticObject())
+			{
+				return objects[i]->getFriction();
+			}
+		}
+		return -1.0;
+	}
+
+	TEST(tgRobustnessEvaluatorTest, EvaluatesEveryClone) {
+		CounterFactory factory;
+		tgRobustnessEvaluator robust(factory, tgRobustnessEvaluator::Config(4, 0.1, 0.2, 0.0, 10));
+		ASSERT_EQ(4u, robust.size());
+		ASSERT_EQ(4u, factory.counters.size());
+		EXPECT_EQ(10, factory.counters[0]->steps);
+
+		const tgRobustnessEvaluator::Statistics first = robust.evaluate(25);
+		ASSERT_EQ(4u, first.scores.size());
+		for (std::size_t i = 0; i < factory.counters.size(); i++)
+		{
+			EXPECT_EQ(35, factory.counters[i]->steps);
+			EXPECT_DOUBLE_EQ(35 * robust.getPerturbation(i).friction, first.scores[i]);
+		}
+
+		// Each evaluation starts from the settled state, with the same clones
+		robust.evaluate(5);
+		EXPECT_EQ(40, factory.counters[3]->steps);
+
+		EXPECT_THROW(robust.getPerturbation(4), std::out_of_range);
+	}
+
+	TEST(tgRobustnessEvaluatorTest, PerturbsTheGround) {
+		tgRandom::setMasterSeed(17);
+		CounterFactory factory;
+		tgRobustnessEvaluator robust(factory, tgRobustnessEvaluator::Config(3, 0.0, 0.5));
+		CounterFactory otherFactory;
+		tgRobustnessEvaluator other(otherFactory, tgRobustnessEvaluator::Config(3, 0.0, 0.5));
+		CounterFactory plainFactory;
+		tgRobustnessEvaluator plain(plainFactory, tgRobustnessEvaluator::Config(1, 0.0, 0.0));
+
+		const double friction = groundFriction(plain.getBatch().getWorld(0));
+		EXPECT_DOUBLE_EQ(1.0, plain.getPerturbation(0).friction);
+		for (std::size_t i = 0; i < robust.size(); i++)
+		{
+			const tgRobustnessEvaluator::Perturbation& p = robust.getPerturbation(i);
+			EXPECT_EQ(i, p.clone);
+			EXPECT_GT(p.friction, 0.0);
+			EXPECT_NEAR(friction * p.friction,
+						groundFriction(robust.getBatch().getWorld(i)), 1e-12);
+
+			// The clones depend only on the seed
+			EXPECT_EQ(p.friction, other.getPerturbation(i).friction);
+			EXPECT_EQ(p.terrainSeed, other.getPerturbation(i).terrainSeed);
+		}
+		EXPECT_NE(robust.getPerturbation(0).friction, robust.getPerturbation(1).friction);
+	}
+
+	TEST(tgRobustnessEvaluatorTest, Summarizes) {
+		std::vector<double> scores;
+		scores.push_back(4.0);
+		scores.push_back(1.0);
+		scores.push_back(3.0);
+		scores.push_back(2.0);
+		const tgRobustnessEvaluator::Statistics s = tgRobustnessEvaluator::summarize(scores);
+		EXPECT_DOUBLE_EQ(2.5, s.mean);
+		EXPECT_DOUBLE_EQ(2.5, s.median);
+		EXPECT_DOUBLE_EQ(1.0, s.min);
+		EXPECT_DOUBLE_EQ(4.0, s.max);
+		EXPECT_NEAR(std::sqrt(5.0 / 3.0), s.stddev, 1e-12);
+		EXPECT_EQ(4.0, s.scores[0]);
+
+		EXPECT_THROW(tgRobustnessEvaluator::summarize(std::vector<double>()),
+					 std::invalid_argument);
+	}
+
+	TEST(tgRobustnessEvaluatorTest, RejectsBadConfigs) {
+		CounterFactory factory;
+		EXPECT_THROW(tgRobustnessEvaluator(factory, tgRobustnessEvaluator::Config(0)),
+					 std::invalid_argument);
+		EXPECT_THROW(tgRobustnessEvaluator(factory, tgRobustnessEvaluator::Config(2, -0.1)),
+					 std::invalid_argument);
+		EXPECT_THROW(tgRobustnessEvaluator(factory, tgRobustnessEvaluator::Config(2, 0.1, 0.1, 0.0, -1)),
+					 std::invalid_argument);
+		EXPECT_TRUE(factory.counters.empty());
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
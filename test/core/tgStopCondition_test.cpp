@@ -0,0 +1,166 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgStopCondition_test.cpp
+* @brief Contains a test of the run budgets of tgSimulation: stop
+* conditions and wall clock limits, and the reasons they report
+* $Id$
+*/
+
+// This application
+#include "core/tgModel.h"
+#include "core/tgSettledCondition.h"
+#include "core/tgSimView.h"
+#include "core/tgSimulation.h"
+#include "core/tgStopCondition.h"
+#include "core/tgWorld.h"
+#include "core/terrain/tgEmptyGround.h"
+// The C++ Standard Library
+#include <stdexcept>
+#include <string>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	/** Counts its steps */
+	class Counter : public tgModel {
+		public:
+			Counter() : steps(0) {}
+
+			virtual void step(double dt)
+			{
+				steps++;
+				tgModel::step(dt);
+			}
+
+			int steps;
+	};
+
+	/** Stops after a number of steps of each run */
+	class AfterSteps : public tgStopCondition {
+		public:
+			AfterSteps(int steps) : m_steps(steps), seen(0), starts(0) {}
+
+			virtual void start(const tgSimulation& simulation)
+			{
+				seen = 0;
+				starts++;
+			}
+
+			virtual bool shouldStop(const tgSimulation& simulation, double dt)
+			{
+				return ++seen >= m_steps;
+			}
+
+		private:
+			const int m_steps;
+
+		public:
+			int seen;
+			int starts;
+	};
+
+	class tgStopConditionTest : public ::testing::Test {
+		protected:
+			tgStopConditionTest() :
+			world(tgWorld::Config(0.0), new tgEmptyGround()),
+			view(world, 1.0/1000.0, 1.0/60.0),
+			simulation(view),
+			counter(new Counter())
+			{
+				simulation.addModel(counter);
+			}
+
+			tgWorld world;
+			tgSimView view;
+			tgSimulation simulation;
+			Counter* counter;
+	};
+
+	TEST_F(tgStopConditionTest, RunsAllStepsWithoutBudget) {
+		simulation.run(50);
+		EXPECT_EQ(50, counter->steps);
+		EXPECT_FALSE(simulation.isStopped());
+		EXPECT_EQ(tgSimulation::eNotStopped, simulation.getStopReason());
+	}
+
+	TEST_F(tgStopConditionTest, ConditionEndsEachRun) {
+		AfterSteps condition(10);
+		simulation.setStopCondition(&condition);
+		simulation.run(100);
+		EXPECT_EQ(10, counter->steps);
+		EXPECT_TRUE(simulation.isStopped());
+		EXPECT_EQ(tgSimulation::eCondition, simulation.getStopReason());
+		EXPECT_EQ(std::string("condition"),
+				  tgSimulation::stopReasonName(simulation.getStopReason()));
+
+		// Each run starts the condition again
+		simulation.run(100);
+		EXPECT_EQ(20, counter->steps);
+		EXPECT_EQ(2, condition.starts);
+
+		// Stepping outside of run(int) has no budget
+		simulation.setStopCondition(NULL);
+		simulation.run(5);
+		EXPECT_EQ(25, counter->steps);
+		EXPECT_EQ(tgSimulation::eNotStopped, simulation.getStopReason());
+	}
+
+	TEST_F(tgStopConditionTest, WallClockLimitEndsRun) {
+		EXPECT_THROW(simulation.setWallClockLimit(-1.0), std::invalid_argument);
+
+		// Any step takes longer than this
+		simulation.setWallClockLimit(1.0e-12);
+		simulation.run(1000);
+		EXPECT_EQ(1, counter->steps);
+		EXPECT_EQ(tgSimulation::eWallClock, simulation.getStopReason());
+
+		simulation.setWallClockLimit(0.0);
+		simulation.run(10);
+		EXPECT_EQ(11, counter->steps);
+		EXPECT_FALSE(simulation.isStopped());
+	}
+
+	TEST_F(tgStopConditionTest, FirstReasonIsKept) {
+		AfterSteps condition(1);
+		simulation.setStopCondition(&condition);
+		simulation.setWallClockLimit(1.0e-12);
+		simulation.run(10);
+		EXPECT_EQ(tgSimulation::eCondition, simulation.getStopReason());
+	}
+
+	TEST_F(tgStopConditionTest, SettledAfterGrace) {
+		EXPECT_THROW(tgSettledCondition(0.0, 1.0), std::invalid_argument);
+		EXPECT_THROW(tgSettledCondition(1.0, -1.0), std::invalid_argument);
+
+		// Nothing moves, so it is settled as soon as the grace is over
+		tgSettledCondition settled(0.1, 0.05, 0.1);
+		simulation.setStopCondition(&settled);
+		simulation.run(1000);
+		EXPECT_EQ(tgSimulation::eCondition, simulation.getStopReason());
+		EXPECT_NEAR(150, counter->steps, 2);
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
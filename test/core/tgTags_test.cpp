@@ -0,0 +1,98 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgTags_test.cpp
+* @brief Contains a test of tag matching through interned tag ids
+* $Id$
+*/
+
+// This application
+#include "core/tgTags.h"
+#include "core/tgTagSearch.h"
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	TEST(tgTagsTest, testInternIsStable) {
+		const unsigned rod = tgTags::intern("rod");
+		EXPECT_EQ(rod, tgTags::intern("rod"));
+		EXPECT_NE(rod, tgTags::intern("string"));
+
+		unsigned id;
+		EXPECT_TRUE(tgTags::lookup("rod", id));
+		EXPECT_EQ(rod, id);
+		EXPECT_FALSE(tgTags::lookup("neverUsedAsATag", id));
+	}
+
+	TEST(tgTagsTest, testContains) {
+		const tgTags tags("a b c");
+		EXPECT_TRUE(tags.contains(tgTags("c a")));
+		EXPECT_TRUE(tags.contains("b"));
+		EXPECT_TRUE(tags.contains(tgTags()));
+		EXPECT_FALSE(tags.contains(tgTags("a d")));
+		// Unknown and integer tags never match, they don't throw
+		EXPECT_FALSE(tags.contains("unknownTag"));
+		EXPECT_FALSE(tags.contains("a 3"));
+
+		EXPECT_TRUE(tags.containsAny(tgTags("d c")));
+		EXPECT_FALSE(tags.containsAny(tgTags("d e")));
+	}
+
+	TEST(tgTagsTest, testEditsKeepIdsInStep) {
+		tgTags tags("a b");
+		tags.prepend("z");
+		tags.append("b c");
+		ASSERT_EQ(4, tags.size());
+		EXPECT_EQ("z", tags[0]);
+		EXPECT_EQ("c", tags[3]);
+
+		tags.remove("b");
+		EXPECT_EQ(3, tags.size());
+		EXPECT_FALSE(tags.contains("b"));
+		EXPECT_TRUE(tags.contains("a c z"));
+		EXPECT_TRUE(tags == tgTags("c z a"));
+
+		tags += tgTags("q");
+		EXPECT_TRUE(tags.contains("q a"));
+	}
+
+	TEST(tgTagsTest, testSearch) {
+		const tgTagSearch search("rod top");
+		EXPECT_TRUE(search.matches(tgTags("top rod left")));
+		EXPECT_FALSE(search.matches(tgTags("rod bottom")));
+		// Many tags spread the signature over more than one word's bits
+		tgTags many;
+		for (int i = 0; i < 100; i++)
+		{
+			std::stringstream ss;
+			ss << "t" << i;
+			many.append(ss.str());
+		}
+		EXPECT_FALSE(search.matches(many));
+		many.append("top rod");
+		EXPECT_TRUE(search.matches(many));
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,133 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgWarmDantzigSolver_test.cpp
+* @brief Contains a test of the warm started MLCP solver
+* $Id$
+*/
+
+// This application
+#include "core/tgWarmDantzigSolver.h"
+// Google Test
+#include "gtest/gtest.h"
+// The C++ Standard Library
+#include <stdexcept>
+
+namespace {
+
+	/** One contact: a normal row and two friction rows with mu 0.5 */
+	class tgWarmDantzigSolverTest : public ::testing::Test {
+		protected:
+			tgWarmDantzigSolverTest() : A(3, 3), b(3), lo(3), hi(3), x(3) {
+				const double values[3][3] = {{2.0, 0.3, 0.1},
+											 {0.3, 1.5, 0.2},
+											 {0.1, 0.2, 1.2}};
+				for (int i = 0; i < 3; i++) {
+					for (int j = 0; j < 3; j++) {
+						A.setElem(i, j, values[i][j]);
+					}
+				}
+				lo[0] = 0.0;
+				hi[0] = SIMD_INFINITY;
+				for (int i = 1; i < 3; i++) {
+					lo[i] = -0.5;
+					hi[i] = 0.5;
+				}
+				limitDependency.push_back(-1);
+				limitDependency.push_back(0);
+				limitDependency.push_back(0);
+				x.setZero();
+			}
+
+			/** Solve with both solvers, the warm one from guess */
+			void expectSame(const btVectorXu& guess, bool warm) {
+				btVectorXu cold(x);
+				btDantzigSolver dantzig;
+				ASSERT_TRUE(dantzig.solveMLCP(A, b, cold, lo, hi, limitDependency, 10));
+
+				btVectorXu result(guess);
+				tgWarmDantzigSolver solver;
+				ASSERT_TRUE(solver.solveMLCP(A, b, result, lo, hi, limitDependency, 10));
+				for (int i = 0; i < 3; i++) {
+					EXPECT_NEAR(cold[i], result[i], 1e-9);
+				}
+				EXPECT_EQ(warm ? 1u : 0u, solver.getWarmSolves());
+				EXPECT_EQ(warm ? 0u : 1u, solver.getColdSolves());
+			}
+
+			btMatrixXu A;
+			btVectorXu b;
+			btVectorXu lo;
+			btVectorXu hi;
+			btVectorXu x;
+			btAlignedObjectArray<int> limitDependency;
+	};
+
+	TEST_F(tgWarmDantzigSolverTest, testStickingContact) {
+		b[0] = 1.0;
+		b[1] = 0.1;
+		b[2] = -0.1;
+		btVectorXu cold(x);
+		btDantzigSolver dantzig;
+		ASSERT_TRUE(dantzig.solveMLCP(A, b, cold, lo, hi, limitDependency, 10));
+
+		// The last step's solution, as Bullet's warm starting scales it
+		btVectorXu guess(cold);
+		for (int i = 0; i < 3; i++) {
+			guess[i] *= 0.85;
+		}
+		expectSame(guess, true);
+	}
+
+	TEST_F(tgWarmDantzigSolverTest, testSeparatingContact) {
+		b[0] = -1.0;
+		b[1] = 0.1;
+		b[2] = 0.2;
+		expectSame(x, true);
+	}
+
+	TEST_F(tgWarmDantzigSolverTest, testSlidingFromRest) {
+		// Friction saturates, which the pivots find from a zero guess
+		b[0] = 0.2;
+		b[1] = 2.0;
+		b[2] = 0.0;
+		expectSame(x, true);
+	}
+
+	TEST_F(tgWarmDantzigSolverTest, testNoPivotsFallsBack) {
+		b[0] = 0.2;
+		b[1] = 2.0;
+		b[2] = 0.0;
+		btVectorXu result(x);
+		tgWarmDantzigSolver solver(0);
+		ASSERT_TRUE(solver.solveMLCP(A, b, result, lo, hi, limitDependency, 10));
+		EXPECT_EQ(0u, solver.getWarmSolves());
+		EXPECT_EQ(1u, solver.getColdSolves());
+	}
+
+	TEST_F(tgWarmDantzigSolverTest, testNegativePivots) {
+		EXPECT_THROW(tgWarmDantzigSolver(-1), std::invalid_argument);
+	}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
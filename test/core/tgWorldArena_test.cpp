@@ -0,0 +1,111 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgWorldArena_test.cpp
+* @brief Contains a test of the per world allocator of Bullet objects
+* $Id$
+*/
+
+// This application
+#include "core/tgWorldArena.h"
+// Google Test
+#include "gtest/gtest.h"
+// The C++ Standard Library
+#include <cstring>
+
+namespace {
+
+	TEST(tgWorldArenaTest, testNoScopeUsesMalloc) {
+		tgWorldArena arena;
+		void* const p = tgWorldArena::allocate(100);
+		ASSERT_TRUE(p != NULL);
+		std::memset(p, 1, 100);
+		EXPECT_EQ(0u, arena.bytes());
+		tgWorldArena::release(p);
+		tgWorldArena::release(NULL);
+	}
+
+	TEST(tgWorldArenaTest, testScopeUsesArena) {
+		tgWorldArena arena(1024);
+		{
+			const tgWorldArena::Scope scope(&arena);
+			void* const a = tgWorldArena::allocate(10);
+			void* const b = tgWorldArena::allocate(10);
+			EXPECT_EQ(0u, reinterpret_cast<std::size_t>(a) % 16);
+			EXPECT_EQ(0u, reinterpret_cast<std::size_t>(b) % 16);
+			EXPECT_EQ(32, static_cast<char*>(b) - static_cast<char*>(a));
+			EXPECT_EQ(1u, arena.chunks());
+			EXPECT_EQ(64u, arena.bytes());
+			tgWorldArena::release(a);
+			tgWorldArena::release(b);
+		}
+		// Closed, so back to malloc
+		void* const c = tgWorldArena::allocate(10);
+		EXPECT_EQ(64u, arena.bytes());
+		tgWorldArena::release(c);
+	}
+
+	TEST(tgWorldArenaTest, testLargeBlocksGetChunks) {
+		tgWorldArena arena(1024);
+		const tgWorldArena::Scope scope(&arena);
+		void* const small = tgWorldArena::allocate(10);
+		void* const large = tgWorldArena::allocate(4000);
+		std::memset(large, 1, 4000);
+		void* const next = tgWorldArena::allocate(10);
+		EXPECT_EQ(2u, arena.chunks());
+		// The ordinary chunk is still filled after the large block
+		EXPECT_EQ(32, static_cast<char*>(next) - static_cast<char*>(small));
+		tgWorldArena::release(small);
+		tgWorldArena::release(large);
+		tgWorldArena::release(next);
+	}
+
+	TEST(tgWorldArenaTest, testScopesNest) {
+		tgWorldArena outer;
+		tgWorldArena inner;
+		const tgWorldArena::Scope outerScope(&outer);
+		{
+			const tgWorldArena::Scope innerScope(&inner);
+			const tgWorldArena::Scope none(NULL);
+			tgWorldArena::release(tgWorldArena::allocate(10));
+		}
+		tgWorldArena::release(tgWorldArena::allocate(10));
+		EXPECT_EQ(32u, inner.bytes());
+		EXPECT_EQ(32u, outer.bytes());
+	}
+
+	TEST(tgWorldArenaTest, testBlocksOutliveArena) {
+		tgWorldArena* const pArena = new tgWorldArena();
+		void* p = NULL;
+		{
+			const tgWorldArena::Scope scope(pArena);
+			p = tgWorldArena::allocate(100);
+		}
+		delete pArena;
+		// The chunk is kept until the last block goes
+		std::memset(p, 1, 100);
+		tgWorldArena::release(p);
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
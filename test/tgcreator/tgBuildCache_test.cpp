@@ -0,0 +1,125 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgBuildCache_test.cpp
+* @brief Contains a test of the build plan files and keys of tgBuildCache
+* $Id$
+*/
+
+// This application
+#include "tgcreator/tgBuildCache.h"
+#include "tgcreator/tgBuildSpec.h"
+#include "tgcreator/tgStructure.h"
+// The C++ Standard Library
+#include <cstdio>
+#include <fstream>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	TEST(tgBuildCacheTest, testSaveAndLoad) {
+		const tgBuildCache cache;
+		const std::string key = "00000000deadbeef";
+
+		tgBuildCache::Plan plan;
+		plan.rigidAgents.push_back(0);
+		plan.rigidAgents.push_back(-1);
+		plan.connectorAgents.push_back(-1);
+		plan.connectorAgents.push_back(1);
+		plan.groups.push_back(0);
+		plan.fromRigids.push_back(0);
+		plan.toRigids.push_back(-1);
+		cache.save(key, plan);
+
+		tgBuildCache::Plan loaded;
+		ASSERT_TRUE(cache.load(key, loaded));
+		EXPECT_EQ(plan.rigidAgents, loaded.rigidAgents);
+		EXPECT_EQ(plan.connectorAgents, loaded.connectorAgents);
+		EXPECT_EQ(plan.groups, loaded.groups);
+		EXPECT_EQ(plan.fromRigids, loaded.fromRigids);
+		EXPECT_EQ(plan.toRigids, loaded.toRigids);
+
+		// An entry saved under another key is not used
+		std::rename(cache.getFileName(key).c_str(),
+					cache.getFileName("0000000000000001").c_str());
+		EXPECT_FALSE(cache.load("0000000000000001", loaded));
+		std::remove(cache.getFileName("0000000000000001").c_str());
+
+		EXPECT_FALSE(cache.load(key, loaded));
+	}
+
+	TEST(tgBuildCacheTest, testTruncatedEntryIsIgnored) {
+		const tgBuildCache cache;
+		const std::string key = "00000000cafef00d";
+		tgBuildCache::Plan plan;
+		plan.rigidAgents.assign(100, 2);
+		plan.connectorAgents.assign(100, -1);
+		cache.save(key, plan);
+
+		// Keep only the head of the file
+		std::string head;
+		{
+			std::ifstream in(cache.getFileName(key).c_str(), std::ios::binary);
+			head.assign(64, '\0');
+			in.read(&head[0], head.size());
+		}
+		{
+			std::ofstream out(cache.getFileName(key).c_str(),
+							  std::ios::binary | std::ios::trunc);
+			out.write(head.data(), head.size());
+		}
+
+		tgBuildCache::Plan loaded;
+		EXPECT_FALSE(cache.load(key, loaded));
+		EXPECT_TRUE(loaded.rigidAgents.empty());
+		std::remove(cache.getFileName(key).c_str());
+	}
+
+	TEST(tgBuildCacheTest, testKeyFollowsTheStructure) {
+		tgBuildSpec spec;
+		tgStructure a;
+		a.addNode(0, 0, 0, "base");
+		a.addNode(0, 1, 0, "tip");
+		a.addPair(0, 1, "rod");
+
+		tgStructure b(a);
+		EXPECT_EQ(tgBuildCache::makeKey(a, spec), tgBuildCache::makeKey(b, spec));
+
+		tgStructure moved(a);
+		moved.move(btVector3(0, 0, 1));
+		EXPECT_NE(tgBuildCache::makeKey(a, spec), tgBuildCache::makeKey(moved, spec));
+
+		tgStructure retagged;
+		retagged.addNode(0, 0, 0, "base");
+		retagged.addNode(0, 1, 0, "tip");
+		retagged.addPair(0, 1, "string");
+		EXPECT_NE(tgBuildCache::makeKey(a, spec), tgBuildCache::makeKey(retagged, spec));
+
+		tgStructure parent;
+		parent.addChild(a);
+		EXPECT_NE(tgBuildCache::makeKey(a, spec), tgBuildCache::makeKey(parent, spec));
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
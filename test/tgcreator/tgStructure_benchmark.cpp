@@ -0,0 +1,129 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgStructure_benchmark.cpp
+* @brief Counts the heap allocations made while building and searching a
+* large tgStructure
+* $Id$
+*/
+
+// This application
+#include "tgcreator/tgNode.h"
+#include "tgcreator/tgNodes.h"
+#include "tgcreator/tgPairs.h"
+#include "tgcreator/tgStructure.h"
+// The C++ Standard Library
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	// Every operator new in the program goes through here
+	std::size_t allocations = 0;
+
+	// A ladder of numRungs rungs: two tagged nodes, a rod and a string each
+	void buildLadder(tgStructure& ladder, int numRungs)
+	{
+		for (int i = 0; i < numRungs; i++)
+		{
+			ladder.addNode(0, i, 0, "left");
+			ladder.addNode(1, i, 0, "right");
+			ladder.addPair(2 * i, 2 * i + 1, "rod");
+			if (i > 0)
+			{
+				ladder.addPair(2 * i - 2, 2 * i, "string");
+			}
+		}
+	}
+
+	void report(const std::string& phase, std::size_t count, int numRungs)
+	{
+		std::cout << phase << ": " << count << " allocations, " <<
+			static_cast<double>(count) / numRungs << " per rung" << std::endl;
+	}
+
+	TEST(tgStructureBenchmark, benchmarkAllocations) {
+		const int numRungs = 2000;
+
+		tgStructure ladder("ladder");
+		std::size_t start = allocations;
+		buildLadder(ladder, numRungs);
+		const std::size_t built = allocations - start;
+		report("build", built, numRungs);
+
+		// Reading nodes and pairs by index must not allocate at all
+		start = allocations;
+		double sum = 0.0;
+		const tgNodes& nodes = ladder.getNodes();
+		const tgPairs& pairs = ladder.getPairs();
+		for (int i = 0; i < nodes.size(); i++)
+		{
+			sum += nodes[i].x();
+		}
+		for (int i = 0; i < pairs.size(); i++)
+		{
+			sum += pairs[i].getFrom().y();
+		}
+		const std::size_t indexed = allocations - start;
+		report("index", indexed, numRungs);
+		EXPECT_EQ(0u, indexed);
+		EXPECT_LT(0.0, sum);
+
+		start = allocations;
+		tgStructure parent("parent");
+		parent.addChild(ladder);
+		parent.move(btVector3(0, 1, 0));
+		EXPECT_EQ(2.0 * numRungs, parent.getChildren()[0]->getNodes().size());
+		report("copy and move", allocations - start, numRungs);
+
+		start = allocations;
+		std::vector<tgNode> copies(nodes.getNodes());
+		const tgNodes fromVector(copies);
+		EXPECT_EQ(copies.size(), static_cast<std::size_t>(fromVector.size()));
+		report("tgNodes from a vector", allocations - start, numRungs);
+	}
+
+} // namespace
+
+void* operator new(std::size_t size)
+{
+	++allocations;
+	void* const p = std::malloc(size == 0 ? 1 : size);
+	if (p == NULL)
+	{
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void operator delete(void* p) throw()
+{
+	std::free(p);
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
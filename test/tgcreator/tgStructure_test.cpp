@@ -0,0 +1,183 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgStructure_test.cpp
+* @brief Contains a test of the indexed node and child searches, of
+* the child instances and of clearing tgStructure
+* $Id$
+*/
+
+// This application
+#include "tgcreator/tgNode.h"
+#include "tgcreator/tgStructure.h"
+// The C++ Standard Library
+#include <cmath>
+#include <stdexcept>
+// Google Test
+#include "gtest/gtest.h"
+// Boost
+#include "boost/shared_ptr.hpp"
+
+namespace {
+
+	// The fixture builds root -> (left -> (leaf), right)
+	class tgStructureTest : public ::testing::Test {
+		protected:
+
+			tgStructureTest() : root("root")
+			{
+				root.addNode(0, 0, 0, "origin");
+				tgStructure left("left");
+				left.addNode(1, 0, 0, "tip");
+				tgStructure leaf("leaf");
+				leaf.addNode(2, 0, 0, "tip deep");
+				left.addChild(leaf);
+				root.addChild(left);
+				root.addChild(tgStructure("right"));
+			}
+
+			tgStructure root;
+	};
+
+	TEST_F(tgStructureTest, testFindFirstInBreadthFirstOrder) {
+		EXPECT_EQ(0.0, root.findNode("origin").x());
+		// Both tips match, the shallower one comes first
+		EXPECT_EQ(1.0, root.findNode("tip").x());
+		EXPECT_EQ(2.0, root.findNode("deep tip").x());
+
+		EXPECT_TRUE(root.findChild("leaf").hasTag("leaf"));
+		EXPECT_THROW(root.findChild("root"), std::invalid_argument);
+		EXPECT_THROW(root.findNode("missing"), std::invalid_argument);
+	}
+
+	TEST_F(tgStructureTest, testAdditionsBelowReachTheIndex) {
+		// Build the index
+		EXPECT_EQ(2.0, root.findNode("deep").x());
+
+		// A node added to a grandchild must be found from the root
+		root.findChild("leaf").addNode(3, 0, 0, "late");
+		EXPECT_EQ(3.0, root.findNode("late").x());
+
+		// So must a node that is tagged after the index was built
+		root.findNode("deep").addTags("retagged");
+		EXPECT_EQ(2.0, root.findNode("retagged").x());
+
+		root.findChild("right").addChild(tgStructure("far"));
+		EXPECT_TRUE(root.findChild("far").hasTag("far"));
+	}
+
+	TEST_F(tgStructureTest, testClearKeepsOnlyTheTags) {
+		root.addNode(0, 1, 0, "top");
+		root.addPair(0, 1, "loop");
+		// Build the index, which must not outlive the children
+		EXPECT_EQ(2.0, root.findNode("deep").x());
+
+		root.clear();
+		EXPECT_EQ(0u, root.getNodes().size());
+		EXPECT_EQ(0u, root.getPairs().size());
+		EXPECT_TRUE(root.getChildren().empty());
+		EXPECT_TRUE(root.hasTag("root"));
+		EXPECT_THROW(root.findNode("deep"), std::invalid_argument);
+		EXPECT_THROW(root.findChild("leaf"), std::invalid_argument);
+
+		// A cleared structure can be built up again
+		root.addNode(4, 0, 0, "again");
+		EXPECT_EQ(4.0, root.findNode("again").x());
+	}
+
+	TEST_F(tgStructureTest, testCopiesSearchTheirOwnChildren) {
+		EXPECT_EQ(2.0, root.findNode("deep").x());
+
+		tgStructure copy(root);
+		tgNode& copied = copy.findNode("deep");
+		EXPECT_NE(&root.findNode("deep"), &copied);
+		copy.findChild("leaf").addNode(4, 0, 0, "onlyInCopy");
+		EXPECT_EQ(4.0, copy.findNode("onlyInCopy").x());
+		EXPECT_THROW(root.findNode("onlyInCopy"), std::invalid_argument);
+	}
+
+	TEST_F(tgStructureTest, testTransformsComposeInOrder) {
+		tgStructure& left = root.findChild("left");
+		left.move(btVector3(0, 1, 0));
+		root.addRotation(btVector3(0, 0, 0), btVector3(0, 0, 1), M_PI / 2);
+		// The rotation of root comes before this, though left holds it
+		left.scale(btVector3(0, 0, 0), 2.0);
+		root.move(btVector3(1, 0, 0));
+
+		// A copy takes everything pending above and on what it copies
+		tgStructure copy(left);
+		EXPECT_NEAR(-1.0, copy.findNode("tip").x(), 1e-12);
+		EXPECT_NEAR(4.0, copy.findNode("deep").y(), 1e-12);
+
+		// (1, 0, 0) moved, rotated a quarter turn, scaled, moved again
+		const btVector3& tip = root.findNode("tip");
+		EXPECT_NEAR(-1.0, tip.x(), 1e-12);
+		EXPECT_NEAR(2.0, tip.y(), 1e-12);
+		EXPECT_NEAR(0.0, tip.z(), 1e-12);
+		const btVector3& deep = root.findNode("deep");
+		EXPECT_NEAR(-1.0, deep.x(), 1e-12);
+		EXPECT_NEAR(4.0, deep.y(), 1e-12);
+		const btVector3& origin = root.findNode("origin");
+		EXPECT_NEAR(1.0, origin.x(), 1e-12);
+		EXPECT_NEAR(0.0, origin.y(), 1e-12);
+	}
+
+	TEST_F(tgStructureTest, testInstancesMatchTransformedCopies) {
+		boost::shared_ptr<const tgStructure> prototype(new tgStructure(root));
+		const btVector3 axis(0, 0, 1);
+
+		tgStructure copies("copies");
+		tgStructure copy(root);
+		copy.addTags("placed");
+		copy.scale(btVector3(1, 0, 0), 2.0);
+		copy.addRotation(btVector3(0, 1, 0), axis, 0.5);
+		copy.move(btVector3(0, 0, 3));
+		copies.addChild(copy);
+
+		tgStructure instances("instances");
+		tgStructure& instance =
+			instances.addChildInstance(prototype, tgTags("placed"));
+		instance.scale(btVector3(1, 0, 0), 2.0);
+		instance.addRotation(btVector3(0, 1, 0), axis, 0.5);
+		instances.move(btVector3(0, 0, 3));
+		EXPECT_TRUE(instance.isInstance());
+
+		const char* names[] = {"origin", "tip", "deep"};
+		for (int i = 0; i < 3; i++) {
+			const btVector3 expected = copies.findNode(names[i]);
+			const btVector3 actual = instances.findNode(names[i]);
+			EXPECT_EQ(expected.x(), actual.x());
+			EXPECT_EQ(expected.y(), actual.y());
+			EXPECT_EQ(expected.z(), actual.z());
+		}
+		EXPECT_FALSE(instance.isInstance());
+		EXPECT_TRUE(instances.findChild("placed").hasTag("root"));
+		EXPECT_TRUE(instances.findChild("leaf").hasTag("leaf"));
+
+		// The prototype is untouched
+		EXPECT_EQ(2.0, root.findNode("deep").x());
+		EXPECT_EQ(0.0, prototype->getNodes()[0].x());
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -24,6 +24,8 @@
 */
 
 // This application
+#include "util/CPGBatch.h"
+#include "util/CPGCoupling.h"
 #include "util/CPGEquations.h"
 #include "util/CPGNode.h"
 // The Bullet Physics Library
@@ -172,6 +174,300 @@ namespace {
             delete m_pCPGSystem2;
 	}
 
+	TEST_F(CPGEquationsTest, testFixedStepIntegration) {
+            
+            int numNodes = 3;
+            
+            // The adaptive and fixed step integrators follow the same equations
+            CPGEquations* m_pCPGSystem = getCPGSystem(numNodes);
+            CPGEquations* m_pCPGSystem2 = getCPGSystem(numNodes);
+            m_pCPGSystem2->setFixedStep(true);
+            
+            double descendingCommand = 1.0;
+            std::vector<double> desComs (numNodes, descendingCommand);
+            
+            int numSteps = 1000;
+            for (int i = 0; i < numSteps; i++)
+            {
+                m_pCPGSystem->update(desComs, 0.001);
+                m_pCPGSystem2->update(desComs, 0.001);
+            }
+            
+            EXPECT_NEAR((*m_pCPGSystem)[0], (*m_pCPGSystem2)[0], 1.0 * pow(10, -6));
+            EXPECT_NEAR((*m_pCPGSystem)[1], (*m_pCPGSystem2)[1], 1.0 * pow(10, -6));
+            EXPECT_NEAR((*m_pCPGSystem)[2], (*m_pCPGSystem2)[2], 1.0 * pow(10, -6));
+            
+            delete m_pCPGSystem;
+            delete m_pCPGSystem2;
+	}
+
+	TEST_F(CPGEquationsTest, testBatchMatchesSingleSystems) {
+            
+            int numNodes = 3;
+            int numSystems = 5;
+            
+            std::vector<CPGEquations*> batched;
+            std::vector<CPGEquations*> singles;
+            for (int s = 0; s < numSystems; s++)
+            {
+                batched.push_back(getCPGSystem(numNodes));
+                singles.push_back(getCPGSystem(numNodes));
+                singles.back()->setFixedStep(true);
+            }
+            
+            CPGBatch batch;
+            batch.build(batched);
+            ASSERT_EQ(5u, batch.systems());
+            ASSERT_EQ(3u, batch.nodes());
+            
+            // A different command for each system, [node][system]
+            std::vector<double> batchComs (numNodes * numSystems);
+            for (int i = 0; i < numNodes; i++)
+            {
+                for (int s = 0; s < numSystems; s++)
+                {
+                    batchComs[i * numSystems + s] = 0.5 * s;
+                }
+            }
+            
+            for (int i = 0; i < 100; i++)
+            {
+                batch.update(batchComs, 0.01, 0.01);
+                for (int s = 0; s < numSystems; s++)
+                {
+                    std::vector<double> desComs (numNodes, 0.5 * s);
+                    singles[s]->update(desComs, 0.01);
+                }
+            }
+            batch.store(batched);
+            
+            for (int s = 0; s < numSystems; s++)
+            {
+                for (int i = 0; i < numNodes; i++)
+                {
+                    EXPECT_NEAR((*singles[s])[i], batch.value(i, s), 1.0 * pow(10, -12));
+                    EXPECT_NEAR((*singles[s])[i], (*batched[s])[i], 1.0 * pow(10, -12));
+                }
+                delete batched[s];
+                delete singles[s];
+            }
+	}
+
+	TEST_F(CPGEquationsTest, testFloatBatchFollowsDouble) {
+            
+            int numNodes = 3;
+            int numSystems = 8;
+            
+            std::vector<CPGEquations*> systems;
+            for (int s = 0; s < numSystems; s++)
+            {
+                systems.push_back(getCPGSystem(numNodes));
+            }
+            
+            CPGBatch batch;
+            CPGBatchF batchF;
+            batch.build(systems);
+            batchF.build(systems);
+            
+            std::vector<double> batchComs (numNodes * numSystems, 1.0);
+            for (int i = 0; i < 100; i++)
+            {
+                batch.update(batchComs, 0.01, 0.01);
+                batchF.update(batchComs, 0.01, 0.01);
+            }
+            
+            // Single precision over a second of oscillation
+            for (int s = 0; s < numSystems; s++)
+            {
+                for (int i = 0; i < numNodes; i++)
+                {
+                    EXPECT_NEAR(batch.value(i, s), batchF.value(i, s), 1.0 * pow(10, -4));
+                }
+                delete systems[s];
+            }
+	}
+
+	TEST_F(CPGEquationsTest, testCouplingRows) {
+            
+            CPGCoupling coupling;
+            for (int i = 0; i < 3; i++)
+            {
+                coupling.addNode();
+            }
+            
+            std::vector<int> targets (1, 2);
+            std::vector<double> weights (1, 2.0);
+            std::vector<double> phases (1, 0.0);
+            coupling.connect(2, targets, weights, phases);
+            
+            // Filling an earlier row moves the later ones
+            targets[0] = 1;
+            weights[0] = 0.5;
+            coupling.connect(0, targets, weights, phases);
+            
+            ASSERT_EQ(2u, coupling.couplings());
+            EXPECT_EQ(0u, coupling.begin(0));
+            EXPECT_EQ(1u, coupling.end(0));
+            EXPECT_EQ(coupling.end(1), coupling.begin(1));
+            EXPECT_EQ(1u, coupling.target(0));
+            EXPECT_EQ(2u, coupling.target(1));
+            
+            // phi and r, interleaved
+            double state[6] = {0.0, 1.0, M_PI / 2.0, 3.0, 0.0, 1.0};
+            EXPECT_NEAR(1.5, coupling.sum(0, state, state + 1, 2), 1.0 * pow(10, -12));
+            EXPECT_NEAR(0.0, coupling.sum(2, state, state + 1, 2), 1.0 * pow(10, -12));
+            
+            targets[0] = 3;
+            EXPECT_THROW(coupling.connect(1, targets, weights, phases), std::invalid_argument);
+	}
+
+	TEST_F(CPGEquationsTest, testUpdatePeriod) {
+            
+            int numNodes = 3;
+            
+            // One ticks on its own, the other is updated by a timer
+            CPGEquations* m_pCPGSystem = getCPGSystem(numNodes);
+            CPGEquations* m_pCPGSystem2 = getCPGSystem(numNodes);
+            m_pCPGSystem->setUpdatePeriod(0.01, CPGEquations::LINEAR);
+            
+            std::vector<double> desComs (numNodes, 1.0);
+            
+            // The first step ticks one period ahead, nodes start at 0
+            EXPECT_TRUE(m_pCPGSystem->step(desComs, 0.005));
+            m_pCPGSystem2->update(desComs, 0.01);
+            std::vector<double> first (numNodes);
+            for (int i = 0; i < numNodes; i++)
+            {
+                first[i] = (*m_pCPGSystem2)[i];
+                EXPECT_NEAR(0.5 * first[i], (*m_pCPGSystem)[i], 1.0 * pow(10, -12));
+            }
+            
+            // Between ticks nothing is integrated
+            EXPECT_FALSE(m_pCPGSystem->step(desComs, 0.004));
+            EXPECT_TRUE(m_pCPGSystem->step(desComs, 0.002));
+            m_pCPGSystem2->update(desComs, 0.01);
+            
+            // 0.001 into the second tick
+            for (int i = 0; i < numNodes; i++)
+            {
+                double b = (*m_pCPGSystem2)[i];
+                EXPECT_NEAR(first[i] + 0.1 * (b - first[i]), (*m_pCPGSystem)[i], 1.0 * pow(10, -9));
+            }
+            
+            // All outputs at once read the same as one at a time
+            std::vector<double> outputs;
+            m_pCPGSystem->getOutputs(outputs);
+            ASSERT_EQ(3u, outputs.size());
+            for (int i = 0; i < numNodes; i++)
+            {
+                EXPECT_NEAR((*m_pCPGSystem)[i], outputs[i], 1.0 * pow(10, -15));
+            }
+            
+            EXPECT_THROW(m_pCPGSystem->setUpdatePeriod(-1.0), std::invalid_argument);
+            
+            delete m_pCPGSystem;
+            delete m_pCPGSystem2;
+	}
+
+	TEST_F(CPGEquationsTest, testStiffnessBudget) {
+            
+            int numNodes = 3;
+            std::vector<double> desComs (numNodes, 1.0);
+            
+            // Far more time than 5000 evaluations can cover
+            CPGEquations* m_pCPGSystem = getCPGSystem(numNodes);
+            EXPECT_THROW(m_pCPGSystem->update(desComs, 10000.0), std::runtime_error);
+            EXPECT_TRUE(m_pCPGSystem->isStiff());
+            
+            m_pCPGSystem->clearStiffness();
+            m_pCPGSystem->setThrowOnStiffness(false);
+            EXPECT_NO_THROW(m_pCPGSystem->update(desComs, 10000.0));
+            EXPECT_TRUE(m_pCPGSystem->isStiff());
+            EXPECT_EQ(1, m_pCPGSystem->getStiffUpdates());
+            // Integration stopped at the first step over the budget
+            EXPECT_GT(m_pCPGSystem->getStepCount(), 5000);
+            EXPECT_LE(m_pCPGSystem->getStepCount(), 5006);
+            
+            m_pCPGSystem->clearStiffness();
+            m_pCPGSystem->update(desComs, 0.01);
+            EXPECT_FALSE(m_pCPGSystem->isStiff());
+            EXPECT_EQ(0, m_pCPGSystem->getRejectedSteps());
+            
+            delete m_pCPGSystem;
+	}
+
+	TEST_F(CPGEquationsTest, testResetForAnotherTrial) {
+            
+            int numNodes = 3;
+            std::vector<double> desComs (numNodes, 1.0);
+            
+            // One system runs a trial, then takes the parameters of another
+            CPGEquations* m_pCPGSystem = getCPGSystem(numNodes);
+            m_pCPGSystem->setUpdatePeriod(0.01, CPGEquations::LINEAR);
+            for (int i = 0; i < 25; i++)
+            {
+                m_pCPGSystem->step(desComs, 0.001);
+            }
+            
+            std::vector<double> params (7);
+            params[0] = 2.0; // Frequency Offset
+            params[1] = 0.0; // Frequency Scale
+            params[2] = 0.5; // Radius Offset
+            params[3] = 0.0; // Radius Scale
+            params[4] = 20.0; // rConst (a constant)
+            params[5] = 0.0; // dMin for descending commands
+            params[6] = 5.0; // dMax for descending commands
+            
+            // The other is built for that trial
+            CPGEquations* m_pCPGSystem2 = new CPGEquations(5000);
+            m_pCPGSystem2->setUpdatePeriod(0.01, CPGEquations::LINEAR);
+            for (int i = 0; i < numNodes; i++)
+            {
+                m_pCPGSystem2->addNode(params);
+            }
+            std::vector<double> weights (2, 0.5);
+            std::vector<double> phases (2, 0.25);
+            for (int i = 0; i < numNodes; i++)
+            {
+                // The other two nodes, in order, as in getCPGSystem
+                std::vector<int> connectivityList;
+                for (int j = 0; j < numNodes; j++)
+                {
+                    if (j != i)
+                    {
+                        connectivityList.push_back(j);
+                    }
+                }
+                m_pCPGSystem->setNodeParams(i, params);
+                m_pCPGSystem->setConnectionParams(i, connectivityList, weights, phases);
+                m_pCPGSystem2->defineConnections(i, connectivityList, weights, phases);
+            }
+            m_pCPGSystem->restart();
+            
+            for (int s = 0; s < 25; s++)
+            {
+                EXPECT_EQ(m_pCPGSystem2->step(desComs, 0.001),
+                            m_pCPGSystem->step(desComs, 0.001));
+                for (int i = 0; i < numNodes; i++)
+                {
+                    EXPECT_EQ((*m_pCPGSystem2)[i], (*m_pCPGSystem)[i]);
+                }
+            }
+            
+            // The connections must be the ones defined
+            std::vector<int> reversed;
+            reversed.push_back(2);
+            reversed.push_back(1);
+            EXPECT_THROW(m_pCPGSystem->setConnectionParams(0, reversed, weights, phases),
+                            std::invalid_argument);
+            EXPECT_THROW(m_pCPGSystem->setNodeParams(0, std::vector<double>(3)),
+                            std::invalid_argument);
+            EXPECT_THROW(m_pCPGSystem->setNodeParams(3, params), std::invalid_argument);
+            
+            delete m_pCPGSystem;
+            delete m_pCPGSystem2;
+	}
+
 } // namespace
 
 int main(int argc, char **argv) {
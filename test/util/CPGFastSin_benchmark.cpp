@@ -0,0 +1,140 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file CPGFastSin_benchmark.cpp
+* @brief Compares the accuracy and speed of CPGFastSin in the coupling
+* terms of CPGEquations with the C library's sin
+* $Id$
+*/
+
+// This application
+#include "util/CPGEquations.h"
+#include "util/CPGFastSin.h"
+// The C++ Standard Library
+#include <cmath>
+#include <ctime>
+#include <iostream>
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	// A ring of nodes, each coupled to its eight nearest neighbours
+	CPGEquations* getCPGSystem(int numNodes)
+	{
+		CPGEquations* pCPGSystem = new CPGEquations(100000);
+		
+		std::vector<double> params (7);
+		params[1] = 0.0; // Frequency Scale
+		params[2] = 1.0; // Radius Offset
+		params[3] = 0.0; // Radius Scale
+		params[4] = 20.0; // rConst (a constant)
+		params[5] = 0.0; // dMin for descending commands
+		params[6] = 5.0; // dMax for descending commands
+		for (int i = 0; i < numNodes; i++)
+		{
+			params[0] = 1.0 + 0.01 * i; // Frequency Offset
+			pCPGSystem->addNode(params);
+		}
+		
+		for (int i = 0; i < numNodes; i++)
+		{
+			std::vector<int> connectivityList;
+			std::vector<double> weights;
+			std::vector<double> phases;
+			for (int j = -4; j <= 4; j++)
+			{
+				if (j != 0)
+				{
+					connectivityList.push_back((i + j + numNodes) % numNodes);
+					weights.push_back(0.5 / std::abs(j));
+					phases.push_back(0.1 * j);
+				}
+			}
+			pCPGSystem->defineConnections(i, connectivityList, weights, phases);
+		}
+		return pCPGSystem;
+	}
+
+	// Seconds of processor time to run the system for simTime
+	double runSystem(CPGEquations& system, double simTime, double dt)
+	{
+		std::vector<double> desComs (200, 1.0);
+		const std::clock_t start = std::clock();
+		for (double t = 0.0; t < simTime; t += dt)
+		{
+			system.update(desComs, dt);
+		}
+		return (std::clock() - start) / static_cast<double>(CLOCKS_PER_SEC);
+	}
+
+	TEST(CPGFastSinTest, testAccuracy) {
+		const double tolerances[] = {1.0e-3, 1.0e-6, 1.0e-9, 1.0e-12};
+		for (int t = 0; t < 4; t++)
+		{
+			const std::size_t terms = CPGFastSin::termsFor(tolerances[t]);
+			double maxError = 0.0;
+			for (double x = -1000.0; x < 1000.0; x += 0.00123)
+			{
+				maxError = std::max(maxError,
+						std::fabs(CPGFastSin::sin(x, terms) - std::sin(x)));
+			}
+			std::cout << "tolerance " << tolerances[t] << ": " << terms <<
+				" terms, max error " << maxError << std::endl;
+			// Reduction adds rounding of about |x| * 1e-16
+			EXPECT_LT(maxError, tolerances[t] + 1.0e-12);
+		}
+		EXPECT_EQ(0u, CPGFastSin::termsFor(0.0));
+	}
+
+	TEST(CPGFastSinTest, benchmarkCoupling) {
+		const int numNodes = 200;
+		const double simTime = 10.0;
+		const double dt = 0.01;
+		
+		CPGEquations* libm = getCPGSystem(numNodes);
+		CPGEquations* fast = getCPGSystem(numNodes);
+		fast->setSinTolerance(1.0e-9);
+		
+		const double libmTime = runSystem(*libm, simTime, dt);
+		const double fastTime = runSystem(*fast, simTime, dt);
+		
+		double maxDifference = 0.0;
+		for (int i = 0; i < numNodes; i++)
+		{
+			maxDifference = std::max(maxDifference,
+					std::fabs((*libm)[i] - (*fast)[i]));
+		}
+		std::cout << "libm " << libmTime << " s, fast " << fastTime <<
+			" s, max output difference " << maxDifference << std::endl;
+		
+		// Both stay within the integrator's own tolerance of each other
+		EXPECT_LT(maxDifference, 1.0e-5);
+		
+		delete libm;
+		delete fast;
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
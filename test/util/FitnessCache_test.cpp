@@ -0,0 +1,108 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file FitnessCache_test.cpp
+* @brief Contains a test of the quantized lookup, eviction and nearest
+* neighbour prediction of FitnessCache
+* $Id$
+*/
+
+// This application
+#include "util/FitnessCache.h"
+// The C++ Standard Library
+#include <stdexcept>
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	std::vector<double> point(double x, double y)
+	{
+		std::vector<double> p(2);
+		p[0] = x;
+		p[1] = y;
+		return p;
+	}
+
+	std::vector<double> scores(double s)
+	{
+		return std::vector<double>(2, s);
+	}
+
+	TEST(FitnessCacheTest, testFindWithinResolution) {
+		FitnessCache cache(0.01);
+		std::vector<double> found;
+		EXPECT_FALSE(cache.find(point(0.5, 0.5), found));
+
+		cache.insert(point(0.5, 0.5), scores(3.0));
+		ASSERT_TRUE(cache.find(point(0.501, 0.499), found));
+		EXPECT_DOUBLE_EQ(3.0, found[0]);
+		EXPECT_FALSE(cache.find(point(0.52, 0.5), found));
+
+		// Repeats are averaged
+		cache.insert(point(0.5, 0.5), scores(5.0));
+		ASSERT_TRUE(cache.find(point(0.5, 0.5), found));
+		EXPECT_DOUBLE_EQ(4.0, found[0]);
+		EXPECT_EQ(1u, cache.size());
+	}
+
+	TEST(FitnessCacheTest, testOldestEntriesAreEvicted) {
+		FitnessCache cache(0.01, 3);
+		for (int i = 0; i < 5; i++)
+		{
+			cache.insert(point(0.1 * i, 0.0), scores(i));
+		}
+		EXPECT_EQ(3u, cache.size());
+
+		std::vector<double> found;
+		EXPECT_FALSE(cache.find(point(0.0, 0.0), found));
+		EXPECT_FALSE(cache.find(point(0.1, 0.0), found));
+		ASSERT_TRUE(cache.find(point(0.4, 0.0), found));
+		EXPECT_DOUBLE_EQ(4.0, found[0]);
+	}
+
+	TEST(FitnessCacheTest, testPredictAndQuantile) {
+		FitnessCache cache(1.0e-6);
+		double predicted = 0.0;
+		EXPECT_FALSE(cache.predict(point(0.5, 0.5), 2, predicted));
+		EXPECT_THROW(cache.quantile(0.5), std::runtime_error);
+
+		cache.insert(point(0.0, 0.0), scores(0.0));
+		cache.insert(point(1.0, 0.0), scores(10.0));
+		cache.insert(point(0.0, 1.0), scores(20.0));
+
+		// Halfway between the two nearest
+		ASSERT_TRUE(cache.predict(point(0.5, 0.0), 2, predicted));
+		EXPECT_DOUBLE_EQ(5.0, predicted);
+		// An exact match wins
+		ASSERT_TRUE(cache.predict(point(0.0, 1.0), 3, predicted));
+		EXPECT_DOUBLE_EQ(20.0, predicted);
+
+		EXPECT_DOUBLE_EQ(0.0, cache.quantile(0.0));
+		EXPECT_DOUBLE_EQ(10.0, cache.quantile(0.5));
+		EXPECT_DOUBLE_EQ(20.0, cache.quantile(1.0));
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
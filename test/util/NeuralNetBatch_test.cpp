@@ -0,0 +1,159 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file NeuralNetBatch_test.cpp
+* @brief Contains a test of NeuralNetBatch against the feed forward of
+* neuralNetwork from nnImplementationV2
+* $Id$
+*/
+
+// This application
+#include "util/NeuralNetBatch.h"
+// The C++ Standard Library
+#include <math.h>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	/** neuralNetwork::feedForward, one pattern at a time */
+	void reference(const std::vector<double>& w, int nIn, int nHid, int nOut,
+					const double* pattern, double* outputs)
+	{
+		std::vector<double> input(pattern, pattern + nIn);
+		input.push_back(-1.0);
+		std::vector<double> hidden(nHid + 1, -1.0);
+		for (int j = 0; j < nHid; j++)
+		{
+			double sum = 0.0;
+			for (int i = 0; i <= nIn; i++)
+			{
+				sum += input[i] * w[i * nHid + j];
+			}
+			hidden[j] = 1.0 / (1.0 + exp(-sum));
+		}
+		const double* wHO = &w[(nIn + 1) * nHid];
+		for (int k = 0; k < nOut; k++)
+		{
+			double sum = 0.0;
+			for (int j = 0; j <= nHid; j++)
+			{
+				sum += hidden[j] * wHO[j * nOut + k];
+			}
+			outputs[k] = 1.0 / (1.0 + exp(-sum));
+		}
+	}
+
+	class NeuralNetBatchTest : public ::testing::Test {
+		protected:
+
+			NeuralNetBatchTest() :
+			nets(2, 4, 3)
+			{
+				for (int n = 0; n < 2; n++)
+				{
+					std::vector<double>& w = weights[n];
+					for (std::size_t i = 0; i < nets.weightCount(); i++)
+					{
+						w.push_back(sin(1.0 + n + 0.7 * i) * 2.0);
+					}
+					nets.addNetwork(&w[0]);
+				}
+				// An odd count exercises the scalar tail
+				for (int p = 0; p < 7; p++)
+				{
+					inputs.push_back(0.1 * p);
+					inputs.push_back(1.0 - 0.15 * p);
+				}
+			}
+
+			NeuralNetBatch nets;
+			std::vector<double> weights[2];
+			std::vector<double> inputs;
+	};
+
+	TEST_F(NeuralNetBatchTest, testMatchesFeedForward) {
+		std::vector<double> outputs(7 * 3);
+		nets.evaluate(1, &inputs[0], 7, &outputs[0]);
+		for (int p = 0; p < 7; p++)
+		{
+			double expected[3];
+			reference(weights[1], 2, 4, 3, &inputs[2 * p], expected);
+			for (int k = 0; k < 3; k++)
+			{
+				EXPECT_EQ(expected[k], outputs[3 * p + k]);
+			}
+		}
+	}
+
+	TEST_F(NeuralNetBatchTest, testMixedNetworks) {
+		const std::size_t networks[7] = { 0, 1, 1, 0, 1, 0, 0 };
+		std::vector<double> outputs(7 * 3);
+		nets.evaluateAll(networks, &inputs[0], 7, &outputs[0]);
+		for (int p = 0; p < 7; p++)
+		{
+			double expected[3];
+			reference(weights[networks[p]], 2, 4, 3, &inputs[2 * p], expected);
+			for (int k = 0; k < 3; k++)
+			{
+				EXPECT_EQ(expected[k], outputs[3 * p + k]);
+			}
+		}
+
+		const std::size_t bad[1] = { 2 };
+		EXPECT_THROW(nets.evaluateAll(bad, &inputs[0], 1, &outputs[0]),
+						std::invalid_argument);
+	}
+
+	TEST_F(NeuralNetBatchTest, testWeightsFile) {
+		const char* fileName = "NeuralNetBatch_test.nnw";
+		std::FILE* file = std::fopen(fileName, "w");
+		ASSERT_TRUE(file != NULL);
+		for (std::size_t i = 0; i < weights[0].size(); i++)
+		{
+			std::fprintf(file, i == 0 ? "%.17g" : ",%.17g", weights[0][i]);
+		}
+		std::fclose(file);
+
+		NeuralNetBatch loaded(2, 4, 3);
+		EXPECT_EQ(0u, loaded.addNetwork(fileName));
+
+		std::vector<double> expected(3);
+		std::vector<double> outputs(3);
+		nets.evaluate(0, &inputs[0], 1, &expected[0]);
+		loaded.evaluate(0, &inputs[0], 1, &outputs[0]);
+		for (int k = 0; k < 3; k++)
+		{
+			EXPECT_EQ(expected[k], outputs[k]);
+		}
+
+		NeuralNetBatch wrongShape(3, 4, 3);
+		EXPECT_THROW(wrongShape.addNetwork(fileName), std::invalid_argument);
+		std::remove(fileName);
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
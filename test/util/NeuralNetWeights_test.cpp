@@ -0,0 +1,151 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file NeuralNetWeights_test.cpp
+* @brief Contains a test of the text and binary weights files of
+* NeuralNetWeights
+* $Id$
+*/
+
+// This application
+#include "util/NeuralNetWeights.h"
+#include "util/NeuralNetBatch.h"
+// The C++ Standard Library
+#include <math.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	class NeuralNetWeightsTest : public ::testing::Test {
+		protected:
+
+			NeuralNetWeightsTest()
+			{
+				// 2 inputs, 4 hidden and 3 outputs
+				for (int i = 0; i < 27; i++)
+				{
+					weights.push_back(sin(0.3 + 1.1 * i) / 3.0);
+				}
+			}
+
+			~NeuralNetWeightsTest()
+			{
+				std::remove("NeuralNetWeights_test.nnw");
+				std::remove("NeuralNetWeights_test.nnb");
+			}
+
+			std::vector<double> weights;
+	};
+
+	TEST_F(NeuralNetWeightsTest, testTextRoundTrip) {
+		NeuralNetWeights::writeText("NeuralNetWeights_test.nnw",
+									&weights[0], weights.size());
+		EXPECT_FALSE(NeuralNetWeights::isBinary("NeuralNetWeights_test.nnw"));
+
+		const NeuralNetWeights loaded("NeuralNetWeights_test.nnw");
+		EXPECT_FALSE(loaded.isMapped());
+		ASSERT_EQ(weights.size(), loaded.size());
+		for (std::size_t i = 0; i < weights.size(); i++)
+		{
+			EXPECT_EQ(weights[i], loaded.data()[i]);
+		}
+	}
+
+	TEST_F(NeuralNetWeightsTest, testConvertToBinary) {
+		NeuralNetWeights::writeText("NeuralNetWeights_test.nnw",
+									&weights[0], weights.size());
+		NeuralNetWeights::toBinary("NeuralNetWeights_test.nnw",
+									"NeuralNetWeights_test.nnb", 2, 4, 3);
+		EXPECT_TRUE(NeuralNetWeights::isBinary("NeuralNetWeights_test.nnb"));
+
+		const NeuralNetWeights loaded("NeuralNetWeights_test.nnb");
+		EXPECT_TRUE(loaded.isMapped());
+		EXPECT_EQ(2, loaded.inputs());
+		EXPECT_EQ(4, loaded.hidden());
+		EXPECT_EQ(3, loaded.outputs());
+		ASSERT_EQ(weights.size(), loaded.size());
+		for (std::size_t i = 0; i < weights.size(); i++)
+		{
+			EXPECT_EQ(weights[i], loaded.data()[i]);
+		}
+
+		// Both formats feed the same network
+		NeuralNetBatch nets(2, 4, 3);
+		nets.addNetwork("NeuralNetWeights_test.nnw");
+		nets.addNetwork("NeuralNetWeights_test.nnb");
+		const double inputs[2] = { 0.25, -0.5 };
+		double fromText[3];
+		double fromBinary[3];
+		nets.evaluate(0, inputs, 1, fromText);
+		nets.evaluate(1, inputs, 1, fromBinary);
+		for (int k = 0; k < 3; k++)
+		{
+			EXPECT_EQ(fromText[k], fromBinary[k]);
+		}
+
+		NeuralNetBatch wrongShape(3, 3, 3);
+		EXPECT_THROW(wrongShape.addNetwork("NeuralNetWeights_test.nnb"),
+						std::invalid_argument);
+	}
+
+	TEST_F(NeuralNetWeightsTest, testBadBinary) {
+		NeuralNetWeights::writeBinary("NeuralNetWeights_test.nnb",
+										&weights[0], weights.size());
+
+		// Cut the last value off
+		std::vector<char> contents;
+		{
+			std::ifstream input("NeuralNetWeights_test.nnb", std::ios::binary);
+			contents.assign(std::istreambuf_iterator<char>(input),
+							std::istreambuf_iterator<char>());
+		}
+		{
+			std::ofstream output("NeuralNetWeights_test.nnb", std::ios::binary);
+			output.write(&contents[0], contents.size() - sizeof(double));
+		}
+		EXPECT_THROW(NeuralNetWeights("NeuralNetWeights_test.nnb"),
+						std::invalid_argument);
+
+		// Another version, or the other byte order
+		contents[8] = 2;
+		{
+			std::ofstream output("NeuralNetWeights_test.nnb", std::ios::binary);
+			output.write(&contents[0], contents.size());
+		}
+		EXPECT_THROW(NeuralNetWeights("NeuralNetWeights_test.nnb"),
+						std::invalid_argument);
+	}
+
+	TEST_F(NeuralNetWeightsTest, testMissingFile) {
+		EXPECT_THROW(NeuralNetWeights("NeuralNetWeights_test.missing"),
+						std::invalid_argument);
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
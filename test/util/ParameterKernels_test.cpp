@@ -0,0 +1,151 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file ParameterKernels_test.cpp
+* @brief Contains a test of Philox4x32 against the published known answers
+* and of the ParameterKernels population operators
+* $Id$
+*/
+
+// This application
+#include "util/ParameterKernels.h"
+#include "core/Philox4x32.h"
+// The C++ Standard Library
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	TEST(ParameterKernelsTest, testPhiloxKnownAnswers) {
+		// From the Random123 distribution, philox4x32-10
+		const boost::uint32_t c0[4] = {0, 0, 0, 0};
+		const boost::uint32_t k0[2] = {0, 0};
+		boost::uint32_t out[4];
+		Philox4x32::block(c0, k0, out);
+		EXPECT_EQ(0x6627e8d5u, out[0]);
+		EXPECT_EQ(0xe169c58du, out[1]);
+		EXPECT_EQ(0xbc57ac4cu, out[2]);
+		EXPECT_EQ(0x9b00dbd8u, out[3]);
+
+		const boost::uint32_t c1[4] = {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344};
+		const boost::uint32_t k1[2] = {0xa4093822, 0x299f31d0};
+		Philox4x32::block(c1, k1, out);
+		EXPECT_EQ(0xd16cfe09u, out[0]);
+		EXPECT_EQ(0x94fdccebu, out[1]);
+		EXPECT_EQ(0x5001e420u, out[2]);
+		EXPECT_EQ(0x24126ea1u, out[3]);
+	}
+
+	TEST(ParameterKernelsTest, testBatchedBlocksMatchSingleBlocks) {
+		Philox4x32 single(5, 9);
+		Philox4x32 batched(5, 9);
+		// Four side by side, then one at a time, then the counter moves on
+		std::vector<boost::uint32_t> expected(4 * 10);
+		std::vector<boost::uint32_t> actual(4 * 10);
+		for (std::size_t i = 0; i < 10; i++)
+		{
+			single.next(&expected[4 * i]);
+		}
+		batched.next(&actual[0], 5);
+		batched.next(&actual[20], 5);
+		EXPECT_TRUE(expected == actual);
+	}
+
+	TEST(ParameterKernelsTest, testStreamsAreReproducibleAndDistinct) {
+		ParameterKernels a(42, 0);
+		ParameterKernels b(42, 0);
+		ParameterKernels c(42, 1);
+		int same = 0;
+		for (int i = 0; i < 100; i++)
+		{
+			const double u = a.uniform();
+			ASSERT_GE(u, 0.0);
+			ASSERT_LT(u, 1.0);
+			EXPECT_EQ(u, b.uniform());
+			same += (u == c.uniform());
+		}
+		EXPECT_EQ(0, same);
+
+		// Reseeding restarts the stream
+		a.seed(42, 1);
+		c.seed(42, 1);
+		EXPECT_EQ(c.uniform(), a.uniform());
+	}
+
+	TEST(ParameterKernelsTest, testMutateStaysInRange) {
+		ParameterKernels kernels(7, 0);
+		const std::size_t n = 1001;
+		std::vector<double> params(n, 0.5);
+		params[0] = 0.0;
+		params[1] = 1.0;
+
+		// Probability 0 changes nothing
+		kernels.mutate(&params[0], n, 0.0, 0.1);
+		EXPECT_EQ(0.5, params[2]);
+
+		// A large deviation must clamp
+		kernels.mutate(&params[0], n, 1.0, 10.0);
+		std::size_t moved = 0;
+		double mean = 0.0;
+		for (std::size_t i = 0; i < n; i++)
+		{
+			EXPECT_GE(params[i], 0.0);
+			EXPECT_LE(params[i], 1.0);
+			moved += (params[i] == 0.0 || params[i] == 1.0);
+			mean += params[i] / n;
+		}
+		EXPECT_GT(moved, n * 9 / 10);
+		EXPECT_NEAR(0.5, mean, 0.1);
+
+		kernels.randomize(&params[0], n);
+		mean = 0.0;
+		for (std::size_t i = 0; i < n; i++)
+		{
+			EXPECT_GE(params[i], 0.0);
+			EXPECT_LT(params[i], 1.0);
+			mean += params[i] / n;
+		}
+		EXPECT_NEAR(0.5, mean, 0.05);
+	}
+
+	TEST(ParameterKernelsTest, testCrossoverTakesFromBothParents) {
+		ParameterKernels kernels(3, 0);
+		const std::size_t n = 101;
+		std::vector<double> a(n, 0.25);
+		std::vector<double> b(n, 0.75);
+		std::vector<double> child(n, 0.0);
+
+		kernels.crossover(&child[0], &a[0], &b[0], n);
+		std::size_t fromA = 0;
+		for (std::size_t i = 0; i < n; i++)
+		{
+			ASSERT_TRUE(child[i] == 0.25 || child[i] == 0.75);
+			fromA += (child[i] == 0.25);
+		}
+		EXPECT_GT(fromA, 20u);
+		EXPECT_LT(fromA, 80u);
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
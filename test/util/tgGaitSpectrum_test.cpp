@@ -0,0 +1,102 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgGaitSpectrum_test.cpp
+* @brief Contains a test of the peaks and phase lags of tgGaitSpectrum
+* $Id$
+*/
+
+// This application
+#include "util/tgGaitSpectrum.h"
+// The C++ Standard Library
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	const double pi = 3.14159265358979323846;
+
+	/** Sample two sines of a frequency off the bins, offset and phased */
+	void feed(tgGaitSpectrum& spectrum, double frequency, std::size_t n)
+	{
+		const double dt = spectrum.getConfig().samplePeriod;
+		std::vector<double> values(2);
+		for (std::size_t i = 0; i < n; i++) {
+			const double t = i * dt;
+			values[0] = 10.0 + 2.0 * std::sin(2.0 * pi * frequency * t);
+			values[1] = 3.0 + 0.5 * std::sin(2.0 * pi * frequency * t + pi / 2);
+			spectrum.sample(values);
+		}
+	}
+
+	TEST(tgGaitSpectrumTest, FindsThePeak) {
+		tgGaitSpectrum spectrum(2, tgGaitSpectrum::Config(0.01, 5.0, 0.2, 10.0));
+		EXPECT_EQ(500u, spectrum.getWindowSamples());
+		feed(spectrum, 1.13, 499);
+		EXPECT_FALSE(spectrum.isReady());
+		EXPECT_EQ(0.0, spectrum.getFrequency(0));
+
+		// Past a refresh, so the sliding bins have been recomputed
+		feed(spectrum, 1.13, 1234);
+		ASSERT_TRUE(spectrum.isReady());
+		EXPECT_NEAR(1.13, spectrum.getFrequency(0), 0.01);
+		EXPECT_NEAR(1.13, spectrum.getFrequency(1), 0.01);
+		EXPECT_NEAR(2.0, spectrum.getAmplitude(0), 0.1);
+		EXPECT_NEAR(0.5, spectrum.getAmplitude(1), 0.025);
+		EXPECT_NEAR(pi / 2, spectrum.getPhaseLag(1, 0), 0.05);
+		EXPECT_NEAR(-pi / 2, spectrum.getPhaseLag(0, 1), 0.05);
+		EXPECT_NEAR(0.0, spectrum.getPhaseLag(0, 0), 1e-12);
+	}
+
+	TEST(tgGaitSpectrumTest, FollowsAChange) {
+		tgGaitSpectrum spectrum(2, tgGaitSpectrum::Config(0.01, 4.0, 0.2, 10.0));
+		feed(spectrum, 0.8, 1000);
+		EXPECT_NEAR(0.8, spectrum.getFrequency(0), 0.01);
+		// One window later only the new gait is left
+		feed(spectrum, 2.5, 400);
+		EXPECT_NEAR(2.5, spectrum.getFrequency(0), 0.01);
+
+		spectrum.reset();
+		EXPECT_FALSE(spectrum.isReady());
+	}
+
+	TEST(tgGaitSpectrumTest, RejectsBadConfigs) {
+		EXPECT_THROW(tgGaitSpectrum(0), std::invalid_argument);
+		EXPECT_THROW(tgGaitSpectrum(1, tgGaitSpectrum::Config(0.0)),
+					 std::invalid_argument);
+		EXPECT_THROW(tgGaitSpectrum(1, tgGaitSpectrum::Config(0.01, 0.05)),
+					 std::invalid_argument);
+		EXPECT_THROW(tgGaitSpectrum(1, tgGaitSpectrum::Config(0.01, 5.0, 80.0, 90.0)),
+					 std::invalid_argument);
+
+		tgGaitSpectrum spectrum(2);
+		EXPECT_THROW(spectrum.sample(std::vector<double>(3)),
+					 std::invalid_argument);
+		EXPECT_THROW(spectrum.getPeak(2), std::out_of_range);
+	}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,95 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file tgMetricsStore_test.cpp
+* @brief Contains a test of the reductions of tgMetricsStore
+* $Id$
+*/
+
+// This application
+#include "util/tgMetricsStore.h"
+// The C++ Standard Library
+#include <stdexcept>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	class tgMetricsStoreTest : public ::testing::Test {
+		protected:
+
+			tgMetricsStoreTest() :
+			store(16)
+			{
+				time = store.addColumn("time");
+				value = store.addColumn("value");
+				const double values[] = { 4.0, 1.0, 3.0, 2.0 };
+				for (std::size_t i = 0; i < 4; i++)
+				{
+					store.append(time, 0.5 * i);
+					store.append(value, values[i]);
+				}
+			}
+
+			tgMetricsStore store;
+			std::size_t time;
+			std::size_t value;
+	};
+
+	TEST_F(tgMetricsStoreTest, testColumns) {
+		EXPECT_EQ(2u, store.columns());
+		EXPECT_EQ(value, store.getColumn("value"));
+		EXPECT_FALSE(store.hasColumn("tension"));
+		EXPECT_THROW(store.getColumn("tension"), std::invalid_argument);
+		EXPECT_THROW(store.addColumn("time"), std::invalid_argument);
+		EXPECT_EQ(4u, store.size(value));
+	}
+
+	TEST_F(tgMetricsStoreTest, testReductions) {
+		EXPECT_DOUBLE_EQ(10.0, store.sum(value));
+		EXPECT_DOUBLE_EQ(2.5, store.mean(value));
+		EXPECT_DOUBLE_EQ(1.25, store.variance(value));
+		EXPECT_DOUBLE_EQ(1.0, store.min(value));
+		EXPECT_DOUBLE_EQ(4.0, store.max(value));
+
+		EXPECT_DOUBLE_EQ(1.0, store.percentile(value, 0.0));
+		EXPECT_DOUBLE_EQ(2.5, store.percentile(value, 50.0));
+		EXPECT_DOUBLE_EQ(4.0, store.percentile(value, 100.0));
+		EXPECT_THROW(store.percentile(value, 101.0), std::invalid_argument);
+
+		// Trapezoids of (4, 1), (1, 3) and (3, 2), each 0.5 wide
+		EXPECT_DOUBLE_EQ(3.5, store.integral(value, 0.5));
+		EXPECT_DOUBLE_EQ(3.5, store.integral(value, time));
+	}
+
+	TEST_F(tgMetricsStoreTest, testClearKeepsColumns) {
+		store.clear();
+		EXPECT_EQ(2u, store.columns());
+		EXPECT_EQ(0u, store.size(value));
+		EXPECT_DOUBLE_EQ(0.0, store.sum(value));
+		EXPECT_DOUBLE_EQ(0.0, store.integral(value, 0.5));
+		EXPECT_THROW(store.mean(value), std::runtime_error);
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
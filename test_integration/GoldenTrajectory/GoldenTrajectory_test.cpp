@@ -0,0 +1,191 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License 197.632for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file GoldenTrajectory_test.cpp
+* @brief Compares the step by step state of reference scenarios with
+* golden trajectories recorded by an earlier build
+* $Id$
+*/
+
+// This application
+#include "examples/contactCables/ContactCableDemo.h"
+// This library
+#include "core/tgModel.h"
+#include "core/tgSimView.h"
+#include "core/tgSimulation.h"
+#include "core/tgWorld.h"
+#include "core/terrain/tgBoxGround.h"
+#include "core/terrain/tgEmptyGround.h"
+#include "sensors/tgGoldenTrajectory.h"
+
+// The C++ Standard Library
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+// Google Test
+#include "gtest/gtest.h"
+
+
+using namespace std;
+
+namespace {
+
+	/** A reference scenario: the contact cable prism, floating or dropped */
+	struct Scenario
+	{
+		const char* name;
+		double gravity;
+		bool ground;
+		int steps;
+	};
+
+	const Scenario scenarios[] = {
+		{ "ContactCableFloating", 0.0, false, 2000 },
+		{ "ContactCableDropped", 98.1, true, 2000 }
+	};
+
+	/** Run a scenario and return its trajectory, owned by simulation */
+	tgGoldenTrajectory* run(const Scenario& scenario, tgSimulation*& simulation,
+							tgWorld*& world, tgSimView*& view)
+	{
+		const tgWorld::Config config(scenario.gravity); // gravity, cm/sec^2
+		tgGround* ground = scenario.ground ?
+			static_cast<tgGround*>(new tgBoxGround()) :
+			static_cast<tgGround*>(new tgEmptyGround());
+		world = new tgWorld(config, ground);
+		view = new tgSimView(*world, 1.0/1000.0, 1.0/60.0);
+		simulation = new tgSimulation(*view);
+
+		ContactCableDemo* myModel = new ContactCableDemo();
+		simulation->addModel(myModel);
+
+		tgGoldenTrajectory* trajectory = new tgGoldenTrajectory();
+		trajectory->addSenseable(myModel);
+		simulation->addDataManager(trajectory);
+
+		simulation->run(scenario.steps);
+		return trajectory;
+	}
+
+	/** Runs a scenario, then deletes it */
+	class ScenarioRun
+	{
+	public:
+		explicit ScenarioRun(const Scenario& scenario) :
+		trajectory(run(scenario, simulation, world, view))
+		{
+		}
+
+		~ScenarioRun()
+		{
+			delete simulation;
+			delete view;
+			delete world;
+		}
+
+		tgSimulation* simulation;
+		tgWorld* world;
+		tgSimView* view;
+		tgGoldenTrajectory* trajectory;
+	};
+
+	/** The tolerance chosen by NTRT_GOLDEN_SIGMAS, bitwise if unset */
+	tgGoldenTrajectory::Tolerance tolerance()
+	{
+		const char* sigmas = getenv("NTRT_GOLDEN_SIGMAS");
+		return tgGoldenTrajectory::Tolerance(sigmas ? atof(sigmas) : 0.0);
+	}
+
+	class GoldenTrajectoryTest : public ::testing::Test {
+		protected:
+			GoldenTrajectoryTest() {
+			}
+
+			virtual ~GoldenTrajectoryTest() {
+			}
+	};
+
+	// Bitwise comparison of builds means nothing if one build differs
+	// from itself
+	TEST_F(GoldenTrajectoryTest, Deterministic) {
+		for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+			ScenarioRun first(scenarios[i]);
+			ScenarioRun second(scenarios[i]);
+			const tgGoldenTrajectory::Divergence divergence =
+				second.trajectory->compare(*first.trajectory);
+			EXPECT_FALSE(divergence.diverged) << scenarios[i].name << ": "
+											  << divergence.toString();
+			EXPECT_EQ(scenarios[i].steps + 1, (int) first.trajectory->getFrames());
+		}
+	}
+
+	TEST_F(GoldenTrajectoryTest, SaveLoad) {
+		ScenarioRun scenario(scenarios[0]);
+		const string path = "GoldenTrajectory_test.golden";
+		scenario.trajectory->save(path);
+
+		tgGoldenTrajectory loaded;
+		loaded.load(path);
+		EXPECT_EQ(scenario.trajectory->getBodies(), loaded.getBodies());
+		EXPECT_EQ(scenario.trajectory->getCables(), loaded.getCables());
+		EXPECT_FALSE(loaded.compare(*scenario.trajectory).diverged);
+
+		// Dropping the prism starts like floating it, then drifts off
+		ScenarioRun dropped(scenarios[1]);
+		const tgGoldenTrajectory::Divergence divergence =
+			dropped.trajectory->compare(loaded);
+		EXPECT_TRUE(divergence.diverged);
+		EXPECT_LT(0u, divergence.step);
+		EXPECT_NE("layout", divergence.component);
+
+		// which a loose enough tolerance lets through
+		EXPECT_FALSE(dropped.trajectory->compare(loaded,
+										tgGoldenTrajectory::Tolerance(0.0, 1.0e6)).diverged);
+		remove(path.c_str());
+	}
+
+	TEST_F(GoldenTrajectoryTest, MatchesGolden) {
+		const bool rerecord = getenv("NTRT_RECORD_GOLDEN") != NULL;
+		for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+			const string path = string(GOLDEN_TRAJECTORY_DIR) + "/" +
+				scenarios[i].name + ".golden";
+			ScenarioRun scenario(scenarios[i]);
+			if (rerecord || !ifstream(path.c_str()).good()) {
+				scenario.trajectory->save(path);
+				cout << "Recorded " << path << endl;
+				continue;
+			}
+
+			tgGoldenTrajectory golden;
+			golden.load(path);
+			const tgGoldenTrajectory::Divergence divergence =
+				scenario.trajectory->compare(golden, tolerance());
+			EXPECT_FALSE(divergence.diverged) << scenarios[i].name << ": "
+											  << divergence.toString();
+		}
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
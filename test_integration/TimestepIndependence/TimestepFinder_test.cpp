@@ -0,0 +1,95 @@
+/*
+* Copyright © 2012, United States Government, as represented by the
+* Administrator of the National Aeronautics and Space Administration.
+* All rights reserved.
+*
+* The NASA Tensegrity Robotics Toolkit (NTRT) v1 platform is licensed
+* under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+* http://www.apache.org/licenses/LICENSE-2.0.
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an
+* "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+* either express or implied. See the License for the specific language
+* governing permissions and limitations under the License.
+*/
+
+/**
+* @file TimestepFinder_test.cpp
+* @brief Contains tests of tgTimestepFinder on the motor test rig
+* $Id$
+*/
+
+// This application
+#include "examples/motorModel/tsTestRig.h"
+// This library
+#include "core/tgSimulation.h"
+#include "core/tgTimestepFinder.h"
+#include "core/tgWorld.h"
+// The C++ Standard Library
+#include <vector>
+// Google Test
+#include "gtest/gtest.h"
+
+namespace {
+
+	class RigBuilder : public tgTimestepFinder::Builder {
+		public:
+			virtual void build(tgSimulation& simulation) const {
+				simulation.addModel(new tsTestRig(true));
+			}
+	};
+
+	TEST(TimestepFinderTest, Candidates) {
+		const std::vector<double> steps = tgTimestepFinder::candidates(0.0001, 0.01, 3);
+		ASSERT_EQ(3u, steps.size());
+		EXPECT_DOUBLE_EQ(0.0001, steps[0]);
+		EXPECT_NEAR(0.001, steps[1], 1e-12);
+		EXPECT_DOUBLE_EQ(0.01, steps[2]);
+		EXPECT_THROW(tgTimestepFinder::candidates(0.0, 0.01, 3), std::invalid_argument);
+	}
+
+	TEST(TimestepFinderTest, ReferenceMatchesItself) {
+		const tgWorld::Config config(981); // gravity, dm/sec^2
+		const RigBuilder builder;
+		const tgTimestepFinder::Config sweep(0.5, 0.01, 0.03, 1.0/1000.0);
+		tgTimestepFinder finder(config, builder, sweep, 2);
+
+		const std::vector<tgTimestepFinder::Result> results =
+			finder.sweep(std::vector<double>(1, 1.0/1000.0));
+		ASSERT_EQ(1u, results.size());
+		EXPECT_EQ(0.0, results[0].error);
+		EXPECT_TRUE(results[0].stable);
+		EXPECT_EQ(1.0/1000.0, tgTimestepFinder::largestStable(results));
+	}
+
+	TEST(TimestepFinderTest, SweepIsOrdered) {
+		const tgWorld::Config config(981); // gravity, dm/sec^2
+		const RigBuilder builder;
+		const tgTimestepFinder::Config sweep(0.5, 0.01, 0.03, 1.0/5000.0);
+		tgTimestepFinder finder(config, builder, sweep);
+
+		std::vector<double> steps;
+		steps.push_back(1.0/100.0);
+		steps.push_back(1.0/1000.0);
+		steps.push_back(1.0/500.0);
+		const std::vector<tgTimestepFinder::Result> results = finder.sweep(steps);
+		ASSERT_EQ(3u, results.size());
+		for (std::size_t i = 0; i < results.size(); i++) {
+			EXPECT_GE(results[i].error, 0.0);
+			if (i > 0) {
+				EXPECT_LT(results[i - 1].stepSize, results[i].stepSize);
+			}
+		}
+		const double largest = tgTimestepFinder::largestStable(results);
+		EXPECT_LE(largest, 1.0/100.0);
+	}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}